@@ -136,7 +136,7 @@ static void BenchGLSetDefaultGLInterface() {
     gBenchGLInterfaceInit = true;
 }
 
-BenchGpuTimer::BenchGpuTimer() {
+BenchGpuTimer::BenchGpuTimer() : fStarted(false) {
     BenchGLSetDefaultGLInterface();
     if (gBenchGL.fHasTimer) {
         gBenchGL.fGenQueries(1, &this->fQuery);
@@ -161,10 +161,19 @@ void BenchGpuTimer::startGpu() {
  * as this will cpu wait for the gpu to finish.
  */
 double BenchGpuTimer::endGpu() {
-    if (!gBenchGL.fHasTimer) return 0;
+    this->stopGpu();
+    return this->readGpu();
+}
+
+void BenchGpuTimer::stopGpu() {
+    if (!gBenchGL.fHasTimer || !this->fStarted) return;
     
     this->fStarted = false;
     gBenchGL.fEndQuery(BenchGL_TIME_ELAPSED);
+}
+
+double BenchGpuTimer::readGpu() {
+    if (!gBenchGL.fHasTimer) return 0;
     
     GLint available = 0;
     while (!available) {
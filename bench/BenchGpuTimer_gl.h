@@ -25,6 +25,11 @@ public:
     ~BenchGpuTimer();
     void startGpu();
     double endGpu();
+
+    // endGpu() is stopGpu() then readGpu(), which waits for the result; in
+    // between, the GPU can catch up without the CPU spinning on it
+    void stopGpu();
+    double readGpu();
 private:
     GLuint fQuery;
     int fStarted;
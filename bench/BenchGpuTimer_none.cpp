@@ -12,3 +12,10 @@ void BenchGpuTimer::startGpu() {
 double BenchGpuTimer::endGpu() {
     return -1.0;
 }
+
+void BenchGpuTimer::stopGpu() {
+}
+
+double BenchGpuTimer::readGpu() {
+    return -1.0;
+}
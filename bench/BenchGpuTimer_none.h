@@ -7,6 +7,8 @@ public:
     ~BenchGpuTimer();
     void startGpu();
     double endGpu();
+    void stopGpu();
+    double readGpu();
 };
 
 #endif
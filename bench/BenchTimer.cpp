@@ -19,13 +19,13 @@
     #include "BenchGpuTimer_none.h"
 #endif
 
-BenchTimer::BenchTimer()
+BenchTimer::BenchTimer(bool gpu)
         : fCpu(-1.0)
         , fWall(-1.0)
         , fGpu(-1.0)
 {
     this->fSysTimer = new BenchSysTimer();
-    this->fGpuTimer = new BenchGpuTimer();
+    this->fGpuTimer = gpu ? new BenchGpuTimer() : NULL;
 }
 
 BenchTimer::~BenchTimer() {
@@ -35,7 +35,9 @@ BenchTimer::~BenchTimer() {
 
 void BenchTimer::start() {
     this->fSysTimer->startWall();
-    this->fGpuTimer->startGpu();
+    if (this->fGpuTimer) {
+        this->fGpuTimer->startGpu();
+    }
     this->fSysTimer->startCpu();
 }
 
@@ -43,6 +45,39 @@ void BenchTimer::end() {
     this->fCpu = this->fSysTimer->endCpu();
     //It is important to stop the cpu clocks first,
     //as the following will cpu wait for the gpu to finish.
-    this->fGpu = this->fGpuTimer->endGpu();
+    if (this->fGpuTimer) {
+        this->fGpu = this->fGpuTimer->endGpu();
+    }
     this->fWall = this->fSysTimer->endWall();
 }
+
+BenchFrameTimer::BenchFrameTimer()
+        : fSubmit(-1.0)
+        , fStall(-1.0)
+        , fGpu(-1.0)
+{
+    this->fSysTimer = new BenchSysTimer();
+    this->fGpuTimer = new BenchGpuTimer();
+}
+
+BenchFrameTimer::~BenchFrameTimer() {
+    delete this->fSysTimer;
+    delete this->fGpuTimer;
+}
+
+void BenchFrameTimer::start() {
+    this->fSysTimer->startWall();
+    this->fGpuTimer->startGpu();
+}
+
+void BenchFrameTimer::submitted() {
+    this->fSubmit = this->fSysTimer->endWall();
+    //Only ends the query; waiting for its result here would be a stall of
+    //our own making.
+    this->fGpuTimer->stopGpu();
+}
+
+void BenchFrameTimer::finished() {
+    this->fStall = this->fSysTimer->endWall() - this->fSubmit;
+    this->fGpu = this->fGpuTimer->readGpu();
+}
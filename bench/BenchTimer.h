@@ -11,7 +11,11 @@ class BenchGpuTimer;
  */
 class BenchTimer {
 public:
-    BenchTimer();
+    /**
+     * Pass false for a timer that leaves the GPU alone, e.g. for timing on
+     * threads that have no GL context; fGpu is then always -1.
+     */
+    explicit BenchTimer(bool gpu = true);
     ~BenchTimer();
     void start();
     void end();
@@ -24,4 +28,27 @@ private:
     BenchGpuTimer *fGpuTimer;
 };
 
+/**
+ * Times one GPU frame in three parts: start() to submitted() is the CPU
+ * issuing and flushing the frame, submitted() to finished() is the CPU
+ * waiting for the GPU (e.g. in glFinish), and fGpu is what the GPU itself
+ * spent on it between start() and submitted() (not positive if there
+ * are no timer queries).
+ */
+class BenchFrameTimer {
+public:
+    BenchFrameTimer();
+    ~BenchFrameTimer();
+    void start();
+    void submitted();
+    void finished();
+    double fSubmit;
+    double fStall;
+    double fGpu;
+
+private:
+    BenchSysTimer *fSysTimer;
+    BenchGpuTimer *fGpuTimer;
+};
+
 #endif
@@ -3,15 +3,19 @@
 #include "SkPaint.h"
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
+#include "SkCreateRLEPixelRef.h"
+#include "SkPixelRef.h"
 #include "SkRandom.h"
+#include "SkRegion.h"
 #include "SkString.h"
+#include "SkXfermode.h"
 
 static const char* gTileName[] = {
     "clamp", "repeat", "mirror"
 };
 
 static const char* gConfigName[] = {
-    "ERROR", "a1", "a8", "index8", "565", "4444", "8888"
+    "ERROR", "a1", "a8", "index8", "565", "4444", "8888", "rle"
 };
 
 static void drawIntoBitmap(const SkBitmap& bm) {
@@ -162,6 +166,200 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+/*  Draws one large, immutable bitmap shrunk and filtered, over and over at a
+    few places that are whole pixels apart, as a scrolling list of thumbnails
+    would.
+ */
+class ScaledBitmapBench : public SkBenchmark {
+    SkBitmap    fBitmap;
+    enum { N = 20 };
+public:
+    ScaledBitmapBench(void* param) : INHERITED(param) {
+        fBitmap.setConfig(SkBitmap::kARGB_8888_Config, 512, 512);
+        fBitmap.allocPixels();
+        fBitmap.eraseColor(SK_ColorBLACK);
+        drawIntoBitmap(fBitmap);
+        fBitmap.setIsOpaque(true);
+        fBitmap.pixelRef()->setImmutable();
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return "bitmap_scaled_filter";
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkPaint paint;
+        this->setupPaint(&paint);
+        paint.setFilterBitmap(true);
+
+        const SkScalar scale = SkFloatToScalar(0.4f);
+        for (int i = 0; i < N; i++) {
+            canvas->save();
+            canvas->translate(SkIntToScalar(i % 4 * 50),
+                              SkFloatToScalar(10.5f) + SkIntToScalar(i % 3));
+            canvas->scale(scale, scale);
+            canvas->drawBitmap(fBitmap, 0, 0, &paint);
+            canvas->restore();
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+/*  Converts a bitmap to another config with copyTo(), as decoding to 565 or
+    reading pixels back as 8888 do. Small bitmaps show the fixed cost of each
+    copy more than large ones.
+ */
+class BitmapCopyBench : public SkBenchmark {
+    SkBitmap            fBitmap;
+    SkBitmap::Config    fDstConfig;
+    SkString            fName;
+    enum { N = 10 };
+public:
+    BitmapCopyBench(void* param, SkBitmap::Config srcConfig,
+                    SkBitmap::Config dstConfig, int size, bool isOpaque)
+            : INHERITED(param), fDstConfig(dstConfig) {
+        SkBitmap bm;
+        bm.setConfig(SkBitmap::kARGB_8888_Config, size, size);
+        bm.allocPixels();
+        bm.eraseColor(isOpaque ? SK_ColorBLACK : 0);
+        drawIntoBitmap(bm);
+        bm.setIsOpaque(isOpaque);
+        if (SkBitmap::kARGB_8888_Config == srcConfig) {
+            fBitmap.swap(bm);
+        } else {
+            bm.copyTo(&fBitmap, srcConfig);
+        }
+        fName.printf("bitmap_copy_%s_%s_%d%s", gConfigName[srcConfig],
+                     gConfigName[dstConfig], size, isOpaque ? "" : "_A");
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int i = 0; i < N; i++) {
+            SkBitmap dst;
+            fBitmap.copyTo(&dst, fDstConfig);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+/*  Scrolls a screen-sized bitmap a line of text at a time, as a terminal
+    view would: all of it up, or a sub-rect of it sideways.
+ */
+class BitmapScrollBench : public SkBenchmark {
+    SkBitmap    fBitmap;
+    SkIRect     fSubset;
+    int         fDx, fDy;
+    const char* fName;
+    enum { N = 10 };
+public:
+    BitmapScrollBench(void* param, bool vertical) : INHERITED(param) {
+        fBitmap.setConfig(SkBitmap::kARGB_8888_Config, 640, 480);
+        fBitmap.allocPixels();
+        fBitmap.eraseColor(SK_ColorBLACK);
+        drawIntoBitmap(fBitmap);
+        if (vertical) {
+            fSubset.set(0, 0, 640, 480);
+            fDx = 0;
+            fDy = -16;
+            fName = "bitmap_scroll_up";
+        } else {
+            fSubset.set(40, 40, 600, 440);
+            fDx = -8;
+            fDy = 0;
+            fName = "bitmap_scroll_left_subset";
+        }
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName;
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkRegion inval;
+        for (int i = 0; i < N; i++) {
+            fBitmap.scrollRect(&fSubset, fDx, fDy, &inval);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+/*  Draws a bitmap at whole pixels, where it goes through the sprite blitters,
+    with a global alpha or an xfermode.
+ */
+class SpriteBench : public SkBenchmark {
+    SkBitmap    fBitmap;
+    SkPaint     fPaint;
+    SkString    fName;
+    enum { N = 300 };
+public:
+    SpriteBench(void* param, SkBitmap::Config c, bool xfermode)
+            : INHERITED(param) {
+        SkBitmap bm;
+        bm.setConfig(SkBitmap::kARGB_8888_Config, 128, 128);
+        bm.allocPixels();
+        bm.eraseColor(SK_ColorBLACK);
+        drawIntoBitmap(bm);
+        bm.setIsOpaque(true);
+
+        if (SkBitmap::kIndex8_Config == c) {
+            convertToIndex666(bm, &fBitmap);
+            fBitmap.getColorTable()->setIsOpaque(true);
+            fBitmap.setIsOpaque(true);
+        } else if (SkBitmap::kRLE_Index8_Config == c) {
+            SkBitmap index8;
+            convertToIndex666(bm, &index8);
+            index8.getColorTable()->setIsOpaque(true);
+            SkCreateRLEBitmap(index8, &fBitmap);
+            fBitmap.setIsOpaque(true);
+        } else {
+            bm.copyTo(&fBitmap, c);
+        }
+
+        fName.printf("sprite_%s", gConfigName[c]);
+        if (xfermode) {
+            fPaint.setXfermode(SkXfermode::Create(
+                                    SkXfermode::kMultiply_Mode))->unref();
+            fName.append("_multiply");
+        } else {
+            fPaint.setAlpha(0x80);
+            fName.append("_alpha");
+        }
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkIPoint dim = this->getSize();
+        SkRandom rand;
+
+        for (int i = 0; i < N; i++) {
+            int x = rand.nextU() % dim.fX - fBitmap.width() / 2;
+            int y = rand.nextU() % dim.fY - fBitmap.height() / 2;
+            canvas->drawBitmap(fBitmap, SkIntToScalar(x), SkIntToScalar(y),
+                               &fPaint);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 static SkBenchmark* Fact0(void* p) { return new BitmapBench(p, false, SkBitmap::kARGB_8888_Config); }
 static SkBenchmark* Fact1(void* p) { return new BitmapBench(p, true, SkBitmap::kARGB_8888_Config); }
 static SkBenchmark* Fact2(void* p) { return new BitmapBench(p, true, SkBitmap::kRGB_565_Config); }
@@ -177,3 +375,45 @@ static BenchRegistry gReg3(Fact3);
 static BenchRegistry gReg4(Fact4);
 static BenchRegistry gReg5(Fact5);
 static BenchRegistry gReg6(Fact6);
+
+static SkBenchmark* Fact7(void* p) { return new ScaledBitmapBench(p); }
+
+static BenchRegistry gReg7(Fact7);
+
+static SkBenchmark* Fact8(void* p) { return new BitmapCopyBench(p, SkBitmap::kARGB_8888_Config, SkBitmap::kRGB_565_Config, 256, true); }
+static SkBenchmark* Fact9(void* p) { return new BitmapCopyBench(p, SkBitmap::kARGB_8888_Config, SkBitmap::kRGB_565_Config, 16, true); }
+static SkBenchmark* Fact10(void* p) { return new BitmapCopyBench(p, SkBitmap::kRGB_565_Config, SkBitmap::kARGB_8888_Config, 256, true); }
+static SkBenchmark* Fact11(void* p) { return new BitmapCopyBench(p, SkBitmap::kRGB_565_Config, SkBitmap::kARGB_8888_Config, 16, true); }
+static SkBenchmark* Fact12(void* p) { return new BitmapCopyBench(p, SkBitmap::kARGB_4444_Config, SkBitmap::kARGB_8888_Config, 256, false); }
+static SkBenchmark* Fact13(void* p) { return new BitmapCopyBench(p, SkBitmap::kARGB_8888_Config, SkBitmap::kARGB_4444_Config, 256, false); }
+
+static BenchRegistry gReg8(Fact8);
+static BenchRegistry gReg9(Fact9);
+static BenchRegistry gReg10(Fact10);
+static BenchRegistry gReg11(Fact11);
+static BenchRegistry gReg12(Fact12);
+static BenchRegistry gReg13(Fact13);
+
+static SkBenchmark* Fact14(void* p) { return new BitmapScrollBench(p, true); }
+static SkBenchmark* Fact15(void* p) { return new BitmapScrollBench(p, false); }
+
+static BenchRegistry gReg14(Fact14);
+static BenchRegistry gReg15(Fact15);
+
+static SkBenchmark* Fact16(void* p) { return new SpriteBench(p, SkBitmap::kRGB_565_Config, false); }
+static SkBenchmark* Fact17(void* p) { return new SpriteBench(p, SkBitmap::kIndex8_Config, false); }
+static SkBenchmark* Fact18(void* p) { return new SpriteBench(p, SkBitmap::kRGB_565_Config, true); }
+static SkBenchmark* Fact19(void* p) { return new SpriteBench(p, SkBitmap::kARGB_8888_Config, true); }
+
+static BenchRegistry gReg16(Fact16);
+static BenchRegistry gReg17(Fact17);
+static BenchRegistry gReg18(Fact18);
+static BenchRegistry gReg19(Fact19);
+
+static SkBenchmark* Fact20(void* p) { return new SpriteBench(p, SkBitmap::kRLE_Index8_Config, false); }
+static SkBenchmark* Fact21(void* p) { return new SpriteBench(p, SkBitmap::kIndex8_Config, true); }
+static SkBenchmark* Fact22(void* p) { return new SpriteBench(p, SkBitmap::kRLE_Index8_Config, true); }
+
+static BenchRegistry gReg20(Fact20);
+static BenchRegistry gReg21(Fact21);
+static BenchRegistry gReg22(Fact22);
@@ -0,0 +1,191 @@
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkShader.h"
+#include "SkString.h"
+
+// Shades spans straight from a bitmap shader, which runs the matrix and
+// sample procs that SkBitmapProcState picked for the combination of config,
+// matrix type, filtering and tiling, but none of the blitting after them.
+
+enum {
+    kSrcSize = 256,
+    kSpanWidth = 256,
+    kSpanCount = 64     // spans shaded per draw
+};
+
+enum MatrixType {
+    kTranslate_MatrixType,
+    kScale_MatrixType,
+    kAffine_MatrixType,
+    kPerspective_MatrixType
+};
+
+static const char* gMatrixName[] = {
+    "translate", "scale", "affine", "perspective"
+};
+
+static const char* gConfigName[] = {
+    "ERROR", "a1", "a8", "index8", "565", "4444", "8888"
+};
+
+static void make_bitmap(SkBitmap* bm, SkBitmap::Config config) {
+    SkRandom rand;
+    if (SkBitmap::kIndex8_Config == config) {
+        SkPMColor colors[256];
+        for (int i = 0; i < 256; i++) {
+            colors[i] = SkPreMultiplyColor(rand.nextU() | 0xFF000000);
+        }
+        SkColorTable* ctable = SkNEW_ARGS(SkColorTable, (colors, 256));
+        bm->setConfig(config, kSrcSize, kSrcSize);
+        bm->allocPixels(ctable);
+        ctable->unref();
+    } else {
+        bm->setConfig(config, kSrcSize, kSrcSize);
+        bm->allocPixels();
+    }
+
+    SkAutoLockPixels alp(*bm);
+    for (int y = 0; y < kSrcSize; y++) {
+        for (int x = 0; x < kSrcSize; x++) {
+            uint32_t r = rand.nextU();
+            switch (config) {
+                case SkBitmap::kIndex8_Config:
+                    *bm->getAddr8(x, y) = r & 0xFF;
+                    break;
+                case SkBitmap::kRGB_565_Config:
+                    *bm->getAddr16(x, y) = r & 0xFFFF;
+                    break;
+                default:
+                    *bm->getAddr32(x, y) = SkPreMultiplyColor(r);
+                    break;
+            }
+        }
+    }
+}
+
+class BitmapProcBench : public SkBenchmark {
+    SkBitmap            fBitmap;
+    SkBitmap            fDevice;
+    SkShader*           fShader;
+    SkPaint             fPaint;
+    SkMatrix            fMatrix;
+    SkPMColor           fSpan[kSpanWidth];
+    SkString            fName;
+public:
+    BitmapProcBench(void* param, SkBitmap::Config config, MatrixType type,
+                    bool filter, SkShader::TileMode tile = SkShader::kClamp_TileMode)
+            : INHERITED(param) {
+        make_bitmap(&fBitmap, config);
+        fDevice.setConfig(SkBitmap::kARGB_8888_Config, kSpanWidth, kSpanCount);
+
+        fShader = SkShader::CreateBitmapShader(fBitmap, tile, tile);
+        fPaint.setShader(fShader);
+        fPaint.setFilterBitmap(filter);
+
+        // the spans cover the bitmap (more than once, if it tiles)
+        const SkScalar half = SkIntToScalar(kSrcSize) / 2;
+        fMatrix.reset();
+        switch (type) {
+            case kTranslate_MatrixType:
+                fMatrix.setTranslate(SkIntToScalar(3), SkIntToScalar(5));
+                break;
+            case kScale_MatrixType:
+                fMatrix.setScale(SkFloatToScalar(1.7f),
+                                 SkFloatToScalar(1.3f));
+                break;
+            case kAffine_MatrixType:
+                fMatrix.setRotate(SkIntToScalar(30), half, half);
+                break;
+            case kPerspective_MatrixType:
+                fMatrix.setRotate(SkIntToScalar(30), half, half);
+                fMatrix.setPerspX(SkFloatToScalar(0.0005f));
+                break;
+        }
+
+        fName.printf("bitmapproc_%s_%s", gConfigName[config],
+                     gMatrixName[type]);
+        if (filter) {
+            fName.append("_filter");
+        }
+        if (SkShader::kClamp_TileMode != tile) {
+            fName.append("_repeat");
+        }
+    }
+
+    virtual ~BitmapProcBench() {
+        fShader->unref();
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kSpanWidth * kSpanCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        if (!fShader->setContext(fDevice, fPaint, fMatrix)) {
+            return;
+        }
+        for (int y = 0; y < kSpanCount; y++) {
+            fShader->shadeSpan(0, y, fSpan, kSpanWidth);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+#define C8888   SkBitmap::kARGB_8888_Config
+#define C565    SkBitmap::kRGB_565_Config
+#define CIndex8 SkBitmap::kIndex8_Config
+
+static SkBenchmark* Fact00(void* p) { return new BitmapProcBench(p, C8888, kTranslate_MatrixType, false); }
+static SkBenchmark* Fact01(void* p) { return new BitmapProcBench(p, C8888, kTranslate_MatrixType, true); }
+static SkBenchmark* Fact02(void* p) { return new BitmapProcBench(p, C8888, kScale_MatrixType, false); }
+static SkBenchmark* Fact03(void* p) { return new BitmapProcBench(p, C8888, kScale_MatrixType, true); }
+static SkBenchmark* Fact04(void* p) { return new BitmapProcBench(p, C8888, kAffine_MatrixType, false); }
+static SkBenchmark* Fact05(void* p) { return new BitmapProcBench(p, C8888, kAffine_MatrixType, true); }
+static SkBenchmark* Fact06(void* p) { return new BitmapProcBench(p, C8888, kPerspective_MatrixType, false); }
+static SkBenchmark* Fact07(void* p) { return new BitmapProcBench(p, C8888, kPerspective_MatrixType, true); }
+static SkBenchmark* Fact08(void* p) { return new BitmapProcBench(p, C8888, kScale_MatrixType, false, SkShader::kRepeat_TileMode); }
+static SkBenchmark* Fact09(void* p) { return new BitmapProcBench(p, C8888, kScale_MatrixType, true, SkShader::kRepeat_TileMode); }
+
+static SkBenchmark* Fact10(void* p) { return new BitmapProcBench(p, C565, kTranslate_MatrixType, false); }
+static SkBenchmark* Fact11(void* p) { return new BitmapProcBench(p, C565, kTranslate_MatrixType, true); }
+static SkBenchmark* Fact12(void* p) { return new BitmapProcBench(p, C565, kScale_MatrixType, false); }
+static SkBenchmark* Fact13(void* p) { return new BitmapProcBench(p, C565, kScale_MatrixType, true); }
+static SkBenchmark* Fact14(void* p) { return new BitmapProcBench(p, C565, kAffine_MatrixType, false); }
+static SkBenchmark* Fact15(void* p) { return new BitmapProcBench(p, C565, kAffine_MatrixType, true); }
+
+static SkBenchmark* Fact20(void* p) { return new BitmapProcBench(p, CIndex8, kTranslate_MatrixType, false); }
+static SkBenchmark* Fact21(void* p) { return new BitmapProcBench(p, CIndex8, kTranslate_MatrixType, true); }
+static SkBenchmark* Fact22(void* p) { return new BitmapProcBench(p, CIndex8, kScale_MatrixType, false); }
+static SkBenchmark* Fact23(void* p) { return new BitmapProcBench(p, CIndex8, kScale_MatrixType, true); }
+static SkBenchmark* Fact24(void* p) { return new BitmapProcBench(p, CIndex8, kAffine_MatrixType, false); }
+static SkBenchmark* Fact25(void* p) { return new BitmapProcBench(p, CIndex8, kAffine_MatrixType, true); }
+
+static BenchRegistry gReg00(Fact00);
+static BenchRegistry gReg01(Fact01);
+static BenchRegistry gReg02(Fact02);
+static BenchRegistry gReg03(Fact03);
+static BenchRegistry gReg04(Fact04);
+static BenchRegistry gReg05(Fact05);
+static BenchRegistry gReg06(Fact06);
+static BenchRegistry gReg07(Fact07);
+static BenchRegistry gReg08(Fact08);
+static BenchRegistry gReg09(Fact09);
+
+static BenchRegistry gReg10(Fact10);
+static BenchRegistry gReg11(Fact11);
+static BenchRegistry gReg12(Fact12);
+static BenchRegistry gReg13(Fact13);
+static BenchRegistry gReg14(Fact14);
+static BenchRegistry gReg15(Fact15);
+
+static BenchRegistry gReg20(Fact20);
+static BenchRegistry gReg21(Fact21);
+static BenchRegistry gReg22(Fact22);
+static BenchRegistry gReg23(Fact23);
+static BenchRegistry gReg24(Fact24);
+static BenchRegistry gReg25(Fact25);
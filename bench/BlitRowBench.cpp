@@ -0,0 +1,326 @@
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkBlitRow.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkColorShader.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkString.h"
+#include "SkUtils.h"
+
+// These drive the row procs directly, without a canvas or a blitter, so
+// that their per-pixel cost can be compared before and after SIMD work.
+
+enum {
+    kRowWidth = 1024,
+    kRowCount = 64     // rows blitted per draw
+};
+
+static void fill_src(SkPMColor src[], bool opaque) {
+    SkRandom rand;
+    for (int i = 0; i < kRowWidth; i++) {
+        U8CPU a = opaque ? 0xFF : rand.nextU() & 0xFF;
+        // every kind of alpha shows up, including the 0 and 255 fast paths
+        if (!opaque && (i & 7) == 0) {
+            a = (i & 8) ? 0xFF : 0;
+        }
+        src[i] = SkPreMultiplyARGB(a, rand.nextU() & 0xFF,
+                                   rand.nextU() & 0xFF, rand.nextU() & 0xFF);
+    }
+}
+
+class BlitRow32Bench : public SkBenchmark {
+    SkBlitRow::Proc32   fProc;
+    unsigned            fFlags;
+    SkPMColor           fSrc[kRowWidth];
+    SkPMColor           fDst[kRowWidth];
+    SkString            fName;
+public:
+    BlitRow32Bench(void* param, unsigned flags) : INHERITED(param) {
+        fFlags = flags;
+        fProc = SkBlitRow::Factory32(flags);
+        fill_src(fSrc, !(flags & SkBlitRow::kSrcPixelAlpha_Flag32));
+        sk_memset32(fDst, SkPackARGB32(0xFF, 0x40, 0x80, 0xC0), kRowWidth);
+
+        fName.set("blitrow_32");
+        if (flags & SkBlitRow::kSrcPixelAlpha_Flag32) {
+            fName.append("_srcalpha");
+        }
+        if (flags & SkBlitRow::kGlobalAlpha_Flag32) {
+            fName.append("_globalalpha");
+        }
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        U8CPU alpha = (fFlags & SkBlitRow::kGlobalAlpha_Flag32) ? 0x80 : 0xFF;
+        for (int i = 0; i < kRowCount; i++) {
+            fProc(fDst, fSrc, kRowWidth, alpha);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+class BlitRow16Bench : public SkBenchmark {
+    SkBlitRow::Proc     fProc;
+    unsigned            fFlags;
+    SkPMColor           fSrc[kRowWidth];
+    uint16_t            fDst[kRowWidth];
+    SkString            fName;
+public:
+    BlitRow16Bench(void* param, unsigned flags) : INHERITED(param) {
+        fFlags = flags;
+        fProc = SkBlitRow::Factory(flags, SkBitmap::kRGB_565_Config);
+        fill_src(fSrc, !(flags & SkBlitRow::kSrcPixelAlpha_Flag));
+        sk_memset16(fDst, SkPackRGB16(0x08, 0x20, 0x18), kRowWidth);
+
+        fName.set("blitrow_16");
+        if (flags & SkBlitRow::kSrcPixelAlpha_Flag) {
+            fName.append("_srcalpha");
+        }
+        if (flags & SkBlitRow::kGlobalAlpha_Flag) {
+            fName.append("_globalalpha");
+        }
+        if (flags & SkBlitRow::kDither_Flag) {
+            fName.append("_dither");
+        }
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        U8CPU alpha = (fFlags & SkBlitRow::kGlobalAlpha_Flag) ? 0x80 : 0xFF;
+        for (int i = 0; i < kRowCount; i++) {
+            fProc(fDst, fSrc, kRowWidth, alpha, 0, i);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// an A8 mask drawn into a 565 bitmap of its own, which goes through the
+// RGB16 blitters' blitMask (as text does)
+class BlitMask16Bench : public SkBenchmark {
+    SkBitmap    fDst;
+    SkBitmap    fMask;
+    SkColor     fColor;
+    SkString    fName;
+public:
+    BlitMask16Bench(void* param, SkColor color) : INHERITED(param) {
+        fColor = color;
+        fDst.setConfig(SkBitmap::kRGB_565_Config, kRowWidth, kRowCount);
+        fDst.allocPixels();
+        fDst.eraseColor(SK_ColorWHITE);
+        fMask.setConfig(SkBitmap::kA8_Config, kRowWidth, kRowCount);
+        fMask.allocPixels();
+
+        SkRandom rand;
+        for (int y = 0; y < kRowCount; y++) {
+            uint8_t* row = fMask.getAddr8(0, y);
+            for (int x = 0; x < kRowWidth; x++) {
+                row[x] = rand.nextU() & 0xFF;
+            }
+        }
+        fName.printf("blitmask_16_%02x", SkColorGetA(color));
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkCanvas canvas(fDst);
+        SkPaint paint;
+        paint.setColor(fColor);
+        canvas.drawBitmap(fMask, 0, 0, &paint);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// an A8 mask drawn into an A8 bitmap of its own (as clip masks and shadows
+// are built), with the paint's alpha or a shader's
+class BlitMaskA8Bench : public SkBenchmark {
+    SkBitmap    fDst;
+    SkBitmap    fMask;
+    SkPaint     fPaint;
+    SkString    fName;
+public:
+    BlitMaskA8Bench(void* param, U8CPU alpha, bool shader)
+            : INHERITED(param) {
+        fDst.setConfig(SkBitmap::kA8_Config, kRowWidth, kRowCount);
+        fDst.allocPixels();
+        fDst.eraseColor(0);
+        fMask.setConfig(SkBitmap::kA8_Config, kRowWidth, kRowCount);
+        fMask.allocPixels();
+
+        SkRandom rand;
+        for (int y = 0; y < kRowCount; y++) {
+            uint8_t* row = fMask.getAddr8(0, y);
+            for (int x = 0; x < kRowWidth; x++) {
+                row[x] = rand.nextU() & 0xFF;
+            }
+        }
+        if (shader) {
+            fPaint.setShader(new SkColorShader(SkColorSetARGB(alpha, 0, 0,
+                                                              0)))->unref();
+        } else {
+            fPaint.setAlpha(alpha);
+        }
+        fName.printf("blitmask_a8_%02x%s", alpha, shader ? "_shader" : "");
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkCanvas canvas(fDst);
+        canvas.drawBitmap(fMask, 0, 0, &fPaint);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// the color procs, which blend one color over the row (e.g. for drawRect)
+class BlitRowColorBench : public SkBenchmark {
+    SkBlitRow::ColorProc    fProc;
+    SkPMColor               fColor;
+    SkPMColor               fSrc[kRowWidth];
+    SkPMColor               fDst[kRowWidth];
+    SkString                fName;
+public:
+    BlitRowColorBench(void* param, U8CPU alpha) : INHERITED(param) {
+        fProc = SkBlitRow::ColorProcFactory();
+        fColor = SkPreMultiplyARGB(alpha, 0x20, 0x80, 0xE0);
+        fill_src(fSrc, true);
+        sk_memset32(fDst, 0, kRowWidth);
+        fName.printf("blitrow_color32_%02x", alpha);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        for (int i = 0; i < kRowCount; i++) {
+            fProc(fDst, fSrc, kRowWidth, fColor);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// the LCD mask rows that subpixel text blits into 8888
+class BlitRowLCDBench : public SkBenchmark {
+    SkBlitMask::LCD16RowProc    fProc16;
+    SkBlitMask::LCD32RowProc    fProc32;
+    uint16_t                    fMask16[kRowWidth];
+    uint32_t                    fMask32[kRowWidth];
+    SkPMColor                   fDst[kRowWidth];
+    const char*                 fName;
+public:
+    BlitRowLCDBench(void* param, bool lcd32) : INHERITED(param) {
+        fProc16 = lcd32 ? NULL : SkBlitMask::LCD16RowFactory();
+        fProc32 = lcd32 ? SkBlitMask::LCD32RowFactory() : NULL;
+        SkRandom rand;
+        for (int i = 0; i < kRowWidth; i++) {
+            // glyphs have plenty of empty coverage
+            uint32_t m = (i & 3) ? rand.nextU() : 0;
+            fMask16[i] = (uint16_t)m;
+            fMask32[i] = m;
+        }
+        sk_memset32(fDst, SkPackARGB32(0xFF, 0x40, 0x80, 0xC0), kRowWidth);
+        fName = lcd32 ? "blitrow_lcd32" : "blitrow_lcd16";
+    }
+
+protected:
+    virtual const char* onGetName() { return fName; }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkPMColor color = SkPackARGB32(0xFF, 0x20, 0x80, 0xE0);
+        for (int i = 0; i < kRowCount; i++) {
+            if (fProc16) {
+                fProc16(fDst, fMask16, color, kRowWidth);
+            } else {
+                fProc32(fDst, fMask32, color, kRowWidth);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+#define GA32    SkBlitRow::kGlobalAlpha_Flag32
+#define SA32    SkBlitRow::kSrcPixelAlpha_Flag32
+#define GA16    SkBlitRow::kGlobalAlpha_Flag
+#define SA16    SkBlitRow::kSrcPixelAlpha_Flag
+#define DI16    SkBlitRow::kDither_Flag
+
+static SkBenchmark* Fact320(void* p) { return new BlitRow32Bench(p, 0); }
+static SkBenchmark* Fact321(void* p) { return new BlitRow32Bench(p, GA32); }
+static SkBenchmark* Fact322(void* p) { return new BlitRow32Bench(p, SA32); }
+static SkBenchmark* Fact323(void* p) { return new BlitRow32Bench(p, GA32 | SA32); }
+
+static SkBenchmark* Fact160(void* p) { return new BlitRow16Bench(p, 0); }
+static SkBenchmark* Fact161(void* p) { return new BlitRow16Bench(p, GA16); }
+static SkBenchmark* Fact162(void* p) { return new BlitRow16Bench(p, SA16); }
+static SkBenchmark* Fact163(void* p) { return new BlitRow16Bench(p, GA16 | SA16); }
+static SkBenchmark* Fact164(void* p) { return new BlitRow16Bench(p, DI16); }
+static SkBenchmark* Fact165(void* p) { return new BlitRow16Bench(p, SA16 | DI16); }
+static SkBenchmark* Fact166(void* p) { return new BlitRow16Bench(p, GA16 | DI16); }
+static SkBenchmark* Fact167(void* p) { return new BlitRow16Bench(p, GA16 | SA16 | DI16); }
+
+static SkBenchmark* FactM0(void* p) { return new BlitMask16Bench(p, 0xFF336699); }
+static SkBenchmark* FactM1(void* p) { return new BlitMask16Bench(p, 0x80336699); }
+
+static SkBenchmark* FactL0(void* p) { return new BlitRowLCDBench(p, false); }
+static SkBenchmark* FactL1(void* p) { return new BlitRowLCDBench(p, true); }
+
+static SkBenchmark* FactC0(void* p) { return new BlitRowColorBench(p, 0x80); }
+static SkBenchmark* FactC1(void* p) { return new BlitRowColorBench(p, 0xFF); }
+
+static BenchRegistry gReg320(Fact320);
+static BenchRegistry gReg321(Fact321);
+static BenchRegistry gReg322(Fact322);
+static BenchRegistry gReg323(Fact323);
+
+static BenchRegistry gReg160(Fact160);
+static BenchRegistry gReg161(Fact161);
+static BenchRegistry gReg162(Fact162);
+static BenchRegistry gReg163(Fact163);
+static BenchRegistry gReg164(Fact164);
+static BenchRegistry gReg165(Fact165);
+static BenchRegistry gReg166(Fact166);
+static BenchRegistry gReg167(Fact167);
+
+static BenchRegistry gRegM0(FactM0);
+static BenchRegistry gRegM1(FactM1);
+
+static SkBenchmark* FactA0(void* p) { return new BlitMaskA8Bench(p, 0xFF, false); }
+static SkBenchmark* FactA1(void* p) { return new BlitMaskA8Bench(p, 0x80, false); }
+static SkBenchmark* FactA2(void* p) { return new BlitMaskA8Bench(p, 0x80, true); }
+
+static BenchRegistry gRegA0(FactA0);
+static BenchRegistry gRegA1(FactA1);
+static BenchRegistry gRegA2(FactA2);
+
+static BenchRegistry gRegL0(FactL0);
+static BenchRegistry gRegL1(FactL1);
+
+static BenchRegistry gRegC0(FactC0);
+static BenchRegistry gRegC1(FactC1);
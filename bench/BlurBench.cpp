@@ -0,0 +1,90 @@
+#include "SkBenchmark.h"
+#include "SkBlurMask.h"
+#include "SkMask.h"
+#include "SkString.h"
+
+// Calls SkBlurMask::Blur on its own, so that the box/three-pass kernels can
+// be timed per source pixel without the mask filter or the blitter.
+
+enum {
+    kMaskSize = 128
+};
+
+static const char* gStyleName[] = {
+    "normal", "solid", "outer", "inner"
+};
+
+class BlurBench : public SkBenchmark {
+    SkMask              fSrc;
+    SkScalar            fRadius;
+    SkBlurMask::Style   fStyle;
+    SkBlurMask::Quality fQuality;
+    SkString            fName;
+public:
+    BlurBench(void* param, int radius, SkBlurMask::Style style,
+              SkBlurMask::Quality quality) : INHERITED(param) {
+        fRadius = SkIntToScalar(radius);
+        fStyle = style;
+        fQuality = quality;
+
+        // a filled circle, so there are edges to spread and flat parts too
+        fSrc.fFormat = SkMask::kA8_Format;
+        fSrc.fBounds.set(0, 0, kMaskSize, kMaskSize);
+        fSrc.fRowBytes = kMaskSize;
+        fSrc.fImage = SkMask::AllocImage(fSrc.computeImageSize());
+        const int c = kMaskSize / 2;
+        for (int y = 0; y < kMaskSize; y++) {
+            for (int x = 0; x < kMaskSize; x++) {
+                int d2 = (x - c) * (x - c) + (y - c) * (y - c);
+                fSrc.fImage[y * kMaskSize + x] = d2 < c * c * 9 / 16 ? 0xFF : 0;
+            }
+        }
+
+        fName.printf("blurmask_%d_%s_%s", radius, gStyleName[style],
+                     SkBlurMask::kHigh_Quality == quality ? "high" : "low");
+    }
+
+    virtual ~BlurBench() {
+        SkMask::FreeImage(fSrc.fImage);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kMaskSize * kMaskSize; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkMask dst;
+        if (SkBlurMask::Blur(&dst, fSrc, fRadius, fStyle, fQuality)) {
+            SkMask::FreeImage(dst.fImage);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+#define NORMAL  SkBlurMask::kNormal_Style
+#define LOW     SkBlurMask::kLow_Quality
+#define HIGH    SkBlurMask::kHigh_Quality
+
+static SkBenchmark* Fact00(void* p) { return new BlurBench(p, 1, NORMAL, LOW); }
+static SkBenchmark* Fact01(void* p) { return new BlurBench(p, 3, NORMAL, LOW); }
+static SkBenchmark* Fact02(void* p) { return new BlurBench(p, 10, NORMAL, LOW); }
+static SkBenchmark* Fact03(void* p) { return new BlurBench(p, 30, NORMAL, LOW); }
+static SkBenchmark* Fact10(void* p) { return new BlurBench(p, 3, NORMAL, HIGH); }
+static SkBenchmark* Fact11(void* p) { return new BlurBench(p, 10, NORMAL, HIGH); }
+static SkBenchmark* Fact12(void* p) { return new BlurBench(p, 30, NORMAL, HIGH); }
+static SkBenchmark* Fact20(void* p) { return new BlurBench(p, 10, SkBlurMask::kSolid_Style, HIGH); }
+static SkBenchmark* Fact21(void* p) { return new BlurBench(p, 10, SkBlurMask::kOuter_Style, HIGH); }
+static SkBenchmark* Fact22(void* p) { return new BlurBench(p, 10, SkBlurMask::kInner_Style, HIGH); }
+
+static BenchRegistry gReg00(Fact00);
+static BenchRegistry gReg01(Fact01);
+static BenchRegistry gReg02(Fact02);
+static BenchRegistry gReg03(Fact03);
+static BenchRegistry gReg10(Fact10);
+static BenchRegistry gReg11(Fact11);
+static BenchRegistry gReg12(Fact12);
+static BenchRegistry gReg20(Fact20);
+static BenchRegistry gReg21(Fact21);
+static BenchRegistry gReg22(Fact22);
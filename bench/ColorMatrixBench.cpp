@@ -0,0 +1,69 @@
+#include "SkBenchmark.h"
+#include "SkColorMatrixFilter.h"
+#include "SkColorPriv.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// These call SkColorMatrixFilter::filterSpan directly, the way a shader's
+// blitter would, so that its per-pixel cost can be compared.
+
+enum {
+    kSpanWidth = 1024,
+    kSpanCount = 64     // spans filtered per draw
+};
+
+class ColorMatrixBench : public SkBenchmark {
+    SkColorMatrixFilter*    fFilter;
+    SkPMColor               fSrc[kSpanWidth];
+    SkPMColor               fDst[kSpanWidth];
+    SkString                fName;
+public:
+    ColorMatrixBench(void* param, bool general, bool opaque)
+            : INHERITED(param) {
+        SkColorMatrix cm;
+        cm.setSaturation(SK_Scalar1 / 2);
+        if (general) {
+            // makes it change alpha too
+            cm.fMat[18] = SK_Scalar1 * 3 / 4;
+        }
+        fFilter = SkNEW_ARGS(SkColorMatrixFilter, (cm));
+
+        SkRandom rand;
+        for (int i = 0; i < kSpanWidth; i++) {
+            U8CPU a = opaque ? 0xFF : rand.nextU() & 0xFF;
+            fSrc[i] = SkPreMultiplyARGB(a, rand.nextU() & 0xFF,
+                                        rand.nextU() & 0xFF,
+                                        rand.nextU() & 0xFF);
+        }
+
+        fName.printf("colormatrix_%s_%s", general ? "general" : "affine",
+                     opaque ? "opaque" : "alpha");
+    }
+
+    virtual ~ColorMatrixBench() {
+        fFilter->unref();
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kSpanWidth * kSpanCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        for (int i = 0; i < kSpanCount; i++) {
+            fFilter->filterSpan(fSrc, kSpanWidth, fDst);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new ColorMatrixBench(p, false, true); }
+static SkBenchmark* Fact1(void* p) { return new ColorMatrixBench(p, false, false); }
+static SkBenchmark* Fact2(void* p) { return new ColorMatrixBench(p, true, true); }
+static SkBenchmark* Fact3(void* p) { return new ColorMatrixBench(p, true, false); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
+static BenchRegistry gReg3(Fact3);
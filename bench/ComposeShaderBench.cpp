@@ -0,0 +1,92 @@
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkComposeShader.h"
+#include "SkGradientShader.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// A bitmap drawn over (or masked by) a gradient, the way our UI stacks them.
+
+enum {
+    kWidth = 256,
+    kHeight = 256
+};
+
+static const char* gModeNames[] = {
+    "clear", "src", "dst", "srcover", "dstover", "srcin", "dstin",
+    "srcout", "dstout", "srcatop", "dstatop", "xor", "plus", "multiply",
+};
+
+class ComposeShaderBench : public SkBenchmark {
+    SkPaint     fPaint;
+    SkString    fName;
+public:
+    ComposeShaderBench(void* param, SkXfermode::Mode mode, bool opaque)
+            : INHERITED(param) {
+        SkBitmap bm;
+        bm.setConfig(SkBitmap::kARGB_8888_Config, kWidth, kHeight);
+        bm.allocPixels();
+        SkRandom rand;
+        for (int y = 0; y < kHeight; y++) {
+            for (int x = 0; x < kWidth; x++) {
+                U8CPU a = opaque ? 0xFF : rand.nextU() & 0xFF;
+                *bm.getAddr32(x, y) = SkPreMultiplyARGB(a, rand.nextU() & 0xFF,
+                                                        rand.nextU() & 0xFF,
+                                                        rand.nextU() & 0xFF);
+            }
+        }
+        bm.setIsOpaque(opaque);
+        SkShader* shaderA = SkShader::CreateBitmapShader(bm,
+                                                SkShader::kClamp_TileMode,
+                                                SkShader::kClamp_TileMode);
+
+        SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(kWidth), 0 } };
+        SkColor colors[] = { SK_ColorRED, 0x800000FF };
+        SkShader* shaderB = SkGradientShader::CreateLinear(pts, colors, NULL,
+                                            2, SkShader::kClamp_TileMode);
+
+        SkXfermode* xfer = SkXfermode::Create(mode);
+        fPaint.setShader(SkNEW_ARGS(SkComposeShader,
+                                    (shaderA, shaderB, xfer)))->unref();
+        SkSafeUnref(xfer);
+        shaderB->unref();
+        shaderA->unref();
+        if (!opaque) {
+            // and some paint alpha for the shader to scale by
+            fPaint.setAlpha(0x80);
+        }
+
+        SkASSERT((size_t)mode < SK_ARRAY_COUNT(gModeNames));
+        fName.printf("composeshader_%s_%s", gModeNames[mode],
+                     opaque ? "opaque" : "alpha");
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kWidth * kHeight; }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        canvas->drawRect(SkRect::MakeWH(SkIntToScalar(kWidth),
+                                        SkIntToScalar(kHeight)), fPaint);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+template <SkXfermode::Mode mode, bool opaque>
+static SkBenchmark* Fact(void* p) {
+    return new ComposeShaderBench(p, mode, opaque);
+}
+
+static BenchRegistry gReg0(Fact<SkXfermode::kSrcIn_Mode, true>);
+static BenchRegistry gReg1(Fact<SkXfermode::kSrcIn_Mode, false>);
+static BenchRegistry gReg2(Fact<SkXfermode::kDstIn_Mode, true>);
+static BenchRegistry gReg3(Fact<SkXfermode::kDstIn_Mode, false>);
+static BenchRegistry gReg4(Fact<SkXfermode::kMultiply_Mode, true>);
+static BenchRegistry gReg5(Fact<SkXfermode::kMultiply_Mode, false>);
+static BenchRegistry gReg6(Fact<SkXfermode::kSrcOver_Mode, true>);
+static BenchRegistry gReg7(Fact<SkXfermode::kSrcOver_Mode, false>);
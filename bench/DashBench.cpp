@@ -0,0 +1,83 @@
+#include "SkBenchmark.h"
+#include "SkCanvas.h"
+#include "SkDashPathEffect.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkString.h"
+
+// Dashed grid lines, as charts draw them: a few dozen polylines of short
+// segments each. The dashes are made once per draw (or found in the cache,
+// when the path hasn't changed since the last one).
+
+enum {
+    kRows = 40,
+    kSegs = 100
+};
+
+static void make_grid(SkPath* path, SkScalar dy) {
+    path->reset();
+    for (int y = 0; y < kRows; y++) {
+        path->moveTo(0, SkIntToScalar(y * 10) + dy);
+        for (int x = 1; x <= kSegs; x++) {
+            path->lineTo(SkIntToScalar(x * 6),
+                         SkIntToScalar(y * 10 + (x & 1) * 3) + dy);
+        }
+    }
+}
+
+class DashBench : public SkBenchmark {
+    SkPath      fPath;
+    SkPaint     fPaint;
+    SkString    fName;
+    bool        fDraw;
+    bool        fChange;
+    int         fPhase;
+    enum { N = 10 };
+public:
+    DashBench(void* param, bool draw, bool change)
+            : INHERITED(param), fDraw(draw), fChange(change), fPhase(0) {
+        static const SkScalar gIntervals[] = { 3, 3 };
+        fPaint.setStyle(SkPaint::kStroke_Style);
+        fPaint.setPathEffect(new SkDashPathEffect(gIntervals, 2, 0))->unref();
+        make_grid(&fPath, 0);
+        fName.printf("dash_grid_%s%s", draw ? "draw" : "filter",
+                     change ? "_changing" : "");
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkPathEffect* pe = fPaint.getPathEffect();
+        for (int i = 0; i < N; i++) {
+            if (fChange) {
+                // a new path every time, as an animation (or a chart that
+                // is being scrolled) makes them
+                fPhase ^= 1;
+                make_grid(&fPath, SkIntToScalar(fPhase));
+            }
+            if (fDraw) {
+                canvas->drawPath(fPath, fPaint);
+            } else {
+                SkPath dst;
+                SkScalar width = 0;
+                pe->filterPath(&dst, fPath, &width);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new DashBench(p, false, false); }
+static SkBenchmark* Fact1(void* p) { return new DashBench(p, false, true); }
+static SkBenchmark* Fact2(void* p) { return new DashBench(p, true, false); }
+static SkBenchmark* Fact3(void* p) { return new DashBench(p, true, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
+static BenchRegistry gReg3(Fact3);
@@ -47,6 +47,30 @@ private:
     typedef FPSBench INHERITED;
 };
 
+// drawRect goes through the blitter's blitRect, where drawColor doesn't
+class Rect_FPSBench : public FPSBench {
+public:
+    Rect_FPSBench(void* p, SkColor c, const char name[]) : INHERITED(p) {
+        fColor = c;
+        fName = name;
+    }
+
+protected:
+    virtual const char* onGetName() { return fName; }
+    virtual void onDraw(SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setColor(fColor);
+        canvas->drawRect(SkRect::MakeWH(SkIntToScalar(this->width()),
+                                        SkIntToScalar(this->height())), paint);
+    }
+
+private:
+    const char* fName;
+    SkColor     fColor;
+
+    typedef FPSBench INHERITED;
+};
+
 class Bitmap_FPSBench : public FPSBench {
 public:
     Bitmap_FPSBench(void* p, SkBitmap::Config config, bool doOpaque, bool doScale) : INHERITED(p) {
@@ -90,6 +114,7 @@ private:
 
 static SkBenchmark* FillFactory(void* p) { return SkNEW_ARGS(Color_FPSBench, (p, 0xFFFF0000, "fps_fill")); }
 static SkBenchmark* BlendFactory(void* p) { return SkNEW_ARGS(Color_FPSBench, (p, 0x80FF0000, "fps_blend")); }
+static SkBenchmark* RectFactory(void* p) { return SkNEW_ARGS(Rect_FPSBench, (p, 0xFFFF0000, "fps_fill_rect")); }
 static SkBenchmark* BMFactory0(void* p) { return SkNEW_ARGS(Bitmap_FPSBench, (p, SkBitmap::kARGB_8888_Config, false, false)); }
 static SkBenchmark* BMFactory1(void* p) { return SkNEW_ARGS(Bitmap_FPSBench, (p, SkBitmap::kARGB_8888_Config, false, true)); }
 static SkBenchmark* BMFactory2(void* p) { return SkNEW_ARGS(Bitmap_FPSBench, (p, SkBitmap::kARGB_8888_Config, true, false)); }
@@ -99,6 +124,7 @@ static SkBenchmark* BMFactory5(void* p) { return SkNEW_ARGS(Bitmap_FPSBench, (p,
 
 static BenchRegistry gFillReg(FillFactory);
 static BenchRegistry gBlendReg(BlendFactory);
+static BenchRegistry gRectReg(RectFactory);
 static BenchRegistry gBMReg0(BMFactory0);
 static BenchRegistry gBMReg1(BMFactory1);
 static BenchRegistry gBMReg2(BMFactory2);
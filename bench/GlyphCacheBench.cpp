@@ -0,0 +1,115 @@
+#include "SkBenchmark.h"
+#include "SkGlyphCache.h"
+#include "SkPaint.h"
+#include "SkString.h"
+
+// Looks glyphs up in a strike directly, as text measuring and drawing do for
+// every character, after the first draw has filled the strike.
+
+enum {
+    kGlyphCount = 96,   // printable ascii
+    kLoopCount = 10     // passes over the glyphs per draw
+};
+
+// not static, so the compiler can't drop the lookups
+int gGlyphCacheBench_NonStaticGlobal;
+
+class GlyphCacheBench : public SkBenchmark {
+public:
+    enum Lookup {
+        kGlyphIDMetrics_Lookup,
+        kUnicharAdvance_Lookup,
+        kUnicharMetrics_Lookup
+    };
+
+private:
+    SkPaint     fPaint;
+    Lookup      fLookup;
+    uint16_t    fGlyphIDs[kGlyphCount];
+    SkString    fName;
+public:
+    GlyphCacheBench(void* param, Lookup lookup) : INHERITED(param) {
+        fLookup = lookup;
+        fPaint.setTextSize(SkIntToScalar(16));
+
+        char text[kGlyphCount];
+        for (int i = 0; i < kGlyphCount; i++) {
+            text[i] = ' ' + i;
+        }
+        fPaint.textToGlyphs(text, kGlyphCount, fGlyphIDs);
+
+        static const char* gLookupName[] = {
+            "glyphid_metrics", "unichar_advance", "unichar_metrics"
+        };
+        fName.printf("glyphcache_%s", gLookupName[lookup]);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kGlyphCount * kLoopCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkAutoGlyphCache autoCache(fPaint, NULL);
+        SkGlyphCache* cache = autoCache.getCache();
+
+        SkFixed sum = 0;
+        for (int n = 0; n < kLoopCount; n++) {
+            for (int i = 0; i < kGlyphCount; i++) {
+                switch (fLookup) {
+                    case kGlyphIDMetrics_Lookup:
+                        sum += cache->getGlyphIDMetrics(fGlyphIDs[i]).fAdvanceX;
+                        break;
+                    case kUnicharAdvance_Lookup:
+                        sum += cache->getUnicharAdvance(' ' + i).fAdvanceX;
+                        break;
+                    case kUnicharMetrics_Lookup:
+                        sum += cache->getUnicharMetrics(' ' + i).fAdvanceX;
+                        break;
+                }
+            }
+        }
+        gGlyphCacheBench_NonStaticGlobal += sum;
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// finding the strike for a paint, which every drawText does once
+class GlyphCacheDetachBench : public SkBenchmark {
+    SkPaint fPaint;
+public:
+    GlyphCacheDetachBench(void* param) : INHERITED(param) {
+        fPaint.setTextSize(SkIntToScalar(16));
+    }
+
+protected:
+    virtual const char* onGetName() { return "glyphcache_detach_attach"; }
+    virtual int onGetUnitsPerDraw() { return kGlyphCount * kLoopCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        for (int i = 0; i < kGlyphCount * kLoopCount; i++) {
+            SkAutoGlyphCache autoCache(fPaint, NULL);
+            gGlyphCacheBench_NonStaticGlobal += NULL != autoCache.getCache();
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) {
+    return new GlyphCacheBench(p, GlyphCacheBench::kGlyphIDMetrics_Lookup);
+}
+static SkBenchmark* Fact1(void* p) {
+    return new GlyphCacheBench(p, GlyphCacheBench::kUnicharAdvance_Lookup);
+}
+static SkBenchmark* Fact2(void* p) {
+    return new GlyphCacheBench(p, GlyphCacheBench::kUnicharMetrics_Lookup);
+}
+static SkBenchmark* Fact3(void* p) { return new GlyphCacheDetachBench(p); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
+static BenchRegistry gReg3(Fact3);
@@ -0,0 +1,73 @@
+#include "SkBenchmark.h"
+#include "SkCanvas.h"
+#include "SkLayer.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// content that is worth caching: a pile of antialiased circles
+class CirclesLayer : public SkLayer {
+public:
+    CirclesLayer(uint32_t seed) : fSeed(seed) {
+        this->setSize(SkIntToScalar(128), SkIntToScalar(96));
+    }
+
+protected:
+    virtual void onDraw(SkCanvas* canvas, SkScalar opacity) {
+        SkRandom rand(fSeed);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 50; i++) {
+            paint.setColor(rand.nextU() | 0xFF000000);
+            paint.setAlpha(SkScalarRound(SkScalarMul(opacity, 255)));
+            canvas->drawCircle(SkIntToScalar(rand.nextU() % 128),
+                               SkIntToScalar(rand.nextU() % 96),
+                               SkIntToScalar(4 + rand.nextU() % 16), paint);
+        }
+    }
+
+private:
+    uint32_t fSeed;
+};
+
+/*  A few layers that move around (and fade) from one frame to the next,
+    without their content changing, so a cached layer is just composited.
+ */
+class LayerBench : public SkBenchmark {
+    enum { N = 8, FRAMES = 10 };
+    SkLayer     fRoot;
+    SkString    fName;
+public:
+    LayerBench(void* param, bool cached) : INHERITED(param) {
+        for (int i = 0; i < N; i++) {
+            SkLayer* layer = new CirclesLayer(i);
+            layer->setCachingContent(cached);
+            fRoot.addChild(layer)->unref();
+        }
+        fName.printf("layer_animate_%s", cached ? "cached" : "uncached");
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int frame = 0; frame < FRAMES; frame++) {
+            for (int i = 0; i < N; i++) {
+                SkLayer* layer = fRoot.getChild(i);
+                layer->setPosition(SkIntToScalar(i * 60 + frame * 3),
+                                   SkIntToScalar(i * 40 + frame * 2));
+                layer->setOpacity(SK_Scalar1 - SkIntToScalar(frame) / 20);
+            }
+            fRoot.draw(canvas);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new LayerBench(p, false); }
+static SkBenchmark* Fact1(void* p) { return new LayerBench(p, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
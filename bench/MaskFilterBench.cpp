@@ -0,0 +1,86 @@
+#include "SkBenchmark.h"
+#include "SkBlurMaskFilter.h"
+#include "SkKernel33MaskFilter.h"
+#include "SkMask.h"
+#include "SkMatrix.h"
+#include "SkString.h"
+#include "SkTableMaskFilter.h"
+
+// Calls the mask filters' filterMask() on their own, so that they can be
+// timed per source pixel without the rasterizer or the blitter.
+
+enum {
+    kMaskSize = 128
+};
+
+class MaskFilterBench : public SkBenchmark {
+    SkMask          fSrc;
+    SkMaskFilter*   fFilter;
+    SkString        fName;
+public:
+    MaskFilterBench(void* param, SkMaskFilter* filter, const char name[])
+            : INHERITED(param), fFilter(filter) {
+        // a filled circle, so there are edges to light and flat parts too
+        fSrc.fFormat = SkMask::kA8_Format;
+        fSrc.fBounds.set(0, 0, kMaskSize, kMaskSize);
+        fSrc.fRowBytes = kMaskSize;
+        fSrc.fImage = SkMask::AllocImage(fSrc.computeImageSize());
+        const int c = kMaskSize / 2;
+        for (int y = 0; y < kMaskSize; y++) {
+            for (int x = 0; x < kMaskSize; x++) {
+                int d2 = (x - c) * (x - c) + (y - c) * (y - c);
+                fSrc.fImage[y * kMaskSize + x] = d2 < c * c * 9 / 16 ? 0xFF : 0;
+            }
+        }
+
+        fName.printf("maskfilter_%s", name);
+    }
+
+    virtual ~MaskFilterBench() {
+        SkMask::FreeImage(fSrc.fImage);
+        fFilter->unref();
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kMaskSize * kMaskSize; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkMask dst;
+        dst.fImage = NULL;
+        SkIPoint margin;
+        if (fFilter->filterMask(&dst, fSrc, SkMatrix::I(), &margin)) {
+            SkMask::FreeImage(dst.fImage);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) {
+    static const int gSharpen[3][3] = {
+        { -1, -1, -1 }, { -1, 9, -1 }, { -1, -1, -1 },
+    };
+    return new MaskFilterBench(p, new SkKernel33MaskFilter(gSharpen, 0),
+                               "kernel33");
+}
+
+static SkBenchmark* Fact1(void* p) {
+    static const SkScalar gDirection[] = {
+        SK_Scalar1, SK_Scalar1, SK_Scalar1
+    };
+    return new MaskFilterBench(p, SkBlurMaskFilter::CreateEmboss(gDirection,
+                                        SK_Scalar1 / 4, SkIntToScalar(4),
+                                        SkIntToScalar(3)),
+                               "emboss");
+}
+
+static SkBenchmark* Fact2(void* p) {
+    return new MaskFilterBench(p, SkTableMaskFilter::CreateGamma(SkFloatToScalar(1.4f)),
+                               "table_gamma");
+}
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
@@ -0,0 +1,77 @@
+#include "SkAsyncNWayCanvas.h"
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkNWayCanvas.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+
+// draws the same antialiased scene into three raster canvases, one after
+// another through SkNWayCanvas, or at once through SkAsyncNWayCanvas
+class NWayCanvasBench : public SkBenchmark {
+    enum {
+        kTargets = 3,
+        kW = 320,
+        kH = 240,
+        N = 300
+    };
+    SkBitmap            fBitmaps[kTargets];
+    SkNWayCanvas        fNWay;
+    SkAsyncNWayCanvas   fAsyncNWay;
+    bool                fAsync;
+public:
+    NWayCanvasBench(void* param, bool async) : INHERITED(param) {
+        fAsync = async;
+        for (int i = 0; i < kTargets; i++) {
+            fBitmaps[i].setConfig(SkBitmap::kARGB_8888_Config, kW, kH);
+            fBitmaps[i].allocPixels();
+            SkCanvas* canvas = new SkCanvas(fBitmaps[i]);
+            if (async) {
+                fAsyncNWay.addCanvas(canvas);
+            } else {
+                fNWay.addCanvas(canvas);
+            }
+            canvas->unref();
+        }
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fAsync ? "nway_canvas_async" : "nway_canvas_serial";
+    }
+
+    void drawScene(SkCanvas* canvas) {
+        SkRandom rand;
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < N; i++) {
+            SkScalar x = rand.nextUScalar1() * kW;
+            SkScalar y = rand.nextUScalar1() * kH;
+            SkScalar r = rand.nextUScalar1() * 40 + 4;
+            SkPath path;
+            path.addCircle(x, y, r);
+            path.addOval(SkRect::MakeXYWH(x - r, y - r / 2, 2 * r, r));
+            paint.setColor(rand.nextU() | 0x80000000);
+            canvas->drawPath(path, paint);
+        }
+    }
+
+    virtual void onDraw(SkCanvas*) {
+        if (fAsync) {
+            this->drawScene(fAsyncNWay.beginRecording());
+            fAsyncNWay.endRecording();
+        } else {
+            this->drawScene(&fNWay);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new NWayCanvasBench(p, false); }
+static SkBenchmark* Fact1(void* p) { return new NWayCanvasBench(p, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
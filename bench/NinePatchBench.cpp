@@ -0,0 +1,50 @@
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkNinePatch.h"
+#include "SkPaint.h"
+
+// a screen full of buttons of the same size, like a UI draws every frame
+class NinePatchBench : public SkBenchmark {
+    enum { N = 100 };
+    SkBitmap    fBitmap;
+    SkIRect     fMargins;
+    bool        fRetained;
+public:
+    NinePatchBench(void* param, bool retained) : INHERITED(param) {
+        fRetained = retained;
+        fBitmap.setConfig(SkBitmap::kARGB_8888_Config, 24, 24);
+        fBitmap.allocPixels();
+        fBitmap.eraseColor(0xC0408040);
+        fMargins.set(8, 8, 8, 8);
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fRetained ? "ninepatch_retained" : "ninepatch_drawnine";
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkNinePatch patch(fBitmap, fMargins);
+        for (int i = 0; i < N; i++) {
+            SkRect dst = SkRect::MakeXYWH(SkIntToScalar(i % 10 * 64),
+                                          SkIntToScalar(i / 10 * 48),
+                                          SkIntToScalar(60),
+                                          SkIntToScalar(40));
+            if (fRetained) {
+                patch.draw(canvas, dst);
+            } else {
+                SkNinePatch::DrawNine(canvas, dst, fBitmap, fMargins);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new NinePatchBench(p, false); }
+static SkBenchmark* Fact1(void* p) { return new NinePatchBench(p, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
@@ -3,19 +3,23 @@
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
 #include "SkPaint.h"
+#include "SkParsePath.h"
 #include "SkRandom.h"
 #include "SkShader.h"
 #include "SkString.h"
 
 enum Flags {
-    kStroke_Flag = 1 << 0,
-    kBig_Flag    = 1 << 1
+    kStroke_Flag    = 1 << 0,
+    kBig_Flag       = 1 << 1,
+    kAnalytic_Flag  = 1 << 2
 };
 
 #define FLAGS00  Flags(0)
 #define FLAGS01  Flags(kStroke_Flag)
 #define FLAGS10  Flags(kBig_Flag)
 #define FLAGS11  Flags(kStroke_Flag | kBig_Flag)
+#define FLAGSA00 Flags(kAnalytic_Flag)
+#define FLAGSA10 Flags(kAnalytic_Flag | kBig_Flag)
 
 class PathBench : public SkBenchmark {
     SkPaint     fPaint;
@@ -39,6 +43,9 @@ protected:
         fName.printf("path_%s_%s_",
                      fFlags & kStroke_Flag ? "stroke" : "fill",
                      fFlags & kBig_Flag ? "big" : "small");
+        if (fFlags & kAnalytic_Flag) {
+            fName.append("analytic_");
+        }
         this->appendName(&fName);
         return fName.c_str();
     }
@@ -46,6 +53,7 @@ protected:
     virtual void onDraw(SkCanvas* canvas) {
         SkPaint paint(fPaint);
         this->setupPaint(&paint);
+        paint.setAnalyticAA(SkToBool(fFlags & kAnalytic_Flag));
 
         SkPath path;
         this->makePath(&path);
@@ -177,6 +185,81 @@ private:
 
 
 
+// Builds, copies and throws away small paths, which is mostly the cost of
+// their storage.
+class PathCreateBench : public SkBenchmark {
+    enum { N = 10000 };
+public:
+    PathCreateBench(void* param) : INHERITED(param) {}
+
+protected:
+    virtual const char* onGetName() {
+        return "path_create_small";
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int i = 0; i < N; i++) {
+            SkPath path;
+            path.moveTo(0, 0);
+            path.lineTo(SkIntToScalar(i & 7), SkIntToScalar(10));
+            path.lineTo(SkIntToScalar(10), SkIntToScalar(i & 3));
+            path.close();
+            SkPath copy(path);
+            copy.addRect(0, 0, SkIntToScalar(4), SkIntToScalar(4));
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// Parses a long SVG path string of the kind map tiles are made of: mostly
+// relative lines and curves, with short decimal coordinates.
+class PathParseBench : public SkBenchmark {
+    enum { N = 20, SEGMENTS = 1000 };
+    SkString fData;
+public:
+    PathParseBench(void* param) : INHERITED(param) {
+        SkRandom rand;
+        fData.set("M10.5,20.25");
+        for (int i = 0; i < SEGMENTS; i++) {
+            SkScalar v[6];
+            for (int j = 0; j < 6; j++) {
+                v[j] = SkIntToScalar((int)(rand.nextU() % 20001) - 10000) / 100;
+            }
+            switch (i % 4) {
+                case 0:
+                case 1:
+                    fData.appendf("l%g,%g", v[0], v[1]);
+                    break;
+                case 2:
+                    fData.appendf("c%g %g %g %g %g %g", v[0], v[1], v[2], v[3],
+                                  v[4], v[5]);
+                    break;
+                case 3:
+                    fData.appendf("H%g V%g", v[0], v[1]);
+                    break;
+            }
+        }
+        fData.append("z");
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return "path_parse_svg";
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int i = 0; i < N; i++) {
+            SkPath path;
+            SkParsePath::FromSVGString(fData.c_str(), &path);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 static SkBenchmark* FactT00(void* p) { return new TrianglePathBench(p, FLAGS00); }
 static SkBenchmark* FactT01(void* p) { return new TrianglePathBench(p, FLAGS01); }
 static SkBenchmark* FactT10(void* p) { return new TrianglePathBench(p, FLAGS10); }
@@ -192,6 +275,9 @@ static SkBenchmark* FactO01(void* p) { return new OvalPathBench(p, FLAGS01); }
 static SkBenchmark* FactO10(void* p) { return new OvalPathBench(p, FLAGS10); }
 static SkBenchmark* FactO11(void* p) { return new OvalPathBench(p, FLAGS11); }
 
+static SkBenchmark* FactOA00(void* p) { return new OvalPathBench(p, FLAGSA00); }
+static SkBenchmark* FactOA10(void* p) { return new OvalPathBench(p, FLAGSA10); }
+
 static SkBenchmark* FactS00(void* p) { return new SawToothPathBench(p, FLAGS00); }
 static SkBenchmark* FactS01(void* p) { return new SawToothPathBench(p, FLAGS01); }
 
@@ -201,6 +287,12 @@ static SkBenchmark* FactLC00(void* p) {
 static SkBenchmark* FactLC01(void* p) {
     return new LongCurvedPathBench(p, FLAGS01);
 }
+static SkBenchmark* FactLCA00(void* p) {
+    return new LongCurvedPathBench(p, FLAGSA00);
+}
+
+static SkBenchmark* FactPC(void* p) { return new PathCreateBench(p); }
+static SkBenchmark* FactPP(void* p) { return new PathParseBench(p); }
 
 static BenchRegistry gRegT00(FactT00);
 static BenchRegistry gRegT01(FactT01);
@@ -216,10 +308,14 @@ static BenchRegistry gRegO00(FactO00);
 static BenchRegistry gRegO01(FactO01);
 static BenchRegistry gRegO10(FactO10);
 static BenchRegistry gRegO11(FactO11);
+static BenchRegistry gRegOA00(FactOA00);
+static BenchRegistry gRegOA10(FactOA10);
 
 static BenchRegistry gRegS00(FactS00);
 static BenchRegistry gRegS01(FactS01);
 
 static BenchRegistry gRegLC00(FactLC00);
 static BenchRegistry gRegLC01(FactLC01);
-
+static BenchRegistry gRegLCA00(FactLCA00);
+static BenchRegistry gRegPC(FactPC);
+static BenchRegistry gRegPP(FactPP);
@@ -0,0 +1,71 @@
+#include "SkBenchmark.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPicture.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// Draws a tree of small pictures, four levels deep, each holding a few rects
+// and the pictures below it, as content built from cached sub-pictures is.
+class PictureNestBench : public SkBenchmark {
+    enum {
+        N = 10,
+        kDepth = 4,
+        kFanOut = 3
+    };
+    SkString    fName;
+    SkPicture   fPictures[kDepth];
+    SkPicture   fRoot;
+public:
+    PictureNestBench(void* param, bool inlined) : INHERITED(param) {
+        fName.printf("picture_nest_%s", inlined ? "inlined" : "referenced");
+
+        SkRandom rand;
+        for (int i = 0; i < kDepth; i++) {
+            SkCanvas* canvas = fPictures[i].beginRecording(64, 64);
+            SkPaint paint;
+            for (int j = 0; j < 3; j++) {
+                paint.setColor(rand.nextU() | 0xFF000000);
+                canvas->drawRect(SkRect::MakeXYWH(rand.nextUScalar1() * 48,
+                                                  rand.nextUScalar1() * 48,
+                                                  SkIntToScalar(16),
+                                                  SkIntToScalar(16)), paint);
+            }
+            if (i > 0) {
+                for (int j = 0; j < kFanOut; j++) {
+                    canvas->save();
+                    canvas->translate(SkIntToScalar(j * 4), 0);
+                    canvas->drawPicture(fPictures[i - 1]);
+                    canvas->restore();
+                }
+            }
+            fPictures[i].endRecording();
+        }
+
+        uint32_t flags = inlined ?
+                SkPicture::kInlineSmallPictures_RecordingFlag : 0;
+        fRoot.beginRecording(64, 64, flags)->drawPicture(
+                fPictures[kDepth - 1]);
+        fRoot.endRecording();
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int i = 0; i < N; i++) {
+            fRoot.draw(canvas);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new PictureNestBench(p, false); }
+static SkBenchmark* Fact1(void* p) { return new PictureNestBench(p, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
@@ -0,0 +1,70 @@
+#include "SkBenchmark.h"
+#include "SkBlurMaskFilter.h"
+#include "SkCanvas.h"
+#include "SkLayerRasterizer.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkString.h"
+
+// A path drawn through an SkLayerRasterizer with the layers that text effects
+// stack up: two outlines (offset from each other), a shadow and a fill.
+
+class LayerRasterizerBench : public SkBenchmark {
+    SkPath      fPath;
+    SkPaint     fPaint;
+    SkString    fName;
+    enum { N = 10 };
+public:
+    LayerRasterizerBench(void* param, bool shadow)
+            : INHERITED(param) {
+        fPath.addCircle(SkIntToScalar(60), SkIntToScalar(60),
+                        SkIntToScalar(40));
+        fPath.addRoundRect(SkRect::MakeXYWH(SkIntToScalar(20), SkIntToScalar(110),
+                                            SkIntToScalar(160), SkIntToScalar(40)),
+                           SkIntToScalar(8), SkIntToScalar(8));
+
+        SkLayerRasterizer* rast = new SkLayerRasterizer;
+        SkPaint p;
+        p.setAntiAlias(true);
+        p.setStyle(SkPaint::kStroke_Style);
+        p.setStrokeWidth(SkIntToScalar(6));
+        p.setAlpha(0x60);
+        rast->addLayer(p);
+        if (shadow) {
+            SkPaint s;
+            s.setAntiAlias(true);
+            s.setAlpha(0x80);
+            s.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(2),
+                            SkBlurMaskFilter::kNormal_BlurStyle))->unref();
+            rast->addLayer(s, SkIntToScalar(3), SkIntToScalar(3));
+        }
+        p.setAlpha(0xFF);
+        rast->addLayer(p, SK_Scalar1, SK_Scalar1);
+        p.setStyle(SkPaint::kFill_Style);
+        rast->addLayer(p);
+
+        fPaint.setAntiAlias(true);
+        fPaint.setRasterizer(rast)->unref();
+        fName.printf("layer_rasterizer%s", shadow ? "_shadow" : "");
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int i = 0; i < N; i++) {
+            canvas->drawPath(fPath, fPaint);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new LayerRasterizerBench(p, false); }
+static SkBenchmark* Fact1(void* p) { return new LayerRasterizerBench(p, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
@@ -121,6 +121,47 @@ protected:
     virtual const char* onGetName() { return fName; }
 };
 
+// a chart's line, hairline or antialiased, most of which is scrolled off to
+// the sides of the canvas, as lines or as one polygon
+class ChartBench : public SkBenchmark {
+    enum {
+        W = 640,
+        H = 480,
+        N = 20000
+    };
+    SkPoint             fPts[N];
+    SkCanvas::PointMode fMode;
+    bool                fAA;
+    SkString            fName;
+public:
+    ChartBench(void* param, SkCanvas::PointMode mode, bool aa)
+            : INHERITED(param), fMode(mode), fAA(aa) {
+        SkRandom rand;
+        SkScalar y = SkIntToScalar(H / 2);
+        for (int i = 0; i < N; i++) {
+            y += rand.nextSScalar1() * 8;
+            y = SkScalarPin(y, 0, SkIntToScalar(H));
+            fPts[i].set(SkIntToScalar(i - N / 2) / 4, y);
+        }
+        fName.printf("chart_%s%s",
+                     SkCanvas::kLines_PointMode == mode ? "lines" : "polygon",
+                     aa ? "_aa" : "");
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual void onDraw(SkCanvas* canvas) {
+        SkPaint paint;
+        this->setupPaint(&paint);
+        paint.setAntiAlias(fAA);
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawPoints(fMode, N, fPts, paint);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 /*******************************************************************************
  * to bench BlitMask [Opaque, Black, color, shader]
  *******************************************************************************/
@@ -220,6 +261,15 @@ static SkBenchmark* PolygonFactory(void* p) {
 
 /* init the blitmask bench
  */
+static SkBenchmark* ChartLinesFactory(void* p) {
+    return SkNEW_ARGS(ChartBench, (p, SkCanvas::kLines_PointMode, false));
+}
+static SkBenchmark* ChartPolygonFactory(void* p) {
+    return SkNEW_ARGS(ChartBench, (p, SkCanvas::kPolygon_PointMode, false));
+}
+static SkBenchmark* ChartPolygonAAFactory(void* p) {
+    return SkNEW_ARGS(ChartBench, (p, SkCanvas::kPolygon_PointMode, true));
+}
 static SkBenchmark* BlitMaskOpaqueFactory(void* p) {
     return SkNEW_ARGS(BlitMaskBench,
                       (p, SkCanvas::kPoints_PointMode,
@@ -256,6 +306,9 @@ static BenchRegistry gRRectReg2(RRectFactory2);
 static BenchRegistry gPointsReg(PointsFactory);
 static BenchRegistry gLinesReg(LinesFactory);
 static BenchRegistry gPolygonReg(PolygonFactory);
+static BenchRegistry gChartLinesReg(ChartLinesFactory);
+static BenchRegistry gChartPolygonReg(ChartPolygonFactory);
+static BenchRegistry gChartPolygonAAReg(ChartPolygonAAFactory);
 static BenchRegistry gRectRegOpaque(BlitMaskOpaqueFactory);
 static BenchRegistry gRectRegBlack(BlitMaskBlackFactory);
 static BenchRegistry gRectRegColor(BlitMaskColorFactory);
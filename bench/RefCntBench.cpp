@@ -0,0 +1,77 @@
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorShader.h"
+#include "SkPaint.h"
+#include "SkPicture.h"
+#include "SkRefCnt.h"
+
+class RefCntBench : public SkBenchmark {
+    enum { N = 100000 };
+public:
+    RefCntBench(void* param) : INHERITED(param) {}
+
+protected:
+    virtual const char* onGetName() {
+        return "ref_cnt_inc_dec";
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkRefCnt ref;
+        for (int i = 0; i < N; i++) {
+            ref.ref();
+            ref.ref();
+            ref.unref();
+            ref.unref();
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// Every draw here copies a paint with a shader, and the scaled bitmaps get
+// shaders of their own, so playback spends much of its time in ref/unref.
+class RefPictureBench : public SkBenchmark {
+    enum { N = 200 };
+    SkPicture   fPicture;
+public:
+    RefPictureBench(void* param) : INHERITED(param) {
+        SkBitmap bm;
+        bm.setConfig(SkBitmap::kARGB_8888_Config, 4, 4);
+        bm.allocPixels();
+        bm.eraseColor(SK_ColorGREEN);
+
+        SkPaint paint;
+        paint.setShader(SkNEW_ARGS(SkColorShader, (SK_ColorBLUE)))->unref();
+
+        SkCanvas* canvas = fPicture.beginRecording(64, 64);
+        for (int i = 0; i < N; i++) {
+            SkRect r = SkRect::MakeXYWH(SkIntToScalar(i % 60),
+                                        SkIntToScalar(i % 50),
+                                        SkIntToScalar(4), SkIntToScalar(8));
+            SkIRect src = SkIRect::MakeWH(4, 4);
+            canvas->drawRect(r, paint);
+            canvas->drawBitmapRect(bm, &src, r, &paint);
+        }
+        fPicture.endRecording();
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return "ref_cnt_picture_playback";
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        fPicture.draw(canvas);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new RefCntBench(p); }
+static SkBenchmark* Fact1(void* p) { return new RefPictureBench(p); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
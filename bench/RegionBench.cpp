@@ -0,0 +1,104 @@
+#include "SkBenchmark.h"
+#include "SkRandom.h"
+#include "SkRegion.h"
+#include "SkString.h"
+
+// Combines two regions of many runs with each op, as clipping to complex
+// (e.g. window-manager) regions would.
+
+enum {
+    kRectCount = 100,
+    kOpCount = 100      // ops per draw
+};
+
+static const char* gOpName[] = {
+    "difference", "intersect", "union", "xor", "reversedifference", "replace"
+};
+
+static void make_region(SkRegion* rgn, SkRandom* rand) {
+    rgn->setEmpty();
+    for (int i = 0; i < kRectCount; i++) {
+        SkIRect r;
+        r.fLeft = rand->nextU() % 1000;
+        r.fTop = rand->nextU() % 1000;
+        r.fRight = r.fLeft + 1 + rand->nextU() % 100;
+        r.fBottom = r.fTop + 1 + rand->nextU() % 100;
+        rgn->op(r, SkRegion::kUnion_Op);
+    }
+}
+
+class RegionOpBench : public SkBenchmark {
+    SkRegion        fA, fB;
+    SkRegion::Op    fOp;
+    SkString        fName;
+public:
+    RegionOpBench(void* param, SkRegion::Op op) : INHERITED(param) {
+        fOp = op;
+        SkRandom rand;
+        make_region(&fA, &rand);
+        make_region(&fB, &rand);
+        fName.printf("region_%s", gOpName[op]);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kOpCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        SkRegion result;
+        for (int i = 0; i < kOpCount; i++) {
+            result.op(fA, fB, fOp);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// not static, so the compiler can't drop the lookups
+int gRegionBench_NonStaticGlobal;
+
+// hit-testing a complex region, which the clip does for every rect it sees
+class RegionContainsBench : public SkBenchmark {
+    SkRegion        fA;
+    SkIRect         fRects[kOpCount];
+public:
+    RegionContainsBench(void* param) : INHERITED(param) {
+        SkRandom rand;
+        make_region(&fA, &rand);
+        for (int i = 0; i < kOpCount; i++) {
+            int x = rand.nextU() % 1000;
+            int y = rand.nextU() % 1000;
+            fRects[i].set(x, y, x + 10, y + 10);
+        }
+    }
+
+protected:
+    virtual const char* onGetName() { return "region_contains_rect"; }
+    virtual int onGetUnitsPerDraw() { return kOpCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        int count = 0;
+        for (int i = 0; i < kOpCount; i++) {
+            count += fA.contains(fRects[i]);
+        }
+        gRegionBench_NonStaticGlobal += count;
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new RegionOpBench(p, SkRegion::kDifference_Op); }
+static SkBenchmark* Fact1(void* p) { return new RegionOpBench(p, SkRegion::kIntersect_Op); }
+static SkBenchmark* Fact2(void* p) { return new RegionOpBench(p, SkRegion::kUnion_Op); }
+static SkBenchmark* Fact3(void* p) { return new RegionOpBench(p, SkRegion::kXOR_Op); }
+static SkBenchmark* Fact4(void* p) { return new RegionOpBench(p, SkRegion::kReverseDifference_Op); }
+static SkBenchmark* Fact5(void* p) { return new RegionContainsBench(p); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
+static BenchRegistry gReg3(Fact3);
+static BenchRegistry gReg4(Fact4);
+static BenchRegistry gReg5(Fact5);
@@ -0,0 +1,70 @@
+#include "SkBenchmark.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPicture.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// Fades each of a grid of views, as a UI toolkit does, with a saveLayerAlpha
+// around the one draw that each view makes. The draws are made directly, or
+// recorded into a picture and played back. The layers are as big as the
+// canvas, unless they are bounded by their view.
+class SaveLayerBench : public SkBenchmark {
+    enum {
+        N = 20,
+        kViews = 40
+    };
+    SkString    fName;
+    bool        fPicture;
+    bool        fBounded;
+    SkPicture   fRecording;
+public:
+    SaveLayerBench(void* param, bool picture, bool bounded)
+        : INHERITED(param), fPicture(picture), fBounded(bounded) {
+        fName.printf("savelayer_alpha_%s%s", picture ? "picture" : "canvas",
+                     bounded ? "_bounded" : "");
+        this->drawViews(fRecording.beginRecording(640, 480));
+        fRecording.endRecording();
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int i = 0; i < N; i++) {
+            if (fPicture) {
+                fRecording.draw(canvas);
+            } else {
+                this->drawViews(canvas);
+            }
+        }
+    }
+
+private:
+    void drawViews(SkCanvas* canvas) {
+        SkRandom rand;
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < kViews; i++) {
+            SkRect r = SkRect::MakeXYWH(SkIntToScalar((i % 8) * 80),
+                                        SkIntToScalar((i / 8) * 96),
+                                        SkIntToScalar(72), SkIntToScalar(88));
+            paint.setColor(rand.nextU() | 0xFF000000);
+            canvas->saveLayerAlpha(fBounded ? &r : NULL, 0x20 + (i * 5));
+            canvas->drawRect(r, paint);
+            canvas->restore();
+        }
+    }
+
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new SaveLayerBench(p, false, false); }
+static SkBenchmark* Fact1(void* p) { return new SaveLayerBench(p, true, false); }
+static SkBenchmark* Fact2(void* p) { return new SaveLayerBench(p, false, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
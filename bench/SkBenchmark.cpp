@@ -20,6 +20,10 @@ SkIPoint SkBenchmark::getSize() {
     return this->onGetSize();
 }
 
+int SkBenchmark::getUnitsPerDraw() {
+    return this->onGetUnitsPerDraw();
+}
+
 void SkBenchmark::draw(SkCanvas* canvas) {
     this->onDraw(canvas);
 }
@@ -25,6 +25,11 @@ public:
     const char* getName();
     SkIPoint getSize();
     void draw(SkCanvas*);
+
+    /** Return how many pixels (or ops) one draw() processes, so that kernel
+        benches can be reported per unit; 0 if the bench doesn't count them.
+    */
+    int getUnitsPerDraw();
     
     void setForceAlpha(int alpha) {
         fForceAlpha = alpha;
@@ -66,6 +71,7 @@ protected:
     virtual void onDraw(SkCanvas*) = 0;
 
     virtual SkIPoint onGetSize();
+    virtual int onGetUnitsPerDraw() { return 0; }
 
 private:
     const SkTDict<const char*>* fDict;
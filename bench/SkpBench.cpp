@@ -0,0 +1,292 @@
+#include "SkpBench.h"
+#include "SkOSFile.h"
+#include "SkPicture.h"
+#include "SkProxyCanvas.h"
+#include "SkStream.h"
+#include "BenchTimer.h"
+
+namespace {
+
+enum OpType {
+    kSave_OpType,       // save and restore
+    kSaveLayer_OpType,
+    kMatrix_OpType,
+    kClip_OpType,
+    kDrawPaint_OpType,
+    kDrawPoints_OpType,
+    kDrawRect_OpType,
+    kDrawPath_OpType,
+    kDrawBitmap_OpType, // all of the bitmap and sprite draws
+    kDrawText_OpType,   // all of the text draws
+    kDrawPicture_OpType,
+    kDrawVertices_OpType,
+    kDrawData_OpType,
+
+    kOpTypeCount
+};
+
+static const char* gOpTypeName[] = {
+    "save/restore", "saveLayer", "matrix", "clip", "drawPaint", "drawPoints",
+    "drawRect", "drawPath", "drawBitmap", "drawText", "drawPicture",
+    "drawVertices", "drawData"
+};
+
+/*  Passes every call on to the real canvas, adding up the time each kind
+    of op takes there.
+ */
+class OpTimingCanvas : public SkProxyCanvas {
+public:
+    OpTimingCanvas(SkCanvas* proxy) : INHERITED(proxy), fTimer(false) {
+        SkASSERT(SK_ARRAY_COUNT(gOpTypeName) == kOpTypeCount);
+        for (int i = 0; i < kOpTypeCount; i++) {
+            fCount[i] = 0;
+            fMSecs[i] = 0;
+        }
+    }
+
+    int     fCount[kOpTypeCount];
+    double  fMSecs[kOpTypeCount];
+
+    class AutoTime {
+    public:
+        AutoTime(OpTimingCanvas* canvas, OpType type)
+                : fCanvas(canvas), fType(type) {
+            fCanvas->fTimer.start();
+        }
+        ~AutoTime() {
+            fCanvas->fTimer.end();
+            fCanvas->fCount[fType] += 1;
+            fCanvas->fMSecs[fType] += fCanvas->fTimer.fWall;
+        }
+    private:
+        OpTimingCanvas* fCanvas;
+        OpType          fType;
+    };
+
+    virtual int save(SaveFlags flags) {
+        AutoTime at(this, kSave_OpType);
+        return INHERITED::save(flags);
+    }
+    virtual int saveLayer(const SkRect* bounds, const SkPaint* paint,
+                          SaveFlags flags) {
+        AutoTime at(this, kSaveLayer_OpType);
+        return INHERITED::saveLayer(bounds, paint, flags);
+    }
+    virtual void restore() {
+        AutoTime at(this, kSave_OpType);
+        INHERITED::restore();
+    }
+
+    virtual bool translate(SkScalar dx, SkScalar dy) {
+        AutoTime at(this, kMatrix_OpType);
+        return INHERITED::translate(dx, dy);
+    }
+    virtual bool scale(SkScalar sx, SkScalar sy) {
+        AutoTime at(this, kMatrix_OpType);
+        return INHERITED::scale(sx, sy);
+    }
+    virtual bool rotate(SkScalar degrees) {
+        AutoTime at(this, kMatrix_OpType);
+        return INHERITED::rotate(degrees);
+    }
+    virtual bool skew(SkScalar sx, SkScalar sy) {
+        AutoTime at(this, kMatrix_OpType);
+        return INHERITED::skew(sx, sy);
+    }
+    virtual bool concat(const SkMatrix& matrix) {
+        AutoTime at(this, kMatrix_OpType);
+        return INHERITED::concat(matrix);
+    }
+    virtual void setMatrix(const SkMatrix& matrix) {
+        AutoTime at(this, kMatrix_OpType);
+        INHERITED::setMatrix(matrix);
+    }
+
+    virtual bool clipRect(const SkRect& rect, SkRegion::Op op) {
+        AutoTime at(this, kClip_OpType);
+        return INHERITED::clipRect(rect, op);
+    }
+    virtual bool clipPath(const SkPath& path, SkRegion::Op op,
+                          bool doAntiAlias) {
+        AutoTime at(this, kClip_OpType);
+        return INHERITED::clipPath(path, op, doAntiAlias);
+    }
+    virtual bool clipRegion(const SkRegion& deviceRgn, SkRegion::Op op) {
+        AutoTime at(this, kClip_OpType);
+        return INHERITED::clipRegion(deviceRgn, op);
+    }
+
+    virtual void drawPaint(const SkPaint& paint) {
+        AutoTime at(this, kDrawPaint_OpType);
+        INHERITED::drawPaint(paint);
+    }
+    virtual void drawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                            const SkPaint& paint) {
+        AutoTime at(this, kDrawPoints_OpType);
+        INHERITED::drawPoints(mode, count, pts, paint);
+    }
+    virtual void drawRect(const SkRect& rect, const SkPaint& paint) {
+        AutoTime at(this, kDrawRect_OpType);
+        INHERITED::drawRect(rect, paint);
+    }
+    virtual void drawPath(const SkPath& path, const SkPaint& paint) {
+        AutoTime at(this, kDrawPath_OpType);
+        INHERITED::drawPath(path, paint);
+    }
+    virtual void drawBitmap(const SkBitmap& bitmap, SkScalar left,
+                            SkScalar top, const SkPaint* paint) {
+        AutoTime at(this, kDrawBitmap_OpType);
+        INHERITED::drawBitmap(bitmap, left, top, paint);
+    }
+    virtual void drawBitmapRect(const SkBitmap& bitmap, const SkIRect* src,
+                                const SkRect& dst, const SkPaint* paint) {
+        AutoTime at(this, kDrawBitmap_OpType);
+        INHERITED::drawBitmapRect(bitmap, src, dst, paint);
+    }
+    virtual void drawBitmapMatrix(const SkBitmap& bitmap, const SkMatrix& m,
+                                  const SkPaint* paint) {
+        AutoTime at(this, kDrawBitmap_OpType);
+        INHERITED::drawBitmapMatrix(bitmap, m, paint);
+    }
+    virtual void drawSprite(const SkBitmap& bitmap, int left, int top,
+                            const SkPaint* paint) {
+        AutoTime at(this, kDrawBitmap_OpType);
+        INHERITED::drawSprite(bitmap, left, top, paint);
+    }
+    virtual void drawText(const void* text, size_t byteLength, SkScalar x,
+                          SkScalar y, const SkPaint& paint) {
+        AutoTime at(this, kDrawText_OpType);
+        INHERITED::drawText(text, byteLength, x, y, paint);
+    }
+    virtual void drawPosText(const void* text, size_t byteLength,
+                             const SkPoint pos[], const SkPaint& paint) {
+        AutoTime at(this, kDrawText_OpType);
+        INHERITED::drawPosText(text, byteLength, pos, paint);
+    }
+    virtual void drawPosTextH(const void* text, size_t byteLength,
+                              const SkScalar xpos[], SkScalar constY,
+                              const SkPaint& paint) {
+        AutoTime at(this, kDrawText_OpType);
+        INHERITED::drawPosTextH(text, byteLength, xpos, constY, paint);
+    }
+    virtual void drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                              const SkPaint& paint) {
+        AutoTime at(this, kDrawText_OpType);
+        INHERITED::drawTextBlob(blob, x, y, paint);
+    }
+    virtual void drawTextOnPath(const void* text, size_t byteLength,
+                                const SkPath& path, const SkMatrix* matrix,
+                                const SkPaint& paint) {
+        AutoTime at(this, kDrawText_OpType);
+        INHERITED::drawTextOnPath(text, byteLength, path, matrix, paint);
+    }
+    virtual void drawPicture(SkPicture& picture) {
+        AutoTime at(this, kDrawPicture_OpType);
+        INHERITED::drawPicture(picture);
+    }
+    virtual void drawVertices(VertexMode vmode, int vertexCount,
+                              const SkPoint vertices[], const SkPoint texs[],
+                              const SkColor colors[], SkXfermode* xmode,
+                              const uint16_t indices[], int indexCount,
+                              const SkPaint& paint) {
+        AutoTime at(this, kDrawVertices_OpType);
+        INHERITED::drawVertices(vmode, vertexCount, vertices, texs, colors,
+                                xmode, indices, indexCount, paint);
+    }
+    virtual void drawData(const void* data, size_t length) {
+        AutoTime at(this, kDrawData_OpType);
+        INHERITED::drawData(data, length);
+    }
+
+private:
+    BenchTimer  fTimer;
+
+    typedef SkProxyCanvas INHERITED;
+};
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkpBench::SkpBench(void* param, const char path[], Mode mode)
+        : INHERITED(param), fMode(mode), fLength(0), fPicture(NULL) {
+    // named for the file, without its directory or .skp
+    const char* name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    fName.printf("skp_%s", name);
+    if (fName.endsWith(".skp")) {
+        fName.remove(fName.size() - 4, 4);
+    }
+    if (kDeserialize_Mode == fMode) {
+        fName.append("_deserialize");
+    }
+
+    SkFILEStream stream(path);
+    if (!stream.isValid()) {
+        return;
+    }
+    fLength = stream.getLength();
+    // too short to hold even the version and size of a picture
+    if (fLength < 3 * sizeof(uint32_t) ||
+            stream.read(fData.alloc(fLength), fLength) != fLength) {
+        return;
+    }
+    SkMemoryStream memStream(fData.get(), fLength);
+    fPicture = SkNEW_ARGS(SkPicture, (&memStream));
+}
+
+SkpBench::~SkpBench() {
+    SkSafeUnref(fPicture);
+}
+
+const char* SkpBench::onGetName() {
+    return fName.c_str();
+}
+
+SkIPoint SkpBench::onGetSize() {
+    if (NULL == fPicture) {
+        return SkIPoint::Make(0, 0);
+    }
+    return SkIPoint::Make(fPicture->width(), fPicture->height());
+}
+
+void SkpBench::onDraw(SkCanvas* canvas) {
+    if (kDeserialize_Mode == fMode) {
+        SkMemoryStream memStream(fData.get(), fLength);
+        SkPicture picture(&memStream);
+    } else {
+        fPicture->draw(canvas);
+    }
+}
+
+static int compare_op_msecs(const void* a, const void* b) {
+    double da = ((const double*)a)[0];
+    double db = ((const double*)b)[0];
+    return da < db ? 1 : (da > db ? -1 : 0);
+}
+
+void SkpBench::appendOpTimes(SkCanvas* canvas, SkString* report) {
+    OpTimingCanvas timing(canvas);
+    fPicture->draw(&timing);
+
+    // (msecs, type) pairs, so they can be sorted together
+    double sorted[kOpTypeCount][2];
+    double total = 0;
+    for (int i = 0; i < kOpTypeCount; i++) {
+        sorted[i][0] = timing.fMSecs[i];
+        sorted[i][1] = i;
+        total += timing.fMSecs[i];
+    }
+    qsort(sorted, kOpTypeCount, sizeof(sorted[0]), compare_op_msecs);
+
+    for (int i = 0; i < kOpTypeCount; i++) {
+        int type = (int)sorted[i][1];
+        if (0 == timing.fCount[type]) {
+            continue;
+        }
+        report->appendf("\n      %12s: %6d ops msecs = %8.3f (%4.1f%%)",
+                        gOpTypeName[type], timing.fCount[type],
+                        timing.fMSecs[type],
+                        total > 0 ? timing.fMSecs[type] * 100 / total : 0);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef SkpBench_DEFINED
+#define SkpBench_DEFINED
+
+#include "SkBenchmark.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+
+class SkPicture;
+
+/**
+ *  Times a picture that was serialized into a .skp file (e.g. captured from
+ *  a real page), rather than something made up by an SkBenchmark subclass.
+ *  In kDraw_Mode each draw plays the picture back; in kDeserialize_Mode it
+ *  only reads the picture from the file's bytes (which are loaded up front,
+ *  so the disk isn't timed).
+ */
+class SkpBench : public SkBenchmark {
+public:
+    enum Mode {
+        kDraw_Mode,
+        kDeserialize_Mode
+    };
+
+    SkpBench(void* param, const char path[], Mode);
+    virtual ~SkpBench();
+
+    /** Return false if the file couldn't be read, in which case the bench
+        shouldn't be run.
+    */
+    bool isValid() const { return NULL != fPicture; }
+
+    Mode getMode() const { return fMode; }
+
+    /** Play the picture into canvas once, timing each call it makes, and
+        append the totals for each kind of op to report, slowest first.
+        The times are of the canvas calls (so for the GPU they don't include
+        flushing), and only of the ops at the top level of the picture.
+    */
+    void appendOpTimes(SkCanvas* canvas, SkString* report);
+
+protected:
+    virtual const char* onGetName();
+    virtual SkIPoint onGetSize();
+    virtual void onDraw(SkCanvas*);
+
+private:
+    Mode            fMode;
+    SkString        fName;
+    SkAutoMalloc    fData;
+    size_t          fLength;
+    SkPicture*      fPicture;
+
+    typedef SkBenchmark INHERITED;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "SkBenchmark.h"
+#include "SkRandom.h"
+#include "SkTSort.h"
+#include "SkTSearch.h"
+#include "SkString.h"
+
+static int int_compare(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return x < y ? -1 : (x > y);
+}
+
+namespace {
+    struct IntKey {
+        int32_t operator()(int x) const { return x; }
+    };
+}
+
+// Sorts N ints per draw, either spread over the full 32-bit range or
+// squeezed into [0, 1024) like the y-coordinates of a path's edges.
+class SortBench : public SkBenchmark {
+public:
+    enum Type {
+        kQSort_Type,
+        kHeap_Type,
+        kIntro_Type,
+        kRadix_Type
+    };
+
+private:
+    enum { N = 1000 };
+    int         fUnsorted[N];
+    int         fSorted[N];
+    Type        fType;
+    SkString    fName;
+
+public:
+    SortBench(void* param, Type type, bool smallKeys)
+            : INHERITED(param), fType(type) {
+        static const char* gNames[] = { "qsort", "heap", "intro", "radix" };
+
+        SkRandom rand;
+        for (int i = 0; i < N; i++) {
+            fUnsorted[i] = smallKeys ? (rand.nextU() & 1023) : rand.nextS();
+        }
+        fName.printf("sort_%s_%s", gNames[type], smallKeys ? "small" : "full");
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        for (int loop = 0; loop < 10; loop++) {
+            memcpy(fSorted, fUnsorted, sizeof(fSorted));
+            switch (fType) {
+                case kQSort_Type:
+                    SkQSort(fSorted, N, sizeof(int), int_compare);
+                    break;
+                case kHeap_Type:
+                    SkTHeapSort<int>(fSorted, N);
+                    break;
+                case kIntro_Type:
+                    SkTIntroSort<int>(fSorted, N);
+                    break;
+                case kRadix_Type:
+                    SkTRadixSort(fSorted, N, IntKey());
+                    break;
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) {
+    return new SortBench(p, SortBench::kQSort_Type, false);
+}
+static SkBenchmark* Fact1(void* p) {
+    return new SortBench(p, SortBench::kHeap_Type, false);
+}
+static SkBenchmark* Fact2(void* p) {
+    return new SortBench(p, SortBench::kIntro_Type, false);
+}
+static SkBenchmark* Fact3(void* p) {
+    return new SortBench(p, SortBench::kRadix_Type, false);
+}
+static SkBenchmark* Fact4(void* p) {
+    return new SortBench(p, SortBench::kQSort_Type, true);
+}
+static SkBenchmark* Fact5(void* p) {
+    return new SortBench(p, SortBench::kIntro_Type, true);
+}
+static SkBenchmark* Fact6(void* p) {
+    return new SortBench(p, SortBench::kRadix_Type, true);
+}
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
+static BenchRegistry gReg3(Fact3);
+static BenchRegistry gReg4(Fact4);
+static BenchRegistry gReg5(Fact5);
+static BenchRegistry gReg6(Fact6);
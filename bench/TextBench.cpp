@@ -133,3 +133,38 @@ static BenchRegistry gReg5(Fact5);
 static BenchRegistry gReg6(Fact6);
 static BenchRegistry gReg7(Fact7);
 
+
+// measuring the same lines over and over, as line breaking does
+class MeasureTextBench : public SkBenchmark {
+    SkPaint     fPaint;
+    enum { N = 2000 };
+public:
+    MeasureTextBench(void* param) : INHERITED(param) {
+        fPaint.setAntiAlias(true);
+        fPaint.setTextSize(SkIntToScalar(15));
+    }
+
+protected:
+    virtual const char* onGetName() { return "text_measure"; }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        static const char gText[] =
+            "The quick brown fox jumps over the lazy dog, again and again.";
+        const size_t len = sizeof(gText) - 1;
+        SkScalar total = 0;
+        for (int i = 0; i < N; i++) {
+            total += fPaint.measureText(gText, len);
+            total += SkIntToScalar(fPaint.breakText(gText, len,
+                                                    SkIntToScalar(200)));
+        }
+        // so the loop isn't optimized away
+        canvas->drawPoint(total > 0 ? 1 : 0, 0, fPaint);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact8(void* p) { return new MeasureTextBench(p); }
+
+static BenchRegistry gReg8(Fact8);
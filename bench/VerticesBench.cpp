@@ -0,0 +1,100 @@
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkShader.h"
+#include "SkString.h"
+
+// a grid of triangles over most of the canvas, with some warp, like the
+// meshes that SkMeshUtils and the warp effects draw
+class VerticesBench : public SkBenchmark {
+    enum {
+        kRows = 24,
+        kCols = 32,
+        kVertCount = (kRows + 1) * (kCols + 1),
+        kIndexCount = kRows * kCols * 6
+    };
+    SkPoint     fVerts[kVertCount];
+    SkPoint     fTexs[kVertCount];
+    SkColor     fColors[kVertCount];
+    uint16_t    fIndices[kIndexCount];
+    SkBitmap    fBitmap;
+    bool        fUseColors, fUseTexture, fWarp;
+    SkString    fName;
+public:
+    VerticesBench(void* param, bool colors, bool texture, bool warp)
+            : INHERITED(param) {
+        fUseColors = colors;
+        fUseTexture = texture;
+        fWarp = warp;
+        fName.printf("vertices%s%s%s", colors ? "_colors" : "",
+                     texture ? "_texture" : "", warp ? "_warp" : "");
+
+        fBitmap.setConfig(SkBitmap::kARGB_8888_Config, 64, 64);
+        fBitmap.allocPixels();
+        for (int y = 0; y < 64; y++) {
+            for (int x = 0; x < 64; x++) {
+                *fBitmap.getAddr32(x, y) = ((x ^ y) & 8) ? 0xFF4080C0 :
+                                                           0xFFC08040;
+            }
+        }
+
+        SkRandom rand;
+        for (int y = 0; y <= kRows; y++) {
+            for (int x = 0; x <= kCols; x++) {
+                int i = y * (kCols + 1) + x;
+                fTexs[i].set(SkIntToScalar(x * 64) / kCols,
+                             SkIntToScalar(y * 64) / kRows);
+                fVerts[i].set(SkIntToScalar(x * 18 + 10),
+                              SkIntToScalar(y * 18 + 10));
+                if (fWarp) {
+                    fVerts[i].offset(rand.nextSScalar1() * 6,
+                                     rand.nextSScalar1() * 6);
+                }
+                fColors[i] = rand.nextU() | 0xFF000000;
+            }
+        }
+        uint16_t* indices = fIndices;
+        for (int y = 0; y < kRows; y++) {
+            for (int x = 0; x < kCols; x++) {
+                uint16_t i = y * (kCols + 1) + x;
+                *indices++ = i;
+                *indices++ = i + 1;
+                *indices++ = i + kCols + 2;
+                *indices++ = i;
+                *indices++ = i + kCols + 2;
+                *indices++ = i + kCols + 1;
+            }
+        }
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+
+    virtual void onDraw(SkCanvas* canvas) {
+        SkPaint paint;
+        if (fUseTexture) {
+            paint.setShader(SkShader::CreateBitmapShader(fBitmap,
+                                                SkShader::kClamp_TileMode,
+                                                SkShader::kClamp_TileMode))->unref();
+        }
+        canvas->drawVertices(SkCanvas::kTriangles_VertexMode, kVertCount,
+                             fVerts, fUseTexture ? fTexs : NULL,
+                             fUseColors ? fColors : NULL, NULL,
+                             fIndices, kIndexCount, paint);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkBenchmark* Fact0(void* p) { return new VerticesBench(p, true, false, false); }
+static SkBenchmark* Fact1(void* p) { return new VerticesBench(p, false, true, false); }
+static SkBenchmark* Fact2(void* p) { return new VerticesBench(p, false, true, true); }
+static SkBenchmark* Fact3(void* p) { return new VerticesBench(p, true, true, true); }
+
+static BenchRegistry gReg0(Fact0);
+static BenchRegistry gReg1(Fact1);
+static BenchRegistry gReg2(Fact2);
+static BenchRegistry gReg3(Fact3);
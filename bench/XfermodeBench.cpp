@@ -0,0 +1,181 @@
+#include "SkAvoidXfermode.h"
+#include "SkBenchmark.h"
+#include "SkColorPriv.h"
+#include "SkPixelXorXfermode.h"
+#include "SkRandom.h"
+#include "SkString.h"
+#include "SkXfermode.h"
+
+// Runs each mode's xfer32 over a row (and a few with coverage), so the
+// per-pixel cost of a mode can be measured apart from the blitter that
+// calls it. The dst isn't reset between rows; none of the procs take
+// shortcuts on what's already there. SrcOver has no xfermode object (blitters special-case it), so
+// its cost is measured by the blitrow_32_srcalpha bench instead.
+
+enum {
+    kRowWidth = 1024,
+    kRowCount = 16     // rows transferred per draw
+};
+
+static const char* gModeName[] = {
+    "clear", "src", "dst", "srcover", "dstover", "srcin", "dstin",
+    "srcout", "dstout", "srcatop", "dstatop", "xor", "plus", "multiply",
+    "screen", "overlay", "darken", "lighten", "colordodge", "colorburn",
+    "hardlight", "softlight", "difference", "exclusion"
+};
+
+class XfermodeBench : public SkBenchmark {
+    SkXfermode* fXfer;
+    bool        fAA;
+    SkPMColor   fSrc[kRowWidth];
+    SkPMColor   fDst[kRowWidth];
+    SkAlpha     fCoverage[kRowWidth];
+    SkString    fName;
+public:
+    XfermodeBench(void* param, SkXfermode::Mode mode, bool aa)
+            : INHERITED(param) {
+        SkASSERT(SK_ARRAY_COUNT(gModeName) == SkXfermode::kLastMode + 1);
+
+        fXfer = SkXfermode::Create(mode);
+        fAA = aa;
+
+        SkRandom rand;
+        for (int i = 0; i < kRowWidth; i++) {
+            fSrc[i] = SkPreMultiplyColor(rand.nextU());
+            fDst[i] = SkPreMultiplyColor(rand.nextU() | 0xFF000000);
+            // mostly full coverage, as along the inside of an AA edge
+            fCoverage[i] = (i & 3) ? 0xFF : rand.nextU() & 0xFF;
+        }
+
+        fName.printf("xfermode_%s%s", gModeName[mode], aa ? "_aa" : "");
+    }
+
+    virtual ~XfermodeBench() {
+        SkSafeUnref(fXfer);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        if (NULL == fXfer) {
+            return;
+        }
+        const SkAlpha* aa = fAA ? fCoverage : NULL;
+        for (int i = 0; i < kRowCount; i++) {
+            fXfer->xfer32(fDst, fSrc, kRowWidth, aa);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+// the effects' xfermodes, over 8888 and 565 rows: a halo color that half the
+// row is close to
+class EffectXfermodeBench : public SkBenchmark {
+    SkXfermode* fXfer;
+    bool        f565;
+    SkPMColor   fSrc[kRowWidth];
+    SkPMColor   fDst[kRowWidth];
+    uint16_t    fDst16[kRowWidth];
+    SkString    fName;
+public:
+    EffectXfermodeBench(void* param, SkXfermode* xfer, const char name[],
+                        bool is565) : INHERITED(param) {
+        fXfer = xfer;
+        f565 = is565;
+
+        SkRandom rand;
+        for (int i = 0; i < kRowWidth; i++) {
+            fSrc[i] = SkPreMultiplyColor(rand.nextU());
+            SkPMColor c = (i & 1) ? SkPreMultiplyColor(0xFFF0F0F0 ^
+                                                       (rand.nextU() & 0x0F0F0F))
+                                  : SkPreMultiplyColor(rand.nextU() | 0xFF000000);
+            fDst[i] = c;
+            fDst16[i] = SkPixel32ToPixel16(c);
+        }
+
+        fName.printf("xfermode_%s%s", name, is565 ? "_565" : "");
+    }
+
+    virtual ~EffectXfermodeBench() {
+        SkSafeUnref(fXfer);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual int onGetUnitsPerDraw() { return kRowWidth * kRowCount; }
+
+    virtual void onDraw(SkCanvas*) {
+        for (int i = 0; i < kRowCount; i++) {
+            if (f565) {
+                fXfer->xfer16(fDst16, fSrc, kRowWidth, NULL);
+            } else {
+                fXfer->xfer32(fDst, fSrc, kRowWidth, NULL);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+static SkXfermode* make_avoid() {
+    return new SkAvoidXfermode(0xFFF0F0F0, 32,
+                               SkAvoidXfermode::kAvoidColor_Mode);
+}
+
+template <int MODE> static SkBenchmark* Fact(void* p) {
+    return new XfermodeBench(p, (SkXfermode::Mode)MODE, false);
+}
+template <int MODE> static SkBenchmark* FactAA(void* p) {
+    return new XfermodeBench(p, (SkXfermode::Mode)MODE, true);
+}
+
+static BenchRegistry gReg00(Fact<SkXfermode::kClear_Mode>);
+static BenchRegistry gReg01(Fact<SkXfermode::kSrc_Mode>);
+static BenchRegistry gReg02(Fact<SkXfermode::kDst_Mode>);
+static BenchRegistry gReg04(Fact<SkXfermode::kDstOver_Mode>);
+static BenchRegistry gReg05(Fact<SkXfermode::kSrcIn_Mode>);
+static BenchRegistry gReg06(Fact<SkXfermode::kDstIn_Mode>);
+static BenchRegistry gReg07(Fact<SkXfermode::kSrcOut_Mode>);
+static BenchRegistry gReg08(Fact<SkXfermode::kDstOut_Mode>);
+static BenchRegistry gReg09(Fact<SkXfermode::kSrcATop_Mode>);
+static BenchRegistry gReg10(Fact<SkXfermode::kDstATop_Mode>);
+static BenchRegistry gReg11(Fact<SkXfermode::kXor_Mode>);
+static BenchRegistry gReg12(Fact<SkXfermode::kPlus_Mode>);
+static BenchRegistry gReg13(Fact<SkXfermode::kMultiply_Mode>);
+static BenchRegistry gReg14(Fact<SkXfermode::kScreen_Mode>);
+static BenchRegistry gReg15(Fact<SkXfermode::kOverlay_Mode>);
+static BenchRegistry gReg16(Fact<SkXfermode::kDarken_Mode>);
+static BenchRegistry gReg17(Fact<SkXfermode::kLighten_Mode>);
+static BenchRegistry gReg18(Fact<SkXfermode::kColorDodge_Mode>);
+static BenchRegistry gReg19(Fact<SkXfermode::kColorBurn_Mode>);
+static BenchRegistry gReg20(Fact<SkXfermode::kHardLight_Mode>);
+static BenchRegistry gReg21(Fact<SkXfermode::kSoftLight_Mode>);
+static BenchRegistry gReg22(Fact<SkXfermode::kDifference_Mode>);
+static BenchRegistry gReg23(Fact<SkXfermode::kExclusion_Mode>);
+
+// coverage takes a separate path in most modes
+static BenchRegistry gRegAA01(FactAA<SkXfermode::kSrc_Mode>);
+static BenchRegistry gRegAA06(FactAA<SkXfermode::kDstIn_Mode>);
+static BenchRegistry gRegAA12(FactAA<SkXfermode::kPlus_Mode>);
+static BenchRegistry gRegAA13(FactAA<SkXfermode::kMultiply_Mode>);
+static BenchRegistry gRegAA14(FactAA<SkXfermode::kScreen_Mode>);
+
+static SkBenchmark* FactAvoid(void* p) {
+    return new EffectXfermodeBench(p, make_avoid(), "avoid", false);
+}
+static SkBenchmark* FactAvoid565(void* p) {
+    return new EffectXfermodeBench(p, make_avoid(), "avoid", true);
+}
+static SkBenchmark* FactPixelXor(void* p) {
+    return new EffectXfermodeBench(p, new SkPixelXorXfermode(0xFF808080),
+                                   "pixelxor", false);
+}
+
+static BenchRegistry gRegAvoid(FactAvoid);
+static BenchRegistry gRegAvoid565(FactAvoid565);
+static BenchRegistry gRegPixelXor(FactPixelXor);
@@ -12,9 +12,12 @@ def usage():
     
     print '-o <file> the old bench output file.'
     print '-n <file> the new bench output file.'
+    print '   Either file may be the text that bench prints, or its -json file.'
     print '-h causes headers to be output.'
+    print '-s only outputs significant differences (needs -json files).'
     print '-f <fieldSpec> which fields to output and in what order.'
-    print '   Not specifying is the same as -f "bctondp".'
+    print '   Not specifying is the same as -f "bctondp", or -f "bctondps"'
+    print '   if both files are -json files.'
     print '  b: bench'
     print '  c: config'
     print '  t: time type'
@@ -22,6 +25,7 @@ def usage():
     print '  n: new time'
     print '  d: diff'
     print '  p: percent diff'
+    print '  s: significance (* if the samples differ, by Welch\'s t-test)'
     
 class BenchDiff:
     """A compare between data points produced by bench.
@@ -35,6 +39,8 @@ class BenchDiff:
         if old.time != 0:
             diffp = self.diff / old.time
         self.diffp = diffp
+        self.significant = bench_util.is_significant(old.samples,
+                                                     new.samples)
     
     def __repr__(self):
         return "BenchDiff(%s, %s)" % (
@@ -46,7 +52,7 @@ def main():
     """Parses command line and writes output."""
     
     try:
-        opts, _ = getopt.getopt(sys.argv[1:], "f:o:n:h")
+        opts, _ = getopt.getopt(sys.argv[1:], "f:o:n:hs")
     except getopt.GetoptError, err:
         print str(err) 
         usage()
@@ -60,6 +66,7 @@ def main():
         'n' : '{new_time: >10.2f} ',
         'd' : '{diff: >+10.2f} ',
         'p' : '{diffp: >+8.1%} ',
+        's' : '{significant: >1} ',
     }
     header_formats = {
         'b' : '{bench: >28} ',
@@ -69,14 +76,16 @@ def main():
         'n' : '{new_time: >10} ',
         'd' : '{diff: >10} ',
         'p' : '{diffp: >8} ',
+        's' : '{significant: >1} ',
     }
     
     old = None
     new = None
     column_format = ""
     header_format = ""
-    columns = 'bctondp'
+    columns = None
     header = False
+    significant_only = False
     
     for option, value in opts:
         if option == "-o":
@@ -85,6 +94,8 @@ def main():
             new = value
         elif option == "-h":
             header = True
+        elif option == "-s":
+            significant_only = True
         elif option == "-f":
             columns = value
         else:
@@ -95,8 +106,17 @@ def main():
         usage()
         sys.exit(2)
     
+    old_benches = bench_util.parse_file({}, old)
+    new_benches = bench_util.parse_file({}, new)
+    
+    if columns is None:
+        columns = 'bctondp'
+        if (all([b.samples for b in old_benches]) and
+            all([b.samples for b in new_benches])):
+            columns += 's'
+    
     for column_char in columns:
-        if column_formats[column_char]:
+        if column_char in column_formats:
             column_format += column_formats[column_char]
             header_format += header_formats[column_char]
         else:
@@ -112,11 +132,9 @@ def main():
             , new_time='new'
             , diff='diff'
             , diffp='diffP'
+            , significant='s'
         )
     
-    old_benches = bench_util.parse({}, open(old, 'r'))
-    new_benches = bench_util.parse({}, open(new, 'r'))
-    
     bench_diffs = []
     for old_bench in old_benches:
         #filter new_benches for benches that match old_bench
@@ -127,7 +145,10 @@ def main():
         ]
         if (len(new_bench_match) < 1):
             continue
-        bench_diffs.append(BenchDiff(old_bench, new_bench_match[0]))
+        bench_diff = BenchDiff(old_bench, new_bench_match[0])
+        if significant_only and not bench_diff.significant:
+            continue
+        bench_diffs.append(bench_diff)
     
     bench_diffs.sort(key=lambda d : [d.diffp,
                                      d.old.bench,
@@ -143,6 +164,7 @@ def main():
             , new_time=bench_diff.new.time
             , diff=bench_diff.diff
             , diffp=bench_diff.diffp
+            , significant='*' if bench_diff.significant else ''
         )
     
 if __name__ == "__main__":
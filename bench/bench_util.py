@@ -6,17 +6,21 @@ Created on May 19, 2011
 
 import re
 import math
+import json
 
 class BenchDataPoint:
     """A single data point produced by bench.
     
-    (str, str, str, float, {str:str})"""
-    def __init__(self, bench, config, time_type, time, settings):
+    (str, str, str, float, {str:str}, [float])
+    samples holds the time of every sample, if bench wrote them (see
+    parse_json), and is empty otherwise."""
+    def __init__(self, bench, config, time_type, time, settings, samples=None):
         self.bench = bench
         self.config = config
         self.time_type = time_type
         self.time = time
         self.settings = settings
+        self.samples = samples or []
     
     def __repr__(self):
         return "BenchDataPoint(%s, %s, %s, %s, %s)" % (
@@ -45,6 +49,23 @@ class _ExtremeType(object):
 Max = _ExtremeType(1, "Max")
 Min = _ExtremeType(-1, "Min")
 
+setting_re = '([^\s=]+)(?:=(\S+))?'
+settings_re = 'skia bench:((?:\s+' + setting_re + ')*)'
+
+def _parse_settings(settings, line):
+    """Returns a copy of settings, updated from a bench settings line.
+    
+    ({str:str}, str) -> {str:str}"""
+    settings = dict(settings)
+    settingsMatch = re.search(settings_re, line)
+    if (settingsMatch):
+        for settingMatch in re.finditer(setting_re, settingsMatch.group(1)):
+            if (settingMatch.group(2)):
+                settings[settingMatch.group(1)] = settingMatch.group(2)
+            else:
+                settings[settingMatch.group(1)] = True
+    return settings
+
 def parse(settings, lines):
     """Parses bench output into a useful data structure.
     
@@ -52,8 +73,6 @@ def parse(settings, lines):
     
     benches = []
     current_bench = None
-    setting_re = '([^\s=]+)(?:=(\S+))?'
-    settings_re = 'skia bench:((?:\s+' + setting_re + ')*)'
     bench_re = 'running bench (?:\[\d+ \d+\] )?\s*(\S+)'
     time_re = '(?:(\w*)msecs = )?\s*(\d+\.\d+)'
     config_re = '(\S+): ((?:' + time_re + '\s+)+)'
@@ -61,14 +80,8 @@ def parse(settings, lines):
     for line in lines:
         
         #see if this line is a settings line
-        settingsMatch = re.search(settings_re, line)
-        if (settingsMatch):
-            settings = dict(settings)
-            for settingMatch in re.finditer(setting_re, settingsMatch.group(1)):
-                if (settingMatch.group(2)):
-                    settings[settingMatch.group(1)] = settingMatch.group(2)
-                else:
-                    settings[settingMatch.group(1)] = True
+        if (re.search(settings_re, line)):
+            settings = _parse_settings(settings, line)
                 
         #see if this line starts a new bench
         new_bench = re.search(bench_re, line)
@@ -91,6 +104,75 @@ def parse(settings, lines):
                             , settings))
     
     return benches
+
+# the time types of parse(), by their names in bench's -json output
+json_time_types = {
+    'wall' : '',
+    'cpu' : 'c',
+    'gpu' : 'g',
+}
+
+def parse_json(settings, text):
+    """Parses the output of bench -json, whose times are medians.
+    
+    ({str:str}, str) -> [BenchDataPoint]"""
+    
+    data = json.loads(text)
+    settings = _parse_settings(settings, data['settings'])
+    benches = []
+    for result in data['results']:
+        for name, time_type in json_time_types.items():
+            if name in result:
+                times = result[name]
+                benches.append(BenchDataPoint(
+                        result['bench']
+                        , result['config']
+                        , time_type
+                        , times['median']
+                        , settings
+                        , times['samples']))
+    return benches
+
+def parse_file(settings, path):
+    """Parses a file of bench output, in either format.
+    
+    ({str:str}, str) -> [BenchDataPoint]"""
+    
+    text = open(path, 'r').read()
+    if text.lstrip().startswith('{'):
+        return parse_json(settings, text)
+    return parse(settings, text.splitlines(True))
+
+# two-sided 95% critical values of Student's t, for 1 to 30 degrees of freedom
+_t_table = [12.71, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+            2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+            2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+            2.048, 2.045, 2.042]
+
+def is_significant(old_samples, new_samples):
+    """Whether the means of two sets of samples differ, by Welch's t-test at
+    95%. Sets of fewer than two samples are never significantly different.
+    
+    ([float], [float]) -> bool"""
+    
+    n1 = len(old_samples)
+    n2 = len(new_samples)
+    if n1 < 2 or n2 < 2:
+        return False
+    mean1 = sum(old_samples) / n1
+    mean2 = sum(new_samples) / n2
+    var1 = sum([(x - mean1) ** 2 for x in old_samples]) / (n1 - 1)
+    var2 = sum([(x - mean2) ** 2 for x in new_samples]) / (n2 - 1)
+    se2 = var1 / n1 + var2 / n2
+    if se2 == 0:
+        return mean1 != mean2
+    t = abs(mean1 - mean2) / math.sqrt(se2)
+    # Welch-Satterthwaite
+    df = se2 * se2 / ((var1 / n1) ** 2 / (n1 - 1) + (var2 / n2) ** 2 / (n2 - 1))
+    df = max(1, int(df))
+    if df <= len(_t_table):
+        return t > _t_table[df - 1]
+    return t > 1.96
     
 class LinearRegression:
     """Linear regression data based on a set of data points.
@@ -1,15 +1,27 @@
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
+#include "SkGPipe.h"
 #include "SkGraphics.h"
 #include "SkImageEncoder.h"
+#include "SkMemoryTracker.h"
 #include "SkNWayCanvas.h"
+#include "SkOSFile.h"
 #include "SkPicture.h"
 #include "SkString.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
 #include "GrContext.h"
 #include "SkGpuDevice.h"
 #include "SkEGLContext.h"
 
+#ifdef SK_SUPPORT_PDF
+    #include "SkPDFDevice.h"
+    #include "SkPDFDocument.h"
+#endif
+
 #include "SkBenchmark.h"
+#include "SkpBench.h"
 #include "BenchTimer.h"
 
 #ifdef ANDROID
@@ -51,25 +63,87 @@ static bool equal(const SkBitmap& bm1, const SkBitmap& bm2) {
 }
 #endif
 
+// runs through the registered benches, then (if there's a dir) the .skps
 class Iter {
 public:
-    Iter(void* param) {
+    Iter(void* param, const char skpDir[] = NULL,
+         bool skpDeserialize = false) {
         fBench = BenchRegistry::Head();
         fParam = param;
+        fSkpDir = skpDir;
+        if (skpDir) {
+            fSkpIter.reset(skpDir, ".skp");
+        }
+        fSkpDeserialize = skpDeserialize;
+        fSkpMode = SkpBench::kDraw_Mode;
+        fLastSkp = NULL;
+        fFactory = NULL;
     }
     
     SkBenchmark* next() {
         if (fBench) {
-            BenchRegistry::Factory f = fBench->factory();
+            fFactory = fBench->factory();
             fBench = fBench->next();
-            return f(fParam);
+            return fFactory(fParam);
+        }
+        fFactory = NULL;
+        fLastSkp = this->nextSkp();
+        return fLastSkp;
+    }
+
+    // makes another instance of the bench that next() returned last
+    SkBenchmark* again() {
+        if (fFactory) {
+            return fFactory(fParam);
         }
-        return NULL;
+        return SkNEW_ARGS(SkpBench, (fParam, fSkpPath.c_str(), fSkpMode));
     }
 
+    // what next() returned, if it was a .skp, else NULL
+    SkpBench* lastSkp() const { return fLastSkp; }
+
 private:
     const BenchRegistry* fBench;
+    BenchRegistry::Factory fFactory;
     void* fParam;
+
+    const char*     fSkpDir;
+    SkOSFile::Iter  fSkpIter;
+    SkString        fSkpPath;
+    bool            fSkpDeserialize;
+    SkpBench::Mode  fSkpMode;
+    SkpBench*       fLastSkp;
+
+    // each file gets a bench for drawing, then one for deserializing
+    SkpBench* nextSkp() {
+        if (NULL == fSkpDir) {
+            return NULL;
+        }
+        for (;;) {
+            if (fSkpDeserialize && SkpBench::kDraw_Mode == fSkpMode &&
+                    fSkpPath.size() > 0) {
+                fSkpMode = SkpBench::kDeserialize_Mode;
+            } else {
+                SkString name;
+                if (!fSkpIter.next(&name)) {
+                    return NULL;
+                }
+                fSkpPath.printf("%s/%s", fSkpDir, name.c_str());
+                fSkpMode = SkpBench::kDraw_Mode;
+            }
+            SkpBench* bench = SkNEW_ARGS(SkpBench, (fParam, fSkpPath.c_str(),
+                                                    fSkpMode));
+            if (bench->isValid()) {
+                return bench;
+            }
+            SkString str;
+            str.printf("could not read %s\n", fSkpPath.c_str());
+            log_error(str);
+            bench->unref();
+            // don't try to deserialize what we couldn't read
+            fSkpMode = SkpBench::kDeserialize_Mode;
+        }
+    }
 };
 
 static void make_filename(const char name[], SkString* path) {
@@ -147,6 +221,19 @@ static void performScale(SkCanvas* canvas, int w, int h) {
     canvas->translate(-x, -y);
 }
 
+static void performTransforms(SkCanvas* canvas, const SkIPoint& dim,
+                              bool doClip, bool doScale, bool doRotate) {
+    if (doClip) {
+        performClip(canvas, dim.fX, dim.fY);
+    }
+    if (doScale) {
+        performScale(canvas, dim.fX, dim.fY);
+    }
+    if (doRotate) {
+        performRotate(canvas, dim.fX, dim.fY);
+    }
+}
+
 static bool parse_bool_arg(char * const* argv, char* const* stop, bool* var) {
     if (argv < stop) {
         *var = atoi(*argv) != 0;
@@ -159,8 +246,86 @@ enum Backend {
     kRaster_Backend,
     kGPU_Backend,
     kPDF_Backend,
+    kRecord_Backend,    // times recording into an SkPicture
+    kPlayback_Backend,  // times drawing the recorded SkPicture into 8888
+    kPipe_Backend,      // times an SkGPipe writer and reader, into 8888
+};
+
+// the backends that don't draw into the device's pixels
+static bool draws_offscreen(Backend backend) {
+    return kPDF_Backend == backend || kRecord_Backend == backend;
+}
+
+class NullWStream : public SkWStream {
+public:
+    virtual bool write(const void*, size_t) { return true; }
+};
+
+// plays the pipe back as it's written, into the same block each time
+class PipeController : public SkGPipeController {
+public:
+    PipeController(SkCanvas* target)
+        : fReader(target), fBlockSize(0), fBytesRead(0) {}
+
+    virtual void* requestBlock(size_t minRequest, size_t* actual) {
+        if (fBlockSize < minRequest) {
+            fBlockSize = SkMax32(minRequest, 64 * 1024);
+            fBlock.alloc(fBlockSize);
+        }
+        fBytesRead = 0;
+        *actual = fBlockSize;
+        return fBlock.get();
+    }
+
+    virtual void notifyWritten(size_t bytes) {
+        fReader.playback((const char*)fBlock.get() + fBytesRead, bytes);
+        fBytesRead += bytes;
+    }
+
+private:
+    SkGPipeReader   fReader;
+    SkAutoMalloc    fBlock;
+    size_t          fBlockSize;
+    size_t          fBytesRead;
 };
 
+// draws the bench through the backends that make something other than pixels
+static void drawOffscreen(SkBenchmark* bench, Backend backend,
+                          const SkIPoint& dim, bool doClip, bool doScale,
+                          bool doRotate) {
+    switch (backend) {
+        case kPDF_Backend: {
+#ifdef SK_SUPPORT_PDF
+            SkISize size = SkISize::Make(dim.fX, dim.fY);
+            SkMatrix identity;
+            identity.reset();
+            SkPDFDevice* dev = new SkPDFDevice(size, size, identity);
+            SkAutoUnref aur(dev);
+
+            SkCanvas canvas(dev);
+            performTransforms(&canvas, dim, doClip, doScale, doRotate);
+            bench->draw(&canvas);
+
+            SkPDFDocument doc;
+            doc.appendPage(dev);
+            NullWStream stream;
+            doc.emitPDF(&stream);
+#endif
+            break;
+        }
+        case kRecord_Backend: {
+            SkPicture picture;
+            SkCanvas* canvas = picture.beginRecording(dim.fX, dim.fY);
+            performTransforms(canvas, dim, doClip, doScale, doRotate);
+            bench->draw(canvas);
+            picture.endRecording();
+            break;
+        }
+        default:
+            SkASSERT(!"unsupported");
+    }
+}
+
 static SkDevice* make_device(SkBitmap::Config config, const SkIPoint& size,
                              Backend backend, GrContext* context) {
     SkDevice* device = NULL;
@@ -178,12 +343,44 @@ static SkDevice* make_device(SkBitmap::Config config, const SkIPoint& size,
 //            device->clear(0xFFFFFFFF);
             break;
         case kPDF_Backend:
+        case kRecord_Backend:
+        case kPlayback_Backend:
+        case kPipe_Backend:
+            // a raster target (for the picture and the pipe to draw into)
+            bitmap.allocPixels();
+            erase(bitmap);
+            device = new SkDevice(bitmap);
+            break;
         default:
             SkASSERT(!"unsupported");
     }
     return device;
 }
 
+static void drawBench(SkBenchmark* bench, Backend backend, SkCanvas* canvas,
+                      SkPicture& picture, const SkIPoint& dim, bool doClip,
+                      bool doScale, bool doRotate) {
+    switch (backend) {
+        case kPlayback_Backend:
+            canvas->drawPicture(picture);
+            break;
+        case kPipe_Backend: {
+            PipeController controller(canvas);
+            SkGPipeWriter writer;
+            bench->draw(writer.startRecording(&controller));
+            writer.endRecording();
+            break;
+        }
+        default:
+            if (draws_offscreen(backend)) {
+                drawOffscreen(bench, backend, dim, doClip, doScale, doRotate);
+            } else {
+                bench->draw(canvas);
+            }
+            break;
+    }
+}
+
 static const struct {
     SkBitmap::Config    fConfig;
     const char*         fName;
@@ -192,8 +389,299 @@ static const struct {
     { SkBitmap::kARGB_8888_Config,  "8888",     kRaster_Backend },
     { SkBitmap::kRGB_565_Config,    "565",      kRaster_Backend },
     { SkBitmap::kARGB_8888_Config,  "GPU",      kGPU_Backend },
+#ifdef SK_SUPPORT_PDF
+    { SkBitmap::kARGB_8888_Config,  "PDF",      kPDF_Backend },
+#endif
+    { SkBitmap::kARGB_8888_Config,  "record",   kRecord_Backend },
+    { SkBitmap::kARGB_8888_Config,  "playback", kPlayback_Backend },
+    { SkBitmap::kARGB_8888_Config,  "pipe",     kPipe_Backend },
+};
+
+/*  For -threads: each thread draws its own instance of the bench into its own
+    device, after waiting for the others to be ready, so that they all draw
+    at the same time.
+ */
+class ThreadBench : public SkRunnable {
+public:
+    SkBenchmark*        fBench;
+    SkBitmap::Config    fConfig;
+    Backend             fBackend;
+    int                 fRepeatDraw;
+    bool                fDoClip, fDoScale, fDoRotate;
+    int                 fThreadCount;
+    int32_t*            fReady;
+
+    SkTDArray<double>   fMSecs;     // of each draw
+    double              fTotalMSecs;
+
+    virtual void run() {
+        const SkIPoint dim = fBench->getSize();
+        SkDevice* device = make_device(fConfig, dim, fBackend, NULL);
+        SkCanvas canvas(device);
+        device->unref();
+        performTransforms(&canvas, dim, fDoClip, fDoScale, fDoRotate);
+
+        SkPicture picture;
+        if (kPlayback_Backend == fBackend) {
+            fBench->draw(picture.beginRecording(dim.fX, dim.fY));
+            picture.endRecording();
+        }
+        if (fRepeatDraw > 1) {
+            SkAutoCanvasRestore acr(&canvas, true);
+            drawBench(fBench, fBackend, &canvas, picture, dim, fDoClip,
+                      fDoScale, fDoRotate);
+        }
+
+        sk_atomic_inc(fReady);
+        while (*(volatile int32_t*)fReady < fThreadCount) {
+            sk_thread_yield();
+        }
+
+        BenchTimer total(false);
+        BenchTimer timer(false);
+        total.start();
+        for (int i = 0; i < fRepeatDraw; i++) {
+            SkAutoCanvasRestore acr(&canvas, true);
+            timer.start();
+            drawBench(fBench, fBackend, &canvas, picture, dim, fDoClip,
+                      fDoScale, fDoRotate);
+            timer.end();
+            *fMSecs.append() = timer.fWall;
+        }
+        total.end();
+        fTotalMSecs = total.fWall;
+    }
+};
+
+static int compare_msecs(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+// the fraction is of the draws; msecs must be sorted
+static double percentile(const SkTDArray<double>& msecs, double fraction) {
+    int index = (int)(msecs.count() * fraction);
+    return msecs[SkMin32(index, msecs.count() - 1)];
+}
+
+struct Stats {
+    double  fMedian;
+    double  fMin;
+    double  fMean;
+    double  fStdDev;
+};
+
+// sorts the samples
+static void computeStats(SkTDArray<double>& samples, Stats* stats) {
+    const int n = samples.count();
+    qsort(samples.begin(), n, sizeof(double), compare_msecs);
+    stats->fMedian = (n & 1) ? samples[n / 2] :
+                     (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats->fMin = samples[0];
+
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    stats->fMean = sum / n;
+    double squares = 0;
+    for (int i = 0; i < n; i++) {
+        double d = samples[i] - stats->fMean;
+        squares += d * d;
+    }
+    stats->fStdDev = n > 1 ? sqrt(squares / (n - 1)) : 0;
+}
+
+static void appendJSONString(SkString* json, const char str[]) {
+    json->append("\"");
+    for (; *str; str++) {
+        if ('"' == *str || '\\' == *str) {
+            json->append("\\");
+        }
+        json->append(str, 1);
+    }
+    json->append("\"");
+}
+
+// the samples are sorted (see computeStats)
+static void appendJSONTimes(SkString* json, const char name[],
+                            const SkTDArray<double>& samples,
+                            const Stats& stats) {
+    json->appendf(", \"%s\": {\"median\": %.4f, \"min\": %.4f, "
+                  "\"mean\": %.4f, \"stddev\": %.4f, \"samples\": [",
+                  name, stats.fMedian, stats.fMin, stats.fMean,
+                  stats.fStdDev);
+    for (int i = 0; i < samples.count(); i++) {
+        json->appendf(i ? ", %.4f" : "%.4f", samples[i]);
+    }
+    json->append("]}");
+}
+
+/*  For -memory: what sk_malloc handed out between start() and end(), and how
+    much the caches grew by. Without SK_ENABLE_MEMORY_TRACKING only the
+    caches are counted.
+ */
+struct MemoryDelta {
+    int64_t fBytes;     // allocated in all
+    int64_t fPeak;      // most allocated at once, above what was at start()
+    int32_t fAllocs;
+    int64_t fCacheBytes;
+
+    void start() {
+        SkMemoryTracker::GetStats(&fStart);
+        SkMemoryTracker::ResetPeak();
+        fStartCache = SkGraphics::GetTotalCacheUsed();
+    }
+
+    void end() {
+        SkMemoryTracker::Stats now;
+        SkMemoryTracker::GetStats(&now);
+        fBytes = now.fAllocatedBytes - fStart.fAllocatedBytes;
+        fPeak = now.fPeakBytes - fStart.fCurrentBytes;
+        fAllocs = now.fAllocCount - fStart.fAllocCount;
+        fCacheBytes = (int64_t)SkGraphics::GetTotalCacheUsed() - fStartCache;
+    }
+
+    void append(SkString* str, const char name[], int draws) const {
+        draws = SkMax32(draws, 1);
+        str->appendf(" %s = %lldB/%d", name, (long long)(fBytes / draws),
+                     fAllocs / draws);
+        if (1 == draws) {
+            str->appendf(" peak %lldB", (long long)fPeak);
+        }
+        if (fCacheBytes) {
+            str->appendf(" caches %+lldB", (long long)fCacheBytes);
+        }
+    }
+
+    void appendJSON(SkString* json, const char name[], int draws) const {
+        draws = SkMax32(draws, 1);
+        json->appendf(", \"%s\": {\"bytes\": %lld, \"allocs\": %d, "
+                      "\"peak\": %lld, \"cache_bytes\": %lld}", name,
+                      (long long)(fBytes / draws), fAllocs / draws,
+                      (long long)fPeak, (long long)fCacheBytes);
+    }
+
+private:
+    SkMemoryTracker::Stats  fStart;
+    int64_t                 fStartCache;
+};
+
+static void log_memory_sites(int maxCount) {
+    SkAutoTArray<SkMemoryTracker::Site> sites(maxCount);
+    int count = SkMemoryTracker::GetSites(sites.get(), maxCount);
+    SkString str;
+    str.printf("sk_malloc call sites (%d in all), most bytes first:\n",
+               count);
+    for (int i = 0; i < SkMin32(count, maxCount); i++) {
+        str.appendf("  %18p %12lldB %8d allocs %12lldB live\n",
+                    sites[i].fCaller, (long long)sites[i].fAllocatedBytes,
+                    sites[i].fAllocCount, (long long)sites[i].fCurrentBytes);
+    }
+    log_progress(str);
+}
+
+/*  For -frames: what each GPU frame cost. The CPU spends submit + stall on
+    a frame, so the GPU time that isn't a stall ran while the CPU was still
+    submitting; if that is most of it the two overlap well, and if the GPU
+    takes longer than the submit, the GPU is what sets the frame rate.
+ */
+struct FrameTimes {
+    // frames are counted by msecs: under 1, 1-2, 2-4, ... 32-64, 64 and up
+    enum { kBucketCount = 8 };
+
+    SkTDArray<double>   fSubmit, fStall, fGpu, fFrame;
+    Stats               fSubmitStats, fStallStats, fGpuStats, fFrameStats;
+    int                 fBuckets[kBucketCount];
+    int                 fSlow;      // frames over twice the median
+
+    void add(const BenchFrameTimer& timer) {
+        *fSubmit.append() = timer.fSubmit;
+        *fStall.append() = timer.fStall;
+        *fFrame.append() = timer.fSubmit + timer.fStall;
+        if (timer.fGpu > 0) {
+            *fGpu.append() = timer.fGpu;
+        }
+    }
+
+    // sorts the times
+    void finish() {
+        computeStats(fSubmit, &fSubmitStats);
+        computeStats(fStall, &fStallStats);
+        computeStats(fFrame, &fFrameStats);
+        if (fGpu.count() > 0) {
+            computeStats(fGpu, &fGpuStats);
+        }
+        memset(fBuckets, 0, sizeof(fBuckets));
+        fSlow = 0;
+        for (int i = 0; i < fFrame.count(); i++) {
+            int bucket = 0;
+            for (double limit = 1; bucket < kBucketCount - 1 &&
+                    fFrame[i] >= limit; limit *= 2) {
+                bucket += 1;
+            }
+            fBuckets[bucket] += 1;
+            if (fFrame[i] > 2 * fFrameStats.fMedian) {
+                fSlow += 1;
+            }
+        }
+    }
+
+    void append(SkString* str) const {
+        str->appendf("\n  frames: %d submit = %.2f stall = %.2f",
+                     fFrame.count(), fSubmitStats.fMedian,
+                     fStallStats.fMedian);
+        if (fGpu.count() > 0) {
+            double overlap = 1 - fStallStats.fMedian / fGpuStats.fMedian;
+            str->appendf(" gpu = %.2f overlap = %d%% %s bound",
+                         fGpuStats.fMedian,
+                         overlap > 0 ? (int)(overlap * 100) : 0,
+                         fGpuStats.fMedian > fSubmitStats.fMedian ?
+                         "gpu" : "cpu");
+        }
+        str->appendf("\n    frame msecs p50/p90/p99/max = %.2f/%.2f/%.2f/%.2f"
+                     " (%d over 2x p50)", percentile(fFrame, 0.5),
+                     percentile(fFrame, 0.9), percentile(fFrame, 0.99),
+                     fFrame[fFrame.count() - 1], fSlow);
+        int first = 0, last = kBucketCount - 1;
+        while (0 == fBuckets[first]) {
+            first += 1;
+        }
+        while (0 == fBuckets[last]) {
+            last -= 1;
+        }
+        str->append("\n    histogram:");
+        for (int i = first; i <= last; i++) {
+            if (0 == i) {
+                str->appendf(" <1: %d", fBuckets[i]);
+            } else if (kBucketCount - 1 == i) {
+                str->appendf(" %d+: %d", 1 << (i - 1), fBuckets[i]);
+            } else {
+                str->appendf(" %d-%d: %d", 1 << (i - 1), 1 << i, fBuckets[i]);
+            }
+        }
+    }
+
+    void appendJSON(SkString* json) const {
+        json->appendf(", \"frames\": {\"count\": %d", fFrame.count());
+        appendJSONTimes(json, "submit", fSubmit, fSubmitStats);
+        appendJSONTimes(json, "stall", fStall, fStallStats);
+        appendJSONTimes(json, "frame", fFrame, fFrameStats);
+        if (fGpu.count() > 0) {
+            appendJSONTimes(json, "gpu", fGpu, fGpuStats);
+        }
+        json->append(", \"histogram\": [");
+        for (int i = 0; i < kBucketCount; i++) {
+            json->appendf(i ? ", %d" : "%d", fBuckets[i]);
+        }
+        json->appendf("], \"slow\": %d}", fSlow);
+    }
 };
 
+// caps -calibrate, for benches that draw nothing
+static const int kMaxCalibratedLoops = 1 << 16;
+
 static int findConfig(const char config[]) {
     for (size_t i = 0; i < SK_ARRAY_COUNT(gConfigs); i++) {
         if (!strcmp(config, gConfigs[i].fName)) {
@@ -221,6 +709,18 @@ int main (int argc, char * const argv[]) {
     const char* matchStr = NULL;
     bool hasStrokeWidth = false;
     float strokeWidth;
+    int threadCount = 0;
+    int warmupDraws = -1;       // -1 for one, if there is more than one draw
+    int sampleCount = 1;
+    double calibrateMSecs = 0;  // 0 to draw -repeat times per sample
+    const char* jsonPath = NULL;
+    SkFILEWStream* jsonFile = NULL;
+    const char* skpDir = NULL;
+    bool skpDeserialize = false;
+    bool skpOps = false;
+    bool memory = false;
+    int memorySites = 0;
+    int frameCount = 0;
     
     SkString outDir;
     SkBitmap::Config outConfig = SkBitmap::kNo_Config;
@@ -309,6 +809,81 @@ int main (int argc, char * const argv[]) {
                 log_error("missing arg for -strokeWidth\n");
                 return -1;
             }
+        } else if (strcmp(*argv, "-warmup") == 0) {
+            argv++;
+            if (argv < stop) {
+                warmupDraws = SkMax32(atoi(*argv), 0);
+            } else {
+                log_error("missing arg for -warmup\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-samples") == 0) {
+            argv++;
+            if (argv < stop) {
+                sampleCount = SkMax32(atoi(*argv), 1);
+            } else {
+                log_error("missing arg for -samples\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-calibrate") == 0) {
+            argv++;
+            if (argv < stop) {
+                calibrateMSecs = atof(*argv);
+            } else {
+                log_error("missing arg for -calibrate\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-json") == 0) {
+            argv++;
+            if (argv < stop) {
+                jsonPath = *argv;
+            } else {
+                log_error("missing arg for -json\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-skps") == 0) {
+            argv++;
+            if (argv < stop) {
+                skpDir = *argv;
+            } else {
+                log_error("missing arg for -skps\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-skpDeserialize") == 0) {
+            skpDeserialize = true;
+        } else if (strcmp(*argv, "-skpOps") == 0) {
+            skpOps = true;
+        } else if (strcmp(*argv, "-memory") == 0) {
+            memory = true;
+        } else if (strcmp(*argv, "-memorySites") == 0) {
+            argv++;
+            if (argv < stop) {
+                memorySites = SkMax32(atoi(*argv), 0);
+                memory = true;
+            } else {
+                log_error("missing arg for -memorySites\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-frames") == 0) {
+            argv++;
+            if (argv < stop) {
+                frameCount = SkMax32(atoi(*argv), 0);
+            } else {
+                log_error("missing arg for -frames\n");
+                return -1;
+            }
+        } else if (strcmp(*argv, "-threads") == 0) {
+            argv++;
+            if (argv < stop) {
+                threadCount = atoi(*argv);
+                if (threadCount < 1) {
+                    log_error("bad arg for -threads\n");
+                    return -1;
+                }
+            } else {
+                log_error("missing arg for -threads\n");
+                return -1;
+            }
         } else if (strcmp(*argv, "-match") == 0) {
             argv++;
             if (argv < stop) {
@@ -374,6 +949,16 @@ int main (int argc, char * const argv[]) {
         } else {
             str.append(" strokeWidth=none");
         }
+        if (threadCount > 0) {
+            str.appendf(" threads=%d", threadCount);
+        }
+        if (frameCount > 0) {
+            str.appendf(" frames=%d", frameCount);
+        }
+        if (memory) {
+            str.appendf(" memory=%s", SkMemoryTracker::IsEnabled() ?
+                        "tracked" : "caches");
+        }
         
 #if defined(SK_SCALAR_IS_FLOAT)
         str.append(" scalar=float");
@@ -396,6 +981,21 @@ int main (int argc, char * const argv[]) {
 #if defined(SK_DEBUG)
         str.append(" DEBUG");
 #endif
+        
+        if (jsonPath) {
+            SkString json("{\"settings\": ");
+            appendJSONString(&json, str.c_str());
+            json.append(",\n \"results\": [");
+            jsonFile = new SkFILEWStream(jsonPath);
+            if (!jsonFile->isValid()) {
+                SkString err;
+                err.printf("could not open %s\n", jsonPath);
+                log_error(err);
+                delete jsonFile;
+                return -1;
+            }
+            jsonFile->writeText(json.c_str());
+        }
         str.append("\n");
         log_progress(str);
     }
@@ -410,8 +1010,10 @@ int main (int argc, char * const argv[]) {
 #endif
     
     BenchTimer timer = BenchTimer();
+    BenchFrameTimer frameTimer;
+    int jsonResults = 0;
     
-    Iter iter(&defineDict);
+    Iter iter(&defineDict, skpDir, skpDeserialize);
     SkBenchmark* bench;
     while ((bench = iter.next()) != NULL) {
         SkIPoint dim = bench->getSize();
@@ -419,19 +1021,27 @@ int main (int argc, char * const argv[]) {
             continue;
         }
         
-        bench->setForceAlpha(forceAlpha);
-        bench->setForceAA(forceAA);
-        bench->setForceFilter(forceFilter);
-        bench->setDither(forceDither);
-        if (hasStrokeWidth) {
-            bench->setStrokeWidth(strokeWidth);
-        }
-        
         // only run benchmarks if their name contains matchStr
         if (matchStr && strstr(bench->getName(), matchStr) == NULL) {
             continue;
         }
         
+        // the first is the bench itself, the others are made for -threads
+        SkAutoTArray<SkBenchmark*> benches(SkMax32(threadCount, 1));
+        benches[0] = bench;
+        for (int i = 1; i < threadCount; i++) {
+            benches[i] = iter.again();
+        }
+        for (int i = 0; i < SkMax32(threadCount, 1); i++) {
+            benches[i]->setForceAlpha(forceAlpha);
+            benches[i]->setForceAA(forceAA);
+            benches[i]->setForceFilter(forceFilter);
+            benches[i]->setDither(forceDither);
+            if (hasStrokeWidth) {
+                benches[i]->setStrokeWidth(strokeWidth);
+            }
+        }
+        
         {
             SkString str;
             str.printf("running bench [%d %d] %28s", dim.fX, dim.fY,
@@ -450,58 +1060,253 @@ int main (int argc, char * const argv[]) {
                 continue;
             }
             
+            if (threadCount > 0) {
+                // a GrContext may only be used by one thread
+                if (kGPU_Backend == backend) {
+                    continue;
+                }
+                SkAutoTArray<ThreadBench> runs(threadCount);
+                int32_t ready = 0;
+                SkThreadPool pool(threadCount);
+                // if we didn't get every thread, the runs take turns
+                const int together = pool.threadCount() == threadCount ?
+                                     threadCount : 1;
+                for (int i = 0; i < threadCount; i++) {
+                    runs[i].fBench = benches[i];
+                    runs[i].fConfig = outConfig;
+                    runs[i].fBackend = backend;
+                    runs[i].fRepeatDraw = repeatDraw;
+                    runs[i].fDoClip = doClip;
+                    runs[i].fDoScale = doScale;
+                    runs[i].fDoRotate = doRotate;
+                    runs[i].fThreadCount = together;
+                    runs[i].fReady = &ready;
+                    pool.add(&runs[i]);
+                }
+                pool.wait();
+                
+                // the threads start together, so the slowest one's time is
+                // the time they all took
+                double wall = 0;
+                for (int i = 0; i < threadCount; i++) {
+                    if (runs[i].fTotalMSecs > wall) {
+                        wall = runs[i].fTotalMSecs;
+                    }
+                }
+                SkString str;
+                str.printf("\n  %4s: draws/sec = %8.1f  p50/p99 msecs =",
+                           configName, wall > 0 ?
+                           threadCount * repeatDraw * 1000 / wall : 0);
+                for (int i = 0; i < threadCount; i++) {
+                    SkTDArray<double>& msecs = runs[i].fMSecs;
+                    qsort(msecs.begin(), msecs.count(), sizeof(double),
+                          compare_msecs);
+                    str.appendf(" %.2f/%.2f", percentile(msecs, 0.5),
+                                percentile(msecs, 0.99));
+                }
+                log_progress(str);
+                continue;
+            }
+            
             SkDevice* device = make_device(outConfig, dim, backend, context);
             SkCanvas canvas(device);
             device->unref();
             
-            if (doClip) {
-                performClip(&canvas, dim.fX, dim.fY);
-            }
-            if (doScale) {
-                performScale(&canvas, dim.fX, dim.fY);
-            }
-            if (doRotate) {
-                performRotate(&canvas, dim.fX, dim.fY);
+            performTransforms(&canvas, dim, doClip, doScale, doRotate);
+            
+            // recorded before the timer starts, so only playback is timed
+            SkPicture picture;
+            MemoryDelta recordMemory, firstMemory, drawMemory;
+            if (kPlayback_Backend == backend) {
+                recordMemory.start();
+                bench->draw(picture.beginRecording(dim.fX, dim.fY));
+                picture.endRecording();
+                recordMemory.end();
             }
             
             bool gpu = kGPU_Backend == backend && context;
             //warm up caches if needed
-            if (repeatDraw > 1) {
+            int warmups = warmupDraws;
+            if (warmups < 0) {
+                warmups = (repeatDraw > 1 || sampleCount > 1 ||
+                           calibrateMSecs > 0) ? 1 : 0;
+            }
+            // the first draw is the one that fills the caches
+            if (memory) {
+                warmups = SkMax32(warmups, 1);
+            }
+            for (int i = 0; i < warmups; i++) {
+                if (0 == i) {
+                    firstMemory.start();
+                }
                 SkAutoCanvasRestore acr(&canvas, true);
-                bench->draw(&canvas);
+                drawBench(bench, backend, &canvas, picture, dim, doClip,
+                          doScale, doRotate);
                 if (gpu) {
                     context->flush();
                     glFinish();
                 }
+                if (0 == i) {
+                    firstMemory.end();
+                }
             }
             
-            timer.start();
-            for (int i = 0; i < repeatDraw; i++) {
-                SkAutoCanvasRestore acr(&canvas, true);
-                bench->draw(&canvas);
+            // double the draws per sample until a sample takes long enough
+            int loops = repeatDraw;
+            if (calibrateMSecs > 0) {
+                for (loops = 1; loops < kMaxCalibratedLoops; loops *= 2) {
+                    timer.start();
+                    for (int i = 0; i < loops; i++) {
+                        SkAutoCanvasRestore acr(&canvas, true);
+                        drawBench(bench, backend, &canvas, picture, dim,
+                                  doClip, doScale, doRotate);
+                    }
+                    timer.end();
+                    if (timer.fWall >= calibrateMSecs) {
+                        break;
+                    }
+                }
             }
-            timer.end();
             
-            if (repeatDraw > 1) {
+            // each sample is the time per draw, over loops draws
+            SkTDArray<double> wallSamples, cpuSamples, gpuSamples;
+            drawMemory.start();
+            for (int s = 0; s < sampleCount; s++) {
+                timer.start();
+                for (int i = 0; i < loops; i++) {
+                    SkAutoCanvasRestore acr(&canvas, true);
+                    drawBench(bench, backend, &canvas, picture, dim, doClip,
+                              doScale, doRotate);
+                }
+                timer.end();
+                *wallSamples.append() = timer.fWall / loops;
+                *cpuSamples.append() = timer.fCpu / loops;
+                if (gpu && timer.fGpu > 0) {
+                    *gpuSamples.append() = timer.fGpu / loops;
+                }
+            }
+            drawMemory.end();
+            
+            // then frames of the same draws, each one flushed and finished
+            FrameTimes frames;
+            const bool doFrames = gpu && frameCount > 0;
+            if (doFrames) {
+                for (int f = 0; f < frameCount; f++) {
+                    frameTimer.start();
+                    for (int i = 0; i < loops; i++) {
+                        SkAutoCanvasRestore acr(&canvas, true);
+                        drawBench(bench, backend, &canvas, picture, dim,
+                                  doClip, doScale, doRotate);
+                    }
+                    context->flush();
+                    frameTimer.submitted();
+                    glFinish();
+                    frameTimer.finished();
+                    frames.add(frameTimer);
+                }
+                frames.finish();
+            }
+            Stats wallStats, cpuStats, gpuStats;
+            computeStats(wallSamples, &wallStats);
+            computeStats(cpuSamples, &cpuStats);
+            if (gpuSamples.count() > 0) {
+                computeStats(gpuSamples, &gpuStats);
+            }
+            
+            // kernel benches also get the cpu time per pixel (or op)
+            const int units = bench->getUnitsPerDraw();
+
+            // with several samples, the median stands in for the mean
+            if (loops * sampleCount > 1) {
                 SkString str;
                 str.printf("  %4s:", configName);
                 if (timerWall) {
-                    str.appendf(" msecs = %6.2f", timer.fWall / repeatDraw);
+                    str.appendf(" msecs = %6.2f", wallStats.fMedian);
                 }
                 if (timerCpu) {
-                    str.appendf(" cmsecs = %6.2f", timer.fCpu / repeatDraw);
+                    str.appendf(" cmsecs = %6.2f", cpuStats.fMedian);
                 }
-                if (timerGpu && gpu && timer.fGpu > 0) {
-                    str.appendf(" gmsecs = %6.2f", timer.fGpu / repeatDraw);
+                if (timerGpu && gpuSamples.count() > 0) {
+                    str.appendf(" gmsecs = %6.2f", gpuStats.fMedian);
+                }
+                if (units > 0) {
+                    str.appendf(" cnsecs/unit = %6.3f",
+                                cpuStats.fMedian * 1000000 / units);
+                }
+                log_progress(str);
+            }
+            if (memory) {
+                SkString str("\n  mem:");
+                if (kPlayback_Backend == backend) {
+                    recordMemory.append(&str, "record", 1);
                 }
+                firstMemory.append(&str, "first", 1);
+                drawMemory.append(&str, "draw", loops * sampleCount);
                 log_progress(str);
             }
-            if (outDir.size() > 0) {
+            if (doFrames) {
+                SkString str;
+                frames.append(&str);
+                log_progress(str);
+            }
+            // once more, straight into the device's canvas (the other
+            // backends would only add their own calls), to see where the
+            // time goes
+            SkpBench* skp = iter.lastSkp();
+            if (skpOps && skp && SkpBench::kDraw_Mode == skp->getMode() &&
+                    (kRaster_Backend == backend || kGPU_Backend == backend)) {
+                SkString str;
+                SkAutoCanvasRestore acr(&canvas, true);
+                skp->appendOpTimes(&canvas, &str);
+                str.append("\n");
+                log_progress(str);
+            }
+            if (jsonFile) {
+                SkString json(jsonResults ? ",\n  {" : "\n  {");
+                json.append("\"bench\": ");
+                appendJSONString(&json, bench->getName());
+                json.append(", \"config\": ");
+                appendJSONString(&json, configName);
+                json.appendf(", \"loops\": %d", loops);
+                if (units > 0) {
+                    json.appendf(", \"units\": %d", units);
+                }
+                appendJSONTimes(&json, "wall", wallSamples, wallStats);
+                appendJSONTimes(&json, "cpu", cpuSamples, cpuStats);
+                if (gpuSamples.count() > 0) {
+                    appendJSONTimes(&json, "gpu", gpuSamples, gpuStats);
+                }
+                if (memory) {
+                    if (kPlayback_Backend == backend) {
+                        recordMemory.appendJSON(&json, "mem_record", 1);
+                    }
+                    firstMemory.appendJSON(&json, "mem_first", 1);
+                    drawMemory.appendJSON(&json, "mem_draw",
+                                          loops * sampleCount);
+                }
+                if (doFrames) {
+                    frames.appendJSON(&json);
+                }
+                json.append("}");
+                jsonFile->writeText(json.c_str());
+                jsonResults += 1;
+            }
+            if (outDir.size() > 0 && !draws_offscreen(backend)) {
                 saveFile(bench->getName(), configName, outDir.c_str(),
                          device->accessBitmap(false));
             }
         }
         log_progress("\n");
+        for (int i = 1; i < threadCount; i++) {
+            benches[i]->unref();
+        }
+    }
+    if (jsonFile) {
+        jsonFile->writeText("\n]}\n");
+        delete jsonFile;
+    }
+    if (memorySites > 0) {
+        log_memory_sites(memorySites);
     }
     
     return 0;
@@ -233,11 +233,13 @@ bool SkDumpCanvasM::clipRect(const SkRect& rect, SkRegion::Op op) {
     return this->INHERITED::clipRect(rect, op);
 }
 
-bool SkDumpCanvasM::clipPath(const SkPath& path, SkRegion::Op op) {
+bool SkDumpCanvasM::clipPath(const SkPath& path, SkRegion::Op op,
+                             bool doAntiAlias) {
     SkString str;
     toString(path, &str);
-    this->dump(kClip_Verb, NULL, "clipPath(%s %s)", str.c_str(), toString(op));
-    return this->INHERITED::clipPath(path, op);
+    this->dump(kClip_Verb, NULL, "clipPath(%s %s %s)", str.c_str(), toString(op),
+               doAntiAlias ? "AA" : "BW");
+    return this->INHERITED::clipPath(path, op, doAntiAlias);
 }
 
 bool SkDumpCanvasM::clipRegion(const SkRegion& deviceRgn, SkRegion::Op op) {
@@ -7,6 +7,9 @@
 #include "SkPicture.h"
 #include "SkStream.h"
 #include "SkRefCnt.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
 
 #include "GrContext.h"
 #include "SkGpuCanvas.h"
@@ -19,6 +22,10 @@
     #include "SkPDFDocument.h"
 #endif
 
+#ifndef SK_BUILD_FOR_WIN
+    #include "SkMMapStream.h"
+#endif
+
 #ifdef SK_BUILD_FOR_MAC
     #include "SkCGUtils.h"
     #define CAN_IMAGE_PDF   true
@@ -92,8 +99,289 @@ static void force_all_opaque(const SkBitmap& bitmap) {
     SkAutoLockPixels lock(bitmap);
     for (int y = 0; y < bitmap.height(); y++) {
         for (int x = 0; x < bitmap.width(); x++) {
-            *bitmap.getAddr32(x, y) |= (SK_A32_MASK << SK_A32_SHIFT);
+            // cached reference images are mapped read-only, and already
+            // opaque, so only write what needs changing
+            uint32_t* addr = bitmap.getAddr32(x, y);
+            if (SkGetPackedA32(*addr) != 0xFF) {
+                *addr |= (SK_A32_MASK << SK_A32_SHIFT);
+            }
+        }
+    }
+}
+
+// 64-bit FNV-1a
+static uint64_t hash_bytes(const void* data, size_t length,
+                           uint64_t hash = 0xCBF29CE484222325ULL) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// hashes what compare() would compare: the pixels as opaque 8888
+static uint64_t hash_rendered(const SkBitmap& bitmap) {
+    SkBitmap copy;
+    const SkBitmap* bm = &bitmap;
+    if (bitmap.config() != SkBitmap::kARGB_8888_Config) {
+        bitmap.copyTo(&copy, SkBitmap::kARGB_8888_Config);
+        bm = &copy;
+    }
+    int32_t size[2] = { bm->width(), bm->height() };
+    uint64_t hash = hash_bytes(size, sizeof(size));
+
+    SkAutoLockPixels alp(*bm);
+    SkAutoTMalloc<uint32_t> storage(bm->width());
+    uint32_t* row = storage.get();
+    for (int y = 0; y < bm->height(); y++) {
+        const uint32_t* src = bm->getAddr32(0, y);
+        for (int x = 0; x < bm->width(); x++) {
+            row[x] = src[x] | (SK_A32_MASK << SK_A32_SHIFT);
+        }
+        hash = hash_bytes(row, bm->width() * sizeof(uint32_t), hash);
+    }
+    return hash;
+}
+
+/*  For --cache: keeps the reference images from readPath decoded between
+    runs, in a file that is mapped in rather than read, along with the hash
+    of the last rendering that matched each one. A cached image is only used
+    while its PNG is byte for byte the same as when it was cached (which is
+    much cheaper to check than decoding it), and a rendering whose hash
+    matches needn't be compared at all.
+
+    The file is a header (magic, version, count), followed by that many
+    entries, each 4-byte aligned:
+        uint32  name length, width, height, unused
+        uint64  PNG hash, hash of the last matching rendering (0 for none)
+        name, then width * height opaque 8888 pixels
+ */
+class ReferenceCache {
+public:
+    ReferenceCache() : fStream(NULL), fDirty(false), fSkipped(0) {}
+
+    ~ReferenceCache() {
+        fEntries.deleteAll();
+        SkSafeUnref(fStream);
+    }
+
+    // Returns false if there is no usable cache at path, in which case the
+    // cache starts out empty.
+    bool load(const char path[]);
+
+    // Writes the cache back to path, if anything in it changed.
+    bool save(const char path[]);
+
+    // Returns true if name's reference image is cached for that PNG, and
+    // sets bitmap to it (which must not be modified) and matchHash to the
+    // hash of the last rendering that matched it.
+    bool find(const SkString& name, uint64_t pngHash, SkBitmap* bitmap,
+              uint64_t* matchHash);
+
+    // Caches (a copy of) name's reference image, decoded from that PNG.
+    void add(const SkString& name, uint64_t pngHash, const SkBitmap& bitmap);
+
+    // Records that a rendering with matchHash matched name's reference.
+    void setMatch(const SkString& name, uint64_t pngHash, uint64_t matchHash);
+
+    // for the renderings that weren't compared since their hash matched
+    void incSkipped() { sk_atomic_inc(&fSkipped); }
+    int skipped() const { return fSkipped; }
+
+private:
+    struct Entry {
+        SkString    fName;
+        uint64_t    fPNGHash;
+        uint64_t    fMatchHash;
+        SkBitmap    fBitmap;    // may point into fStream
+    };
+
+    enum {
+        kMagic = 0x434D4752,    // 'GMRC'
+        kVersion = 1
+    };
+
+    SkMutex             fMutex;
+    SkTDArray<Entry*>   fEntries;
+    SkStream*           fStream;    // holds the loaded file
+    bool                fDirty;
+    int32_t             fSkipped;
+
+    // must be called with fMutex held
+    Entry* findEntry(const SkString& name);
+};
+
+static size_t align4(size_t size) {
+    return (size + 3) & ~3;
+}
+
+bool ReferenceCache::load(const char path[]) {
+    SkAutoMutexAcquire ac(fMutex);
+    SkASSERT(NULL == fStream && 0 == fEntries.count());
+#ifdef SK_BUILD_FOR_WIN
+    SkFILEStream file(path);
+    if (!file.isValid()) {
+        return false;
+    }
+    size_t length = file.getLength();
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream, (length));
+    file.read((void*)stream->getMemoryBase(), length);
+#else
+    SkMMAPStream* stream = SkNEW_ARGS(SkMMAPStream, (path));
+#endif
+    SkAutoUnref aur(stream);
+
+    const char* data = (const char*)stream->getMemoryBase();
+    const size_t length = stream->getLength();
+    if (NULL == data || length < 3 * sizeof(uint32_t)) {
+        return false;
+    }
+    const uint32_t* header = (const uint32_t*)data;
+    if (kMagic != header[0] || kVersion != header[1]) {
+        return false;
+    }
+    const uint32_t count = header[2];
+    size_t offset = 3 * sizeof(uint32_t);
+
+    SkTDArray<Entry*> entries;
+    for (uint32_t i = 0; i < count; i++) {
+        const size_t fixedSize = 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        if (length - offset < fixedSize) {
+            break;
+        }
+        const uint32_t* sizes = (const uint32_t*)(data + offset);
+        const uint64_t* hashes = (const uint64_t*)(sizes + 4);
+        const size_t nameSize = align4(sizes[0]);
+        const size_t pixelSize = (size_t)sizes[1] * sizes[2] * 4;
+        offset += fixedSize;
+        if (length - offset < nameSize ||
+                length - offset - nameSize < pixelSize) {
+            break;
+        }
+
+        Entry* entry = SkNEW(Entry);
+        entry->fName.set(data + offset, sizes[0]);
+        entry->fPNGHash = hashes[0];
+        entry->fMatchHash = hashes[1];
+        offset += nameSize;
+        entry->fBitmap.setConfig(SkBitmap::kARGB_8888_Config,
+                                 sizes[1], sizes[2]);
+        entry->fBitmap.setPixels((void*)(data + offset));
+        entry->fBitmap.setIsOpaque(true);
+        offset += pixelSize;
+        *entries.append() = entry;
+    }
+    if (entries.count() != (int)count) {
+        // truncated, so don't trust any of it
+        entries.deleteAll();
+        return false;
+    }
+
+    fEntries.swap(entries);
+    fStream = stream;
+    fStream->ref();
+    return true;
+}
+
+bool ReferenceCache::save(const char path[]) {
+    SkAutoMutexAcquire ac(fMutex);
+    if (!fDirty) {
+        return true;
+    }
+
+    // write it next to the old one, which may be mapped in, and then swap
+    SkString tmpPath(path);
+    tmpPath.append(".tmp");
+    {
+        SkFILEWStream stream(tmpPath.c_str());
+        if (!stream.isValid()) {
+            return false;
         }
+        stream.write32(kMagic);
+        stream.write32(kVersion);
+        stream.write32(fEntries.count());
+        for (int i = 0; i < fEntries.count(); i++) {
+            const Entry& entry = *fEntries[i];
+            const SkBitmap& bm = entry.fBitmap;
+            stream.write32(entry.fName.size());
+            stream.write32(bm.width());
+            stream.write32(bm.height());
+            stream.write32(0);
+            stream.write(&entry.fPNGHash, sizeof(uint64_t));
+            stream.write(&entry.fMatchHash, sizeof(uint64_t));
+            stream.write(entry.fName.c_str(), entry.fName.size());
+            uint32_t zero = 0;
+            stream.write(&zero, align4(entry.fName.size()) -
+                                entry.fName.size());
+
+            SkAutoLockPixels alp(bm);
+            for (int y = 0; y < bm.height(); y++) {
+                stream.write(bm.getAddr32(0, y), bm.width() * 4);
+            }
+        }
+    }
+#ifdef SK_BUILD_FOR_WIN
+    // the old file is in memory, not mapped, and rename() won't replace it
+    remove(path);
+#endif
+    if (rename(tmpPath.c_str(), path)) {
+        return false;
+    }
+    fDirty = false;
+    return true;
+}
+
+ReferenceCache::Entry* ReferenceCache::findEntry(const SkString& name) {
+    for (int i = 0; i < fEntries.count(); i++) {
+        if (fEntries[i]->fName.equals(name)) {
+            return fEntries[i];
+        }
+    }
+    return NULL;
+}
+
+bool ReferenceCache::find(const SkString& name, uint64_t pngHash,
+                          SkBitmap* bitmap, uint64_t* matchHash) {
+    SkAutoMutexAcquire ac(fMutex);
+    Entry* entry = this->findEntry(name);
+    if (NULL == entry || entry->fPNGHash != pngHash) {
+        return false;
+    }
+    *bitmap = entry->fBitmap;
+    *matchHash = entry->fMatchHash;
+    return true;
+}
+
+void ReferenceCache::add(const SkString& name, uint64_t pngHash,
+                         const SkBitmap& bitmap) {
+    SkBitmap copy;
+    if (!bitmap.copyTo(&copy, SkBitmap::kARGB_8888_Config)) {
+        return;
+    }
+    force_all_opaque(copy);
+    copy.setIsOpaque(true);
+
+    SkAutoMutexAcquire ac(fMutex);
+    Entry* entry = this->findEntry(name);
+    if (NULL == entry) {
+        entry = SkNEW(Entry);
+        entry->fName = name;
+        *fEntries.append() = entry;
+    }
+    entry->fPNGHash = pngHash;
+    entry->fMatchHash = 0;
+    entry->fBitmap = copy;
+    fDirty = true;
+}
+
+void ReferenceCache::setMatch(const SkString& name, uint64_t pngHash,
+                              uint64_t matchHash) {
+    SkAutoMutexAcquire ac(fMutex);
+    Entry* entry = this->findEntry(name);
+    if (entry && entry->fPNGHash == pngHash &&
+            entry->fMatchHash != matchHash) {
+        entry->fMatchHash = matchHash;
+        fDirty = true;
     }
 }
 
@@ -308,20 +596,55 @@ static bool compare_to_reference_image(const SkString& name,
     return success;
 }
 
+static bool read_file(const SkString& path, SkAutoMalloc* storage,
+                      size_t* length) {
+    SkFILEStream stream(path.c_str());
+    if (!stream.isValid()) {
+        return false;
+    }
+    *length = stream.getLength();
+    return stream.read(storage->alloc(*length), *length) == *length;
+}
+
 static bool compare_to_reference_image(const char readPath [],
                                        const SkString& name,
                                        SkBitmap &bitmap,
                                        const char diffPath [],
-                                       const char renderModeDescriptor []) {
+                                       const char renderModeDescriptor [],
+                                       ReferenceCache* cache) {
     SkString path = make_filename(readPath, "", name, "png");
+    SkAutoMalloc png;
+    size_t pngLength = 0;
+    bool success = read_file(path, &png, &pngLength);
+    const uint64_t pngHash = success ? hash_bytes(png.get(), pngLength) : 0;
+
     SkBitmap orig;
-    bool success = SkImageDecoder::DecodeFile(path.c_str(), &orig,
-                        SkBitmap::kARGB_8888_Config,
-                        SkImageDecoder::kDecodePixels_Mode, NULL);
+    uint64_t renderedHash = 0;
+    if (success && cache) {
+        uint64_t matchHash;
+        renderedHash = hash_rendered(bitmap);
+        if (cache->find(name, pngHash, &orig, &matchHash) &&
+                matchHash == renderedHash) {
+            // it matched last time, so it still does
+            cache->incSkipped();
+            return true;
+        }
+    }
+    if (success && orig.isNull()) {
+        success = SkImageDecoder::DecodeMemory(png.get(), pngLength, &orig,
+                            SkBitmap::kARGB_8888_Config,
+                            SkImageDecoder::kDecodePixels_Mode, NULL);
+        if (success && cache) {
+            cache->add(name, pngHash, orig);
+        }
+    }
     if (success) {
         success = compare_to_reference_image(name, bitmap,
                                              orig, diffPath,
                                              renderModeDescriptor);
+        if (success && cache) {
+            cache->setMatch(name, pngHash, renderedHash);
+        }
     } else {
         fprintf(stderr, "FAILED to read %s\n", path.c_str());
         // we lie here, and report succes, since we're just missing a master
@@ -341,7 +664,8 @@ static bool handle_test_results(GM* gm,
                                 const char renderModeDescriptor [],
                                 SkBitmap& bitmap,
                                 SkDynamicMemoryWStream* pdf,
-                                const SkBitmap* comparisonBitmap) {
+                                const SkBitmap* comparisonBitmap,
+                                ReferenceCache* cache) {
     SkString name = make_name(gm->shortName(), gRec.fName);
 
     if (writePath) {
@@ -349,7 +673,7 @@ static bool handle_test_results(GM* gm,
                               name, bitmap, pdf);
     } else if (readPath && (gRec.fBackend != kPDF_Backend || CAN_IMAGE_PDF)) {
         return compare_to_reference_image(readPath, name, bitmap,
-                                   diffPath, renderModeDescriptor);
+                                   diffPath, renderModeDescriptor, cache);
     } else if (comparisonBitmap) {
         return compare_to_reference_image(name, bitmap,
                                    *comparisonBitmap, diffPath,
@@ -399,6 +723,7 @@ static bool test_drawing(GM* gm,
                          const char readPath [],
                          const char diffPath [],
                          GrContext* context,
+                         ReferenceCache* cache,
                          SkBitmap* bitmap) {
     SkDynamicMemoryWStream pdf;
 
@@ -418,7 +743,7 @@ static bool test_drawing(GM* gm,
 #endif
     }
     return handle_test_results(gm, gRec, writePath, readPath, diffPath,
-                        "", *bitmap, &pdf, NULL);
+                        "", *bitmap, &pdf, NULL, cache);
 }
 
 static bool test_picture_playback(GM* gm,
@@ -433,7 +758,7 @@ static bool test_picture_playback(GM* gm,
         SkBitmap bitmap;
         generate_image_from_picture(gm, gRec, pict, &bitmap);
         return handle_test_results(gm, gRec, NULL, NULL, diffPath,
-                            "-replay", bitmap, NULL, &comparisonBitmap);
+                            "-replay", bitmap, NULL, &comparisonBitmap, NULL);
     }
     return true;
 }
@@ -452,14 +777,15 @@ static bool test_picture_serialization(GM* gm,
         SkBitmap bitmap;
         generate_image_from_picture(gm, gRec, repict, &bitmap);
         return handle_test_results(gm, gRec, NULL, NULL, diffPath,
-                            "-serialize", bitmap, NULL, &comparisonBitmap);
+                            "-serialize", bitmap, NULL, &comparisonBitmap,
+                            NULL);
     }
     return true;
 }
 
 static void usage(const char * argv0) {
     SkDebugf("%s [-w writePath] [-r readPath] [-d diffPath]\n", argv0);
-    SkDebugf("    [--replay] [--serialize]\n");
+    SkDebugf("    [--replay] [--serialize] [--threads N] [--cache cachePath]\n");
     SkDebugf("    writePath: directory to write rendered images in.\n");
     SkDebugf(
 "    readPath: directory to read reference images from;\n"
@@ -468,6 +794,11 @@ static void usage(const char * argv0) {
     SkDebugf("    --replay: exercise SkPicture replay.\n");
     SkDebugf(
 "    --serialize: exercise SkPicture serialization & deserialization.\n");
+    SkDebugf(
+"    --threads: draw the raster configs of N GMs at a time (default 1).\n");
+    SkDebugf(
+"    cachePath: file to keep readPath's images decoded in between runs,\n"
+"        and to skip comparing renderings that match the last run's.\n");
 }
 
 static const ConfigData gRec[] = {
@@ -482,37 +813,112 @@ static const ConfigData gRec[] = {
 #endif
 };
 
+struct Options {
+    const char*     fWritePath;
+    const char*     fReadPath;
+    const char*     fDiffPath;
+    bool            fDoReplay;
+    bool            fDoSerialize;
+    ReferenceCache* fCache;
+};
+
+// Runs all the tests of one config on gm, and returns true if they passed.
+static bool test_config(GM* gm, const ConfigData& rec, const Options& opts,
+                        GrContext* context) {
+    SkBitmap forwardRenderedBitmap;
+    bool testSuccess = test_drawing(gm, rec, opts.fWritePath, opts.fReadPath,
+                                    opts.fDiffPath, context, opts.fCache,
+                                    &forwardRenderedBitmap);
+    bool success = testSuccess;
+
+    if (opts.fDoReplay && testSuccess) {
+        testSuccess = test_picture_playback(gm, rec, forwardRenderedBitmap,
+                                            opts.fReadPath, opts.fDiffPath);
+        success &= testSuccess;
+    }
+
+    if (opts.fDoSerialize && testSuccess) {
+        testSuccess &= test_picture_serialization(gm, rec,
+                                                  forwardRenderedBitmap,
+                                                  opts.fReadPath,
+                                                  opts.fDiffPath);
+        success &= testSuccess;
+    }
+    return success;
+}
+
+/*  For --threads: runs the raster configs of a GM on the pool. The GPU (whose
+    context is only current on the main thread) and PDF configs are left for
+    main() to run, on a GM instance of its own, since GMs may keep state
+    between draws.
+ */
+class RasterTask : public SkRunnable {
+public:
+    RasterTask() : fGM(NULL), fOptions(NULL), fSuccess(true) {}
+    ~RasterTask() { SkDELETE(fGM); }
+
+    GM*             fGM;
+    const Options*  fOptions;
+    bool            fSuccess;
+
+    virtual void run() {
+        SkISize size = fGM->getISize();
+        SkDebugf("drawing... %s [%d %d]\n", fGM->shortName(),
+                 size.width(), size.height());
+        for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+            if (kRaster_Backend == gRec[i].fBackend) {
+                fSuccess &= test_config(fGM, gRec[i], *fOptions, NULL);
+            }
+        }
+    }
+};
+
 int main(int argc, char * const argv[]) {
     SkAutoGraphics ag;
 
-    const char* writePath = NULL;   // if non-null, where we write the originals
-    const char* readPath = NULL;    // if non-null, were we read from to compare
-    const char* diffPath = NULL;    // if non-null, where we write our diffs (from compare)
+    Options opts;
+    opts.fWritePath = NULL;     // if non-null, where we write the originals
+    opts.fReadPath = NULL;      // if non-null, were we read from to compare
+    opts.fDiffPath = NULL;      // if non-null, where we write our diffs (from compare)
+    opts.fDoReplay = true;
+    opts.fDoSerialize = false;
+    opts.fCache = NULL;
 
-    bool doReplay = true;
-    bool doSerialize = false;
+    const char* cachePath = NULL;   // if non-null, where we cache readPath
+    int threadCount = 1;
     const char* const commandName = argv[0];
     char* const* stop = argv + argc;
     for (++argv; argv < stop; ++argv) {
         if (strcmp(*argv, "-w") == 0) {
             argv++;
             if (argv < stop && **argv) {
-                writePath = *argv;
+                opts.fWritePath = *argv;
             }
         } else if (strcmp(*argv, "-r") == 0) {
             argv++;
             if (argv < stop && **argv) {
-                readPath = *argv;
+                opts.fReadPath = *argv;
             }
         } else if (strcmp(*argv, "-d") == 0) {
             argv++;
             if (argv < stop && **argv) {
-                diffPath = *argv;
+                opts.fDiffPath = *argv;
             }
         } else if (strcmp(*argv, "--noreplay") == 0) {
-            doReplay = false;
+            opts.fDoReplay = false;
         } else if (strcmp(*argv, "--serialize") == 0) {
-            doSerialize = true;
+            opts.fDoSerialize = true;
+        } else if (strcmp(*argv, "--threads") == 0) {
+            argv++;
+            if (argv >= stop || (threadCount = atoi(*argv)) < 1) {
+                usage(commandName);
+                return -1;
+            }
+        } else if (strcmp(*argv, "--cache") == 0) {
+            argv++;
+            if (argv < stop && **argv) {
+                cachePath = *argv;
+            }
         } else {
           usage(commandName);
           return -1;
@@ -531,6 +937,7 @@ int main(int argc, char * const argv[]) {
         SkISize size = gm->getISize();
         maxW = SkMax32(size.width(), maxW);
         maxH = SkMax32(size.height(), maxH);
+        SkDELETE(gm);
     }
     // setup a GL context for drawing offscreen
     GrContext* context = NULL;
@@ -540,44 +947,72 @@ int main(int argc, char * const argv[]) {
     }
 
 
-    if (readPath) {
-        fprintf(stderr, "reading from %s\n", readPath);
-    } else if (writePath) {
-        fprintf(stderr, "writing to %s\n", writePath);
+    if (opts.fReadPath) {
+        fprintf(stderr, "reading from %s\n", opts.fReadPath);
+    } else if (opts.fWritePath) {
+        fprintf(stderr, "writing to %s\n", opts.fWritePath);
+    }
+
+    ReferenceCache cache;
+    if (cachePath && opts.fReadPath && !opts.fWritePath) {
+        if (!cache.load(cachePath)) {
+            fprintf(stderr, "starting a new cache in %s\n", cachePath);
+        }
+        opts.fCache = &cache;
     }
 
     // Accumulate success of all tests so we can flag error in any
     // one with the return value.
-    iter.reset();
     bool overallSuccess = true;
-    while ((gm = iter.next()) != NULL) {
-        SkISize size = gm->getISize();
-        SkDebugf("drawing... %s [%d %d]\n", gm->shortName(),
-                 size.width(), size.height());
-        SkBitmap forwardRenderedBitmap;
+    if (threadCount > 1) {
+        // this only takes effect if nothing has used the pool yet
+        SkTaskGroup::SetThreadCount(threadCount - 1);
+
+        SkAutoTArray<RasterTask> tasks(Iter::Count());
+        SkTaskGroup group;
+        iter.reset();
+        for (int i = 0; (gm = iter.next()) != NULL; i++) {
+            tasks[i].fGM = gm;
+            tasks[i].fOptions = &opts;
+            group.add(&tasks[i]);
+        }
 
-        for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
-            bool testSuccess = test_drawing(gm, gRec[i],
-                         writePath, readPath, diffPath, context,
-                         &forwardRenderedBitmap);
-            overallSuccess &= testSuccess;
-
-            if (doReplay && testSuccess) {
-                testSuccess = test_picture_playback(gm, gRec[i],
-                                      forwardRenderedBitmap,
-                                      readPath, diffPath);
-                overallSuccess &= testSuccess;
+        iter.reset();
+        while ((gm = iter.next()) != NULL) {
+            for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+                if (kRaster_Backend != gRec[i].fBackend) {
+                    overallSuccess &= test_config(gm, gRec[i], opts,
+                                                  context);
+                }
             }
+            SkDELETE(gm);
+        }
 
-            if (doSerialize && testSuccess) {
-                testSuccess &= test_picture_serialization(gm, gRec[i],
-                                      forwardRenderedBitmap,
-                                      readPath, diffPath);
-                overallSuccess &= testSuccess;
+        group.wait();
+        for (int i = 0; i < Iter::Count(); i++) {
+            overallSuccess &= tasks[i].fSuccess;
+        }
+    } else {
+        iter.reset();
+        while ((gm = iter.next()) != NULL) {
+            SkISize size = gm->getISize();
+            SkDebugf("drawing... %s [%d %d]\n", gm->shortName(),
+                     size.width(), size.height());
+
+            for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+                overallSuccess &= test_config(gm, gRec[i], opts, context);
             }
+            SkDELETE(gm);
         }
-        SkDELETE(gm);
     }
+
+    if (opts.fCache) {
+        fprintf(stderr, "%d renderings matched the cache\n", cache.skipped());
+        if (!cache.save(cachePath)) {
+            fprintf(stderr, "FAILED to write %s\n", cachePath);
+        }
+    }
+
     if (false == overallSuccess) {
         return -1;
     }
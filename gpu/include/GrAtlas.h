@@ -38,6 +38,9 @@ public:
 
     bool addSubImage(int width, int height, const void*, GrIPoint16*);
 
+    // fraction of the plot's area taken by sub images
+    float percentFull() const;
+
     static void FreeLList(GrAtlas* atlas) {
         while (atlas) {
             GrAtlas* next = atlas->fNext;
@@ -21,6 +21,7 @@
 #include "GrClip.h"
 #include "GrTextureCache.h"
 #include "GrPaint.h"
+#include "GrConvexPathRenderer.h"
 #include "GrPathRenderer.h"
 
 class GrFontCache;
@@ -28,7 +29,11 @@ class GrGpu;
 struct GrGpuStats;
 class GrVertexBufferAllocPool;
 class GrIndexBufferAllocPool;
+class GrImageAtlas;
 class GrInOrderDrawBuffer;
+class GrPixelRead;
+class GrRenderTargetPool;
+class SkPurgeableCache;
 
 class GR_API GrEGLImage : public GrRefCnt {
 public:
@@ -96,6 +101,20 @@ public:
      */
     void freeGpuResources();
 
+    /**
+     * Repacks cached glyphs that are spread over more of the glyph atlas than
+     * they need, releasing atlas space. Glyphs that aren't drawn anymore
+     * don't come back. Meant to be called on idle frames, since the glyphs
+     * that are drawn next have to be rasterized again.
+     */
+    void compactGlyphAtlases();
+
+    /**
+     * Marks the start of a new frame. Pooled scratch render targets that
+     * haven't been used for a few frames are released.
+     */
+    void newFrame();
+
     ///////////////////////////////////////////////////////////////////////////
     // Textures
 
@@ -143,12 +162,47 @@ public:
      */
     GrTextureEntry* findApproximateKeylessTexture(const GrTextureDesc& desc);
 
+    /**
+     * Returns a scratch render target texture from the render target pool,
+     * at least as large as desc and with its config and aa level. Sizes are
+     * bucketed, so targets whose size changes a little reuse the same
+     * texture. It has a stencil buffer unless desc sets the no stencil flag.
+     * Its contents are unknown. The texture is ref'ed and must be returned
+     * with unlockScratchRenderTarget().
+     */
+    GrTexture* lockScratchRenderTarget(const GrTextureDesc& desc);
+
+    /**
+     * Returns a texture from lockScratchRenderTarget() to the pool.
+     */
+    void unlockScratchRenderTarget(GrTexture* texture);
+
     /**
      *  When done with an entry, call unlockTexture(entry) on it, which returns
      *  it to the cache, where it may be purged.
      */
     void unlockTexture(GrTextureEntry* entry);
 
+    /**
+     * Finds a small RGBA 8888 image in the image atlas, adding it if needed.
+     * The atlas packs such images into shared textures, so that consecutive
+     * draws of different images can be batched into one. The image is
+     * identified by p0, p1 and its size, like a GrTextureKey.
+     *
+     * @param pixels    the image's pixels, only read if it is added.
+     * @param rowBytes  bytes between the starts of rows in pixels.
+     * @param bounds    set to where the image is in the returned texture.
+     *
+     * @return the texture holding the image, or NULL if the image is too big
+     *         for the atlas. The texture isn't ref'ed. The image is only
+     *         sure to stay at bounds until findOrAddAtlasImage() is called
+     *         again, which may flush draws and start the atlas over.
+     */
+    GrTexture* findOrAddAtlasImage(uint32_t p0, uint32_t p1,
+                                   int width, int height,
+                                   const void* pixels, size_t rowBytes,
+                                   GrIRect* bounds);
+
     /**
      * Creates a texture that is outside the cache. Does not count against
      * cache's budget.
@@ -162,6 +216,56 @@ public:
      */
     bool supportsIndex8PixelConfig(const GrSamplerState&, int width, int height);
 
+    /**
+     *  Returns true if the specified use of a texture of a compressed config
+     *  (e.g. kETC1_GrPixelConfig) is supported. Compressed textures can't be
+     *  stretched to a power of two, so this is false whenever they'd need to
+     *  be.
+     */
+    bool supportsCompressedPixelConfig(GrPixelConfig,
+                                       const GrSamplerState&,
+                                       int width, int height);
+
+    /**
+     *  Returns true if convolveInX() and convolveInY() are supported.
+     */
+    bool supportsConvolution() const;
+
+    /**
+     *  Returns true if the radial, two-point radial and sweep sample modes
+     *  of GrSamplerState are supported. Otherwise only linear gradients can
+     *  be drawn, as 1D texture lookups.
+     */
+    bool supportsGradients() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Profiling
+
+    /**
+     *  Returns the counters of the work given to the GPU in a pass (see
+     *  GrGpuPass) since the last resetStats(), or summed over all of them if
+     *  pass is kGrGpuPassCount. Buffered draws are only counted once they are
+     *  flushed. The counters other than the GPU time are only collected when
+     *  GR_COLLECT_STATS is set.
+     *
+     *  GPU times come from timer queries (see enableGpuTimers). Only the
+     *  results the GPU has already returned are included, unless wait is
+     *  true, which stalls until the GPU has finished everything given to it.
+     */
+    const GrGpuStats& getPassStats(GrGpuPass pass, bool wait = false);
+
+    /**
+     *  Returns true if the GPU can time the passes.
+     */
+    bool supportsGpuTimers() const;
+
+    /**
+     *  Starts or stops timing the passes on the GPU, which adds a few 3D API
+     *  calls each time the pass changes. Off by default, and ignored if
+     *  supportsGpuTimers() is false.
+     */
+    void enableGpuTimers(bool enable);
+
     /**
      *  Return the current texture cache limits.
      *
@@ -433,6 +537,34 @@ public:
                             const TEX_SRC* texCoordSrc,
                             const COL_SRC* colorSrc);
 
+    /**
+     * Convolves a rect of the texture in x with a kernel centered on each
+     * texel, and draws the result to the same rect of the render target,
+     * replacing what was there. Texels outside the texture are clamped to
+     * its edges. The rect is in texels and is transformed by the context's
+     * matrix. Only supported if supportsConvolution() is true.
+     *
+     * @param texture       the texture to read, which must not be the render
+     *                      target.
+     * @param rect          the rect to convolve.
+     * @param kernel        the weights, applied from left to right.
+     * @param kernelWidth   the number of weights, odd and no more than
+     *                      GrSamplerState::kMaxKernelWidth.
+     */
+    void convolveInX(GrTexture* texture,
+                     const GrRect& rect,
+                     const float* kernel,
+                     int kernelWidth);
+
+    /**
+     * Same as convolveInX(), but convolves in y, applying the kernel from top
+     * to bottom.
+     */
+    void convolveInY(GrTexture* texture,
+                     const GrRect& rect,
+                     const float* kernel,
+                     int kernelWidth);
+
     ///////////////////////////////////////////////////////////////////////////
     // Misc.
 
@@ -484,6 +616,22 @@ public:
                                 int left, int top, int width, int height,
                                 GrPixelConfig config, void* buffer);
 
+    /**
+     * Starts reading a rectangle of pixels from a render target, without
+     * waiting for the drawing already issued to it to finish. The parameters
+     * are the same as readRenderTargetPixels(). The pixels are copied out
+     * with GrPixelRead::finish(); doing that a frame or two later lets the
+     * readback overlap with rendering. The caller must unref the read.
+     *
+     * @return the read, or NULL if the 3D API can't read asynchronously or
+     *         the config is unsupported. readRenderTargetPixels() can be
+     *         used instead.
+     */
+    GrPixelRead* beginReadRenderTargetPixels(GrRenderTarget* target,
+                                             int left, int top,
+                                             int width, int height,
+                                             GrPixelConfig config);
+
     /**
      * Reads a rectangle of pixels from a texture.
      * @param texture       the render target to read from.
@@ -552,11 +700,15 @@ private:
     };
     DrawCategory fLastDrawCategory;
 
-    GrGpu*          fGpu;
-    GrTextureCache* fTextureCache;
-    GrFontCache*    fFontCache;
+    GrGpu*              fGpu;
+    GrTextureCache*     fTextureCache;
+    SkPurgeableCache*   fPurgeableCache;    // fTextureCache's, for SkGraphics
+    GrFontCache*        fFontCache;
+    GrImageAtlas*       fImageAtlas;
+    GrRenderTargetPool* fRenderTargetPool;
 
     GrPathRenderer*         fCustomPathRenderer;
+    GrConvexPathRenderer    fConvexPathRenderer;
     GrDefaultPathRenderer   fDefaultPathRenderer;
 
     GrVertexBufferAllocPool*    fDrawBufferVBAllocPool;
@@ -594,10 +746,21 @@ private:
                             const GrSamplerState&,
                             bool keyless) const;
 
+    // true if the texture doesn't need to be stretched to a pow2 size
+    bool canTextureWithoutStretch(const GrSamplerState&,
+                                  int width, int height) const;
+
     GrDrawTarget* prepareToDraw(const GrPaint& paint, DrawCategory drawType);
 
     void drawClipIntoStencil();
 
+    void convolve(GrTexture* texture,
+                  const GrRect& rect,
+                  float imageIncrementX,
+                  float imageIncrementY,
+                  const float* kernel,
+                  int kernelWidth);
+
     GrPathRenderer* getPathRenderer(const GrDrawTarget*, const GrPath&, GrPathFill);
 
     struct OffscreenRecord;
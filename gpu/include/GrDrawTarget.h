@@ -369,6 +369,11 @@ public:
      */
     void setColor(GrColor);
 
+    /**
+     *  Gets the color set for the next draw.
+     */
+    GrColor getColor() const { return fCurrDrawState.fColor; }
+
     /**
      * Add a color filter that can be represented by a color and a mode.
      */
@@ -102,8 +102,11 @@
 #define GR_GL_ELEMENT_ARRAY_BUFFER           0x8893
 #define GR_GL_ARRAY_BUFFER_BINDING           0x8894
 #define GR_GL_ELEMENT_ARRAY_BUFFER_BINDING   0x8895
+#define GR_GL_PIXEL_PACK_BUFFER              0x88EB
+#define GR_GL_PIXEL_UNPACK_BUFFER            0x88EC
 
 #define GR_GL_STREAM_DRAW                    0x88E0
+#define GR_GL_STREAM_READ                    0x88E1
 #define GR_GL_STATIC_DRAW                    0x88E4
 #define GR_GL_DYNAMIC_DRAW                   0x88E8
 
@@ -297,6 +300,8 @@
 #define GR_GL_LUMINANCE                      0x1909
 #define GR_GL_LUMINANCE_ALPHA                0x190A
 #define GR_GL_PALETTE8_RGBA8                 0x8B96
+#define GR_GL_ETC1_RGB8                      0x8D64
+#define GR_GL_COMPRESSED_RGB_S3TC_DXT1       0x83F0
 
 /* PixelType */
 /*      GL_UNSIGNED_BYTE */
@@ -328,6 +333,24 @@
 #define GR_GL_MAX_FRAGMENT_UNIFORM_COMPONENTS  0x8B49
 #define GR_GL_MAX_VERTEX_UNIFORM_COMPONENTS    0x8B4A
 
+/* Program binaries (GL 4.1, ARB & OES get_program_binary) */
+#define GR_GL_PROGRAM_BINARY_LENGTH            0x8741
+#define GR_GL_NUM_PROGRAM_BINARY_FORMATS       0x87FE
+#define GR_GL_PROGRAM_BINARY_FORMATS           0x87FF
+
+/* Sync Objects */
+#define GR_GL_SYNC_GPU_COMMANDS_COMPLETE       0x9117
+#define GR_GL_SYNC_FLUSH_COMMANDS_BIT          0x00000001
+#define GR_GL_ALREADY_SIGNALED                 0x911A
+#define GR_GL_TIMEOUT_EXPIRED                  0x911B
+#define GR_GL_CONDITION_SATISFIED              0x911C
+#define GR_GL_WAIT_FAILED                      0x911D
+
+/* Timer Queries */
+#define GR_GL_TIME_ELAPSED                     0x88BF
+#define GR_GL_QUERY_RESULT                     0x8866
+#define GR_GL_QUERY_RESULT_AVAILABLE           0x8867
+
 /* StencilFunction */
 #define GR_GL_NEVER                          0x0200
 #define GR_GL_LESS                           0x0201
@@ -571,6 +594,7 @@
 #define GR_GL_T4F_C4F_N3F_V4F                    0x2A2D
 
 /* Vertex Buffer Object */
+#define GR_GL_READ_ONLY                          0x88B8
 #define GR_GL_WRITE_ONLY                         0x88B9
 #define GR_GL_BUFFER_MAPPED                      0x88BC
 /* Read Format */
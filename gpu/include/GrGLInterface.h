@@ -79,6 +79,8 @@ typedef void GrGLvoid;
 typedef long GrGLintptr;
 typedef long GrGLsizeiptr;
 typedef char GrGLchar;
+typedef unsigned long long GrGLuint64;
+typedef struct __GLsync* GrGLsync;
 
 enum GrGLBinding {
     kDesktop_GrGLBinding = 0x01,
@@ -210,6 +212,23 @@ extern "C" {
 
     typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLEGLImageTargeTexture2DOESProc)(GrGLenum target, void* image);
 
+    // Program binaries: desktop gl 4.1 & ARB_get_program_binary, OES ES extension
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLGetProgramBinaryProc)(GrGLuint program, GrGLsizei bufSize, GrGLsizei* length, GrGLenum* binaryFormat, GrGLvoid* binary);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLProgramBinaryProc)(GrGLuint program, GrGLenum binaryFormat, const GrGLvoid* binary, GrGLsizei length);
+
+    // Sync objects: desktop gl 3.2 & ARB_sync
+    typedef GrGLsync (GR_GL_FUNCTION_TYPE *GrGLFenceSyncProc)(GrGLenum condition, GrGLbitfield flags);
+    typedef GrGLenum (GR_GL_FUNCTION_TYPE *GrGLClientWaitSyncProc)(GrGLsync sync, GrGLbitfield flags, GrGLuint64 timeout);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLDeleteSyncProc)(GrGLsync sync);
+
+    // Timer queries: desktop gl 3.3, ARB_timer_query & EXT_timer_query
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLGenQueriesProc)(GrGLsizei n, GrGLuint* ids);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLDeleteQueriesProc)(GrGLsizei n, const GrGLuint* ids);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLBeginQueryProc)(GrGLenum target, GrGLuint id);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLEndQueryProc)(GrGLenum target);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLGetQueryObjectivProc)(GrGLuint id, GrGLenum pname, GrGLint* params);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLGetQueryObjectui64vProc)(GrGLuint id, GrGLenum pname, GrGLuint64* params);
+
     // Additional typedefs for GLES2
     typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLBlendEquationProc)( GrGLenum target );
     typedef GrGLvoid (GR_GL_FUNCTION_TYPE *GrGLBlendEquationSeparateProc)( GrGLenum modeRBG, GrGLenum modeAlpha );
@@ -490,6 +509,23 @@ struct GrGLInterface {
 
     GrGLEGLImageTargeTexture2DOESProc fEGLImageTargetTexture2DOES;
 
+    // Program binaries (optional, may be NULL)
+    GrGLGetProgramBinaryProc fGetProgramBinary;
+    GrGLProgramBinaryProc fProgramBinary;
+
+    // Sync objects (optional, may be NULL)
+    GrGLFenceSyncProc fFenceSync;
+    GrGLClientWaitSyncProc fClientWaitSync;
+    GrGLDeleteSyncProc fDeleteSync;
+
+    // Timer queries (optional, may be NULL)
+    GrGLGenQueriesProc fGenQueries;
+    GrGLDeleteQueriesProc fDeleteQueries;
+    GrGLBeginQueryProc fBeginQuery;
+    GrGLEndQueryProc fEndQuery;
+    GrGLGetQueryObjectivProc fGetQueryObjectiv;
+    GrGLGetQueryObjectui64vProc fGetQueryObjectui64v;
+
     // Code that initializes this struct using a static initializer should
     // make this the last entry in the static initializer. It can help to guard
     // against failing to initialize newly-added members of this struct.
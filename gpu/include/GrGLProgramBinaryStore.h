@@ -0,0 +1,76 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef GrGLProgramBinaryStore_DEFINED
+#define GrGLProgramBinaryStore_DEFINED
+
+#include "GrGLInterface.h"
+#include "GrRefCnt.h"
+
+class GrAutoMalloc;
+
+/**
+ * Keeps linked GL program binaries (from glGetProgramBinary) across runs, so
+ * that a program generated on an earlier launch can be loaded instead of
+ * compiled. Programs are keyed by the bytes of their descriptor. A stored
+ * binary that the driver no longer accepts (e.g. after a driver update) is
+ * simply compiled again and replaced.
+ *
+ * The store is only used when the GL exposes program binaries (GL 4.1,
+ * GL_ARB_get_program_binary or GL_OES_get_program_binary).
+ */
+class GrGLProgramBinaryStore : public GrRefCnt {
+public:
+    /**
+     * Looks up the binary stored for a program.
+     *
+     * @param key       the program's key
+     * @param keySize   size of the key in bytes
+     * @param format    set to the binary's format if one is found
+     * @param binary    reallocated to hold the binary if one is found. Its
+     *                  size() is the size of the binary.
+     *
+     * @return true if a binary was found.
+     */
+    virtual bool find(const void* key, size_t keySize,
+                      GrGLenum* format, GrAutoMalloc* binary) = 0;
+
+    /**
+     * Stores the binary of a program that had to be compiled, replacing any
+     * that was stored for the key before.
+     */
+    virtual void add(const void* key, size_t keySize,
+                     GrGLenum format, const void* binary, size_t size) = 0;
+
+    /**
+     * Creates a store that keeps each binary in its own file in the
+     * directory dir, which must already exist.
+     */
+    static GrGLProgramBinaryStore* CreateFileStore(const char dir[]);
+
+private:
+    typedef GrRefCnt INHERITED;
+};
+
+/*
+ * Sets the program binary store that is used by GL contexts created after the
+ * call. The store is ref'ed. Passing NULL (the default) turns the store off.
+ */
+GR_API void GrGLSetProgramBinaryStore(GrGLProgramBinaryStore* store);
+GR_API GrGLProgramBinaryStore* GrGLGetProgramBinaryStore();
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "GrDrawTarget.h"
 #include "GrPathRenderer.h"
+#include "GrPixelRead.h"
 #include "GrRect.h"
 #include "GrRefCnt.h"
 #include "GrTexture.h"
@@ -55,6 +56,28 @@ struct GrGpuStats {
         *  Number of rendertargets created.
         */
     uint32_t fRenderTargetCreateCnt;
+    /*
+        *  Number of times blend, stencil or scissor state is set in 3D API
+        */
+    uint32_t fStateChngCnt;
+    /*
+        *  Number of uniform (and constant attribute) values set in 3D API
+        */
+    uint32_t fUniformChngCnt;
+    /*
+        *  Number of the state, texture, program and uniform changes above that
+        *  were skipped because the 3D API already had the value
+        */
+    uint32_t fSkippedChngCnt;
+    /*
+        *  Bytes of texture data given to the 3D API.
+        */
+    uint64_t fUploadByteCnt;
+    /*
+        *  Nanoseconds the GPU spent, measured by timer queries. Always 0
+        *  unless they are enabled (see GrGpu::enableTimerQueries).
+        */
+    uint64_t fGpuTimeNs;
 };
 
 class GrGpu : public GrDrawTarget {
@@ -170,6 +193,23 @@ public:
      */
     bool supports8BitPalette() const { return f8bitPaletteSupport; }
 
+    /**
+     * Can textures of a compressed config (see GrPixelConfigIsCompressed) be
+     * created.
+     *
+     * @return    true if the config's compressed textures are supported
+     */
+    bool supportsCompressedConfig(GrPixelConfig config) const {
+        switch (config) {
+            case kETC1_GrPixelConfig:
+                return fETC1Support;
+            case kDXT1_GrPixelConfig:
+                return fDXT1Support;
+            default:
+                return false;
+        }
+    }
+
     /**
      * returns true if two sided stenciling is supported. If false then only
      * the front face values of the GrStencilSettings
@@ -205,6 +245,19 @@ public:
      */
     bool supports4x4DownsampleFilter() const { return f4X4DownsampleFilterSupport; }
 
+    /**
+     * Does the subclass support GrSamplerState::kConvolution_Filter
+     */
+    bool supportsConvolutionFilter() const { return fConvolutionFilterSupport; }
+
+    /**
+     * Does the subclass support the radial, two-point radial and sweep
+     * gradient sample modes of GrSamplerState
+     */
+    bool supportsGradientSampleModes() const {
+        return fGradientSampleModeSupport;
+    }
+
     /**
      * Does this instance support dual-source blending? Required for proper
      * blending with partial coverage with certain blend modes (dst coeff is
@@ -269,6 +322,15 @@ public:
 
     virtual void clear(const GrIRect* rect, GrColor color);
 
+    // GrDrawTarget override. Notes the device bounds of the rect, so that the
+    // clip can be skipped when it contains them, or only the parts of the
+    // clip that they touch applied.
+    virtual void drawRect(const GrRect& rect,
+                          const GrMatrix* matrix,
+                          StageBitfield stageEnableBitfield,
+                          const GrRect* srcRects[],
+                          const GrMatrix* srcMatrices[]);
+
     /**
      * Installs a path renderer that will be used to draw paths that are
      * part of the clip.
@@ -319,10 +381,72 @@ public:
                     int left, int top, int width, int height,
                     GrPixelConfig config, void* buffer);
 
+    /**
+     * Starts reading a rectangle of pixels from a render target without
+     * waiting for the GPU to finish the drawing before it. The parameters
+     * are the same as readPixels(). The pixels are copied out of the
+     * returned object, which the caller must unref.
+     *
+     * @return the read, or NULL if it can't be made asynchronously. The
+     *         caller may then fall back to readPixels().
+     */
+    GrPixelRead* beginReadPixels(GrRenderTarget* renderTarget,
+                                 int left, int top, int width, int height,
+                                 GrPixelConfig config);
+
+    /**
+     * Returns the stats summed over every pass.
+     */
     const GrGpuStats& getStats() const;
+    const GrGpuStats& getPassStats(GrGpuPass pass) const {
+        GrAssert((unsigned)pass < kGrGpuPassCount);
+        return fPassStats[pass];
+    }
     void resetStats();
     void printStats() const;
 
+    /**
+     * Sets the pass that following work is counted in. The counters are only
+     * collected when GR_COLLECT_STATS is set, but GPU times are measured
+     * whenever timer queries are enabled.
+     */
+    void setPass(GrGpuPass pass);
+    GrGpuPass getPass() const { return fCurrPass; }
+
+    /**
+     * Sets the pass for the life of the object, and puts back the previous
+     * one after.
+     */
+    class AutoPassRestore : ::GrNoncopyable {
+    public:
+        AutoPassRestore(GrGpu* gpu, GrGpuPass pass)
+            : fGpu(gpu), fSavedPass(gpu->getPass()) {
+            gpu->setPass(pass);
+        }
+        ~AutoPassRestore() { fGpu->setPass(fSavedPass); }
+    private:
+        GrGpu*      fGpu;
+        GrGpuPass   fSavedPass;
+    };
+
+    /**
+     * Are timer queries supported, to measure the GPU time of each pass.
+     */
+    bool supportsTimerQueries() const { return fTimerQuerySupport; }
+
+    /**
+     * Starts or stops timing passes on the GPU. Timing has some overhead, so
+     * it is off by default. Does nothing if timer queries aren't supported.
+     */
+    void enableTimerQueries(bool enable);
+
+    /**
+     * Adds the GPU times that have come back from the timer queries to the
+     * stats. If wait is true this waits for all of them, which stalls until
+     * the GPU has caught up.
+     */
+    void collectTimerQueries(bool wait) { this->onCollectTimerQueries(wait); }
+
     /**
      * Called to tell Gpu object that all GrResources have been lost and should
      * be abandoned.
@@ -358,18 +482,38 @@ protected:
                                                  // clipping.
     };
 
+    enum {
+        // A clip that is the union of at most this many disjoint rects is
+        // applied by drawing once per rect with the scissor set to it, rather
+        // than by rendering it into the stencil.
+        kMaxClipScissorRects = 4,
+    };
+
     /**
      * Extensions to GrDrawTarget::StateBits to implement stencil clipping
      */
     struct ClipState {
         bool            fClipInStencil;
         bool            fClipIsDirty;
+        // Compared with the render target's fLastStencilClipGeneration.
+        // Bumped when the stencil contents can no longer be trusted (e.g.
+        // the context was reset), which invalidates every cached clip.
+        int             fStencilGeneration;
+        // The clip as disjoint scissor rects, found when the clip changes.
+        // -1 if that can't be done.
+        int             fScissorRectCount;
+        GrIRect         fScissorRects[kMaxClipScissorRects];
+        // The scissor rects the current draw is repeated for. Only used when
+        // there is more than one.
+        int             fDrawPassCount;
+        GrIRect         fDrawPassRects[kMaxClipScissorRects];
     } fClipState;
 
     // GrDrawTarget override
     virtual void clipWillBeSet(const GrClip& newClip);
 
-    // prepares clip flushes gpu state before a draw
+    // prepares clip flushes gpu state before a draw. Returns false if the
+    // state is unsupported or the clip rejects the whole draw.
     bool setupClipAndFlushState(GrPrimitiveType type);
 
     // Functions used to map clip-respecting stencil tests into normal
@@ -389,6 +533,9 @@ protected:
 
     // defaults to false, subclass can set true to support palleted textures
     bool f8bitPaletteSupport;
+    // likewise for compressed textures
+    bool fETC1Support;
+    bool fDXT1Support;
 
     // set by subclass
     bool fNPOTTextureSupport;
@@ -399,6 +546,8 @@ protected:
     bool fAALineSupport;
     bool fFSAASupport;
     bool f4X4DownsampleFilterSupport; // supports GrSamplerState::k4x4Downsample_Filter
+    bool fConvolutionFilterSupport;   // supports GrSamplerState::kConvolution_Filter
+    bool fGradientSampleModeSupport;  // supports GrSamplerState::isGradient()
     bool fDualSourceBlendingSupport;
 
     // set by subclass to true if index and vertex buffers can be locked, false
@@ -413,7 +562,34 @@ protected:
     int fRenderTargetCnt;
     int fMaxRenderTargetCnt;
 
-    GrGpuStats fStats;
+    // the stats of the current pass, which is where subclasses count work
+    GrGpuStats& passStats() { return fPassStats[fCurrPass]; }
+
+    void countUniformChange() {
+    #if GR_COLLECT_STATS
+        ++this->passStats().fUniformChngCnt;
+    #endif
+    }
+    void countSkippedChange() {
+    #if GR_COLLECT_STATS
+        ++this->passStats().fSkippedChngCnt;
+    #endif
+    }
+
+    GrGpuStats fPassStats[kGrGpuPassCount];
+    GrGpuPass  fCurrPass;
+
+    // set by subclass
+    bool fTimerQuerySupport;
+
+    // Called when the pass to time on the GPU changes: pass is the one that
+    // following work should be timed in, or kGrGpuPassCount to stop timing.
+    virtual void onSetTimedPass(GrGpuPass pass) {}
+    virtual void onCollectTimerQueries(bool wait) {}
+
+    // incremented by resetStats(), so that subclasses can drop the results
+    // of timer queries from before it
+    uint32_t fStatsGeneration;
 
     struct GeometryPoolState {
         const GrVertexBuffer* fPoolVertexBuffer;
@@ -484,6 +660,13 @@ protected:
                               int left, int top, int width, int height,
                               GrPixelConfig, void* buffer) = 0;
 
+    // overridden by API-specific derived class to start an asynchronous read.
+    // The default can't, and returns NULL.
+    virtual GrPixelRead* onBeginReadPixels(GrRenderTarget* target,
+                                           int left, int top,
+                                           int width, int height,
+                                           GrPixelConfig config);
+
     // called to program the vertex data, indexCount will be 0 if drawing non-
     // indexed geometry. The subclass may adjust the startVertex and/or
     // startIndex since it may have already accounted for these in the setup.
@@ -536,6 +719,15 @@ private:
 
     GrResource*                 fResourceHead;
 
+    mutable GrGpuStats          fStats; // the sum of fPassStats, mutable so
+                                        // it can be summed on demand
+    bool                        fTimerQueriesEnabled;
+
+    // device bounds of the rect being drawn by drawRect(), consumed by
+    // setupClipAndFlushState()
+    GrRect                      fDrawBounds;
+    bool                        fDrawBoundsValid;
+
     // GrDrawTarget overrides
     virtual void onDrawIndexed(GrPrimitiveType type,
                                int startVertex,
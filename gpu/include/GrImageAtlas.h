@@ -0,0 +1,112 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef GrImageAtlas_DEFINED
+#define GrImageAtlas_DEFINED
+
+#include "GrPoint.h"
+#include "GrRect.h"
+#include "GrTHashCache.h"
+
+class GrGpu;
+class GrRectanizer;
+class GrTexture;
+
+/**
+ * Packs small RGBA 8888 images into a few shared textures, so that drawing
+ * many of them doesn't switch textures and consecutive draws can be batched.
+ * Images are identified by two 32bit values and their size, like the keys of
+ * the texture cache, and are never updated in place: an image whose pixels
+ * change must get a new key.
+ *
+ * Each image is surrounded by a copy of its edge pixels, so drawing all of it
+ * with filtering looks the same as drawing it from a clamped texture of its
+ * own.
+ */
+class GrImageAtlas {
+public:
+    GrImageAtlas(GrGpu*);
+    ~GrImageAtlas();
+
+    enum {
+        // larger images are better off in their own textures
+        kMaxImageSize = 64,
+    };
+
+    static bool CanHold(int width, int height) {
+        return width > 0 && height > 0 &&
+               width <= kMaxImageSize && height <= kMaxImageSize;
+    }
+
+    /**
+     * Finds the image with the given key, adding it if it isn't in the atlas
+     * yet.
+     *
+     * @param pixels    the image's pixels, only read when it is added
+     * @param rowBytes  bytes between the starts of rows in pixels
+     * @param bounds    set to where the image is in the returned texture
+     *
+     * @return the texture holding the image (not ref'ed), or NULL if it
+     *         can't be held or every page is full.
+     */
+    GrTexture* findOrAdd(uint32_t p0, uint32_t p1, int width, int height,
+                         const void* pixels, size_t rowBytes,
+                         GrIRect* bounds);
+
+    /**
+     * Forgets every image, keeping the pages' textures for the images added
+     * next. Draws using the atlas must have been flushed first.
+     */
+    void purge();
+
+    /**
+     * Forgets every image and releases the pages' textures.
+     */
+    void freeAll();
+
+private:
+    enum {
+        kPageSize = 1024,
+        kMaxPages = 4,
+    };
+
+    struct Image {
+        uint32_t    fP0;
+        uint32_t    fP1;
+        uint32_t    fSize;      // width | (height << 16)
+        int         fPage;
+        GrIPoint16  fLoc;       // top left of the pixels, inside the border
+
+        uint32_t getHash() const { return fP0 ^ fP1 ^ fSize; }
+    };
+    class Key;
+
+    struct Page {
+        GrTexture*      fTexture;
+        GrRectanizer*   fRects;
+    };
+
+    bool addToPage(int pageIndex, int width, int height,
+                   const void* pixels, size_t rowBytes, GrIPoint16* loc);
+
+    GrGpu*                          fGpu;
+    Page                            fPages[kMaxPages];
+    int                             fPageCount;
+    GrTHashTable<Image, Key, 8>     fCache;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "GrAllocPool.h"
 #include "GrAllocator.h"
 #include "GrClip.h"
+#include "GrTDArray.h"
 
 class GrVertexBufferAllocPool;
 class GrIndexBufferAllocPool;
@@ -79,6 +80,20 @@ public:
      * @param target    the target to receive the playback
      */
     void playback(GrDrawTarget* target);
+
+    /**
+     * Allows playback to change the order of draws that don't overlap, so
+     * that draws made with the same state, or failing that with the same
+     * textures, blend and render target, are played back together. This
+     * saves the target state changes (texture binds, program switches) when
+     * for example text and image quads alternate. Draws whose device space
+     * bounds aren't known (their vertices come from a caller's buffer) are
+     * never moved across, nor are clears. Off by default, and only affects
+     * draws queued after it is turned on.
+     *
+     * @param reorder   true to allow draws to be reordered.
+     */
+    void setReorderDraws(bool reorder) { fReorderDraws = reorder; }
     
     // overrides from GrDrawTarget
     virtual void drawRect(const GrRect& rect, 
@@ -106,6 +121,9 @@ private:
         GrVertexLayout          fVertexLayout;
         const GrVertexBuffer*   fVertexBuffer;
         const GrIndexBuffer*    fIndexBuffer;
+        // device space, only recorded when reordering
+        bool                    fBoundsValid;
+        GrRect                  fBounds;
     };
 
     struct Clear {
@@ -145,12 +163,23 @@ private:
     void pushState();
     void pushClip();
 
+    void setDrawBounds(Draw* draw, int startVertex, int vertexCount);
+    bool appendQuadsToPreviousDraw(GrPrimitiveType type,
+                                   int startVertex,
+                                   int startIndex,
+                                   int vertexCount,
+                                   int indexCount);
+    bool canSwapDraws(int drawA, int drawB) const;
+    void reorderDraws(const int states[], const int clips[],
+                      GrTDArray<int>* order) const;
+
     GrTAllocator<Draw>              fDraws;
     GrTAllocator<SavedDrawState>    fStates;
     GrTAllocator<Clear>             fClears;
 
     GrTAllocator<GrClip>            fClips;
     bool                            fClipSet;
+    bool                            fReorderDraws;
 
     GrVertexLayout                  fLastRectVertexLayout;
     const GrIndexBuffer*            fQuadIndexBuffer;
@@ -165,6 +194,8 @@ private:
         int                             fPoolStartVertex;
         const GrIndexBuffer*            fPoolIndexBuffer;
         int                             fPoolStartIndex;
+        // cpu copy of the reserved or array vertices, to find draw bounds
+        const void*                     fPoolVertices;
         // caller may conservatively over reserve vertices / indices.
         // we release unused space back to allocator if possible
         // can only do this if there isn't an intervening pushGeometrySource()
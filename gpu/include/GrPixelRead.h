@@ -0,0 +1,70 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef GrPixelRead_DEFINED
+#define GrPixelRead_DEFINED
+
+#include "GrRefCnt.h"
+#include "GrTypes.h"
+
+/**
+ * A read of a rectangle of render target pixels that was started by
+ * GrContext::beginReadRenderTargetPixels() and whose pixels are picked up
+ * later. The read is queued behind the drawing issued before it, so rendering
+ * can go on while the pixels are copied out. Picking them up a frame or two
+ * after the read was started usually doesn't wait on the GPU at all.
+ */
+class GR_API GrPixelRead : public GrRefCnt {
+public:
+    GrPixelRead(int width, int height, GrPixelConfig config)
+        : fWidth(width)
+        , fHeight(height)
+        , fConfig(config) {
+    }
+
+    int width() const { return fWidth; }
+    int height() const { return fHeight; }
+    GrPixelConfig config() const { return fConfig; }
+
+    /**
+     * Returns true if finish() can copy the pixels without waiting on the
+     * GPU. This is only a hint: when the 3D API can't tell, it is always true.
+     */
+    virtual bool isReady() = 0;
+
+    /**
+     * Copies the read pixels into buffer, top row first, waiting for them if
+     * they aren't ready yet. May only be called once.
+     *
+     * @param buffer    memory to copy the rectangle into.
+     * @param rowBytes  bytes between the starts of rows in buffer. 0 means
+     *                  width * bytes per pixel of the config.
+     *
+     * @return true if the pixels were copied, false if the read failed (e.g.
+     *              because the context was lost before they were picked up).
+     */
+    virtual bool finish(void* buffer, size_t rowBytes = 0) = 0;
+
+private:
+    int             fWidth;
+    int             fHeight;
+    GrPixelConfig   fConfig;
+
+    typedef GrRefCnt INHERITED;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef GrRenderTargetPool_DEFINED
+#define GrRenderTargetPool_DEFINED
+
+#include "GrTDArray.h"
+#include "GrTexture.h"
+
+class GrGpu;
+
+/**
+ * Keeps scratch render target textures (with their stencil buffers) around
+ * after they're unlocked, so that offscreen passes and layers that come and go
+ * don't create and delete them all the time. Sizes are bucketed, so a layer
+ * that grows or shrinks a little reuses the same render target.
+ *
+ * Unlocked render targets are released once they haven't been used for a few
+ * frames, or when the unlocked ones hold more than the pool's budget.
+ */
+class GrRenderTargetPool {
+public:
+    GrRenderTargetPool(GrGpu*);
+    ~GrRenderTargetPool();
+
+    /**
+     * Returns a render target texture with desc's config and aa level that is
+     * at least as large as desc. It has a stencil buffer unless desc sets
+     * kNoStencil_GrTextureFlagBit. Its contents are unknown. The texture is
+     * ref'ed and won't be returned again until it is unlocked.
+     */
+    GrTexture* lock(const GrTextureDesc& desc);
+
+    /**
+     * Returns a texture from lock() to the pool and unrefs it.
+     */
+    void unlock(GrTexture*);
+
+    /**
+     * Starts a new frame: unlocked render targets that weren't used during
+     * the last kMaxIdleFrames frames are released.
+     */
+    void newFrame();
+
+    /**
+     * Releases the unlocked render targets.
+     */
+    void freeUnlocked();
+
+    /**
+     * Forgets every render target, e.g. when the 3D API context was lost.
+     * Locked ones are only unref'ed by their owners.
+     */
+    void freeAll();
+
+    void printStats() const;
+
+private:
+    enum {
+        kMaxIdleFrames  = 4,
+        kMaxUnlockedBytes = 16 * 1024 * 1024,
+    };
+
+    struct Entry {
+        GrTexture*      fTexture;
+        GrTextureDesc   fDesc;
+        int             fLastUsedFrame;
+        bool            fLocked;
+    };
+
+    void purge(int maxBytes);
+    void remove(int index);
+
+    GrGpu*              fGpu;
+    GrTDArray<Entry>    fEntries;
+    int                 fFrame;
+    size_t              fUnlockedBytes;
+
+    // stats
+    int                 fHitCnt;
+    int                 fMissCnt;
+    int                 fPurgeCnt;
+};
+
+#endif
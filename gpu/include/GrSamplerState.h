@@ -39,6 +39,19 @@ public:
          * between texels in x and y spaced 4 texels apart.)
          */
         k4x4Downsample_Filter,
+        /**
+         * Weighted sum of kernelWidth texels centered on the sample position
+         * and stepping by the image increment, e.g. one pass of a separable
+         * blur. See setConvolutionParams.
+         */
+        kConvolution_Filter,
+    };
+
+    enum {
+        /**
+         * The widest kernel kConvolution_Filter can apply.
+         */
+        kMaxKernelWidth = 25
     };
 
     /**
@@ -217,6 +230,26 @@ public:
         fRadial2PosRoot = posRoot;
     }
 
+    int getKernelWidth() const { return fKernelWidth; }
+    const float* getKernel() const { return fKernel; }
+    const float* getImageIncrement() const { return fImageIncrement; }
+
+    /**
+     * Sets the parameters for kConvolution_Filter. The kernel is applied to
+     * kernelWidth texels, (kernelWidth - 1) / 2 image increments either side
+     * of the sample position. The image increment is in texels, e.g. (1, 0)
+     * to convolve in x.
+     */
+    void setConvolutionParams(int kernelWidth, const float* kernel,
+                              float imageIncrementX, float imageIncrementY) {
+        GrAssert(kernelWidth >= 1 && kernelWidth <= kMaxKernelWidth);
+        GrAssert(kernelWidth & 1);
+        fKernelWidth = kernelWidth;
+        memcpy(fKernel, kernel, kernelWidth * sizeof(float));
+        fImageIncrement[0] = imageIncrementX;
+        fImageIncrement[1] = imageIncrementY;
+    }
+
     static const GrSamplerState& ClampNoFilter() {
         return gClampNoFilter;
     }
@@ -234,6 +267,11 @@ private:
     GrScalar    fRadial2Radius0;
     bool        fRadial2PosRoot;
 
+    // these are undefined unless fFilter == kConvolution_Filter
+    int         fKernelWidth;
+    float       fKernel[kMaxKernelWidth];
+    float       fImageIncrement[2];
+
     static const GrSamplerState gClampNoFilter;
 };
 
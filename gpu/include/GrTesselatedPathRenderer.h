@@ -18,10 +18,12 @@
 #define GrTesselatedPathRenderer_DEFINED
 
 #include "GrPathRenderer.h"
+#include "GrTDArray.h"
 
 class GrTesselatedPathRenderer : public GrPathRenderer {
 public:
     GrTesselatedPathRenderer();
+    virtual ~GrTesselatedPathRenderer();
 
     virtual void drawPath(GrDrawTarget* target,
                           GrDrawTarget::StageBitfield stages,
@@ -42,6 +44,20 @@ public:
     virtual bool supportsAA(GrDrawTarget* target,
                             const GrPath& path,
                             GrPathFill fill);
+
+private:
+    // The triangles of a non-antialiased fill, for a path's generation ID,
+    // fill, curve tolerance and translate, so that redrawing the path doesn't
+    // run the tesselator again.
+    struct CachedTess;
+
+    const CachedTess* findTess(const GrPath& path, GrPathFill fill,
+                               GrScalar tol, const GrPoint& translate);
+    void addTess(const GrPath& path, GrPathFill fill, GrScalar tol,
+                 const GrPoint& translate, const GrTDArray<GrPoint>& vertices,
+                 const GrTDArray<uint16_t>& indices);
+
+    GrTDArray<CachedTess*> fCache;  // most recently used first
 };
 
 #endif
@@ -52,6 +52,12 @@ public:
         return fCache.getArray()[index];
     }
     GrAtlas* getAtlas() const { return fAtlas; }
+    int countAtlases() const;
+
+    // Frees the strike's atlases if its glyphs would fit in fewer of them.
+    // The glyphs are added again the next time they are drawn, so only the
+    // ones still in use take space. Returns true if the atlases were freed.
+    bool compactAtlases();
 
 public:
     // for LRU
@@ -88,6 +94,15 @@ public:
 
     void purgeExceptFor(GrTextStrike*);
 
+    /**
+     * Repacks the glyphs of strikes that are spread over more atlas plots
+     * than they need; see GrTextStrike::compactAtlases(). Meant to be called
+     * on idle frames. Draws using the atlases must have been flushed first.
+     */
+    void compactAtlases();
+
+    void printStats() const;
+
     // testing
     int countStrikes() const { return fCache.getArray().count(); }
     const GrTextStrike* strikeAt(int index) const {
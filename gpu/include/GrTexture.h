@@ -129,6 +129,7 @@ protected:
         , fHeight(height)
         , fStencilBits(stencilBits)
         , fIsMultisampled(isMultisampled)
+        , fLastStencilClipGeneration(0)
     {
         fResolveRect.setLargestInverted();
     }
@@ -153,9 +154,11 @@ private:
     GrIRect    fResolveRect;
 
     // GrGpu keeps a cached clip in the render target to avoid redundantly
-    // rendering the clip into the same stencil buffer.
+    // rendering the clip into the same stencil buffer. The stencil only
+    // still holds it if the generation matches the GrGpu's.
     friend class GrGpu;
     GrClip     fLastStencilClip;
+    int        fLastStencilClipGeneration;
 
     typedef GrResource INHERITED;
 };
@@ -195,6 +198,9 @@ public:
      *  Approximate number of bytes used by the texture
      */
     size_t sizeInBytes() const {
+        if (GrPixelConfigIsCompressed(fConfig)) {
+            return GrCompressedDataSize(fConfig, fWidth, fHeight);
+        }
         return fWidth * fHeight * GrBytesPerPixel(fConfig);
     }
 
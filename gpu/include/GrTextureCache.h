@@ -216,6 +216,18 @@ public:
      */
     void setLimits(int maxTextures, size_t maxTextureBytes);
 
+    /**
+     *  Return the number of bytes of texture memory held by the cache,
+     *  including the entries that are detached.
+     */
+    size_t getCachedBytes() const { return fEntryBytes; }
+
+    /**
+     *  Purge unlocked entries (LRU) until no more than the specified number of
+     *  bytes remain, without changing the limits.
+     */
+    void purgeTo(size_t bytes);
+
     /**
      *  Search for an entry with the same Key. If found, "lock" it and return it.
      *  If not found, return null.
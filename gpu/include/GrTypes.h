@@ -273,6 +273,8 @@ enum GrPixelConfig {
     kRGBA_4444_GrPixelConfig, //!< premultiplied
     kRGBA_8888_GrPixelConfig, //!< premultiplied
     kRGBX_8888_GrPixelConfig, //!< treat the alpha channel as opaque
+    kETC1_GrPixelConfig,      //!< opaque, compressed in 4x4 blocks
+    kDXT1_GrPixelConfig,      //!< opaque, compressed in 4x4 blocks
 };
 
 static inline size_t GrBytesPerPixel(GrPixelConfig config) {
@@ -287,14 +289,42 @@ static inline size_t GrBytesPerPixel(GrPixelConfig config) {
         case kRGBX_8888_GrPixelConfig:
             return 4;
         default:
+            // compressed configs don't have whole bytes per pixel
             return 0;
     }
 }
 
+/**
+ *  Compressed configs are uploaded in 4x4 blocks of pixels instead of rows,
+ *  and can't be rendered to or updated after they are created.
+ */
+static inline bool GrPixelConfigIsCompressed(GrPixelConfig config) {
+    switch (config) {
+        case kETC1_GrPixelConfig:
+        case kDXT1_GrPixelConfig:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ *  Return the number of bytes of a compressed config's data for an image of
+ *  the specified size, whose edges are padded out to whole blocks.
+ */
+static inline size_t GrCompressedDataSize(GrPixelConfig config,
+                                          int width, int height) {
+    GrAssert(GrPixelConfigIsCompressed(config));
+    // both configs take 8 bytes per 4x4 block
+    return ((width + 3) >> 2) * ((height + 3) >> 2) * 8;
+}
+
 static inline bool GrPixelConfigIsOpaque(GrPixelConfig config) {
     switch (config) {
         case kRGB_565_GrPixelConfig:
         case kRGBX_8888_GrPixelConfig:
+        case kETC1_GrPixelConfig:
+        case kDXT1_GrPixelConfig:
             return true;
         default:
             return false;
@@ -310,6 +340,22 @@ static inline bool GrPixelConfigIsAlphaOnly(GrPixelConfig config) {
     }
 }
 
+/**
+ * The parts of drawing a frame that GrGpu breaks its stats down by. Work is
+ * counted in the pass that was current (see GrGpu::setPass) when it was
+ * given to the 3D API.
+ */
+enum GrGpuPass {
+    kOther_GrGpuPass,           //<! Anything not in one of the others
+    kBufferedDraws_GrGpuPass,   //<! Playing back buffered draws (e.g. rects)
+    kText_GrGpuPass,            //<! Playing back buffered glyphs
+    kPath_GrGpuPass,            //<! Drawing paths with a path renderer
+    kClip_GrGpuPass,            //<! Writing clips into the stencil buffer
+    kOffscreenAA_GrGpuPass,     //<! Drawing through an offscreen AA target
+
+    kGrGpuPassCount
+};
+
 /**
     * Used to control the level of antialiasing available for a rendertarget.
     * Anti-alias quality levels depend on the underlying API/GPU capabilities.
@@ -79,6 +79,10 @@ GrAtlas::~GrAtlas() {
 #endif
 }
 
+float GrAtlas::percentFull() const {
+    return fRects->percentFull();
+}
+
 static void adjustForPlot(GrIPoint16* loc, const GrIPoint16& plot) {
     loc->fX += plot.fX * GR_ATLAS_WIDTH;
     loc->fY += plot.fY * GR_ATLAS_HEIGHT;
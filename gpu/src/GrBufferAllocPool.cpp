@@ -47,6 +47,7 @@ GrBufferAllocPool::GrBufferAllocPool(GrGpu* gpu,
     fMinBlockSize = GrMax(GrBufferAllocPool_MIN_BLOCK_SIZE, blockSize);
 
     fBytesInUse = 0;
+    fLastSpareBytes = 0;
             
     fPreallocBuffersInUse = 0;
     fFirstPreallocBuffer = 0;
@@ -71,6 +72,7 @@ GrBufferAllocPool::~GrBufferAllocPool() {
         destroyBlock();
     }
     fPreallocBuffers.unrefAll();
+    fSpareBuffers.unrefAll();
     releaseGpuRef();
 }
 
@@ -90,9 +92,18 @@ void GrBufferAllocPool::reset() {
             buffer->unlock();
         }
     }
+    // Buffers beyond the preallocated ones are kept for the next use of the
+    // pool rather than recreated, as long as there is recent use for them.
+    size_t spareBytes = 0;
     while (!fBlocks.empty()) {
-        destroyBlock();
+        GrGeometryBuffer* spare = destroyBlock(true);
+        if (NULL != spare) {
+            *fSpareBuffers.append() = spare;
+            spareBytes += spare->size();
+        }
     }
+    this->trimSpareBuffers(GrMax(spareBytes, fLastSpareBytes));
+    fLastSpareBytes = spareBytes;
     if (fPreallocBuffers.count()) {
         // must set this after above loop.
         fFirstPreallocBuffer = (fFirstPreallocBuffer + fPreallocBuffersInUse) %
@@ -257,11 +268,15 @@ bool GrBufferAllocPool::createBlock(size_t requestSize) {
         block.fBuffer->ref();
         ++fPreallocBuffersInUse;
     } else {
-        block.fBuffer = this->createBuffer(size);
+        block.fBuffer = this->takeSpareBuffer(size);
+        if (NULL == block.fBuffer) {
+            block.fBuffer = this->createBuffer(size);
+        }
         if (NULL == block.fBuffer) {
             fBlocks.pop_back();
             return false;
         }
+        size = block.fBuffer->size();
     }
 
     block.fBytesFree = size;
@@ -294,10 +309,11 @@ bool GrBufferAllocPool::createBlock(size_t requestSize) {
     return true;
 }
 
-void GrBufferAllocPool::destroyBlock() {
+GrGeometryBuffer* GrBufferAllocPool::destroyBlock(bool keepSpare) {
     GrAssert(!fBlocks.empty());
 
     BufferBlock& block = fBlocks.back();
+    GrGeometryBuffer* spare = block.fBuffer;
     if (fPreallocBuffersInUse > 0) {
         uint32_t prevPreallocBuffer = (fPreallocBuffersInUse +
                                        fFirstPreallocBuffer +
@@ -305,12 +321,54 @@ void GrBufferAllocPool::destroyBlock() {
                                       fPreallocBuffers.count();
         if (block.fBuffer == fPreallocBuffers[prevPreallocBuffer]) {
             --fPreallocBuffersInUse;
+            spare = NULL;
         }
     }
     GrAssert(!block.fBuffer->isLocked());
-    block.fBuffer->unref();
+    if (!keepSpare || NULL == spare) {
+        block.fBuffer->unref();
+        spare = NULL;
+    }
     fBlocks.pop_back();
     fBufferPtr = NULL;
+    return spare;
+}
+
+GrGeometryBuffer* GrBufferAllocPool::takeSpareBuffer(size_t size) {
+    // the smallest spare that is big enough
+    int best = -1;
+    for (int i = 0; i < fSpareBuffers.count(); ++i) {
+        size_t spareSize = fSpareBuffers[i]->size();
+        if (spareSize >= size &&
+            (best < 0 || spareSize < fSpareBuffers[best]->size())) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return NULL;
+    }
+    GrGeometryBuffer* buffer = fSpareBuffers[best];
+    fSpareBuffers.removeShuffle(best);
+    return buffer;
+}
+
+void GrBufferAllocPool::trimSpareBuffers(size_t maxBytes) {
+    size_t bytes = 0;
+    for (int i = 0; i < fSpareBuffers.count(); ++i) {
+        bytes += fSpareBuffers[i]->size();
+    }
+    // the largest go first, since they are the least likely to be needed
+    while (bytes > maxBytes) {
+        int largest = 0;
+        for (int i = 1; i < fSpareBuffers.count(); ++i) {
+            if (fSpareBuffers[i]->size() > fSpareBuffers[largest]->size()) {
+                largest = i;
+            }
+        }
+        bytes -= fSpareBuffers[largest]->size();
+        fSpareBuffers[largest]->unref();
+        fSpareBuffers.removeShuffle(largest);
+    }
 }
 
 void GrBufferAllocPool::flushCpuData(GrGeometryBuffer* buffer,
@@ -331,7 +389,9 @@ void GrBufferAllocPool::flushCpuData(GrGeometryBuffer* buffer,
             updated = true;
         }
     }
-    buffer->updateData(fBufferPtr, flushSize);
+    if (!updated) {
+        buffer->updateData(fBufferPtr, flushSize);
+    }
 }
 
 GrGeometryBuffer* GrBufferAllocPool::createBuffer(size_t size) {
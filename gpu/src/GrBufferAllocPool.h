@@ -37,6 +37,8 @@ class GrGpu;
  * At creation time a minimum per-buffer size can be specified. Additionally,
  * a number of buffers to preallocate can be specified. These will
  * be allocated at the min size and kept around until the pool is destroyed.
+ * Buffers created beyond those are kept across a reset for reuse, up to what
+ * the last two resets' worth of use needed.
  */
 class GrBufferAllocPool : GrNoncopyable {
 
@@ -48,7 +50,8 @@ public:
     void unlock();
 
     /**
-     *  Invalidates all the data in the pool, unrefs non-preallocated buffers.
+     *  Invalidates all the data in the pool. Non-preallocated buffers are
+     *  kept for reuse as long as recent use of the pool needed them.
      */
     void reset();
 
@@ -166,7 +169,11 @@ private:
     };
 
     bool createBlock(size_t requestSize);
-    void destroyBlock();
+    // returns the block's buffer (still reffed) if keepSpare and the buffer
+    // isn't a preallocated one, else unrefs it and returns NULL
+    GrGeometryBuffer* destroyBlock(bool keepSpare = false);
+    GrGeometryBuffer* takeSpareBuffer(size_t size);
+    void trimSpareBuffers(size_t maxBytes);
     void flushCpuData(GrGeometryBuffer* buffer, size_t flushSize);
 #if GR_DEBUG
     void validate(bool unusedBlockAllowed = false) const;
@@ -178,6 +185,8 @@ private:
     bool                            fGpuIsReffed;
     bool                            fFrequentResetHint;
     GrTDArray<GrGeometryBuffer*>    fPreallocBuffers;
+    GrTDArray<GrGeometryBuffer*>    fSpareBuffers;
+    size_t                          fLastSpareBytes;
     size_t                          fMinBlockSize;
     BufferType                      fBufferType;
 
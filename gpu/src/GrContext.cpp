@@ -17,6 +17,8 @@
 
 #include "GrContext.h"
 #include "GrGpu.h"
+#include "GrImageAtlas.h"
+#include "GrRenderTargetPool.h"
 #include "GrTextureCache.h"
 #include "GrTextStrike.h"
 #include "GrMemory.h"
@@ -26,6 +28,8 @@
 #include "GrBufferAllocPool.h"
 #include "GrPathRenderer.h"
 #include "GrPathUtils.h"
+#include "SkPurgeableCache.h"
+#include "SkTrace.h"
 
 // Using MSAA seems to be slower for some yet unknown reason.
 #define PREFER_MSAA_OFFSCREEN_AA 0
@@ -35,9 +39,33 @@
 
 #define BATCH_RECT_TO_RECT (1 && !GR_STATIC_RECT_VB)
 
+// Let the draw buffer group non-overlapping draws by state on playback.
+#define REORDER_DRAW_BUFFER 0
+
 static const size_t MAX_TEXTURE_CACHE_COUNT = 1024;
 static const size_t MAX_TEXTURE_CACHE_BYTES = 130 * 1024 * 1024;
 
+namespace {
+
+// Lets SkGraphics trim the texture cache along with the other caches. The
+// cache isn't thread safe, so neither is this: the textures may only be
+// purged from the thread that uses the context.
+class TexturePurgeableCache : public SkPurgeableCache {
+public:
+    TexturePurgeableCache(GrTextureCache* cache)
+            : INHERITED("gpu textures", kExpensive_Cost), fCache(cache) {}
+
+    virtual size_t bytesUsed() const { return fCache->getCachedBytes(); }
+    virtual void purgeTo(size_t bytes) { fCache->purgeTo(bytes); }
+
+private:
+    GrTextureCache* fCache;
+
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
 static const size_t DRAW_BUFFER_VBPOOL_BUFFER_SIZE = 1 << 18;
 static const int DRAW_BUFFER_VBPOOL_PREALLOC_BUFFERS = 4;
 
@@ -63,8 +91,11 @@ GrContext* GrContext::CreateGLShaderContext() {
 
 GrContext::~GrContext() {
     this->flush();
+    delete fPurgeableCache;
     delete fTextureCache;
     delete fFontCache;
+    delete fImageAtlas;
+    delete fRenderTargetPool;
     delete fDrawBuffer;
     delete fDrawBufferVBAllocPool;
     delete fDrawBufferIBAllocPool;
@@ -98,6 +129,8 @@ void GrContext::contextDestroyed() {
 
     fTextureCache->removeAll();
     fFontCache->freeAll();
+    fImageAtlas->freeAll();
+    fRenderTargetPool->freeAll();
     fGpu->markContextDirty();
 }
 
@@ -113,6 +146,18 @@ void GrContext::freeGpuResources() {
     this->flush();
     fTextureCache->removeAll();
     fFontCache->freeAll();
+    fImageAtlas->freeAll();
+    fRenderTargetPool->freeUnlocked();
+}
+
+void GrContext::newFrame() {
+    fRenderTargetPool->newFrame();
+}
+
+void GrContext::compactGlyphAtlases() {
+    // queued text may still use the atlases
+    this->flush();
+    fFontCache->compactAtlases();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -157,10 +202,21 @@ bool GrContext::finalizeTextureKey(GrTextureKey* key,
     return 0 != bits;
 }
 
+SK_TRACE_COUNTER(gTextureHits, "gpu.texturecache.hits");
+SK_TRACE_COUNTER(gTextureMisses, "gpu.texturecache.misses");
+
 GrTextureEntry* GrContext::findAndLockTexture(GrTextureKey* key,
                                               const GrSamplerState& sampler) {
     finalizeTextureKey(key, sampler, false);
-    return fTextureCache->findAndLock(*key);
+    GrTextureEntry* entry = fTextureCache->findAndLock(*key);
+#ifdef SK_ENABLE_TRACE
+    if (entry) {
+        SK_TRACE_INC(gTextureHits);
+    } else {
+        SK_TRACE_INC(gTextureMisses);
+    }
+#endif
+    return entry;
 }
 
 static void stretchImage(void* dst,
@@ -196,6 +252,7 @@ GrTextureEntry* GrContext::createAndLockTexture(GrTextureKey* key,
                                                 void* srcData, size_t rowBytes) {
     GrAssert(key->width() == desc.fWidth);
     GrAssert(key->height() == desc.fHeight);
+    SK_TRACE_EVENT("GrContext::createAndLockTexture");
 
 #if GR_DUMP_TEXTURE_UPLOAD
     GrPrintf("GrContext::createAndLockTexture [%d %d]\n", desc.fWidth, desc.fHeight);
@@ -398,6 +455,17 @@ GrTextureEntry* GrContext::findApproximateKeylessTexture(
     return entry;
 }
 
+GrTexture* GrContext::lockScratchRenderTarget(const GrTextureDesc& desc) {
+    // a pooled render target may have been unlocked while queued draws
+    // still read from it
+    this->flushDrawBuffer();
+    return fRenderTargetPool->lock(desc);
+}
+
+void GrContext::unlockScratchRenderTarget(GrTexture* texture) {
+    fRenderTargetPool->unlock(texture);
+}
+
 void GrContext::unlockTexture(GrTextureEntry* entry) {
     if (kKeylessBit & entry->key().getPrivateBits()) {
         fTextureCache->reattachAndUnlock(entry);
@@ -406,6 +474,26 @@ void GrContext::unlockTexture(GrTextureEntry* entry) {
     }
 }
 
+GrTexture* GrContext::findOrAddAtlasImage(uint32_t p0, uint32_t p1,
+                                          int width, int height,
+                                          const void* pixels, size_t rowBytes,
+                                          GrIRect* bounds) {
+    if (!GrImageAtlas::CanHold(width, height)) {
+        return NULL;
+    }
+    GrTexture* texture = fImageAtlas->findOrAdd(p0, p1, width, height,
+                                                pixels, rowBytes, bounds);
+    if (NULL == texture) {
+        // Every page is full. Draw what is queued from the atlas before its
+        // images are replaced.
+        this->flush();
+        fImageAtlas->purge();
+        texture = fImageAtlas->findOrAdd(p0, p1, width, height,
+                                         pixels, rowBytes, bounds);
+    }
+    return texture;
+}
+
 GrTexture* GrContext::createUncachedTexture(const GrTextureDesc& desc,
                                             void* srcData,
                                             size_t rowBytes) {
@@ -460,8 +548,20 @@ bool GrContext::supportsIndex8PixelConfig(const GrSamplerState& sampler,
     if (!fGpu->supports8BitPalette()) {
         return false;
     }
+    return this->canTextureWithoutStretch(sampler, width, height);
+}
 
+bool GrContext::supportsCompressedPixelConfig(GrPixelConfig config,
+                                              const GrSamplerState& sampler,
+                                              int width, int height) {
+    if (!fGpu->supportsCompressedConfig(config)) {
+        return false;
+    }
+    return this->canTextureWithoutStretch(sampler, width, height);
+}
 
+bool GrContext::canTextureWithoutStretch(const GrSamplerState& sampler,
+                                         int width, int height) const {
     bool isPow2 = GrIsPow2(width) && GrIsPow2(height);
 
     if (!isPow2) {
@@ -519,8 +619,10 @@ void GrContext::drawPaint(const GrPaint& paint) {
 ////////////////////////////////////////////////////////////////////////////////
 
 struct GrContext::OffscreenRecord {
-    OffscreenRecord() { fEntry0 = NULL; fEntry1 = NULL; }
-    ~OffscreenRecord() { GrAssert(NULL == fEntry0 && NULL == fEntry1); }
+    OffscreenRecord() { fOffscreen0 = NULL; fOffscreen1 = NULL; }
+    ~OffscreenRecord() {
+        GrAssert(NULL == fOffscreen0 && NULL == fOffscreen1);
+    }
 
     enum Downsample {
         k4x4TwoPass_Downsample,
@@ -532,8 +634,8 @@ struct GrContext::OffscreenRecord {
     int                            fTileCountX;
     int                            fTileCountY;
     int                            fScale;
-    GrTextureEntry*                fEntry0;
-    GrTextureEntry*                fEntry1;
+    GrTexture*                     fOffscreen0;
+    GrTexture*                     fOffscreen1;
     GrDrawTarget::SavedDrawState   fSavedState;
 };
 
@@ -574,8 +676,8 @@ bool GrContext::prepareForOffscreenAA(GrDrawTarget* target,
 
     GrAssert(GR_USE_OFFSCREEN_AA);
 
-    GrAssert(NULL == record->fEntry0);
-    GrAssert(NULL == record->fEntry1);
+    GrAssert(NULL == record->fOffscreen0);
+    GrAssert(NULL == record->fOffscreen1);
     GrAssert(!boundRect.isEmpty());
 
     int boundW = boundRect.width();
@@ -617,30 +719,30 @@ bool GrContext::prepareForOffscreenAA(GrDrawTarget* target,
     desc.fWidth *= record->fScale;
     desc.fHeight *= record->fScale;
 
-    record->fEntry0 = this->findApproximateKeylessTexture(desc);
-    if (NULL == record->fEntry0) {
+    record->fOffscreen0 = this->lockScratchRenderTarget(desc);
+    if (NULL == record->fOffscreen0) {
         return false;
     }
-    // the approximate lookup might have given us some slop space, might as well
+    // the pool might have given us some slop space, might as well
     // use it when computing the tiles size.
     // these are scale values, will adjust after considering
     // the possible second offscreen.
-    record->fTileSizeX = record->fEntry0->texture()->width();
-    record->fTileSizeY = record->fEntry0->texture()->height();
+    record->fTileSizeX = record->fOffscreen0->width();
+    record->fTileSizeY = record->fOffscreen0->height();
 
     if (OffscreenRecord::k4x4TwoPass_Downsample == record->fDownsample) {
         desc.fWidth /= 2;
         desc.fHeight /= 2;
-        record->fEntry1 = this->findApproximateKeylessTexture(desc);
-        if (NULL == record->fEntry1) {
-            this->unlockTexture(record->fEntry0);
-            record->fEntry0 = NULL;
+        record->fOffscreen1 = this->lockScratchRenderTarget(desc);
+        if (NULL == record->fOffscreen1) {
+            this->unlockScratchRenderTarget(record->fOffscreen0);
+            record->fOffscreen0 = NULL;
             return false;
         }
         record->fTileSizeX = GrMin(record->fTileSizeX, 
-                                   2 * record->fEntry0->texture()->width());
+                                   2 * record->fOffscreen0->width());
         record->fTileSizeY = GrMin(record->fTileSizeY, 
-                                   2 * record->fEntry0->texture()->height());
+                                   2 * record->fOffscreen0->height());
     }
     record->fTileSizeX /= record->fScale;
     record->fTileSizeY /= record->fScale;
@@ -657,7 +759,7 @@ void GrContext::setupOffscreenAAPass1(GrDrawTarget* target,
                                       int tileX, int tileY,
                                       OffscreenRecord* record) {
 
-    GrRenderTarget* offRT0 = record->fEntry0->texture()->asRenderTarget();
+    GrRenderTarget* offRT0 = record->fOffscreen0->asRenderTarget();
     GrAssert(NULL != offRT0);
 
     GrPaint tempPaint;
@@ -704,7 +806,7 @@ void GrContext::doOffscreenAAPass2(GrDrawTarget* target,
                                  int tileX, int tileY,
                                  OffscreenRecord* record) {
 
-    GrAssert(NULL != record->fEntry0);
+    GrAssert(NULL != record->fOffscreen0);
     
     GrIRect tileRect;
     tileRect.fLeft = boundRect.fLeft + tileX * record->fTileSizeX;
@@ -727,7 +829,7 @@ void GrContext::doOffscreenAAPass2(GrDrawTarget* target,
     GrSamplerState sampler(GrSamplerState::kClamp_WrapMode, 
                            GrSamplerState::kClamp_WrapMode, filter);
 
-    GrTexture* src = record->fEntry0->texture();
+    GrTexture* src = record->fOffscreen0;
     int scale;
 
     enum {
@@ -735,9 +837,9 @@ void GrContext::doOffscreenAAPass2(GrDrawTarget* target,
     };
 
     if (OffscreenRecord::k4x4TwoPass_Downsample == record->fDownsample) {
-        GrAssert(NULL != record->fEntry1);
+        GrAssert(NULL != record->fOffscreen1);
         scale = 2;
-        GrRenderTarget* dst = record->fEntry1->texture()->asRenderTarget();
+        GrRenderTarget* dst = record->fOffscreen1->asRenderTarget();
         
         // Do 2x2 downsample from first to second
         target->setTexture(kOffscreenStage, src);
@@ -751,7 +853,7 @@ void GrContext::doOffscreenAAPass2(GrDrawTarget* target,
                                      scale * tileRect.height());
         target->drawSimpleRect(rect, NULL, 1 << kOffscreenStage);
         
-        src = record->fEntry1->texture();
+        src = record->fOffscreen1;
     } else if (OffscreenRecord::kFSAA_Downsample == record->fDownsample) {
         scale = 1;
         GrIRect rect = SkIRect::MakeWH(tileRect.width(), tileRect.height());
@@ -799,15 +901,15 @@ void GrContext::doOffscreenAAPass2(GrDrawTarget* target,
 void GrContext::cleanupOffscreenAA(GrDrawTarget* target,
                                    GrPathRenderer* pr,
                                    OffscreenRecord* record) {
-    this->unlockTexture(record->fEntry0);
-    record->fEntry0 = NULL;
+    this->unlockScratchRenderTarget(record->fOffscreen0);
+    record->fOffscreen0 = NULL;
     if (pr) {
         // Counterpart of scale() in prepareForOffscreenAA()
         //pr->scaleCurveTolerance(SkScalarInvert(SkIntToScalar(record->fScale)));
     }
-    if (NULL != record->fEntry1) {
-        this->unlockTexture(record->fEntry1);
-        record->fEntry1 = NULL;
+    if (NULL != record->fOffscreen1) {
+        this->unlockScratchRenderTarget(record->fOffscreen1);
+        record->fOffscreen1 = NULL;
     }
     target->restoreDrawState(record->fSavedState);
 }
@@ -1021,6 +1123,35 @@ static bool isIRect(const GrRect& r) {
            GrScalarIsInt(r.fRight) && GrScalarIsInt(r.fBottom);
 }
 
+#if BATCH_RECT_TO_RECT
+/**
+ * Splits the stroke of rect into non-overlapping rects: the top and bottom
+ * sides span the full width, the left and right ones fill in between. A
+ * stroke wide enough to cover the inside of the rect is the outer rect.
+ * Returns the number of rects written.
+ */
+static int stroke_rect_sides(GrRect rect, GrScalar width, GrRect sides[4]) {
+    const GrScalar rad = GrScalarHalf(width);
+    rect.sort();
+
+    GrRect outer;
+    outer.setLTRB(rect.fLeft - rad, rect.fTop - rad,
+                  rect.fRight + rad, rect.fBottom + rad);
+    GrRect inner;
+    inner.setLTRB(rect.fLeft + rad, rect.fTop + rad,
+                  rect.fRight - rad, rect.fBottom - rad);
+    if (inner.fLeft >= inner.fRight || inner.fTop >= inner.fBottom) {
+        sides[0] = outer;
+        return 1;
+    }
+    sides[0].setLTRB(outer.fLeft, outer.fTop, outer.fRight, inner.fTop);
+    sides[1].setLTRB(outer.fLeft, inner.fBottom, outer.fRight, outer.fBottom);
+    sides[2].setLTRB(outer.fLeft, inner.fTop, inner.fLeft, inner.fBottom);
+    sides[3].setLTRB(inner.fRight, inner.fTop, outer.fRight, inner.fBottom);
+    return 4;
+}
+#endif
+
 static bool apply_aa_to_rect(GrDrawTarget* target,
                              GrGpu* gpu,
                              const GrPaint& paint,
@@ -1076,15 +1207,36 @@ void GrContext::drawRect(const GrPaint& paint,
                          GrScalar width,
                          const GrMatrix* matrix) {
 
-
-    GrDrawTarget* target = this->prepareToDraw(paint, kUnbuffered_DrawCategory);
     int stageMask = paint.getActiveStageMask();
 
+    // the draw state isn't set up from the paint yet, but the render target
+    // and view matrix that decide on aa are already those of the gpu.
     GrRect devRect = rect;
     GrMatrix combinedMatrix;
-    bool doAA = apply_aa_to_rect(target, fGpu, paint, rect, width, matrix, 
+    bool doAA = apply_aa_to_rect(fGpu, fGpu, paint, rect, width, matrix,
                                  &combinedMatrix, &devRect);
 
+#if BATCH_RECT_TO_RECT
+    // Filled and stroked rects go into the draw buffer as quads, which it
+    // merges into a single indexed draw with the neighboring rects.
+    if (!doAA && 0 != width) {
+        GrDrawTarget* target = this->prepareToDraw(paint,
+                                                   kBuffered_DrawCategory);
+        if (width < 0) {
+            target->drawSimpleRect(rect, matrix, stageMask);
+        } else {
+            GrRect sides[4];
+            int count = stroke_rect_sides(rect, width, sides);
+            for (int i = 0; i < count; ++i) {
+                target->drawSimpleRect(sides[i], matrix, stageMask);
+            }
+        }
+        return;
+    }
+#endif
+
+    GrDrawTarget* target = this->prepareToDraw(paint, kUnbuffered_DrawCategory);
+
     if (doAA) {
         GrDrawTarget::AutoViewMatrixRestore avm(target);
         if (stageMask) {
@@ -1311,6 +1463,7 @@ void GrContext::drawPath(const GrPaint& paint, const GrPath& path,
 
     GrDrawTarget* target = this->prepareToDraw(paint, kUnbuffered_DrawCategory);
     GrPathRenderer* pr = this->getPathRenderer(target, path, fill);
+    GrGpu::AutoPassRestore apr(fGpu, kPath_GrGpuPass);
 
     if (!pr->supportsAA(target, path, fill) &&
         this->doOffscreenAA(target, paint, kHairLine_PathFill == fill)) {
@@ -1341,6 +1494,7 @@ void GrContext::drawPath(const GrPaint& paint, const GrPath& path,
             }
         }
         OffscreenRecord record;
+        GrGpu::AutoPassRestore offscreenPass(fGpu, kOffscreenAA_GrGpuPass);
         if (this->prepareForOffscreenAA(target, needsStencil, bound,
                                         pr, &record)) {
             for (int tx = 0; tx < record.fTileCountX; ++tx) {
@@ -1385,6 +1539,48 @@ void GrContext::drawPath(const GrPaint& paint, const GrPath& path,
     pr->drawPath(target, enabledStages, path, fill, translate);
 }
 
+void GrContext::convolveInX(GrTexture* texture,
+                            const GrRect& rect,
+                            const float* kernel,
+                            int kernelWidth) {
+    this->convolve(texture, rect, GR_Scalar1, 0, kernel, kernelWidth);
+}
+
+void GrContext::convolveInY(GrTexture* texture,
+                            const GrRect& rect,
+                            const float* kernel,
+                            int kernelWidth) {
+    this->convolve(texture, rect, 0, GR_Scalar1, kernel, kernelWidth);
+}
+
+void GrContext::convolve(GrTexture* texture,
+                         const GrRect& rect,
+                         float imageIncrementX,
+                         float imageIncrementY,
+                         const float* kernel,
+                         int kernelWidth) {
+    GrAssert(fGpu->supportsConvolutionFilter());
+    GrAssert(texture->asRenderTarget() != this->getRenderTarget());
+
+    GrPaint paint;
+    paint.reset();
+    // the result replaces the dst
+    paint.fSrcBlendCoeff = kOne_BlendCoeff;
+    paint.fDstBlendCoeff = kZero_BlendCoeff;
+    paint.setTexture(0, texture);
+
+    GrSamplerState* sampler = paint.getTextureSampler(0);
+    sampler->setFilter(GrSamplerState::kConvolution_Filter);
+    sampler->setConvolutionParams(kernelWidth, kernel,
+                                  imageIncrementX, imageIncrementY);
+    GrMatrix sampleM;
+    sampleM.setScale(GR_Scalar1 / texture->width(),
+                     GR_Scalar1 / texture->height());
+    sampler->setMatrix(sampleM);
+
+    this->drawRect(paint, rect);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void GrContext::flush(int flagsBitfield) {
@@ -1408,6 +1604,9 @@ void GrContext::flushText() {
 void GrContext::flushDrawBuffer() {
 #if BATCH_RECT_TO_RECT || DEFER_TEXT_RENDERING
     if (fDrawBuffer) {
+        GrGpu::AutoPassRestore apr(fGpu,
+                                   kText_DrawCategory == fLastDrawCategory ?
+                                   kText_GrGpuPass : kBufferedDraws_GrGpuPass);
         fDrawBuffer->playback(fGpu);
         fDrawBuffer->reset();
     }
@@ -1445,6 +1644,19 @@ bool GrContext::readRenderTargetPixels(GrRenderTarget* target,
                             config, buffer);
 }
 
+GrPixelRead* GrContext::beginReadRenderTargetPixels(GrRenderTarget* target,
+                                                    int left, int top,
+                                                    int width, int height,
+                                                    GrPixelConfig config) {
+    uint32_t flushFlags = 0;
+    if (NULL == target) {
+        flushFlags |= GrContext::kForceCurrentRenderTarget_FlushBit;
+    }
+
+    this->flush(flushFlags);
+    return fGpu->beginReadPixels(target, left, top, width, height, config);
+}
+
 void GrContext::writePixels(int left, int top, int width, int height,
                             GrPixelConfig config, const void* buffer,
                             size_t stride) {
@@ -1599,8 +1811,34 @@ const GrGpuStats& GrContext::getStats() const {
     return fGpu->getStats();
 }
 
+bool GrContext::supportsConvolution() const {
+    return fGpu->supportsConvolutionFilter();
+}
+
+bool GrContext::supportsGradients() const {
+    return fGpu->supportsGradientSampleModes();
+}
+
+const GrGpuStats& GrContext::getPassStats(GrGpuPass pass, bool wait) {
+    fGpu->collectTimerQueries(wait);
+    if (kGrGpuPassCount == pass) {
+        return fGpu->getStats();
+    }
+    return fGpu->getPassStats(pass);
+}
+
+bool GrContext::supportsGpuTimers() const {
+    return fGpu->supportsTimerQueries();
+}
+
+void GrContext::enableGpuTimers(bool enable) {
+    fGpu->enableTimerQueries(enable);
+}
+
 void GrContext::printStats() const {
     fGpu->printStats();
+    fFontCache->printStats();
+    fRenderTargetPool->printStats();
 }
 
 GrContext::GrContext(GrGpu* gpu) :
@@ -1616,7 +1854,10 @@ GrContext::GrContext(GrGpu* gpu) :
 
     fTextureCache = new GrTextureCache(MAX_TEXTURE_CACHE_COUNT,
                                        MAX_TEXTURE_CACHE_BYTES);
+    fPurgeableCache = new TexturePurgeableCache(fTextureCache);
     fFontCache = new GrFontCache(fGpu);
+    fImageAtlas = new GrImageAtlas(fGpu);
+    fRenderTargetPool = new GrRenderTargetPool(fGpu);
 
     fLastDrawCategory = kUnbuffered_DrawCategory;
 
@@ -1656,9 +1897,15 @@ void GrContext::setupDrawBuffer() {
                                           fDrawBufferIBAllocPool);
 #endif
 
-#if BATCH_RECT_TO_RECT
+#if BATCH_RECT_TO_RECT || DEFER_TEXT_RENDERING
+    // lets the buffer merge consecutive runs of quads, from text as well as
+    // from batched rects
     fDrawBuffer->setQuadIndexBuffer(this->getQuadIndexBuffer());
 #endif
+
+#if (DEFER_TEXT_RENDERING || BATCH_RECT_TO_RECT) && REORDER_DRAW_BUFFER
+    fDrawBuffer->setReorderDraws(true);
+#endif
 }
 
 GrDrawTarget* GrContext::getTextTarget(const GrPaint& paint) {
@@ -1682,6 +1929,8 @@ GrPathRenderer* GrContext::getPathRenderer(const GrDrawTarget* target,
     if (NULL != fCustomPathRenderer &&
         fCustomPathRenderer->canDrawPath(target, path, fill)) {
         return fCustomPathRenderer;
+    } else if (fConvexPathRenderer.canDrawPath(target, path, fill)) {
+        return &fConvexPathRenderer;
     } else {
         GrAssert(fDefaultPathRenderer.canDrawPath(target, path, fill));
         return &fDefaultPathRenderer;
@@ -0,0 +1,266 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "GrConvexPathRenderer.h"
+
+#include "GrMemory.h"
+#include "GrPathUtils.h"
+#include "GrPoint.h"
+#include "GrTexture.h"
+
+#include <limits.h>
+
+namespace {
+
+// Points closer than this (in device space) are merged so that every edge
+// has a usable normal.
+const GrScalar kCloseSqd = GrScalarDiv(GR_Scalar1,
+                                       GrIntToScalar(256 * 256));
+
+// Limits how far a vertex of the ramp moves out and in at a sharp corner,
+// as a multiple of half a pixel.
+const GrScalar kMaxMiter = GrIntToScalar(4);
+
+/**
+ * Flattens the single contour of a convex path into pts. Returns the number
+ * of points, with consecutive duplicates (and a closing point equal to the
+ * first) removed.
+ */
+int flatten_path(const GrPath& path, GrScalar tolSqd, GrScalar tol,
+                 GrPoint* base) {
+    GrPoint* vert = base;
+    GrPoint pts[4];
+    SkPath::Iter iter(path, false);
+    for (;;) {
+        switch (iter.next(pts)) {
+            case kMove_PathCmd:
+                *vert++ = pts[0];
+                break;
+            case kLine_PathCmd:
+                *vert++ = pts[1];
+                break;
+            case kQuadratic_PathCmd:
+                GrPathUtils::generateQuadraticPoints(pts[0], pts[1], pts[2],
+                                                     tolSqd, &vert,
+                                                     GrPathUtils::quadraticPointCount(pts, tol));
+                break;
+            case kCubic_PathCmd:
+                GrPathUtils::generateCubicPoints(pts[0], pts[1], pts[2], pts[3],
+                                                 tolSqd, &vert,
+                                                 GrPathUtils::cubicPointCount(pts, tol));
+                break;
+            case kClose_PathCmd:
+                break;
+            case kEnd_PathCmd:
+                return vert - base;
+        }
+    }
+}
+
+int remove_close_points(GrPoint* pts, int count) {
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        if (n > 0 && pts[n - 1].distanceToSqd(pts[i]) <= kCloseSqd) {
+            continue;
+        }
+        pts[n++] = pts[i];
+    }
+    while (n > 1 && pts[n - 1].distanceToSqd(pts[0]) <= kCloseSqd) {
+        --n;
+    }
+    return n;
+}
+
+/**
+ * Sets the unit normal of each edge pts[i] -> pts[i + 1], pointing out of the
+ * polygon.
+ */
+void edge_normals(const GrPoint* pts, int count, GrVec* normals) {
+    GrScalar area = 0;
+    for (int i = 0; i < count; ++i) {
+        const GrPoint& p = pts[i];
+        const GrPoint& q = pts[(i + 1) % count];
+        area += GrMul(p.fX, q.fY) - GrMul(q.fX, p.fY);
+    }
+    GrScalar sign = area >= 0 ? GR_Scalar1 : -GR_Scalar1;
+    for (int i = 0; i < count; ++i) {
+        GrVec d = pts[(i + 1) % count] - pts[i];
+        normals[i].set(GrMul(d.fY, sign), -GrMul(d.fX, sign));
+        normals[i].normalize();
+    }
+}
+
+}
+
+GrConvexPathRenderer::GrConvexPathRenderer() {
+}
+
+bool GrConvexPathRenderer::canDrawPath(const GrDrawTarget* target,
+                                       const GrPath& path,
+                                       GrPathFill fill) const {
+    if (kHairLine_PathFill == fill || IsFillInverted(fill) ||
+        !path.isConvex()) {
+        return false;
+    }
+    // the coverage ramp is computed in device space
+    if (target->getViewMatrix().hasPerspective()) {
+        return false;
+    }
+    // a convex path may still have one contour per moveTo
+    SkPath::Iter iter(path, false);
+    GrPoint pts[4];
+    int moves = 0;
+    for (GrPathCmd cmd = (GrPathCmd)iter.next(pts); kEnd_PathCmd != cmd;
+         cmd = (GrPathCmd)iter.next(pts)) {
+        if (kMove_PathCmd == cmd && ++moves > 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GrConvexPathRenderer::supportsAA(GrDrawTarget* target,
+                                      const GrPath& path,
+                                      GrPathFill fill) {
+    return true;
+}
+
+void GrConvexPathRenderer::drawPath(GrDrawTarget* target,
+                                    GrDrawTarget::StageBitfield stages,
+                                    const GrPath& path,
+                                    GrPathFill fill,
+                                    const GrPoint* translate) {
+    GrDrawTarget::AutoStateRestore asr(target);
+    // face culling doesn't make sense here
+    GrAssert(GrDrawTarget::kBoth_DrawFace == target->getDrawFace());
+
+    GrMatrix viewM = target->getViewMatrix();
+    GrScalar stretch = viewM.getMaxStretch();
+    GrScalar tol = fCurveTolerance;
+    if (stretch > 0) {
+        tol = GrScalarDiv(tol, stretch);
+    }
+    GrScalar tolSqd = GrMul(tol, tol);
+
+    int subpathCnt;
+    int maxPts = GrPathUtils::worstCasePointCount(path, &subpathCnt, tol);
+    // the ramp doubles the vertices
+    if (2 * maxPts > USHRT_MAX) {
+        return;
+    }
+
+    GrVertexLayout layout = 0;
+    for (int s = 0; s < GrDrawTarget::kNumStages; ++s) {
+        if ((1 << s) & stages) {
+            layout |= GrDrawTarget::StagePosAsTexCoordVertexLayoutBit(s);
+        }
+    }
+
+    GrAutoSTMalloc<32, GrPoint> baseMem(maxPts);
+    GrPoint* base = (GrPoint*) baseMem;
+    int count = flatten_path(path, tolSqd, tol, base);
+    GrAssert(count <= maxPts);
+    if (NULL != translate) {
+        for (int i = 0; i < count; ++i) {
+            base[i].offset(translate->fX, translate->fY);
+        }
+    }
+
+    bool doAA = target->isAntialiasState() &&
+                !target->getRenderTarget()->isMultisampled();
+    GrMatrix inverse;
+    if (doAA && !target->getViewInverse(&inverse)) {
+        doAA = false;
+    }
+
+    if (!doAA) {
+        count = remove_close_points(base, count);
+        if (count < 3) {
+            return;
+        }
+        target->setVertexSourceToArray(layout, base, count);
+        target->drawNonIndexed(kTriangleFan_PrimitiveType, 0, count);
+        return;
+    }
+
+    // Build the ramp in device space. Stages read positions as texture
+    // coordinates, so their matrices must undo the view matrix.
+    viewM.mapPoints(base, count);
+    count = remove_close_points(base, count);
+    if (count < 3) {
+        return;
+    }
+    target->setViewMatrix(GrMatrix::I());
+    if (stages) {
+        target->preConcatSamplerMatrices(stages, inverse);
+    }
+
+    GrAutoSTMalloc<32, GrVec> normals(count);
+    edge_normals(base, count, normals);
+
+    // vertices 0..count-1 are the inset fan, count..2*count-1 the outset ring
+    layout |= GrDrawTarget::kColor_VertexLayoutBit;
+    GrDrawTarget::AutoReleaseGeometry geo(target, layout, 2 * count,
+                                          3 * (count - 2) + 6 * count);
+    if (!geo.succeeded()) {
+        return;
+    }
+    size_t vsize = GrDrawTarget::VertexSize(layout);
+    int colorOffset = GrDrawTarget::VertexColorOffset(layout);
+    intptr_t verts = reinterpret_cast<intptr_t>(geo.vertices());
+    GrColor color = target->getColor();
+
+    for (int i = 0; i < count; ++i) {
+        // the corner moves along the bisector of its two edge normals, far
+        // enough that both edges move by half a pixel
+        const GrVec& n0 = normals[(i + count - 1) % count];
+        const GrVec& n1 = normals[i];
+        GrVec bisector = n0 + n1;
+        if (!bisector.normalize()) {
+            bisector = n1;
+        }
+        GrScalar cosHalf = bisector.dot(n1);
+        GrScalar scale = GrMul(cosHalf, kMaxMiter) > GR_Scalar1 ?
+                         GrScalarDiv(GR_Scalar1, cosHalf) : kMaxMiter;
+        bisector.scale(GrMul(scale, GR_ScalarHalf));
+
+        GrPoint* inner = reinterpret_cast<GrPoint*>(verts + i * vsize);
+        GrPoint* outer = reinterpret_cast<GrPoint*>(verts + (count + i) * vsize);
+        *inner = base[i] - bisector;
+        *outer = base[i] + bisector;
+        *reinterpret_cast<GrColor*>(verts + i * vsize + colorOffset) = color;
+        *reinterpret_cast<GrColor*>(verts + (count + i) * vsize + colorOffset) = 0;
+    }
+
+    uint16_t* idx = reinterpret_cast<uint16_t*>(geo.indices());
+    for (int i = 1; i < count - 1; ++i) {
+        *idx++ = 0;
+        *idx++ = i;
+        *idx++ = i + 1;
+    }
+    for (int i = 0; i < count; ++i) {
+        int j = (i + 1) % count;
+        *idx++ = i;
+        *idx++ = count + i;
+        *idx++ = count + j;
+        *idx++ = count + j;
+        *idx++ = j;
+        *idx++ = i;
+    }
+
+    target->drawIndexed(kTriangles_PrimitiveType, 0, 0, 2 * count,
+                        3 * (count - 2) + 6 * count);
+}
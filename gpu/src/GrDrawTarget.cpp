@@ -818,8 +818,8 @@ void GrDrawTarget::SetRectVertices(const GrRect& rect,
 
     int stageOffsets[kNumStages];
     int colorOffset;
+    // any per vertex color is left for the caller to fill in
     int vsize = VertexSizeAndOffsetsByStage(layout, stageOffsets, &colorOffset);
-    GrAssert(-1 == colorOffset);
 
     GrTCast<GrPoint*>(vertices)->setRectFan(rect.fLeft, rect.fTop, 
                                             rect.fRight, rect.fBottom,
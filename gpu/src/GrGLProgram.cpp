@@ -19,6 +19,7 @@
 
 #include "GrBinHashKey.h"
 #include "GrGLConfig.h"
+#include "GrGLProgramBinaryStore.h"
 #include "GrMemory.h"
 
 #include "SkXfermode.h"
@@ -142,6 +143,16 @@ static void tex_domain_name(int stage, GrStringBuilder* s) {
     s->appendS32(stage);
 }
 
+static void kernel_name(int stage, GrStringBuilder* s) {
+    *s = "uKernel";
+    s->appendS32(stage);
+}
+
+static void image_increment_name(int stage, GrStringBuilder* s) {
+    *s = "uImageIncrement";
+    s->appendS32(stage);
+}
+
 GrGLProgram::GrGLProgram() {
 }
 
@@ -327,7 +338,8 @@ static void addColorFilter(GrStringBuilder* fsCode, const char * outputVar,
     add_helper(outputVar, colorStr.c_str(), constStr.c_str(), fsCode);
 }
 
-bool GrGLProgram::genProgram(GrGLProgram::CachedData* programData) const {
+bool GrGLProgram::genProgram(GrGLProgram::CachedData* programData,
+                             GrGLProgramBinaryStore* binaryStore) const {
 
     ShaderCodeSegments segments;
     const uint32_t& layout = fProgramDesc.fVertexLayout;
@@ -626,6 +638,14 @@ bool GrGLProgram::genProgram(GrGLProgram::CachedData* programData) const {
     ///////////////////////////////////////////////////////////////////////////
     // compile and setup attribs and unis
 
+    // the code is still generated for a stored binary, as that is what
+    // decides which uniforms must be looked up
+    if (NULL != binaryStore &&
+        this->loadProgramBinary(binaryStore, programData)) {
+        this->getUniformLocationsAndInitCache(programData);
+        return true;
+    }
+
     if (!CompileFSAndVS(segments, programData)) {
         return false;
     }
@@ -637,6 +657,10 @@ bool GrGLProgram::genProgram(GrGLProgram::CachedData* programData) const {
         return false;
     }
 
+    if (NULL != binaryStore) {
+        this->storeProgramBinary(binaryStore, programData);
+    }
+
     this->getUniformLocationsAndInitCache(programData);
 
     return true;
@@ -866,6 +890,58 @@ bool GrGLProgram::bindOutputsAttribsAndLinkProgram(
     return true;
 }
 
+bool GrGLProgram::loadProgramBinary(GrGLProgramBinaryStore* binaryStore,
+                                    CachedData* programData) const {
+    GrGLenum format;
+    GrAutoMalloc binary;
+    if (!binaryStore->find(&fProgramDesc, sizeof(fProgramDesc),
+                           &format, &binary)) {
+        return false;
+    }
+
+    programData->fProgramID = GR_GL(CreateProgram());
+    if (!programData->fProgramID) {
+        return false;
+    }
+    // the attrib locations were bound before the binary was linked. There
+    // are no shaders to delete with the program.
+    programData->fVShaderID = 0;
+    programData->fFShaderID = 0;
+
+    // a binary from another driver is an expected error
+    GR_GL_NO_ERR(ProgramBinary(programData->fProgramID, format,
+                               binary.get(), binary.size()));
+    GrGLClearErr();
+    GrGLint linked = GR_GL_INIT_ZERO;
+    GR_GL(GetProgramiv(programData->fProgramID, GR_GL_LINK_STATUS, &linked));
+    if (!linked) {
+        GR_GL(DeleteProgram(programData->fProgramID));
+        programData->fProgramID = 0;
+        return false;
+    }
+    return true;
+}
+
+void GrGLProgram::storeProgramBinary(GrGLProgramBinaryStore* binaryStore,
+                                     const CachedData* programData) const {
+    GrGLint length = GR_GL_INIT_ZERO;
+    GR_GL(GetProgramiv(programData->fProgramID,
+                       GR_GL_PROGRAM_BINARY_LENGTH,
+                       &length));
+    if (length <= 0) {
+        return;
+    }
+    GrAutoMalloc binary(length);
+    GrGLsizei written = 0;
+    GrGLenum format;
+    GR_GL(GetProgramBinary(programData->fProgramID, length, &written,
+                           &format, binary.get()));
+    if (written > 0) {
+        binaryStore->add(&fProgramDesc, sizeof(fProgramDesc),
+                         format, binary.get(), written);
+    }
+}
+
 void GrGLProgram::getUniformLocationsAndInitCache(CachedData* programData) const {
     const GrGLint& progID = programData->fProgramID;
 
@@ -939,6 +1015,24 @@ void GrGLProgram::getUniformLocationsAndInitCache(CachedData* programData) const
                                              texDomName.c_str()));
                 GrAssert(kUnusedUniform != locations.fTexDomUni);
             }
+
+            if (kUseUniform == locations.fKernelUni) {
+                GrStringBuilder kernelName;
+                kernel_name(s, &kernelName);
+                locations.fKernelUni = GR_GL(GetUniformLocation(
+                                             progID,
+                                             kernelName.c_str()));
+                GrAssert(kUnusedUniform != locations.fKernelUni);
+            }
+
+            if (kUseUniform == locations.fImageIncrementUni) {
+                GrStringBuilder imageIncrementName;
+                image_increment_name(s, &imageIncrementName);
+                locations.fImageIncrementUni = GR_GL(GetUniformLocation(
+                                                     progID,
+                                                     imageIncrementName.c_str()));
+                GrAssert(kUnusedUniform != locations.fImageIncrementUni);
+            }
         }
     }
     GR_GL(UseProgram(progID));
@@ -953,7 +1047,13 @@ void GrGLProgram::getUniformLocationsAndInitCache(CachedData* programData) const
         programData->fRadial2Radius0[s] = -GR_ScalarMax;
         programData->fTextureWidth[s] = -1;
         programData->fTextureHeight[s] = -1;
+        programData->fTextureDomain[s].setLTRB(GR_ScalarMax, GR_ScalarMax,
+                                               -GR_ScalarMax, -GR_ScalarMax);
+        programData->fKernelWidth[s] = -1;
+        programData->fImageIncrement[s][0] = GR_ScalarMax;
+        programData->fImageIncrement[s][1] = GR_ScalarMax;
     }
+    programData->fEdgeAANumEdges = -1;
     programData->fViewMatrix = GrMatrix::InvalidMatrix();
     programData->fColor = GrColor_ILLEGAL;
     programData->fColorFilterColor = GrColor_ILLEGAL;
@@ -1015,6 +1115,19 @@ void GrGLProgram::genStageCode(int stageNum,
         segments->fFSUnis.appendf("uniform vec2 %s;\n", texelSizeName.c_str());
     }
 
+    GrStringBuilder kernelName, imageIncrementName;
+    if (ProgramDesc::StageDesc::kConvolution_FetchMode == desc.fFetchMode) {
+        GrAssert(desc.fKernelWidth & 1);
+        kernel_name(stageNum, &kernelName);
+        image_increment_name(stageNum, &imageIncrementName);
+        segments->fFSUnis.appendf("uniform float %s[%d];\n",
+                                  kernelName.c_str(), desc.fKernelWidth);
+        segments->fFSUnis.appendf("uniform vec2 %s;\n",
+                                  imageIncrementName.c_str());
+        locations->fKernelUni = kUseUniform;
+        locations->fImageIncrementUni = kUseUniform;
+    }
+
     segments->fVaryings.appendf("varying %s %s;\n",
                                 float_vector_type(varyingDims), varyingName.c_str());
 
@@ -1198,6 +1311,32 @@ void GrGLProgram::genStageCode(int stageNum,
         segments->fFSCode.appendf("\t%s += %s(%s, %s + vec2(-%s.x,+%s.y))%s;\n", accumVar.c_str(), texFunc.c_str(), samplerName.c_str(), sampleCoords.c_str(), texelSizeName.c_str(), texelSizeName.c_str(), smear);
         segments->fFSCode.appendf("\t%s += %s(%s, %s + vec2(+%s.x,+%s.y))%s;\n", accumVar.c_str(), texFunc.c_str(), samplerName.c_str(), sampleCoords.c_str(), texelSizeName.c_str(), texelSizeName.c_str(), smear);
         segments->fFSCode.appendf("\t%s = .25 * %s%s;\n", fsOutColor, accumVar.c_str(), modulate.c_str());
+    } else if (ProgramDesc::StageDesc::kConvolution_FetchMode == desc.fFetchMode) {
+        GrAssert(2 == coordDims);
+        // start at the first tap and step through the kernel one image
+        // increment at a time.
+        GrStringBuilder coordVar("kCoord");
+        coordVar.appendS32(stageNum);
+        GrStringBuilder sumVar("sum");
+        sumVar.appendS32(stageNum);
+        segments->fFSCode.appendf("\t%s %s = %s - %d.0 * %s;\n",
+                                  float_vector_type(coordDims),
+                                  coordVar.c_str(), sampleCoords.c_str(),
+                                  desc.fKernelWidth / 2,
+                                  imageIncrementName.c_str());
+        segments->fFSCode.appendf("\tvec4 %s = vec4(0, 0, 0, 0);\n",
+                                  sumVar.c_str());
+        segments->fFSCode.appendf("\tfor (int i = 0; i < %d; i++) {\n",
+                                  desc.fKernelWidth);
+        segments->fFSCode.appendf("\t\t%s += %s(%s, %s)%s * %s[i];\n",
+                                  sumVar.c_str(), texFunc.c_str(),
+                                  samplerName.c_str(), coordVar.c_str(),
+                                  smear, kernelName.c_str());
+        segments->fFSCode.appendf("\t\t%s += %s;\n", coordVar.c_str(),
+                                  imageIncrementName.c_str());
+        segments->fFSCode.appendf("\t}\n");
+        segments->fFSCode.appendf("\t%s = %s%s;\n", fsOutColor,
+                                  sumVar.c_str(), modulate.c_str());
     } else {
 
         GrStringBuilder texXCoord;
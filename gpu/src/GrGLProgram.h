@@ -26,6 +26,7 @@
 #include "SkXfermode.h"
 
 class GrBinHashKeyBuilder;
+class GrGLProgramBinaryStore;
 
 struct ShaderCodeSegments {
     GrStringBuilder fHeader; // VS+FS, GLSL version, etc
@@ -67,8 +68,12 @@ public:
      *  This is the heavy initilization routine for building a GLProgram.
      *  The result of heavy init is not stored in datamembers of GrGLProgam,
      *  but in a separate cacheable container.
+     *
+     *  If binaryStore is not NULL the linked program is loaded from it when
+     *  it holds a binary the driver accepts, and is added to it otherwise.
      */
-    bool genProgram(CachedData* programData) const;
+    bool genProgram(CachedData* programData,
+                    GrGLProgramBinaryStore* binaryStore = NULL) const;
 
      /**
       * The shader may modify the blend coeffecients. Params are in/out
@@ -113,7 +118,8 @@ private:
             };
             enum FetchMode {
                 kSingle_FetchMode,
-                k2x2_FetchMode
+                k2x2_FetchMode,
+                kConvolution_FetchMode
             };
             enum CoordMapping {
                 kIdentity_CoordMapping,
@@ -140,6 +146,7 @@ private:
 
             uint8_t fWrapModeHorizontal; // casts to enum GrSamplerState::WrapMode
             uint8_t fWrapModeVertical;
+            uint8_t fKernelWidth;  // 0 unless kConvolution_FetchMode
         };
 
         enum ColorType {
@@ -172,7 +179,7 @@ private:
         int8_t fEdgeAANumEdges;
         uint8_t fColorFilterXfermode;  // casts to enum SkXfermode::Mode
 
-        uint8_t fPadTo32bLengthMultiple [1];
+        // the fields above already make up a 32b length multiple
 
     } fProgramDesc;
 
@@ -190,12 +197,16 @@ public:
         GrGLint fSamplerUni;
         GrGLint fRadial2Uni;
         GrGLint fTexDomUni;
+        GrGLint fKernelUni;
+        GrGLint fImageIncrementUni;
         void reset() {
             fTextureMatrixUni = kUnusedUniform;
             fNormalizedTexelSizeUni = kUnusedUniform;
             fSamplerUni = kUnusedUniform;
             fRadial2Uni = kUnusedUniform;
             fTexDomUni = kUnusedUniform;
+            fKernelUni = kUnusedUniform;
+            fImageIncrementUni = kUnusedUniform;
         }
     };
 
@@ -251,6 +262,14 @@ public:
         GrScalar                    fRadial2Radius0[GrDrawTarget::kNumStages];
         bool                        fRadial2PosRoot[GrDrawTarget::kNumStages];
         GrRect                      fTextureDomain[GrDrawTarget::kNumStages];
+        // convolution kernels and (normalized) image increments
+        int                         fKernelWidth[GrDrawTarget::kNumStages];
+        float                       fKernel[GrDrawTarget::kNumStages]
+                                           [GrSamplerState::kMaxKernelWidth];
+        float                       fImageIncrement[GrDrawTarget::kNumStages][2];
+        // edges as given to GL, i.e. flipped to the render target
+        GrDrawTarget::Edge          fEdgeAAEdges[GrDrawTarget::kMaxEdges];
+        int                         fEdgeAANumEdges;
 
     private:
         enum Constants {
@@ -291,6 +310,15 @@ private:
                 bool bindDualSrcOut,
                 CachedData* programData) const;
 
+    // Creates a GL program ID from the binary stored for this program's
+    // descriptor. Returns false if there isn't one or the driver rejects it.
+    bool loadProgramBinary(GrGLProgramBinaryStore* binaryStore,
+                           CachedData* programData) const;
+
+    // Adds the linked program's binary to the store.
+    void storeProgramBinary(GrGLProgramBinaryStore* binaryStore,
+                            const CachedData* programData) const;
+
     // Gets locations for all uniforms set to kUseUniform and initializes cache
     // to invalid values.
     void getUniformLocationsAndInitCache(CachedData* programData) const;
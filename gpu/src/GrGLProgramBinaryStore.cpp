@@ -0,0 +1,119 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "GrGLProgramBinaryStore.h"
+#include "GrMemory.h"
+#include "GrStringBuilder.h"
+#include "SkStream.h"
+
+namespace {
+
+// Each file holds the full key, so that two keys with the same hash (and so
+// the same file name) are told apart.
+enum {
+    kFileTag     = ('g' << 24) | ('r' << 16) | ('p' << 8) | 'b',
+    kFileVersion = 1,
+};
+
+uint32_t hash_key(const void* key, size_t keySize) {
+    // FNV-1a
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(key);
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < keySize; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+    return hash;
+}
+
+class GrGLProgramFileStore : public GrGLProgramBinaryStore {
+public:
+    GrGLProgramFileStore(const char dir[]) : fDir(dir) {
+        if (fDir.size() && !fDir.endsWith("/")) {
+            fDir.append("/");
+        }
+    }
+
+    virtual bool find(const void* key, size_t keySize,
+                      GrGLenum* format, GrAutoMalloc* binary) {
+        GrStringBuilder path;
+        this->getPath(key, keySize, &path);
+        SkFILEStream stream(path.c_str());
+        if (!stream.isValid() ||
+            kFileTag != stream.readU32() ||
+            kFileVersion != stream.readU32() ||
+            keySize != stream.readU32()) {
+            return false;
+        }
+        GrAutoMalloc storedKey(keySize);
+        if (keySize != stream.read(storedKey.get(), keySize) ||
+            memcmp(storedKey.get(), key, keySize)) {
+            return false;
+        }
+        *format = stream.readU32();
+        size_t size = stream.readU32();
+        // a truncated file has a short binary
+        if (0 == size || size > stream.getLength()) {
+            return false;
+        }
+        binary->realloc(size);
+        return size == stream.read(binary->get(), size);
+    }
+
+    virtual void add(const void* key, size_t keySize,
+                     GrGLenum format, const void* binary, size_t size) {
+        GrStringBuilder path;
+        this->getPath(key, keySize, &path);
+        SkFILEWStream stream(path.c_str());
+        if (!stream.isValid()) {
+            return;
+        }
+        stream.write32(kFileTag);
+        stream.write32(kFileVersion);
+        stream.write32(keySize);
+        stream.write(key, keySize);
+        stream.write32(format);
+        stream.write32(size);
+        stream.write(binary, size);
+    }
+
+private:
+    void getPath(const void* key, size_t keySize,
+                 GrStringBuilder* path) const {
+        path->printf("%s%08x.glbin", fDir.c_str(), hash_key(key, keySize));
+    }
+
+    GrStringBuilder fDir;
+
+    typedef GrGLProgramBinaryStore INHERITED;
+};
+
+GrGLProgramBinaryStore* gProgramBinaryStore;
+
+}
+
+GrGLProgramBinaryStore* GrGLProgramBinaryStore::CreateFileStore(
+                                                        const char dir[]) {
+    return new GrGLProgramFileStore(dir);
+}
+
+void GrGLSetProgramBinaryStore(GrGLProgramBinaryStore* store) {
+    GrSafeAssign(gProgramBinaryStore, store);
+}
+
+GrGLProgramBinaryStore* GrGLGetProgramBinaryStore() {
+    return gProgramBinaryStore;
+}
@@ -191,14 +191,23 @@ void GrGLTexture::uploadTextureData(int x,
     // glCompressedTexSubImage2D doesn't support any formats
     // (at least without extensions)
     GrAssert(fUploadFormat != GR_GL_PALETTE8_RGBA8);
+    GrAssert(!GrPixelConfigIsCompressed(this->config()));
 
     // If we need to update textures that are created upside down
     // then we have to modify this code to flip the srcData
     GrAssert(kTopDown_Orientation == fOrientation);
+#if GR_COLLECT_STATS
+    GPUGL->passStats().fUploadByteCnt += width * height * fUploadByteCount;
+#endif
     GR_GL(BindTexture(GR_GL_TEXTURE_2D, fTexIDObj->id()));
     GR_GL(PixelStorei(GR_GL_UNPACK_ALIGNMENT, fUploadByteCount));
+    bool boundUnpackBuffer = GPUGL->bindUnpackBuffer(&srcData,
+                                            width * height * fUploadByteCount);
     GR_GL(TexSubImage2D(GR_GL_TEXTURE_2D, 0, x, y, width, height,
                         fUploadFormat, fUploadType, srcData));
+    if (boundUnpackBuffer) {
+        GPUGL->unbindUnpackBuffer();
+    }
 
 }
 
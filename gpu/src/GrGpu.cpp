@@ -38,6 +38,8 @@ extern void gr_run_unittests();
 
 GrGpu::GrGpu()
     : f8bitPaletteSupport(false)
+    , fETC1Support(false)
+    , fDXT1Support(false)
     , fContext(NULL)
     , fVertexPool(NULL)
     , fIndexPool(NULL)
@@ -49,7 +51,19 @@ GrGpu::GrGpu()
     , fDefaultPathRenderer(NULL)
     , fClientPathRenderer(NULL)
     , fContextIsDirty(true)
-    , fResourceHead(NULL) {
+    , fResourceHead(NULL)
+    , fTimerQueriesEnabled(false)
+    , fDrawBoundsValid(false) {
+
+    fCurrPass = kOther_GrGpuPass;
+    fTimerQuerySupport = false;
+    fStatsGeneration = 0;
+
+    fClipState.fClipInStencil = false;
+    fClipState.fClipIsDirty = true;
+    fClipState.fStencilGeneration = 1;
+    fClipState.fScissorRectCount = -1;
+    fClipState.fDrawPassCount = 0;
 
 #if GR_DEBUG
     //gr_run_unittests();
@@ -189,6 +203,26 @@ bool GrGpu::readPixels(GrRenderTarget* target,
     return this->onReadPixels(target, left, top, width, height, config, buffer);
 }
 
+GrPixelRead* GrGpu::beginReadPixels(GrRenderTarget* target,
+                                    int left, int top, int width, int height,
+                                    GrPixelConfig config) {
+
+    this->handleDirtyContext();
+    if (NULL == target) {
+        target = fCurrDrawState.fRenderTarget;
+        if (NULL == target) {
+            return NULL;
+        }
+    }
+    return this->onBeginReadPixels(target, left, top, width, height, config);
+}
+
+GrPixelRead* GrGpu::onBeginReadPixels(GrRenderTarget* target,
+                                      int left, int top, int width, int height,
+                                      GrPixelConfig config) {
+    return NULL;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static const int MAX_QUADS = 1 << 12; // max possible: (1 << 14) - 1;
@@ -265,6 +299,26 @@ const GrVertexBuffer* GrGpu::getUnitSquareVertexBuffer() const {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void GrGpu::drawRect(const GrRect& rect,
+                     const GrMatrix* matrix,
+                     StageBitfield stageEnableBitfield,
+                     const GrRect* srcRects[],
+                     const GrMatrix* srcMatrices[]) {
+    GrMatrix combined = fCurrDrawState.fViewMatrix;
+    if (NULL != matrix) {
+        combined.preConcat(*matrix);
+    }
+    // mapRect doesn't bound the rect if it goes behind the eye
+    fDrawBoundsValid = !combined.hasPerspective();
+    if (fDrawBoundsValid) {
+        combined.mapRect(&fDrawBounds, rect);
+    }
+
+    INHERITED::drawRect(rect, matrix, stageEnableBitfield,
+                        srcRects, srcMatrices);
+    fDrawBoundsValid = false;
+}
+
 void GrGpu::clipWillBeSet(const GrClip& newClip) {
     if (newClip != fClip) {
         fClipState.fClipIsDirty = true;
@@ -376,10 +430,88 @@ void GrGpu::ConvertStencilFuncAndMask(GrStencilFunc func,
     #define SET_RANDOM_COLOR
 #endif
 
+/*
+ *  Finds disjoint device rects whose union is the clip, so it can be applied
+ *  with the scissor instead of the stencil. Returns the number of rects, or
+ *  -1 if the clip has a path or an op other than replace, intersect and
+ *  union, or needs more than kMaxClipScissorRects rects. The rects are
+ *  rounded the way they would rasterize into the stencil.
+ */
+static int get_clip_scissor_rects(const GrClip& clip, int maxCount,
+                                  GrIRect rects[]) {
+    int count = 0;
+    for (int c = 0; c < clip.getElementCount(); ++c) {
+        if (kRect_ClipType != clip.getElementType(c)) {
+            return -1;
+        }
+        GrIRect r;
+        clip.getRect(c).round(&r);
+
+        GrSetOp op = 0 == c ? kReplace_SetOp : clip.getOp(c);
+        switch (op) {
+            case kReplace_SetOp:
+                count = 0;
+                if (!r.isEmpty()) {
+                    rects[count++] = r;
+                }
+                break;
+            case kIntersect_SetOp: {
+                int kept = 0;
+                for (int i = 0; i < count; ++i) {
+                    if (rects[i].intersect(r)) {
+                        rects[kept++] = rects[i];
+                    }
+                }
+                count = kept;
+                break;
+            }
+            case kUnion_SetOp: {
+                if (r.isEmpty()) {
+                    break;
+                }
+                bool covered = false;
+                int kept = 0;
+                for (int i = 0; i < count; ++i) {
+                    if (rects[i].contains(r)) {
+                        covered = true;
+                    }
+                    if (!r.contains(rects[i])) {
+                        rects[kept++] = rects[i];
+                    }
+                }
+                count = kept;
+                if (covered) {
+                    break;
+                }
+                for (int i = 0; i < count; ++i) {
+                    if (GrIRect::Intersects(rects[i], r)) {
+                        // overlapping passes would blend twice
+                        return -1;
+                    }
+                }
+                if (count == maxCount) {
+                    return -1;
+                }
+                rects[count++] = r;
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+    return count;
+}
+
 bool GrGpu::setupClipAndFlushState(GrPrimitiveType type) {
     const GrIRect* r = NULL;
     GrIRect clipRect;
 
+    // the bounds only apply to this draw, not to the ones made below to
+    // render the clip
+    bool drawBoundsValid = fDrawBoundsValid;
+    fDrawBoundsValid = false;
+    fClipState.fDrawPassCount = 0;
+
     // we check this early because we need a valid
     // render target to setup stencil clipping
     // before even going into flushGraphicsState
@@ -410,15 +542,69 @@ bool GrGpu::setupClipAndFlushState(GrPrimitiveType type) {
         }
         r = &clipRect;
 
+        if (drawBoundsValid && !GrRect::Intersects(fDrawBounds, bounds)) {
+            // the clip rejects the whole draw
+            return false;
+        }
+
+        if (fClipState.fClipIsDirty) {
+            fClipState.fScissorRectCount = -1;
+            if (!fClip.isRect() && !fClip.isEmpty()) {
+                fClipState.fScissorRectCount =
+                    get_clip_scissor_rects(fClip, kMaxClipScissorRects,
+                                           fClipState.fScissorRects);
+            }
+        }
+
+        bool scissorRects = !fClip.isRect() &&
+                            !fClip.isEmpty() &&
+                            fClipState.fScissorRectCount >= 0;
+        if (scissorRects) {
+            // use the rects that the draw touches, and no clip at all if one
+            // of them contains it
+            int passes = 0;
+            for (int i = 0; i < fClipState.fScissorRectCount; ++i) {
+                GrIRect passRect = fClipState.fScissorRects[i];
+                if (!passRect.intersect(clipRect)) {
+                    continue;
+                }
+                if (drawBoundsValid) {
+                    GrRect rect;
+                    rect.set(passRect);
+                    if (rect.contains(fDrawBounds)) {
+                        passes = 0;
+                        r = NULL;
+                        break;
+                    }
+                    if (!GrRect::Intersects(rect, fDrawBounds)) {
+                        continue;
+                    }
+                }
+                fClipState.fDrawPassRects[passes++] = passRect;
+            }
+            if (NULL != r) {
+                if (0 == passes) {
+                    return false;
+                }
+                r = &fClipState.fDrawPassRects[0];
+            }
+            fClipState.fDrawPassCount = passes;
+        } else if (drawBoundsValid && fClip.isRect() &&
+                   fClip.getRect(0).contains(fDrawBounds)) {
+            r = NULL;
+        }
+
         fClipState.fClipInStencil = !fClip.isRect() &&
                                     !fClip.isEmpty() &&
-                                    !bounds.isEmpty();
+                                    !bounds.isEmpty() &&
+                                    !scissorRects;
 
         if (fClipState.fClipInStencil &&
-            (fClipState.fClipIsDirty ||
+            (rt.fLastStencilClipGeneration != fClipState.fStencilGeneration ||
              fClip != rt.fLastStencilClip)) {
 
             rt.fLastStencilClip = fClip;
+            rt.fLastStencilClipGeneration = fClipState.fStencilGeneration;
             // we set the current clip to the bounds so that our recursive
             // draws are scissored to them. We use the copy of the complex clip
             // in the rt to render
@@ -427,6 +613,7 @@ bool GrGpu::setupClipAndFlushState(GrPrimitiveType type) {
 
             AutoStateRestore asr(this);
             AutoGeometryPush agp(this);
+            AutoPassRestore apr(this, kClip_GrGpuPass);
 
             this->setViewMatrix(GrMatrix::I());
             this->clearStencilClip(clipRect);
@@ -613,9 +800,9 @@ void GrGpu::onDrawIndexed(GrPrimitiveType type,
     }
 
 #if GR_COLLECT_STATS
-    fStats.fVertexCnt += vertexCount;
-    fStats.fIndexCnt  += indexCount;
-    fStats.fDrawCnt   += 1;
+    this->passStats().fVertexCnt += vertexCount;
+    this->passStats().fIndexCnt  += indexCount;
+    this->passStats().fDrawCnt   += 1;
 #endif
 
     int sVertex = startVertex;
@@ -624,6 +811,12 @@ void GrGpu::onDrawIndexed(GrPrimitiveType type,
 
     this->onGpuDrawIndexed(type, sVertex, sIndex,
                            vertexCount, indexCount);
+    // the rest of the rects of a scissored clip
+    for (int i = 1; i < fClipState.fDrawPassCount; ++i) {
+        this->flushScissor(&fClipState.fDrawPassRects[i]);
+        this->onGpuDrawIndexed(type, sVertex, sIndex,
+                               vertexCount, indexCount);
+    }
 }
 
 void GrGpu::onDrawNonIndexed(GrPrimitiveType type,
@@ -635,14 +828,18 @@ void GrGpu::onDrawNonIndexed(GrPrimitiveType type,
         return;
     }
 #if GR_COLLECT_STATS
-    fStats.fVertexCnt += vertexCount;
-    fStats.fDrawCnt   += 1;
+    this->passStats().fVertexCnt += vertexCount;
+    this->passStats().fDrawCnt   += 1;
 #endif
 
     int sVertex = startVertex;
     setupGeometry(&sVertex, NULL, vertexCount, 0);
 
     this->onGpuDrawNonIndexed(type, sVertex, vertexCount);
+    for (int i = 1; i < fClipState.fDrawPassCount; ++i) {
+        this->flushScissor(&fClipState.fDrawPassRects[i]);
+        this->onGpuDrawNonIndexed(type, sVertex, vertexCount);
+    }
 }
 
 void GrGpu::finalizeReservedVertices() {
@@ -784,26 +981,82 @@ void GrGpu::releaseIndexArray() {
 ////////////////////////////////////////////////////////////////////////////////
 
 const GrGpuStats& GrGpu::getStats() const {
+    memset(&fStats, 0, sizeof(fStats));
+    for (int p = 0; p < kGrGpuPassCount; ++p) {
+        const GrGpuStats& stats = fPassStats[p];
+        fStats.fVertexCnt             += stats.fVertexCnt;
+        fStats.fIndexCnt              += stats.fIndexCnt;
+        fStats.fDrawCnt               += stats.fDrawCnt;
+        fStats.fProgChngCnt           += stats.fProgChngCnt;
+        fStats.fTextureChngCnt        += stats.fTextureChngCnt;
+        fStats.fRenderTargetChngCnt   += stats.fRenderTargetChngCnt;
+        fStats.fTextureCreateCnt      += stats.fTextureCreateCnt;
+        fStats.fRenderTargetCreateCnt += stats.fRenderTargetCreateCnt;
+        fStats.fStateChngCnt          += stats.fStateChngCnt;
+        fStats.fUniformChngCnt        += stats.fUniformChngCnt;
+        fStats.fSkippedChngCnt        += stats.fSkippedChngCnt;
+        fStats.fUploadByteCnt         += stats.fUploadByteCnt;
+        fStats.fGpuTimeNs             += stats.fGpuTimeNs;
+    }
     return fStats;
 }
 
 void GrGpu::resetStats() {
-    memset(&fStats, 0, sizeof(fStats));
+    memset(fPassStats, 0, sizeof(fPassStats));
+    fStatsGeneration += 1;
+}
+
+void GrGpu::setPass(GrGpuPass pass) {
+    GrAssert((unsigned)pass < kGrGpuPassCount);
+    if (pass != fCurrPass) {
+        fCurrPass = pass;
+        if (fTimerQueriesEnabled) {
+            this->onSetTimedPass(pass);
+        }
+    }
+}
+
+void GrGpu::enableTimerQueries(bool enable) {
+    enable = enable && fTimerQuerySupport;
+    if (enable != fTimerQueriesEnabled) {
+        fTimerQueriesEnabled = enable;
+        this->onSetTimedPass(enable ? fCurrPass : kGrGpuPassCount);
+    }
 }
 
 void GrGpu::printStats() const {
+    static const char* gPassNames[] = {
+        "Other", "BufferedDraws", "Text", "Path", "Clip", "OffscreenAA"
+    };
+    GR_STATIC_ASSERT(GR_ARRAY_COUNT(gPassNames) == kGrGpuPassCount);
+
     if (GR_COLLECT_STATS) {
+     const GrGpuStats& stats = this->getStats();
      GrPrintf(
      "-v-------------------------GPU STATS----------------------------v-\n"
      "Stats collection is: %s\n"
      "Draws: %04d, Verts: %04d, Indices: %04d\n"
      "ProgChanges: %04d, TexChanges: %04d, RTChanges: %04d\n"
      "TexCreates: %04d, RTCreates:%04d\n"
-     "-^--------------------------------------------------------------^-\n",
+     "StateChanges: %04d, UniformChanges: %04d, SkippedChanges: %04d\n"
+     "UploadKB: %04d, GpuMs: %.3f\n",
      (GR_COLLECT_STATS ? "ON" : "OFF"),
-    fStats.fDrawCnt, fStats.fVertexCnt, fStats.fIndexCnt,
-    fStats.fProgChngCnt, fStats.fTextureChngCnt, fStats.fRenderTargetChngCnt,
-    fStats.fTextureCreateCnt, fStats.fRenderTargetCreateCnt);
+    stats.fDrawCnt, stats.fVertexCnt, stats.fIndexCnt,
+    stats.fProgChngCnt, stats.fTextureChngCnt, stats.fRenderTargetChngCnt,
+    stats.fTextureCreateCnt, stats.fRenderTargetCreateCnt,
+    stats.fStateChngCnt, stats.fUniformChngCnt, stats.fSkippedChngCnt,
+    (int)(stats.fUploadByteCnt >> 10),
+    stats.fGpuTimeNs / 1000000.0);
+     for (int p = 0; p < kGrGpuPassCount; ++p) {
+         const GrGpuStats& pass = fPassStats[p];
+         GrPrintf("%-14s Draws: %04d, ProgChanges: %04d, StateChanges: %04d, "
+                  "UploadKB: %04d, GpuMs: %.3f\n",
+                  gPassNames[p], pass.fDrawCnt, pass.fProgChngCnt,
+                  pass.fStateChngCnt, (int)(pass.fUploadByteCnt >> 10),
+                  pass.fGpuTimeNs / 1000000.0);
+     }
+     GrPrintf(
+     "-^--------------------------------------------------------------^-\n");
     }
 }
 
@@ -321,14 +321,29 @@ GrGpuGL::GrGpuGL(GrPlatform3DContext platformContext) {
     GrAutoSTMalloc<10, GrGLint> formats(numFormats);
     GR_GL_GetIntegerv(GR_GL_COMPRESSED_TEXTURE_FORMATS, formats);
     for (int i = 0; i < numFormats; ++i) {
-        if (formats[i] == GR_GL_PALETTE8_RGBA8) {
-            f8bitPaletteSupport = true;
-            break;
+        switch (formats[i]) {
+            case GR_GL_PALETTE8_RGBA8:
+                f8bitPaletteSupport = true;
+                break;
+            case GR_GL_ETC1_RGB8:
+                fETC1Support = true;
+                break;
+            case GR_GL_COMPRESSED_RGB_S3TC_DXT1:
+                fDXT1Support = true;
+                break;
         }
     }
+    // some drivers don't list every format that their extensions add
+    fETC1Support = fETC1Support ||
+                   has_gl_extension("GL_OES_compressed_ETC1_RGB8_texture");
+    fDXT1Support = fDXT1Support ||
+                   has_gl_extension("GL_EXT_texture_compression_s3tc") ||
+                   has_gl_extension("GL_EXT_texture_compression_dxt1");
 
     if (gPrintStartupSpew) {
         GrPrintf("Palette8 support: %s\n", (f8bitPaletteSupport ? "YES" : "NO"));
+        GrPrintf("ETC1 support: %s\n", (fETC1Support ? "YES" : "NO"));
+        GrPrintf("DXT1 support: %s\n", (fDXT1Support ? "YES" : "NO"));
     }
 
     GR_STATIC_ASSERT(0 == kNone_GrAALevel);
@@ -461,6 +476,40 @@ GrGpuGL::GrGpuGL(GrPlatform3DContext platformContext) {
         GrPrintf("Map Buffer: %s\n", (fBufferLockSupport ? "YES" : "NO"));
     }
 
+    if (GR_GL_SUPPORT_DESKTOP) {
+        fPixelBufferSupport =
+                    major > 2 || (2 == major && 1 <= minor) ||
+                    has_gl_extension("GL_ARB_pixel_buffer_object") ||
+                    has_gl_extension("GL_EXT_pixel_buffer_object");
+    } else {
+        fPixelBufferSupport = false;
+    }
+    fUnpackBufferID = 0;
+    memset(fReadBuffers, 0, sizeof(fReadBuffers));
+    fNextReadBuffer = 0;
+
+    if (gPrintStartupSpew) {
+        GrPrintf("Pixel Buffer: %s\n",
+                 (fPixelBufferSupport ? "YES" : "NO"));
+    }
+
+    // the default interfaces only fill in the query procs when the GL can
+    // time with them
+    const GrGLInterface* gl = GrGLGetGLInterface();
+    fTimerQuerySupport = GR_GL_SUPPORT_DESKTOP &&
+                         NULL != gl->fGenQueries &&
+                         NULL != gl->fDeleteQueries &&
+                         NULL != gl->fBeginQuery &&
+                         NULL != gl->fEndQuery &&
+                         NULL != gl->fGetQueryObjectiv &&
+                         NULL != gl->fGetQueryObjectui64v;
+    fTimerQueryActive = false;
+
+    if (gPrintStartupSpew) {
+        GrPrintf("Timer Query: %s\n",
+                 (fTimerQuerySupport ? "YES" : "NO"));
+    }
+
     if (GR_GL_SUPPORT_DESKTOP) {
         if (major >= 2 || has_gl_extension("GL_ARB_texture_non_power_of_two")) {
             fNPOTTextureTileSupport = true;
@@ -540,6 +589,37 @@ GrGpuGL::GrGpuGL(GrPlatform3DContext platformContext) {
 }
 
 GrGpuGL::~GrGpuGL() {
+    this->enableTimerQueries(false);
+    for (int i = 0; i < fTimerQueries.count(); ++i) {
+        GR_GL(DeleteQueries(1, &fTimerQueries[i].fQueryID));
+    }
+    if (fFreeTimerQueryIDs.count()) {
+        GR_GL(DeleteQueries(fFreeTimerQueryIDs.count(),
+                            fFreeTimerQueryIDs.begin()));
+    }
+    if (fUnpackBufferID) {
+        GR_GL(DeleteBuffers(1, &fUnpackBufferID));
+    }
+    this->detachPixelReads();
+    for (int i = 0; i < kReadBufferCount; ++i) {
+        if (NULL != fReadBuffers[i].fFence) {
+            GR_GL(DeleteSync(fReadBuffers[i].fFence));
+        }
+        if (fReadBuffers[i].fBufferID) {
+            GR_GL(DeleteBuffers(1, &fReadBuffers[i].fBufferID));
+        }
+    }
+}
+
+void GrGpuGL::abandonResources() {
+    INHERITED::abandonResources();
+    fUnpackBufferID = 0;
+    this->detachPixelReads();
+    memset(fReadBuffers, 0, sizeof(fReadBuffers));
+    // the queries are gone with the context, so their results are too
+    fTimerQueries.reset();
+    fFreeTimerQueryIDs.reset();
+    fTimerQueryActive = false;
 }
 
 void GrGpuGL::resetContext() {
@@ -601,6 +681,8 @@ void GrGpuGL::resetContext() {
     fHWDrawState.fStencilSettings.invalidate();
     fHWStencilClip = false;
     fClipState.fClipIsDirty = true;
+    // anything may have been drawn into the stencil since
+    ++fClipState.fStencilGeneration;
 
     fHWGeometryState.fIndexBuffer = NULL;
     fHWGeometryState.fVertexBuffer = NULL;
@@ -749,12 +831,50 @@ static size_t as_size_t(int x) {
 }
 #endif
 
+// Smaller uploads aren't worth the extra copy.
+static const size_t MIN_UNPACK_BUFFER_UPLOAD_SIZE = 64 * 1024;
+
+bool GrGpuGL::bindUnpackBuffer(const void** pixels, size_t size) {
+    if (!fPixelBufferSupport || NULL == *pixels ||
+        size < MIN_UNPACK_BUFFER_UPLOAD_SIZE) {
+        return false;
+    }
+    if (!fUnpackBufferID) {
+        GR_GL(GenBuffers(1, &fUnpackBufferID));
+        if (!fUnpackBufferID) {
+            return false;
+        }
+    }
+    GR_GL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, fUnpackBufferID));
+    // Respecifying the store detaches the one an earlier upload may still
+    // be transferring from, so we never wait for it.
+    GR_GL(BufferData(GR_GL_PIXEL_UNPACK_BUFFER, size, NULL,
+                     GR_GL_STREAM_DRAW));
+    void* dst = NULL;
+    if (fBufferLockSupport) {
+        dst = GR_GL(MapBuffer(GR_GL_PIXEL_UNPACK_BUFFER, GR_GL_WRITE_ONLY));
+    }
+    if (NULL != dst) {
+        memcpy(dst, *pixels, size);
+        GR_GL(UnmapBuffer(GR_GL_PIXEL_UNPACK_BUFFER));
+    } else {
+        GR_GL(BufferSubData(GR_GL_PIXEL_UNPACK_BUFFER, 0, size, *pixels));
+    }
+    // the pixels start at the beginning of the buffer
+    *pixels = NULL;
+    return true;
+}
+
+void GrGpuGL::unbindUnpackBuffer() {
+    GR_GL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
 GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
                                     const void* srcData,
                                     size_t rowBytes) {
 
 #if GR_COLLECT_STATS
-    ++fStats.fTextureCreateCnt;
+    ++this->passStats().fTextureCreateCnt;
 #endif
 
     this->setSpareTextureUnit();
@@ -784,6 +904,16 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
         return return_null_texture();
     }
 
+    // compressed data can't be padded out to pow2 sizes, rendered to, or
+    // uploaded later (ES has no CompressedTexSubImage2D for it)
+    bool compressed = GrPixelConfigIsCompressed(desc.fFormat);
+    if (compressed && (renderTarget || NULL == srcData ||
+                       (desc.fFlags & kDynamicUpdate_GrTextureFlagBit) ||
+                       (!this->npotTextureSupport() &&
+                        (!GrIsPow2(desc.fWidth) || !GrIsPow2(desc.fHeight))))) {
+        return return_null_texture();
+    }
+
     GrAssert(as_size_t(desc.fAALevel) < GR_ARRAY_COUNT(fAASamples));
     GrGLint samples = fAASamples[desc.fAALevel];
 
@@ -792,7 +922,16 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
         return return_null_texture();
     }
 
-    glDesc.fUploadByteCount = GrBytesPerPixel(desc.fFormat);
+    // compressed blocks are byte aligned and ignore the row length
+    glDesc.fUploadByteCount = compressed ? 1 : GrBytesPerPixel(desc.fFormat);
+
+#if GR_COLLECT_STATS
+    if (NULL != srcData) {
+        this->passStats().fUploadByteCnt += compressed ?
+                GrCompressedDataSize(desc.fFormat, desc.fWidth, desc.fHeight) :
+                desc.fWidth * desc.fHeight * glDesc.fUploadByteCount;
+    }
+#endif
 
     // in case we need a temporary, trimmed copy of the src pixels
     GrAutoSMalloc<128 * 128> trimStorage;
@@ -802,7 +941,9 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
      *  to trim those off here, since GL doesn't let us pass the rowBytes as
      *  a parameter to glTexImage2D
      */
-    if (GR_GL_SUPPORT_DESKTOP) {
+    if (compressed) {
+        // the blocks are tightly packed, whatever rowBytes is
+    } else if (GR_GL_SUPPORT_DESKTOP) {
         if (srcData) {
             GR_GL(PixelStorei(GR_GL_UNPACK_ROW_LENGTH,
                               rowBytes / glDesc.fUploadByteCount));
@@ -879,15 +1020,39 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
                                    glDesc.fAllocWidth, glDesc.fAllocHeight,
                                    0, imageSize, srcData));
         GrGLRestoreResetRowLength();
+    } else if (compressed) {
+        GrAssert(desc.fWidth == glDesc.fAllocWidth);
+        GrAssert(desc.fHeight == glDesc.fAllocHeight);
+        GrGLsizei imageSize = GrCompressedDataSize(desc.fFormat,
+                                                   desc.fWidth, desc.fHeight);
+        GR_GL(CompressedTexImage2D(GR_GL_TEXTURE_2D, 0, glDesc.fUploadFormat,
+                                   glDesc.fAllocWidth, glDesc.fAllocHeight,
+                                   0, imageSize, srcData));
     } else {
+        // the bytes GL reads, given the row length set above
+        size_t uploadSize = 0;
+        if (NULL != srcData && desc.fHeight > 0) {
+            size_t trimRowBytes = desc.fWidth * glDesc.fUploadByteCount;
+            size_t srcRowBytes = (GR_GL_SUPPORT_DESKTOP && rowBytes) ?
+                                 rowBytes : trimRowBytes;
+            uploadSize = (desc.fHeight - 1) * srcRowBytes + trimRowBytes;
+        }
+        const void* uploadData = srcData;
+
         if (NULL != srcData && (glDesc.fAllocWidth != desc.fWidth ||
                                 glDesc.fAllocHeight != desc.fHeight)) {
             GR_GL(TexImage2D(GR_GL_TEXTURE_2D, 0, internalFormat,
                              glDesc.fAllocWidth, glDesc.fAllocHeight,
                              0, glDesc.fUploadFormat, glDesc.fUploadType, NULL));
+            bool boundUnpackBuffer = this->bindUnpackBuffer(&uploadData,
+                                                            uploadSize);
             GR_GL(TexSubImage2D(GR_GL_TEXTURE_2D, 0, 0, 0, desc.fWidth,
                                 desc.fHeight, glDesc.fUploadFormat,
-                                glDesc.fUploadType, srcData));
+                                glDesc.fUploadType, uploadData));
+            // the edges below are uploaded from client memory
+            if (boundUnpackBuffer) {
+                this->unbindUnpackBuffer();
+            }
             GrGLRestoreResetRowLength();
 
             int extraW = glDesc.fAllocWidth  - desc.fWidth;
@@ -940,9 +1105,14 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
             }
 
         } else {
+            bool boundUnpackBuffer = this->bindUnpackBuffer(&uploadData,
+                                                            uploadSize);
             GR_GL(TexImage2D(GR_GL_TEXTURE_2D, 0, internalFormat, glDesc.fAllocWidth,
                              glDesc.fAllocHeight, 0, glDesc.fUploadFormat,
-                             glDesc.fUploadType, srcData));
+                             glDesc.fUploadType, uploadData));
+            if (boundUnpackBuffer) {
+                this->unbindUnpackBuffer();
+            }
             GrGLRestoreResetRowLength();
         }
     }
@@ -959,7 +1129,7 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
 
     if (renderTarget) {
 #if GR_COLLECT_STATS
-        ++fStats.fRenderTargetCreateCnt;
+        ++this->passStats().fRenderTargetCreateCnt;
 #endif
         bool failed = true;
         GrGLenum status;
@@ -1059,7 +1229,7 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
             GR_GL(BindFramebuffer(GR_GL_FRAMEBUFFER, rtIDs.fTexFBOID));
 
 #if GR_COLLECT_STATS
-            ++fStats.fRenderTargetChngCnt;
+            ++this->passStats().fRenderTargetChngCnt;
 #endif
             if (samples > 1 && fMSFBOType == kIMG_MSFBO) {
                 GR_GL(FramebufferTexture2DMultisample(GR_GL_FRAMEBUFFER,
@@ -1079,7 +1249,7 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
                 }
                 GR_GL(BindFramebuffer(GR_GL_FRAMEBUFFER, rtIDs.fRTFBOID));
             #if GR_COLLECT_STATS
-                ++fStats.fRenderTargetChngCnt;
+                ++this->passStats().fRenderTargetChngCnt;
             #endif
                 GR_GL(FramebufferRenderbuffer(GR_GL_FRAMEBUFFER,
                                               GR_GL_COLOR_ATTACHMENT0,
@@ -1190,6 +1360,73 @@ GrIndexBuffer* GrGpuGL::onCreateIndexBuffer(uint32_t size, bool dynamic) {
     return NULL;
 }
 
+// past this many uncollected queries, their results are collected on the
+// next pass change, so that they don't pile up if nobody asks for them
+#define MAX_TIMER_QUERIES   256
+
+void GrGpuGL::onSetTimedPass(GrGpuPass pass) {
+    if (fTimerQueryActive) {
+        GR_GL(EndQuery(GR_GL_TIME_ELAPSED));
+        fTimerQueryActive = false;
+    }
+    if (kGrGpuPassCount == pass) {
+        return;
+    }
+    if (fTimerQueries.count() >= MAX_TIMER_QUERIES) {
+        this->onCollectTimerQueries(false);
+        if (fTimerQueries.count() >= MAX_TIMER_QUERIES) {
+            // the GPU is far behind, so waiting for it costs little
+            this->onCollectTimerQueries(true);
+        }
+    }
+
+    TimerQuery* query = fTimerQueries.append();
+    if (fFreeTimerQueryIDs.count()) {
+        query->fQueryID = *fFreeTimerQueryIDs.back();
+        fFreeTimerQueryIDs.remove(fFreeTimerQueryIDs.count() - 1);
+    } else {
+        GR_GL(GenQueries(1, &query->fQueryID));
+    }
+    query->fPass = pass;
+    query->fStatsGeneration = fStatsGeneration;
+    GR_GL(BeginQuery(GR_GL_TIME_ELAPSED, query->fQueryID));
+    fTimerQueryActive = true;
+}
+
+void GrGpuGL::onCollectTimerQueries(bool wait) {
+    if (wait && fTimerQueryActive) {
+        // end the current pass's query so that its time so far is counted
+        this->onSetTimedPass(this->getPass());
+    }
+    // the active query has no result yet
+    int ended = fTimerQueries.count() - (fTimerQueryActive ? 1 : 0);
+    int collected = 0;
+    while (collected < ended) {
+        const TimerQuery& query = fTimerQueries[collected];
+        if (!wait) {
+            GrGLint available = 0;
+            GR_GL(GetQueryObjectiv(query.fQueryID,
+                                   GR_GL_QUERY_RESULT_AVAILABLE,
+                                   &available));
+            if (!available) {
+                // the later ones can't be available either
+                break;
+            }
+        }
+        GrGLuint64 elapsed = 0;
+        GR_GL(GetQueryObjectui64v(query.fQueryID, GR_GL_QUERY_RESULT,
+                                  &elapsed));
+        if (query.fStatsGeneration == fStatsGeneration) {
+            fPassStats[query.fPass].fGpuTimeNs += elapsed;
+        }
+        *fFreeTimerQueryIDs.append() = query.fQueryID;
+        ++collected;
+    }
+    while (collected-- > 0) {
+        fTimerQueries.remove(0);
+    }
+}
+
 void GrGpuGL::flushScissor(const GrIRect* rect) {
     GrAssert(NULL != fCurrDrawState.fRenderTarget);
     const GrGLIRect& vp =
@@ -1208,6 +1445,11 @@ void GrGpuGL::flushScissor(const GrIRect* rect) {
         if (fHWBounds.fScissorRect != scissor) {
             scissor.pushToGLScissor();
             fHWBounds.fScissorRect = scissor;
+        #if GR_COLLECT_STATS
+            ++this->passStats().fStateChngCnt;
+        #endif
+        } else {
+            this->countSkippedChange();
         }
         if (!fHWBounds.fScissorEnabled) {
             GR_GL(Enable(GR_GL_SCISSOR_TEST));
@@ -1291,33 +1533,43 @@ void GrGpuGL::onForceRenderTargetFlush() {
     this->flushRenderTarget(&GrIRect::EmptyIRect());
 }
 
-bool GrGpuGL::onReadPixels(GrRenderTarget* target,
-                           int left, int top, int width, int height,
-                           GrPixelConfig config, void* buffer) {
-    GrGLenum internalFormat;  // we don't use this for glReadPixels
-    GrGLenum format;
-    GrGLenum type;
-    if (!this->canBeTexture(config, &internalFormat, &format, &type)) {
-        return false;
-    }    
-    GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
-    GrAutoTPtrValueRestore<GrRenderTarget*> autoTargetRestore;
-    switch (tgt->getResolveType()) {
+bool GrGpuGL::bindReadFramebuffer(
+                        GrGLRenderTarget* target,
+                        GrAutoTPtrValueRestore<GrRenderTarget*>* restore) {
+    switch (target->getResolveType()) {
         case GrGLRenderTarget::kCantResolve_ResolveType:
             return false;
         case GrGLRenderTarget::kAutoResolves_ResolveType:
-            autoTargetRestore.save(&fCurrDrawState.fRenderTarget);
+            restore->save(&fCurrDrawState.fRenderTarget);
             fCurrDrawState.fRenderTarget = target;
             this->flushRenderTarget(&GrIRect::EmptyIRect());
             break;
         case GrGLRenderTarget::kCanResolve_ResolveType:
-            this->resolveRenderTarget(tgt);
+            this->resolveRenderTarget(target);
             // we don't track the state of the READ FBO ID.
-            GR_GL(BindFramebuffer(GR_GL_READ_FRAMEBUFFER, tgt->textureFBOID()));
+            GR_GL(BindFramebuffer(GR_GL_READ_FRAMEBUFFER,
+                                  target->textureFBOID()));
             break;
         default:
             GrCrash("Unknown resolve type");
     }
+    return true;
+}
+
+bool GrGpuGL::onReadPixels(GrRenderTarget* target,
+                           int left, int top, int width, int height,
+                           GrPixelConfig config, void* buffer) {
+    GrGLenum internalFormat;  // we don't use this for glReadPixels
+    GrGLenum format;
+    GrGLenum type;
+    if (!this->canBeTexture(config, &internalFormat, &format, &type)) {
+        return false;
+    }    
+    GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
+    GrAutoTPtrValueRestore<GrRenderTarget*> autoTargetRestore;
+    if (!this->bindReadFramebuffer(tgt, &autoTargetRestore)) {
+        return false;
+    }
 
     const GrGLIRect& glvp = tgt->getViewport();
 
@@ -1349,6 +1601,202 @@ bool GrGpuGL::onReadPixels(GrRenderTarget* target,
     return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// copies rows that are stored bottom-to-top so that they are top-to-bottom
+static void copy_flipped_rows(const void* src, size_t srcRowBytes,
+                              int height, void* dst, size_t dstRowBytes) {
+    const char* srcRow = reinterpret_cast<const char*>(src) +
+                         (height - 1) * srcRowBytes;
+    char* dstRow = reinterpret_cast<char*>(dst);
+    for (int y = 0; y < height; ++y) {
+        memcpy(dstRow, srcRow, srcRowBytes);
+        srcRow -= srcRowBytes;
+        dstRow += dstRowBytes;
+    }
+}
+
+class GrGpuGL::PixelRead : public GrPixelRead {
+public:
+    PixelRead(GrGpuGL* gpu, int bufferIndex,
+              int width, int height, GrPixelConfig config)
+        : INHERITED(width, height, config)
+        , fGpu(gpu)
+        , fBufferIndex(bufferIndex)
+        , fInMemory(false) {
+    }
+
+    virtual ~PixelRead() {
+        if (NULL != fGpu && fBufferIndex >= 0) {
+            fGpu->releaseReadBuffer(fBufferIndex);
+        }
+    }
+
+    virtual bool isReady() {
+        if (fInMemory || NULL == fGpu || fBufferIndex < 0) {
+            return true;
+        }
+        return fGpu->isReadBufferReady(fBufferIndex);
+    }
+
+    virtual bool finish(void* buffer, size_t rowBytes) {
+        size_t stride = this->width() * GrBytesPerPixel(this->config());
+        if (0 == rowBytes) {
+            rowBytes = stride;
+        }
+        if (fInMemory) {
+            copy_flipped_rows(fPixels.get(), stride, this->height(),
+                              buffer, rowBytes);
+            fInMemory = false;
+            return true;
+        }
+        if (NULL == fGpu || fBufferIndex < 0) {
+            return false;
+        }
+        const void* pixels = fGpu->mapReadBuffer(fBufferIndex);
+        if (NULL != pixels) {
+            copy_flipped_rows(pixels, stride, this->height(),
+                              buffer, rowBytes);
+            fGpu->unmapReadBuffer();
+        }
+        fGpu->releaseReadBuffer(fBufferIndex);
+        fBufferIndex = -1;
+        return NULL != pixels;
+    }
+
+    // called when the ring wants the buffer back before the pixels have been
+    // picked up
+    void moveToMemory() {
+        GrAssert(NULL != fGpu && fBufferIndex >= 0);
+        const void* pixels = fGpu->mapReadBuffer(fBufferIndex);
+        if (NULL != pixels) {
+            size_t size = this->height() * this->width() *
+                          GrBytesPerPixel(this->config());
+            fPixels.realloc(size);
+            memcpy(fPixels.get(), pixels, size);
+            fGpu->unmapReadBuffer();
+            fInMemory = true;
+        }
+        fGpu->releaseReadBuffer(fBufferIndex);
+        fBufferIndex = -1;
+    }
+
+    // called when the GrGpuGL or its context goes away
+    void detach() {
+        fGpu = NULL;
+        fBufferIndex = -1;
+    }
+
+private:
+    GrGpuGL*        fGpu;
+    int             fBufferIndex;   // -1 once it has given up its buffer
+    GrAutoMalloc    fPixels;        // bottom-to-top, like the buffer
+    bool            fInMemory;
+
+    typedef GrPixelRead INHERITED;
+};
+
+GrPixelRead* GrGpuGL::onBeginReadPixels(GrRenderTarget* target,
+                                        int left, int top,
+                                        int width, int height,
+                                        GrPixelConfig config) {
+    if (!fPixelBufferSupport || !fBufferLockSupport) {
+        return NULL;
+    }
+    GrGLenum internalFormat;  // we don't use this for glReadPixels
+    GrGLenum format;
+    GrGLenum type;
+    if (!this->canBeTexture(config, &internalFormat, &format, &type)) {
+        return NULL;
+    }
+    GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
+    GrAutoTPtrValueRestore<GrRenderTarget*> autoTargetRestore;
+    if (!this->bindReadFramebuffer(tgt, &autoTargetRestore)) {
+        return NULL;
+    }
+
+    int index = fNextReadBuffer;
+    ReadBuffer& readBuffer = fReadBuffers[index];
+    if (NULL != readBuffer.fRead) {
+        // this is the oldest read, so it has most likely completed by now
+        readBuffer.fRead->moveToMemory();
+    }
+    if (!readBuffer.fBufferID) {
+        GR_GL(GenBuffers(1, &readBuffer.fBufferID));
+        if (!readBuffer.fBufferID) {
+            return NULL;
+        }
+    }
+
+    // the read rect is viewport-relative
+    GrGLIRect readRect;
+    readRect.setRelativeTo(tgt->getViewport(), left, top, width, height);
+
+    size_t size = width * height * GrBytesPerPixel(config);
+    GR_GL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, readBuffer.fBufferID));
+    GR_GL(BufferData(GR_GL_PIXEL_PACK_BUFFER, size, NULL, GR_GL_STREAM_READ));
+    // the pixels go to the beginning of the buffer
+    GR_GL(ReadPixels(readRect.fLeft, readRect.fBottom,
+                     readRect.fWidth, readRect.fHeight,
+                     format, type, NULL));
+    GR_GL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+    if (NULL != GrGLGetGLInterface()->fFenceSync) {
+        readBuffer.fFence = GR_GL(FenceSync(GR_GL_SYNC_GPU_COMMANDS_COMPLETE,
+                                            0));
+    }
+
+    readBuffer.fRead = new PixelRead(this, index, width, height, config);
+    fNextReadBuffer = (index + 1) % kReadBufferCount;
+    return readBuffer.fRead;
+}
+
+const void* GrGpuGL::mapReadBuffer(int index) {
+    GrAssert(NULL != fReadBuffers[index].fRead);
+    GR_GL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, fReadBuffers[index].fBufferID));
+    void* pixels = GR_GL(MapBuffer(GR_GL_PIXEL_PACK_BUFFER, GR_GL_READ_ONLY));
+    if (NULL == pixels) {
+        GR_GL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+    }
+    return pixels;
+}
+
+void GrGpuGL::unmapReadBuffer() {
+    GR_GL(UnmapBuffer(GR_GL_PIXEL_PACK_BUFFER));
+    GR_GL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+}
+
+bool GrGpuGL::isReadBufferReady(int index) {
+    GrGLsync fence = fReadBuffers[index].fFence;
+    if (NULL == fence || NULL == GrGLGetGLInterface()->fClientWaitSync) {
+        return true;
+    }
+    // the flush makes sure the fence is eventually signaled even if the
+    // caller only ever polls
+    GrGLenum status = GR_GL(ClientWaitSync(fence,
+                                           GR_GL_SYNC_FLUSH_COMMANDS_BIT, 0));
+    return GR_GL_TIMEOUT_EXPIRED != status;
+}
+
+void GrGpuGL::releaseReadBuffer(int index) {
+    ReadBuffer& readBuffer = fReadBuffers[index];
+    if (NULL != readBuffer.fFence) {
+        GR_GL(DeleteSync(readBuffer.fFence));
+        readBuffer.fFence = NULL;
+    }
+    readBuffer.fRead = NULL;
+}
+
+void GrGpuGL::detachPixelReads() {
+    for (int i = 0; i < kReadBufferCount; ++i) {
+        if (NULL != fReadBuffers[i].fRead) {
+            fReadBuffers[i].fRead->detach();
+            fReadBuffers[i].fRead = NULL;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void GrGpuGL::flushRenderTarget(const GrIRect* bound) {
 
     GrAssert(NULL != fCurrDrawState.fRenderTarget);
@@ -1357,7 +1805,7 @@ void GrGpuGL::flushRenderTarget(const GrIRect* bound) {
     if (fHWDrawState.fRenderTarget != fCurrDrawState.fRenderTarget) {
         GR_GL(BindFramebuffer(GR_GL_FRAMEBUFFER, rt->renderFBOID()));
     #if GR_COLLECT_STATS
-        ++fStats.fRenderTargetChngCnt;
+        ++this->passStats().fRenderTargetChngCnt;
     #endif
     #if GR_DEBUG
         GrGLenum status = GR_GL(CheckFramebufferStatus(GR_GL_FRAMEBUFFER));
@@ -1479,7 +1927,7 @@ void GrGpuGL::resolveRenderTarget(GrGLRenderTarget* rt) {
         GR_GL(BindFramebuffer(GR_GL_DRAW_FRAMEBUFFER,
                                         rt->textureFBOID()));
     #if GR_COLLECT_STATS
-        ++fStats.fRenderTargetChngCnt;
+        ++this->passStats().fRenderTargetChngCnt;
     #endif
         // make sure we go through flushRenderTarget() since we've modified
         // the bound DRAW FBO ID.
@@ -1567,6 +2015,9 @@ void GrGpuGL::flushStencil() {
                           (fCurrDrawState.fFlagBits & kModifyStencilClip_StateBit));
 
     if (stencilChange) {
+    #if GR_COLLECT_STATS
+        ++this->passStats().fStateChngCnt;
+    #endif
 
         // we can't simultaneously perform stencil-clipping and modify the stencil clip
         GrAssert(!stencilClip || !(fCurrDrawState.fFlagBits & kModifyStencilClip_StateBit));
@@ -1671,6 +2122,8 @@ void GrGpuGL::flushStencil() {
         }
         fHWDrawState.fStencilSettings = fCurrDrawState.fStencilSettings;
         fHWStencilClip = stencilClip;
+    } else {
+        this->countSkippedChange();
     }
 }
 
@@ -1739,20 +2192,30 @@ void GrGpuGL::flushBlend(GrPrimitiveType type,
     } else {
         bool blendOff = canDisableBlend();
         if (fHWBlendDisabled != blendOff) {
+        #if GR_COLLECT_STATS
+            ++this->passStats().fStateChngCnt;
+        #endif
             if (blendOff) {
                 GR_GL(Disable(GR_GL_BLEND));
             } else {
                 GR_GL(Enable(GR_GL_BLEND));
             }
             fHWBlendDisabled = blendOff;
+        } else {
+            this->countSkippedChange();
         }
         if (!blendOff) {
             if (fHWDrawState.fSrcBlend != srcCoeff ||
                 fHWDrawState.fDstBlend != dstCoeff) {
+            #if GR_COLLECT_STATS
+                ++this->passStats().fStateChngCnt;
+            #endif
                 GR_GL(BlendFunc(gXfermodeCoeff2Blend[srcCoeff],
                                 gXfermodeCoeff2Blend[dstCoeff]));
                 fHWDrawState.fSrcBlend = srcCoeff;
                 fHWDrawState.fDstBlend = dstCoeff;
+            } else {
+                this->countSkippedChange();
             }
             if ((BlendCoeffReferencesConstant(srcCoeff) ||
                  BlendCoeffReferencesConstant(dstCoeff)) &&
@@ -1798,13 +2261,15 @@ bool GrGpuGL::flushGLStateCommon(GrPrimitiveType type) {
                 setTextureUnit(s);
                 GR_GL(BindTexture(GR_GL_TEXTURE_2D, nextTexture->textureID()));
             #if GR_COLLECT_STATS
-                ++fStats.fTextureChngCnt;
+                ++this->passStats().fTextureChngCnt;
             #endif
                 //GrPrintf("---- bindtexture %d\n", nextTexture->textureID());
                 fHWDrawState.fTextures[s] = nextTexture;
                 // The texture matrix has to compensate for texture width/height
                 // and NPOT-embedded-in-POT
                 fDirtyFlags.fTextureChangedMask |= (1 << s);
+            } else {
+                this->countSkippedChange();
             }
 
             const GrSamplerState& sampler = fCurrDrawState.fSamplerStates[s];
@@ -2022,6 +2487,17 @@ bool GrGpuGL::canBeTexture(GrPixelConfig config,
             *internalFormat = GR_GL_ALPHA;
             *type = GR_GL_UNSIGNED_BYTE;
             break;
+        case kETC1_GrPixelConfig:
+        case kDXT1_GrPixelConfig:
+            if (this->supportsCompressedConfig(config)) {
+                *format = kETC1_GrPixelConfig == config ?
+                          GR_GL_ETC1_RGB8 : GR_GL_COMPRESSED_RGB_S3TC_DXT1;
+                *internalFormat = *format;
+                *type = GR_GL_UNSIGNED_BYTE;   // unused
+            } else {
+                return false;
+            }
+            break;
         default:
             return false;
     }
@@ -2037,7 +2513,7 @@ void GrGpuGL::setTextureUnit(int unit) {
 }
 
 void GrGpuGL::setSpareTextureUnit() {
-    if (fActiveTextureUnitIdx != (GR_GL_TEXTURE0 + SPARE_TEX_UNIT)) {
+    if (fActiveTextureUnitIdx != SPARE_TEX_UNIT) {
         GR_GL(ActiveTexture(GR_GL_TEXTURE0 + SPARE_TEX_UNIT));
         fActiveTextureUnitIdx = SPARE_TEX_UNIT;
     }
@@ -25,11 +25,14 @@
 
 #include "GrGLVertexBuffer.h"
 #include "GrGLIndexBuffer.h"
+#include "GrTDArray.h"
 
 class GrGpuGL : public GrGpu {
 public:
     virtual ~GrGpuGL();
 
+    virtual void abandonResources();
+
 protected:
     GrGpuGL(GrPlatform3DContext platformContext);
 
@@ -94,6 +97,11 @@ protected:
                               int left, int top, int width, int height,
                               GrPixelConfig, void* buffer);
 
+    virtual GrPixelRead* onBeginReadPixels(GrRenderTarget* target,
+                                           int left, int top,
+                                           int width, int height,
+                                           GrPixelConfig config);
+
     virtual void onGpuDrawIndexed(GrPrimitiveType type,
                                   uint32_t startVertex,
                                   uint32_t startIndex,
@@ -102,6 +110,9 @@ protected:
     virtual void onGpuDrawNonIndexed(GrPrimitiveType type,
                                      uint32_t vertexCount,
                                      uint32_t numVertices);
+    virtual void onSetTimedPass(GrGpuPass pass);
+    virtual void onCollectTimerQueries(bool wait);
+
     virtual void flushScissor(const GrIRect* rect);
     void clearStencil(uint32_t value, uint32_t mask);
     virtual void clearStencilClip(const GrIRect& rect);
@@ -156,6 +167,36 @@ private:
 
     void setSpareTextureUnit();
 
+    // Large uploads are copied into a pixel unpack buffer, which the driver
+    // transfers from after TexImage2D/TexSubImage2D have returned, rather
+    // than reading client memory before they return. If this returns true
+    // the buffer is left bound and *pixels replaced by the offset to pass to
+    // GL in place of the pixels. The caller must then call
+    // unbindUnpackBuffer() after its upload call.
+    bool bindUnpackBuffer(const void** pixels, size_t size);
+    void unbindUnpackBuffer();
+
+    // Binds the framebuffer that target's pixels are read from, resolving
+    // it first if needed. Returns false if they can't be read.
+    bool bindReadFramebuffer(GrGLRenderTarget* target,
+                             GrAutoTPtrValueRestore<GrRenderTarget*>* restore);
+
+    // Asynchronous reads go through a ring of pixel pack buffers. A read
+    // keeps its buffer until its pixels are picked up, unless the ring comes
+    // back around to the buffer first; then the pixels are moved into the
+    // read's own memory so that the buffer can be reused.
+    class PixelRead;
+    friend class PixelRead;
+
+    // Maps a read buffer, waiting for the read into it to complete. Returns
+    // NULL if it can't be mapped. Call unmapReadBuffer() when done with it.
+    const void* mapReadBuffer(int index);
+    void unmapReadBuffer();
+    bool isReadBufferReady(int index);
+    void releaseReadBuffer(int index);
+    // tells the outstanding reads that their buffers are gone
+    void detachPixelReads();
+
     bool useSmoothLines();
 
     // bound is region that may be modified and therefore has to be resolved.
@@ -192,6 +233,33 @@ private:
     // Do we have stencil wrap ops.
     bool fHasStencilWrap;
 
+    // Can pixels be transferred through pixel buffer objects.
+    bool fPixelBufferSupport;
+    GrGLuint fUnpackBufferID;
+
+    enum {
+        kReadBufferCount = 3
+    };
+    struct ReadBuffer {
+        GrGLuint    fBufferID;
+        GrGLsync    fFence;     // NULL if the GL has no sync objects
+        PixelRead*  fRead;      // NULL if the buffer is free
+    } fReadBuffers[kReadBufferCount];
+    int fNextReadBuffer;
+
+    // Each pass is timed by a TIME_ELAPSED query (which can't nest) from
+    // when it becomes current until the pass changes. The queries are kept
+    // in the order they were issued, which is the order their results come
+    // back in, until they are collected; then their ids are reused.
+    struct TimerQuery {
+        GrGLuint    fQueryID;
+        GrGpuPass   fPass;
+        uint32_t    fStatsGeneration;
+    };
+    GrTDArray<TimerQuery>   fTimerQueries;
+    GrTDArray<GrGLuint>     fFreeTimerQueryIDs;
+    bool                    fTimerQueryActive;  // for the last in the list
+
     // The maximum number of fragment uniform vectors (GLES has min. 16).
     int fMaxFragmentUniformVectors;
 
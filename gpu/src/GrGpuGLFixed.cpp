@@ -60,6 +60,8 @@ GrGpuGLFixed::GrGpuGLFixed(GrPlatform3DContext platformContext)
   : INHERITED(platformContext)
 {
     f4X4DownsampleFilterSupport = false;
+    fConvolutionFilterSupport = false;
+    fGradientSampleModeSupport = false;
     fDualSourceBlendingSupport = false;
 }
 
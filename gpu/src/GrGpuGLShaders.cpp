@@ -17,6 +17,7 @@
 
 #include "GrBinHashKey.h"
 #include "GrGLProgram.h"
+#include "GrGLProgramBinaryStore.h"
 #include "GrGpuGLShaders.h"
 #include "GrGpuVertex.h"
 #include "GrMemory.h"
@@ -60,24 +61,31 @@ private:
     GrTHashTable<Entry, ProgramHashKey, 8> fHashCache;
 
     // We may have kMaxEntries+1 shaders in the GL context because
-    // we create a new shader before evicting from the cache.
+    // we create a new shader before evicting from the cache. Lookups go
+    // through fHashCache, so only a miss (which compiles a program anyway)
+    // scans the entries for the least recently used one.
     enum {
-        kMaxEntries = 32
+        kMaxEntries = 128
     };
-    Entry        fEntries[kMaxEntries];
-    int          fCount;
-    unsigned int fCurrLRUStamp;
+    Entry                   fEntries[kMaxEntries];
+    int                     fCount;
+    unsigned int            fCurrLRUStamp;
+    GrGLProgramBinaryStore* fBinaryStore;
 
 public:
-    ProgramCache() 
+    // binaryStore may be NULL
+    ProgramCache(GrGLProgramBinaryStore* binaryStore)
         : fCount(0)
-        , fCurrLRUStamp(0) {
+        , fCurrLRUStamp(0)
+        , fBinaryStore(binaryStore) {
+        GrSafeRef(fBinaryStore);
     }
 
     ~ProgramCache() {
         for (int i = 0; i < fCount; ++i) {
             GrGpuGLShaders::DeleteProgram(&fEntries[i].fProgramData);
         }
+        GrSafeUnref(fBinaryStore);
     }
 
     void abandon() {
@@ -98,7 +106,7 @@ public:
         }
         Entry* entry = fHashCache.find(newEntry.fKey);
         if (NULL == entry) {
-            if (!desc.genProgram(&newEntry.fProgramData)) {
+            if (!desc.genProgram(&newEntry.fProgramData, fBinaryStore)) {
                 return NULL;
             }
             if (fCount < kMaxEntries) {
@@ -163,6 +171,7 @@ void GrGpuGLShaders::ProgramUnitTest() {
     static const GrGLProgram::ProgramDesc::StageDesc::FetchMode FETCH_MODES[] = {
         GrGLProgram::ProgramDesc::StageDesc::kSingle_FetchMode,
         GrGLProgram::ProgramDesc::StageDesc::k2x2_FetchMode,
+        GrGLProgram::ProgramDesc::StageDesc::kConvolution_FetchMode,
     };
     GrGLProgram program;
     GrGLProgram::ProgramDesc& pdesc = program.fProgramDesc;
@@ -234,6 +243,14 @@ void GrGpuGLShaders::ProgramUnitTest() {
             pdesc.fStages[s].fCoordMapping = STAGE_COORD_MAPPINGS[idx];
             idx = (int)(random.nextF() * GR_ARRAY_COUNT(FETCH_MODES));
             pdesc.fStages[s].fFetchMode = FETCH_MODES[idx];
+            if (GrGLProgram::ProgramDesc::StageDesc::kConvolution_FetchMode ==
+                pdesc.fStages[s].fFetchMode) {
+                idx = (int)(random.nextF() *
+                            (GrSamplerState::kMaxKernelWidth / 2 + 1));
+                pdesc.fStages[s].fKernelWidth = 2 * idx + 1;
+            } else {
+                pdesc.fStages[s].fKernelWidth = 0;
+            }
             pdesc.fStages[s].setEnabled(VertexUsesStage(s, pdesc.fVertexLayout));
         }
         GrGLProgram::CachedData cachedData;
@@ -256,6 +273,8 @@ GrGpuGLShaders::GrGpuGLShaders(GrPlatform3DContext platformContext)
     gl_version(&major, &minor);
 
     f4X4DownsampleFilterSupport = true;
+    fConvolutionFilterSupport = true;
+    fGradientSampleModeSupport = true;
     if (GR_GL_SUPPORT_DESKTOP) {
         fDualSourceBlendingSupport =
             major > 3 ||(3 == major && 3 <= minor) ||
@@ -264,8 +283,19 @@ GrGpuGLShaders::GrGpuGLShaders(GrPlatform3DContext platformContext)
         fDualSourceBlendingSupport = false;
     }
 
+    // programs are only kept across runs if they can be read back
+    GrGLProgramBinaryStore* binaryStore = NULL;
+    if (NULL != GrGLGetGLInterface()->fGetProgramBinary &&
+        NULL != GrGLGetGLInterface()->fProgramBinary) {
+        GrGLint numFormats = 0;
+        GR_GL_GetIntegerv(GR_GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        if (numFormats > 0) {
+            binaryStore = GrGLGetProgramBinaryStore();
+        }
+    }
+
     fProgramData = NULL;
-    fProgramCache = new ProgramCache();
+    fProgramCache = new ProgramCache(binaryStore);
 
 #if 0
     ProgramUnitTest();
@@ -384,6 +414,9 @@ void GrGpuGLShaders::flushTextureDomain(int s) {
             values[3] *= SkScalarToFloat(texture->contentScaleY());
 
             GR_GL(Uniform4fv(uni, 1, values));
+            this->countUniformChange();
+        } else {
+            this->countSkippedChange();
         }
     }
 }
@@ -429,6 +462,9 @@ void GrGpuGLShaders::flushTextureMatrix(int s) {
                 GR_GL(UniformMatrix3fv(uni, 1, false, mt));
             }
             recordHWSamplerMatrix(s, getSamplerMatrix(s));
+            this->countUniformChange();
+        } else if (GrGLProgram::kUnusedUniform != uni) {
+            this->countSkippedChange();
         }
     }
 }
@@ -437,10 +473,12 @@ void GrGpuGLShaders::flushRadial2(int s) {
 
     const int &uni = fProgramData->fUniLocations.fStages[s].fRadial2Uni;
     const GrSamplerState& sampler = fCurrDrawState.fSamplerStates[s];
-    if (GrGLProgram::kUnusedUniform != uni &&
-        (fProgramData->fRadial2CenterX1[s] != sampler.getRadial2CenterX1() ||
-         fProgramData->fRadial2Radius0[s]  != sampler.getRadial2Radius0()  ||
-         fProgramData->fRadial2PosRoot[s]  != sampler.isRadial2PosRoot())) {
+    if (GrGLProgram::kUnusedUniform == uni) {
+        return;
+    }
+    if (fProgramData->fRadial2CenterX1[s] != sampler.getRadial2CenterX1() ||
+        fProgramData->fRadial2Radius0[s]  != sampler.getRadial2Radius0()  ||
+        fProgramData->fRadial2PosRoot[s]  != sampler.isRadial2PosRoot()) {
 
         GrScalar centerX1 = sampler.getRadial2CenterX1();
         GrScalar radius0 = sampler.getRadial2Radius0();
@@ -459,6 +497,9 @@ void GrGpuGLShaders::flushRadial2(int s) {
         fProgramData->fRadial2CenterX1[s] = sampler.getRadial2CenterX1();
         fProgramData->fRadial2Radius0[s]  = sampler.getRadial2Radius0();
         fProgramData->fRadial2PosRoot[s]  = sampler.isRadial2PosRoot();
+        this->countUniformChange();
+    } else {
+        this->countSkippedChange();
     }
 }
 
@@ -467,11 +508,57 @@ void GrGpuGLShaders::flushTexelSize(int s) {
     if (GrGLProgram::kUnusedUniform != uni) {
         GrGLTexture* texture = (GrGLTexture*) fCurrDrawState.fTextures[s];
         if (texture->allocWidth() != fProgramData->fTextureWidth[s] ||
-            texture->allocHeight() != fProgramData->fTextureWidth[s]) {
+            texture->allocHeight() != fProgramData->fTextureHeight[s]) {
 
             float texelSize[] = {1.f / texture->allocWidth(),
                                  1.f / texture->allocHeight()};
             GR_GL(Uniform2fv(uni, 1, texelSize));
+            fProgramData->fTextureWidth[s] = texture->allocWidth();
+            fProgramData->fTextureHeight[s] = texture->allocHeight();
+            this->countUniformChange();
+        } else {
+            this->countSkippedChange();
+        }
+    }
+}
+
+void GrGpuGLShaders::flushConvolution(int s) {
+    const GrGLProgram::StageUniLocations& locations =
+                                        fProgramData->fUniLocations.fStages[s];
+    const GrSamplerState& sampler = fCurrDrawState.fSamplerStates[s];
+    if (GrGLProgram::kUnusedUniform != locations.fKernelUni) {
+        int width = sampler.getKernelWidth();
+        if (width != fProgramData->fKernelWidth[s] ||
+            memcmp(sampler.getKernel(), fProgramData->fKernel[s],
+                   width * sizeof(float))) {
+            GR_GL(Uniform1fv(locations.fKernelUni, width, sampler.getKernel()));
+            memcpy(fProgramData->fKernel[s], sampler.getKernel(),
+                   width * sizeof(float));
+            fProgramData->fKernelWidth[s] = width;
+            this->countUniformChange();
+        } else {
+            this->countSkippedChange();
+        }
+    }
+    if (GrGLProgram::kUnusedUniform != locations.fImageIncrementUni) {
+        GrGLTexture* texture = (GrGLTexture*) fCurrDrawState.fTextures[s];
+        // the increment is in texels, the shader's coords are normalized to
+        // the allocated size and flipped for bottom-up textures
+        float imageIncrement[2] = {
+            sampler.getImageIncrement()[0] / texture->allocWidth(),
+            sampler.getImageIncrement()[1] / texture->allocHeight()
+        };
+        if (GrGLTexture::kBottomUp_Orientation == texture->orientation()) {
+            imageIncrement[1] = -imageIncrement[1];
+        }
+        if (memcmp(imageIncrement, fProgramData->fImageIncrement[s],
+                   sizeof(imageIncrement))) {
+            GR_GL(Uniform2fv(locations.fImageIncrementUni, 1, imageIncrement));
+            memcpy(fProgramData->fImageIncrement[s], imageIncrement,
+                   sizeof(imageIncrement));
+            this->countUniformChange();
+        } else {
+            this->countSkippedChange();
         }
     }
 }
@@ -489,7 +576,15 @@ void GrGpuGLShaders::flushEdgeAAData() {
             edges[i].fY = -b;
             edges[i].fZ += b * height;
         }
-        GR_GL(Uniform3fv(uni, count, &edges[0].fX));
+        if (count != fProgramData->fEdgeAANumEdges ||
+            memcmp(edges, fProgramData->fEdgeAAEdges, count * sizeof(Edge))) {
+            GR_GL(Uniform3fv(uni, count, &edges[0].fX));
+            memcpy(fProgramData->fEdgeAAEdges, edges, count * sizeof(Edge));
+            fProgramData->fEdgeAANumEdges = count;
+            this->countUniformChange();
+        } else {
+            this->countSkippedChange();
+        }
     }
 }
 
@@ -516,6 +611,9 @@ void GrGpuGLShaders::flushColor() {
                     float c[] = GR_COLOR_TO_VEC4(fCurrDrawState.fColor);
                     GR_GL(VertexAttrib4fv(GrGLProgram::ColorAttributeIdx(), c));
                     fHWDrawState.fColor = fCurrDrawState.fColor;
+                    this->countUniformChange();
+                } else {
+                    this->countSkippedChange();
                 }
                 break;
             case GrGLProgram::ProgramDesc::kUniform_ColorType:
@@ -526,6 +624,9 @@ void GrGpuGLShaders::flushColor() {
                              fProgramData->fUniLocations.fColorUni);
                     GR_GL(Uniform4fv(fProgramData->fUniLocations.fColorUni, 1, c));
                     fProgramData->fColor = fCurrDrawState.fColor;
+                    this->countUniformChange();
+                } else {
+                    this->countSkippedChange();
                 }
                 break;
             case GrGLProgram::ProgramDesc::kNone_ColorType:
@@ -536,12 +637,16 @@ void GrGpuGLShaders::flushColor() {
         }
     }
     if (fProgramData->fUniLocations.fColorFilterUni
-                != GrGLProgram::kUnusedUniform
-            && fProgramData->fColorFilterColor
+                != GrGLProgram::kUnusedUniform) {
+        if (fProgramData->fColorFilterColor
                 != fCurrDrawState.fColorFilterColor) {
-        float c[] = GR_COLOR_TO_VEC4(fCurrDrawState.fColorFilterColor);
-        GR_GL(Uniform4fv(fProgramData->fUniLocations.fColorFilterUni, 1, c));
-        fProgramData->fColorFilterColor = fCurrDrawState.fColorFilterColor;
+            float c[] = GR_COLOR_TO_VEC4(fCurrDrawState.fColorFilterColor);
+            GR_GL(Uniform4fv(fProgramData->fUniLocations.fColorFilterUni, 1, c));
+            fProgramData->fColorFilterColor = fCurrDrawState.fColorFilterColor;
+            this->countUniformChange();
+        } else {
+            this->countSkippedChange();
+        }
     }
 }
 
@@ -569,6 +674,11 @@ bool GrGpuGLShaders::flushGraphicsState(GrPrimitiveType type) {
     if (fHWProgramID != fProgramData->fProgramID) {
         GR_GL(UseProgram(fProgramData->fProgramID));
         fHWProgramID = fProgramData->fProgramID;
+    #if GR_COLLECT_STATS
+        ++this->passStats().fProgChngCnt;
+    #endif
+    } else {
+        this->countSkippedChange();
     }
     GrBlendCoeff srcCoeff = fCurrDrawState.fSrcBlend;
     GrBlendCoeff dstCoeff = fCurrDrawState.fDstBlend;
@@ -589,6 +699,9 @@ bool GrGpuGLShaders::flushGraphicsState(GrPrimitiveType type) {
     if (*currViewMatrix != fCurrDrawState.fViewMatrix) {
         flushViewMatrix();
         *currViewMatrix = fCurrDrawState.fViewMatrix;
+        this->countUniformChange();
+    } else {
+        this->countSkippedChange();
     }
 
     for (int s = 0; s < kNumStages; ++s) {
@@ -598,6 +711,8 @@ bool GrGpuGLShaders::flushGraphicsState(GrPrimitiveType type) {
 
         this->flushTexelSize(s);
 
+        this->flushConvolution(s);
+
         this->flushTextureDomain(s);
     }
     this->flushEdgeAAData();
@@ -785,10 +900,21 @@ void GrGpuGLShaders::buildProgram(GrPrimitiveType type) {
                 case GrSamplerState::k4x4Downsample_Filter:
                     stage.fFetchMode = GrGLProgram::ProgramDesc::StageDesc::k2x2_FetchMode;
                     break;
+                // performs kernel width texture2D()s
+                case GrSamplerState::kConvolution_Filter:
+                    stage.fFetchMode = GrGLProgram::ProgramDesc::StageDesc::kConvolution_FetchMode;
+                    break;
                 default:
                     GrCrash("Unexpected filter!");
                     break;
             }
+            if (GrGLProgram::ProgramDesc::StageDesc::kConvolution_FetchMode ==
+                stage.fFetchMode) {
+                stage.fKernelWidth =
+                            fCurrDrawState.fSamplerStates[s].getKernelWidth();
+            } else {
+                stage.fKernelWidth = 0;
+            }
 
             if (fCurrDrawState.fSamplerStates[s].hasTextureDomain()) {
                 GrAssert(GrSamplerState::kClamp_WrapMode ==
@@ -809,6 +935,7 @@ void GrGpuGLShaders::buildProgram(GrPrimitiveType type) {
             stage.fOptFlags     = 0;
             stage.fCoordMapping = (GrGLProgram::ProgramDesc::StageDesc::CoordMapping)0;
             stage.fModulation   = (GrGLProgram::ProgramDesc::StageDesc::Modulation)0;
+            stage.fKernelWidth  = 0;
         }
     }
 
@@ -69,6 +69,9 @@ private:
     // flushes the normalized texel size
     void flushTexelSize(int stage);
 
+    // flushes the kernel and image increment of a convolution
+    void flushConvolution(int stage);
+
     // flushes the edges for edge AA
     void flushEdgeAAData();
 
@@ -0,0 +1,161 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "GrImageAtlas.h"
+#include "GrGpu.h"
+#include "GrMemory.h"
+#include "GrRectanizer.h"
+#include "GrTextureCache.h"
+
+#define BORDER      1
+#define BPP         4
+
+class GrImageAtlas::Key {
+public:
+    Key(uint32_t p0, uint32_t p1, int width, int height) {
+        fImage.fP0 = p0;
+        fImage.fP1 = p1;
+        fImage.fSize = width | (height << 16);
+    }
+
+    uint32_t getHash() const { return fImage.getHash(); }
+
+    static bool LT(const Image& image, const Key& key) {
+        RET_IF_LT_OR_GT(image.fP0, key.fImage.fP0);
+        RET_IF_LT_OR_GT(image.fP1, key.fImage.fP1);
+        return image.fSize < key.fImage.fSize;
+    }
+    static bool EQ(const Image& image, const Key& key) {
+        return image.fP0 == key.fImage.fP0 && image.fP1 == key.fImage.fP1 &&
+               image.fSize == key.fImage.fSize;
+    }
+
+    Image fImage;
+};
+
+GrImageAtlas::GrImageAtlas(GrGpu* gpu) {
+    fGpu = gpu;
+    gpu->ref();
+    Gr_bzero(fPages, sizeof(fPages));
+    fPageCount = 0;
+}
+
+GrImageAtlas::~GrImageAtlas() {
+    this->freeAll();
+    fGpu->unref();
+}
+
+void GrImageAtlas::purge() {
+    fCache.deleteAll();
+    for (int i = 0; i < fPageCount; ++i) {
+        delete fPages[i].fRects;
+        fPages[i].fRects = GrRectanizer::Factory(kPageSize, kPageSize);
+    }
+}
+
+void GrImageAtlas::freeAll() {
+    fCache.deleteAll();
+    for (int i = 0; i < fPageCount; ++i) {
+        fPages[i].fTexture->unref();
+        delete fPages[i].fRects;
+    }
+    Gr_bzero(fPages, sizeof(fPages));
+    fPageCount = 0;
+}
+
+GrTexture* GrImageAtlas::findOrAdd(uint32_t p0, uint32_t p1,
+                                   int width, int height,
+                                   const void* pixels, size_t rowBytes,
+                                   GrIRect* bounds) {
+    if (!CanHold(width, height)) {
+        return NULL;
+    }
+
+    Key key(p0, p1, width, height);
+    Image* image = fCache.find(key);
+    if (NULL == image) {
+        GrIPoint16 loc;
+        int page = 0;
+        while (page < fPageCount &&
+               !this->addToPage(page, width, height, pixels, rowBytes, &loc)) {
+            ++page;
+        }
+        if (page == fPageCount) {
+            if (kMaxPages == fPageCount) {
+                return NULL;
+            }
+            GrTextureDesc desc = {
+                kDynamicUpdate_GrTextureFlagBit,
+                kNone_GrAALevel,
+                kPageSize,
+                kPageSize,
+                kRGBA_8888_GrPixelConfig
+            };
+            GrTexture* texture = fGpu->createTexture(desc, NULL, 0);
+            if (NULL == texture) {
+                return NULL;
+            }
+            fPages[page].fTexture = texture;
+            fPages[page].fRects = GrRectanizer::Factory(kPageSize, kPageSize);
+            ++fPageCount;
+            if (!this->addToPage(page, width, height, pixels, rowBytes,
+                                 &loc)) {
+                return NULL;
+            }
+        }
+        image = new Image(key.fImage);
+        image->fPage = page;
+        image->fLoc = loc;
+        fCache.insert(key, image);
+    }
+
+    bounds->setXYWH(image->fLoc.fX, image->fLoc.fY, width, height);
+    return fPages[image->fPage].fTexture;
+}
+
+bool GrImageAtlas::addToPage(int pageIndex, int width, int height,
+                             const void* pixels, size_t rowBytes,
+                             GrIPoint16* loc) {
+    Page& page = fPages[pageIndex];
+    const int dstW = width + 2 * BORDER;
+    const int dstH = height + 2 * BORDER;
+    if (!page.fRects->addRect(dstW, dstH, loc)) {
+        return false;
+    }
+
+    // copy the pixels with their edges repeated into the border
+    GrAutoSMalloc<4096> storage;
+    const size_t dstRB = dstW * BPP;
+    uint8_t* dst = (uint8_t*)storage.realloc(dstH * dstRB);
+    for (int y = 0; y < dstH; ++y) {
+        int srcY = GrMin(GrMax(y - BORDER, 0), height - 1);
+        const uint8_t* src = (const uint8_t*)pixels + srcY * rowBytes;
+        uint8_t* row = dst + y * dstRB;
+        memcpy(row + BORDER * BPP, src, width * BPP);
+        for (int x = 0; x < BORDER; ++x) {
+            memcpy(row + x * BPP, src, BPP);
+            memcpy(row + (BORDER + width + x) * BPP,
+                   src + (width - 1) * BPP, BPP);
+        }
+    }
+    page.fTexture->uploadTextureData(loc->fX, loc->fY, dstW, dstH, dst);
+
+    // the image starts inside the border
+    loc->fX += BORDER;
+    loc->fY += BORDER;
+    return true;
+}
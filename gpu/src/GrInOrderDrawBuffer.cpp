@@ -22,6 +22,31 @@
 #include "GrVertexBuffer.h"
 #include "GrGpu.h"
 
+// How far back in the playback order a draw may be moved when reordering. It
+// bounds the cost of reordering, as a draw is checked against each draw it
+// would move ahead of.
+static const int MAX_REORDER_DISTANCE = 32;
+
+// Finds the device space bounds of count vertices, outset to cover the AA
+// edges and hairlines that may extend past them.
+// Device space area (in pixels) up to which batching a rect with others of
+// different colors is worth drawing it with blending on.
+static const GrScalar SMALL_RECT_AREA = GrIntToScalar(64 * 64);
+
+static void vertex_bounds(const void* vertices, int start, int count,
+                          int vertexSize, const GrMatrix& matrix,
+                          GrRect* bounds) {
+    const GrPoint* p = GrDrawTarget::GetVertexPoint(vertices, start,
+                                                    vertexSize);
+    bounds->set(p->fX, p->fY, p->fX, p->fY);
+    for (int v = 1; v < count; ++v) {
+        p = GrDrawTarget::GetVertexPoint(vertices, start + v, vertexSize);
+        bounds->growToInclude(p->fX, p->fY);
+    }
+    matrix.mapRect(bounds);
+    bounds->inset(-GR_Scalar1, -GR_Scalar1);
+}
+
 GrInOrderDrawBuffer::GrInOrderDrawBuffer(GrVertexBufferAllocPool* vertexPool,
                                          GrIndexBufferAllocPool* indexPool)
     : fDraws(&fDrawStorage)
@@ -29,6 +54,7 @@ GrInOrderDrawBuffer::GrInOrderDrawBuffer(GrVertexBufferAllocPool* vertexPool,
     , fClears(&fClearStorage)
     , fClips(&fClipStorage)
     , fClipSet(true)
+    , fReorderDraws(false)
 
     , fLastRectVertexLayout(0)
     , fQuadIndexBuffer(NULL)
@@ -45,6 +71,7 @@ GrInOrderDrawBuffer::GrInOrderDrawBuffer(GrVertexBufferAllocPool* vertexPool,
     GeometryPoolState& poolState = fGeoPoolStateStack.push_back();
     poolState.fUsedPoolVertexBytes = 0;
     poolState.fUsedPoolIndexBytes = 0;
+    poolState.fPoolVertices = NULL;
 #if GR_DEBUG
     poolState.fPoolVertexBuffer = (GrVertexBuffer*)~0;
     poolState.fPoolStartVertex = ~0;
@@ -92,16 +119,43 @@ void GrInOrderDrawBuffer::drawRect(const GrRect& rect,
     if (fMaxQuads) {
 
         bool appendToPreviousDraw = false;
-        GrVertexLayout layout = GetRectVertexLayout(stageEnableBitfield, srcRects);
-        AutoReleaseGeometry geo(this, layout, 4, 0);
-        AutoViewMatrixRestore avmr(this);
         GrMatrix combinedMatrix = this->getViewMatrix();
-        this->setViewMatrix(GrMatrix::I());
         if (NULL != matrix) {
             combinedMatrix.preConcat(*matrix);
         }
 
+        // Small or translucent rects carry their color in their vertices so
+        // that a run of them isn't broken by color changes. Other rects keep
+        // it in the draw state, where an opaque color lets blending be
+        // turned off.
+        GrColor color = this->getColor();
+        bool colorInVertices = 0xff != GrColorUnpackA(color);
+        if (!colorInVertices) {
+            GrRect devRect;
+            combinedMatrix.mapRect(&devRect, rect);
+            colorInVertices = devRect.width() * devRect.height() <=
+                              SMALL_RECT_AREA;
+        }
+
+        GrVertexLayout layout = GetRectVertexLayout(stageEnableBitfield, srcRects);
+        if (colorInVertices) {
+            layout |= kColor_VertexLayoutBit;
+        }
+        AutoReleaseGeometry geo(this, layout, 4, 0);
+        AutoViewMatrixRestore avmr(this);
+        this->setViewMatrix(GrMatrix::I());
+
         SetRectVertices(rect, &combinedMatrix, srcRects, srcMatrices, layout, geo.vertices());
+        if (colorInVertices) {
+            int vsize = VertexSize(layout);
+            int colorOffset = VertexColorOffset(layout);
+            for (int v = 0; v < 4; ++v) {
+                *(GrColor*)((intptr_t)geo.vertices() + v * vsize +
+                            colorOffset) = color;
+            }
+            // the same for every such rect, so they can share a draw
+            this->setColor(0xffffffff);
+        }
 
         // we don't want to miss an opportunity to batch rects together
         // simply because the clip has changed if the clip doesn't affect
@@ -167,6 +221,12 @@ void GrInOrderDrawBuffer::drawRect(const GrRect& rect,
             if (appendToPreviousDraw) {
                 lastDraw.fVertexCount += 4;
                 lastDraw.fIndexCount += 6;
+                if (lastDraw.fBoundsValid) {
+                    GrRect bounds;
+                    vertex_bounds(geo.vertices(), 0, 4, vsize, GrMatrix::I(),
+                                  &bounds);
+                    lastDraw.fBounds.growToInclude(bounds);
+                }
                 fCurrQuad += 1;
                 // we reserved above, so we should be the first
                 // use of this vertex reserveation.
@@ -177,12 +237,16 @@ void GrInOrderDrawBuffer::drawRect(const GrRect& rect,
         if (!appendToPreviousDraw) {
             this->setIndexSourceToBuffer(fQuadIndexBuffer);
             drawIndexed(kTriangles_PrimitiveType, 0, 0, 4, 6);
-            fCurrQuad = 1;
+            // the rect may have been added to an earlier run of quads
+            fCurrQuad = fDraws.back().fVertexCount / 4;
             fLastRectVertexLayout = layout;
         }
         if (disabledClip) {
             this->enableState(kClip_StateBit);
         }
+        if (colorInVertices) {
+            this->setColor(color);
+        }
     } else {
         INHERITED::drawRect(rect, matrix, stageEnableBitfield, srcRects, srcMatrices);
     }
@@ -200,6 +264,12 @@ void GrInOrderDrawBuffer::onDrawIndexed(GrPrimitiveType primitiveType,
 
     fCurrQuad = 0;
 
+    if (this->appendQuadsToPreviousDraw(primitiveType, startVertex,
+                                        startIndex, vertexCount,
+                                        indexCount)) {
+        return;
+    }
+
     GeometryPoolState& poolState = fGeoPoolStateStack.back();
 
     Draw& draw = fDraws.push_back();
@@ -238,6 +308,7 @@ void GrInOrderDrawBuffer::onDrawIndexed(GrPrimitiveType primitiveType,
         GrCrash("unknown geom src type");
     }
     draw.fVertexBuffer->ref();
+    this->setDrawBounds(&draw, startVertex, vertexCount);
 
     switch (this->getGeomSrc().fIndexSrc) {
     case kBuffer_GeometrySrcType:
@@ -258,6 +329,65 @@ void GrInOrderDrawBuffer::onDrawIndexed(GrPrimitiveType primitiveType,
     draw.fIndexBuffer->ref();
 }
 
+/*
+ *  Quads drawn with the quad index buffer (text runs, rects that couldn't
+ *  join the rect run) whose vertices follow on from the previous such draw
+ *  in the same vertex buffer, with the same state and clip, are added to
+ *  that draw. Consecutive drawText calls that share a paint and glyph atlas
+ *  are then played back as a single draw.
+ */
+bool GrInOrderDrawBuffer::appendQuadsToPreviousDraw(GrPrimitiveType type,
+                                                    int startVertex,
+                                                    int startIndex,
+                                                    int vertexCount,
+                                                    int indexCount) {
+    const GeometrySrcState& geoSrc = this->getGeomSrc();
+    if (NULL == fQuadIndexBuffer || fDraws.empty() ||
+        kTriangles_PrimitiveType != type || 0 != startIndex ||
+        kBuffer_GeometrySrcType != geoSrc.fIndexSrc ||
+        fQuadIndexBuffer != geoSrc.fIndexBuffer ||
+        (kReserved_GeometrySrcType != geoSrc.fVertexSrc &&
+         kArray_GeometrySrcType != geoSrc.fVertexSrc) ||
+        0 != vertexCount % 4 || 6 * (vertexCount / 4) != indexCount) {
+        return false;
+    }
+
+    Draw& lastDraw = fDraws.back();
+    GeometryPoolState& poolState = fGeoPoolStateStack.back();
+    bool clearSinceLastDraw = fClears.count() &&
+                              fClears.back().fBeforeDrawIdx == fDraws.count();
+    if (clearSinceLastDraw ||
+        lastDraw.fIndexBuffer != fQuadIndexBuffer ||
+        kTriangles_PrimitiveType != lastDraw.fPrimitiveType ||
+        0 != lastDraw.fStartIndex ||
+        lastDraw.fVertexLayout != geoSrc.fVertexLayout ||
+        lastDraw.fVertexBuffer != poolState.fPoolVertexBuffer ||
+        lastDraw.fStartVertex + lastDraw.fVertexCount !=
+            poolState.fPoolStartVertex + startVertex ||
+        (lastDraw.fVertexCount + vertexCount) / 4 > fMaxQuads ||
+        this->needsNewClip() || this->needsNewState()) {
+        return false;
+    }
+
+    if (lastDraw.fBoundsValid) {
+        Draw appended;
+        this->setDrawBounds(&appended, startVertex, vertexCount);
+        if (appended.fBoundsValid) {
+            lastDraw.fBounds.growToInclude(appended.fBounds);
+        } else {
+            lastDraw.fBoundsValid = false;
+        }
+    }
+    lastDraw.fVertexCount += vertexCount;
+    lastDraw.fIndexCount += indexCount;
+
+    size_t vertexBytes = (vertexCount + startVertex) *
+                         VertexSize(geoSrc.fVertexLayout);
+    poolState.fUsedPoolVertexBytes =
+                        GrMax(poolState.fUsedPoolVertexBytes, vertexBytes);
+    return true;
+}
+
 void GrInOrderDrawBuffer::onDrawNonIndexed(GrPrimitiveType primitiveType,
                                            int startVertex,
                                            int vertexCount) {
@@ -306,6 +436,7 @@ void GrInOrderDrawBuffer::onDrawNonIndexed(GrPrimitiveType primitiveType,
     }
     draw.fVertexBuffer->ref();
     draw.fIndexBuffer = NULL;
+    this->setDrawBounds(&draw, startVertex, vertexCount);
 }
 
 void GrInOrderDrawBuffer::clear(const GrIRect* rect, GrColor color) {
@@ -375,11 +506,38 @@ void GrInOrderDrawBuffer::playback(GrDrawTarget* target) {
     GrDrawTarget::AutoClipRestore acr(target);
     AutoGeometryPush agp(target);
 
+    // the state and clip that each draw was queued with
+    GrAutoSTMalloc<kDrawPreallocCnt, int> states(numDraws);
+    GrAutoSTMalloc<kDrawPreallocCnt, int> clips(numDraws);
     int currState = ~0;
     int currClip  = ~0;
+    for (int i = 0; i < numDraws; ++i) {
+        if (fDraws[i].fStateChanged) {
+            ++currState;
+        }
+        if (fDraws[i].fClipChanged) {
+            ++currClip;
+        }
+        states[i] = currState;
+        clips[i] = currClip;
+    }
+
+    GrTDArray<int> order;
+    if (fReorderDraws) {
+        this->reorderDraws(states, clips, &order);
+    } else {
+        for (int i = 0; i < numDraws; ++i) {
+            *order.append() = i;
+        }
+    }
+
+    currState = ~0;
+    currClip  = ~0;
     int currClear = 0;
 
-    for (int i = 0; i < numDraws; ++i) {
+    for (int p = 0; p < numDraws; ++p) {
+        int i = order[p];
+        // reordering keeps the draw after a clear in place
         while (currClear < fClears.count() && 
                i == fClears[currClear].fBeforeDrawIdx) {
             target->clear(&fClears[currClear].fRect, fClears[currClear].fColor);
@@ -387,12 +545,13 @@ void GrInOrderDrawBuffer::playback(GrDrawTarget* target) {
         }
 
         const Draw& draw = fDraws[i];
-        if (draw.fStateChanged) {
-            ++currState;
+        if (states[i] != currState) {
+            currState = states[i];
             target->restoreDrawState(fStates[currState]);
         }
-        if (draw.fClipChanged) {
-            ++currClip;
+        const DrState& state = this->accessSavedDrawState(fStates[currState]);
+        if ((state.fFlagBits & kClip_StateBit) && clips[i] != currClip) {
+            currClip = clips[i];
             target->setClip(fClips[currClip]);
         }
 
@@ -421,6 +580,67 @@ void GrInOrderDrawBuffer::playback(GrDrawTarget* target) {
     }
 }
 
+void GrInOrderDrawBuffer::reorderDraws(const int states[], const int clips[],
+                                       GrTDArray<int>* order) const {
+    int numDraws = fDraws.count();
+    int currClear = 0;
+    int clearPos = 0;
+
+    for (int i = 0; i < numDraws; ++i) {
+        // draws are never moved ahead of a clear
+        while (currClear < fClears.count() &&
+               i == fClears[currClear].fBeforeDrawIdx) {
+            clearPos = order->count();
+            ++currClear;
+        }
+
+        const Draw& draw = fDraws[i];
+        const DrState& state = this->accessSavedDrawState(fStates[states[i]]);
+        int sameAt = -1;
+        int compatibleAt = -1;
+        if (draw.fBoundsValid) {
+            int stop = GrMax(clearPos, order->count() - MAX_REORDER_DISTANCE);
+            for (int p = order->count() - 1; p >= stop; --p) {
+                int j = (*order)[p];
+                const Draw& other = fDraws[j];
+                const DrState& otherState =
+                                this->accessSavedDrawState(fStates[states[j]]);
+                if (states[i] == states[j] || state == otherState) {
+                    // the same flags, so both use the clip or neither does
+                    if (!(state.fFlagBits & kClip_StateBit) ||
+                        clips[i] == clips[j] ||
+                        fClips[clips[i]] == fClips[clips[j]]) {
+                        sameAt = p + 1;
+                        break;
+                    }
+                }
+                if (compatibleAt < 0 &&
+                    draw.fVertexLayout == other.fVertexLayout &&
+                    state.fSrcBlend == otherState.fSrcBlend &&
+                    state.fDstBlend == otherState.fDstBlend &&
+                    state.fRenderTarget == otherState.fRenderTarget &&
+                    0 == memcmp(state.fTextures, otherState.fTextures,
+                                sizeof(state.fTextures))) {
+                    compatibleAt = p + 1;
+                }
+                // a draw to another target may read this one's, or be read
+                if (!other.fBoundsValid ||
+                    state.fRenderTarget != otherState.fRenderTarget ||
+                    GrRect::Intersects(draw.fBounds, other.fBounds)) {
+                    break;
+                }
+            }
+        }
+        if (sameAt >= 0) {
+            *order->insert(sameAt) = i;
+        } else if (compatibleAt >= 0) {
+            *order->insert(compatibleAt) = i;
+        } else {
+            *order->append() = i;
+        }
+    }
+}
+
 bool GrInOrderDrawBuffer::geometryHints(GrVertexLayout vertexLayout,
                                         int* vertexCount,
                                         int* indexCount) const {
@@ -463,6 +683,7 @@ bool GrInOrderDrawBuffer::onReserveVertexSpace(GrVertexLayout vertexLayout,
                                       vertexCount,
                                       &poolState.fPoolVertexBuffer,
                                       &poolState.fPoolStartVertex);
+    poolState.fPoolVertices = *vertices;
     return NULL != *vertices;
 }
     
@@ -518,6 +739,8 @@ void GrInOrderDrawBuffer::onSetVertexSourceToArray(const void* vertexArray,
                                &poolState.fPoolVertexBuffer,
                                &poolState.fPoolStartVertex);
     GR_DEBUGASSERT(success);
+    // the caller's array stays valid while it is the vertex source
+    poolState.fPoolVertices = vertexArray;
 }
 
 void GrInOrderDrawBuffer::onSetIndexSourceToArray(const void* indexArray,
@@ -538,6 +761,7 @@ void GrInOrderDrawBuffer::geometrySourceWillPush() {
     GeometryPoolState& poolState = fGeoPoolStateStack.push_back();
     poolState.fUsedPoolVertexBytes = 0;
     poolState.fUsedPoolIndexBytes = 0;
+    poolState.fPoolVertices = NULL;
 #if GR_DEBUG
     poolState.fPoolVertexBuffer = (GrVertexBuffer*)~0;
     poolState.fPoolStartVertex = ~0;
@@ -588,6 +812,22 @@ void GrInOrderDrawBuffer::geometrySourceWillPop(
     }
 }
 
+void GrInOrderDrawBuffer::setDrawBounds(Draw* draw,
+                                        int startVertex,
+                                        int vertexCount) {
+    const GeometrySrcState& geoSrc = this->getGeomSrc();
+    // we can't read the vertices back out of a caller's buffer, and under
+    // perspective the mapped rect may not contain the draw
+    draw->fBoundsValid = fReorderDraws &&
+                         kBuffer_GeometrySrcType != geoSrc.fVertexSrc &&
+                         !fCurrDrawState.fViewMatrix.hasPerspective();
+    if (draw->fBoundsValid) {
+        vertex_bounds(fGeoPoolStateStack.back().fPoolVertices, startVertex,
+                      vertexCount, VertexSize(geoSrc.fVertexLayout),
+                      fCurrDrawState.fViewMatrix, &draw->fBounds);
+    }
+}
+
 bool GrInOrderDrawBuffer::needsNewState() const {
      if (fStates.empty()) {
         return true;
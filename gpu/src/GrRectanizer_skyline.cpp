@@ -0,0 +1,158 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "GrRectanizer.h"
+
+/*
+    Keeps the top edge of the packed rects (the skyline) as a list of
+    horizontal segments, ordered by x. A new rect goes where its top would be
+    lowest ("bottom-left" in y-down coordinates), preferring the narrowest
+    segment on ties, so rects of mixed heights don't each waste the rest of a
+    row the way the pow2 and fifo rectanizers do.
+ */
+class GrRectanizerSkyline : public GrRectanizer {
+public:
+    GrRectanizerSkyline(int w, int h) : GrRectanizer(w, h) {
+        fAreaSoFar = 0;
+        Segment* seg = fSkyline.append();
+        seg->fX = 0;
+        seg->fY = 0;
+        seg->fWidth = w;
+    }
+
+    virtual ~GrRectanizerSkyline() {
+    }
+
+    virtual bool addRect(int w, int h, GrIPoint16* loc);
+
+    virtual float percentFull() const {
+        return fAreaSoFar / ((float)this->width() * this->height());
+    }
+
+    virtual int stripToPurge(int height) const { return -1; }
+    virtual void purgeStripAtY(int yCoord) { }
+
+private:
+    struct Segment {
+        int fX;
+        int fY;         // the lowest free y over the segment
+        int fWidth;
+    };
+
+    GrTDArray<Segment>  fSkyline;
+    int32_t             fAreaSoFar;
+
+    // Can a width x height rect go with its left edge at segment index? If
+    // so, sets y to where its top goes.
+    bool rectangleFits(int index, int width, int height, int* y) const;
+    void addSkylineLevel(int index, int x, int y, int width, int height);
+};
+
+bool GrRectanizerSkyline::rectangleFits(int index, int width, int height,
+                                        int* ypos) const {
+    int x = fSkyline[index].fX;
+    if (x + width > this->width()) {
+        return false;
+    }
+
+    int widthLeft = width;
+    int i = index;
+    int y = fSkyline[index].fY;
+    while (widthLeft > 0) {
+        GrAssert(i < fSkyline.count());
+        y = GrMax(y, fSkyline[i].fY);
+        if (y + height > this->height()) {
+            return false;
+        }
+        widthLeft -= fSkyline[i].fWidth;
+        ++i;
+    }
+    *ypos = y;
+    return true;
+}
+
+void GrRectanizerSkyline::addSkylineLevel(int index, int x, int y,
+                                          int width, int height) {
+    Segment* newSeg = fSkyline.insert(index);
+    newSeg->fX = x;
+    newSeg->fY = y + height;
+    newSeg->fWidth = width;
+
+    // trim (or remove) the segments the new one now covers
+    for (int i = index + 1; i < fSkyline.count(); ++i) {
+        const Segment& prev = fSkyline[i - 1];
+        int prevRight = prev.fX + prev.fWidth;
+        if (fSkyline[i].fX >= prevRight) {
+            break;
+        }
+        int shrink = prevRight - fSkyline[i].fX;
+        fSkyline[i].fX += shrink;
+        fSkyline[i].fWidth -= shrink;
+        if (fSkyline[i].fWidth > 0) {
+            break;
+        }
+        fSkyline.remove(i);
+        --i;
+    }
+
+    // merge neighbors at the same height
+    for (int i = 0; i < fSkyline.count() - 1; ++i) {
+        if (fSkyline[i].fY == fSkyline[i + 1].fY) {
+            fSkyline[i].fWidth += fSkyline[i + 1].fWidth;
+            fSkyline.remove(i + 1);
+            --i;
+        }
+    }
+}
+
+bool GrRectanizerSkyline::addRect(int width, int height, GrIPoint16* loc) {
+    if ((unsigned)width > (unsigned)this->width() ||
+        (unsigned)height > (unsigned)this->height()) {
+        return false;
+    }
+
+    int bestIndex = -1;
+    int bestX = 0;
+    int bestY = this->height() + 1;
+    int bestWidth = this->width() + 1;
+    for (int i = 0; i < fSkyline.count(); ++i) {
+        int y;
+        if (this->rectangleFits(i, width, height, &y)) {
+            if (y < bestY ||
+                (y == bestY && fSkyline[i].fWidth < bestWidth)) {
+                bestIndex = i;
+                bestX = fSkyline[i].fX;
+                bestY = y;
+                bestWidth = fSkyline[i].fWidth;
+            }
+        }
+    }
+    if (-1 == bestIndex) {
+        return false;
+    }
+
+    this->addSkylineLevel(bestIndex, bestX, bestY, width, height);
+    loc->set(bestX, bestY);
+    fAreaSoFar += width * height;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+GrRectanizer* GrRectanizer::Factory(int width, int height) {
+    return new GrRectanizerSkyline(width, height);
+}
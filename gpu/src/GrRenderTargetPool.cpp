@@ -0,0 +1,191 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "GrRenderTargetPool.h"
+#include "GrGpu.h"
+
+namespace {
+
+// Up to 512 sizes are rounded up to a power of two. Above that they're
+// rounded to a multiple of 256, so big layers don't waste most of a texture.
+int bucket_size(int size, int maxSize) {
+    static const int MIN_SIZE = 64;
+    static const int POW2_LIMIT = 512;
+    int bucket;
+    if (size <= POW2_LIMIT) {
+        bucket = GrMax(MIN_SIZE, GrNextPow2(size));
+    } else {
+        bucket = (int)GrSizeAlignUp(size, 256);
+    }
+    return GrMax(size, GrMin(bucket, maxSize));
+}
+
+bool can_use(const GrTextureDesc& have, const GrTextureDesc& want,
+             int bucketW, int bucketH) {
+    if (have.fFormat != want.fFormat || have.fAALevel != want.fAALevel) {
+        return false;
+    }
+    if ((have.fFlags & kNoStencil_GrTextureFlagBit) &&
+        !(want.fFlags & kNoStencil_GrTextureFlagBit)) {
+        return false;
+    }
+    // don't use a much bigger render target than needed: it may be wanted
+    // for something bigger next
+    return have.fWidth >= bucketW && have.fWidth <= 2 * bucketW &&
+           have.fHeight >= bucketH && have.fHeight <= 2 * bucketH;
+}
+
+}
+
+GrRenderTargetPool::GrRenderTargetPool(GrGpu* gpu) {
+    fGpu = gpu;
+    fFrame = 0;
+    fUnlockedBytes = 0;
+    fHitCnt = 0;
+    fMissCnt = 0;
+    fPurgeCnt = 0;
+}
+
+GrRenderTargetPool::~GrRenderTargetPool() {
+    this->freeAll();
+}
+
+GrTexture* GrRenderTargetPool::lock(const GrTextureDesc& inDesc) {
+    GrTextureDesc desc = inDesc;
+    desc.fFlags |= kRenderTarget_GrTextureFlagBit;
+    int maxSize = fGpu->maxRenderTargetSize();
+    int bucketW = bucket_size(desc.fWidth, maxSize);
+    int bucketH = bucket_size(desc.fHeight, maxSize);
+
+    // take the smallest that fits
+    int best = -1;
+    for (int i = 0; i < fEntries.count(); ++i) {
+        const Entry& entry = fEntries[i];
+        if (!entry.fLocked &&
+            can_use(entry.fDesc, desc, bucketW, bucketH) &&
+            (-1 == best ||
+             entry.fDesc.fWidth * entry.fDesc.fHeight <
+             fEntries[best].fDesc.fWidth * fEntries[best].fDesc.fHeight)) {
+            best = i;
+        }
+    }
+
+    Entry* entry;
+    if (-1 != best) {
+        ++fHitCnt;
+        entry = &fEntries[best];
+        fUnlockedBytes -= entry->fTexture->sizeInBytes();
+    } else {
+        ++fMissCnt;
+        desc.fWidth = bucketW;
+        desc.fHeight = bucketH;
+        GrTexture* texture = fGpu->createTexture(desc, NULL, 0);
+        if (NULL == texture) {
+            // maybe the unlocked ones use the memory we need
+            this->freeUnlocked();
+            texture = fGpu->createTexture(desc, NULL, 0);
+            if (NULL == texture) {
+                return NULL;
+            }
+        }
+        entry = fEntries.append();
+        entry->fTexture = texture;
+        entry->fDesc = desc;
+    }
+    entry->fLocked = true;
+    entry->fLastUsedFrame = fFrame;
+    entry->fTexture->ref();
+    return entry->fTexture;
+}
+
+void GrRenderTargetPool::unlock(GrTexture* texture) {
+    for (int i = 0; i < fEntries.count(); ++i) {
+        Entry& entry = fEntries[i];
+        if (entry.fTexture == texture) {
+            GrAssert(entry.fLocked);
+            entry.fLocked = false;
+            entry.fLastUsedFrame = fFrame;
+            fUnlockedBytes += texture->sizeInBytes();
+            texture->unref();
+            this->purge(kMaxUnlockedBytes);
+            return;
+        }
+    }
+    // the pool was emptied (freeAll) while the texture was locked
+    texture->unref();
+}
+
+void GrRenderTargetPool::newFrame() {
+    ++fFrame;
+    for (int i = fEntries.count() - 1; i >= 0; --i) {
+        const Entry& entry = fEntries[i];
+        if (!entry.fLocked &&
+            fFrame - entry.fLastUsedFrame > kMaxIdleFrames) {
+            this->remove(i);
+        }
+    }
+}
+
+void GrRenderTargetPool::freeUnlocked() {
+    this->purge(0);
+}
+
+void GrRenderTargetPool::freeAll() {
+    for (int i = 0; i < fEntries.count(); ++i) {
+        fEntries[i].fTexture->unref();
+    }
+    fEntries.reset();
+    fUnlockedBytes = 0;
+}
+
+void GrRenderTargetPool::purge(int maxBytes) {
+    // release the least recently used first
+    while (fUnlockedBytes > (size_t)maxBytes) {
+        int oldest = -1;
+        for (int i = 0; i < fEntries.count(); ++i) {
+            if (!fEntries[i].fLocked &&
+                (-1 == oldest || fEntries[i].fLastUsedFrame <
+                                 fEntries[oldest].fLastUsedFrame)) {
+                oldest = i;
+            }
+        }
+        if (-1 == oldest) {
+            break;
+        }
+        this->remove(oldest);
+    }
+}
+
+void GrRenderTargetPool::remove(int index) {
+    Entry& entry = fEntries[index];
+    GrAssert(!entry.fLocked);
+    fUnlockedBytes -= entry.fTexture->sizeInBytes();
+    entry.fTexture->unref();
+    fEntries.removeShuffle(index);
+    ++fPurgeCnt;
+}
+
+void GrRenderTargetPool::printStats() const {
+    int locked = 0;
+    for (int i = 0; i < fEntries.count(); ++i) {
+        locked += fEntries[i].fLocked;
+    }
+    GrPrintf("Render target pool: %d targets (%d locked), %dK unlocked, "
+             "%d hits, %d misses, %d purged\n",
+             fEntries.count(), locked, (int)(fUnlockedBytes >> 10),
+             fHitCnt, fMissCnt, fPurgeCnt);
+}
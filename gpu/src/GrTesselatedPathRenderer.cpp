@@ -289,9 +289,83 @@ static unsigned fill_type_to_glu_winding_rule(GrPathFill fill) {
     }
 }
 
+// Enough for the paths a frame redraws, without holding on to many
+// tesselations that are never drawn again.
+#define MAX_CACHED_TESS 16
+
+struct GrTesselatedPathRenderer::CachedTess {
+    uint32_t        fGenerationID;
+    GrPathFill      fFill;
+    GrScalar        fTolerance;
+    GrPoint         fTranslate;
+    GrPointArray    fVertices;
+    GrIndexArray    fIndices;
+
+    bool matches(uint32_t genID, GrPathFill fill, GrScalar tol,
+                 const GrPoint& translate) const {
+        return fGenerationID == genID && fFill == fill &&
+               fTolerance == tol && fTranslate == translate;
+    }
+};
+
 GrTesselatedPathRenderer::GrTesselatedPathRenderer() {
 }
 
+GrTesselatedPathRenderer::~GrTesselatedPathRenderer() {
+    fCache.deleteAll();
+}
+
+const GrTesselatedPathRenderer::CachedTess*
+GrTesselatedPathRenderer::findTess(const GrPath& path, GrPathFill fill,
+                                   GrScalar tol, const GrPoint& translate) {
+    uint32_t genID = path.getGenerationID();
+    for (int i = 0; i < fCache.count(); ++i) {
+        CachedTess* tess = fCache[i];
+        if (tess->matches(genID, fill, tol, translate)) {
+            // move it to the front
+            fCache.remove(i);
+            *fCache.prepend() = tess;
+            return tess;
+        }
+    }
+    return NULL;
+}
+
+void GrTesselatedPathRenderer::addTess(const GrPath& path, GrPathFill fill,
+                                       GrScalar tol, const GrPoint& translate,
+                                       const GrPointArray& vertices,
+                                       const GrIndexArray& indices) {
+    CachedTess* tess;
+    if (fCache.count() >= MAX_CACHED_TESS) {
+        // reuse the least recently used one
+        tess = fCache[fCache.count() - 1];
+        fCache.remove(fCache.count() - 1);
+    } else {
+        tess = new CachedTess;
+    }
+    tess->fGenerationID = path.getGenerationID();
+    tess->fFill = fill;
+    tess->fTolerance = tol;
+    tess->fTranslate = translate;
+    tess->fVertices = vertices;
+    tess->fIndices = indices;
+    *fCache.prepend() = tess;
+}
+
+static void drawIndexedTriangles(GrDrawTarget* target, GrVertexLayout layout,
+                                 const GrPointArray& vertices,
+                                 const GrIndexArray& indices) {
+    if (indices.count() > 0) {
+        target->setVertexSourceToArray(layout, vertices.begin(), vertices.count());
+        target->setIndexSourceToArray(indices.begin(), indices.count());
+        target->drawIndexed(kTriangles_PrimitiveType,
+                            0,
+                            0,
+                            vertices.count(),
+                            indices.count());
+    }
+}
+
 static bool isCCW(const GrPoint* pts, int count) {
     GrVec v1, v2;
     do {
@@ -385,7 +459,23 @@ void GrTesselatedPathRenderer::drawPath(GrDrawTarget* target,
         }
     }
 
+    // Inverse fills depend on the render target's bounds, and antialiased
+    // ones on the view matrix, but the rest only on what the key holds.
     bool inverted = IsFillInverted(fill);
+    const bool cacheable = !inverted && !target->isAntialiasState();
+    GrPoint offset = GrPoint::Make(0, 0);
+    if (translate) {
+        offset = *translate;
+    }
+    if (cacheable) {
+        const CachedTess* tess = this->findTess(path, fill, tol, offset);
+        if (NULL != tess) {
+            drawIndexedTriangles(target, layout, tess->fVertices,
+                                 tess->fIndices);
+            return;
+        }
+    }
+
     if (inverted) {
         maxPts += 4;
         subpathCnt++;
@@ -598,15 +688,10 @@ FINISHED:
     ptess.addVertices(base, subpathVertCount, subpathCnt);
     const GrPointArray& vertices = ptess.vertices();
     const GrIndexArray& indices = ptess.indices();
-    if (indices.count() > 0) {
-        target->setVertexSourceToArray(layout, vertices.begin(), vertices.count());
-        target->setIndexSourceToArray(indices.begin(), indices.count());
-        target->drawIndexed(kTriangles_PrimitiveType,
-                            0,
-                            0,
-                            vertices.count(),
-                            indices.count());
+    if (cacheable) {
+        this->addTess(path, fill, tol, offset, vertices, indices);
     }
+    drawIndexedTriangles(target, layout, vertices, indices);
 }
 
 bool GrTesselatedPathRenderer::canDrawPath(const GrDrawTarget* target,
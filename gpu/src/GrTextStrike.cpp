@@ -84,6 +84,32 @@ void GrFontCache::purgeExceptFor(GrTextStrike* preserveStrike) {
     }
 }
 
+void GrFontCache::compactAtlases() {
+    GrTextStrike* strike = fHead;
+    while (strike) {
+        strike->compactAtlases();
+        strike = strike->fNext;
+    }
+}
+
+void GrFontCache::printStats() const {
+    int atlasCount = 0;
+    float fill = 0;
+    const GrTextStrike* strike = fHead;
+    while (strike) {
+        GrAtlas* atlas = strike->fAtlas;
+        while (atlas) {
+            atlasCount += 1;
+            fill += atlas->percentFull();
+            atlas = atlas->nextAtlas();
+        }
+        strike = strike->fNext;
+    }
+    GrPrintf("Font cache: %d strikes, %d atlas plots, %d%% full\n",
+             fCache.count(), atlasCount,
+             atlasCount ? (int)(100 * fill / atlasCount) : 0);
+}
+
 #if GR_DEBUG
 void GrFontCache::validate() const {
     int count = fCache.count();
@@ -159,6 +185,33 @@ GrTextStrike::~GrTextStrike() {
 #endif
 }
 
+int GrTextStrike::countAtlases() const {
+    int count = 0;
+    for (GrAtlas* atlas = fAtlas; atlas; atlas = atlas->nextAtlas()) {
+        count += 1;
+    }
+    return count;
+}
+
+static void ForgetGlyphAtlas(GrGlyph*& glyph) { glyph->fAtlas = NULL; }
+
+bool GrTextStrike::compactAtlases() {
+    int count = 0;
+    float fill = 0;
+    for (GrAtlas* atlas = fAtlas; atlas; atlas = atlas->nextAtlas()) {
+        count += 1;
+        fill += atlas->percentFull();
+    }
+    // would the glyphs that are in the atlases fit in one plot less?
+    if (count < 2 || fill > count - 1) {
+        return false;
+    }
+    GrAtlas::FreeLList(fAtlas);
+    fAtlas = NULL;
+    fCache.getArray().visit(ForgetGlyphAtlas);
+    return true;
+}
+
 GrGlyph* GrTextStrike::generateGlyph(GrGlyph::PackedID packed,
                                      GrFontScaler* scaler) {
     GrIRect bounds;
@@ -78,6 +78,13 @@ void GrTextureCache::setLimits(int maxTextures, size_t maxTextureBytes) {
     }
 }
 
+void GrTextureCache::purgeTo(size_t bytes) {
+    size_t maxBytes = fMaxBytes;
+    fMaxBytes = GrMin(bytes, maxBytes);
+    this->purgeAsNeeded();
+    fMaxBytes = maxBytes;
+}
+
 void GrTextureCache::internalDetach(GrTextureEntry* entry,
                                     bool clientDetach) {
     GrTextureEntry* prev = entry->fPrev;
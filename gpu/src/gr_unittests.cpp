@@ -19,6 +19,8 @@
 #include "GrDrawTarget.h"
 #include "GrMatrix.h"
 #include "GrPath.h"
+#include "GrRandom.h"
+#include "GrRectanizer.h"
 #include "GrRedBlackTree.h"
 #include "GrTDArray.h"
 
@@ -271,7 +273,37 @@ static void test_convex() {
 #endif
 }
 
+static void test_rectanizer() {
+    const int kSize = 128;
+    GrRectanizer* rectanizer = GrRectanizer::Factory(kSize, kSize);
+    GrTDArray<GrIRect> added;
+    GrRandom rand;
+
+    // add mixed sizes until the rectanizer is full
+    for (int i = 0; i < 1000; i++) {
+        int w = 1 + rand.nextU() % 20;
+        int h = 1 + rand.nextU() % 20;
+        GrIPoint16 loc;
+        if (!rectanizer->addRect(w, h, &loc)) {
+            continue;
+        }
+        GrIRect r;
+        r.setXYWH(loc.fX, loc.fY, w, h);
+        GrAssert(r.fLeft >= 0 && r.fTop >= 0);
+        GrAssert(r.fRight <= kSize && r.fBottom <= kSize);
+        for (int j = 0; j < added.count(); j++) {
+            GrAssert(!GrIRect::Intersects(r, added[j]));
+        }
+        *added.append() = r;
+    }
+    GrAssert(rectanizer->percentFull() > 0.5f);
+    GrIPoint16 loc;
+    GrAssert(!rectanizer->addRect(kSize + 1, 1, &loc));
+    delete rectanizer;
+}
+
 void gr_run_unittests() {
+    test_rectanizer();
     test_tdarray();
     test_bsearch();
     test_binHashKey();
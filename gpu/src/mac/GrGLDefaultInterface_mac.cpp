@@ -160,6 +160,17 @@ void GrGLSetDefaultGLInterface() {
     #endif
 #endif
         gDefaultInterface.fBindFragDataLocationIndexed = NULL;
+        gDefaultInterface.fGetProgramBinary = NULL;
+        gDefaultInterface.fProgramBinary = NULL;
+        gDefaultInterface.fFenceSync = NULL;
+        gDefaultInterface.fClientWaitSync = NULL;
+        gDefaultInterface.fDeleteSync = NULL;
+        gDefaultInterface.fGenQueries = NULL;
+        gDefaultInterface.fDeleteQueries = NULL;
+        gDefaultInterface.fBeginQuery = NULL;
+        gDefaultInterface.fEndQuery = NULL;
+        gDefaultInterface.fGetQueryObjectiv = NULL;
+        gDefaultInterface.fGetQueryObjectui64v = NULL;
 
         gDefaultInterface.fBindingsExported = kDesktop_GrGLBinding;
 
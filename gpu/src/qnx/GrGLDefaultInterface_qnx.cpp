@@ -183,6 +183,12 @@ void GrGLSetDefaultGLInterface() {
 
         gDefaultInterface.fEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
 
+        // OES_get_program_binary
+        if (has_gl_extension("GL_OES_get_program_binary")) {
+            gDefaultInterface.fGetProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+            gDefaultInterface.fProgramBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+        }
+
         gDefaultInterface.fBindingsExported = kES2_GrGLBinding;
         gDefaultInterfaceInit = true;
     }
@@ -144,6 +144,36 @@ void GrGLSetDefaultGLInterface() {
             GR_GL_GET_PROC(VertexAttrib4fv);
             GR_GL_GET_PROC(VertexAttribPointer);
             GR_GL_GET_PROC(BindFragDataLocationIndexed);
+            if (major > 4 || (4 == major && 1 <= minor) ||
+                has_gl_extension_from_string("GL_ARB_get_program_binary",
+                                             extString)) {
+                GR_GL_GET_PROC(GetProgramBinary);
+                GR_GL_GET_PROC(ProgramBinary);
+            }
+            if (major > 3 || (3 == major && 2 <= minor) ||
+                has_gl_extension_from_string("GL_ARB_sync", extString)) {
+                GR_GL_GET_PROC(FenceSync);
+                GR_GL_GET_PROC(ClientWaitSync);
+                GR_GL_GET_PROC(DeleteSync);
+            }
+            // queries are core, but timing them needs 3.3 or an extension
+            if (major > 3 || (3 == major && 3 <= minor) ||
+                has_gl_extension_from_string("GL_ARB_timer_query", extString)) {
+                GR_GL_GET_PROC(GenQueries);
+                GR_GL_GET_PROC(DeleteQueries);
+                GR_GL_GET_PROC(BeginQuery);
+                GR_GL_GET_PROC(EndQuery);
+                GR_GL_GET_PROC(GetQueryObjectiv);
+                GR_GL_GET_PROC(GetQueryObjectui64v);
+            } else if (has_gl_extension_from_string("GL_EXT_timer_query",
+                                                    extString)) {
+                GR_GL_GET_PROC(GenQueries);
+                GR_GL_GET_PROC(DeleteQueries);
+                GR_GL_GET_PROC(BeginQuery);
+                GR_GL_GET_PROC(EndQuery);
+                GR_GL_GET_PROC(GetQueryObjectiv);
+                GR_GL_GET_PROC_SUFFIX(GetQueryObjectui64v, EXT);
+            }
 
             // First look for GL3.0 FBO or GL_ARB_framebuffer_object (same since
             // GL_ARB_framebuffer_object doesn't use ARB suffix.)
@@ -111,7 +111,10 @@
         '../samplecode/SampleXfermodesBlur.cpp',
         
         # Dependecies for the pipe code in SampleApp
+        '../src/pipe/SkAsyncNWayCanvas.cpp',
+        '../src/pipe/SkGPipeFanOut.cpp',
         '../src/pipe/SkGPipeRead.cpp',
+        '../src/pipe/SkGPipeSharedMemory.cpp',
         '../src/pipe/SkGPipeWrite.cpp',
       ],
       'sources!': [
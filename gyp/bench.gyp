@@ -15,6 +15,11 @@
     {
       'target_name': 'bench',
       'type': 'executable',
+      'include_dirs' : [
+        '../include/pipe', # for the pipe config
+        '../src/core',     # for the kernel benches
+        '../src/effects',
+      ],
       'sources': [
         '../bench/benchmain.cpp',
         '../bench/BenchTimer.h',
@@ -32,17 +37,44 @@
         
         '../bench/SkBenchmark.h',
         '../bench/SkBenchmark.cpp',
+        '../bench/SkpBench.h',
+        '../bench/SkpBench.cpp',
         
         '../bench/BitmapBench.cpp',
+        '../bench/BitmapProcBench.cpp',
+        '../bench/BlitRowBench.cpp',
+        '../bench/BlurBench.cpp',
+        '../bench/ColorMatrixBench.cpp',
+        '../bench/ComposeShaderBench.cpp',
+        '../bench/DashBench.cpp',
         '../bench/DecodeBench.cpp',
         '../bench/FPSBench.cpp',
+        '../bench/GlyphCacheBench.cpp',
         '../bench/GradientBench.cpp',
+        '../bench/LayerBench.cpp',
+        '../bench/MaskFilterBench.cpp',
         '../bench/MatrixBench.cpp',
+        '../bench/NinePatchBench.cpp',
+        '../bench/NWayCanvasBench.cpp',
         '../bench/PathBench.cpp',
+        '../bench/PictureNestBench.cpp',
+        '../bench/RasterizerBench.cpp',
         '../bench/RectBench.cpp',
+        '../bench/RefCntBench.cpp',
+        '../bench/RegionBench.cpp',
         '../bench/RepeatTileBench.cpp',
+        '../bench/SaveLayerBench.cpp',
+        '../bench/SortBench.cpp',
         '../bench/ScalarBench.cpp',
         '../bench/TextBench.cpp',
+        '../bench/VerticesBench.cpp',
+        '../bench/XfermodeBench.cpp',
+
+        # for the pipe config, and SkAsyncNWayCanvas
+        '../src/pipe/SkAsyncNWayCanvas.cpp',
+        '../src/pipe/SkGPipeFanOut.cpp',
+        '../src/pipe/SkGPipeRead.cpp',
+        '../src/pipe/SkGPipeWrite.cpp',
       ],
       'dependencies': [
         'core.gyp:core',
@@ -50,6 +82,7 @@
         'gpu.gyp:gr',
         'gpu.gyp:skgr',
         'images.gyp:images',
+        'pdf.gyp:pdf',
         'utils.gyp:utils',
       ],
       'conditions': [
@@ -15,6 +15,7 @@
         '../src/core/SkAlphaRuns.cpp',
         '../src/core/SkAntiRun.h',
         '../src/core/SkBitmap.cpp',
+        '../src/core/SkBitmapMipMap.h',
         '../src/core/SkBitmapProcShader.cpp',
         '../src/core/SkBitmapProcShader.h',
         '../src/core/SkBitmapProcState.cpp',
@@ -78,13 +79,18 @@
         '../src/core/SkGlobals.cpp',
         '../src/core/SkGlyphCache.cpp',
         '../src/core/SkGlyphCache.h',
+        '../src/core/SkGlyphDiskCache.cpp',
+        '../src/core/SkGlyphDiskCache.h',
         '../src/core/SkGraphics.cpp',
+        '../src/core/SkLayerPool.cpp',
+        '../src/core/SkLayerPool.h',
         '../src/core/SkLineClipper.cpp',
         '../src/core/SkMallocPixelRef.cpp',
         '../src/core/SkMask.cpp',
         '../src/core/SkMaskFilter.cpp',
         '../src/core/SkMath.cpp',
         '../src/core/SkMatrix.cpp',
+        '../src/core/SkMemoryTracker.cpp',
         '../src/core/SkMetaData.cpp',
         '../src/core/SkPackBits.cpp',
         '../src/core/SkPaint.cpp',
@@ -96,14 +102,20 @@
         '../src/core/SkPicture.cpp',
         '../src/core/SkPictureFlat.cpp',
         '../src/core/SkPictureFlat.h',
+        '../src/core/SkPictureIndex.cpp',
+        '../src/core/SkPictureIndex.h',
+        '../src/core/SkPictureMapping.cpp',
+        '../src/core/SkPictureMapping.h',
         '../src/core/SkPicturePlayback.cpp',
         '../src/core/SkPicturePlayback.h',
+        '../src/core/SkPictureProfile.cpp',
         '../src/core/SkPictureRecord.cpp',
         '../src/core/SkPictureRecord.h',
         '../src/core/SkPixelRef.cpp',
         '../src/core/SkPoint.cpp',
         '../src/core/SkProcSpriteBlitter.cpp',
         '../src/core/SkPtrRecorder.cpp',
+        '../src/core/SkPurgeableCache.cpp',
         '../src/core/SkQuadClipper.cpp',
         '../src/core/SkQuadClipper.h',
         '../src/core/SkRasterizer.cpp',
@@ -113,6 +125,8 @@
         '../src/core/SkRegionPriv.h',
         '../src/core/SkRegion_path.cpp',
         '../src/core/SkScalar.cpp',
+        '../src/core/SkScaledBitmapCache.cpp',
+        '../src/core/SkScaledBitmapCache.h',
         '../src/core/SkScalerContext.cpp',
         '../src/core/SkScan.cpp',
         '../src/core/SkScanPriv.h',
@@ -120,6 +134,8 @@
         '../src/core/SkScan_Antihair.cpp',
         '../src/core/SkScan_Hairline.cpp',
         '../src/core/SkScan_Path.cpp',
+        '../src/core/SkScratchAlloc.cpp',
+        '../src/core/SkScratchAlloc.h',
         '../src/core/SkShader.cpp',
         '../src/core/SkShape.cpp',
         '../src/core/SkSpriteBlitter_ARGB32.cpp',
@@ -132,7 +148,11 @@
         '../src/core/SkStroke.cpp',
         '../src/core/SkStrokerPriv.cpp',
         '../src/core/SkStrokerPriv.h',
+        '../src/core/SkTaskGroup.cpp',
+        '../src/core/SkTextBlob.cpp',
         '../src/core/SkTextFormatParams.h',
+        '../src/core/SkTLS.cpp',
+        '../src/core/SkTrace.cpp',
         '../src/core/SkTSearch.cpp',
         '../src/core/SkTSort.h',
         '../src/core/SkTemplatesPriv.h',
@@ -179,6 +199,7 @@
         '../include/core/SkDeque.h',
         '../include/core/SkDescriptor.h',
         '../include/core/SkDevice.h',
+        '../include/core/SkDiscardableMemory.h',
         '../include/core/SkDither.h',
         '../include/core/SkDraw.h',
         '../include/core/SkDrawFilter.h',
@@ -198,6 +219,7 @@
         '../include/core/SkMaskFilter.h',
         '../include/core/SkMath.h',
         '../include/core/SkMatrix.h',
+        '../include/core/SkMemoryTracker.h',
         '../include/core/SkMetaData.h',
         '../include/core/SkOSFile.h',
         '../include/core/SkPackBits.h',
@@ -207,9 +229,11 @@
         '../include/core/SkPathMeasure.h',
         '../include/core/SkPerspIter.h',
         '../include/core/SkPicture.h',
+        '../include/core/SkPictureProfile.h',
         '../include/core/SkPixelRef.h',
         '../include/core/SkPoint.h',
         '../include/core/SkPtrRecorder.h',
+        '../include/core/SkPurgeableCache.h',
         '../include/core/SkRandom.h',
         '../include/core/SkRasterizer.h',
         '../include/core/SkReader32.h',
@@ -217,6 +241,7 @@
         '../include/core/SkRefCnt.h',
         '../include/core/SkRefDict.h',
         '../include/core/SkRegion.h',
+        '../include/core/SkRunnable.h',
         '../include/core/SkScalar.h',
         '../include/core/SkScalarCompare.h',
         '../include/core/SkScalerContext.h',
@@ -232,9 +257,12 @@
         '../include/core/SkTScopedPtr.h',
         '../include/core/SkTSearch.h',
         '../include/core/SkTemplates.h',
+        '../include/core/SkTextBlob.h',
         '../include/core/SkThread.h',
         '../include/core/SkThread_platform.h',
         '../include/core/SkTime.h',
+        '../include/core/SkTLS.h',
+        '../include/core/SkTrace.h',
         '../include/core/SkTypeface.h',
         '../include/core/SkTypes.h',
         '../include/core/SkUnPreMultiply.h',
@@ -246,6 +274,7 @@
       'include_dirs': [
         '../include/config',
         '../include/core',
+        '../include/effects', # for the SkColorMatrixFilter opts
         '../include/ports',
         '../include/xml',
         '../src/core',
@@ -260,6 +289,7 @@
           'sources': [
             '../include/core/SkMMapStream.h',
             '../src/core/SkMMapStream.cpp',
+            '../src/ports/SkDiscardableMemory_posix.cpp',
             '../src/ports/SkThread_pthread.cpp',
             '../src/ports/SkTime_Unix.cpp',
             '../src/ports/SkFontHost_FreeType.cpp',
@@ -284,6 +314,7 @@
             '../src/core/SkMMapStream.cpp',
             '../src/ports/SkFontHost_mac_coretext.cpp',
 
+            '../src/ports/SkDiscardableMemory_posix.cpp',
             '../src/ports/SkThread_pthread.cpp',
             '../src/ports/SkTime_Unix.cpp',
           ],
@@ -299,6 +330,7 @@
             'config/win',
           ],
           'sources': [
+            '../src/ports/SkDiscardableMemory_win.cpp',
             '../src/ports/SkFontHost_win.cpp',
             '../src/ports/SkThread_win.cpp',
           ],
@@ -6,6 +6,9 @@
     {
       'target_name': 'effects',
       'type': 'static_library',
+      'dependencies': [
+        'utils.gyp:utils',
+      ],
       'include_dirs': [
         '../include/config',
         '../include/core',
@@ -33,6 +36,7 @@
         '../include/effects/SkPixelXorXfermode.h',
         '../include/effects/SkPorterDuff.h',
         '../include/effects/SkRectShape.h',
+        '../include/effects/SkTableMaskFilter.h',
         '../include/effects/SkTransparentShader.h',
 
         '../src/effects/Sk1DPathEffect.cpp',
@@ -43,6 +47,8 @@
         '../src/effects/SkBlurDrawLooper.cpp',
         '../src/effects/SkBlurMask.cpp',
         '../src/effects/SkBlurMask.h',
+        '../src/effects/SkBlurMaskCache.cpp',
+        '../src/effects/SkBlurMaskCache.h',
         '../src/effects/SkBlurMaskFilter.cpp',
         '../src/effects/SkColorFilters.cpp',
         '../src/effects/SkColorMatrixFilter.cpp',
@@ -63,6 +69,7 @@
         '../src/effects/SkPorterDuff.cpp',
         '../src/effects/SkRadialGradient_Table.h',
         '../src/effects/SkRectShape.cpp',
+        '../src/effects/SkTableMaskFilter.cpp',
         '../src/effects/SkTransparentShader.cpp',
       ],
       'direct_dependent_settings': {
@@ -26,6 +26,8 @@
         '../src/gpu/SkGr.cpp',
         '../src/gpu/SkGrFontScaler.cpp',
         '../src/gpu/SkGrTexturePixelRef.cpp',
+        '../src/gpu/SkTextureCompressor.cpp',
+        '../src/gpu/SkTextureCompressor.h',
       ],
       'conditions': [
           [ 'OS == "linux"', {
@@ -88,6 +90,7 @@
         '../gpu/include/GrConfig.h',
         '../gpu/include/GrContext.h',
         '../gpu/include/GrContext_impl.h',
+        '../gpu/include/GrConvexPathRenderer.h',
         '../gpu/include/GrDrawTarget.h',
         '../gpu/include/GrFontScaler.h',
         '../gpu/include/GrGeometryBuffer.h',
@@ -95,6 +98,7 @@
         '../gpu/include/GrGLConfig_chrome.h',
         '../gpu/include/GrGLIndexBuffer.h',
         '../gpu/include/GrGLInterface.h',
+        '../gpu/include/GrGLProgramBinaryStore.h',
         '../gpu/include/GrGLIRect.h',
         '../gpu/include/GrGLTexture.h',
         '../gpu/include/GrGLVertexBuffer.h',
@@ -105,6 +109,7 @@
         '../gpu/include/GrInOrderDrawBuffer.h',
         '../gpu/include/GrInstanceCounter.h',
         '../gpu/include/GrIPoint.h',
+        '../gpu/include/GrImageAtlas.h',
         '../gpu/include/GrKey.h',
         '../gpu/include/GrMatrix.h',
         '../gpu/include/GrMemory.h',
@@ -114,12 +119,14 @@
         '../gpu/include/GrPath.h',
         '../gpu/include/GrPathRenderer.h',
         '../gpu/include/GrPathSink.h',
+        '../gpu/include/GrPixelRead.h',
         '../gpu/include/GrPlotMgr.h',
         '../gpu/include/GrPoint.h',
         '../gpu/include/GrRandom.h',
         '../gpu/include/GrRect.h',
         '../gpu/include/GrRectanizer.h',
         '../gpu/include/GrRefCnt.h',
+        '../gpu/include/GrRenderTargetPool.h',
         '../gpu/include/GrResource.h',
         '../gpu/include/GrSamplerState.h',
         '../gpu/include/GrScalar.h',
@@ -147,6 +154,7 @@
         '../gpu/src/GrBufferAllocPool.h',
         '../gpu/src/GrClip.cpp',
         '../gpu/src/GrContext.cpp',
+        '../gpu/src/GrConvexPathRenderer.cpp',
         '../gpu/src/GrCreatePathRenderer_none.cpp',
         '../gpu/src/GrDrawTarget.cpp',
         '../gpu/src/GrGLDefaultInterface_none.cpp',
@@ -154,6 +162,7 @@
         '../gpu/src/GrGLInterface.cpp',
         '../gpu/src/GrGLProgram.cpp',
         '../gpu/src/GrGLProgram.h',
+        '../gpu/src/GrGLProgramBinaryStore.cpp',
         '../gpu/src/GrGLTexture.cpp',
         '../gpu/src/GrGLUtil.cpp',
         '../gpu/src/GrGLVertexBuffer.cpp',
@@ -165,14 +174,16 @@
         '../gpu/src/GrGpuGLFixed.h',
         '../gpu/src/GrGpuGLShaders.cpp',
         '../gpu/src/GrGpuGLShaders.h',
+        '../gpu/src/GrImageAtlas.cpp',
         '../gpu/src/GrInOrderDrawBuffer.cpp',
         '../gpu/src/GrMatrix.cpp',
         '../gpu/src/GrMemory.cpp',
         '../gpu/src/GrPathRenderer.cpp',
         '../gpu/src/GrPathUtils.cpp',
         '../gpu/src/GrPathUtils.h',
-        '../gpu/src/GrRectanizer.cpp',
+        '../gpu/src/GrRectanizer_skyline.cpp',
         '../gpu/src/GrRedBlackTree.h',
+        '../gpu/src/GrRenderTargetPool.cpp',
         '../gpu/src/GrResource.cpp',
         '../gpu/src/GrStencil.cpp',
         '../gpu/src/GrTesselatedPathRenderer.cpp',
@@ -183,6 +194,8 @@
         '../gpu/src/GrTextureCache.cpp',
         '../gpu/src/gr_unittests.cpp',
 
+        '../gpu/src/egl/GrGLDefaultInterface_egl.cpp',
+
         '../gpu/src/mac/GrGLDefaultInterface_mac.cpp',
 
         '../gpu/src/win/GrGLDefaultInterface_win.cpp',
@@ -192,6 +205,7 @@
         '../gpu/src/mesa/GrGLDefaultInterface_mesa.cpp',
       ],
       'sources!': [
+        '../gpu/src/egl/GrGLDefaultInterface_egl.cpp',
         '../gpu/src/mesa/GrGLDefaultInterface_mesa.cpp',
       ],
       'defines': [
@@ -15,10 +15,13 @@
         '../include/images',
       ],
       'sources': [
+        '../include/images/SkCreateRLEPixelRef.h',
         '../include/images/SkFlipPixelRef.h',
+        '../include/images/SkImageDecodeQueue.h',
         '../include/images/SkImageDecoder.h',
         '../include/images/SkImageEncoder.h',
         '../include/images/SkImageRef.h',
+        '../include/images/SkImageRef_Discardable.h',
         '../include/images/SkImageRef_GlobalPool.h',
         '../include/images/SkJpegUtility.h',
         '../include/images/SkMovie.h',
@@ -30,6 +33,7 @@
         '../src/images/SkCreateRLEPixelRef.cpp',
         '../src/images/SkFDStream.cpp',
         '../src/images/SkFlipPixelRef.cpp',
+        '../src/images/SkImageDecodeQueue.cpp',
         '../src/images/SkImageDecoder.cpp',
         '../src/images/SkImageDecoder_Factory.cpp',
         '../src/images/SkImageDecoder_libbmp.cpp',
@@ -43,6 +47,7 @@
         '../src/images/SkImageRef.cpp',
         '../src/images/SkImageRefPool.cpp',
         '../src/images/SkImageRefPool.h',
+        '../src/images/SkImageRef_Discardable.cpp',
         '../src/images/SkImageRef_GlobalPool.cpp',
         '../src/images/SkJpegUtility.cpp',
         '../src/images/SkMovie.cpp',
@@ -112,6 +117,7 @@
             ],
             'libraries': [
               '-lpng',
+              '-lz',
             ],
           },
           # end libpng stuff
@@ -27,6 +27,7 @@
       'include_dirs': [
         '../include/config',
         '../include/core',
+        '../include/effects',
         '../src/core',
       ],
       'conditions': [
@@ -37,8 +38,11 @@
         }],
       ],
       'sources': [
+        '../src/opts/SkAvoidXfermode_opts_SSE2.cpp',
         '../src/opts/SkBitmapProcState_opts_SSE2.cpp',
         '../src/opts/SkBlitRow_opts_SSE2.cpp',
+        '../src/opts/SkColorMatrixFilter_opts_SSE2.cpp',
+        '../src/opts/SkMatrix_opts_SSE2.cpp',
         '../src/opts/SkUtils_opts_SSE2.cpp',
       ],
     },
@@ -50,6 +50,7 @@
         ],
       },
       'dependencies': [
+        'utils.gyp:utils',
         'zlib.gyp:zlib',
       ],
     },
@@ -18,6 +18,7 @@
         '../include/svg/SkSVGBase.h',
         '../include/svg/SkSVGPaintState.h',
         '../include/svg/SkSVGParser.h',
+        '../include/svg/SkSVGPicture.h',
         '../include/svg/SkSVGTypes.h',
 
         '../src/svg/SkSVGCircle.cpp',
@@ -54,6 +55,7 @@
         '../src/svg/SkSVGParser.cpp',
         '../src/svg/SkSVGPath.cpp',
         '../src/svg/SkSVGPath.h',
+        '../src/svg/SkSVGPicture.cpp',
         '../src/svg/SkSVGPolygon.cpp',
         '../src/svg/SkSVGPolygon.h',
         '../src/svg/SkSVGPolyline.cpp',
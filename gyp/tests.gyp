@@ -10,28 +10,59 @@
       'type': 'executable',
       'include_dirs' : [
         '../src/core',
+        '../src/effects',
+        '../src/images',
       ],
       'sources': [
+        '../tests/AAClipTest.cpp',
+        '../tests/AnalyticAATest.cpp',
+        '../tests/BMPDecodeTest.cpp',
         '../tests/BitmapCopyTest.cpp',
         '../tests/BitmapGetColorTest.cpp',
+        '../tests/BitmapProcStateTest.cpp',
+        '../tests/BitmapScrollTest.cpp',
         '../tests/BlitRowTest.cpp',
+        '../tests/BlurTest.cpp',
+        '../tests/BoundsDeviceTest.cpp',
+        '../tests/CaptureCanvasTest.cpp',
         '../tests/ClampRangeTest.cpp',
         '../tests/ClipCubicTest.cpp',
         '../tests/ClipStackTest.cpp',
         '../tests/ClipperTest.cpp',
         '../tests/ColorFilterTest.cpp',
         '../tests/ColorTest.cpp',
+        '../tests/ComposeShaderTest.cpp',
+        '../tests/DashPathEffectTest.cpp',
         '../tests/DataRefTest.cpp',
+        '../tests/DecodeRegionTest.cpp',
+        '../tests/DeferredDeviceTest.cpp',
         '../tests/DequeTest.cpp',
+        '../tests/DiscardableMemoryTest.cpp',
         '../tests/DrawBitmapRectTest.cpp',
         '../tests/FillPathTest.cpp',
         '../tests/FlateTest.cpp',
+        '../tests/FlipPixelRefTest.cpp',
+        '../tests/FlattenableTest.cpp',
         '../tests/GeometryTest.cpp',
+        '../tests/GlyphCacheTest.cpp',
+        '../tests/GradientTest.cpp',
+        '../tests/ImageDecodeQueueTest.cpp',
+        '../tests/ImageRefPoolTest.cpp',
+        '../tests/IncrementalDecodeTest.cpp',
+        '../tests/Index8Test.cpp',
         '../tests/InfRectTest.cpp',
+        '../tests/InterpolatorTest.cpp',
+        '../tests/LayerPoolTest.cpp',
+        '../tests/LayerRasterizerTest.cpp',
+        '../tests/LayerTest.cpp',
+        '../tests/MaskFilterTest.cpp',
         '../tests/MathTest.cpp',
         '../tests/MatrixTest.cpp',
         '../tests/Matrix44Test.cpp',
+        '../tests/MemoryTrackerTest.cpp',
         '../tests/MetaDataTest.cpp',
+        '../tests/MipMapTest.cpp',
+        '../tests/NinePatchTest.cpp',
         '../tests/PackBitsTest.cpp',
         '../tests/PaintTest.cpp',
         '../tests/ParsePathTest.cpp',
@@ -39,18 +70,39 @@
         '../tests/PathMeasureTest.cpp',
         '../tests/PathTest.cpp',
         '../tests/PDFPrimitivesTest.cpp',
+        '../tests/PNGEncodeTest.cpp',
+        '../tests/PictureIndexTest.cpp',
+        '../tests/PictureMappingTest.cpp',
+        '../tests/PictureOverdrawTest.cpp',
+        '../tests/PictureProfileTest.cpp',
+        '../tests/PictureRecordTest.cpp',
+        '../tests/PictureTilerTest.cpp',
+        '../tests/PixelRefTest.cpp',
         '../tests/PointTest.cpp',
+        '../tests/PurgeableCacheTest.cpp',
+        '../tests/QuickRejectTest.cpp',
         '../tests/Reader32Test.cpp',
         '../tests/RefDictTest.cpp',
         '../tests/RegionTest.cpp',
+        '../tests/ScaledBitmapCacheTest.cpp',
+        '../tests/ScaledBitmapSamplerTest.cpp',
+        '../tests/ScratchAllocTest.cpp',
         '../tests/Sk64Test.cpp',
         '../tests/skia_test.cpp',
         '../tests/SortTest.cpp',
+        '../tests/SpriteBlitterTest.cpp',
         '../tests/SrcOverTest.cpp',
         '../tests/StreamTest.cpp',
         '../tests/StringTest.cpp',
+        '../tests/TDArrayTest.cpp',
+        '../tests/TaskGroupTest.cpp',
         '../tests/Test.cpp',
+        '../tests/TextBlobTest.cpp',
+        '../tests/ThinStrokeTest.cpp',
+        '../tests/TraceTest.cpp',
         '../tests/TestSize.cpp',
+        '../tests/TriangulationTest.cpp',
+        '../tests/TypefaceCacheTest.cpp',
         '../tests/UtilsTest.cpp',
         '../tests/Writer32Test.cpp',
         '../tests/XfermodeTest.cpp',
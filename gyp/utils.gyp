@@ -19,9 +19,12 @@
       ],
       'sources': [
         '../include/utils/SkBoundaryPatch.h',
+        '../include/utils/SkBoundsDevice.h',
         '../include/utils/SkCamera.h',
+        '../include/utils/SkCaptureCanvas.h',
         '../include/utils/SkCubicInterval.h',
         '../include/utils/SkCullPoints.h',
+        '../include/utils/SkDeferredDevice.h',
         '../include/utils/SkDumpCanvas.h',
         '../include/utils/SkEGLContext.h',
         '../include/utils/SkGLCanvas.h',
@@ -31,19 +34,26 @@
         '../include/utils/SkMeshUtils.h',
         '../include/utils/SkNinePatch.h',
         '../include/utils/SkNWayCanvas.h',
+        '../include/utils/SkOverdrawDevice.h',
         '../include/utils/SkParse.h',
         '../include/utils/SkParsePaint.h',
         '../include/utils/SkParsePath.h',
+        '../include/utils/SkPictureTiler.h',
         '../include/utils/SkProxyCanvas.h',
+        '../include/utils/SkReadAheadStream.h',
         '../include/utils/SkSfntUtils.h',
         '../include/utils/SkTextBox.h',
+        '../include/utils/SkThreadPool.h',
         '../include/utils/SkUnitMappers.h',
 
         '../src/utils/SkBoundaryPatch.cpp',
+        '../src/utils/SkBoundsDevice.cpp',
         '../src/utils/SkCamera.cpp',
+        '../src/utils/SkCaptureCanvas.cpp',
         '../src/utils/SkColorMatrix.cpp',
         '../src/utils/SkCubicInterval.cpp',
         '../src/utils/SkCullPoints.cpp',
+        '../src/utils/SkDeferredDevice.cpp',
         '../src/utils/SkDumpCanvas.cpp',
         '../src/utils/SkEGLContext_none.cpp',
         '../src/utils/SkInterpolator.cpp',
@@ -53,13 +63,20 @@
         '../src/utils/SkNinePatch.cpp',
         '../src/utils/SkNWayCanvas.cpp',
         '../src/utils/SkOSFile.cpp',
+        '../src/utils/SkOverdrawDevice.cpp',
         '../src/utils/SkParse.cpp',
         '../src/utils/SkParseColor.cpp',
         '../src/utils/SkParsePath.cpp',
+        '../src/utils/SkPictureTiler.cpp',
         '../src/utils/SkProxyCanvas.cpp',
+        '../src/utils/SkReadAheadStream.cpp',
         '../src/utils/SkSfntUtils.cpp',
+        '../src/utils/SkThreadPool.cpp',
         '../src/utils/SkUnitMappers.cpp',
 
+        #egl
+        '../src/utils/egl/SkEGLContext_EGL.cpp',
+
         #mac
         '../include/utils/mac/SkCGUtils.h',
         '../src/utils/mac/SkCreateCGImageRef.cpp',
@@ -89,6 +106,7 @@
         '../src/utils/win/SkOSWindow_Win.cpp',
       ],
       'sources!': [
+          '../src/utils/egl/SkEGLContext_EGL.cpp',
           '../src/utils/mesa/SkEGLContext_Mesa.cpp',
           '../src/utils/SDL/SkOSWindow_SDL.cpp',
       ],
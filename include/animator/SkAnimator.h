@@ -17,6 +17,7 @@
 #ifndef SkAnimator_DEFINED
 #define SkAnimator_DEFINED
 
+#include "SkColor.h"
 #include "SkScalar.h"
 #include "SkKey.h"
 #include "SkEventSink.h"
@@ -31,6 +32,7 @@ class SkPaint;
 struct SkRect;
 class SkStream;
 class SkTypedArray;
+class SkWStream;
 class SkXMLParserError;
 class SkDOM;
 struct SkDOMNode;
@@ -107,6 +109,7 @@ public:
     /** Read in XML from memory. Returns true if the file can be 
         read without error. Returns false if an error was encountered.
         Error diagnostics are stored in fErrorCode and fLineNumber.
+        The buffer may also hold a document written by precompile().
         @param buffer  The XML text as UTF-8 characters.
         @param size  The XML text length in bytes.
         @return true if the XML was parsed successfully.
@@ -116,6 +119,8 @@ public:
     /** Read in XML from a stream. Returns true if the file can be 
         read without error. Returns false if an error was encountered.
         Error diagnostics are stored in fErrorCode and fLineNumber.
+        A document written by precompile() is also read, if the stream
+        has a memory base (e.g. SkMemoryStream or SkMMAPStream).
         @param stream  The stream containg the XML text as UTF-8 characters.
         @return true if the XML was parsed successfully.
     */
@@ -136,6 +141,19 @@ public:
     */
     bool decodeURI(const char uri[]);
 
+    /** Read in XML from memory, like decodeMemory(), and write a precompiled
+        form of it to dst. Decoding the precompiled form skips parsing the XML
+        and looking up element and attribute names, and starts out with the
+        scripts that were compiled while the XML was read. It can only be
+        decoded by the same build of the library that wrote it, and documents
+        it includes are still read as XML.
+        @param buffer  The XML text as UTF-8 characters.
+        @param size  The XML text length in bytes.
+        @param dst  The stream to write the precompiled document to.
+        @return true if the XML was parsed and written successfully.
+    */
+    bool precompile(const void* buffer, size_t size, SkWStream* dst);
+
     /** Pass a char event, usually a keyboard symbol, to the animator.
         This triggers events of the form <event kind="keyChar" key="... />
         @param ch  The character to match against <event> element "key" 
@@ -204,6 +222,23 @@ public:
     */
     DifferenceType draw(SkCanvas* canvas, SkMSec time);
 
+    /** Experimental:
+        Sets whether draw() repaints only the parts of the canvas that have
+        changed since the previous call. Each top-level element is recorded
+        into a picture; elements that can only change by being animated or
+        set are kept as pictures until they are, and the union of the bounds
+        they drew before and draw now is erased to eraseColor and repainted,
+        from the pictures. When draw() returns anything but kNotDifferent,
+        getInvalBounds() returns what was repainted.
+        The canvas must keep its pixels from one call to the next (e.g. an
+        offscreen bitmap), and <bounds>, <hitTest> and <snapshot> elements
+        don't see the canvas, so they should not be used in this mode.
+        @param incremental true to repaint only what has changed
+        @param eraseColor what to fill the repainted area with first, by
+               default transparent
+    */
+    void setIncrementalDraw(bool incremental, SkColor eraseColor = 0);
+
     /** Experimental:
         Helper to choose whether to return a SkView::Click handler.
         @param x ignored
@@ -141,6 +141,18 @@
  */
 //#define SK_ALLOW_OVER_32K_BITMAPS
 
+/*  Define this to compile the SK_TRACE_ counters and events (see SkTrace.h)
+    into the hot paths. Without it they compile to nothing.
+ */
+//#define SK_ENABLE_TRACE
+
+/*  Define this to have sk_malloc, sk_realloc and sk_free count the bytes and
+    blocks they hand out, in all and for each call site (see
+    SkMemoryTracker.h). It adds a header to every block, and takes a lock on
+    every call.
+ */
+//#define SK_ENABLE_MEMORY_TRACKING
+
 /*  If SK_DEBUG is defined, then you can optionally define SK_SUPPORT_UNITTEST
     which will run additional self-tests at startup. These can take a long time,
     so this flag is optional.
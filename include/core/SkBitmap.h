@@ -482,6 +482,12 @@ public:
     bool canCopyTo(Config newConfig) const;
 
     bool hasMipMap() const;
+    /** Build the mip levels (each half the size of the one above it) for our
+        pixels, if the config supports them (8888, 565 and 4444). If the
+        pixels belong to a pixelref, the levels are cached on it, so that
+        other bitmaps that share those pixels (and generation ID) share the
+        levels rather than building them again.
+     */
     void buildMipMap(bool forceRebuild = false);
     void freeMipMap();
 
@@ -566,6 +572,7 @@ public:
 private:
     struct MipMap;
     mutable MipMap* fMipMap;
+    friend class SkPixelRef;    // caches our MipMap
 
     mutable SkPixelRef* fPixelRef;
     mutable size_t      fPixelRefOffset;
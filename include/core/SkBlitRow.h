@@ -66,6 +66,41 @@ public:
 
     static ColorProc ColorProcFactory();
 
+    /** Function pointer that blends a single color onto a row of 32-bit
+        pixels, scaling it by a separate coverage value for each pixel.
+        Pixels whose coverage is 0 are left unchanged.
+     */
+    typedef void (*ColorAAProc)(SkPMColor dst[], const SkAlpha aa[], int count,
+                                SkPMColor color);
+
+    static void ColorAA32(SkPMColor dst[], const SkAlpha aa[], int count,
+                          SkPMColor color);
+
+    static ColorAAProc ColorAAProcFactory();
+
+    /** Function pointer that blends alpha onto a row of kA8 pixels, scaled
+        by a separate coverage value for each pixel, or by none if aa is NULL.
+        Pixels whose coverage is 0 are left unchanged.
+     */
+    typedef void (*ColorA8Proc)(uint8_t dst[], const SkAlpha aa[], int count,
+                                U8CPU alpha);
+
+    static void ColorA8(uint8_t dst[], const SkAlpha aa[], int count,
+                        U8CPU alpha);
+
+    static ColorA8Proc ColorA8ProcFactory();
+
+    /** As ColorA8Proc, but with an alpha for each pixel in src, e.g. from
+        SkShader::shadeSpanAlpha().
+     */
+    typedef void (*AlphaA8Proc)(uint8_t dst[], const SkAlpha src[],
+                                const SkAlpha aa[], int count);
+
+    static void AlphaA8(uint8_t dst[], const SkAlpha src[], const SkAlpha aa[],
+                        int count);
+
+    static AlphaA8Proc AlphaA8ProcFactory();
+
     /** These static functions are called by the Factory and Factory32
         functions, and should return either NULL, or a
         platform-specific function-ptr to be used in place of the
@@ -76,6 +111,9 @@ public:
     static Proc PlatformProcs565(unsigned flags);
     static Proc PlatformProcs4444(unsigned flags);
     static ColorProc PlatformColorProc();
+    static ColorAAProc PlatformColorAAProc();
+    static ColorA8Proc PlatformColorA8Proc();
+    static AlphaA8Proc PlatformAlphaA8Proc();
 
 private:
     enum {
@@ -106,6 +144,25 @@ public:
      * or NULL if no optimized
      */
     static Proc PlatformProcs(SkBitmap::Config dstConfig, SkColor color);
+
+    /**
+     *  Function pointers that blit a row of an LCD mask (kLCD16_Format or
+     *  kLCD32_Format, i.e. a coverage for each of r, g and b) into a row of
+     *  8888 pixels, colorized by color. The color's alpha is ignored.
+     */
+    typedef void (*LCD16RowProc)(SkPMColor dst[], const uint16_t mask[],
+                                 SkPMColor color, int width);
+    typedef void (*LCD32RowProc)(SkPMColor dst[], const uint32_t mask[],
+                                 SkPMColor color, int width);
+
+    static LCD16RowProc LCD16RowFactory();
+    static LCD32RowProc LCD32RowFactory();
+
+    /* return either platform specific optimized LCD row function-ptrs,
+     * or NULL if no optimized
+     */
+    static LCD16RowProc PlatformLCD16RowProc();
+    static LCD32RowProc PlatformLCD32RowProc();
 };
 
 
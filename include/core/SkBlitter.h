@@ -36,6 +36,13 @@ public:
     virtual void blitRect(int x, int y, int width, int height);
     virtual void blitMask(const SkMask&, const SkIRect& clip);
 
+    /*  Blits count masks, each within its clip, as that many calls to
+        blitMask() would. Text hands over its glyphs a run at a time this way,
+        so that blitters can dispatch once for all of them.
+    */
+    virtual void blitMasks(const SkMask masks[], const SkIRect clips[],
+                           int count);
+
     /*  If the blitter just sets a single value for each pixel, return the
         bitmap it draws into, and assign value. If not, return NULL and ignore
         the value parameter.
@@ -130,6 +137,54 @@ private:
     const SkRegion* fRgn;
 };
 
+/** Wraps another (real) blitter, and modulates everything it is asked to
+    blit by the coverage in an A8 clip mask (e.g. an antialiased clip), so the
+    real blitter is only called with antialiased spans and masks. Nothing
+    outside the mask's bounds is blitted.
+*/
+class SkMaskClipBlitter : public SkBlitter {
+public:
+    void init(SkBlitter* blitter, const SkMask* clipMask);
+
+    // overrides
+    virtual void blitH(int x, int y, int width);
+    virtual void blitAntiH(int x, int y, const SkAlpha[], const int16_t runs[]);
+    virtual void blitV(int x, int y, int height, SkAlpha alpha);
+    virtual void blitRect(int x, int y, int width, int height);
+    virtual void blitMask(const SkMask&, const SkIRect& clip);
+    virtual const SkBitmap* justAnOpaqueColor(uint32_t* value);
+
+private:
+    SkBlitter*      fBlitter;
+    const SkMask*   fClipMask;
+    // a row of runs and coverage, as wide as fClipMask
+    int16_t*        fRuns;
+    SkAlpha*        fAA;
+    SkAutoSMalloc<512> fStorage;
+
+    void blitCoverage(int x, int y, int width);
+};
+
+/** Wraps another (real) blitter, and adds what it is asked to blit to the
+    blitter.pixels.* trace counters (see SkTrace.h), which only count if
+    SK_ENABLE_TRACE is defined.
+*/
+class SkTraceBlitter : public SkBlitter {
+public:
+    void init(SkBlitter* blitter) { fBlitter = blitter; }
+
+    // overrides
+    virtual void blitH(int x, int y, int width);
+    virtual void blitAntiH(int x, int y, const SkAlpha[], const int16_t runs[]);
+    virtual void blitV(int x, int y, int height, SkAlpha alpha);
+    virtual void blitRect(int x, int y, int width, int height);
+    virtual void blitMask(const SkMask&, const SkIRect& clip);
+    virtual const SkBitmap* justAnOpaqueColor(uint32_t* value);
+
+private:
+    SkBlitter*  fBlitter;
+};
+
 class SkBlitterClipper {
 public:
     SkBlitter*  apply(SkBlitter* blitter, const SkRegion* clip,
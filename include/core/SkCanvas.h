@@ -33,7 +33,9 @@ class SkDevice;
 class SkDeviceFactory;
 class SkDraw;
 class SkDrawFilter;
+class SkExecutor;
 class SkPicture;
+class SkTextBlob;
 
 /** \class SkCanvas
 
@@ -277,13 +279,24 @@ public:
     virtual bool clipRect(const SkRect& rect,
                           SkRegion::Op op = SkRegion::kIntersect_Op);
 
-    /** Modify the current clip with the specified path.
+    /** Modify the current clip with the specified path. Intersecting with
+        (or replacing the clip with) a path is deferred until something needs
+        the clip, so in those cases this can return true for a clip that turns
+        out to be empty.
+
+        If doAntiAlias is true, the clip's edges along the path are
+        antialiased when drawing into a bitmap: what is drawn is modulated by
+        an 8-bit coverage mask of the clip, which is built (and cached for the
+        clip) the first time something is drawn through it. Other devices may
+        clip to the aliased path instead.
         @param path The path to apply to the current clip
         @param op The region op to apply to the current clip
-        @return true if the canvas' new clip is non-empty
+        @param doAntiAlias true if the clip's edges should be antialiased
+        @return true if the canvas' new clip may be non-empty
     */
     virtual bool clipPath(const SkPath& path,
-                          SkRegion::Op op = SkRegion::kIntersect_Op);
+                          SkRegion::Op op = SkRegion::kIntersect_Op,
+                          bool doAntiAlias = false);
 
     /** Modify the current clip with the specified region. Note that unlike
         clipRect() and clipPath() which transform their arguments by the current
@@ -362,7 +375,9 @@ public:
     /** Return the bounds of the current clip (in local coordinates) in the
         bounds parameter, and return true if it is non-empty. This can be useful
         in a way similar to quickReject, in that it tells you that drawing
-        outside of these bounds will be clipped out.
+        outside of these bounds will be clipped out. While paths that were
+        intersected with the clip are still deferred, the bounds may be larger
+        than the clip.
     */
     bool getClipBounds(SkRect* bounds, EdgeType et = kAA_EdgeType) const;
 
@@ -620,6 +635,17 @@ public:
                               const SkScalar xpos[], SkScalar constY,
                               const SkPaint& paint);
 
+    /** Draw the glyphs of the blob, with the blob's origin at (x,y). The font
+        attributes recorded in the blob replace those of the paint, so the
+        text is neither converted to glyphs nor measured again.
+        @param blob     The glyphs and positions to be drawn
+        @param x        The x-coordinate of the blob's origin
+        @param y        The y-coordinate of the blob's origin
+        @param paint    The paint used for the text (e.g. color, shader)
+    */
+    virtual void drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                              const SkPaint& paint);
+
     /** Draw the text, with origin at (x,y), using the specified paint, along
         the specified path. The paint's Align setting determins where along the
         path to start the text.
@@ -748,6 +774,23 @@ public:
     */
     virtual SkDrawFilter* setDrawFilter(SkDrawFilter* filter);
 
+    /** Get the current executor (or NULL).
+        @return the canvas' executor (or NULL).
+    */
+    SkExecutor* getExecutor() const { return fExecutor; }
+
+    /** Set an executor (or NULL) whose threads large paths may be filled on,
+        in bands, as well as the caller's. What is drawn is the same as
+        without one. The canvas does not own the executor, which must outlive
+        its use by the canvas.
+        @param executor the new executor (or NULL)
+        @return the new executor
+    */
+    SkExecutor* setExecutor(SkExecutor* executor) {
+        fExecutor = executor;
+        return executor;
+    }
+
     //////////////////////////////////////////////////////////////////////////
 
     /** Return the current matrix on the canvas.
@@ -826,6 +869,7 @@ private:
     uint32_t    fMCRecStorage[32];
 
     SkBounder*  fBounder;
+    SkExecutor* fExecutor;
     SkDevice*   fLastDeviceToGainFocus;
     SkDeviceFactory* fDeviceFactory;
 
@@ -880,6 +924,22 @@ private:
     }
     void computeLocalClipBoundsCompareType(EdgeType et) const;
 
+    /*  These cache the clip bounds in device coordinates, which stay the same
+        when the matrix changes, as it does for every child of a scroll view.
+     */
+    mutable SkRect  fDeviceClipBounds;
+    mutable SkRect  fDeviceClipBoundsBW;
+    mutable bool    fDeviceClipBoundsDirty;
+
+    const SkRect& getDeviceClipBounds(EdgeType et) const {
+        if (fDeviceClipBoundsDirty) {
+            this->computeDeviceClipBounds();
+            fDeviceClipBoundsDirty = false;
+        }
+        return et == kAA_EdgeType ? fDeviceClipBounds : fDeviceClipBoundsBW;
+    }
+    void computeDeviceClipBounds() const;
+
     SkMatrix    fExternalMatrix, fExternalInverse;
     bool        fUseExternalMatrix;
 
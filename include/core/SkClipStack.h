@@ -30,7 +30,8 @@ public:
         this->clipDevRect(r, op);
     }
     void clipDevRect(const SkRect&, SkRegion::Op = SkRegion::kIntersect_Op);
-    void clipDevPath(const SkPath&, SkRegion::Op = SkRegion::kIntersect_Op);
+    void clipDevPath(const SkPath&, SkRegion::Op = SkRegion::kIntersect_Op,
+                     bool doAntiAlias = false);
 
     class B2FIter {
     public:
@@ -42,12 +43,14 @@ public:
         B2FIter(const SkClipStack& stack);
 
         struct Clip {
-            Clip() : fRect(NULL), fPath(NULL), fOp(SkRegion::kIntersect_Op) {}
+            Clip() : fRect(NULL), fPath(NULL), fOp(SkRegion::kIntersect_Op),
+                     fDoAA(false) {}
             friend bool operator==(const Clip& a, const Clip& b);
             friend bool operator!=(const Clip& a, const Clip& b);
             const SkRect*   fRect;  // if non-null, this is a rect clip
             const SkPath*   fPath;  // if non-null, this is a path clip
             SkRegion::Op    fOp;
+            bool            fDoAA;  // the path's edges are antialiased
         };
 
         /**
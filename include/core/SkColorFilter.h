@@ -30,6 +30,13 @@ public:
      */
     virtual bool asColorMode(SkColor* color, SkXfermode::Mode* mode);
 
+    /**
+     *  If the filter can be represented by a 5x4 color matrix (see
+     *  SkColorMatrix), this returns true, and sets the matrix appropriately.
+     *  If not, this returns false and ignores the parameter.
+     */
+    virtual bool asColorMatrix(SkScalar matrix[20]);
+
     /** Called with a scanline of colors, as if there was a shader installed.
         The implementation writes out its filtered version into result[].
         Note: shader and result may be the same buffer.
@@ -73,6 +80,13 @@ public:
      */
     SkColor filterColor(SkColor);
 
+    /**
+     *  Like filterColor(), but only succeeds if the filtered color survives
+     *  the trip back to an SkColor, i.e. if drawing with the returned color
+     *  draws exactly what filtering the original color draws. If not, this
+     *  returns false and result is left unchanged.
+     */
+    bool filterColorExact(SkColor, SkColor* result);
 
     /** Create a colorfilter that uses the specified color and mode.
         If the Mode is DST, this function will return NULL (since that
@@ -100,6 +114,17 @@ public:
     */
     static SkColorFilter* CreateLightingFilter(SkColor mul, SkColor add);
 
+    /** Create a colorfilter that applies inner, and then outer, to each color.
+        Where it can, this returns a single filter that does both at once
+        instead: for an inner filter that always makes the same color, the
+        outer one is applied to that color here, and two color matrices are
+        concatenated (the result of which can differ by a rounding step from
+        applying them in turn, and doesn't pin the color in between).
+        If either filter is NULL, this returns the other one (ref'd).
+    */
+    static SkColorFilter* CreateComposeFilter(SkColorFilter* outer,
+                                              SkColorFilter* inner);
+
 protected:
     SkColorFilter() {}
     SkColorFilter(SkFlattenableReadBuffer& rb) : INHERITED(rb) {}
@@ -17,9 +17,9 @@
 #ifndef SkComposeShader_DEFINED
 #define SkComposeShader_DEFINED
 
+#include "SkBlitRow.h"
 #include "SkShader.h"
-
-class SkXfermode;
+#include "SkXfermode.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
@@ -60,6 +60,20 @@ private:
     SkShader*   fShaderB;
     SkXfermode* fMode;
 
+    // Chosen by setContext(), see chooseProcs(). If fPassShader is set, the
+    // composition comes out as just that shader's colors. If shader B is a
+    // solid color (fFoldedB), we don't shade it, but apply fModeProc to A's
+    // colors with fColorB. Otherwise these are what we combine the two with,
+    // instead of fMode->xfer32(), if the mode is one we know.
+    SkShader*           fPassShader;
+    bool                fFoldedB;
+    SkPMColor           fColorB;
+    SkXfermodeProc      fModeProc;
+    SkXfermode::Proc32  fModeProc32;
+    SkBlitRow::Proc32   fSrcOverProc32;
+
+    void chooseProcs();
+
     typedef SkShader INHERITED;
 };
 
@@ -247,6 +247,11 @@ public:
     virtual void drawPosText(const SkDraw&, const void* text, size_t len,
                              const SkScalar pos[], SkScalar constY,
                              int scalarsPerPos, const SkPaint& paint);
+    /** The paint already has the blob's font applied. The default draws the
+        blob's glyphs through drawPosText().
+     */
+    virtual void drawTextBlob(const SkDraw&, const SkTextBlob* blob,
+                              SkScalar x, SkScalar y, const SkPaint& paint);
     virtual void drawTextOnPath(const SkDraw&, const void* text, size_t len,
                                 const SkPath& path, const SkMatrix* matrix,
                                 const SkPaint& paint);
@@ -300,6 +305,14 @@ protected:
     */
     virtual void onAccessBitmap(SkBitmap*);
 
+    /** Called instead of onAccessBitmap() when the canvas is about to hand the
+        bitmap to one of this device's own draw methods, rather than to a
+        caller that will examine the pixels. The default calls
+        onAccessBitmap(). A device that defers its drawing can override this
+        to leave its pending draws alone.
+    */
+    virtual void onAccessBitmapForDraw(SkBitmap*);
+
     enum Usage {
        kGeneral_Usage,
        kSaveLayer_Usage, // <! internal use only
@@ -321,6 +334,9 @@ protected:
 
 private:
     friend class SkCanvas;
+    friend class SkDrawIter;
+    // just called by SkDrawIter, on its way to calling our draw methods
+    const SkBitmap& accessBitmapForDraw();
     // just called by SkCanvas when built as a layer
     void setOrigin(int x, int y) { fOrigin.set(x, y); }
     // just called by SkCanvas for saveLayer
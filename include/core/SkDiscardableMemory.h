@@ -0,0 +1,62 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkDiscardableMemory_DEFINED
+#define SkDiscardableMemory_DEFINED
+
+#include "SkTypes.h"
+
+/** \class SkDiscardableMemory
+
+    A block of memory that the OS may take back while it is unlocked, when
+    it runs short. Whoever uses it has to be able to make the contents again
+    (e.g. by decoding an image), since lock() reports when they are gone.
+    Implemented by the porting layer; ports that can't discard memory just
+    keep it, and lock() always succeeds.
+*/
+class SK_API SkDiscardableMemory : SkNoncopyable {
+public:
+    /** Return new memory of at least size bytes, locked, or null if it
+        can't be allocated.
+    */
+    static SkDiscardableMemory* Create(size_t size);
+    ~SkDiscardableMemory();
+
+    /** The memory, which may only be used while it is locked. */
+    void*   data() const { return fAddr; }
+    size_t  size() const { return fSize; }
+
+    /** Lock the memory, so that the OS can't take it. Return true if the
+        contents are as they were left by unlock(), or false if they were
+        discarded, in which case the memory is locked but its contents are
+        undefined.
+    */
+    bool    lock();
+
+    /** Let the OS discard the memory if it needs to. */
+    void    unlock();
+
+private:
+    SkDiscardableMemory(void* addr, size_t size);
+
+    void*   fAddr;
+    size_t  fSize;
+    void*   fPortData;  // whatever the port needs to lock and unlock
+    bool    fLocked;
+};
+
+#endif
@@ -25,9 +25,11 @@
 #include "SkRect.h"
 #include "SkAutoKern.h"
 
+class SkBlitter;
 class SkBounder;
 class SkClipStack;
 class SkDevice;
+class SkExecutor;
 class SkPath;
 class SkRegion;
 struct SkDrawProcs;
@@ -108,6 +110,9 @@ private:
                              SkScalar x, SkScalar y, const SkPaint&) const;
     void    drawDevMask(const SkMask& mask, const SkPaint&) const;
     void    drawBitmapAsMask(const SkBitmap&, const SkPaint&) const;
+    // returns false if the fill isn't worth splitting up (or can't be)
+    bool    fillPathInBands(const SkPath& devPath, const SkPaint&,
+                            SkBlitter*) const;
 
 public:
     const SkBitmap* fBitmap;        // required
@@ -115,9 +120,14 @@ public:
     const SkRegion* fClip;          // required
 
     const SkClipStack* fClipStack;  // optional
+    // optional, A8 coverage (in fBitmap's coordinates) that modulates what is
+    // drawn, e.g. for antialiased clips. fClip must be inside its bounds.
+    const SkMask*   fClipMask;
     SkDevice*       fDevice;        // optional
     SkBounder*      fBounder;       // optional
     SkDrawProcs*    fProcs;         // optional
+    // optional, large paths are filled in bands on its threads
+    SkExecutor*     fExecutor;
 
     const SkMatrix* fMVMatrix;      // optional
     const SkMatrix* fExtMatrix;     // optional
@@ -21,6 +21,7 @@
 
 class SkCanvas;
 class SkPaint;
+struct SkRect;
 
 /** \class SkDrawLooper
     Subclasses of SkDrawLooper can be attached to a SkPaint. Where they are,
@@ -51,6 +52,15 @@ public:
      *  init() was first called.
      */
     virtual bool next(SkCanvas*, SkPaint* paint) = 0;
+
+    /**
+     *  Grow outset, the fast bounds of a shape with empty bounds at the origin
+     *  (see SkPaint::computeFastBounds()) as the paint would draw it without
+     *  the looper, to include everything that the looper's draws of it can
+     *  touch, and return true. The default returns false, for loopers that
+     *  can't tell, which keeps paints that use them from computing fast bounds.
+     */
+    virtual bool computeFastBoundsOutset(SkRect*) const { return false; }
     
 protected:
     SkDrawLooper() {}
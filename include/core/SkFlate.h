@@ -56,4 +56,61 @@ public:
     static bool Inflate(SkStream* src, SkWStream* dst);
 };
 
+/** \class SkDeflater
+    Compresses data a piece at a time into a SkWStream. The compressor's
+    state is kept from one begin() to the next, so compressing lots of small
+    streams with the same deflater doesn't set up zlib each time. A deflater
+    may be used on any thread, but only on one at a time.
+*/
+class SkDeflater : SkNoncopyable {
+public:
+    enum {
+        kDefault_Level  = -1,
+        kNone_Level     = 0,
+        kFast_Level     = 1,    // e.g. for previews
+        kBest_Level     = 9
+    };
+
+    enum Strategy {
+        kDefault_Strategy,
+        kFiltered_Strategy,
+        kHuffmanOnly_Strategy,
+        kRLE_Strategy           // fast, and good for runs of the same byte
+    };
+
+    /** level is from kNone_Level to kBest_Level, or kDefault_Level. */
+    explicit SkDeflater(int level = kDefault_Level,
+                        Strategy strategy = kDefault_Strategy);
+    ~SkDeflater();
+
+    /** Start compressing into dst, dropping whatever was left unfinished
+        from before. Returns false if flate isn't available.
+     */
+    bool begin(SkWStream* dst);
+
+    /** Compress size bytes of data. Some of the result may stay buffered
+        until finish(). Returns false if an error occurs.
+     */
+    bool write(const void* data, size_t size);
+
+    /** Write out the rest of the compressed data. Returns false if an error
+        occurred here or in any write() since begin().
+     */
+    bool finish();
+
+    /** Compress all of src into dst. */
+    bool deflate(SkStream* src, SkWStream* dst);
+
+private:
+    struct State;
+
+    int         fLevel;
+    Strategy    fStrategy;
+    State*      fState;     // made by the first begin()
+    SkWStream*  fDst;       // null if not between begin() and finish()
+    bool        fOK;
+
+    bool drain();
+};
+
 #endif
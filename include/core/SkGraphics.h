@@ -17,7 +17,7 @@
 #ifndef SkGraphics_DEFINED
 #define SkGraphics_DEFINED
 
-#include "SkTypes.h"
+#include "SkPurgeableCache.h"
 
 class SkGraphics {
 public:
@@ -34,6 +34,52 @@ public:
     */
     static bool SetFontCacheUsed(size_t usageInBytes);
 
+    /** Set a directory in which the font cache keeps a copy of the glyph
+        metrics and masks of each strike, so that the next process that uses
+        the same strike can skip the font scaler. Strikes are written when
+        they are purged from the font cache (e.g. by Term()), and read when
+        they are created. Pass NULL (the default) to disable this. The
+        directory must exist, and should only be shared by processes that
+        see the same set of fonts.
+    */
+    static void SetGlyphDiskCacheDir(const char dir[]);
+
+    /** Return the (approximate) number of bytes used by all of the caches
+        together: the font cache, and (when they are linked in) the gradient
+        tables, the blurred masks, the global image pool and each GrContext's
+        texture cache.
+    */
+    static size_t GetTotalCacheUsed();
+
+    /** Fill out up to maxCount entries with each cache's name, cost and
+        usage, and return the number of caches. See SkPurgeableCache.
+    */
+    static int GetCacheUsage(SkPurgeableCache::Usage usage[], int maxCount);
+
+    /** Return the budget for all of the caches together. 0 (the default)
+        means there is none.
+    */
+    static size_t GetCacheBudget();
+
+    /** Set the budget for all of the caches together, and purge them down to
+        it. The caches may grow past it again; call PurgeToBudget() (e.g.
+        once a frame) to trim them back.
+    */
+    static void SetCacheBudget(size_t bytes);
+
+    enum PurgeLevel {
+        kBudget_PurgeLevel, //!< down to the budget, if there is one
+        kHalf_PurgeLevel,   //!< down to half the budget, or of what's used
+        kAll_PurgeLevel     //!< as far as possible, e.g. on a memory warning
+    };
+
+    /** Purge the caches, those that are cheapest to rebuild first, until
+        what they use together is within the level. GPU textures are among
+        them, so if there are any GrContexts this must be called from the
+        thread that uses them. Returns the number of bytes that remain.
+    */
+    static size_t PurgeToBudget(PurgeLevel);
+
     /** Return the version numbers for the library. If the parameter is not
         null, it is set to the version number.
      */
@@ -34,6 +34,30 @@ public:
      */
     static bool IntersectLine(const SkPoint src[2], const SkRect& clip,
                               SkPoint dst[2]);
+
+    enum Outcode {
+        kLeft_Outcode   = 1 << 0,   //!< x < clip.fLeft
+        kTop_Outcode    = 1 << 1,   //!< y < clip.fTop
+        kRight_Outcode  = 1 << 2,   //!< x > clip.fRight
+        kBottom_Outcode = 1 << 3    //!< y > clip.fBottom
+    };
+
+    /*  Store in codes[] the Outcode bits saying which sides of clip each of
+        the count points is outside of, or 0 if it is inside (or on the
+        edge). A segment whose end-points share a bit lies completely outside
+        the clip. Points with NaN coordinates get 0.
+     */
+    static void ComputeOutcodes(const SkPoint pts[], int count,
+                                const SkRect& clip, uint8_t codes[]);
+
+    /*  Copy to dst[] the line segments src[0]..src[1], src[2]..src[3], ...
+        that aren't completely outside of clip, and return the number of
+        points copied. This only looks at the end-points, so some of the
+        segments that are kept may cross a corner without entering the clip.
+        count must be even, and dst may be the same as src.
+     */
+    static int CullLines(const SkPoint src[], int count, const SkRect& clip,
+                         SkPoint dst[]);
 };
 
 #endif
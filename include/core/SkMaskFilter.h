@@ -62,6 +62,35 @@ public:
     virtual bool filterMask(SkMask* dst, const SkMask& src, const SkMatrix&,
                             SkIPoint* margin);
 
+    /** Grow outset, the fast bounds of a shape with empty bounds at the
+        origin (see SkPaint::computeFastBounds()), by how far (in local
+        coordinates) the filtered mask can reach beyond the shape, and return
+        true. The default returns false, for filters that can't tell, which
+        keeps paints that use them from computing fast bounds.
+    */
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
+
+    enum BlurType {
+        kNone_BlurType,     //!< this filter is not a blur
+        kNormal_BlurType,   //!< fuzzy inside and outside
+        kSolid_BlurType,    //!< solid inside, fuzzy outside
+        kOuter_BlurType,    //!< nothing inside, fuzzy outside
+        kInner_BlurType,    //!< fuzzy inside, nothing outside
+    };
+
+    struct BlurInfo {
+        SkScalar    fRadius;            // in local coordinates, unless
+        bool        fIgnoreTransform;   // this is set
+        bool        fHighQuality;
+    };
+
+    /** If this filter is a blur, return its type and, if info is not NULL,
+        its parameters, so that a device can blur the mask itself (e.g. on the
+        GPU) rather than call filterMask(). The default returns
+        kNone_BlurType.
+    */
+    virtual BlurType asABlur(BlurInfo* info) const;
+
     /** Helper method that, given a path in device space, will rasterize it into a kA8_Format mask
         and then call filterMask(). If this returns true, the specified blitter will be called
         to render that mask. Returns false if filterMask() returned false.
@@ -72,9 +101,36 @@ public:
 
     virtual void flatten(SkFlattenableWriteBuffer& ) {}
 
+    /** A mask that is drawn over fOuterRect by repeating its fCenter column
+        and row as many times as it takes to fill the outer rect.
+    */
+    struct NinePatch {
+        SkMask      fMask;      // allocated with SkMask::AllocImage()
+        SkIRect     fOuterRect; // device bounds, at least as big as fMask's
+        SkIPoint    fCenter;    // relative to fMask.fBounds' top left
+    };
+
 protected:
     // empty for now, but lets get our subclass to remember to init us for the future
     SkMaskFilter(SkFlattenableReadBuffer&) {}
+
+    enum FilterReturn {
+        kFalse_FilterReturn,
+        kTrue_FilterReturn,
+        kUnimplemented_FilterReturn
+    };
+
+    /** Called by filterPath() when the device path is a rect, so that a
+        subclass whose result has a stretchable middle can filter a smaller
+        rect instead. Return kTrue_FilterReturn after filling out patch (which
+        filterPath() then draws and frees), kFalse_FilterReturn to have
+        filterPath() fail as if filterMask() had, or kUnimplemented_FilterReturn
+        (the default) to have the rect masked and filtered like any other
+        path.
+    */
+    virtual FilterReturn filterRectToNine(const SkRect& devRect,
+                                          const SkMatrix& matrix,
+                                          NinePatch* patch);
 };
 
 /** \class SkAutoMaskImage
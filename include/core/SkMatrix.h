@@ -395,6 +395,19 @@ public:
         return this->mapRect(rect, *rect);
     }
 
+    /** Apply this matrix to each of the src rectangles, as mapRect() does,
+        and write the transformed rectangles into dst, which may be the same
+        as src. The rects are mapped together, which is faster than calling
+        mapRect() for each of them.
+        @param dst  Where the transformed rectangles are written. It must
+                    contain at least count entries
+        @param src  The original rectangles to be transformed. It must contain
+                    at least count entries
+        @param count The number of rectangles in src
+        @return the result of calling rectStaysRect()
+    */
+    bool mapRects(SkRect dst[], const SkRect src[], int count) const;
+
     void mapPointsWithStride(SkPoint pts[], size_t stride, int count) const {
         for (int i = 0; i < count; ++i) {            
             this->mapPoints(pts, pts, 1);
@@ -423,10 +436,10 @@ public:
     typedef void (*MapPtsProc)(const SkMatrix& mat, SkPoint dst[],
                                   const SkPoint src[], int count);
 
-    static MapPtsProc GetMapPtsProc(TypeMask mask) {
-        SkASSERT((mask & ~kAllMasks) == 0);
-        return gMapPtsProcs[mask & kAllMasks];
-    }
+    /** Returns the platform's (e.g. SSE2) proc for the mask if it has one,
+        or else the portable one.
+    */
+    static MapPtsProc GetMapPtsProc(TypeMask mask);
     
     MapPtsProc getMapPtsProc() const {
         return GetMapPtsProc(this->getType());
@@ -564,6 +577,10 @@ private:
     
     static const MapPtsProc gMapPtsProcs[];
 
+    // Implemented in src/opts. Returns NULL if there isn't a faster proc
+    // than the portable one for the mask.
+    static MapPtsProc PlatformMapPtsProc(TypeMask mask);
+
     friend class SkPerspIter;
 };
 
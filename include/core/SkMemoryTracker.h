@@ -0,0 +1,94 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkMemoryTracker_DEFINED
+#define SkMemoryTracker_DEFINED
+
+#include "SkTypes.h"
+
+/** \class SkMemoryTracker
+
+    When the library is built with SK_ENABLE_MEMORY_TRACKING, sk_malloc,
+    sk_realloc and sk_free keep count of the blocks they hand out, both in all
+    and for each call site (the address that sk_malloc etc. were called from,
+    which a symbolizer such as addr2line can turn into a file and line).
+    Without it nothing is counted, and the stats are all zero.
+
+    A realloc counts as freeing the old block and allocating the new one.
+    Memory from operator new, or got from malloc() directly, is not counted.
+*/
+class SkMemoryTracker {
+public:
+    struct Stats {
+        int64_t fAllocatedBytes;    //!< bytes allocated in all
+        int64_t fCurrentBytes;      //!< bytes allocated and not yet freed
+        int64_t fPeakBytes;         //!< most fCurrentBytes since ResetPeak()
+        int32_t fAllocCount;        //!< blocks allocated in all
+        int32_t fFreeCount;         //!< blocks freed in all
+    };
+
+    struct Site {
+        const void* fCaller;        //!< NULL for the sites that didn't fit
+        int64_t     fAllocatedBytes;
+        int64_t     fCurrentBytes;
+        int32_t     fAllocCount;
+    };
+
+    /** Return true if the library was built with SK_ENABLE_MEMORY_TRACKING.
+    */
+    static bool IsEnabled();
+
+    static void GetStats(Stats*);
+
+    /** Start the peak over from the bytes allocated now, e.g. to find the
+        peak of one part of a program as the difference between fPeakBytes
+        afterwards and fCurrentBytes now.
+    */
+    static void ResetPeak();
+
+    /** Copy the call sites that allocated the most bytes into sites, at most
+        maxCount of them, most bytes first, and return how many there are in
+        all. Only a few thousand different sites are kept apart; the
+        allocations from any after that are all counted in one site, whose
+        fCaller is NULL.
+    */
+    static int GetSites(Site sites[], int maxCount);
+
+    /** Forget the sites counted so far. Blocks they allocated that are
+        freed later won't be taken off any site.
+    */
+    static void ResetSites();
+
+    // For the ports, when SK_ENABLE_MEMORY_TRACKING is defined: these
+    // allocate with malloc(), behind a header that records the block's size
+    // and site, and count the block. Free() may also be given a block that
+    // doesn't have a header, which it just frees.
+    static void* Malloc(size_t size, const void* caller);
+    static void* Realloc(void* addr, size_t size, const void* caller);
+    static void Free(void* addr);
+};
+
+/** The address that the function using this will return to, or NULL if the
+    compiler can't tell.
+*/
+#if defined(__GNUC__)
+    #define SK_MEMORY_CALLER()  __builtin_return_address(0)
+#else
+    #define SK_MEMORY_CALLER()  NULL
+#endif
+
+#endif
@@ -42,6 +42,10 @@ bool    sk_frewind(SkFILE*);
 size_t  sk_fread(void* buffer, size_t byteCount, SkFILE*);
 size_t  sk_fwrite(const void* buffer, size_t byteCount, SkFILE*);
 void    sk_fflush(SkFILE*);
+/** Tell the OS that byteCount bytes at offset will be read soon, so that it
+    can start reading them in. Returns false if the OS does not take hints.
+*/
+bool    sk_fprefetch(SkFILE*, size_t offset, size_t byteCount);
 
 int     sk_fseek( SkFILE*, size_t, int );
 size_t  sk_ftell( SkFILE* );
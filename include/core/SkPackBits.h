@@ -81,6 +81,24 @@ public:
     */
     static void Unpack8(uint8_t dst[], size_t dstSkip, size_t dstWrite,
                         const uint8_t src[]);
+
+    /** Unpack the data from src[] as Unpack8(dst, dstSkip, dstWrite, src)
+        does, but write table[] of each byte into dst[] instead of the byte,
+        so that a repeated byte is a single memset of its entry. This is how
+        kRLE_Index8_Config bitmaps are drawn, without unpacking their indices.
+        @param dst      Buffer (allocated by caller) for the dstWrite entries
+        @param dstSkip  Number of bytes of unpacked src to skip
+        @param dstWrite Number of entries to write into dst
+        @param src      Input data to unpack, previously created by Pack8.
+        @param table    The entries that each byte of src is mapped to
+    */
+    static void Unpack8To32(uint32_t dst[], size_t dstSkip, size_t dstWrite,
+                            const uint8_t src[], const uint32_t table[]);
+
+    /** As Unpack8To32(), but for a table of 16bit entries.
+    */
+    static void Unpack8To16(uint16_t dst[], size_t dstSkip, size_t dstWrite,
+                            const uint8_t src[], const uint16_t table[]);
 };
 
 #endif
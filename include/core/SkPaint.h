@@ -106,10 +106,11 @@ public:
         kLCDRenderText_Flag   = 0x200,  //!< mask to enable subpixel glyph renderering
         kEmbeddedBitmapText_Flag = 0x400, //!< mask to enable embedded bitmap strikes
         kAutoHinting_Flag     = 0x800,  //!< mask to force Freetype's autohinter
+        kAnalyticAA_Flag      = 0x1000, //!< mask to use exact-area antialiasing
         // when adding extra flags, note that the fFlags member is specified
         // with a bit-width and you'll have to expand it.
 
-        kAllFlags = 0xFFF
+        kAllFlags = 0x1FFF
     };
 
     /** Return the paint's flags. Use the Flag enum to test flag values.
@@ -134,6 +135,21 @@ public:
         */
     void setAntiAlias(bool aa);
 
+    /** Helper for getFlags(), returning true if kAnalyticAA_Flag bit is set.
+        When both this and kAntiAlias_Flag are set, filled paths compute the
+        exact area covered in each pixel instead of supersampling.
+        @return true if the kAnalyticAA_Flag bit is set in the paint's flags.
+    */
+    bool isAnalyticAA() const {
+        return SkToBool(this->getFlags() & kAnalyticAA_Flag);
+    }
+
+    /** Helper for setFlags(), setting or clearing the kAnalyticAA_Flag bit
+        @param analyticAA   true to set the kAnalyticAA_Flag bit in the paint's
+                            flags, false to clear it.
+    */
+    void setAnalyticAA(bool analyticAA);
+
     /** Helper for getFlags(), returning true if kDither_Flag bit is set
         @return true if the dithering bit is set in the paint's flags.
         */
@@ -421,22 +437,26 @@ public:
     bool getFillPath(const SkPath& src, SkPath* dst) const;
 
     /** Returns true if the current paint settings allow for fast computation of
-        bounds (i.e. there is nothing complex like a patheffect that would make
-        the bounds computation expensive.
+        bounds (i.e. there is nothing complex like a rasterizer, or an effect
+        that can't bound what it draws, that would make the bounds computation
+        expensive).
     */
     bool canComputeFastBounds() const {
         // use bit-or since no need for early exit
-        return (reinterpret_cast<uintptr_t>(this->getMaskFilter()) |
-                reinterpret_cast<uintptr_t>(this->getLooper()) |
-                reinterpret_cast<uintptr_t>(this->getRasterizer()) |
-                reinterpret_cast<uintptr_t>(this->getPathEffect())) == 0;
+        if ((reinterpret_cast<uintptr_t>(this->getMaskFilter()) |
+             reinterpret_cast<uintptr_t>(this->getLooper()) |
+             reinterpret_cast<uintptr_t>(this->getRasterizer()) |
+             reinterpret_cast<uintptr_t>(this->getPathEffect())) == 0) {
+            return true;
+        }
+        return NULL != this->getFastBoundsOutset();
     }
 
     /** Only call this if canComputeFastBounds() returned true. This takes a
         raw rectangle (the raw bounds of a shape), and adjusts it for stylistic
-        effects in the paint (e.g. stroking). If needed, it uses the storage
-        rect parameter. It returns the adjusted bounds that can then be used
-        for quickReject tests.
+        effects in the paint (e.g. stroking, blurs and shadows). If needed, it
+        uses the storage rect parameter. It returns the adjusted bounds that
+        can then be used for quickReject tests.
 
         The returned rect will either be orig or storage, thus the caller
         should not rely on storage being set to the result, but should always
@@ -454,8 +474,13 @@ public:
         }
     */
     const SkRect& computeFastBounds(const SkRect& orig, SkRect* storage) const {
-        return this->getStyle() == kFill_Style ? orig :
-                    this->computeStrokeFastBounds(orig, storage);
+        if (this->getStyle() == kFill_Style &&
+                (reinterpret_cast<uintptr_t>(this->getMaskFilter()) |
+                 reinterpret_cast<uintptr_t>(this->getLooper()) |
+                 reinterpret_cast<uintptr_t>(this->getPathEffect())) == 0) {
+            return orig;
+        }
+        return this->doComputeFastBounds(orig, storage);
     }
 
     /** Get the paint's shader object.
@@ -839,7 +864,7 @@ private:
     SkColor         fColor;
     SkScalar        fWidth;
     SkScalar        fMiterLimit;
-    unsigned        fFlags : 12;
+    unsigned        fFlags : 13;
     unsigned        fTextAlign : 2;
     unsigned        fCapType : 2;
     unsigned        fJoinType : 2;
@@ -850,6 +875,11 @@ private:
     uint32_t        fGenerationID;
 #endif
 
+    // What computeFastBounds() adds to a shape's bounds, for the paint as it
+    // is now. These come last, since operator== doesn't compare them.
+    mutable SkRect  fFastBoundsOutset;
+    mutable uint8_t fFastBoundsState;
+
     SkDrawCacheProc    getDrawCacheProc() const;
     SkMeasureCacheProc getMeasureCacheProc(TextBufferDirection dir,
                                            bool needFullMetrics) const;
@@ -863,8 +893,16 @@ private:
                         void (*proc)(const SkDescriptor*, void*),
                         void* context, bool ignoreGamma = false) const;
 
-    const SkRect& computeStrokeFastBounds(const SkRect& orig,
-                                          SkRect* storage) const;
+    enum FastBoundsState {
+        kDirty_FastBoundsState,     // must be 0, for the constructor
+        kOutset_FastBoundsState,
+        kNone_FastBoundsState       // the paint can't compute fast bounds
+    };
+    void dirtyFastBounds() { fFastBoundsState = kDirty_FastBoundsState; }
+    // NULL if the paint can't compute fast bounds
+    const SkRect* getFastBoundsOutset() const;
+    const SkRect& doComputeFastBounds(const SkRect& orig,
+                                      SkRect* storage) const;
 
     enum {
         kCanonicalTextSizeForPaths = 64
@@ -20,14 +20,6 @@
 #include "SkMatrix.h"
 #include "SkTDArray.h"
 
-#ifdef ANDROID
-#define GEN_ID_INC              fGenerationID++
-#define GEN_ID_PTR_INC(ptr)     ptr->fGenerationID++
-#else
-#define GEN_ID_INC
-#define GEN_ID_PTR_INC(ptr)
-#endif
-
 class SkReader32;
 class SkWriter32;
 class SkAutoPathBoundsUpdate;
@@ -82,7 +74,7 @@ public:
     */
     void setFillType(FillType ft) {
         fFillType = SkToU8(ft);
-        GEN_ID_INC;
+        fGenerationID = 0;
     }
 
     /** Returns true if the filltype is one of the Inverse variants */
@@ -94,7 +86,7 @@ public:
      */
     void toggleInverseFillType() {
         fFillType ^= 2;
-        GEN_ID_INC;
+        fGenerationID = 0;
      }
 
     enum Convexity {
@@ -110,7 +102,7 @@ public:
      */
     Convexity getConvexity() const {
         if (kUnknown_Convexity == fConvexity) {
-            fConvexity = (uint8_t)ComputeConvexity(*this);
+            this->computeConvexity();
         }
         return (Convexity)fConvexity;
     }
@@ -197,6 +189,18 @@ public:
     */
     bool isRect(SkRect* rect) const;
 
+    /** Returns true if the path is just an oval, i.e. it was made by a single
+        addOval() (or addCircle(), or addRoundRect() with radii that reach
+        half the size) and has only been translated or scaled since. If so,
+        and if rect is not null, set rect to the oval's bounds. Unlike
+        isRect(), this only checks a flag, so a path that happens to trace an
+        oval some other way is not one.
+
+        @param rect If not null, returns the bounds of the oval
+        @return true if the path is an oval
+    */
+    bool isOval(SkRect* rect) const;
+
     /** Return the number of points in the path
      */
     int countPoints() const {
@@ -431,6 +435,15 @@ public:
         kCCW_Direction
     };
 
+    /** If the path is convex and not degenerate, set dir to the direction
+        its contour winds in and return true, otherwise return false. This is
+        computed along with the convexity, and cached in the same way.
+
+        @param dir  Returns the direction of the path's contour
+        @return true if the path has a direction
+    */
+    bool getDirection(Direction* dir) const;
+
     /** Add a closed rectangle contour to the path
         @param rect The rectangle to add as a closed contour to the path
         @param dir  The direction to wind the rectangle's contour
@@ -639,26 +652,42 @@ public:
     void flatten(SkWriter32&) const;
     void unflatten(SkReader32&);
 
-#ifdef ANDROID
+    /**
+     *  Return a unique ID for the path's current contents (its points, verbs,
+     *  fill type and convexity setting), so that caches of things made from
+     *  the path (masks, textures, ...) can tell when it has changed. A copy
+     *  of the path has the same ID until either one is edited. The ID is
+     *  never 0.
+     */
     uint32_t getGenerationID() const;
-#endif
 
     SkDEBUGCODE(void validate() const;)
 
 private:
-    SkTDArray<SkPoint>  fPts;
-    SkTDArray<uint8_t>  fVerbs;
+    // enough for rects and other small polygons without going to the heap
+    enum {
+        kInlinePointCount   = 8,
+        kInlineVerbCount    = 16
+    };
+    typedef SkSTDArray<kInlinePointCount, SkPoint>  PointArray;
+    typedef SkSTDArray<kInlineVerbCount, uint8_t>   VerbArray;
+
+    PointArray          fPts;
+    VerbArray           fVerbs;
     mutable SkRect      fBounds;
     mutable uint8_t     fBoundsIsDirty;
     uint8_t             fFillType;
     mutable uint8_t     fConvexity;
-#ifdef ANDROID
-    uint32_t            fGenerationID;
-#endif
+    mutable uint8_t     fDirection;     // Direction, or unknown/none
+    uint8_t             fIsOval;
+    mutable uint32_t    fGenerationID;  // 0 until getGenerationID()
 
     // called, if dirty, by getBounds()
     void computeBounds() const;
 
+    // called, if unknown, by getConvexity(); also caches the direction
+    void computeConvexity() const;
+
     friend class Iter;
     void cons_moveto();
 
@@ -677,6 +706,7 @@ private:
 
     friend const SkPoint* sk_get_path_points(const SkPath&, int index);
     friend class SkAutoPathBoundsUpdate;
+    friend class SkPathHeap;    // to hash the points and verbs
 };
 
 #endif
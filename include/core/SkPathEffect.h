@@ -20,6 +20,7 @@
 #include "SkFlattenable.h"
 
 class SkPath;
+struct SkRect;
 
 /** \class SkPathEffect
 
@@ -41,6 +42,15 @@ public:
     */
     virtual bool filterPath(SkPath* dst, const SkPath& src, SkScalar* width) = 0;
 
+    /** Grow outset, the fast bounds of a shape with empty bounds at the
+        origin (see SkPaint::computeFastBounds()), by as much as this effect
+        can move any path outside of its bounds, and return true. The default
+        returns false, for effects that can't bound what they make (or that
+        change the stroke width), which keeps paints that use them from
+        computing fast bounds.
+    */
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
+
 private:
     // illegal
     SkPathEffect(const SkPathEffect&);
@@ -86,6 +96,7 @@ public:
     // overrides
     
     virtual bool filterPath(SkPath* dst, const SkPath& src, SkScalar* width);
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
 
     static SkFlattenable* CreateProc(SkFlattenableReadBuffer& buffer) {
         return SkNEW_ARGS(SkComposePathEffect, (buffer));
@@ -121,6 +132,7 @@ public:
 
     // overrides
     virtual bool filterPath(SkPath* dst, const SkPath& src, SkScalar* width);
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
 
     static SkFlattenable* CreateProc(SkFlattenableReadBuffer& buffer)  {
         return SkNEW_ARGS(SkSumPathEffect, (buffer));
@@ -20,6 +20,7 @@
 
 #include "SkPath.h"
 #include "SkTDArray.h"
+#include "SkThread.h"
 
 class SK_API SkPathMeasure : SkNoncopyable {
 public:
@@ -36,6 +37,10 @@ public:
         for the lifetime of the measure object, or until setPath() is called with
         a different path (or null), since the measure object keeps a pointer to the
         path object (does not copy its data).
+        If the path has the same generation ID as the one that was measured
+        before (e.g. it's the same, unchanged path, or a copy of it), and every
+        contour was measured, the segments are kept and the measure just goes
+        back to the first contour.
     */
     void    setPath(const SkPath*, bool forceClosed);
 
@@ -51,6 +56,16 @@ public:
     */
     bool getPosTan(SkScalar distance, SkPoint* position, SkVector* tangent);
 
+    /** Compute the positions and/or tangents at count distances along the
+        current contour, each pinned as getPosTan() does. This is faster than
+        calling getPosTan() for each one, especially if the distances increase
+        (or are close together). positions or tangents may be null.
+        Returns false if there is no path, or a zero-length path was specified,
+        in which case positions and tangents are unchanged.
+    */
+    bool getPosTans(const SkScalar distances[], int count,
+                    SkPoint positions[], SkVector tangents[]);
+
     enum MatrixFlags {
         kGetPosition_MatrixFlag     = 0x01,
         kGetTangent_MatrixFlag      = 0x02,
@@ -79,6 +94,11 @@ public:
     */
     bool nextContour();
 
+    /** Go back to the path's first contour. The contours that have been
+        measured already aren't measured again.
+    */
+    void rewind();
+
 #ifdef SK_DEBUG
     void    dump();
 #endif
@@ -86,10 +106,12 @@ public:
 private:
     SkPath::Iter    fIter;
     const SkPath*   fPath;
+    uint32_t        fGenerationID;      // of the path that was measured
     SkScalar        fLength;            // relative to the current contour
-    int             fFirstPtIndex;      // relative to the current contour
+    int             fFirstPtIndex;      // where fIter's next contour starts
     bool            fIsClosed;          // relative to the current contour
     bool            fForceClosed;
+    bool            fIterDone;          // every contour has been measured
 
     struct Segment {
         SkScalar    fDistance;  // total distance up to this point
@@ -99,16 +121,63 @@ private:
 
         SkScalar getScalarT() const;
     };
-    SkTDArray<Segment>  fSegments;
+    SkTDArray<Segment>  fSegments;      // every measured contour's, in order
+
+    struct Contour {
+        int         fSegmentStart;
+        int         fSegmentCount;
+        SkScalar    fLength;
+        bool        fIsClosed;
+    };
+    SkTDArray<Contour>  fContours;      // the ones measured so far
+    int                 fContourIndex;  // the current one
+    int                 fSegmentStart;  // the current one's segments
+    int                 fSegmentCount;
 
     static const Segment* NextSegment(const Segment*);
 
+    void     reset();
+    void     selectContour();
     void     buildSegments();
     SkScalar compute_quad_segs(const SkPoint pts[3], SkScalar distance,
                                 int mint, int maxt, int ptIndex);
     SkScalar compute_cubic_segs(const SkPoint pts[3], SkScalar distance,
                                 int mint, int maxt, int ptIndex);
-    const Segment* distanceToSegment(SkScalar distance, SkScalar* t);
+    const Segment* distanceToSegment(SkScalar distance, SkScalar* t,
+                                     int* hint = NULL);
+};
+
+/**
+ *  Holds on to an SkPathMeasure between calls, so that measuring the same
+ *  path again (e.g. dashing it, or drawing text along it, in every frame of
+ *  an animation) reuses its segments instead of flattening it again. Each
+ *  call checks the measure out with SkAutoCachedPathMeasure, so threads
+ *  don't wait for each other: one that finds it checked out gets a new one.
+ */
+class SK_API SkPathMeasureCache : SkNoncopyable {
+public:
+    SkPathMeasureCache();
+    ~SkPathMeasureCache();
+
+private:
+    SkMutex         fMutex;
+    SkPathMeasure*  fMeasure;   // NULL while it's checked out
+
+    friend class SkAutoCachedPathMeasure;
+};
+
+class SK_API SkAutoCachedPathMeasure : SkNoncopyable {
+public:
+    SkAutoCachedPathMeasure(SkPathMeasureCache*, const SkPath&,
+                            bool forceClosed);
+    /** Returns the measure to the cache (or deletes it if there's another) */
+    ~SkAutoCachedPathMeasure();
+
+    SkPathMeasure& get() { return *fMeasure; }
+
+private:
+    SkPathMeasureCache* fCache;
+    SkPathMeasure*      fMeasure;
 };
 
 #endif
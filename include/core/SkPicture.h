@@ -20,7 +20,9 @@
 #include "SkRefCnt.h"
 
 class SkCanvas;
+class SkData;
 class SkPicturePlayback;
+class SkPictureProfile;
 class SkPictureRecord;
 class SkStream;
 class SkWStream;
@@ -38,10 +40,21 @@ public:
     */
     SkPicture();
     /** Make a copy of the contents of src. If src records more drawing after
-        this call, those elements will not appear in this picture.
+        this call, those elements will not appear in this picture. The copy
+        shares the src's paints (and their shaders), so it is no safer to draw
+        on another thread than src itself; see canDrawConcurrently().
     */
     SkPicture(const SkPicture& src);
     explicit SkPicture(SkStream*);
+    /** Play back a picture written by serializeMappable(), in place: the
+        picture refs data, reads its drawing commands straight out of it, and
+        only unflattens its bitmaps, paints, paths and regions the first time
+        they are drawn. data must be 4-byte aligned, and must not change while
+        the picture (or a copy of it) is alive. To read a file without loading
+        it, pass an SkData that holds the file's mmap()ed contents, and
+        munmap()s them in its ReleaseProc.
+    */
+    explicit SkPicture(SkData* data);
     virtual ~SkPicture();
     
     /**
@@ -58,7 +71,24 @@ public:
             clip-query calls will reflect the path's bounds, not the actual
             path.
          */
-        kUsePathBoundsForClip_RecordingFlag = 0x01
+        kUsePathBoundsForClip_RecordingFlag = 0x01,
+        /*  This flag specifies that endRecording() should remove the draws
+            that a later opaque draw (or clear) completely hides, and the
+            save/restore blocks that end up drawing nothing. Whether a draw is
+            hidden is decided in the picture's own coordinates, so pixels at
+            the very edge of the covering draw may differ if the picture is
+            played back scaled down or rotated.
+         */
+        kEliminateOverdraw_RecordingFlag = 0x02,
+        /*  This flag specifies that drawPicture() should record the ops of a
+            small picture (one whose ops take up to 1K bytes) in place of a
+            reference to it, so that the overdraw pass and the spatial index
+            see them, and playback does not have to recurse. Pictures that
+            small pictures draw are inlined too. The picture's contents are
+            taken as they are when drawPicture() is called, so it must not be
+            recording then (a picture that is, is referenced as usual).
+         */
+        kInlineSmallPictures_RecordingFlag = 0x04
     };
 
     /** Returns the canvas that records the drawing commands.
@@ -87,6 +117,23 @@ public:
         @param surface the canvas receiving the drawing commands.
     */
     void draw(SkCanvas* surface);
+
+    /** Returns true if several threads may draw() this picture at once, each
+        into its own canvas. Playback keeps its place on each draw()'s stack,
+        but shaders and draw loopers keep what they set up for a draw in
+        themselves, so a picture whose paints (or nested pictures' paints)
+        have any is only safe to draw on one thread at a time. This calls
+        endRecording() if that has not already been called; that must happen
+        before the threads start drawing.
+    */
+    bool canDrawConcurrently();
+
+    /** Like draw(), but times each drawing command as it is replayed, and
+        adds the times to profile (see SkPictureProfile). This is slower than
+        draw(), and is meant for finding out which commands a slow picture
+        spends its time in.
+    */
+    void profile(SkCanvas* surface, SkPictureProfile* profile);
     
     /** Return the width of the picture's recording canvas. This
         value reflects what was passed to setSize(), and does not necessarily
@@ -104,6 +151,12 @@ public:
 
     void serialize(SkWStream*) const;
 
+    /** Write the picture in the format that SkPicture(SkData*) plays back in
+        place. It is larger than what serialize() writes, since everything in
+        it is aligned for reading where it lies.
+    */
+    void serializeMappable(SkWStream*) const;
+
     /** Signals that the caller is prematurely done replaying the drawing
         commands. This can be called from a canvas virtual while the picture
         is drawing. Has no effect if the picture is not drawing. 
@@ -117,6 +170,7 @@ private:
 
     friend class SkFlatPicture;
     friend class SkPicturePlayback;
+    friend class SkPictureRecord;
 };
 
 class SkAutoPictureRecord : SkNoncopyable {
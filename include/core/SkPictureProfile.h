@@ -0,0 +1,105 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkPictureProfile_DEFINED
+#define SkPictureProfile_DEFINED
+
+#include "SkTypes.h"
+
+class SkPaint;
+class SkString;
+
+/** \class SkPictureProfile
+
+    Collects where the time goes when a picture is played back with
+    SkPicture::profile(). Every op in the picture is timed on its own, and
+    its time is added to the totals for its type, and to the totals for each
+    of the paint features its paint uses (if it has one).
+
+    Ops inside a nested picture are not broken out: they count toward the
+    DRAW_PICTURE that draws it. Ops that are skipped over (e.g. because they
+    were clipped out) are not counted at all. Timing each op adds some
+    overhead of its own, so the totals are only useful compared to each
+    other, not to an ordinary draw().
+*/
+class SkPictureProfile {
+public:
+    SkPictureProfile();
+
+    enum {
+        kOpTypeCount = 32   //!< more than the number of op types in a picture
+    };
+
+    enum Feature {
+        kShader_Feature,        //!< the paint has a shader
+        kXfermode_Feature,      //!< the paint's xfermode isn't srcover
+        kMaskFilter_Feature,    //!< the paint has a mask filter
+        kAntiAlias_Feature,     //!< the paint is antialiased
+
+        kFeatureCount
+    };
+
+    struct Stat {
+        int     fCount;     //!< number of ops played back
+        double  fUSecs;     //!< total microseconds they took
+    };
+
+    /** Zero all the totals. */
+    void reset();
+
+    /** Return the totals for ops of the specified type, which is one of the
+        picture's internal op types: 0 <= type < kOpTypeCount.
+    */
+    const Stat& op(int type) const {
+        SkASSERT((unsigned)type < kOpTypeCount);
+        return fOps[type];
+    }
+
+    /** Return the totals for ops whose paint has the specified feature. An
+        op may count toward more than one feature.
+    */
+    const Stat& feature(Feature f) const {
+        SkASSERT((unsigned)f < kFeatureCount);
+        return fFeatures[f];
+    }
+
+    /** Return the totals for every op. */
+    const Stat& total() const { return fTotal; }
+
+    /** Return the name of an op type (e.g. "DRAW_RECT"), or NULL if no op
+        has that type.
+    */
+    static const char* OpName(int type);
+    static const char* FeatureName(Feature);
+
+    /** Append a table of the op types and features that were played back,
+        each sorted by their total time, longest first.
+    */
+    void toString(SkString*) const;
+
+    /** Called by the playback for each op. paint is the op's paint, or NULL
+        if it doesn't have one.
+    */
+    void addOp(int type, const SkPaint* paint, double usecs);
+
+private:
+    Stat    fOps[kOpTypeCount];
+    Stat    fFeatures[kFeatureCount];
+    Stat    fTotal;
+};
+
+#endif
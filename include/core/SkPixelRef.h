@@ -17,11 +17,12 @@
 #ifndef SkPixelRef_DEFINED
 #define SkPixelRef_DEFINED
 
+#include "SkBitmap.h"
 #include "SkRefCnt.h"
 #include "SkString.h"
 
-class SkBitmap;
 class SkColorTable;
+class SkData;
 struct SkIRect;
 class SkMutex;
 class SkFlattenableReadBuffer;
@@ -41,9 +42,10 @@ class SkGpuTexture;
 class SkPixelRef : public SkRefCnt {
 public:
     explicit SkPixelRef(SkMutex* mutex = NULL);
+    virtual ~SkPixelRef();
 
     /** Return the pixel memory returned from lockPixels, or null if the
-        lockCount is 0.
+        lockCount is 0 (unless the pixels are pre-locked, see setPreLocked).
     */
     void* pixels() const { return fPixels; }
 
@@ -116,6 +118,12 @@ public:
 
     bool readPixels(SkBitmap* dst, const SkIRect* subset = NULL);
 
+    /** If the pixels are decoded from encoded data (e.g. a JPEG file) that is
+        still around, return a reference to that data, otherwise NULL. The
+        caller must call unref() on the result.
+     */
+    SkData* refEncodedData() { return this->onRefEncodedData(); }
+
     // serialization
 
     typedef SkPixelRef* (*Factory)(SkFlattenableReadBuffer&);
@@ -169,6 +177,10 @@ protected:
      */
     virtual bool onReadPixels(SkBitmap* dst, const SkIRect* subsetOrNull);
 
+    /** The base class implementation returns NULL.
+     */
+    virtual SkData* onRefEncodedData();
+
     /** Return the mutex associated with this pixelref. This value is assigned
         in the constructor, and cannot change during the lifetime of the object.
     */
@@ -176,11 +188,18 @@ protected:
 
     SkPixelRef(SkFlattenableReadBuffer&, SkMutex*);
 
+    /** For subclasses whose pixels stay put (and valid) for the life of the
+        object: call this from the constructor, and lockPixels/unlockPixels
+        will just count, without taking the mutex or calling onLockPixels
+        and onUnlockPixels.
+    */
+    void setPreLocked(void* pixels, SkColorTable* ctable);
+
 private:
     SkMutex*        fMutex; // must remain in scope for the life of this object
     void*           fPixels;
     SkColorTable*   fColorTable;    // we do not track ownership, subclass does
-    int             fLockCount;
+    int32_t         fLockCount;
 
     mutable uint32_t fGenerationID;
 
@@ -188,6 +207,18 @@ private:
 
     // can go from false to true, but never from true to false
     bool    fIsImmutable;
+    // set once, by setPreLocked()
+    bool    fPreLocked;
+
+    // the mip levels SkBitmap::buildMipMap() last built from our pixels, and
+    // the generation ID and subset (offset, width, height) they were built
+    // for. Guarded by fMutex.
+    SkBitmap::MipMap*   fMipMap;
+    uint32_t            fMipMapGenerationID;
+    size_t              fMipMapOffset;
+    int                 fMipMapWidth, fMipMapHeight;
+
+    friend class SkBitmap;
 };
 
 #endif
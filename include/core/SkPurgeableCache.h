@@ -0,0 +1,86 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkPurgeableCache_DEFINED
+#define SkPurgeableCache_DEFINED
+
+#include "SkTypes.h"
+
+/** \class SkPurgeableCache
+
+    A cache that SkGraphics can report on and trim, as part of a budget shared
+    by every cache in the process (see SkGraphics::PurgeToBudget()). Creating
+    one registers it, and deleting it unregisters it, so a global cache is
+    usually a static instance of a subclass, next to the cache itself.
+
+    bytesUsed() and purgeTo() may be called from any thread, at any time
+    between the constructor and the destructor.
+*/
+class SK_API SkPurgeableCache : SkNoncopyable {
+public:
+    /** How expensive the contents are to rebuild. Cheaper caches are
+        purged first.
+    */
+    enum Cost {
+        kCheap_Cost,        //!< e.g. tables computed from a few parameters
+        kModerate_Cost,     //!< e.g. rasterized glyphs or masks
+        kExpensive_Cost     //!< e.g. decoded images, or uploaded textures
+    };
+
+    SkPurgeableCache(const char name[], Cost);
+    virtual ~SkPurgeableCache();
+
+    const char* name() const { return fName; }
+    Cost cost() const { return fCost; }
+
+    /** Return the (approximate) number of bytes used by the cache. */
+    virtual size_t bytesUsed() const = 0;
+
+    /** Purge the cache until no more than the specified number of bytes
+        remain, if it can (e.g. entries that are in use may be kept).
+    */
+    virtual void purgeTo(size_t bytes) = 0;
+
+    struct Usage {
+        const char* fName;
+        Cost        fCost;
+        size_t      fBytesUsed;
+    };
+
+    /** Fill out up to maxCount usages, one per registered cache, and return
+        the number of caches (which may be larger than maxCount). usage may be
+        NULL if maxCount is 0.
+    */
+    static int GetUsage(Usage usage[], int maxCount);
+
+    /** Return the sum of bytesUsed() over every registered cache. */
+    static size_t GetTotalBytesUsed();
+
+    /** Purge the caches, cheapest first (and the largest first among those
+        that cost the same), until no more than the specified number of bytes
+        remains in all of them together. Returns what remains.
+    */
+    static size_t PurgeTo(size_t bytes);
+
+private:
+    const char*         fName;
+    Cost                fCost;
+    SkPurgeableCache*   fPrev;
+    SkPurgeableCache*   fNext;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "SkFlattenable.h"
 #include "SkMask.h"
 
+class SkExecutor;
 class SkMaskFilter;
 class SkMatrix;
 class SkPath;
@@ -30,10 +31,12 @@ public:
     SkRasterizer() {}
 
     /** Turn the path into a mask, respecting the specified local->device matrix.
+        If executor is not null, large masks may be rendered on its threads.
     */
     bool rasterize(const SkPath& path, const SkMatrix& matrix,
                    const SkIRect* clipBounds, SkMaskFilter* filter,
-                   SkMask* mask, SkMask::CreateMode mode);
+                   SkMask* mask, SkMask::CreateMode mode,
+                   SkExecutor* executor = NULL);
 
     virtual void flatten(SkFlattenableWriteBuffer& ) {}
 protected:
@@ -41,7 +44,8 @@ protected:
 
     virtual bool onRasterize(const SkPath& path, const SkMatrix& matrix,
                              const SkIRect* clipBounds,
-                             SkMask* mask, SkMask::CreateMode mode);
+                             SkMask* mask, SkMask::CreateMode mode,
+                             SkExecutor* executor);
 
 private:
     typedef SkFlattenable INHERITED;
@@ -57,6 +57,8 @@ public:
     */
     void unref() const {
         SkASSERT(fRefCnt > 0);
+        // sk_atomic_dec is a full barrier on every port, so whoever takes the
+        // count to zero sees what the other owners wrote before letting go.
         if (sk_atomic_dec(&fRefCnt) == 1) {
             fRefCnt = 1;    // so our destructor won't complain
             SkDELETE(this);
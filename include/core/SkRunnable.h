@@ -0,0 +1,52 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkRunnable_DEFINED
+#define SkRunnable_DEFINED
+
+/** \class SkRunnable
+
+    A unit of work that can be handed to an SkExecutor.
+*/
+class SkRunnable {
+public:
+    virtual ~SkRunnable() {}
+    virtual void run() = 0;
+};
+
+/** \class SkExecutor
+
+    Runs SkRunnables, possibly on other threads (see SkThreadPool). This lets
+    the core hand work off without depending on a particular thread library.
+*/
+class SkExecutor {
+public:
+    virtual ~SkExecutor() {}
+
+    /** Return the number of threads (besides the caller's) that runnables
+        may be run on at the same time. If this is 0, they are all run by
+        wait().
+    */
+    virtual int threadCount() const = 0;
+
+    /** Queue the runnable, which must stay alive until wait() returns. */
+    virtual void add(SkRunnable*) = 0;
+
+    /** Block until every runnable passed to add() has finished running. */
+    virtual void wait() = 0;
+};
+
+#endif
@@ -246,6 +246,16 @@ public:
     void        getMetrics(SkGlyph*);
     void        getImage(const SkGlyph&);
     void        getPath(const SkGlyph&, SkPath*);
+
+    /** Batch versions of getMetrics() and getImage(), for filling in many
+        glyphs of a strike at once. getMetrics() skips the glyphs that already
+        have full metrics. Each glyph passed to getImages() must have full
+        metrics and a non-null fImage. Runs of glyphs from the same font are
+        handed to the port back to back, so it can keep its per-size state
+        set up across the run.
+    */
+    void        getMetrics(SkGlyph* const glyphs[], int count);
+    void        getImages(const SkGlyph* const glyphs[], int count);
     void        getFontMetrics(SkPaint::FontMetrics* mX,
                                SkPaint::FontMetrics* mY);
 
@@ -267,11 +277,21 @@ protected:
     // default impl returns 0, indicating failure.
     virtual SkUnichar generateGlyphToChar(uint16_t);
 
+    /** Return the table (e.g. for gamma) that getImage() maps the A8 image
+        from generateImage() through, or NULL if there is none. Calling this
+        from generateImage() promises to map the image itself, e.g. with
+        sk_table8() as it copies the pixels, so that getImage() won't.
+    */
+    const uint8_t* takeImageTable();
+
 private:
     SkPathEffect*   fPathEffect;
     SkMaskFilter*   fMaskFilter;
     SkRasterizer*   fRasterizer;
     SkScalar        fDevFrameWidth;
+    bool            fImageTableTaken;   // during generateImage()
+
+    const uint8_t* getImageTable() const;
 
     void internalGetPath(const SkGlyph& glyph, SkPath* fillPath,
                          SkPath* devPath, SkMatrix* fillToDevMatrix);
@@ -18,10 +18,12 @@
 #ifndef SkScan_DEFINED
 #define SkScan_DEFINED
 
+#include "SkPaint.h"
 #include "SkRect.h"
 
 class SkRegion;
 class SkBlitter;
+class SkExecutor;
 class SkPath;
 
 /** Defines a fixed-point rectangle, identical to the integer SkIRect, but its
@@ -31,6 +33,11 @@ typedef SkIRect SkXRect;
 
 class SkScan {
 public:
+    enum {
+        // the most bands a path is filled in at once (see FillPath)
+        kMaxFillBands = 16
+    };
+
     static void FillIRect(const SkIRect&, const SkRegion* clip, SkBlitter*);
     static void FillXRect(const SkXRect&, const SkRegion* clip, SkBlitter*);
 
@@ -43,6 +50,15 @@ public:
     static void FillRect(const SkRect&, const SkRegion* clip, SkBlitter*);
 #endif
     static void FillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
+    /** Fill the path as above, but split into up to count horizontal bands
+        that are filled at the same time on the executor's threads (and the
+        caller's), the i'th band into blitters[i]. The edges are only built
+        once, and what is blitted is the same as for the serial fill. Paths
+        that are too small to be worth splitting, and inverse fills, are
+        filled serially into blitters[0].
+     */
+    static void FillPath(const SkPath&, const SkRegion& clip,
+                         SkBlitter* blitters[], int count, SkExecutor*);
 
     static void FillTriangle(const SkPoint pts[], const SkRegion*, SkBlitter*);
     static void FillTriangle(const SkPoint& a, const SkPoint& b,
@@ -71,12 +87,27 @@ public:
 #endif
     
     static void AntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
+    // same as FillPath with bands, but antialiased
+    static void AntiFillPath(const SkPath&, const SkRegion& clip,
+                             SkBlitter* blitters[], int count, SkExecutor*);
+    // same as AntiFillPath, but computes the exact area covered in each pixel
+    // rather than supersampling
+    static void AnalyticFillPath(const SkPath&, const SkRegion& clip,
+                                 SkBlitter*);
 
     static void AntiHairLine(const SkPoint&, const SkPoint&, const SkRegion*,
                              SkBlitter*);
     static void AntiHairRect(const SkRect&, const SkRegion* clip, SkBlitter*);
     static void AntiHairPath(const SkPath&, const SkRegion* clip, SkBlitter*);
 
+    // Strokes a (device space) path of lines whose width is at most 2 pixels
+    // without building its outline, in one pass over the path. Joins are
+    // drawn round, and curves as their chords. Some pixels at joins and round
+    // caps are drawn twice, so the blitter's paint should be opaque.
+    static void AntiThinStrokePath(const SkPath&, SkScalar width,
+                                   SkPaint::Cap, const SkRegion& clip,
+                                   SkBlitter*);
+
     // draws with a miter-join
     static void FrameRect(const SkRect&, const SkPoint& strokeSize,
                           const SkRegion*, SkBlitter*);
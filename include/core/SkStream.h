@@ -60,6 +60,14 @@ public:
     */
     virtual const void* getMemoryBase();
 
+    /** Hint that length bytes starting at offset (from the beginning of the
+        stream) will be read soon, so that a stream backed by a file or the
+        network can start fetching them. This never changes the position of
+        the stream. Returns true if the hint was taken; the default ignores
+        it and returns false.
+    */
+    virtual bool prefetch(size_t offset, size_t length);
+
     int8_t   readS8();
     int16_t  readS16();
     int32_t  readS32();
@@ -105,6 +113,19 @@ public:
     bool writeStream(SkStream* input, size_t length);
 
     bool writeData(const SkData*);
+
+    /** One piece of a gathered write: fSize bytes starting at fData.
+    */
+    struct Chunk {
+        const void* fData;
+        size_t      fSize;
+    };
+    /** Write count chunks, one after the other, as if write() was called on
+        each in turn. Subclasses that can take them all at once may override
+        this.
+        @return true on success
+    */
+    virtual bool writev(const Chunk chunks[], int count);
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -135,6 +156,7 @@ public:
     virtual bool rewind();
     virtual size_t read(void* buffer, size_t size);
     virtual const char* getFileName();
+    virtual bool prefetch(size_t offset, size_t length);
 
 private:
     SkFILE*     fFILE;
@@ -159,6 +181,7 @@ public:
     virtual bool rewind();
     virtual size_t read(void* buffer, size_t size);
     virtual const char* getFileName() { return NULL; }
+    virtual bool prefetch(size_t offset, size_t length);
     
 private:
     int     fFD;
@@ -242,6 +265,7 @@ public:
     virtual const char* getFileName();
     virtual size_t      read(void* buffer, size_t size);
     virtual const void* getMemoryBase();
+    virtual bool        prefetch(size_t offset, size_t length);
 
 private:
     enum {
@@ -261,6 +285,10 @@ private:
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 
+/** A stream that writes to a file, through a buffer of its own so that lots of
+    small writes turn into a few large ones. What is still in the buffer goes
+    to the file on flush(), and when the stream is destroyed.
+ */
 class SK_API SkFILEWStream : public SkWStream {
 public:
             SkFILEWStream(const char path[]);
@@ -273,7 +301,15 @@ public:
     virtual bool write(const void* buffer, size_t size);
     virtual void flush();
 private:
+    enum {
+        kBufferSize = 4096
+    };
     SkFILE* fFILE;
+    size_t  fBufferUsed;
+    char    fBuffer[kBufferSize];
+
+    bool writeBuffer();
+    bool writeFile(const void* buffer, size_t size);
 };
 
 class SkMemoryWStream : public SkWStream {
@@ -289,7 +325,10 @@ private:
 
 class SK_API SkDynamicMemoryWStream : public SkWStream {
 public:
-    SkDynamicMemoryWStream();
+    /** Blocks are at least minBlockSize bytes (or a default, if that is 0),
+        and grow along with the amount written, up to a limit.
+    */
+    explicit SkDynamicMemoryWStream(size_t minBlockSize = 0);
     virtual ~SkDynamicMemoryWStream();
 
     virtual bool write(const void* buffer, size_t size);
@@ -309,6 +348,19 @@ public:
      */
     SkData* copyToData() const;
 
+    /**
+     *  Return the data written so far, and reset the stream. If it all fits
+     *  in one block, the SkData takes that block over instead of copying it.
+     *  The caller is responsible for calling unref() on the data.
+     */
+    SkData* detachAsData();
+
+    /**
+     *  Write what has been written to this stream to dst, a block at a time,
+     *  without gathering it into one piece first.
+     */
+    bool writeToStream(SkWStream* dst) const;
+
     // reset the stream to its original state
     void reset();
     void padToAlign4();
@@ -317,9 +369,11 @@ private:
     Block*  fHead;
     Block*  fTail;
     size_t  fBytesWritten;
+    size_t  fMinBlockSize;
     mutable SkData* fCopy;  // is invalidated if we write after it is created
 
     void invalidateCopy();
+    Block* appendBlock(size_t minSize);
 };
 
 
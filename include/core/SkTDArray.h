@@ -310,5 +310,195 @@ private:
     }
 };
 
+/** \class SkSTDArray
+
+    Like SkTDArray, but the first N elements live inside the array itself, so
+    that arrays that stay small never touch the heap. Since the elements may
+    be inside it, an SkSTDArray must not be moved with memcpy.
+*/
+template <int N, typename T> class SkSTDArray {
+public:
+    SkSTDArray() {
+        fArray = this->storage();
+        fReserve = N;
+        fCount = 0;
+    }
+    SkSTDArray(const SkSTDArray<N, T>& src) {
+        fArray = this->storage();
+        fReserve = N;
+        fCount = 0;
+        this->append(src.fCount, src.fArray);
+    }
+    ~SkSTDArray() {
+        if (!this->isInline()) {
+            sk_free(fArray);
+        }
+    }
+
+    SkSTDArray<N, T>& operator=(const SkSTDArray<N, T>& src) {
+        if (this != &src) {
+            this->rewind();
+            this->append(src.fCount, src.fArray);
+        }
+        return *this;
+    }
+
+    friend int operator==(const SkSTDArray<N, T>& a,
+                          const SkSTDArray<N, T>& b) {
+        return  a.fCount == b.fCount &&
+                (a.fCount == 0 ||
+                 !memcmp(a.fArray, b.fArray, a.fCount * sizeof(T)));
+    }
+
+    void swap(SkSTDArray<N, T>& other) {
+        if (this->isInline() || other.isInline()) {
+            SkSTDArray<N, T> tmp;
+            tmp.take(this);
+            this->take(&other);
+            other.take(&tmp);
+        } else {
+            SkTSwap(fArray, other.fArray);
+            SkTSwap(fReserve, other.fReserve);
+            SkTSwap(fCount, other.fCount);
+        }
+    }
+
+    bool isEmpty() const { return fCount == 0; }
+    int count() const { return fCount; }
+    T*  begin() const { return fArray; }
+    T*  end() const { return fArray + fCount; }
+    T&  operator[](int index) const {
+        SkASSERT((unsigned)index < fCount);
+        return fArray[index];
+    }
+
+    /** Empty the array, and give back any memory it allocated. */
+    void reset() {
+        if (!this->isInline()) {
+            sk_free(fArray);
+            fArray = this->storage();
+            fReserve = N;
+        }
+        fCount = 0;
+    }
+
+    void rewind() {
+        // same as setCount(0)
+        fCount = 0;
+    }
+
+    void setCount(size_t count) {
+        if (count > fReserve) {
+            this->growBy(count - fCount);
+        } else {
+            fCount = count;
+        }
+    }
+
+    void setReserve(size_t reserve) {
+        if (reserve > fReserve) {
+            size_t count = fCount;
+            this->growBy(reserve - fCount);
+            fCount = count;
+        }
+    }
+
+    T* append() {
+        return this->append(1, NULL);
+    }
+    T* append(size_t count, const T* src = NULL) {
+        size_t oldCount = fCount;
+        if (count) {
+            SkASSERT(src == NULL ||
+                     src + count <= fArray || fArray + oldCount <= src);
+            this->growBy(count);
+            if (src) {
+                memcpy(fArray + oldCount, src, sizeof(T) * count);
+            }
+        }
+        return fArray + oldCount;
+    }
+
+    void remove(size_t index, size_t count = 1) {
+        SkASSERT(index + count <= fCount);
+        fCount = fCount - count;
+        memmove(fArray + index, fArray + index + count,
+                sizeof(T) * (fCount - index));
+    }
+
+    void removeShuffle(size_t index) {
+        SkASSERT(index < fCount);
+        size_t newCount = fCount - 1;
+        fCount = newCount;
+        if (index != newCount) {
+            memcpy(fArray + index, fArray + newCount, sizeof(T));
+        }
+    }
+
+    // routines to treat the array like a stack
+    T*          push() { return this->append(); }
+    void        push(const T& elem) { *this->append() = elem; }
+    const T&    top() const { return (*this)[fCount - 1]; }
+    T&          top() { return (*this)[fCount - 1]; }
+    void        pop(T* elem) { if (elem) *elem = (*this)[fCount - 1]; --fCount; }
+    void        pop() { --fCount; }
+
+#ifdef SK_DEBUG
+    void validate() const {
+        SkASSERT(fReserve >= N);
+        SkASSERT(this->isInline() == (fReserve == N));
+        SkASSERT(fCount <= fReserve);
+    }
+#endif
+
+private:
+    T*      fArray;
+    size_t  fReserve, fCount;
+    union {
+        uint32_t    fStorage32[(N * sizeof(T) + 3) >> 2];
+        T           fTStorage[1];   // do NOT want to invoke T::T()
+    };
+
+    T* storage() { return fTStorage; }
+    bool isInline() const { return fArray == fTStorage; }
+
+    // the same growth as SkTDArray, except that leaving the inline storage
+    // means copying out of it
+    void growBy(size_t extra) {
+        SkASSERT(extra);
+
+        if (fCount + extra > fReserve) {
+            size_t size = fCount + extra + 4;
+            size += size >> 2;
+
+            if (this->isInline()) {
+                T* array = (T*)sk_malloc_throw(size * sizeof(T));
+                memcpy(array, fArray, fCount * sizeof(T));
+                fArray = array;
+            } else {
+                fArray = (T*)sk_realloc_throw(fArray, size * sizeof(T));
+            }
+            fReserve = size;
+        }
+        fCount += extra;
+    }
+
+    // src's elements become ours, and src is left empty
+    void take(SkSTDArray<N, T>* src) {
+        this->reset();
+        if (src->isInline()) {
+            memcpy(fArray, src->fArray, src->fCount * sizeof(T));
+            fCount = src->fCount;
+        } else {
+            fArray = src->fArray;
+            fReserve = src->fReserve;
+            fCount = src->fCount;
+            src->fArray = src->storage();
+            src->fReserve = N;
+        }
+        src->fCount = 0;
+    }
+};
+
 #endif
 
@@ -0,0 +1,54 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkTLS_DEFINED
+#define SkTLS_DEFINED
+
+#include "SkTypes.h"
+
+/** \class SkTLS
+
+    Per-thread objects, each identified by the proc that creates it.
+*/
+class SkTLS {
+public:
+    typedef void* (*CreateProc)();
+    typedef void  (*DeleteProc)(void*);
+
+    /** Return the calling thread's object for createProc, calling createProc
+        to make it the first time this thread asks. deleteProc (if not null)
+        is called on it when the thread exits.
+    */
+    static void* Get(CreateProc, DeleteProc);
+
+    /** Return the calling thread's object for createProc, or null if it
+        hasn't been made yet.
+    */
+    static void* Find(CreateProc);
+
+private:
+    // implemented by the porting layer: a single pointer for each thread,
+    // initially null. The port calls Destructor() with the pointer's value
+    // when a thread exits with it set, if the platform can tell.
+    static void* PlatformGetSpecific();
+    static void  PlatformSetSpecific(void*);
+
+public:
+    // only for the porting layer
+    static void Destructor(void* ptr);
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkTextBlob_DEFINED
+#define SkTextBlob_DEFINED
+
+#include "SkPaint.h"
+#include "SkRect.h"
+#include "SkRefCnt.h"
+
+class SkCanvas;
+
+/** \class SkTextBlob
+
+    An immutable run of text that has already been converted to glyph IDs and
+    positioned, for text that is drawn many times (e.g. labels that are redrawn
+    every frame). The blob remembers the font attributes of the paint it was
+    created with (typeface, size, scale, skew, hinting, alignment, and the
+    antialias and text flags), so drawing it only takes the remaining
+    attributes (color, shader, style, ...) from the paint passed to
+    SkCanvas::drawTextBlob().
+
+    Each blob has a uniqueID, so devices can cache work for blobs they have
+    already seen.
+*/
+class SkTextBlob : public SkRefCnt {
+public:
+    /** Create a blob for the text, laid out as drawText() would lay it out
+        with its origin at (0, 0). The caller must call unref() on the result.
+     */
+    static SkTextBlob* Create(const void* text, size_t byteLength,
+                              const SkPaint& paint);
+
+    /** Create a blob for the text, with each character placed at the
+        corresponding entry of pos[], as drawPosText() would place it. The
+        caller must call unref() on the result.
+     */
+    static SkTextBlob* Create(const void* text, size_t byteLength,
+                              const SkPoint pos[], const SkPaint& paint);
+
+    virtual ~SkTextBlob();
+
+    int glyphCount() const { return fGlyphCount; }
+    const uint16_t* glyphs() const { return fGlyphs; }
+    /** The origin of each glyph. The paint's alignment has already been
+        applied, so these are always left-aligned origins.
+     */
+    const SkPoint* positions() const { return fPositions; }
+
+    /** Conservative bounds of the glyphs, relative to the blob's origin,
+        when filled with the blob's font (styles and effects from the draw
+        paint are not included).
+     */
+    const SkRect& bounds() const { return fBounds; }
+
+    uint32_t uniqueID() const { return fUniqueID; }
+
+    /** Copy the blob's font attributes into paint, and set its encoding to
+        kGlyphID_TextEncoding and its alignment to kLeft_Align, so that it can
+        draw glyphs() at positions().
+     */
+    void applyFont(SkPaint* paint) const;
+
+    /** Returns true if a and b have the same font attributes (those that
+        applyFont() copies, and the alignment), so that blobs made with either
+        would hold the same glyphs at the same positions.
+     */
+    static bool SameFont(const SkPaint& a, const SkPaint& b);
+
+    /** Draw the blob at (x, y) through canvas->drawPosText(). This is how
+        canvases that do not rasterize (e.g. recording or forwarding ones)
+        can implement drawTextBlob().
+     */
+    void drawAsPosText(SkCanvas* canvas, SkScalar x, SkScalar y,
+                       const SkPaint& paint) const;
+
+private:
+    SkTextBlob(const SkPaint& font, int glyphCount);
+
+    SkPaint     fFont;
+    int         fGlyphCount;
+    uint16_t*   fGlyphs;
+    SkPoint*    fPositions;
+    SkRect      fBounds;
+    uint32_t    fUniqueID;
+
+    static SkTextBlob* Build(const void* text, size_t byteLength,
+                             const SkPoint pos[], const SkPaint& paint);
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
@@ -18,12 +18,14 @@
 #define SkThread_DEFINED
 
 #include "SkTypes.h"
+#include "SkRunnable.h"
 #include "SkThread_platform.h"
 
 /****** SkThread_platform needs to define the following...
 
 int32_t sk_atomic_inc(int32_t*);
 int32_t sk_atomic_dec(int32_t*);
+int32_t sk_atomic_add(int32_t*, int32_t inc);
 
 class SkMutex {
 public:
@@ -34,6 +36,19 @@ public:
     void    release();
 };
 
+class SkSemaphore {
+public:
+    SkSemaphore(int count);
+    ~SkSemaphore();
+
+    void    signal(int n);
+    void    wait();
+};
+
+int  sk_num_cores();
+bool sk_start_thread(void (*proc)(void*), void* data);
+void sk_thread_yield();
+
 ****************/
 
 class SkAutoMutexAcquire : SkNoncopyable {
@@ -65,4 +80,53 @@ private:
     SkMutex* fMutex;
 };
 
+/** \class SkTaskGroup
+
+    Runs SkRunnables on a process-wide pool of worker threads, and waits for
+    the ones that were added to it. Each worker has its own queue, which it
+    runs newest first; once that is empty, it steals the oldest work from the
+    others, so that one long queue gets shared out. The pool is started the
+    first time it is needed, with a thread for each core but the caller's.
+
+    Without thread support (see SkThread_none.cpp), or on a single core, the
+    runnables are run on the calling thread by wait().
+*/
+class SkTaskGroup : public SkExecutor, SkNoncopyable {
+public:
+    SkTaskGroup();
+    /** Waits for any runnables that have not finished. */
+    virtual ~SkTaskGroup();
+
+    /** Return the number of worker threads in the pool. */
+    virtual int threadCount() const;
+
+    /** Queue the runnable, which must stay alive until wait() returns. */
+    virtual void add(SkRunnable*);
+
+    /** Block until every runnable added to this group has finished running.
+        Queued runnables (of any group) are run on the calling thread in the
+        meantime, so wait() may be called from a runnable.
+    */
+    virtual void wait();
+
+    /** Set how many worker threads the pool starts, instead of one for each
+        core but the caller's. This only has an effect before the pool is
+        first used.
+    */
+    static void SetThreadCount(int count);
+
+private:
+    int32_t fPending;
+};
+
+/** Called by SkParallelFor for the indices in [start, stop). */
+typedef void (*SkParallelForProc)(void* context, int start, int stop);
+
+/** Call proc for every index in [start, stop), in ranges of grain indices (or
+    fewer, at the end) that are run at the same time on SkTaskGroup's pool and
+    the calling thread. Returns once proc has been called for all of them.
+*/
+SK_API void SkParallelFor(int start, int stop, int grain,
+                          SkParallelForProc proc, void* context);
+
 #endif
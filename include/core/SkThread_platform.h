@@ -24,6 +24,7 @@
 
 #define sk_atomic_inc(addr)     android_atomic_inc(addr)
 #define sk_atomic_dec(addr)     android_atomic_dec(addr)
+#define sk_atomic_add(addr, inc) android_atomic_add(inc, addr)
 
 class SkMutex : android::Mutex {
 public:
@@ -47,6 +48,11 @@ SK_API int32_t sk_atomic_inc(int32_t* addr);
     value.
 */
 SK_API int32_t sk_atomic_dec(int32_t* addr);
+/** Implemented by the porting layer, this function adds inc to the int
+    specified by the address (in a thread-safe manner), and returns the
+    previous value.
+*/
+SK_API int32_t sk_atomic_add(int32_t* addr, int32_t inc);
 
 class SkMutex {
 public:
@@ -68,4 +74,39 @@ private:
 
 #endif
 
+/** Implemented by the porting layer, a counting semaphore. wait() blocks until
+    the count is above 0, and then takes 1 from it.
+*/
+class SkSemaphore {
+public:
+    explicit SkSemaphore(int count = 0);
+    ~SkSemaphore();
+
+    void    signal(int n = 1);
+    void    wait();
+
+private:
+    enum {
+        kStorageIntCount = 64
+    };
+    uint32_t    fStorage[kStorageIntCount];
+};
+
+/** Implemented by the porting layer, this function returns the number of
+    cores the process can run on, or 1 if that is unknown or there is no
+    thread support.
+*/
+SK_API int sk_num_cores();
+
+/** Implemented by the porting layer, this function starts a thread that calls
+    proc(data), and is never joined. Returns false if the thread could not be
+    started (which is always the case without thread support).
+*/
+SK_API bool sk_start_thread(void (*proc)(void*), void* data);
+
+/** Implemented by the porting layer, this function lets other threads run
+    before the caller carries on.
+*/
+SK_API void sk_thread_yield();
+
 #endif
@@ -36,6 +36,12 @@ public:
     static void GetDateTime(DateTime*);
 
     static SkMSec GetMSecs();
+
+    /** Return a count of microseconds from some fixed point, with enough
+        precision to time short spans (e.g. a single draw). Unlike GetMSecs()
+        it doesn't jump when the time of day is changed.
+    */
+    static double GetUSecs();
 };
 
 #if defined(SK_DEBUG) && defined(SK_BUILD_FOR_WIN32)
@@ -0,0 +1,141 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkTrace_DEFINED
+#define SkTrace_DEFINED
+
+#include "SkThread.h"
+#include "SkTime.h"
+
+class SkWStream;
+
+/** \class SkTrace
+
+    Counters and timed events for the hot paths, which can be written out in
+    the Chrome trace format (for chrome://tracing, or about:tracing). The
+    SK_TRACE_ macros below only compile to anything if SK_ENABLE_TRACE is
+    defined (see SkUserConfig.h), so they cost nothing otherwise.
+
+    Counters always count. Events are only recorded while tracing is enabled
+    (which is checked with a single load), into a buffer that holds the first
+    kMaxEvents of them; later ones are dropped, but still counted.
+*/
+class SK_API SkTrace {
+public:
+    enum {
+        kMaxEvents = 64 * 1024
+    };
+
+    /** A named total, kept with an atomic add. It should be a static (at
+        file scope, so that it exists before any thread can use it), and
+        its name a literal. The count wraps around after 2^31, so sample it
+        (or Reset()) rather than let it run for hours.
+    */
+    class SK_API Counter {
+    public:
+        Counter(const char name[]);
+
+        void add(int32_t delta) { sk_atomic_add(&fValue, delta); }
+        void inc() { sk_atomic_inc(&fValue); }
+
+        const char* name() const { return fName; }
+        int32_t value() const { return fValue; }
+
+    private:
+        const char* fName;
+        int32_t     fValue;
+        Counter*    fNext;
+
+        friend class SkTrace;
+    };
+
+    /** Records an event for the time from its constructor to its destructor,
+        if tracing was enabled when it was constructed. name must be a literal
+        (or otherwise outlive the trace).
+    */
+    class AutoEvent {
+    public:
+        AutoEvent(const char name[]) {
+            if (gEnabled) {
+                fName = name;
+                fStart = SkTime::GetUSecs();
+            } else {
+                fName = NULL;
+            }
+        }
+        ~AutoEvent() {
+            if (fName) {
+                SkTrace::RecordEvent(fName, fStart, SkTime::GetUSecs());
+            }
+        }
+
+    private:
+        const char* fName;
+        double      fStart;
+    };
+
+    /** Start (or stop) recording events. Enabling tracing doesn't clear the
+        events recorded before; call Reset() for that.
+    */
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled() { return gEnabled; }
+
+    /** Forget the events recorded so far, and zero the counters. This must
+        not be called while other threads may be recording.
+    */
+    static void Reset();
+
+    /** Return how many events have been recorded (up to kMaxEvents), and
+        how many more were dropped for want of room.
+    */
+    static int GetEventCount();
+    static int GetDroppedEventCount();
+
+    /** Return the counter with this name, or NULL if there isn't one. */
+    static const Counter* FindCounter(const char name[]);
+
+    /** Record an event that took from start to stop (in SkTime::GetUSecs()
+        microseconds), on the calling thread.
+    */
+    static void RecordEvent(const char name[], double start, double stop);
+
+    /** Write the events, then the counters' current values, as a Chrome
+        trace: {"traceEvents": [...]}. Tracing should be disabled first, or
+        events that are being recorded at the same time may be left out.
+    */
+    static void WriteJSON(SkWStream*);
+
+private:
+    static bool gEnabled;
+};
+
+#ifdef SK_ENABLE_TRACE
+    #define SK_TRACE_COUNTER(var, name)     static SkTrace::Counter var(name)
+    #define SK_TRACE_ADD(var, delta)        var.add(delta)
+    #define SK_TRACE_INC(var)               var.inc()
+    #define SK_TRACE_EVENT_CONCAT(a, b)     a##b
+    #define SK_TRACE_EVENT_VAR(line)        SK_TRACE_EVENT_CONCAT(trace_event_, line)
+    #define SK_TRACE_EVENT(name)            \
+        SkTrace::AutoEvent SK_TRACE_EVENT_VAR(__LINE__)(name)
+#else
+    #define SK_TRACE_COUNTER(var, name)
+    #define SK_TRACE_ADD(var, delta)        do {} while (0)
+    #define SK_TRACE_INC(var)               do {} while (0)
+    #define SK_TRACE_EVENT(name)            do {} while (0)
+#endif
+
+#endif
@@ -209,6 +209,9 @@ static inline bool SkIsU16(long x) {
 /** Returns x rounded up to a multiple of 4
 */
 #define SkAlign4(x)     (((x) + 3) >> 2 << 2)
+/** Returns x rounded up to a multiple of 8
+*/
+#define SkAlign8(x)     (((x) + 7) >> 3 << 3)
 
 typedef uint32_t SkFourByteTag;
 #define SkSetFourByteTag(a, b, c, d)    (((a) << 24) | ((b) << 16) | ((c) << 8) | (d))
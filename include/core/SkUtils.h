@@ -22,6 +22,25 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/** The instruction set extensions that the platform procs (see src/opts)
+    choose their kernels by.
+*/
+enum SkCpuFeature {
+    kSSE2_SkCpuFeature  = 1 << 0,
+    kSSSE3_SkCpuFeature = 1 << 1,
+    kSSE41_SkCpuFeature = 1 << 2,
+    kAVX2_SkCpuFeature  = 1 << 3
+};
+
+/** Returns the SkCpuFeature bits of the CPU we're running on, or 0 on
+    platforms whose procs are chosen at compile time. The CPU is only probed
+    the first time; SkGraphics::Init() does that, so the platform procs never
+    have to.
+*/
+uint32_t SkGetCpuFeatures();
+
+///////////////////////////////////////////////////////////////////////////////
+
 /** Similar to memset(), but it assigns a 16bit value into the buffer.
     @param buffer   The memory to have value copied into it
     @param value    The 16bit value to be copied into buffer
@@ -55,6 +74,78 @@ extern SkMemset16Proc sk_memset16;
 extern SkMemset32Proc sk_memset32;
 #endif
 
+/** Fill a rect of 16bit values, whose rows are rowBytes apart, as
+    sk_memset16() does each row. Platforms may write big rects around the
+    cache, since they are unlikely to still be in it by the time they are read.
+    @param dst      The first value of the top row
+    @param value    The 16bit value to be copied into each row
+    @param width    The number of values in each row
+    @param height   The number of rows
+    @param rowBytes The distance in bytes from one row to the next
+*/
+void sk_memset_rect16_portable(uint16_t dst[], uint16_t value, int width,
+                               int height, size_t rowBytes);
+typedef void (*SkMemsetRect16Proc)(uint16_t dst[], uint16_t value, int width,
+                                   int height, size_t rowBytes);
+SkMemsetRect16Proc SkMemsetRect16GetPlatformProc();
+
+extern SkMemsetRect16Proc sk_memset_rect16;
+
+/** Fill a rect of 32bit values, as sk_memset_rect16() does for 16bit ones.
+*/
+void sk_memset_rect32_portable(uint32_t dst[], uint32_t value, int width,
+                               int height, size_t rowBytes);
+typedef void (*SkMemsetRect32Proc)(uint32_t dst[], uint32_t value, int width,
+                                   int height, size_t rowBytes);
+SkMemsetRect32Proc SkMemsetRect32GetPlatformProc();
+
+extern SkMemsetRect32Proc sk_memset_rect32;
+
+/** Map each byte through a table, as gamma and SkTableMaskFilter do to the
+    pixels of A8 masks: dst[i] = table[src[i]].
+    @param dst      The bytes to write. May be the same as src, but may not
+                    otherwise overlap it.
+    @param src      The bytes to map
+    @param count    The number of bytes in dst and src
+    @param table    The 256 bytes that each value is mapped to
+*/
+void sk_table8_portable(uint8_t dst[], const uint8_t src[], int count,
+                        const uint8_t table[256]);
+typedef void (*SkTable8Proc)(uint8_t dst[], const uint8_t src[], int count,
+                             const uint8_t table[256]);
+SkTable8Proc SkTable8GetPlatformProc();
+
+extern SkTable8Proc sk_table8;
+
+/** Convert 565 pixels to SkPMColors, as SkPixel16ToPixel32() does, for
+    SkBitmap::copyTo() and the image encoders.
+    @param dst      The SkPMColors to write. May not overlap src.
+    @param src      The 565 pixels to convert
+    @param count    The number of pixels in dst and src
+*/
+void sk_pixel16_to_pixel32_portable(uint32_t dst[], const uint16_t src[],
+                                    int count);
+typedef void (*SkPixel16ToPixel32Proc)(uint32_t dst[], const uint16_t src[],
+                                       int count);
+SkPixel16ToPixel32Proc SkPixel16ToPixel32GetPlatformProc();
+
+extern SkPixel16ToPixel32Proc sk_pixel16_to_pixel32;
+
+/** Unpremultiply SkPMColors with the scales in SkUnPreMultiply, writing each
+    one as R, G, B, A bytes, which is the order the image encoders want.
+    Colors whose alpha is 0 or 255 keep their components as they are.
+    @param dst      The 4 * count bytes to write. May not overlap src.
+    @param src      The SkPMColors to unpremultiply
+    @param count    The number of colors in src
+*/
+void sk_unpremultiply_to_rgba_portable(uint8_t dst[], const uint32_t src[],
+                                       int count);
+typedef void (*SkUnPremultiplyToRGBAProc)(uint8_t dst[], const uint32_t src[],
+                                          int count);
+SkUnPremultiplyToRGBAProc SkUnPremultiplyToRGBAGetPlatformProc();
+
+extern SkUnPremultiplyToRGBAProc sk_unpremultiply_to_rgba;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define kMaxBytesInUTF8Sequence     4
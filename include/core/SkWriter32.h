@@ -28,29 +28,63 @@ class SkWStream;
 
 class SkWriter32 : SkNoncopyable {
 public:
+    /**
+     *  The writer allocates blocks of at least minSize bytes as it needs them,
+     *  each at least as big as everything written so far.
+     */
     SkWriter32(size_t minSize)
         : fMinSize(minSize),
           fSize(0),
-          fSingleBlock(NULL),
-          fSingleBlockSize(0),
           fHead(NULL),
           fTail(NULL) {
     }
+
+    /**
+     *  Write into the caller's storage (which must outlive the writer, or
+     *  the next reset(block, size)) until it is full, and then into blocks
+     *  allocated as above.
+     */
+    SkWriter32(size_t minSize, void* storage, size_t size)
+        : fMinSize(minSize),
+          fSize(0),
+          fHead(NULL),
+          fTail(NULL) {
+        this->reset(storage, size);
+    }
+
     ~SkWriter32();
 
     /**
-     *  Returns the single block backing the writer, or NULL if the memory is
-     *  to be dynamically allocated.
+     *  Returns the caller's storage backing the writer, or NULL if the memory
+     *  is all dynamically allocated.
      */
-    void* getSingleBlock() const { return fSingleBlock; }
+    void* getSingleBlock() const {
+        return fHead == &fExternal ? fExternal.fData : NULL;
+    }
 
     /**
-     *  Specify the single block to back the writer, rathern than dynamically
-     *  allocating the memory. If block == NULL, then the writer reverts to
-     *  dynamic allocation (and resets).
+     *  Specify the storage to write into, rather than dynamically allocating
+     *  the memory (until it fills up). If block == NULL, then the writer
+     *  reverts to dynamic allocation. Either way, the writer is reset.
      */
     void reset(void* block, size_t size);
-                    
+
+    /**
+     *  Returns what has been written if it is all in one block (e.g. it fits
+     *  in the block passed to reset(block, size)), so that it can be read
+     *  (say with SkReader32) without calling flatten(). Otherwise returns
+     *  NULL. The pointer is valid until the next write or reset.
+     */
+    const void* contiguousArray() const;
+
+    /**
+     *  If what has been written is all in one block that the writer
+     *  allocated, returns it (allocated with sk_malloc, for the caller to
+     *  sk_free) and resets the writer without it. Otherwise returns NULL,
+     *  and leaves the writer as it is.
+     */
+    void* detachContiguousArray();
+
     bool writeBool(bool value) {
         this->writeInt(value);
         return value;
@@ -120,9 +154,22 @@ public:
 
     // return the current offset (will always be a multiple of 4)
     uint32_t  size() const { return fSize; }
+
+    /**
+     *  Empties the writer, keeping its memory (and the caller's storage, if
+     *  any) to write into again. If what was written had spilled over several
+     *  allocated blocks, they are replaced by one as big as all of them, so
+     *  writing as much again needs no allocations and is contiguous.
+     */
     void      reset();
     uint32_t* reserve(size_t size); // size MUST be multiple of 4
 
+    /**
+     *  Forget what was written after offset (which must be a multiple of 4,
+     *  and no more than size()), keeping the memory to write into again.
+     */
+    void      rewindToOffset(size_t offset);
+
     // return the address of the 4byte int at the specified offset (which must
     // be a multiple of 4. This does not allocate any new space, so the returned
     // address is only valid for 1 int.
@@ -138,17 +185,24 @@ public:
     bool writeToStream(SkWStream*);
 
 private:
+    struct Block {
+        Block*  fNext;
+        char*   fData;
+        size_t  fSize;
+        size_t  fAllocated;
+
+        size_t  available() const { return fSize - fAllocated; }
+    };
+
     size_t      fMinSize;
     uint32_t    fSize;
 
-    char*       fSingleBlock;
-    uint32_t    fSingleBlockSize;
-    
-    struct Block;
-    Block*  fHead;
-    Block*  fTail;
+    Block       fExternal;  // the caller's storage, if fHead points to it
+    Block*      fHead;
+    Block*      fTail;      // the block being written to; later ones are spare
 
-    Block* newBlock(size_t bytes);
+    Block* nextBlock(size_t bytes);
+    void freeBlocks(Block* block);
 };
 
 #endif
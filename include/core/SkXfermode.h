@@ -154,6 +154,18 @@ public:
       */
     static SkXfermodeProc16 GetProc16(Mode mode, SkColor srcColor);
 
+    /** Function pointer that applies a transfer mode to a row of 32bit
+        colors, with no coverage.
+     */
+    typedef void (*Proc32)(SkPMColor dst[], const SkPMColor src[], int count);
+
+    /** Return a platform-specific row proc for the specified mode, or NULL if
+        there is none. When it exists, it must produce exactly the same result
+        as calling GetProc(mode) on each pixel. This is implemented in the
+        src/opts/ files for each platform.
+     */
+    static Proc32 PlatformProcs32(Mode mode);
+
     /**
      *  If the specified mode can be represented by a pair of Coeff, then return
      *  true and set (if not NULL) the corresponding coeffs. If the mode is
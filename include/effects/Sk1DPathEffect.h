@@ -19,8 +19,7 @@
 
 #include "SkPathEffect.h"
 #include "SkPath.h"
-
-class SkPathMeasure;
+#include "SkPathMeasure.h"
 
 //  This class is not exported to java.
 class Sk1DPathEffect : public SkPathEffect {
@@ -41,6 +40,9 @@ protected:
     virtual SkScalar next(SkPath* dst, SkScalar distance, SkPathMeasure&) = 0;
 
 private:
+    // keeps the last path's segments, for when it's drawn again
+    SkPathMeasureCache  fMeasureCache;
+
     typedef SkPathEffect INHERITED;
 };
 
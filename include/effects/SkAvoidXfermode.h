@@ -66,6 +66,25 @@ public:
         return SkNEW_ARGS(SkAvoidXfermode, (buffer));
     }
 
+    struct State {
+        unsigned    fOpR, fOpG, fOpB;   // the op color's components, 0..255
+        uint32_t    fDistMul;           // x.14
+        bool        fTarget;            // kTargetColor_Mode
+    };
+
+    /** Transfer the first pixels of a row the way xfer32() (or xfer16())
+        does, with the same results, and return how many were done; xfer32()
+        does the rest.
+    */
+    typedef int (*Proc32)(const State&, SkPMColor dst[], const SkPMColor src[],
+                          int count, const SkAlpha aa[]);
+    typedef int (*Proc16)(const State&, uint16_t dst[], const SkPMColor src[],
+                          int count, const SkAlpha aa[]);
+
+    /** Return procs for the CPU, or NULL (see src/opts). */
+    static Proc32 PlatformProc32();
+    static Proc16 PlatformProc16();
+
 protected:
     SkAvoidXfermode(SkFlattenableReadBuffer&);
 
@@ -74,6 +93,8 @@ private:
     uint32_t    fDistMul;   // x.14
     Mode        fMode;
 
+    void getState(State*) const;
+
     static SkFlattenable* Create(SkFlattenableReadBuffer&);
 
     typedef SkXfermode INHERITED;
@@ -62,6 +62,15 @@ public:
                                         SkScalar ambient, SkScalar specular,
                                         SkScalar blurRadius);
 
+    /** Return the limit, in bytes, on the memory used to cache the masks that
+        blur maskfilters (including the ones in SkBlurDrawLooper) have
+        blurred, so that drawing the same shape again reuses them.
+    */
+    static size_t GetCacheLimit();
+
+    /** Set the limit on the blurred mask cache. 0 turns the cache off. */
+    static void SetCacheLimit(size_t bytes);
+
 private:
     SkBlurMaskFilter(); // can't be instantiated
 };
@@ -33,6 +33,7 @@ public:
     virtual void filterSpan(const SkPMColor src[], int count, SkPMColor[]);
     virtual void filterSpan16(const uint16_t src[], int count, uint16_t[]);
     virtual uint32_t getFlags();
+    virtual bool asColorMatrix(SkScalar matrix[20]);
 
     // overrides for SkFlattenable
     virtual void flatten(SkFlattenableWriteBuffer& buffer);
@@ -43,6 +44,16 @@ public:
         int32_t fResult[4];
     };
 
+    /** Filters the first pixels of a span the way filterSpan() does, with
+        the same results, and returns how many it did; filterSpan() does the
+        rest.
+    */
+    typedef int (*SpanProc)(const State&, const SkPMColor src[], int count,
+                            SkPMColor dst[]);
+
+    /** Returns a SpanProc for the CPU, or NULL (see src/opts). */
+    static SpanProc PlatformSpanProc();
+
     static SkFlattenable* CreateProc(SkFlattenableReadBuffer& buffer);
 
 protected:
@@ -35,6 +35,8 @@ public:
     // overrides for SkPathEffect
     //  This method is not exported to java.
     virtual bool filterPath(SkPath* dst, const SkPath& src, SkScalar* width);
+    //  This method is not exported to java.
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
 
     // overrides for SkFlattenable
     //  This method is not exported to java.
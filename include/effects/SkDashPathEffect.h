@@ -18,6 +18,7 @@
 #define SkDashPathEffect_DEFINED
 
 #include "SkPathEffect.h"
+#include "SkPathMeasure.h"
 
 /** \class SkDashPathEffect
 
@@ -37,6 +38,8 @@ public:
     // overrides for SkPathEffect
     //  This method is not exported to java.
     virtual bool filterPath(SkPath* dst, const SkPath& src, SkScalar* width);
+    //  This method is not exported to java.
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
 
     // overrides for SkFlattenable
     //  This method is not exported to java.
@@ -57,6 +60,16 @@ private:
     int32_t     fInitialDashIndex;
     SkScalar    fIntervalLength;
     bool        fScaleToFit;
+    // keeps the last path's segments, for when it's dashed again
+    SkPathMeasureCache  fMeasureCache;
+    // and the dashes we made from it, for when it's dashed again unchanged
+    SkMutex     fCacheMutex;
+    SkPath      fCachedDst;
+    uint32_t    fCachedGenerationID;    // of the src, or 0 if there's none
+
+    SkScalar fitScale(SkScalar length) const;
+    bool dashLines(SkPath* dst, const SkPath& src) const;
+    void dashMeasured(SkPath* dst, const SkPath& src);
 
     typedef SkPathEffect INHERITED;
 };
@@ -25,7 +25,13 @@ public:
         : fPercent256(percent256) {}
 
     virtual uint8_t computeValue(uint8_t* const* srcRows) = 0;
-    
+
+    /** Computes count values, the window of dst[x] being columns x..x+2 of
+        the three rows. The default calls computeValue() for each of them,
+        which subclasses may do better.
+    */
+    virtual void computeRow(uint8_t* const rows[3], int count, uint8_t dst[]);
+
     // overrides from SkMaskFilter
     virtual SkMask::Format getFormat();
     virtual bool filterMask(SkMask*, const SkMask&, const SkMatrix&, SkIPoint*);
@@ -52,8 +58,9 @@ public:
         fShift = shift;
     }
     
-    // override from SkKernel33ProcMaskFilter
+    // overrides from SkKernel33ProcMaskFilter
     virtual uint8_t computeValue(uint8_t* const* srcRows);
+    virtual void computeRow(uint8_t* const rows[3], int count, uint8_t dst[]);
     
     // overrides from SkFlattenable
     virtual void flatten(SkFlattenableWriteBuffer& wb);
@@ -49,7 +49,8 @@ protected:
     // override from SkRasterizer
     virtual bool onRasterize(const SkPath& path, const SkMatrix& matrix,
                              const SkIRect* clipBounds,
-                             SkMask* mask, SkMask::CreateMode mode);
+                             SkMask* mask, SkMask::CreateMode mode,
+                             SkExecutor* executor);
 
 private:
     SkDeque fLayers;
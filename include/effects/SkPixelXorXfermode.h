@@ -36,6 +36,19 @@ public:
         return SkNEW_ARGS(SkPixelXorXfermode, (buffer));
     }
 
+    // override from SkXfermode
+    virtual void xfer32(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]);
+
+    /** Xor the first pixels of a row (without aa) the way xferColor() does,
+        and return how many were done; xfer32() does the rest.
+    */
+    typedef int (*Proc32)(uint32_t opColor, SkPMColor dst[],
+                          const SkPMColor src[], int count);
+
+    /** Returns a Proc32 for the CPU, or NULL (see src/opts). */
+    static Proc32 PlatformProc32();
+
 protected:
     // override from SkXfermode
     virtual SkPMColor xferColor(SkPMColor src, SkPMColor dst);
@@ -93,6 +93,7 @@ public:
 
     // overrides from SkDevice
 
+    virtual uint32_t getDeviceCapabilities() { return kGL_Capability; }
     virtual void clear(SkColor color);
     virtual bool readPixels(const SkIRect& srcRect, SkBitmap* bitmap);
     virtual void writePixels(const SkBitmap& bitmap, int x, int y);
@@ -190,6 +191,7 @@ private:
     // state for our offscreen render-target
     TexCache*       fCache;
     GrTexture*      fTexture;
+    bool            fScratchTexture;    // fTexture is from the rt pool
     GrRenderTarget* fRenderTarget;
     bool            fNeedClear;
     bool            fNeedPrepareRenderTarget;
@@ -234,7 +236,8 @@ private:
 
     void prepareRenderTarget(const SkDraw&);
     void internalDrawBitmap(const SkDraw&, const SkBitmap&,
-                            const SkIRect&, const SkMatrix&, GrPaint* grPaint);
+                            const SkIRect& srcRect, const SkIRect& sampleRect,
+                            const SkMatrix&, GrPaint* grPaint);
 
     typedef SkDevice INHERITED;
 };
@@ -0,0 +1,39 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkCreateRLEPixelRef_DEFINED
+#define SkCreateRLEPixelRef_DEFINED
+
+#include "SkBitmap.h"
+
+class SkPixelRef;
+
+/** Packs each row of src, which must be kIndex8_Config, with SkPackBits, and
+    returns a pixel ref that holds the rows and src's color table, or NULL if
+    src has some other config. Mostly flat images take a fraction of the
+    memory of their pixels.
+*/
+SkPixelRef* SkCreateRLEPixelRef(const SkBitmap& src);
+
+/** Sets dst to a kRLE_Index8_Config bitmap of src's size, with the pixel ref
+    that SkCreateRLEPixelRef() returns for src, and returns true, or returns
+    false if src can't be packed. Drawn unscaled (as a sprite, or through a
+    translated, clamped bitmap shader), it is drawn straight from its runs.
+*/
+bool SkCreateRLEBitmap(const SkBitmap& src, SkBitmap* dst);
+
+#endif
@@ -24,9 +24,16 @@
 
 class SkRegion;
 
+/** \class SkFlipPixelRef
+
+    A pixelref with pageCount pages of pixels (2 by default, or up to
+    SkPageFlipper::kMaxPages), which are drawn into in turn. Between updates
+    the front page, the one drawn into last, is the one that is locked.
+*/
 class SkFlipPixelRef : public SkPixelRef {
 public:
-            SkFlipPixelRef(SkBitmap::Config, int width, int height);
+            SkFlipPixelRef(SkBitmap::Config, int width, int height,
+                           int pageCount = 2);
     virtual ~SkFlipPixelRef();
     
     bool isDirty() const { return fFlipper.isDirty(); }
@@ -43,17 +50,20 @@ public:
 private:
     void getFrontBack(const void** front, void** back) const {
         if (front) {
-            *front = fPage0;
+            *front = fPages[0];
         }
         if (back) {
-            *back = fPage1;
+            *back = fPages[fFlipper.pageCount() - 1];
         }
     }
 
     void    swapPages();
 
     // Helper to copy pixels from srcAddr to the dst bitmap, clipped to clip.
-    // srcAddr points to memory with the same config as dst.
+    // srcAddr points to memory with the same config as dst. Nearby rects of
+    // clip are copied together, along with the pixels between them, so this
+    // is only for copying the front page to the back one, which are the same
+    // outside of clip, except where the back page is about to be drawn.
     static void CopyBitsFromAddr(const SkBitmap& dst, const SkRegion& clip,
                                  const void* srcAddr);
 
@@ -75,9 +85,9 @@ private:
     SkPageFlipper   fFlipper;
     
     void*           fStorage;
-    void*           fPage0; // points into fStorage;
-    void*           fPage1; // points into fStorage;
-    size_t          fSize;  // size of 1 page. fStorage holds 2 pages
+    // point into fStorage, the front page first and then the older ones
+    void*           fPages[SkPageFlipper::kMaxPages];
+    size_t          fSize;  // size of 1 page. fStorage holds pageCount pages
     SkBitmap::Config fConfig;
 
     typedef SkPixelRef INHERITED;
@@ -0,0 +1,120 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkImageDecodeQueue_DEFINED
+#define SkImageDecodeQueue_DEFINED
+
+#include "SkBitmap.h"
+#include "SkImageDecoder.h"
+#include "SkRefCnt.h"
+#include "SkThreadPool.h"
+
+class SkStream;
+
+/** \class SkImageDecodeQueue
+
+    Decodes images asynchronously on a pool of worker threads. Each call to
+    decode() returns a Future that holds the bitmap once its stream has been
+    decoded.
+
+    Every decode uses its own SkImageDecoder (created with
+    SkImageDecoder::Factory()), so no codec instance is ever shared between
+    threads.
+
+    The pixel memory of the decodes that are in progress is limited to a
+    ceiling, which defaults to the budget of SkImageRef_GlobalPool (where 0
+    means that there is no limit). A decode that would go over the ceiling
+    waits for the others to finish first (unless it is the only one, in which
+    case it always proceeds). Before the pixels are allocated, the global pool
+    is asked to purge enough of its unlocked images that the two together
+    stay within the ceiling.
+*/
+class SkImageDecodeQueue : SkNoncopyable {
+public:
+    class Future : public SkRefCnt {
+    public:
+        virtual ~Future();
+
+        /** Return true if the decode has finished (successfully or not). */
+        bool isDone() const;
+
+        /** Block until the decode has finished. Return true if it succeeded,
+            in which case the bitmap is copied into bitmap (if not NULL),
+            sharing its pixels.
+        */
+        bool wait(SkBitmap* bitmap = NULL);
+
+    private:
+        Future(SkImageDecodeQueue*, SkStream*, SkBitmap::Config,
+               SkImageDecoder::Mode);
+
+        SkImageDecodeQueue*     fQueue;
+        SkStream*               fStream;
+        SkBitmap::Config        fPrefConfig;
+        SkImageDecoder::Mode    fMode;
+        SkBitmap                fBitmap;
+        bool                    fSuccess;
+        volatile bool           fDone;
+
+        friend class SkImageDecodeQueue;
+        typedef SkRefCnt INHERITED;
+    };
+
+    /** Create a queue with the specified number of worker threads (0 for
+        SkThreadPool::CPUCount()), and a ceiling in bytes on the pixel memory
+        of the decodes in progress (0 to follow SkImageRef_GlobalPool's
+        budget, whatever its value when each decode allocates its pixels).
+    */
+    explicit SkImageDecodeQueue(int threadCount = 0, size_t ramCeiling = 0);
+
+    /** Wait for every decode that has been queued to finish. */
+    ~SkImageDecodeQueue();
+
+    /** Return the ceiling currently in effect, or 0 if there is none. */
+    size_t getRAMCeiling() const;
+
+    /** Queue the stream to be decoded. The stream is ref'd until the decode
+        has finished, and must not be used by anyone else until then. The
+        caller must call unref() on the returned future.
+    */
+    Future* decode(SkStream* stream,
+                   SkBitmap::Config pref = SkBitmap::kNo_Config,
+                   SkImageDecoder::Mode = SkImageDecoder::kDecodePixels_Mode);
+
+    /** Queue count streams, storing their (ref'd) futures in futures[]. */
+    void decode(SkStream* const streams[], int count, Future* futures[],
+                SkBitmap::Config pref = SkBitmap::kNo_Config,
+                SkImageDecoder::Mode = SkImageDecoder::kDecodePixels_Mode);
+
+    /** Block until every decode that has been queued has finished. */
+    void wait();
+
+private:
+    class Allocator;
+    class Job;
+    struct Impl;
+
+    SkThreadPool    fPool;
+    Impl*           fImpl;
+    size_t          fRAMCeiling;
+    size_t          fRAMInFlight;   // pixels allocated by unfinished decodes
+
+    void run(Future*);
+    void reserveRAM(size_t bytes, size_t alreadyReserved);
+    void waitFor(const Future*);
+};
+
+#endif
@@ -19,8 +19,10 @@
 #define SkImageDecoder_DEFINED
 
 #include "SkBitmap.h"
+#include "SkRect.h"
 #include "SkRefCnt.h"
 
+class SkDynamicMemoryWStream;
 class SkStream;
 
 /** \class SkImageDecoder
@@ -57,6 +59,19 @@ public:
     */
     void setDitherImage(bool dither) { fDitherImage = dither; }
 
+    /** Returns true if palettized sources should keep their palette, see
+        setPreserveSrcDepth(). The default setting is false.
+    */
+    bool getPreserveSrcDepth() const { return fPreserveSrcDepth; }
+
+    /** Set to true if palettized sources (e.g. PNG and GIF) should always be
+        decoded to kIndex8_Config, with a premultiplied SkColorTable, even if
+        they have alpha and another config was requested. This takes a quarter
+        of the memory of expanding them to kARGB_8888_Config.
+        The default setting is false.
+    */
+    void setPreserveSrcDepth(bool preserve) { fPreserveSrcDepth = preserve; }
+
     /** \class Peeker
 
         Base class for optional callbacks to retrieve meta/chunk data out of
@@ -177,6 +192,63 @@ public:
         return this->decode(stream, bitmap, SkBitmap::kNo_Config, mode);
     }
 
+    /** Prepare to decode parts of the image in the stream with decodeRegion().
+        The decoder keeps a reference to the stream (which it will rewind for
+        each region) and remembers what it learned from the header, so each
+        region only decodes as much of the image as it needs. On success,
+        width and height (if not NULL) are set to the image's dimensions.
+        Returns false if the image cannot be decoded, or if this decoder does
+        not support regions (PNG and JPEG do).
+    */
+    bool buildTileIndex(SkStream*, int* width = NULL, int* height = NULL);
+
+    /** Decode the part of the image inside rect (in the coordinates of the
+        full image, and clipped to it) into bitmap, subsampled by
+        getSampleSize(). The pixels outside of rect are never stored, so this
+        does not need as much memory as decoding the whole image. May only be
+        called after buildTileIndex() has succeeded.
+    */
+    bool decodeRegion(SkBitmap* bitmap, const SkIRect& rect,
+                      SkBitmap::Config pref = SkBitmap::kNo_Config);
+
+    enum IncrementalResult {
+        kError_IncrementalResult,       //!< the data cannot be decoded
+        kPartial_IncrementalResult,     //!< more data is needed
+        kComplete_IncrementalResult     //!< the whole image has been decoded
+    };
+
+    /** Start decoding an image whose data will be passed to pushIncremental()
+        as it arrives (e.g. over a slow network), rather than as a stream. The
+        decoder must have been created by Factory() from the first bytes of
+        the image. All of the data (including those first bytes) is then
+        passed to pushIncremental().
+    */
+    void beginIncremental(SkBitmap::Config pref = SkBitmap::kNo_Config);
+
+    /** Decode as much of the image as the data received so far allows. As
+        soon as the header has been decoded, incrementalBitmap() has its
+        config and pixels (initially undefined), and the first
+        incrementalRows() rows of it hold decoded pixels from then on.
+        PNG and JPEG decode as the data arrives (for an interlaced PNG, every
+        row is refined after each pass); other formats keep the data until
+        endIncremental().
+    */
+    IncrementalResult pushIncremental(const void* data, size_t size);
+
+    /** Call once all of the data has been pushed. Returns
+        kComplete_IncrementalResult if the whole image was decoded, and
+        kError_IncrementalResult otherwise (in which case incrementalBitmap()
+        may still hold the part of a truncated image that was decoded).
+    */
+    IncrementalResult endIncremental();
+
+    /** The bitmap that the incremental decode fills in. Its pixels may be
+        drawn (e.g. by another thread) while the decode continues; its
+        generation ID changes whenever more of it has been decoded.
+    */
+    const SkBitmap& incrementalBitmap() const { return fIncrementalBitmap; }
+    int incrementalRows() const { return fIncrementalRows; }
+
     /** Given a stream, this will try to find an appropriate decoder object.
         If none is found, the method returns NULL.
     */
@@ -265,6 +337,30 @@ protected:
     // must be overridden in subclasses. This guy is called by decode(...)
     virtual bool onDecode(SkStream*, SkBitmap* bitmap, Mode) = 0;
 
+    // override these to support decodeRegion(). onDecodeRegion is passed a
+    // rect that has already been clipped to the image.
+    virtual bool onBuildTileIndex(SkStream*, int* width, int* height) {
+        return false;
+    }
+    virtual bool onDecodeRegion(SkBitmap* bitmap, const SkIRect& rect) {
+        return false;
+    }
+    // onDecodeRegion can call this after rewinding the stream, to have it
+    // prefetch the part that a decoder producing rows in order will read.
+    void prefetchRegion(SkStream*, const SkIRect& rect) const;
+
+    // override these to decode incrementally. If onBeginIncremental returns
+    // false, the data is kept until the end, and then passed to onDecode.
+    // Subclasses store into incrementalBitmapForWriting() and report their
+    // progress with setIncrementalRows().
+    virtual bool onBeginIncremental() { return false; }
+    virtual IncrementalResult onPushIncremental(const void* data,
+                                                size_t size) {
+        return kError_IncrementalResult;
+    }
+    SkBitmap* incrementalBitmapForWriting() { return &fIncrementalBitmap; }
+    void setIncrementalRows(int rows);
+
     /** Can be queried from within onDecode, to see if the user (possibly in
         a different thread) has requested the decode to cancel. If this returns
         true, your onDecode() should stop and return false.
@@ -314,7 +410,16 @@ private:
     SkBitmap::Config        fPrefTable[6];  // use if fUsePrefTable is true
     bool                    fDitherImage;
     bool                    fUsePrefTable;
+    bool                    fPreserveSrcDepth;
     mutable bool            fShouldCancelDecode;
+    int                     fTileWidth;     // 0 until buildTileIndex()
+    int                     fTileHeight;
+    size_t                  fTileLength;    // of the stream, if it knows
+    SkBitmap                fIncrementalBitmap;
+    int                     fIncrementalRows;
+    IncrementalResult       fIncrementalResult;
+    // holds the data until the end, if the subclass cannot decode as it goes
+    SkDynamicMemoryWStream* fIncrementalData;
 
     // illegal
     SkImageDecoder(const SkImageDecoder&);
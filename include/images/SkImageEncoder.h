@@ -4,6 +4,7 @@
 #include "SkTypes.h"
 
 class SkBitmap;
+class SkExecutor;
 class SkWStream;
 
 class SkImageEncoder {
@@ -14,7 +15,27 @@ public:
     };
     static SkImageEncoder* Create(Type);
 
+    SkImageEncoder();
     virtual ~SkImageEncoder();
+
+    /** How much effort lossless formats (PNG) spend on making the output
+        small. They ignore the quality parameter.
+    */
+    enum Speed {
+        kFast_Speed,        //!< little effort, e.g. for screenshots
+        kDefault_Speed,     //!< the codec library's own defaults
+        kSmallest_Speed     //!< as small as the codec can make it
+    };
+
+    Speed getSpeed() const { return fSpeed; }
+    void setSpeed(Speed speed) { fSpeed = speed; }
+
+    /** If an executor with threads is set, encoders that can split up their
+        work (PNG) run the pieces on it, and wait() for it before returning.
+        The executor is not owned, and may be shared with other work.
+    */
+    SkExecutor* getExecutor() const { return fExecutor; }
+    void setExecutor(SkExecutor* executor) { fExecutor = executor; }
     
     /*  Quality ranges from 0..100 */
     enum {
@@ -31,6 +52,10 @@ public:
 
 protected:
     virtual bool onEncode(SkWStream*, const SkBitmap&, int quality) = 0;
+
+private:
+    Speed       fSpeed;
+    SkExecutor* fExecutor;
 };
 
 #endif
@@ -84,9 +84,19 @@ protected:
     virtual void* onLockPixels(SkColorTable**);
     // override this in your subclass to clean up when we're unlocking pixels
     virtual void onUnlockPixels();
+    virtual SkData* onRefEncodedData();
     
     SkImageRef(SkFlattenableReadBuffer&);
 
+    /** Decode the pixels into bitmap from a private stream over our encoded
+        data, without holding the mutex, so that it can be done ahead of time
+        on another thread while the mutex is used to draw other images.
+        Return false if our stream is not in memory (see
+        SkStream::getMemoryBase()) or if the decode fails. Must not be called
+        with the mutex held.
+     */
+    bool decodeUnlocked(SkBitmap* bitmap);
+
     SkBitmap fBitmap;
 
 private:    
@@ -104,7 +114,11 @@ private:
     
     friend class SkImageRefPool;
     
-    SkImageRef*  fPrev, *fNext;    
+    SkImageRef*  fPrev, *fNext;
+    // how long our last decode took, and how much the pool wants to keep
+    // our pixels (see SkImageRefPool::setRAMUsed)
+    SkMSec       fDecodeMSecs;
+    float        fKeepScore;
     size_t ramUsed() const;
     
     typedef SkPixelRef INHERITED;
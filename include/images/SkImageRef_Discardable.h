@@ -0,0 +1,67 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkImageRef_Discardable_DEFINED
+#define SkImageRef_Discardable_DEFINED
+
+#include "SkImageRef.h"
+
+class SkDiscardableMemory;
+
+/** \class SkImageRef_Discardable
+
+    An imageref that decodes into SkDiscardableMemory, so that while it is
+    unlocked the OS may take its pixels back if memory runs short. The next
+    lock then decodes them again, into the same memory.
+*/
+class SkImageRef_Discardable : public SkImageRef {
+public:
+    SkImageRef_Discardable(SkStream*, SkBitmap::Config, int sampleSize = 1);
+    virtual ~SkImageRef_Discardable();
+
+    // overrides
+    virtual Factory getFactory() const {
+        return Create;
+    }
+    static SkPixelRef* Create(SkFlattenableReadBuffer&);
+
+    /** Return how many times the pixels have been decoded. */
+    int getDecodeCount() const { return fDecodeCount; }
+
+protected:
+    virtual bool onDecode(SkImageDecoder* codec, SkStream* stream,
+                          SkBitmap* bitmap, SkBitmap::Config config,
+                          SkImageDecoder::Mode mode);
+
+    virtual void* onLockPixels(SkColorTable**);
+    virtual void onUnlockPixels();
+
+private:
+    SkImageRef_Discardable(SkFlattenableReadBuffer&);
+    void freeMemory();
+
+    SkDiscardableMemory*    fMemory;    // null until the first decode
+    SkColorTable*           fCT;
+    bool                    fLocked;    // true if fMemory is locked
+    int                     fDecodeCount;
+
+    friend class DiscardableAllocator;
+
+    typedef SkImageRef INHERITED;
+};
+
+#endif
@@ -31,6 +31,17 @@ public:
     }
     static SkPixelRef* Create(SkFlattenableReadBuffer&);
 
+    /** Hint that the pixels will be needed soon (e.g. the image is about to
+        be scrolled back into view). If they are not in memory, they are
+        decoded on a background thread, so that the next lockPixels() does
+        not have to wait for the decode. Once decoded they count against the
+        budget like any other unlocked pixels. If they are not ready (or have
+        been purged again) by the time they are locked, they are decoded as
+        usual. Only images whose stream is in memory (see
+        SkStream::getMemoryBase()) are decoded ahead of time.
+     */
+    void prefetch();
+
     // API to control the global pool
 
     /** Return the amount specified as the budget for the cache (in bytes).
@@ -56,6 +67,9 @@ public:
     
     static void DumpPool();
 
+    /** Block until every prefetch() that has been requested has finished. */
+    static void WaitForPrefetches();
+
 protected:
     virtual bool onDecode(SkImageDecoder* codec, SkStream* stream,
                           SkBitmap* bitmap, SkBitmap::Config config,
@@ -66,6 +80,12 @@ protected:
     SkImageRef_GlobalPool(SkFlattenableReadBuffer&);
 
 private:
+    class PrefetchJob;
+
+    bool    fPrefetching;
+
+    void decodeAhead();
+
     typedef SkImageRef INHERITED;
 };
 
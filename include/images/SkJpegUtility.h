@@ -41,11 +41,13 @@ void skjpeg_error_exit(j_common_ptr cinfo);
 /* Our source struct for directing jpeg to our stream object.
 */
 struct skjpeg_source_mgr : jpeg_source_mgr {
-    skjpeg_source_mgr(SkStream* stream, SkImageDecoder* decoder, bool ownStream);
+    skjpeg_source_mgr(SkStream* stream, SkImageDecoder* decoder,
+                      bool ownStream = false);
     ~skjpeg_source_mgr();
 
     SkStream*   fStream;
-    void*       fMemoryBase;
+    // the stream's getMemoryBase(), which we read in place if it is not NULL
+    const void* fMemoryBase;
     size_t      fMemoryBaseSize;
     bool        fUnrefStream;
     SkImageDecoder* fDecoder;
@@ -27,19 +27,29 @@
     region of pixels that should be copied from the "front" page onto the one
     you're about to draw into. This copyBits region will be disjoint from the
     inval region, so both need to be handled.
+
+    By default there are two pages, but there may be up to kMaxPages, drawn
+    into in turn. The page about to be drawn into was last drawn pageCount()
+    - 1 updates ago, so its copyBits region is everything drawn in any of the
+    updates since.
  */
 class SkPageFlipper {
 public:
+    enum {
+        kMaxPages = 3
+    };
+
     SkPageFlipper();
-    SkPageFlipper(int width, int height);
+    SkPageFlipper(int width, int height, int pageCount = 2);
     
     int width() const { return fWidth; }
     int height() const { return fHeight; }
+    int pageCount() const { return fPageCount; }
 
     void resize(int width, int height);
 
-    bool isDirty() const { return !fDirty1->isEmpty(); }
-    const SkRegion& dirtyRgn() const { return *fDirty1; }
+    bool isDirty() const { return !fInval.isEmpty(); }
+    const SkRegion& dirtyRgn() const { return fInval; }
 
     void inval();
     void inval(const SkIRect&);
@@ -52,16 +62,16 @@ public:
         the front page to the back page (will not intersect with the returned
         inval region.
      
-        Once this is called, the two internal regions are swapped, so the *new*
-        back inval region is ready to receive new inval calls.
+        Once this is called, the inval region is remembered as the one drawn
+        into this page, and a new, empty one is ready to receive inval calls.
      */
     const SkRegion& update(SkRegion* copyBits);
 
 private:
-    SkRegion*   fDirty0;
-    SkRegion*   fDirty1;
-    SkRegion    fDirty0Storage;
-    SkRegion    fDirty1Storage;
+    // what was drawn in each of the last pageCount - 1 updates, latest first
+    SkRegion    fDrawn[kMaxPages - 1];
+    SkRegion    fInval;
+    int         fPageCount;
     int         fWidth;
     int         fHeight;
 };
@@ -50,6 +50,13 @@ public:
      */
     size_t setFileOffset(SkPDFObject* obj, size_t offset);
 
+    /** Forget the passed object, which has been emitted and won't be
+     *  referred to again, so that it can be freed.  Its object number and
+     *  file offset are kept for the cross reference table.
+     *  @param obj         The object to forget.
+     */
+    void forgetObject(SkPDFObject* obj);
+
     /** Output the object number for the passed object.
      *  @param obj         The object of interest.
      *  @param stream      The writable output stream to send the output to.
@@ -70,6 +77,25 @@ public:
      */
     int32_t emitXrefTable(SkWStream* stream, bool firstPage);
 
+    /** Set substitute object for the passed object.  References to original
+     *  are emitted as references to substitute, which is emitted instead of
+     *  it, e.g. a subset of a font.  Refs substitute.  original must not be
+     *  added to the catalog.
+     *  @param original    The object to replace.
+     *  @param substitute  The object to emit in its place.
+     */
+    void setSubstitute(SkPDFObject* original, SkPDFObject* substitute);
+
+    /** Return the substitute object of the passed object, or the object
+     *  itself if it doesn't have one.
+     */
+    SkPDFObject* getSubstituteObject(SkPDFObject* object);
+
+    /** Return true if the passed object is one of the resources of an object
+     *  that has been substituted, so it isn't used any more.
+     */
+    bool isReplaced(SkPDFObject* object) const;
+
 private:
     struct Rec {
         Rec(SkPDFObject* object, bool onFirstPage)
@@ -84,9 +110,19 @@ private:
         bool fOnFirstPage;
     };
 
+    struct SubstituteMapping {
+        SkPDFObject* fOriginal;
+        SkPDFObject* fSubstitute;
+    };
+
     // TODO(vandebo) Make this a hash if it's a performance problem.
     SkTDArray<struct Rec> fCatalog;
 
+    // Objects and their substitutes (which are ref'ed), and the resources of
+    // the substituted objects (which are ref'ed too).
+    SkTDArray<SubstituteMapping> fSubstituteMap;
+    SkTDArray<SkPDFObject*> fReplacedResources;
+
     // Number of objects on the first page.
     uint32_t fFirstPageCount;
     // Next object number to assign (on page > 1).
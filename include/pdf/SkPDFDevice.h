@@ -30,6 +30,7 @@ class SkPDFDevice;
 class SkPDFDict;
 class SkPDFFont;
 class SkPDFFormXObject;
+class SkPDFGlyphSetMap;
 class SkPDFGraphicState;
 class SkPDFObject;
 class SkPDFShader;
@@ -127,10 +128,24 @@ public:
      */
     SK_API void getResources(SkTDArray<SkPDFObject*>* resourceList) const;
 
+    /** Get the resources that other pages may share (graphic states, fonts,
+     *  shaders and images), along with the resources they use.
+     *  @param resourceList A list to append the resources to.
+     */
+    SK_API void getSharedResources(
+            SkTDArray<SkPDFObject*>* resourceList) const;
+
     /** Get the fonts used on this device.
      */
     SK_API const SkTDArray<SkPDFFont*>& getFontResources() const;
 
+    /** Get the glyphs used with each of the fonts on this device, including
+     *  the ones drawn into layers.
+     */
+    SK_API const SkPDFGlyphSetMap& getFontGlyphUsage() const {
+        return *(fFontGlyphUsage.get());
+    }
+
     /** Returns the media box for this device.
      */
     SK_API SkRefPtr<SkPDFArray> getMediaBox() const;
@@ -169,8 +184,12 @@ private:
 
     SkTDArray<SkPDFGraphicState*> fGraphicStateResources;
     SkTDArray<SkPDFObject*> fXObjectResources;
+    // The images in fXObjectResources, which other pages may share since
+    // they are canonicalized.  fXObjectResources holds their references.
+    SkTDArray<SkPDFObject*> fImageResources;
     SkTDArray<SkPDFFont*> fFontResources;
     SkTDArray<SkPDFShader*> fShaderResources;
+    SkTScopedPtr<SkPDFGlyphSetMap> fFontGlyphUsage;
 
     SkTScopedPtr<ContentEntry> fContentEntries;
     ContentEntry* fLastContentEntry;
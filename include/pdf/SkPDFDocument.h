@@ -24,8 +24,27 @@
 
 class SkPDFDevice;
 class SkPDFPage;
+class SkThreadPool;
 class SkWSteam;
 
+/** \class SkPDFPageSource
+
+    Draws the pages that SkPDFDocument::appendPages() adds.
+*/
+class SkPDFPageSource {
+public:
+    virtual ~SkPDFPageSource() {}
+
+    /** Return a new device with the page drawn on it, or NULL if the page
+     *  can't be drawn.  Different pages are drawn at the same time on
+     *  different threads, so a page may only share objects that are safe to
+     *  use from several threads (like the PDF fonts, graphic states and
+     *  shaders that are canonicalized across devices) with other pages.
+     *  @param pageIndex The index of the page, from 0, in the appended pages.
+     */
+    virtual SkPDFDevice* createPage(int pageIndex) = 0;
+};
+
 /** \class SkPDFDocument
 
     A SkPDFDocument assembles pages together and generates the final PDF file.
@@ -35,9 +54,21 @@ public:
     /** Create a PDF document.
      */
     SK_API SkPDFDocument();
+
+    /** Create a PDF document that is written to stream as it is built, so
+     *  that memory use doesn't grow with the number of pages.  Each page,
+     *  its content and the resources only it uses are emitted as soon as
+     *  the page is appended.  Resources pages may share (fonts, graphic
+     *  states, shaders and images) are kept until emitPDF() finishes the
+     *  file.
+     *  @param stream    The writable output stream to send the PDF to.  It
+     *                   must outlive the document and be passed to emitPDF.
+     */
+    SK_API explicit SkPDFDocument(SkWStream* stream);
     SK_API ~SkPDFDocument();
 
-    /** Output the PDF to the passed stream.
+    /** Output the PDF to the passed stream.  For a document created with a
+     *  stream, this finishes the file and must be passed that stream.
      *  @param stream    The writable output stream to send the PDF to.
      */
     SK_API bool emitPDF(SkWStream* stream);
@@ -49,7 +80,22 @@ public:
      */
     SK_API bool appendPage(const SkRefPtr<SkPDFDevice>& pdfDevice);
 
-    /** Get the list of pages in this document.
+    /** Draw pages on the pool's threads and compress their content there,
+     *  then append them to the document in order.  Returns true if every
+     *  page was drawn and appended.  Pages that were drawn before the first
+     *  one that failed are still appended.  Will fail if the document has
+     *  already been emitted.
+     *
+     *  @param source    Draws the pages.
+     *  @param count     The number of pages to append.
+     *  @param pool      The threads to draw on.  If NULL, the pages are
+     *                   drawn on the calling thread.
+     */
+    SK_API bool appendPages(SkPDFPageSource* source, int count,
+                            SkThreadPool* pool);
+
+    /** Get the list of pages in this document.  The pages of a document
+     *  created with a stream have no content left once they are appended.
      */
     SK_API const SkTDArray<SkPDFPage*>& getPages();
 
@@ -57,6 +103,11 @@ private:
     SkPDFCatalog fCatalog;
     int64_t fXRefFileOffset;
 
+    // Only set for a document that is emitted page by page.
+    SkWStream* fStream;
+    off_t fFileOffset;
+    SkRefPtr<SkPDFDict> fPageTreeRoot;
+
     SkTDArray<SkPDFPage*> fPages;
     SkTDArray<SkPDFDict*> fPageTree;
     SkRefPtr<SkPDFDict> fDocCatalog;
@@ -79,6 +130,20 @@ private:
      *  @param objCount  The number of objects in the PDF.
      */
     void emitFooter(SkWStream* stream, int64_t objCount);
+
+    /** Add a new page (taking its reference) to the document.
+     */
+    void addPage(SkPDFPage* page, const SkRefPtr<SkPDFDevice>& pdfDevice);
+
+    /** Output a page that was just appended, with its content and the
+     *  resources that only it uses, then release them.
+     */
+    void streamPage(SkPDFPage* page, const SkRefPtr<SkPDFDevice>& pdfDevice);
+
+    /** Output what's left of a document created with a stream: the page
+     *  tree, the document catalog, the shared resources and the trailer.
+     */
+    void finishStream();
 };
 
 #endif
@@ -23,6 +23,58 @@
 #include "SkThread.h"
 
 class SkPaint;
+class SkPDFFont;
+
+/** \class SkPDFGlyphSet
+
+    The set of glyphs, in a font's encoding (see
+    SkPDFFont::glyphsToPDFFontEncoding), that is used with the font.
+*/
+class SkPDFGlyphSet : SkNoncopyable {
+public:
+    SkPDFGlyphSet();
+
+    void set(const uint16_t* glyphIDs, int numGlyphs);
+    bool has(uint16_t glyphID) const;
+    void merge(const SkPDFGlyphSet& usage);
+
+    /** Return a hash of the glyphs in the set.
+     */
+    uint32_t hash() const;
+
+private:
+    SkTDArray<uint32_t> fBitSet;
+};
+
+/** \class SkPDFGlyphSetMap
+
+    The glyphs used with each of a set of fonts, e.g. by a page.  The fonts
+    are not ref'ed, whoever uses them must keep them alive.
+*/
+class SkPDFGlyphSetMap : SkNoncopyable {
+public:
+    struct FontGlyphSetPair {
+        SkPDFFont* fFont;
+        SkPDFGlyphSet* fGlyphSet;
+    };
+
+    SkPDFGlyphSetMap();
+    ~SkPDFGlyphSetMap();
+
+    void merge(const SkPDFGlyphSetMap& usage);
+    void reset();
+
+    void noteGlyphUsage(SkPDFFont* font, const uint16_t* glyphIDs,
+                        int numGlyphs);
+
+    int count() const { return fMap.count(); }
+    const FontGlyphSetPair& operator[](int index) const { return fMap[index]; }
+
+private:
+    SkPDFGlyphSet* getGlyphSetForFont(SkPDFFont* font);
+
+    SkTDArray<FontGlyphSetPair> fMap;
+};
 
 /** \class SkPDFFont
     A PDF Object class representing a font.  The font may have resources
@@ -76,6 +128,15 @@ public:
     SK_API static SkPDFFont* getFontResource(SkTypeface* typeface,
                                              uint16_t glyphID);
 
+    /** Return a new font that only has the passed glyphs, to be emitted in
+     *  place of this one by a document that only uses them, or NULL if this
+     *  font can't be subset.  Only the programs of TrueType fonts are
+     *  subset, and the glyph descriptions of Type3 fonts; the widths and
+     *  ToUnicode table of a subset only cover its glyphs.
+     *  @param usage  The glyphs to keep, in this font's encoding.
+     */
+    SK_API SkPDFFont* getFontSubset(const SkPDFGlyphSet* usage);
+
 private:
     SkRefPtr<SkTypeface> fTypeface;
     SkAdvancedTypefaceMetrics::FontType fType;
@@ -83,13 +144,15 @@ private:
     bool fDescendant;
 #endif
     bool fMultiByteGlyphs;
+    bool fType3Font;
 
     // The glyph IDs accessible with this font.  For Type1 (non CID) fonts,
     // this will be a subset if the font has more than 255 glyphs.
     uint16_t fFirstGlyphID;
     uint16_t fLastGlyphID;
     // The font info is only kept around after construction for large
-    // Type1 (non CID) fonts that need multiple "fonts" to access all glyphs.
+    // Type1 (non CID) fonts that need multiple "fonts" to access all glyphs,
+    // and for TrueType (Type0) fonts, to make subsets of them.
     SkRefPtr<SkAdvancedTypefaceMetrics> fFontInfo;
     SkTDArray<SkPDFObject*> fResources;
     SkRefPtr<SkPDFDict> fDescriptor;
@@ -121,12 +184,15 @@ private:
      *  @param fontDescriptor If the font descriptor has already have generated
      *                        for this font, pass it in here, otherwise pass
      *                        NULL.
+     *  @param subset         The glyphs to include if this is a subset of
+     *                        the font (see getFontSubset), otherwise NULL.
      */
     SkPDFFont(class SkAdvancedTypefaceMetrics* fontInfo, SkTypeface* typeface,
-              uint16_t glyphID, bool descendantFont, SkPDFDict* fontDescriptor);
+              uint16_t glyphID, bool descendantFont, SkPDFDict* fontDescriptor,
+              const SkPDFGlyphSet* subset);
 
-    void populateType0Font();
-    void populateCIDFont();
+    void populateType0Font(const SkPDFGlyphSet* subset);
+    void populateCIDFont(const SkPDFGlyphSet* subset);
     bool populateType1Font(int16_t glyphID);
 
     /** Populate the PDF font dictionary as Type3 font which includes glyph
@@ -135,9 +201,9 @@ private:
      *  information including glyph paths are queried from the platform
      *  dependent SkGlyphCache.
     */
-    void populateType3Font(int16_t glyphID);
-    bool addFontDescriptor(int16_t defaultWidth);
-    void populateToUnicodeTable();
+    void populateType3Font(int16_t glyphID, const SkPDFGlyphSet* subset);
+    bool addFontDescriptor(int16_t defaultWidth, const SkPDFGlyphSet* subset);
+    void populateToUnicodeTable(const SkPDFGlyphSet* subset);
     void addWidthInfoFromRange(int16_t defaultWidth,
         const SkAdvancedTypefaceMetrics::WidthRange* widthRangeEntry);
     /** Set fFirstGlyphID and fLastGlyphID to span at most 255 glyphs,
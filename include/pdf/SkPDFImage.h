@@ -19,21 +19,24 @@
 
 #include "SkPDFStream.h"
 #include "SkPDFTypes.h"
+#include "SkRect.h"
 #include "SkRefCnt.h"
+#include "SkThread.h"
 
 class SkBitmap;
+class SkData;
 class SkPaint;
 class SkPDFCatalog;
-struct SkIRect;
 
 /** \class SkPDFImage
 
     An image XObject.
 */
 
-// We could play the same trick here as is done in SkPDFGraphicState, storing
-// a copy of the Bitmap object (not the pixels), the pixel generation number,
-// and settings used from the paint to canonicalize image objects.
+// Images of bitmaps with a pixel ref are canonicalized by the pixel ref's
+// generation ID and the part of its pixels that is drawn, so a bitmap drawn on every
+// page is only emitted once per document (resources are deduplicated by
+// pointer).
 class SkPDFImage : public SkPDFObject {
 public:
     /** Create a new Image XObject to represent the passed bitmap.
@@ -41,7 +44,9 @@ public:
      *  @param srcRect  The rectangle to cut out of bitmap.
      *  @param paint    Used to calculate alpha, masks, etc.
      *  @return  The image XObject or NUll if there is nothing to draw for
-     *           the given parameters.
+     *           the given parameters.  The reference count of the object
+     *           is incremented and it is the caller's responsibility to
+     *           unreference it when done.
      */
     static SkPDFImage* CreateImage(const SkBitmap& bitmap,
                                    const SkIRect& srcRect,
@@ -65,6 +70,40 @@ private:
     SkRefPtr<SkPDFStream> fStream;
     SkTDArray<SkPDFObject*> fResources;
 
+    class ImageCanonicalEntry {
+    public:
+        SkPDFImage* fImage;
+        uint32_t fGenerationID;
+        size_t fPixelRefOffset;
+        size_t fRowBytes;
+        int fWidth;
+        int fHeight;
+        int fConfig;
+        SkIRect fSrcRect;
+
+        bool operator==(const ImageCanonicalEntry& b) const;
+        ImageCanonicalEntry(SkPDFImage* image, const SkBitmap& bitmap,
+                            const SkIRect& srcRect);
+    };
+    // This should be made a hash table if performance is a problem.
+    static SkTDArray<ImageCanonicalEntry>& canonicalImages();
+    static SkMutex& canonicalImagesMutex();
+
+    /** Create the image XObject for the passed bitmap without looking for
+     *  it in the canonical images.
+     */
+    static SkPDFImage* EncodeImage(const SkBitmap& bitmap,
+                                   const SkIRect& srcRect,
+                                   const SkPaint& paint);
+
+    /** Create an image XObject of a JPEG file, emitted as is.
+     *  @param jpeg       The JPEG file.
+     *  @param width      The width of the image.
+     *  @param height     The height of the image.
+     *  @param components The number of color components, 1 or 3.
+     */
+    SkPDFImage(SkData* jpeg, int width, int height, int components);
+
     /** Create a PDF image XObject. Entries for the image properties are
      *  automatically added to the stream dictionary.
      *  @param imageData  The final raw bits representing the image.
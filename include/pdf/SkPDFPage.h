@@ -24,6 +24,7 @@
 
 class SkPDFCatalog;
 class SkPDFDevice;
+class SkPDFGlyphSetMap;
 class SkWStream;
 
 /** \class SkPDFPage
@@ -40,6 +41,14 @@ public:
     explicit SkPDFPage(const SkRefPtr<SkPDFDevice>& content);
     ~SkPDFPage();
 
+    /** Put the page content into its (compressed) stream.  This touches no
+     *  catalog and nothing shared with other pages, so it can be done for
+     *  several pages at once on different threads.  finalizePage calls it
+     *  if it hasn't been called yet.  No changes to the PDFDevice will be
+     *  honored afterwards.
+     */
+    void finalizeContent();
+
     /** Before a page and its contents can be sized and emitted, it must
      *  be finalized.  No changes to the PDFDevice will be honored after
      *  finalizePage has been called.  This function adds the page content
@@ -69,6 +78,14 @@ public:
      */
     void emitPage(SkWStream* stream, SkPDFCatalog* catalog);
 
+    /** Drop the page's content once the page and its content have been
+     *  emitted, so that only the (empty) page object is left for the page
+     *  tree to refer to.  The content stream is forgotten by the catalog.
+     *  getFontResources() can't be called afterwards.
+     *  @param catalog    The catalog the page was emitted with.
+     */
+    void releaseContent(SkPDFCatalog* catalog);
+
     /** Generate a page tree for the passed vector of pages.  New objects are
      *  added to the catalog.  The pageTree vector is populated with all of
      *  the 'Pages' dictionaries as well as the 'Page' objects.  Page trees
@@ -90,6 +107,11 @@ public:
      */
     SK_API const SkTDArray<SkPDFFont*>& getFontResources() const;
 
+    /** Get the glyphs used with each font on this page.  Like
+     *  getFontResources(), it can't be called after releaseContent().
+     */
+    SK_API const SkPDFGlyphSetMap& getFontGlyphUsage() const;
+
 private:
     // Multiple pages may reference the content.
     SkRefPtr<SkPDFDevice> fDevice;
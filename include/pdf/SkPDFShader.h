@@ -75,6 +75,7 @@ private:
         explicit State(const SkShader& shader, const SkMatrix& canvasTransform,
                        const SkIRect& bbox);
         bool operator==(const State& b) const;
+        bool equalsExceptBBox(const State& b) const;
     };
 
     SkRefPtr<SkPDFDict> fContent;
@@ -22,6 +22,7 @@
 #include "SkStream.h"
 #include "SkTemplates.h"
 
+class SkData;
 class SkPDFCatalog;
 
 /** \class SkPDFStream
@@ -37,6 +38,14 @@ public:
      *  @param stream The data part of the stream.
      */
     explicit SkPDFStream(SkStream* stream);
+
+    /** Create a PDF stream of data that is already encoded, e.g. a JPEG
+     *  file, which is emitted as is.  Length and Filter entries are added
+     *  to the stream dictionary.
+     *  @param data       The encoded data part of the stream.
+     *  @param filterName The name of the filter that decodes data.
+     */
+    SkPDFStream(SkData* data, const char filterName[]);
     virtual ~SkPDFStream();
 
     // The SkPDFObject interface.
@@ -151,8 +151,19 @@ public:
     explicit SkPDFScalar(SkScalar value);
     virtual ~SkPDFScalar();
 
+    /** The most bytes AppendToBuffer() will write for a single value. */
+    static const int kMaxTextSize = 20;
+
     static void Append(SkScalar value, SkWStream* stream);
 
+    /** Write the PDF text form of value into buffer, which must hold at
+     *  least kMaxTextSize bytes, and return a pointer just past the last
+     *  character written. No terminating zero is written. The output is the
+     *  same as Append() but it goes through neither snprintf nor the locale,
+     *  so callers emitting many numbers can batch them into one write.
+     */
+    static char* AppendToBuffer(SkScalar value, char buffer[]);
+
     // The SkPDFObject interface.
     virtual void emitObject(SkWStream* stream, SkPDFCatalog* catalog,
                             bool indirect);
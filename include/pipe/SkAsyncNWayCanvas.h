@@ -0,0 +1,81 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkAsyncNWayCanvas_DEFINED
+#define SkAsyncNWayCanvas_DEFINED
+
+#include "SkGPipe.h"
+#include "SkTDArray.h"
+
+class SkGPipeFanOutController;
+class SkThreadPool;
+
+/**
+ *  Like SkNWayCanvas, but the drawing is recorded once, into an SkGPipe, and
+ *  each target canvas plays it back on a thread of its own while recording
+ *  goes on, so drawing into N targets takes about as long as the slowest of
+ *  them rather than all of them together, e.g.
+ *
+ *      SkAsyncNWayCanvas nway;
+ *      nway.addCanvas(&rasterCanvas);
+ *      nway.addCanvas(&pdfCanvas);
+ *      SkCanvas* canvas = nway.beginRecording();
+ *      ... draw into canvas ...
+ *      nway.endRecording();
+ *
+ *  The targets must not be used by anyone else until endRecording() has
+ *  returned. Bitmaps are copied into the pipe as they are drawn, so their
+ *  pixels may change once the draw has been made.
+ */
+class SkAsyncNWayCanvas : SkNoncopyable {
+public:
+    SkAsyncNWayCanvas();
+    /** Ends any recording, and waits for the targets to play it back. */
+    ~SkAsyncNWayCanvas();
+
+    /** These can only be called while not recording. */
+    void addCanvas(SkCanvas*);
+    void removeCanvas(SkCanvas*);
+    void removeAll();
+
+    bool isRecording() const { return NULL != fController; }
+
+    /**
+     *  Start a thread for each target, and return the canvas to draw into,
+     *  which is valid until endRecording().
+     */
+    SkCanvas* beginRecording();
+
+    /**
+     *  Stop recording, and wait for every target to finish playing it back.
+     *  Returns false if any of them couldn't play it all back.
+     */
+    bool endRecording();
+
+private:
+    class Target;
+
+    void freeTargets();
+
+    SkTDArray<SkCanvas*>        fList;
+    SkTDArray<Target*>          fTargets;   // one for each of fList
+    SkThreadPool*               fPool;      // with fTargets.count() threads
+    SkGPipeFanOutController*    fController;
+    SkGPipeWriter               fWriter;
+};
+
+#endif
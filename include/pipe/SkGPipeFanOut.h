@@ -0,0 +1,89 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkGPipeFanOut_DEFINED
+#define SkGPipeFanOut_DEFINED
+
+#include "SkGPipe.h"
+
+/**
+ *  Gives an SkGPipeWriter blocks to write into that a fixed number of
+ *  readers play back at the same time, each typically on its own thread and
+ *  into its own tile, e.g.
+ *
+ *      SkBitmap tile;
+ *      dst.extractSubset(&tile, bounds);
+ *      SkCanvas canvas(tile);
+ *      canvas.translate(-SkIntToScalar(bounds.fLeft),
+ *                       -SkIntToScalar(bounds.fTop));
+ *      controller.playback(&canvas);
+ *
+ *  Each block is counted by the readers that haven't finished with it, and
+ *  is freed once the last of them has, so the writer never waits for the
+ *  readers, and the memory held is what the slowest reader has yet to play
+ *  back.
+ *
+ *  Without thread support, playback() can't wait for the writer, so the
+ *  readers have to play back after recording has ended.
+ */
+class SkGPipeFanOutController : public SkGPipeController {
+public:
+    /** readerCount is the number of times playback() will be called. */
+    explicit SkGPipeFanOutController(int readerCount);
+
+    /**
+     *  Frees what the readers haven't. Every playback() must have returned
+     *  (or not been started).
+     */
+    virtual ~SkGPipeFanOutController();
+
+    virtual void* requestBlock(size_t minRequest, size_t* actual);
+    virtual void notifyWritten(size_t bytes);
+
+    /**
+     *  Play back everything the writer writes into the canvas, waiting for
+     *  more as needed, as one of the readers. This may be called from any
+     *  thread, but at most readerCount times. Returns kDone_Status once the
+     *  writer has finished, or kError_Status if the data is bad. Without
+     *  thread support, returns kEOF_Status if it plays back everything
+     *  before the writer has finished.
+     */
+    SkGPipeReader::Status playback(SkCanvas*);
+
+private:
+    struct Block;
+    struct Impl;
+
+    // these do nothing without thread support, where waitForBlocks()
+    // returns false
+    void lock();
+    void unlock();
+    bool waitForBlocks();
+    void wakeReaders();
+
+    // must be called with the lock held
+    void releaseBlock(Block*);
+    void freeUnusedBlocks();
+
+    Impl*   fImpl;
+    Block*  fHead;          // oldest block a reader may still need
+    Block*  fTail;          // the block the writer is writing into
+    int     fReaderCount;   // readers that may still read fTail
+    int     fUnstarted;     // readers that haven't called playback()
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkGPipeSharedMemory_DEFINED
+#define SkGPipeSharedMemory_DEFINED
+
+#include "SkGPipe.h"
+
+/**
+ *  A ring buffer in memory that is shared between processes, which one
+ *  SkGPipeWriter writes into (through an SkGPipeSharedMemoryController) while
+ *  one SkGPipeSharedMemoryReader plays it back, without copying the data in
+ *  between.  The writer waits when the ring is full, and the reader when it
+ *  is empty.
+ *
+ *  If the reader is in another process, the writer has to record with
+ *  SkGPipeWriter::kCrossProcess_Flag.
+ */
+class SkGPipeSharedMemory : SkNoncopyable {
+public:
+    /**
+     *  Create a ring that can hold capacity bytes of pipe data, in anonymous
+     *  shared memory that child processes forked afterwards share.  Returns
+     *  NULL if the memory can't be mapped.
+     */
+    static SkGPipeSharedMemory* Create(size_t capacity);
+
+    /**
+     *  Map a ring from a file descriptor of shared memory (e.g. from
+     *  shm_open()), so that unrelated processes can share it.  Only one of
+     *  them, before the others map it, passes initialize, which sizes the
+     *  memory with ftruncate() and sets up the ring.  The descriptor may be
+     *  closed once the ring is mapped.  Returns NULL if the memory can't be
+     *  mapped.
+     */
+    static SkGPipeSharedMemory* CreateFromFD(int fd, size_t capacity,
+                                             bool initialize);
+
+    /**
+     *  Return the number of bytes to map for a ring with the passed capacity.
+     */
+    static size_t MappedSize(size_t capacity);
+
+    /** Unmaps the memory (in this process only). */
+    ~SkGPipeSharedMemory();
+
+    size_t capacity() const;
+
+private:
+    struct Header;
+
+    SkGPipeSharedMemory(void* memory, size_t mappedSize);
+
+    Header*     fHeader;
+    uint8_t*    fData;
+    size_t      fMappedSize;
+
+    friend class SkGPipeSharedMemoryController;
+    friend class SkGPipeSharedMemoryReader;
+};
+
+/**
+ *  Gives an SkGPipeWriter blocks of an SkGPipeSharedMemory to write into.
+ *  Each block is as much of the free part of the ring (up to its end) as
+ *  there is, so the writer only waits for the reader when the ring is
+ *  nearly full.
+ */
+class SkGPipeSharedMemoryController : public SkGPipeController {
+public:
+    /** The shared memory must outlive the controller. */
+    explicit SkGPipeSharedMemoryController(SkGPipeSharedMemory*);
+
+    /**
+     *  Tells the reader that nothing more will be written, in case the writer
+     *  stopped without finishing (e.g. a block couldn't be had).
+     */
+    virtual ~SkGPipeSharedMemoryController();
+
+    virtual void* requestBlock(size_t minRequest, size_t* actual);
+    virtual void notifyWritten(size_t bytes);
+
+private:
+    SkGPipeSharedMemory* fMemory;
+};
+
+/**
+ *  Plays an SkGPipeSharedMemory back into a canvas while it is being
+ *  written, typically in another process or thread.
+ */
+class SkGPipeSharedMemoryReader : SkNoncopyable {
+public:
+    /** The shared memory must outlive the reader. */
+    SkGPipeSharedMemoryReader(SkGPipeSharedMemory*, SkCanvas* target);
+
+    /**
+     *  Play back what has been written.  If wait is true, this keeps playing
+     *  back until the writer is done, waiting for more data as needed;
+     *  otherwise it returns kEOF_Status once it has played back what was
+     *  written so far.  Returns kDone_Status once it has read everything,
+     *  and kError_Status if the data is bad or the writer stopped without
+     *  finishing.
+     */
+    SkGPipeReader::Status playback(bool wait = true);
+
+private:
+    SkGPipeSharedMemory*    fMemory;
+    SkGPipeReader           fReader;
+    SkGPipeReader::Status   fStatus;
+};
+
+#endif
@@ -39,11 +39,14 @@ extern "C" {
 
 #include "SkTypes.h"
 
+class SkGlyphCache;
 class SkPaint;
 class SkTypeface;
 
 class SK_API SkHarfBuzzFont {
 public:
+    SkHarfBuzzFont() : fShapingCache(NULL) {}
+
     /** The subclass returns the typeface for this font, or NULL
      */
     virtual SkTypeface* getTypeface() const = 0;
@@ -61,6 +64,22 @@ public:
                                      HB_Byte* buffer, HB_UInt* len);
 
     static const HB_FontClass& GetFontClass();
+
+    /** Shape the item, as HB_ShapeItem() does. The item's font must use
+        GetFontClass(), with an SkHarfBuzzFont as its userData.
+
+        The results are kept in a global cache, keyed by the string, the run,
+        the font's attributes (from setupPaint()) and the shaper flags, and
+        are copied out again if the same run is shaped with the same font.
+        Otherwise, the font's callbacks share one glyph cache strike while
+        the run is shaped, instead of finding it for every call.
+     */
+    static HB_Bool ShapeItem(HB_ShaperItem*);
+
+private:
+    SkGlyphCache*   fShapingCache;  // while ShapeItem() runs, or NULL
+
+    friend class SkAutoHarfBuzzShaping;
 };
 
 #endif
@@ -0,0 +1,52 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkSVGPicture_DEFINED
+#define SkSVGPicture_DEFINED
+
+#include "SkTypes.h"
+
+class SkPicture;
+class SkStream;
+
+/** Records SVG documents straight into pictures, parsing them once as they
+    stream through SkXMLParser rather than translating them into the
+    animator's XML first (as SkSVGParser does). This handles the subset that
+    icons use: svg, g, path, rect, circle, ellipse, line, polyline and
+    polygon, with transforms, solid colors, opacity and the stroke
+    properties, given as attributes or in a style. Anything else, such as
+    gradients, text and use, is skipped along with its children.
+ */
+class SkSVGPicture {
+public:
+    /** Returns a new picture of the document, or NULL if it can't be parsed.
+        The caller owns the picture.
+    */
+    static SkPicture* CreateFromStream(SkStream*);
+    static SkPicture* CreateFromData(const void* data, size_t length);
+
+    /** Like CreateFromData(), but returns the picture made earlier for a
+        document with the same bytes, if it is still in the cache. The
+        returned picture has been ref()ed for the caller.
+    */
+    static SkPicture* RefCached(const void* data, size_t length);
+
+    /** Drops every picture that the cache holds. */
+    static void PurgeCache();
+};
+
+#endif
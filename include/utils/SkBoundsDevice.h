@@ -0,0 +1,145 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkBoundsDevice_DEFINED
+#define SkBoundsDevice_DEFINED
+
+#include "SkDevice.h"
+#include "SkTDArray.h"
+
+/** \class SkBoundsDevice
+
+    A device that draws nothing, and instead keeps track of where its draws
+    would have touched pixels, for layout, hit testing or damage passes that
+    need to know where things go but not what they look like. It has no
+    pixels, so none of its draws rasterize anything.
+
+    Each draw's bounds are in device coordinates and intersected with the
+    bounds of the clip. They are conservative: they always contain every
+    pixel the draw would have touched, and are exact for rects and bitmaps
+    drawn without antialiasing or effects through a matrix that keeps rects
+    rects. Strokes, path effects, mask filters and loopers outset them as
+    they do for SkPaint::computeFastBounds(), text uses its glyphs' bounds,
+    and draws whose extent can't be bounded (e.g. with a rasterizer, or
+    through a perspective matrix) cover the whole clip.
+
+    Layers (saveLayer) are devices of this kind too, whose draws are added
+    to the device below them when they are restored.
+
+    The canvas rejects some draws before they reach the device (e.g. when
+    they are clipped out), so to find the bounds of one particular draw,
+    call reset() before it and look at drawnBounds() afterwards.
+*/
+class SkBoundsDevice : public SkDevice {
+public:
+    SkBoundsDevice(int width, int height);
+
+    /** Return the union of the bounds of every draw since the device was
+        created or last reset (or an empty rect if nothing was drawn).
+    */
+    const SkIRect& drawnBounds() const { return fDrawnBounds; }
+
+    /** If record is true, the bounds of each draw are also kept separately,
+        in the order the draws reach the device. They are not by default.
+    */
+    void setRecordDraws(bool record) { fRecordDraws = record; }
+    bool getRecordDraws() const { return fRecordDraws; }
+
+    /** Return the number of draws whose bounds have been recorded. */
+    int countDraws() const { return fDraws.count(); }
+
+    /** Return the bounds of a recorded draw, which are empty if it turned
+        out not to touch any pixels.
+    */
+    const SkIRect& drawBoundsAt(int index) const { return fDraws[index]; }
+
+    /** Forget every draw's bounds. */
+    void reset();
+
+    // overrides from SkDevice
+
+    virtual void clear(SkColor color);
+
+    virtual void drawPaint(const SkDraw&, const SkPaint& paint);
+    virtual void drawPoints(const SkDraw&, SkCanvas::PointMode mode,
+                            size_t count, const SkPoint[],
+                            const SkPaint& paint);
+    virtual void drawRect(const SkDraw&, const SkRect& r,
+                          const SkPaint& paint);
+    virtual void drawPath(const SkDraw&, const SkPath& path,
+                          const SkPaint& paint,
+                          const SkMatrix* prePathMatrix = NULL,
+                          bool pathIsMutable = false);
+    virtual void drawBitmap(const SkDraw&, const SkBitmap& bitmap,
+                            const SkIRect* srcRectOrNull,
+                            const SkMatrix& matrix, const SkPaint& paint);
+    virtual void drawSprite(const SkDraw&, const SkBitmap& bitmap,
+                            int x, int y, const SkPaint& paint);
+    virtual void drawText(const SkDraw&, const void* text, size_t len,
+                          SkScalar x, SkScalar y, const SkPaint& paint);
+    virtual void drawPosText(const SkDraw&, const void* text, size_t len,
+                             const SkScalar pos[], SkScalar constY,
+                             int scalarsPerPos, const SkPaint& paint);
+    virtual void drawTextOnPath(const SkDraw&, const void* text, size_t len,
+                                const SkPath& path, const SkMatrix* matrix,
+                                const SkPaint& paint);
+#ifdef ANDROID
+    virtual void drawPosTextOnPath(const SkDraw& draw, const void* text,
+                                   size_t len, const SkPoint pos[],
+                                   const SkPaint& paint, const SkPath& path,
+                                   const SkMatrix* matrix);
+#endif
+    virtual void drawVertices(const SkDraw&, SkCanvas::VertexMode,
+                              int vertexCount, const SkPoint verts[],
+                              const SkPoint texs[], const SkColor colors[],
+                              SkXfermode* xmode, const uint16_t indices[],
+                              int indexCount, const SkPaint& paint);
+    virtual void drawDevice(const SkDraw&, SkDevice*, int x, int y,
+                            const SkPaint&);
+
+protected:
+    virtual SkDevice* onCreateCompatibleDevice(SkBitmap::Config config,
+                                               int width, int height,
+                                               bool isOpaque,
+                                               Usage usage);
+
+private:
+    SkIRect             fDrawnBounds;
+    SkTDArray<SkIRect>  fDraws;
+    bool                fRecordDraws;
+
+    enum BoundsFlags {
+        kRound_BoundsFlag   = 0x01, // round the edges instead of rounding out
+        kFilled_BoundsFlag  = 0x02, // ignore the paint's style and path effect
+        kOutset_BoundsFlag  = 0x04  // outset by a pixel, e.g. for hinting
+    };
+
+    // add the bounds of a shape whose geometry has the specified bounds,
+    // before it is drawn with paint through matrix
+    void addShapeBounds(const SkDraw&, const SkMatrix& matrix,
+                        const SkRect& bounds, const SkPaint& paint,
+                        unsigned flags = 0);
+    // add bounds that are already in device coordinates, but not clipped
+    void addDeviceBounds(const SkDraw&, const SkRect& bounds,
+                         unsigned flags = 0);
+    // add bounds that are already in device coordinates and clipped
+    void addDrawBounds(const SkIRect& bounds);
+
+    typedef SkDevice INHERITED;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkCaptureCanvas_DEFINED
+#define SkCaptureCanvas_DEFINED
+
+#include "SkNWayCanvas.h"
+#include "SkString.h"
+#include "SkThreadPool.h"
+
+class SkPicture;
+
+/** \class SkCaptureCanvas
+
+    Forwards every call to a target canvas, and on every Nth frame also
+    records the calls into an SkPicture, which is then serialized to a .skp
+    file on a background thread. Unlike SkDumpCanvas nothing is formatted,
+    and frames that aren't sampled cost no more than an SkNWayCanvas with a
+    single canvas, so it can be left on in production.
+
+    Only the most recent captures are kept: they are written into a ring of
+    files named capture_0.skp ... capture_<ringCount-1>.skp in the output
+    directory, and each capture overwrites the oldest one. The directory
+    can then be given to bench's -skps option to replay the captured frames.
+    If a sampled frame comes around while the file it would go into is
+    still being written, that frame is dropped rather than stalling the
+    caller.
+
+    Frames are delimited by beginFrame()/endFrame(), which should be called
+    while the target is at its initial save level, so that the recorded
+    picture is self-contained.
+*/
+class SkCaptureCanvas : public SkNWayCanvas {
+public:
+    /** @param target        the canvas that all calls are forwarded to
+        @param dir           directory that the .skp files are written to
+        @param frameInterval capture one out of every frameInterval frames,
+                             starting with the first. 0 disables capturing.
+        @param ringCount     the number of captures to keep on disk (> 0)
+    */
+    SkCaptureCanvas(SkCanvas* target, const char dir[], int frameInterval,
+                    int ringCount);
+
+    /** Waits for any files that are still being written. */
+    virtual ~SkCaptureCanvas();
+
+    /** Start a frame. If it is sampled, the calls made until endFrame() are
+        also recorded into a width x height picture.
+        @return true if this frame is being captured
+    */
+    bool beginFrame(int width, int height);
+
+    /** End the frame started by beginFrame(). If it was being captured, the
+        picture is queued to be written out.
+    */
+    void endFrame();
+
+    /** Block until every queued capture has been written to disk. */
+    void flush();
+
+    /** Return the number of frames that have been queued to be written. */
+    int captureCount() const { return fCaptureCount; }
+
+    /** Return the number of sampled frames that were dropped because their
+        file was still being written.
+    */
+    int droppedCount() const { return fDroppedCount; }
+
+private:
+    class Slot : public SkRunnable {
+    public:
+        Slot();
+        virtual ~Slot();
+        virtual void run();
+
+        bool isBusy();
+
+        SkPicture*  fPicture;
+        SkString    fPath;
+        int32_t     fBusy;
+    };
+
+    SkThreadPool    fWriter;
+    Slot*           fSlots;
+    int             fRingCount;
+    int             fFrameInterval;
+    int             fFrameCount;
+    int             fCaptureCount;
+    int             fDroppedCount;
+    Slot*           fRecordingSlot;
+
+    typedef SkNWayCanvas INHERITED;
+};
+
+#endif
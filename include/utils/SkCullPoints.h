@@ -43,9 +43,12 @@ private:
     SkIRect      fR;             // the caller's rectangle
     SkIPoint     fAsQuad[4];     // cache of fR as 4 points
     SkIPoint     fPrevPt;        // private state
+    unsigned     fPrevCode;     // which sides of fR fPrevPt is outside of
     LineToResult fPrevResult;   // private state
     
-    bool sect_test(int x0, int y0, int x1, int y1) const;
+    unsigned outcode(int x, int y) const;
+    bool sect_test(int x0, int y0, unsigned code0,
+                   int x1, int y1, unsigned code1) const;
 };
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,111 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkDeferredDevice_DEFINED
+#define SkDeferredDevice_DEFINED
+
+#include "SkDevice.h"
+#include "SkTDArray.h"
+
+/** \class SkDeferredDevice
+
+    A raster device that queues its draws instead of rasterizing them right
+    away. Before the queue is played back into the bitmap,
+    - adjacent rects drawn with the same paint, and adjacent sprites cut from
+      the same pixels, are merged into a single draw;
+    - draws that a later opaque draw completely covers are dropped.
+
+    The queue is played back by flush(), by readPixels(), by anyone calling
+    accessBitmap(), and when the device is destroyed. Draws that the device
+    does not queue (e.g. vertices) flush it first, and then draw directly.
+
+    Bitmaps are copied when they are queued, unless their pixelref is
+    immutable. Other objects the paint refers to, such as a bitmap shader,
+    are not, so their pixels must not change until the queue is flushed.
+*/
+class SkDeferredDevice : public SkDevice {
+public:
+    /** Draw into the specified bitmap's pixels, which the caller must not
+        examine without calling flush() or accessBitmap() first.
+    */
+    SkDeferredDevice(const SkBitmap& bitmap);
+    virtual ~SkDeferredDevice();
+
+    /** Return the number of draws waiting to be played back. A merged draw
+        counts once, and a dropped draw not at all.
+    */
+    int countQueued() const { return fQueue.count(); }
+
+    // overrides from SkDevice
+
+    virtual void clear(SkColor color);
+    virtual void flush();
+
+    virtual void drawPaint(const SkDraw&, const SkPaint& paint);
+    virtual void drawPoints(const SkDraw&, SkCanvas::PointMode mode,
+                            size_t count, const SkPoint[],
+                            const SkPaint& paint);
+    virtual void drawRect(const SkDraw&, const SkRect& r,
+                          const SkPaint& paint);
+    virtual void drawPath(const SkDraw&, const SkPath& path,
+                          const SkPaint& paint,
+                          const SkMatrix* prePathMatrix = NULL,
+                          bool pathIsMutable = false);
+    virtual void drawBitmap(const SkDraw&, const SkBitmap& bitmap,
+                            const SkIRect* srcRectOrNull,
+                            const SkMatrix& matrix, const SkPaint& paint);
+    virtual void drawSprite(const SkDraw&, const SkBitmap& bitmap,
+                            int x, int y, const SkPaint& paint);
+    virtual void drawText(const SkDraw&, const void* text, size_t len,
+                          SkScalar x, SkScalar y, const SkPaint& paint);
+    virtual void drawPosText(const SkDraw&, const void* text, size_t len,
+                             const SkScalar pos[], SkScalar constY,
+                             int scalarsPerPos, const SkPaint& paint);
+    virtual void drawTextOnPath(const SkDraw&, const void* text, size_t len,
+                                const SkPath& path, const SkMatrix* matrix,
+                                const SkPaint& paint);
+#ifdef ANDROID
+    virtual void drawPosTextOnPath(const SkDraw& draw, const void* text,
+                                   size_t len, const SkPoint pos[],
+                                   const SkPaint& paint, const SkPath& path,
+                                   const SkMatrix* matrix);
+#endif
+    virtual void drawVertices(const SkDraw&, SkCanvas::VertexMode,
+                              int vertexCount, const SkPoint verts[],
+                              const SkPoint texs[], const SkColor colors[],
+                              SkXfermode* xmode, const uint16_t indices[],
+                              int indexCount, const SkPaint& paint);
+    virtual void drawDevice(const SkDraw&, SkDevice*, int x, int y,
+                            const SkPaint&);
+
+    class Cmd;
+
+protected:
+    virtual void onAccessBitmap(SkBitmap*);
+    virtual void onAccessBitmapForDraw(SkBitmap*);
+
+private:
+    SkBitmap            fTarget;    // shares the device's pixels
+    SkTDArray<Cmd*>     fQueue;
+    size_t              fCopiedBytes;
+
+    bool canQueue(const SkDraw&, const SkBitmap* bitmap = NULL) const;
+    void queue(Cmd*);
+
+    typedef SkDevice INHERITED;
+};
+
+#endif
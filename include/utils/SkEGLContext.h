@@ -3,6 +3,8 @@
 
 #if defined(SK_MESA)
     #include "GL/osmesa.h"
+#elif defined(SK_EGL)
+    #include <EGL/egl.h>
 #elif defined(SK_BUILD_FOR_MAC)
     #include <AGL/agl.h>
 #elif defined(SK_BUILD_FOR_UNIX)
@@ -17,6 +19,12 @@
 
 /**
  *  Create an offscreen opengl context
+ *
+ *  None of the variants need a window. SK_MESA renders in software through
+ *  OSMesa, and SK_EGL uses EGL without a window system (surfaceless where
+ *  the driver supports it, otherwise a pbuffer), for GPU machines without
+ *  an X server. Either one is selected by defining it and building the
+ *  matching SkEGLContext and GrGLDefaultInterface sources.
  */
 class SkEGLContext {
 public:
@@ -29,6 +37,10 @@ private:
 #if defined(SK_MESA)
     OSMesaContext context;
     GLfloat *image;
+#elif defined(SK_EGL)
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
 #elif defined(SK_BUILD_FOR_MAC)
     AGLContext context;
 #elif defined(SK_BUILD_FOR_UNIX)
@@ -76,6 +76,11 @@ protected:
     };
     static SkScalar ComputeRelativeT(SkMSec time, SkMSec prevTime,
                              SkMSec nextTime, const SkScalar blend[4] = NULL);
+    /** Return the index of the key frame at time, or ~index of the first key
+        frame after it (as SkTSearch does), remembering the result so that
+        the next search for a nearby later time is constant time.
+    */
+    int searchTimes(SkMSec time) const;
     int16_t fFrameCount;
     uint8_t fElemCount;
     uint8_t fFlags;
@@ -86,6 +91,7 @@ protected:
     };
     SkTimeCode* fTimes;     // pointer into fStorage
     void* fStorage;
+    mutable int fLastIndex; // hint for searchTimes()
 #ifdef SK_DEBUG
     SkTimeCode(* fTimesArray)[10];
 #endif
@@ -120,8 +126,26 @@ public:
     */
     Result timeToValues(SkMSec time, SkScalar values[] = NULL) const;
 
+    /** Compute the values of count interpolators at the same time. The
+        interpolators must all have the same element count, and the values
+        are written grouped by element: element e of interpolator i is
+        written to values[e * count + i].
+        @param interps  The interpolators to sample
+        @param count    The number of interpolators
+        @param time     The time to sample (in milliseconds)
+        @param values   Where to write the values [elemCount * count]
+        @param results  (may be null) where to write each interpolator's
+                        Result [count]
+    */
+    static void TimeToValues(const SkInterpolator* const interps[], int count,
+                             SkMSec time, SkScalar values[],
+                             Result results[] = NULL);
+
     SkDEBUGCODE(static void UnitTest();)
 private:
+    void writeValues(int index, SkBool exact, SkScalar T, SkScalar values[],
+                     int stride) const;
+
     SkScalar* fValues;  // pointer into fStorage
 #ifdef SK_DEBUG
     SkScalar(* fScalarsArray)[10];
@@ -19,6 +19,7 @@
 
 #include "SkRefCnt.h"
 #include "SkTDArray.h"
+#include "SkBitmap.h"
 #include "SkColor.h"
 #include "SkMatrix.h"
 #include "SkPoint.h"
@@ -53,6 +54,29 @@ public:
     void setMatrix(const SkMatrix&);
     void setChildrenMatrix(const SkMatrix&);
 
+    // cached content
+
+    /** Return true if this layer keeps what onDraw() draws in a bitmap.
+     */
+    bool isCachingContent() const;
+
+    /** If true, onDraw() draws into a bitmap of this layer's size (rounded up
+        to whole pixels) the first time the layer is drawn, and after that the
+        bitmap is just drawn with the layer's transform and opacity, until
+        inval() is called. Changing only the transform or the opacity then
+        costs one composite: a sprite blit on a raster device, or a textured
+        quad on the GPU, where the bitmap's texture is cached with it.
+        Children still draw themselves on top (each with a cache of their
+        own, if they have one). Since the bitmap is drawn at one pixel per
+        unit, a scaled layer draws it filtered. Off by default.
+     */
+    void setCachingContent(bool);
+
+    /** Mark what onDraw() draws as changed, so that a caching layer calls it
+        again the next time it is drawn. This has no effect on the children.
+     */
+    void inval();
+
     // children
 
     /** Return the number of layers in our child list.
@@ -111,13 +135,22 @@ public:
     }
 
 protected:
+    /** Draw this layer's own content (not its children), in its local
+        coordinates. When the layer is caching its content, this draws into
+        the cache with an opacity of 1, and the opacity is applied when the
+        cache is drawn.
+     */
     virtual void onDraw(SkCanvas*, SkScalar opacity);
 
 private:
     enum Flags {
-        kInheritFromRootTransform_Flag = 0x01
+        kInheritFromRootTransform_Flag  = 0x01,
+        kCachingContent_Flag            = 0x02,
+        kCacheIsDirty_Flag              = 0x04
     };
 
+    void drawCache(SkCanvas*, SkScalar opacity);
+
     SkLayer*    fParent;
     SkScalar    m_opacity;
     SkSize      m_size;
@@ -126,6 +159,7 @@ private:
     SkMatrix    fMatrix;
     SkMatrix    fChildrenMatrix;
     uint32_t    fFlags;
+    SkBitmap    fCache;     // empty unless kCachingContent_Flag is set
 
     SkTDArray<SkLayer*> m_children;
 
@@ -17,15 +17,20 @@
 #ifndef SkNinePatch_DEFINED
 #define SkNinePatch_DEFINED
 
+#include "SkBitmap.h"
 #include "SkRect.h"
 #include "SkRegion.h"
 
-class SkBitmap;
 class SkCanvas;
 class SkPaint;
+class SkShader;
 
-class SkNinePatch {
+class SkNinePatch : SkNoncopyable {
 public:
+    /** Draw the bitmap into dst, stretching all but the margins. On a GPU
+        canvas this is a single drawVertices() (see DrawMesh()), otherwise
+        one drawBitmapRect() per piece.
+     */
     static void DrawNine(SkCanvas* canvas, const SkRect& dst,
                      const SkBitmap& bitmap, const SkIRect& margins,
                      const SkPaint* paint = NULL);
@@ -35,6 +40,33 @@ public:
                          const int32_t xDivs[], int numXDivs,
                          const int32_t yDivs[], int numYDivs,
                          const SkPaint* paint = NULL);
+
+    /** A nine-patch that is drawn over and over (e.g. the background of a
+        button) draws like DrawNine(), but keeps what does not depend on
+        where it is drawn: the nine subsets of the bitmap, and for GPU
+        canvases the bitmap's shader and the mesh for the last size drawn.
+        Pieces that are not scaled (usually the corners) are drawn with
+        drawBitmap(), so that they are blitted as sprites when the canvas
+        only translates by whole pixels.
+     */
+    SkNinePatch(const SkBitmap& bitmap, const SkIRect& margins);
+    ~SkNinePatch();
+
+    void draw(SkCanvas* canvas, const SkRect& dst,
+              const SkPaint* paint = NULL);
+
+private:
+    SkBitmap    fBitmap;
+    SkIRect     fMargins;
+    SkBitmap    fSubsets[9];    // rows of 3, empty for empty pieces
+    SkShader*   fShader;        // for the mesh, made on first use
+
+    // the mesh, with its top left at (0, 0), if fMeshWidth/Height > 0
+    SkScalar    fMeshWidth, fMeshHeight;
+    SkPoint     fVerts[16];
+    SkPoint     fTexs[16];
+
+    bool drawAsMesh(SkCanvas*, const SkRect& dst, const SkPaint*);
 };
 
 #endif
@@ -0,0 +1,129 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkOverdrawDevice_DEFINED
+#define SkOverdrawDevice_DEFINED
+
+#include "SkDevice.h"
+
+class SkXfermode;
+
+/** \class SkOverdrawDevice
+
+    A raster device that counts how many times each of its pixels is drawn
+    to, instead of drawing anything. Every draw counts once for each pixel
+    that it touches with nonzero coverage, whatever its paint's color,
+    shader or xfermode, so that a picture played back into it shows where it
+    draws the same pixels over and over.
+
+    Layers (saveLayer) are devices of this kind too. When one is restored,
+    its counts are added into the device below it, along with one more for
+    each pixel the layer covers, since compositing the layer writes them
+    too.
+
+    The counts are kept as uint32_t in the device's 8888 bitmap, which must
+    not be drawn anywhere as it is: use heatmap() for a bitmap to look at.
+*/
+class SkOverdrawDevice : public SkDevice {
+public:
+    SkOverdrawDevice(int width, int height);
+    virtual ~SkOverdrawDevice();
+
+    /** Return the number of times the pixel at (x, y) was drawn to, which
+        must be inside the device.
+    */
+    uint32_t countAt(int x, int y) const;
+
+    /** Return the largest count of any pixel. */
+    uint32_t maxCount() const;
+
+    /** Return the number of pixels drawn to at least once. */
+    int countCovered() const;
+
+    /** Return the number of pixel writes in all, divided by the number of
+        pixels drawn to at least once (or 0 if there are none).
+    */
+    float averageCount() const;
+
+    /** Set every count back to zero. */
+    void resetCounts();
+
+    /** Turn the counts into colors in an 8888 bitmap the size of the
+        device: pixels that weren't drawn to are transparent, and those that
+        were are blue, green, pink and then red, for drawn to once, twice,
+        three times, and four times or more.
+    */
+    void heatmap(SkBitmap* dst) const;
+
+    // overrides from SkDevice
+
+    virtual void clear(SkColor color);
+
+    virtual void drawPaint(const SkDraw&, const SkPaint& paint);
+    virtual void drawPoints(const SkDraw&, SkCanvas::PointMode mode,
+                            size_t count, const SkPoint[],
+                            const SkPaint& paint);
+    virtual void drawRect(const SkDraw&, const SkRect& r,
+                          const SkPaint& paint);
+    virtual void drawPath(const SkDraw&, const SkPath& path,
+                          const SkPaint& paint,
+                          const SkMatrix* prePathMatrix = NULL,
+                          bool pathIsMutable = false);
+    virtual void drawBitmap(const SkDraw&, const SkBitmap& bitmap,
+                            const SkIRect* srcRectOrNull,
+                            const SkMatrix& matrix, const SkPaint& paint);
+    virtual void drawSprite(const SkDraw&, const SkBitmap& bitmap,
+                            int x, int y, const SkPaint& paint);
+    virtual void drawText(const SkDraw&, const void* text, size_t len,
+                          SkScalar x, SkScalar y, const SkPaint& paint);
+    virtual void drawPosText(const SkDraw&, const void* text, size_t len,
+                             const SkScalar pos[], SkScalar constY,
+                             int scalarsPerPos, const SkPaint& paint);
+    virtual void drawTextOnPath(const SkDraw&, const void* text, size_t len,
+                                const SkPath& path, const SkMatrix* matrix,
+                                const SkPaint& paint);
+#ifdef ANDROID
+    virtual void drawPosTextOnPath(const SkDraw& draw, const void* text,
+                                   size_t len, const SkPoint pos[],
+                                   const SkPaint& paint, const SkPath& path,
+                                   const SkMatrix* matrix);
+#endif
+    virtual void drawVertices(const SkDraw&, SkCanvas::VertexMode,
+                              int vertexCount, const SkPoint verts[],
+                              const SkPoint texs[], const SkColor colors[],
+                              SkXfermode* xmode, const uint16_t indices[],
+                              int indexCount, const SkPaint& paint);
+    virtual void drawDevice(const SkDraw&, SkDevice*, int x, int y,
+                            const SkPaint&);
+
+protected:
+    virtual SkDevice* onCreateCompatibleDevice(SkBitmap::Config config,
+                                               int width, int height,
+                                               bool isOpaque,
+                                               Usage usage);
+
+private:
+    SkXfermode* fCountMode;     // adds one per covered pixel
+    SkXfermode* fLayerMode;     // adds a layer's counts, plus one
+
+    // the paint to draw with instead of paint
+    void countingPaint(const SkPaint& paint, SkPaint* counting) const;
+
+    typedef SkDevice INHERITED;
+};
+
+#endif
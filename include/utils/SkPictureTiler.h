@@ -0,0 +1,88 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkPictureTiler_DEFINED
+#define SkPictureTiler_DEFINED
+
+#include "SkBitmap.h"
+
+class SkPicture;
+class SkThreadPool;
+
+/** \class SkPictureTiler
+
+    Rasterizes an SkPicture into a bitmap by splitting the bitmap into tiles
+    and playing the picture back once per tile, clipped to that tile. Ops that
+    fall entirely outside of a tile are quick-rejected by the tile's canvas.
+
+    When a thread pool is given, the tiles are distributed across its worker
+    threads. If the picture can be drawn on several threads at once (see
+    SkPicture::canDrawConcurrently()) the workers all play it back; if not,
+    each worker plays back its own private copy of it. Each tile writes to a
+    disjoint area of the destination, so no locking is needed around the
+    pixels.
+*/
+class SkPictureTiler {
+public:
+    /** Draw the picture into dst, as if dst were wrapped in an SkCanvas and
+        the picture were drawn into it with an identity matrix.
+        @param picture  the picture to draw. Recording is ended if needed.
+        @param dst      the destination bitmap. Its pixels must be allocated.
+        @param tileWidth  width of each tile in pixels (must be > 0)
+        @param tileHeight height of each tile in pixels (must be > 0)
+        @param pool     optional thread pool. If NULL, or if the pool has no
+                        threads, the tiles are drawn on the calling thread.
+    */
+    static void Draw(SkPicture* picture, const SkBitmap& dst,
+                     int tileWidth, int tileHeight, SkThreadPool* pool = NULL);
+
+    /** Receives the bands drawn by DrawBands(), in order from top to bottom.
+     */
+    class BandSink {
+    public:
+        virtual ~BandSink() {}
+
+        /** Called once per band. The band's pixels are only valid for the
+            duration of the call, since the same memory is reused for the next
+            band. Return false to stop drawing the remaining bands.
+            @param band the finished band. Its width is the output width, and
+                        its height is the band height (the last band may be
+                        shorter).
+            @param top  the y coordinate of the band's first row in the output
+        */
+        virtual bool onBand(const SkBitmap& band, int top) = 0;
+    };
+
+    /** Draw the picture into an output of width x height pixels, one
+        horizontal band at a time, without ever allocating the whole output.
+        Only a single band's worth of pixels is allocated, and each band is
+        cleared to transparent before the picture is played back into it.
+        Ops that fall entirely outside of a band are skipped.
+        @param picture  the picture to draw. Recording is ended if needed.
+        @param width    width of the output in pixels
+        @param height   height of the output in pixels
+        @param bandHeight height of each band in pixels (must be > 0)
+        @param config   the config of the band bitmaps
+        @param sink     receives each band as it is finished
+        @return true if every band was drawn and accepted by the sink, false
+                if the sink stopped early or the band could not be allocated
+    */
+    static bool DrawBands(SkPicture* picture, int width, int height,
+                          int bandHeight, SkBitmap::Config config,
+                          BandSink* sink);
+};
+
+#endif
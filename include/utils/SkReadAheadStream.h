@@ -0,0 +1,111 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkReadAheadStream_DEFINED
+#define SkReadAheadStream_DEFINED
+
+#include "SkStream.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
+
+/** \class SkReadAheadStream
+
+    Wraps another stream (e.g. an SkFILEStream on a network filesystem) and
+    reads it on a background thread, in large blocks that start at multiples
+    of the block size, a few blocks ahead of the caller. A read only waits
+    when the data it needs has not arrived yet.
+
+    The blocks that have been read are kept (up to the cache limit), so a
+    rewind() is served from memory instead of going back to the proxy. This
+    suits the region decoders, which rewind and read the start of the image
+    again for each region, and can prefetch() the part they will need.
+
+    Skipping with read(NULL, size) still reads the bytes in between, as the
+    proxy is read in order. The proxy must not be used by anyone else while
+    it is wrapped.
+*/
+class SkReadAheadStream : public SkStream {
+public:
+    /** The proxy is referenced, and unreferenced in the destructor. If
+        blockSize is 0, a default is used; otherwise it is rounded up to a
+        multiple of 4K. Once more than cacheLimit bytes (or a default, if it
+        is 0) are held, the blocks behind the current position are freed.
+    */
+    SkReadAheadStream(SkStream* proxy, size_t blockSize = 0,
+                      size_t cacheLimit = 0);
+    virtual ~SkReadAheadStream();
+
+    virtual bool        rewind();
+    virtual const char* getFileName();
+    virtual size_t      read(void* buffer, size_t size);
+
+    /** Start reading the proxy up to offset + length (limited to the cache
+        size past the current position) in the background, and pass the hint
+        on to the proxy. Always returns true.
+    */
+    virtual bool        prefetch(size_t offset, size_t length);
+
+    size_t blockSize() const { return fBlockSize; }
+
+private:
+    enum {
+        kDefaultBlockSize   = 64 * 1024,
+        kDefaultCacheLimit  = 4 * 1024 * 1024,
+        kAheadBlocks        = 4,
+        kAlignment          = 4 * 1024
+    };
+
+    struct Filler : SkRunnable {
+        SkReadAheadStream* fStream;
+        virtual void run() { fStream->fill(); }
+    };
+
+    // run by the background thread: read blocks until fFetched >= fTarget
+    void    fill();
+    // raise fTarget to end, and start the background thread if it is idle
+    void    fetchTo(size_t end);
+    // wait until the bytes before end have been fetched (or the proxy has
+    // ended), and return how many of them there are
+    size_t  waitFor(size_t end);
+    // stop the background thread, and return to the start of the proxy
+    void    reset();
+    void    freeBehind();
+
+    SkStream*       fProxy;
+    size_t          fBlockSize;
+    size_t          fCacheLimit;
+    size_t          fLength;        // the proxy's, read once up front
+    size_t          fOffset;        // the caller's position
+    int             fFirstBlock;    // the blocks before it have been freed
+
+    // shared with the background thread, guarded by fMutex
+    SkMutex         fMutex;
+    SkTDArray<char*> fBlocks;       // block i holds [i, i + 1) * fBlockSize
+    size_t          fHeld;          // bytes in the blocks we hold
+    size_t          fFetched;
+    size_t          fTarget;
+    bool            fAtEnd;         // the proxy had no more to give
+    bool            fFilling;       // fFiller has been added to fThread
+
+    Filler          fFiller;
+    SkThreadPool    fThread;
+
+    typedef SkStream INHERITED;
+};
+
+#endif
@@ -18,6 +18,9 @@
 #define SkTextBox_DEFINED
 
 #include "SkCanvas.h"
+#include "SkTDArray.h"
+
+class SkTextBlob;
 
 /** \class SkTextBox
 
@@ -29,10 +32,15 @@
     Spacing is a linear equation used to compute the distance between lines
     of text. Spacing consists of two scalars: mul and add, and the spacing
     between lines is computed as: spacing = paint.getTextSize() * mul + add
+
+    Text given to setText() is retained: its line breaks, glyphs and positions
+    are computed on the first draw() and kept (as one SkTextBlob per line)
+    until the text, the box's width or the paint's font attributes change.
 */
-class SkTextBox {
+class SkTextBox : SkNoncopyable {
 public:
     SkTextBox();
+    ~SkTextBox();
 
     enum Mode {
         kOneLine_Mode,
@@ -62,6 +70,11 @@ public:
 
     void    draw(SkCanvas*, const char text[], size_t len, const SkPaint&);
 
+    /** Retain the text and the paint, for draw(SkCanvas*), countLines() and
+        getTextHeight(). Neither is copied: the text must not change until the
+        next setText(), but the paint may, and the lines are laid out again if
+        its font attributes have.
+    */
     void    setText(const char text[], size_t len, const SkPaint&);
     void    draw(SkCanvas*);
     int     countLines() const;
@@ -74,6 +87,19 @@ private:
     const char* fText;
     size_t      fLen;
     const SkPaint* fPaint;
+
+    // the retained layout of fText, valid if fLinesValid and it was made for
+    // fLinesWidth and fLinesFont
+    mutable SkTDArray<SkTextBlob*> fLines;
+    mutable SkPaint     fLinesFont;
+    mutable SkScalar    fLinesWidth;
+    mutable bool        fLinesValid;
+
+    void    validateLines() const;
+    void    clearLines() const;
+    SkScalar firstBaseline(int lineCount, const SkPaint&,
+                           SkPaint::FontMetrics*, SkScalar* spacing) const;
+    SkScalar lineOriginX(const SkPaint&) const;
 };
 
 class SkTextLineBreaker {
@@ -0,0 +1,67 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkThreadPool_DEFINED
+#define SkThreadPool_DEFINED
+
+#include "SkRunnable.h"
+#include "SkTDArray.h"
+
+/** \class SkThreadPool
+
+    A fixed set of worker threads that execute SkRunnables in the order they
+    were added. The pool does not own the runnables; they must stay alive
+    until wait() returns.
+
+    On platforms without thread support (or when constructed with a count of
+    0) the runnables are executed on the calling thread inside wait().
+*/
+class SkThreadPool : public SkExecutor, SkNoncopyable {
+public:
+    /** Create a pool with the specified number of worker threads. A count of
+        0 means that no threads are created, and all work is done by wait().
+    */
+    explicit SkThreadPool(int threadCount);
+    virtual ~SkThreadPool();
+
+    /** Return the number of worker threads in the pool. */
+    virtual int threadCount() const { return fThreads.count(); }
+
+    /** Queue the runnable for execution on one of the worker threads. */
+    virtual void add(SkRunnable*);
+
+    /** Block until every runnable passed to add() has finished running. */
+    virtual void wait();
+
+    /** Return the number of processors available to the process, or 1 if
+        that cannot be determined.
+    */
+    static int CPUCount();
+
+private:
+    struct Impl;
+
+    static void* Loop(void* pool);
+    SkRunnable* nextRunnable();
+
+    SkTDArray<void*>        fThreads;
+    SkTDArray<SkRunnable*>  fQueue;
+    Impl*                   fImpl;
+    int                     fPending;
+    bool                    fDone;
+};
+
+#endif
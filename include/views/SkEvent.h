@@ -194,7 +194,8 @@ public:
     */
     static void     Term();
 
-    /** Call this to process one event from the queue. If it returns true, there are more events
+    /** Call this to process the events on the queue. Events posted while they are being
+        processed are left for the next call. If it returns true, there are more events
         to process.
     */
     static bool     ProcessEvent();
@@ -215,7 +216,7 @@ public:
     ////////////////////////////////////////////////////
 
     /** Called whenever an SkEvent is posted to an empty queue, so that the OS
-        can be told to later call Dequeue().
+        can be told to later call ProcessEvent().
     */
     static void SignalNonEmptyQueue();
     /** Called whenever the delay until the next delayed event changes. If zero is
@@ -244,12 +245,12 @@ private:
     // these are for our implementation of the event queue
     SkEventSinkID   fTargetID;
     SkMSec          fTime;
-    SkEvent*        fNextEvent; // either in the delay or normal event queue
+    SkEvent*        fNextEvent; // in the normal event queue
     void initialize(const char* type, size_t typeLen);
 
     static bool Enqueue(SkEvent* evt);
     static SkMSec EnqueueTime(SkEvent* evt, SkMSec time);
-    static SkEvent* Dequeue(SkEventSinkID* targetID);
+    static SkEvent* DequeueAll();
     static bool     QHasEvents();
 };
 
@@ -67,7 +67,7 @@ private:
     // Needed for GL
     XVisualInfo* fVi;
 
-    void    doPaint();
+    void    doPaint(const SkIRect* areaOrNull = NULL);
     void    mapWindowAndWait();
 
     typedef SkWindow INHERITED;
@@ -24,6 +24,7 @@
 
 class SkCanvas;
 class SkLayerView;
+class SkPicture;
 
 /** \class SkView
 
@@ -108,6 +109,16 @@ public:
     */
     void        inval(SkRect* rectOrNull);
 
+    /** If caching is on, the view records what it and its children draw into
+        a picture, and plays that back in draw() until inval() is called on
+        the view or one of its descendants. This suits subtrees that rarely
+        change inside a window that is often redrawn. Only what falls within
+        the view's bounds is recorded, and views that override
+        beforeChildren() to draw their children elsewhere shouldn't cache.
+    */
+    void        setCachingDrawing(bool);
+    bool        isCachingDrawing() const { return fPicture != NULL; }
+
     //  Focus management
 
     SkView* getFocusView() const;
@@ -356,6 +367,8 @@ private:
     SkView*     fPrevSibling;
     uint8_t     fFlags;
     uint8_t     fContainsFocus;
+    uint8_t     fPictureIsDirty;
+    SkPicture*  fPicture;
 
     friend class B2FIter;
     friend class F2BIter;
@@ -365,6 +378,7 @@ private:
     bool    setFocusView(SkView* fvOrNull);
     SkView* acceptFocus(FocusDirection);
     void    detachFromParent_NoLayout();
+    void    drawContent(SkCanvas*, bool callAfterChild);
 };
 
 #endif
@@ -406,10 +406,16 @@ private:
     int             fCurrIndex;     // logical index
     int             fScrollIndex;   // logical index of top-most visible row
     int             fVisibleRowCount;
+    // a ring of (left, right) string pairs, holding row i in slot
+    // i % fStrCacheSlots, for the rows [fStrCacheStart, + fStrCacheRows)
     SkString*       fStrCache;
+    int             fStrCacheSlots;
+    int             fStrCacheStart;
+    int             fStrCacheRows;
 
     void    dirtyStrCache();
     void    ensureStrCache(int visibleCount);
+    const SkString* getCachedRow(int index) const;
 
     int     logicalToVisualIndex(int index) const { return index - fScrollIndex; }
     void    invalSelection();
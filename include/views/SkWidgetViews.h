@@ -202,6 +202,7 @@ private:
     SkPaint     fPaint;
     uint8_t     fMode;
     uint8_t     fSpacingAlign;
+    SkTextBox   fTextBox;   // lays out fText with fPaint
 
     void computeSize();
 
@@ -53,6 +53,11 @@ public:
     void    forceInvalAll();
     // return the bounds of the dirty/inval rgn, or [0,0,0,0] if none
     const SkIRect& getDirtyBounds() const { return fDirtyRgn.getBounds(); }
+    // Scroll the pixels of subset (or of the whole bitmap, if it is null) by
+    // dx, dy in place, and inval just the area that this exposes, rather
+    // than all of subset. Anything already dirty inside subset stays dirty
+    // where it has moved to.
+    void    scrollRect(const SkIRect* subset, int dx, int dy);
 
     bool    handleClick(int x, int y, Click::State, void* owner = NULL);
     bool    handleChar(SkUnichar);
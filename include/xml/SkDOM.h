@@ -20,6 +20,7 @@
 #include "SkChunkAlloc.h"
 #include "SkMath.h"
 #include "SkScalar.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 
 struct SkDOMNode;
@@ -58,6 +59,7 @@ public:
     
     // helpers for walking children
     int countChildren(const Node* node, const char elem[] = NULL) const;
+    const Node* getChild(const Node* node, int index) const;
 
     // helpers for calling SkParse
     bool findS32(const Node*, const char name[], int32_t* value) const;
@@ -92,6 +94,14 @@ public:
 private:
     SkChunkAlloc    fAlloc;
     Node*           fRoot;
+    // every element and attribute name, sorted and stored once in fAlloc, so
+    // that lookups compare pointers after a single search for the name
+    SkTDArray<const char*>  fNames;
+
+    const char* findName(const char name[]) const;
+    const char* internName(const char name[]);
+    void reset();
+
     friend class AttrIter;
     friend class SkDOMParser;
 };
@@ -180,11 +180,11 @@ void SkActive::create(SkDrawable* drawable, SkMSec time) {
             bool success = animate->fFieldInfo->setValue(fMaker, &values, 0, 0, NULL, 
                 animate->getValuesType(), animate->formula);
             SkASSERT(success);
-            fApply.applyValues(index, values.begin(), count, animate->getValuesType(), time);
+            fApply.applyValues(fMaker, index, values.begin(), count, animate->getValuesType(), time);
         } else {
             SkAutoSTMalloc<16, SkOperand> values(count);
             interpolator.timeToValues(time, values.get());
-            fApply.applyValues(index, values.get(), count, animate->getValuesType(), time);
+            fApply.applyValues(fMaker, index, values.get(), count, animate->getValuesType(), time);
         }
     }
     drawable->enable(fMaker);
@@ -218,11 +218,11 @@ bool SkActive::immediate(bool enable) {
                 bool success = animate->fFieldInfo->setValue(fMaker, &values, 0, 0, NULL, 
                     animate->getValuesType(), animate->formula);
                 SkASSERT(success);
-                fApply.applyValues(index, values.begin(), count, animate->getValuesType(), time);
+                fApply.applyValues(fMaker, index, values.begin(), count, animate->getValuesType(), time);
             } else {
                 SkAutoSTMalloc<16, SkOperand> values(count);
                 interpolator.timeToValues(time, values.get());
-                fApply.applyValues(index, values.get(), count, animate->getValuesType(), time);
+                fApply.applyValues(fMaker, index, values.get(), count, animate->getValuesType(), time);
             }
         }
         if (enable)
@@ -39,7 +39,7 @@ SkAnimateMaker::SkAnimateMaker(SkAnimator* animator, SkCanvas* canvas, SkPaint*
     : fActiveEvent(NULL), fAdjustedStart(0), fCanvas(canvas), fEnableTime(0), 
         fHostEventSinkID(0), fMinimumInterval((SkMSec) -1), fPaint(paint), fParentMaker(NULL),
         fTimeline(&gDefaultTimeline), fInInclude(false), fInMovie(false),
-        fFirstScriptError(false), fLoaded(false), fIDs(256), fAnimator(animator)
+        fFirstScriptError(false), fLoaded(false), fIDs(256), fCompiledScripts(256), fAnimator(animator)
 {
     fScreenplay.time = 0;
 #if defined SK_DEBUG && defined SK_DEBUG_ANIMATION_TIMING
@@ -52,6 +52,10 @@ SkAnimateMaker::SkAnimateMaker(SkAnimator* animator, SkCanvas* canvas, SkPaint*
 
 SkAnimateMaker::~SkAnimateMaker() {
     deleteMembers();
+    SkTDict<SkCompiledScript*>::Iter iter(fCompiledScripts);
+    SkCompiledScript* compiled;
+    while (iter.next(&compiled))
+        delete compiled;
 }
 
 #if 0
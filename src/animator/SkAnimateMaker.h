@@ -151,6 +151,7 @@ private:
     SkBool8 fLoaded;
     SkTDDisplayableArray fMovies;
     SkTDict<SkDisplayable*> fIDs;
+    SkTDict<SkCompiledScript*> fCompiledScripts; // numeric scripts seen by SkAnimatorScript
     SkAnimator* fAnimator;
     friend class SkAdd;
     friend class SkAnimateBase;
@@ -27,6 +27,7 @@
 #include "SkScript2.h" //   compiled script experiment
 #include "SkSystemEventTypes.h"
 #include "SkTypedArray.h"
+#include "SkWriter32.h"
 #ifdef ANDROID
 #include "SkDrawExtraPathEffect.h"
 #endif
@@ -66,17 +67,34 @@ bool SkAnimator::appendStream(SkStream* stream) {
     return decodeStream(stream);
 }
 
+// precompiled documents are read in place, so they must be 4-byte aligned
+static bool decode_binary(SkDisplayXMLParser& parser, const void* buffer, size_t size) {
+    if (SkAlign4((intptr_t) buffer) == (intptr_t) buffer)
+        return parser.parseBinary(buffer, size);
+    SkAutoMalloc storage(size);
+    memcpy(storage.get(), buffer, size);
+    return parser.parseBinary(storage.get(), size);
+}
+
 bool SkAnimator::decodeMemory(const void* buffer, size_t size)
 {
     fMaker->fFileName.reset();
     SkDisplayXMLParser parser(*fMaker);
+    if (SkDisplayXMLParser::IsBinary(buffer, size))
+        return decode_binary(parser, buffer, size);
     return parser.parse((const char*)buffer, size);
 }
 
 bool SkAnimator::decodeStream(SkStream* stream)
 {
     SkDisplayXMLParser parser(*fMaker);
-    bool result = parser.parse(*stream);
+    bool result;
+    const void* base = stream->getMemoryBase();
+    size_t size = base ? stream->getLength() : 0;
+    if (base && SkDisplayXMLParser::IsBinary(base, size))
+        result = decode_binary(parser, base, size);
+    else
+        result = parser.parse(*stream);
     fMaker->setErrorString();
     return result;
 }
@@ -99,6 +117,16 @@ bool SkAnimator::decodeURI(const char uri[]) {
     return decodeStream(stream);
 }
 
+bool SkAnimator::precompile(const void* buffer, size_t size, SkWStream* dst) {
+    fMaker->fFileName.reset();
+    SkWriter32 recorder(1024);
+    SkDisplayXMLParser parser(*fMaker);
+    parser.setRecorder(&recorder);
+    if (parser.parse((const char*)buffer, size) == false)
+        return false;
+    return parser.writeBinary(dst);
+}
+
 bool SkAnimator::doCharEvent(SkUnichar code) {
     if (code == 0)
         return false;
@@ -519,6 +547,10 @@ void SkAnimator::setHostEventSinkID(SkEventSinkID target) {
 void SkAnimator::onSetHostHandler(Handler ) {
 }
 
+void SkAnimator::setIncrementalDraw(bool incremental, SkColor eraseColor) {
+    fMaker->fDisplayList.setIncremental(incremental, eraseColor);
+}
+
 void SkAnimator::setJavaOwner(Handler ) {
 }
 
@@ -553,6 +585,7 @@ bool SkAnimator::setArray(SkDisplayable* element, const SkMemberInfo* info, SkTy
     //if it's not, we cannot
     SkDisplayTypes type = element->getType();
     if (type == SkType_Array) {
+        fMaker->fDisplayList.touch(element);
         SkDisplayArray* dispArray = (SkDisplayArray*) element;
         dispArray->values = array;  
         return true;
@@ -573,6 +606,7 @@ bool SkAnimator::setArray(const char* id, const char* fieldID, SkTypedArray arra
 }
 
 bool SkAnimator::setInt(SkDisplayable* element, const SkMemberInfo* info, int32_t s32) {
+    fMaker->fDisplayList.touch(element);
     if (info->fType != SkType_MemberProperty) {
         SkOperand operand;
         operand.fS32 = s32;
@@ -598,6 +632,7 @@ bool SkAnimator::setInt(const char* id, const char* fieldID, int32_t s32) {
 }
 
 bool SkAnimator::setScalar(SkDisplayable* element, const SkMemberInfo* info, SkScalar scalar) {
+    fMaker->fDisplayList.touch(element);
     if (info->fType != SkType_MemberProperty) {
         SkOperand operand;
         operand.fScalar = scalar;
@@ -625,6 +660,7 @@ bool SkAnimator::setScalar(const char* id, const char* fieldID, SkScalar scalar)
 bool SkAnimator::setString(SkDisplayable* element, 
         const SkMemberInfo* info, const char* str) {
     // !!! until this is fixed, can't call script with global references from here 
+    fMaker->fDisplayList.touch(element);
     info->setValue(*fMaker, NULL, 0, info->fCount, element, info->getType(), str, strlen(str));
     return true;
 }
@@ -87,8 +87,7 @@ SkAnimatorScript::~SkAnimatorScript() {
 }
 
 bool SkAnimatorScript::evaluate(const char* original, SkScriptValue* result, SkDisplayTypes type) {
-        const char* script = original;
-        bool success = evaluateScript(&script, result);
+        bool success = evaluateCached(original, result);
         if (success == false || result->fType != type) {
             fMaker.setScriptError(*this);
             return false;
@@ -96,6 +95,26 @@ bool SkAnimatorScript::evaluate(const char* original, SkScriptValue* result, SkD
         return true;
 }
 
+// Numeric scripts are parsed once per maker; after that, ones that only combine numbers and
+// id.member values are replayed from what was recorded the first time.
+bool SkAnimatorScript::evaluateCached(const char* original, SkScriptValue* result) {
+    enum { kMaxCompiledScripts = 256 };
+    const char* script = original;
+    if (fReturnType != kInt && fReturnType != kScalar)
+        return evaluateScript(&script, result);
+    SkCompiledScript* compiled;
+    if (fMaker.fCompiledScripts.find(original, &compiled)) {
+        if (compiled->isValid() && compiled->getReturnType() == fReturnType)
+            return evaluateCompiled(*compiled, result);
+        return evaluateScript(&script, result);
+    }
+    if (fMaker.fCompiledScripts.count() >= kMaxCompiledScripts)
+        return evaluateScript(&script, result);
+    compiled = new SkCompiledScript;
+    fMaker.fCompiledScripts.set(original, compiled);
+    return compileScript(&script, result, compiled);
+}
+
 bool SkAnimatorScript::Box(void* user, SkScriptValue* scriptValue) {
     SkAnimatorScript* engine = (SkAnimatorScript*) user;
     SkDisplayTypes type = scriptValue->fType;
@@ -35,6 +35,10 @@ public:
     SkAnimatorScript(SkAnimateMaker& , SkDisplayable* , SkDisplayTypes type);
     ~SkAnimatorScript();
     bool evaluate(const char* script, SkScriptValue* , SkDisplayTypes type);
+    /** Evaluates the script like evaluateScript(), but replays the maker's compiled copy
+        of it if there is one, and compiles numeric scripts the first time they are seen.
+    */
+    bool evaluateCached(const char* script, SkScriptValue* );
     void track(SkDisplayable* displayable) { 
         SkASSERT(fTrackDisplayable.find(displayable) < 0);  
         *fTrackDisplayable.append() = displayable; }
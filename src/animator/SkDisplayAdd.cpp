@@ -86,6 +86,7 @@ void SkAdd::dump(SkAnimateMaker* maker) {
 bool SkAdd::enable(SkAnimateMaker& maker ) {
     SkDisplayTypes type = getType();
     SkDisplayList& displayList = maker.fDisplayList;
+    displayList.touchAll();
     SkTDDrawableArray* parentList = displayList.getDrawList();
     if (type == SkType_Add) {
         if (use == NULL) // not set in apply yet
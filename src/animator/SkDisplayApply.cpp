@@ -112,8 +112,8 @@ void SkApply::append(SkApply* apply) {
     }
 }
 
-void SkApply::applyValues(int animatorIndex, SkOperand* values, int count,
-     SkDisplayTypes valuesType, SkMSec time) 
+void SkApply::applyValues(SkAnimateMaker& maker, int animatorIndex, SkOperand* values,
+     int count, SkDisplayTypes valuesType, SkMSec time) 
 {
     SkAnimateBase* animator = fActive->fAnimators[animatorIndex];
     const SkMemberInfo * info = animator->fFieldInfo;
@@ -121,6 +121,7 @@ void SkApply::applyValues(int animatorIndex, SkOperand* values, int count,
     SkASSERT(info != NULL);
     SkDisplayTypes type = (SkDisplayTypes) info->fType;
     SkDisplayable* target = getTarget(animator);
+    maker.fDisplayList.touch(target);
     if (animator->hasExecute() || type == SkType_MemberFunction || type == SkType_MemberProperty) {
         SkDisplayable* executor = animator->hasExecute() ? animator : target;
         if (type != SkType_MemberProperty) {
@@ -641,11 +642,11 @@ bool SkApply::interpolate(SkAnimateMaker& maker, SkMSec rawTime) {
             SkASSERT(success);
             if (restore)
                 save(inner); // save existing value
-            applyValues(inner, formulaValues.begin(), count, animate->getValuesType(), innerTime);
+            applyValues(maker, inner, formulaValues.begin(), count, animate->getValuesType(), innerTime);
         } else {
             if (restore)
                 save(inner); // save existing value
-            applyValues(inner, values.get(), count, animate->getValuesType(), innerTime);
+            applyValues(maker, inner, values.get(), count, animate->getValuesType(), innerTime);
         }
     }
     return result;
@@ -44,8 +44,8 @@ public:
     void activate(SkAnimateMaker& );
     void append(SkApply* apply);
     void appendActive(SkActive* );
-    void applyValues(int animatorIndex, SkOperand* values, int count,
-        SkDisplayTypes , SkMSec time);
+    void applyValues(SkAnimateMaker& , int animatorIndex, SkOperand* values,
+        int count, SkDisplayTypes , SkMSec time);
     virtual bool contains(SkDisplayable*);
 //  void createActive(SkAnimateMaker& );
     virtual SkDisplayable* deepCopy(SkAnimateMaker* );
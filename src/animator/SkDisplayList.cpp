@@ -19,28 +19,46 @@
 #include "SkAnimateActive.h"
 #include "SkAnimateBase.h"
 #include "SkAnimateMaker.h"
+#include "SkBoundsDevice.h"
+#include "SkCanvas.h"
 #include "SkDisplayApply.h"
 #include "SkDrawable.h"
 #include "SkDrawGroup.h"
 #include "SkDrawMatrix.h"
 #include "SkInterpolator.h"
+#include "SkPicture.h"
 #include "SkTime.h"
 
-SkDisplayList::SkDisplayList() : fDrawBounds(true), fUnionBounds(false), fInTime(0) {
+SkDisplayList::SkDisplayList() : fDrawBounds(true), fUnionBounds(false), fInTime(0),
+    fEraseColor(0), fIncremental(false), fTouchedAll(false) {
+    fCacheClip.setEmpty();
 }
 
 SkDisplayList::~SkDisplayList() {
+    clearCaches();
 }
 
 void SkDisplayList::append(SkActive* active) {
     *fActiveList.append() = active;
 }
 
+void SkDisplayList::clearCaches() {
+    for (Cache* cache = fCaches.begin(); cache < fCaches.end(); cache++)
+        SkSafeUnref(cache->fPicture);
+    fCaches.reset();
+    fTouched.reset();
+}
+
 bool SkDisplayList::draw(SkAnimateMaker& maker, SkMSec inTime) {
     validate();
     fInTime = inTime;
     bool result = false;
     fInvalBounds.setEmpty();
+    if (fIncremental) {
+        result = drawIncremental(maker);
+        validate();
+        return result;
+    }
     if (fDrawList.count()) {
         for (SkActive** activePtr = fActiveList.begin(); activePtr < fActiveList.end(); activePtr++) {
             SkActive* active = *activePtr;
@@ -58,6 +76,238 @@ bool SkDisplayList::draw(SkAnimateMaker& maker, SkMSec inTime) {
     return result;
 }
 
+// Whether drawing this again, if it has not been touched, draws the same and
+// has no other effects, so that it can be played back from a picture instead.
+// Paints change maker.fPaint for what follows them, which a <save> puts back.
+static bool is_static(SkDrawable* drawable, bool inSave) {
+    switch (drawable->getType()) {
+        case SkType_Bitmap:
+        case SkType_Full:
+        case SkType_Image:
+        case SkType_Line:
+        case SkType_Oval:
+        case SkType_Path:
+        case SkType_Polygon:
+        case SkType_Polyline:
+        case SkType_Rect:
+        case SkType_RoundRect:
+        case SkType_Text:
+        case SkType_TextBox:
+        case SkType_TextOnPath:
+        case SkType_Clip:
+        case SkType_Matrix:
+            return true;
+        case SkType_Paint:
+            return inSave;
+        case SkType_Save:
+        case SkType_SaveLayer:
+            inSave = true;
+            // fall through
+        case SkType_Group: {
+            SkGroup* group = (SkGroup*) drawable;
+            if (group->hasCondition())
+                return false;
+            SkTDDrawableArray* children = group->getChildren();
+            for (SkDrawable** ptr = children->begin(); ptr < children->end(); ptr++) {
+                if ((*ptr)->isDrawable() && is_static(*ptr, inSave) == false)
+                    return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// Whether drawing drawable draws target, possibly as part of a group, or as
+// the scope of an apply.
+static bool draws(SkDrawable* drawable, SkDisplayable* target) {
+    if (drawable == target)
+        return true;
+    if (drawable->isApply()) {
+        SkDrawable* scope = ((SkApply*) drawable)->getScope();
+        if (scope && draws(scope, target))
+            return true;
+    } else if (drawable->isGroup()) {
+        SkTDDrawableArray* children = ((SkGroup*) drawable)->getChildren();
+        for (SkDrawable** ptr = children->begin(); ptr < children->end(); ptr++) {
+            if (draws(*ptr, target))
+                return true;
+        }
+        return false;
+    }
+    return drawable->contains(target);
+}
+
+bool SkDisplayList::wasTouched(SkDrawable* drawable) {
+    for (SkDisplayable** ptr = fTouched.begin(); ptr < fTouched.end(); ptr++) {
+        if (draws(drawable, *ptr))
+            return true;
+    }
+    return false;
+}
+
+// draw into a new picture for the cache, and return what draw() returned
+bool SkDisplayList::record(SkAnimateMaker& maker, SkDrawable* drawable, Cache* cache) {
+    SkCanvas* canvas = maker.fCanvas;
+    SkPicture* picture = new SkPicture;
+    maker.fCanvas = picture->beginRecording(canvas->getDevice()->width(),
+        canvas->getDevice()->height());
+    drawable->initialize(); // allow matrices to reset themselves
+    SkASSERT(drawable->isDrawable());
+    bool result = drawable->draw(maker);
+    picture->endRecording();
+    maker.fCanvas = canvas;
+    SkSafeUnref(cache->fPicture);
+    cache->fPicture = picture;
+    return result;
+}
+
+/*  Each of the drawables is recorded into its own picture, which is kept for
+    the next frame. The ones that can't change unless they are touched (see
+    is_static) and weren't are not drawn again, and their old pictures are
+    used. The others are drawn every time, but are only counted as changed
+    if an animation was running in them, or they were touched. Then all of
+    the pictures are played back into an SkBoundsDevice, to find where each
+    one draws (which a matrix or clip before it can change), and the bounds
+    where they drew last time and this time, for those that changed or moved,
+    are repainted, from the pictures.
+ */
+bool SkDisplayList::drawIncremental(SkAnimateMaker& maker) {
+    SkCanvas* canvas = maker.fCanvas;
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    const SkIRect& clip = canvas->getTotalClip().getBounds();
+    bool all = fTouchedAll || matrix != fCacheMatrix || clip != fCacheClip ||
+        *maker.fPaint != fCachePaint;
+    fTouchedAll = false;
+    if (all) {
+        clearCaches();
+        fCacheMatrix = matrix;
+        fCacheClip = clip;
+        fCachePaint = *maker.fPaint;
+    }
+    SkIRect dirty;
+    dirty.setEmpty();
+
+    // find last frame's cache for each drawable; the ones that are left over
+    // were removed, so we repaint where they were
+    SkTDArray<Cache> caches;
+    caches.setCount(fDrawList.count());
+    for (int index = 0; index < fDrawList.count(); index++) {
+        SkDrawable* drawable = fDrawList[index];
+        Cache* cache = &caches[index];
+        int found = index < fCaches.count() && fCaches[index].fDrawable == drawable ? index : -1;
+        for (int inner = 0; found < 0 && inner < fCaches.count(); inner++) {
+            if (fCaches[inner].fDrawable == drawable)
+                found = inner;
+        }
+        if (found >= 0) {
+            *cache = fCaches[found];
+            fCaches[found].fDrawable = NULL;
+            fCaches[found].fPicture = NULL;
+        } else {
+            cache->fDrawable = drawable;
+            cache->fPicture = NULL;
+            cache->fBounds.setEmpty();
+            cache->fResult = false;
+        }
+    }
+    for (Cache* cache = fCaches.begin(); cache < fCaches.end(); cache++) {
+        if (cache->fDrawable) {
+            dirty.join(cache->fBounds);
+            SkSafeUnref(cache->fPicture);
+        }
+    }
+    fCaches.swap(caches);
+
+    for (SkActive** activePtr = fActiveList.begin(); activePtr < fActiveList.end(); activePtr++) {
+        SkActive* active = *activePtr;
+        active->reset();
+    }
+    bool result = false;
+    // the paint each passed over drawable would have been drawn with
+    SkTDArray<SkPaint*> paints;
+    paints.setCount(fCaches.count());
+    for (int index = 0; index < fCaches.count(); index++) {
+        SkDrawable* drawable = fDrawList[index];
+        Cache* cache = &fCaches[index];
+        bool touched = NULL == cache->fPicture || wasTouched(drawable);
+        cache->fChanged = touched || cache->fResult;
+        paints[index] = NULL;
+        if (cache->fChanged == false && is_static(drawable, false)) {
+            paints[index] = new SkPaint(*maker.fPaint);
+            continue;
+        }
+        int touchCount = fTouched.count();
+        bool drawResult = record(maker, drawable, cache);
+        // an animation that just ended may have moved its scope a last time
+        cache->fChanged |= drawResult || fTouched.count() > touchCount;
+        cache->fResult = drawResult;
+        result |= drawResult;
+    }
+    // what was touched after it was passed over is drawn again; if something
+    // was touched that none of the drawables draws, it must be used some
+    // other way (e.g. a rect by a clip), so we draw it all
+    for (SkDisplayable** ptr = fTouched.begin(); all == false && ptr < fTouched.end(); ptr++) {
+        int index;
+        for (index = 0; index < fCaches.count(); index++) {
+            if (draws(fDrawList[index], *ptr))
+                break;
+        }
+        all = fTouchedAll || index == fCaches.count();
+    }
+    all |= fTouchedAll;
+    fTouchedAll = false;
+    SkPaint* paint = maker.fPaint;
+    for (int index = 0; index < fCaches.count(); index++) {
+        Cache* cache = &fCaches[index];
+        SkDrawable* drawable = fDrawList[index];
+        if (paints[index] && (all || wasTouched(drawable))) {
+            maker.fPaint = paints[index];
+            record(maker, drawable, cache);
+            cache->fChanged = true;
+        }
+    }
+    maker.fPaint = paint;
+    paints.deleteAll();
+    fTouched.reset();
+
+    SkBoundsDevice* device = new SkBoundsDevice(canvas->getDevice()->width(),
+        canvas->getDevice()->height());
+    SkCanvas bounder(device);
+    device->unref();
+    bounder.clipRect(SkRect::MakeLTRB(SkIntToScalar(clip.fLeft), SkIntToScalar(clip.fTop),
+        SkIntToScalar(clip.fRight), SkIntToScalar(clip.fBottom)));
+    bounder.setMatrix(matrix);
+    for (Cache* cache = fCaches.begin(); cache < fCaches.end(); cache++) {
+        device->reset();
+        cache->fPicture->draw(&bounder);
+        const SkIRect& bounds = device->drawnBounds();
+        if (cache->fChanged || bounds != cache->fBounds) {
+            dirty.join(cache->fBounds);
+            dirty.join(bounds);
+        }
+        cache->fBounds = bounds;
+    }
+    if (all)
+        dirty = clip;
+    if (dirty.intersect(clip)) {
+        int saveCount = canvas->save();
+        canvas->resetMatrix();
+        canvas->clipRect(SkRect::MakeLTRB(SkIntToScalar(dirty.fLeft), SkIntToScalar(dirty.fTop),
+            SkIntToScalar(dirty.fRight), SkIntToScalar(dirty.fBottom)));
+        canvas->drawColor(fEraseColor, SkXfermode::kSrc_Mode);
+        canvas->setMatrix(matrix);
+        for (Cache* cache = fCaches.begin(); cache < fCaches.end(); cache++)
+            cache->fPicture->draw(canvas);
+        canvas->restoreToCount(saveCount);
+    } else
+        dirty.setEmpty();
+    fInvalBounds = dirty;
+    fHasUnion = true;
+    return result || dirty.isEmpty() == false;
+}
+
 int SkDisplayList::findGroup(SkDrawable* match, SkTDDrawableArray** list,
         SkGroup** parent, SkGroup** found, SkTDDrawableArray**grandList) { 
     *parent = NULL;
@@ -69,6 +319,7 @@ int SkDisplayList::findGroup(SkDrawable* match, SkTDDrawableArray** list,
 void SkDisplayList::hardReset() {
     fDrawList.reset();
     fActiveList.reset();
+    clearCaches();
 }
 
 bool SkDisplayList::onIRect(const SkIRect& r) {
@@ -131,6 +382,27 @@ void SkDisplayList::reset() {
     }           
 }
 
+void SkDisplayList::setIncremental(bool incremental, SkColor eraseColor) {
+    fIncremental = incremental;
+    fEraseColor = eraseColor;
+    fTouchedAll = true;
+    clearCaches();
+}
+
+void SkDisplayList::touch(SkDisplayable* target) {
+    if (fIncremental == false || fTouchedAll)
+        return;
+    // paints and matrices can be referenced by other elements, and changes to
+    // what isn't drawn (e.g. a shader) go who knows where
+    SkDisplayTypes type = target->getType();
+    if (target->isDrawable() == false || type == SkType_Paint || type == SkType_Matrix) {
+        fTouchedAll = true;
+        return;
+    }
+    if (fTouched.find(target) < 0)
+        *fTouched.append() = target;
+}
+
 void SkDisplayList::remove(SkActive* active) {
     int index = fActiveList.find(active);
     SkASSERT(index >= 0);
@@ -21,6 +21,8 @@
 #include "SkOperand.h"
 #include "SkIntArray.h"
 #include "SkBounder.h"
+#include "SkMatrix.h"
+#include "SkPaint.h"
 #include "SkRect.h"
 
 class SkAnimateMaker;
@@ -28,13 +30,14 @@ class SkActive;
 class SkApply;
 class SkDrawable;
 class SkGroup;
+class SkPicture;
 
 class SkDisplayList : public SkBounder {
 public:
     SkDisplayList();
     virtual ~SkDisplayList();
     void append(SkActive* );
-    void clear() { fDrawList.reset(); }
+    void clear() { fDrawList.reset(); this->clearCaches(); }
     int count() { return fDrawList.count(); }
     bool draw(SkAnimateMaker& , SkMSec time);
 #ifdef SK_DUMP_ENABLED
@@ -52,6 +55,14 @@ public:
     virtual bool onIRect(const SkIRect& r);
     void reset();
     void remove(SkActive* );
+    // when incremental, draw() erases to eraseColor and repaints only what
+    // has changed since the last frame, and sets fInvalBounds to it (see
+    // SkAnimator)
+    void setIncremental(bool incremental, SkColor eraseColor);
+    // note that target has been changed, e.g. by an animation
+    void touch(SkDisplayable* target);
+    // note that we can't tell what has been changed
+    void touchAll() { fTouchedAll = true; }
 #ifdef SK_DEBUG
     void validate();
 #else
@@ -69,9 +80,30 @@ public:
     bool fHasUnion;
     bool fUnionBounds;
 private:
+    // what each of fDrawList's drawables drew last time, when incremental
+    struct Cache {
+        SkDrawable* fDrawable;
+        SkPicture* fPicture;
+        SkIRect fBounds;    // in device coordinates
+        bool fResult;       // from the drawable's last draw()
+        bool fChanged;
+    };
+    void clearCaches();
+    bool drawIncremental(SkAnimateMaker& );
+    bool record(SkAnimateMaker& , SkDrawable* , Cache* );
+    bool wasTouched(SkDrawable* );
+
     SkTDDrawableArray fDrawList;
     SkTDActiveArray fActiveList;
     SkMSec fInTime;
+    SkTDArray<Cache> fCaches;
+    SkTDDisplayableArray fTouched;
+    SkMatrix fCacheMatrix;  // the canvas and paint that fCaches were drawn with
+    SkIRect fCacheClip;
+    SkPaint fCachePaint;
+    SkColor fEraseColor;
+    bool fIncremental;
+    bool fTouchedAll;
     friend class SkEvents;
 };
 
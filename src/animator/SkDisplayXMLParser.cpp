@@ -18,7 +18,10 @@
 #include "SkDisplayXMLParser.h"
 #include "SkAnimateMaker.h"
 #include "SkDisplayApply.h"
+#include "SkReader32.h"
+#include "SkStream.h"
 #include "SkUtils.h"
+#include "SkWriter32.h"
 #ifdef SK_DEBUG
 #include "SkTime.h"
 #endif
@@ -55,6 +58,48 @@ static char const* const gErrorStrings[] = {
     "unexpected type "
 };
 
+/*  A precompiled document is a sequence of 32 bit words: a header, the compiled scripts, then
+    one verb for each element and attribute the parser acted on, followed by its data. Types
+    and members are stored as the enums and indices of the build that wrote them, so that
+    reading them back needs no name lookups.
+ */
+enum {
+    kBinaryTag = SkSetFourByteTag('s', 'k', 'a', 'b'),
+    kBinaryVersion = 1
+};
+
+enum BinaryVerb {
+    kStartScreenplay_BinaryVerb,    // name
+    kStartElement_BinaryVerb,       // type, name
+    kID_BinaryVerb,                 // value
+    kMember_BinaryVerb,             // member index, name, value
+    kEndElement_BinaryVerb,
+    kEndScreenplay_BinaryVerb,
+    kScripts_BinaryVerb,            // count, then for each: script, compiled script
+    kEnd_BinaryVerb
+};
+
+// the index-th member of type, counting the ones it inherits first
+static const SkMemberInfo* GetMemberAt(SkAnimateMaker* maker, SkDisplayTypes type, int index) {
+#if SK_USE_CONDENSED_INFO == 0
+    int infoCount;
+    const SkMemberInfo* info = SkDisplayType::GetMembers(maker, type, &infoCount);
+    return SkMemberInfo::Find(info, infoCount, &index);
+#else
+    return SkMemberInfo::Find(type, &index);
+#endif
+}
+
+// returns NULL instead of reading past the end of the document
+static const char* read_string(SkReader32& reader, size_t* len) {
+    if (reader.available() < sizeof(uint32_t))
+        return NULL;
+    size_t length = *(const uint32_t*) reader.peek();
+    if (length >= reader.available() - sizeof(uint32_t))
+        return NULL;
+    return reader.readString(len);
+}
+
 SkDisplayXMLParserError::~SkDisplayXMLParserError() {
 }
 
@@ -79,7 +124,7 @@ void SkDisplayXMLParserError::setInnerError(SkAnimateMaker* parent, const SkStri
 
 SkDisplayXMLParser::SkDisplayXMLParser(SkAnimateMaker& maker)
     : INHERITED(&maker.fError), fMaker(maker), fInInclude(maker.fInInclude), 
-        fInSkia(maker.fInInclude), fCurrDisplayable(NULL)
+        fInSkia(maker.fInInclude), fCurrDisplayable(NULL), fRecorder(NULL)
 {
 }
 
@@ -107,34 +152,59 @@ bool SkDisplayXMLParser::onAddAttributeLen(const char attrName[], const char att
 {
     if (fCurrDisplayable == NULL)    // this signals we should ignore attributes for this element
         return strncmp(attrName, "xmlns", sizeof("xmlns") - 1) != 0;
-    SkDisplayable*  displayable = fCurrDisplayable;
-    SkDisplayTypes  type = fCurrType;
-
     if (strcmp(attrName, "id") == 0) {
-        if (fMaker.find(attrValue, attrValueLen, NULL)) {
-            fError->setNoun(attrValue, attrValueLen);
-            fError->setCode(SkXMLParserError::kDuplicateIDs);
+        if (setID(attrValue, attrValueLen))
             return true;
-        }
-#ifdef SK_DEBUG
-        displayable->_id.set(attrValue, attrValueLen);
-        displayable->id = displayable->_id.c_str();
-#endif
-        fMaker.idsSet(attrValue, attrValueLen, displayable);
-        int parentIndex = fParents.count() - 1;
-        if (parentIndex > 0) {
-            SkDisplayable* parent = fParents[parentIndex - 1].fDisplayable;
-            parent->setChildHasID();
+        if (fRecorder) {
+            fRecorder->write32(kID_BinaryVerb);
+            fRecorder->writeString(attrValue, attrValueLen);
         }
         return false;
     }
     const char* name = attrName;
-    const SkMemberInfo* info = SkDisplayType::GetMember(&fMaker, type, &name);
+    const SkMemberInfo* info = SkDisplayType::GetMember(&fMaker, fCurrType, &name);
     if (info == NULL) {
         fError->setNoun(name);
         fError->setCode(SkXMLParserError::kUnknownAttributeName);
         return true;
     }
+    if (setMember(info, name, attrValue, attrValueLen))
+        return true;
+    if (fRecorder) {
+        int index = 0;
+        while (GetMemberAt(&fMaker, fCurrType, index) != info)
+            index++;
+        fRecorder->write32(kMember_BinaryVerb);
+        fRecorder->write32(index);
+        fRecorder->writeString(name);
+        fRecorder->writeString(attrValue, attrValueLen);
+    }
+    return false;
+}
+
+bool SkDisplayXMLParser::setID(const char attrValue[], size_t attrValueLen) {
+    SkDisplayable* displayable = fCurrDisplayable;
+    if (fMaker.find(attrValue, attrValueLen, NULL)) {
+        fError->setNoun(attrValue, attrValueLen);
+        fError->setCode(SkXMLParserError::kDuplicateIDs);
+        return true;
+    }
+#ifdef SK_DEBUG
+    displayable->_id.set(attrValue, attrValueLen);
+    displayable->id = displayable->_id.c_str();
+#endif
+    fMaker.idsSet(attrValue, attrValueLen, displayable);
+    int parentIndex = fParents.count() - 1;
+    if (parentIndex > 0) {
+        SkDisplayable* parent = fParents[parentIndex - 1].fDisplayable;
+        parent->setChildHasID();
+    }
+    return false;
+}
+
+bool SkDisplayXMLParser::setMember(const SkMemberInfo* info, const char name[],
+        const char attrValue[], size_t attrValueLen) {
+    SkDisplayable* displayable = fCurrDisplayable;
     if (info->setValue(fMaker, NULL, 0, info->getCount(), displayable, info->getType(), attrValue,
             attrValueLen))
         return false;
@@ -174,6 +244,13 @@ bool SkDisplayXMLParser::onAddAttributeLen(const char attrName[], const char att
 
 bool SkDisplayXMLParser::onEndElement(const char elem[])
 {
+    bool screenplay = SK_strcasecmp(elem, "screenplay") == 0;
+    if (fRecorder && (screenplay || fParents.count() > 0))
+        fRecorder->write32(screenplay ? kEndScreenplay_BinaryVerb : kEndElement_BinaryVerb);
+    return endDisplayable(screenplay);
+}
+
+bool SkDisplayXMLParser::endDisplayable(bool screenplay) {
     int parentIndex = fParents.count() - 1;
     if (parentIndex >= 0) {
         Parent& container = fParents[parentIndex];
@@ -207,7 +284,7 @@ bool SkDisplayXMLParser::onEndElement(const char elem[])
         fParents.remove(parentIndex);
     }
     fCurrDisplayable = NULL;
-    if (fInInclude == false && SK_strcasecmp(elem, "screenplay") == 0) {
+    if (fInInclude == false && screenplay) {
         if (fMaker.fInMovie == false) {
             fMaker.fEnableTime = fMaker.getAppTime();
 #if defined SK_DEBUG && defined SK_DEBUG_ANIMATION_TIMING
@@ -240,21 +317,43 @@ bool SkDisplayXMLParser::onStartElementLen(const char name[], size_t len) {
     fCurrDisplayable = NULL; // init so we'll ignore attributes if we exit early
 
     if (SK_strncasecmp(name, "screenplay", len) == 0) {
-        fInSkia = true;
-        if (fInInclude == false)
-            fMaker.idsSet(name, len, &fMaker.fScreenplay);
+        startScreenplay(name, len);
+        if (fRecorder) {
+            fRecorder->write32(kStartScreenplay_BinaryVerb);
+            fRecorder->writeString(name, len);
+        }
         return false;
     }
     if (fInSkia == false)
         return false;
 
-    SkDisplayable* displayable = fMaker.createInstance(name, len);
+    SkDisplayTypes type = SkDisplayType::GetType(&fMaker, name, len);
+    if (startDisplayable(type, name, len))
+        return true;
+    if (fRecorder) {
+        fRecorder->write32(kStartElement_BinaryVerb);
+        fRecorder->write32(type);
+        fRecorder->writeString(name, len);
+    }
+    return false;
+}
+
+void SkDisplayXMLParser::startScreenplay(const char name[], size_t len) {
+    fCurrDisplayable = NULL;
+    fInSkia = true;
+    if (fInInclude == false)
+        fMaker.idsSet(name, len, &fMaker.fScreenplay);
+}
+
+bool SkDisplayXMLParser::startDisplayable(SkDisplayTypes type, const char name[], size_t len) {
+    fCurrDisplayable = NULL;
+    SkDisplayable* displayable = (int) type >= 0 ? SkDisplayType::CreateInstance(&fMaker, type) : NULL;
     if (displayable == NULL) {
         fError->setNoun(name, len);
         fError->setCode(SkXMLParserError::kUnknownElement);
         return true;
     }
-    SkDisplayTypes type = displayable->getType();
+    type = displayable->getType();
     Parent record = { displayable, type };
     *fParents.append() = record;
     if (fParents.count() == 1)
@@ -323,4 +422,114 @@ rectNext:
     return NULL;
 }
 
+bool SkDisplayXMLParser::IsBinary(const void* data, size_t size) {
+    uint32_t header[2];
+    if (size < sizeof(header))
+        return false;
+    memcpy(header, data, sizeof(header));
+    return header[0] == kBinaryTag && header[1] == kBinaryVersion;
+}
+
+bool SkDisplayXMLParser::parseBinary(const void* data, size_t size) {
+    if (IsBinary(data, size) == false || SkAlign4((intptr_t) data) != (intptr_t) data) {
+        fError->setCode(SkXMLParserError::kUnknownError);
+        return false;
+    }
+    SkReader32 reader(data, size & ~3);
+    reader.skip(2 * sizeof(uint32_t));
+    const char* name;
+    const char* value;
+    size_t nameLen, valueLen;
+    for (;;) {
+        bool stop = false;
+        if (reader.available() < sizeof(uint32_t))
+            goto badData;
+        switch (reader.readU32()) {
+            case kStartScreenplay_BinaryVerb:
+                if ((name = read_string(reader, &nameLen)) == NULL)
+                    goto badData;
+                startScreenplay(name, nameLen);
+                break;
+            case kStartElement_BinaryVerb: {
+                if (reader.available() < sizeof(uint32_t))
+                    goto badData;
+                SkDisplayTypes type = (SkDisplayTypes) reader.readS32();
+                if ((name = read_string(reader, &nameLen)) == NULL)
+                    goto badData;
+                stop = startDisplayable(type, name, nameLen);
+                } break;
+            case kID_BinaryVerb:
+                if ((value = read_string(reader, &valueLen)) == NULL || fCurrDisplayable == NULL)
+                    goto badData;
+                stop = setID(value, valueLen);
+                break;
+            case kMember_BinaryVerb: {
+                if (reader.available() < sizeof(uint32_t) || fCurrDisplayable == NULL)
+                    goto badData;
+                int index = reader.readS32();
+                const SkMemberInfo* info = index >= 0 ?
+                    GetMemberAt(&fMaker, fCurrType, index) : NULL;
+                if (info == NULL || (name = read_string(reader, &nameLen)) == NULL ||
+                        (value = read_string(reader, &valueLen)) == NULL)
+                    goto badData;
+                stop = setMember(info, name, value, valueLen);
+                } break;
+            case kEndElement_BinaryVerb:
+                stop = endDisplayable(false);
+                break;
+            case kEndScreenplay_BinaryVerb:
+                stop = endDisplayable(true);
+                break;
+            case kScripts_BinaryVerb: {
+                if (reader.available() < sizeof(uint32_t))
+                    goto badData;
+                int count = reader.readS32();
+                for (int index = 0; index < count; index++) {
+                    if ((name = read_string(reader, &nameLen)) == NULL)
+                        goto badData;
+                    SkCompiledScript* compiled = new SkCompiledScript;
+                    if (compiled->unflatten(reader) == false) {
+                        delete compiled;
+                        goto badData;
+                    }
+                    SkCompiledScript* existing;
+                    if (fMaker.fCompiledScripts.find(name, &existing)) {
+                        delete compiled;
+                        continue;
+                    }
+                    fMaker.fCompiledScripts.set(name, compiled);
+                }
+                } break;
+            case kEnd_BinaryVerb:
+                return true;
+            default:
+                goto badData;
+        }
+        if (stop)
+            return false;
+    }
+badData:
+    if (fError->hasError() == false)
+        fError->setCode(SkXMLParserError::kUnknownError);
+    return false;
+}
 
+bool SkDisplayXMLParser::writeBinary(SkWStream* dst) {
+    SkASSERT(fRecorder);
+    SkWriter32 header(1024);
+    header.write32(kBinaryTag);
+    header.write32(kBinaryVersion);
+    header.write32(kScripts_BinaryVerb);
+    header.write32(fMaker.fCompiledScripts.count());
+    SkTDict<SkCompiledScript*>::Iter iter(fMaker.fCompiledScripts);
+    SkCompiledScript* compiled;
+    const char* script;
+    while ((script = iter.next(&compiled)) != NULL) {
+        header.writeString(script);
+        compiled->flatten(header);
+    }
+    if (header.writeToStream(dst) == false || fRecorder->writeToStream(dst) == false)
+        return false;
+    uint32_t end = kEnd_BinaryVerb;
+    return dst->write(&end, sizeof(end));
+}
@@ -25,6 +25,8 @@
 
 class SkAnimateMaker;
 class SkDisplayable;
+class SkWStream;
+class SkWriter32;
 
 class SkDisplayXMLParserError : public SkXMLParserError {
 public:
@@ -70,6 +72,20 @@ class SkDisplayXMLParser : public SkXMLParser {
 public:
     SkDisplayXMLParser(SkAnimateMaker& maker);
     virtual ~SkDisplayXMLParser();
+    /** Returns true if data starts like a document written by writeBinary(). */
+    static bool IsBinary(const void* data, size_t size);
+    /** Builds the document written by writeBinary() without parsing any XML. data must be
+        4-byte aligned; it is only read from, so it can be mapped straight from a file.
+    */
+    bool parseBinary(const void* data, size_t size);
+    /** While recorder is set, each element and attribute that parse() adds to the maker
+        is also recorded into it, with its type and member already looked up.
+    */
+    void setRecorder(SkWriter32* recorder) { fRecorder = recorder; }
+    /** Writes what was recorded, together with the scripts the maker has compiled so far,
+        as one document for parseBinary(). The format is tied to the build that wrote it.
+    */
+    bool writeBinary(SkWStream* dst);
 protected:
     virtual bool onAddAttribute(const char name[], const char value[]);
     bool onAddAttributeLen(const char name[], const char value[], size_t len);
@@ -83,15 +99,21 @@ private:
     };
     SkTDArray<Parent> fParents;
     SkDisplayXMLParser& operator= (const SkDisplayXMLParser& );
+    bool endDisplayable(bool screenplay);
     SkDisplayXMLParserError* getError() { return (SkDisplayXMLParserError*) fError; }
     const SkMemberInfo* searchContainer(const SkMemberInfo* ,
         int infoCount);
+    bool setID(const char value[], size_t len);
+    bool setMember(const SkMemberInfo* , const char name[], const char value[], size_t len);
+    bool startDisplayable(SkDisplayTypes , const char name[], size_t len);
+    void startScreenplay(const char name[], size_t len);
     SkAnimateMaker& fMaker;
     SkBool fInInclude;
     SkBool fInSkia;
     // local state between onStartElement and onAddAttribute
     SkDisplayable*  fCurrDisplayable;
     SkDisplayTypes  fCurrType;
+    SkWriter32* fRecorder;
     friend class SkXMLAnimatorWriter;
     typedef SkXMLParser INHERITED;
 };
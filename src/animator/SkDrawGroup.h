@@ -44,6 +44,7 @@ public:
     virtual bool enable(SkAnimateMaker& );
     SkTDDrawableArray* getChildren() { return &fChildren; }
     SkGroup* getOriginal() { return fOriginal; }
+    bool hasCondition() const { return condition.size() > 0; }
     virtual bool hasEnable() const;
     virtual void initialize();
     SkBool isACopy() { return fOriginal != NULL; }
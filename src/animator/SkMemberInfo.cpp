@@ -255,8 +255,7 @@ bool SkMemberInfo::setValue(SkAnimateMaker& maker, SkTDOperandArray* arrayStorag
         case SkType_Float:
         case SkType_Array:
 scriptCommon: {
-                const char* script = valueStr.c_str();
-                success = engine.evaluateScript(&script, &scriptValue);
+                success = engine.evaluateCached(valueStr.c_str(), &scriptValue);
                 if (success == false) {
                     maker.setScriptError(engine);
                     return false;
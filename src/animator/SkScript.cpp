@@ -18,8 +18,10 @@
 #include "SkScript.h"
 #include "SkMath.h"
 #include "SkParse.h"
+#include "SkReader32.h"
 #include "SkString.h"
 #include "SkTypedArray.h"
+#include "SkWriter32.h"
 
 /* things to do
     ? re-enable support for struct literals (e.g., for initializing points or rects)
@@ -186,7 +188,7 @@ static int token_length(const char* start) {
 }
 
 SkScriptEngine::SkScriptEngine(SkOpType returnType) :
-    fTokenLength(0), fReturnType(returnType), fError(kNoError)
+    fTokenLength(0), fReturnType(returnType), fError(kNoError), fCompiling(NULL)
 {
     SkSuppress noInitialSuppress;
     noInitialSuppress.fOperator = kUnassigned;
@@ -347,6 +349,20 @@ bool SkScriptEngine::convertParams(SkTDArray<SkScriptValue>& params,
     return true;
 }
 
+bool SkScriptEngine::compileScript(const char** script, SkScriptValue* value,
+        SkCompiledScript* compiled) {
+    compiled->fSteps.reset();
+    compiled->fNames.reset();
+    compiled->fReturnType = fReturnType;
+    compiled->fValid = fReturnType == kInt || fReturnType == kScalar;
+    fCompiling = compiled->fValid ? compiled : NULL;
+    bool success = evaluateScript(script, value);
+    if (success == false)
+        compiled->fValid = false;
+    fCompiling = NULL;
+    return success;
+}
+
 bool SkScriptEngine::convertTo(SkDisplayTypes toType, SkScriptValue* value ) {
     SkDisplayTypes type = value->fType;
     if (type == toType)
@@ -381,12 +397,26 @@ bool SkScriptEngine::evaluateDot(const char*& script, bool suppressed) {
     }
     const char* field = script;
     script += fieldLength;
+    SkCompiledScript* compiling = fCompiling;
+    if (compiling) {
+        const char* next = script;
+        while (is_ws(next[0]))
+            next++;
+        if (next[0] == '(') {
+            notCompilable();
+            compiling = NULL;
+        } else
+            compiling->addMember(fToken, fTokenLength, field, fieldLength);
+        fCompiling = NULL;  // the replay looks up the object and its member itself
+    }
     bool success = handleProperty(suppressed);
     if (success == false) {
         fError = kCouldNotFindReferencedID; // note: never generated by standard animator plugins
         return false;
     }
-    return evaluateDotParam(script, suppressed, field, fieldLength);
+    success = evaluateDotParam(script, suppressed, field, fieldLength);
+    fCompiling = compiling;
+    return success;
 }
 
 bool SkScriptEngine::evaluateDotParam(const char*& script, bool suppressed, 
@@ -423,6 +453,41 @@ bool SkScriptEngine::evaluateDotParam(const char*& script, bool suppressed,
     return success; 
 }
 
+bool SkScriptEngine::evaluateCompiled(const SkCompiledScript& compiled, SkScriptValue* value) {
+    SkASSERT(compiled.isValid() && compiled.getReturnType() == fReturnType);
+    const char* names = compiled.fNames.begin();
+    const SkCompiledScript::Step* stop = compiled.fSteps.end();
+    for (const SkCompiledScript::Step* step = compiled.fSteps.begin(); step < stop; step++) {
+        switch (step->fType) {
+            case SkCompiledScript::kLiteral_StepType:
+                *fTypeStack.push() = step->fOpType;
+                fOperandStack.push(step->fOperand);
+                break;
+            case SkCompiledScript::kMember_StepType: {
+                fToken = names + step->fName;
+                fTokenLength = step->fNameLength;
+                if (handleProperty(false) == false) {
+                    fError = kCouldNotFindReferencedID;
+                    return false;
+                }
+                const char* field = names + step->fField;
+                const char* end = field + step->fFieldLength;
+                if (evaluateDotParam(end, false, field, step->fFieldLength) == false)
+                    return false;
+                } break;
+            case SkCompiledScript::kOp_StepType:
+            case SkCompiledScript::kFlippedOp_StepType:
+                fOpStack.push(step->fOp);
+                if (step->fType == SkCompiledScript::kFlippedOp_StepType)
+                    *fOpStack.push() = (SkOp) (kFlipOps | kArtificialOp);
+                if (processOp() == false)
+                    return false;
+                break;
+        }
+    }
+    return popResult(value, false);
+}
+
 bool SkScriptEngine::evaluateScript(const char** scriptPtr, SkScriptValue* value) {
 #ifdef SK_DEBUG
     const char** original = scriptPtr;
@@ -667,8 +732,11 @@ scalarCommon:
                 if (suppressed == false)
                     *fTypeStack.push() = kScalar;
             }
-            if (suppressed == false)
+            if (suppressed == false) {
                 fOperandStack.push(operand);
+                if (fCompiling)
+                    fCompiling->addLiteral(fTypeStack.top(), operand);
+            }
             lastPush = true;
             continue;
         }
@@ -690,6 +758,8 @@ scalarCommon:
                 fError = kExpectedOperator;
                 return false;
             }
+            if (fCompiling)
+                notCompilable();
             operand.fString = new SkString();
             track(operand.fString);
             ++script;
@@ -717,6 +787,8 @@ scalarCommon:
         ;
         if (ch ==  '.') {
             if (fTokenLength == 0) {
+                if (fCompiling)
+                    notCompilable();
                 SkScriptValue scriptValue;
                 SkDEBUGCODE(scriptValue.fOperand.fObject = NULL);
                 int tokenLength = token_length(++script);
@@ -748,6 +820,8 @@ scalarCommon:
         }
         if (ch == '[') {
             if (lastPush == false) {
+                if (fCompiling)
+                    notCompilable();
                 script++;
                 *fBraceStack.push() = kArrayBrace;
                 if (suppressed)
@@ -822,38 +896,8 @@ scalarCommon:
         if (processOp() == false)
             return false;
     }   
-    SkOpType topType = fTypeStack.count() > 0 ? fTypeStack.top() : kNoType;
-    if (suppressed == false && topType != fReturnType &&
-            topType == kString && fReturnType != kNoType) { // if result is a string, give handle property a chance to convert it to the property value
-        SkString* string = fOperandStack.top().fString;
-        fToken = string->c_str();
-        fTokenLength = string->size();
-        fOperandStack.pop();
-        fTypeStack.pop();
-        success = handleProperty(SkToBool(fSuppressStack.top().fSuppress));
-        if (success == false) { // if it couldn't convert, return string (error?)
-            SkOperand operand;
-            operand.fS32 = 0;
-            *fTypeStack.push() = kString;
-            operand.fString = string;
-            fOperandStack.push(operand);
-        }
-    }
-    if (value) {
-        if (fOperandStack.count() == 0)
-            return false;
-        SkASSERT(fOperandStack.count() >= 1);
-        SkASSERT(fTypeStack.count() >= 1);
-        fOperandStack.pop(&value->fOperand);
-        SkOpType type;
-        fTypeStack.pop(&type);
-        value->fType = ToDisplayType(type);
-//      SkASSERT(value->fType != SkType_Unknown);
-        if (topType != fReturnType && topType == kObject && fReturnType != kNoType) {
-            if (convertTo(ToDisplayType(fReturnType), value) == false)
-                return false;
-        }
-    }
+    if (popResult(value, suppressed) == false)
+        return false;
     while (fSuppressStack.count() > suppressBalance)
         fSuppressStack.pop();
     *scriptPtr = script;
@@ -872,6 +916,11 @@ void SkScriptEngine::memberFunctionCallBack(_memberFunctionCallBack func, void*
     commonCallBack(kMemberFunction, callBack, userStorage);
 }
 
+void SkScriptEngine::notCompilable() {
+    fCompiling->fValid = false;
+    fCompiling = NULL;
+}
+
 #if 0
 void SkScriptEngine::objectToStringCallBack(_objectToStringCallBack func, void* userStorage) {
     UserCallBack callBack;
@@ -881,6 +930,8 @@ void SkScriptEngine::objectToStringCallBack(_objectToStringCallBack func, void*
 #endif
 
 bool SkScriptEngine::handleArrayIndexer(const char** scriptPtr, bool suppressed) {
+    if (fCompiling)
+        notCompilable();
     SkScriptValue scriptValue;
     (*scriptPtr)++;
     *fOpStack.push() = kParen;
@@ -939,6 +990,8 @@ done:
 }
 
 bool SkScriptEngine::handleFunction(const char** scriptPtr, bool suppressed) {
+    if (fCompiling)
+        notCompilable();
     SkScriptValue callbackResult;
     SkTDArray<SkScriptValue> params;
     SkString functionName(fToken, fTokenLength);
@@ -1032,6 +1085,8 @@ done:
 #endif
 
 bool SkScriptEngine::handleProperty(bool suppressed) {
+    if (fCompiling)
+        notCompilable();   // plain ids may be resolved differently the next time
     SkScriptValue callbackResult;
     bool success = true;
     if (suppressed) 
@@ -1112,6 +1167,8 @@ int SkScriptEngine::logicalOp(char ch, char nextChar) {
 noMatch:
             return 0;
     }
+    if (fCompiling && match != kParen)
+        notCompilable();    // conditionals suppress parts of the script depending on values
     SkSuppress suppress;
     precedence = gPrecedence[match];
     if (fSuppressStack.top().fSuppress) {
@@ -1256,7 +1313,48 @@ SkScriptEngine::Error SkScriptEngine::opError() {
     return kNoError;
 }
 
+bool SkScriptEngine::popResult(SkScriptValue* value, bool suppressed) {
+    SkOpType topType = fTypeStack.count() > 0 ? fTypeStack.top() : kNoType;
+    if (suppressed == false && topType != fReturnType &&
+            topType == kString && fReturnType != kNoType) { // if result is a string, give handle property a chance to convert it to the property value
+        SkString* string = fOperandStack.top().fString;
+        fToken = string->c_str();
+        fTokenLength = string->size();
+        fOperandStack.pop();
+        fTypeStack.pop();
+        bool success = handleProperty(SkToBool(fSuppressStack.top().fSuppress));
+        if (success == false) { // if it couldn't convert, return string (error?)
+            SkOperand operand;
+            operand.fS32 = 0;
+            *fTypeStack.push() = kString;
+            operand.fString = string;
+            fOperandStack.push(operand);
+        }
+    }
+    if (value) {
+        if (fOperandStack.count() == 0)
+            return false;
+        SkASSERT(fOperandStack.count() >= 1);
+        SkASSERT(fTypeStack.count() >= 1);
+        fOperandStack.pop(&value->fOperand);
+        SkOpType type;
+        fTypeStack.pop(&type);
+        value->fType = ToDisplayType(type);
+//      SkASSERT(value->fType != SkType_Unknown);
+        if (topType != fReturnType && topType == kObject && fReturnType != kNoType) {
+            if (convertTo(ToDisplayType(fReturnType), value) == false)
+                return false;
+        }
+    }
+    return true;
+}
+
 bool SkScriptEngine::processOp() {
+    if (fCompiling) {
+        SkOp op = fOpStack.top();
+        bool flipped = (SkOp) (op & ~kArtificialOp) == kFlipOps;
+        fCompiling->addOp(flipped ? fOpStack.index(1) : op, flipped);
+    }
     SkOp op;
     fOpStack.pop(&op);
     op = (SkOp) (op & ~kArtificialOp);
@@ -1648,6 +1746,65 @@ bool SkScriptEngine::ValueToString(SkScriptValue value, SkString* string) {
     return true; // no error
 }
 
+void SkCompiledScript::addLiteral(SkScriptEngine::SkOpType type, const SkOperand& operand) {
+    Step* step = fSteps.append();
+    step->fType = kLiteral_StepType;
+    step->fOpType = type;
+    step->fOperand = operand;
+}
+
+void SkCompiledScript::addMember(const char name[], size_t nameLength, const char field[],
+        size_t fieldLength) {
+    Step* step = fSteps.append();
+    step->fType = kMember_StepType;
+    step->fName = addName(name, nameLength);
+    step->fNameLength = (int) nameLength;
+    step->fField = addName(field, fieldLength);
+    step->fFieldLength = (int) fieldLength;
+}
+
+void SkCompiledScript::addOp(SkScriptEngine::SkOp op, bool flipped) {
+    Step* step = fSteps.append();
+    step->fType = flipped ? kFlippedOp_StepType : kOp_StepType;
+    step->fOp = op;
+}
+
+void SkCompiledScript::flatten(SkWriter32& writer) const {
+    writer.write32(fReturnType);
+    writer.write32(fValid);
+    writer.write32(fSteps.count());
+    writer.write(fSteps.begin(), fSteps.count() * sizeof(Step));
+    writer.writeString(fNames.begin(), fNames.count());
+}
+
+bool SkCompiledScript::unflatten(SkReader32& reader) {
+    if (reader.available() < 3 * sizeof(uint32_t))
+        return false;
+    fReturnType = (SkScriptEngine::SkOpType) reader.readS32();
+    fValid = reader.readBool();
+    uint32_t count = reader.readU32();
+    if (count > reader.available() / sizeof(Step))
+        return false;
+    fSteps.setCount(count);
+    memcpy(fSteps.begin(), reader.skip(count * sizeof(Step)), count * sizeof(Step));
+    if (reader.available() < sizeof(uint32_t) ||
+            *(const uint32_t*) reader.peek() >= reader.available() - sizeof(uint32_t))
+        return false;
+    size_t length;
+    const char* names = reader.readString(&length);
+    fNames.setCount(length);
+    memcpy(fNames.begin(), names, length);
+    return true;
+}
+
+int SkCompiledScript::addName(const char name[], size_t length) {
+    int offset = fNames.count();
+    char* dst = fNames.append((int) length + 1);
+    memcpy(dst, name, length);
+    dst[length] = '\0';
+    return offset;
+}
+
 #ifdef SK_SUPPORT_UNITTEST
 
 #ifdef SK_CAN_USE_FLOAT
@@ -1908,6 +2065,19 @@ void SkScriptEngine::UnitTest() {
             default:
                 SkASSERT(0);
         }
+        // numeric scripts are recorded, and replaying them gives the same answer
+        SkScriptEngine compileEngine(SkScriptEngine::ToOpType(scriptTests[index].fType));
+        SkCompiledScript compiled;
+        script = scriptTests[index].fScript;
+        SkScriptValue compiledValue;
+        SkASSERT(compileEngine.compileScript(&script, &compiledValue, &compiled) == true);
+        if (compiled.isValid() == false)
+            continue;
+        SkScriptEngine replayEngine(SkScriptEngine::ToOpType(scriptTests[index].fType));
+        SkASSERT(replayEngine.evaluateCompiled(compiled, &compiledValue) == true);
+        SkASSERT(compiledValue.fType == value.fType);
+        SkASSERT(value.fType == SkType_Int ? compiledValue.fOperand.fS32 == value.fOperand.fS32 :
+            compiledValue.fOperand.fScalar == value.fOperand.fScalar);
     }
 }
 #endif
@@ -24,6 +24,9 @@
 #include "SkTDStack.h"
 
 class SkAnimateMaker;
+class SkCompiledScript;
+class SkReader32;
+class SkWriter32;
 
 class SkScriptEngine {
 public:
@@ -81,7 +84,16 @@ public:
     SkScriptEngine(SkOpType returnType);
     ~SkScriptEngine();
     void boxCallBack(_boxCallBack func, void* userStorage);
+    /** Evaluates the script like evaluateScript(), and if it only combines numbers and
+        object.member values with operators and parentheses, also records in compiled
+        what evaluateCompiled() needs to evaluate it again without parsing it.
+    */
+    bool compileScript(const char** script, SkScriptValue* value, SkCompiledScript* compiled);
     bool convertTo(SkDisplayTypes , SkScriptValue* );
+    /** Evaluates a script recorded by compileScript(), using this engine's callbacks. The
+        compiled script must be valid, and have been recorded with the same return type.
+    */
+    bool evaluateCompiled(const SkCompiledScript& compiled, SkScriptValue* value);
     bool evaluateScript(const char** script, SkScriptValue* value);
     void forget(SkTypedArray* array);
     void functionCallBack(_functionCallBack func, void* userStorage);
@@ -219,7 +231,9 @@ protected:
     bool handleUnbox(SkScriptValue* scriptValue);
     bool innerScript(const char** scriptPtr, SkScriptValue* value);
     int logicalOp(char ch, char nextChar);
+    void notCompilable();
     Error opError();
+    bool popResult(SkScriptValue* value, bool suppressed);
     bool processOp();
     void setAnimateMaker(SkAnimateMaker* maker) { fMaker = maker; }
     bool setError(Error , const char* pos);
@@ -251,6 +265,7 @@ protected:
     SkOpType fReturnType;
     Error fError;
     int fErrorPosition;
+    SkCompiledScript* fCompiling;   // non-NULL while compileScript() records
 private:
     friend class SkTypedArray;
 #ifdef SK_SUPPORT_UNITTEST
@@ -259,6 +274,46 @@ public:
 #endif
 };
 
+/** The steps the engine took to evaluate a script: the numbers and object.member values
+    it pushed, and the operators it applied to them, in order. Replaying these skips
+    tokenizing the script and sorting out operator precedence, while values and
+    conversions still come from the engine's callbacks and operators.
+*/
+class SkCompiledScript {
+public:
+    SkCompiledScript() : fReturnType(SkScriptEngine::kNoType), fValid(false) {}
+    void flatten(SkWriter32& ) const;
+    SkScriptEngine::SkOpType getReturnType() const { return fReturnType; }
+    bool isValid() const { return fValid; }
+    /** Reads what flatten() wrote with the same build; returns false if it runs out of data. */
+    bool unflatten(SkReader32& );
+private:
+    enum StepType {
+        kLiteral_StepType,
+        kMember_StepType,   // object.member: fName is the object, fField the member
+        kOp_StepType,
+        kFlippedOp_StepType // the operator is followed by kFlipOps
+    };
+    struct Step {
+        StepType fType;
+        SkScriptEngine::SkOpType fOpType;
+        SkScriptEngine::SkOp fOp;
+        SkOperand fOperand;
+        int fName, fNameLength;     // offsets into fNames
+        int fField, fFieldLength;
+    };
+    void addLiteral(SkScriptEngine::SkOpType type, const SkOperand& operand);
+    void addMember(const char name[], size_t nameLength, const char field[], size_t fieldLength);
+    void addOp(SkScriptEngine::SkOp op, bool flipped);
+    int addName(const char name[], size_t length);
+
+    SkTDArray<Step> fSteps;
+    SkTDArray<char> fNames;     // each name is followed by a zero
+    SkScriptEngine::SkOpType fReturnType;
+    SkBool8 fValid;
+    friend class SkScriptEngine;
+};
+
 #ifdef SK_SUPPORT_UNITTEST
 
 struct SkScriptNAnswer {
@@ -15,6 +15,7 @@
  */
 
 #include "SkBitmap.h"
+#include "SkBitmapMipMap.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
 #include "SkFlattenable.h"
@@ -33,54 +34,6 @@ static bool isPos32Bits(const Sk64& value) {
     return !value.isNeg() && value.is32();
 }
 
-struct MipLevel {
-    void*       fPixels;
-    uint32_t    fRowBytes;
-    uint32_t    fWidth, fHeight;
-};
-
-struct SkBitmap::MipMap : SkNoncopyable {
-    int32_t fRefCnt;
-    int     fLevelCount;
-//  MipLevel    fLevel[fLevelCount];
-//  Pixels[]
-
-    static MipMap* Alloc(int levelCount, size_t pixelSize) {
-        if (levelCount < 0) {
-            return NULL;
-        }
-        Sk64 size;
-        size.setMul(levelCount + 1, sizeof(MipLevel));
-        size.add(sizeof(MipMap));
-        size.add(pixelSize);
-        if (!isPos32Bits(size)) {
-            return NULL;
-        }
-        MipMap* mm = (MipMap*)sk_malloc_throw(size.get32());
-        mm->fRefCnt = 1;
-        mm->fLevelCount = levelCount;
-        return mm;
-    }
-
-    const MipLevel* levels() const { return (const MipLevel*)(this + 1); }
-    MipLevel* levels() { return (MipLevel*)(this + 1); }
-
-    const void* pixels() const { return levels() + fLevelCount; }
-    void* pixels() { return levels() + fLevelCount; }
-
-    void ref() {
-        if (SK_MaxS32 == sk_atomic_inc(&fRefCnt)) {
-            sk_throw();
-        }
-    }
-    void unref() {
-        SkASSERT(fRefCnt > 0);
-        if (sk_atomic_dec(&fRefCnt) == 1) {
-            sk_free(this);
-        }
-    }
-};
-
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -268,7 +221,8 @@ void SkBitmap::setConfig(Config c, int width, int height, int rowBytes) {
 
     if (rowBytes == 0) {
         rowBytes = SkBitmap::ComputeRowBytes(c, width);
-        if (0 == rowBytes && kNo_Config != c) {
+        // RLE rows are packed, so those have no rowBytes either
+        if (0 == rowBytes && kNo_Config != c && kRLE_Index8_Config != c) {
             goto err;
         }
     }
@@ -728,20 +682,14 @@ void SkBitmap::eraseARGB(U8CPU a, U8CPU r, U8CPU g, U8CPU b) const {
                 v = SkPackRGB16(r >> (8 - SK_R16_BITS), g >> (8 - SK_G16_BITS),
                                 b >> (8 - SK_B16_BITS));
             }
-            while (--height >= 0) {
-                sk_memset16(p, v, width);
-                p = (uint16_t*)((char*)p + rowBytes);
-            }
+            sk_memset_rect16(p, v, width, height, rowBytes);
             break;
         }
         case kARGB_8888_Config: {
             uint32_t* p = (uint32_t*)fPixels;
             uint32_t  v = SkPackARGB32(a, r, g, b);
 
-            while (--height >= 0) {
-                sk_memset32(p, v, width);
-                p = (uint32_t*)((char*)p + rowBytes);
-            }
+            sk_memset_rect32(p, v, width, height, rowBytes);
             break;
         }
     }
@@ -846,6 +794,7 @@ bool SkBitmap::extractSubset(SkBitmap* result, const SkIRect& subset) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkBlitRow.h"
 #include "SkCanvas.h"
 #include "SkPaint.h"
 
@@ -879,6 +828,82 @@ bool SkBitmap::canCopyTo(Config dstConfig) const {
     return true;
 }
 
+/*  Converts the pixels of src into dst, which has the same size, a row at a
+    time, without the device and blitter that drawing src into dst would
+    set up. The results are the same as drawing's: 8888 sources are blitted
+    into 565 and 4444 with the same (dithering) SkBlitRow procs, and the
+    conversions to 8888 are what the sprite blitters and bitmap shaders
+    write over a cleared dst. Returns false for the pairs it leaves to
+    drawing.
+ */
+static bool convert_pixels(const SkBitmap& dst, const SkBitmap& src) {
+    const int width = src.width();
+    const int height = src.height();
+    const SkBitmap::Config dstConfig = dst.config();
+    const SkBitmap::Config srcConfig = src.config();
+
+    if (SkBitmap::kARGB_8888_Config == srcConfig &&
+            (SkBitmap::kRGB_565_Config == dstConfig ||
+             SkBitmap::kARGB_4444_Config == dstConfig)) {
+        unsigned flags = SkBlitRow::kDither_Flag;
+        if (!src.isOpaque()) {
+            flags |= SkBlitRow::kSrcPixelAlpha_Flag;
+        }
+        SkBlitRow::Proc proc = SkBlitRow::Factory(flags, dstConfig);
+        if (NULL == proc) {
+            return false;
+        }
+        for (int y = 0; y < height; y++) {
+            uint16_t* dstRow = (uint16_t*)dst.getAddr(0, y);
+            if (!src.isOpaque()) {
+                memset(dstRow, 0, width << 1);
+            }
+            proc(dstRow, src.getAddr32(0, y), width, 0xFF, 0, y);
+        }
+        return true;
+    }
+
+    if (SkBitmap::kARGB_8888_Config != dstConfig) {
+        return false;
+    }
+    switch (srcConfig) {
+        case SkBitmap::kRGB_565_Config:
+            for (int y = 0; y < height; y++) {
+                sk_pixel16_to_pixel32(dst.getAddr32(0, y), src.getAddr16(0, y),
+                                      width);
+            }
+            return true;
+        case SkBitmap::kARGB_4444_Config:
+            for (int y = 0; y < height; y++) {
+                SkPMColor* dstRow = dst.getAddr32(0, y);
+                const SkPMColor16* srcRow = (const SkPMColor16*)
+                                                        src.getAddr16(0, y);
+                for (int x = 0; x < width; x++) {
+                    dstRow[x] = SkPixel4444ToPixel32(srcRow[x]);
+                }
+            }
+            return true;
+        case SkBitmap::kIndex8_Config: {
+            SkColorTable* ctable = src.getColorTable();
+            if (NULL == ctable) {
+                return false;
+            }
+            const SkPMColor* colors = ctable->lockColors();
+            for (int y = 0; y < height; y++) {
+                SkPMColor* dstRow = dst.getAddr32(0, y);
+                const uint8_t* srcRow = src.getAddr8(0, y);
+                for (int x = 0; x < width; x++) {
+                    dstRow[x] = colors[srcRow[x]];
+                }
+            }
+            ctable->unlockColors(false);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 bool SkBitmap::copyTo(SkBitmap* dst, Config dstConfig, Allocator* alloc) const {
     if (!this->canCopyTo(dstConfig)) {
         return false;
@@ -941,7 +966,7 @@ bool SkBitmap::copyTo(SkBitmap* dst, Config dstConfig, Allocator* alloc) const {
                 dstP += tmpDst.rowBytes();
             }
         }
-    } else {
+    } else if (!convert_pixels(tmpDst, *src)) {
         // if the src has alpha, we have to clear the dst first
         if (!src->isOpaque()) {
             tmpDst.eraseColor(0);
@@ -1091,6 +1116,23 @@ void SkBitmap::buildMipMap(bool forceRebuild) {
             return; // don't build mipmaps for these configs
     }
 
+    // another bitmap may already have built them for the same pixels
+    SkPixelRef* pr = fPixelRef;
+    uint32_t genID = 0;
+    if (pr) {
+        genID = pr->getGenerationID();
+        SkAutoMutexAcquire ac(*pr->mutex());
+        if (!forceRebuild && pr->fMipMap &&
+                pr->fMipMapGenerationID == genID &&
+                pr->fMipMapOffset == fPixelRefOffset &&
+                pr->fMipMapWidth == this->width() &&
+                pr->fMipMapHeight == this->height()) {
+            pr->fMipMap->ref();
+            fMipMap = pr->fMipMap;
+            return;
+        }
+    }
+
     SkAutoLockPixels alp(*this);
     if (!this->readyToDraw()) {
         return;
@@ -1160,6 +1202,19 @@ void SkBitmap::buildMipMap(bool forceRebuild) {
     }
     SkASSERT(addr == (uint8_t*)mm->pixels() + size);
     fMipMap = mm;
+
+    if (pr) {
+        SkAutoMutexAcquire ac(*pr->mutex());
+        if (pr->fMipMap) {
+            pr->fMipMap->unref();
+        }
+        mm->ref();
+        pr->fMipMap = mm;
+        pr->fMipMapGenerationID = genID;
+        pr->fMipMapOffset = fPixelRefOffset;
+        pr->fMipMapWidth = this->width();
+        pr->fMipMapHeight = this->height();
+    }
 }
 
 bool SkBitmap::hasMipMap() const {
@@ -1177,8 +1232,8 @@ int SkBitmap::extractMipLevel(SkBitmap* dst, SkFixed sx, SkFixed sy) {
         return 0;
     }
 
-    if (level >= fMipMap->fLevelCount) {
-        level = fMipMap->fLevelCount - 1;
+    if (level > fMipMap->fLevelCount) {
+        level = fMipMap->fLevelCount;
     }
     if (dst) {
         const MipLevel& mip = fMipMap->levels()[level - 1];
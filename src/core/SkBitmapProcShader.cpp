@@ -18,6 +18,8 @@
 #include "SkBitmapProcShader.h"
 #include "SkColorPriv.h"
 #include "SkPixelRef.h"
+#include "SkScaledBitmapCache.h"
+#include "SkUtils.h"
 
 bool SkBitmapProcShader::CanDo(const SkBitmap& bm, TileMode tx, TileMode ty) {
     switch (bm.config()) {
@@ -91,6 +93,115 @@ static bool only_scale_and_translate(const SkMatrix& matrix) {
     return (matrix.getType() & ~mask) == 0;
 }
 
+static void shade_span(const SkBitmapProcState&, int x, int y,
+                       SkPMColor dstC[], int count);
+
+/*  Each filtered draw that shrinks a bitmap resamples all of it again, though
+    drawing it through the same scale, at the same position within a pixel,
+    gives the same pixels every time. So we draw it once into a bitmap of its
+    own (just as it would have been drawn into the device), keep that in
+    SkScaledBitmapCache, and then only copy pixels out of it.
+
+    The bitmap covers where the src lands in the device, and then a margin in
+    which clamping has already made every pixel the same as the ones beyond
+    it, so clamping it again gives the rest of the device.
+
+    Only the 32bit span is drawn from it: for a 565 device the src would have
+    been sampled (and dithered) some other way.
+ */
+#define SCALED_BITMAP_MARGIN    2
+
+bool SkBitmapProcShader::chooseScaledBitmap(const SkBitmap& device,
+                                            const SkPaint& paint) {
+    const SkMatrix& inv = this->getTotalInverse();
+    const SkBitmap& src = fState.fOrigBitmap;
+    const SkPixelRef* pr = src.pixelRef();
+
+    // the paint's alpha (and an A8 src's color) would have to be in the key
+    if (!fState.fDoFilter || SkBitmap::kARGB_8888_Config != device.config() ||
+            255 != paint.getAlpha() || SkBitmap::kA8_Config == src.config() ||
+            SkShader::kClamp_TileMode != fState.fTileModeX ||
+            SkShader::kClamp_TileMode != fState.fTileModeY ||
+            !only_scale_and_translate(inv) ||
+            NULL == pr || !pr->isImmutable() || src.getTexture()) {
+        return false;
+    }
+
+    // only downsizes, which never need more memory than the src; the upper
+    // limit keeps the key's translate in range
+    const SkScalar sx = inv.getScaleX();
+    const SkScalar sy = inv.getScaleY();
+    const SkScalar maxScale = SkIntToScalar(256);
+    if (SkScalarAbs(sx) < SK_Scalar1 || SkScalarAbs(sy) < SK_Scalar1 ||
+            SkScalarAbs(sx) > maxScale || SkScalarAbs(sy) > maxScale) {
+        return false;
+    }
+
+    SkMatrix matrix;
+    if (!inv.invert(&matrix)) {
+        return false;
+    }
+    SkRect r;
+    r.set(0, 0, SkIntToScalar(src.width()), SkIntToScalar(src.height()));
+    matrix.mapRect(&r);
+
+    SkIRect bounds;
+    r.roundOut(&bounds);
+    bounds.inset(-SCALED_BITMAP_MARGIN, -SCALED_BITMAP_MARGIN);
+    if (bounds.isEmpty() || (size_t)bounds.width() * bounds.height() *
+            sizeof(SkPMColor) > SkScaledBitmapCache::GetByteLimit() / 4) {
+        return false;
+    }
+
+    SkScaledBitmapCache::Key key;
+    key.fGenerationID = pr->getGenerationID();
+    key.fPixelRefOffset = (uint32_t)src.pixelRefOffset();
+    key.fWidth = src.width();
+    key.fHeight = src.height();
+    key.fConfig = src.config();
+    key.fInvScaleX = sx;
+    key.fInvScaleY = sy;
+    key.fInvTransX = SkScalarToFixed(inv.getTranslateX() +
+                                     SkScalarMul(SkIntToScalar(bounds.fLeft), sx));
+    key.fInvTransY = SkScalarToFixed(inv.getTranslateY() +
+                                     SkScalarMul(SkIntToScalar(bounds.fTop), sy));
+
+    SkBitmap scaled;
+    if (!SkScaledBitmapCache::Find(key, &scaled)) {
+        // draw it from the key alone, so that equal keys get equal pixels
+        SkMatrix localInv;
+        localInv.setScale(sx, sy);
+        localInv.postTranslate(SkFixedToScalar(key.fInvTransX),
+                               SkFixedToScalar(key.fInvTransY));
+
+        SkBitmapProcState state;
+        state.fOrigBitmap = src;
+        state.fOrigBitmap.lockPixels();
+        state.fTileModeX = fState.fTileModeX;
+        state.fTileModeY = fState.fTileModeY;
+        if (!state.chooseProcs(localInv, paint)) {
+            return false;
+        }
+
+        scaled.setConfig(SkBitmap::kARGB_8888_Config, bounds.width(),
+                         bounds.height());
+        if (!scaled.allocPixels()) {
+            return false;
+        }
+        for (int y = 0; y < bounds.height(); y++) {
+            shade_span(state, 0, y, scaled.getAddr32(0, y), bounds.width());
+        }
+        scaled.setIsOpaque(src.isOpaque());
+        scaled.pixelRef()->setImmutable();
+        SkScaledBitmapCache::Add(key, scaled);
+    }
+
+    fScaledBitmap = scaled;
+    fScaledBitmap.lockPixels();
+    fScaledOrigin.set(bounds.fLeft, bounds.fTop);
+    return true;
+}
+
 bool SkBitmapProcShader::setContext(const SkBitmap& device,
                                     const SkPaint& paint,
                                     const SkMatrix& matrix) {
@@ -99,6 +210,8 @@ bool SkBitmapProcShader::setContext(const SkBitmap& device,
         return false;
     }
 
+    fScaledBitmap.reset();
+
     fState.fOrigBitmap = fRawBitmap;
     fState.fOrigBitmap.lockPixels();
     if (!fState.fOrigBitmap.getTexture() && !fState.fOrigBitmap.readyToDraw()) {
@@ -109,6 +222,7 @@ bool SkBitmapProcShader::setContext(const SkBitmap& device,
     if (!fState.chooseProcs(this->getTotalInverse(), paint)) {
         return false;
     }
+    this->chooseScaledBitmap(device, paint);
 
     const SkBitmap& bitmap = *fState.fBitmap;
     bool bitmapIsOpaque = bitmap.isOpaque();
@@ -124,6 +238,7 @@ bool SkBitmapProcShader::setContext(const SkBitmap& device,
             flags |= (kHasSpan16_Flag | kIntrinsicly16_Flag);
             break;
         case SkBitmap::kIndex8_Config:
+        case SkBitmap::kRLE_Index8_Config:
         case SkBitmap::kARGB_8888_Config:
             if (bitmapIsOpaque) {
                 flags |= kHasSpan16_Flag;
@@ -165,8 +280,8 @@ bool SkBitmapProcShader::setContext(const SkBitmap& device,
     #define TEST_BUFFER_EXTRA   0
 #endif
 
-void SkBitmapProcShader::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
-    const SkBitmapProcState& state = fState;
+static void shade_span(const SkBitmapProcState& state, int x, int y,
+                       SkPMColor dstC[], int count) {
     if (state.fShaderProc32) {
         state.fShaderProc32(state, x, y, dstC, count);
         return;
@@ -175,7 +290,7 @@ void SkBitmapProcShader::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
     uint32_t buffer[BUF_MAX + TEST_BUFFER_EXTRA];
     SkBitmapProcState::MatrixProc   mproc = state.fMatrixProc;
     SkBitmapProcState::SampleProc32 sproc = state.fSampleProc32;
-    int max = fState.maxCountForBufferSize(sizeof(buffer[0]) * BUF_MAX);
+    int max = state.maxCountForBufferSize(sizeof(buffer[0]) * BUF_MAX);
 
     SkASSERT(state.fBitmap->getPixels());
     SkASSERT(state.fBitmap->pixelRef() == NULL ||
@@ -215,6 +330,37 @@ void SkBitmapProcShader::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
     }
 }
 
+// copies a span of bm, clamping x and y to its edges
+static void copy_clamped(const SkBitmap& bm, int x, int y, SkPMColor dstC[],
+                         int count) {
+    const SkPMColor* row = bm.getAddr32(0, SkClampMax(y, bm.height() - 1));
+    if (x < 0) {
+        int n = SkMin32(-x, count);
+        sk_memset32(dstC, row[0], n);
+        dstC += n;
+        count -= n;
+        x = 0;
+    }
+    int n = SkMin32(bm.width() - x, count);
+    if (n > 0) {
+        memcpy(dstC, row + x, n * sizeof(SkPMColor));
+        dstC += n;
+        count -= n;
+    }
+    if (count > 0) {
+        sk_memset32(dstC, row[bm.width() - 1], count);
+    }
+}
+
+void SkBitmapProcShader::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
+    if (fScaledBitmap.getPixels()) {
+        copy_clamped(fScaledBitmap, x - fScaledOrigin.fX, y - fScaledOrigin.fY,
+                     dstC, count);
+        return;
+    }
+    shade_span(fState, x, y, dstC, count);
+}
+
 void SkBitmapProcShader::shadeSpan16(int x, int y, uint16_t dstC[], int count) {
     const SkBitmapProcState& state = fState;
     if (state.fShaderProc16) {
@@ -54,6 +54,13 @@ protected:
     uint32_t          fFlags;
 
 private:
+    // if fScaledBitmap has pixels, shadeSpan() copies them from it instead
+    // of sampling through fState (see SkScaledBitmapCache)
+    SkBitmap          fScaledBitmap;
+    SkIPoint          fScaledOrigin;    // of fScaledBitmap, in the device
+
+    bool chooseScaledBitmap(const SkBitmap& device, const SkPaint&);
+
     typedef SkShader INHERITED;
 };
 
@@ -2,8 +2,11 @@
 #include "SkBitmapProcState_filter.h"
 #include "SkColorPriv.h"
 #include "SkFilterProc.h"
+#include "SkPackBits.h"
 #include "SkPaint.h"
+#include "SkPixelRef.h"
 #include "SkShader.h"   // for tilemodes
+#include "SkUtils.h"
 
 // returns expanded * 5bits
 static inline uint32_t Filter_565_Expanded(unsigned x, unsigned y,
@@ -281,6 +284,22 @@ static inline U8CPU Filter_8(unsigned x, unsigned y,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// The fused shaderprocs below go straight from the device coordinates to the
+// colors, for a source that is only scaled (or translated) and then clamped
+// or repeated. They generate a _filter_DX and a _nofilter_DX version each.
+
+#define CLAMP_TILEX_PROCF(fx, max)      SkClampMax((fx) >> 16, max)
+#define CLAMP_TILEY_PROCF(fy, max)      SkClampMax((fy) >> 16, max)
+#define CLAMP_TILEX_LOW_BITS(fx, max)   (((fx) >> 12) & 0xF)
+#define CLAMP_TILEY_LOW_BITS(fy, max)   (((fy) >> 12) & 0xF)
+
+#define REPEAT_TILEX_PROCF(fx, max)     (((fx) & 0xFFFF) * ((max) + 1) >> 16)
+#define REPEAT_TILEY_PROCF(fy, max)     (((fy) & 0xFFFF) * ((max) + 1) >> 16)
+#define REPEAT_TILEX_LOW_BITS(fx, max)  ((((fx) & 0xFFFF) * ((max) + 1) >> 12) & 0xF)
+#define REPEAT_TILEY_LOW_BITS(fy, max)  ((((fy) & 0xFFFF) * ((max) + 1) >> 12) & 0xF)
+
+// SRC == 565, DST == 565
+
 #undef FILTER_PROC
 #define FILTER_PROC(x, y, a, b, c, d, dst) \
     do {                                                        \
@@ -288,51 +307,299 @@ static inline U8CPU Filter_8(unsigned x, unsigned y,
         *(dst) = SkCompact_rgb_16((tmp) >> 5);                  \
     } while (0)
 
-
-// clamp
-
-#define TILEX_PROCF(fx, max)    SkClampMax((fx) >> 16, max)
-#define TILEY_PROCF(fy, max)    SkClampMax((fy) >> 16, max)
-#define TILEX_LOW_BITS(fx, max) (((fx) >> 12) & 0xF)
-#define TILEY_LOW_BITS(fy, max) (((fy) >> 12) & 0xF)
-
+#define TILEX_PROCF(fx, max)    CLAMP_TILEX_PROCF(fx, max)
+#define TILEY_PROCF(fy, max)    CLAMP_TILEY_PROCF(fy, max)
+#define TILEX_LOW_BITS(fx, max) CLAMP_TILEX_LOW_BITS(fx, max)
+#define TILEY_LOW_BITS(fy, max) CLAMP_TILEY_LOW_BITS(fy, max)
 #define MAKENAME(suffix)        Clamp_S16_D16 ## suffix
 #define SRCTYPE                 uint16_t
 #define DSTTYPE                 uint16_t
 #define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kRGB_565_Config)
+#define RETURNDST(src)          src
 #define SRC_TO_FILTER(src)      src
 #include "SkBitmapProcState_shaderproc.h"
 
-
-#define TILEX_PROCF(fx, max)    (((fx) & 0xFFFF) * ((max) + 1) >> 16)
-#define TILEY_PROCF(fy, max)    (((fy) & 0xFFFF) * ((max) + 1) >> 16)
-#define TILEX_LOW_BITS(fx, max) ((((fx) & 0xFFFF) * ((max) + 1) >> 12) & 0xF)
-#define TILEY_LOW_BITS(fy, max) ((((fy) & 0xFFFF) * ((max) + 1) >> 12) & 0xF)
-
+#define TILEX_PROCF(fx, max)    REPEAT_TILEX_PROCF(fx, max)
+#define TILEY_PROCF(fy, max)    REPEAT_TILEY_PROCF(fy, max)
+#define TILEX_LOW_BITS(fx, max) REPEAT_TILEX_LOW_BITS(fx, max)
+#define TILEY_LOW_BITS(fy, max) REPEAT_TILEY_LOW_BITS(fy, max)
 #define MAKENAME(suffix)        Repeat_S16_D16 ## suffix
 #define SRCTYPE                 uint16_t
 #define DSTTYPE                 uint16_t
 #define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kRGB_565_Config)
+#define RETURNDST(src)          src
 #define SRC_TO_FILTER(src)      src
 #include "SkBitmapProcState_shaderproc.h"
 
+// SRC == 565, DST == 8888
+
+#undef FILTER_PROC
+#define FILTER_PROC(x, y, a, b, c, d, dst) \
+    do {                                                        \
+        uint32_t tmp = Filter_565_Expanded(x, y, a, b, c, d);   \
+        *(dst) = SkExpanded_565_To_PMColor(tmp);                \
+    } while (0)
 
-#define TILEX_PROCF(fx, max)    SkClampMax((fx) >> 16, max)
-#define TILEY_PROCF(fy, max)    SkClampMax((fy) >> 16, max)
-#define TILEX_LOW_BITS(fx, max) (((fx) >> 12) & 0xF)
-#define TILEY_LOW_BITS(fy, max) (((fy) >> 12) & 0xF)
+#define TILEX_PROCF(fx, max)    CLAMP_TILEX_PROCF(fx, max)
+#define TILEY_PROCF(fy, max)    CLAMP_TILEY_PROCF(fy, max)
+#define TILEX_LOW_BITS(fx, max) CLAMP_TILEX_LOW_BITS(fx, max)
+#define TILEY_LOW_BITS(fy, max) CLAMP_TILEY_LOW_BITS(fy, max)
+#define MAKENAME(suffix)        Clamp_S16_opaque_D32 ## suffix
+#define SRCTYPE                 uint16_t
+#define DSTTYPE                 uint32_t
+#define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kRGB_565_Config); \
+                                SkASSERT(state.fAlphaScale == 256)
+#define RETURNDST(src)          SkPixel16ToPixel32(src)
+#define SRC_TO_FILTER(src)      src
+#include "SkBitmapProcState_shaderproc.h"
+
+#define TILEX_PROCF(fx, max)    REPEAT_TILEX_PROCF(fx, max)
+#define TILEY_PROCF(fy, max)    REPEAT_TILEY_PROCF(fy, max)
+#define TILEX_LOW_BITS(fx, max) REPEAT_TILEX_LOW_BITS(fx, max)
+#define TILEY_LOW_BITS(fy, max) REPEAT_TILEY_LOW_BITS(fy, max)
+#define MAKENAME(suffix)        Repeat_S16_opaque_D32 ## suffix
+#define SRCTYPE                 uint16_t
+#define DSTTYPE                 uint32_t
+#define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kRGB_565_Config); \
+                                SkASSERT(state.fAlphaScale == 256)
+#define RETURNDST(src)          SkPixel16ToPixel32(src)
+#define SRC_TO_FILTER(src)      src
+#include "SkBitmapProcState_shaderproc.h"
+
+// SRC == Index8, DST == 8888
 
 #undef FILTER_PROC
 #define FILTER_PROC(x, y, a, b, c, d, dst)   Filter_32_opaque(x, y, a, b, c, d, dst)
+
+#define TILEX_PROCF(fx, max)    CLAMP_TILEX_PROCF(fx, max)
+#define TILEY_PROCF(fy, max)    CLAMP_TILEY_PROCF(fy, max)
+#define TILEX_LOW_BITS(fx, max) CLAMP_TILEX_LOW_BITS(fx, max)
+#define TILEY_LOW_BITS(fy, max) CLAMP_TILEY_LOW_BITS(fy, max)
 #define MAKENAME(suffix)        Clamp_SI8_opaque_D32 ## suffix
 #define SRCTYPE                 uint8_t
 #define DSTTYPE                 uint32_t
-#define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kIndex8_Config)
+#define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kIndex8_Config); \
+                                SkASSERT(state.fAlphaScale == 256)
 #define PREAMBLE(state)         const SkPMColor* SK_RESTRICT table = state.fBitmap->getColorTable()->lockColors()
+#define RETURNDST(src)          table[src]
 #define SRC_TO_FILTER(src)      table[src]
 #define POSTAMBLE(state)        state.fBitmap->getColorTable()->unlockColors(false)
 #include "SkBitmapProcState_shaderproc.h"
 
+#define TILEX_PROCF(fx, max)    REPEAT_TILEX_PROCF(fx, max)
+#define TILEY_PROCF(fy, max)    REPEAT_TILEY_PROCF(fy, max)
+#define TILEX_LOW_BITS(fx, max) REPEAT_TILEX_LOW_BITS(fx, max)
+#define TILEY_LOW_BITS(fy, max) REPEAT_TILEY_LOW_BITS(fy, max)
+#define MAKENAME(suffix)        Repeat_SI8_opaque_D32 ## suffix
+#define SRCTYPE                 uint8_t
+#define DSTTYPE                 uint32_t
+#define CHECKSTATE(state)       SkASSERT(state.fBitmap->config() == SkBitmap::kIndex8_Config); \
+                                SkASSERT(state.fAlphaScale == 256)
+#define PREAMBLE(state)         const SkPMColor* SK_RESTRICT table = state.fBitmap->getColorTable()->lockColors()
+#define RETURNDST(src)          table[src]
+#define SRC_TO_FILTER(src)      table[src]
+#define POSTAMBLE(state)        state.fBitmap->getColorTable()->unlockColors(false)
+#include "SkBitmapProcState_shaderproc.h"
+
+/*  Each sampleproc that has fused versions, with its clamp and repeat ones.
+    The nofilter versions are only used when the matrix is not trivial, or
+    when clamping: a trivial matrix is applied in source pixels rather than
+    in the unit square that the repeat versions expect.
+ */
+static const struct {
+    SkBitmapProcState::SampleProc32 fSampleProc;
+    SkBitmapProcState::ShaderProc32 fClampProc;
+    SkBitmapProcState::ShaderProc32 fRepeatProc;
+} gShaderProcs32[] = {
+    { S16_opaque_D32_filter_DX,
+        Clamp_S16_opaque_D32_filter_DX_shaderproc,
+        Repeat_S16_opaque_D32_filter_DX_shaderproc },
+    { S16_opaque_D32_nofilter_DX,
+        Clamp_S16_opaque_D32_nofilter_DX_shaderproc,
+        Repeat_S16_opaque_D32_nofilter_DX_shaderproc },
+    { SI8_opaque_D32_filter_DX,
+        Clamp_SI8_opaque_D32_filter_DX_shaderproc,
+        Repeat_SI8_opaque_D32_filter_DX_shaderproc },
+    { SI8_opaque_D32_nofilter_DX,
+        Clamp_SI8_opaque_D32_nofilter_DX_shaderproc,
+        Repeat_SI8_opaque_D32_nofilter_DX_shaderproc },
+};
+
+static const struct {
+    SkBitmapProcState::SampleProc16 fSampleProc;
+    SkBitmapProcState::ShaderProc16 fClampProc;
+    SkBitmapProcState::ShaderProc16 fRepeatProc;
+} gShaderProcs16[] = {
+    { S16_D16_filter_DX,
+        Clamp_S16_D16_filter_DX_shaderproc,
+        Repeat_S16_D16_filter_DX_shaderproc },
+    { S16_D16_nofilter_DX,
+        Clamp_S16_D16_nofilter_DX_shaderproc,
+        Repeat_S16_D16_nofilter_DX_shaderproc },
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  With only a translate, a repeated or mirrored source needs no sampling:
+    a span is the rest of one tile's row, then whole rows, then the start of
+    one, each copied straight from the source (backwards, for the mirrored
+    tiles). The start is found the way nofilter_trans_preamble finds it, so
+    this draws exactly what the _nofilter_trans matrix procs and the
+    sampleprocs would.
+ */
+template <typename T>
+static void tile_trans_shaderproc(const SkBitmapProcState& s, int x, int y,
+                                  T* SK_RESTRICT colors, int count) {
+    SkASSERT((s.fInvType & ~SkMatrix::kTranslate_Mask) == 0);
+    SkASSERT(SkShader::kClamp_TileMode != s.fTileModeX);
+
+    SkPoint pt;
+    s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+               SkIntToScalar(y) + SK_ScalarHalf, &pt);
+    const SkBitmap& bm = *s.fBitmap;
+    const int width = bm.width();
+    const int iy = s.fIntTileProcY(SkScalarToFixed(pt.fY) >> 16, bm.height());
+    const T* SK_RESTRICT row = (const T*)((const char*)bm.getPixels() +
+                                          iy * bm.rowBytes());
+
+    // where we are in a repeat (or forward and backward tile pair)
+    const int period = SkShader::kRepeat_TileMode == s.fTileModeX ?
+                       width : 2 * width;
+    int phase = (SkScalarToFixed(pt.fX) >> 16) % period;
+    if (phase < 0) {
+        phase += period;
+    }
+
+    while (count > 0) {
+        int n;
+        if (phase < width) {
+            n = SkMin32(width - phase, count);
+            memcpy(colors, row + phase, n * sizeof(T));
+            phase = width % period;
+        } else {
+            const int start = period - 1 - phase;
+            n = SkMin32(start + 1, count);
+            for (int i = 0; i < n; i++) {
+                colors[i] = row[start - i];
+            }
+            phase = 0;
+        }
+        colors += n;
+        count -= n;
+    }
+}
+
+static void S32_D32_tile_trans_shaderproc(const SkBitmapProcState& s,
+                                          int x, int y, SkPMColor colors[],
+                                          int count) {
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale == 256);
+    tile_trans_shaderproc<SkPMColor>(s, x, y, colors, count);
+}
+
+static void S16_D16_tile_trans_shaderproc(const SkBitmapProcState& s,
+                                          int x, int y, uint16_t colors[],
+                                          int count) {
+    SkASSERT(s.fBitmap->config() == SkBitmap::kRGB_565_Config);
+    tile_trans_shaderproc<uint16_t>(s, x, y, colors, count);
+}
+
+/*  A kRLE_Index8 source can't be sampled, only unpacked a row at a time, so
+    it is only drawn translated and clamped, straight from its runs: a span
+    is the left edge, as much of the row as it covers, then the right edge.
+ */
+static inline void table_memset(SkPMColor dst[], SkPMColor value, int n) {
+    sk_memset32(dst, value, n);
+}
+
+static inline void table_memset(uint16_t dst[], uint16_t value, int n) {
+    sk_memset16(dst, value, n);
+}
+
+static inline void table_unpack(SkPMColor dst[], int skip, int n,
+                                const uint8_t packed[], const SkPMColor table[]) {
+    SkPackBits::Unpack8To32(dst, skip, n, packed, table);
+}
+
+static inline void table_unpack(uint16_t dst[], int skip, int n,
+                                const uint8_t packed[], const uint16_t table[]) {
+    SkPackBits::Unpack8To16(dst, skip, n, packed, table);
+}
+
+template <typename T>
+static void rle_clamp_trans_span(const SkBitmapProcState& s, int x, int y,
+                                 T* SK_RESTRICT colors, int count,
+                                 const T* SK_RESTRICT table) {
+    SkASSERT((s.fInvType & ~SkMatrix::kTranslate_Mask) == 0);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kRLE_Index8_Config);
+
+    SkPoint pt;
+    s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+               SkIntToScalar(y) + SK_ScalarHalf, &pt);
+    const SkBitmap& bm = *s.fBitmap;
+    const int width = bm.width();
+    const int iy = SkClampMax(SkScalarToFixed(pt.fY) >> 16, bm.height() - 1);
+    int ix = SkScalarToFixed(pt.fX) >> 16;
+
+    const SkBitmap::RLEPixels* rle = (const SkBitmap::RLEPixels*)bm.getPixels();
+    const uint8_t* packed = rle->packedAtY(iy);
+
+    if (ix < 0) {
+        int n = SkMin32(-ix, count);
+        uint8_t index;
+        SkPackBits::Unpack8(&index, 0, 1, packed);
+        table_memset(colors, table[index], n);
+        colors += n;
+        count -= n;
+        ix = 0;
+    }
+    int n = SkMin32(width - ix, count);
+    if (n > 0) {
+        table_unpack(colors, ix, n, packed, table);
+        colors += n;
+        count -= n;
+    }
+    if (count > 0) {
+        uint8_t index;
+        SkPackBits::Unpack8(&index, width - 1, 1, packed);
+        table_memset(colors, table[index], count);
+    }
+}
+
+static void SRLE_D32_clamp_trans_shaderproc(const SkBitmapProcState& s,
+                                            int x, int y, SkPMColor colors[],
+                                            int count) {
+    SkColorTable* ctable = s.fBitmap->getColorTable();
+    rle_clamp_trans_span<SkPMColor>(s, x, y, colors, count,
+                                    ctable->lockColors());
+    ctable->unlockColors(false);
+
+    const unsigned scale = s.fAlphaScale;
+    if (scale < 256) {
+        for (int i = 0; i < count; i++) {
+            colors[i] = SkAlphaMulQ(colors[i], scale);
+        }
+    }
+}
+
+static void SRLE_D16_clamp_trans_shaderproc(const SkBitmapProcState& s,
+                                            int x, int y, uint16_t colors[],
+                                            int count) {
+    SkColorTable* ctable = s.fBitmap->getColorTable();
+    rle_clamp_trans_span<uint16_t>(s, x, y, colors, count,
+                                   ctable->lock16BitCache());
+    ctable->unlock16BitCache();
+}
+
+#undef CLAMP_TILEX_PROCF
+#undef CLAMP_TILEY_PROCF
+#undef CLAMP_TILEX_LOW_BITS
+#undef CLAMP_TILEY_LOW_BITS
+#undef REPEAT_TILEX_PROCF
+#undef REPEAT_TILEY_PROCF
+#undef REPEAT_TILEX_LOW_BITS
+#undef REPEAT_TILEY_LOW_BITS
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static bool valid_for_filtering(unsigned dimension) {
@@ -360,20 +627,39 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
     }
 
     fBitmap = &fOrigBitmap;
+
+    // the inverse scale, measured in source pixels whatever m is
+    const SkFixed invSx = SkScalarToFixed(inv.getScaleX());
+    const SkFixed invKy = SkScalarToFixed(inv.getSkewY());
+
+    /*  When a filtered draw minifies by 2 or more, the 4 texels that bilerp
+        reads are spread over the source, which both aliases and misses the
+        cache on every pixel. Drawing from the mip level that is closest to
+        the destination size avoids both. The levels are cached on the
+        pixelref, so we only build them for pixels that cannot change behind
+        our back.
+     */
+    if (!fOrigBitmap.hasMipMap() && paint.isFilterBitmap() &&
+            !(inv.getType() & SkMatrix::kPerspective_Mask) &&
+            SkMax32(SkAbs32(invSx), SkAbs32(invKy)) >= 2 * SK_Fixed1 &&
+            fOrigBitmap.pixelRef() && fOrigBitmap.pixelRef()->isImmutable()) {
+        fOrigBitmap.buildMipMap();
+    }
+
     if (fOrigBitmap.hasMipMap()) {
-        int shift = fOrigBitmap.extractMipLevel(&fMipBitmap,
-                                                SkScalarToFixed(m->getScaleX()),
-                                                SkScalarToFixed(m->getSkewY()));
-        
+        int shift = fOrigBitmap.extractMipLevel(&fMipBitmap, invSx, invKy);
+
         if (shift > 0) {
+            // the unit matrix maps to [0..1) of whichever bitmap we sample,
+            // so only a matrix in source pixels needs to be scaled
             if (m != &fUnitInvMatrix) {
                 fUnitInvMatrix = *m;
                 m = &fUnitInvMatrix;
+
+                SkScalar scale = SkFixedToScalar(SK_Fixed1 >> shift);
+                fUnitInvMatrix.postScale(scale, scale);
             }
 
-            SkScalar scale = SkFixedToScalar(SK_Fixed1 >> shift);
-            fUnitInvMatrix.postScale(scale, scale);
-            
             // now point here instead of fOrigBitmap
             fBitmap = &fMipBitmap;
         }
@@ -401,6 +687,16 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
     fSampleProc32 = NULL;
     fSampleProc16 = NULL;
 
+    if (SkBitmap::kRLE_Index8_Config == fBitmap->config()) {
+        if (!trivial_matrix || !clamp_clamp) {
+            return false;
+        }
+        fMatrixProc = NULL;
+        fShaderProc32 = SRLE_D32_clamp_trans_shaderproc;
+        fShaderProc16 = SRLE_D16_clamp_trans_shaderproc;
+        return true;
+    }
+
     fMatrixProc = this->chooseMatrixProc(trivial_matrix);
     if (NULL == fMatrixProc) {
         return false;
@@ -515,15 +811,34 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
     fSampleProc16 = gSample16[index];
 
     // our special-case shaderprocs
-    if (S16_D16_filter_DX == fSampleProc16) {
-        if (clamp_clamp) {
-            fShaderProc16 = Clamp_S16_D16_filter_DX_shaderproc;
-        } else if (SkShader::kRepeat_TileMode == fTileModeX &&
-                   SkShader::kRepeat_TileMode == fTileModeY) {
-            fShaderProc16 = Repeat_S16_D16_filter_DX_shaderproc;
+    const bool repeat_repeat = SkShader::kRepeat_TileMode == fTileModeX &&
+                               SkShader::kRepeat_TileMode == fTileModeY &&
+                               !trivial_matrix;
+    if (clamp_clamp || repeat_repeat) {
+        for (size_t i = 0; i < SK_ARRAY_COUNT(gShaderProcs32); i++) {
+            if (gShaderProcs32[i].fSampleProc == fSampleProc32) {
+                fShaderProc32 = clamp_clamp ? gShaderProcs32[i].fClampProc :
+                                              gShaderProcs32[i].fRepeatProc;
+                break;
+            }
+        }
+        for (size_t i = 0; i < SK_ARRAY_COUNT(gShaderProcs16); i++) {
+            if (gShaderProcs16[i].fSampleProc == fSampleProc16) {
+                fShaderProc16 = clamp_clamp ? gShaderProcs16[i].fClampProc :
+                                              gShaderProcs16[i].fRepeatProc;
+                break;
+            }
+        }
+    }
+
+    // a translated tile is copied, rather than sampled
+    if (trivial_matrix && SkShader::kClamp_TileMode != fTileModeX) {
+        if (fSampleProc32 == S32_opaque_D32_nofilter_DX) {
+            fShaderProc32 = S32_D32_tile_trans_shaderproc;
+        }
+        if (fSampleProc16 == S16_D16_nofilter_DX) {
+            fShaderProc16 = S16_D16_tile_trans_shaderproc;
         }
-    } else if (SI8_opaque_D32_filter_DX == fSampleProc32 && clamp_clamp) {
-        fShaderProc32 = Clamp_SI8_opaque_D32_filter_DX_shaderproc;
     }
 
     // see if our platform has any accelerated overrides
@@ -143,5 +143,54 @@ void S32_opaque_D32_filter_DX(const SkBitmapProcState& s, const uint32_t xy[],
                               int count, SkPMColor colors[]);
 void S32_alpha_D32_filter_DX(const SkBitmapProcState& s, const uint32_t xy[],
                              int count, SkPMColor colors[]);
+void S32_opaque_D32_nofilter_DX(const SkBitmapProcState& s, const uint32_t xy[],
+                                int count, SkPMColor colors[]);
+void S32_opaque_D32_filter_DXDY(const SkBitmapProcState& s, const uint32_t xy[],
+                                int count, SkPMColor colors[]);
+void S32_alpha_D32_filter_DXDY(const SkBitmapProcState& s, const uint32_t xy[],
+                               int count, SkPMColor colors[]);
+void S32_opaque_D32_nofilter_DXDY(const SkBitmapProcState& s,
+                                  const uint32_t xy[], int count,
+                                  SkPMColor colors[]);
+void S32_alpha_D32_nofilter_DXDY(const SkBitmapProcState& s,
+                                 const uint32_t xy[], int count,
+                                 SkPMColor colors[]);
+void S32_alpha_D32_nofilter_DX(const SkBitmapProcState& s, const uint32_t xy[],
+                               int count, SkPMColor colors[]);
+void S16_opaque_D32_filter_DX(const SkBitmapProcState& s, const uint32_t xy[],
+                              int count, SkPMColor colors[]);
+void SI8_opaque_D32_filter_DX(const SkBitmapProcState& s, const uint32_t xy[],
+                              int count, SkPMColor colors[]);
+void S16_alpha_D32_filter_DX(const SkBitmapProcState& s, const uint32_t xy[],
+                             int count, SkPMColor colors[]);
+void S16_opaque_D32_filter_DXDY(const SkBitmapProcState& s, const uint32_t xy[],
+                                int count, SkPMColor colors[]);
+void S16_alpha_D32_filter_DXDY(const SkBitmapProcState& s, const uint32_t xy[],
+                               int count, SkPMColor colors[]);
+
+void ClampX_ClampY_nofilter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                  int count, int x, int y);
+void ClampX_ClampY_filter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                int count, int x, int y);
+void ClampX_ClampY_nofilter_affine(const SkBitmapProcState& s, uint32_t xy[],
+                                   int count, int x, int y);
+void ClampX_ClampY_filter_affine(const SkBitmapProcState& s, uint32_t xy[],
+                                 int count, int x, int y);
+void RepeatX_RepeatY_nofilter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                    int count, int x, int y);
+void RepeatX_RepeatY_filter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                  int count, int x, int y);
+void RepeatX_RepeatY_nofilter_affine(const SkBitmapProcState& s, uint32_t xy[],
+                                     int count, int x, int y);
+void RepeatX_RepeatY_filter_affine(const SkBitmapProcState& s, uint32_t xy[],
+                                   int count, int x, int y);
+void ClampX_ClampY_nofilter_persp(const SkBitmapProcState& s, uint32_t xy[],
+                                  int count, int x, int y);
+void ClampX_ClampY_filter_persp(const SkBitmapProcState& s, uint32_t xy[],
+                                int count, int x, int y);
+void RepeatX_RepeatY_nofilter_persp(const SkBitmapProcState& s, uint32_t xy[],
+                                    int count, int x, int y);
+void RepeatX_RepeatY_filter_persp(const SkBitmapProcState& s, uint32_t xy[],
+                                  int count, int x, int y);
 
 #endif
@@ -52,7 +52,7 @@
     #define PREAMBLE_ARG_Y
 #endif
 
-static void SCALE_NOFILTER_NAME(const SkBitmapProcState& s,
+void SCALE_NOFILTER_NAME(const SkBitmapProcState& s,
                                 uint32_t xy[], int count, int x, int y) {
     SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
                              SkMatrix::kScale_Mask)) == 0);
@@ -183,7 +183,7 @@ static void SCALE_NOFILTER_NAME(const SkBitmapProcState& s,
 // SCALE's inner loop that only looks at dx
 
 
-static void AFFINE_NOFILTER_NAME(const SkBitmapProcState& s,
+void AFFINE_NOFILTER_NAME(const SkBitmapProcState& s,
                                  uint32_t xy[], int count, int x, int y) {
     SkASSERT(s.fInvType & SkMatrix::kAffine_Mask);
     SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
@@ -437,7 +437,7 @@ static inline uint32_t PACK_FILTER_X_NAME(SkFixed f, unsigned max,
     return (i << 14) | (TILEX_PROCF((f + one), max));
 }
 
-static void SCALE_FILTER_NAME(const SkBitmapProcState& s,
+void SCALE_FILTER_NAME(const SkBitmapProcState& s,
                               uint32_t xy[], int count, int x, int y) {
     SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
                              SkMatrix::kScale_Mask)) == 0);
@@ -478,7 +478,7 @@ static void SCALE_FILTER_NAME(const SkBitmapProcState& s,
     }
 }
 
-static void AFFINE_FILTER_NAME(const SkBitmapProcState& s,
+void AFFINE_FILTER_NAME(const SkBitmapProcState& s,
                                uint32_t xy[], int count, int x, int y) {
     SkASSERT(s.fInvType & SkMatrix::kAffine_Mask);
     SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
@@ -78,6 +78,54 @@ static void SCALE_FILTER_NAME(const SkBitmapProcState& s, int x, int y,
 #endif
 }
 
+#ifdef RETURNDST
+
+#define SCALE_NOFILTER_NAME     MAKENAME(_nofilter_DX_shaderproc)
+
+static void SCALE_NOFILTER_NAME(const SkBitmapProcState& s, int x, int y,
+                                DSTTYPE* SK_RESTRICT colors, int count) {
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+    SkASSERT(s.fInvKy == 0);
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(!s.fDoFilter);
+    SkDEBUGCODE(CHECKSTATE(s);)
+
+    const unsigned maxX = s.fBitmap->width() - 1;
+    const SkFixed dx = s.fInvSx;
+    SkFixed fx;
+    const SRCTYPE* SK_RESTRICT row;
+
+    {
+        SkPoint pt;
+        s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                   SkIntToScalar(y) + SK_ScalarHalf, &pt);
+        const unsigned maxY = s.fBitmap->height() - 1;
+        int y0 = TILEY_PROCF(SkScalarToFixed(pt.fY), maxY);
+
+        const char* SK_RESTRICT srcAddr = (const char*)s.fBitmap->getPixels();
+        row = (const SRCTYPE*)(srcAddr + y0 * s.fBitmap->rowBytes());
+        fx = SkScalarToFixed(pt.fX);
+    }
+
+#ifdef PREAMBLE
+    PREAMBLE(s);
+#endif
+
+    do {
+        *colors++ = RETURNDST(row[TILEX_PROCF(fx, maxX)]);
+        fx += dx;
+    } while (--count != 0);
+
+#ifdef POSTAMBLE
+    POSTAMBLE(s);
+#endif
+}
+
+#undef SCALE_NOFILTER_NAME
+
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #undef TILEX_PROCF
@@ -90,6 +138,7 @@ static void SCALE_FILTER_NAME(const SkBitmapProcState& s, int x, int y,
 #undef CHECKSTATE
 #undef SRC_TO_FILTER
 #undef FILTER_TO_DST
+#undef RETURNDST
 #undef PREAMBLE
 #undef POSTAMBLE
 
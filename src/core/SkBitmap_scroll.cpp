@@ -44,22 +44,32 @@ bool SkBitmap::scrollRect(const SkIRect* subset, int dx, int dy,
 
     // compute the inval region now, before we see if there are any pixels
     if (NULL != inval) {
-        SkIRect r;
-        
-        r.set(0, 0, width, height);
-        // initial the region with the entire bounds
-        inval->setRect(r);
-        // do the "scroll"
-        r.offset(dx, dy);
-        
         // check if we scrolled completely away
-        if (!SkIRect::Intersects(r, inval->getBounds())) {
-            // inval has already been updated...
+        if (SkAbs32(dx) >= width || SkAbs32(dy) >= height) {
+            inval->setRect(0, 0, width, height);
             return true;
         }
-        
-        // compute the dirty area
-        inval->op(r, SkRegion::kDifference_Op);
+
+        // the dirty area is a band of rows across the top or bottom, and one
+        // of columns down the left or right of what rows are left
+        SkIRect dirty[2];
+        int top = 0;
+        int bottom = height;
+        if (dy > 0) {
+            dirty[0].set(0, 0, width, dy);
+            top = dy;
+        } else {
+            dirty[0].set(0, height + dy, width, height);
+            bottom = height + dy;
+        }
+        if (dx > 0) {
+            dirty[1].set(0, top, dx, bottom);
+        } else {
+            dirty[1].set(width + dx, top, width, bottom);
+        }
+        inval->setRects(dirty, 2);
+    } else if (SkAbs32(dx) >= width || SkAbs32(dy) >= height) {
+        return true;
     }
     
     SkAutoLockPixels    alp(*this);
@@ -97,10 +107,28 @@ bool SkBitmap::scrollRect(const SkIRect* subset, int dx, int dy,
     }
 
     width <<= shift;    // now width is the number of bytes to move per line
-    while (--height >= 0) {
-        memmove(dst, src, width);
-        dst += rowBytes;
-        src += rowBytes;
+    if (0 == dx && SkAbs32(rowBytes) == width) {
+        // the rows are contiguous, so they all move at once
+        if (rowBytes < 0) {
+            src += (height - 1) * rowBytes;
+            dst += (height - 1) * rowBytes;
+        }
+        memmove(dst, src, height * width);
+    } else if (0 == dy) {
+        // each row moves within itself
+        while (--height >= 0) {
+            memmove(dst, src, width);
+            dst += rowBytes;
+            src += rowBytes;
+        }
+    } else {
+        // src and dst are always on different rows, and the rows whose
+        // pixels are still to be moved are never written to before then
+        while (--height >= 0) {
+            memcpy(dst, src, width);
+            dst += rowBytes;
+            src += rowBytes;
+        }
     }
     return true;
 }
@@ -217,7 +217,14 @@ static const SkBlitRow::Proc gDefault_565_Procs[] = {
 };
 
 extern SkBlitRow::Proc SkBlitRow_Factory_4444(unsigned flags);
-    
+
+// the portable procs, which the platform ones have to match
+SkBlitRow::Proc SkBlitRow_Factory_565(unsigned flags);
+SkBlitRow::Proc SkBlitRow_Factory_565(unsigned flags) {
+    SkASSERT(flags < SK_ARRAY_COUNT(gDefault_565_Procs));
+    return gDefault_565_Procs[flags];
+}
+
 SkBlitRow::Proc SkBlitRow::Factory(unsigned flags, SkBitmap::Config config) {
     SkASSERT(flags < SK_ARRAY_COUNT(gDefault_565_Procs));
     // just so we don't crash
@@ -229,7 +236,7 @@ SkBlitRow::Proc SkBlitRow::Factory(unsigned flags, SkBitmap::Config config) {
         case SkBitmap::kRGB_565_Config:
             proc = PlatformProcs565(flags);
             if (NULL == proc) {
-                proc = gDefault_565_Procs[flags];
+                proc = SkBlitRow_Factory_565(flags);
             }
             break;
         case SkBitmap::kARGB_4444_Config:
@@ -168,6 +168,26 @@ void SkBlitRow::Color32(SkPMColor dst[], const SkPMColor src[],
     }
 }
 
+SkBlitRow::ColorAAProc SkBlitRow::ColorAAProcFactory() {
+    SkBlitRow::ColorAAProc proc = PlatformColorAAProc();
+    if (NULL == proc) {
+        proc = ColorAA32;
+    }
+    SkASSERT(proc);
+    return proc;
+}
+
+void SkBlitRow::ColorAA32(SkPMColor dst[], const SkAlpha aa[], int count,
+                          SkPMColor color) {
+    for (int i = 0; i < count; i++) {
+        unsigned alpha = aa[i];
+        if (alpha) {
+            SkPMColor sc = SkAlphaMulQ(color, SkAlpha255To256(alpha));
+            dst[i] = sc + SkAlphaMulQ(dst[i], 255 - SkGetPackedA32(sc));
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static void D32_Mask_Color(void* dst, size_t dstRB, SkBitmap::Config,
@@ -230,7 +250,6 @@ static void D32_Mask_Black(void* dst, size_t dstRB, SkBitmap::Config,
 
 SkBlitMask::Proc SkBlitMask::Factory(SkBitmap::Config config, SkColor color) {
     SkBlitMask::Proc proc = PlatformProcs(config, color);
-    proc = NULL;
     if (NULL == proc) {
         switch (config) {
             case SkBitmap::kARGB_8888_Config:
@@ -249,3 +268,103 @@ SkBlitMask::Proc SkBlitMask::Factory(SkBitmap::Config config, SkColor color) {
     return proc;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+static inline int upscale31To32(int value) {
+    SkASSERT((unsigned)value <= 31);
+    return value + (value >> 4);
+}
+
+static inline int blend32(int src, int dst, int scale) {
+    SkASSERT((unsigned)src <= 0xFF);
+    SkASSERT((unsigned)dst <= 0xFF);
+    SkASSERT((unsigned)scale <= 32);
+    return dst + ((src - dst) * scale >> 5);
+}
+
+static void LCD16_Row(SkPMColor dst[], const uint16_t src[],
+                      SkPMColor color, int width) {
+    int srcR = SkGetPackedR32(color);
+    int srcG = SkGetPackedG32(color);
+    int srcB = SkGetPackedB32(color);
+
+    for (int i = 0; i < width; i++) {
+        uint16_t mask = src[i];
+        if (0 == mask) {
+            continue;
+        }
+
+        SkPMColor d = dst[i];
+        
+        /*  We want all of these in 5bits, hence the shifts in case one of them
+         *  (green) is 6bits.
+         */
+        int maskR = SkGetPackedR16(mask) >> (SK_R16_BITS - 5);
+        int maskG = SkGetPackedG16(mask) >> (SK_G16_BITS - 5);
+        int maskB = SkGetPackedB16(mask) >> (SK_B16_BITS - 5);
+
+        // Now upscale them to 0..256, so we can use SkAlphaBlend
+        maskR = upscale31To32(maskR);
+        maskG = upscale31To32(maskG);
+        maskB = upscale31To32(maskB);
+
+        int maskA = SkMax32(SkMax32(maskR, maskG), maskB);
+
+        int dstA = SkGetPackedA32(d);
+        int dstR = SkGetPackedR32(d);
+        int dstG = SkGetPackedG32(d);
+        int dstB = SkGetPackedB32(d);
+
+        dst[i] = SkPackARGB32(blend32(0xFF, dstA, maskA),
+                              blend32(srcR, dstR, maskR),
+                              blend32(srcG, dstG, maskG),
+                              blend32(srcB, dstB, maskB));
+    }
+}
+
+static void LCD32_Row(SkPMColor dst[], const uint32_t src[],
+                      SkPMColor color, int width) {
+    int srcR = SkGetPackedR32(color);
+    int srcG = SkGetPackedG32(color);
+    int srcB = SkGetPackedB32(color);
+
+    for (int i = 0; i < width; i++) {
+        uint32_t mask = src[i];
+        if (0 == mask) {
+            continue;
+        }
+
+        SkPMColor d = dst[i];
+        
+        int maskR = SkGetPackedR32(mask);
+        int maskG = SkGetPackedG32(mask);
+        int maskB = SkGetPackedB32(mask);
+
+        // Now upscale them to 0..256, so we can use SkAlphaBlend
+        maskR = SkAlpha255To256(maskR);
+        maskG = SkAlpha255To256(maskG);
+        maskB = SkAlpha255To256(maskB);
+
+        int maskA = SkMax32(SkMax32(maskR, maskG), maskB);
+
+        int dstA = SkGetPackedA32(d);
+        int dstR = SkGetPackedR32(d);
+        int dstG = SkGetPackedG32(d);
+        int dstB = SkGetPackedB32(d);
+
+        dst[i] = SkPackARGB32(SkAlphaBlend(0xFF, dstA, maskA),
+                              SkAlphaBlend(srcR, dstR, maskR),
+                              SkAlphaBlend(srcG, dstG, maskG),
+                              SkAlphaBlend(srcB, dstB, maskB));
+    }
+}
+
+SkBlitMask::LCD16RowProc SkBlitMask::LCD16RowFactory() {
+    SkBlitMask::LCD16RowProc proc = PlatformLCD16RowProc();
+    return proc ? proc : LCD16_Row;
+}
+
+SkBlitMask::LCD32RowProc SkBlitMask::LCD32RowFactory() {
+    SkBlitMask::LCD32RowProc proc = PlatformLCD32RowProc();
+    return proc ? proc : LCD32_Row;
+}
@@ -18,10 +18,13 @@
 #include "SkBlitter.h"
 #include "SkAntiRun.h"
 #include "SkColor.h"
+#include "SkColorPriv.h"
 #include "SkColorFilter.h"
 #include "SkMask.h"
 #include "SkMaskFilter.h"
+#include "SkScratchAlloc.h"
 #include "SkTemplatesPriv.h"
+#include "SkTrace.h"
 #include "SkUtils.h"
 #include "SkXfermode.h"
 
@@ -176,6 +179,13 @@ void SkBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
 
 /////////////////////// these guys are not virtual, just a helpers
 
+void SkBlitter::blitMasks(const SkMask masks[], const SkIRect clips[],
+                          int count) {
+    for (int i = 0; i < count; i++) {
+        this->blitMask(masks[i], clips[i]);
+    }
+}
+
 void SkBlitter::blitMaskRegion(const SkMask& mask, const SkRegion& clip) {
     if (clip.quickReject(mask.fBounds)) {
         return;
@@ -457,6 +467,267 @@ const SkBitmap* SkRgnClipBlitter::justAnOpaqueColor(uint32_t* value) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void SkMaskClipBlitter::init(SkBlitter* blitter, const SkMask* clipMask) {
+    SkASSERT(clipMask && SkMask::kA8_Format == clipMask->fFormat);
+    SkASSERT(!clipMask->isEmpty());
+    fBlitter = blitter;
+    fClipMask = clipMask;
+
+    int width = clipMask->fBounds.width();
+    fRuns = (int16_t*)fStorage.realloc((width + 1) *
+                                       (sizeof(int16_t) + sizeof(SkAlpha)));
+    fAA = (SkAlpha*)(fRuns + width + 1);
+}
+
+// fAA[0..width) holds the coverage of each pixel, starting at x. Turn it into
+// runs of equal coverage, and blit those.
+void SkMaskClipBlitter::blitCoverage(int x, int y, int width) {
+    SkASSERT(width > 0 && width <= fClipMask->fBounds.width());
+    const SkAlpha* aa = fAA;
+    int16_t* runs = fRuns;
+    int i = 0;
+    while (i < width) {
+        int n = 1;
+        while (i + n < width && aa[i + n] == aa[i]) {
+            n += 1;
+        }
+        runs[i] = SkToS16(n);
+        i += n;
+    }
+    runs[width] = 0;
+    fBlitter->blitAntiH(x, y, fAA, fRuns);
+}
+
+void SkMaskClipBlitter::blitH(int x, int y, int width) {
+    const SkIRect& bounds = fClipMask->fBounds;
+    if (!y_in_rect(y, bounds)) {
+        return;
+    }
+    int left = SkMax32(x, bounds.fLeft);
+    int right = SkMin32(x + width, bounds.fRight);
+    if (left >= right) {
+        return;
+    }
+    memcpy(fAA, fClipMask->getAddr(left, y), right - left);
+    this->blitCoverage(left, y, right - left);
+}
+
+void SkMaskClipBlitter::blitAntiH(int x, int y, const SkAlpha aa[],
+                                  const int16_t runs[]) {
+    const SkIRect& bounds = fClipMask->fBounds;
+    if (!y_in_rect(y, bounds)) {
+        return;
+    }
+    int left = SkMax32(x, bounds.fLeft);
+    int right = SkMin32(x + compute_anti_width(runs), bounds.fRight);
+    if (left >= right) {
+        return;
+    }
+
+    const uint8_t* coverage = fClipMask->getAddr(left, y);
+    SkAlpha* dst = fAA;
+    for (;;) {
+        int n = runs[0];
+        if (0 == n) {
+            break;
+        }
+        // the part of this run that is in [left, right)
+        int start = SkMax32(x, left);
+        int stop = SkMin32(x + n, right);
+        for (int i = start; i < stop; ++i) {
+            dst[i - left] = SkMulDiv255Round(aa[0], coverage[i - left]);
+        }
+        x += n;
+        runs += n;
+        aa += n;
+    }
+    this->blitCoverage(left, y, right - left);
+}
+
+void SkMaskClipBlitter::blitV(int x, int y, int height, SkAlpha alpha) {
+    const SkIRect& bounds = fClipMask->fBounds;
+    if (!x_in_rect(x, bounds)) {
+        return;
+    }
+    int top = SkMax32(y, bounds.fTop);
+    int bottom = SkMin32(y + height, bounds.fBottom);
+
+    // blit runs of the same coverage together
+    while (top < bottom) {
+        SkAlpha a = SkMulDiv255Round(alpha, *fClipMask->getAddr(x, top));
+        int n = 1;
+        while (top + n < bottom &&
+               SkMulDiv255Round(alpha, *fClipMask->getAddr(x, top + n)) == a) {
+            n += 1;
+        }
+        if (a) {
+            fBlitter->blitV(x, top, n, a);
+        }
+        top += n;
+    }
+}
+
+void SkMaskClipBlitter::blitRect(int x, int y, int width, int height) {
+    SkIRect r;
+    r.set(x, y, x + width, y + height);
+    if (!r.intersect(fClipMask->fBounds)) {
+        return;
+    }
+    for (int cy = r.fTop; cy < r.fBottom; ++cy) {
+        memcpy(fAA, fClipMask->getAddr(r.fLeft, cy), r.width());
+        this->blitCoverage(r.fLeft, cy, r.width());
+    }
+}
+
+/*  Blit a copy of the mask with its coverage modulated by the clip's. BW
+    masks become A8 ones; the other formats keep their format, with each
+    channel of LCD and ARGB masks (and only the alpha plane of 3D ones)
+    modulated.
+ */
+void SkMaskClipBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
+    SkASSERT(mask.fBounds.contains(clip));
+
+    SkIRect r = clip;
+    if (!r.intersect(fClipMask->fBounds)) {
+        return;
+    }
+
+    SkMask dst;
+    dst.fBounds = r;
+    dst.fFormat = SkMask::kBW_Format == mask.fFormat ? SkMask::kA8_Format :
+                                                       mask.fFormat;
+    switch (dst.fFormat) {
+        case SkMask::kLCD16_Format:
+            dst.fRowBytes = r.width() << 1;
+            break;
+        case SkMask::kARGB32_Format:
+        case SkMask::kLCD32_Format:
+            dst.fRowBytes = r.width() << 2;
+            break;
+        default:
+            dst.fRowBytes = r.width();
+            break;
+    }
+
+    size_t planeSize = dst.computeImageSize();
+    if (0 == planeSize) {
+        return;
+    }
+    SkAutoScratch storage;
+    dst.fImage = (uint8_t*)storage.alloc(dst.computeTotalImageSize());
+
+    for (int y = r.fTop; y < r.fBottom; ++y) {
+        const uint8_t* coverage = fClipMask->getAddr(r.fLeft, y);
+        int width = r.width();
+        switch (mask.fFormat) {
+            case SkMask::kBW_Format: {
+                uint8_t* d = dst.getAddr(r.fLeft, y);
+                for (int i = 0; i < width; ++i) {
+                    int x = r.fLeft + i;
+                    int bit = 7 - ((x - mask.fBounds.fLeft) & 7);
+                    d[i] = (*mask.getAddr1(x, y) >> bit) & 1 ? coverage[i] : 0;
+                }
+            } break;
+            case SkMask::kA8_Format:
+            case SkMask::k3D_Format: {
+                const uint8_t* s = mask.getAddr(r.fLeft, y);
+                uint8_t* d = dst.getAddr(r.fLeft, y);
+                for (int i = 0; i < width; ++i) {
+                    d[i] = SkMulDiv255Round(s[i], coverage[i]);
+                }
+            } break;
+            case SkMask::kLCD16_Format: {
+                const uint16_t* s = mask.getAddrLCD16(r.fLeft, y);
+                uint16_t* d = dst.getAddrLCD16(r.fLeft, y);
+                for (int i = 0; i < width; ++i) {
+                    d[i] = SkAlphaMulRGB16_ToU16(s[i],
+                                                SkAlpha255To256(coverage[i]));
+                }
+            } break;
+            case SkMask::kARGB32_Format:
+            case SkMask::kLCD32_Format: {
+                const uint32_t* s = (const uint32_t*)(mask.fImage +
+                        (y - mask.fBounds.fTop) * mask.fRowBytes) +
+                        (r.fLeft - mask.fBounds.fLeft);
+                uint32_t* d = (uint32_t*)(dst.fImage +
+                        (y - r.fTop) * dst.fRowBytes);
+                for (int i = 0; i < width; ++i) {
+                    d[i] = SkAlphaMulQ(s[i], SkAlpha255To256(coverage[i]));
+                }
+            } break;
+        }
+    }
+
+    if (SkMask::k3D_Format == mask.fFormat) {
+        // the mul and add planes follow the alpha plane, and aren't modulated
+        size_t srcPlaneSize = mask.computeImageSize();
+        for (int plane = 1; plane <= 2; ++plane) {
+            for (int y = r.fTop; y < r.fBottom; ++y) {
+                memcpy(dst.getAddr(r.fLeft, y) + plane * planeSize,
+                       mask.getAddr(r.fLeft, y) + plane * srcPlaneSize,
+                       r.width());
+            }
+        }
+    }
+
+    fBlitter->blitMask(dst, r);
+}
+
+const SkBitmap* SkMaskClipBlitter::justAnOpaqueColor(uint32_t* value) {
+    // what we blit is modulated by the clip, so it isn't just one value
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SK_TRACE_COUNTER(gBlitHPixels, "blitter.pixels.blitH");
+SK_TRACE_COUNTER(gBlitAntiHPixels, "blitter.pixels.blitAntiH");
+SK_TRACE_COUNTER(gBlitVPixels, "blitter.pixels.blitV");
+SK_TRACE_COUNTER(gBlitRectPixels, "blitter.pixels.blitRect");
+SK_TRACE_COUNTER(gBlitMaskPixels, "blitter.pixels.blitMask");
+
+void SkTraceBlitter::blitH(int x, int y, int width) {
+    SK_TRACE_ADD(gBlitHPixels, width);
+    fBlitter->blitH(x, y, width);
+}
+
+void SkTraceBlitter::blitAntiH(int x, int y, const SkAlpha aa[],
+                               const int16_t runs[]) {
+#ifdef SK_ENABLE_TRACE
+    // only the runs with some coverage touch their pixels
+    int width = 0;
+    const SkAlpha* a = aa;
+    for (const int16_t* r = runs; *r > 0; a += *r, r += *r) {
+        if (*a) {
+            width += *r;
+        }
+    }
+    SK_TRACE_ADD(gBlitAntiHPixels, width);
+#endif
+    fBlitter->blitAntiH(x, y, aa, runs);
+}
+
+void SkTraceBlitter::blitV(int x, int y, int height, SkAlpha alpha) {
+    SK_TRACE_ADD(gBlitVPixels, height);
+    fBlitter->blitV(x, y, height, alpha);
+}
+
+void SkTraceBlitter::blitRect(int x, int y, int width, int height) {
+    SK_TRACE_ADD(gBlitRectPixels, width * height);
+    fBlitter->blitRect(x, y, width, height);
+}
+
+void SkTraceBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
+    SK_TRACE_ADD(gBlitMaskPixels, clip.width() * clip.height());
+    fBlitter->blitMask(mask, clip);
+}
+
+const SkBitmap* SkTraceBlitter::justAnOpaqueColor(uint32_t* value) {
+    return fBlitter->justAnOpaqueColor(value);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SkBlitter* SkBlitterClipper::apply(SkBlitter* blitter, const SkRegion* clip,
                                    const SkIRect* ir) {
     if (clip) {
@@ -758,11 +1029,15 @@ static XferInterp interpret_xfermode(const SkPaint& paint, SkXfermode* xfer,
     return kNormal_XferInterp;
 }
 
+SK_TRACE_COUNTER(gChooseCount, "blitter.choose");
+
 SkBlitter* SkBlitter::Choose(const SkBitmap& device,
                              const SkMatrix& matrix,
                              const SkPaint& origPaint,
                              void* storage, size_t storageSize) {
     SkASSERT(storageSize == 0 || storage != NULL);
+    SK_TRACE_EVENT("SkBlitter::Choose");
+    SK_TRACE_INC(gChooseCount);
 
     SkBlitter*  blitter = NULL;
 
@@ -809,6 +1084,16 @@ SkBlitter* SkBlitter::Choose(const SkBitmap& device,
             // xfermodes (and filters) require shaders for our current blitters
             shader = SkNEW(SkColorShader);
             paint.setShader(shader)->unref();
+#ifndef SK_IGNORE_CF_OPTIMIZATION
+            // the shader makes just the paint's color, so if the filter's
+            // version of that is an SkColor too, filter it once, here
+            SkColor color;
+            if (cf && cf->filterColorExact(paint.getColor(), &color)) {
+                paint.setColor(color);
+                paint.setColorFilter(NULL);
+                cf = NULL;
+            }
+#endif
         } else if (cf) {
             // if no shader && no xfermode, we just apply the colorfilter to
             // our color and move on.
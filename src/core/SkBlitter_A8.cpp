@@ -20,9 +20,62 @@
 #include "SkShader.h"
 #include "SkXfermode.h"
 
+// the same blend the BW mask procs below use: dst scaled by 256 - src, so
+// that a src of 0 leaves dst as it was
+static inline U8CPU srcover_a8(U8CPU sa, U8CPU da) {
+    return SkToU8(sa + SkAlphaMul(da, 256 - sa));
+}
+
+void SkBlitRow::ColorA8(uint8_t dst[], const SkAlpha aa[], int count,
+                        U8CPU alpha) {
+    if (NULL == aa) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = srcover_a8(alpha, dst[i]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            dst[i] = srcover_a8(SkAlphaMul(alpha, SkAlpha255To256(aa[i])),
+                                dst[i]);
+        }
+    }
+}
+
+void SkBlitRow::AlphaA8(uint8_t dst[], const SkAlpha src[], const SkAlpha aa[],
+                        int count) {
+    if (NULL == aa) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = srcover_a8(src[i], dst[i]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            dst[i] = srcover_a8(SkAlphaMul(src[i], SkAlpha255To256(aa[i])),
+                                dst[i]);
+        }
+    }
+}
+
+SkBlitRow::ColorA8Proc SkBlitRow::ColorA8ProcFactory() {
+    SkBlitRow::ColorA8Proc proc = PlatformColorA8Proc();
+    if (NULL == proc) {
+        proc = ColorA8;
+    }
+    return proc;
+}
+
+SkBlitRow::AlphaA8Proc SkBlitRow::AlphaA8ProcFactory() {
+    SkBlitRow::AlphaA8Proc proc = PlatformAlphaA8Proc();
+    if (NULL == proc) {
+        proc = AlphaA8;
+    }
+    return proc;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SkA8_Blitter::SkA8_Blitter(const SkBitmap& device, const SkPaint& paint)
         : INHERITED(device) {
     fSrcA = paint.getAlpha();
+    fColorA8Proc = SkBlitRow::ColorA8ProcFactory();
 }
 
 const SkBitmap* SkA8_Blitter::justAnOpaqueColor(uint32_t* value) {
@@ -46,12 +99,7 @@ void SkA8_Blitter::blitH(int x, int y, int width) {
     if (fSrcA == 255) {
         memset(device, 0xFF, width);
     } else {
-        unsigned scale = 256 - SkAlpha255To256(fSrcA);
-        unsigned srcA = fSrcA;
-
-        for (int i = 0; i < width; i++) {
-            device[i] = SkToU8(srcA + SkAlphaMul(device[i], scale));
-        }
+        fColorA8Proc(device, NULL, width, fSrcA);
     }
 }
 
@@ -74,13 +122,9 @@ void SkA8_Blitter::blitAntiH(int x, int y, const SkAlpha antialias[],
 
         if (aa == 255 && srcA == 255) {
             memset(device, 0xFF, count);
-        } else {
-            unsigned sa = SkAlphaMul(srcA, SkAlpha255To256(aa));
-            unsigned scale = 256 - sa;
-
-            for (int i = 0; i < count; i++) {
-                device[i] = SkToU8(sa + SkAlphaMul(device[i], scale));
-            }
+        } else if (aa) {
+            fColorA8Proc(device, NULL, count,
+                         SkAlphaMul(srcA, SkAlpha255To256(aa)));
         }
         runs += count;
         antialias += count;
@@ -149,31 +193,9 @@ void SkA8_Blitter::blitMask(const SkMask& mask, const SkIRect& clip) {
     int height = clip.height();
     uint8_t* device = fDevice.getAddr8(x, y);
     const uint8_t* alpha = mask.getAddr(x, y);
-    unsigned    srcA = fSrcA;
 
     while (--height >= 0) {
-        for (int i = width - 1; i >= 0; --i) {
-            unsigned sa;
-            // scale our src by the alpha value
-            {
-                int aa = alpha[i];
-                if (aa == 0) {
-                    continue;
-                }
-                if (aa == 255) {
-                    if (srcA == 255) {
-                        device[i] = 0xFF;
-                        continue;
-                    }
-                    sa = srcA;
-                } else {
-                    sa = SkAlphaMul(srcA, SkAlpha255To256(aa));
-                }
-            }
-
-            int scale = 256 - SkAlpha255To256(sa);
-            device[i] = SkToU8(sa + SkAlphaMul(device[i], scale));
-        }
+        fColorA8Proc(device, alpha, width, fSrcA);
         device += fDevice.rowBytes();
         alpha += mask.fRowBytes;
     }
@@ -215,22 +237,20 @@ void SkA8_Blitter::blitRect(int x, int y, int width, int height) {
     }
 
     uint8_t*    device = fDevice.getAddr8(x, y);
-    unsigned    srcA = fSrcA;
+    size_t      rowBytes = fDevice.rowBytes();
 
-    if (srcA == 255) {
-        while (--height >= 0) {
+    // contiguous rows are one long row
+    if (rowBytes == (size_t)width) {
+        width *= height;
+        height = 1;
+    }
+    while (--height >= 0) {
+        if (fSrcA == 255) {
             memset(device, 0xFF, width);
-            device += fDevice.rowBytes();
-        }
-    } else {
-        unsigned scale = 256 - SkAlpha255To256(srcA);
-
-        while (--height >= 0) {
-            for (int i = 0; i < width; i++) {
-                device[i] = SkToU8(srcA + SkAlphaMul(device[i], scale));
-            }
-            device += fDevice.rowBytes();
+        } else {
+            fColorA8Proc(device, NULL, width, fSrcA);
         }
+        device += rowBytes;
     }
 }
 
@@ -246,6 +266,8 @@ SkA8_Shader_Blitter::SkA8_Shader_Blitter(const SkBitmap& device, const SkPaint&
     int width = device.width();
     fBuffer = (SkPMColor*)sk_malloc_throw(sizeof(SkPMColor) * (width + (SkAlign4(width) >> 2)));
     fAAExpand = (uint8_t*)(fBuffer + width);
+    fColorA8Proc = SkBlitRow::ColorA8ProcFactory();
+    fAlphaA8Proc = SkBlitRow::AlphaA8ProcFactory();
 }
 
 SkA8_Shader_Blitter::~SkA8_Shader_Blitter() {
@@ -261,33 +283,17 @@ void SkA8_Shader_Blitter::blitH(int x, int y, int width) {
 
     if ((fShader->getFlags() & SkShader::kOpaqueAlpha_Flag) && !fXfermode) {
         memset(device, 0xFF, width);
+    } else if (fXfermode) {
+        fShader->shadeSpan(x, y, fBuffer, width);
+        fXfermode->xferA8(device, fBuffer, width, NULL);
     } else {
-        SkPMColor*  span = fBuffer;
-
-        fShader->shadeSpan(x, y, span, width);
-        if (fXfermode) {
-            fXfermode->xferA8(device, span, width, NULL);
-        } else {
-            for (int i = width - 1; i >= 0; --i) {
-                unsigned    srcA = SkGetPackedA32(span[i]);
-                unsigned    scale = 256 - SkAlpha255To256(srcA);
-
-                device[i] = SkToU8(srcA + SkAlphaMul(device[i], scale));
-            }
-        }
+        // only the shader's alphas matter here, not its colors
+        uint8_t* alpha = (uint8_t*)fBuffer;
+        fShader->shadeSpanAlpha(x, y, alpha, width);
+        fAlphaA8Proc(device, alpha, NULL, width);
     }
 }
 
-static inline uint8_t aa_blend8(SkPMColor src, U8CPU da, int aa) {
-    SkASSERT((unsigned)aa <= 255);
-
-    int src_scale = SkAlpha255To256(aa);
-    int sa = SkGetPackedA32(src);
-    int dst_scale = 256 - SkAlphaMul(sa, src_scale);
-
-    return SkToU8((sa * src_scale + da * dst_scale) >> 8);
-}
-
 void SkA8_Shader_Blitter::blitAntiH(int x, int y, const SkAlpha antialias[],
                                     const int16_t runs[]) {
     SkShader*   shader = fShader;
@@ -306,16 +312,21 @@ void SkA8_Shader_Blitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         if (aa) {
             if (opaque && aa == 255 && mode == NULL) {
                 memset(device, 0xFF, count);
-            } else {
+            } else if (opaque && mode == NULL) {
+                fColorA8Proc(device, NULL, count, aa);
+            } else if (mode) {
                 shader->shadeSpan(x, y, span, count);
-                if (mode) {
+                memset(aaExpand, aa, count);
+                mode->xferA8(device, span, count, aaExpand);
+            } else {
+                uint8_t* alpha = (uint8_t*)span;
+                const uint8_t* coverage = NULL;
+                shader->shadeSpanAlpha(x, y, alpha, count);
+                if (aa < 255) {
                     memset(aaExpand, aa, count);
-                    mode->xferA8(device, span, count, aaExpand);
-                } else {
-                    for (int i = count - 1; i >= 0; --i) {
-                        device[i] = aa_blend8(span[i], device[i], aa);
-                    }
+                    coverage = aaExpand;
                 }
+                fAlphaA8Proc(device, alpha, coverage, count);
             }
         }
         device += count;
@@ -339,11 +350,19 @@ void SkA8_Shader_Blitter::blitMask(const SkMask& mask, const SkIRect& clip) {
     const uint8_t* alpha = mask.getAddr(x, y);
 
     SkPMColor*  span = fBuffer;
+    bool        opaque = (fShader->getFlags() & SkShader::kOpaqueAlpha_Flag) &&
+                         NULL == fXfermode;
 
     while (--height >= 0) {
-        fShader->shadeSpan(x, y, span, width);
-        if (fXfermode) {
+        if (opaque) {
+            fColorA8Proc(device, alpha, width, 0xFF);
+        } else if (fXfermode) {
+            fShader->shadeSpan(x, y, span, width);
             fXfermode->xferA8(device, span, width, alpha);
+        } else {
+            uint8_t* srcA = (uint8_t*)span;
+            fShader->shadeSpanAlpha(x, y, srcA, width);
+            fAlphaA8Proc(device, srcA, alpha, width);
         }
 
         y += 1;
@@ -23,97 +23,26 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static inline int upscale31To32(int value) {
-    SkASSERT((unsigned)value <= 31);
-    return value + (value >> 4);
-}
-
-static inline int blend32(int src, int dst, int scale) {
-    SkASSERT((unsigned)src <= 0xFF);
-    SkASSERT((unsigned)dst <= 0xFF);
-    SkASSERT((unsigned)scale <= 32);
-    return dst + ((src - dst) * scale >> 5);
-}
-
-static void blit_lcd16_opaque(SkPMColor dst[], const uint16_t src[],
-                              SkPMColor color, int width) {
-    int srcR = SkGetPackedR32(color);
-    int srcG = SkGetPackedG32(color);
-    int srcB = SkGetPackedB32(color);
-
-    for (int i = 0; i < width; i++) {
-        uint16_t mask = src[i];
-        if (0 == mask) {
-            continue;
-        }
-
-        SkPMColor d = dst[i];
-        
-        /*  We want all of these in 5bits, hence the shifts in case one of them
-         *  (green) is 6bits.
-         */
-        int maskR = SkGetPackedR16(mask) >> (SK_R16_BITS - 5);
-        int maskG = SkGetPackedG16(mask) >> (SK_G16_BITS - 5);
-        int maskB = SkGetPackedB16(mask) >> (SK_B16_BITS - 5);
-
-        // Now upscale them to 0..256, so we can use SkAlphaBlend
-        maskR = upscale31To32(maskR);
-        maskG = upscale31To32(maskG);
-        maskB = upscale31To32(maskB);
-
-        int maskA = SkMax32(SkMax32(maskR, maskG), maskB);
-
-        int dstA = SkGetPackedA32(d);
-        int dstR = SkGetPackedR32(d);
-        int dstG = SkGetPackedG32(d);
-        int dstB = SkGetPackedB32(d);
-
-        dst[i] = SkPackARGB32(blend32(0xFF, dstA, maskA),
-                              blend32(srcR, dstR, maskR),
-                              blend32(srcG, dstG, maskG),
-                              blend32(srcB, dstB, maskB));
+// looked up once; threads racing to look it up all find the same proc
+static SkBlitMask::LCD16RowProc lcd16_proc() {
+    static SkBlitMask::LCD16RowProc gProc;
+    if (NULL == gProc) {
+        gProc = SkBlitMask::LCD16RowFactory();
     }
+    return gProc;
 }
 
-static void blit_lcd32_opaque(SkPMColor dst[], const uint32_t src[],
-                              SkPMColor color, int width) {
-    int srcR = SkGetPackedR32(color);
-    int srcG = SkGetPackedG32(color);
-    int srcB = SkGetPackedB32(color);
-
-    for (int i = 0; i < width; i++) {
-        uint32_t mask = src[i];
-        if (0 == mask) {
-            continue;
-        }
-
-        SkPMColor d = dst[i];
-        
-        int maskR = SkGetPackedR32(mask);
-        int maskG = SkGetPackedG32(mask);
-        int maskB = SkGetPackedB32(mask);
-
-        // Now upscale them to 0..256, so we can use SkAlphaBlend
-        maskR = SkAlpha255To256(maskR);
-        maskG = SkAlpha255To256(maskG);
-        maskB = SkAlpha255To256(maskB);
-
-        int maskA = SkMax32(SkMax32(maskR, maskG), maskB);
-
-        int dstA = SkGetPackedA32(d);
-        int dstR = SkGetPackedR32(d);
-        int dstG = SkGetPackedG32(d);
-        int dstB = SkGetPackedB32(d);
-
-        dst[i] = SkPackARGB32(SkAlphaBlend(0xFF, dstA, maskA),
-                              SkAlphaBlend(srcR, dstR, maskR),
-                              SkAlphaBlend(srcG, dstG, maskG),
-                              SkAlphaBlend(srcB, dstB, maskB));
+static SkBlitMask::LCD32RowProc lcd32_proc() {
+    static SkBlitMask::LCD32RowProc gProc;
+    if (NULL == gProc) {
+        gProc = SkBlitMask::LCD32RowFactory();
     }
+    return gProc;
 }
 
 static void blitmask_lcd16(const SkBitmap& device, const SkMask& mask,
                            const SkIRect& clip, SkPMColor srcColor) {
+    SkBlitMask::LCD16RowProc proc = lcd16_proc();
     int x = clip.fLeft;
     int y = clip.fTop;
     int width = clip.width();
@@ -123,7 +52,7 @@ static void blitmask_lcd16(const SkBitmap& device, const SkMask& mask,
     const uint16_t* srcRow = mask.getAddrLCD16(x, y);
 
     do {
-        blit_lcd16_opaque(dstRow, srcRow, srcColor, width);
+        proc(dstRow, srcRow, srcColor, width);
         dstRow = (SkPMColor*)((char*)dstRow + device.rowBytes());
         srcRow = (const uint16_t*)((const char*)srcRow + mask.fRowBytes);
     } while (--height != 0);
@@ -131,6 +60,7 @@ static void blitmask_lcd16(const SkBitmap& device, const SkMask& mask,
 
 static void blitmask_lcd32(const SkBitmap& device, const SkMask& mask,
                            const SkIRect& clip, SkPMColor srcColor) {
+    SkBlitMask::LCD32RowProc proc = lcd32_proc();
     int x = clip.fLeft;
     int y = clip.fTop;
     int width = clip.width();
@@ -140,7 +70,7 @@ static void blitmask_lcd32(const SkBitmap& device, const SkMask& mask,
     const uint32_t* srcRow = mask.getAddrLCD32(x, y);
 
     do {
-        blit_lcd32_opaque(dstRow, srcRow, srcColor, width);
+        proc(dstRow, srcRow, srcColor, width);
         dstRow = (SkPMColor*)((char*)dstRow + device.rowBytes());
         srcRow = (const uint32_t*)((const char*)srcRow + mask.fRowBytes);
     } while (--height != 0);
@@ -187,6 +117,7 @@ SkARGB32_Blitter::SkARGB32_Blitter(const SkBitmap& device, const SkPaint& paint)
 
     fPMColor = SkPackARGB32(fSrcA, fSrcR, fSrcG, fSrcB);
     fColor32Proc = SkBlitRow::ColorProcFactory();
+    fColorAAProc = SkBlitRow::ColorAAProcFactory();
 
     // init the pro for blitmask
     fBlitMaskProc = SkBlitMask::Factory(SkBitmap::kARGB_8888_Config, color);
@@ -228,6 +159,19 @@ void SkARGB32_Blitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         if (count <= 0) {
             return;
         }
+        if (1 == count) {
+            // antialiased edges arrive as a series of 1-pixel runs, whose
+            // coverage values are contiguous, so blend them all at once
+            int n = 1;
+            while (1 == runs[n]) {
+                n += 1;
+            }
+            fColorAAProc(device, antialias, n, color);
+            runs += n;
+            antialias += n;
+            device += n;
+            continue;
+        }
         unsigned aa = antialias[0];
         if (aa) {
             if ((opaqueMask & aa) == 255) {
@@ -342,6 +286,24 @@ void SkARGB32_Opaque_Blitter::blitMask(const SkMask& mask,
                   mask.getAddr(x, y), mask.fRowBytes, fColor, width, height);
 }
 
+// the qualified calls skip the virtual dispatch for each glyph
+void SkARGB32_Blitter::blitMasks(const SkMask masks[], const SkIRect clips[],
+                                 int count) {
+    if (0 == fSrcA) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        this->SkARGB32_Blitter::blitMask(masks[i], clips[i]);
+    }
+}
+
+void SkARGB32_Opaque_Blitter::blitMasks(const SkMask masks[],
+                                        const SkIRect clips[], int count) {
+    for (int i = 0; i < count; i++) {
+        this->SkARGB32_Opaque_Blitter::blitMask(masks[i], clips[i]);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////
 
 void SkARGB32_Blitter::blitV(int x, int y, int height, SkAlpha alpha) {
@@ -383,6 +345,10 @@ void SkARGB32_Blitter::blitRect(int x, int y, int width, int height) {
     uint32_t    color = fPMColor;
     size_t      rowBytes = fDevice.rowBytes();
 
+    if (255 == fSrcA) {
+        sk_memset_rect32(device, color, width, height, rowBytes);
+        return;
+    }
     while (--height >= 0) {
         fColor32Proc(device, device, width, color);
         device = (uint32_t*)((char*)device + rowBytes);
@@ -432,6 +398,13 @@ void SkARGB32_Black_Blitter::blitMask(const SkMask& mask, const SkIRect& clip) {
     }
 }
 
+void SkARGB32_Black_Blitter::blitMasks(const SkMask masks[],
+                                       const SkIRect clips[], int count) {
+    for (int i = 0; i < count; i++) {
+        this->SkARGB32_Black_Blitter::blitMask(masks[i], clips[i]);
+    }
+}
+
 void SkARGB32_Black_Blitter::blitAntiH(int x, int y, const SkAlpha antialias[],
                                        const int16_t runs[]) {
     uint32_t*   device = fDevice.getAddr32(x, y);
@@ -443,6 +416,20 @@ void SkARGB32_Black_Blitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         if (count <= 0) {
             return;
         }
+        if (1 == count) {
+            // a series of 1-pixel runs is just a row of coverage, which the
+            // mask proc blends the same way as the loop below
+            int n = 1;
+            while (1 == runs[n]) {
+                n += 1;
+            }
+            fBlitMaskProc(device, n << 2, SkBitmap::kARGB_8888_Config,
+                          antialias, n, SK_ColorBLACK, n, 1);
+            runs += n;
+            antialias += n;
+            device += n;
+            continue;
+        }
         unsigned aa = antialias[0];
         if (aa) {
             if (aa == 255) {
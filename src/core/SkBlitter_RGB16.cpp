@@ -69,6 +69,7 @@ public:
     virtual void blitRect(int x, int y, int width, int height);
     virtual void blitMask(const SkMask&,
                           const SkIRect&);
+    virtual void blitMasks(const SkMask[], const SkIRect[], int count);
     virtual const SkBitmap* justAnOpaqueColor(uint32_t*);
     
 protected:
@@ -79,6 +80,9 @@ protected:
     uint16_t    fRawColor16;    // unscaled
     uint16_t    fRawDither16;   // unscaled
     SkBool8     fDoDither;
+    SkColor     fColor;
+    // the platform's version of blitMask for A8 masks, or NULL
+    SkBlitMask::Proc fBlitMaskProc;
     
     // illegal
     SkRGB16_Blitter& operator=(const SkRGB16_Blitter&);
@@ -96,6 +100,7 @@ public:
     virtual void blitRect(int x, int y, int width, int height);
     virtual void blitMask(const SkMask&,
                           const SkIRect&);
+    virtual void blitMasks(const SkMask[], const SkIRect[], int count);
     
 private:
     typedef SkRGB16_Blitter INHERITED;
@@ -106,6 +111,7 @@ class SkRGB16_Black_Blitter : public SkRGB16_Opaque_Blitter {
 public:
     SkRGB16_Black_Blitter(const SkBitmap& device, const SkPaint& paint);
     virtual void blitMask(const SkMask&, const SkIRect&);
+    virtual void blitMasks(const SkMask[], const SkIRect[], int count);
     virtual void blitAntiH(int x, int y, const SkAlpha* antialias,
                            const int16_t* runs);
     
@@ -240,6 +246,13 @@ void SkRGB16_Black_Blitter::blitMask(const SkMask& SK_RESTRICT mask,
     }
 }
 
+void SkRGB16_Black_Blitter::blitMasks(const SkMask masks[],
+                                      const SkIRect clips[], int count) {
+    for (int i = 0; i < count; i++) {
+        this->SkRGB16_Black_Blitter::blitMask(masks[i], clips[i]);
+    }
+}
+
 void SkRGB16_Black_Blitter::blitAntiH(int x, int y,
                                       const SkAlpha* SK_RESTRICT antialias,
                                       const int16_t* SK_RESTRICT runs) {
@@ -389,6 +402,13 @@ void SkRGB16_Opaque_Blitter::blitMask(const SkMask& SK_RESTRICT mask,
     const uint8_t* SK_RESTRICT alpha = mask.getAddr(clip.fLeft, clip.fTop);
     int width = clip.width();
     int height = clip.height();
+
+    if (fBlitMaskProc) {
+        fBlitMaskProc(device, fDevice.rowBytes(), SkBitmap::kRGB_565_Config,
+                      alpha, mask.fRowBytes, fColor, width, height);
+        return;
+    }
+
     unsigned    deviceRB = fDevice.rowBytes() - (width << 1);
     unsigned    maskRB = mask.fRowBytes - width;
     uint32_t    expanded32 = fExpandedRaw16;
@@ -487,6 +507,13 @@ void SkRGB16_Opaque_Blitter::blitMask(const SkMask& SK_RESTRICT mask,
 #endif
 }
 
+void SkRGB16_Opaque_Blitter::blitMasks(const SkMask masks[],
+                                       const SkIRect clips[], int count) {
+    for (int i = 0; i < count; i++) {
+        this->SkRGB16_Opaque_Blitter::blitMask(masks[i], clips[i]);
+    }
+}
+
 void SkRGB16_Opaque_Blitter::blitV(int x, int y, int height, SkAlpha alpha) {
     uint16_t* SK_RESTRICT device = fDevice.getAddr16(x, y);
     unsigned    deviceRB = fDevice.rowBytes();
@@ -519,10 +546,7 @@ void SkRGB16_Opaque_Blitter::blitRect(int x, int y, int width, int height) {
             device = (uint16_t*)((char*)device + deviceRB);
         }
     } else {  // no dither
-        while (--height >= 0) {
-            sk_memset16(device, color16, width);
-            device = (uint16_t*)((char*)device + deviceRB);
-        }
+        sk_memset_rect16(device, color16, width, height, deviceRB);
     }
 }
 
@@ -550,6 +574,11 @@ SkRGB16_Blitter::SkRGB16_Blitter(const SkBitmap& device, const SkPaint& paint)
     fColor16 = SkPackRGB16( SkAlphaMul(r, fScale) >> (8 - SK_R16_BITS),
                             SkAlphaMul(g, fScale) >> (8 - SK_G16_BITS),
                             SkAlphaMul(b, fScale) >> (8 - SK_B16_BITS));
+
+    // the portable blitMask is ours, so only take the platform's
+    fColor = color;
+    fBlitMaskProc = SkBlitMask::PlatformProcs(SkBitmap::kRGB_565_Config,
+                                              color);
 }
 
 const SkBitmap* SkRGB16_Blitter::justAnOpaqueColor(uint32_t* value) {
@@ -649,6 +678,13 @@ void SkRGB16_Blitter::blitMask(const SkMask& SK_RESTRICT mask,
     const uint8_t* SK_RESTRICT alpha = mask.getAddr(clip.fLeft, clip.fTop);
     int width = clip.width();
     int height = clip.height();
+
+    if (fBlitMaskProc) {
+        fBlitMaskProc(device, fDevice.rowBytes(), SkBitmap::kRGB_565_Config,
+                      alpha, mask.fRowBytes, fColor, width, height);
+        return;
+    }
+
     unsigned    deviceRB = fDevice.rowBytes() - (width << 1);
     unsigned    maskRB = mask.fRowBytes - width;
     uint32_t    color32 = fExpandedRaw16;
@@ -668,6 +704,13 @@ void SkRGB16_Blitter::blitMask(const SkMask& SK_RESTRICT mask,
     } while (--height != 0);
 }
 
+void SkRGB16_Blitter::blitMasks(const SkMask masks[],
+                                const SkIRect clips[], int count) {
+    for (int i = 0; i < count; i++) {
+        this->SkRGB16_Blitter::blitMask(masks[i], clips[i]);
+    }
+}
+
 void SkRGB16_Blitter::blitV(int x, int y, int height, SkAlpha alpha) {
     uint16_t* SK_RESTRICT device = fDevice.getAddr16(x, y);
     unsigned    deviceRB = fDevice.rowBytes();
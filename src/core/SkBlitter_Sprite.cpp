@@ -16,6 +16,9 @@
 */
 
 #include "SkSpriteBlitter.h"
+#include "SkColorPriv.h"
+#include "SkPackBits.h"
+#include "SkUtils.h"
 
 SkSpriteBlitter::SkSpriteBlitter(const SkBitmap& source)
         : fSource(&source) {
@@ -34,6 +37,53 @@ void SkSpriteBlitter::setup(const SkBitmap& device, int left, int top,
     fPaint = &paint;
 }
 
+void SkSpriteBlitter::convertRow(SkPMColor* SK_RESTRICT dst, int x, int y,
+                                 int count,
+                                 const SkPMColor* SK_RESTRICT ctable,
+                                 unsigned scale) const {
+    SkASSERT(count > 0);
+
+    switch (fSource->config()) {
+        case SkBitmap::kARGB_8888_Config:
+            memcpy(dst, fSource->getAddr32(x, y), count << 2);
+            break;
+        case SkBitmap::kRGB_565_Config:
+            sk_pixel16_to_pixel32(dst, fSource->getAddr16(x, y), count);
+            break;
+        case SkBitmap::kARGB_4444_Config: {
+            const SkPMColor16* SK_RESTRICT src = fSource->getAddr16(x, y);
+            for (int i = 0; i < count; i++) {
+                dst[i] = SkPixel4444ToPixel32(src[i]);
+            }
+            break;
+        }
+        case SkBitmap::kIndex8_Config: {
+            SkASSERT(ctable);
+            const uint8_t* SK_RESTRICT src = fSource->getAddr8(x, y);
+            for (int i = 0; i < count; i++) {
+                dst[i] = ctable[src[i]];
+            }
+            break;
+        }
+        case SkBitmap::kRLE_Index8_Config: {
+            SkASSERT(ctable);
+            const SkBitmap::RLEPixels* rle =
+                                (const SkBitmap::RLEPixels*)fSource->getPixels();
+            SkPackBits::Unpack8To32(dst, x, count, rle->packedAtY(y), ctable);
+            break;
+        }
+        default:
+            SkASSERT(!"unexpected source config");
+            return;
+    }
+
+    if (scale < 256) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = SkAlphaMulQ(dst[i], scale);
+        }
+    }
+}
+
 #ifdef SK_DEBUG
 void SkSpriteBlitter::blitH(int x, int y, int width) {
     SkASSERT(!"how did we get here?");
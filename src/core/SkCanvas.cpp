@@ -22,9 +22,12 @@
 #include "SkDrawLooper.h"
 #include "SkPicture.h"
 #include "SkScalarCompare.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkTextBlob.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
+#include "SkXfermode.h"
 #include <new>
 
 //#define SK_TRACE_SAVERESTORE
@@ -73,6 +76,7 @@ struct DeviceCM {
     DeviceCM*           fNext;
     SkDevice*           fDevice;
     SkRegion            fClip;
+    const SkMask*       fClipMask;  // null unless the clip is antialiased
     const SkMatrix*     fMatrix;
     SkPaint*            fPaint; // may be null (in the future)
     // optional, related to canvas' external matrix
@@ -80,7 +84,7 @@ struct DeviceCM {
     const SkMatrix*     fExtMatrix;
 
 	DeviceCM(SkDevice* device, int x, int y, const SkPaint* paint)
-            : fNext(NULL) {
+            : fNext(NULL), fClipMask(NULL) {
         if (NULL != device) {
             device->ref();
             device->lockPixels();
@@ -98,7 +102,8 @@ struct DeviceCM {
 	}
 
     void updateMC(const SkMatrix& totalMatrix, const SkRegion& totalClip,
-                  const SkClipStack& clipStack, SkRegion* updateClip) {
+                  const SkMask* totalClipMask, const SkClipStack& clipStack,
+                  SkRegion* updateClip) {
         int x = fDevice->getOrigin().x();
         int y = fDevice->getOrigin().y();
         int width = fDevice->width();
@@ -107,6 +112,7 @@ struct DeviceCM {
         if ((x | y) == 0) {
             fMatrix = &totalMatrix;
             fClip = totalClip;
+            fClipMask = totalClipMask;
         } else {
             fMatrixStorage = totalMatrix;
             fMatrixStorage.postTranslate(SkIntToScalar(-x),
@@ -114,6 +120,14 @@ struct DeviceCM {
             fMatrix = &fMatrixStorage;
 
             totalClip.translate(-x, -y, &fClip);
+
+            // the same pixels, just with offset bounds
+            fClipMask = NULL;
+            if (totalClipMask) {
+                fClipMaskStorage = *totalClipMask;
+                fClipMaskStorage.fBounds.offset(-x, -y);
+                fClipMask = &fClipMaskStorage;
+            }
         }
 
         fClip.op(0, 0, width, height, SkRegion::kIntersect_Op);
@@ -148,6 +162,358 @@ struct DeviceCM {
 
 private:
     SkMatrix    fMatrixStorage, fMVMatrixStorage;
+    SkMask      fClipMaskStorage;
+};
+
+static bool clipPathHelper(const SkCanvas* canvas, SkRegion* currRgn,
+                           const SkPath& devPath, SkRegion::Op op);
+
+// Combine the coverage of one element of a clip stack into what the elements
+// before it cover, like SkRegion::Op does for regions.
+static void clip_mask_op(uint8_t* dst, const uint8_t* src, size_t count,
+                         SkRegion::Op op) {
+    for (size_t i = 0; i < count; ++i) {
+        unsigned a = dst[i];
+        unsigned b = src[i];
+        switch (op) {
+            case SkRegion::kDifference_Op:
+                dst[i] = SkMulDiv255Round(a, 255 - b);
+                break;
+            case SkRegion::kIntersect_Op:
+                dst[i] = SkMulDiv255Round(a, b);
+                break;
+            case SkRegion::kUnion_Op:
+                dst[i] = a + b - SkMulDiv255Round(a, b);
+                break;
+            case SkRegion::kXOR_Op:
+                dst[i] = a + b - 2 * SkMulDiv255Round(a, b);
+                break;
+            case SkRegion::kReverseDifference_Op:
+                dst[i] = SkMulDiv255Round(b, 255 - a);
+                break;
+            case SkRegion::kReplace_Op:
+                dst[i] = b;
+                break;
+        }
+    }
+}
+
+/*  Build the A8 coverage of the clip stack within bounds (in device
+    coordinates), drawing each element with or without antialiasing the way
+    it was clipped. Rects are rounded, as they are for the region.
+ */
+static void build_clip_mask(const SkClipStack& stack, const SkIRect& bounds,
+                            SkMask* mask) {
+    mask->fBounds = bounds;
+    mask->fRowBytes = bounds.width();
+    mask->fFormat = SkMask::kA8_Format;
+    size_t size = mask->computeImageSize();
+    mask->fImage = SkMask::AllocImage(size);
+    memset(mask->fImage, 0xFF, size);
+
+    // each element is drawn into its own mask, then combined
+    SkAutoMalloc storage(size);
+    uint8_t* elemImage = (uint8_t*)storage.get();
+    SkBitmap elem;
+    elem.setConfig(SkBitmap::kA8_Config, bounds.width(), bounds.height(),
+                   mask->fRowBytes);
+    elem.setPixels(elemImage);
+
+    SkMatrix matrix;
+    matrix.setTranslate(-SkIntToScalar(bounds.fLeft),
+                        -SkIntToScalar(bounds.fTop));
+    SkRegion clip(SkIRect::MakeWH(bounds.width(), bounds.height()));
+    SkDraw draw;
+    draw.fBitmap = &elem;
+    draw.fMatrix = &matrix;
+    draw.fClip = &clip;
+    SkPaint paint;
+
+    SkClipStack::B2FIter iter(stack);
+    const SkClipStack::B2FIter::Clip* element;
+    while ((element = iter.next()) != NULL) {
+        memset(elemImage, 0, size);
+        if (element->fPath) {
+            paint.setAntiAlias(element->fDoAA);
+            draw.drawPath(*element->fPath, paint);
+        } else if (element->fRect) {
+            SkIRect ir;
+            element->fRect->round(&ir);
+            ir.offset(-bounds.fLeft, -bounds.fTop);
+            if (ir.intersect(0, 0, bounds.width(), bounds.height())) {
+                for (int y = ir.fTop; y < ir.fBottom; ++y) {
+                    memset(elemImage + y * mask->fRowBytes + ir.fLeft, 0xFF,
+                           ir.width());
+                }
+            }
+        }
+        clip_mask_op(mask->fImage, elemImage, size, element->fOp);
+    }
+}
+
+/*  The clip for a save/restore level. Scan converting a path into a region is
+    expensive, and clips are often restored before anything is drawn through
+    them, so paths that are intersected with the clip are kept in a list, and
+    only applied to the region when someone asks for it. Intersections can be
+    done in any order, so rects and regions that intersect are still applied
+    to the region right away; any other op applies the paths first.
+
+    bounds() (and therefore isEmpty()) is exact once the paths are applied,
+    and never smaller than the clip before that, so it is enough for quick
+    rejects.
+
+    Antialiased paths aren't scan converted into the region at all. Once
+    there is one in the clip, the region only bounds what the clip covers,
+    and the coverage itself is an A8 mask, built from the clip stack the first
+    time something is drawn through the clip.
+
+    The path list and the mask are shared (and never changed) by copies, and
+    SkRegion copies share their runs, so copying the clip for a save is cheap
+    until one of the copies is changed.
+ */
+class ClipRec {
+public:
+    ClipRec() : fPaths(NULL), fMask(NULL), fNeedsMask(false) {
+        fBounds.setEmpty();
+    }
+    ClipRec(const ClipRec& src)
+            : fRegion(src.fRegion), fPaths(src.fPaths), fBounds(src.fBounds),
+              fMask(src.fMask), fNeedsMask(src.fNeedsMask) {
+        SkSafeRef(fPaths);
+        SkSafeRef(fMask);
+    }
+    ~ClipRec() {
+        SkSafeUnref(fPaths);
+        SkSafeUnref(fMask);
+    }
+
+    ClipRec& operator=(const ClipRec& src) {
+        SkRefCnt_SafeAssign(fPaths, src.fPaths);
+        SkRefCnt_SafeAssign(fMask, src.fMask);
+        fRegion = src.fRegion;
+        fBounds = src.fBounds;
+        fNeedsMask = src.fNeedsMask;
+        return *this;
+    }
+
+    bool isEmpty() const { return fBounds.isEmpty(); }
+    const SkIRect& bounds() const { return fBounds; }
+
+    const SkRegion& region() {
+        if (fPaths) {
+            this->applyPaths();
+        }
+        return fRegion;
+    }
+
+    /*  Returns the coverage of the clip (in device coordinates) if it has
+        antialiased edges, and NULL if the region is the clip. The stack must
+        be the canvas' clip stack, which matches this clip.
+     */
+    const SkMask* mask(const SkClipStack& stack) {
+        if (!fNeedsMask || this->region().isEmpty()) {
+            return NULL;
+        }
+        if (NULL == fMask) {
+            fMask = SkNEW(Mask);
+            build_clip_mask(stack, fRegion.getBounds(), &fMask->fMask);
+        }
+        return &fMask->fMask;
+    }
+
+    bool setEmpty() {
+        this->resetPaths();
+        this->resetMask(SkRegion::kReplace_Op);
+        fRegion.setEmpty();
+        return this->updateBounds();
+    }
+
+    bool setRect(const SkIRect& r) {
+        this->resetPaths();
+        this->resetMask(SkRegion::kReplace_Op);
+        fRegion.setRect(r);
+        return this->updateBounds();
+    }
+
+    bool op(const SkIRect& r, SkRegion::Op op) {
+        op = this->resetMask(op);
+        if (fPaths && SkRegion::kIntersect_Op == op) {
+            if (!fRegion.op(r, op) || !fBounds.intersect(r)) {
+                return this->setEmpty();
+            }
+            return true;
+        }
+        this->prepareForOp(op);
+        fRegion.op(r, op);
+        return this->updateBounds();
+    }
+
+    bool op(const SkRegion& rgn, SkRegion::Op op) {
+        op = this->resetMask(op);
+        if (fPaths && SkRegion::kIntersect_Op == op) {
+            if (!fRegion.op(rgn, op) || !fBounds.intersect(rgn.getBounds())) {
+                return this->setEmpty();
+            }
+            return true;
+        }
+        this->prepareForOp(op);
+        fRegion.op(rgn, op);
+        return this->updateBounds();
+    }
+
+    /*  Intersecting (or replacing the clip with) devPath is deferred, and an
+        antialiased devPath only goes into the region as its bounds, so the
+        result only says that the clip is not known to be empty.
+     */
+    bool opPath(const SkCanvas* canvas, const SkPath& devPath,
+                SkRegion::Op op, bool doAA) {
+        op = this->resetMask(op);
+        if (doAA) {
+            return this->opAntiAliasedPath(canvas, devPath, op);
+        }
+        if (SkRegion::kReplace_Op == op) {
+            this->resetRegionToDevice(canvas);
+        } else if (SkRegion::kIntersect_Op != op) {
+            this->prepareForOp(op);
+            clipPathHelper(canvas, &fRegion, devPath, op);
+            return this->updateBounds();
+        }
+        if (this->isEmpty()) {
+            return false;
+        }
+
+        PathRec* rec = SkNEW_ARGS(PathRec, (devPath, fPaths));
+        fPaths = rec;   // takes over our ref on the old head
+
+        if (!devPath.isInverseFillType()) {
+            SkIRect ir;
+            devPath.getBounds().roundOut(&ir);
+            if (!fBounds.intersect(ir)) {
+                return this->setEmpty();
+            }
+        }
+        return true;
+    }
+
+private:
+    struct PathRec : public SkRefCnt {
+        PathRec(const SkPath& path, PathRec* next)
+            : fPath(path), fNext(next) {}
+        virtual ~PathRec() { SkSafeUnref(fNext); }
+
+        SkPath      fPath;
+        PathRec*    fNext;  // the paths intersected before this one
+    };
+
+    struct Mask : public SkRefCnt {
+        Mask() { fMask.fImage = NULL; }
+        virtual ~Mask() { SkMask::FreeImage(fMask.fImage); }
+
+        SkMask  fMask;
+    };
+
+    SkRegion    fRegion;
+    PathRec*    fPaths;     // newest first, or NULL
+    SkIRect     fBounds;
+    Mask*       fMask;      // built when first needed
+    bool        fNeedsMask; // the clip has antialiased edges
+
+    void resetPaths() {
+        SkSafeUnref(fPaths);
+        fPaths = NULL;
+    }
+
+    /*  Called before the clip is changed by op. Drops the mask, which no
+        longer matches, and returns the op to apply to the region. While the
+        clip has antialiased edges, the region is larger than what the clip
+        covers, so ops that would remove what the region and their argument
+        have in common are made to keep it.
+     */
+    SkRegion::Op resetMask(SkRegion::Op op) {
+        SkSafeUnref(fMask);
+        fMask = NULL;
+        if (SkRegion::kReplace_Op == op) {
+            fNeedsMask = false;
+        } else if (fNeedsMask) {
+            if (SkRegion::kXOR_Op == op) {
+                op = SkRegion::kUnion_Op;
+            } else if (SkRegion::kReverseDifference_Op == op) {
+                this->resetPaths();
+                op = SkRegion::kReplace_Op;
+            }
+        }
+        return op;
+    }
+
+    bool opAntiAliasedPath(const SkCanvas* canvas, const SkPath& devPath,
+                           SkRegion::Op op) {
+        SkIRect ir;
+        if (devPath.isInverseFillType()) {
+            const SkDevice* device = canvas->getDevice();
+            ir.set(0, 0, device->width(), device->height());
+        } else {
+            devPath.getBounds().roundOut(&ir);
+        }
+        fNeedsMask = true;
+
+        switch (op) {
+            case SkRegion::kDifference_Op:
+                // the region still bounds what is left
+                return !this->isEmpty();
+            case SkRegion::kXOR_Op:
+                op = SkRegion::kUnion_Op;
+                break;
+            case SkRegion::kReverseDifference_Op:
+                op = SkRegion::kReplace_Op;
+                break;
+            default:
+                break;
+        }
+        if (SkRegion::kReplace_Op == op) {
+            this->resetPaths();
+            fRegion.setRect(ir);
+            return this->updateBounds();
+        }
+        return this->op(ir, op);
+    }
+
+    void resetRegionToDevice(const SkCanvas* canvas) {
+        // just the size, so don't force a deferring device to flush
+        const SkDevice* device = canvas->getDevice();
+        this->resetPaths();
+        fRegion.setRect(0, 0, device->width(), device->height());
+        this->updateBounds();
+    }
+
+    void prepareForOp(SkRegion::Op op) {
+        if (SkRegion::kReplace_Op == op) {
+            this->resetPaths();
+        } else if (fPaths) {
+            this->applyPaths();
+        }
+    }
+
+    void applyPaths() {
+        // Scan converting against a different clip can change the edge
+        // pixels slightly, so apply them in the order they were clipped with.
+        SkTDArray<const PathRec*> recs;
+        for (const PathRec* rec = fPaths; rec; rec = rec->fNext) {
+            *recs.append() = rec;
+        }
+        for (int i = recs.count() - 1; i >= 0; --i) {
+            if (!clipPathHelper(NULL, &fRegion, recs[i]->fPath,
+                                SkRegion::kIntersect_Op)) {
+                break;
+            }
+        }
+        this->resetPaths();
+        this->updateBounds();
+    }
+
+    bool updateBounds() {
+        fBounds = fRegion.getBounds();
+        return !fBounds.isEmpty();
+    }
 };
 
 /*  This is the record we keep for each save/restore level in the stack.
@@ -161,7 +527,7 @@ class SkCanvas::MCRec {
 public:
     MCRec*          fNext;
     SkMatrix*       fMatrix;    // points to either fMatrixStorage or prev MCRec
-    SkRegion*       fRegion;    // points to either fRegionStorage or prev MCRec
+    ClipRec*        fClip;      // points to either fClipStorage or prev MCRec
     SkDrawFilter*   fFilter;    // the current filter (or null)
 
     DeviceCM*   fLayer;
@@ -183,10 +549,10 @@ public:
             }
 
             if (flags & SkCanvas::kClip_SaveFlag) {
-                fRegionStorage = *prev->fRegion;
-                fRegion = &fRegionStorage;
+                fClipStorage = *prev->fClip;
+                fClip = &fClipStorage;
             } else {
-                fRegion = prev->fRegion;
+                fClip = prev->fClip;
             }
 
             fFilter = prev->fFilter;
@@ -197,7 +563,7 @@ public:
             fMatrixStorage.reset();
 
             fMatrix     = &fMatrixStorage;
-            fRegion     = &fRegionStorage;
+            fClip       = &fClipStorage;
             fFilter     = NULL;
             fTopLayer   = NULL;
         }
@@ -214,7 +580,7 @@ public:
 
 private:
     SkMatrix    fMatrixStorage;
-    SkRegion    fRegionStorage;
+    ClipRec     fClipStorage;
 };
 
 class SkDrawIter : public SkDraw {
@@ -225,6 +591,7 @@ public:
 
         fClipStack = &canvas->getTotalClipStack();
         fBounder = canvas->getBounder();
+        fExecutor = canvas->getExecutor();
         fCurrLayer = canvas->fMCRec->fTopLayer;
         fSkipEmptyClips = skipEmptyClips;
     }
@@ -242,8 +609,9 @@ public:
 
             fMatrix = rec->fMatrix;
             fClip   = &rec->fClip;
+            fClipMask = rec->fClipMask;
             fDevice = rec->fDevice;
-            fBitmap = &fDevice->accessBitmap(true);
+            fBitmap = &fDevice->accessBitmapForDraw();
             fPaint  = rec->fPaint;
             fMVMatrix = rec->fMVMatrix;
             fExtMatrix = rec->fExtMatrix;
@@ -398,10 +766,12 @@ private:
 
 SkDevice* SkCanvas::init(SkDevice* device) {
     fBounder = NULL;
+    fExecutor = NULL;
     fLocalBoundsCompareType.setEmpty();
     fLocalBoundsCompareTypeDirty = true;
     fLocalBoundsCompareTypeBW.setEmpty();
     fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
     fLastDeviceToGainFocus = NULL;
     fDeviceCMDirty = false;
 
@@ -522,6 +892,9 @@ SkDevice* SkCanvas::setDevice(SkDevice* device) {
     rootDevice = device;
 
     fDeviceCMDirty = true;
+    fLocalBoundsCompareTypeDirty = true;
+    fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
 
     /*  Now we update our initial region to have the bounds of the new device,
         and then intersect all of the clips in our stack with these bounds,
@@ -538,9 +911,9 @@ SkDevice* SkCanvas::setDevice(SkDevice* device) {
     */
 
     if (NULL == device) {
-        rec->fRegion->setEmpty();
+        rec->fClip->setEmpty();
         while ((rec = (MCRec*)iter.next()) != NULL) {
-            (void)rec->fRegion->setEmpty();
+            (void)rec->fClip->setEmpty();
         }
         fClipStack.reset();
     } else {
@@ -550,9 +923,9 @@ SkDevice* SkCanvas::setDevice(SkDevice* device) {
         bounds.set(0, 0, device->width(), device->height());
 
         // now jam our 1st clip to be bounds, and intersect the rest with that
-        rec->fRegion->setRect(bounds);
+        rec->fClip->setRect(bounds);
         while ((rec = (MCRec*)iter.next()) != NULL) {
-            (void)rec->fRegion->op(bounds, SkRegion::kIntersect_Op);
+            (void)rec->fClip->op(bounds, SkRegion::kIntersect_Op);
         }
         fClipStack.clipDevRect(bounds, SkRegion::kIntersect_Op);
     }
@@ -603,10 +976,12 @@ void SkCanvas::updateDeviceCMCache() {
     if (fDeviceCMDirty) {
         const SkMatrix& totalMatrix = this->getTotalMatrix();
         const SkRegion& totalClip = this->getTotalClip();
+        const SkMask*   totalClipMask = fMCRec->fClip->mask(fClipStack);
         DeviceCM*       layer = fMCRec->fTopLayer;
 
         if (NULL == layer->fNext) {   // only one layer
-            layer->updateMC(totalMatrix, totalClip, fClipStack, NULL);
+            layer->updateMC(totalMatrix, totalClip, totalClipMask, fClipStack,
+                            NULL);
             if (fUseExternalMatrix) {
                 layer->updateExternalMatrix(fExternalMatrix,
                                             fExternalInverse);
@@ -615,7 +990,8 @@ void SkCanvas::updateDeviceCMCache() {
             SkRegion clip;
             clip = totalClip;  // make a copy
             do {
-                layer->updateMC(totalMatrix, clip, fClipStack, &clip);
+                layer->updateMC(totalMatrix, clip, totalClipMask, fClipStack,
+                                &clip);
                 if (fUseExternalMatrix) {
                     layer->updateExternalMatrix(fExternalMatrix,
                                                 fExternalInverse);
@@ -702,6 +1078,17 @@ static bool bounds_affects_clip(SkCanvas::SaveFlags flags) {
     return (flags & SkCanvas::kClipToLayer_SaveFlag) != 0;
 }
 
+// true if a layer drawn with paint cannot change the pixels under it
+static bool hides_layer(const SkPaint* paint) {
+    if (NULL == paint || 0 != paint->getAlpha()) {
+        return false;
+    }
+    SkXfermode::Mode mode;
+    return SkXfermode::AsMode(paint->getXfermode(), &mode) &&
+           SkXfermode::kSrcOver_Mode == mode &&
+           NULL == paint->getColorFilter() && NULL == paint->getLooper();
+}
+
 int SkCanvas::saveLayer(const SkRect* bounds, const SkPaint* paint,
                         SaveFlags flags) {
     // do this before we create the layer. We don't call the public save() since
@@ -709,6 +1096,15 @@ int SkCanvas::saveLayer(const SkRect* bounds, const SkPaint* paint,
     int count = this->internalSave(flags);
 
     fDeviceCMDirty = true;
+    fLocalBoundsCompareTypeDirty = true;
+    fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
+
+    // nothing drawn into a fully transparent layer will show, so skip it all
+    if (hides_layer(paint)) {
+        fMCRec->fClip->setEmpty();
+        return count;
+    }
 
     SkIRect         ir;
     const SkIRect&  clipBounds = this->getTotalClip().getBounds();
@@ -724,7 +1120,7 @@ int SkCanvas::saveLayer(const SkRect* bounds, const SkPaint* paint,
         // early exit if the layer's bounds are clipped out
         if (!ir.intersect(clipBounds)) {
             if (bounds_affects_clip(flags))
-                fMCRec->fRegion->setEmpty();
+                fMCRec->fClip->setEmpty();
             return count;
         }
     } else {    // no user bounds, so just use the clip
@@ -734,7 +1130,7 @@ int SkCanvas::saveLayer(const SkRect* bounds, const SkPaint* paint,
     fClipStack.clipDevRect(ir, SkRegion::kIntersect_Op);
     // early exit if the clip is now empty
     if (bounds_affects_clip(flags) &&
-        !fMCRec->fRegion->op(ir, SkRegion::kIntersect_Op)) {
+        !fMCRec->fClip->op(ir, SkRegion::kIntersect_Op)) {
         return count;
     }
 
@@ -779,6 +1175,7 @@ void SkCanvas::internalRestore() {
     fDeviceCMDirty = true;
     fLocalBoundsCompareTypeDirty = true;
     fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
 
     fClipStack.restore();
 	// reserve our layer (if any)
@@ -924,6 +1321,7 @@ bool SkCanvas::clipRect(const SkRect& rect, SkRegion::Op op) {
     fDeviceCMDirty = true;
     fLocalBoundsCompareTypeDirty = true;
     fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
 
     if (fMCRec->fMatrix->rectStaysRect()) {
         // for these simpler matrices, we can stay a rect ever after applying
@@ -936,7 +1334,7 @@ bool SkCanvas::clipRect(const SkRect& rect, SkRegion::Op op) {
         fMCRec->fMatrix->mapRect(&r, rect);
         fClipStack.clipDevRect(r, op);
         r.round(&ir);
-        return fMCRec->fRegion->op(ir, op);
+        return fMCRec->fClip->op(ir, op);
     } else {
         // since we're rotate or some such thing, we convert the rect to a path
         // and clip against that, since it can handle any matrix. However, to
@@ -968,8 +1366,9 @@ static bool clipPathHelper(const SkCanvas* canvas, SkRegion* currRgn,
             return currRgn->op(rgn, op);
         }
     } else {
-        const SkBitmap& bm = canvas->getDevice()->accessBitmap(false);
-        base.setRect(0, 0, bm.width(), bm.height());
+        // just the size, so don't force a deferring device to flush
+        const SkDevice* device = canvas->getDevice();
+        base.setRect(0, 0, device->width(), device->height());
 
         if (SkRegion::kReplace_Op == op) {
             return currRgn->setPath(devPath, base);
@@ -981,20 +1380,22 @@ static bool clipPathHelper(const SkCanvas* canvas, SkRegion* currRgn,
     }
 }
 
-bool SkCanvas::clipPath(const SkPath& path, SkRegion::Op op) {
+bool SkCanvas::clipPath(const SkPath& path, SkRegion::Op op,
+                        bool doAntiAlias) {
     AutoValidateClip avc(this);
 
     fDeviceCMDirty = true;
     fLocalBoundsCompareTypeDirty = true;
     fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
 
     SkPath devPath;
     path.transform(*fMCRec->fMatrix, &devPath);
 
     // if we called path.swap() we could avoid a deep copy of this path
-    fClipStack.clipDevPath(devPath, op);
+    fClipStack.clipDevPath(devPath, op, doAntiAlias);
 
-    return clipPathHelper(this, fMCRec->fRegion, devPath, op);
+    return fMCRec->fClip->opPath(this, devPath, op, doAntiAlias);
 }
 
 bool SkCanvas::clipRegion(const SkRegion& rgn, SkRegion::Op op) {
@@ -1003,12 +1404,13 @@ bool SkCanvas::clipRegion(const SkRegion& rgn, SkRegion::Op op) {
     fDeviceCMDirty = true;
     fLocalBoundsCompareTypeDirty = true;
     fLocalBoundsCompareTypeDirtyBW = true;
+    fDeviceClipBoundsDirty = true;
 
     // todo: signal fClipStack that we have a region, and therefore (I guess)
     // we have to ignore it, and use the region directly?
     fClipStack.clipDevRect(rgn.getBounds());
 
-    return fMCRec->fRegion->op(rgn, op);
+    return fMCRec->fClip->op(rgn, op);
 }
 
 #ifdef SK_DEBUG
@@ -1061,21 +1463,60 @@ void SkCanvas::computeLocalClipBoundsCompareType(EdgeType et) const {
     getLocalClipBoundsCompareType(), which always returns a value assuming
     antialiasing (worst case)
  */
+void SkCanvas::computeDeviceClipBounds() const {
+    const SkIRect& ibounds = fMCRec->fClip->bounds();
+    fDeviceClipBoundsBW.set(SkIntToScalar(ibounds.fLeft),
+                            SkIntToScalar(ibounds.fTop),
+                            SkIntToScalar(ibounds.fRight),
+                            SkIntToScalar(ibounds.fBottom));
+    // adjust it outwards for antialiasing
+    fDeviceClipBounds = fDeviceClipBoundsBW;
+    fDeviceClipBounds.inset(-SK_Scalar1, -SK_Scalar1);
+}
+
+// map y0 and y1 through scale and trans, and sort them
+static void map_sorted(SkScalar y0, SkScalar y1, SkScalar scale,
+                       SkScalar trans, SkScalar* top, SkScalar* bottom) {
+    y0 = SkScalarMul(y0, scale) + trans;
+    y1 = SkScalarMul(y1, scale) + trans;
+    if (y0 > y1) {
+        SkTSwap(y0, y1);
+    }
+    *top = y0;
+    *bottom = y1;
+}
+
 bool SkCanvas::quickReject(const SkRect& rect, EdgeType et) const {
 
     if (!rect.hasValidCoordinates())
         return true;
 
-    if (fMCRec->fRegion->isEmpty()) {
+    if (fMCRec->fClip->isEmpty()) {
         return true;
     }
 
-    if (fMCRec->fMatrix->hasPerspective()) {
+    const SkMatrix& matrix = *fMCRec->fMatrix;
+    if (matrix.hasPerspective()) {
         SkRect dst;
-        fMCRec->fMatrix->mapRect(&dst, rect);
+        matrix.mapRect(&dst, rect);
         SkIRect idst;
         dst.roundOut(&idst);
-        return !SkIRect::Intersects(idst, fMCRec->fRegion->getBounds());
+        return !SkIRect::Intersects(idst, fMCRec->fClip->bounds());
+    } else if (!(matrix.getType() & SkMatrix::kAffine_Mask)) {
+        // compare in device space, where the clip's bounds are already known
+        const SkRect& clipR = this->getDeviceClipBounds(et);
+
+        // for speed, do the most likely reject compares first
+        SkScalar top, bottom;
+        map_sorted(rect.fTop, rect.fBottom, matrix.getScaleY(),
+                   matrix.getTranslateY(), &top, &bottom);
+        if (top >= clipR.fBottom || bottom <= clipR.fTop) {
+            return true;
+        }
+        SkScalar left, right;
+        map_sorted(rect.fLeft, rect.fRight, matrix.getScaleX(),
+                   matrix.getTranslateX(), &left, &right);
+        return left >= clipR.fRight || right <= clipR.fLeft;
     } else {
         const SkRectCompareType& clipR = this->getLocalClipBoundsCompareType(et);
 
@@ -1104,7 +1545,7 @@ bool SkCanvas::quickRejectY(SkScalar top, SkScalar bottom, EdgeType et) const {
         antialiasing (worst case)
      */
 
-    if (fMCRec->fRegion->isEmpty()) {
+    if (fMCRec->fClip->isEmpty()) {
         return true;
     }
 
@@ -1117,13 +1558,25 @@ bool SkCanvas::quickRejectY(SkScalar top, SkScalar bottom, EdgeType et) const {
         return true;
     }
 
+    const SkMatrix& matrix = *fMCRec->fMatrix;
+    if (!(matrix.getType() & (SkMatrix::kAffine_Mask |
+                              SkMatrix::kPerspective_Mask))) {
+        const SkRect& clipR = this->getDeviceClipBounds(kAA_EdgeType);
+        SkScalar devT, devB;
+        map_sorted(top, bottom, matrix.getScaleY(), matrix.getTranslateY(),
+                   &devT, &devB);
+        return devT >= clipR.fBottom || devB <= clipR.fTop;
+    }
+
     // check if we are above or below the local clip bounds
     const SkRectCompareType& clipR = this->getLocalClipBoundsCompareType();
     return userT >= clipR.fBottom || userB <= clipR.fTop;
 }
 
 bool SkCanvas::getClipBounds(SkRect* bounds, EdgeType et) const {
-    const SkRegion& clip = *fMCRec->fRegion;
+    // the bounds may be larger than the clip, until the clip's paths are
+    // applied, but that's still good enough for culling
+    const ClipRec& clip = *fMCRec->fClip;
     if (clip.isEmpty()) {
         if (bounds) {
             bounds->setEmpty();
@@ -1143,7 +1596,7 @@ bool SkCanvas::getClipBounds(SkRect* bounds, EdgeType et) const {
     if (NULL != bounds) {
         SkRect   r;
         // get the clip's bounds
-        const SkIRect& ibounds = clip.getBounds();
+        const SkIRect& ibounds = clip.bounds();
         // adjust it outwards if we are antialiasing
         int inset = (kAA_EdgeType == et);
         r.iset(ibounds.fLeft - inset,  ibounds.fTop - inset,
@@ -1160,7 +1613,7 @@ const SkMatrix& SkCanvas::getTotalMatrix() const {
 }
 
 const SkRegion& SkCanvas::getTotalClip() const {
-    return *fMCRec->fRegion;
+    return fMCRec->fClip->region();
 }
 
 const SkClipStack& SkCanvas::getTotalClipStack() const {
@@ -1450,6 +1903,39 @@ void SkCanvas::drawPosTextH(const void* text, size_t byteLength,
     LOOPER_END
 }
 
+void SkCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                            const SkPaint& paint) {
+    if (0 == blob->glyphCount()) {
+        return;
+    }
+
+    SkPaint blobPaint(paint);
+    blob->applyFont(&blobPaint);
+
+    // the blob's bounds do not include underlines or strike-thrus
+    const uint32_t decorations = SkPaint::kUnderlineText_Flag |
+                                 SkPaint::kStrikeThruText_Flag;
+    if (blobPaint.canComputeFastBounds() &&
+            !(blobPaint.getFlags() & decorations)) {
+        SkRect bounds = blob->bounds();
+        bounds.offset(x, y);
+        SkRect storage;
+        if (this->quickReject(blobPaint.computeFastBounds(bounds, &storage),
+                              paint2EdgeType(&blobPaint))) {
+            return;
+        }
+    }
+
+    LOOPER_BEGIN(blobPaint, SkDrawFilter::kText_Type)
+
+    while (iter.next()) {
+        SkDeviceFilteredPaint dfp(iter.fDevice, looper.paint());
+        iter.fDevice->drawTextBlob(iter, blob, x, y, dfp.paint());
+    }
+
+    LOOPER_END
+}
+
 void SkCanvas::drawTextOnPath(const void* text, size_t byteLength,
                               const SkPath& path, const SkMatrix* matrix,
                               const SkPaint& paint) {
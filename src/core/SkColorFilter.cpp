@@ -23,6 +23,10 @@ bool SkColorFilter::asColorMode(SkColor* color, SkXfermode::Mode* mode) {
     return false;
 }
 
+bool SkColorFilter::asColorMatrix(SkScalar matrix[20]) {
+    return false;
+}
+
 void SkColorFilter::filterSpan16(const uint16_t s[], int count, uint16_t d[]) {
     SkASSERT(this->getFlags() & SkColorFilter::kHasFilter16_Flag);
     SkASSERT(!"missing implementation of SkColorFilter::filterSpan16");
@@ -38,6 +42,17 @@ SkColor SkColorFilter::filterColor(SkColor c) {
     return SkUnPreMultiply::PMColorToColor(dst);
 }
 
+bool SkColorFilter::filterColorExact(SkColor c, SkColor* result) {
+    SkPMColor dst, src = SkPreMultiplyColor(c);
+    this->filterSpan(&src, 1, &dst);
+    SkColor color = SkUnPreMultiply::PMColorToColor(dst);
+    if (SkPreMultiplyColor(color) != dst) {
+        return false;
+    }
+    *result = color;
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkFilterShader::SkFilterShader(SkShader* shader, SkColorFilter* filter) {
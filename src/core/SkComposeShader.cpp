@@ -28,6 +28,8 @@ SkComposeShader::SkComposeShader(SkShader* sA, SkShader* sB, SkXfermode* mode) {
     // mode may be null
     fMode = mode;
     SkSafeRef(mode);
+    fPassShader = NULL;
+    fFoldedB = false;
 }
 
 SkComposeShader::SkComposeShader(SkFlattenableReadBuffer& buffer) :
@@ -35,6 +37,8 @@ SkComposeShader::SkComposeShader(SkFlattenableReadBuffer& buffer) :
     fShaderA = static_cast<SkShader*>(buffer.readFlattenable());
     fShaderB = static_cast<SkShader*>(buffer.readFlattenable());
     fMode = static_cast<SkXfermode*>(buffer.readFlattenable());
+    fPassShader = NULL;
+    fFoldedB = false;
 }
 
 SkComposeShader::~SkComposeShader() {
@@ -99,8 +103,66 @@ bool SkComposeShader::setContext(const SkBitmap& device,
 
     SkAutoAlphaRestore  restore(const_cast<SkPaint*>(&paint), 0xFF);
 
-    return  fShaderA->setContext(device, paint, tmpM) &&
-            fShaderB->setContext(device, paint, tmpM);
+    if (!fShaderA->setContext(device, paint, tmpM) ||
+            !fShaderB->setContext(device, paint, tmpM)) {
+        return false;
+    }
+    this->chooseProcs();
+    return true;
+}
+
+/*  Some modes come out as just one of the shaders' colors, either always, or
+    when the other shader (or that one) is opaque, so we only need to shade
+    that one. If shader B is a solid color, then every call to the mode has the
+    same src, so we look at that color once, here, instead of shading B for
+    every span. Otherwise, for a mode we know, we call its row proc (or the one
+    for src-over) directly.
+*/
+void SkComposeShader::chooseProcs() {
+    fPassShader = NULL;
+    fFoldedB = false;
+    fModeProc = NULL;
+    fModeProc32 = NULL;
+    fSrcOverProc32 = NULL;
+
+    SkXfermode::Mode mode = SkXfermode::kSrcOver_Mode;
+    if (fMode && !SkXfermode::AsMode(fMode, &mode)) {
+        return;
+    }
+
+    bool opaqueA = SkToBool(fShaderA->getFlags() & kOpaqueAlpha_Flag);
+    bool opaqueB = SkToBool(fShaderB->getFlags() & kOpaqueAlpha_Flag);
+    if (SkXfermode::kDst_Mode == mode ||
+            (opaqueB && SkXfermode::kDstIn_Mode == mode) ||
+            (opaqueA && SkXfermode::kDstOver_Mode == mode)) {
+        fPassShader = fShaderA;
+        return;
+    }
+    if (SkXfermode::kSrc_Mode == mode ||
+            (opaqueB && SkXfermode::kSrcOver_Mode == mode) ||
+            (opaqueA && SkXfermode::kSrcIn_Mode == mode)) {
+        fPassShader = fShaderB;
+        return;
+    }
+
+    fModeProc = SkXfermode::GetProc(mode);
+    if (SkShader::kColor_GradientType == fShaderB->asAGradient(NULL)) {
+        fShaderB->shadeSpan(0, 0, &fColorB, 1);
+        fFoldedB = true;
+    } else if (SkXfermode::kSrcOver_Mode == mode) {
+        fSrcOverProc32 = SkBlitRow::Factory32(
+                                        SkBlitRow::kSrcPixelAlpha_Flag32);
+    } else {
+        fModeProc32 = SkXfermode::PlatformProcs32(mode);
+    }
+}
+
+static void scale_span(SkPMColor span[], int count, unsigned scale) {
+    if (256 != scale) {
+        for (int i = 0; i < count; i++) {
+            span[i] = SkAlphaMulQ(span[i], scale);
+        }
+    }
 }
 
 // larger is better (fewer times we have to loop), but we shouldn't
@@ -113,56 +175,64 @@ void SkComposeShader::shadeSpan(int x, int y, SkPMColor result[], int count) {
     SkXfermode* mode = fMode;
     unsigned    scale = SkAlpha255To256(this->getPaintAlpha());
 
-    SkPMColor   tmp[TMP_COLOR_COUNT];
+    if (fPassShader) {
+        fPassShader->shadeSpan(x, y, result, count);
+        scale_span(result, count, scale);
+        return;
+    }
 
-    if (NULL == mode) {   // implied SRC_OVER
-        // TODO: when we have a good test-case, should use SkBlitRow::Proc32
-        // for these loops
-        do {
-            int n = count;
-            if (n > TMP_COLOR_COUNT) {
-                n = TMP_COLOR_COUNT;
+    SkXfermodeProc proc = fModeProc;
+    if (fFoldedB) {
+        SkPMColor color = fColorB;
+        shaderA->shadeSpan(x, y, result, count);
+        if (256 == scale) {
+            for (int i = 0; i < count; i++) {
+                result[i] = proc(color, result[i]);
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                result[i] = SkAlphaMulQ(proc(color, result[i]), scale);
             }
+        }
+        return;
+    }
 
-            shaderA->shadeSpan(x, y, result, n);
-            shaderB->shadeSpan(x, y, tmp, n);
+    SkPMColor   tmp[TMP_COLOR_COUNT];
 
+    do {
+        int n = count;
+        if (n > TMP_COLOR_COUNT) {
+            n = TMP_COLOR_COUNT;
+        }
+
+        shaderA->shadeSpan(x, y, result, n);
+        shaderB->shadeSpan(x, y, tmp, n);
+
+        // the row procs are fastest even with the extra pass for alpha, but
+        // without one, we scale as we go
+        if (fSrcOverProc32) {
+            fSrcOverProc32(result, tmp, n, 0xFF);
+            scale_span(result, n, scale);
+        } else if (fModeProc32) {
+            fModeProc32(result, tmp, n);
+            scale_span(result, n, scale);
+        } else if (proc) {
             if (256 == scale) {
                 for (int i = 0; i < n; i++) {
-                    result[i] = SkPMSrcOver(tmp[i], result[i]);
+                    result[i] = proc(tmp[i], result[i]);
                 }
             } else {
                 for (int i = 0; i < n; i++) {
-                    result[i] = SkAlphaMulQ(SkPMSrcOver(tmp[i], result[i]),
-                                            scale);
+                    result[i] = SkAlphaMulQ(proc(tmp[i], result[i]), scale);
                 }
             }
-
-            result += n;
-            x += n;
-            count -= n;
-        } while (count > 0);
-    } else {    // use mode for the composition
-        do {
-            int n = count;
-            if (n > TMP_COLOR_COUNT) {
-                n = TMP_COLOR_COUNT;
-            }
-
-            shaderA->shadeSpan(x, y, result, n);
-            shaderB->shadeSpan(x, y, tmp, n);
+        } else {
             mode->xfer32(result, tmp, n, NULL);
+            scale_span(result, n, scale);
+        }
 
-            if (256 == scale) {
-                for (int i = 0; i < n; i++) {
-                    result[i] = SkAlphaMulQ(result[i], scale);
-                }
-            }
-
-            result += n;
-            x += n;
-            count -= n;
-        } while (count > 0);
-    }
+        result += n;
+        x += n;
+        count -= n;
+    } while (count > 0);
 }
-
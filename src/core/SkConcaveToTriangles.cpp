@@ -34,15 +34,12 @@
 //   pre-sort during trapezoidization. Use this information in angleIsConvex()
 //   to allowed either handedness outer contour. In either case, though, holes
 //   need to have the opposite orientation.
-// - SkTHeapSort was broken, so I wrote a bubble sort so that I could make other
-//   things work. Use SkQSort() instead.
 // - The ActiveTrapezoid array does a linear search which is O(n) inefficient.
 //   Use SkSearch to implement O(log n) binary search and insertion sort.
-// - There is no need to use SkTDArray for everything. Use SkAutoTMalloc for
-//   everything else.
 
 #include "SkTDArray.h"
 #include "SkGeometry.h"
+#include "SkTemplates.h"
 #include "SkTSort.h"
 
 // This is used to prevent runaway code bugs, and can probably be removed after
@@ -427,12 +424,15 @@ public:
 };
 
 
+// Equal points are kept in polygon order, so that the order is total and the
+// (unstable) heap sort gives the same result as a stable sort.
 bool operator<(VertexPtr &v0, VertexPtr &v1) {
     // DebugPrintf("< %p %p\n", &v0, &v1);
     if (v0.vt->point().fY < v1.vt->point().fY)  return true;
     if (v0.vt->point().fY > v1.vt->point().fY)  return false;
     if (v0.vt->point().fX < v1.vt->point().fX)  return true;
-    else                                        return false;
+    if (v0.vt->point().fX > v1.vt->point().fX)  return false;
+    return v0.vt < v1.vt;
 }
 
 
@@ -584,7 +584,11 @@ static const char* GetVertexTypeString(Vertex::VertexType type) {
 }
 
 
+// These classify every vertex, so they only run when they would print.
 static void PrintVertices(size_t numPts, Vertex *vt) {
+    if (gDebugLevel <= 0) {
+        return;
+    }
     DebugPrintf("\nVertices:\n");
     for (size_t i = 0; i < numPts; i++) {
         Vertex *e0, *e1;
@@ -610,6 +614,9 @@ static void PrintVertices(size_t numPts, Vertex *vt) {
 
 
 static void PrintVertexPtrs(size_t numPts, VertexPtr *vp, Vertex *vtBase) {
+    if (gDebugLevel <= 0) {
+        return;
+    }
     DebugPrintf("\nSorted Vertices:\n");
     for (size_t i = 0; i < numPts; i++) {
         Vertex *e0, *e1;
@@ -639,25 +646,6 @@ inline void PrintVertexPtrs(size_t numPts, VertexPtr *vp, Vertex *vtBase) {}
 #endif  // !DEBUG
 
 
-// SkTHeapSort is broken, so we use a bubble sort in the meantime.
-template <typename T>
-void BubbleSort(T *array, size_t count) {
-    bool sorted;
-    size_t count_1 = count - 1;
-    do {
-        sorted = true;
-        for (size_t i = 0; i < count_1; ++i) {
-            if (array[i + 1] < array[i]) {
-                T t = array[i];
-                array[i] = array[i + 1];
-                array[i + 1] = t;
-                sorted = false;
-            }
-        }
-    } while (!sorted);
-}
-
-
 // Remove zero-height trapezoids.
 static void RemoveDegenerateTrapezoids(size_t numVt, Vertex *vt) {
     for (; numVt-- != 0; vt++) {
@@ -681,6 +669,10 @@ static void RemoveDegenerateTrapezoids(size_t numVt, Vertex *vt) {
 }
 
 
+// Most polygons are small enough for their vertices and sort to fit on the
+// stack.
+#define kStackVertexCount 64
+
 // Enhance the polygon with trapezoids.
 bool ConvertPointsToVertices(size_t numPts, const SkPoint *pts, Vertex *vta) {
     DebugPrintf("ConvertPointsToVertices()\n");
@@ -696,24 +688,24 @@ bool ConvertPointsToVertices(size_t numPts, const SkPoint *pts, Vertex *vta) {
 
     PrintVertices(numPts, vta);
 
-    SkTDArray<VertexPtr> vtptr;
-    vtptr.setCount(numPts);
+    SkAutoSTMalloc<kStackVertexCount, VertexPtr> vtptrStorage(numPts);
+    VertexPtr* vtptr = vtptrStorage.get();
+    VertexPtr* vtptrEnd = vtptr + numPts;
     for (int i = numPts; i-- != 0;)
         vtptr[i].vt = vta + i;
-    PrintVertexPtrs(vtptr.count(), vtptr.begin(), vta);
-    DebugPrintf("Sorting vertrap ptr array [%d] %p %p\n", vtptr.count(),
-        &vtptr[0], &vtptr[vtptr.count() - 1]
+    PrintVertexPtrs(numPts, vtptr, vta);
+    DebugPrintf("Sorting vertrap ptr array [%d] %p %p\n", numPts,
+        &vtptr[0], &vtptr[numPts - 1]
     );
-//  SkTHeapSort(vtptr.begin(), vtptr.count());
-    BubbleSort(vtptr.begin(), vtptr.count());
+    SkTHeapSort(vtptr, numPts);
     DebugPrintf("Done sorting\n");
-    PrintVertexPtrs(vtptr.count(), vtptr.begin(), vta);
+    PrintVertexPtrs(numPts, vtptr, vta);
 
     DebugPrintf("Traversing sorted vertrap ptrs\n");
     ActiveTrapezoids incompleteTrapezoids;
-    for (VertexPtr *vtpp = vtptr.begin(); vtpp < vtptr.end(); ++vtpp) {
+    for (VertexPtr *vtpp = vtptr; vtpp < vtptrEnd; ++vtpp) {
         DebugPrintf("%d: sorted vertrap %d\n",
-                    vtpp - vtptr.begin(), vtpp->vt - vta);
+                    vtpp - vtptr, vtpp->vt - vta);
         Vertex *vt = vtpp->vt;
         Vertex *e0, *e1;
         Trapezoid *t;
@@ -801,7 +793,7 @@ bool ConvertPointsToVertices(size_t numPts, const SkPoint *pts, Vertex *vta) {
     RemoveDegenerateTrapezoids(numPts, vta);
 
     DebugPrintf("Done making trapezoids\n");
-    PrintVertexPtrs(vtptr.count(), vtptr.begin(), vta);
+    PrintVertexPtrs(numPts, vtptr, vta);
 
     size_t k = incompleteTrapezoids.count();
     if (k > 0) {
@@ -892,8 +884,13 @@ bool TriangulateMonotone(Vertex *first, Vertex *last,
     while (numVertices >= 3) {
         if (current->angleIsConvex()) {
             DebugPrintf("Angle %p is convex\n", current);
-            // Print the vertices
-            PrintLinkedVertices(numVertices, start);
+#ifdef DEBUG
+            // Print the vertices (which walks all of them, so only if
+            // they're going to be printed)
+            if (gDebugLevel > 0) {
+                PrintLinkedVertices(numVertices, start);
+            }
+#endif
 
             appendTriangleAtVertex(current, triangles);
             if (triangles->count() > kMaxCount * 3) {
@@ -956,12 +953,12 @@ bool SkConcaveToTriangles(size_t numPts,
                           SkTDArray<SkPoint> *triangles) {
     DebugPrintf("SkConcaveToTriangles()\n");
 
-    SkTDArray<Vertex> vertices;
-    vertices.setCount(numPts);
-    if (!ConvertPointsToVertices(numPts, pts, vertices.begin()))
+    SkAutoSTMalloc<kStackVertexCount, Vertex> vertices(numPts);
+    if (!ConvertPointsToVertices(numPts, pts, vertices.get()))
         return false;
 
-    triangles->setReserve(numPts);
+    // a simple polygon has numPts - 2 triangles
+    triangles->setReserve(numPts * 3);
     triangles->setCount(0);
-    return Triangulate(vertices.begin(), vertices.end() - 1, triangles);
+    return Triangulate(vertices.get(), vertices.get() + numPts - 1, triangles);
 }
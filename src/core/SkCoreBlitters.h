@@ -61,7 +61,8 @@ public:
     virtual const SkBitmap* justAnOpaqueColor(uint32_t*);
 
 private:
-    unsigned fSrcA;
+    unsigned                fSrcA;
+    SkBlitRow::ColorA8Proc  fColorA8Proc;
 
     // illegal
     SkA8_Blitter& operator=(const SkA8_Blitter&);
@@ -78,9 +79,11 @@ public:
     virtual void blitMask(const SkMask&, const SkIRect&);
 
 private:
-    SkXfermode* fXfermode;
-    SkPMColor*  fBuffer;
-    uint8_t*    fAAExpand;
+    SkXfermode*             fXfermode;
+    SkPMColor*              fBuffer;
+    uint8_t*                fAAExpand;
+    SkBlitRow::ColorA8Proc  fColorA8Proc;
+    SkBlitRow::AlphaA8Proc  fAlphaA8Proc;
 
     // illegal
     SkA8_Shader_Blitter& operator=(const SkA8_Shader_Blitter&);
@@ -98,12 +101,14 @@ public:
     virtual void blitV(int x, int y, int height, SkAlpha alpha);
     virtual void blitRect(int x, int y, int width, int height);
     virtual void blitMask(const SkMask&, const SkIRect&);
+    virtual void blitMasks(const SkMask[], const SkIRect[], int count);
     virtual const SkBitmap* justAnOpaqueColor(uint32_t*);
 
 protected:
     SkColor                fColor;
     SkPMColor              fPMColor;
     SkBlitRow::ColorProc   fColor32Proc;
+    SkBlitRow::ColorAAProc fColorAAProc;
     SkBlitMask::Proc       fBlitMaskProc;
 
 private:
@@ -120,6 +125,7 @@ public:
     SkARGB32_Opaque_Blitter(const SkBitmap& device, const SkPaint& paint)
         : INHERITED(device, paint) { SkASSERT(paint.getAlpha() == 0xFF); }
     virtual void blitMask(const SkMask&, const SkIRect&);
+    virtual void blitMasks(const SkMask[], const SkIRect[], int count);
 
 private:
     typedef SkARGB32_Blitter INHERITED;
@@ -130,6 +136,7 @@ public:
     SkARGB32_Black_Blitter(const SkBitmap& device, const SkPaint& paint)
         : INHERITED(device, paint) {}
     virtual void blitMask(const SkMask&, const SkIRect&);
+    virtual void blitMasks(const SkMask[], const SkIRect[], int count);
     virtual void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]);
 
 private:
@@ -1,7 +1,10 @@
 #include "SkDevice.h"
 #include "SkDraw.h"
+#include "SkLayerPool.h"
 #include "SkMetaData.h"
 #include "SkRect.h"
+#include "SkTemplates.h"
+#include "SkTextBlob.h"
 
 //#define TRACE_FACTORY_LIFETIME
 
@@ -25,6 +28,16 @@ SkDeviceFactory::~SkDeviceFactory() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// layers come and go with save/restore, so their pixels come from a pool
+static SkDevice* new_layer_device(SkBitmap::Config config, int width,
+                                  int height, bool isOpaque) {
+    SkBitmap bitmap;
+    if (SkLayerPool::AllocPixels(&bitmap, config, width, height, isOpaque)) {
+        return SkNEW_ARGS(SkDevice, (bitmap));
+    }
+    return SkNEW_ARGS(SkDevice, (config, width, height, isOpaque));
+}
+
 #if 0
 SkDevice::SkDevice() : fMetaData(NULL) {
     fOrigin.setZero();
@@ -85,6 +98,9 @@ SkDevice* SkDevice::onCreateCompatibleDevice(SkBitmap::Config config,
                                              int width, int height, 
                                              bool isOpaque,
                                              Usage usage) {
+    if (kSaveLayer_Usage == usage) {
+        return new_layer_device(config, width, height, isOpaque);
+    }
     return SkNEW_ARGS(SkDevice,(config, width, height, isOpaque));
 }
 
@@ -113,6 +129,12 @@ const SkBitmap& SkDevice::accessBitmap(bool changePixels) {
     return fBitmap;
 }
 
+const SkBitmap& SkDevice::accessBitmapForDraw() {
+    this->onAccessBitmapForDraw(&fBitmap);
+    fBitmap.notifyPixelsChanged();
+    return fBitmap;
+}
+
 void SkDevice::getBounds(SkIRect* bounds) const {
     if (bounds) {
         bounds->set(0, 0, fBitmap.width(), fBitmap.height());
@@ -132,6 +154,10 @@ void SkDevice::clear(SkColor color) {
 
 void SkDevice::onAccessBitmap(SkBitmap* bitmap) {}
 
+void SkDevice::onAccessBitmapForDraw(SkBitmap* bitmap) {
+    this->onAccessBitmap(bitmap);
+}
+
 void SkDevice::setMatrixClip(const SkMatrix& matrix, const SkRegion& region,
                              const SkClipStack& clipStack) {
 }
@@ -222,6 +248,29 @@ void SkDevice::drawPosText(const SkDraw& draw, const void* text, size_t len,
     draw.drawPosText((const char*)text, len, xpos, y, scalarsPerPos, paint);
 }
 
+void SkDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob,
+                            SkScalar x, SkScalar y, const SkPaint& paint) {
+    const int count = blob->glyphCount();
+    if (0 == count) {
+        return;
+    }
+    const size_t byteLength = count * sizeof(uint16_t);
+    const SkPoint* pos = blob->positions();
+    if (0 == x && 0 == y) {
+        this->drawPosText(draw, blob->glyphs(), byteLength, &pos->fX, 0, 2,
+                          paint);
+        return;
+    }
+
+    SkAutoSTMalloc<64, SkPoint> storage(count);
+    SkPoint* translated = storage.get();
+    for (int i = 0; i < count; i++) {
+        translated[i].set(pos[i].fX + x, pos[i].fY + y);
+    }
+    this->drawPosText(draw, blob->glyphs(), byteLength, &translated->fX, 0, 2,
+                      paint);
+}
+
 void SkDevice::drawTextOnPath(const SkDraw& draw, const void* text,
                                   size_t len, const SkPath& path,
                                   const SkMatrix* matrix,
@@ -285,7 +334,7 @@ SkDevice* SkRasterDeviceFactory::newDevice(SkCanvas*,
                                            int height, bool isOpaque,
                                            bool isForLayer) {
     if (isForLayer) {
-        return SkNEW_ARGS(SkDevice, (config, width, height, isOpaque));
+        return new_layer_device(config, width, height, isOpaque);
     } else {
         // should we ever get here?
         SkBitmap bitmap;
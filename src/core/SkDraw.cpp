@@ -21,21 +21,29 @@
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
 #include "SkDevice.h"
+#include "SkLineClipper.h"
 #include "SkMaskFilter.h"
 #include "SkPaint.h"
 #include "SkPathEffect.h"
 #include "SkRasterizer.h"
+#include "SkRunnable.h"
 #include "SkScan.h"
+#include "SkScratchAlloc.h"
 #include "SkShader.h"
 #include "SkStroke.h"
 #include "SkTemplatesPriv.h"
 #include "SkTextFormatParams.h"
+#include "SkTrace.h"
 #include "SkUtils.h"
 
 #include "SkAutoKern.h"
 #include "SkBitmapProcShader.h"
 #include "SkDrawProcs.h"
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 //#define TRACE_BITMAP_DRAWS
 
 class SkAutoRestoreBounder : SkNoncopyable {
@@ -71,20 +79,39 @@ static SkPoint* rect_points(SkRect& r, int index) {
 
 class SkAutoBlitterChoose {
 public:
+    /** If clipMask is not null, what is blitted is modulated by it. */
     SkAutoBlitterChoose(const SkBitmap& device, const SkMatrix& matrix,
-                        const SkPaint& paint) {
+                        const SkPaint& paint, const SkMask* clipMask) {
         fBlitter = SkBlitter::Choose(device, matrix, paint,
                                      fStorage, sizeof(fStorage));
+        fClipped = fBlitter;
+        if (clipMask) {
+            fMaskClipBlitter.init(fBlitter, clipMask);
+            fClipped = &fMaskClipBlitter;
+        }
+#ifdef SK_ENABLE_TRACE
+        // the pixels are only counted while tracing, to keep the virtual
+        // call out of the spans otherwise
+        if (SkTrace::IsEnabled()) {
+            fTraceBlitter.init(fClipped);
+            fClipped = &fTraceBlitter;
+        }
+#endif
     }
 
     ~SkAutoBlitterChoose();
 
-    SkBlitter*  operator->() { return fBlitter; }
-    SkBlitter*  get() const { return fBlitter; }
+    SkBlitter*  operator->() { return fClipped; }
+    SkBlitter*  get() const { return fClipped; }
 
 private:
-    SkBlitter*  fBlitter;
-    uint32_t    fStorage[kBlitterStorageLongCount];
+    SkBlitter*          fBlitter;
+    SkBlitter*          fClipped;   // fBlitter, or fMaskClipBlitter over it
+    SkMaskClipBlitter   fMaskClipBlitter;
+#ifdef SK_ENABLE_TRACE
+    SkTraceBlitter      fTraceBlitter;
+#endif
+    uint32_t            fStorage[kBlitterStorageLongCount];
 };
 
 SkAutoBlitterChoose::~SkAutoBlitterChoose() {
@@ -158,24 +185,44 @@ SkDraw::SkDraw(const SkDraw& src) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-typedef void (*BitmapXferProc)(void* pixels, size_t bytes, uint32_t data);
+// each proc fills height rows of bytes, rowBytes apart
+typedef void (*BitmapXferProc)(void* pixels, size_t bytes, int height,
+                               size_t rowBytes, uint32_t data);
 
-static void D_Clear_BitmapXferProc(void* pixels, size_t bytes, uint32_t) {
-    sk_bzero(pixels, bytes);
+static void D_Clear_BitmapXferProc(void* pixels, size_t bytes, int height,
+                                   size_t rowBytes, uint32_t) {
+    if (rowBytes == bytes) {
+        sk_bzero(pixels, bytes * height);
+        return;
+    }
+    while (--height >= 0) {
+        sk_bzero(pixels, bytes);
+        pixels = (char*)pixels + rowBytes;
+    }
 }
 
-static void D_Dst_BitmapXferProc(void*, size_t, uint32_t data) {}
+static void D_Dst_BitmapXferProc(void*, size_t, int, size_t, uint32_t data) {}
 
-static void D32_Src_BitmapXferProc(void* pixels, size_t bytes, uint32_t data) {
-    sk_memset32((uint32_t*)pixels, data, bytes >> 2);
+static void D32_Src_BitmapXferProc(void* pixels, size_t bytes, int height,
+                                   size_t rowBytes, uint32_t data) {
+    sk_memset_rect32((uint32_t*)pixels, data, bytes >> 2, height, rowBytes);
 }
 
-static void D16_Src_BitmapXferProc(void* pixels, size_t bytes, uint32_t data) {
-    sk_memset16((uint16_t*)pixels, data, bytes >> 1);
+static void D16_Src_BitmapXferProc(void* pixels, size_t bytes, int height,
+                                   size_t rowBytes, uint32_t data) {
+    sk_memset_rect16((uint16_t*)pixels, data, bytes >> 1, height, rowBytes);
 }
 
-static void DA8_Src_BitmapXferProc(void* pixels, size_t bytes, uint32_t data) {
-    memset(pixels, data, bytes);
+static void DA8_Src_BitmapXferProc(void* pixels, size_t bytes, int height,
+                                   size_t rowBytes, uint32_t data) {
+    if (rowBytes == bytes) {
+        memset(pixels, data, bytes * height);
+        return;
+    }
+    while (--height >= 0) {
+        memset(pixels, data, bytes);
+        pixels = (char*)pixels + rowBytes;
+    }
 }
 
 static BitmapXferProc ChooseBitmapXferProc(const SkBitmap& bitmap,
@@ -278,10 +325,7 @@ static void CallBitmapXferProc(const SkBitmap& bitmap, const SkIRect& rect,
 
     // skip down to the first scanline and X position
     pixels += rect.fTop * rowBytes + (rect.fLeft << shiftPerPixel);
-    for (int scans = rect.height() - 1; scans >= 0; --scans) {
-        proc(pixels, widthBytes, procData);
-        pixels += rowBytes;
-    }
+    proc(pixels, widthBytes, rect.height(), rowBytes, procData);
 }
 
 void SkDraw::drawPaint(const SkPaint& paint) const {
@@ -304,7 +348,9 @@ void SkDraw::drawPaint(const SkPaint& paint) const {
         in the clip, we don't have to worry about antialiasing.
     */
     uint32_t procData = 0;  // to avoid the warning
-    BitmapXferProc proc = ChooseBitmapXferProc(*fBitmap, paint, &procData);
+    // the procs write every pixel in the clip, which a clip mask doesn't allow
+    BitmapXferProc proc = fClipMask ? NULL :
+                          ChooseBitmapXferProc(*fBitmap, paint, &procData);
     if (proc) {
         if (D_Dst_BitmapXferProc == proc) { // nothing to do
             return;
@@ -317,7 +363,7 @@ void SkDraw::drawPaint(const SkPaint& paint) const {
         }
     } else {
         // normal case: use a blitter
-        SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint);
+        SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint, fClipMask);
         SkScan::FillIRect(devRect, fClip, blitter.get());
     }
 }
@@ -548,6 +594,54 @@ static bool bounder_points(SkBounder* bounder, SkCanvas::PointMode mode,
 // must be even for lines/polygon to work
 #define MAX_DEV_PTS     32
 
+// Call proc for the points (or segments) in devPts[] that may draw inside
+// bounds, which the caller has outset by how far a point can reach. Charts
+// often have most of their points off to one side of the clip, and this
+// way they don't get as far as the scan converters.
+static void cull_and_draw(const PtProcRec& rec, PtProcRec::Proc proc,
+                          SkPoint devPts[], int count, const SkRect& bounds,
+                          SkBlitter* blitter) {
+    SkASSERT(count <= MAX_DEV_PTS);
+
+    if (SkCanvas::kLines_PointMode == rec.fMode) {
+        count = SkLineClipper::CullLines(devPts, count, bounds, devPts);
+        if (count > 0) {
+            proc(rec, devPts, count, blitter);
+        }
+        return;
+    }
+
+    uint8_t codes[MAX_DEV_PTS];
+    SkLineClipper::ComputeOutcodes(devPts, count, bounds, codes);
+
+    if (SkCanvas::kPoints_PointMode == rec.fMode) {
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (0 == codes[i]) {
+                devPts[n++] = devPts[i];
+            }
+        }
+        if (n > 0) {
+            proc(rec, devPts, n, blitter);
+        }
+    } else {
+        // each segment is drawn on its own, so the polygon can be broken up
+        // into the runs of segments that are kept
+        int start = 0;
+        for (int i = 0; i < count - 1; i++) {
+            if (codes[i] & codes[i + 1]) {
+                if (i > start) {
+                    proc(rec, devPts + start, i - start + 1, blitter);
+                }
+                start = i + 1;
+            }
+        }
+        if (count - 1 > start) {
+            proc(rec, devPts + start, count - start, blitter);
+        }
+    }
+}
+
 void SkDraw::drawPoints(SkCanvas::PointMode mode, size_t count,
                         const SkPoint pts[], const SkPaint& paint,
                         bool forceUseDevice) const {
@@ -583,7 +677,7 @@ void SkDraw::drawPoints(SkCanvas::PointMode mode, size_t count,
 
     PtProcRec rec;
     if (!forceUseDevice && rec.init(mode, paint, fMatrix, fClip)) {
-        SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint);
+        SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint, fClipMask);
 
         SkPoint             devPts[MAX_DEV_PTS];
         const SkMatrix*     matrix = fMatrix;
@@ -592,13 +686,20 @@ void SkDraw::drawPoints(SkCanvas::PointMode mode, size_t count,
         // we have to back up subsequent passes if we're in polygon mode
         const size_t backup = (SkCanvas::kPolygon_PointMode == mode);
 
+        // nothing the procs draw reaches further than their radius (or a
+        // hairline's half pixel) from the points, plus a pixel for rounding
+        SkRect cullBounds;
+        cullBounds.set(fClip->getBounds());
+        SkScalar outset = SK_Scalar1 + SkFixedToScalar(rec.fRadius);
+        cullBounds.inset(-outset, -outset);
+
         do {
             size_t n = count;
             if (n > MAX_DEV_PTS) {
                 n = MAX_DEV_PTS;
             }
             matrix->mapPoints(devPts, pts, n);
-            proc(rec, devPts, n, bltr);
+            cull_and_draw(rec, proc, devPts, n, cullBounds, bltr);
             pts += n - backup;
             SkASSERT(count >= n);
             count -= n;
@@ -774,7 +875,7 @@ void SkDraw::drawRect(const SkRect& rect, const SkPaint& paint) const {
             return;
     }
 
-    SkAutoBlitterChoose blitterStorage(*fBitmap, matrix, paint);
+    SkAutoBlitterChoose blitterStorage(*fBitmap, matrix, paint, fClipMask);
     SkBlitter*          blitter = blitterStorage.get();
     const SkRegion*     clip = fClip;
 
@@ -828,7 +929,7 @@ void SkDraw::drawDevMask(const SkMask& srcM, const SkPaint& paint) const {
         return;
     }
 
-    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint);
+    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint, fClipMask);
 
     blitter->blitMaskRegion(*mask, *fClip);
 }
@@ -880,9 +981,123 @@ static bool map_radius(const SkMatrix& matrix, SkScalar* value) {
     return false;
 }
 
+// like map_radius, but for strokes up to kMaxThinStrokeWidth wide, which are
+// drawn with SkScan::AntiThinStrokePath, so the scale has to be even
+static bool map_thin_width(const SkMatrix& matrix, SkScalar* value) {
+    static const SkScalar kMaxThinStrokeWidth = SkIntToScalar(2);
+
+    if (matrix.hasPerspective()) {
+        return false;
+    }
+    SkVector src[2], dst[2];
+    src[0].set(*value, 0);
+    src[1].set(0, *value);
+    matrix.mapVectors(dst, src, 2);
+    SkScalar len0 = dst[0].length();
+    SkScalar len1 = dst[1].length();
+    SkScalar tol = SkScalarMul(len0, SkFloatToScalar(0.01f));
+    if (!SkScalarNearlyEqual(len0, len1, tol) ||
+            SkScalarAbs(SkPoint::DotProduct(dst[0], dst[1])) >
+                SkScalarMul(len0, tol)) {
+        return false;
+    }
+    if (len0 >= SK_Scalar1 && len0 <= kMaxThinStrokeWidth) {
+        *value = len0;
+        return true;
+    }
+    return false;
+}
+
+static bool has_only_lines(const SkPath& path) {
+    SkPath::Iter    iter(path, false);
+    SkPoint         pts[4];
+    SkPath::Verb    verb;
+
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        if (SkPath::kQuad_Verb == verb || SkPath::kCubic_Verb == verb) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Can the paint's stroke be drawn with SkScan::AntiThinStrokePath? It draws
+// some pixels twice, so the paint has to be opaque.
+static bool is_thin_stroke(const SkPaint& paint) {
+    return paint.isAntiAlias() &&
+           paint.getStyle() == SkPaint::kStroke_Style &&
+           paint.getStrokeWidth() > 0 &&
+           paint.getAlpha() == 0xFF &&
+           NULL == paint.getXfermode() &&
+           NULL == paint.getShader() &&
+           NULL == paint.getColorFilter() &&
+           NULL == paint.getPathEffect() &&
+           NULL == paint.getMaskFilter() &&
+           NULL == paint.getRasterizer();
+}
+
+// fewer pixels than this (in the path's bounds, inside the clip) are not
+// worth handing off to fExecutor's threads
+static const int kMinBandFillPixels = 256 * 256;
+
+// Can the paint be filled by several blitters of its own at once? Shaders
+// (which blitters also use for color filters) keep the state of what they are
+// drawing in themselves, so they can't.
+static bool can_fill_in_bands(const SkPaint& paint) {
+    return NULL == paint.getShader() &&
+           NULL == paint.getColorFilter() &&
+           NULL == paint.getMaskFilter() &&
+           !(paint.isAntiAlias() && paint.isAnalyticAA());
+}
+
+bool SkDraw::fillPathInBands(const SkPath& devPath, const SkPaint& paint,
+                             SkBlitter* blitter) const {
+    if (NULL == fExecutor || 0 == fExecutor->threadCount() ||
+            devPath.isInverseFillType() || !can_fill_in_bands(paint)) {
+        return false;
+    }
+
+    SkIRect bounds;
+    devPath.getBounds().roundOut(&bounds);
+    if (!bounds.intersect(fClip->getBounds()) ||
+            (int64_t)bounds.width() * bounds.height() < kMinBandFillPixels) {
+        return false;
+    }
+
+    // every band needs its own blitter
+    int count = SkMin32(fExecutor->threadCount() + 1,
+                        SkScan::kMaxFillBands);
+    SkAutoBlitterChoose* choosers[SkScan::kMaxFillBands];
+    SkBlitter* blitters[SkScan::kMaxFillBands];
+    blitters[0] = blitter;
+    for (int i = 1; i < count; i++) {
+        choosers[i] = SkNEW_ARGS(SkAutoBlitterChoose,
+                                 (*fBitmap, *fMatrix, paint, fClipMask));
+        blitters[i] = choosers[i]->get();
+    }
+
+    if (paint.isAntiAlias()) {
+        SkScan::AntiFillPath(devPath, *fClip, blitters, count, fExecutor);
+    } else {
+        SkScan::FillPath(devPath, *fClip, blitters, count, fExecutor);
+    }
+
+    for (int i = 1; i < count; i++) {
+        SkDELETE(choosers[i]);
+    }
+    return true;
+}
+
+SK_TRACE_COUNTER(gDrawPathCount, "draw.path");
+SK_TRACE_COUNTER(gDrawBitmapCount, "draw.bitmap");
+SK_TRACE_COUNTER(gDrawTextCount, "draw.text");
+SK_TRACE_COUNTER(gDrawPosTextCount, "draw.posText");
+
 void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& paint,
                       const SkMatrix* prePathMatrix, bool pathIsMutable) const {
     SkDEBUGCODE(this->validate();)
+    SK_TRACE_EVENT("SkDraw::drawPath");
+    SK_TRACE_INC(gDrawPathCount);
 
     // nothing to draw
     if (fClip->isEmpty() ||
@@ -942,6 +1157,22 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& paint,
         }
     }
 
+    // a stroke of lines a pixel or two wide is drawn as it is, without
+    // making its outline
+    if (NULL == fBounder && is_thin_stroke(paint)) {
+        SkScalar width = paint.getStrokeWidth();
+        if (map_thin_width(*matrix, &width) && has_only_lines(*pathPtr)) {
+            SkPath* devPathPtr = pathIsMutable ? pathPtr : &tmpPath;
+            pathPtr->transform(*matrix, devPathPtr);
+
+            SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint, fClipMask);
+            SkScan::AntiThinStrokePath(*devPathPtr, width,
+                                       paint.getStrokeCap(), *fClip,
+                                       blitter.get());
+            return;
+        }
+    }
+
     if (paint.getPathEffect() || paint.getStyle() != SkPaint::kFill_Style) {
         doFill = paint.getFillPath(*pathPtr, &tmpPath);
         pathPtr = &tmpPath;
@@ -951,7 +1182,8 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& paint,
         SkMask  mask;
         if (paint.getRasterizer()->rasterize(*pathPtr, *matrix,
                             &fClip->getBounds(), paint.getMaskFilter(), &mask,
-                            SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
+                            SkMask::kComputeBoundsAndRenderImage_CreateMode,
+                            fExecutor)) {
             this->drawDevMask(mask, paint);
             SkMask::FreeImage(mask.fImage);
         }
@@ -964,7 +1196,7 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& paint,
     // transform the path into device space
     pathPtr->transform(*matrix, devPathPtr);
 
-    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint);
+    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint, fClipMask);
 
     // how does filterPath() know to fill or hairline the path??? <mrr>
     if (paint.getMaskFilter() &&
@@ -977,9 +1209,17 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& paint,
         return;
     }
 
+    if (doFill && this->fillPathInBands(*devPathPtr, paint, blitter.get())) {
+        return;
+    }
+
     if (doFill) {
         if (paint.isAntiAlias()) {
-            SkScan::AntiFillPath(*devPathPtr, *fClip, blitter.get());
+            if (paint.isAnalyticAA()) {
+                SkScan::AnalyticFillPath(*devPathPtr, *fClip, blitter.get());
+            } else {
+                SkScan::AntiFillPath(*devPathPtr, *fClip, blitter.get());
+            }
         } else {
             SkScan::FillPath(*devPathPtr, *fClip, blitter.get());
         }
@@ -1058,8 +1298,8 @@ void SkDraw::drawBitmapAsMask(const SkBitmap& bitmap,
         }
 
         // allocate (and clear) our temp buffer to hold the transformed bitmap
-        SkAutoMalloc    storage(size);
-        mask.fImage = (uint8_t*)storage.get();
+        SkAutoScratch   storage;
+        mask.fImage = (uint8_t*)storage.alloc(size);
         memset(mask.fImage, 0, size);
 
         // now draw our bitmap(src) into mask(dst), transformed by the matrix
@@ -1109,6 +1349,8 @@ static bool clipped_out(const SkMatrix& matrix, const SkRegion& clip,
 void SkDraw::drawBitmap(const SkBitmap& bitmap, const SkMatrix& prematrix,
                         const SkPaint& paint) const {
     SkDEBUGCODE(this->validate();)
+    SK_TRACE_EVENT("SkDraw::drawBitmap");
+    SK_TRACE_INC(gDrawBitmapCount);
 
     // nothing to draw
     if (fClip->isEmpty() ||
@@ -1153,7 +1395,8 @@ void SkDraw::drawBitmap(const SkBitmap& bitmap, const SkMatrix& prematrix,
         return;
     }
 
-    if (bitmap.getConfig() != SkBitmap::kA8_Config &&
+    // sprite blitters only blit rects, so they can't go through a clip mask
+    if (bitmap.getConfig() != SkBitmap::kA8_Config && NULL == fClipMask &&
             just_translate(matrix, bitmap)) {
         int         ix = SkScalarRound(matrix.getTranslateX());
         int         iy = SkScalarRound(matrix.getTranslateY());
@@ -1221,7 +1464,7 @@ void SkDraw::drawSprite(const SkBitmap& bitmap, int x, int y,
 
     SkAutoPaintStyleRestore restore(paint, SkPaint::kFill_Style);
 
-    if (NULL == paint.getColorFilter()) {
+    if (NULL == paint.getColorFilter() && NULL == fClipMask) {
         uint32_t    storage[kBlitterStorageLongCount];
         SkBlitter*  blitter = SkBlitter::ChooseSprite(*fBitmap, paint, bitmap,
                                                 x, y, storage, sizeof(storage));
@@ -1381,18 +1624,17 @@ static void D1G_NoBounder_RectClip(const SkDraw1Glyph& state,
     int right   = left + glyph.fWidth;
     int bottom  = top + glyph.fHeight;
 
-	SkMask		mask;
-	SkIRect		storage;
-	SkIRect*	bounds = &mask.fBounds;
+	SkMask&		mask = state.fBatchMasks[state.fBatchCount];
+	SkIRect&	clip = state.fBatchClips[state.fBatchCount];
 
 	mask.fBounds.set(left, top, right, bottom);
 
 	// this extra test is worth it, assuming that most of the time it succeeds
-	// since we can avoid writing to storage
-	if (!state.fClipBounds.containsNoEmptyCheck(left, top, right, bottom)) {
-		if (!storage.intersectNoEmptyCheck(mask.fBounds, state.fClipBounds))
-			return;
-		bounds = &storage;
+	// since we can avoid the intersection
+	if (state.fClipBounds.containsNoEmptyCheck(left, top, right, bottom)) {
+		clip = mask.fBounds;
+	} else if (!clip.intersectNoEmptyCheck(mask.fBounds, state.fClipBounds)) {
+		return;
 	}
 
 	uint8_t* aa = (uint8_t*)glyph.fImage;
@@ -1406,7 +1648,9 @@ static void D1G_NoBounder_RectClip(const SkDraw1Glyph& state,
 	mask.fRowBytes = glyph.rowBytes();
 	mask.fFormat = static_cast<SkMask::Format>(glyph.fMaskFormat);
 	mask.fImage = aa;
-	state.fBlitter->blitMask(mask, *bounds);
+	if (++state.fBatchCount == SkDraw1Glyph::kMaxBatchCount) {
+		state.flush();
+	}
 }
 
 static void D1G_NoBounder_RgnClip(const SkDraw1Glyph& state,
@@ -1495,6 +1739,7 @@ SkDraw1Glyph::Proc SkDraw1Glyph::init(const SkDraw* draw, SkBlitter* blitter,
     fClipBounds = fClip->getBounds();
 	fBlitter = blitter;
 	fCache = cache;
+    fBatchCount = 0;
 
     if (draw->fProcs && draw->fProcs->fD1GProc) {
         return draw->fProcs->fD1GProc;
@@ -1511,6 +1756,13 @@ SkDraw1Glyph::Proc SkDraw1Glyph::init(const SkDraw* draw, SkBlitter* blitter,
     }
 }
 
+void SkDraw1Glyph::flush() const {
+    if (fBatchCount > 0) {
+        fBlitter->blitMasks(fBatchMasks, fBatchClips, fBatchCount);
+        fBatchCount = 0;
+    }
+}
+
 enum RoundBaseline {
     kDont_Round_Baseline,
     kRound_X_Baseline,
@@ -1536,6 +1788,8 @@ void SkDraw::drawText(const char text[], size_t byteLength,
     SkASSERT(byteLength == 0 || text != NULL);
 
     SkDEBUGCODE(this->validate();)
+    SK_TRACE_EVENT("SkDraw::drawText");
+    SK_TRACE_INC(gDrawTextCount);
 
     // nothing to draw
     if (text == NULL || byteLength == 0 ||
@@ -1583,7 +1837,7 @@ void SkDraw::drawText(const char text[], size_t byteLength,
 
     SkAutoGlyphCache    autoCache(paint, matrix);
     SkGlyphCache*       cache = autoCache.getCache();
-    SkAutoBlitterChoose blitter(*fBitmap, *matrix, paint);
+    SkAutoBlitterChoose blitter(*fBitmap, *matrix, paint, fClipMask);
 
     // transform our starting point
     {
@@ -1645,6 +1899,7 @@ void SkDraw::drawText(const char text[], size_t byteLength,
         fx += glyph.fAdvanceX;
         fy += glyph.fAdvanceY;
     }
+    d1g.flush();
 
     if (underlineWidth) {
         autoCache.release();    // release this now to free up the RAM
@@ -1751,6 +2006,8 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
     SkASSERT(1 == scalarsPerPosition || 2 == scalarsPerPosition);
 
     SkDEBUGCODE(this->validate();)
+    SK_TRACE_EVENT("SkDraw::drawPosText");
+    SK_TRACE_INC(gDrawPosTextCount);
 
     // nothing to draw
     if (text == NULL || byteLength == 0 ||
@@ -1778,7 +2035,7 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
     SkDrawCacheProc     glyphCacheProc = paint.getDrawCacheProc();
     SkAutoGlyphCache    autoCache(paint, matrix);
     SkGlyphCache*       cache = autoCache.getCache();
-    SkAutoBlitterChoose blitter(*fBitmap, *matrix, paint);
+    SkAutoBlitterChoose blitter(*fBitmap, *matrix, paint, fClipMask);
 
     const char*        stop = text + byteLength;
     AlignProc          alignProc = pick_align_proc(paint.getTextAlign());
@@ -1869,6 +2126,7 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
             pos += scalarsPerPosition;
         }
     }
+    d1g.flush();
 }
 
 #if defined _WIN32 && _MSC_VER >= 1300
@@ -1879,19 +2137,36 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
 
 #include "SkPathMeasure.h"
 
+// the same path is often followed again (e.g. in the next frame)
+static SkPathMeasureCache gTextOnPathMeasureCache;
+
 static void morphpoints(SkPoint dst[], const SkPoint src[], int count,
                         SkPathMeasure& meas, const SkMatrix& matrix) {
     SkMatrix::MapXYProc proc = matrix.getMapXYProc();
+    SkScalar    distances[3];
+    SkScalar    offsets[3];
+    SkPoint     positions[3];
+    SkVector    tangents[3];
 
+    SkASSERT(count <= 3);
     for (int i = 0; i < count; i++) {
-        SkPoint pos;
-        SkVector tangent;
-
-        proc(matrix, src[i].fX, src[i].fY, &pos);
-        SkScalar sx = pos.fX;
-        SkScalar sy = pos.fY;
+        SkPoint pt;
+        proc(matrix, src[i].fX, src[i].fY, &pt);
+        distances[i] = pt.fX;
+        offsets[i] = pt.fY;
+    }
+    if (!meas.getPosTans(distances, count, positions, tangents)) {
+        // nothing to follow, so leave the points where they are
+        for (int i = 0; i < count; i++) {
+            positions[i].set(distances[i], 0);
+            tangents[i].set(SK_Scalar1, 0);
+        }
+    }
 
-        meas.getPosTan(sx, &pos, &tangent);
+    for (int i = 0; i < count; i++) {
+        const SkPoint& pos = positions[i];
+        const SkVector& tangent = tangents[i];
+        SkScalar sy = offsets[i];
 
         /*  This is the old way (that explains our approach but is way too slow
             SkMatrix    matrix;
@@ -1964,7 +2239,8 @@ void SkDraw::drawTextOnPath(const char text[], size_t byteLength,
     }
 
     SkTextToPathIter    iter(text, byteLength, paint, true, true);
-    SkPathMeasure       meas(follow, false);
+    SkAutoCachedPathMeasure acm(&gTextOnPathMeasureCache, follow, false);
+    SkPathMeasure&      meas = acm.get();
     SkScalar            hOffset = 0;
 
     // need to measure first
@@ -2271,29 +2547,91 @@ static int ScalarTo256(SkScalar v) {
     return SkAlpha255To256(scale);
 }
 
-void SkTriColorShader::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
-    SkPoint src;
-
-    for (int i = 0; i < count; i++) {
-        fDstToUnit.mapXY(SkIntToScalar(x), SkIntToScalar(y), &src);
-        x += 1;
-
-        int scale1 = ScalarTo256(src.fX);
-        int scale2 = ScalarTo256(src.fY);
-        int scale0 = 256 - scale1 - scale2;
-        if (scale0 < 0) {
-            if (scale1 > scale2) {
-                scale2 = 256 - scale1;
-            } else {
-                scale1 = 256 - scale2;
-            }
-            scale0 = 0;
+// the weights (out of 256) of the three colors at src, the pixel's position
+// in the triangle's unit space
+static inline void tri_scales(const SkPoint& src, int scales[3]) {
+    int scale1 = ScalarTo256(src.fX);
+    int scale2 = ScalarTo256(src.fY);
+    int scale0 = 256 - scale1 - scale2;
+    if (scale0 < 0) {
+        if (scale1 > scale2) {
+            scale2 = 256 - scale1;
+        } else {
+            scale1 = 256 - scale2;
         }
+        scale0 = 0;
+    }
+    scales[0] = scale0;
+    scales[1] = scale1;
+    scales[2] = scale2;
+}
 
-        dstC[i] = SkAlphaMulQ(fColors[0], scale0) +
-        SkAlphaMulQ(fColors[1], scale1) +
-        SkAlphaMulQ(fColors[2], scale2);
+static inline SkPMColor tri_color(const SkPMColor colors[3],
+                                  const int scales[3]) {
+    return SkAlphaMulQ(colors[0], scales[0]) +
+           SkAlphaMulQ(colors[1], scales[1]) +
+           SkAlphaMulQ(colors[2], scales[2]);
+}
+
+void SkTriColorShader::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
+    // The unit space is an affine map of device space, unless the canvas
+    // has perspective, so the y terms are the same for the whole span. This
+    // computes what mapXY() computes for every affine matrix type.
+    const bool affine = !fDstToUnit.hasPerspective();
+    const SkScalar sx = fDstToUnit.getScaleX();
+    const SkScalar ky = fDstToUnit.getSkewY();
+    const SkScalar rowX = SkScalarMulAdd(SkIntToScalar(y),
+                                         fDstToUnit.getSkewX(),
+                                         fDstToUnit.getTranslateX());
+    const SkScalar rowY = SkScalarMulAdd(SkIntToScalar(y),
+                                         fDstToUnit.getScaleY(),
+                                         fDstToUnit.getTranslateY());
+
+    SkPoint src;
+#define MAP_PIXEL()                                                     \
+    do {                                                                \
+        if (affine) {                                                   \
+            src.fX = SkScalarMul(SkIntToScalar(x), sx) + rowX;          \
+            src.fY = SkScalarMul(SkIntToScalar(x), ky) + rowY;          \
+        } else {                                                        \
+            fDstToUnit.mapXY(SkIntToScalar(x), SkIntToScalar(y), &src); \
+        }                                                               \
+        x += 1;                                                         \
+    } while (0)
+
+    int i = 0;
+#if defined(__SSE2__)
+    // two pixels at a time, with 16 bits per component: each product is at
+    // most 255 * 256, and the shifted products sum to at most 255, so this
+    // is exactly what tri_color() computes
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c0 = _mm_unpacklo_epi8(_mm_set1_epi32(fColors[0]), zero);
+    const __m128i c1 = _mm_unpacklo_epi8(_mm_set1_epi32(fColors[1]), zero);
+    const __m128i c2 = _mm_unpacklo_epi8(_mm_set1_epi32(fColors[2]), zero);
+    for (; i + 1 < count; i += 2) {
+        int a[3], b[3];
+        MAP_PIXEL();
+        tri_scales(src, a);
+        MAP_PIXEL();
+        tri_scales(src, b);
+
+        __m128i s0 = _mm_set_epi16(b[0], b[0], b[0], b[0], a[0], a[0], a[0], a[0]);
+        __m128i s1 = _mm_set_epi16(b[1], b[1], b[1], b[1], a[1], a[1], a[1], a[1]);
+        __m128i s2 = _mm_set_epi16(b[2], b[2], b[2], b[2], a[2], a[2], a[2], a[2]);
+        __m128i sum = _mm_add_epi16(
+                _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(c0, s0), 8),
+                              _mm_srli_epi16(_mm_mullo_epi16(c1, s1), 8)),
+                _mm_srli_epi16(_mm_mullo_epi16(c2, s2), 8));
+        _mm_storel_epi64((__m128i*)&dstC[i], _mm_packus_epi16(sum, sum));
+    }
+#endif
+    for (; i < count; i++) {
+        int scales[3];
+        MAP_PIXEL();
+        tri_scales(src, scales);
+        dstC[i] = tri_color(fColors, scales);
     }
+#undef MAP_PIXEL
 }
 
 void SkDraw::drawVertices(SkCanvas::VertexMode vmode, int count,
@@ -2368,7 +2706,7 @@ void SkDraw::drawVertices(SkCanvas::VertexMode vmode, int count,
         }
     }
 
-    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, p);
+    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, p, fClipMask);
     // setup our state and function pointer for iterating triangles
     VertState       state(count, indices, indexCount);
     VertState::Proc vertProc = state.chooseProc(vmode);
@@ -18,6 +18,18 @@ struct SkDraw1Glyph {
 	typedef void (*Proc)(const SkDraw1Glyph&, SkFixed x, SkFixed y, const SkGlyph&);
 	
 	Proc init(const SkDraw* draw, SkBlitter* blitter, SkGlyphCache* cache);
+
+    // Blits the glyphs that the proc has batched up. Call it after the last
+    // glyph, while the cache still holds their images.
+    void flush() const;
+
+    enum { kMaxBatchCount = 32 };
+
+    // D1G_NoBounder_RectClip gathers glyphs here, and hands them to the
+    // blitter with a single blitMasks() once it has kMaxBatchCount of them
+    mutable SkMask  fBatchMasks[kMaxBatchCount];
+    mutable SkIRect fBatchClips[kMaxBatchCount];
+    mutable int     fBatchCount;
 };
 
 struct SkDrawProcs {
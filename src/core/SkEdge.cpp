@@ -158,7 +158,11 @@ static inline SkFDot6 cheap_distance(SkFDot6 dx, SkFDot6 dy)
     return dx;
 }
 
-static inline int diff_to_shift(SkFDot6 dx, SkFDot6 dy)
+/*  shiftAA is the shift the points were scaled up by for supersampling (0 if
+    not antialiasing). dx,dy are then in supersampled dot6, and the tolerance
+    is in supersampled pixels.
+ */
+static inline int diff_to_shift(SkFDot6 dx, SkFDot6 dy, int shiftAA)
 {
     // cheap calc of distance from center of p0-p2 to the center of the curve
     SkFDot6 dist = cheap_distance(dx, dy);
@@ -167,7 +171,11 @@ static inline int diff_to_shift(SkFDot6 dx, SkFDot6 dy)
     // down by 5 should give us 1/2 pixel accuracy (assuming our dist is accurate...)
     // this is chosen by heuristic: make it as big as possible (to minimize segments)
     // ... but small enough so that our curves still look smooth
-    dist = (dist + (1 << 4)) >> 5;
+    // When supersampling, an error of half a subpixel is far less than the
+    // coverage can show, so allow a whole subpixel (1/4 of a pixel for
+    // SHIFT == 2).
+    int down = shiftAA ? 6 : 5;
+    dist = (dist + (1 << (down - 1))) >> down;
 
     // each subdivision (shift value) cuts this dist (error) by 1/4
     return (32 - SkCLZ(dist)) >> 1;
@@ -175,6 +183,7 @@ static inline int diff_to_shift(SkFDot6 dx, SkFDot6 dy)
 
 int SkQuadraticEdge::setQuadratic(const SkPoint pts[3], int shift)
 {
+    const int shiftAA = shift;
     SkFDot6 x0, y0, x1, y1, x2, y2;
 
     {
@@ -217,7 +226,7 @@ int SkQuadraticEdge::setQuadratic(const SkPoint pts[3], int shift)
     {
         SkFDot6 dx = ((x1 << 1) - x0 - x2) >> 2;
         SkFDot6 dy = ((y1 << 1) - y0 - y2) >> 2;
-        shift = diff_to_shift(dx, dy);
+        shift = diff_to_shift(dx, dy, shiftAA);
         SkASSERT(shift >= 0);
     }
     // need at least 1 subdivision for our bias trick
@@ -316,6 +325,7 @@ static SkFDot6 cubic_delta_from_line(SkFDot6 a, SkFDot6 b, SkFDot6 c, SkFDot6 d)
 
 int SkCubicEdge::setCubic(const SkPoint pts[4], const SkIRect* clip, int shift)
 {
+    const int shiftAA = shift;
     SkFDot6 x0, y0, x1, y1, x2, y2, x3, y3;
 
     {
@@ -371,7 +381,7 @@ int SkCubicEdge::setCubic(const SkPoint pts[4], const SkIRect* clip, int shift)
         SkFDot6 dx = cubic_delta_from_line(x0, x1, x2, x3);
         SkFDot6 dy = cubic_delta_from_line(y0, y1, y2, y3);
         // add 1 (by observation)
-        shift = diff_to_shift(dx, dy) + 1;
+        shift = diff_to_shift(dx, dy, shiftAA) + 1;
     }
     // need at least 1 subdivision for our bias trick
     SkASSERT(shift > 0);
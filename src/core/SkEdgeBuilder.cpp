@@ -5,36 +5,49 @@
 #include "SkLineClipper.h"
 #include "SkGeometry.h"
 
-SkEdgeBuilder::SkEdgeBuilder() : fAlloc(16*1024) {}
+SkEdgeBuilder::SkEdgeBuilder() : fList(NULL), fCount(0), fCapacity(0) {}
 
-template <typename T> static T* typedAllocThrow(SkChunkAlloc& alloc) {
-    return static_cast<T*>(alloc.allocThrow(sizeof(T)));
+template <typename T> static T* typedAllocThrow(SkAutoScratch& scratch) {
+    return SkScratchAllocT<T>(&scratch, 1);
+}
+
+void SkEdgeBuilder::push(SkEdge* edge) {
+    if (fCount == fCapacity) {
+        // the old list stays in the scratch memory until the next build()
+        fCapacity = SkMax32(fCapacity * 2, 32);
+        SkEdge** list = SkScratchAllocT<SkEdge*>(&fScratch, fCapacity);
+        if (fCount > 0) {
+            memcpy(list, fList, fCount * sizeof(SkEdge*));
+        }
+        fList = list;
+    }
+    fList[fCount++] = edge;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkEdgeBuilder::addLine(const SkPoint pts[]) {
-    SkEdge* edge = typedAllocThrow<SkEdge>(fAlloc);
+    SkEdge* edge = typedAllocThrow<SkEdge>(fScratch);
     if (edge->setLine(pts[0], pts[1], NULL, fShiftUp)) {
-        fList.push(edge);
+        this->push(edge);
     } else {
         // TODO: unallocate edge from storage...
     }
 }
 
 void SkEdgeBuilder::addQuad(const SkPoint pts[]) {
-    SkQuadraticEdge* edge = typedAllocThrow<SkQuadraticEdge>(fAlloc);
+    SkQuadraticEdge* edge = typedAllocThrow<SkQuadraticEdge>(fScratch);
     if (edge->setQuadratic(pts, fShiftUp)) {
-        fList.push(edge);
+        this->push(edge);
     } else {
         // TODO: unallocate edge from storage...
     }
 }
 
 void SkEdgeBuilder::addCubic(const SkPoint pts[]) {
-    SkCubicEdge* edge = typedAllocThrow<SkCubicEdge>(fAlloc);
+    SkCubicEdge* edge = typedAllocThrow<SkCubicEdge>(fScratch);
     if (edge->setCubic(pts, NULL, fShiftUp)) {
-        fList.push(edge);
+        this->push(edge);
     } else {
         // TODO: unallocate edge from storage...
     }
@@ -61,6 +74,29 @@ void SkEdgeBuilder::addClipper(SkEdgeClipper* clipper) {
     }
 }
 
+void SkEdgeBuilder::addVLine(SkScalar x, SkScalar y0, SkScalar y1) {
+    SkPoint pts[2];
+    pts[0].set(x, y0);
+    pts[1].set(x, y1);
+    this->addLine(pts);
+}
+
+void SkEdgeBuilder::addChoppedQuad(const SkPoint pts[]) {
+    SkPoint monoX[5];
+    int n = SkChopQuadAtYExtrema(pts, monoX);
+    for (int i = 0; i <= n; i++) {
+        this->addQuad(&monoX[i * 2]);
+    }
+}
+
+void SkEdgeBuilder::addChoppedCubic(const SkPoint pts[]) {
+    SkPoint monoY[10];
+    int n = SkChopCubicAtYExtrema(pts, monoY);
+    for (int i = 0; i <= n; i++) {
+        this->addCubic(&monoY[i * 3]);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static void setShiftedClip(SkRect* dst, const SkIRect& src, int shift) {
@@ -70,10 +106,81 @@ static void setShiftedClip(SkRect* dst, const SkIRect& src, int shift) {
              SkIntToScalar(src.fBottom >> shift));
 }
 
+enum CurvePlacement {
+    kOutside_CurvePlacement,    // wholly above or below the clip
+    kLeft_CurvePlacement,       // wholly to the left of the clip
+    kRight_CurvePlacement,      // wholly to the right of the clip
+    kInside_CurvePlacement,
+    kCrosses_CurvePlacement
+};
+
+// Where a curve is relative to the clip, going by its control points.
+static CurvePlacement place_curve(const SkPoint pts[], int count,
+                                  const SkRect& clip) {
+    SkRect bounds;
+    bounds.set(pts, count);
+    if (bounds.fTop >= clip.fBottom || bounds.fBottom <= clip.fTop) {
+        return kOutside_CurvePlacement;
+    }
+    if (bounds.fRight <= clip.fLeft) {
+        return kLeft_CurvePlacement;
+    }
+    if (bounds.fLeft >= clip.fRight) {
+        return kRight_CurvePlacement;
+    }
+    if (clip.contains(bounds)) {
+        return kInside_CurvePlacement;
+    }
+    return kCrosses_CurvePlacement;
+}
+
+static inline SkScalar pin_to_clip_y(SkScalar y, const SkRect& clip) {
+    return SkScalarPin(y, clip.fTop, clip.fBottom);
+}
+
+/*  Most of a zoomed in path's curves are wholly outside of the clip, or
+    wholly inside of it, so they're sorted out before going through the
+    SkEdgeClipper (which chops every curve at its extrema first). A curve to
+    the left or right of the clip only matters for its winding, which is the
+    same as for a vertical line on the clip's edge, from where the curve
+    starts to where it ends.
+ */
+bool SkEdgeBuilder::addCulledCurve(const SkPoint pts[], int count,
+                                   const SkRect& clip) {
+    CurvePlacement placement = place_curve(pts, count, clip);
+    switch (placement) {
+        case kOutside_CurvePlacement:
+            return true;
+        case kLeft_CurvePlacement:
+        case kRight_CurvePlacement: {
+            SkScalar x = kLeft_CurvePlacement == placement ? clip.fLeft :
+                                                             clip.fRight;
+            SkScalar y0 = pin_to_clip_y(pts[0].fY, clip);
+            SkScalar y1 = pin_to_clip_y(pts[count - 1].fY, clip);
+            if (y0 != y1) {
+                this->addVLine(x, y0, y1);
+            }
+            return true;
+        }
+        case kInside_CurvePlacement:
+            if (3 == count) {
+                this->addChoppedQuad(pts);
+            } else {
+                this->addChoppedCubic(pts);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
 int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
                          int shiftUp) {
-    fAlloc.reset();
-    fList.reset();
+    fScratch.reset();
+    fCount = 0;
+    // most paths make about one edge per point
+    fCapacity = SkMax32(path.countPoints(), 32);
+    fList = SkScratchAllocT<SkEdge*>(&fScratch, fCapacity);
     fShiftUp = shiftUp;
 
     SkPath::Iter    iter(path, true);
@@ -101,12 +208,14 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
                     break;
                 }
                 case SkPath::kQuad_Verb:
-                    if (clipper.clipQuad(pts, clip)) {
+                    if (!this->addCulledCurve(pts, 3, clip) &&
+                            clipper.clipQuad(pts, clip)) {
                         this->addClipper(&clipper);
                     }
                     break;
                 case SkPath::kCubic_Verb:
-                    if (clipper.clipCubic(pts, clip)) {
+                    if (!this->addCulledCurve(pts, 4, clip) &&
+                            clipper.clipCubic(pts, clip)) {
                         this->addClipper(&clipper);
                     }
                     break;
@@ -126,29 +235,19 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
                 case SkPath::kLine_Verb:
                     this->addLine(pts);
                     break;
-                case SkPath::kQuad_Verb: {
-                    SkPoint monoX[5];
-                    int n = SkChopQuadAtYExtrema(pts, monoX);
-                    for (int i = 0; i <= n; i++) {
-                        this->addQuad(&monoX[i * 2]);
-                    }
+                case SkPath::kQuad_Verb:
+                    this->addChoppedQuad(pts);
                     break;
-                }
-                case SkPath::kCubic_Verb: {
-                    SkPoint monoY[10];
-                    int n = SkChopCubicAtYExtrema(pts, monoY);
-                    for (int i = 0; i <= n; i++) {
-                        this->addCubic(&monoY[i * 3]);
-                    }
+                case SkPath::kCubic_Verb:
+                    this->addChoppedCubic(pts);
                     break;
-                }
                 default:
                     SkASSERT(!"unexpected verb");
                     break;
             }
         }
     }
-    return fList.count();
+    return fCount;
 }
 
 
@@ -1,31 +1,43 @@
 #ifndef SkEdgeBuilder_DEFINED
 #define SkEdgeBuilder_DEFINED
 
-#include "SkChunkAlloc.h"
 #include "SkRect.h"
-#include "SkTDArray.h"
+#include "SkScratchAlloc.h"
 
 struct SkEdge;
 class SkEdgeClipper;
 class SkPath;
 
+/*  The edges (and their list) live in the thread's SkScratchAlloc until the
+    builder goes out of scope, so it must be used like an SkAutoScratch.
+ */
 class SkEdgeBuilder {
 public:
     SkEdgeBuilder();
     
     int build(const SkPath& path, const SkIRect* clip, int shiftUp);
 
-    SkEdge** edgeList() { return fList.begin(); }
+    SkEdge** edgeList() { return fList; }
 
 private:
-    SkChunkAlloc        fAlloc;
-    SkTDArray<SkEdge*>  fList;
-    int                 fShiftUp;
+    SkAutoScratch   fScratch;
+    SkEdge**        fList;
+    int             fCount;
+    int             fCapacity;
+    int             fShiftUp;
+
+    void push(SkEdge*);
 
     void addLine(const SkPoint pts[]);
     void addQuad(const SkPoint pts[]);
     void addCubic(const SkPoint pts[]);
     void addClipper(SkEdgeClipper*);
+    void addVLine(SkScalar x, SkScalar y0, SkScalar y1);
+    // these chop the curve at its Y extrema, as the edges need
+    void addChoppedQuad(const SkPoint pts[]);
+    void addChoppedCubic(const SkPoint pts[]);
+    // returns false if the curve crosses the clip, and so needs clipping
+    bool addCulledCurve(const SkPoint pts[], int count, const SkRect& clip);
 };
 
 #endif
@@ -18,10 +18,25 @@
 #include "SkFlate.h"
 #include "SkStream.h"
 
+#include "SkTLS.h"
+
 #ifndef SK_ZLIB_INCLUDE
 bool SkFlate::HaveFlate() { return false; }
 bool SkFlate::Deflate(SkStream*, SkWStream*) { return false; }
+bool SkFlate::Deflate(const void*, size_t, SkWStream*) { return false; }
+bool SkFlate::Deflate(const SkData*, SkWStream*) { return false; }
 bool SkFlate::Inflate(SkStream*, SkWStream*) { return false; }
+
+struct SkDeflater::State {};
+
+SkDeflater::SkDeflater(int level, Strategy strategy)
+    : fLevel(level), fStrategy(strategy), fState(NULL), fDst(NULL),
+      fOK(false) {}
+SkDeflater::~SkDeflater() {}
+bool SkDeflater::begin(SkWStream*) { return false; }
+bool SkDeflater::write(const void*, size_t) { return false; }
+bool SkDeflater::finish() { return false; }
+bool SkDeflater::deflate(SkStream*, SkWStream*) { return false; }
 #else
 
 // static
@@ -119,20 +134,34 @@ bool doFlate(bool compress, SkStream* src, SkWStream* dst) {
 
 }
 
+// each thread keeps a deflater, so that SkPDFStream and friends don't set
+// zlib up again for every stream
+static void* create_deflater() {
+    return SkNEW(SkDeflater);
+}
+
+static void delete_deflater(void* deflater) {
+    SkDELETE((SkDeflater*)deflater);
+}
+
+static SkDeflater* get_deflater() {
+    return (SkDeflater*)SkTLS::Get(create_deflater, delete_deflater);
+}
+
 // static
 bool SkFlate::Deflate(SkStream* src, SkWStream* dst) {
-    return doFlate(true, src, dst);
+    return get_deflater()->deflate(src, dst);
 }
 
 bool SkFlate::Deflate(const void* ptr, size_t len, SkWStream* dst) {
-    SkMemoryStream stream(ptr, len);
-    return doFlate(true, &stream, dst);
+    SkDeflater* deflater = get_deflater();
+    return deflater->begin(dst) && deflater->write(ptr, len) &&
+           deflater->finish();
 }
 
 bool SkFlate::Deflate(const SkData* data, SkWStream* dst) {
     if (data) {
-        SkMemoryStream stream(data->data(), data->size());
-        return doFlate(true, &stream, dst);
+        return Deflate(data->data(), data->size(), dst);
     }
     return false;
 }
@@ -142,5 +171,135 @@ bool SkFlate::Inflate(SkStream* src, SkWStream* dst) {
     return doFlate(false, src, dst);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+struct SkDeflater::State {
+    z_stream    fStream;
+    uint8_t     fOutput[4 * kBufferSize];
+};
+
+static int zlib_strategy(SkDeflater::Strategy strategy) {
+    switch (strategy) {
+        case SkDeflater::kFiltered_Strategy:
+            return Z_FILTERED;
+        case SkDeflater::kHuffmanOnly_Strategy:
+            return Z_HUFFMAN_ONLY;
+        case SkDeflater::kRLE_Strategy:
+            return Z_RLE;
+        default:
+            return Z_DEFAULT_STRATEGY;
+    }
+}
+
+SkDeflater::SkDeflater(int level, Strategy strategy)
+    : fLevel(level), fStrategy(strategy), fState(NULL), fDst(NULL),
+      fOK(false) {
+    SkASSERT(kDefault_Level == level ||
+             (level >= kNone_Level && level <= kBest_Level));
+}
+
+SkDeflater::~SkDeflater() {
+    if (fState) {
+        deflateEnd(&fState->fStream);
+        SkDELETE(fState);
+    }
+}
+
+bool SkDeflater::begin(SkWStream* dst) {
+    if (NULL == fState) {
+        State* state = SkNEW(State);
+        z_stream& zs = state->fStream;
+        zs.zalloc = NULL;
+        zs.zfree = NULL;
+        zs.opaque = NULL;
+        if (deflateInit2(&zs, fLevel, Z_DEFLATED, MAX_WBITS, 8,
+                         zlib_strategy(fStrategy)) != Z_OK) {
+            SkDELETE(state);
+            fDst = NULL;
+            return false;
+        }
+        fState = state;
+    } else if (deflateReset(&fState->fStream) != Z_OK) {
+        fDst = NULL;
+        return false;
+    }
+    fState->fStream.next_out = fState->fOutput;
+    fState->fStream.avail_out = sizeof(fState->fOutput);
+    fDst = dst;
+    fOK = true;
+    return true;
+}
+
+// write out what's in the output buffer
+bool SkDeflater::drain() {
+    z_stream& zs = fState->fStream;
+    size_t size = sizeof(fState->fOutput) - zs.avail_out;
+    if (size > 0 && !fDst->write(fState->fOutput, size)) {
+        fOK = false;
+    }
+    zs.next_out = fState->fOutput;
+    zs.avail_out = sizeof(fState->fOutput);
+    return fOK;
+}
+
+bool SkDeflater::write(const void* data, size_t size) {
+    if (NULL == fDst || !fOK) {
+        return false;
+    }
+    z_stream& zs = fState->fStream;
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = size;
+    while (zs.avail_in > 0) {
+        if (0 == zs.avail_out && !this->drain()) {
+            return false;
+        }
+        if (::deflate(&zs, Z_NO_FLUSH) != Z_OK) {
+            fOK = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SkDeflater::finish() {
+    if (NULL == fDst) {
+        return false;
+    }
+    z_stream& zs = fState->fStream;
+    zs.next_in = NULL;
+    zs.avail_in = 0;
+    while (fOK) {
+        int rc = ::deflate(&zs, Z_FINISH);
+        if (rc != Z_OK && rc != Z_STREAM_END) {
+            fOK = false;
+        }
+        if (!this->drain() || Z_STREAM_END == rc) {
+            break;
+        }
+    }
+    fDst = NULL;
+    return fOK;
+}
+
+bool SkDeflater::deflate(SkStream* src, SkWStream* dst) {
+    if (!this->begin(dst)) {
+        return false;
+    }
+    const void* input = src->getMemoryBase();
+    size_t inputLength = src->getLength();
+    if (input != NULL && inputLength > 0) {
+        this->write(input, inputLength);
+    } else {
+        uint8_t buffer[kBufferSize];
+        size_t read;
+        while ((read = src->read(buffer, sizeof(buffer))) > 0) {
+            if (!this->write(buffer, read)) {
+                break;
+            }
+        }
+    }
+    return this->finish();
+}
+
 #endif
 
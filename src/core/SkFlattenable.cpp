@@ -3,6 +3,7 @@
 
 #include "SkMatrix.h"
 #include "SkRegion.h"
+#include "SkTSearch.h"
 
 void SkReadMatrix(SkReader32* reader, SkMatrix* matrix) {
     size_t size = matrix->unflatten(reader->peek());
@@ -321,8 +322,54 @@ struct Pair {
     SkFlattenable::Factory  fFactory;
 };
 
-static int gCount;
-static Pair gPairs[MAX_PAIR_COUNT];
+/*  The registry is kept sorted twice, by name and by factory, so that pictures
+    and pipes with many effects don't pay a linear walk (of string compares)
+    for each factory they resolve. Registering a name (or factory) again
+    replaces the earlier pair, so the last registration wins either way.
+ */
+static int  gNameCount;
+static Pair gByName[MAX_PAIR_COUNT];
+static int  gFactoryCount;
+static Pair gByFactory[MAX_PAIR_COUNT];
+
+static inline const void* factory_key(SkFlattenable::Factory factory) {
+    return (const void*)factory;
+}
+
+static int find_name(const char name[]) {
+    return SkStrSearch(&gByName[0].fName, gNameCount, name, sizeof(Pair));
+}
+
+// returns the index of factory, or ~ the index it would be inserted at
+static int find_factory(SkFlattenable::Factory factory) {
+    const void* key = factory_key(factory);
+    int lo = 0;
+    int hi = gFactoryCount;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        const void* elem = factory_key(gByFactory[mid].fFactory);
+        if (elem < key) {
+            lo = mid + 1;
+        } else if (elem > key) {
+            hi = mid;
+        } else {
+            return mid;
+        }
+    }
+    return ~lo;
+}
+
+static void insert_pair(Pair pairs[], int* count, int index, const Pair& pair) {
+    if (index >= 0) {
+        pairs[index] = pair;
+        return;
+    }
+    index = ~index;
+    SkASSERT(*count < MAX_PAIR_COUNT);
+    memmove(&pairs[index + 1], &pairs[index], (*count - index) * sizeof(Pair));
+    pairs[index] = pair;
+    *count += 1;
+}
 
 void SkFlattenable::Register(const char name[], Factory factory) {
     SkASSERT(name);
@@ -330,35 +377,26 @@ void SkFlattenable::Register(const char name[], Factory factory) {
 
     static bool gOnce;
     if (!gOnce) {
-        gCount = 0;
+        gNameCount = 0;
+        gFactoryCount = 0;
         gOnce = true;
     }
 
-    SkASSERT(gCount < MAX_PAIR_COUNT);
-
-    gPairs[gCount].fName = name;
-    gPairs[gCount].fFactory = factory;
-    gCount += 1;
+    Pair pair;
+    pair.fName = name;
+    pair.fFactory = factory;
+    insert_pair(gByName, &gNameCount, find_name(name), pair);
+    insert_pair(gByFactory, &gFactoryCount, find_factory(factory), pair);
 }
 
 SkFlattenable::Factory SkFlattenable::NameToFactory(const char name[]) {
-    const Pair* pairs = gPairs;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(pairs[i].fName, name) == 0) {
-            return pairs[i].fFactory;
-        }
-    }
-    return NULL;
+    int index = find_name(name);
+    return index >= 0 ? gByName[index].fFactory : NULL;
 }
 
 const char* SkFlattenable::FactoryToName(Factory fact) {
-    const Pair* pairs = gPairs;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (pairs[i].fFactory == fact) {
-            return pairs[i].fName;
-        }
-    }
-    return NULL;
+    int index = find_factory(fact);
+    return index >= 0 ? gByFactory[index].fName : NULL;
 }
 
 bool SkFlattenable::toDumpString(SkString* str) const {
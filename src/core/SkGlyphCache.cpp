@@ -17,8 +17,12 @@
 
 #include "SkGlyphCache.h"
 #include "SkFontHost.h"
+#include "SkGlyphDiskCache.h"
 #include "SkPaint.h"
+#include "SkPurgeableCache.h"
 #include "SkTemplates.h"
+#include "SkTrace.h"
+#include "SkUtils.h"
 
 #define SPEW_PURGE_STATUS
 //#define USE_CACHE_HASH
@@ -63,19 +67,20 @@ SkGlyphCache::SkGlyphCache(const SkDescriptor* desc)
     fDesc = desc->copy();
     fScalerContext = SkScalerContext::Create(desc);
     fScalerContext->getFontMetrics(NULL, &fFontMetricsY);
-
-    // init to 0 so that all of the pointers will be null
-    memset(fGlyphHash, 0, sizeof(fGlyphHash));
-    // init with 0xFF so that the charCode field will be -1, which is invalid
-    memset(fCharToGlyphHash, 0xFF, sizeof(fCharToGlyphHash));
+    fDiskCache = SkGlyphDiskCache::Open(desc);
 
     fMemoryUsed = sizeof(*this) + kMinGlphAlloc + kMinImageAlloc;
 
+    fGlyphHash = NULL;
+    fCharToGlyphHash = NULL;
+    this->allocHashTables(kMinHashBits);
+
     fGlyphArray.setReserve(METRICS_RESERVE_COUNT);
 
     fMetricsCount = 0;
     fAdvanceCount = 0;
     fAuxProcList = NULL;
+    fAdvanceTable = NULL;
 }
 
 SkGlyphCache::~SkGlyphCache() {
@@ -88,11 +93,67 @@ SkGlyphCache::~SkGlyphCache() {
         }
         gptr += 1;
     }
+    if (fDiskCache) {
+        fDiskCache->save(fGlyphArray);
+        SkDELETE(fDiskCache);
+    }
+    sk_free(fGlyphHash);
+    sk_free(fCharToGlyphHash);
+    sk_free(fAdvanceTable);
     SkDescriptor::Free(fDesc);
     SkDELETE(fScalerContext);
     this->invokeAndRemoveAuxProcs();
 }
 
+void SkGlyphCache::allocHashTables(int hashBits) {
+    SkASSERT(hashBits >= kMinHashBits && hashBits <= kMaxHashBits);
+
+    const size_t count = 1 << hashBits;
+    fHashBits = hashBits;
+    fHashMask = count - 1;
+    fHashShift = SkGlyph::kSubShift + SkGlyph::kSubBits*2 - hashBits;
+
+    fGlyphHash = (SkGlyph**)sk_malloc_throw(count * sizeof(SkGlyph*));
+    fCharToGlyphHash = (CharGlyphRec*)sk_malloc_throw(count *
+                                                      sizeof(CharGlyphRec));
+    // init to 0 so that all of the pointers will be null
+    memset(fGlyphHash, 0, count * sizeof(SkGlyph*));
+    // init with 0xFF so that the charCode field will be -1, which is invalid
+    memset(fCharToGlyphHash, 0xFF, count * sizeof(CharGlyphRec));
+
+    fMemoryUsed += count * (sizeof(SkGlyph*) + sizeof(CharGlyphRec));
+}
+
+/*  The tables are direct-mapped, so once the strike holds more glyphs than
+    they have slots (e.g. CJK text), most lookups would miss and fall back to
+    the binary search in lookupMetrics. To keep them effective, we double them
+    whenever the strike holds more than half as many glyphs as there are slots,
+    and rehash the existing entries.
+ */
+void SkGlyphCache::growHashTables() {
+    SkGlyph**       oldGlyphHash = fGlyphHash;
+    CharGlyphRec*   oldCharHash = fCharToGlyphHash;
+    const unsigned  oldCount = fHashMask + 1;
+
+    this->allocHashTables(fHashBits + 1);
+
+    SkGlyph** gptr = fGlyphArray.begin();
+    SkGlyph** gstop = fGlyphArray.end();
+    for (; gptr < gstop; gptr++) {
+        fGlyphHash[ID2HashIndex((*gptr)->fID)] = *gptr;
+    }
+    for (unsigned i = 0; i < oldCount; i++) {
+        const CharGlyphRec& rec = oldCharHash[i];
+        if (rec.fID != SK_MaxU32) {
+            fCharToGlyphHash[ID2HashIndex(rec.fID)] = rec;
+        }
+    }
+
+    sk_free(oldGlyphHash);
+    sk_free(oldCharHash);
+    fMemoryUsed -= oldCount * (sizeof(SkGlyph*) + sizeof(CharGlyphRec));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef SK_DEBUG
@@ -129,15 +190,88 @@ const SkGlyph& SkGlyphCache::getUnicharAdvance(SkUnichar charCode) {
     CharGlyphRec* rec = &fCharToGlyphHash[ID2HashIndex(id)];
 
     if (rec->fID != id) {
+        // this ID is based on the glyph index
+        SkGlyph* glyph = this->lookupMetrics(
+                SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode)),
+                kJustAdvance_MetricsType);
+        // lookupMetrics may have grown the table, so find rec again
+        rec = &fCharToGlyphHash[ID2HashIndex(id)];
         // this ID is based on the UniChar
         rec->fID = id;
-        // this ID is based on the glyph index
-        id = SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode));
-        rec->fGlyph = this->lookupMetrics(id, kJustAdvance_MetricsType);
+        rec->fGlyph = glyph;
     }
     return *rec->fGlyph;
 }
 
+SkFixed SkGlyphCache::lookupAdvanceX(SkUnichar charCode) {
+    SkFixed advance = this->getUnicharAdvance(charCode).fAdvanceX;
+    if ((unsigned)charCode < kAdvanceTableCount) {
+        if (NULL == fAdvanceTable) {
+            const size_t size = kAdvanceTableCount * sizeof(SkFixed);
+            fAdvanceTable = (SkFixed*)sk_malloc_throw(size);
+            sk_memset32((uint32_t*)fAdvanceTable, kUnknownAdvance,
+                        kAdvanceTableCount);
+            fMemoryUsed += size;
+        }
+        fAdvanceTable[charCode] = advance;
+    }
+    return advance;
+}
+
+/*  Once the advances we need are in the table, the sum has no branches, and
+    is spread over several accumulators so that the adds don't wait on each
+    other.
+ */
+template <typename T>
+int64_t SkGlyphCache::sumAdvancesX(const T chars[], int count) {
+    for (int i = 0; i < count; i++) {
+        SkASSERT(chars[i] < kAdvanceTableCount);
+        if (NULL == fAdvanceTable ||
+                kUnknownAdvance == fAdvanceTable[chars[i]]) {
+            this->lookupAdvanceX(chars[i]);
+        }
+    }
+
+    const SkFixed* table = fAdvanceTable;
+    int64_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sum0 += table[chars[i + 0]];
+        sum1 += table[chars[i + 1]];
+        sum2 += table[chars[i + 2]];
+        sum3 += table[chars[i + 3]];
+    }
+    for (; i < count; i++) {
+        sum0 += table[chars[i]];
+    }
+    return sum0 + sum1 + sum2 + sum3;
+}
+
+int64_t SkGlyphCache::sumUTF8AdvancesX(const char** text, const char* stop,
+                                       int* count) {
+    const uint8_t* start = (const uint8_t*)*text;
+    const uint8_t* end = (const uint8_t*)stop;
+    const uint8_t* ptr = start;
+    while (ptr < end && *ptr < 0x80) {
+        ptr += 1;
+    }
+    *text = (const char*)ptr;
+    *count += ptr - start;
+    return this->sumAdvancesX(start, ptr - start);
+}
+
+int64_t SkGlyphCache::sumUTF16AdvancesX(const uint16_t** text,
+                                        const uint16_t* stop, int* count) {
+    const uint16_t* start = *text;
+    const uint16_t* ptr = start;
+    while (ptr < stop && *ptr < kAdvanceTableCount) {
+        ptr += 1;
+    }
+    *text = ptr;
+    *count += ptr - start;
+    return this->sumAdvancesX(start, ptr - start);
+}
+
 const SkGlyph& SkGlyphCache::getGlyphIDAdvance(uint16_t glyphID) {
     VALIDATE();
     uint32_t id = SkGlyph::MakeID(glyphID);
@@ -146,7 +280,8 @@ const SkGlyph& SkGlyphCache::getGlyphIDAdvance(uint16_t glyphID) {
 
     if (NULL == glyph || glyph->fID != id) {
         glyph = this->lookupMetrics(glyphID, kJustAdvance_MetricsType);
-        fGlyphHash[index] = glyph;
+        // lookupMetrics may have grown the table, so recompute the index
+        fGlyphHash[ID2HashIndex(id)] = glyph;
     }
     return *glyph;
 }
@@ -160,11 +295,15 @@ const SkGlyph& SkGlyphCache::getUnicharMetrics(SkUnichar charCode) {
 
     if (rec->fID != id) {
         RecordHashCollisionIf(rec->fGlyph != NULL);
+        // this ID is based on the glyph index
+        SkGlyph* glyph = this->lookupMetrics(
+                SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode)),
+                kFull_MetricsType);
+        // lookupMetrics may have grown the table, so find rec again
+        rec = &fCharToGlyphHash[ID2HashIndex(id)];
         // this ID is based on the UniChar
         rec->fID = id;
-        // this ID is based on the glyph index
-        id = SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode));
-        rec->fGlyph = this->lookupMetrics(id, kFull_MetricsType);
+        rec->fGlyph = glyph;
     } else {
         RecordHashSuccess();
         if (rec->fGlyph->isJustAdvance()) {
@@ -183,11 +322,15 @@ const SkGlyph& SkGlyphCache::getUnicharMetrics(SkUnichar charCode,
 
     if (rec->fID != id) {
         RecordHashCollisionIf(rec->fGlyph != NULL);
+        // this ID is based on the glyph index
+        SkGlyph* glyph = this->lookupMetrics(
+                SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode), x, y),
+                kFull_MetricsType);
+        // lookupMetrics may have grown the table, so find rec again
+        rec = &fCharToGlyphHash[ID2HashIndex(id)];
         // this ID is based on the UniChar
         rec->fID = id;
-        // this ID is based on the glyph index
-        id = SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode), x, y);
-        rec->fGlyph = this->lookupMetrics(id, kFull_MetricsType);
+        rec->fGlyph = glyph;
     } else {
         RecordHashSuccess();
         if (rec->fGlyph->isJustAdvance()) {
@@ -207,7 +350,8 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID) {
     if (NULL == glyph || glyph->fID != id) {
         RecordHashCollisionIf(glyph != NULL);
         glyph = this->lookupMetrics(glyphID, kFull_MetricsType);
-        fGlyphHash[index] = glyph;
+        // lookupMetrics may have grown the table, so recompute the index
+        fGlyphHash[ID2HashIndex(id)] = glyph;
     } else {
         RecordHashSuccess();
         if (glyph->isJustAdvance()) {
@@ -228,7 +372,8 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID,
     if (NULL == glyph || glyph->fID != id) {
         RecordHashCollisionIf(glyph != NULL);
         glyph = this->lookupMetrics(id, kFull_MetricsType);
-        fGlyphHash[index] = glyph;
+        // lookupMetrics may have grown the table, so recompute the index
+        fGlyphHash[ID2HashIndex(id)] = glyph;
     } else {
         RecordHashSuccess();
         if (glyph->isJustAdvance()) {
@@ -239,7 +384,60 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID,
     return *glyph;
 }
 
+void SkGlyphCache::getGlyphIDMetrics(const uint16_t glyphIDs[], int count,
+                                     const SkGlyph* glyphs[],
+                                     bool wantImages) {
+    VALIDATE();
+    SkAutoSTMalloc<64, SkGlyph*> allStorage(count);
+    SkAutoSTMalloc<64, SkGlyph*> pendingStorage(count);
+    SkGlyph** all = allStorage.get();
+    SkGlyph** pending = pendingStorage.get();
+    int pendingCount = 0;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t id = SkGlyph::MakeID(glyphIDs[i]);
+        SkGlyph* glyph = fGlyphHash[ID2HashIndex(id)];
+
+        if (NULL == glyph || glyph->fID != id) {
+            glyph = this->lookupMetrics(id, kDeferred_MetricsType);
+            fGlyphHash[ID2HashIndex(id)] = glyph;
+        }
+        if (glyph->isJustAdvance()) {
+            pending[pendingCount++] = glyph;
+        }
+        all[i] = glyph;
+    }
+    // duplicate IDs are skipped once their first copy has its metrics
+    fScalerContext->getMetrics(pending, pendingCount);
+    fMetricsCount += pendingCount;
+
+    if (wantImages) {
+        pendingCount = 0;
+        for (int i = 0; i < count; i++) {
+            // allocImage returns false for the second copy of a glyph
+            if (this->allocImage(*all[i])) {
+                pending[pendingCount++] = all[i];
+            }
+        }
+        fScalerContext->getImages(pending, pendingCount);
+    }
+
+    if (glyphs) {
+        for (int i = 0; i < count; i++) {
+            SkASSERT(all[i]->isFullMetrics());
+            glyphs[i] = all[i];
+        }
+    }
+}
+
+// each of these means asking the scaler context
+SK_TRACE_COUNTER(gMetricsMisses, "glyphcache.metrics_misses");
+SK_TRACE_COUNTER(gImageMisses, "glyphcache.image_misses");
+SK_TRACE_COUNTER(gPathMisses, "glyphcache.path_misses");
+SK_TRACE_COUNTER(gStrikeMisses, "glyphcache.strike_misses");
+
 SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
+    SK_TRACE_INC(gMetricsMisses);
     SkGlyph* glyph;
 
     int     hi = 0;
@@ -280,7 +478,17 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
     glyph->init(id);
     *fGlyphArray.insert(hi) = glyph;
 
-    if (kJustAdvance_MetricsType == mtype) {
+    if (fHashBits < kMaxHashBits &&
+            (unsigned)fGlyphArray.count() > ((fHashMask + 1) >> 1)) {
+        this->growHashTables();
+    }
+
+    if (fDiskCache && fDiskCache->findMetrics(glyph)) {
+        // the full metrics are as cheap as the advance when read from disk
+        fMetricsCount += 1;
+    } else if (kDeferred_MetricsType == mtype) {
+        // leave the glyph marked as just-advance, so the caller finds it
+    } else if (kJustAdvance_MetricsType == mtype) {
         fScalerContext->getAdvance(glyph);
         fAdvanceCount += 1;
     } else {
@@ -292,25 +500,39 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
     return glyph;
 }
 
-const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
-    if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
-        if (glyph.fImage == NULL) {
-            size_t  size = glyph.computeImageSize();
-            const_cast<SkGlyph&>(glyph).fImage = fImageAlloc.alloc(size,
-                                        SkChunkAlloc::kReturnNil_AllocFailType);
-            // check that alloc() actually succeeded
-            if (glyph.fImage) {
-                fScalerContext->getImage(glyph);
-                fMemoryUsed += size;
-            }
+/*  Allocate the image for the glyph, if it needs one and does not have it yet,
+    and fill it from the disk cache if we can. Returns true if the image still
+    has to be generated by the scaler context.
+ */
+bool SkGlyphCache::allocImage(const SkGlyph& glyph) {
+    if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth &&
+            NULL == glyph.fImage) {
+        size_t  size = glyph.computeImageSize();
+        const_cast<SkGlyph&>(glyph).fImage = fImageAlloc.alloc(size,
+                                    SkChunkAlloc::kReturnNil_AllocFailType);
+        // check that alloc() actually succeeded
+        if (glyph.fImage) {
+            fMemoryUsed += size;
+            return NULL == fDiskCache || !fDiskCache->findImage(glyph);
         }
     }
+    return false;
+}
+
+const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
+    if (this->allocImage(glyph)) {
+        SK_TRACE_EVENT("SkGlyphCache::getImage");
+        SK_TRACE_INC(gImageMisses);
+        fScalerContext->getImage(glyph);
+    }
     return glyph.fImage;
 }
 
 const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
     if (glyph.fWidth) {
         if (glyph.fPath == NULL) {
+            SK_TRACE_EVENT("SkGlyphCache::getPath");
+            SK_TRACE_INC(gPathMisses);
             const_cast<SkGlyph&>(glyph).fPath = SkNEW(SkPath);
             fScalerContext->getPath(glyph, glyph.fPath);
             fMemoryUsed += sizeof(SkPath) +
@@ -413,8 +635,34 @@ void SkGlyphCache::invokeAndRemoveAuxProcs() {
     }
 #endif
 
-class SkGlyphCache_Globals : public SkGlobals::Rec {
+/*  The strikes are split across several shards, each with its own mutex and
+    list, so that threads drawing text with different strikes don't serialize
+    on a single lock. A strike always lives in the shard picked by its
+    descriptor's checksum. Each shard enforces an equal share of the font
+    cache budget, so together they stay within the budget.
+ */
+#define SHARD_BITCOUNT  3
+#define SHARD_COUNT     (1 << SHARD_BITCOUNT)
+#define SHARD_MASK      (SHARD_COUNT - 1)
+
+static unsigned desc_to_shardindex(const SkDescriptor* desc) {
+    uint32_t n = desc->getChecksum();
+    // use different bits than desc_to_hashindex, so each shard's hash still
+    // gets a spread of values
+    n ^= (n >> 11) ^ (n >> 22);
+    return (n >> 3) & SHARD_MASK;
+}
+
+class SkGlyphCache_Globals {
 public:
+    SkGlyphCache_Globals() {
+        fHead = NULL;
+        fTotalMemoryUsed = 0;
+#ifdef USE_CACHE_HASH
+        memset(fHash, 0, sizeof(fHash));
+#endif
+    }
+
     SkMutex         fMutex;
     SkGlyphCache*   fHead;
     size_t          fTotalMemoryUsed;
@@ -429,40 +677,47 @@ public:
 #endif
 };
 
+class SkGlyphCache_Shards : public SkGlobals::Rec {
+public:
+    SkGlyphCache_Globals    fShards[SHARD_COUNT];
+
+    SkGlyphCache_Globals& find(const SkDescriptor* desc) {
+        return fShards[desc_to_shardindex(desc)];
+    }
+};
+
 #ifdef SK_USE_RUNTIME_GLOBALS
     static SkGlobals::Rec* create_globals() {
-        SkGlyphCache_Globals* rec = SkNEW(SkGlyphCache_Globals);
-        rec->fHead = NULL;
-        rec->fTotalMemoryUsed = 0;
-#ifdef USE_CACHE_HASH
-        memset(rec->fHash, 0, sizeof(rec->fHash));
-#endif
-        return rec;
+        return SkNEW(SkGlyphCache_Shards);
     }
 
-    #define FIND_GC_GLOBALS()   *(SkGlyphCache_Globals*)SkGlobals::Find(SkGlyphCache_GlobalsTag, create_globals)
-    #define GET_GC_GLOBALS()    *(SkGlyphCache_Globals*)SkGlobals::Get(SkGlyphCache_GlobalsTag)
+    #define FIND_GC_GLOBALS()   *(SkGlyphCache_Shards*)SkGlobals::Find(SkGlyphCache_GlobalsTag, create_globals)
+    #define GET_GC_GLOBALS()    *(SkGlyphCache_Shards*)SkGlobals::Get(SkGlyphCache_GlobalsTag)
 #else
-    static SkGlyphCache_Globals gGCGlobals;
+    static SkGlyphCache_Shards gGCGlobals;
     #define FIND_GC_GLOBALS()   gGCGlobals
     #define GET_GC_GLOBALS()    gGCGlobals
 #endif
 
 void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
                                   void* context) {
-    SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
-    SkAutoMutexAcquire    ac(globals.fMutex);
-    SkGlyphCache*         cache;
+    SkGlyphCache_Shards& shards = FIND_GC_GLOBALS();
 
-    globals.validate();
+    for (int i = 0; i < SHARD_COUNT; i++) {
+        SkGlyphCache_Globals& globals = shards.fShards[i];
+        SkAutoMutexAcquire    ac(globals.fMutex);
+        SkGlyphCache*         cache;
 
-    for (cache = globals.fHead; cache != NULL; cache = cache->fNext) {
-        if (proc(cache, context)) {
-            break;
+        globals.validate();
+
+        for (cache = globals.fHead; cache != NULL; cache = cache->fNext) {
+            if (proc(cache, context)) {
+                return;
+            }
         }
-    }
 
-    globals.validate();
+        globals.validate();
+    }
 }
 
 /*  This guy calls the visitor from within the mutext lock, so the visitor
@@ -476,7 +731,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(const SkDescriptor* desc,
                               void* context) {
     SkASSERT(desc);
 
-    SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
+    SkGlyphCache_Globals& globals = FIND_GC_GLOBALS().find(desc);
     SkAutoMutexAcquire    ac(globals.fMutex);
     SkGlyphCache*         cache;
     bool                  insideMutex = true;
@@ -506,7 +761,12 @@ SkGlyphCache* SkGlyphCache::VisitCache(const SkDescriptor* desc,
     ac.release();           // release the mutex now
     insideMutex = false;    // can't use globals anymore
 
-    cache = SkNEW_ARGS(SkGlyphCache, (desc));
+    SK_TRACE_INC(gStrikeMisses);
+    {
+        // scoped, so that the gotos don't jump past it
+        SK_TRACE_EVENT("SkGlyphCache::create");
+        cache = SkNEW_ARGS(SkGlyphCache, (desc));
+    }
 
 FOUND_IT:
 
@@ -538,16 +798,19 @@ void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
     SkASSERT(cache);
     SkASSERT(cache->fNext == NULL);
 
-    SkGlyphCache_Globals& globals = GET_GC_GLOBALS();
+    SkGlyphCache_Globals& globals = GET_GC_GLOBALS().find(cache->fDesc);
     SkAutoMutexAcquire    ac(globals.fMutex);
 
     globals.validate();
     cache->validate();
 
-    // if we have a fixed budget for our cache, do a purge here
+    // if we have a fixed budget for our cache, do a purge here. Each shard
+    // gets an equal share of the budget.
     {
         size_t allocated = globals.fTotalMemoryUsed + cache->fMemoryUsed;
-        size_t amountToFree = SkFontHost::ShouldPurgeFontCache(allocated);
+        size_t amountToFree = SkFontHost::ShouldPurgeFontCache(
+                                                allocated * SHARD_COUNT);
+        amountToFree /= SHARD_COUNT;
         if (amountToFree)
             (void)InternalFreeCache(&globals, amountToFree);
     }
@@ -565,24 +828,60 @@ void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
 }
 
 size_t SkGlyphCache::GetCacheUsed() {
-    SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
-    SkAutoMutexAcquire  ac(globals.fMutex);
+    SkGlyphCache_Shards& shards = FIND_GC_GLOBALS();
+    size_t used = 0;
+
+    for (int i = 0; i < SHARD_COUNT; i++) {
+        SkGlyphCache_Globals& globals = shards.fShards[i];
+        SkAutoMutexAcquire  ac(globals.fMutex);
 
-    return SkGlyphCache::ComputeMemoryUsed(globals.fHead);
+        used += SkGlyphCache::ComputeMemoryUsed(globals.fHead);
+    }
+    return used;
 }
 
 bool SkGlyphCache::SetCacheUsed(size_t bytesUsed) {
-    size_t curr = SkGlyphCache::GetCacheUsed();
+    SkGlyphCache_Shards& shards = FIND_GC_GLOBALS();
+    // like the budget in AttachCache, split the target evenly across shards
+    const size_t shardBytesUsed = bytesUsed / SHARD_COUNT;
+    bool purged = false;
 
-    if (curr > bytesUsed) {
-        SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
+    for (int i = 0; i < SHARD_COUNT; i++) {
+        SkGlyphCache_Globals& globals = shards.fShards[i];
         SkAutoMutexAcquire  ac(globals.fMutex);
 
-        return InternalFreeCache(&globals, curr - bytesUsed) > 0;
+        size_t curr = SkGlyphCache::ComputeMemoryUsed(globals.fHead);
+        if (curr > shardBytesUsed) {
+            if (InternalFreeCache(&globals, curr - shardBytesUsed) > 0) {
+                purged = true;
+            }
+        }
+    }
+    return purged;
+}
+
+namespace {
+
+// the font cache's share of the global budget (see SkGraphics)
+class GlyphPurgeableCache : public SkPurgeableCache {
+public:
+    GlyphPurgeableCache() : INHERITED("glyphs", kModerate_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        return SkGlyphCache::GetCacheUsed();
     }
-    return false;
+    virtual void purgeTo(size_t bytes) {
+        (void)SkGlyphCache::SetCacheUsed(bytes);
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
 }
 
+static GlyphPurgeableCache gPurgeableCache;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkGlyphCache* SkGlyphCache::FindTail(SkGlyphCache* cache) {
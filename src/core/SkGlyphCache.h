@@ -24,6 +24,7 @@
 #include "SkScalerContext.h"
 #include "SkTemplates.h"
 
+class SkGlyphDiskCache;
 class SkPaint;
 
 class SkGlyphCache_Globals;
@@ -48,6 +49,38 @@ public:
     const SkGlyph& getUnicharAdvance(SkUnichar);
     const SkGlyph& getGlyphIDAdvance(uint16_t);
 
+    enum {
+        // the unichars (Latin-1) whose advances we keep in a dense table
+        kAdvanceTableCount = 256
+    };
+
+    /** Returns the 16.16 horizontal advance of the unichar, the same as
+        getUnicharAdvance(uni).fAdvanceX. For the first kAdvanceTableCount
+        unichars this is a lookup in a table that is filled in as they are
+        first asked for, without the char-to-glyph hash probe.
+    */
+    SkFixed getUnicharAdvanceX(SkUnichar uni) {
+        if ((unsigned)uni < kAdvanceTableCount && fAdvanceTable) {
+            SkFixed advance = fAdvanceTable[uni];
+            if (advance != kUnknownAdvance) {
+                return advance;
+            }
+        }
+        return this->lookupAdvanceX(uni);
+    }
+
+    /** Adds up the horizontal advances of the ASCII run at the start of the
+        UTF-8 text, stopping at stop or at the first byte of a multi-byte
+        char, and moves text past what it added up. Returns the sum in 48.16
+        (so it can't overflow), and adds the number of chars to *count.
+    */
+    int64_t sumUTF8AdvancesX(const char** text, const char* stop, int* count);
+
+    /** The same for the run of UTF-16 text below kAdvanceTableCount.
+    */
+    int64_t sumUTF16AdvancesX(const uint16_t** text, const uint16_t* stop,
+                              int* count);
+
     /** Returns a glyph with all fields valid except fImage and fPath, which
         may be null. If they are null, call findImage or findPath for those.
         If they are not null, then they are valid.
@@ -66,6 +99,16 @@ public:
     const SkGlyph& getUnicharMetrics(SkUnichar, SkFixed x, SkFixed y);
     const SkGlyph& getGlyphIDMetrics(uint16_t, SkFixed x, SkFixed y);
 
+    /** Batch version of getGlyphIDMetrics (and of findImage, if wantImages is
+        true). All of the missing metrics, and then all of the missing images,
+        are generated in one call into the scaler context. If glyphs is not
+        null, it receives the glyph for each ID. Since a detached strike is
+        private to its thread, this can also be used to warm up a new strike
+        on a helper thread before handing it back with AttachCache().
+    */
+    void getGlyphIDMetrics(const uint16_t glyphIDs[], int count,
+                           const SkGlyph* glyphs[], bool wantImages);
+
     /** Return the glyphID for the specified Unichar. If the char has already
         been seen, use the existing cache entry. If not, ask the scalercontext
         to compute it for us.
@@ -195,10 +238,17 @@ private:
 
     enum MetricsType {
         kJustAdvance_MetricsType,
-        kFull_MetricsType
+        kFull_MetricsType,
+        // the caller will generate the metrics (unless the glyph came from
+        // the disk cache already complete)
+        kDeferred_MetricsType
     };
 
     SkGlyph* lookupMetrics(uint32_t id, MetricsType);
+    SkFixed lookupAdvanceX(SkUnichar);
+    // chars must all be below kAdvanceTableCount
+    template <typename T> int64_t sumAdvancesX(const T chars[], int count);
+    bool allocImage(const SkGlyph&);
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
     void detach(SkGlyphCache** head) {
@@ -228,14 +278,23 @@ private:
     SkPaint::FontMetrics fFontMetricsY;
 
     enum {
-        kHashBits   = 8,
-        kHashCount  = 1 << kHashBits,
-        kHashMask   = kHashCount - 1
+        // the hash tables start out at (1 << kMinHashBits) entries, and double
+        // as the strike fills up, until they reach (1 << kMaxHashBits)
+        kMinHashBits = 8,
+        kMaxHashBits = 14
     };
-    SkGlyph*            fGlyphHash[kHashCount];
+    // direct-mapped, indexed by ID2HashIndex(), fHashMask + 1 entries
+    SkGlyph**           fGlyphHash;
     SkTDArray<SkGlyph*> fGlyphArray;
     SkChunkAlloc        fGlyphAlloc;
     SkChunkAlloc        fImageAlloc;
+    // optional copy of the strike from a previous process, may be NULL
+    SkGlyphDiskCache*   fDiskCache;
+
+    // kAdvanceTableCount advances, indexed by unichar, allocated on first use
+    // and filled in lazily (unfilled entries hold kUnknownAdvance)
+    static const SkFixed kUnknownAdvance = SK_NaN32;
+    SkFixed*            fAdvanceTable;
 
     int fMetricsCount, fAdvanceCount;
 
@@ -243,20 +302,21 @@ private:
         uint32_t    fID;    // unichar + subpixel
         SkGlyph*    fGlyph;
     };
-    // no reason to use the same kHashCount as fGlyphHash, but we do for now
-    CharGlyphRec    fCharToGlyphHash[kHashCount];
+    // no reason to use the same size as fGlyphHash, but we do for now
+    CharGlyphRec*   fCharToGlyphHash;
 
-    enum {
-        // shift so that the top bits fall into kHashBits region
-        kShiftForHashIndex = SkGlyph::kSubShift +
-                             SkGlyph::kSubBits*2 -
-                             kHashBits
-    };
+    int         fHashBits;
+    uint32_t    fHashMask;
+    // shift so that the top (subpixel) bits fall into the fHashBits region
+    int         fHashShift;
 
-    static inline unsigned ID2HashIndex(uint32_t id) {
-        return (id ^ (id >> kShiftForHashIndex)) & kHashMask;
+    inline unsigned ID2HashIndex(uint32_t id) const {
+        return (id ^ (id >> fHashShift)) & fHashMask;
     }
 
+    void allocHashTables(int hashBits);
+    void growHashTables();
+
     // used to track (approx) how much ram is tied-up in this cache
     size_t  fMemoryUsed;
 
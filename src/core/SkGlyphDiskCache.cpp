@@ -0,0 +1,295 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkGlyphDiskCache.h"
+#include "SkDescriptor.h"
+#include "SkOSFile.h"
+#include "SkScalerContext.h"
+#include "SkStream.h"
+#include "SkThread.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+    #include "SkMMapStream.h"
+    #define USE_MMAP
+#endif
+
+#include <stdio.h>
+
+#define STRIKE_FILE_MAGIC   SkSetFourByteTag('s', 'k', 'g', 'c')
+#define STRIKE_FILE_VERSION 1
+
+// the file is
+//  FileHeader
+//  descriptor (fDescLength bytes)
+//  Record[fRecordCount], sorted by fID
+//  image data (fImageSize bytes)
+struct FileHeader {
+    uint32_t    fMagic;
+    uint32_t    fVersion;
+    uint32_t    fDescLength;
+    uint32_t    fRecordCount;
+    uint32_t    fImageSize;
+};
+
+static SkMutex  gDirMutex;
+static SkString gDir;
+
+void SkGlyphDiskCache::SetDir(const char dir[]) {
+    SkAutoMutexAcquire ac(gDirMutex);
+    gDir.set(dir);
+}
+
+SkGlyphDiskCache* SkGlyphDiskCache::Open(const SkDescriptor* desc) {
+    SkString path;
+    {
+        SkAutoMutexAcquire ac(gDirMutex);
+        if (gDir.isEmpty()) {
+            return NULL;
+        }
+        path.set(gDir);
+    }
+    if (!path.endsWith("/")) {
+        path.append("/");
+    }
+    path.appendHex(desc->getChecksum(), 8);
+    path.append(".skglyphs");
+    return SkNEW_ARGS(SkGlyphDiskCache, (desc, path.c_str()));
+}
+
+SkGlyphDiskCache::SkGlyphDiskCache(const SkDescriptor* desc, const char path[])
+        : fPath(path) {
+    fDesc = desc->copy();
+    fStream = NULL;
+    fRecords = NULL;
+    fRecordCount = 0;
+    fImages = NULL;
+    this->load();
+}
+
+SkGlyphDiskCache::~SkGlyphDiskCache() {
+    SkSafeUnref(fStream);
+    SkDescriptor::Free(fDesc);
+}
+
+void SkGlyphDiskCache::load() {
+    // check first, so that a missing file (the common cold start) is quiet
+    SkFILE* file = sk_fopen(fPath.c_str(), kRead_SkFILE_Flag);
+    if (NULL == file) {
+        return;
+    }
+#ifdef USE_MMAP
+    sk_fclose(file);
+    SkMemoryStream* stream = SkNEW_ARGS(SkMMAPStream, (fPath.c_str()));
+#else
+    size_t fileSize = sk_fgetsize(file);
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream, (fileSize));
+    size_t bytesRead = sk_fread((void*)stream->getMemoryBase(), fileSize,
+                                file);
+    sk_fclose(file);
+    if (bytesRead != fileSize) {
+        stream->unref();
+        return;
+    }
+#endif
+    SkAutoUnref aur(stream);
+
+    const char* base = (const char*)stream->getMemoryBase();
+    const size_t size = stream->getLength();
+    if (NULL == base || size < sizeof(FileHeader)) {
+        return;
+    }
+
+    const FileHeader* header = (const FileHeader*)base;
+    const uint32_t descLength = fDesc->getLength();
+    if (header->fMagic != STRIKE_FILE_MAGIC ||
+            header->fVersion != STRIKE_FILE_VERSION ||
+            header->fDescLength != descLength ||
+            header->fRecordCount > (size / sizeof(Record))) {
+        return;
+    }
+    const size_t expectedSize = sizeof(FileHeader) + descLength +
+                                header->fRecordCount * sizeof(Record) +
+                                header->fImageSize;
+    if (size != expectedSize) {
+        return;
+    }
+    // another strike may share our checksum, so the descriptor must match
+    if (memcmp(base + sizeof(FileHeader), fDesc, descLength)) {
+        return;
+    }
+
+    const Record* records = (const Record*)(base + sizeof(FileHeader) +
+                                            descLength);
+    const int count = header->fRecordCount;
+    for (int i = 0; i < count; i++) {
+        const Record& rec = records[i];
+        if ((i > 0 && rec.fID <= records[i - 1].fID) ||
+                rec.fImageOffset > header->fImageSize ||
+                rec.fImageSize > header->fImageSize - rec.fImageOffset) {
+            return;
+        }
+    }
+
+    fStream = stream;
+    fStream->ref();
+    fRecords = records;
+    fRecordCount = count;
+    fImages = (const char*)(records + count);
+}
+
+const SkGlyphDiskCache::Record* SkGlyphDiskCache::find(uint32_t id) const {
+    int lo = 0;
+    int hi = fRecordCount - 1;
+    while (lo <= hi) {
+        int mid = (hi + lo) >> 1;
+        if (fRecords[mid].fID < id) {
+            lo = mid + 1;
+        } else if (fRecords[mid].fID > id) {
+            hi = mid - 1;
+        } else {
+            return &fRecords[mid];
+        }
+    }
+    return NULL;
+}
+
+bool SkGlyphDiskCache::findMetrics(SkGlyph* glyph) const {
+    const Record* rec = this->find(glyph->fID);
+    if (NULL == rec) {
+        return false;
+    }
+    glyph->fAdvanceX = rec->fAdvanceX;
+    glyph->fAdvanceY = rec->fAdvanceY;
+    glyph->fWidth = rec->fWidth;
+    glyph->fHeight = rec->fHeight;
+    glyph->fTop = rec->fTop;
+    glyph->fLeft = rec->fLeft;
+    glyph->fMaskFormat = rec->fMaskFormat;
+    glyph->fRsbDelta = rec->fRsbDelta;
+    glyph->fLsbDelta = rec->fLsbDelta;
+    return true;
+}
+
+bool SkGlyphDiskCache::findImage(const SkGlyph& glyph) const {
+    const Record* rec = this->find(glyph.fID);
+    if (NULL == rec || 0 == rec->fImageSize ||
+            rec->fImageSize != glyph.computeImageSize()) {
+        return false;
+    }
+    memcpy(glyph.fImage, fImages + rec->fImageOffset, rec->fImageSize);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void glyph_to_record(const SkGlyph& glyph,
+                            SkGlyphDiskCache::Record* rec) {
+    rec->fID = glyph.fID;
+    rec->fAdvanceX = glyph.fAdvanceX;
+    rec->fAdvanceY = glyph.fAdvanceY;
+    rec->fWidth = glyph.fWidth;
+    rec->fHeight = glyph.fHeight;
+    rec->fTop = glyph.fTop;
+    rec->fLeft = glyph.fLeft;
+    rec->fMaskFormat = glyph.fMaskFormat;
+    rec->fRsbDelta = glyph.fRsbDelta;
+    rec->fLsbDelta = glyph.fLsbDelta;
+    rec->fPad = 0;
+    rec->fImageSize = glyph.fImage ? glyph.computeImageSize() : 0;
+}
+
+void SkGlyphDiskCache::save(const SkTDArray<SkGlyph*>& glyphs) {
+    SkTDArray<Record>       records;
+    SkTDArray<const void*>  images;
+    bool                    changed = false;
+
+    // merge the glyphs with what is already on disk, both sorted by fID
+    int diskIndex = 0;
+    for (int i = 0; i < glyphs.count(); i++) {
+        const SkGlyph& glyph = *glyphs[i];
+        if (!glyph.isFullMetrics()) {
+            continue;
+        }
+        while (diskIndex < fRecordCount &&
+                fRecords[diskIndex].fID < glyph.fID) {
+            *records.append() = fRecords[diskIndex];
+            *images.append() = fImages + fRecords[diskIndex].fImageOffset;
+            diskIndex += 1;
+        }
+
+        Record rec;
+        glyph_to_record(glyph, &rec);
+        if (diskIndex < fRecordCount &&
+                fRecords[diskIndex].fID == glyph.fID) {
+            const Record& diskRec = fRecords[diskIndex];
+            diskIndex += 1;
+            if (rec.fImageSize <= diskRec.fImageSize) {
+                *records.append() = diskRec;
+                *images.append() = fImages + diskRec.fImageOffset;
+                continue;
+            }
+        }
+        *records.append() = rec;
+        *images.append() = glyph.fImage;
+        changed = true;
+    }
+    if (!changed) {
+        return;
+    }
+    for (; diskIndex < fRecordCount; diskIndex++) {
+        *records.append() = fRecords[diskIndex];
+        *images.append() = fImages + fRecords[diskIndex].fImageOffset;
+    }
+
+    FileHeader header;
+    header.fMagic = STRIKE_FILE_MAGIC;
+    header.fVersion = STRIKE_FILE_VERSION;
+    header.fDescLength = fDesc->getLength();
+    header.fRecordCount = records.count();
+    header.fImageSize = 0;
+    for (int i = 0; i < records.count(); i++) {
+        records[i].fImageOffset = header.fImageSize;
+        header.fImageSize += records[i].fImageSize;
+    }
+
+    // write to a temporary file and then rename it, so that we never modify
+    // the file that we (or another process) may have mapped
+    SkString tmpPath(fPath);
+    tmpPath.append(".tmp");
+    bool success;
+    {
+        SkFILEWStream stream(tmpPath.c_str());
+        success = stream.isValid() &&
+                  stream.write(&header, sizeof(header)) &&
+                  stream.write(fDesc, header.fDescLength) &&
+                  stream.write(records.begin(),
+                               records.count() * sizeof(Record));
+        for (int i = 0; success && i < records.count(); i++) {
+            if (records[i].fImageSize) {
+                success = stream.write(images[i], records[i].fImageSize);
+            }
+        }
+    }
+    if (success) {
+        remove(fPath.c_str());
+        success = 0 == rename(tmpPath.c_str(), fPath.c_str());
+    }
+    if (!success) {
+        SkDEBUGF(("---- failed to write glyph disk cache %s\n",
+                  fPath.c_str()));
+        remove(tmpPath.c_str());
+    }
+}
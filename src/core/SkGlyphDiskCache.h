@@ -0,0 +1,98 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkGlyphDiskCache_DEFINED
+#define SkGlyphDiskCache_DEFINED
+
+#include "SkString.h"
+#include "SkTDArray.h"
+
+class SkDescriptor;
+class SkStream;
+struct SkGlyph;
+
+/** \class SkGlyphDiskCache
+
+    The glyphs of one strike (metrics and masks, but not paths), as saved to
+    disk by a previous process. Each strike is one file in the directory set
+    with SetDir(), named after its descriptor's checksum, and is memory-mapped
+    where the platform supports it.
+
+    The files are keyed by the full descriptor, which includes the typeface's
+    uniqueID, so a directory is only valid for as long as the process assigns
+    the same IDs to the same fonts (i.e. the set of installed fonts, and the
+    order they are loaded in, does not change).
+*/
+class SkGlyphDiskCache {
+public:
+    /** Set the directory that holds the strike files, or NULL (the default)
+        to disable the disk cache. The directory must already exist.
+     */
+    static void SetDir(const char dir[]);
+
+    /** If the disk cache is enabled, return a new object for the strike that
+        matches desc (which will be empty if no valid file was found), else
+        return NULL.
+     */
+    static SkGlyphDiskCache* Open(const SkDescriptor* desc);
+
+    ~SkGlyphDiskCache();
+
+    /** If the glyph with glyph->fID is on disk, copy its full metrics into
+        glyph and return true. fImage and fPath are not modified.
+     */
+    bool findMetrics(SkGlyph* glyph) const;
+
+    /** If the image for the glyph is on disk, copy it into glyph.fImage (which
+        must hold computeImageSize() bytes) and return true.
+     */
+    bool findImage(const SkGlyph& glyph) const;
+
+    /** Write the strike file again if glyphs (which must be sorted by fID)
+        contains any full metrics or image that is not on disk yet. What was
+        already on disk is kept.
+     */
+    void save(const SkTDArray<SkGlyph*>& glyphs);
+
+    // this is the on-disk layout, so it must not change size or order
+    struct Record {
+        uint32_t    fID;
+        int32_t     fAdvanceX, fAdvanceY;
+        uint16_t    fWidth, fHeight;
+        int16_t     fTop, fLeft;
+        uint8_t     fMaskFormat;
+        int8_t      fRsbDelta, fLsbDelta;
+        uint8_t     fPad;
+        uint32_t    fImageOffset;   // from the start of the image data
+        uint32_t    fImageSize;     // 0 if the image is not stored
+    };
+
+private:
+    SkGlyphDiskCache(const SkDescriptor* desc, const char path[]);
+
+    SkDescriptor*   fDesc;
+    SkString        fPath;
+    SkStream*       fStream;
+    // these point into fStream's memory (or are NULL/0 if there is no file)
+    const Record*   fRecords;
+    int             fRecordCount;
+    const char*     fImages;
+
+    void load();
+    const Record* find(uint32_t id) const;
+};
+
+#endif
@@ -50,6 +50,10 @@
 void SkGraphics::Init() {
     SkGlobals::Init();
 
+    // probe the CPU before anything draws, so that the platform procs all
+    // see its features without racing to look them up
+    SkGetCpuFeatures();
+
 #ifdef BUILD_EMBOSS_TABLE
     SkEmbossMask_BuildTable();
 #endif
@@ -116,6 +120,7 @@ void SkGraphics::Init() {
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkGlyphCache.h"
+#include "SkGlyphDiskCache.h"
 
 void SkGraphics::Term() {
     SkGraphics::SetFontCacheUsed(0);
@@ -130,6 +135,50 @@ bool SkGraphics::SetFontCacheUsed(size_t usageInBytes) {
     return SkGlyphCache::SetCacheUsed(usageInBytes);
 }
 
+void SkGraphics::SetGlyphDiskCacheDir(const char dir[]) {
+    SkGlyphDiskCache::SetDir(dir);
+}
+
+size_t SkGraphics::GetTotalCacheUsed() {
+    return SkPurgeableCache::GetTotalBytesUsed();
+}
+
+int SkGraphics::GetCacheUsage(SkPurgeableCache::Usage usage[], int maxCount) {
+    return SkPurgeableCache::GetUsage(usage, maxCount);
+}
+
+static size_t gCacheBudget;
+
+size_t SkGraphics::GetCacheBudget() {
+    return gCacheBudget;
+}
+
+void SkGraphics::SetCacheBudget(size_t bytes) {
+    gCacheBudget = bytes;
+    (void)SkGraphics::PurgeToBudget(kBudget_PurgeLevel);
+}
+
+size_t SkGraphics::PurgeToBudget(PurgeLevel level) {
+    size_t budget = gCacheBudget;
+    switch (level) {
+        case kBudget_PurgeLevel:
+            if (0 == budget) {
+                return SkPurgeableCache::GetTotalBytesUsed();
+            }
+            break;
+        case kHalf_PurgeLevel:
+            if (0 == budget) {
+                budget = SkPurgeableCache::GetTotalBytesUsed();
+            }
+            budget >>= 1;
+            break;
+        case kAll_PurgeLevel:
+            budget = 0;
+            break;
+    }
+    return SkPurgeableCache::PurgeTo(budget);
+}
+
 void SkGraphics::GetVersion(int32_t* major, int32_t* minor, int32_t* patch) {
     if (major) {
         *major = SKIA_VERSION_MAJOR;
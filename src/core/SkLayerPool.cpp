@@ -0,0 +1,259 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkLayerPool.h"
+#include "Sk64.h"
+#include "SkPixelRef.h"
+#include "SkPurgeableCache.h"
+#include "SkThread.h"
+
+// room for a full screen layer or two, kept from one frame to the next
+#define LAYER_POOL_DEFAULT_LIMIT    (8 * 1024 * 1024)
+// buffers are rounded up to this many pixels (and rows), so that layers that
+// are only a little different in size can share them
+#define LAYER_POOL_ROUND            16
+// a layer may not take a buffer that is more than this many times its size
+#define LAYER_POOL_MAX_WASTE        2
+
+/*  Each buffer is a single allocation: the header, then the pixels. Only the
+    buffers that aren't in use are on the list.
+ */
+struct LayerBuffer {
+    LayerBuffer*    fPrev;  // more recently freed
+    LayerBuffer*    fNext;  // less recently freed
+    size_t          fSize;  // of the whole allocation
+    int             fConfig;
+    int             fRowBytes;
+    int             fHeight;
+
+    void* pixels() const {
+        return (void*)SkAlign8((intptr_t)(this + 1));
+    }
+};
+
+static SkMutex      gLayerPoolMutex;
+static LayerBuffer* gHead;
+static LayerBuffer* gTail;
+static size_t       gBytesUsed;
+static size_t       gByteLimit = LAYER_POOL_DEFAULT_LIMIT;
+
+// the following must be called with gLayerPoolMutex held
+
+static void detach(LayerBuffer* buffer) {
+    if (buffer->fPrev) {
+        buffer->fPrev->fNext = buffer->fNext;
+    } else {
+        gHead = buffer->fNext;
+    }
+    if (buffer->fNext) {
+        buffer->fNext->fPrev = buffer->fPrev;
+    } else {
+        gTail = buffer->fPrev;
+    }
+    gBytesUsed -= buffer->fSize;
+}
+
+static void add_to_head(LayerBuffer* buffer) {
+    buffer->fPrev = NULL;
+    buffer->fNext = gHead;
+    if (gHead) {
+        gHead->fPrev = buffer;
+    } else {
+        gTail = buffer;
+    }
+    gHead = buffer;
+    gBytesUsed += buffer->fSize;
+}
+
+static void purge_to(size_t limit) {
+    while (gTail && gBytesUsed > limit) {
+        LayerBuffer* buffer = gTail;
+        detach(buffer);
+        sk_free(buffer);
+    }
+}
+
+// the smallest buffer that fits, if it isn't too much bigger
+static LayerBuffer* find_buffer(SkBitmap::Config config, int rowBytes,
+                                int height) {
+    const size_t maxSize = LAYER_POOL_MAX_WASTE * (size_t)rowBytes * height +
+                           sizeof(LayerBuffer) + 8;
+    LayerBuffer* best = NULL;
+    for (LayerBuffer* buffer = gHead; buffer; buffer = buffer->fNext) {
+        if (buffer->fConfig == config && buffer->fRowBytes >= rowBytes &&
+                buffer->fHeight >= height && buffer->fSize <= maxSize &&
+                (NULL == best || buffer->fSize < best->fSize)) {
+            best = buffer;
+        }
+    }
+    if (best) {
+        detach(best);
+    }
+    return best;
+}
+
+static void recycle(LayerBuffer* buffer) {
+    SkAutoMutexAcquire ac(gLayerPoolMutex);
+    if (buffer->fSize > gByteLimit) {
+        sk_free(buffer);
+        return;
+    }
+    add_to_head(buffer);
+    purge_to(gByteLimit);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// hands its buffer back to the pool when the last bitmap is done with it
+class LayerPixelRef : public SkPixelRef {
+public:
+    explicit LayerPixelRef(LayerBuffer* buffer) : fBuffer(buffer) {
+        this->setPreLocked(buffer->pixels(), NULL);
+    }
+    virtual ~LayerPixelRef() {
+        recycle(fBuffer);
+    }
+
+protected:
+    virtual void* onLockPixels(SkColorTable** ct) {
+        *ct = NULL;
+        return fBuffer->pixels();
+    }
+    virtual void onUnlockPixels() {
+        // nothing to do
+    }
+
+private:
+    LayerBuffer*    fBuffer;
+
+    typedef SkPixelRef INHERITED;
+};
+
+}
+
+static int round_up(int x) {
+    return (x + LAYER_POOL_ROUND - 1) / LAYER_POOL_ROUND * LAYER_POOL_ROUND;
+}
+
+static bool is_pooled_config(SkBitmap::Config config) {
+    switch (config) {
+        case SkBitmap::kA1_Config:
+        case SkBitmap::kA8_Config:
+        case SkBitmap::kRGB_565_Config:
+        case SkBitmap::kARGB_4444_Config:
+        case SkBitmap::kARGB_8888_Config:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SkLayerPool::AllocPixels(SkBitmap* bitmap, SkBitmap::Config config,
+                              int width, int height, bool isOpaque) {
+    if (!is_pooled_config(config) || width <= 0 || height <= 0 ||
+            width > SK_MaxS32 - LAYER_POOL_ROUND ||
+            height > SK_MaxS32 - LAYER_POOL_ROUND) {
+        return false;
+    }
+    const int roundedWidth = round_up(width);
+    const int roundedHeight = round_up(height);
+    const int rowBytes = SkBitmap::ComputeRowBytes(config, width);
+    const int roundedRowBytes = SkBitmap::ComputeRowBytes(config,
+                                                          roundedWidth);
+    Sk64 size;
+    size.setMul(roundedRowBytes, roundedHeight);
+    if (0 == rowBytes || 0 == roundedRowBytes || !size.is32() ||
+            size.get32() > SK_MaxS32 - (int32_t)sizeof(LayerBuffer) - 8) {
+        return false;
+    }
+
+    LayerBuffer* buffer;
+    {
+        SkAutoMutexAcquire ac(gLayerPoolMutex);
+        buffer = find_buffer(config, rowBytes, height);
+    }
+    if (NULL == buffer) {
+        const size_t allocSize = sizeof(LayerBuffer) + 8 + size.get32();
+        buffer = (LayerBuffer*)sk_malloc_flags(allocSize, 0);
+        if (NULL == buffer) {
+            return false;
+        }
+        buffer->fSize = allocSize;
+        buffer->fConfig = config;
+        buffer->fRowBytes = roundedRowBytes;
+        buffer->fHeight = roundedHeight;
+    }
+
+    // the rest of the buffer is left as the previous layer left it
+    bitmap->setConfig(config, width, height, buffer->fRowBytes);
+    bitmap->setPixelRef(SkNEW_ARGS(LayerPixelRef, (buffer)))->unref();
+    bitmap->setIsOpaque(isOpaque);
+    if (!isOpaque) {
+        bitmap->eraseColor(0);
+    }
+    return true;
+}
+
+size_t SkLayerPool::GetByteLimit() {
+    SkAutoMutexAcquire ac(gLayerPoolMutex);
+    return gByteLimit;
+}
+
+void SkLayerPool::SetByteLimit(size_t bytes) {
+    SkAutoMutexAcquire ac(gLayerPoolMutex);
+    gByteLimit = bytes;
+    purge_to(bytes);
+}
+
+size_t SkLayerPool::GetBytesUsed() {
+    SkAutoMutexAcquire ac(gLayerPoolMutex);
+    return gBytesUsed;
+}
+
+void SkLayerPool::PurgeTo(size_t bytes) {
+    SkAutoMutexAcquire ac(gLayerPoolMutex);
+    purge_to(bytes);
+}
+
+void SkLayerPool::Purge() {
+    SkAutoMutexAcquire ac(gLayerPoolMutex);
+    purge_to(0);
+}
+
+namespace {
+
+// a layer is only a malloc (and a clear) away, so this is the first to go
+class LayerPurgeableCache : public SkPurgeableCache {
+public:
+    LayerPurgeableCache() : INHERITED("layers", kCheap_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        return SkLayerPool::GetBytesUsed();
+    }
+    virtual void purgeTo(size_t bytes) {
+        SkLayerPool::PurgeTo(bytes);
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static LayerPurgeableCache gPurgeableCache;
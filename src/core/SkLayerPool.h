@@ -0,0 +1,68 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkLayerPool_DEFINED
+#define SkLayerPool_DEFINED
+
+#include "SkBitmap.h"
+
+/** \class SkLayerPool
+
+    A global, bounded pool of pixel buffers for saveLayer's offscreen devices,
+    so that a layer that is freed on restore() hands its buffer on to the next
+    layer of a similar size and config, in this frame or the next, instead of
+    going back to malloc.
+
+    Buffers are rounded up in both dimensions when they are allocated, so one
+    buffer serves layers of slightly different sizes: a layer's bitmap may
+    have more rowbytes than its width needs.
+*/
+class SkLayerPool {
+public:
+    /** Set bitmap to the specified config and size, with pixels from the
+        pool, cleared to transparent unless isOpaque is true. The pixels go
+        back to the pool when the bitmap's pixelref is deleted. Returns false
+        (leaving bitmap alone) for configs that need a colortable, or if the
+        memory could not be allocated.
+    */
+    static bool AllocPixels(SkBitmap* bitmap, SkBitmap::Config, int width,
+                            int height, bool isOpaque);
+
+    /** Return the limit on the memory that is kept for later layers, in
+        bytes. Buffers that are in use don't count.
+    */
+    static size_t GetByteLimit();
+
+    /** Set the limit, freeing the least recently used buffers if need be.
+        0 turns the pool off.
+    */
+    static void SetByteLimit(size_t bytes);
+
+    /** Return the memory currently kept for later layers, in bytes. */
+    static size_t GetBytesUsed();
+
+    /** Free the least recently used buffers until no more than the specified
+        number of bytes remain. Unlike SetByteLimit(), this leaves the limit
+        alone.
+    */
+    static void PurgeTo(size_t bytes);
+
+    /** Free every buffer that isn't in use. */
+    static void Purge();
+};
+
+#endif
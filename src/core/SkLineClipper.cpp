@@ -1,5 +1,10 @@
 #include "SkLineClipper.h"
 
+#if defined(SK_SCALAR_IS_FLOAT) && defined(__SSE2__)
+    #include <emmintrin.h>
+    #define SK_LINECLIPPER_USE_SSE2
+#endif
+
 // return X coordinate of intersection with horizontal line at Y
 static SkScalar sect_with_horizontal(const SkPoint src[2], SkScalar Y) {
     SkScalar dy = src[1].fY - src[0].fY;
@@ -241,3 +246,60 @@ int SkLineClipper::ClipLine(const SkPoint pts[], const SkRect& clip,
     return lineCount;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+
+static inline unsigned compute_outcode(const SkPoint& pt, const SkRect& clip) {
+    return  (unsigned)(pt.fX < clip.fLeft) |
+           ((unsigned)(pt.fY < clip.fTop) << 1) |
+           ((unsigned)(pt.fX > clip.fRight) << 2) |
+           ((unsigned)(pt.fY > clip.fBottom) << 3);
+}
+
+void SkLineClipper::ComputeOutcodes(const SkPoint pts[], int count,
+                                    const SkRect& clip, uint8_t codes[]) {
+    int i = 0;
+#ifdef SK_LINECLIPPER_USE_SSE2
+    // two points at a time, as x0 y0 x1 y1, so each compare's mask has the
+    // bits of both in the Outcode order
+    const __m128 lt = _mm_setr_ps(clip.fLeft, clip.fTop,
+                                  clip.fLeft, clip.fTop);
+    const __m128 rb = _mm_setr_ps(clip.fRight, clip.fBottom,
+                                  clip.fRight, clip.fBottom);
+    for (; i + 1 < count; i += 2) {
+        __m128 xy = _mm_loadu_ps(&pts[i].fX);
+        int less = _mm_movemask_ps(_mm_cmplt_ps(xy, lt));
+        int greater = _mm_movemask_ps(_mm_cmpgt_ps(xy, rb));
+        codes[i] = SkToU8((less & 3) | ((greater & 3) << 2));
+        codes[i + 1] = SkToU8((less >> 2) | ((greater >> 2) << 2));
+    }
+#endif
+    for (; i < count; i++) {
+        codes[i] = SkToU8(compute_outcode(pts[i], clip));
+    }
+}
+
+// how many points CullLines() classifies at a time
+#define CULL_CHUNK  64
+
+int SkLineClipper::CullLines(const SkPoint src[], int count,
+                             const SkRect& clip, SkPoint dst[]) {
+    SkASSERT(!(count & 1));
+
+    uint8_t codes[CULL_CHUNK];
+    int dstCount = 0;
+    for (int start = 0; start < count; start += CULL_CHUNK) {
+        const SkPoint* pts = src + start;
+        int n = SkMin32(count - start, CULL_CHUNK);
+        ComputeOutcodes(pts, n, clip, codes);
+        // dst never gets ahead of src, so they may be the same
+        for (int i = 0; i < n; i += 2) {
+            if (0 == (codes[i] & codes[i + 1])) {
+                dst[dstCount] = pts[i];
+                dst[dstCount + 1] = pts[i + 1];
+                dstCount += 2;
+            }
+        }
+    }
+    return dstCount;
+}
@@ -21,15 +21,169 @@
 #include "SkBuffer.h"
 #include "SkDraw.h"
 #include "SkRegion.h"
+#include "SkTemplates.h"
 
 bool SkMaskFilter::filterMask(SkMask*, const SkMask&, const SkMatrix&,
                               SkIPoint*) {
     return false;
 }
 
+bool SkMaskFilter::computeFastBoundsOutset(SkRect*) const {
+    return false;
+}
+
+SkMaskFilter::BlurType SkMaskFilter::asABlur(BlurInfo*) const {
+    return kNone_BlurType;
+}
+
+SkMaskFilter::FilterReturn SkMaskFilter::filterRectToNine(const SkRect&,
+                                                          const SkMatrix&,
+                                                          NinePatch*) {
+    return kUnimplemented_FilterReturn;
+}
+
+// true if path is a single (non-inverse) contour around an axis aligned rect
+static bool is_rect(const SkPath& path, SkRect* rect) {
+    if (path.isInverseFillType()) {
+        return false;
+    }
+
+    SkPath::Iter    iter(path, false);
+    SkPoint         pts[4];
+    SkPoint         corners[5];
+    int             count = 0;
+    SkPath::Verb    verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                if (count > 0) {
+                    return false;
+                }
+                corners[count++] = pts[0];
+                break;
+            case SkPath::kLine_Verb:
+                if (count == 0 || count >= 5) {
+                    return false;
+                }
+                corners[count++] = pts[1];
+                break;
+            case SkPath::kClose_Verb:
+                break;
+            default:
+                return false;
+        }
+    }
+    // we allow the last line to go back to the start
+    if (5 == count && corners[4] == corners[0]) {
+        count = 4;
+    }
+    if (4 != count) {
+        return false;
+    }
+
+    rect->set(corners, 4);
+    if (rect->isEmpty()) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        const SkPoint& p = corners[i];
+        const SkPoint& q = corners[(i + 1) & 3];
+        if ((p.fX != rect->fLeft && p.fX != rect->fRight) ||
+                (p.fY != rect->fTop && p.fY != rect->fBottom)) {
+            return false;
+        }
+        // each edge changes exactly one coordinate
+        if ((p.fX == q.fX) == (p.fY == q.fY)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*  Draw the rows [clip.fTop, clip.fBottom) of the patch, over the columns
+    [clip.fLeft, clip.fRight). Each row of the patch is its mask row with the
+    center value repeated, so we hand it to the blitter as runs.
+ */
+static void draw_nine_clipped(const SkMaskFilter::NinePatch& patch,
+                              const SkIRect& clip, SkBlitter* blitter) {
+    const SkMask&   mask = patch.fMask;
+    const SkIRect&  outer = patch.fOuterRect;
+    const int       cx = patch.fCenter.fX;
+    const int       cy = patch.fCenter.fY;
+    const int       extraX = outer.width() - mask.fBounds.width();
+    const int       extraY = outer.height() - mask.fBounds.height();
+    const int       width = clip.width();
+
+    SkAutoSTMalloc<256, int16_t> runStorage(width + 1);
+    SkAutoSTMalloc<256, SkAlpha> alphaStorage(width);
+    int16_t* runs = runStorage.get();
+    SkAlpha* alpha = alphaStorage.get();
+
+    for (int y = clip.fTop; y < clip.fBottom; y++) {
+        int my = y - outer.fTop;
+        if (my > cy) {
+            my = SkMax32(my - extraY, cy);
+        }
+        const uint8_t* row = mask.fImage + my * mask.fRowBytes;
+
+        int x = clip.fLeft - outer.fLeft;
+        const int stop = clip.fRight - outer.fLeft;
+        int i = 0;
+        while (x < stop) {
+            int n = 1;
+            int mx = x;
+            if (x >= cx && x <= cx + extraX) {
+                // the stretched center, in runs that fit in an int16_t
+                n = SkMin32(SkMin32(cx + extraX + 1, stop) - x, 0x7FFF);
+                mx = cx;
+            } else if (x > cx) {
+                mx = x - extraX;
+            }
+            runs[i] = SkToS16(n);
+            alpha[i] = row[mx];
+            i += n;
+            x += n;
+        }
+        runs[i] = 0;
+        blitter->blitAntiH(clip.fLeft, y, alpha, runs);
+    }
+}
+
+static void draw_nine(const SkMaskFilter::NinePatch& patch,
+                      const SkRegion& clip, SkBounder* bounder,
+                      SkBlitter* blitter) {
+    SkRegion::Cliperator clipper(clip, patch.fOuterRect);
+    if (!clipper.done() &&
+            (NULL == bounder || bounder->doIRect(patch.fOuterRect))) {
+        do {
+            draw_nine_clipped(patch, clipper.rect(), blitter);
+            clipper.next();
+        } while (!clipper.done());
+    }
+}
+
 bool SkMaskFilter::filterPath(const SkPath& devPath, const SkMatrix& matrix,
                               const SkRegion& clip, SkBounder* bounder,
                               SkBlitter* blitter) {
+    SkRect rect;
+    if (is_rect(devPath, &rect)) {
+        NinePatch patch;
+        switch (this->filterRectToNine(rect, matrix, &patch)) {
+            case kFalse_FilterReturn:
+                return false;
+            case kTrue_FilterReturn:
+                SkASSERT(patch.fOuterRect.width() >=
+                         patch.fMask.fBounds.width());
+                SkASSERT(patch.fOuterRect.height() >=
+                         patch.fMask.fBounds.height());
+                draw_nine(patch, clip, bounder, blitter);
+                SkMask::FreeImage(patch.fMask.fImage);
+                return true;
+            case kUnimplemented_FilterReturn:
+                break;
+        }
+    }
+
     SkMask  srcM, dstM;
 
     if (!SkDraw::DrawToMask(devPath, &clip.getBounds(), this, &matrix, &srcM,
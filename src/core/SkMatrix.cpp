@@ -1029,6 +1029,28 @@ const SkMatrix::MapPtsProc SkMatrix::gMapPtsProcs[] = {
     SkMatrix::Persp_pts,    SkMatrix::Persp_pts
 };
 
+/*  Finding out which procs the CPU can run may be slow (e.g. cpuid), so the
+    choice is made once for each mask. Threads racing to make it only store
+    the same proc.
+ */
+static SkMatrix::MapPtsProc gChosenMapPtsProcs[16];
+
+SkMatrix::MapPtsProc SkMatrix::GetMapPtsProc(TypeMask mask) {
+    SkASSERT((mask & ~kAllMasks) == 0);
+    SkASSERT(SK_ARRAY_COUNT(gChosenMapPtsProcs) == kORableMasks + 1);
+
+    mask = (TypeMask)(mask & kORableMasks);
+    MapPtsProc proc = gChosenMapPtsProcs[mask];
+    if (NULL == proc) {
+        proc = PlatformMapPtsProc(mask);
+        if (NULL == proc) {
+            proc = gMapPtsProcs[mask];
+        }
+        gChosenMapPtsProcs[mask] = proc;
+    }
+    return proc;
+}
+
 void SkMatrix::mapPoints(SkPoint dst[], const SkPoint src[], int count) const {
     SkASSERT((dst && src && count > 0) || count == 0);
     // no partial overlap
@@ -1078,6 +1100,29 @@ bool SkMatrix::mapRect(SkRect* dst, const SkRect& src) const {
     }
 }
 
+bool SkMatrix::mapRects(SkRect dst[], const SkRect src[], int count) const {
+    SkASSERT((dst && src && count > 0) || count == 0);
+
+    if (this->rectStaysRect()) {
+        // the corners of all of the rects are mapped together
+        this->mapPoints((SkPoint*)dst, (const SkPoint*)src, count << 1);
+        for (int i = 0; i < count; i++) {
+            dst[i].sort();
+        }
+        return true;
+    } else {
+        MapPtsProc proc = this->getMapPtsProc();
+        for (int i = 0; i < count; i++) {
+            SkPoint quad[4];
+
+            src[i].toQuad(quad);
+            proc(*this, quad, quad, 4);
+            dst[i].set(quad, 4);
+        }
+        return false;
+    }
+}
+
 SkScalar SkMatrix::mapRadius(SkScalar radius) const {
     SkVector    vec[2];
 
@@ -0,0 +1,235 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkMemoryTracker.h"
+#include "SkThread.h"
+#include <stdlib.h>
+
+namespace {
+
+// in front of every block, keeping what follows 16-byte aligned
+struct BlockHeader {
+    uint64_t    fSize;
+    uint32_t    fMagic;
+    uint32_t    fSite;      // index into gSites, and its generation
+};
+
+}
+
+SK_COMPILE_ASSERT(16 == sizeof(BlockHeader), block_header_size);
+
+#define BLOCK_MAGIC     0x534B4D54  // 'SKMT'
+
+// a power of 2; site 0 is kept for the ones that don't fit
+#define MAX_SITES       4096
+// gives up looking for a free slot after this many
+#define MAX_PROBES      32
+// the rest of a block's fSite is the generation of the sites it counts in
+#define SITE_BITS       12
+SK_COMPILE_ASSERT((1 << SITE_BITS) == MAX_SITES, site_bits);
+
+static SkMemoryTracker::Stats   gStats;
+static SkMemoryTracker::Site    gSites[MAX_SITES];
+static uint32_t                 gSiteGeneration;    // bumped by ResetSites()
+
+// sk_malloc may be called before our static initializers, so don't rely on
+// them having made the mutex
+static SkMutex& get_mutex() {
+    static SkMutex* gMutex;
+    if (NULL == gMutex) {
+        gMutex = new SkMutex;
+    }
+    return *gMutex;
+}
+
+// must be called with the mutex held
+static uint32_t find_site(const void* caller) {
+    uintptr_t hash = (uintptr_t)caller;
+    hash ^= hash >> 16;
+    for (int i = 0; i < MAX_PROBES; i++) {
+        uint32_t index = (uint32_t)((hash + i) & (MAX_SITES - 1));
+        if (0 == index) {
+            continue;
+        }
+        SkMemoryTracker::Site& site = gSites[index];
+        if (site.fCaller == caller) {
+            return index;
+        }
+        if (NULL == site.fCaller) {
+            site.fCaller = caller;
+            return index;
+        }
+    }
+    return 0;
+}
+
+// must be called with the mutex held
+static void count_alloc(BlockHeader* header, size_t size, const void* caller) {
+    header->fSize = size;
+    header->fMagic = BLOCK_MAGIC;
+    uint32_t index = caller ? find_site(caller) : 0;
+    header->fSite = index | (gSiteGeneration << SITE_BITS);
+
+    gStats.fAllocatedBytes += size;
+    gStats.fCurrentBytes += size;
+    if (gStats.fPeakBytes < gStats.fCurrentBytes) {
+        gStats.fPeakBytes = gStats.fCurrentBytes;
+    }
+    gStats.fAllocCount += 1;
+
+    SkMemoryTracker::Site& site = gSites[index];
+    site.fAllocatedBytes += size;
+    site.fCurrentBytes += size;
+    site.fAllocCount += 1;
+}
+
+// must be called with the mutex held
+static SkMemoryTracker::Site* site_of(const BlockHeader* header) {
+    if ((header->fSite >> SITE_BITS) !=
+            (gSiteGeneration & ((1 << (32 - SITE_BITS)) - 1))) {
+        return NULL;    // counted before the last ResetSites()
+    }
+    return &gSites[header->fSite & (MAX_SITES - 1)];
+}
+
+// must be called with the mutex held
+static void count_free(const BlockHeader* header) {
+    gStats.fCurrentBytes -= header->fSize;
+    gStats.fFreeCount += 1;
+    SkMemoryTracker::Site* site = site_of(header);
+    if (site) {
+        site->fCurrentBytes -= header->fSize;
+    }
+}
+
+static BlockHeader* header_of(void* addr) {
+    BlockHeader* header = (BlockHeader*)addr - 1;
+    return BLOCK_MAGIC == header->fMagic ? header : NULL;
+}
+
+void* SkMemoryTracker::Malloc(size_t size, const void* caller) {
+    BlockHeader* header = (BlockHeader*)malloc(sizeof(BlockHeader) + size);
+    if (NULL == header) {
+        return NULL;
+    }
+    SkAutoMutexAcquire ac(get_mutex());
+    count_alloc(header, size, caller);
+    return header + 1;
+}
+
+void* SkMemoryTracker::Realloc(void* addr, size_t size, const void* caller) {
+    if (NULL == addr) {
+        return Malloc(size, caller);
+    }
+    if (0 == size) {
+        Free(addr);
+        return NULL;
+    }
+    BlockHeader* header = header_of(addr);
+    if (NULL == header) {
+        return realloc(addr, size);
+    }
+
+    // the old block may be freed by realloc(), so take it off first
+    BlockHeader old = *header;
+    {
+        SkAutoMutexAcquire ac(get_mutex());
+        count_free(&old);
+    }
+    header->fMagic = 0;
+    BlockHeader* newHeader = (BlockHeader*)realloc(header,
+                                                   sizeof(BlockHeader) + size);
+    SkAutoMutexAcquire ac(get_mutex());
+    if (NULL == newHeader) {
+        // the old block is still there
+        header->fMagic = BLOCK_MAGIC;
+        gStats.fCurrentBytes += old.fSize;
+        gStats.fFreeCount -= 1;
+        SkMemoryTracker::Site* site = site_of(&old);
+        if (site) {
+            site->fCurrentBytes += old.fSize;
+        }
+        return NULL;
+    }
+    count_alloc(newHeader, size, caller);
+    return newHeader + 1;
+}
+
+void SkMemoryTracker::Free(void* addr) {
+    if (NULL == addr) {
+        return;
+    }
+    BlockHeader* header = header_of(addr);
+    if (NULL == header) {
+        free(addr);
+        return;
+    }
+    {
+        SkAutoMutexAcquire ac(get_mutex());
+        count_free(header);
+    }
+    header->fMagic = 0;
+    free(header);
+}
+
+bool SkMemoryTracker::IsEnabled() {
+#ifdef SK_ENABLE_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SkMemoryTracker::GetStats(Stats* stats) {
+    SkAutoMutexAcquire ac(get_mutex());
+    *stats = gStats;
+}
+
+void SkMemoryTracker::ResetPeak() {
+    SkAutoMutexAcquire ac(get_mutex());
+    gStats.fPeakBytes = gStats.fCurrentBytes;
+}
+
+int SkMemoryTracker::GetSites(Site sites[], int maxCount) {
+    SkAutoMutexAcquire ac(get_mutex());
+    int count = 0;
+    for (int i = 0; i < MAX_SITES; i++) {
+        const Site& site = gSites[i];
+        if (0 == site.fAllocCount) {
+            continue;
+        }
+        count += 1;
+        // keep the first maxCount sorted, by inserting each one
+        int j = SkMin32(count, maxCount) - 1;
+        if (j < 0 || (j == maxCount - 1 && count > maxCount &&
+                      sites[j].fAllocatedBytes >= site.fAllocatedBytes)) {
+            continue;
+        }
+        while (j > 0 && sites[j - 1].fAllocatedBytes < site.fAllocatedBytes) {
+            sites[j] = sites[j - 1];
+            j -= 1;
+        }
+        sites[j] = site;
+    }
+    return count;
+}
+
+void SkMemoryTracker::ResetSites() {
+    SkAutoMutexAcquire ac(get_mutex());
+    memset(gSites, 0, sizeof(gSites));
+    gSiteGeneration += 1;
+}
@@ -16,9 +16,22 @@
 */
 
 #include "SkTypes.h"
+#include "SkMemoryTracker.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef SK_ENABLE_MEMORY_TRACKING
+    #define sk_raw_malloc(size, caller)         \
+        SkMemoryTracker::Malloc(size, caller)
+    #define sk_raw_realloc(addr, size, caller)  \
+        SkMemoryTracker::Realloc(addr, size, caller)
+    #define sk_raw_free(addr)                   SkMemoryTracker::Free(addr)
+#else
+    #define sk_raw_malloc(size, caller)         malloc(size)
+    #define sk_raw_realloc(addr, size, caller)  realloc(addr, size)
+    #define sk_raw_free(addr)                   free(addr)
+#endif
+
 #ifdef SK_DEBUG
     #define SK_TAG_BLOCKS
     // #define SK_TRACK_ALLOC  // enable to see a printf for every alloc/free
@@ -183,9 +196,11 @@ void sk_out_of_memory(void)
     abort();
 }
 
+static void* malloc_flags(size_t size, unsigned flags, const void* caller);
+
 void* sk_malloc_throw(size_t size)
 {
-    return sk_malloc_flags(size, SK_MALLOC_THROW);
+    return malloc_flags(size, SK_MALLOC_THROW, SK_MEMORY_CALLER());
 }
 
 void* sk_realloc_throw(void* addr, size_t size)
@@ -206,7 +221,7 @@ void* sk_realloc_throw(void* addr, size_t size)
         size += sizeof(SkBlockHeader);
 #endif
 
-    void* p = realloc(addr, size);
+    void* p = sk_raw_realloc(addr, size, SK_MEMORY_CALLER());
     if (size == 0)
     {
         ValidateHeap();
@@ -246,12 +261,18 @@ void sk_free(void* p)
         p = header;
 #endif
         ValidateHeap();
-        free(p);
+        sk_raw_free(p);
         ValidateHeap();
     }
 }
 
 void* sk_malloc_flags(size_t size, unsigned flags)
+{
+    return malloc_flags(size, flags, SK_MEMORY_CALLER());
+}
+
+// caller is who called sk_malloc, for SkMemoryTracker
+static void* malloc_flags(size_t size, unsigned flags, const void* caller)
 {
     ValidateHeap();
 #ifdef SK_TAG_BLOCKS
@@ -259,7 +280,7 @@ void* sk_malloc_flags(size_t size, unsigned flags)
     size += sizeof(SkBlockHeader);
 #endif
     
-    void* p = malloc(size);
+    void* p = sk_raw_malloc(size, caller);
     if (p == NULL)
     {
         if (flags & SK_MALLOC_THROW)
@@ -402,3 +402,56 @@ void SkPackBits::Unpack8(uint8_t* SK_RESTRICT dst, size_t dstSkip,
     }
     SkASSERT(0 == dstWrite);
 }
+
+static inline void table_memset(uint32_t dst[], uint32_t value, int n) {
+    sk_memset32(dst, value, n);
+}
+
+static inline void table_memset(uint16_t dst[], uint16_t value, int n) {
+    sk_memset16(dst, value, n);
+}
+
+// walks the runs, skipping the start of the ones that begin before dstSkip
+template <typename T>
+static void unpack8_to_table(T* SK_RESTRICT dst, size_t dstSkip,
+                             size_t dstWrite, const uint8_t* SK_RESTRICT src,
+                             const T* SK_RESTRICT table) {
+    while (dstWrite > 0) {
+        size_t n = *src++;
+        const bool repeat = n <= 127;
+        n = repeat ? n + 1 : n - 127;
+
+        if (dstSkip >= n) {
+            dstSkip -= n;
+            src += repeat ? 1 : n;
+            continue;
+        }
+        size_t count = n - dstSkip;
+        if (count > dstWrite) {
+            count = dstWrite;
+        }
+        if (repeat) {
+            table_memset(dst, table[*src], count);
+            src += 1;
+        } else {
+            const uint8_t* SK_RESTRICT s = src + dstSkip;
+            for (size_t i = 0; i < count; i++) {
+                dst[i] = table[s[i]];
+            }
+            src += n;
+        }
+        dstSkip = 0;
+        dst += count;
+        dstWrite -= count;
+    }
+}
+
+void SkPackBits::Unpack8To32(uint32_t dst[], size_t dstSkip, size_t dstWrite,
+                             const uint8_t src[], const uint32_t table[]) {
+    unpack8_to_table<uint32_t>(dst, dstSkip, dstWrite, src, table);
+}
+
+void SkPackBits::Unpack8To16(uint16_t dst[], size_t dstSkip, size_t dstWrite,
+                             const uint8_t src[], const uint16_t table[]) {
+    unpack8_to_table<uint16_t>(dst, dstSkip, dstWrite, src, table);
+}
@@ -135,7 +135,9 @@ SkPaint& SkPaint::operator=(const SkPaint& src) {
 }
 
 int operator==(const SkPaint& a, const SkPaint& b) {
-    return memcmp(&a, &b, sizeof(a)) == 0;
+    // the fast bounds cache (at the end) depends only on what comes before it
+    const size_t size = (const char*)&a.fFastBoundsOutset - (const char*)&a;
+    return memcmp(&a, &b, size) == 0;
 }
 
 void SkPaint::reset() {
@@ -171,6 +173,11 @@ void SkPaint::setAntiAlias(bool doAA) {
     this->setFlags(SkSetClearMask(fFlags, doAA, kAntiAlias_Flag));
 }
 
+void SkPaint::setAnalyticAA(bool analyticAA) {
+    GEN_ID_INC_EVAL(analyticAA != isAnalyticAA());
+    this->setFlags(SkSetClearMask(fFlags, analyticAA, kAnalyticAA_Flag));
+}
+
 void SkPaint::setDither(bool doDither) {
     GEN_ID_INC_EVAL(doDither != isDither());
     this->setFlags(SkSetClearMask(fFlags, doDither, kDither_Flag));
@@ -230,6 +237,7 @@ void SkPaint::setStyle(Style style) {
     if ((unsigned)style < kStyleCount) {
         GEN_ID_INC_EVAL((unsigned)style != fStyle);
         fStyle = style;
+        this->dirtyFastBounds();
     } else {
         SkDEBUGCODE(SkDebugf("SkPaint::setStyle(%d) out of range\n", style);)
     }
@@ -253,6 +261,7 @@ void SkPaint::setStrokeWidth(SkScalar width) {
     if (width >= 0) {
         GEN_ID_INC_EVAL(width != fWidth);
         fWidth = width;
+        this->dirtyFastBounds();
     } else {
         SkDEBUGCODE(SkDebugf("SkPaint::setStrokeWidth() called with negative value\n");)
     }
@@ -262,6 +271,7 @@ void SkPaint::setStrokeMiter(SkScalar limit) {
     if (limit >= 0) {
         GEN_ID_INC_EVAL(limit != fMiterLimit);
         fMiterLimit = limit;
+        this->dirtyFastBounds();
     } else {
         SkDEBUGCODE(SkDebugf("SkPaint::setStrokeMiter() called with negative value\n");)
     }
@@ -280,6 +290,7 @@ void SkPaint::setStrokeJoin(Join jt) {
     if ((unsigned)jt < kJoinCount) {
         GEN_ID_INC_EVAL((unsigned)jt != fJoinType);
         fJoinType = SkToU8(jt);
+        this->dirtyFastBounds();
     } else {
         SkDEBUGCODE(SkDebugf("SkPaint::setStrokeJoin(%d) out of range\n", jt);)
     }
@@ -334,12 +345,14 @@ SkTypeface* SkPaint::setTypeface(SkTypeface* font) {
 
 SkRasterizer* SkPaint::setRasterizer(SkRasterizer* r) {
     SkRefCnt_SafeAssign(fRasterizer, r);
+    this->dirtyFastBounds();
     GEN_ID_INC;
     return r;
 }
 
 SkDrawLooper* SkPaint::setLooper(SkDrawLooper* looper) {
     SkRefCnt_SafeAssign(fLooper, looper);
+    this->dirtyFastBounds();
     GEN_ID_INC;
     return looper;
 }
@@ -780,6 +793,41 @@ static void join_bounds(const SkGlyph& g, SkRect* bounds, Sk48Dot16 dx) {
                  SkIntToScalar(g.fTop + g.fHeight));
 }
 
+/*  Without bounds or kerning, each char only adds its advance, so the runs of
+    chars that the strike keeps a table of are added up straight from it, and
+    only the others go through the cache.
+ */
+static Sk48Dot16 measure_utf8_advances(SkGlyphCache* cache, const char* text,
+                                       const char* stop, int* count) {
+    Sk48Dot16 x = 0;
+    int n = 0;
+    while (text < stop) {
+        x += cache->sumUTF8AdvancesX(&text, stop, &n);
+        if (text < stop) {
+            x += cache->getUnicharAdvanceX(SkUTF8_NextUnichar(&text));
+            n += 1;
+        }
+    }
+    *count = n;
+    return x;
+}
+
+static Sk48Dot16 measure_utf16_advances(SkGlyphCache* cache,
+                                        const uint16_t* text,
+                                        const uint16_t* stop, int* count) {
+    Sk48Dot16 x = 0;
+    int n = 0;
+    while (text < stop) {
+        x += cache->sumUTF16AdvancesX(&text, stop, &n);
+        if (text < stop) {
+            x += cache->getUnicharAdvanceX(SkUTF16_NextUnichar(&text));
+            n += 1;
+        }
+    }
+    *count = n;
+    return x;
+}
+
 SkScalar SkPaint::measure_text(SkGlyphCache* cache,
                                const char* text, size_t byteLength,
                                int* count, SkRect* bounds) const {
@@ -792,6 +840,21 @@ SkScalar SkPaint::measure_text(SkGlyphCache* cache,
         return 0;
     }
 
+    if (NULL == bounds && !this->isDevKernText()) {
+        const char* stop = text + byteLength;
+        switch (this->getTextEncoding()) {
+            case kUTF8_TextEncoding:
+                return Sk48Dot16ToScalar(measure_utf8_advances(cache, text,
+                                                               stop, count));
+            case kUTF16_TextEncoding:
+                return Sk48Dot16ToScalar(measure_utf16_advances(cache,
+                                                (const uint16_t*)text,
+                                                (const uint16_t*)stop, count));
+            default:
+                break;
+        }
+    }
+
     SkMeasureCacheProc glyphCacheProc;
     glyphCacheProc = this->getMeasureCacheProc(kForward_TextBufferDirection,
                                                NULL != bounds);
@@ -958,6 +1021,23 @@ size_t SkPaint::breakText(const void* textD, size_t length, SkScalar maxWidth,
             }
             rsb = g.fRsbDelta;
         }
+    } else if (kForward_TextBufferDirection == tbd &&
+               kUTF8_TextEncoding == this->getTextEncoding()) {
+        while (text < stop) {
+            const char* curr = text;
+            SkUnichar uni = *(const uint8_t*)text;
+            if (uni < 0x80) {
+                text += 1;
+            } else {
+                uni = SkUTF8_NextUnichar(&text);
+            }
+            SkFixed x = cache->getUnicharAdvanceX(uni);
+            if ((width += x) > max) {
+                width -= x;
+                text = curr;
+                break;
+            }
+        }
     } else {
         while (pred(text, stop)) {
             const char* curr = text;
@@ -1117,6 +1197,19 @@ int SkPaint::getTextWidths(const void* textData, size_t byteLength,
                 *widths = SkFixedToScalar(prevWidth);
             }
         }
+    } else if (NULL == bounds && kUTF8_TextEncoding == this->getTextEncoding()) {
+        // just the advances, which for ASCII come from the strike's table
+        while (text < stop) {
+            SkUnichar uni = *(const uint8_t*)text;
+            if (uni < 0x80) {
+                text += 1;
+            } else {
+                uni = SkUTF8_NextUnichar(&text);
+            }
+            SkScalar w = SkFixedToScalar(cache->getUnicharAdvanceX(uni));
+            *widths++ = scale ? SkScalarMul(w, scale) : w;
+            ++count;
+        }
     } else {    // no devkern
         if (scale) {
             while (text < stop) {
@@ -1623,12 +1716,14 @@ SkXfermode* SkPaint::setXfermodeMode(SkXfermode::Mode mode) {
 SkPathEffect* SkPaint::setPathEffect(SkPathEffect* effect) {
     GEN_ID_INC_EVAL(effect != fPathEffect);
     SkRefCnt_SafeAssign(fPathEffect, effect);
+    this->dirtyFastBounds();
     return effect;
 }
 
 SkMaskFilter* SkPaint::setMaskFilter(SkMaskFilter* filter) {
     GEN_ID_INC_EVAL(filter != fMaskFilter);
     SkRefCnt_SafeAssign(fMaskFilter, filter);
+    this->dirtyFastBounds();
     return filter;
 }
 
@@ -1692,23 +1787,56 @@ bool SkPaint::getFillPath(const SkPath& src, SkPath* dst) const {
     return width != 0;  // return true if we're filled, or false if we're hairline (width == 0)
 }
 
-const SkRect& SkPaint::computeStrokeFastBounds(const SkRect& src,
-                                               SkRect* storage) const {
-    SkASSERT(storage);
-    SkASSERT(this->getStyle() != SkPaint::kFill_Style);
-
-    // since we're stroked, outset the rect by the radius (and join type)
-    SkScalar radius = SkScalarHalf(this->getStrokeWidth());
-    if (0 == radius) {  // hairline
-        radius = SK_Scalar1;
-    } else if (this->getStrokeJoin() == SkPaint::kMiter_Join) {
-        SkScalar scale = this->getStrokeMiter();
-        if (scale > SK_Scalar1) {
-            radius = SkScalarMul(radius, scale);
+/*  The outset is the fast bounds of a shape with empty bounds at the origin:
+    each effect grows it by what it adds to the bounds of what it is given,
+    in the order that they are applied.
+ */
+const SkRect* SkPaint::getFastBoundsOutset() const {
+    if (kDirty_FastBoundsState == fFastBoundsState) {
+        SkRect outset;
+        outset.setEmpty();
+        bool ok = NULL == fRasterizer;
+        if (ok && fPathEffect) {
+            ok = fPathEffect->computeFastBoundsOutset(&outset);
         }
+        if (ok && this->getStyle() != kFill_Style) {
+            // since we're stroked, outset by the radius (and join type)
+            SkScalar radius = SkScalarHalf(this->getStrokeWidth());
+            if (0 == radius) {  // hairline
+                radius = SK_Scalar1;
+            } else if (this->getStrokeJoin() == kMiter_Join) {
+                SkScalar scale = this->getStrokeMiter();
+                if (scale > SK_Scalar1) {
+                    radius = SkScalarMul(radius, scale);
+                }
+            }
+            outset.inset(-radius, -radius);
+        }
+        if (ok && fMaskFilter) {
+            ok = fMaskFilter->computeFastBoundsOutset(&outset);
+        }
+        if (ok && fLooper) {
+            ok = fLooper->computeFastBoundsOutset(&outset);
+        }
+        fFastBoundsOutset = outset;
+        fFastBoundsState = ok ? kOutset_FastBoundsState :
+                                kNone_FastBoundsState;
+    }
+    return kOutset_FastBoundsState == fFastBoundsState ? &fFastBoundsOutset :
+                                                         NULL;
+}
+
+const SkRect& SkPaint::doComputeFastBounds(const SkRect& src,
+                                           SkRect* storage) const {
+    SkASSERT(storage);
+
+    const SkRect* outset = this->getFastBoundsOutset();
+    SkASSERT(outset);
+    if (NULL == outset) {
+        return src;
     }
-    storage->set(src.fLeft - radius, src.fTop - radius,
-                 src.fRight + radius, src.fBottom + radius);
+    storage->set(src.fLeft + outset->fLeft, src.fTop + outset->fTop,
+                 src.fRight + outset->fRight, src.fBottom + outset->fBottom);
     return *storage;
 }
 
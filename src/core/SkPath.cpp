@@ -19,6 +19,7 @@
 #include "SkReader32.h"
 #include "SkWriter32.h"
 #include "SkMath.h"
+#include "SkThread.h"
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -72,7 +73,8 @@ private:
     }
 };
 
-static void compute_pt_bounds(SkRect* bounds, const SkTDArray<SkPoint>& pts) {
+template <typename Array>
+static void compute_pt_bounds(SkRect* bounds, const Array& pts) {
     if (pts.count() <= 1) {  // we ignore just 1 point (moveto)
         bounds->set(0, 0, 0, 0);
     } else {
@@ -96,20 +98,31 @@ static void compute_pt_bounds(SkRect* bounds, const SkTDArray<SkPoint>& pts) {
 
 ////////////////////////////////////////////////////////////////////////////
 
+// values of fDirection besides the Directions
+enum {
+    kUnknown_Direction = 2,     // not computed yet
+    kNone_Direction             // not convex, or degenerate
+};
+
+#define DIRTY_AFTER_EDIT                    \
+    do {                                    \
+        fBoundsIsDirty = true;              \
+        fConvexity = kUnknown_Convexity;    \
+        fDirection = kUnknown_Direction;    \
+        fIsOval = false;                    \
+        fGenerationID = 0;                  \
+    } while (0)
+
 SkPath::SkPath() : fBoundsIsDirty(true), fFillType(kWinding_FillType) {
     fConvexity = kUnknown_Convexity;
-#ifdef ANDROID
+    fDirection = kUnknown_Direction;
+    fIsOval = false;
     fGenerationID = 0;
-#endif
 }
 
 SkPath::SkPath(const SkPath& src) {
     SkDEBUGCODE(src.validate();)
     *this = src;
-#ifdef ANDROID
-    // the assignment operator above increments the ID so correct for that here
-    fGenerationID--;
-#endif
 }
 
 SkPath::~SkPath() {
@@ -126,7 +139,9 @@ SkPath& SkPath::operator=(const SkPath& src) {
         fFillType       = src.fFillType;
         fBoundsIsDirty  = src.fBoundsIsDirty;
         fConvexity      = src.fConvexity;
-        GEN_ID_INC;
+        fDirection      = src.fDirection;
+        fIsOval         = src.fIsOval;
+        fGenerationID   = src.fGenerationID;
     }
     SkDEBUGCODE(this->validate();)
     return *this;
@@ -149,24 +164,29 @@ void SkPath::swap(SkPath& other) {
         SkTSwap<uint8_t>(fFillType, other.fFillType);
         SkTSwap<uint8_t>(fBoundsIsDirty, other.fBoundsIsDirty);
         SkTSwap<uint8_t>(fConvexity, other.fConvexity);
-        GEN_ID_INC;
+        SkTSwap<uint8_t>(fDirection, other.fDirection);
+        SkTSwap<uint8_t>(fIsOval, other.fIsOval);
+        SkTSwap<uint32_t>(fGenerationID, other.fGenerationID);
     }
 }
 
-#ifdef ANDROID
 uint32_t SkPath::getGenerationID() const {
+    if (0 == fGenerationID) {
+        static int32_t gPathGenerationID;
+        // loop in case the global wraps around, as we never return 0
+        do {
+            fGenerationID = sk_atomic_inc(&gPathGenerationID) + 1;
+        } while (0 == fGenerationID);
+    }
     return fGenerationID;
 }
-#endif
 
 void SkPath::reset() {
     SkDEBUGCODE(this->validate();)
 
     fPts.reset();
     fVerbs.reset();
-    GEN_ID_INC;
-    fBoundsIsDirty = true;
-    fConvexity = kUnknown_Convexity;
+    DIRTY_AFTER_EDIT;
 }
 
 void SkPath::rewind() {
@@ -174,9 +194,7 @@ void SkPath::rewind() {
 
     fPts.rewind();
     fVerbs.rewind();
-    GEN_ID_INC;
-    fBoundsIsDirty = true;
-    fConvexity = kUnknown_Convexity;
+    DIRTY_AFTER_EDIT;
 }
 
 bool SkPath::isEmpty() const {
@@ -186,11 +204,53 @@ bool SkPath::isEmpty() const {
     return count == 0 || (count == 1 && fVerbs[0] == kMove_Verb);
 }
 
-bool SkPath::isRect(SkRect*) const {
+bool SkPath::isRect(SkRect* rect) const {
     SkDEBUGCODE(this->validate();)
 
-    SkASSERT(!"unimplemented");
-    return false;
+    // a rect is a moveTo and 3 or 4 lineTos, which may be closed
+    int verbCount = fVerbs.count();
+    if (verbCount > 0 && kClose_Verb == fVerbs[verbCount - 1]) {
+        verbCount -= 1;
+    }
+    if (verbCount < 4 || verbCount > 5 || kMove_Verb != fVerbs[0]) {
+        return false;
+    }
+    for (int i = 1; i < verbCount; i++) {
+        if (kLine_Verb != fVerbs[i]) {
+            return false;
+        }
+    }
+
+    const SkPoint* pts = fPts.begin();
+    SkASSERT(fPts.count() == verbCount);
+    if (5 == verbCount && pts[4] != pts[0]) {
+        return false;
+    }
+    // the sides have to alternate between horizontal and vertical (which
+    // means none of them is empty)
+    const bool firstIsHorizontal = pts[0].fY == pts[1].fY;
+    for (int i = 0; i < 4; i++) {
+        const SkPoint& a = pts[i];
+        const SkPoint& b = pts[(i + 1) & 3];
+        bool horizontal = a.fY == b.fY;
+        bool vertical = a.fX == b.fX;
+        if (horizontal == vertical ||
+                horizontal != (firstIsHorizontal ^ (i & 1))) {
+            return false;
+        }
+    }
+
+    if (rect) {
+        *rect = this->getBounds();
+    }
+    return true;
+}
+
+bool SkPath::isOval(SkRect* rect) const {
+    if (fIsOval && rect) {
+        *rect = this->getBounds();
+    }
+    return SkToBool(fIsOval);
 }
 
 int SkPath::getPoints(SkPoint copy[], int max) const {
@@ -232,7 +292,7 @@ void SkPath::setLastPt(SkScalar x, SkScalar y) {
         this->moveTo(x, y);
     } else {
         fPts[count - 1].set(x, y);
-        GEN_ID_INC;
+        DIRTY_AFTER_EDIT;
     }
 }
 
@@ -247,19 +307,13 @@ void SkPath::computeBounds() const {
 void SkPath::setConvexity(Convexity c) {
     if (fConvexity != c) {
         fConvexity = c;
-        GEN_ID_INC;
+        fGenerationID = 0;
     }
 }
 
 //////////////////////////////////////////////////////////////////////////////
 //  Construction methods
 
-#define DIRTY_AFTER_EDIT                \
-    do {                                \
-        fBoundsIsDirty = true;          \
-        fConvexity = kUnknown_Convexity;\
-    } while (0)
-
 void SkPath::incReserve(U16CPU inc) {
     SkDEBUGCODE(this->validate();)
 
@@ -283,7 +337,6 @@ void SkPath::moveTo(SkScalar x, SkScalar y) {
     }
     pt->set(x, y);
 
-    GEN_ID_INC;
     DIRTY_AFTER_EDIT;
 }
 
@@ -303,7 +356,6 @@ void SkPath::lineTo(SkScalar x, SkScalar y) {
     fPts.append()->set(x, y);
     *fVerbs.append() = kLine_Verb;
 
-    GEN_ID_INC;
     DIRTY_AFTER_EDIT;
 }
 
@@ -326,7 +378,6 @@ void SkPath::quadTo(SkScalar x1, SkScalar y1, SkScalar x2, SkScalar y2) {
     pts[1].set(x2, y2);
     *fVerbs.append() = kQuad_Verb;
 
-    GEN_ID_INC;
     DIRTY_AFTER_EDIT;
 }
 
@@ -350,7 +401,6 @@ void SkPath::cubicTo(SkScalar x1, SkScalar y1, SkScalar x2, SkScalar y2,
     pts[2].set(x3, y3);
     *fVerbs.append() = kCubic_Verb;
 
-    GEN_ID_INC;
     DIRTY_AFTER_EDIT;
 }
 
@@ -372,7 +422,8 @@ void SkPath::close() {
             case kQuad_Verb:
             case kCubic_Verb:
                 *fVerbs.append() = kClose_Verb;
-                GEN_ID_INC;
+                fIsOval = false;
+                fGenerationID = 0;
                 break;
             default:
                 // don't add a close if the prev wasn't a primitive
@@ -390,6 +441,7 @@ void SkPath::addRect(const SkRect& rect, Direction dir) {
 void SkPath::addRect(SkScalar left, SkScalar top, SkScalar right,
                      SkScalar bottom, Direction dir) {
     SkAutoPathBoundsUpdate apbu(this, left, top, right, bottom);
+    const bool wasEmpty = this->isEmpty();
 
     this->incReserve(5);
 
@@ -404,6 +456,10 @@ void SkPath::addRect(SkScalar left, SkScalar top, SkScalar right,
         this->lineTo(left, bottom);
     }
     this->close();
+
+    if (wasEmpty) {
+        fDirection = dir;
+    }
 }
 
 #define CUBIC_ARC_FACTOR    ((SK_ScalarSqrt2 - SK_Scalar1) * 4 / 3)
@@ -550,6 +606,7 @@ void SkPath::addRoundRect(const SkRect& rect, const SkScalar rad[],
 
 void SkPath::addOval(const SkRect& oval, Direction dir) {
     SkAutoPathBoundsUpdate apbu(this, oval);
+    const bool wasEmpty = this->isEmpty();
 
     SkScalar    cx = oval.centerX();
     SkScalar    cy = oval.centerY();
@@ -612,6 +669,11 @@ void SkPath::addOval(const SkRect& oval, Direction dir) {
     }
 #endif
     this->close();
+
+    if (wasEmpty) {
+        fIsOval = true;
+        fDirection = dir;
+    }
 }
 
 void SkPath::addCircle(SkScalar x, SkScalar y, SkScalar r, Direction dir) {
@@ -990,7 +1052,6 @@ void SkPath::transform(const SkMatrix& matrix, SkPath* dst) const {
             matrix.mapRect(&dst->fBounds, fBounds);
             dst->fBoundsIsDirty = false;
         } else {
-            GEN_ID_PTR_INC(dst);
             dst->fBoundsIsDirty = true;
         }
 
@@ -998,7 +1059,13 @@ void SkPath::transform(const SkMatrix& matrix, SkPath* dst) const {
             dst->fVerbs = fVerbs;
             dst->fPts.setCount(fPts.count());
             dst->fFillType = fFillType;
+            // an affine matrix keeps a path convex (or not)
+            dst->fConvexity = fConvexity;
         }
+        // but a mirror reverses its direction
+        dst->fDirection = kUnknown_Direction;
+        dst->fIsOval = fIsOval && matrix.rectStaysRect();
+        dst->fGenerationID = 0;
         matrix.mapPoints(dst->fPts.begin(), fPts.begin(), fPts.count());
         SkDEBUGCODE(dst->validate();)
     }
@@ -1215,7 +1282,6 @@ void SkPath::unflatten(SkReader32& buffer) {
     buffer.read(fPts.begin(), sizeof(SkPoint) * fPts.count());
     buffer.read(fVerbs.begin(), fVerbs.count());
 
-    GEN_ID_INC;
     DIRTY_AFTER_EDIT;
 
     SkDEBUGCODE(this->validate();)
@@ -1346,6 +1412,7 @@ struct Convexicator {
     }
 
     SkPath::Convexity getConvexity() const { return fConvexity; }
+    int getSign() const { return fSign; }
 
     void addPt(const SkPoint& pt) {
         if (SkPath::kConcave_Convexity == fConvexity) {
@@ -1409,7 +1476,9 @@ private:
     int                 fDx, fDy, fSx, fSy;
 };
 
-SkPath::Convexity SkPath::ComputeConvexity(const SkPath& path) {
+// sign is the sign of the cross products of a convex path's edges, or 0 if
+// the path isn't convex or is degenerate
+static SkPath::Convexity compute_convexity(const SkPath& path, int* sign) {
     SkPoint         pts[4];
     SkPath::Verb    verb;
     SkPath::Iter    iter(path, true);
@@ -1418,34 +1487,69 @@ SkPath::Convexity SkPath::ComputeConvexity(const SkPath& path) {
     int             count;
     Convexicator    state;
 
+    *sign = 0;
     while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
         switch (verb) {
-            case kMove_Verb:
+            case SkPath::kMove_Verb:
                 if (++contourCount > 1) {
-                    return kConcave_Convexity;
+                    return SkPath::kConcave_Convexity;
                 }
                 pts[1] = pts[0];
                 count = 1;
                 break;
-            case kLine_Verb: count = 1; break;
-            case kQuad_Verb: count = 2; break;
-            case kCubic_Verb: count = 3; break;
-            case kClose_Verb:
+            case SkPath::kLine_Verb: count = 1; break;
+            case SkPath::kQuad_Verb: count = 2; break;
+            case SkPath::kCubic_Verb: count = 3; break;
+            case SkPath::kClose_Verb:
                 state.close();
                 count = 0;
                 break;
             default:
                 SkASSERT(!"bad verb");
-                return kConcave_Convexity;
+                return SkPath::kConcave_Convexity;
         }
 
         for (int i = 1; i <= count; i++) {
             state.addPt(pts[i]);
         }
         // early exit
-        if (kConcave_Convexity == state.getConvexity()) {
-            return kConcave_Convexity;
+        if (SkPath::kConcave_Convexity == state.getConvexity()) {
+            return SkPath::kConcave_Convexity;
         }
     }
+    *sign = state.getSign();
     return state.getConvexity();
 }
+
+SkPath::Convexity SkPath::ComputeConvexity(const SkPath& path) {
+    int sign;
+    return compute_convexity(path, &sign);
+}
+
+void SkPath::computeConvexity() const {
+    int sign;
+    Convexity convexity = compute_convexity(*this, &sign);
+    // don't override a convexity that was set
+    if (kUnknown_Convexity == fConvexity) {
+        fConvexity = (uint8_t)convexity;
+    }
+    if (kConvex_Convexity != convexity || 0 == sign) {
+        fDirection = kNone_Direction;
+    } else {
+        // y points down, so a positive cross product turns clockwise
+        fDirection = sign > 0 ? kCW_Direction : kCCW_Direction;
+    }
+}
+
+bool SkPath::getDirection(Direction* dir) const {
+    if (kUnknown_Direction == fDirection) {
+        this->computeConvexity();
+    }
+    if (kNone_Direction == fDirection) {
+        return false;
+    }
+    if (dir) {
+        *dir = (Direction)fDirection;
+    }
+    return true;
+}
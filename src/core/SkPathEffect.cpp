@@ -19,6 +19,10 @@
 #include "SkPath.h"
 #include "SkBuffer.h"
 
+bool SkPathEffect::computeFastBoundsOutset(SkRect*) const {
+    return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkPairPathEffect::SkPairPathEffect(SkPathEffect* pe0, SkPathEffect* pe1)
@@ -66,6 +70,11 @@ bool SkComposePathEffect::filterPath(SkPath* dst, const SkPath& src,
     return fPE0->filterPath(dst, *ptr, width);
 }
 
+bool SkComposePathEffect::computeFastBoundsOutset(SkRect* outset) const {
+    return fPE0 && fPE1 && fPE1->computeFastBoundsOutset(outset) &&
+           fPE0->computeFastBoundsOutset(outset);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 bool SkSumPathEffect::filterPath(SkPath* dst, const SkPath& src,
@@ -74,6 +83,20 @@ bool SkSumPathEffect::filterPath(SkPath* dst, const SkPath& src,
     return  fPE0->filterPath(dst, src, width) | fPE1->filterPath(dst, src, width);
 }
 
+bool SkSumPathEffect::computeFastBoundsOutset(SkRect* outset) const {
+    SkRect outset1 = *outset;
+    if (!fPE0->computeFastBoundsOutset(outset) ||
+            !fPE1->computeFastBoundsOutset(&outset1)) {
+        return false;
+    }
+    // not join(), which skips empty rects
+    outset->set(SkMinScalar(outset->fLeft, outset1.fLeft),
+                SkMinScalar(outset->fTop, outset1.fTop),
+                SkMaxScalar(outset->fRight, outset1.fRight),
+                SkMaxScalar(outset->fBottom, outset1.fBottom));
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkStroke.h"
@@ -7,10 +7,15 @@
 #define kPathCount  64
 
 SkPathHeap::SkPathHeap() : fHeap(kPathCount * sizeof(SkPath)) {
+    fSlots = NULL;
+    fSlotCount = 0;
 }
 
 SkPathHeap::SkPathHeap(SkFlattenableReadBuffer& buffer)
             : fHeap(kPathCount * sizeof(SkPath)) {
+    fSlots = NULL;
+    fSlotCount = 0;
+
     int count = buffer.readS32();
 
     fPaths.setCount(count);
@@ -32,12 +37,69 @@ SkPathHeap::~SkPathHeap() {
         (*iter)->~SkPath();
         iter++;
     }
+    sk_free(fSlots);
+}
+
+template <typename PointArray, typename VerbArray>
+static uint32_t hash_path(const SkPath& path, const PointArray& pts,
+                          const VerbArray& verbs) {
+    // FNV-1a over the fill type, the points and the verbs
+    uint32_t hash = (2166136261U ^ path.getFillType()) * 16777619U;
+    const uint32_t* words = (const uint32_t*)pts.begin();
+    const uint32_t* stop = words + pts.count() * 2;
+    while (words < stop) {
+        hash = (hash ^ *words++) * 16777619U;
+    }
+    for (int i = 0; i < verbs.count(); i++) {
+        hash = (hash ^ verbs[i]) * 16777619U;
+    }
+    return hash;
+}
+
+void SkPathHeap::addToSlots(int index) {
+    int slot = fHashes[index] & (fSlotCount - 1);
+    while (fSlots[slot]) {
+        slot = (slot + 1) & (fSlotCount - 1);
+    }
+    fSlots[slot] = index + 1;
+}
+
+void SkPathHeap::growSlots() {
+    sk_free(fSlots);
+    fSlotCount = fSlotCount ? fSlotCount << 1 : kPathCount;
+    fSlots = (int*)sk_malloc_throw(fSlotCount * sizeof(int));
+    sk_bzero(fSlots, fSlotCount * sizeof(int));
+    for (int i = 0; i < fHashes.count(); i++) {
+        this->addToSlots(i);
+    }
 }
 
 int SkPathHeap::append(const SkPath& path) {
+    // a heap that was read back has no hashes yet
+    while (fHashes.count() < fPaths.count()) {
+        const SkPath& p = *fPaths[fHashes.count()];
+        *fHashes.append() = hash_path(p, p.fPts, p.fVerbs);
+    }
+    // keep at least a quarter of the slots empty, so that probes stay short
+    if ((fPaths.count() + 1) * 4 > fSlotCount * 3) {
+        this->growSlots();
+    }
+
+    const uint32_t hash = hash_path(path, path.fPts, path.fVerbs);
+    int slot = hash & (fSlotCount - 1);
+    while (fSlots[slot]) {
+        int index = fSlots[slot] - 1;
+        if (fHashes[index] == hash && *fPaths[index] == path) {
+            return index + 1;
+        }
+        slot = (slot + 1) & (fSlotCount - 1);
+    }
+
     SkPath* p = (SkPath*)fHeap.allocThrow(sizeof(SkPath));
     new (p) SkPath(path);
     *fPaths.append() = p;
+    *fHashes.append() = hash;
+    fSlots[slot] = fPaths.count();
     return fPaths.count();
 }
 
@@ -15,9 +15,9 @@ public:
             SkPathHeap(SkFlattenableReadBuffer&);
     virtual ~SkPathHeap();
 
-    /** Copy the path into the heap, and return the new total number of paths.
-        Thus, the returned value will be index+1, where index is the index of
-        this newly added (copied) path.
+    /** Copy the path into the heap, and return index+1, where index is the
+        index of the newly added (copied) path. If an identical path is
+        already in the heap, return its index+1 instead, without copying.
      */
     int append(const SkPath&);
     
@@ -34,6 +34,16 @@ private:
     SkChunkAlloc        fHeap;
     // we just store ptrs into fHeap here
     SkTDArray<SkPath*>  fPaths;
+
+    // An open-addressed hash table of index+1 into fPaths (0 for empty), so
+    // that append() can find an identical path. fHashes holds the hash of
+    // each path.
+    SkTDArray<uint32_t> fHashes;
+    int*                fSlots;
+    int                 fSlotCount; // 0, or a power of 2
+
+    void addToSlots(int index);
+    void growSlots();
 };
 
 #endif
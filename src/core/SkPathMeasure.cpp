@@ -159,8 +159,8 @@ void SkPathMeasure::buildSegments() {
     bool            isClosed = fForceClosed;
     bool            firstMoveTo = ptIndex < 0;
     Segment*        seg;
+    const int       segmentStart = fSegments.count();
 
-    fSegments.reset();
     for (;;) {
         switch (fIter.next(pts)) {
             case SkPath::kMove_Verb:
@@ -203,17 +203,21 @@ void SkPathMeasure::buildSegments() {
                 break;
                 
             case SkPath::kDone_Verb:
+                fIterDone = true;
                 goto DONE;
         }
     }
 DONE:
-    fLength = distance;
-    fIsClosed = isClosed;
+    Contour* contour = fContours.append();
+    contour->fSegmentStart = segmentStart;
+    contour->fSegmentCount = fSegments.count() - segmentStart;
+    contour->fLength = distance;
+    contour->fIsClosed = isClosed;
     fFirstPtIndex = ptIndex + 1;
 
 #ifdef SK_DEBUG
     {
-        const Segment* seg = fSegments.begin();
+        const Segment* seg = fSegments.begin() + segmentStart;
         const Segment* stop = fSegments.end();
         unsigned        ptIndex = 0;
         SkScalar        distance = 0;
@@ -358,34 +362,70 @@ static void seg_to(const SkPath& src, int firstPtIndex, int ptIndex,
 
 SkPathMeasure::SkPathMeasure() {
     fPath = NULL;
-    fLength = -1;   // signal we need to compute it
     fForceClosed = false;
-    fFirstPtIndex = -1;
+    this->reset();
 }
 
 SkPathMeasure::SkPathMeasure(const SkPath& path, bool forceClosed) {
     fPath = &path;
-    fLength = -1;   // signal we need to compute it
     fForceClosed = forceClosed;
-    fFirstPtIndex = -1;
-
-    fIter.setPath(path, forceClosed);
+    this->reset();
 }
 
 SkPathMeasure::~SkPathMeasure() {}
 
+void SkPathMeasure::reset() {
+    fGenerationID = 0;
+    fFirstPtIndex = -1;
+    fIterDone = false;
+    fSegments.reset();
+    fContours.reset();
+    if (fPath) {
+        fIter.setPath(*fPath, fForceClosed);
+        fGenerationID = fPath->getGenerationID();
+    }
+    this->rewind();
+}
+
 /** Assign a new path, or null to have none.
 */
 void SkPathMeasure::setPath(const SkPath* path, bool forceClosed) {
+    if (path && fIterDone && forceClosed == fForceClosed &&
+            path->getGenerationID() == fGenerationID) {
+        // the same points and verbs as we measured, so the segments (which
+        // only refer to points by index) are still good
+        fPath = path;
+        this->rewind();
+        return;
+    }
+
     fPath = path;
-    fLength = -1;   // signal we need to compute it
     fForceClosed = forceClosed;
-    fFirstPtIndex = -1;
+    this->reset();
+}
 
-    if (path) {
-        fIter.setPath(*path, forceClosed);
+void SkPathMeasure::rewind() {
+    fContourIndex = 0;
+    fLength = -1;   // signal we need to compute it
+}
+
+void SkPathMeasure::selectContour() {
+    while (fContourIndex >= fContours.count() && !fIterDone) {
+        this->buildSegments();
+    }
+    if (fContourIndex < fContours.count()) {
+        const Contour& contour = fContours[fContourIndex];
+        fSegmentStart = contour.fSegmentStart;
+        fSegmentCount = contour.fSegmentCount;
+        fLength = contour.fLength;
+        fIsClosed = contour.fIsClosed;
+    } else {
+        // past the last contour
+        fSegmentStart = fSegments.count();
+        fSegmentCount = 0;
+        fLength = 0;
+        fIsClosed = fForceClosed;
     }
-    fSegments.reset();
 }
 
 SkScalar SkPathMeasure::getLength() {
@@ -393,24 +433,46 @@ SkScalar SkPathMeasure::getLength() {
         return 0;
     }
     if (fLength < 0) {
-        this->buildSegments();
+        this->selectContour();
     }
     SkASSERT(fLength >= 0);
     return fLength;
 }
 
+// how far a hint is walked forward before giving up and searching
+#define kMaxHintWalk    8
+
 const SkPathMeasure::Segment* SkPathMeasure::distanceToSegment(
-                                            SkScalar distance, SkScalar* t) {
+                                SkScalar distance, SkScalar* t, int* hint) {
     SkDEBUGCODE(SkScalar length = ) this->getLength();
     SkASSERT(distance >= 0 && distance <= length);
 
-    const Segment*  seg = fSegments.begin();
-    int             count = fSegments.count();
-
-    int index = SkTSearch<SkScalar>(&seg->fDistance, count, distance,
+    const Segment*  seg = fSegments.begin() + fSegmentStart;
+    int             count = fSegmentCount;
+
+    // find the first segment that ends at or after distance, starting at the
+    // hint if that's at or before it
+    int index = -1;
+    if (hint && (unsigned)*hint < (unsigned)count &&
+            (0 == *hint || seg[*hint - 1].fDistance < distance)) {
+        int i = *hint;
+        const int stop = SkMin32(i + kMaxHintWalk, count);
+        while (i < stop && seg[i].fDistance < distance) {
+            i += 1;
+        }
+        if (i < stop) {
+            index = i;
+        }
+    }
+    if (index < 0) {
+        index = SkTSearch<SkScalar>(&seg->fDistance, count, distance,
                                     sizeof(Segment));
-    // don't care if we hit an exact match or not, so we xor index if it is negative
-    index ^= (index >> 31);
+        // don't care if we hit an exact match or not, so we xor index if it is negative
+        index ^= (index >> 31);
+    }
+    if (hint) {
+        *hint = index;
+    }
     seg = &seg[index];
 
     // now interpolate t-values with the prev segment (if possible)
@@ -436,31 +498,39 @@ const SkPathMeasure::Segment* SkPathMeasure::distanceToSegment(
 
 bool SkPathMeasure::getPosTan(SkScalar distance, SkPoint* pos,
                               SkVector* tangent) {
+    return this->getPosTans(&distance, 1, pos, tangent);
+}
+
+bool SkPathMeasure::getPosTans(const SkScalar distances[], int count,
+                               SkPoint pos[], SkVector tangents[]) {
     SkASSERT(fPath);
     if (fPath == NULL) {
-    EMPTY:
         return false;
     }
 
     SkScalar    length = this->getLength(); // call this to force computing it
-    int         count = fSegments.count();
-
-    if (count == 0 || length == 0) {
-        goto EMPTY;
+    if (fSegmentCount == 0 || length == 0) {
+        return false;
     }
 
-    // pin the distance to a legal range
-    if (distance < 0) {
-        distance = 0;
-    } else if (distance > length) {
-        distance = length;
-    }
-    
-    SkScalar        t;
-    const Segment*  seg = this->distanceToSegment(distance, &t);
+    const int firstPtIndex = fSegments[fSegmentStart].fPtIndex;
+    int hint = 0;
+    for (int i = 0; i < count; i++) {
+        // pin the distance to a legal range
+        SkScalar distance = distances[i];
+        if (distance < 0) {
+            distance = 0;
+        } else if (distance > length) {
+            distance = length;
+        }
 
-    compute_pos_tan(*fPath, fSegments[0].fPtIndex, seg->fPtIndex, seg->fType,
-                    t, pos, tangent);
+        SkScalar        t;
+        const Segment*  seg = this->distanceToSegment(distance, &t, &hint);
+
+        compute_pos_tan(*fPath, firstPtIndex, seg->fPtIndex, seg->fType, t,
+                        pos ? &pos[i] : NULL,
+                        tangents ? &tangents[i] : NULL);
+    }
     return true;
 }
 
@@ -503,27 +573,29 @@ bool SkPathMeasure::getSegment(SkScalar startD, SkScalar stopD, SkPath* dst,
 
     SkPoint  p;
     SkScalar startT, stopT;
-    const Segment* seg = this->distanceToSegment(startD, &startT);
-    const Segment* stopSeg = this->distanceToSegment(stopD, &stopT);
+    int      hint = 0;
+    const Segment* seg = this->distanceToSegment(startD, &startT, &hint);
+    const Segment* stopSeg = this->distanceToSegment(stopD, &stopT, &hint);
     SkASSERT(seg <= stopSeg);
+    const int firstPtIndex = fSegments[fSegmentStart].fPtIndex;
 
     if (startWithMoveTo) {
-        compute_pos_tan(*fPath, fSegments[0].fPtIndex, seg->fPtIndex,
+        compute_pos_tan(*fPath, firstPtIndex, seg->fPtIndex,
                         seg->fType, startT, &p, NULL);
         dst->moveTo(p);
     }
 
     if (seg->fPtIndex == stopSeg->fPtIndex) {
-        seg_to(*fPath, fSegments[0].fPtIndex, seg->fPtIndex, seg->fType,
+        seg_to(*fPath, firstPtIndex, seg->fPtIndex, seg->fType,
                startT, stopT, dst);
     } else {
         do {
-            seg_to(*fPath, fSegments[0].fPtIndex, seg->fPtIndex, seg->fType,
+            seg_to(*fPath, firstPtIndex, seg->fPtIndex, seg->fType,
                    startT, SK_Scalar1, dst);
             seg = SkPathMeasure::NextSegment(seg);
             startT = 0;
         } while (seg->fPtIndex < stopSeg->fPtIndex);
-        seg_to(*fPath, fSegments[0].fPtIndex, seg->fPtIndex, seg->fType,
+        seg_to(*fPath, firstPtIndex, seg->fPtIndex, seg->fType,
                0, stopT, dst);
     }
     return true;
@@ -538,20 +610,53 @@ bool SkPathMeasure::isClosed() {
     we're done with the path.
 */
 bool SkPathMeasure::nextContour() {
+    fContourIndex += 1;
     fLength = -1;
     return this->getLength() > 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+SkPathMeasureCache::SkPathMeasureCache() : fMeasure(NULL) {}
+
+SkPathMeasureCache::~SkPathMeasureCache() {
+    SkDELETE(fMeasure);
+}
+
+SkAutoCachedPathMeasure::SkAutoCachedPathMeasure(SkPathMeasureCache* cache,
+                                                 const SkPath& path,
+                                                 bool forceClosed)
+        : fCache(cache) {
+    {
+        SkAutoMutexAcquire  ac(cache->fMutex);
+        fMeasure = cache->fMeasure;
+        cache->fMeasure = NULL;
+    }
+    if (NULL == fMeasure) {
+        fMeasure = SkNEW(SkPathMeasure);
+    }
+    fMeasure->setPath(&path, forceClosed);
+}
+
+SkAutoCachedPathMeasure::~SkAutoCachedPathMeasure() {
+    SkAutoMutexAcquire  ac(fCache->fMutex);
+    if (NULL == fCache->fMeasure) {
+        fCache->fMeasure = fMeasure;
+    } else {
+        SkDELETE(fMeasure);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef SK_DEBUG
 
 void SkPathMeasure::dump() {
-    SkDebugf("pathmeas: length=%g, segs=%d\n", fLength, fSegments.count());
+    SkDebugf("pathmeas: length=%g, segs=%d\n", fLength, fSegmentCount);
 
-    for (int i = 0; i < fSegments.count(); i++) {
-        const Segment* seg = &fSegments[i];
+    for (int i = 0; i < fSegmentCount; i++) {
+        const Segment* seg = &fSegments[fSegmentStart + i];
         SkDebugf("pathmeas: seg[%d] distance=%g, point=%d, t=%g, type=%d\n",
                 i, seg->fDistance, seg->fPtIndex, seg->getScalarT(),
                  seg->fType);
@@ -178,7 +178,8 @@ SkCanvas* SkPicture::getRecordingCanvas() const {
 void SkPicture::endRecording() {
     if (NULL == fPlayback) {
         if (NULL != fRecord) {
-            fPlayback = SkNEW_ARGS(SkPicturePlayback, (*fRecord));
+            fRecord->endRecording();
+            fPlayback = SkNEW_ARGS(SkPicturePlayback, (fRecord));
             fRecord->unref();
             fRecord = NULL;
         }
@@ -193,6 +194,18 @@ void SkPicture::draw(SkCanvas* surface) {
     }
 }
 
+bool SkPicture::canDrawConcurrently() {
+    this->endRecording();
+    return NULL == fPlayback || fPlayback->canDrawConcurrently();
+}
+
+void SkPicture::profile(SkCanvas* surface, SkPictureProfile* profile) {
+    this->endRecording();
+    if (fPlayback) {
+        fPlayback->draw(*surface, profile);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkStream.h"
@@ -237,6 +250,64 @@ void SkPicture::serialize(SkWStream* stream) const {
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SkData.h"
+
+#define PICTURE_MAPPABLE_TAG        SkSetFourByteTag('s', 'k', 'p', 'm')
+#define PICTURE_MAPPABLE_VERSION    1
+
+// the header is the tag, version, width, height and size of the playback
+#define PICTURE_MAPPABLE_HEADER_SIZE    (5 * sizeof(uint32_t))
+
+SkPicture::SkPicture(SkData* data) : SkRefCnt() {
+    const uint32_t* header = (const uint32_t*)data->data();
+    if (data->size() < PICTURE_MAPPABLE_HEADER_SIZE ||
+            header[0] != PICTURE_MAPPABLE_TAG ||
+            header[1] != PICTURE_MAPPABLE_VERSION) {
+        sk_throw();
+    }
+
+    fWidth = header[2];
+    fHeight = header[3];
+
+    fRecord = NULL;
+    fPlayback = NULL;
+
+    if (header[4]) {
+        fPlayback = SkNEW_ARGS(SkPicturePlayback,
+                               (data, PICTURE_MAPPABLE_HEADER_SIZE, header[4]));
+    }
+}
+
+void SkPicture::serializeMappable(SkWStream* stream) const {
+    SkPicturePlayback* playback = fPlayback;
+
+    if (NULL == playback && fRecord) {
+        playback = SkNEW_ARGS(SkPicturePlayback, (*fRecord));
+    }
+
+    // the playback has to be written first, to find its size
+    SkDynamicMemoryWStream playbackStream;
+    if (playback) {
+        playback->serializeMappable(&playbackStream);
+        if (playback != fPlayback) {
+            SkDELETE(playback);
+        }
+    }
+
+    stream->write32(PICTURE_MAPPABLE_TAG);
+    stream->write32(PICTURE_MAPPABLE_VERSION);
+    stream->write32(fWidth);
+    stream->write32(fHeight);
+    stream->write32(playbackStream.getOffset());
+    if (playbackStream.getOffset()) {
+        SkAutoMalloc storage(playbackStream.getOffset());
+        playbackStream.copyTo(storage.get());
+        stream->write(storage.get(), playbackStream.getOffset());
+    }
+}
+
 void SkPicture::abortPlayback() {
     if (NULL == fPlayback) {
         return;
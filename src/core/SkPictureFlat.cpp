@@ -11,10 +11,79 @@
 SkFlatData* SkFlatData::Alloc(SkChunkAlloc* heap, int32_t size, int index) {
     SkFlatData* result = (SkFlatData*) heap->allocThrow(size + sizeof(SkFlatData));
     result->fIndex = index;
+    result->fHash = 0;
     result->fAllocSize = size + sizeof(result->fAllocSize);
     return result;
 }
 
+void SkFlatData::computeHash() {
+    // FNV-1a, a word at a time
+    const uint32_t* data = (const uint32_t*)&fAllocSize;
+    const uint32_t* stop = data + (fAllocSize >> 2);
+    uint32_t hash = 2166136261U;
+    while (data < stop) {
+        hash = (hash ^ *data++) * 16777619U;
+    }
+    const uint8_t* tail = (const uint8_t*)stop;
+    for (int i = 0; i < (fAllocSize & 3); i++) {
+        hash = (hash ^ tail[i]) * 16777619U;
+    }
+    fHash = hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define FLAT_DICTIONARY_MIN_CAPACITY    64
+
+SkFlatDictionary::SkFlatDictionary() : fSlots(NULL), fCapacity(0), fCount(0) {}
+
+SkFlatDictionary::~SkFlatDictionary() {
+    sk_free(fSlots);
+}
+
+void SkFlatDictionary::reset() {
+    sk_free(fSlots);
+    fSlots = NULL;
+    fCapacity = fCount = 0;
+}
+
+void SkFlatDictionary::grow() {
+    const SkFlatData** oldSlots = fSlots;
+    int oldCapacity = fCapacity;
+
+    fCapacity = oldCapacity ? oldCapacity << 1 : FLAT_DICTIONARY_MIN_CAPACITY;
+    fSlots = (const SkFlatData**)sk_malloc_throw(fCapacity * sizeof(fSlots[0]));
+    sk_bzero(fSlots, fCapacity * sizeof(fSlots[0]));
+    for (int i = 0; i < oldCapacity; i++) {
+        const SkFlatData* flat = oldSlots[i];
+        if (flat) {
+            int slot = flat->hash() & (fCapacity - 1);
+            while (fSlots[slot]) {
+                slot = (slot + 1) & (fCapacity - 1);
+            }
+            fSlots[slot] = flat;
+        }
+    }
+    sk_free(oldSlots);
+}
+
+const SkFlatData* SkFlatDictionary::findOrAdd(const SkFlatData* flat) {
+    // keep at least a quarter of the slots empty, so that probes stay short
+    if ((fCount + 1) * 4 > fCapacity * 3) {
+        this->grow();
+    }
+    int slot = flat->hash() & (fCapacity - 1);
+    while (fSlots[slot]) {
+        if (SkFlatData::Equal(fSlots[slot], flat)) {
+            return fSlots[slot];
+        }
+        slot = (slot + 1) & (fCapacity - 1);
+    }
+    fSlots[slot] = flat;
+    fCount += 1;
+    return flat;
+}
+
 SkFlatBitmap* SkFlatBitmap::Flatten(SkChunkAlloc* heap, const SkBitmap& bitmap,
                                     int index, SkRefCntSet* rec) {
     SkFlattenableWriteBuffer buffer(1024);
@@ -24,6 +93,7 @@ SkFlatBitmap* SkFlatBitmap::Flatten(SkChunkAlloc* heap, const SkBitmap& bitmap,
     size_t size = buffer.size();
     SkFlatBitmap* result = (SkFlatBitmap*) INHERITED::Alloc(heap, size, index);
     buffer.flatten(result->fBitmapData);
+    result->computeHash();
     return result;
 }
 
@@ -31,6 +101,7 @@ SkFlatMatrix* SkFlatMatrix::Flatten(SkChunkAlloc* heap, const SkMatrix& matrix,
     size_t size = matrix.flatten(NULL);
     SkFlatMatrix* result = (SkFlatMatrix*) INHERITED::Alloc(heap, size, index);
     matrix.flatten(&result->fMatrixData);
+    result->computeHash();
     return result;
 }
 
@@ -92,6 +163,7 @@ SkFlatPaint* SkFlatPaint::Flatten(SkChunkAlloc* heap, const SkPaint& paint,
     uint32_t size = buffer.size();
     SkFlatPaint* result = (SkFlatPaint*) INHERITED::Alloc(heap, size, index);
     buffer.flatten(&result->fPaintData);
+    result->computeHash();
     return result;
 }
     
@@ -210,6 +282,7 @@ SkFlatRegion* SkFlatRegion::Flatten(SkChunkAlloc* heap, const SkRegion& region,
     uint32_t size = region.flatten(NULL);
     SkFlatRegion* result = (SkFlatRegion*) INHERITED::Alloc(heap, size, index);
     region.flatten(&result->fRegionData);
+    result->computeHash();
     return result;
 }
     
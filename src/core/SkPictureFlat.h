@@ -43,6 +43,11 @@ enum DrawType {
     TRANSLATE
 };
 
+// or'd with the op of a CLIP_PATH
+enum ClipPathFlags {
+    CLIP_PATH_DO_ANTI_ALIAS = 0x10
+};
+
 enum DrawVertexFlags {
     DRAW_VERTICES_HAS_TEXS    = 0x01,
     DRAW_VERTICES_HAS_COLORS  = 0x02,
@@ -103,8 +108,12 @@ public:
     static int Compare(const SkFlatData* a, const SkFlatData* b) {
         return memcmp(&a->fAllocSize, &b->fAllocSize, a->fAllocSize);
     }
+    static bool Equal(const SkFlatData* a, const SkFlatData* b) {
+        return a->fHash == b->fHash && 0 == Compare(a, b);
+    }
     
     int index() const { return fIndex; }
+    uint32_t hash() const { return fHash; }
     
 #ifdef SK_DEBUG_SIZE
     size_t size() const { return sizeof(fIndex) + fAllocSize; }
@@ -112,11 +121,39 @@ public:
 
 protected:
     static SkFlatData* Alloc(SkChunkAlloc* heap, int32_t size, int index);
+    // must be called once the flattened data has been written
+    void computeHash();
     
     int fIndex;
+    uint32_t fHash;     // of fAllocSize and the data that follows it
     int32_t fAllocSize;
 };
 
+/** \class SkFlatDictionary
+
+    A hash table of flattened objects, so that a recording can find out if it
+    has already flattened an identical one without comparing it against all
+    of the others. It does not own the entries.
+*/
+class SkFlatDictionary {
+public:
+    SkFlatDictionary();
+    ~SkFlatDictionary();
+
+    /** Return the entry that is equal to flat, or add flat and return it. */
+    const SkFlatData* findOrAdd(const SkFlatData* flat);
+
+    int count() const { return fCount; }
+    void reset();
+
+private:
+    const SkFlatData**  fSlots;
+    int                 fCapacity;  // 0, or a power of 2
+    int                 fCount;
+
+    void grow();
+};
+
 class SkFlatBitmap : public SkFlatData {
 public:
     static SkFlatBitmap* Flatten(SkChunkAlloc*, const SkBitmap&, int index,
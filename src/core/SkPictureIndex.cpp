@@ -0,0 +1,105 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkPictureIndex.h"
+#include "SkTemplates.h"
+
+// target size (in pixels) of each cell, and maximum cells along either axis
+#define CELL_SIZE       128
+#define MAX_CELL_COUNT  64
+
+static int compute_cell_count(int size) {
+    int count = (size + CELL_SIZE - 1) / CELL_SIZE;
+    return SkPin32(count, 1, MAX_CELL_COUNT);
+}
+
+SkPictureIndex::SkPictureIndex(const SkTDArray<Op>& ops, int width,
+                               int height) {
+    fOps.setCount(ops.count());
+    memcpy(fOps.begin(), ops.begin(), ops.count() * sizeof(Op));
+
+    width = SkMax32(width, 1);
+    height = SkMax32(height, 1);
+    fCols = compute_cell_count(width);
+    fRows = compute_cell_count(height);
+    fCellWidth = (width + fCols - 1) / fCols;
+    fCellHeight = (height + fRows - 1) / fRows;
+
+    const int cellCount = fCols * fRows;
+    fCellStarts.setCount(cellCount + 1);
+    sk_bzero(fCellStarts.begin(), fCellStarts.count() * sizeof(int32_t));
+
+    int l, t, r, b;
+    // first pass: count the ops that land in each cell
+    for (int i = 0; i < fOps.count(); i++) {
+        this->cellRange(fOps[i].fBounds, &l, &t, &r, &b);
+        for (int y = t; y <= b; y++) {
+            for (int x = l; x <= r; x++) {
+                fCellStarts[y * fCols + x + 1] += 1;
+            }
+        }
+    }
+    for (int i = 0; i < cellCount; i++) {
+        fCellStarts[i + 1] += fCellStarts[i];
+    }
+
+    // second pass: fill in the op indices, using a cursor per cell
+    fCellOps.setCount(fCellStarts[cellCount]);
+    SkAutoTMalloc<int32_t> cursor(cellCount);
+    memcpy(cursor.get(), fCellStarts.begin(), cellCount * sizeof(int32_t));
+    for (int i = 0; i < fOps.count(); i++) {
+        this->cellRange(fOps[i].fBounds, &l, &t, &r, &b);
+        for (int y = t; y <= b; y++) {
+            for (int x = l; x <= r; x++) {
+                fCellOps[cursor.get()[y * fCols + x]++] = i;
+            }
+        }
+    }
+}
+
+SkPictureIndex::~SkPictureIndex() {}
+
+void SkPictureIndex::cellRange(const SkIRect& bounds, int* left, int* top,
+                               int* right, int* bottom) const {
+    // divide before pinning so that huge coordinates cannot overflow
+    *left = SkPin32(bounds.fLeft / fCellWidth, 0, fCols - 1);
+    *right = SkPin32((bounds.fRight - 1) / fCellWidth, 0, fCols - 1);
+    *top = SkPin32(bounds.fTop / fCellHeight, 0, fRows - 1);
+    *bottom = SkPin32((bounds.fBottom - 1) / fCellHeight, 0, fRows - 1);
+}
+
+void SkPictureIndex::search(const SkIRect& query, bool visible[]) const {
+    if (query.isEmpty()) {
+        return;
+    }
+
+    int l, t, r, b;
+    this->cellRange(query, &l, &t, &r, &b);
+    for (int y = t; y <= b; y++) {
+        for (int x = l; x <= r; x++) {
+            const int cell = y * fCols + x;
+            const int32_t* iter = fCellOps.begin() + fCellStarts[cell];
+            const int32_t* stop = fCellOps.begin() + fCellStarts[cell + 1];
+            for (; iter < stop; iter++) {
+                int32_t index = *iter;
+                if (!visible[index] &&
+                        SkIRect::Intersects(fOps[index].fBounds, query)) {
+                    visible[index] = true;
+                }
+            }
+        }
+    }
+}
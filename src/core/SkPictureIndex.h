@@ -0,0 +1,70 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkPictureIndex_DEFINED
+#define SkPictureIndex_DEFINED
+
+#include "SkRect.h"
+#include "SkRefCnt.h"
+#include "SkTDArray.h"
+
+/** \class SkPictureIndex
+
+    A uniform grid over the recorded draw ops of a picture. Each entry
+    describes one draw op in the op stream (its offset and size in bytes) and
+    its conservative bounds in the picture's coordinate space. Ops with
+    unknown bounds are simply not entered, and are always played back.
+
+    The index is immutable once built, so it can be shared between copies of
+    a playback (and between threads).
+*/
+class SkPictureIndex : public SkRefCnt {
+public:
+    struct Op {
+        uint32_t    fOffset;    // offset of the op in the stream
+        uint32_t    fSize;      // bytes to skip to reach the next op
+        SkIRect     fBounds;    // conservative bounds in picture coordinates
+    };
+
+    /** Build the grid for the specified ops, which must be sorted by offset.
+        The grid covers [0, width) x [0, height); ops that extend (or lie)
+        outside of that area are put into the nearest edge cells.
+     */
+    SkPictureIndex(const SkTDArray<Op>& ops, int width, int height);
+    virtual ~SkPictureIndex();
+
+    int count() const { return fOps.count(); }
+    const Op& operator[](int index) const { return fOps[index]; }
+
+    /** For every op whose bounds intersect query, set visible[index] to true.
+        Entries for the other ops are left unchanged, so the caller must clear
+        the array (count() entries) beforehand.
+     */
+    void search(const SkIRect& query, bool visible[]) const;
+
+private:
+    SkTDArray<Op>       fOps;
+    // fCellStarts[i]..fCellStarts[i+1] is the range in fCellOps for cell i
+    SkTDArray<int32_t>  fCellStarts;
+    SkTDArray<int32_t>  fCellOps;
+    int                 fCellWidth, fCellHeight;
+    int                 fCols, fRows;
+
+    void cellRange(const SkIRect& bounds, int* left, int* top,
+                   int* right, int* bottom) const;
+};
+
+#endif
@@ -0,0 +1,248 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkPictureMapping.h"
+#include "SkData.h"
+#include "SkStream.h"
+#include "SkTypeface.h"
+
+// The data may come straight from a file, so every size is checked before it
+// is used, and a bad one is treated like a bad tag.
+
+static const void* skip_checked(SkReader32* reader, size_t size) {
+    if (size > reader->available() || SkAlign4(size) > reader->available()) {
+        sk_throw();
+    }
+    return reader->skip(size);
+}
+
+static uint32_t read_checked(SkReader32* reader) {
+    if (reader->available() < sizeof(uint32_t)) {
+        sk_throw();
+    }
+    return reader->readU32();
+}
+
+static uint32_t read_tag_count(SkReader32* reader, uint32_t expectedTag) {
+    if (read_checked(reader) != expectedTag) {
+        sk_throw();
+    }
+    return read_checked(reader);
+}
+
+static void read_table(SkReader32* reader, uint32_t tag, int* count,
+                       const uint32_t** offsets, const char** entries,
+                       void*** decoded) {
+    uint32_t n = read_tag_count(reader, tag);
+    if (n >= reader->available() / sizeof(uint32_t)) {
+        sk_throw();
+    }
+    const uint32_t* offs = (const uint32_t*)skip_checked(reader,
+                                                (n + 1) * sizeof(uint32_t));
+    // the entries are in order, and each one starts 4-byte aligned
+    for (uint32_t i = 0; i < n; i++) {
+        if (offs[i] > offs[i + 1] || SkAlign4(offs[i]) != offs[i]) {
+            sk_throw();
+        }
+    }
+    if (offs[0] != 0) {
+        sk_throw();
+    }
+    *entries = (const char*)skip_checked(reader, offs[n]);
+    *offsets = offs;
+    *count = n;
+    *decoded = NULL;
+    if (n) {
+        *decoded = (void**)sk_malloc_throw(n * sizeof(void*));
+        sk_bzero(*decoded, n * sizeof(void*));
+    }
+}
+
+SkPictureMapping::SkPictureMapping(SkData* data, size_t offset, size_t size) {
+    fData = data;
+    fData->ref();
+    fMatrices = NULL;
+    fMatrixCount = 0;
+    fPictureRefs = NULL;
+    fPictureCount = 0;
+    fFactoryPlayback = NULL;
+    memset(&fBitmaps, 0, sizeof(fBitmaps));
+    memset(&fPaints, 0, sizeof(fPaints));
+    memset(&fPaths, 0, sizeof(fPaths));
+    memset(&fRegions, 0, sizeof(fRegions));
+
+    const uint8_t* base = data->bytes() + offset;
+    if (offset > data->size() || size > data->size() - offset ||
+            SkAlign4(size) != size || ((uintptr_t)base & 3)) {
+        sk_throw();
+    }
+    SkReader32 reader(base, size);
+
+    fOpsSize = read_tag_count(&reader, PICT_MAPPED_READER_TAG);
+    fOps = skip_checked(&reader, fOpsSize);
+    if (SkAlign4(fOpsSize) != fOpsSize) {
+        sk_throw();
+    }
+
+    int i;
+    int factoryCount = read_tag_count(&reader, PICT_MAPPED_FACTORY_TAG);
+    if (factoryCount < 0 || (uint32_t)factoryCount > reader.available()) {
+        sk_throw();
+    }
+    fFactoryPlayback = SkNEW_ARGS(SkFactoryPlayback, (factoryCount));
+    for (i = 0; i < factoryCount; i++) {
+        size_t len = read_checked(&reader);
+        SkString name((const char*)skip_checked(&reader, len), len);
+        fFactoryPlayback->base()[i] = SkFlattenable::NameToFactory(name.c_str());
+    }
+
+    int typefaceCount = read_tag_count(&reader, PICT_MAPPED_TYPEFACE_TAG);
+    size_t typefaceSize = read_checked(&reader);
+    if (typefaceCount < 0 || (uint32_t)typefaceCount > typefaceSize) {
+        sk_throw();
+    }
+    {
+        SkMemoryStream stream(skip_checked(&reader, typefaceSize),
+                              typefaceSize);
+        fTFPlayback.setCount(typefaceCount);
+        for (i = 0; i < typefaceCount; i++) {
+            fTFPlayback.set(i, SkTypeface::Deserialize(&stream))->unref();
+        }
+    }
+
+    fPictureCount = read_tag_count(&reader, PICT_MAPPED_PICTURE_TAG);
+    if (fPictureCount < 0 ||
+            (uint32_t)fPictureCount > reader.available() / sizeof(uint32_t)) {
+        sk_throw();
+    }
+    fPictureRefs = SkNEW_ARRAY(SkPicture*, fPictureCount);
+    for (i = 0; i < fPictureCount; i++) {
+        fPictureRefs[i] = NULL;
+    }
+    for (i = 0; i < fPictureCount; i++) {
+        size_t pictureSize = read_checked(&reader);
+        const uint8_t* picture = (const uint8_t*)skip_checked(&reader,
+                                                              pictureSize);
+        SkData* subset = SkData::NewSubset(fData, picture - data->bytes(),
+                                           pictureSize);
+        fPictureRefs[i] = SkNEW_ARGS(SkPicture, (subset));
+        subset->unref();
+    }
+
+    fMatrixCount = read_tag_count(&reader, PICT_MAPPED_MATRIX_TAG);
+    if (fMatrixCount < 0 ||
+            (uint32_t)fMatrixCount > reader.available() / sizeof(SkMatrix)) {
+        sk_throw();
+    }
+    // copied, since SkMatrix caches its type in place
+    fMatrices = SkNEW_ARRAY(SkMatrix, fMatrixCount);
+    memcpy(fMatrices, skip_checked(&reader, fMatrixCount * sizeof(SkMatrix)),
+           fMatrixCount * sizeof(SkMatrix));
+
+    read_table(&reader, PICT_MAPPED_BITMAP_TAG, &fBitmaps.fCount,
+               &fBitmaps.fOffsets, &fBitmaps.fEntries, &fBitmaps.fDecoded);
+    read_table(&reader, PICT_MAPPED_PAINT_TAG, &fPaints.fCount,
+               &fPaints.fOffsets, &fPaints.fEntries, &fPaints.fDecoded);
+    read_table(&reader, PICT_MAPPED_PATH_TAG, &fPaths.fCount,
+               &fPaths.fOffsets, &fPaths.fEntries, &fPaths.fDecoded);
+    read_table(&reader, PICT_MAPPED_REGION_TAG, &fRegions.fCount,
+               &fRegions.fOffsets, &fRegions.fEntries, &fRegions.fDecoded);
+}
+
+template <typename T> static void delete_decoded(int count, void** decoded) {
+    for (int i = 0; i < count; i++) {
+        SkDELETE((T*)decoded[i]);
+    }
+    sk_free(decoded);
+}
+
+SkPictureMapping::~SkPictureMapping() {
+    delete_decoded<SkBitmap>(fBitmaps.fCount, fBitmaps.fDecoded);
+    delete_decoded<SkPaint>(fPaints.fCount, fPaints.fDecoded);
+    delete_decoded<SkPath>(fPaths.fCount, fPaths.fDecoded);
+    delete_decoded<SkRegion>(fRegions.fCount, fRegions.fDecoded);
+
+    if (fPictureRefs) {
+        for (int i = 0; i < fPictureCount; i++) {
+            SkSafeUnref(fPictureRefs[i]);
+        }
+    }
+    SkDELETE_ARRAY(fPictureRefs);
+    SkDELETE_ARRAY(fMatrices);
+    SkDELETE(fFactoryPlayback);
+    fData->unref();
+}
+
+void SkPictureMapping::setupBuffer(SkFlattenableReadBuffer& buffer) const {
+    fFactoryPlayback->setupBuffer(buffer);
+    fTFPlayback.setupBuffer(buffer);
+}
+
+const SkBitmap& SkPictureMapping::bitmap(int index) {
+    SkASSERT((unsigned)index < (unsigned)fBitmaps.fCount);
+    SkAutoMutexAcquire ac(fMutex);
+    SkBitmap* bitmap = (SkBitmap*)fBitmaps.fDecoded[index];
+    if (NULL == bitmap) {
+        SkFlattenableReadBuffer buffer(fBitmaps.entry(index),
+                                       fBitmaps.entrySize(index));
+        this->setupBuffer(buffer);
+        bitmap = SkNEW(SkBitmap);
+        bitmap->unflatten(buffer);
+        fBitmaps.fDecoded[index] = bitmap;
+    }
+    return *bitmap;
+}
+
+const SkPaint& SkPictureMapping::paint(int index) {
+    SkASSERT((unsigned)index < (unsigned)fPaints.fCount);
+    SkAutoMutexAcquire ac(fMutex);
+    SkPaint* paint = (SkPaint*)fPaints.fDecoded[index];
+    if (NULL == paint) {
+        SkFlattenableReadBuffer buffer(fPaints.entry(index),
+                                       fPaints.entrySize(index));
+        this->setupBuffer(buffer);
+        paint = SkNEW(SkPaint);
+        paint->unflatten(buffer);
+        fPaints.fDecoded[index] = paint;
+    }
+    return *paint;
+}
+
+const SkPath& SkPictureMapping::path(int index) {
+    SkASSERT((unsigned)index < (unsigned)fPaths.fCount);
+    SkAutoMutexAcquire ac(fMutex);
+    SkPath* path = (SkPath*)fPaths.fDecoded[index];
+    if (NULL == path) {
+        SkReader32 reader(fPaths.entry(index), fPaths.entrySize(index));
+        path = SkNEW(SkPath);
+        path->unflatten(reader);
+        fPaths.fDecoded[index] = path;
+    }
+    return *path;
+}
+
+const SkRegion& SkPictureMapping::region(int index) {
+    SkASSERT((unsigned)index < (unsigned)fRegions.fCount);
+    SkAutoMutexAcquire ac(fMutex);
+    SkRegion* region = (SkRegion*)fRegions.fDecoded[index];
+    if (NULL == region) {
+        region = SkNEW(SkRegion);
+        SkDEBUGCODE(uint32_t bytes =) region->unflatten(fRegions.entry(index));
+        SkASSERT(bytes <= fRegions.entrySize(index));
+        fRegions.fDecoded[index] = region;
+    }
+    return *region;
+}
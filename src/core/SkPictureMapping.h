@@ -0,0 +1,117 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkPictureMapping_DEFINED
+#define SkPictureMapping_DEFINED
+
+#include "SkPictureFlat.h"
+#include "SkThread.h"
+
+class SkData;
+
+// The chunks of a mappable playback, in the order they are written. Each one
+// starts with its tag and a count, and everything is 4-byte aligned.
+#define PICT_MAPPED_READER_TAG      SkSetFourByteTag('r', 'e', 'a', 'd')
+#define PICT_MAPPED_FACTORY_TAG     SkSetFourByteTag('f', 'a', 'c', 't')
+#define PICT_MAPPED_TYPEFACE_TAG    SkSetFourByteTag('t', 'p', 'f', 'c')
+#define PICT_MAPPED_PICTURE_TAG     SkSetFourByteTag('p', 'c', 't', 'r')
+#define PICT_MAPPED_MATRIX_TAG      SkSetFourByteTag('m', 't', 'r', 'x')
+// these are tables: count + 1 offsets, from the end of the offsets, followed
+// by the flattened entries
+#define PICT_MAPPED_BITMAP_TAG      SkSetFourByteTag('b', 't', 'm', 'p')
+#define PICT_MAPPED_PAINT_TAG       SkSetFourByteTag('p', 'n', 't', ' ')
+#define PICT_MAPPED_PATH_TAG        SkSetFourByteTag('p', 't', 'h', ' ')
+#define PICT_MAPPED_REGION_TAG      SkSetFourByteTag('r', 'g', 'n', ' ')
+
+/** \class SkPictureMapping
+
+    The objects of a playback written by SkPicture::serializeMappable(), read
+    in place from the picture's data. Matrices, typefaces, factories and
+    nested pictures are read up front (they are few, and small); bitmaps,
+    paints, paths and regions are unflattened the first time they are asked
+    for, and kept until the mapping is destroyed.
+
+    A mapping is shared by the copies of a playback, so asking for an object
+    is thread-safe.
+*/
+class SkPictureMapping : public SkRefCnt {
+public:
+    /** Parse the playback that is size bytes at offset into data, which the
+        mapping refs. Calls sk_throw() if the chunks are malformed.
+    */
+    SkPictureMapping(SkData* data, size_t offset, size_t size);
+    virtual ~SkPictureMapping();
+
+    const void* ops() const { return fOps; }
+    size_t opsSize() const { return fOpsSize; }
+
+    int bitmapCount() const { return fBitmaps.fCount; }
+    int matrixCount() const { return fMatrixCount; }
+    int paintCount() const { return fPaints.fCount; }
+    int pathCount() const { return fPaths.fCount; }
+    int pictureCount() const { return fPictureCount; }
+    int regionCount() const { return fRegions.fCount; }
+
+    const SkBitmap& bitmap(int index);
+    const SkMatrix& matrix(int index) const {
+        SkASSERT((unsigned)index < (unsigned)fMatrixCount);
+        return fMatrices[index];
+    }
+    const SkPaint& paint(int index);
+    const SkPath& path(int index);
+    SkPicture* picture(int index) const {
+        SkASSERT((unsigned)index < (unsigned)fPictureCount);
+        return fPictureRefs[index];
+    }
+    const SkRegion& region(int index);
+
+private:
+    struct Table {
+        int             fCount;
+        const uint32_t* fOffsets;   // fCount + 1 of them
+        const char*     fEntries;
+        void**          fDecoded;   // fCount of them, NULL until asked for
+
+        const void* entry(int index) const {
+            return fEntries + fOffsets[index];
+        }
+        size_t entrySize(int index) const {
+            return fOffsets[index + 1] - fOffsets[index];
+        }
+    };
+
+    SkData*             fData;
+    const void*         fOps;
+    size_t              fOpsSize;
+    SkMatrix*           fMatrices;
+    int                 fMatrixCount;
+    SkPicture**         fPictureRefs;
+    int                 fPictureCount;
+    Table               fBitmaps;
+    Table               fPaints;
+    Table               fPaths;
+    Table               fRegions;
+
+    SkFactoryPlayback*  fFactoryPlayback;
+    SkTypefacePlayback  fTFPlayback;
+    SkMutex             fMutex;     // guards the tables' fDecoded
+
+    void setupBuffer(SkFlattenableReadBuffer&) const;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
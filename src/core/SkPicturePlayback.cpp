@@ -1,5 +1,9 @@
 #include "SkPicturePlayback.h"
+#include "SkPictureProfile.h"
 #include "SkPictureRecord.h"
+#include "SkThread.h"
+#include "SkTime.h"
+#include "SkTrace.h"
 #include "SkTypeface.h"
 #include <new>
 
@@ -13,6 +17,18 @@ SkPicturePlayback::SkPicturePlayback() {
 }
 
 SkPicturePlayback::SkPicturePlayback(const SkPictureRecord& record) {
+    this->initFromRecord(record, NULL, 0);
+}
+
+SkPicturePlayback::SkPicturePlayback(SkPictureRecord* record) {
+    // if the ops are all in one block, take it as it is, rather than copying
+    size_t size = record->writeStream().size();
+    void* ops = record->detachOps();
+    this->initFromRecord(*record, ops, size);
+}
+
+void SkPicturePlayback::initFromRecord(const SkPictureRecord& record,
+                                       void* ops, size_t opsSize) {
 #ifdef SK_DEBUG_SIZE
     size_t overallBytes, bitmapBytes, matricesBytes,
     paintBytes, pathBytes, pictureBytes, regionBytes;
@@ -53,10 +69,16 @@ SkPicturePlayback::SkPicturePlayback(const SkPictureRecord& record) {
     record.validate();
     const SkWriter32& writer = record.writeStream();
     init();
-    if (writer.size() == 0)
-        return;
+    if (ops) {
+        if (0 == opsSize) {
+            sk_free(ops);
+            return;
+        }
+        fReader.setMemory(ops, opsSize);    // fReader owns ops now
+    } else {
+        if (writer.size() == 0)
+            return;
 
-    {
         size_t size = writer.size();
         void* buffer = sk_malloc_throw(size);
         writer.flatten(buffer);
@@ -131,6 +153,8 @@ SkPicturePlayback::SkPicturePlayback(const SkPictureRecord& record) {
         }
     }
 
+    fIndex = record.createIndex();
+
 #ifdef SK_DEBUG_SIZE
     int overall = fPlayback->size(&overallBytes);
     bitmaps = fPlayback->bitmaps(&bitmapBytes);
@@ -156,6 +180,19 @@ SkPicturePlayback::SkPicturePlayback(const SkPictureRecord& record) {
 SkPicturePlayback::SkPicturePlayback(const SkPicturePlayback& src) {
     this->init();
 
+    if (src.fMapping) {
+        // share the mapping, which reads the objects for both of us
+        fMapping = src.fMapping;
+        fMapping->ref();
+        fReader.setMemory(src.fReader.base(), src.fReader.size());
+        fBitmapCount = src.fBitmapCount;
+        fMatrixCount = src.fMatrixCount;
+        fPaintCount = src.fPaintCount;
+        fPictureCount = src.fPictureCount;
+        fRegionCount = src.fRegionCount;
+        return;
+    }
+
     // copy the data from fReader
     {
         size_t size = src.fReader.size();
@@ -197,6 +234,9 @@ SkPicturePlayback::SkPicturePlayback(const SkPicturePlayback& src) {
     for (i = 0; i < fRegionCount; i++) {
         fRegions[i] = src.fRegions[i];
     }
+
+    fIndex = src.fIndex;
+    SkSafeRef(fIndex);
 }
 
 void SkPicturePlayback::init() {
@@ -210,10 +250,16 @@ void SkPicturePlayback::init() {
     fRegionCount = 0;
 
     fFactoryPlayback = NULL;
+    fIndex = NULL;
+    fMapping = NULL;
+    fAbortCount = 0;
 }
 
 SkPicturePlayback::~SkPicturePlayback() {
-    sk_free((void*) fReader.base());
+    if (NULL == fMapping) {
+        sk_free((void*) fReader.base());
+    }
+    SkSafeUnref(fMapping);
 
     SkDELETE_ARRAY(fBitmaps);
     SkDELETE_ARRAY(fMatrices);
@@ -221,9 +267,12 @@ SkPicturePlayback::~SkPicturePlayback() {
     SkDELETE_ARRAY(fRegions);
 
     SkSafeUnref(fPathHeap);
+    SkSafeUnref(fIndex);
 
-    for (int i = 0; i < fPictureCount; i++) {
-        fPictureRefs[i]->unref();
+    if (fPictureRefs) {
+        for (int i = 0; i < fPictureCount; i++) {
+            fPictureRefs[i]->unref();
+        }
     }
     SkDELETE_ARRAY(fPictureRefs);
 
@@ -236,7 +285,7 @@ void SkPicturePlayback::dumpSize() const {
              fBitmapCount, fBitmapCount * sizeof(SkBitmap),
              fMatrixCount, fMatrixCount * sizeof(SkMatrix),
              fPaintCount, fPaintCount * sizeof(SkPaint),
-             fPathHeap ? fPathHeap->count() : 0,
+             this->pathCount(),
              fRegionCount);
 }
 
@@ -324,31 +373,38 @@ void SkPicturePlayback::serialize(SkWStream* stream) const {
 
     writeTagSize(buffer, PICT_BITMAP_TAG, fBitmapCount);
     for (i = 0; i < fBitmapCount; i++) {
-        fBitmaps[i].flatten(buffer);
+        this->bitmapAt(i).flatten(buffer);
     }
 
     writeTagSize(buffer, PICT_MATRIX_TAG, fMatrixCount);
-    buffer.writeMul4(fMatrices, fMatrixCount * sizeof(SkMatrix));
+    for (i = 0; i < fMatrixCount; i++) {
+        buffer.writeMul4(&this->matrixAt(i), sizeof(SkMatrix));
+    }
 
     writeTagSize(buffer, PICT_PAINT_TAG, fPaintCount);
     for (i = 0; i < fPaintCount; i++) {
-        fPaints[i].flatten(buffer);
+        this->paintAt(i).flatten(buffer);
     }
 
     {
-        int count = fPathHeap ? fPathHeap->count() : 0;
+        // the same as SkPathHeap::flatten()
+        int count = this->pathCount();
         writeTagSize(buffer, PICT_PATH_TAG, count);
         if (count > 0) {
-            fPathHeap->flatten(buffer);
+            buffer.write32(count);
+            for (i = 0; i < count; i++) {
+                this->pathAt(i).flatten(buffer);
+            }
         }
     }
 
     writeTagSize(buffer, PICT_REGION_TAG, fRegionCount);
     for (i = 0; i < fRegionCount; i++) {
-        uint32_t size = fRegions[i].flatten(NULL);
+        const SkRegion& region = this->regionAt(i);
+        uint32_t size = region.flatten(NULL);
         buffer.write32(size);
         SkAutoSMalloc<512> storage(size);
-        fRegions[i].flatten(storage.get());
+        region.flatten(storage.get());
         buffer.writePad(storage.get(), size);
     }
 
@@ -359,7 +415,7 @@ void SkPicturePlayback::serialize(SkWStream* stream) const {
 
     writeTagSize(stream, PICT_PICTURE_TAG, fPictureCount);
     for (i = 0; i < fPictureCount; i++) {
-        fPictureRefs[i]->serialize(stream);
+        this->pictureAt(i)->serialize(stream);
     }
 
     writeTagSize(stream, PICT_ARRAYS_TAG, buffer.size());
@@ -368,6 +424,134 @@ void SkPicturePlayback::serialize(SkWStream* stream) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void setupWriteBuffer(SkFlattenableWriteBuffer* buffer,
+                             SkRefCntSet* typefaceSet, SkFactorySet* factSet) {
+    buffer->setFlags(SkFlattenableWriteBuffer::kCrossProcess_Flag);
+    buffer->setTypefaceRecorder(typefaceSet);
+    buffer->setFactoryRecorder(factSet);
+}
+
+static void writePadding(SkWStream* stream, size_t size) {
+    static const uint32_t gZero = 0;
+    stream->write(&gZero, SkAlign4(size) - size);
+}
+
+// Each entry has already been flattened into buffer, and *offsets.append()
+// was called before each one, so all that is missing is the end.
+static void writeTable(SkWStream* stream, uint32_t tag,
+                       SkTDArray<uint32_t>* offsets,
+                       SkFlattenableWriteBuffer* buffer) {
+    writeTagSize(stream, tag, offsets->count());
+    *offsets->append() = buffer->size();
+    stream->write(offsets->begin(), offsets->count() * sizeof(uint32_t));
+    buffer->writeToStream(stream);
+}
+
+/*  The mappable format has the same chunks as the one above, but each object
+    is flattened on its own, with a table of where each one starts, so that
+    they can be unflattened one at a time, straight out of the data.
+ */
+void SkPicturePlayback::serializeMappable(SkWStream* stream) const {
+    SkRefCntSet  typefaceSet;
+    SkFactorySet factSet;
+    int i;
+
+    // the objects have to be flattened first, to find the factories and
+    // typefaces that they need
+    SkFlattenableWriteBuffer bitmaps(1024);
+    SkTDArray<uint32_t> bitmapOffsets;
+    setupWriteBuffer(&bitmaps, &typefaceSet, &factSet);
+    for (i = 0; i < fBitmapCount; i++) {
+        *bitmapOffsets.append() = bitmaps.size();
+        this->bitmapAt(i).flatten(bitmaps);
+    }
+
+    SkFlattenableWriteBuffer paints(1024);
+    SkTDArray<uint32_t> paintOffsets;
+    setupWriteBuffer(&paints, &typefaceSet, &factSet);
+    for (i = 0; i < fPaintCount; i++) {
+        *paintOffsets.append() = paints.size();
+        this->paintAt(i).flatten(paints);
+    }
+
+    SkFlattenableWriteBuffer paths(1024);
+    SkTDArray<uint32_t> pathOffsets;
+    setupWriteBuffer(&paths, &typefaceSet, &factSet);
+    for (i = 0; i < this->pathCount(); i++) {
+        *pathOffsets.append() = paths.size();
+        this->pathAt(i).flatten(paths);
+    }
+
+    SkFlattenableWriteBuffer regions(1024);
+    SkTDArray<uint32_t> regionOffsets;
+    for (i = 0; i < fRegionCount; i++) {
+        *regionOffsets.append() = regions.size();
+        const SkRegion& region = this->regionAt(i);
+        uint32_t size = region.flatten(NULL);
+        SkAutoSMalloc<512> storage(size);
+        region.flatten(storage.get());
+        regions.writePad(storage.get(), size);
+    }
+
+    writeTagSize(stream, PICT_MAPPED_READER_TAG, fReader.size());
+    stream->write(fReader.base(), fReader.size());
+
+    {
+        int count = factSet.count();
+        writeTagSize(stream, PICT_MAPPED_FACTORY_TAG, count);
+        SkAutoSTMalloc<16, SkFlattenable::Factory> storage(count);
+        SkFlattenable::Factory* array = (SkFlattenable::Factory*)storage.get();
+        factSet.copyToArray(array);
+        for (i = 0; i < count; i++) {
+            const char* name = SkFlattenable::FactoryToName(array[i]);
+            uint32_t len = name ? strlen(name) : 0;
+            stream->write32(len);
+            stream->write(name, len);
+            writePadding(stream, len);
+        }
+    }
+
+    {
+        int count = typefaceSet.count();
+        SkAutoSTMalloc<16, SkTypeface*> storage(count);
+        SkTypeface** array = (SkTypeface**)storage.get();
+        typefaceSet.copyToArray((SkRefCnt**)array);
+        SkDynamicMemoryWStream typefaces;
+        for (i = 0; i < count; i++) {
+            array[i]->serialize(&typefaces);
+        }
+        typefaces.padToAlign4();
+        writeTagSize(stream, PICT_MAPPED_TYPEFACE_TAG, count);
+        stream->write32(typefaces.getOffset());
+        SkAutoMalloc copy(typefaces.getOffset());
+        typefaces.copyTo(copy.get());
+        stream->write(copy.get(), typefaces.getOffset());
+    }
+
+    writeTagSize(stream, PICT_MAPPED_PICTURE_TAG, fPictureCount);
+    for (i = 0; i < fPictureCount; i++) {
+        SkDynamicMemoryWStream picture;
+        this->pictureAt(i)->serializeMappable(&picture);
+        SkASSERT(SkAlign4(picture.getOffset()) == picture.getOffset());
+        stream->write32(picture.getOffset());
+        SkAutoMalloc copy(picture.getOffset());
+        picture.copyTo(copy.get());
+        stream->write(copy.get(), picture.getOffset());
+    }
+
+    writeTagSize(stream, PICT_MAPPED_MATRIX_TAG, fMatrixCount);
+    for (i = 0; i < fMatrixCount; i++) {
+        stream->write(&this->matrixAt(i), sizeof(SkMatrix));
+    }
+
+    writeTable(stream, PICT_MAPPED_BITMAP_TAG, &bitmapOffsets, &bitmaps);
+    writeTable(stream, PICT_MAPPED_PAINT_TAG, &paintOffsets, &paints);
+    writeTable(stream, PICT_MAPPED_PATH_TAG, &pathOffsets, &paths);
+    writeTable(stream, PICT_MAPPED_REGION_TAG, &regionOffsets, &regions);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static int readTagSize(SkFlattenableReadBuffer& buffer, uint32_t expectedTag) {
     uint32_t tag = buffer.readU32();
     if (tag != expectedTag) {
@@ -462,6 +646,19 @@ SkPicturePlayback::SkPicturePlayback(SkStream* stream) {
     }
 }
 
+SkPicturePlayback::SkPicturePlayback(SkData* data, size_t offset,
+                                     size_t size) {
+    this->init();
+
+    fMapping = SkNEW_ARGS(SkPictureMapping, (data, offset, size));
+    fReader.setMemory(fMapping->ops(), fMapping->opsSize());
+    fBitmapCount = fMapping->bitmapCount();
+    fMatrixCount = fMapping->matrixCount();
+    fPaintCount = fMapping->paintCount();
+    fPictureCount = fMapping->pictureCount();
+    fRegionCount = fMapping->regionCount();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -482,7 +679,17 @@ struct SkipClipRec {
 };
 #endif
 
-void SkPicturePlayback::draw(SkCanvas& canvas) {
+void SkPicturePlayback::draw(SkCanvas& canvas, SkPictureProfile* profile) {
+    SK_TRACE_EVENT("SkPicturePlayback::draw");
+    this->play(canvas, profile, true);
+}
+
+void SkPicturePlayback::drawUnculled(SkCanvas& canvas) {
+    this->play(canvas, NULL, false);
+}
+
+void SkPicturePlayback::play(SkCanvas& canvas, SkPictureProfile* profile,
+                             bool cull) {
 #ifdef ENABLE_TIME_DRAW
     SkAutoTime  at("SkPicture::draw", 50);
 #endif
@@ -491,187 +698,230 @@ void SkPicturePlayback::draw(SkCanvas& canvas) {
     SkipClipRec skipRect, skipRegion, skipPath;
 #endif
 
-#ifdef ANDROID
-    SkAutoMutexAcquire autoMutex(fDrawMutex);
-#endif
-
     TextContainer text;
-    fReader.rewind();
+    DrawReader reader(fReader.base(), fReader.size());
+    const int32_t abortCount = fAbortCount;
+
+    // If we have an index, find the draw ops that can touch the canvas' clip,
+    // and skip over the rest without decoding them. State ops (matrix, clip,
+    // save/restore) are never indexed, so they are always played back.
+    const bool* visible = NULL;
+    int indexCount = 0;
+    int indexCursor = 0;
+    SkAutoSTMalloc<256, bool> visibleStorage(fIndex ? fIndex->count() : 0);
+    if (fIndex && cull && !canvas.getTotalMatrix().hasPerspective()) {
+        indexCount = fIndex->count();
+        bool* storage = visibleStorage.get();
+        memset(storage, 0, indexCount * sizeof(bool));
+        SkRect clipBounds;
+        if (canvas.getClipBounds(&clipBounds)) {
+            SkIRect query;
+            clipBounds.roundOut(&query);
+            fIndex->search(query, storage);
+        }
+        visible = storage;
+    }
 
-    while (!fReader.eof()) {
-        switch (fReader.readInt()) {
+    while (!reader.eof() && abortCount == fAbortCount) {
+        if (visible) {
+            size_t offset = reader.offset();
+            // clip-skipping may have jumped over some indexed ops
+            while (indexCursor < indexCount &&
+                   (*fIndex)[indexCursor].fOffset < offset) {
+                indexCursor += 1;
+            }
+            if (indexCursor < indexCount &&
+                    (*fIndex)[indexCursor].fOffset == offset) {
+                if (!visible[indexCursor]) {
+                    reader.setOffset(offset + (*fIndex)[indexCursor].fSize);
+                    indexCursor += 1;
+                    continue;
+                }
+                indexCursor += 1;
+            }
+        }
+        const int op = reader.readInt();
+        double opStart = 0;
+        if (profile) {
+            reader.fLastPaint = NULL;
+            opStart = SkTime::GetUSecs();
+        }
+        switch (op) {
             case CLIP_PATH: {
-                const SkPath& path = getPath();
-                SkRegion::Op op = (SkRegion::Op) getInt();
-                size_t offsetToRestore = getInt();
+                const SkPath& path = getPath(&reader);
+                uint32_t packed = getInt(&reader);
+                SkRegion::Op op = (SkRegion::Op)(packed & ~CLIP_PATH_DO_ANTI_ALIAS);
+                bool doAA = SkToBool(packed & CLIP_PATH_DO_ANTI_ALIAS);
+                size_t offsetToRestore = getInt(&reader);
                 // HACK (false) until I can handle op==kReplace
-                if (!canvas.clipPath(path, op)) {
+                if (!canvas.clipPath(path, op, doAA) && cull) {
 #ifdef SPEW_CLIP_SKIPPING
-                    skipPath.recordSkip(offsetToRestore - fReader.offset());
+                    skipPath.recordSkip(offsetToRestore - reader.offset());
 #endif
-                    fReader.setOffset(offsetToRestore);
+                    reader.setOffset(offsetToRestore);
                 }
             } break;
             case CLIP_REGION: {
-                const SkRegion& region = getRegion();
-                SkRegion::Op op = (SkRegion::Op) getInt();
-                size_t offsetToRestore = getInt();
-                if (!canvas.clipRegion(region, op)) {
+                const SkRegion& region = getRegion(&reader);
+                SkRegion::Op op = (SkRegion::Op) getInt(&reader);
+                size_t offsetToRestore = getInt(&reader);
+                if (!canvas.clipRegion(region, op) && cull) {
 #ifdef SPEW_CLIP_SKIPPING
-                    skipRegion.recordSkip(offsetToRestore - fReader.offset());
+                    skipRegion.recordSkip(offsetToRestore - reader.offset());
 #endif
-                    fReader.setOffset(offsetToRestore);
+                    reader.setOffset(offsetToRestore);
                 }
             } break;
             case CLIP_RECT: {
-                const SkRect* rect = fReader.skipRect();
-                SkRegion::Op op = (SkRegion::Op) getInt();
-                size_t offsetToRestore = getInt();
-                if (!canvas.clipRect(*rect, op)) {
+                const SkRect* rect = reader.skipRect();
+                SkRegion::Op op = (SkRegion::Op) getInt(&reader);
+                size_t offsetToRestore = getInt(&reader);
+                if (!canvas.clipRect(*rect, op) && cull) {
 #ifdef SPEW_CLIP_SKIPPING
-                    skipRect.recordSkip(offsetToRestore - fReader.offset());
+                    skipRect.recordSkip(offsetToRestore - reader.offset());
 #endif
-                    fReader.setOffset(offsetToRestore);
+                    reader.setOffset(offsetToRestore);
                 }
             } break;
             case CONCAT:
-                canvas.concat(*getMatrix());
+                canvas.concat(*getMatrix(&reader));
                 break;
             case DRAW_BITMAP: {
-                const SkPaint* paint = getPaint();
-                const SkBitmap& bitmap = getBitmap();
-                const SkPoint* loc = fReader.skipPoint();
+                const SkPaint* paint = getPaint(&reader);
+                const SkBitmap& bitmap = getBitmap(&reader);
+                const SkPoint* loc = reader.skipPoint();
                 canvas.drawBitmap(bitmap, loc->fX, loc->fY, paint);
             } break;
             case DRAW_BITMAP_RECT: {
-                const SkPaint* paint = getPaint();
-                const SkBitmap& bitmap = getBitmap();
-                const SkIRect* src = this->getIRectPtr();   // may be null
-                const SkRect* dst = fReader.skipRect();     // required
+                const SkPaint* paint = getPaint(&reader);
+                const SkBitmap& bitmap = getBitmap(&reader);
+                const SkIRect* src = this->getIRectPtr(&reader);   // may be null
+                const SkRect* dst = reader.skipRect();     // required
                 canvas.drawBitmapRect(bitmap, src, *dst, paint);
             } break;
             case DRAW_BITMAP_MATRIX: {
-                const SkPaint* paint = getPaint();
-                const SkBitmap& bitmap = getBitmap();
-                const SkMatrix* matrix = getMatrix();
+                const SkPaint* paint = getPaint(&reader);
+                const SkBitmap& bitmap = getBitmap(&reader);
+                const SkMatrix* matrix = getMatrix(&reader);
                 canvas.drawBitmapMatrix(bitmap, *matrix, paint);
             } break;
             case DRAW_CLEAR:
-                canvas.clear(getInt());
+                canvas.clear(getInt(&reader));
                 break;
             case DRAW_DATA: {
-                size_t length = getInt();
-                canvas.drawData(fReader.skip(length), length);
+                size_t length = getInt(&reader);
+                canvas.drawData(reader.skip(length), length);
                 // skip handles padding the read out to a multiple of 4
             } break;
             case DRAW_PAINT:
-                canvas.drawPaint(*getPaint());
+                canvas.drawPaint(*getPaint(&reader));
                 break;
             case DRAW_PATH: {
-                const SkPaint& paint = *getPaint();
-                canvas.drawPath(getPath(), paint);
+                const SkPaint& paint = *getPaint(&reader);
+                canvas.drawPath(getPath(&reader), paint);
             } break;
             case DRAW_PICTURE:
-                canvas.drawPicture(getPicture());
+                canvas.drawPicture(getPicture(&reader));
                 break;
             case DRAW_POINTS: {
-                const SkPaint& paint = *getPaint();
-                SkCanvas::PointMode mode = (SkCanvas::PointMode)getInt();
-                size_t count = getInt();
-                const SkPoint* pts = (const SkPoint*)fReader.skip(sizeof(SkPoint) * count);
+                const SkPaint& paint = *getPaint(&reader);
+                SkCanvas::PointMode mode = (SkCanvas::PointMode)getInt(&reader);
+                size_t count = getInt(&reader);
+                const SkPoint* pts = (const SkPoint*)reader.skip(sizeof(SkPoint) * count);
                 canvas.drawPoints(mode, count, pts, paint);
             } break;
             case DRAW_POS_TEXT: {
-                const SkPaint& paint = *getPaint();
-                getText(&text);
-                size_t points = getInt();
-                const SkPoint* pos = (const SkPoint*)fReader.skip(points * sizeof(SkPoint));
+                const SkPaint& paint = *getPaint(&reader);
+                getText(&reader, &text);
+                size_t points = getInt(&reader);
+                const SkPoint* pos = (const SkPoint*)reader.skip(points * sizeof(SkPoint));
                 canvas.drawPosText(text.text(), text.length(), pos, paint);
             } break;
             case DRAW_POS_TEXT_H: {
-                const SkPaint& paint = *getPaint();
-                getText(&text);
-                size_t xCount = getInt();
-                const SkScalar constY = getScalar();
-                const SkScalar* xpos = (const SkScalar*)fReader.skip(xCount * sizeof(SkScalar));
+                const SkPaint& paint = *getPaint(&reader);
+                getText(&reader, &text);
+                size_t xCount = getInt(&reader);
+                const SkScalar constY = getScalar(&reader);
+                const SkScalar* xpos = (const SkScalar*)reader.skip(xCount * sizeof(SkScalar));
                 canvas.drawPosTextH(text.text(), text.length(), xpos, constY,
                                     paint);
             } break;
             case DRAW_POS_TEXT_H_TOP_BOTTOM: {
-                const SkPaint& paint = *getPaint();
-                getText(&text);
-                size_t xCount = getInt();
-                const SkScalar* xpos = (const SkScalar*)fReader.skip((3 + xCount) * sizeof(SkScalar));
+                const SkPaint& paint = *getPaint(&reader);
+                getText(&reader, &text);
+                size_t xCount = getInt(&reader);
+                const SkScalar* xpos = (const SkScalar*)reader.skip((3 + xCount) * sizeof(SkScalar));
                 const SkScalar top = *xpos++;
                 const SkScalar bottom = *xpos++;
                 const SkScalar constY = *xpos++;
-                if (!canvas.quickRejectY(top, bottom, SkCanvas::kAA_EdgeType)) {
+                if (!cull || !canvas.quickRejectY(top, bottom,
+                                                  SkCanvas::kAA_EdgeType)) {
                     canvas.drawPosTextH(text.text(), text.length(), xpos,
                                         constY, paint);
                 }
             } break;
             case DRAW_RECT: {
-                const SkPaint& paint = *getPaint();
-                canvas.drawRect(*fReader.skipRect(), paint);
+                const SkPaint& paint = *getPaint(&reader);
+                canvas.drawRect(*reader.skipRect(), paint);
             } break;
             case DRAW_SPRITE: {
-                const SkPaint* paint = getPaint();
-                const SkBitmap& bitmap = getBitmap();
-                int left = getInt();
-                int top = getInt();
+                const SkPaint* paint = getPaint(&reader);
+                const SkBitmap& bitmap = getBitmap(&reader);
+                int left = getInt(&reader);
+                int top = getInt(&reader);
                 canvas.drawSprite(bitmap, left, top, paint);
             } break;
             case DRAW_TEXT: {
-                const SkPaint& paint = *getPaint();
-                getText(&text);
-                SkScalar x = getScalar();
-                SkScalar y = getScalar();
+                const SkPaint& paint = *getPaint(&reader);
+                getText(&reader, &text);
+                SkScalar x = getScalar(&reader);
+                SkScalar y = getScalar(&reader);
                 canvas.drawText(text.text(), text.length(), x, y, paint);
             } break;
             case DRAW_TEXT_TOP_BOTTOM: {
-                const SkPaint& paint = *getPaint();
-                getText(&text);
-                const SkScalar* ptr = (const SkScalar*)fReader.skip(4 * sizeof(SkScalar));
+                const SkPaint& paint = *getPaint(&reader);
+                getText(&reader, &text);
+                const SkScalar* ptr = (const SkScalar*)reader.skip(4 * sizeof(SkScalar));
                 // ptr[0] == x
                 // ptr[1] == y
                 // ptr[2] == top
                 // ptr[3] == bottom
-                if (!canvas.quickRejectY(ptr[2], ptr[3],
-                                         SkCanvas::kAA_EdgeType)) {
+                if (!cull || !canvas.quickRejectY(ptr[2], ptr[3],
+                                                  SkCanvas::kAA_EdgeType)) {
                     canvas.drawText(text.text(), text.length(), ptr[0], ptr[1],
                                     paint);
                 }
             } break;
             case DRAW_TEXT_ON_PATH: {
-                const SkPaint& paint = *getPaint();
-                getText(&text);
-                const SkPath& path = getPath();
-                const SkMatrix* matrix = getMatrix();
+                const SkPaint& paint = *getPaint(&reader);
+                getText(&reader, &text);
+                const SkPath& path = getPath(&reader);
+                const SkMatrix* matrix = getMatrix(&reader);
                 canvas.drawTextOnPath(text.text(), text.length(), path,
                                       matrix, paint);
             } break;
             case DRAW_VERTICES: {
-                const SkPaint& paint = *getPaint();
-                DrawVertexFlags flags = (DrawVertexFlags)getInt();
-                SkCanvas::VertexMode vmode = (SkCanvas::VertexMode)getInt();
-                int vCount = getInt();
-                const SkPoint* verts = (const SkPoint*)fReader.skip(
+                const SkPaint& paint = *getPaint(&reader);
+                DrawVertexFlags flags = (DrawVertexFlags)getInt(&reader);
+                SkCanvas::VertexMode vmode = (SkCanvas::VertexMode)getInt(&reader);
+                int vCount = getInt(&reader);
+                const SkPoint* verts = (const SkPoint*)reader.skip(
                                                     vCount * sizeof(SkPoint));
                 const SkPoint* texs = NULL;
                 const SkColor* colors = NULL;
                 const uint16_t* indices = NULL;
                 int iCount = 0;
                 if (flags & DRAW_VERTICES_HAS_TEXS) {
-                    texs = (const SkPoint*)fReader.skip(
+                    texs = (const SkPoint*)reader.skip(
                                                     vCount * sizeof(SkPoint));
                 }
                 if (flags & DRAW_VERTICES_HAS_COLORS) {
-                    colors = (const SkColor*)fReader.skip(
+                    colors = (const SkColor*)reader.skip(
                                                     vCount * sizeof(SkColor));
                 }
                 if (flags & DRAW_VERTICES_HAS_INDICES) {
-                    iCount = getInt();
-                    indices = (const uint16_t*)fReader.skip(
+                    iCount = getInt(&reader);
+                    indices = (const uint16_t*)reader.skip(
                                                     iCount * sizeof(uint16_t));
                 }
                 canvas.drawVertices(vmode, vCount, verts, texs, colors, NULL,
@@ -681,52 +931,77 @@ void SkPicturePlayback::draw(SkCanvas& canvas) {
                 canvas.restore();
                 break;
             case ROTATE:
-                canvas.rotate(getScalar());
+                canvas.rotate(getScalar(&reader));
                 break;
             case SAVE:
-                canvas.save((SkCanvas::SaveFlags) getInt());
+                canvas.save((SkCanvas::SaveFlags) getInt(&reader));
                 break;
             case SAVE_LAYER: {
-                const SkRect* boundsPtr = getRectPtr();
-                const SkPaint* paint = getPaint();
-                canvas.saveLayer(boundsPtr, paint, (SkCanvas::SaveFlags) getInt());
+                const SkRect* boundsPtr = getRectPtr(&reader);
+                const SkPaint* paint = getPaint(&reader);
+                canvas.saveLayer(boundsPtr, paint, (SkCanvas::SaveFlags) getInt(&reader));
                 } break;
             case SCALE: {
-                SkScalar sx = getScalar();
-                SkScalar sy = getScalar();
+                SkScalar sx = getScalar(&reader);
+                SkScalar sy = getScalar(&reader);
                 canvas.scale(sx, sy);
             } break;
             case SET_MATRIX:
-                canvas.setMatrix(*getMatrix());
+                canvas.setMatrix(*getMatrix(&reader));
                 break;
             case SKEW: {
-                SkScalar sx = getScalar();
-                SkScalar sy = getScalar();
+                SkScalar sx = getScalar(&reader);
+                SkScalar sy = getScalar(&reader);
                 canvas.skew(sx, sy);
             } break;
             case TRANSLATE: {
-                SkScalar dx = getScalar();
-                SkScalar dy = getScalar();
+                SkScalar dx = getScalar(&reader);
+                SkScalar dy = getScalar(&reader);
                 canvas.translate(dx, dy);
             } break;
             default:
                 SkASSERT(0);
         }
+        if (profile) {
+            profile->addOp(op, reader.fLastPaint, SkTime::GetUSecs() - opStart);
+        }
     }
 
 #ifdef SPEW_CLIP_SKIPPING
     {
         size_t size =  skipRect.fSize + skipPath.fSize + skipRegion.fSize;
         SkDebugf("--- Clip skips %d%% rect:%d path:%d rgn:%d\n",
-             size * 100 / fReader.offset(), skipRect.fCount, skipPath.fCount,
+             size * 100 / reader.offset(), skipRect.fCount, skipPath.fCount,
              skipRegion.fCount);
     }
 #endif
 //    this->dumpSize();
 }
 
+bool SkPicturePlayback::canDrawConcurrently() const {
+    for (int i = 0; i < fPaintCount; i++) {
+        const SkPaint& paint = this->paintAt(i);
+        if (paint.getShader() || paint.getLooper()) {
+            return false;
+        }
+        // a paint caches its fast bounds the first time they are asked for,
+        // so do that now, before the threads share it
+        if (paint.canComputeFastBounds()) {
+            SkRect r;
+            r.setEmpty();
+            (void)paint.computeFastBounds(r, &r);
+        }
+    }
+    for (int i = 0; i < fPictureCount; i++) {
+        if (!this->pictureAt(i)->canDrawConcurrently()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void SkPicturePlayback::abort() {
-    fReader.skip(fReader.size() - fReader.offset());
+    sk_atomic_inc(&fAbortCount);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -11,11 +11,11 @@
 #include "SkPathHeap.h"
 #include "SkRegion.h"
 #include "SkPictureFlat.h"
+#include "SkPictureIndex.h"
+#include "SkPictureMapping.h"
 
-#ifdef ANDROID
-#include "SkThread.h"
-#endif
-
+class SkData;
+class SkPictureProfile;
 class SkPictureRecord;
 class SkStream;
 class SkWStream;
@@ -25,21 +25,51 @@ public:
     SkPicturePlayback();
     SkPicturePlayback(const SkPicturePlayback& src);
     explicit SkPicturePlayback(const SkPictureRecord& record);
+    // takes the record's ops (leaving it without them) if it can
+    explicit SkPicturePlayback(SkPictureRecord* record);
     explicit SkPicturePlayback(SkStream*);
+    // plays back the mappable playback that is size bytes at offset into data
+    SkPicturePlayback(SkData* data, size_t offset, size_t size);
 
     virtual ~SkPicturePlayback();
 
-    void draw(SkCanvas& canvas);
+    // if profile is not NULL, each op is timed and added to it. draw() only
+    // reads the playback, so several threads may call it at once.
+    void draw(SkCanvas& canvas, SkPictureProfile* profile = NULL);
+
+    // Like draw(), but plays every op, even ones that canvas' clip says are
+    // not visible. This is for canvases that are recording, whose clip is
+    // not the one the ops will finally be drawn with.
+    void drawUnculled(SkCanvas& canvas);
+
+    // the size of the ops, in bytes
+    size_t opsSize() const { return fReader.size(); }
+
+    // see SkPicture::canDrawConcurrently()
+    bool canDrawConcurrently() const;
 
     void serialize(SkWStream*) const;
+    void serializeMappable(SkWStream*) const;
 
     void dumpSize() const;
     
     // Can be called in the middle of playback (the draw() call). WIll abort the
-    // drawing and return from draw() after the "current" op code is done
+    // drawing and return from draw() after the "current" op code is done. If
+    // several threads are drawing, they all stop.
     void abort();
 
 private:
+    // Where one draw() call is in the ops. It lives on draw()'s stack, so
+    // that the playback itself is never written to while drawing.
+    class DrawReader : public SkReader32 {
+    public:
+        DrawReader(const void* ops, size_t size)
+            : SkReader32(ops, size), fLastPaint(NULL) {}
+
+        // the paint of the op being played back; only read (and cleared
+        // before each op) when draw() is profiling
+        const SkPaint* fLastPaint;
+    };
 
     class TextContainer {
     public:
@@ -49,73 +79,104 @@ private:
         const char* fText;
     };
 
-    const SkBitmap& getBitmap() {
-        int index = getInt();
+    const SkBitmap& getBitmap(DrawReader* reader) const {
+        int index = getInt(reader);
         SkASSERT(index > 0);
-        return fBitmaps[index - 1];
+        return this->bitmapAt(index - 1);
     }
 
-    int getIndex() { return fReader.readInt(); }
-    int getInt() { return fReader.readInt(); }
+    int getIndex(DrawReader* reader) const { return reader->readInt(); }
+    int getInt(DrawReader* reader) const { return reader->readInt(); }
 
-    const SkMatrix* getMatrix() {
-        int index = getInt();
+    const SkMatrix* getMatrix(DrawReader* reader) const {
+        int index = getInt(reader);
         if (index == 0) {
             return NULL;
         }
         SkASSERT(index > 0 && index <= fMatrixCount);
-        return &fMatrices[index - 1];
+        return &this->matrixAt(index - 1);
     }
 
-    const SkPath& getPath() {
-        return (*fPathHeap)[getInt() - 1];
+    const SkPath& getPath(DrawReader* reader) const {
+        return this->pathAt(getInt(reader) - 1);
     }
 
-    SkPicture& getPicture() {
-        int index = getInt();
+    SkPicture& getPicture(DrawReader* reader) const {
+        int index = getInt(reader);
         SkASSERT(index > 0 && index <= fPictureCount);
-        return *fPictureRefs[index - 1];
+        return *this->pictureAt(index - 1);
     }
     
-    const SkPaint* getPaint() {
-        int index = getInt();
+    const SkPaint* getPaint(DrawReader* reader) const {
+        int index = getInt(reader);
         if (index == 0) {
             return NULL;
         }
         SkASSERT(index > 0 && index <= fPaintCount);
-        return &fPaints[index - 1];
+        reader->fLastPaint = &this->paintAt(index - 1);
+        return reader->fLastPaint;
     }
 
-    const SkRect* getRectPtr() {
-        if (fReader.readBool()) {
-            return fReader.skipRect();
+    const SkRect* getRectPtr(DrawReader* reader) const {
+        if (reader->readBool()) {
+            return reader->skipRect();
         } else {
             return NULL;
         }
     }
 
-    const SkIRect* getIRectPtr() {
-        if (fReader.readBool()) {
-            return (const SkIRect*)fReader.skip(sizeof(SkIRect));
+    const SkIRect* getIRectPtr(DrawReader* reader) const {
+        if (reader->readBool()) {
+            return (const SkIRect*)reader->skip(sizeof(SkIRect));
         } else {
             return NULL;
         }
     }
 
-    const SkRegion& getRegion() {
-        int index = getInt();
+    const SkRegion& getRegion(DrawReader* reader) const {
+        int index = getInt(reader);
         SkASSERT(index > 0);
-        return fRegions[index - 1];
+        return this->regionAt(index - 1);
     }
 
-    SkScalar getScalar() { return fReader.readScalar(); }
+    SkScalar getScalar(DrawReader* reader) const {
+        return reader->readScalar();
+    }
 
-    void getText(TextContainer* text) {
-        size_t length = text->fByteLength = getInt();
-        text->fText = (const char*)fReader.skip(length);
+    void getText(DrawReader* reader, TextContainer* text) const {
+        size_t length = text->fByteLength = getInt(reader);
+        text->fText = (const char*)reader->skip(length);
     }
 
+    // the objects, wherever they are kept
+    const SkBitmap& bitmapAt(int index) const {
+        return fMapping ? fMapping->bitmap(index) : fBitmaps[index];
+    }
+    const SkMatrix& matrixAt(int index) const {
+        return fMapping ? fMapping->matrix(index) : fMatrices[index];
+    }
+    const SkPaint& paintAt(int index) const {
+        return fMapping ? fMapping->paint(index) : fPaints[index];
+    }
+    int pathCount() const {
+        return fMapping ? fMapping->pathCount() :
+                          (fPathHeap ? fPathHeap->count() : 0);
+    }
+    const SkPath& pathAt(int index) const {
+        return fMapping ? fMapping->path(index) : (*fPathHeap)[index];
+    }
+    SkPicture* pictureAt(int index) const {
+        return fMapping ? fMapping->picture(index) : fPictureRefs[index];
+    }
+    const SkRegion& regionAt(int index) const {
+        return fMapping ? fMapping->region(index) : fRegions[index];
+    }
+
+    void play(SkCanvas& canvas, SkPictureProfile* profile, bool cull);
+
     void init();
+    // ops, if not null, are opsSize bytes of the record's ops, which we own
+    void initFromRecord(const SkPictureRecord&, void* ops, size_t opsSize);
 
 #ifdef SK_DEBUG_SIZE
 public:
@@ -167,9 +228,13 @@ private:
     SkRefCntPlayback fRCPlayback;
     SkTypefacePlayback fTFPlayback;
     SkFactoryPlayback*   fFactoryPlayback;
-#ifdef ANDROID
-    SkMutex fDrawMutex;
-#endif
+    SkPictureIndex*      fIndex;    // reference counted, may be NULL
+    // bumped by abort(); a draw() stops once it no longer matches the count
+    // that draw() started with
+    int32_t              fAbortCount;
+    // reference counted; if not NULL, fReader and the object counts refer to
+    // it, and the object arrays are not used
+    SkPictureMapping*    fMapping;
 };
 
 #endif
@@ -0,0 +1,174 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkPictureProfile.h"
+#include "SkPictureFlat.h"
+#include "SkPaint.h"
+#include "SkString.h"
+#include "SkXfermode.h"
+
+SK_COMPILE_ASSERT(TRANSLATE < SkPictureProfile::kOpTypeCount,
+                  too_many_op_types);
+
+static const char* gOpNames[] = {
+    NULL,   // UNUSED
+    "CLIP_PATH",
+    "CLIP_REGION",
+    "CLIP_RECT",
+    "CONCAT",
+    "DRAW_BITMAP",
+    "DRAW_BITMAP_MATRIX",
+    "DRAW_BITMAP_RECT",
+    "DRAW_CLEAR",
+    "DRAW_DATA",
+    "DRAW_PAINT",
+    "DRAW_PATH",
+    "DRAW_PICTURE",
+    "DRAW_POINTS",
+    "DRAW_POS_TEXT",
+    "DRAW_POS_TEXT_H",
+    "DRAW_POS_TEXT_H_TOP_BOTTOM",
+    "DRAW_RECT",
+    "DRAW_SPRITE",
+    "DRAW_TEXT",
+    "DRAW_TEXT_ON_PATH",
+    "DRAW_TEXT_TOP_BOTTOM",
+    "DRAW_VERTICES",
+    "RESTORE",
+    "ROTATE",
+    "SAVE",
+    "SAVE_LAYER",
+    "SCALE",
+    "SET_MATRIX",
+    "SKEW",
+    "TRANSLATE"
+};
+
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gOpNames) == TRANSLATE + 1,
+                  op_names_mismatch);
+
+static const char* gFeatureNames[] = {
+    "shader",
+    "xfermode",
+    "maskfilter",
+    "antialias"
+};
+
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gFeatureNames) ==
+                  SkPictureProfile::kFeatureCount, feature_names_mismatch);
+
+SkPictureProfile::SkPictureProfile() {
+    this->reset();
+}
+
+void SkPictureProfile::reset() {
+    memset(fOps, 0, sizeof(fOps));
+    memset(fFeatures, 0, sizeof(fFeatures));
+    memset(&fTotal, 0, sizeof(fTotal));
+}
+
+const char* SkPictureProfile::OpName(int type) {
+    if ((unsigned)type >= SK_ARRAY_COUNT(gOpNames)) {
+        return NULL;
+    }
+    return gOpNames[type];
+}
+
+const char* SkPictureProfile::FeatureName(Feature f) {
+    SkASSERT((unsigned)f < kFeatureCount);
+    return gFeatureNames[f];
+}
+
+static void add_stat(SkPictureProfile::Stat* stat, double usecs) {
+    stat->fCount += 1;
+    stat->fUSecs += usecs;
+}
+
+void SkPictureProfile::addOp(int type, const SkPaint* paint, double usecs) {
+    SkASSERT((unsigned)type < kOpTypeCount);
+    add_stat(&fOps[type], usecs);
+    add_stat(&fTotal, usecs);
+    if (NULL == paint) {
+        return;
+    }
+    if (paint->getShader()) {
+        add_stat(&fFeatures[kShader_Feature], usecs);
+    }
+    SkXfermode::Mode mode;
+    if (!SkXfermode::AsMode(paint->getXfermode(), &mode) ||
+            SkXfermode::kSrcOver_Mode != mode) {
+        add_stat(&fFeatures[kXfermode_Feature], usecs);
+    }
+    if (paint->getMaskFilter()) {
+        add_stat(&fFeatures[kMaskFilter_Feature], usecs);
+    }
+    if (paint->isAntiAlias()) {
+        add_stat(&fFeatures[kAntiAlias_Feature], usecs);
+    }
+}
+
+struct NamedStat {
+    const char*                     fName;
+    const SkPictureProfile::Stat*   fStat;
+};
+
+static void append_sorted(SkString* str, NamedStat stats[], int count,
+                          double totalUSecs) {
+    // a handful of entries, so a simple insertion sort will do
+    for (int i = 1; i < count; i++) {
+        NamedStat tmp = stats[i];
+        int j = i;
+        while (j > 0 && stats[j - 1].fStat->fUSecs < tmp.fStat->fUSecs) {
+            stats[j] = stats[j - 1];
+            j -= 1;
+        }
+        stats[j] = tmp;
+    }
+    for (int i = 0; i < count; i++) {
+        const SkPictureProfile::Stat& s = *stats[i].fStat;
+        double percent = totalUSecs > 0 ? s.fUSecs * 100 / totalUSecs : 0;
+        str->appendf("  %-28s %7d %12.1f us %6.1f%%\n", stats[i].fName,
+                     s.fCount, s.fUSecs, percent);
+    }
+}
+
+void SkPictureProfile::toString(SkString* str) const {
+    NamedStat stats[kOpTypeCount];
+    int count = 0;
+    for (int i = 0; i < kOpTypeCount; i++) {
+        if (fOps[i].fCount > 0 && OpName(i)) {
+            stats[count].fName = OpName(i);
+            stats[count].fStat = &fOps[i];
+            count += 1;
+        }
+    }
+    str->appendf("ops: %d in %.1f us\n", fTotal.fCount, fTotal.fUSecs);
+    append_sorted(str, stats, count, fTotal.fUSecs);
+
+    count = 0;
+    for (int i = 0; i < kFeatureCount; i++) {
+        if (fFeatures[i].fCount > 0) {
+            stats[count].fName = gFeatureNames[i];
+            stats[count].fStat = &fFeatures[i];
+            count += 1;
+        }
+    }
+    if (count > 0) {
+        str->append("paint features:\n");
+        append_sorted(str, stats, count, fTotal.fUSecs);
+    }
+}
@@ -1,8 +1,15 @@
 #include "SkPictureRecord.h"
+#include "SkDevice.h"
+#include "SkPicturePlayback.h"
+#include "SkTextBlob.h"
 #include "SkTSearch.h"
+#include "SkXfermode.h"
 
 #define MIN_WRITER_SIZE 16384
 #define HEAP_BLOCK_SIZE 4096
+// with kInlineSmallPictures_RecordingFlag, the largest ops (in bytes) that a
+// picture can have for drawPicture() to record them in place
+#define MAX_INLINE_OPS_SIZE 1024
 
 SkPictureRecord::SkPictureRecord(uint32_t flags) :
         fHeap(HEAP_BLOCK_SIZE), fWriter(MIN_WRITER_SIZE), fRecordFlags(flags) {
@@ -16,6 +23,15 @@ SkPictureRecord::SkPictureRecord(uint32_t flags) :
     fRestoreOffsetStack.push(0);
 
     fPathHeap = NULL;   // lazy allocate
+
+    fOpBoundsPending = false;
+    fCanIndex = true;
+
+    *fLayerParents.append() = 0;
+    fApproxClipLevel = 0;
+    fCanEliminate = true;
+    fClipsAreConvex = true;
+    fLayerFold.fActive = false;
 }
 
 SkPictureRecord::~SkPictureRecord() {
@@ -29,19 +45,54 @@ int SkPictureRecord::save(SaveFlags flags) {
     addInt(flags);
 
     fRestoreOffsetStack.push(0);
+    *fLayerStack.append() = this->currentLayer();
 
     validate();
     return this->INHERITED::save(flags);
 }
 
+// true if drawing a layer with paint just scales it by the paint's alpha
+static bool only_applies_alpha(const SkPaint* paint) {
+    if (NULL == paint) {
+        return true;
+    }
+    SkXfermode::Mode mode;
+    return SkXfermode::AsMode(paint->getXfermode(), &mode) &&
+           SkXfermode::kSrcOver_Mode == mode &&
+           NULL == paint->getShader() && NULL == paint->getColorFilter() &&
+           NULL == paint->getMaskFilter() && NULL == paint->getLooper() &&
+           NULL == paint->getRasterizer();
+}
+
 int SkPictureRecord::saveLayer(const SkRect* bounds, const SkPaint* paint,
                                SaveFlags flags) {
+    size_t offset = fWriter.size();
     addDraw(SAVE_LAYER);
     addRectPtr(bounds);
     addPaintPtr(paint);
     addInt(flags);
 
     fRestoreOffsetStack.push(0);
+    int parent = this->currentLayer();
+    *fLayerStack.append() = fLayerParents.count();
+    *fLayerParents.append() = parent;
+
+    // an opaque layer starts out with whatever is in its pixels
+    fLayerFold.fActive = SkToBool(flags & kHasAlphaLayer_SaveFlag) &&
+                         only_applies_alpha(paint);
+    if (fLayerFold.fActive) {
+        fLayerFold.fLayerOffset = offset;
+        fLayerFold.fLayerEnd = fWriter.size();
+        fLayerFold.fDrawOffset = 0;
+        fLayerFold.fFlags = flags;
+        fLayerFold.fAlpha = paint ? paint->getAlpha() : 0xFF;
+        fLayerFold.fBounded = NULL != bounds;
+        if (bounds) {
+            SkRect r;
+            this->getTotalMatrix().mapRect(&r, *bounds);
+            r.roundOut(&fLayerFold.fBounds);
+        }
+    }
 
     validate();
     /*  Don't actually call saveLayer, because that will try to allocate an
@@ -69,9 +120,21 @@ void SkPictureRecord::restore() {
     }
     fRestoreOffsetStack.pop();
 
+    if (fLayerFold.fActive) {
+        // no save or clip was made since the saveLayer, so this is its restore
+        fLayerFold.fActive = false;
+        this->foldLayer();
+    }
+
     addDraw(RESTORE);
+    if (fLayerStack.count()) {
+        fLayerStack.pop();
+    }
     validate();
-    return this->INHERITED::restore();
+    this->INHERITED::restore();
+    if (fApproxClipLevel > this->getSaveCount()) {
+        fApproxClipLevel = 0;
+    }
 }
 
 bool SkPictureRecord::translate(SkScalar dx, SkScalar dy) {
@@ -117,6 +180,9 @@ void SkPictureRecord::setMatrix(const SkMatrix& matrix) {
     validate();
     addDraw(SET_MATRIX);
     addMatrix(matrix);
+    // the playback matrix is replaced, so recorded bounds no longer apply
+    fCanIndex = false;
+    fCanEliminate = false;
     validate();
     this->INHERITED::setMatrix(matrix);
 }
@@ -125,6 +191,10 @@ bool SkPictureRecord::clipRect(const SkRect& rect, SkRegion::Op op) {
     addDraw(CLIP_RECT);
     addRect(rect);
     addInt(op);
+    this->checkClipOp(op);
+    if (SkRegion::kIntersect_Op != op) {
+        fClipsAreConvex = false;
+    }
 
     size_t offset = fWriter.size();
     addInt(fRestoreOffsetStack.top());
@@ -134,10 +204,13 @@ bool SkPictureRecord::clipRect(const SkRect& rect, SkRegion::Op op) {
     return this->INHERITED::clipRect(rect, op);
 }
 
-bool SkPictureRecord::clipPath(const SkPath& path, SkRegion::Op op) {
+bool SkPictureRecord::clipPath(const SkPath& path, SkRegion::Op op,
+                               bool doAntiAlias) {
     addDraw(CLIP_PATH);
     addPath(path);
-    addInt(op);
+    addInt(op | (doAntiAlias ? CLIP_PATH_DO_ANTI_ALIAS : 0));
+    this->checkClipOp(op);
+    fClipsAreConvex = false;
 
     size_t offset = fWriter.size();
     addInt(fRestoreOffsetStack.top());
@@ -146,9 +219,12 @@ bool SkPictureRecord::clipPath(const SkPath& path, SkRegion::Op op) {
     validate();
 
     if (fRecordFlags & SkPicture::kUsePathBoundsForClip_RecordingFlag) {
+        if (0 == fApproxClipLevel) {
+            fApproxClipLevel = this->getSaveCount();
+        }
         return this->INHERITED::clipRect(path.getBounds(), op);
     } else {
-        return this->INHERITED::clipPath(path, op);
+        return this->INHERITED::clipPath(path, op, doAntiAlias);
     }
 }
 
@@ -156,6 +232,9 @@ bool SkPictureRecord::clipRegion(const SkRegion& region, SkRegion::Op op) {
     addDraw(CLIP_REGION);
     addRegion(region);
     addInt(op);
+    this->checkClipOp(op);
+    // the region is in device coordinates at playback
+    fCanEliminate = false;
 
     size_t offset = fWriter.size();
     addInt(fRestoreOffsetStack.top());
@@ -168,65 +247,104 @@ bool SkPictureRecord::clipRegion(const SkRegion& region, SkRegion::Op op) {
 void SkPictureRecord::clear(SkColor color) {
     addDraw(DRAW_CLEAR);
     addInt(color);
+    if (fRecordFlags & SkPicture::kEliminateOverdraw_RecordingFlag) {
+        // clear ignores the clip
+        fOps.top().fCoversAll = true;
+    }
     validate();
 }
 
 void SkPictureRecord::drawPaint(const SkPaint& paint) {
     addDraw(DRAW_PAINT);
     addPaint(paint);
+    this->addOpCovers(NULL, &paint, true);
     validate();
 }
 
 void SkPictureRecord::drawPoints(PointMode mode, size_t count, const SkPoint pts[],
                         const SkPaint& paint) {
+    size_t offset = fWriter.size();
     addDraw(DRAW_POINTS);
     addPaint(paint);
     addInt(mode);
     addInt(count);
     fWriter.writeMul4(pts, count * sizeof(SkPoint));
+    if (count > 0) {
+        SkRect bounds;
+        bounds.set(pts, count);
+        // points are drawn as squares or circles of the stroke width,
+        // independent of the paint's style
+        SkScalar radius = SkScalarHalf(paint.getStrokeWidth());
+        bounds.inset(-radius, -radius);
+        this->addOpBounds(offset, bounds, &paint);
+    }
     validate();
 }
 
 void SkPictureRecord::drawRect(const SkRect& rect, const SkPaint& paint) {
+    size_t offset = fWriter.size();
     addDraw(DRAW_RECT);
     addPaint(paint);
     addRect(rect);
+    this->addOpBounds(offset, rect, &paint);
+    this->addOpCovers(&rect, &paint, true);
     validate();
 }
 
 void SkPictureRecord::drawPath(const SkPath& path, const SkPaint& paint) {
+    size_t offset = fWriter.size();
     addDraw(DRAW_PATH);
     addPaint(paint);
     addPath(path);
+    if (!path.isInverseFillType()) {
+        this->addOpBounds(offset, path.getBounds(), &paint);
+    }
     validate();
 }
 
 void SkPictureRecord::drawBitmap(const SkBitmap& bitmap, SkScalar left, SkScalar top,
                         const SkPaint* paint = NULL) {
+    size_t offset = fWriter.size();
     addDraw(DRAW_BITMAP);
     addPaintPtr(paint);
     addBitmap(bitmap);
     addScalar(left);
     addScalar(top);
+    SkRect bounds;
+    bounds.set(left, top, left + SkIntToScalar(bitmap.width()),
+               top + SkIntToScalar(bitmap.height()));
+    this->addOpBounds(offset, bounds, paint);
+    this->addOpCovers(&bounds, paint, bitmap.isOpaque());
     validate();
 }
 
 void SkPictureRecord::drawBitmapRect(const SkBitmap& bitmap, const SkIRect* src,
                             const SkRect& dst, const SkPaint* paint) {
+    size_t offset = fWriter.size();
     addDraw(DRAW_BITMAP_RECT);
     addPaintPtr(paint);
     addBitmap(bitmap);
     addIRectPtr(src);  // may be null
     addRect(dst);
+    this->addOpBounds(offset, dst, paint);
+    this->addOpCovers(&dst, paint, bitmap.isOpaque());
     validate();
 }
 
 void SkPictureRecord::drawBitmapMatrix(const SkBitmap& bitmap, const SkMatrix& matrix,
                               const SkPaint* paint) {
+    size_t offset = fWriter.size();
     addDraw(DRAW_BITMAP_MATRIX);
     addPaintPtr(paint);
     addBitmap(bitmap);
     addMatrix(matrix);
+    if (!matrix.hasPerspective()) {
+        SkRect bounds;
+        bounds.set(0, 0, SkIntToScalar(bitmap.width()),
+                   SkIntToScalar(bitmap.height()));
+        matrix.mapRect(&bounds);
+        this->addOpBounds(offset, bounds, paint);
+    }
     validate();
 }
 
@@ -259,6 +377,7 @@ void SkPictureRecord::drawText(const void* text, size_t byteLength, SkScalar x,
                       SkScalar y, const SkPaint& paint) {
     bool fast = paint.canComputeFastBounds();
 
+    size_t offset = fWriter.size();
     addDraw(fast ? DRAW_TEXT_TOP_BOTTOM : DRAW_TEXT);
     addPaint(paint);
     addText(text, byteLength);
@@ -266,6 +385,11 @@ void SkPictureRecord::drawText(const void* text, size_t byteLength, SkScalar x,
     addScalar(y);
     if (fast) {
         addFontMetricsTopBottom(paint, y);
+        // the text is somewhere within its advance of x, whatever the align
+        SkScalar width = paint.measureText(text, byteLength);
+        SkRect bounds;
+        bounds.set(x - width, y, x + width, y);
+        this->addTextOpBounds(offset, bounds, paint);
     }
     validate();
 }
@@ -290,6 +414,7 @@ void SkPictureRecord::drawPosText(const void* text, size_t byteLength,
 
     bool fast = canUseDrawH && paint.canComputeFastBounds();
 
+    size_t offset = fWriter.size();
     if (fast) {
         addDraw(DRAW_POS_TEXT_H_TOP_BOTTOM);
     } else {
@@ -318,9 +443,21 @@ void SkPictureRecord::drawPosText(const void* text, size_t byteLength,
     fPointBytes += fWriter.size() - start;
     fPointWrites += points;
 #endif
+    if (paint.canComputeFastBounds()) {
+        SkRect bounds;
+        bounds.set(pos, points);
+        this->addTextOpBounds(offset, bounds, paint);
+    }
     validate();
 }
 
+void SkPictureRecord::drawTextBlob(const SkTextBlob* blob, SkScalar x,
+                                   SkScalar y, const SkPaint& paint) {
+    // recorded as glyph IDs and positions, so playback needs no text
+    // conversion either (and picks drawPosTextH when the run is horizontal)
+    blob->drawAsPosText(this, x, y, paint);
+}
+
 void SkPictureRecord::drawPosTextH(const void* text, size_t byteLength,
                           const SkScalar xpos[], SkScalar constY,
                           const SkPaint& paint) {
@@ -330,6 +467,7 @@ void SkPictureRecord::drawPosTextH(const void* text, size_t byteLength,
 
     bool fast = paint.canComputeFastBounds();
 
+    size_t offset = fWriter.size();
     addDraw(fast ? DRAW_POS_TEXT_H_TOP_BOTTOM : DRAW_POS_TEXT_H);
     addPaint(paint);
     addText(text, byteLength);
@@ -347,6 +485,14 @@ void SkPictureRecord::drawPosTextH(const void* text, size_t byteLength,
     fPointBytes += fWriter.size() - start;
     fPointWrites += points;
 #endif
+    if (fast) {
+        SkRect bounds;
+        bounds.set(xpos[0], constY, xpos[0], constY);
+        for (size_t index = 1; index < points; index++) {
+            bounds.growToInclude(xpos[index], constY);
+        }
+        this->addTextOpBounds(offset, bounds, paint);
+    }
     validate();
 }
 
@@ -362,6 +508,20 @@ void SkPictureRecord::drawTextOnPath(const void* text, size_t byteLength,
 }
 
 void SkPictureRecord::drawPicture(SkPicture& picture) {
+    if ((fRecordFlags & SkPicture::kInlineSmallPictures_RecordingFlag) &&
+            NULL == picture.fRecord) {
+        SkPicturePlayback* playback = picture.fPlayback;
+        if (NULL == playback) {
+            return;     // it draws nothing
+        }
+        if (playback->opsSize() <= MAX_INLINE_OPS_SIZE) {
+            // the same save and restore as SkCanvas::drawPicture()
+            int saveCount = this->save(kMatrixClip_SaveFlag);
+            playback->drawUnculled(*this);
+            this->restoreToCount(saveCount);
+            return;
+        }
+    }
     addDraw(DRAW_PICTURE);
     addPicture(picture);
     validate();
@@ -383,6 +543,7 @@ void SkPictureRecord::drawVertices(VertexMode vmode, int vertexCount,
         flags |= DRAW_VERTICES_HAS_INDICES;
     }
 
+    size_t offset = fWriter.size();
     addDraw(DRAW_VERTICES);
     addPaint(paint);
     addInt(flags);
@@ -399,6 +560,11 @@ void SkPictureRecord::drawVertices(VertexMode vmode, int vertexCount,
         addInt(indexCount);
         fWriter.writePad(indices, indexCount * sizeof(uint16_t));
     }
+    if (vertexCount > 0) {
+        SkRect bounds;
+        bounds.set(vertices, vertexCount);
+        this->addOpBounds(offset, bounds, &paint);
+    }
 }
 
 void SkPictureRecord::drawData(const void* data, size_t length) {
@@ -414,10 +580,15 @@ void SkPictureRecord::reset() {
     fPathHeap = NULL;
 
     fBitmaps.reset();
+    fBitmapDictionary.reset();
     fMatrices.reset();
+    fMatrixDictionary.reset();
     fPaints.reset();
+    fPaintDictionary.reset();
     fPictureRefs.unrefAll();
     fRegions.reset();
+    fRegionDictionary.reset();
+    fBitmapIndex = fMatrixIndex = fPaintIndex = fRegionIndex = 1;
     fWriter.reset();
     fHeap.reset();
 
@@ -426,6 +597,553 @@ void SkPictureRecord::reset() {
 
     fRCSet.reset();
     fTFSet.reset();
+
+    fOpBounds.reset();
+    fOpBoundsPending = false;
+    fCanIndex = true;
+
+    fOps.reset();
+    fLayerStack.reset();
+    fLayerParents.setCount(1);
+    fApproxClipLevel = 0;
+    fCanEliminate = true;
+    fClipsAreConvex = true;
+    fLayerFold.fActive = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Coordinates beyond this are not worth indexing (and would overflow when
+// converted to integers), so such ops are treated as unbounded.
+#define MAX_INDEXED_COORD   SkIntToScalar(1 << 28)
+
+void SkPictureRecord::addOpBounds(size_t offset, const SkRect& bounds,
+                                  const SkPaint* paint) {
+    const SkRect* r = &bounds;
+    SkRect storage;
+    if (paint) {
+        if (!paint->canComputeFastBounds()) {
+            return;
+        }
+        r = &paint->computeFastBounds(bounds, &storage);
+    }
+
+    const SkMatrix& matrix = this->getTotalMatrix();
+    if (matrix.hasPerspective()) {
+        return;
+    }
+    SkRect dev;
+    matrix.mapRect(&dev, *r);
+    if (!(dev.fLeft > -MAX_INDEXED_COORD && dev.fTop > -MAX_INDEXED_COORD &&
+          dev.fRight < MAX_INDEXED_COORD && dev.fBottom < MAX_INDEXED_COORD)) {
+        return; // also catches NaNs
+    }
+
+    SkIRect ibounds;
+    dev.roundOut(&ibounds);
+    // allow for antialiasing
+    ibounds.inset(-1, -1);
+    this->addOpDeviceBounds(offset, ibounds);
+}
+
+void SkPictureRecord::addTextOpBounds(size_t offset, const SkRect& bounds,
+                                      const SkPaint& paint) {
+    SkPaint::FontMetrics metrics;
+    paint.getFontMetrics(&metrics);
+    // Outset horizontally by the full height of the font as well, to allow
+    // for glyph overhang, skew and fake-bold.
+    SkScalar pad = metrics.fBottom - metrics.fTop;
+    SkRect r;
+    r.set(bounds.fLeft - pad, bounds.fTop + metrics.fTop,
+          bounds.fRight + pad, bounds.fBottom + metrics.fBottom);
+    this->addOpBounds(offset, r, &paint);
+}
+
+void SkPictureRecord::addOpDeviceBounds(size_t offset,
+                                        const SkIRect& bounds) {
+    SkASSERT(!fOpBoundsPending);
+    SkPictureIndex::Op* op = fOpBounds.append();
+    op->fOffset = offset;
+    op->fSize = 0;
+    op->fBounds = bounds;
+    fOpBoundsPending = true;
+
+    if (fRecordFlags & SkPicture::kEliminateOverdraw_RecordingFlag) {
+        OpRecord& rec = fOps.top();
+        SkASSERT(rec.fOffset == offset);
+        if (!rec.fBounded) {
+            rec.fExtent = bounds;
+            rec.fBounded = true;
+        } else if (!rec.fExtent.intersect(bounds)) {
+            rec.fExtent.setEmpty();
+        }
+    }
+}
+
+void SkPictureRecord::closeOpBounds() {
+    SkASSERT(fOpBoundsPending);
+    SkPictureIndex::Op& op = fOpBounds.top();
+    op.fSize = fWriter.size() - op.fOffset;
+    fOpBoundsPending = false;
+}
+
+void* SkPictureRecord::detachOps() {
+    if (fOpBoundsPending) {
+        // this needs the size of the stream, which is 0 once it is detached
+        this->closeOpBounds();
+    }
+    return fWriter.detachContiguousArray();
+}
+
+SkPictureIndex* SkPictureRecord::createIndex() const {
+    if (!fCanIndex || fOpBounds.isEmpty()) {
+        return NULL;
+    }
+    if (fOpBoundsPending) {
+        // the last op runs to the end of the stream
+        const_cast<SkPictureRecord*>(this)->closeOpBounds();
+    }
+    const SkDevice* device = this->getDevice();
+    return SkNEW_ARGS(SkPictureIndex, (fOpBounds, device->width(),
+                                       device->height()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// more than this many covering ops are not worth comparing every op against
+#define MAX_COVERING_OPS    16
+
+// true if pixels drawn with paint do not depend on what was there before
+static bool overwrites(const SkPaint& paint, bool srcIsOpaque) {
+    if (paint.getPathEffect() || paint.getMaskFilter() ||
+            paint.getRasterizer() || paint.getLooper()) {
+        return false;   // the paint changes the geometry
+    }
+    SkXfermode::Mode mode;
+    if (!SkXfermode::AsMode(paint.getXfermode(), &mode)) {
+        return false;
+    }
+    switch (mode) {
+        case SkXfermode::kClear_Mode:
+        case SkXfermode::kSrc_Mode:
+            return true;
+        case SkXfermode::kSrcOver_Mode:
+            return srcIsOpaque && 0xFF == paint.getAlpha() &&
+                   NULL == paint.getShader() && NULL == paint.getColorFilter();
+        default:
+            return false;
+    }
+}
+
+static bool is_drawing_op(DrawType type) {
+    switch (type) {
+        case DRAW_BITMAP:
+        case DRAW_BITMAP_MATRIX:
+        case DRAW_BITMAP_RECT:
+        case DRAW_CLEAR:
+        case DRAW_PAINT:
+        case DRAW_PATH:
+        case DRAW_PICTURE:
+        case DRAW_POINTS:
+        case DRAW_POS_TEXT:
+        case DRAW_POS_TEXT_H:
+        case DRAW_POS_TEXT_H_TOP_BOTTOM:
+        case DRAW_RECT:
+        case DRAW_SPRITE:
+        case DRAW_TEXT:
+        case DRAW_TEXT_ON_PATH:
+        case DRAW_TEXT_TOP_BOTTOM:
+        case DRAW_VERTICES:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_clip_op(DrawType type) {
+    return CLIP_PATH == type || CLIP_REGION == type || CLIP_RECT == type;
+}
+
+void SkPictureRecord::addOpRecord(DrawType drawType) {
+    OpRecord* op = fOps.append();
+    op->fOffset = fWriter.size();
+    op->fType = drawType;
+    op->fLayer = this->currentLayer();
+    op->fCovers.setEmpty();
+    op->fCoversAll = false;
+    op->fDead = false;
+
+    // The recording canvas cuts the clip off at the picture's edges, but the
+    // playback canvas does not. If the clip's bounds stay clear of the edges
+    // it was not cut, and the op cannot draw outside of them.
+    const SkIRect& clip = this->getTotalClip().getBounds();
+    const SkDevice* device = this->getDevice();
+    op->fBounded = fClipsAreConvex && clip.fLeft > 0 && clip.fTop > 0 &&
+                   clip.fRight < device->width() &&
+                   clip.fBottom < device->height();
+    if (op->fBounded) {
+        op->fExtent = clip;
+    } else {
+        op->fExtent.setEmpty();
+    }
+}
+
+void SkPictureRecord::addOpCovers(const SkRect* rect, const SkPaint* paint,
+                                  bool srcIsOpaque) {
+    if (!(fRecordFlags & SkPicture::kEliminateOverdraw_RecordingFlag) ||
+            fApproxClipLevel) {
+        return;
+    }
+    const SkRegion& clip = this->getTotalClip();
+    if (!clip.isRect()) {
+        return;
+    }
+    SkPaint defaultPaint;
+    if (NULL == paint) {
+        paint = &defaultPaint;
+    }
+    if (SkPaint::kFill_Style != paint->getStyle() ||
+            !overwrites(*paint, srcIsOpaque)) {
+        return;
+    }
+
+    SkIRect covers = clip.getBounds();
+    if (rect) {
+        const SkMatrix& matrix = this->getTotalMatrix();
+        if (!matrix.rectStaysRect()) {
+            return;
+        }
+        SkRect dev, clipR;
+        matrix.mapRect(&dev, *rect);
+        clipR.set(covers);
+        if (!dev.intersect(clipR)) {
+            return; // also catches NaNs
+        }
+        // just the pixels that are entirely inside
+        covers.set(SkScalarCeil(dev.fLeft), SkScalarCeil(dev.fTop),
+                   SkScalarFloor(dev.fRight), SkScalarFloor(dev.fBottom));
+    }
+    // leave room for the covered op's antialiasing, and for the covering
+    // op's edges at other scales
+    covers.inset(1, 1);
+    if (!covers.isEmpty()) {
+        fOps.top().fCovers = covers;
+    }
+}
+
+void SkPictureRecord::endRecording() {
+    if (!(fRecordFlags & SkPicture::kEliminateOverdraw_RecordingFlag) ||
+            fOps.isEmpty()) {
+        return;
+    }
+    if (fOpBoundsPending) {
+        this->closeOpBounds();
+    }
+    if (fCanEliminate) {
+        this->eliminateOverdraw();
+    }
+    this->removeEmptySaves();
+    this->removeDeadOps();
+}
+
+/*  An op is dead if a later op that draws into the same layer (or into one
+    that the op's layer is drawn into) overwrites every pixel it can touch.
+    Walk backwards, comparing each op against the covering ops seen so far.
+ */
+void SkPictureRecord::eliminateOverdraw() {
+    SkTDArray<const OpRecord*> covering;
+    for (int i = fOps.count() - 1; i >= 0; --i) {
+        OpRecord& op = fOps[i];
+        if (!is_drawing_op(op.fType)) {
+            continue;
+        }
+        for (int j = 0; j < covering.count(); j++) {
+            const OpRecord& cover = *covering[j];
+            if (!cover.fCoversAll && !(op.fBounded &&
+                    !op.fExtent.isEmpty() && cover.fCovers.contains(op.fExtent))) {
+                continue;
+            }
+            int layer = op.fLayer;
+            while (layer > cover.fLayer) {
+                layer = fLayerParents[layer];
+            }
+            if (layer == cover.fLayer) {
+                op.fDead = true;
+                break;
+            }
+        }
+        if (op.fDead || (!op.fCoversAll && op.fCovers.isEmpty())) {
+            continue;
+        }
+        if (covering.count() < MAX_COVERING_OPS) {
+            *covering.append() = &op;
+        } else if (!op.fCoversAll) {
+            // make room by forgetting the smallest
+            int smallest = -1;
+            int64_t area = (int64_t)op.fCovers.width() * op.fCovers.height();
+            for (int j = 0; j < covering.count(); j++) {
+                const OpRecord& cover = *covering[j];
+                int64_t a = (int64_t)cover.fCovers.width() *
+                            cover.fCovers.height();
+                if (!cover.fCoversAll && a < area) {
+                    smallest = j;
+                    area = a;
+                }
+            }
+            if (smallest >= 0) {
+                covering[smallest] = &op;
+            }
+        }
+    }
+}
+
+// Mark the ops from a save to its restore dead if none of them draw.
+void SkPictureRecord::removeEmptySaves() {
+    SkTDArray<int> saves;       // op index of each open save
+    SkTDArray<bool> drew;       // whether anything was drawn inside it
+    for (int i = 0; i < fOps.count(); i++) {
+        const OpRecord& op = fOps[i];
+        if (op.fDead) {
+            continue;
+        }
+        switch (op.fType) {
+            case SAVE:
+            case SAVE_LAYER:
+                *saves.append() = i;
+                // a layer is drawn when it is restored, even if it is empty
+                *drew.append() = SAVE_LAYER == op.fType;
+                break;
+            case RESTORE:
+                if (saves.count()) {
+                    int save = saves.top();
+                    bool didDraw = drew.top();
+                    saves.pop();
+                    drew.pop();
+                    if (!didDraw) {
+                        for (int j = save; j <= i; j++) {
+                            fOps[j].fDead = true;
+                        }
+                    } else if (drew.count()) {
+                        drew.top() = true;
+                    }
+                }
+                break;
+            case CONCAT:
+            case ROTATE:
+            case SCALE:
+            case SET_MATRIX:
+            case SKEW:
+            case TRANSLATE:
+                break;
+            default:
+                if (!is_clip_op(op.fType) && drew.count()) {
+                    drew.top() = true;
+                }
+                break;
+        }
+    }
+}
+
+// Rewrite the op stream without the dead ops, and fix up the offsets into it.
+void SkPictureRecord::removeDeadOps() {
+    const int count = fOps.count();
+    const uint32_t oldSize = fWriter.size();
+
+    // the new offset of each op, and of the end
+    SkTDArray<uint32_t> newOffsets;
+    newOffsets.setCount(count + 1);
+    uint32_t newSize = 0;
+    for (int i = 0; i < count; i++) {
+        newOffsets[i] = newSize;
+        if (!fOps[i].fDead) {
+            uint32_t end = i + 1 < count ? fOps[i + 1].fOffset : oldSize;
+            newSize += end - fOps[i].fOffset;
+        }
+    }
+    newOffsets[count] = newSize;
+    if (newSize == oldSize) {
+        return;
+    }
+
+    SkAutoMalloc storage(oldSize);
+    char* old = (char*)storage.get();
+    fWriter.flatten(old);
+    fWriter.reset();
+    for (int i = 0; i < count; i++) {
+        if (!fOps[i].fDead) {
+            uint32_t end = i + 1 < count ? fOps[i + 1].fOffset : oldSize;
+            fWriter.write(old + fOps[i].fOffset, end - fOps[i].fOffset);
+        }
+    }
+
+    // offsets point at the start of an op, or into one (the restore offset
+    // of a clip that is waiting for its restore), or are 0 for none
+    SkTDArray<uint32_t> oldOffsets;
+    for (int i = 0; i < count; i++) {
+        *oldOffsets.append() = fOps[i].fOffset;
+    }
+    struct Remapper {
+        const SkTDArray<uint32_t>& fOld;
+        const uint32_t* fNew;
+        uint32_t map(uint32_t offset) const {
+            if (0 == offset) {
+                return 0;
+            }
+            int index = SkTSearch<uint32_t>(fOld.begin(), fOld.count(),
+                                            offset, sizeof(uint32_t));
+            if (index < 0) {
+                index = ~index - 1;  // the op that offset is inside of
+            }
+            return fNew[index] + offset - fOld[index];
+        }
+    } remapper = { oldOffsets, newOffsets.begin() };
+
+    for (int i = 0; i < count; i++) {
+        if (!fOps[i].fDead && is_clip_op(fOps[i].fType)) {
+            // the restore offset is the clip op's last word
+            uint32_t end = i + 1 < count ? fOps[i + 1].fOffset : oldSize;
+            uint32_t* slot = fWriter.peek32(newOffsets[i + 1] - sizeof(uint32_t));
+            *slot = remapper.map(*(uint32_t*)(old + end - sizeof(uint32_t)));
+        }
+    }
+    for (int i = 0; i < fRestoreOffsetStack.count(); i++) {
+        fRestoreOffsetStack[i] = remapper.map(fRestoreOffsetStack[i]);
+    }
+
+    int live = 0;
+    for (int i = 0; i < fOpBounds.count(); i++) {
+        SkPictureIndex::Op op = fOpBounds[i];
+        int index = SkTSearch<uint32_t>(oldOffsets.begin(), oldOffsets.count(),
+                                        op.fOffset, sizeof(uint32_t));
+        SkASSERT(index >= 0);
+        if (!fOps[index].fDead) {
+            op.fOffset = newOffsets[index];
+            fOpBounds[live++] = op;
+        }
+    }
+    fOpBounds.setCount(live);
+
+    live = 0;
+    for (int i = 0; i < count; i++) {
+        if (!fOps[i].fDead) {
+            OpRecord op = fOps[i];
+            op.fOffset = newOffsets[i];
+            fOps[live++] = op;
+        }
+    }
+    fOps.setCount(live);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkPictureRecord::checkLayerFold(DrawType drawType) {
+    switch (drawType) {
+        case CONCAT:
+        case ROTATE:
+        case SCALE:
+        case SET_MATRIX:
+        case SKEW:
+        case TRANSLATE:
+            return;
+        // these draw each pixel once (unlike text or points, say, which can
+        // overlap themselves), so drawing with less alpha is the same as
+        // drawing into a layer and then blending that with the alpha
+        case DRAW_BITMAP:
+        case DRAW_BITMAP_MATRIX:
+        case DRAW_BITMAP_RECT:
+        case DRAW_PAINT:
+        case DRAW_PATH:
+        case DRAW_RECT:
+        case DRAW_SPRITE:
+            if (0 == fLayerFold.fDrawOffset) {
+                fLayerFold.fDrawOffset = fWriter.size();
+                fLayerFold.fHasPaint = false;
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    fLayerFold.fActive = false;
+}
+
+// true if drawing with paint blends each pixel it draws with src-over, so
+// that scaling the paint's alpha scales what it draws
+static bool can_take_alpha(const SkPaint& paint) {
+    SkXfermode::Mode mode;
+    if (!SkXfermode::AsMode(paint.getXfermode(), &mode) ||
+            SkXfermode::kSrcOver_Mode != mode) {
+        return false;
+    }
+    if (paint.getColorFilter() || paint.getLooper()) {
+        return false;
+    }
+    // hairlines are drawn a segment at a time, and can overlap themselves
+    return SkPaint::kFill_Style == paint.getStyle() ||
+           paint.getStrokeWidth() > 0;
+}
+
+bool SkPictureRecord::foldLayer() {
+    const LayerFold& fold = fLayerFold;
+    if (fold.fDrawOffset) {
+        if (fold.fHasPaint && !can_take_alpha(fold.fPaint)) {
+            return false;
+        }
+        // the layer's bounds clip the draw, so it must be inside of them
+        if (fold.fBounded && (fOpBounds.isEmpty() ||
+                fOpBounds.top().fOffset != fold.fDrawOffset ||
+                !fold.fBounds.contains(fOpBounds.top().fBounds))) {
+            return false;
+        }
+    }
+
+    // rewrite the SAVE_LAYER as a SAVE, and move the ops after it up
+    const uint32_t delta = fold.fLayerEnd - fold.fLayerOffset -
+                           2 * sizeof(uint32_t);
+    const uint32_t tailSize = fWriter.size() - fold.fLayerEnd;
+    SkAutoSTMalloc<32, uint32_t> storage(tailSize >> 2);
+    uint32_t* tail = storage.get();
+    for (uint32_t i = 0; i < tailSize; i += sizeof(uint32_t)) {
+        tail[i >> 2] = *fWriter.peek32(fold.fLayerEnd + i);
+    }
+    if (fold.fDrawOffset && 0xFF != fold.fAlpha) {
+        SkPaint paint;
+        if (fold.fHasPaint) {
+            paint = fold.fPaint;
+        }
+        paint.setAlpha(SkMulDiv255Round(paint.getAlpha(), fold.fAlpha));
+        // the paint's index follows the draw's type
+        tail[((fold.fDrawOffset - fold.fLayerEnd) >> 2) + 1] =
+                find(fPaints, &paint);
+    }
+    fWriter.rewindToOffset(fold.fLayerOffset);
+    fWriter.writeInt(SAVE);
+    fWriter.writeInt(fold.fFlags & kMatrixClip_SaveFlag);
+    fWriter.write(tail, tailSize);
+
+    if (fold.fDrawOffset && fOpBounds.count() &&
+            fOpBounds.top().fOffset == fold.fDrawOffset) {
+        fOpBounds.top().fOffset -= delta;
+    }
+
+    // the ops drew into the layer, and now draw into its parent
+    int parent = fLayerParents[fLayerStack.top()];
+    fLayerStack.top() = parent;
+    if (fRecordFlags & SkPicture::kEliminateOverdraw_RecordingFlag) {
+        for (int i = fOps.count() - 1; i >= 0; --i) {
+            OpRecord& op = fOps[i];
+            if (op.fOffset == fold.fLayerOffset) {
+                op.fType = SAVE;
+                break;
+            }
+            op.fOffset -= delta;
+            op.fLayer = parent;
+            if (0xFF != fold.fAlpha) {
+                op.fCovers.setEmpty();  // with less alpha, it covers nothing
+            }
+        }
+    }
+    return true;
 }
 
 void SkPictureRecord::addBitmap(const SkBitmap& bitmap) {
@@ -445,6 +1163,14 @@ void SkPictureRecord::addPaint(const SkPaint& paint) {
 }
 
 void SkPictureRecord::addPaintPtr(const SkPaint* paint) {
+    // every draw that a layer can be folded into writes its paint first
+    if (fLayerFold.fActive && fLayerFold.fDrawOffset &&
+            fWriter.size() == fLayerFold.fDrawOffset + sizeof(uint32_t)) {
+        fLayerFold.fHasPaint = NULL != paint;
+        if (paint) {
+            fLayerFold.fPaint = *paint;
+        }
+    }
     addInt(find(fPaints, paint));
 }
 
@@ -529,14 +1255,12 @@ void SkPictureRecord::addText(const void* text, size_t byteLength) {
 int SkPictureRecord::find(SkTDArray<const SkFlatBitmap* >& bitmaps, const SkBitmap& bitmap) {
     SkFlatBitmap* flat = SkFlatBitmap::Flatten(&fHeap, bitmap, fBitmapIndex,
                                                &fRCSet);
-    int index = SkTSearch<SkFlatData>((const SkFlatData**) bitmaps.begin(),
-        bitmaps.count(), (SkFlatData*) flat, sizeof(flat), &SkFlatData::Compare);
-    if (index >= 0) {
+    const SkFlatData* found = fBitmapDictionary.findOrAdd(flat);
+    if (found != flat) {
         (void)fHeap.unalloc(flat);
-        return bitmaps[index]->index();
+        return found->index();
     }
-    index = ~index;
-    *bitmaps.insert(index) = flat;
+    *bitmaps.append() = flat;
     return fBitmapIndex++;
 }
 
@@ -544,14 +1268,12 @@ int SkPictureRecord::find(SkTDArray<const SkFlatMatrix* >& matrices, const SkMat
     if (matrix == NULL)
         return 0;
     SkFlatMatrix* flat = SkFlatMatrix::Flatten(&fHeap, *matrix, fMatrixIndex);
-    int index = SkTSearch<SkFlatData>((const SkFlatData**) matrices.begin(),
-        matrices.count(), (SkFlatData*) flat, sizeof(flat), &SkFlatData::Compare);
-    if (index >= 0) {
+    const SkFlatData* found = fMatrixDictionary.findOrAdd(flat);
+    if (found != flat) {
         (void)fHeap.unalloc(flat);
-        return matrices[index]->index();
+        return found->index();
     }
-    index = ~index;
-    *matrices.insert(index) = flat;
+    *matrices.append() = flat;
     return fMatrixIndex++;
 }
 
@@ -562,28 +1284,23 @@ int SkPictureRecord::find(SkTDArray<const SkFlatPaint* >& paints, const SkPaint*
 
     SkFlatPaint* flat = SkFlatPaint::Flatten(&fHeap, *paint, fPaintIndex,
                                              &fRCSet, &fTFSet);
-    int index = SkTSearch<SkFlatData>((const SkFlatData**) paints.begin(),
-        paints.count(), (SkFlatData*) flat, sizeof(flat), &SkFlatData::Compare);
-    if (index >= 0) {
+    const SkFlatData* found = fPaintDictionary.findOrAdd(flat);
+    if (found != flat) {
         (void)fHeap.unalloc(flat);
-        return paints[index]->index();
+        return found->index();
     }
-
-    index = ~index;
-    *paints.insert(index) = flat;
+    *paints.append() = flat;
     return fPaintIndex++;
 }
 
 int SkPictureRecord::find(SkTDArray<const SkFlatRegion* >& regions, const SkRegion& region) {
     SkFlatRegion* flat = SkFlatRegion::Flatten(&fHeap, region, fRegionIndex);
-    int index = SkTSearch<SkFlatData>((const SkFlatData**) regions.begin(),
-        regions.count(), (SkFlatData*) flat, sizeof(flat), &SkFlatData::Compare);
-    if (index >= 0) {
+    const SkFlatData* found = fRegionDictionary.findOrAdd(flat);
+    if (found != flat) {
         (void)fHeap.unalloc(flat);
-        return regions[index]->index();
+        return found->index();
     }
-    index = ~index;
-    *regions.insert(index) = flat;
+    *regions.append() = flat;
     return fRegionIndex++;
 }
 
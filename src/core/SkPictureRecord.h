@@ -6,6 +6,7 @@
 #include "SkPathHeap.h"
 #include "SkPicture.h"
 #include "SkPictureFlat.h"
+#include "SkPictureIndex.h"
 #include "SkTemplates.h"
 #include "SkWriter32.h"
 
@@ -25,7 +26,8 @@ public:
     virtual bool concat(const SkMatrix& matrix);
     virtual void setMatrix(const SkMatrix& matrix);
     virtual bool clipRect(const SkRect& rect, SkRegion::Op op);
-    virtual bool clipPath(const SkPath& path, SkRegion::Op op);
+    virtual bool clipPath(const SkPath& path, SkRegion::Op op,
+                          bool doAntiAlias);
     virtual bool clipRegion(const SkRegion& region, SkRegion::Op op);
     virtual void clear(SkColor);
     virtual void drawPaint(const SkPaint& paint);
@@ -47,6 +49,8 @@ public:
                              const SkPoint pos[], const SkPaint&);
     virtual void drawPosTextH(const void* text, size_t byteLength,
                       const SkScalar xpos[], SkScalar constY, const SkPaint&);
+    virtual void drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                      const SkPaint&);
     virtual void drawTextOnPath(const void* text, size_t byteLength, 
                             const SkPath& path, const SkMatrix* matrix, 
                                 const SkPaint&);
@@ -75,6 +79,17 @@ public:
     const SkTDArray<const SkFlatRegion* >& getRegions() const {
         return fRegions;
     }
+
+    /** Return the spatial index for the recorded draw ops, or NULL if the
+        recording cannot be indexed (e.g. it calls setMatrix, or uses clip ops
+        that can expand the clip). The caller must unref() the result.
+     */
+    SkPictureIndex* createIndex() const;
+
+    /** Called by SkPicture once recording is finished, to run the passes
+        that need the whole recording (see kEliminateOverdraw_RecordingFlag).
+     */
+    void endRecording();
     
     void reset();
 
@@ -82,6 +97,11 @@ public:
         return fWriter;
     }
 
+    /** If the ops are all in one block, returns it for the caller to sk_free,
+        and leaves the record without them. Otherwise returns NULL.
+     */
+    void* detachOps();
+
 private:
     SkTDArray<uint32_t> fRestoreOffsetStack;
 
@@ -89,6 +109,15 @@ private:
 #ifdef SK_DEBUG_TRACE
         SkDebugf("add %s\n", DrawTypeToString(drawType));
 #endif
+        if (fOpBoundsPending) {
+            this->closeOpBounds();
+        }
+        if (fRecordFlags & SkPicture::kEliminateOverdraw_RecordingFlag) {
+            this->addOpRecord(drawType);
+        }
+        if (fLayerFold.fActive) {
+            this->checkLayerFold(drawType);
+        }
         fWriter.writeInt(drawType);
     }    
     void addInt(int value) {
@@ -113,6 +142,67 @@ private:
     void addRegion(const SkRegion& region);
     void addText(const void* text, size_t byteLength);
 
+    // Record the bounds of the draw op that starts at offset. The bounds are
+    // in local coordinates, and are adjusted for the paint (if any) and
+    // mapped by the current matrix. Ops without recorded bounds are treated
+    // as covering everything.
+    void addOpBounds(size_t offset, const SkRect& bounds, const SkPaint* paint);
+    void addOpDeviceBounds(size_t offset, const SkIRect& bounds);
+    void addTextOpBounds(size_t offset, const SkRect& bounds,
+                         const SkPaint& paint);
+    void closeOpBounds();
+
+    // What the overdraw pass needs to know about each op. The extent and the
+    // covered pixels are in picture coordinates.
+    struct OpRecord {
+        uint32_t    fOffset;
+        DrawType    fType;
+        int         fLayer;     // the saveLayer the op draws into, 0 if none
+        SkIRect     fExtent;    // every pixel it may touch, if fBounded
+        SkIRect     fCovers;    // pixels it overwrites, whatever was there
+        bool        fBounded;
+        bool        fCoversAll; // e.g. clear()
+        bool        fDead;
+    };
+    void addOpRecord(DrawType drawType);
+    // Note that the op being recorded fills rect (or the whole clip if rect
+    // is NULL) with paint (which may be NULL), from a source that is opaque
+    // if srcIsOpaque.
+    void addOpCovers(const SkRect* rect, const SkPaint* paint,
+                     bool srcIsOpaque);
+    int currentLayer() const {
+        return fLayerStack.count() ? fLayerStack.top() : 0;
+    }
+    void eliminateOverdraw();
+    void removeEmptySaves();
+    void removeDeadOps();
+
+    /*  A saveLayer whose paint only applies its alpha, and which holds no
+        more than one draw (and maybe some matrix ops), can be recorded as a
+        save instead, with the draw's paint taking the alpha. checkLayerFold()
+        follows the ops after the saveLayer, and foldLayer() rewrites them at
+        the restore.
+     */
+    struct LayerFold {
+        bool        fActive;        // false once the layer cannot be folded
+        uint32_t    fLayerOffset;   // the SAVE_LAYER op
+        uint32_t    fLayerEnd;      // the op after it
+        uint32_t    fDrawOffset;    // the draw op, or 0 if none yet
+        SaveFlags   fFlags;
+        U8CPU       fAlpha;
+        bool        fBounded;       // if so, the draw must be inside fBounds
+        SkIRect     fBounds;        // the layer's bounds on the device
+        bool        fHasPaint;
+        SkPaint     fPaint;         // the draw's paint, if fHasPaint
+    };
+    void checkLayerFold(DrawType drawType);
+    bool foldLayer();
+    void checkClipOp(SkRegion::Op op) {
+        if (SkRegion::kIntersect_Op != op && SkRegion::kDifference_Op != op) {
+            fCanIndex = false;
+        }
+    }
+
     int find(SkTDArray<const SkFlatBitmap* >& bitmaps,
                    const SkBitmap& bitmap);
     int find(SkTDArray<const SkFlatMatrix* >& matrices,
@@ -156,14 +246,20 @@ public:
 
 private:
     SkChunkAlloc fHeap;
+    // the arrays are in the order the entries were added, and the
+    // dictionaries find an entry's duplicate, if it has one
     int fBitmapIndex;
     SkTDArray<const SkFlatBitmap* > fBitmaps;
+    SkFlatDictionary fBitmapDictionary;
     int fMatrixIndex;
     SkTDArray<const SkFlatMatrix* > fMatrices;
+    SkFlatDictionary fMatrixDictionary;
     int fPaintIndex;
     SkTDArray<const SkFlatPaint* > fPaints;
+    SkFlatDictionary fPaintDictionary;
     int fRegionIndex;
     SkTDArray<const SkFlatRegion* > fRegions;
+    SkFlatDictionary fRegionDictionary;
     SkPathHeap* fPathHeap;  // reference counted
     SkWriter32 fWriter;
 
@@ -175,6 +271,24 @@ private:
     
     uint32_t fRecordFlags;
 
+    SkTDArray<SkPictureIndex::Op> fOpBounds;
+    bool fOpBoundsPending;  // true if fOpBounds.top() has no size yet
+    bool fCanIndex;
+
+    SkTDArray<OpRecord> fOps;
+    SkTDArray<int> fLayerStack;     // the layer inside each save
+    SkTDArray<int> fLayerParents;   // indexed by layer, layer 0 is the device
+    // the save count at which the clip started to be approximated by clipPath
+    // bounds (0 if it is exact)
+    int fApproxClipLevel;
+    // false once the op stream does not map picture coordinates to the same
+    // place throughout, i.e. after setMatrix or clipRegion
+    bool fCanEliminate;
+    // true while every clip has been an intersection of rects, so that the
+    // clip is convex, and lies within the picture if its bounds do
+    bool fClipsAreConvex;
+    LayerFold fLayerFold;
+
     friend class SkPicturePlayback;
 
     typedef SkCanvas INHERITED;
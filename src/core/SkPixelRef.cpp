@@ -1,8 +1,19 @@
 #include "SkPixelRef.h"
+#include "SkBitmapMipMap.h"
 #include "SkFlattenable.h"
 #include "SkThread.h"
 
-static SkMutex  gPixelRefMutex;
+// Pixel refs that don't bring their own mutex are spread over these, so that
+// threads drawing different bitmaps rarely wait for each other, without every
+// pixel ref paying for a mutex of its own.
+#define PIXELREF_MUTEX_RING_COUNT   32
+static SkMutex  gPixelRefMutexRing[PIXELREF_MUTEX_RING_COUNT];
+
+static SkMutex* get_default_mutex() {
+    static int32_t gPixelRefMutexRingIndex;
+    uint32_t index = (uint32_t)sk_atomic_inc(&gPixelRefMutexRingIndex);
+    return &gPixelRefMutexRing[index % PIXELREF_MUTEX_RING_COUNT];
+}
 
 extern int32_t SkNextPixelRefGenerationID() {
     static int32_t  gPixelRefGenerationID;
@@ -18,7 +29,7 @@ extern int32_t SkNextPixelRefGenerationID() {
 
 SkPixelRef::SkPixelRef(SkMutex* mutex) {
     if (NULL == mutex) {
-        mutex = &gPixelRefMutex;
+        mutex = get_default_mutex();
     }
     fMutex = mutex;
     fPixels = NULL;
@@ -26,11 +37,13 @@ SkPixelRef::SkPixelRef(SkMutex* mutex) {
     fLockCount = 0;
     fGenerationID = 0;  // signal to rebuild
     fIsImmutable = false;
+    fPreLocked = false;
+    fMipMap = NULL;
 }
 
 SkPixelRef::SkPixelRef(SkFlattenableReadBuffer& buffer, SkMutex* mutex) {
     if (NULL == mutex) {
-        mutex = &gPixelRefMutex;
+        mutex = get_default_mutex();
     }
     fMutex = mutex;
     fPixels = NULL;
@@ -38,13 +51,34 @@ SkPixelRef::SkPixelRef(SkFlattenableReadBuffer& buffer, SkMutex* mutex) {
     fLockCount = 0;
     fGenerationID = 0;  // signal to rebuild
     fIsImmutable = buffer.readBool();
+    fPreLocked = false;
+    fMipMap = NULL;
+}
+
+SkPixelRef::~SkPixelRef() {
+    if (fMipMap) {
+        fMipMap->unref();
+    }
 }
 
 void SkPixelRef::flatten(SkFlattenableWriteBuffer& buffer) const {
     buffer.writeBool(fIsImmutable);
 }
 
+void SkPixelRef::setPreLocked(void* pixels, SkColorTable* ctable) {
+    // only the constructor may call this, before anyone can lock us
+    SkASSERT(0 == fLockCount);
+    fPixels = pixels;
+    fColorTable = ctable;
+    fPreLocked = true;
+}
+
 void SkPixelRef::lockPixels() {
+    if (fPreLocked) {
+        sk_atomic_inc(&fLockCount);
+        return;
+    }
+
     SkAutoMutexAcquire  ac(*fMutex);
 
     if (1 == ++fLockCount) {
@@ -53,6 +87,12 @@ void SkPixelRef::lockPixels() {
 }
 
 void SkPixelRef::unlockPixels() {
+    if (fPreLocked) {
+        SkDEBUGCODE(int32_t count =) sk_atomic_dec(&fLockCount);
+        SkASSERT(count > 0);
+        return;
+    }
+
     SkAutoMutexAcquire  ac(*fMutex);
 
     SkASSERT(fLockCount > 0);
@@ -92,6 +132,10 @@ bool SkPixelRef::onReadPixels(SkBitmap* dst, const SkIRect* subset) {
     return false;
 }
 
+SkData* SkPixelRef::onRefEncodedData() {
+    return NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define MAX_PAIR_COUNT  16
@@ -0,0 +1,129 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkPurgeableCache.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+/*  Static caches register themselves while static constructors run, so the
+    list's mutex is created on first use, and the head of the list is
+    zero-initialized.
+ */
+static SkMutex& get_mutex() {
+    static SkMutex gMutex;
+    return gMutex;
+}
+
+static SkPurgeableCache* gHead;
+
+SkPurgeableCache::SkPurgeableCache(const char name[], Cost cost)
+        : fName(name), fCost(cost), fPrev(NULL) {
+    SkAutoMutexAcquire ac(get_mutex());
+    fNext = gHead;
+    if (gHead) {
+        gHead->fPrev = this;
+    }
+    gHead = this;
+}
+
+SkPurgeableCache::~SkPurgeableCache() {
+    SkAutoMutexAcquire ac(get_mutex());
+    if (fPrev) {
+        fPrev->fNext = fNext;
+    } else {
+        SkASSERT(gHead == this);
+        gHead = fNext;
+    }
+    if (fNext) {
+        fNext->fPrev = fPrev;
+    }
+}
+
+int SkPurgeableCache::GetUsage(Usage usage[], int maxCount) {
+    SkAutoMutexAcquire ac(get_mutex());
+    int count = 0;
+    for (SkPurgeableCache* cache = gHead; cache; cache = cache->fNext) {
+        if (count < maxCount) {
+            usage[count].fName = cache->fName;
+            usage[count].fCost = cache->fCost;
+            usage[count].fBytesUsed = cache->bytesUsed();
+        }
+        count += 1;
+    }
+    return count;
+}
+
+size_t SkPurgeableCache::GetTotalBytesUsed() {
+    SkAutoMutexAcquire ac(get_mutex());
+    size_t total = 0;
+    for (SkPurgeableCache* cache = gHead; cache; cache = cache->fNext) {
+        total += cache->bytesUsed();
+    }
+    return total;
+}
+
+namespace {
+
+struct PurgeRec {
+    SkPurgeableCache*   fCache;
+    size_t              fBytesUsed;
+};
+
+}
+
+static int compare_recs(const void* a, const void* b) {
+    const PurgeRec* ra = (const PurgeRec*)a;
+    const PurgeRec* rb = (const PurgeRec*)b;
+    if (ra->fCache->cost() != rb->fCache->cost()) {
+        return ra->fCache->cost() < rb->fCache->cost() ? -1 : 1;
+    }
+    if (ra->fBytesUsed != rb->fBytesUsed) {
+        return ra->fBytesUsed > rb->fBytesUsed ? -1 : 1;
+    }
+    return 0;
+}
+
+size_t SkPurgeableCache::PurgeTo(size_t bytes) {
+    // held throughout, so no cache can go away while we purge it
+    SkAutoMutexAcquire ac(get_mutex());
+
+    SkTDArray<PurgeRec> recs;
+    size_t total = 0;
+    for (SkPurgeableCache* cache = gHead; cache; cache = cache->fNext) {
+        PurgeRec* rec = recs.append();
+        rec->fCache = cache;
+        rec->fBytesUsed = cache->bytesUsed();
+        total += rec->fBytesUsed;
+    }
+    if (total <= bytes) {
+        return total;
+    }
+    qsort(recs.begin(), recs.count(), sizeof(PurgeRec), compare_recs);
+
+    for (int i = 0; i < recs.count() && total > bytes; i++) {
+        const size_t used = recs[i].fBytesUsed;
+        if (0 == used) {
+            continue;
+        }
+        const size_t excess = total - bytes;
+        recs[i].fCache->purgeTo(used > excess ? used - excess : 0);
+        // the cache may have grown in the meantime, or kept more than asked
+        const size_t after = recs[i].fCache->bytesUsed();
+        total = total - used + after;
+    }
+    return total;
+}
@@ -25,7 +25,8 @@ SkRasterizer::SkRasterizer(SkFlattenableReadBuffer&) {}
 
 bool SkRasterizer::rasterize(const SkPath& fillPath, const SkMatrix& matrix,
                              const SkIRect* clipBounds, SkMaskFilter* filter,
-                             SkMask* mask, SkMask::CreateMode mode) {
+                             SkMask* mask, SkMask::CreateMode mode,
+                             SkExecutor* executor) {
     SkIRect storage;
     
     if (clipBounds && filter && SkMask::kJustRenderImage_CreateMode != mode) {        
@@ -43,14 +44,16 @@ bool SkRasterizer::rasterize(const SkPath& fillPath, const SkMatrix& matrix,
         clipBounds = &storage;
     }
     
-    return this->onRasterize(fillPath, matrix, clipBounds, mask, mode);
+    return this->onRasterize(fillPath, matrix, clipBounds, mask, mode,
+                             executor);
 }
 
 /*  Our default implementation of the virtual method just scan converts
 */
 bool SkRasterizer::onRasterize(const SkPath& fillPath, const SkMatrix& matrix,
                              const SkIRect* clipBounds,
-                             SkMask* mask, SkMask::CreateMode mode) {
+                             SkMask* mask, SkMask::CreateMode mode,
+                             SkExecutor*) {
     SkPath  devPath;
     
     fillPath.transform(matrix, &devPath);
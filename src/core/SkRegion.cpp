@@ -16,6 +16,8 @@
 */
 
 #include "SkRegionPriv.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
 #include "SkTemplates.h"
 #include "SkThread.h"
 
@@ -548,16 +550,113 @@ void SkRegion::translate(int dx, int dy, SkRegion* dst) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  setRects() sweeps down the rects' top and bottom edges. Between two edges
+    the rects that are open form one scanline: their [left, right) intervals,
+    sorted and merged. A scanline that is the same as the one above it just
+    extends that one's bottom, so the work grows with the number of edges and
+    open rects, not with the complexity of a region built up one rect at a
+    time.
+ */
+namespace {
+    struct RectTop {
+        int32_t operator()(const SkIRect* rect) const { return rect->fTop; }
+    };
+
+    struct RunTypeKey {
+        int32_t operator()(SkRegion::RunType value) const { return value; }
+    };
+
+    struct RectLeftLT {
+        bool operator()(const SkIRect* a, const SkIRect* b) const {
+            return a->fLeft < b->fLeft;
+        }
+    };
+}
+
 bool SkRegion::setRects(const SkIRect rects[], int count) {
-    if (0 == count) {
-        this->setEmpty();
-    } else {
-        this->setRect(rects[0]);
-        for (int i = 1; i < count; i++) {
-            this->op(rects[i], kUnion_Op);
+    // a handful of rects shouldn't need the heap for any of these
+    SkSTDArray<16, const SkIRect*> sorted;  // non-empty rects, by top
+    SkSTDArray<32, RunType> edges;          // every top and bottom, sorted
+    sorted.setReserve(count);
+    edges.setReserve(count * 2);
+    for (int i = 0; i < count; i++) {
+        if (!rects[i].isEmpty()) {
+            *sorted.append() = &rects[i];
+            *edges.append() = rects[i].fTop;
+            *edges.append() = rects[i].fBottom;
+        }
+    }
+    if (sorted.count() <= 1) {
+        return sorted.count() ? this->setRect(*sorted[0]) : this->setEmpty();
+    }
+    SkTRadixSort(sorted.begin(), sorted.count(), RectTop());
+    SkTRadixSort(edges.begin(), edges.count(), RunTypeKey());
+
+    // the open rects are reused from one scanline to the next
+    SkSTDArray<16, const SkIRect*> open;
+    SkSTDArray<64, RunType> runs;
+
+    *runs.append() = edges[0];          // top
+    int prevStart = 0;                  // the previous scanline's first left
+    int prevLength = -1;                // ... and its length (none yet)
+    int next = 0;                       // the next rect to open
+    const RunType* edge = edges.begin();
+    const RunType* edgeStop = edges.end();
+    while (edge < edgeStop - 1) {
+        const RunType top = *edge;
+        while (edge < edgeStop && *edge == top) {
+            edge++;
+        }
+        if (edge == edgeStop) {
+            break;
+        }
+        const RunType bottom = *edge;
+
+        // close the rects that end at top, and open those that start there
+        for (int i = open.count() - 1; i >= 0; --i) {
+            if (open[i]->fBottom <= top) {
+                open.removeShuffle(i);
+            }
+        }
+        while (next < sorted.count() && sorted[next]->fTop == top) {
+            *open.append() = sorted[next++];
+        }
+
+        // their intervals, from left to right
+        SkTIntroSort(open.begin(), open.count(), RectLeftLT());
+
+        *runs.append() = bottom;
+        const int start = runs.count();
+        for (int i = 0; i < open.count(); i++) {
+            RunType left = open[i]->fLeft;
+            RunType right = open[i]->fRight;
+            RunType* prevRight = runs.end() - 1;
+            if (runs.count() > start && *prevRight >= left) {
+                // overlaps or touches the interval before it
+                if (*prevRight < right) {
+                    *prevRight = right;
+                }
+            } else {
+                *runs.append() = left;
+                *runs.append() = right;
+            }
+        }
+        *runs.append() = kRunTypeSentinel;
+
+        const int length = runs.count() - start;
+        if (length == prevLength &&
+                !memcmp(&runs[prevStart], &runs[start],
+                        length * sizeof(RunType))) {
+            // the same as the scanline above, which now reaches bottom
+            runs.setCount(start - 1);
+            runs[prevStart - 1] = bottom;
+        } else {
+            prevStart = start;
+            prevLength = length;
         }
     }
-    return !this->isEmpty();
+    *runs.append() = kRunTypeSentinel;
+    return this->setRuns(runs.begin(), runs.count());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1006,8 +1105,10 @@ bool SkRegion::op(const SkRegion& rgnaOrig, const SkRegion& rgnbOrig, Op op)
     const RunType* a_runs = rgna->getRuns(tmpA, &a_count);
     const RunType* b_runs = rgnb->getRuns(tmpB, &b_count);
 
+    // most ops are between small regions, which this holds without going to
+    // the heap
     int dstCount = compute_worst_case_count(a_count, b_count);
-    SkAutoSTMalloc<32, RunType> array(dstCount);
+    SkAutoSTMalloc<256, RunType> array(dstCount);
 
     int count = operate(a_runs, b_runs, array.get(), op);
     SkASSERT(count <= dstCount);
@@ -423,11 +423,13 @@ static int extract_path(Edge* edge, Edge* stop, SkPath* path) {
     return count;
 }
 
-#include "SkTSearch.h"
+#include "SkTSort.h"
 
-static int EdgeProc(const Edge* a, const Edge* b) {
-    return (a->fX == b->fX) ? a->top() - b->top() : a->fX - b->fX;
-}
+struct EdgeLT {
+    bool operator()(const Edge& a, const Edge& b) const {
+        return (a.fX == b.fX) ? a.top() < b.top() : a.fX < b.fX;
+    }
+};
 
 bool SkRegion::getBoundaryPath(SkPath* path) const {
     if (this->isEmpty()) {
@@ -451,7 +453,7 @@ bool SkRegion::getBoundaryPath(SkPath* path) const {
         edge[0].set(r.fLeft, r.fBottom, r.fTop);
         edge[1].set(r.fRight, r.fTop, r.fBottom);
     }
-    SkQSort(edges.begin(), edges.count(), sizeof(Edge), (SkQSortCompareProc)EdgeProc);
+    SkTIntroSort(edges.begin(), edges.count(), EdgeLT());
     
     int count = edges.count();
     Edge* start = edges.begin();
@@ -0,0 +1,167 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkScaledBitmapCache.h"
+#include "SkPurgeableCache.h"
+#include "SkThread.h"
+
+// room for a few screenfuls of scaled images
+#define SCALED_CACHE_DEFAULT_LIMIT  (4 * 1024 * 1024)
+// keeps the lookup, which looks at every entry, cheap next to a draw
+#define SCALED_CACHE_MAX_ENTRIES    64
+
+struct ScaledCacheEntry {
+    ScaledCacheEntry*           fPrev;  // more recently used
+    ScaledCacheEntry*           fNext;  // less recently used
+    SkScaledBitmapCache::Key    fKey;
+    SkBitmap                    fBitmap;
+    size_t                      fSize;
+};
+
+static SkMutex              gScaledCacheMutex;
+static ScaledCacheEntry*    gHead;
+static ScaledCacheEntry*    gTail;
+static int                  gCount;
+static size_t               gBytesUsed;
+static size_t               gByteLimit = SCALED_CACHE_DEFAULT_LIMIT;
+
+// the following must be called with gScaledCacheMutex held
+
+static ScaledCacheEntry* find_entry(const SkScaledBitmapCache::Key& key) {
+    for (ScaledCacheEntry* entry = gHead; entry; entry = entry->fNext) {
+        if (entry->fKey == key) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void detach(ScaledCacheEntry* entry) {
+    if (entry->fPrev) {
+        entry->fPrev->fNext = entry->fNext;
+    } else {
+        gHead = entry->fNext;
+    }
+    if (entry->fNext) {
+        entry->fNext->fPrev = entry->fPrev;
+    } else {
+        gTail = entry->fPrev;
+    }
+    gCount -= 1;
+    gBytesUsed -= entry->fSize;
+}
+
+static void add_to_head(ScaledCacheEntry* entry) {
+    entry->fPrev = NULL;
+    entry->fNext = gHead;
+    if (gHead) {
+        gHead->fPrev = entry;
+    } else {
+        gTail = entry;
+    }
+    gHead = entry;
+    gCount += 1;
+    gBytesUsed += entry->fSize;
+}
+
+static void purge_to(size_t limit) {
+    while (gTail && (gBytesUsed > limit || gCount > SCALED_CACHE_MAX_ENTRIES)) {
+        ScaledCacheEntry* entry = gTail;
+        detach(entry);
+        SkDELETE(entry);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkScaledBitmapCache::Find(const Key& key, SkBitmap* bitmap) {
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    ScaledCacheEntry* entry = find_entry(key);
+    if (NULL == entry) {
+        return false;
+    }
+    detach(entry);
+    add_to_head(entry);
+    *bitmap = entry->fBitmap;
+    return true;
+}
+
+void SkScaledBitmapCache::Add(const Key& key, const SkBitmap& bitmap) {
+    const size_t size = sizeof(ScaledCacheEntry) + bitmap.getSize();
+    // a single bitmap may not crowd out all of the others
+    if (size > GetByteLimit() / 4) {
+        return;
+    }
+
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    // another thread may have beaten us to it
+    if (find_entry(key)) {
+        return;
+    }
+    ScaledCacheEntry* entry = SkNEW(ScaledCacheEntry);
+    entry->fKey = key;
+    entry->fBitmap = bitmap;
+    entry->fSize = size;
+    add_to_head(entry);
+    purge_to(gByteLimit);
+}
+
+size_t SkScaledBitmapCache::GetByteLimit() {
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    return gByteLimit;
+}
+
+void SkScaledBitmapCache::SetByteLimit(size_t bytes) {
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    gByteLimit = bytes;
+    purge_to(bytes);
+}
+
+size_t SkScaledBitmapCache::GetBytesUsed() {
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    return gBytesUsed;
+}
+
+void SkScaledBitmapCache::Purge() {
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    purge_to(0);
+}
+
+void SkScaledBitmapCache::PurgeTo(size_t bytes) {
+    SkAutoMutexAcquire ac(gScaledCacheMutex);
+    purge_to(bytes);
+}
+
+namespace {
+
+class ScaledPurgeableCache : public SkPurgeableCache {
+public:
+    ScaledPurgeableCache() : INHERITED("scaled bitmaps", kModerate_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        return SkScaledBitmapCache::GetBytesUsed();
+    }
+    virtual void purgeTo(size_t bytes) {
+        SkScaledBitmapCache::PurgeTo(bytes);
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static ScaledPurgeableCache gPurgeableCache;
@@ -0,0 +1,85 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkScaledBitmapCache_DEFINED
+#define SkScaledBitmapCache_DEFINED
+
+#include "SkBitmap.h"
+
+/** \class SkScaledBitmapCache
+
+    A global, bounded cache of bitmaps as they were drawn through a scale,
+    most recently used first, so that SkBitmapProcShader can draw the same
+    bitmap at the same scale again by copying pixels instead of resampling.
+
+    Like SkBitmapCache, each entry holds an SkBitmap, so a bitmap that was
+    found stays valid after its entry is purged.
+*/
+class SkScaledBitmapCache {
+public:
+    /** What the cached bitmap was made from: the src's pixels (the pixelref's
+        generation ID and the subset of it), and the inverse of the matrix it
+        was drawn through, which is only scaled and translated. The translate
+        is that of the cached bitmap's top left, so it is the same for every
+        draw that only moves by whole pixels.
+    */
+    struct Key {
+        uint32_t    fGenerationID;
+        uint32_t    fPixelRefOffset;
+        int32_t     fWidth;
+        int32_t     fHeight;
+        int32_t     fConfig;
+        SkScalar    fInvScaleX;
+        SkScalar    fInvScaleY;
+        SkFixed     fInvTransX;
+        SkFixed     fInvTransY;
+
+        bool operator==(const Key& other) const {
+            return !memcmp(this, &other, sizeof(Key));
+        }
+    };
+
+    /** If there is a bitmap for key, set bitmap to it and return true.
+        Otherwise return false.
+    */
+    static bool Find(const Key& key, SkBitmap* bitmap);
+
+    /** Remember bitmap for key. Bitmaps that are too large for the cache are
+        ignored.
+    */
+    static void Add(const Key& key, const SkBitmap& bitmap);
+
+    /** Return the limit on the memory used by the cache, in bytes. */
+    static size_t GetByteLimit();
+
+    /** Set the limit, purging the oldest entries if need be. 0 turns the
+        cache off.
+    */
+    static void SetByteLimit(size_t bytes);
+
+    /** Return the memory currently used by the cache, in bytes. */
+    static size_t GetBytesUsed();
+
+    /** Purge the oldest entries until no more than the specified number of
+        bytes remain. Unlike SetByteLimit(), this leaves the limit alone.
+    */
+    static void PurgeTo(size_t bytes);
+
+    /** Remove every entry. */
+    static void Purge();
+};
+
+#endif
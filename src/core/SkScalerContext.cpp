@@ -26,6 +26,7 @@
 #include "SkRegion.h"
 #include "SkStroke.h"
 #include "SkThread.h"
+#include "SkUtils.h"
 
 #define ComputeBWRowBytes(width)        (((unsigned)(width) + 7) >> 3)
 
@@ -96,6 +97,7 @@ SkScalerContext::SkScalerContext(const SkDescriptor* desc)
 
     fBaseGlyphCount = 0;
     fNextContext = NULL;
+    fImageTableTaken = false;
 
     const Rec* rec = (const Rec*)desc->findEntry(kRec_SkDescriptorTag, NULL);
     SkASSERT(rec);
@@ -330,9 +332,25 @@ SK_ERROR:
     glyph->fMaskFormat = fRec.fMaskFormat;
 }
 
+void SkScalerContext::getMetrics(SkGlyph* const glyphs[], int count) {
+    for (int i = 0; i < count; i++) {
+        if (glyphs[i]->isJustAdvance()) {
+            this->getMetrics(glyphs[i]);
+        }
+    }
+}
+
+void SkScalerContext::getImages(const SkGlyph* const glyphs[], int count) {
+    for (int i = 0; i < count; i++) {
+        SkASSERT(glyphs[i]->isFullMetrics() && glyphs[i]->fImage);
+        this->getImage(*glyphs[i]);
+    }
+}
+
 void SkScalerContext::getImage(const SkGlyph& origGlyph) {
     const SkGlyph*  glyph = &origGlyph;
     SkGlyph         tmpGlyph;
+    bool            tableTaken = false;
 
     if (fMaskFilter) {   // restore the prefilter bounds
         tmpGlyph.init(origGlyph.fID);
@@ -401,7 +419,10 @@ void SkScalerContext::getImage(const SkGlyph& origGlyph) {
             draw.drawPath(devPath, paint);
         }
     } else {
-        this->getGlyphContext(*glyph)->generateImage(*glyph);
+        SkScalerContext* context = this->getGlyphContext(*glyph);
+        context->fImageTableTaken = false;
+        context->generateImage(*glyph);
+        tableTaken = context->fImageTableTaken;
     }
 
     if (fMaskFilter) {
@@ -440,26 +461,33 @@ void SkScalerContext::getImage(const SkGlyph& origGlyph) {
     }
 
     // check to see if we should filter the alpha channel
+    const uint8_t* table = this->getImageTable();
+    if (NULL != table && !tableTaken) {
+        uint8_t* dst = (uint8_t*)origGlyph.fImage;
+        unsigned rowBytes = origGlyph.rowBytes();
+
+        for (int y = origGlyph.fHeight - 1; y >= 0; --y) {
+            sk_table8(dst, dst, origGlyph.fWidth, table);
+            dst += rowBytes;
+        }
+    }
+}
 
+const uint8_t* SkScalerContext::getImageTable() const {
     if (NULL == fMaskFilter &&
         fRec.fMaskFormat != SkMask::kBW_Format &&
         fRec.fMaskFormat != SkMask::kLCD16_Format &&
         fRec.fMaskFormat != SkMask::kLCD32_Format &&
         (fRec.fFlags & (kGammaForBlack_Flag | kGammaForWhite_Flag)) != 0)
     {
-        const uint8_t* table = (fRec.fFlags & kGammaForBlack_Flag) ? gBlackGammaTable : gWhiteGammaTable;
-        if (NULL != table) {
-            uint8_t* dst = (uint8_t*)origGlyph.fImage;
-            unsigned rowBytes = origGlyph.rowBytes();
-
-            for (int y = origGlyph.fHeight - 1; y >= 0; --y) {
-                for (int x = origGlyph.fWidth - 1; x >= 0; --x) {
-                    dst[x] = table[dst[x]];
-                }
-                dst += rowBytes;
-            }
-        }
+        return (fRec.fFlags & kGammaForBlack_Flag) ? gBlackGammaTable : gWhiteGammaTable;
     }
+    return NULL;
+}
+
+const uint8_t* SkScalerContext::takeImageTable() {
+    fImageTableTaken = true;
+    return this->getImageTable();
 }
 
 void SkScalerContext::getPath(const SkGlyph& glyph, SkPath* path) {
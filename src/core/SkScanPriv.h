@@ -20,6 +20,9 @@
 
 #include "SkScan.h"
 #include "SkBlitter.h"
+#include "SkEdgeBuilder.h"
+#include "SkPath.h"
+#include "SkTDArray.h"
 
 class SkScanClipper {
 public:
@@ -40,6 +43,39 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect,
                   SkBlitter* blitter, int start_y, int stop_y, int shiftEdgesUp,
                   const SkRegion& clipRgn);
 
+/*  The edges of a (non-inverse) path, built once, from which horizontal bands
+    of scanlines can then be walked independently, e.g. on different threads.
+    Each walk steps its own copy of the edges down to the top of its band, and
+    blits the same spans as sk_fill_path would for those scanlines.
+ */
+class SkBandedEdges : SkNoncopyable {
+public:
+    // returns false (and nothing is to be drawn) if the path has fewer than
+    // two edges. clipRect is as for sk_fill_path.
+    bool build(const SkPath&, const SkIRect* clipRect, int shiftEdgesUp);
+
+    /*  Split [start_y, stop_y) into at most maxBands (up to
+        SkScan::kMaxFillBands) bands, each starting on
+        a multiple of step from start_y, and set tops[0..bands] to their
+        bounds. Returns the number of bands.
+     */
+    int split(int start_y, int stop_y, int step, int maxBands,
+              int tops[]) const;
+
+    void walk(SkBlitter*, int start_y, int stop_y) const;
+
+private:
+    SkEdgeBuilder       fBuilder;
+    // the edges in the order that the serial walk takes them up in
+    SkTDArray<SkEdge*>  fOrder;
+    size_t              fEdgeBytes;
+    SkPath::FillType    fFillType;
+    bool                fBucketed;
+
+    bool prepare(int y, int stop_y, SkAutoScratch*, SkEdge*** list,
+                 int* count) const;
+};
+
 // blit the rects above and below avoid, clipped to clip
 void sk_blit_above(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
 void sk_blit_below(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
@@ -20,7 +20,13 @@
 #include "SkMatrix.h"
 #include "SkBlitter.h"
 #include "SkRegion.h"
+#include "SkRunnable.h"
+#include "SkScratchAlloc.h"
 #include "SkAntiRun.h"
+#include "SkGeometry.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+#include "SkTSort.h"
 
 #define SHIFT   2
 #define SCALE   (1 << SHIFT)
@@ -92,7 +98,6 @@ public:
 
     virtual ~SuperBlitter() {
         this->flush();
-        sk_free(fRuns.fRuns);
     }
 
     void flush();
@@ -101,8 +106,9 @@ public:
     virtual void blitRect(int x, int y, int width, int height);
 
 private:
-    SkAlphaRuns fRuns;
-    int         fOffsetX;
+    SkAutoScratch   fScratch;   // holds fRuns
+    SkAlphaRuns     fRuns;
+    int             fOffsetX;
 };
 
 SuperBlitter::SuperBlitter(SkBlitter* realBlitter, const SkIRect& ir,
@@ -111,7 +117,7 @@ SuperBlitter::SuperBlitter(SkBlitter* realBlitter, const SkIRect& ir,
     const int width = fWidth;
 
     // extra one to store the zero at the end
-    fRuns.fRuns = (int16_t*)sk_malloc_throw((width + 1 + (width + 2)/2) * sizeof(int16_t));
+    fRuns.fRuns = (int16_t*)fScratch.alloc((width + 1 + (width + 2)/2) * sizeof(int16_t));
     fRuns.fAlpha = (uint8_t*)(fRuns.fRuns + width + 1);
     fRuns.reset(width);
 
@@ -481,3 +487,509 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
         sk_blit_below(blitter, ir, clip);
     }
 }
+
+namespace {
+    class AntiFillBand : public SkRunnable {
+    public:
+        void set(const SkBandedEdges* edges, SkBlitter* blitter,
+                 const SkRegion* clip, const SkIRect& ir, int top, int bottom) {
+            fEdges = edges;
+            fBlitter = blitter;
+            fClip = clip;
+            fIR = ir;
+            fTop = top;
+            fBottom = bottom;
+        }
+
+        virtual void run() {
+            // the bands start on whole pixels, so each one's supersampler
+            // only flushes its own rows
+            SkScanClipper clipper(fBlitter, fClip, fIR);
+            SuperBlitter superBlit(clipper.getBlitter(), fIR, *fClip);
+            fEdges->walk(&superBlit, fTop, fBottom);
+        }
+
+    private:
+        const SkBandedEdges*    fEdges;
+        SkBlitter*              fBlitter;
+        const SkRegion*         fClip;
+        SkIRect                 fIR;
+        int                     fTop, fBottom;
+    };
+}
+
+void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
+                          SkBlitter* blitters[], int count,
+                          SkExecutor* executor) {
+    SkIRect ir;
+    path.getBounds().roundOut(&ir);
+    // small paths use a MaskSuperBlitter, which blits the whole mask at once
+    if (count < 2 || NULL == executor || path.isInverseFillType() ||
+            clip.isEmpty() || ir.isEmpty() ||
+            MaskSuperBlitter::CanHandleRect(ir) ||
+            (overflows_short_shift(ir.fLeft, SHIFT) |
+             overflows_short_shift(ir.fRight, SHIFT) |
+             overflows_short_shift(ir.fTop, SHIFT) |
+             overflows_short_shift(ir.fBottom, SHIFT))) {
+        SkScan::AntiFillPath(path, clip, blitters[0]);
+        return;
+    }
+
+    SkScanClipper clipper(blitters[0], &clip, ir);
+    if (NULL == clipper.getBlitter()) {
+        return;
+    }
+    const SkIRect* clipRect = clipper.getClipRect();
+
+    SkIRect superRect, *superClipRect = NULL;
+    if (clipRect) {
+        superRect.set(  clipRect->fLeft << SHIFT, clipRect->fTop << SHIFT,
+                        clipRect->fRight << SHIFT, clipRect->fBottom << SHIFT);
+        superClipRect = &superRect;
+    }
+
+    int start_y = ir.fTop << SHIFT;
+    int stop_y = ir.fBottom << SHIFT;
+    if (superClipRect && start_y < superClipRect->fTop) {
+        start_y = superClipRect->fTop;
+    }
+    if (superClipRect && stop_y > superClipRect->fBottom) {
+        stop_y = superClipRect->fBottom;
+    }
+
+    SkBandedEdges edges;
+    if (!edges.build(path, superClipRect, SHIFT)) {
+        return;
+    }
+
+    int tops[SkScan::kMaxFillBands + 1];
+    count = edges.split(start_y, stop_y, SCALE,
+                        SkMin32(count, SkScan::kMaxFillBands), tops);
+
+    AntiFillBand bands[SkScan::kMaxFillBands];
+    for (int i = 0; i < count; i++) {
+        bands[i].set(&edges, blitters[i], &clip, ir, tops[i], tops[i + 1]);
+    }
+    for (int i = 1; i < count; i++) {
+        executor->add(&bands[i]);
+    }
+    bands[0].run();
+    executor->wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  Analytic coverage
+
+    Rather than supersampling, every line of the (flattened) path deposits the
+    exact signed area it sweeps into a per-scanline accumulator: for the part
+    of a line that crosses pixel x, acc[x] gets the area to the right of the
+    line within that pixel, and acc[x+1] gets the remainder of the pixel's
+    height. A running sum along the scanline then gives the coverage of each
+    pixel, with 8 bits of precision in both x and y, so there is no
+    quantization beyond the final alpha.
+
+    Coordinates are stored as 24.8 fixed point, and areas as 16.16.
+ */
+
+#define ACC_SHIFT       8
+#define ACC_ONE         (1 << ACC_SHIFT)
+#define ACC_FULL        (ACC_ONE * ACC_ONE)
+
+// maximum flattening error for curves, in 24.8 units (1/16 of a pixel)
+#define ACC_TOLERANCE   (ACC_ONE >> 4)
+#define ACC_MAX_SEGMENTS_SHIFT  8
+
+struct AccLine {
+    int32_t fX0, fY0, fX1, fY1;     // fY0 < fY1
+    int32_t fWinding;               // +1 if the line pointed down, else -1
+};
+
+struct AccLineY0 {
+    int32_t operator()(const AccLine& line) const { return line.fY0; }
+};
+
+static inline int32_t scalar_to_acc(SkScalar x) {
+    return SkScalarToFixed(x) >> (16 - ACC_SHIFT);
+}
+
+static void acc_add_line(SkTDArray<AccLine>* lines, const SkPoint& p0,
+                         const SkPoint& p1) {
+    int32_t x0 = scalar_to_acc(p0.fX);
+    int32_t y0 = scalar_to_acc(p0.fY);
+    int32_t x1 = scalar_to_acc(p1.fX);
+    int32_t y1 = scalar_to_acc(p1.fY);
+    if (y0 == y1) {
+        return;     // horizontal lines cover no area
+    }
+
+    AccLine* line = lines->append();
+    if (y0 < y1) {
+        line->fX0 = x0; line->fY0 = y0;
+        line->fX1 = x1; line->fY1 = y1;
+        line->fWinding = 1;
+    } else {
+        line->fX0 = x1; line->fY0 = y1;
+        line->fX1 = x0; line->fY1 = y0;
+        line->fWinding = -1;
+    }
+}
+
+static inline int32_t cheap_distance(int32_t dx, int32_t dy) {
+    dx = SkAbs32(dx);
+    dy = SkAbs32(dy);
+    // return max + min/2
+    return dx > dy ? dx + (dy >> 1) : dy + (dx >> 1);
+}
+
+/*  The distance between a curve and its chord is at most 1/8 of the largest
+    second difference of its control points times curveScale (2 for quads,
+    6 for cubics), divided by the square of the number of segments.
+ */
+static int acc_segment_count(int32_t secondDiff, int curveScale) {
+    int32_t limit = ACC_TOLERANCE * 8;
+    int shift = 0;
+    while (shift < ACC_MAX_SEGMENTS_SHIFT &&
+            (secondDiff >> (2 * shift)) * curveScale > limit) {
+        shift += 1;
+    }
+    return 1 << shift;
+}
+
+static void acc_add_quad(SkTDArray<AccLine>* lines, const SkPoint pts[3]) {
+    int32_t ddx = scalar_to_acc(pts[0].fX - 2 * pts[1].fX + pts[2].fX);
+    int32_t ddy = scalar_to_acc(pts[0].fY - 2 * pts[1].fY + pts[2].fY);
+    int count = acc_segment_count(cheap_distance(ddx, ddy), 2);
+
+    const SkScalar dt = SkScalarDiv(SK_Scalar1, SkIntToScalar(count));
+    SkScalar t = dt;
+    SkPoint prev = pts[0];
+    SkPoint curr;
+    for (int i = 1; i < count; i++, t += dt) {
+        SkEvalQuadAt(pts, t, &curr);
+        acc_add_line(lines, prev, curr);
+        prev = curr;
+    }
+    acc_add_line(lines, prev, pts[2]);
+}
+
+static void acc_add_cubic(SkTDArray<AccLine>* lines, const SkPoint pts[4]) {
+    int32_t d0 = cheap_distance(
+                    scalar_to_acc(pts[0].fX - 2 * pts[1].fX + pts[2].fX),
+                    scalar_to_acc(pts[0].fY - 2 * pts[1].fY + pts[2].fY));
+    int32_t d1 = cheap_distance(
+                    scalar_to_acc(pts[1].fX - 2 * pts[2].fX + pts[3].fX),
+                    scalar_to_acc(pts[1].fY - 2 * pts[2].fY + pts[3].fY));
+    int count = acc_segment_count(SkMax32(d0, d1), 6);
+
+    const SkScalar dt = SkScalarDiv(SK_Scalar1, SkIntToScalar(count));
+    SkScalar t = dt;
+    SkPoint prev = pts[0];
+    SkPoint curr;
+    for (int i = 1; i < count; i++, t += dt) {
+        SkEvalCubicAt(pts, t, &curr, NULL, NULL);
+        acc_add_line(lines, prev, curr);
+        prev = curr;
+    }
+    acc_add_line(lines, prev, pts[3]);
+}
+
+static void acc_build_lines(const SkPath& path, SkTDArray<AccLine>* lines) {
+    SkPath::Iter    iter(path, true);
+    SkPoint         pts[4];
+    SkPath::Verb    verb;
+
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kLine_Verb:
+                acc_add_line(lines, pts[0], pts[1]);
+                break;
+            case SkPath::kQuad_Verb:
+                acc_add_quad(lines, pts);
+                break;
+            case SkPath::kCubic_Verb:
+                acc_add_cubic(lines, pts);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// x coordinate of the line at y, for fY0 <= y <= fY1
+static inline int32_t acc_line_x(const AccLine& line, int32_t y) {
+    if (y == line.fY0) {
+        return line.fX0;
+    }
+    if (y == line.fY1) {
+        return line.fX1;
+    }
+    return line.fX0 + (int32_t)((int64_t)(line.fX1 - line.fX0) *
+                                (y - line.fY0) / (line.fY1 - line.fY0));
+}
+
+// y coordinate of the segment (x0,y0)-(x1,y1) at x, for x0 < x < x1
+static inline int32_t acc_segment_y(int32_t x0, int32_t y0, int32_t x1,
+                                    int32_t y1, int32_t x) {
+    return y0 + (int32_t)((int64_t)(y1 - y0) * (x - x0) / (x1 - x0));
+}
+
+class AccumulationRow {
+public:
+    // covers the columns [left, right), plus one column on either side
+    AccumulationRow(int left, int right)
+            : fLeft(left), fWidth(right - left), fAcc(fWidth + 2),
+              fRuns(fWidth + 1), fAlpha(fWidth + 1) {
+        fLeftX = left << ACC_SHIFT;
+        fRightX = right << ACC_SHIFT;
+        sk_bzero(fAcc.get(), (fWidth + 2) * sizeof(int32_t));
+        fMinIndex = fWidth + 2;
+        fMaxIndex = -1;
+    }
+
+    // accumulate the part of line that lies within [top, bottom)
+    void addLine(const AccLine& line, int32_t top, int32_t bottom);
+
+    // blit the row and reset the accumulator
+    void flush(SkBlitter* blitter, int y, bool evenOdd);
+
+private:
+    enum {
+        kStackWidth = 256   // rows up to this wide don't touch the heap
+    };
+    int                     fLeft, fWidth;
+    int32_t                 fLeftX, fRightX;
+    // index 0 collects everything left of fLeft, pixel x is at x - fLeft + 1
+    SkAutoSTMalloc<kStackWidth + 2, int32_t>    fAcc;
+    SkAutoSTMalloc<kStackWidth + 1, int16_t>    fRuns;
+    SkAutoSTMalloc<kStackWidth + 1, SkAlpha>    fAlpha;
+    int                     fMinIndex, fMaxIndex;
+
+    void deposit(int index, int32_t dy, int32_t frac) {
+        SkASSERT(index >= 0 && index <= fWidth);
+        SkASSERT(frac >= 0 && frac <= ACC_ONE);
+        fAcc.get()[index] += dy * (ACC_ONE - frac);
+        fAcc.get()[index + 1] += dy * frac;
+        fMinIndex = SkMin32(fMinIndex, index);
+        fMaxIndex = SkMax32(fMaxIndex, index + 1);
+    }
+};
+
+void AccumulationRow::addLine(const AccLine& line, int32_t top,
+                              int32_t bottom) {
+    int32_t ya = SkMax32(line.fY0, top);
+    int32_t yb = SkMin32(line.fY1, bottom);
+    if (ya >= yb) {
+        return;
+    }
+    int32_t xa = acc_line_x(line, ya);
+    int32_t xb = acc_line_x(line, yb);
+    const int32_t winding = line.fWinding;
+
+    // the area only depends on the height and x extent of each piece, so walk
+    // the line from left to right
+    if (xa > xb) {
+        SkTSwap(xa, xb);
+        SkTSwap(ya, yb);
+    }
+    if (xa >= fRightX) {
+        return;     // only affects pixels to the right of the row
+    }
+
+    // whatever lies to the left of the row covers every pixel in the row
+    if (xa < fLeftX) {
+        int32_t ym = yb;
+        if (xb > fLeftX) {
+            ym = acc_segment_y(xa, ya, xb, yb, fLeftX);
+        }
+        this->deposit(0, winding * SkAbs32(ym - ya), 0);
+        if (xb <= fLeftX) {
+            return;
+        }
+        xa = fLeftX;
+        ya = ym;
+    }
+    // and whatever lies to the right of it affects none of them
+    if (xb > fRightX) {
+        yb = acc_segment_y(xa, ya, xb, yb, fRightX);
+        xb = fRightX;
+    }
+
+    if (xa == xb) {
+        if (xa < fRightX) {
+            int32_t col = (xa - fLeftX) >> ACC_SHIFT;
+            this->deposit(col + 1, winding * SkAbs32(yb - ya),
+                          xa - fLeftX - (col << ACC_SHIFT));
+        }
+        return;
+    }
+
+    // split the line at each pixel boundary it crosses
+    int32_t x = xa;
+    int32_t y = ya;
+    while (x < xb) {
+        int32_t col = (x - fLeftX) >> ACC_SHIFT;
+        int32_t nextX = SkMin32(fLeftX + ((col + 1) << ACC_SHIFT), xb);
+        int32_t nextY = (nextX == xb) ? yb :
+                                        acc_segment_y(xa, ya, xb, yb, nextX);
+        int32_t frac = ((x + nextX) >> 1) - fLeftX - (col << ACC_SHIFT);
+        this->deposit(col + 1, winding * SkAbs32(nextY - y), frac);
+        x = nextX;
+        y = nextY;
+    }
+}
+
+static inline U8CPU acc_to_alpha(int32_t sum, bool evenOdd) {
+    sum = SkAbs32(sum);
+    if (evenOdd) {
+        sum &= 2 * ACC_FULL - 1;
+        if (sum > ACC_FULL) {
+            sum = 2 * ACC_FULL - sum;
+        }
+    } else if (sum > ACC_FULL) {
+        sum = ACC_FULL;
+    }
+    // 0...256 -> 0...255
+    int alpha = (sum + (1 << (ACC_SHIFT - 1))) >> ACC_SHIFT;
+    return alpha - (alpha >> 8);
+}
+
+void AccumulationRow::flush(SkBlitter* blitter, int y, bool evenOdd) {
+    if (fMaxIndex < 0) {
+        return;
+    }
+
+    int32_t* acc = fAcc.get();
+    int16_t* runs = fRuns.get();
+    SkAlpha* alpha = fAlpha.get();
+
+    int32_t sum = 0;
+    int index = fMinIndex;
+    if (0 == index) {
+        sum = acc[0];
+        acc[0] = 0;
+        index = 1;
+    }
+    const int start = index - 1;
+    const int last = SkMin32(fMaxIndex, fWidth);
+
+    int runStart = start;
+    U8CPU runAlpha = 0;
+    bool hasCoverage = false;
+    for (; index <= last; index++) {
+        sum += acc[index];
+        acc[index] = 0;
+        U8CPU a = acc_to_alpha(sum, evenOdd);
+        int x = index - 1;
+        if (x == start) {
+            runAlpha = a;
+        } else if (a != runAlpha) {
+            runs[runStart] = SkToS16(x - runStart);
+            alpha[runStart] = SkToU8(runAlpha);
+            hasCoverage |= (runAlpha != 0);
+            runStart = x;
+            runAlpha = a;
+        }
+    }
+    // the edge of the row may have been touched, but is never drawn
+    acc[fWidth + 1] = 0;
+    fMinIndex = fWidth + 2;
+    fMaxIndex = -1;
+
+    if (start >= last) {
+        return;
+    }
+    // past the last touched pixel the coverage no longer changes
+    if (runAlpha) {
+        runs[runStart] = SkToS16(fWidth - runStart);
+        alpha[runStart] = SkToU8(runAlpha);
+        runs[fWidth] = 0;
+        hasCoverage = true;
+    } else {
+        runs[runStart] = 0;
+    }
+    if (hasCoverage) {
+        blitter->blitAntiH(fLeft + start, y, alpha + start, runs + start);
+    }
+}
+
+void SkScan::AnalyticFillPath(const SkPath& path, const SkRegion& clip,
+                              SkBlitter* blitter) {
+    if (clip.isEmpty()) {
+        return;
+    }
+
+    SkIRect ir;
+    path.getBounds().roundOut(&ir);
+    if (ir.isEmpty()) {
+        if (path.isInverseFillType()) {
+            blitter->blitRegion(clip);
+        }
+        return;
+    }
+
+    // inverse fills, and paths that would overflow the supersampler anyway,
+    // are left to AntiFillPath
+    if (path.isInverseFillType() ||
+            overflows_short_shift(ir.fLeft, SHIFT) |
+            overflows_short_shift(ir.fRight, SHIFT) |
+            overflows_short_shift(ir.fTop, SHIFT) |
+            overflows_short_shift(ir.fBottom, SHIFT)) {
+        SkScan::AntiFillPath(path, clip, blitter);
+        return;
+    }
+
+    SkScanClipper   clipper(blitter, &clip, ir);
+    const SkIRect*  clipRect = clipper.getClipRect();
+
+    if (clipper.getBlitter() == NULL) { // clipped out
+        return;
+    }
+    blitter = clipper.getBlitter();
+
+    SkIRect bounds = ir;
+    if (clipRect && !bounds.intersect(*clipRect)) {
+        return;
+    }
+
+    SkTDArray<AccLine> lines;
+    acc_build_lines(path, &lines);
+    if (lines.isEmpty()) {
+        return;
+    }
+    SkTRadixSort(lines.begin(), lines.count(), AccLineY0());
+
+    const bool evenOdd = (SkPath::kEvenOdd_FillType == path.getFillType());
+    AccumulationRow row(bounds.fLeft, bounds.fRight);
+    SkTDArray<const AccLine*> active;
+    const AccLine* next = lines.begin();
+    const AccLine* stop = lines.end();
+
+    for (int y = bounds.fTop; y < bounds.fBottom; y++) {
+        const int32_t top = y << ACC_SHIFT;
+        const int32_t bottom = top + ACC_ONE;
+
+        for (; next < stop && next->fY0 < bottom; next++) {
+            if (next->fY1 > top) {
+                *active.append() = next;
+            }
+        }
+
+        // accumulate each active line, dropping the ones that end in this row
+        const AccLine** src = active.begin();
+        const AccLine** dst = src;
+        for (; src < active.end(); src++) {
+            row.addLine(**src, top, bottom);
+            if ((*src)->fY1 > bottom) {
+                *dst++ = *src;
+            }
+        }
+        active.setCount(dst - active.begin());
+
+        row.flush(blitter, y, evenOdd);
+
+        if (active.isEmpty() && next == stop) {
+            break;
+        }
+    }
+}
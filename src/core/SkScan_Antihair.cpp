@@ -20,6 +20,7 @@
 #include "SkBlitter.h"
 #include "SkColorPriv.h"
 #include "SkLineClipper.h"
+#include "SkPath.h"
 #include "SkRegion.h"
 #include "SkFDot6.h"
 
@@ -819,3 +820,317 @@ void SkScan::AntiFrameRect(const SkRect& r, const SkPoint& strokeSize,
         innerstrokedot8(L, T, R, B, blitter);
     }
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  A thin stroke (a pixel or two wide) is drawn a line at a time, like a
+    hairline, stepping along each line's major axis. In each column (or row)
+    the stroke covers a span of the minor axis width / cos(angle) long, and
+    each pixel gets as much coverage as it has of that span.
+
+    Where two lines join, each one owns the columns whose centers are on its
+    side of the join, so that nothing is drawn twice and there's no seam.
+    That leaves a notch on the outside of a sharp turn, or where the major
+    axis changes, so a disc the width of the stroke is stamped over those
+    joins (and over round caps). The disc overlaps the lines, which only
+    looks right for opaque paints.
+ */
+
+#define kMaxThinStrokeWidth     SkIntToScalar(2)
+
+// enough for a row of a stroke or a disc at kMaxThinStrokeWidth
+static const int kMaxThinRun = 8;
+
+static inline U8CPU thin_alpha(SkFixed coverage, SkFixed partial) {
+    return (SkFixedMul(coverage, partial) * 255 + SK_FixedHalf) >> 16;
+}
+
+// Blit a column (or a row) of the span [top, bottom) of the minor axis,
+// scaled by partial (less than 1 at the ends of a stroke).
+static void thin_span(int major, SkFixed top, SkFixed bottom, SkFixed partial,
+                      bool vertical, SkBlitter* blitter) {
+    int itop = SkFixedFloor(top);
+    int ibottom = SkFixedCeil(bottom);
+    int count = ibottom - itop;
+    if (count <= 0) {
+        return;
+    }
+
+    U8CPU first, middle, last;
+    if (1 == count) {
+        first = last = thin_alpha(bottom - top, partial);
+    } else {
+        first = thin_alpha(SkIntToFixed(itop + 1) - top, partial);
+        last = thin_alpha(bottom - SkIntToFixed(ibottom - 1), partial);
+    }
+    middle = thin_alpha(SK_Fixed1, partial);
+
+    if (!vertical) {
+        blitter->blitV(major, itop, 1, first);
+        if (count > 1) {
+            if (count > 2) {
+                blitter->blitV(major, itop + 1, count - 2, middle);
+            }
+            blitter->blitV(major, ibottom - 1, 1, last);
+        }
+        return;
+    }
+
+    SkASSERT(count <= kMaxThinRun);
+    SkAlpha aa[kMaxThinRun];
+    int16_t runs[kMaxThinRun + 1];
+
+    aa[0] = first;
+    runs[0] = 1;
+    if (count > 1) {
+        if (count > 2) {
+            aa[1] = middle;
+            runs[1] = count - 2;
+        }
+        aa[count - 1] = last;
+        runs[count - 1] = 1;
+    }
+    runs[count] = 0;
+    blitter->blitAntiH(itop, major, aa, runs);
+}
+
+/*  Draw one line of the stroke. An end that is cut (the end of a contour) is
+    cut off exactly where it is, across the major axis; an end that joins
+    another line ends at the pixel centers, so that the next line picks up
+    the columns after it.
+ */
+static void thin_line(SkPoint p0, SkPoint p1, bool cut0, bool cut1,
+                      SkScalar halfWidth, SkBlitter* blitter) {
+    bool vertical = SkScalarAbs(p1.fY - p0.fY) > SkScalarAbs(p1.fX - p0.fX);
+    if (vertical) {
+        SkTSwap(p0.fX, p0.fY);
+        SkTSwap(p1.fX, p1.fY);
+    }
+    if (p0.fX > p1.fX) {
+        SkTSwap(p0, p1);
+        SkTSwap(cut0, cut1);
+    }
+
+    SkScalar dx = p1.fX - p0.fX;
+    SkScalar dy = p1.fY - p0.fY;
+    if (0 == dx) {
+        return;
+    }
+    SkFixed half = SkScalarToFixed(SkScalarMulDiv(halfWidth,
+                                                  SkPoint::Length(dx, dy), dx));
+    SkFixed slope = SkScalarToFixed(SkScalarDiv(dy, dx));
+    SkFixed x0 = SkScalarToFixed(p0.fX);
+    SkFixed y0 = SkScalarToFixed(p0.fY);
+    SkFixed x1 = SkScalarToFixed(p1.fX);
+
+    int istart = cut0 ? SkFixedFloor(x0) : SkFixedCeil(x0 - SK_FixedHalf);
+    int istop = cut1 ? SkFixedCeil(x1) : SkFixedCeil(x1 - SK_FixedHalf);
+
+    for (int ix = istart; ix < istop; ix++) {
+        SkFixed left = SkIntToFixed(ix);
+        SkFixed right = left + SK_Fixed1;
+        if (cut0 && left < x0) {
+            left = x0;
+        }
+        if (cut1 && right > x1) {
+            right = x1;
+        }
+        if (right <= left) {
+            continue;
+        }
+        SkFixed cy = y0 + SkFixedMul(slope, ((left + right) >> 1) - x0);
+        thin_span(ix, cy - half, cy + half, right - left, vertical, blitter);
+    }
+}
+
+// Stamp an antialiased disc, for round caps and joins.
+static void thin_dot(const SkPoint& center, SkScalar radius,
+                     SkBlitter* blitter) {
+    int left = SkScalarFloor(center.fX - radius);
+    int top = SkScalarFloor(center.fY - radius);
+    int right = SkScalarCeil(center.fX + radius);
+    int bottom = SkScalarCeil(center.fY + radius);
+    int count = right - left;
+    SkASSERT(count <= kMaxThinRun);
+
+    SkAlpha aa[kMaxThinRun];
+    int16_t runs[kMaxThinRun + 1];
+    for (int y = top; y < bottom; y++) {
+        SkScalar dy = SkIntToScalar(y) + SK_ScalarHalf - center.fY;
+        for (int i = 0; i < count; i++) {
+            SkScalar dx = SkIntToScalar(left + i) + SK_ScalarHalf - center.fX;
+            SkScalar cover = radius + SK_ScalarHalf - SkPoint::Length(dx, dy);
+            if (cover <= 0) {
+                aa[i] = 0;
+            } else if (cover >= SK_Scalar1) {
+                aa[i] = 0xFF;
+            } else {
+                aa[i] = SkScalarRound(cover * 255);
+            }
+            runs[i] = 1;
+        }
+        runs[count] = 0;
+        blitter->blitAntiH(left, y, aa, runs);
+    }
+}
+
+/*  Walks a contour's lines, drawing each one once the next one (and so the
+    join between them) is known. The first line waits until the end of the
+    contour, since whether it starts with a cap or a join depends on whether
+    the contour is closed.
+ */
+class ThinStroker {
+public:
+    ThinStroker(SkScalar width, SkPaint::Cap cap, const SkRect& bounds,
+                SkBlitter* blitter)
+        : fHalfWidth(SkScalarHalf(width))
+        , fCap(cap)
+        , fBounds(bounds)
+        , fBlitter(blitter)
+        , fCount(0) {}
+
+    void lineTo(const SkPoint& p0, const SkPoint& p1) {
+        if (p0 == p1) {
+            return;
+        }
+        if (0 == fCount) {
+            fFirst[0] = p0;
+            fFirst[1] = p1;
+        } else {
+            this->join(fPrev, p1);
+            if (fCount > 1) {
+                this->line(fPrev[0], fPrev[1], false, false);
+            }
+        }
+        fPrev[0] = p0;
+        fPrev[1] = p1;
+        fCount += 1;
+    }
+
+    void finish(bool closed) {
+        if (fCount > 1) {
+            this->line(fPrev[0], fPrev[1], false, !closed);
+            if (closed) {
+                this->join(fPrev, fFirst[1]);
+            }
+        }
+        if (fCount > 0) {
+            this->line(fFirst[0], fFirst[1], !closed, fCount == 1);
+        }
+        fCount = 0;
+    }
+
+private:
+    SkScalar        fHalfWidth;
+    SkPaint::Cap    fCap;
+    SkRect          fBounds;    // where the stroke could be seen
+    SkBlitter*      fBlitter;
+    SkPoint         fFirst[2];
+    SkPoint         fPrev[2];
+    int             fCount;
+
+    void dot(const SkPoint& center) {
+        if (fBounds.contains(center.fX, center.fY)) {
+            thin_dot(center, fHalfWidth, fBlitter);
+        }
+    }
+
+    // a disc covers the join unless the lines carry straight (enough) on
+    void join(const SkPoint prev[2], const SkPoint& next) {
+        SkVector a = prev[1] - prev[0];
+        SkVector b = next - prev[1];
+        bool verticalA = SkScalarAbs(a.fY) > SkScalarAbs(a.fX);
+        bool verticalB = SkScalarAbs(b.fY) > SkScalarAbs(b.fX);
+        // cos(30 degrees)
+        const SkScalar kCosMaxTurn = SkFloatToScalar(0.866f);
+        if (verticalA != verticalB || SkPoint::DotProduct(a, b) <
+                SkScalarMul(kCosMaxTurn, SkScalarMul(a.length(), b.length()))) {
+            this->dot(prev[1]);
+        }
+    }
+
+    void line(SkPoint p0, SkPoint p1, bool cap0, bool cap1) {
+        if (SkPaint::kSquare_Cap == fCap && (cap0 || cap1)) {
+            SkVector v = p1 - p0;
+            v.setLength(fHalfWidth);
+            if (cap0) {
+                p0 -= v;
+            }
+            if (cap1) {
+                p1 += v;
+            }
+        } else if (SkPaint::kRound_Cap == fCap) {
+            if (cap0) {
+                this->dot(p0);
+            }
+            if (cap1) {
+                this->dot(p1);
+            }
+        }
+
+        SkPoint pts[2] = { p0, p1 };
+        // keep the coordinates in range of SkFixed
+        if (SkLineClipper::IntersectLine(pts, fBounds, pts)) {
+            // ends that the clip moved aren't seen, so it doesn't matter
+            // how they're drawn
+            thin_line(pts[0], pts[1], cap0, cap1, fHalfWidth, fBlitter);
+        }
+    }
+};
+
+void SkScan::AntiThinStrokePath(const SkPath& path, SkScalar width,
+                                SkPaint::Cap cap, const SkRegion& clip,
+                                SkBlitter* blitter) {
+    SkASSERT(width > 0 && width <= kMaxThinStrokeWidth);
+    if (clip.isEmpty() || !(width > 0)) {
+        return;
+    }
+    if (width > kMaxThinStrokeWidth) {
+        width = kMaxThinStrokeWidth;
+    }
+
+    // anything more than this outside of the clip can't be seen
+    SkScalar outset = width + SK_Scalar1;
+    SkRect bounds;
+    bounds.set(clip.getBounds());
+    bounds.inset(-outset, -outset);
+
+    SkRect pathBounds = path.getBounds();
+    pathBounds.inset(-outset, -outset);
+    if (!pathBounds.intersect(bounds)) {
+        return;
+    }
+    SkIRect ir;
+    pathBounds.roundOut(&ir);
+
+    SkBlitterClipper    clipper;
+    blitter = clipper.apply(blitter, &clip, &ir);
+
+    ThinStroker     stroker(width, cap, bounds, blitter);
+    SkPath::Iter    iter(path, false);
+    SkPoint         pts[4];
+    SkPath::Verb    verb;
+
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                stroker.finish(false);
+                break;
+            case SkPath::kLine_Verb:
+                stroker.lineTo(pts[0], pts[1]);
+                break;
+            case SkPath::kQuad_Verb:
+                stroker.lineTo(pts[0], pts[2]);
+                break;
+            case SkPath::kCubic_Verb:
+                stroker.lineTo(pts[0], pts[3]);
+                break;
+            case SkPath::kClose_Verb:
+                stroker.finish(true);
+                break;
+            default:
+                break;
+        }
+    }
+    stroker.finish(false);
+}
@@ -22,7 +22,9 @@
 #include "SkPath.h"
 #include "SkQuadClipper.h"
 #include "SkRegion.h"
+#include "SkRunnable.h"
 #include "SkTemplates.h"
+#include "SkTSort.h"
 
 #define USE_NEW_BUILDER
 
@@ -203,6 +205,135 @@ static void walk_edges(SkEdge* prevHead, SkPath::FillType fillType,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  With thousands of edges, keeping them all in one linked list, sorted by Y
+    up front and by X as they become active, means chasing pointers through
+    every active edge (and those waiting to be) on each scanline. So instead
+    the edges are bucketed by their first Y, and the active ones kept in an
+    array, which is sorted by X with an insertion sort after each scanline
+    (from one scanline to the next, the order hardly changes).
+
+    This blits the same spans as walk_edges.
+ */
+#define MIN_EDGES_TO_BUCKET     256
+
+static inline void insert_edge_based_on_x(SkEdge* active[], int count,
+                                          SkEdge* edge) {
+    SkFixed x = edge->fX;
+    int i = count;
+    while (i > 0 && active[i - 1]->fX > x) {
+        active[i] = active[i - 1];
+        i -= 1;
+    }
+    active[i] = edge;
+}
+
+static void walk_bucketed_edges(SkEdge* list[], int count,
+                                SkPath::FillType fillType, SkBlitter* blitter,
+                                int start_y, int stop_y, PrePostProc proc) {
+    // like walk_edges, we always do at least one scanline
+    const int rows = SkMax32(stop_y - start_y, 1);
+
+    SkAutoScratch   storage;
+    SkEdge**        sorted = (SkEdge**)storage.alloc(2 * count * sizeof(SkEdge*) +
+                                                     (rows + 1) * sizeof(int));
+    SkEdge**        active = sorted + count;
+    int*            bucket = (int*)(active + count);
+
+    // count the edges starting on each scanline, then turn the counts into
+    // where each bucket ends, and fill the buckets from their ends (so that
+    // bucket[row] ends up where row's edges start)
+    sk_bzero(bucket, (rows + 1) * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        int row = list[i]->fFirstY - start_y;
+        if (row < rows) {
+            bucket[SkMax32(row, 0)] += 1;
+        }
+    }
+    for (int row = 1; row < rows; row++) {
+        bucket[row] += bucket[row - 1];
+    }
+    bucket[rows] = bucket[rows - 1];
+    for (int i = 0; i < count; i++) {
+        int row = list[i]->fFirstY - start_y;
+        if (row < rows) {
+            sorted[--bucket[SkMax32(row, 0)]] = list[i];
+        }
+    }
+
+    // returns 1 for evenodd, -1 for winding, regardless of inverse-ness
+    int windingMask = (fillType & 1) ? 1 : -1;
+    int activeCount = 0;
+
+    for (int row = 0; row < rows; row++) {
+        int curr_y = start_y + row;
+
+        for (int i = bucket[row]; i < bucket[row + 1]; i++) {
+            insert_edge_based_on_x(active, activeCount, sorted[i]);
+            activeCount += 1;
+        }
+
+        if (proc) {
+            proc(blitter, curr_y, PREPOST_START);    // pre-proc
+        }
+
+        int     w = 0;
+        int     left SK_INIT_TO_AVOID_WARNING;
+        bool    in_interval = false;
+        int     kept = 0;
+
+        for (int i = 0; i < activeCount; i++) {
+            SkEdge* currE = active[i];
+            SkASSERT(currE->fFirstY <= curr_y && currE->fLastY >= curr_y);
+
+            int x = (currE->fX + SK_Fixed1/2) >> 16;
+            w += currE->fWinding;
+            if ((w & windingMask) == 0) { // we finished an interval
+                SkASSERT(in_interval);
+                int width = x - left;
+                SkASSERT(width >= 0);
+                if (width)
+                    blitter->blitH(left, curr_y, width);
+                in_interval = false;
+            } else if (!in_interval) {
+                left = x;
+                in_interval = true;
+            }
+
+            if (currE->fLastY == curr_y) {    // are we done with this edge?
+                if (currE->fCurveCount < 0) {
+                    if (!((SkCubicEdge*)currE)->updateCubic()) {
+                        continue;
+                    }
+                    SkASSERT(currE->fFirstY == curr_y + 1);
+                } else if (currE->fCurveCount > 0) {
+                    if (!((SkQuadraticEdge*)currE)->updateQuadratic()) {
+                        continue;
+                    }
+                } else {
+                    continue;
+                }
+            } else {
+                currE->fX += currE->fDX;
+            }
+            active[kept++] = currE;
+        }
+        activeCount = kept;
+
+        if (proc) {
+            proc(blitter, curr_y, PREPOST_END);    // post-proc
+        }
+
+        // re-sort the edges that stay for the next scanline
+        for (int i = 1; i < activeCount; i++) {
+            if (active[i]->fX < active[i - 1]->fX) {
+                insert_edge_based_on_x(active, i, active[i]);
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 // this guy overrides blitH, and will call its proxy blitter with the inverse
 // of the spans it is given (clipped to the left/right of the cliprect)
 //
@@ -400,30 +531,20 @@ static int cheap_worst_case_edge_count(const SkPath& path, size_t* storage) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-extern "C" {
-    static int edge_compare(const void* a, const void* b) {
-        const SkEdge* edgea = *(const SkEdge**)a;
-        const SkEdge* edgeb = *(const SkEdge**)b;
-
-        int valuea = edgea->fFirstY;
-        int valueb = edgeb->fFirstY;
-
-        if (valuea == valueb) {
-            valuea = edgea->fX;
-            valueb = edgeb->fX;
+namespace {
+    // orders edges by the scanline they start on, and then by x
+    struct EdgeLT {
+        bool operator()(const SkEdge* a, const SkEdge* b) const {
+            if (a->fFirstY != b->fFirstY) {
+                return a->fFirstY < b->fFirstY;
+            }
+            return a->fX < b->fX;
         }
-
-        // this overflows if valuea >>> valueb or vice-versa
-        //     return valuea - valueb;
-        // do perform the slower but safe compares
-        return (valuea < valueb) ? -1 : (valuea > valueb);
-    }
+    };
 }
 
-static SkEdge* sort_edges(SkEdge* list[], int count, SkEdge** last) {
-    qsort(list, count, sizeof(SkEdge*), edge_compare);
-
-    // now make the edges linked in sorted order
+// links the edges in the order they are in list[]
+static SkEdge* link_edges(SkEdge* list[], int count, SkEdge** last) {
     for (int i = 1; i < count; i++) {
         list[i - 1]->fNext = list[i];
         list[i]->fPrev = list[i - 1];
@@ -433,6 +554,13 @@ static SkEdge* sort_edges(SkEdge* list[], int count, SkEdge** last) {
     return list[0];
 }
 
+static SkEdge* sort_edges(SkEdge* list[], int count, SkEdge** last) {
+    SkTIntroSort(list, count, EdgeLT());
+
+    // now make the edges linked in sorted order
+    return link_edges(list, count, last);
+}
+
 // clipRect may be null, even though we always have a clip. This indicates that
 // the path is contained in the clip, and so we can ignore it during the blit
 //
@@ -481,6 +609,30 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect, SkBlitter* blitte
         return;
     }
 
+    start_y <<= shiftEdgesUp;
+    stop_y <<= shiftEdgesUp;
+    if (clipRect && start_y < clipRect->fTop) {
+        start_y = clipRect->fTop;
+    }
+    if (clipRect && stop_y > clipRect->fBottom) {
+        stop_y = clipRect->fBottom;
+    }
+
+    InverseBlitter  ib;
+    PrePostProc     proc = NULL;
+
+    if (path.isInverseFillType()) {
+        ib.setBlitter(blitter, clipRgn.getBounds(), shiftEdgesUp);
+        blitter = &ib;
+        proc = PrePostInverseBlitterProc;
+    }
+
+    if (count >= MIN_EDGES_TO_BUCKET) {
+        walk_bucketed_edges(list, count, path.getFillType(), blitter,
+                            start_y, stop_y, proc);
+        return;
+    }
+
     SkEdge headEdge, tailEdge, *last;
     // this returns the first and last edge after they're sorted into a dlink list
     SkEdge* edge = sort_edges(list, count, &last);
@@ -498,27 +650,251 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect, SkBlitter* blitte
 
     // now edge is the head of the sorted linklist
 
-    start_y <<= shiftEdgesUp;
-    stop_y <<= shiftEdgesUp;
-    if (clipRect && start_y < clipRect->fTop) {
-        start_y = clipRect->fTop;
+    walk_edges(&headEdge, path.getFillType(), blitter, start_y, stop_y, proc);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  A band that starts partway down the path can't simply sort the edges it
+    starts with by X, as the serial walk has them in an order that depends on
+    what came before wherever two of them have the same X. So bands only start
+    on scanlines where that can't matter: where no two edges are at the same
+    X, except for lines that have been together since the later of them
+    started (e.g. the edge between two tiles of a mesh), which both walks keep
+    in the order they took them up in.
+ */
+
+// a band that can't start where it would is moved down this many times
+#define MAX_BAND_TOP_TRIES  8
+// bands are at least this many (pixel) scanlines tall
+#define MIN_BAND_ROWS       32
+
+static inline size_t edge_size(const SkEdge* edge) {
+    if (edge->fCurveCount < 0) {
+        return sizeof(SkCubicEdge);
     }
-    if (clipRect && stop_y > clipRect->fBottom) {
-        stop_y = clipRect->fBottom;
+    if (edge->fCurveCount > 0) {
+        return sizeof(SkQuadraticEdge);
     }
+    return sizeof(SkEdge);
+}
 
-    InverseBlitter  ib;
-    PrePostProc     proc = NULL;
+// steps the edge down to scanline y, returning false if it ends above it
+static bool step_edge_to(SkEdge* edge, int y) {
+    while (edge->fLastY < y) {
+        if (edge->fCurveCount < 0) {
+            if (!((SkCubicEdge*)edge)->updateCubic()) {
+                return false;
+            }
+        } else if (edge->fCurveCount > 0) {
+            if (!((SkQuadraticEdge*)edge)->updateQuadratic()) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    if (edge->fFirstY < y) {
+        edge->fX += edge->fDX * (y - edge->fFirstY);
+        edge->fFirstY = y;
+    }
+    return true;
+}
 
-    if (path.isInverseFillType()) {
-        ib.setBlitter(blitter, clipRgn.getBounds(), shiftEdgesUp);
-        blitter = &ib;
-        proc = PrePostInverseBlitterProc;
+namespace {
+    struct BandEdge {
+        SkEdge* fEdge;
+        int     fOrder;     // where the serial walk takes the edge up
+        bool    fIsLine;
+    };
+
+    // the order the walk for a band starts its active edges in
+    struct BandEdgeLT {
+        bool operator()(const BandEdge& a, const BandEdge& b) const {
+            if (a.fEdge->fX != b.fEdge->fX) {
+                return a.fEdge->fX < b.fEdge->fX;
+            }
+            return a.fOrder < b.fOrder;
+        }
+    };
+
+    struct EdgeFirstY {
+        int32_t operator()(const SkEdge* edge) const {
+            return edge->fFirstY;
+        }
+    };
+}
+
+bool SkBandedEdges::build(const SkPath& path, const SkIRect* clipRect,
+                          int shiftEdgesUp) {
+    SkASSERT(!path.isInverseFillType());
+
+    int count = fBuilder.build(path, clipRect, shiftEdgesUp);
+    if (count < 2) {
+        return false;
+    }
+    SkEdge** list = fBuilder.edgeList();
+
+    fFillType = path.getFillType();
+    fBucketed = count >= MIN_EDGES_TO_BUCKET;
+    fOrder.setCount(count);
+    if (fBucketed) {
+        // the order walk_bucketed_edges takes edges up in: by fFirstY, and
+        // the later ones in list first, which the stable sort of the
+        // reversed list keeps
+        for (int i = 0; i < count; i++) {
+            fOrder[i] = list[count - 1 - i];
+        }
+        SkTRadixSort(fOrder.begin(), count, EdgeFirstY());
+    } else {
+        // the same sort as sk_fill_path's, of the same list
+        memcpy(fOrder.begin(), list, count * sizeof(SkEdge*));
+        SkTIntroSort(fOrder.begin(), count, EdgeLT());
     }
 
-    walk_edges(&headEdge, path.getFillType(), blitter, start_y, stop_y, proc);
+    fEdgeBytes = 0;
+    for (int i = 0; i < count; i++) {
+        fEdgeBytes += edge_size(list[i]);
+    }
+    return true;
+}
+
+/*  Copies the edges that reach down to scanline y (but start above stop_y)
+    into storage, stepped down to y, and sets *list to them in the order the
+    walk for the band takes them. Returns false if a band starting at y
+    might not blit the same as the serial walk.
+ */
+bool SkBandedEdges::prepare(int y, int stop_y, SkAutoScratch* storage,
+                            SkEdge*** listPtr, int* countPtr) const {
+    const int count = fOrder.count();
+    storage->reset();
+    SkEdge** list = (SkEdge**)storage->alloc(
+            count * (sizeof(SkEdge*) + sizeof(BandEdge)) + fEdgeBytes);
+    BandEdge* active = (BandEdge*)(list + count);
+    char* edgeStorage = (char*)(active + count);
+
+    // fOrder is sorted by fFirstY, so the edges already on scanline y come
+    // first
+    int activeCount = 0;
+    int listCount = 0;
+    for (int i = 0; i < count; i++) {
+        const SkEdge* src = fOrder[i];
+        if (src->fFirstY >= stop_y) {
+            break;
+        }
+        size_t size = edge_size(src);
+        SkEdge* edge = (SkEdge*)edgeStorage;
+        memcpy(edge, src, size);
+        if (src->fFirstY <= y) {
+            if (!step_edge_to(edge, y)) {
+                continue;
+            }
+            active[activeCount].fEdge = edge;
+            active[activeCount].fOrder = i;
+            active[activeCount].fIsLine = 0 == src->fCurveCount;
+            activeCount += 1;
+        } else {
+            list[listCount++] = edge;
+        }
+        edgeStorage += size;
+    }
+
+    bool canStart = true;
+    SkTIntroSort(active, activeCount, BandEdgeLT());
+    for (int i = 1; i < activeCount; i++) {
+        const BandEdge& prev = active[i - 1];
+        const BandEdge& curr = active[i];
+        if (prev.fEdge->fX == curr.fEdge->fX &&
+                !(prev.fIsLine && curr.fIsLine &&
+                  prev.fEdge->fDX == curr.fEdge->fDX)) {
+            canStart = false;
+            break;
+        }
+    }
+
+    // the active edges go in front of the rest, sorted by X
+    memmove(list + activeCount, list, listCount * sizeof(SkEdge*));
+    for (int i = 0; i < activeCount; i++) {
+        list[i] = active[i].fEdge;
+    }
+    listCount += activeCount;
+
+    if (fBucketed) {
+        // walk_bucketed_edges takes up each scanline's edges back to front
+        for (int i = 0, j = listCount - 1; i < j; i++, j--) {
+            SkTSwap(list[i], list[j]);
+        }
+    }
+
+    *listPtr = list;
+    *countPtr = listCount;
+    return canStart;
+}
+
+int SkBandedEdges::split(int start_y, int stop_y, int step, int maxBands,
+                         int tops[]) const {
+    SkASSERT(maxBands <= SkScan::kMaxFillBands);
+
+    const int rows = (stop_y - start_y) / step;
+    const int bands = SkMin32(maxBands, rows / MIN_BAND_ROWS);
+
+    SkAutoScratch storage;
+    SkEdge** list;
+    int count;
+    int n = 0;
+
+    tops[n++] = start_y;
+    for (int i = 1; i < bands; i++) {
+        int y = start_y + rows * i / bands * step;
+        y = SkMax32(y, tops[n - 1] + step);
+        for (int tries = 0; tries < MAX_BAND_TOP_TRIES && y < stop_y;
+                tries++, y += step) {
+            if (this->prepare(y, stop_y, &storage, &list, &count)) {
+                tops[n++] = y;
+                break;
+            }
+        }
+    }
+    tops[n] = stop_y;
+    return n;
+}
+
+void SkBandedEdges::walk(SkBlitter* blitter, int start_y, int stop_y) const {
+    SkAutoScratch storage;
+    SkEdge** list;
+    int count;
+    this->prepare(start_y, stop_y, &storage, &list, &count);
+
+    if (fBucketed) {
+        walk_bucketed_edges(list, count, fFillType, blitter, start_y, stop_y,
+                            NULL);
+        return;
+    }
+
+    SkEdge headEdge, tailEdge;
+    headEdge.fPrev = NULL;
+    headEdge.fFirstY = kEDGE_HEAD_Y;
+    headEdge.fX = SK_MinS32;
+    tailEdge.fNext = NULL;
+    tailEdge.fFirstY = kEDGE_TAIL_Y;
+
+    if (count > 0) {
+        SkEdge* last;
+        SkEdge* edge = link_edges(list, count, &last);
+        headEdge.fNext = edge;
+        edge->fPrev = &headEdge;
+        tailEdge.fPrev = last;
+        last->fNext = &tailEdge;
+    } else {
+        headEdge.fNext = &tailEdge;
+        tailEdge.fPrev = &headEdge;
+    }
+
+    walk_edges(&headEdge, fFillType, blitter, start_y, stop_y, NULL);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
 void sk_blit_above(SkBlitter* blitter, const SkIRect& ir, const SkRegion& clip) {
     const SkIRect& cr = clip.getBounds();
     SkIRect tmp;
@@ -611,6 +987,79 @@ void SkScan::FillPath(const SkPath& path, const SkRegion& clip,
     }
 }
 
+namespace {
+    class FillBand : public SkRunnable {
+    public:
+        void set(const SkBandedEdges* edges, SkBlitter* blitter,
+                 const SkRegion* clip, const SkIRect& ir, int top, int bottom) {
+            fEdges = edges;
+            fBlitter = blitter;
+            fClip = clip;
+            fIR = ir;
+            fTop = top;
+            fBottom = bottom;
+        }
+
+        virtual void run() {
+            // the clipper's blitters are per band too
+            SkScanClipper clipper(fBlitter, fClip, fIR);
+            fEdges->walk(clipper.getBlitter(), fTop, fBottom);
+        }
+
+    private:
+        const SkBandedEdges*    fEdges;
+        SkBlitter*              fBlitter;
+        const SkRegion*         fClip;
+        SkIRect                 fIR;
+        int                     fTop, fBottom;
+    };
+}
+
+void SkScan::FillPath(const SkPath& path, const SkRegion& clip,
+                      SkBlitter* blitters[], int count, SkExecutor* executor) {
+    SkIRect ir;
+    path.getBounds().round(&ir);
+    if (count < 2 || NULL == executor || path.isInverseFillType() ||
+            clip.isEmpty() || ir.isEmpty()) {
+        SkScan::FillPath(path, clip, blitters[0]);
+        return;
+    }
+
+    SkScanClipper clipper(blitters[0], &clip, ir);
+    if (NULL == clipper.getBlitter()) {
+        return;
+    }
+    const SkIRect* clipRect = clipper.getClipRect();
+
+    int start_y = ir.fTop;
+    int stop_y = ir.fBottom;
+    if (clipRect && start_y < clipRect->fTop) {
+        start_y = clipRect->fTop;
+    }
+    if (clipRect && stop_y > clipRect->fBottom) {
+        stop_y = clipRect->fBottom;
+    }
+
+    SkBandedEdges edges;
+    if (!edges.build(path, clipRect, 0)) {
+        return;
+    }
+
+    int tops[SkScan::kMaxFillBands + 1];
+    count = edges.split(start_y, stop_y, 1,
+                        SkMin32(count, SkScan::kMaxFillBands), tops);
+
+    FillBand bands[SkScan::kMaxFillBands];
+    for (int i = 0; i < count; i++) {
+        bands[i].set(&edges, blitters[i], &clip, ir, tops[i], tops[i + 1]);
+    }
+    for (int i = 1; i < count; i++) {
+        executor->add(&bands[i]);
+    }
+    bands[0].run();
+    executor->wait();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static int build_tri_edges(SkEdge edge[], const SkPoint pts[],
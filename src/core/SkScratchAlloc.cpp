@@ -0,0 +1,129 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkScratchAlloc.h"
+#include "SkTLS.h"
+
+// blocks are at least this big, and grow (by doubling) from here
+#define MIN_BLOCK_SIZE      (16 * 1024)
+// once the outermost scope ends, more than this isn't kept for the next draw
+#define MAX_RETAINED_SIZE   (1024 * 1024)
+
+struct SkScratchAlloc::Block {
+    Block*  fNext;
+    size_t  fSize;
+    size_t  fUsed;
+
+    char* data() { return (char*)this + kHeaderSize; }
+
+    // keeps data() 8-byte aligned
+    static const size_t kHeaderSize;
+};
+
+const size_t SkScratchAlloc::Block::kHeaderSize = SkAlign8(sizeof(Block));
+
+SkScratchAlloc::SkScratchAlloc()
+    : fHead(NULL), fCurr(NULL), fTotalCapacity(0), fDepth(0) {}
+
+SkScratchAlloc::~SkScratchAlloc() {
+    SkASSERT(0 == fDepth);
+    this->freeBlocks();
+}
+
+static void* create_scratch_alloc() {
+    return SkNEW(SkScratchAlloc);
+}
+
+static void delete_scratch_alloc(void* ptr) {
+    SkDELETE((SkScratchAlloc*)ptr);
+}
+
+SkScratchAlloc* SkScratchAlloc::Get() {
+    return (SkScratchAlloc*)SkTLS::Get(create_scratch_alloc,
+                                       delete_scratch_alloc);
+}
+
+void SkScratchAlloc::freeBlocks() {
+    Block* block = fHead;
+    while (block) {
+        Block* next = block->fNext;
+        sk_free(block);
+        block = next;
+    }
+    fHead = fCurr = NULL;
+    fTotalCapacity = 0;
+}
+
+void* SkScratchAlloc::alloc(size_t bytes) {
+    // so that every allocation is 8-byte aligned
+    bytes = SkAlign8(bytes);
+
+    if (fCurr && fCurr->fSize - fCurr->fUsed >= bytes) {
+        void* ptr = fCurr->data() + fCurr->fUsed;
+        fCurr->fUsed += bytes;
+        return ptr;
+    }
+
+    // the blocks after fCurr are all free
+    Block** link = fCurr ? &fCurr->fNext : &fHead;
+    Block* next = *link;
+    if (NULL == next || next->fSize < bytes) {
+        size_t size = fCurr ? fCurr->fSize * 2 : MIN_BLOCK_SIZE;
+        if (size < bytes) {
+            size = bytes;
+        }
+        Block* block = (Block*)sk_malloc_throw(Block::kHeaderSize + size);
+        block->fNext = next;
+        block->fSize = size;
+        fTotalCapacity += size;
+        *link = block;
+        next = block;
+    }
+    fCurr = next;
+    fCurr->fUsed = bytes;
+    return fCurr->data();
+}
+
+void SkScratchAlloc::mark(Mark* mark) const {
+    mark->fBlock = fCurr;
+    mark->fUsed = fCurr ? fCurr->fUsed : 0;
+}
+
+void SkScratchAlloc::rewind(const Mark& mark) {
+    fCurr = mark.fBlock;
+    if (fCurr) {
+        fCurr->fUsed = mark.fUsed;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkAutoScratch::SkAutoScratch() {
+    fAlloc = SkScratchAlloc::Get();
+    fAlloc->mark(&fMark);
+    fAlloc->fDepth += 1;
+    SkDEBUGCODE(fDepth = fAlloc->fDepth;)
+}
+
+SkAutoScratch::~SkAutoScratch() {
+    SkASSERT(fAlloc->fDepth == fDepth);
+    fAlloc->rewind(fMark);
+    fAlloc->fDepth -= 1;
+    if (0 == fAlloc->fDepth &&
+            fAlloc->fTotalCapacity > MAX_RETAINED_SIZE) {
+        fAlloc->freeBlocks();
+    }
+}
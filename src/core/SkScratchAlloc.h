@@ -0,0 +1,98 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkScratchAlloc_DEFINED
+#define SkScratchAlloc_DEFINED
+
+#include "SkTypes.h"
+
+/** \class SkScratchAlloc
+
+    A stack of memory for the temporaries of a single draw, one for each
+    thread. Allocations are freed all at once, by rewinding to a mark taken
+    earlier, and the blocks are kept for the next draw, so drawing the same
+    things over again doesn't go to the heap. Use it through SkAutoScratch.
+*/
+class SkScratchAlloc : SkNoncopyable {
+public:
+    SkScratchAlloc();
+    ~SkScratchAlloc();
+
+    /** Return the calling thread's allocator. */
+    static SkScratchAlloc* Get();
+
+    /** Return the bytes held in blocks, used or not. */
+    size_t totalCapacity() const { return fTotalCapacity; }
+
+private:
+    struct Block;
+
+    struct Mark {
+        Block*  fBlock;
+        size_t  fUsed;
+    };
+
+    Block*  fHead;      // blocks in the order they are used, then spares
+    Block*  fCurr;      // the block being allocated from, or null
+    size_t  fTotalCapacity;
+    int     fDepth;     // number of SkAutoScratch scopes alive
+
+    void* alloc(size_t bytes);
+    void mark(Mark*) const;
+    void rewind(const Mark&);
+    void freeBlocks();
+
+    friend class SkAutoScratch;
+};
+
+/** \class SkAutoScratch
+
+    Marks the calling thread's SkScratchAlloc, and rewinds it to the mark when
+    it goes out of scope, freeing whatever was allocated through it. Scopes
+    nest: only the innermost one may allocate (or reset), so an object holding
+    one has to live in a single function's scope, e.g. on the stack.
+*/
+class SkAutoScratch : SkNoncopyable {
+public:
+    SkAutoScratch();
+    ~SkAutoScratch();
+
+    /** Return bytes (aligned for any type) that stay valid until this scope
+        ends or is reset. Throws (like sk_malloc_throw) if out of memory.
+    */
+    void* alloc(size_t bytes) {
+        SkASSERT(fAlloc->fDepth == fDepth);
+        return fAlloc->alloc(bytes);
+    }
+
+    /** Free everything allocated through this scope so far. */
+    void reset() {
+        SkASSERT(fAlloc->fDepth == fDepth);
+        fAlloc->rewind(fMark);
+    }
+
+private:
+    SkScratchAlloc*         fAlloc;
+    SkScratchAlloc::Mark    fMark;
+    SkDEBUGCODE(int         fDepth;)
+};
+
+/** Typed version of SkAutoScratch::alloc(). */
+template <typename T> T* SkScratchAllocT(SkAutoScratch* scratch, size_t count) {
+    return static_cast<T*>(scratch->alloc(count * sizeof(T)));
+}
+
+#endif
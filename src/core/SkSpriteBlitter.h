@@ -45,6 +45,14 @@ public:
                                       void* storage, size_t storageSize);
 
 protected:
+    /*  For the sprites that go through SkPMColors to get at the 32bit blit
+        row procs and xfermodes: converts count pixels of fSource, starting at
+        (x, y) in its coordinates, scaling them by scale (1...256). ctable is
+        the source's locked colors, if it is kIndex8.
+    */
+    void convertRow(SkPMColor dst[], int x, int y, int count,
+                    const SkPMColor* ctable, unsigned scale) const;
+
     const SkBitmap* fDevice;
     const SkBitmap* fSource;
     int             fLeft, fTop;
@@ -271,6 +271,70 @@ public:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  Handles the sources and paints that have no sprite of their own above,
+    by converting each row to SkPMColors and handing it to the blit row procs
+    or the xfermode. With an xfermode or a filter, alpha is applied first, the
+    way the bitmap shaders do, since neither of those takes a global alpha.
+ */
+class Sprite_D32_Convert : public Sprite_D32_XferFilter {
+public:
+    Sprite_D32_Convert(const SkBitmap& source, const SkPaint& paint)
+            : Sprite_D32_XferFilter(source, paint) {
+        fSrcScale = 256;
+        if (fXfermode || fColorFilter) {
+            fSrcScale = SkAlpha255To256(fAlpha);
+            fAlpha = 255;
+            fProc32 = SkBlitRow::Factory32(SkBlitRow::kSrcPixelAlpha_Flag32);
+        }
+        fDirect = NULL == fXfermode && NULL == fColorFilter &&
+                  255 == fAlpha && source.isOpaque();
+    }
+
+    virtual void blitRect(int x, int y, int width, int height) {
+        SkASSERT(width > 0 && height > 0);
+        SkPMColor* SK_RESTRICT dst = fDevice->getAddr32(x, y);
+        unsigned dstRB = fDevice->rowBytes();
+        SkPMColor* SK_RESTRICT buffer = fDirect ? NULL : fBuffer;
+        SkColorFilter* colorFilter = fColorFilter;
+        SkXfermode* xfermode = fXfermode;
+
+        SkColorTable* ctable = fSource->getColorTable();
+        const SkPMColor* colors = ctable ? ctable->lockColors() : NULL;
+
+        x -= fLeft;
+        y -= fTop;
+        do {
+            if (NULL == buffer) {
+                this->convertRow(dst, x, y, width, colors, 256);
+            } else {
+                this->convertRow(buffer, x, y, width, colors, fSrcScale);
+                if (NULL != colorFilter) {
+                    colorFilter->filterSpan(buffer, width, buffer);
+                }
+                if (NULL != xfermode) {
+                    xfermode->xfer32(dst, buffer, width, NULL);
+                } else {
+                    fProc32(dst, buffer, width, fAlpha);
+                }
+            }
+            y += 1;
+            dst = (SkPMColor* SK_RESTRICT)((char*)dst + dstRB);
+        } while (--height != 0);
+
+        if (ctable) {
+            ctable->unlockColors(false);
+        }
+    }
+
+private:
+    unsigned    fSrcScale;
+    bool        fDirect;    // opaque copy, converts straight into the device
+
+    typedef Sprite_D32_XferFilter INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 #include "SkTemplatesPriv.h"
 
 SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source,
@@ -288,9 +352,9 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source,
     switch (source.getConfig()) {
         case SkBitmap::kARGB_4444_Config:
             if (alpha != 0xFF) {
-                return NULL;    // we only have opaque sprites
-            }
-            if (xfermode || filter) {
+                SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D32_Convert,
+                                      storage, storageSize, (source, paint));
+            } else if (xfermode || filter) {
                 SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D32_S4444_XferFilter,
                                       storage, storageSize, (source, paint));
             } else if (source.isOpaque()) {
@@ -307,6 +371,9 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source,
                     // this can handle xfermode or filter, but not alpha
                     SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D32_S32A_XferFilter,
                                       storage, storageSize, (source, paint));
+                } else {
+                    SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D32_Convert,
+                                      storage, storageSize, (source, paint));
                 }
             } else {
                 // this can handle alpha, but not xfermode or filter
@@ -314,6 +381,12 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source,
                               storage, storageSize, (source, alpha));
             }
             break;
+        case SkBitmap::kRGB_565_Config:
+        case SkBitmap::kIndex8_Config:
+        case SkBitmap::kRLE_Index8_Config:
+            SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D32_Convert,
+                                  storage, storageSize, (source, paint));
+            break;
         default:
             break;
     }
@@ -17,9 +17,12 @@
 
 #include "SkSpriteBlitter.h"
 #include "SkBlitRow.h"
+#include "SkColorFilter.h"
+#include "SkPackBits.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include "SkColorPriv.h"
+#include "SkXfermode.h"
 
 #define D16_S32A_Opaque_Pixel(dst, sc)                                        \
 do {                                                                          \
@@ -314,6 +317,137 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// unpacks each row's runs straight into the device, through the 16bit cache
+class Sprite_D16_SRLE_Opaque : public SkSpriteBlitter {
+public:
+    Sprite_D16_SRLE_Opaque(const SkBitmap& source)
+        : SkSpriteBlitter(source) {}
+
+    // overrides
+    virtual void blitRect(int x, int y, int width, int height) {
+        uint16_t* SK_RESTRICT dst = fDevice->getAddr16(x, y);
+        unsigned dstRB = fDevice->rowBytes();
+        const SkBitmap::RLEPixels* rle =
+                                (const SkBitmap::RLEPixels*)fSource->getPixels();
+        SkColorTable* ctable = fSource->getColorTable();
+        const uint16_t* table16 = ctable->lock16BitCache();
+
+        x -= fLeft;
+        y -= fTop;
+        while (--height >= 0) {
+            SkPackBits::Unpack8To16(dst, x, width, rle->packedAtY(y), table16);
+            y += 1;
+            dst = (uint16_t*)((char*)dst + dstRB);
+        }
+        ctable->unlock16BitCache();
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  Handles xfermodes and color filters for every source, dithered kIndex8
+    sources and the kRLE_Index8 ones that Sprite_D16_SRLE_Opaque can't, by
+    converting each row to SkPMColors and handing it to the 32bit blit row
+    procs or the xfermode. With an xfermode or a filter, alpha is applied
+    first, the way the bitmap shaders do.
+ */
+class Sprite_D16_Convert : public SkSpriteBlitter {
+public:
+    Sprite_D16_Convert(const SkBitmap& source, const SkPaint& paint)
+            : SkSpriteBlitter(source) {
+        fColorFilter = paint.getColorFilter();
+        SkSafeRef(fColorFilter);
+
+        fXfermode = paint.getXfermode();
+        SkSafeRef(fXfermode);
+
+        fBufferSize = 0;
+        fBuffer = NULL;
+
+        unsigned flags = 0;
+        fAlpha = paint.getAlpha();
+        fSrcScale = 256;
+        if (fXfermode || fColorFilter) {
+            fSrcScale = SkAlpha255To256(fAlpha);
+            fAlpha = 255;
+            flags |= SkBlitRow::kSrcPixelAlpha_Flag;
+        } else {
+            if (fAlpha < 0xFF) {
+                flags |= SkBlitRow::kGlobalAlpha_Flag;
+            }
+            if (!source.isOpaque()) {
+                flags |= SkBlitRow::kSrcPixelAlpha_Flag;
+            }
+        }
+        if (paint.isDither()) {
+            flags |= SkBlitRow::kDither_Flag;
+        }
+        fProc = SkBlitRow::Factory(flags, SkBitmap::kRGB_565_Config);
+    }
+
+    virtual ~Sprite_D16_Convert() {
+        delete[] fBuffer;
+        SkSafeUnref(fXfermode);
+        SkSafeUnref(fColorFilter);
+    }
+
+    virtual void setup(const SkBitmap& device, int left, int top,
+                       const SkPaint& paint) {
+        this->INHERITED::setup(device, left, top, paint);
+
+        int width = device.width();
+        if (width > fBufferSize) {
+            fBufferSize = width;
+            delete[] fBuffer;
+            fBuffer = new SkPMColor[width];
+        }
+    }
+
+    virtual void blitRect(int x, int y, int width, int height) {
+        SkASSERT(width > 0 && height > 0);
+        uint16_t* SK_RESTRICT dst = fDevice->getAddr16(x, y);
+        unsigned dstRB = fDevice->rowBytes();
+        SkPMColor* SK_RESTRICT buffer = fBuffer;
+        SkColorFilter* colorFilter = fColorFilter;
+        SkXfermode* xfermode = fXfermode;
+
+        SkColorTable* ctable = fSource->getColorTable();
+        const SkPMColor* colors = ctable ? ctable->lockColors() : NULL;
+
+        do {
+            this->convertRow(buffer, x - fLeft, y - fTop, width, colors,
+                             fSrcScale);
+            if (NULL != colorFilter) {
+                colorFilter->filterSpan(buffer, width, buffer);
+            }
+            if (NULL != xfermode) {
+                xfermode->xfer16(dst, buffer, width, NULL);
+            } else {
+                fProc(dst, buffer, width, fAlpha, x, y);
+            }
+            y += 1;
+            dst = (uint16_t* SK_RESTRICT)((char*)dst + dstRB);
+        } while (--height != 0);
+
+        if (ctable) {
+            ctable->unlockColors(false);
+        }
+    }
+
+private:
+    SkColorFilter*  fColorFilter;
+    SkXfermode*     fXfermode;
+    int             fBufferSize;
+    SkPMColor*      fBuffer;
+    SkBlitRow::Proc fProc;
+    U8CPU           fAlpha;
+    unsigned        fSrcScale;
+
+    typedef SkSpriteBlitter INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 #include "SkTemplatesPriv.h"
 
 SkSpriteBlitter* SkSpriteBlitter::ChooseD16(const SkBitmap& source,
@@ -322,16 +456,26 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD16(const SkBitmap& source,
     if (paint.getMaskFilter() != NULL) { // may add cases for this
         return NULL;
     }
-    if (paint.getXfermode() != NULL) { // may add cases for this
-        return NULL;
-    }
-    if (paint.getColorFilter() != NULL) { // may add cases for this
-        return NULL;
-    }
 
     SkSpriteBlitter* blitter = NULL;
     unsigned alpha = paint.getAlpha();
 
+    if (paint.getXfermode() != NULL || paint.getColorFilter() != NULL) {
+        switch (source.getConfig()) {
+            case SkBitmap::kARGB_8888_Config:
+            case SkBitmap::kARGB_4444_Config:
+            case SkBitmap::kRGB_565_Config:
+            case SkBitmap::kIndex8_Config:
+            case SkBitmap::kRLE_Index8_Config:
+                SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D16_Convert,
+                                      storage, storageSize, (source, paint));
+                break;
+            default:
+                break;
+        }
+        return blitter;
+    }
+
     switch (source.getConfig()) {
         case SkBitmap::kARGB_8888_Config:
             SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D16_S32_BlitRowProc,
@@ -357,7 +501,9 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD16(const SkBitmap& source,
             break;
         case SkBitmap::kIndex8_Config:
             if (paint.isDither()) {
-                // we don't support dither yet in these special cases
+                // the special cases below don't dither
+                SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D16_Convert,
+                                      storage, storageSize, (source, paint));
                 break;
             }
             if (source.isOpaque()) {
@@ -378,6 +524,15 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD16(const SkBitmap& source,
                 }
             }
             break;
+        case SkBitmap::kRLE_Index8_Config:
+            if (source.isOpaque() && 255 == alpha && !paint.isDither()) {
+                SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D16_SRLE_Opaque,
+                                      storage, storageSize, (source));
+            } else {
+                SK_PLACEMENT_NEW_ARGS(blitter, Sprite_D16_Convert,
+                                      storage, storageSize, (source, paint));
+            }
+            break;
         default:
             break;
     }
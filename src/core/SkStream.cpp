@@ -35,6 +35,12 @@ const void* SkStream::getMemoryBase()
     return NULL;
 }
 
+bool SkStream::prefetch(size_t offset, size_t length)
+{
+    // override in subclass if reads can be started early
+    return false;
+}
+
 size_t SkStream::skip(size_t size)
 {
     /*  Check for size == 0, and just return 0. If we passed that
@@ -119,9 +125,9 @@ bool SkWStream::writeText(const char text[])
 
 bool SkWStream::writeDecAsText(int32_t dec)
 {
-    SkString    tmp;
-    tmp.appendS32(dec);
-    return this->write(tmp.c_str(), tmp.size());
+    char    buffer[SkStrAppendS32_MaxSize];
+    char*   stop = SkStrAppendS32(buffer, dec);
+    return this->write(buffer, stop - buffer);
 }
 
 bool SkWStream::writeBigDecAsText(int64_t dec, int minDigits)
@@ -140,9 +146,9 @@ bool SkWStream::writeHexAsText(uint32_t hex, int digits)
 
 bool SkWStream::writeScalarAsText(SkScalar value)
 {
-    SkString    tmp;
-    tmp.appendScalar(value);
-    return this->write(tmp.c_str(), tmp.size());
+    char    buffer[SkStrAppendScalar_MaxSize];
+    char*   stop = SkStrAppendScalar(buffer, value);
+    return this->write(buffer, stop - buffer);
 }
 
 bool SkWStream::write8(U8CPU value) {
@@ -198,6 +204,15 @@ bool SkWStream::writeData(const SkData* data) {
     return true;
 }
 
+bool SkWStream::writev(const Chunk chunks[], int count) {
+    for (int i = 0; i < count; i++) {
+        if (!this->write(chunks[i].fData, chunks[i].fSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkFILEStream::SkFILEStream(const char file[]) : fName(file)
@@ -253,6 +268,11 @@ size_t SkFILEStream::read(void* buffer, size_t size)
     return 0;
 }
 
+bool SkFILEStream::prefetch(size_t offset, size_t length)
+{
+    return fFILE && length && sk_fprefetch(fFILE, offset, length);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static SkData* newFromParams(const void* src, size_t size, bool copyData) {
@@ -502,16 +522,25 @@ const void* SkBufferStream::getMemoryBase()
     return fProxy->getMemoryBase();
 }
 
+bool SkBufferStream::prefetch(size_t offset, size_t length)
+{
+    // our offsets are the proxy's, we just read it in smaller pieces
+    return fProxy->prefetch(offset, length);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-SkFILEWStream::SkFILEWStream(const char path[])
+SkFILEWStream::SkFILEWStream(const char path[]) : fBufferUsed(0)
 {
     fFILE = sk_fopen(path, kWrite_SkFILE_Flag);
 }
 
 SkFILEWStream::~SkFILEWStream()
 {
+    if (fFILE) {
+        this->writeBuffer();
+    }
     if (fFILE)
         sk_fclose(fFILE);
 }
@@ -521,6 +550,36 @@ bool SkFILEWStream::write(const void* buffer, size_t size)
     if (fFILE == NULL)
         return false;
 
+    if (fBufferUsed + size <= kBufferSize) {
+        memcpy(fBuffer + fBufferUsed, buffer, size);
+        fBufferUsed += size;
+        return true;
+    }
+    if (!this->writeBuffer())
+        return false;
+    // what's too big to buffer may as well go straight to the file
+    if (size >= kBufferSize)
+        return this->writeFile(buffer, size);
+    memcpy(fBuffer, buffer, size);
+    fBufferUsed = size;
+    return true;
+}
+
+void SkFILEWStream::flush()
+{
+    if (fFILE && this->writeBuffer())
+        sk_fflush(fFILE);
+}
+
+bool SkFILEWStream::writeBuffer()
+{
+    size_t size = fBufferUsed;
+    fBufferUsed = 0;
+    return 0 == size || this->writeFile(fBuffer, size);
+}
+
+bool SkFILEWStream::writeFile(const void* buffer, size_t size)
+{
     if (sk_fwrite(buffer, size, fFILE) != size)
     {
         SkDEBUGCODE(SkDebugf("SkFILEWStream failed writing %d bytes\n", size);)
@@ -531,12 +590,6 @@ bool SkFILEWStream::write(const void* buffer, size_t size)
     return true;
 }
 
-void SkFILEWStream::flush()
-{
-    if (fFILE)
-        sk_fflush(fFILE);
-}
-
 ////////////////////////////////////////////////////////////////////////
 
 SkMemoryWStream::SkMemoryWStream(void* buffer, size_t size)
@@ -559,6 +612,8 @@ bool SkMemoryWStream::write(const void* buffer, size_t size)
 ////////////////////////////////////////////////////////////////////////
 
 #define SkDynamicMemoryWStream_MinBlockSize   256
+// blocks are as big as what has been written so far, up to this
+#define SkDynamicMemoryWStream_MaxGrowSize    (64 * 1024)
 
 struct SkDynamicMemoryWStream::Block {
     Block*  fNext;
@@ -586,9 +641,11 @@ struct SkDynamicMemoryWStream::Block {
     }
 };
 
-SkDynamicMemoryWStream::SkDynamicMemoryWStream()
+SkDynamicMemoryWStream::SkDynamicMemoryWStream(size_t minBlockSize)
     : fHead(NULL), fTail(NULL), fBytesWritten(0), fCopy(NULL)
 {
+    fMinBlockSize = minBlockSize ? minBlockSize :
+                                   SkDynamicMemoryWStream_MinBlockSize;
 }
 
 SkDynamicMemoryWStream::~SkDynamicMemoryWStream()
@@ -628,21 +685,27 @@ bool SkDynamicMemoryWStream::write(const void* buffer, size_t count)
             if (count == 0)
                 return true;
         }
-            
-        size = SkMax32(count, SkDynamicMemoryWStream_MinBlockSize);
-        Block* block = (Block*)sk_malloc_throw(sizeof(Block) + size);
-        block->init(size);
-        block->append(buffer, count);
-        
-        if (fTail != NULL)
-            fTail->fNext = block;
-        else
-            fHead = fTail = block;
-        fTail = block;
+
+        this->appendBlock(count)->append(buffer, count);
     }
     return true;
 }
 
+SkDynamicMemoryWStream::Block* SkDynamicMemoryWStream::appendBlock(size_t minSize)
+{
+    size_t size = SkMin32(fBytesWritten, SkDynamicMemoryWStream_MaxGrowSize);
+    size = SkMax32(SkMax32(size, fMinBlockSize), minSize);
+    Block* block = (Block*)sk_malloc_throw(sizeof(Block) + size);
+    block->init(size);
+
+    if (fTail != NULL)
+        fTail->fNext = block;
+    else
+        fHead = block;
+    fTail = block;
+    return block;
+}
+
 bool SkDynamicMemoryWStream::write(const void* buffer, size_t offset, size_t count)
 {
     if (offset + count > fBytesWritten) {
@@ -725,6 +788,38 @@ SkData* SkDynamicMemoryWStream::copyToData() const {
     return fCopy;
 }
 
+static void free_block_proc(const void*, size_t, void* block) {
+    sk_free(block);
+}
+
+SkData* SkDynamicMemoryWStream::detachAsData() {
+    SkData* data;
+    if (fCopy) {
+        data = fCopy;
+        fCopy = NULL;
+    } else if (fHead != NULL && fHead == fTail) {
+        data = SkData::NewWithProc(fHead->start(), fBytesWritten,
+                                   free_block_proc, fHead);
+        fHead = fTail = NULL;
+    } else {
+        return this->copyToData();
+    }
+    this->reset();
+    return data;
+}
+
+bool SkDynamicMemoryWStream::writeToStream(SkWStream* dst) const {
+    if (fCopy) {
+        return dst->write(fCopy->data(), fBytesWritten);
+    }
+    for (Block* block = fHead; block != NULL; block = block->fNext) {
+        if (!dst->write(block->start(), block->written())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void SkDynamicMemoryWStream::invalidateCopy() {
     if (fCopy) {
         fCopy->unref();
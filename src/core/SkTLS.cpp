@@ -0,0 +1,67 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkTLS.h"
+
+// each thread's objects, most recently made first
+struct SkTLSRec {
+    SkTLSRec*           fNext;
+    void*               fData;
+    SkTLS::CreateProc   fCreateProc;
+    SkTLS::DeleteProc   fDeleteProc;
+};
+
+void SkTLS::Destructor(void* ptr) {
+    SkTLSRec* rec = (SkTLSRec*)ptr;
+    while (rec) {
+        SkTLSRec* next = rec->fNext;
+        if (rec->fDeleteProc) {
+            rec->fDeleteProc(rec->fData);
+        }
+        SkDELETE(rec);
+        rec = next;
+    }
+}
+
+void* SkTLS::Get(CreateProc createProc, DeleteProc deleteProc) {
+    SkASSERT(createProc);
+
+    SkTLSRec* head = (SkTLSRec*)PlatformGetSpecific();
+    for (SkTLSRec* rec = head; rec; rec = rec->fNext) {
+        if (rec->fCreateProc == createProc) {
+            SkASSERT(rec->fDeleteProc == deleteProc);
+            return rec->fData;
+        }
+    }
+
+    SkTLSRec* rec = SkNEW(SkTLSRec);
+    rec->fNext = head;
+    rec->fData = createProc();
+    rec->fCreateProc = createProc;
+    rec->fDeleteProc = deleteProc;
+    PlatformSetSpecific(rec);
+    return rec->fData;
+}
+
+void* SkTLS::Find(CreateProc createProc) {
+    SkTLSRec* rec = (SkTLSRec*)PlatformGetSpecific();
+    for (; rec; rec = rec->fNext) {
+        if (rec->fCreateProc == createProc) {
+            return rec->fData;
+        }
+    }
+    return NULL;
+}
@@ -18,6 +18,7 @@
 #ifndef SkTSort_DEFINED
 #define SkTSort_DEFINED
 
+#include "SkTemplates.h"
 #include "SkTypes.h"
 
 template <typename T>
@@ -47,4 +48,202 @@ template <typename T> void SkTHeapSort(T array[], int count) {
     }
 }
 
+template <typename T, typename C>
+void SkTHeapSort_SiftDown(T array[], int root, int bottom, C lessThan) {
+    while (root*2 + 1 <= bottom) {
+        int child = root * 2 + 1;
+        if (child+1 <= bottom && lessThan(array[child], array[child+1])) {
+            child += 1;
+        }
+        if (lessThan(array[root], array[child])) {
+            SkTSwap<T>(array[root], array[child]);
+            root = child;
+        } else {
+            break;
+        }
+    }
+}
+
+/** The same as SkTHeapSort(array, count), but ordered by lessThan(a, b),
+    which returns true if a must come before b.
+ */
+template <typename T, typename C>
+void SkTHeapSort(T array[], int count, C lessThan) {
+    int i;
+    for (i = count/2 - 1; i >= 0; --i) {
+        SkTHeapSort_SiftDown<T, C>(array, i, count-1, lessThan);
+    }
+    for (i = count - 1; i > 0; --i) {
+        SkTSwap<T>(array[0], array[i]);
+        SkTHeapSort_SiftDown<T, C>(array, 0, i-1, lessThan);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Sorts array[0..count) stably, by lessThan(a, b), which returns true if a
+    must come before b. Only for a handful of elements.
+ */
+template <typename T, typename C>
+void SkTInsertionSort(T array[], int count, C lessThan) {
+    for (int i = 1; i < count; i++) {
+        if (!lessThan(array[i], array[i - 1])) {
+            continue;
+        }
+        T insert = array[i];
+        int j = i;
+        do {
+            array[j] = array[j - 1];
+            --j;
+        } while (j > 0 && lessThan(insert, array[j - 1]));
+        array[j] = insert;
+    }
+}
+
+// partitions [left, right] around *right, and returns where it ends up
+template <typename T, typename C>
+T* SkTIntroSort_Partition(T* left, T* right, C lessThan) {
+    const T pivot = *right;
+    T* newPivot = left;
+    for (; left < right; ++left) {
+        if (lessThan(*left, pivot)) {
+            SkTSwap<T>(*left, *newPivot);
+            ++newPivot;
+        }
+    }
+    SkTSwap<T>(*newPivot, *right);
+    return newPivot;
+}
+
+template <typename T, typename C>
+void SkTIntroSort(int depth, T* left, T* right, C lessThan) {
+    for (;;) {
+        const int count = right - left + 1;
+        if (count <= 16) {
+            SkTInsertionSort(left, count, lessThan);
+            return;
+        }
+        if (0 == depth) {
+            SkTHeapSort(left, count, lessThan);
+            return;
+        }
+        --depth;
+
+        // the median of the ends and the middle, which goes at the right
+        T* middle = left + (count >> 1);
+        if (lessThan(*middle, *left)) {
+            SkTSwap<T>(*middle, *left);
+        }
+        if (lessThan(*right, *left)) {
+            SkTSwap<T>(*right, *left);
+        }
+        if (lessThan(*middle, *right)) {
+            SkTSwap<T>(*middle, *right);
+        }
+
+        T* pivot = SkTIntroSort_Partition(left, right, lessThan);
+        // recurse on the smaller side, and loop on the larger
+        if (pivot - left < right - pivot) {
+            SkTIntroSort(depth, left, pivot - 1, lessThan);
+            left = pivot + 1;
+        } else {
+            SkTIntroSort(depth, pivot + 1, right, lessThan);
+            right = pivot - 1;
+        }
+    }
+}
+
+/** Sorts array[0..count) by lessThan(a, b), which returns true if a must
+    come before b, and can be a function or (to have it inlined) a functor.
+    This is a quicksort that finishes small partitions with an insertion
+    sort, and falls back to a heap sort if it recurses too deep, so it is
+    never worse than O(n log n). It is not stable.
+ */
+template <typename T, typename C>
+void SkTIntroSort(T array[], int count, C lessThan) {
+    if (count <= 1) {
+        return;
+    }
+    int depth = 0;
+    for (int n = count; n > 1; n >>= 1) {
+        depth += 2;
+    }
+    SkTIntroSort(depth, array, array + count - 1, lessThan);
+}
+
+template <typename T> struct SkTCompareLT {
+    bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
+/** SkTIntroSort(array, count, lessThan), ordered by T's operator<. */
+template <typename T> void SkTIntroSort(T array[], int count) {
+    SkTIntroSort(array, count, SkTCompareLT<T>());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// orders elements by their keys, for sorting short arrays
+template <typename T, typename K> class SkTRadixSort_KeyLT {
+public:
+    SkTRadixSort_KeyLT(K keyOf) : fKeyOf(keyOf) {}
+    bool operator()(const T& a, const T& b) const {
+        return fKeyOf(a) < fKeyOf(b);
+    }
+private:
+    K fKeyOf;
+};
+
+/** Sorts array[0..count) stably, by the int32_t key keyOf(element) returns,
+    with an LSD radix sort a byte at a time. A pass is skipped for a byte
+    that is the same in every key, so small keys (e.g. y coordinates) take
+    only a pass or two. T is moved with memcpy, and count of them are
+    allocated as scratch space. Short arrays are insertion sorted instead.
+ */
+template <typename T, typename K>
+void SkTRadixSort(T array[], int count, K keyOf) {
+    if (count <= 32) {
+        SkTInsertionSort(array, count, SkTRadixSort_KeyLT<T, K>(keyOf));
+        return;
+    }
+
+    // flipping the sign bit orders the keys as unsigned
+    const uint32_t kFlip = 0x80000000;
+    uint32_t counts[4][256];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < count; i++) {
+        const uint32_t key = (uint32_t)keyOf(array[i]) ^ kFlip;
+        counts[0][key & 0xFF] += 1;
+        counts[1][(key >> 8) & 0xFF] += 1;
+        counts[2][(key >> 16) & 0xFF] += 1;
+        counts[3][key >> 24] += 1;
+    }
+
+    SkAutoSTMalloc<64, T> storage(count);
+    T* src = array;
+    T* dst = storage.get();
+    const uint32_t first = (uint32_t)keyOf(array[0]) ^ kFlip;
+    for (int pass = 0; pass < 4; pass++) {
+        const int shift = pass << 3;
+        uint32_t* offsets = counts[pass];
+        if ((int)offsets[(first >> shift) & 0xFF] == count) {
+            continue;   // every key has this byte
+        }
+        uint32_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            const uint32_t n = offsets[b];
+            offsets[b] = sum;
+            sum += n;
+        }
+        for (int i = 0; i < count; i++) {
+            const uint32_t key = (uint32_t)keyOf(src[i]) ^ kFlip;
+            memcpy(&dst[offsets[(key >> shift) & 0xFF]++], &src[i],
+                   sizeof(T));
+        }
+        SkTSwap<T*>(src, dst);
+    }
+    if (src != array) {
+        memcpy(array, src, count * sizeof(T));
+    }
+}
+
 #endif
@@ -0,0 +1,272 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkThread.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+/*  The pool has a queue for each worker (or one, if there are no workers),
+    which new work is spread over. fWork counts what has been queued, so a
+    worker that wakes up goes looking for one task, first in its own queue,
+    then in the others'. Someone else (e.g. a thread in wait()) may have got
+    to it first, in which case the worker goes back to sleep, so there are
+    never fewer signals than tasks left in the queues.
+ */
+
+namespace {
+
+struct Task {
+    SkRunnable* fRunnable;
+    int32_t*    fPending;   // the group's count of unfinished tasks
+};
+
+struct Queue {
+    SkMutex         fMutex;
+    SkTDArray<Task> fTasks;     // oldest first
+};
+
+class Pool;
+
+struct Worker {
+    Pool*   fPool;
+    int     fIndex;
+};
+
+class Pool {
+public:
+    explicit Pool(int threadCount);
+
+    int threadCount() const { return fThreadCount; }
+
+    void add(const Task&);
+
+    // Take a task from queue home (newest first), or else steal one from
+    // the others (oldest first). home is -1 for threads that aren't workers.
+    bool take(int home, Task*);
+
+    static void Run(const Task& task) {
+        task.fRunnable->run();
+        sk_atomic_dec(task.fPending);
+    }
+
+private:
+    Queue*      fQueues;
+    int         fQueueCount;
+    Worker*     fWorkers;
+    int         fThreadCount;
+    int32_t     fNextQueue;
+    SkSemaphore fWork;
+
+    static void Loop(void* worker);
+};
+
+Pool::Pool(int threadCount) : fThreadCount(0), fNextQueue(0) {
+    threadCount = SkMax32(threadCount, 0);
+    fQueueCount = SkMax32(threadCount, 1);
+    fQueues = SkNEW_ARRAY(Queue, fQueueCount);
+    fWorkers = SkNEW_ARRAY(Worker, fQueueCount);
+
+    for (int i = 0; i < threadCount; i++) {
+        fWorkers[i].fPool = this;
+        fWorkers[i].fIndex = i;
+        if (!sk_start_thread(Loop, &fWorkers[i])) {
+            break;
+        }
+        fThreadCount += 1;
+    }
+}
+
+void Pool::add(const Task& task) {
+    uint32_t next = (uint32_t)sk_atomic_inc(&fNextQueue);
+    Queue& queue = fQueues[next % fQueueCount];
+    {
+        SkAutoMutexAcquire ac(queue.fMutex);
+        *queue.fTasks.append() = task;
+    }
+    if (fThreadCount > 0) {
+        fWork.signal();
+    }
+}
+
+bool Pool::take(int home, Task* task) {
+    if (home >= 0) {
+        Queue& queue = fQueues[home];
+        SkAutoMutexAcquire ac(queue.fMutex);
+        if (!queue.fTasks.isEmpty()) {
+            queue.fTasks.pop(task);
+            return true;
+        }
+    }
+    for (int i = 0; i < fQueueCount; i++) {
+        Queue& queue = fQueues[(home + 1 + i) % fQueueCount];
+        SkAutoMutexAcquire ac(queue.fMutex);
+        if (!queue.fTasks.isEmpty()) {
+            *task = queue.fTasks[0];
+            queue.fTasks.remove(0);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Pool::Loop(void* arg) {
+    Worker* worker = (Worker*)arg;
+    Pool* pool = worker->fPool;
+    for (;;) {
+        pool->fWork.wait();
+        Task task;
+        if (pool->take(worker->fIndex, &task)) {
+            Run(task);
+        }
+    }
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+static SkMutex  gPoolMutex;
+static Pool*    gPool;
+static int      gPoolThreadCount = -1;  // -1 for a thread per extra core
+
+// the pool lives (and its workers wait for work) until the process exits
+static Pool* get_pool() {
+    SkAutoMutexAcquire ac(gPoolMutex);
+    if (NULL == gPool) {
+        int count = gPoolThreadCount;
+        if (count < 0) {
+            count = sk_num_cores() - 1;
+        }
+        gPool = SkNEW_ARGS(Pool, (count));
+    }
+    return gPool;
+}
+
+// The ports only have read-modify-writes, which are also full barriers, so
+// this sees everything that the finished tasks wrote.
+static int32_t load_pending(int32_t* pending) {
+    int32_t value = sk_atomic_inc(pending);
+    sk_atomic_dec(pending);
+    return value;
+}
+
+SkTaskGroup::SkTaskGroup() : fPending(0) {}
+
+SkTaskGroup::~SkTaskGroup() {
+    this->wait();
+}
+
+int SkTaskGroup::threadCount() const {
+    return get_pool()->threadCount();
+}
+
+void SkTaskGroup::add(SkRunnable* runnable) {
+    if (NULL == runnable) {
+        return;
+    }
+    Task task;
+    task.fRunnable = runnable;
+    task.fPending = &fPending;
+    sk_atomic_inc(&fPending);
+    get_pool()->add(task);
+}
+
+void SkTaskGroup::wait() {
+    Pool* pool = get_pool();
+    while (load_pending(&fPending) > 0) {
+        Task task;
+        if (pool->take(-1, &task)) {
+            Pool::Run(task);
+        } else {
+            // what's left of ours is running on the workers
+            sk_thread_yield();
+        }
+    }
+}
+
+void SkTaskGroup::SetThreadCount(int count) {
+    SkAutoMutexAcquire ac(gPoolMutex);
+    if (NULL == gPool) {
+        gPoolThreadCount = count;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/*  Every task takes the next range that nobody has taken yet, until there are
+    none left, so that ranges that take longer don't hold the others up.
+ */
+class ParallelForTask : public SkRunnable {
+public:
+    void set(SkParallelForProc proc, void* context, int start, int stop,
+             int grain, int32_t* next) {
+        fProc = proc;
+        fContext = context;
+        fStart = start;
+        fStop = stop;
+        fGrain = grain;
+        fNext = next;
+    }
+
+    virtual void run() {
+        const int count = (fStop - fStart - 1) / fGrain + 1;
+        for (;;) {
+            int i = sk_atomic_inc(fNext);
+            if (i >= count) {
+                break;
+            }
+            int start = fStart + i * fGrain;
+            int stop = (i == count - 1) ? fStop : start + fGrain;
+            fProc(fContext, start, stop);
+        }
+    }
+
+private:
+    SkParallelForProc   fProc;
+    void*               fContext;
+    int                 fStart, fStop, fGrain;
+    int32_t*            fNext;
+};
+
+}  // namespace
+
+void SkParallelFor(int start, int stop, int grain, SkParallelForProc proc,
+                   void* context) {
+    if (start >= stop) {
+        return;
+    }
+    grain = SkMax32(grain, 1);
+    const int ranges = (stop - start - 1) / grain + 1;
+
+    int32_t next = 0;
+    SkTaskGroup group;
+    int taskCount = SkMin32(group.threadCount() + 1, ranges);
+    if (taskCount <= 1) {
+        ParallelForTask task;
+        task.set(proc, context, start, stop, grain, &next);
+        task.run();
+        return;
+    }
+
+    SkAutoTArray<ParallelForTask> tasks(taskCount);
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].set(proc, context, start, stop, grain, &next);
+        group.add(&tasks[i]);
+    }
+    group.wait();
+}
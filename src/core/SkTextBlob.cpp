@@ -0,0 +1,166 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkTextBlob.h"
+#include "SkCanvas.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkTypeface.h"
+
+// the paint flags that describe the font and how its glyphs are rasterized
+// (for text, antialiasing only selects the mask format of the glyphs)
+#define FONT_FLAGS_MASK (SkPaint::kAntiAlias_Flag           |   \
+                         SkPaint::kUnderlineText_Flag       |   \
+                         SkPaint::kStrikeThruText_Flag      |   \
+                         SkPaint::kFakeBoldText_Flag        |   \
+                         SkPaint::kLinearText_Flag          |   \
+                         SkPaint::kSubpixelText_Flag        |   \
+                         SkPaint::kDevKernText_Flag         |   \
+                         SkPaint::kLCDRenderText_Flag       |   \
+                         SkPaint::kEmbeddedBitmapText_Flag  |   \
+                         SkPaint::kAutoHinting_Flag)
+
+static int32_t gNextBlobID;
+
+SkTextBlob::SkTextBlob(const SkPaint& font, int glyphCount)
+        : fFont(font), fGlyphCount(glyphCount) {
+    fPositions = NULL;
+    fGlyphs = NULL;
+    if (glyphCount > 0) {
+        // one block for both arrays, the positions first to keep them aligned
+        size_t size = glyphCount * (sizeof(SkPoint) + sizeof(uint16_t));
+        fPositions = (SkPoint*)sk_malloc_throw(size);
+        fGlyphs = (uint16_t*)(fPositions + glyphCount);
+    }
+    fBounds.setEmpty();
+    fUniqueID = sk_atomic_inc(&gNextBlobID) + 1;
+}
+
+SkTextBlob::~SkTextBlob() {
+    sk_free(fPositions);
+}
+
+SkTextBlob* SkTextBlob::Create(const void* text, size_t byteLength,
+                               const SkPaint& paint) {
+    return Build(text, byteLength, NULL, paint);
+}
+
+SkTextBlob* SkTextBlob::Create(const void* text, size_t byteLength,
+                               const SkPoint pos[], const SkPaint& paint) {
+    SkASSERT(pos || 0 == byteLength);
+    return Build(text, byteLength, pos, paint);
+}
+
+SkTextBlob* SkTextBlob::Build(const void* text, size_t byteLength,
+                              const SkPoint pos[], const SkPaint& paint) {
+    const int count = paint.textToGlyphs(text, byteLength, NULL);
+    SkTextBlob* blob = SkNEW_ARGS(SkTextBlob, (paint, count));
+    if (0 == count) {
+        return blob;
+    }
+    paint.textToGlyphs(text, byteLength, blob->fGlyphs);
+
+    SkPaint glyphPaint;
+    blob->applyFont(&glyphPaint);
+
+    SkAutoSTMalloc<64, SkScalar> widths(count);
+    SkAutoSTMalloc<64, SkRect> rects(count);
+    glyphPaint.getTextWidths(blob->fGlyphs, count * sizeof(uint16_t),
+                             widths.get(), rects.get());
+    const SkScalar* w = widths.get();
+
+    // fraction of each advance that the alignment moves the origin back by
+    SkScalar alignScale = 0;
+    if (SkPaint::kCenter_Align == paint.getTextAlign()) {
+        alignScale = SK_ScalarHalf;
+    } else if (SkPaint::kRight_Align == paint.getTextAlign()) {
+        alignScale = SK_Scalar1;
+    }
+
+    SkPoint* positions = blob->fPositions;
+    if (pos) {
+        // as drawPosText, each glyph is aligned on its own position
+        for (int i = 0; i < count; i++) {
+            positions[i].set(pos[i].fX - SkScalarMul(w[i], alignScale),
+                             pos[i].fY);
+        }
+    } else {
+        // as drawText, the whole run is aligned on the origin
+        SkScalar x = 0;
+        for (int i = 0; i < count; i++) {
+            x += w[i];
+        }
+        x = -SkScalarMul(x, alignScale);
+        for (int i = 0; i < count; i++) {
+            positions[i].set(x, 0);
+            x += w[i];
+        }
+    }
+
+    SkRect* bounds = &blob->fBounds;
+    for (int i = 0; i < count; i++) {
+        SkRect r = rects.get()[i];
+        if (!r.isEmpty()) {
+            r.offset(positions[i].fX, positions[i].fY);
+            bounds->join(r);
+        }
+    }
+    return blob;
+}
+
+void SkTextBlob::applyFont(SkPaint* paint) const {
+    paint->setTypeface(fFont.getTypeface());
+    paint->setTextSize(fFont.getTextSize());
+    paint->setTextScaleX(fFont.getTextScaleX());
+    paint->setTextSkewX(fFont.getTextSkewX());
+    paint->setHinting(fFont.getHinting());
+    paint->setFlags((paint->getFlags() & ~FONT_FLAGS_MASK) |
+                    (fFont.getFlags() & FONT_FLAGS_MASK));
+    paint->setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    paint->setTextAlign(SkPaint::kLeft_Align);
+}
+
+bool SkTextBlob::SameFont(const SkPaint& a, const SkPaint& b) {
+    return SkTypeface::Equal(a.getTypeface(), b.getTypeface()) &&
+           a.getTextSize() == b.getTextSize() &&
+           a.getTextScaleX() == b.getTextScaleX() &&
+           a.getTextSkewX() == b.getTextSkewX() &&
+           a.getHinting() == b.getHinting() &&
+           a.getTextAlign() == b.getTextAlign() &&
+           (a.getFlags() & FONT_FLAGS_MASK) == (b.getFlags() & FONT_FLAGS_MASK);
+}
+
+void SkTextBlob::drawAsPosText(SkCanvas* canvas, SkScalar x, SkScalar y,
+                               const SkPaint& paint) const {
+    if (0 == fGlyphCount) {
+        return;
+    }
+    SkPaint glyphPaint(paint);
+    this->applyFont(&glyphPaint);
+
+    const size_t byteLength = fGlyphCount * sizeof(uint16_t);
+    if (0 == x && 0 == y) {
+        canvas->drawPosText(fGlyphs, byteLength, fPositions, glyphPaint);
+        return;
+    }
+
+    SkAutoSTMalloc<64, SkPoint> storage(fGlyphCount);
+    SkPoint* pos = storage.get();
+    for (int i = 0; i < fGlyphCount; i++) {
+        pos[i].set(fPositions[i].fX + x, fPositions[i].fY + y);
+    }
+    canvas->drawPosText(fGlyphs, byteLength, pos, glyphPaint);
+}
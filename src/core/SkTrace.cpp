@@ -0,0 +1,132 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkTrace.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTLS.h"
+
+namespace {
+
+struct Event {
+    const char* fName;
+    double      fStart;     // microseconds
+    double      fDuration;
+    int32_t     fThread;
+};
+
+}
+
+bool SkTrace::gEnabled;
+
+// the counters are made before main(), so the list needs no lock
+static SkTrace::Counter*    gCounters;
+
+static SkMutex  gEventMutex;    // for allocating the buffer
+static Event*   gEvents;
+static int32_t  gEventCount;    // including the ones that were dropped
+static int32_t  gNextThread;
+
+SkTrace::Counter::Counter(const char name[]) : fName(name), fValue(0) {
+    fNext = gCounters;
+    gCounters = this;
+}
+
+// each thread's id is stored as the pointer, which is never null
+static void* make_thread_id() {
+    return (void*)(intptr_t)(sk_atomic_inc(&gNextThread) + 1);
+}
+
+void SkTrace::SetEnabled(bool enabled) {
+    if (enabled) {
+        SkAutoMutexAcquire ac(gEventMutex);
+        if (NULL == gEvents) {
+            gEvents = (Event*)sk_malloc_throw(kMaxEvents * sizeof(Event));
+        }
+    }
+    gEnabled = enabled;
+}
+
+void SkTrace::Reset() {
+    gEventCount = 0;
+    for (Counter* c = gCounters; c; c = c->fNext) {
+        c->fValue = 0;
+    }
+}
+
+int SkTrace::GetEventCount() {
+    return SkMin32(gEventCount, kMaxEvents);
+}
+
+int SkTrace::GetDroppedEventCount() {
+    return SkMax32(gEventCount - kMaxEvents, 0);
+}
+
+const SkTrace::Counter* SkTrace::FindCounter(const char name[]) {
+    for (Counter* c = gCounters; c; c = c->fNext) {
+        if (!strcmp(c->fName, name)) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+void SkTrace::RecordEvent(const char name[], double start, double stop) {
+    // gEvents is set before tracing is first enabled, and never freed
+    int32_t index = sk_atomic_inc(&gEventCount);
+    if (index >= kMaxEvents || NULL == gEvents) {
+        return;
+    }
+    Event& event = gEvents[index];
+    event.fName = name;
+    event.fStart = start;
+    event.fDuration = stop - start;
+    event.fThread = (int32_t)(intptr_t)SkTLS::Get(make_thread_id, NULL);
+}
+
+void SkTrace::WriteJSON(SkWStream* stream) {
+    SkString str;
+    const char* separator = "\n";
+
+    stream->writeText("{\"traceEvents\": [");
+    const int count = GetEventCount();
+    for (int i = 0; i < count; i++) {
+        const Event& event = gEvents[i];
+        str.printf("%s{\"name\": \"%s\", \"cat\": \"skia\", \"ph\": \"X\", "
+                   "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d}",
+                   separator, event.fName, event.fStart, event.fDuration,
+                   event.fThread);
+        stream->writeText(str.c_str());
+        separator = ",\n";
+    }
+
+    // the counters as they are now, with the dropped events as one of them
+    const double now = SkTime::GetUSecs();
+    for (Counter* c = gCounters; c; c = c->fNext) {
+        str.printf("%s{\"name\": \"%s\", \"cat\": \"skia\", \"ph\": \"C\", "
+                   "\"ts\": %.3f, \"pid\": 1, \"args\": {\"value\": %d}}",
+                   separator, c->fName, now, c->fValue);
+        stream->writeText(str.c_str());
+        separator = ",\n";
+    }
+    str.printf("%s{\"name\": \"trace.dropped_events\", \"cat\": \"skia\", "
+               "\"ph\": \"C\", \"ts\": %.3f, \"pid\": 1, "
+               "\"args\": {\"value\": %d}}", separator, now,
+               GetDroppedEventCount());
+    stream->writeText(str.c_str());
+    stream->writeText("\n]}\n");
+}
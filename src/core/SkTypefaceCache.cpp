@@ -20,35 +20,153 @@
 
 #define TYPEFACE_CACHE_LIMIT    128
 
-void SkTypefaceCache::add(SkTypeface* face, SkTypeface::Style requestedStyle) {
+#define INITIAL_BUCKET_SHIFT    5
+
+static uint32_t hash_name(const char name[]) {
+    uint32_t hash = 2166136261U;
+    while (*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619U;
+    }
+    return hash;
+}
+
+// Spread the key over the top bits, which are the ones we index with.
+static int bucket_index(uint32_t key, int shift) {
+    return (key * 2654435761U) >> (32 - shift);
+}
+
+SkTypefaceCache::SkTypefaceCache() : fBucketShift(INITIAL_BUCKET_SHIFT) {
+    size_t size = (1 << fBucketShift) * sizeof(Rec*);
+    fIDBuckets = (Rec**)sk_malloc_throw(size);
+    fNameBuckets = (Rec**)sk_malloc_throw(size);
+    memset(fIDBuckets, 0, size);
+    memset(fNameBuckets, 0, size);
+}
+
+SkTypefaceCache::~SkTypefaceCache() {
+    Rec** curr = fArray.begin();
+    Rec** stop = fArray.end();
+    while (curr < stop) {
+        SkDELETE(*curr);
+        curr += 1;
+    }
+    sk_free(fIDBuckets);
+    sk_free(fNameBuckets);
+}
+
+SkTypefaceCache::Rec** SkTypefaceCache::idBucket(SkFontID fontID) const {
+    return &fIDBuckets[bucket_index(fontID, fBucketShift)];
+}
+
+SkTypefaceCache::Rec** SkTypefaceCache::nameBucket(
+        uint32_t nameHash, SkTypeface::Style style) const {
+    return &fNameBuckets[bucket_index(nameHash ^ style, fBucketShift)];
+}
+
+// New entries go to the back of their chains, so that the oldest match is
+// found first, as it would be by a scan of fArray.
+void SkTypefaceCache::link(Rec* rec) {
+    rec->fNextByID = NULL;
+    Rec** tail = this->idBucket(rec->fFontID);
+    while (*tail) {
+        tail = &(*tail)->fNextByID;
+    }
+    *tail = rec;
+
+    rec->fNextByName = NULL;
+    if (rec->fHasName) {
+        tail = this->nameBucket(rec->fNameHash, rec->fRequestedStyle);
+        while (*tail) {
+            tail = &(*tail)->fNextByName;
+        }
+        *tail = rec;
+    }
+}
+
+void SkTypefaceCache::unlink(Rec* rec) {
+    Rec** prev = this->idBucket(rec->fFontID);
+    while (*prev != rec) {
+        prev = &(*prev)->fNextByID;
+    }
+    *prev = rec->fNextByID;
+
+    if (rec->fHasName) {
+        prev = this->nameBucket(rec->fNameHash, rec->fRequestedStyle);
+        while (*prev != rec) {
+            prev = &(*prev)->fNextByName;
+        }
+        *prev = rec->fNextByName;
+    }
+}
+
+void SkTypefaceCache::growBuckets() {
+    fBucketShift += 1;
+    size_t size = (1 << fBucketShift) * sizeof(Rec*);
+    fIDBuckets = (Rec**)sk_realloc_throw(fIDBuckets, size);
+    fNameBuckets = (Rec**)sk_realloc_throw(fNameBuckets, size);
+    memset(fIDBuckets, 0, size);
+    memset(fNameBuckets, 0, size);
+
+    for (int i = 0; i < fArray.count(); ++i) {
+        this->link(fArray[i]);
+    }
+}
+
+void SkTypefaceCache::add(SkTypeface* face, SkTypeface::Style requestedStyle,
+                          const char familyName[]) {
     if (fArray.count() >= TYPEFACE_CACHE_LIMIT) {
         this->purge(TYPEFACE_CACHE_LIMIT >> 2);
     }
+    if (fArray.count() >= (1 << fBucketShift)) {
+        this->growBuckets();
+    }
 
-    Rec* rec = fArray.append();
+    Rec* rec = SkNEW(Rec);
     rec->fFace = face;
     rec->fRequestedStyle = requestedStyle;
+    rec->fFontID = face->uniqueID();
+    rec->fHasName = (familyName != NULL);
+    rec->fNameHash = 0;
+    if (familyName) {
+        rec->fNameHash = hash_name(familyName);
+        rec->fName.set(familyName);
+    }
+    *fArray.append() = rec;
+    this->link(rec);
     face->ref();
 }
 
 SkTypeface* SkTypefaceCache::findByID(SkFontID fontID) const {
-    const Rec* curr = fArray.begin();
-    const Rec* stop = fArray.end();
-    while (curr < stop) {
-        if (curr->fFace->uniqueID() == fontID) {
+    const Rec* curr = *this->idBucket(fontID);
+    while (curr) {
+        if (curr->fFontID == fontID) {
             return curr->fFace;
         }
-        curr += 1;
+        curr = curr->fNextByID;
+    }
+    return NULL;
+}
+
+SkTypeface* SkTypefaceCache::findByName(const char familyName[],
+                                        SkTypeface::Style style) const {
+    uint32_t hash = hash_name(familyName);
+    const Rec* curr = *this->nameBucket(hash, style);
+    while (curr) {
+        if (curr->fNameHash == hash && curr->fRequestedStyle == style &&
+                curr->fName.equals(familyName)) {
+            return curr->fFace;
+        }
+        curr = curr->fNextByName;
     }
     return NULL;
 }
 
 SkTypeface* SkTypefaceCache::findByProc(FindProc proc, void* ctx) const {
-    const Rec* curr = fArray.begin();
-    const Rec* stop = fArray.end();
+    Rec* const* curr = fArray.begin();
+    Rec* const* stop = fArray.end();
     while (curr < stop) {
-        if (proc(curr->fFace, curr->fRequestedStyle, ctx)) {
-            return curr->fFace;
+        if (proc((*curr)->fFace, (*curr)->fRequestedStyle, ctx)) {
+            return (*curr)->fFace;
         }
         curr += 1;
     }
@@ -59,9 +177,11 @@ void SkTypefaceCache::purge(int numToPurge) {
     int count = fArray.count();
     int i = 0;
     while (i < count) {
-        SkTypeface* face = fArray[i].fFace;
-        if (1 == face->getRefCnt()) {
-            face->unref();
+        Rec* rec = fArray[i];
+        if (1 == rec->fFace->getRefCnt()) {
+            this->unlink(rec);
+            rec->fFace->unref();
+            SkDELETE(rec);
             fArray.remove(i);
             --count;
             if (--numToPurge == 0) {
@@ -87,9 +207,10 @@ SkFontID SkTypefaceCache::NewFontID() {
 
 static SkMutex gMutex;
 
-void SkTypefaceCache::Add(SkTypeface* face, SkTypeface::Style requestedStyle) {
+void SkTypefaceCache::Add(SkTypeface* face, SkTypeface::Style requestedStyle,
+                          const char familyName[]) {
     SkAutoMutexAcquire ama(gMutex);
-    Get().add(face, requestedStyle);
+    Get().add(face, requestedStyle, familyName);
 }
 
 SkTypeface* SkTypefaceCache::FindByID(SkFontID fontID) {
@@ -97,6 +218,12 @@ SkTypeface* SkTypefaceCache::FindByID(SkFontID fontID) {
     return Get().findByID(fontID);
 }
 
+SkTypeface* SkTypefaceCache::FindByName(const char familyName[],
+                                        SkTypeface::Style requestedStyle) {
+    SkAutoMutexAcquire ama(gMutex);
+    return Get().findByName(familyName, requestedStyle);
+}
+
 SkTypeface* SkTypefaceCache::FindByProc(FindProc proc, void* ctx) {
     SkAutoMutexAcquire ama(gMutex);
     return Get().findByProc(proc, ctx);
@@ -18,6 +18,7 @@
 #ifndef SkTypefaceCache_DEFINED
 #define SkTypefaceCache_DEFINED
 
+#include "SkString.h"
 #include "SkTypeface.h"
 #include "SkTDArray.h"
 
@@ -26,6 +27,9 @@
  *
  *  The current mechanism ends up create a diff typeface for each one, even if
  *  they map to the same internal obj (e.g. CTFontRef on the mac)
+ *
+ *  Lookups by fontID and by (familyName, requestedStyle) go through hash
+ *  tables; only FindByProc() has to visit every cached typeface.
  */
 
 class SkTypefaceCache {
@@ -42,8 +46,12 @@ public:
      *  Add a typeface to the cache. This ref()s the typeface, so that the
      *  cache is also an owner. Later, if we need to purge the cache, it will
      *  unref() typefaces whose refcnt is 1 (meaning only the cache is an owner).
+     *
+     *  If familyName is not NULL, the typeface can later be found with
+     *  FindByName(familyName, requested).
      */
-    static void Add(SkTypeface*, SkTypeface::Style requested);
+    static void Add(SkTypeface*, SkTypeface::Style requested,
+                    const char familyName[] = NULL);
 
     /**
      *  Search the cache for a typeface with the specified fontID (uniqueID).
@@ -52,6 +60,14 @@ public:
      */
     static SkTypeface* FindByID(SkFontID fontID);
 
+    /**
+     *  Search the cache for a typeface that was added with the specified
+     *  familyName and requested style. If one is found, return it (its
+     *  reference count is unmodified). If none is found, return NULL.
+     */
+    static SkTypeface* FindByName(const char familyName[],
+                                  SkTypeface::Style requested);
+
     /**
      *  Iterate through the cache, calling proc(typeface, ctx) with each
      *  typeface. If proc returns true, then we return that typeface (its
@@ -65,18 +81,43 @@ public:
     static void Dump();
 
 private:
+    SkTypefaceCache();
+    ~SkTypefaceCache();
+
     static SkTypefaceCache& Get();
 
-    void add(SkTypeface*, SkTypeface::Style requested);
+    void add(SkTypeface*, SkTypeface::Style requested,
+             const char familyName[]);
     SkTypeface* findByID(SkFontID findID) const;
+    SkTypeface* findByName(const char familyName[],
+                           SkTypeface::Style requested) const;
     SkTypeface* findByProc(FindProc proc, void* ctx) const;
     void purge(int count);
 
     struct Rec {
         SkTypeface*         fFace;
         SkTypeface::Style   fRequestedStyle;
+        SkFontID            fFontID;
+        bool                fHasName;
+        uint32_t            fNameHash;
+        SkString            fName;
+        Rec*                fNextByID;
+        Rec*                fNextByName;
     };
-    SkTDArray<Rec> fArray;
+
+    Rec** idBucket(SkFontID) const;
+    Rec** nameBucket(uint32_t nameHash, SkTypeface::Style) const;
+    void link(Rec*);
+    void unlink(Rec*);
+    void growBuckets();
+
+    // Oldest first, so that purge() drops the least recently added faces.
+    SkTDArray<Rec*> fArray;
+    // Both tables have (1 << fBucketShift) chains, linked through fNextByID
+    // and fNextByName respectively.
+    Rec**           fIDBuckets;
+    Rec**           fNameBuckets;
+    int             fBucketShift;
 };
 
 #endif
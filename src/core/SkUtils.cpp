@@ -16,6 +16,8 @@
 */
 
 #include "SkUtils.h"
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
 
 #if 0
 #define assign_16_longs(dst, value)             \
@@ -135,6 +137,141 @@ SkMemset32Proc sk_memset32 = sk_memset32_stub;
 
 #endif
 
+// rows that follow one another with no gap are filled as one long row
+void sk_memset_rect16_portable(uint16_t dst[], uint16_t value, int width,
+                               int height, size_t rowBytes) {
+    SkASSERT(dst != NULL && width >= 0 && height >= 0);
+
+    if (rowBytes == width * sizeof(uint16_t)) {
+        width *= height;
+        height = 1;
+    }
+    while (--height >= 0) {
+        sk_memset16(dst, value, width);
+        dst = (uint16_t*)((char*)dst + rowBytes);
+    }
+}
+
+static void sk_memset_rect16_stub(uint16_t dst[], uint16_t value, int width,
+                                  int height, size_t rowBytes) {
+    SkMemsetRect16Proc proc = SkMemsetRect16GetPlatformProc();
+    sk_memset_rect16 = proc ? proc : sk_memset_rect16_portable;
+    sk_memset_rect16(dst, value, width, height, rowBytes);
+}
+
+SkMemsetRect16Proc sk_memset_rect16 = sk_memset_rect16_stub;
+
+void sk_memset_rect32_portable(uint32_t dst[], uint32_t value, int width,
+                               int height, size_t rowBytes) {
+    SkASSERT(dst != NULL && width >= 0 && height >= 0);
+
+    if (rowBytes == width * sizeof(uint32_t)) {
+        width *= height;
+        height = 1;
+    }
+    while (--height >= 0) {
+        sk_memset32(dst, value, width);
+        dst = (uint32_t*)((char*)dst + rowBytes);
+    }
+}
+
+static void sk_memset_rect32_stub(uint32_t dst[], uint32_t value, int width,
+                                  int height, size_t rowBytes) {
+    SkMemsetRect32Proc proc = SkMemsetRect32GetPlatformProc();
+    sk_memset_rect32 = proc ? proc : sk_memset_rect32_portable;
+    sk_memset_rect32(dst, value, width, height, rowBytes);
+}
+
+SkMemsetRect32Proc sk_memset_rect32 = sk_memset_rect32_stub;
+
+void sk_table8_portable(uint8_t dst[], const uint8_t src[], int count,
+                        const uint8_t table[256]) {
+    SkASSERT(dst != NULL && src != NULL && table != NULL && count >= 0);
+
+    // read all four before writing any, in case dst is src
+    while (count >= 4) {
+        unsigned a = table[src[0]];
+        unsigned b = table[src[1]];
+        unsigned c = table[src[2]];
+        unsigned d = table[src[3]];
+        dst[0] = a;
+        dst[1] = b;
+        dst[2] = c;
+        dst[3] = d;
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+    while (count > 0) {
+        *dst++ = table[*src++];
+        count -= 1;
+    }
+}
+
+static void sk_table8_stub(uint8_t dst[], const uint8_t src[], int count,
+                           const uint8_t table[256]) {
+    SkTable8Proc proc = SkTable8GetPlatformProc();
+    sk_table8 = proc ? proc : sk_table8_portable;
+    sk_table8(dst, src, count, table);
+}
+
+SkTable8Proc sk_table8 = sk_table8_stub;
+
+void sk_pixel16_to_pixel32_portable(uint32_t dst[], const uint16_t src[],
+                                    int count) {
+    SkASSERT(dst != NULL && src != NULL && count >= 0);
+
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkPixel16ToPixel32(src[i]);
+    }
+}
+
+static void sk_pixel16_to_pixel32_stub(uint32_t dst[], const uint16_t src[],
+                                       int count) {
+    SkPixel16ToPixel32Proc proc = SkPixel16ToPixel32GetPlatformProc();
+    sk_pixel16_to_pixel32 = proc ? proc : sk_pixel16_to_pixel32_portable;
+    sk_pixel16_to_pixel32(dst, src, count);
+}
+
+SkPixel16ToPixel32Proc sk_pixel16_to_pixel32 = sk_pixel16_to_pixel32_stub;
+
+void sk_unpremultiply_to_rgba_portable(uint8_t dst[], const uint32_t src[],
+                                       int count) {
+    SkASSERT(dst != NULL && src != NULL && count >= 0);
+
+    const SkUnPreMultiply::Scale* SK_RESTRICT table =
+                                            SkUnPreMultiply::GetScaleTable();
+    for (int i = 0; i < count; i++) {
+        SkPMColor c = src[i];
+        unsigned a = SkGetPackedA32(c);
+        unsigned r = SkGetPackedR32(c);
+        unsigned g = SkGetPackedG32(c);
+        unsigned b = SkGetPackedB32(c);
+
+        if (0 != a && 255 != a) {
+            SkUnPreMultiply::Scale scale = table[a];
+            r = SkUnPreMultiply::ApplyScale(scale, r);
+            g = SkUnPreMultiply::ApplyScale(scale, g);
+            b = SkUnPreMultiply::ApplyScale(scale, b);
+        }
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+        dst[3] = a;
+        dst += 4;
+    }
+}
+
+static void sk_unpremultiply_to_rgba_stub(uint8_t dst[], const uint32_t src[],
+                                          int count) {
+    SkUnPremultiplyToRGBAProc proc = SkUnPremultiplyToRGBAGetPlatformProc();
+    sk_unpremultiply_to_rgba = proc ? proc : sk_unpremultiply_to_rgba_portable;
+    sk_unpremultiply_to_rgba(dst, src, count);
+}
+
+SkUnPremultiplyToRGBAProc sk_unpremultiply_to_rgba =
+                                                sk_unpremultiply_to_rgba_stub;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /*  0xxxxxxx    1 total
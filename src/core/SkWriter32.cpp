@@ -1,127 +1,178 @@
 #include "SkWriter32.h"
 
-struct SkWriter32::Block {
-    Block*  fNext;
-    size_t  fSize;
-    size_t  fAllocated;
-    
-    size_t  available() const { return fSize - fAllocated; }
-    char*   base() { return (char*)(this + 1); }
-    const char* base() const { return (const char*)(this + 1); }
-    
-    uint32_t* alloc(size_t size) {
-        SkASSERT(SkAlign4(size) == size);
-        SkASSERT(this->available() >= size);
-        void* ptr = this->base() + fAllocated;
-        fAllocated += size;
-        SkASSERT(fAllocated <= fSize);
-        return (uint32_t*)ptr;
-    }
-    
-    uint32_t* peek32(size_t offset) {
-        SkASSERT(offset <= fAllocated + 4);
-        void* ptr = this->base() + offset;
-        return (uint32_t*)ptr;
+/*  Allocated blocks keep their data first and the Block after it, so that
+    detachContiguousArray() can hand the whole allocation over as the data.
+ */
+static size_t header_offset(size_t size) {
+    return (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+}
+
+SkWriter32::Block* SkWriter32::nextBlock(size_t size) {
+    Block* next = fTail ? fTail->fNext : NULL;
+    if (NULL == next || next->fSize < size) {
+        // grow geometrically, so that recording n bytes takes O(log n) blocks
+        size_t blockSize = SkMax32(SkMax32(size, fMinSize), fSize);
+        blockSize = SkAlign4(blockSize);
+        size_t offset = header_offset(blockSize);
+        char* data = (char*)sk_malloc_throw(offset + sizeof(Block));
+        Block* block = (Block*)(data + offset);
+        block->fNext = next;
+        block->fData = data;
+        block->fSize = blockSize;
+        next = block;
+        if (fTail) {
+            fTail->fNext = block;
+        } else {
+            fHead = block;
+        }
     }
+    next->fAllocated = 0;
+    fTail = next;
+    return next;
+}
 
-    static Block* Create(size_t size) {
-        SkASSERT(SkAlign4(size) == size);
-        Block* block = (Block*)sk_malloc_throw(sizeof(Block) + size);
-        block->fNext = NULL;
-        block->fSize = size;
-        block->fAllocated = 0;
-        return block;
+void SkWriter32::freeBlocks(Block* block) {
+    while (block) {
+        Block* next = block->fNext;
+        if (block != &fExternal) {
+            sk_free(block->fData);
+        }
+        block = next;
     }
-};
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
 SkWriter32::~SkWriter32() {
-    this->reset();
+    this->freeBlocks(fHead);
 }
 
 void SkWriter32::reset() {
-    Block* block = fHead;    
-    while (block) {
-        Block* next = block->fNext;
-        sk_free(block);
-        block = next;
+    Block* heap = (fHead == &fExternal) ? fExternal.fNext : fHead;
+
+    if (heap && heap->fNext) {
+        size_t total = 0;
+        for (Block* block = heap; block; block = block->fNext) {
+            total += block->fSize;
+        }
+        this->freeBlocks(heap);
+        fTail = (fHead == &fExternal) ? fHead : NULL;
+        if (NULL == fTail) {
+            fHead = NULL;
+        } else {
+            fTail->fNext = NULL;
+        }
+        fSize = 0;
+        this->nextBlock(total);
     }
 
+    for (Block* block = fHead; block; block = block->fNext) {
+        block->fAllocated = 0;
+    }
     fSize = 0;
-    fHead = fTail = NULL;
-    fSingleBlock = NULL;
+    fTail = fHead;
 }
 
 void SkWriter32::reset(void* block, size_t size) {
     this->reset();
-    SkASSERT(0 == ((fSingleBlock - (char*)0) & 3));   // need 4-byte alignment
-    fSingleBlock = (char*)block;
-    fSingleBlockSize = (size & ~3);
+    Block* heap = (fHead == &fExternal) ? fExternal.fNext : fHead;
+
+    if (block) {
+        SkASSERT(0 == (((char*)block - (char*)0) & 3));   // 4-byte alignment
+        fExternal.fNext = heap;
+        fExternal.fData = (char*)block;
+        fExternal.fSize = size & ~3;
+        fExternal.fAllocated = 0;
+        fHead = &fExternal;
+    } else {
+        fHead = heap;
+    }
+    fTail = fHead;
 }
 
-uint32_t* SkWriter32::reserve(size_t size) {
-    SkASSERT(SkAlign4(size) == size);
+const void* SkWriter32::contiguousArray() const {
+    if (fHead == fTail) {
+        return fHead ? fHead->fData : NULL;
+    }
+    return NULL;
+}
 
-    if (fSingleBlock) {
-        uint32_t* ptr = (uint32_t*)(fSingleBlock + fSize);
-        fSize += size;
-        SkASSERT(fSize <= fSingleBlockSize);
-        return ptr;
+void* SkWriter32::detachContiguousArray() {
+    if (NULL == fHead || fHead != fTail || fHead == &fExternal) {
+        return NULL;
     }
+    void* data = fHead->fData;
+    fHead = fTail = fHead->fNext;
+    if (fTail) {
+        fTail->fAllocated = 0;
+    }
+    fSize = 0;
+    return data;
+}
 
-    Block* block = fTail;
+uint32_t* SkWriter32::reserve(size_t size) {
+    SkASSERT(SkAlign4(size) == size);
 
-    if (NULL == block) {
-        SkASSERT(NULL == fHead);
-        fHead = fTail = block = Block::Create(SkMax32(size, fMinSize));
-    } else if (block->available() < size) {
-        fTail = Block::Create(SkMax32(size, fMinSize));
-        block->fNext = fTail;
-        block = fTail;
+    Block* block = fTail;
+    if (NULL == block || block->available() < size) {
+        block = this->nextBlock(size);
     }
-    
-    fSize += size;
 
-    return block->alloc(size);
+    uint32_t* ptr = (uint32_t*)(block->fData + block->fAllocated);
+    block->fAllocated += size;
+    fSize += size;
+    return ptr;
 }
 
-uint32_t* SkWriter32::peek32(size_t offset) {
+void SkWriter32::rewindToOffset(size_t offset) {
     SkASSERT(SkAlign4(offset) == offset);
     SkASSERT(offset <= fSize);
 
-    if (fSingleBlock) {
-        return (uint32_t*)(fSingleBlock + offset);
+    if (offset == fSize) {
+        return;
     }
+    fSize = offset;
+    Block* block = fHead;
+    while (offset > block->fAllocated && block != fTail) {
+        offset -= block->fAllocated;
+        block = block->fNext;
+    }
+    // the blocks after this one are spare again
+    block->fAllocated = offset;
+    fTail = block;
+}
+
+uint32_t* SkWriter32::peek32(size_t offset) {
+    SkASSERT(SkAlign4(offset) == offset);
+    SkASSERT(offset <= fSize);
 
     Block* block = fHead;
     SkASSERT(NULL != block);
-    
-    while (offset >= block->fAllocated) {
+
+    while (offset >= block->fAllocated && block != fTail) {
         offset -= block->fAllocated;
         block = block->fNext;
         SkASSERT(NULL != block);
     }
-    return block->peek32(offset);
+    SkASSERT(offset <= block->fAllocated + 4);
+    return (uint32_t*)(block->fData + offset);
 }
 
 void SkWriter32::flatten(void* dst) const {
-    if (fSingleBlock) {
-        memcpy(dst, fSingleBlock, fSize);
-        return;
-    }
-
     const Block* block = fHead;
     SkDEBUGCODE(size_t total = 0;)
 
     while (block) {
         size_t allocated = block->fAllocated;
-        memcpy(dst, block->base(), allocated);
+        memcpy(dst, block->fData, allocated);
         dst = (char*)dst + allocated;
-        block = block->fNext;
 
         SkDEBUGCODE(total += allocated;)
         SkASSERT(total <= fSize);
+        if (block == fTail) {
+            break;
+        }
+        block = block->fNext;
     }
     SkASSERT(total == fSize);
 }
@@ -140,17 +191,6 @@ void SkWriter32::writePad(const void* src, size_t size) {
 #include "SkStream.h"
 
 size_t SkWriter32::readFromStream(SkStream* stream, size_t length) {
-    if (fSingleBlock) {
-        SkASSERT(fSingleBlockSize >= fSize);
-        size_t remaining = fSingleBlockSize - fSize;
-        if (length > remaining) {
-            length = remaining;
-        }
-        stream->read(fSingleBlock + fSize, length);
-        fSize += length;
-        return length;
-    }
-
     char scratch[1024];
     const size_t MAX = sizeof(scratch);
     size_t remaining = length;
@@ -171,15 +211,14 @@ size_t SkWriter32::readFromStream(SkStream* stream, size_t length) {
 }
 
 bool SkWriter32::writeToStream(SkWStream* stream) {
-    if (fSingleBlock) {
-        return stream->write(fSingleBlock, fSize);
-    }
-
     const Block* block = fHead;    
     while (block) {
-        if (!stream->write(block->base(), block->fAllocated)) {
+        if (!stream->write(block->fData, block->fAllocated)) {
             return false;
         }
+        if (block == fTail) {
+            break;
+        }
         block = block->fNext;
     }
     return true;
@@ -717,6 +717,19 @@ public:
         // these may be valid, or may be CANNOT_USE_COEFF
         fSrcCoeff = rec.fSC;
         fDstCoeff = rec.fDC;
+        fProc32 = SkXfermode::PlatformProcs32(mode);
+    }
+
+    virtual void xfer32(SkPMColor* SK_RESTRICT dst,
+                        const SkPMColor* SK_RESTRICT src, int count,
+                        const SkAlpha* SK_RESTRICT aa) {
+        SkASSERT(dst && src && count >= 0);
+
+        if (NULL == aa && NULL != fProc32) {
+            fProc32(dst, src, count);
+        } else {
+            this->INHERITED::xfer32(dst, src, count, aa);
+        }
     }
 
     virtual bool asMode(Mode* mode) {
@@ -758,8 +771,13 @@ protected:
         fMode = (SkXfermode::Mode)buffer.readU32();
         fSrcCoeff = (Coeff)buffer.readU32();
         fDstCoeff = (Coeff)buffer.readU32();
+        // not flattened, since it depends on the cpu we're running on
+        fProc32 = SkXfermode::PlatformProcs32(fMode);
     }
 
+    // optional faster version of fProc for rows with no coverage
+    Proc32  fProc32;
+
 private:
     Mode    fMode;
     Coeff   fSrcCoeff, fDstCoeff;
@@ -899,6 +917,9 @@ public:
         if (NULL != aa) {
             return this->INHERITED::xfer32(dst, src, count, aa);
         }
+        if (NULL != fProc32) {
+            return fProc32(dst, src, count);
+        }
 
         do {
             unsigned a = SkGetPackedA32(*src);
@@ -935,6 +956,9 @@ public:
         if (NULL != aa) {
             return this->INHERITED::xfer32(dst, src, count, aa);
         }
+        if (NULL != fProc32) {
+            return fProc32(dst, src, count);
+        }
 
         do {
             unsigned a = SkGetPackedA32(*src);
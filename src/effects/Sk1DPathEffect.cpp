@@ -20,7 +20,8 @@
 
 bool Sk1DPathEffect::filterPath(SkPath* dst, const SkPath& src, SkScalar* width)
 {
-    SkPathMeasure   meas(src, false);
+    SkAutoCachedPathMeasure acm(&fMeasureCache, src, false);
+    SkPathMeasure&  meas = acm.get();
     do {
         SkScalar    length = meas.getLength();
         SkScalar    distance = this->begin(length);
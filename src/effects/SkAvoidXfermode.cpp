@@ -120,9 +120,46 @@ static inline unsigned Accurate255To256(unsigned x) {
     return x + (x >> 7);
 }
 
+// looked up once; threads racing to look them up all find the same procs
+static SkAvoidXfermode::Proc32 get_proc32() {
+    static bool gChecked;
+    static SkAvoidXfermode::Proc32 gProc;
+    if (!gChecked) {
+        gProc = SkAvoidXfermode::PlatformProc32();
+        gChecked = true;
+    }
+    return gProc;
+}
+
+static SkAvoidXfermode::Proc16 get_proc16() {
+    static bool gChecked;
+    static SkAvoidXfermode::Proc16 gProc;
+    if (!gChecked) {
+        gProc = SkAvoidXfermode::PlatformProc16();
+        gChecked = true;
+    }
+    return gProc;
+}
+
+void SkAvoidXfermode::getState(State* state) const {
+    state->fOpR = SkColorGetR(fOpColor);
+    state->fOpG = SkColorGetG(fOpColor);
+    state->fOpB = SkColorGetB(fOpColor);
+    state->fDistMul = fDistMul;
+    state->fTarget = kTargetColor_Mode == fMode;
+}
+
 void SkAvoidXfermode::xfer32(SkPMColor dst[], const SkPMColor src[], int count,
                              const SkAlpha aa[])
 {
+    int i = 0;
+    Proc32 proc = get_proc32();
+    if (NULL != proc) {
+        State state;
+        this->getState(&state);
+        i = proc(state, dst, src, count, aa);
+    }
+
     unsigned    opR = SkColorGetR(fOpColor);
     unsigned    opG = SkColorGetG(fOpColor);
     unsigned    opB = SkColorGetB(fOpColor);
@@ -139,7 +176,7 @@ void SkAvoidXfermode::xfer32(SkPMColor dst[], const SkPMColor src[], int count,
         MAX = 0;
     }
 
-    for (int i = 0; i < count; i++) {
+    for (; i < count; i++) {
         int d = color_dist32(dst[i], opR, opG, opB);
         // now reverse d if we need to
         d = MAX + (d ^ mask) - mask;
@@ -151,7 +188,7 @@ void SkAvoidXfermode::xfer32(SkPMColor dst[], const SkPMColor src[], int count,
 
         if (d > 0) {
             if (NULL != aa) {
-                d = SkAlphaMul(d, Accurate255To256(*aa++));
+                d = SkAlphaMul(d, Accurate255To256(aa[i]));
                 if (0 == d) {
                     continue;
                 }
@@ -174,6 +211,14 @@ static inline U16CPU SkBlend3216(SkPMColor src, U16CPU dst, unsigned scale)
 void SkAvoidXfermode::xfer16(uint16_t dst[], const SkPMColor src[], int count,
                              const SkAlpha aa[])
 {
+    int i = 0;
+    Proc16 proc = get_proc16();
+    if (NULL != proc) {
+        State state;
+        this->getState(&state);
+        i = proc(state, dst, src, count, aa);
+    }
+
     unsigned    opR = SkColorGetR(fOpColor) >> (8 - SK_R16_BITS);
     unsigned    opG = SkColorGetG(fOpColor) >> (8 - SK_G16_BITS);
     unsigned    opB = SkColorGetB(fOpColor) >> (8 - SK_R16_BITS);
@@ -190,7 +235,7 @@ void SkAvoidXfermode::xfer16(uint16_t dst[], const SkPMColor src[], int count,
         MAX = 0;
     }
 
-    for (int i = 0; i < count; i++) {
+    for (; i < count; i++) {
         int d = color_dist16(dst[i], opR, opG, opB);
         // now reverse d if we need to
         d = MAX + (d ^ mask) - mask;
@@ -202,7 +247,7 @@ void SkAvoidXfermode::xfer16(uint16_t dst[], const SkPMColor src[], int count,
 
         if (d > 0) {
             if (NULL != aa) {
-                d = SkAlphaMul(d, Accurate255To256(*aa++));
+                d = SkAlphaMul(d, Accurate255To256(aa[i]));
                 if (0 == d) {
                     continue;
                 }
@@ -243,7 +288,7 @@ void SkAvoidXfermode::xfer4444(uint16_t dst[], const SkPMColor src[], int count,
 
         if (d > 0) {
             if (NULL != aa) {
-                d = SkAlphaMul(d, Accurate255To256(*aa++));
+                d = SkAlphaMul(d, Accurate255To256(aa[i]));
                 if (0 == d) {
                     continue;
                 }
@@ -16,32 +16,48 @@
 
 #include "SkBitmapCache.h"
 
+static uint32_t compute_hash(const void* buffer, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)buffer;
+    uint32_t hash = 0;
+    for (size_t i = 0; i < size; i++) {
+        hash = hash * 31 + bytes[i];
+    }
+    return hash;
+}
+
 struct SkBitmapCache::Entry {
     Entry*      fPrev;
     Entry*      fNext;
 
     void*       fBuffer;
     size_t      fSize;
+    uint32_t    fHash;
     SkBitmap    fBitmap;
 
-    Entry(const void* buffer, size_t size, const SkBitmap& bm)
+    Entry(const void* buffer, size_t size, uint32_t hash, const SkBitmap& bm)
             : fPrev(NULL),
               fNext(NULL),
               fBitmap(bm) {
         fBuffer = sk_malloc_throw(size);
         fSize = size;
+        fHash = hash;
         memcpy(fBuffer, buffer, size);
     }
 
     ~Entry() { sk_free(fBuffer); }
 
-    bool equals(const void* buffer, size_t size) const {
-        return (fSize == size) && !memcmp(fBuffer, buffer, size);
+    size_t bytesUsed() const { return fSize + fBitmap.getSize(); }
+
+    // compare the hashes first, so most mismatches skip the memcmp
+    bool equals(const void* buffer, size_t size, uint32_t hash) const {
+        return (fHash == hash) && (fSize == size) &&
+               !memcmp(fBuffer, buffer, size);
     }
 };
 
 SkBitmapCache::SkBitmapCache(int max) : fMaxEntries(max) {
     fEntryCount = 0;
+    fBytesUsed = 0;
     fHead = fTail = NULL;
 
     this->validate();
@@ -90,9 +106,10 @@ void SkBitmapCache::attachToHead(Entry* entry) const {
 bool SkBitmapCache::find(const void* buffer, size_t size, SkBitmap* bm) const {
     AutoValidate av(this);
 
+    const uint32_t hash = compute_hash(buffer, size);
     Entry* entry = fHead;
     while (entry) {
-        if (entry->equals(buffer, size)) {
+        if (entry->equals(buffer, size, hash)) {
             if (bm) {
                 *bm = entry->fBitmap;
             }
@@ -111,13 +128,26 @@ void SkBitmapCache::add(const void* buffer, size_t len, const SkBitmap& bm) {
 
     if (fEntryCount == fMaxEntries) {
         SkASSERT(fTail);
+        fBytesUsed -= fTail->bytesUsed();
         delete this->detach(fTail);
         fEntryCount -= 1;
     }
 
-    Entry* entry = new Entry(buffer, len, bm);
+    Entry* entry = new Entry(buffer, len, compute_hash(buffer, len), bm);
     this->attachToHead(entry);
     fEntryCount += 1;
+    fBytesUsed += entry->bytesUsed();
+}
+
+void SkBitmapCache::purgeTo(size_t bytes) {
+    AutoValidate av(this);
+
+    while (fBytesUsed > bytes) {
+        SkASSERT(fTail);
+        fBytesUsed -= fTail->bytesUsed();
+        delete this->detach(fTail);
+        fEntryCount -= 1;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -139,11 +169,14 @@ void SkBitmapCache::validate() const {
 
         Entry* entry = fHead;
         int count = 0;
+        size_t bytes = 0;
         while (entry) {
             count += 1;
+            bytes += entry->bytesUsed();
             entry = entry->fNext;
         }
         SkASSERT(count == fEntryCount);
+        SkASSERT(bytes == fBytesUsed);
 
         entry = fTail;
         while (entry) {
@@ -154,6 +187,7 @@ void SkBitmapCache::validate() const {
     } else {
         SkASSERT(NULL == fHead);
         SkASSERT(NULL == fTail);
+        SkASSERT(0 == fBytesUsed);
     }
 }
 
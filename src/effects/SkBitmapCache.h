@@ -27,8 +27,19 @@ public:
     bool find(const void* buffer, size_t len, SkBitmap*) const;
     void add(const void* buffer, size_t len, const SkBitmap&);
 
+    /** Return the memory used by the keys and the bitmaps' pixels. Pixels
+        that are shared with others are counted in full.
+    */
+    size_t bytesUsed() const { return fBytesUsed; }
+
+    /** Remove the least recently used entries until no more than the
+        specified number of bytes remain.
+    */
+    void purgeTo(size_t bytes);
+
 private:
     int fEntryCount;
+    size_t fBytesUsed;
     const int fMaxEntries;
 
     struct Entry;
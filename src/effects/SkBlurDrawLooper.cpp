@@ -107,6 +107,24 @@ bool SkBlurDrawLooper::next(SkCanvas* canvas, SkPaint* paint) {
     }
 }
 
+bool SkBlurDrawLooper::computeFastBoundsOutset(SkRect* outset) const {
+    // the offset (and the blur) would be in device pixels
+    if (fBlurFlags & kIgnoreTransform_BlurFlag) {
+        return false;
+    }
+    SkRect shadow = *outset;
+    if (fBlur && !fBlur->computeFastBoundsOutset(&shadow)) {
+        return false;
+    }
+    shadow.offset(fDx, fDy);
+    // not join(), which skips empty rects
+    outset->set(SkMinScalar(outset->fLeft, shadow.fLeft),
+                SkMinScalar(outset->fTop, shadow.fTop),
+                SkMaxScalar(outset->fRight, shadow.fRight),
+                SkMaxScalar(outset->fBottom, shadow.fBottom));
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static SkFlattenable::Registrar gReg("SkBlurDrawLooper",
@@ -18,165 +18,317 @@
 #include "SkBlurMask.h"
 #include "SkTemplates.h"
 
-#if 0
-static void dump_sum_buffer(const uint32_t sum[], const int w, const int h) {
-    printf("---- sum buffer\n");
-    for (int y = 0; y <= h; y++) {
-        for (int x = 0; x <= w; x++) {
-            printf(" %5d", sum[x]);
-        }
-        printf("\n");
-        sum += w+1;
-    }
-}
-#else
-#define dump_sum_buffer(sum, w, h)
-#endif
-
-/** The sum buffer is an array of u32 to hold the accumulated sum of all of the
-    src values at their position, plus all values above and to the left.
-    When we sample into this buffer, we need an initial row and column of 0s,
-    so we have an index correspondence as follows:
- 
-    src[i, j] == sum[i+1, j+1]
-    sum[0, j] == sum[i, 0] == 0
- 
-    We assume that the sum buffer's stride == its width
- */
-static void build_sum_buffer(uint32_t sum[], int srcW, int srcH, const uint8_t src[], int srcRB) {
-    int sumW = srcW + 1;
-
-    SkASSERT(srcRB >= srcW);
-    // mod srcRB so we can apply it after each row
-    srcRB -= srcW;
+#include "SkThread.h"
+#include "SkThreadPool.h"
 
-    int x, y;
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
-    // zero out the top row and column
-    memset(sum, 0, sumW * sizeof(sum[0]));
-    sum += sumW;
+/*  A box blur of radius r is separable: each dst value is the sum of a
+    (2r+1) x (2r+1) window of the src (which is 0 outside of its bounds), so we
+    sum each row's windows first, and then sum those down each column. Every
+    sum is exact, so scaling them as the summed-area table used to gives the
+    same bytes.
 
-    // special case first row
-    uint32_t X = 0;
-    *sum++ = 0; // initialze the first column to 0
-    for (x = srcW - 1; x >= 0; --x)
-    {
-        X = *src++ + X;
-        *sum++ = X;
-    }
-    src += srcRB;
+    When the outer weight is not 255 we also blur with radius r-1 (the inner
+    box), and blend the two as we scale them.
 
-    // now do the rest of the rows
-    for (y = srcH - 1; y > 0; --y)
-    {
-        uint32_t L = 0;
-        uint32_t C = 0;
-        *sum++ = 0; // initialze the first column to 0
-        for (x = srcW - 1; x >= 0; --x)
-        {
-            uint32_t T = sum[-sumW];
-            X = *src++ + L + T - C;
-            *sum++ = X;
-            L = X;
-            C = T;
+    The dst is (sw + 2r) x (sh + 2r), and dst[x, y] reads the src window
+    [x - 2r, x] x [y - 2r, y].
+ */
+struct BoxBlur {
+    const uint8_t*  fSrc;
+    int             fSrcRB;
+    int             fSW, fSH;
+    int             fR;
+    uint8_t*        fDst;       // rowbytes == dst width
+    uint32_t*       fOuter;     // row sums of the outer box, dw x sh
+    uint32_t*       fInner;     // row sums of the inner box, or NULL
+    const uint32_t* fZeros;     // dw zeros
+    uint32_t        fOuterScale;
+    uint32_t        fInnerScale;
+
+    int dstWidth() const { return fSW + 2 * fR; }
+    int dstHeight() const { return fSH + 2 * fR; }
+
+    void sumRows(int y0, int y1) const;
+    void sumColumns(int y0, int y1) const;
+};
+
+void BoxBlur::sumRows(int y0, int y1) const {
+    const int sw = fSW;
+    const int r2 = 2 * fR;
+    const int dw = this->dstWidth();
+
+    // each row is copied between 2r+1 zeros on the left and 2r on the right,
+    // so that padded[x + 1 .. x + 2r + 1] is the window of dst[x]
+    SkAutoSTMalloc<1024, uint8_t> storage(sw + 2 * r2 + 1);
+    uint8_t* padded = storage.get();
+    memset(padded, 0, r2 + 1);
+    memset(padded + r2 + 1 + sw, 0, r2);
+
+    for (int y = y0; y < y1; y++) {
+        memcpy(padded + r2 + 1, fSrc + y * fSrcRB, sw);
+        uint32_t* outer = fOuter + y * dw;
+        uint32_t sum = 0;
+        for (int x = 0; x < dw; x++) {
+            sum += padded[x + r2 + 1] - padded[x];
+            outer[x] = sum;
+        }
+        if (fInner) {
+            // the inner window drops the two ends of the outer one
+            uint32_t* inner = fInner + y * dw;
+            for (int x = 0; x < dw; x++) {
+                inner[x] = outer[x] - padded[x + r2 + 1] - padded[x + 1];
+            }
         }
-        src += srcRB;
     }
 }
 
-/*  sw and sh are the width and height of the src. Since the sum buffer
-    matches that, but has an extra row and col at the beginning (with zeros),
-    we can just use sw and sh as our "max" values for pinning coordinates
-    when sampling into sum[][]
- */
-static void apply_kernel(uint8_t dst[], int rx, int ry, const uint32_t sum[],
-                         int sw, int sh) {
-    uint32_t scale = (1 << 24) / ((2*rx + 1)*(2*ry + 1));
-
-    int sumStride = sw + 1;
-
-    int dw = sw + 2*rx;
-    int dh = sh + 2*ry;
+#if defined(__SSE2__)
+// (a * scale) for each unsigned lane, as 64bit products in the even and odd
+// lanes
+static inline void mul_epu32(__m128i a, __m128i scale, __m128i* even,
+                             __m128i* odd) {
+    *even = _mm_mul_epu32(a, scale);
+    *odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), scale);
+}
 
-    int prev_y = -2*ry;
-    int next_y = 1;
+// the low 32 bits of (even >> 24) and (odd >> 24), back in their lanes
+static inline __m128i shift24(__m128i even, __m128i odd) {
+    even = _mm_srli_epi64(even, 24);
+    odd = _mm_slli_epi64(_mm_srli_epi64(odd, 24), 32);
+    return _mm_or_si128(even, odd);
+}
+#endif
 
-    for (int y = 0; y < dh; y++) {
-        int py = SkClampPos(prev_y) * sumStride;
-        int ny = SkFastMin32(next_y, sh) * sumStride;
+void BoxBlur::sumColumns(int y0, int y1) const {
+    const int sh = fSH;
+    const int r2 = 2 * fR;
+    const int dw = this->dstWidth();
 
-        int prev_x = -2*rx;
-        int next_x = 1;
+    SkAutoTMalloc<uint32_t> storage(fInner ? 2 * dw : dw);
+    uint32_t* accOuter = storage.get();
+    uint32_t* accInner = fInner ? accOuter + dw : NULL;
 
+    // start with the windows of row y0 - 1
+    memset(accOuter, 0, dw * sizeof(uint32_t));
+    for (int j = SkMax32(y0 - 1 - r2, 0); j <= SkMin32(y0 - 1, sh - 1); j++) {
+        const uint32_t* row = fOuter + j * dw;
         for (int x = 0; x < dw; x++) {
-            int px = SkClampPos(prev_x);
-            int nx = SkFastMin32(next_x, sw);
-
-            uint32_t tmp = sum[px+py] + sum[nx+ny] - sum[nx+py] - sum[px+ny];
-            *dst++ = SkToU8(tmp * scale >> 24);
+            accOuter[x] += row[x];
+        }
+    }
+    if (accInner) {
+        memset(accInner, 0, dw * sizeof(uint32_t));
+        for (int j = SkMax32(y0 - r2, 0); j <= SkMin32(y0 - 2, sh - 1); j++) {
+            const uint32_t* row = fInner + j * dw;
+            for (int x = 0; x < dw; x++) {
+                accInner[x] += row[x];
+            }
+        }
+    }
 
-            prev_x += 1;
-            next_x += 1;
+    for (int y = y0; y < y1; y++) {
+        // slide the windows down to [y - 2r, y] and [y - 2r + 1, y - 1]
+        const uint32_t* add = y < sh ? fOuter + y * dw : fZeros;
+        const uint32_t* sub = y > r2 ? fOuter + (y - r2 - 1) * dw : fZeros;
+        uint8_t* dst = fDst + y * dw;
+        int x = 0;
+
+        if (NULL == accInner) {
+            const uint32_t scale = fOuterScale;
+#if defined(__SSE2__)
+            const __m128i wideScale = _mm_set1_epi32(scale);
+            for (; x + 8 <= dw; x += 8) {
+                __m128i* acc = reinterpret_cast<__m128i*>(accOuter + x);
+                __m128i a0 = _mm_loadu_si128(acc);
+                __m128i a1 = _mm_loadu_si128(acc + 1);
+                a0 = _mm_add_epi32(a0, _mm_loadu_si128((const __m128i*)(add + x)));
+                a1 = _mm_add_epi32(a1, _mm_loadu_si128((const __m128i*)(add + x + 4)));
+                a0 = _mm_sub_epi32(a0, _mm_loadu_si128((const __m128i*)(sub + x)));
+                a1 = _mm_sub_epi32(a1, _mm_loadu_si128((const __m128i*)(sub + x + 4)));
+                _mm_storeu_si128(acc, a0);
+                _mm_storeu_si128(acc + 1, a1);
+
+                __m128i even, odd;
+                mul_epu32(a0, wideScale, &even, &odd);
+                a0 = shift24(even, odd);
+                mul_epu32(a1, wideScale, &even, &odd);
+                a1 = shift24(even, odd);
+                // every value is < 256, so the saturating packs are exact
+                __m128i bytes = _mm_packs_epi32(a0, a1);
+                bytes = _mm_packus_epi16(bytes, bytes);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), bytes);
+            }
+#endif
+            for (; x < dw; x++) {
+                uint32_t a = accOuter[x] + add[x] - sub[x];
+                accOuter[x] = a;
+                dst[x] = SkToU8(a * scale >> 24);
+            }
+        } else {
+            const uint32_t* addInner = y >= 1 && y <= sh ?
+                                       fInner + (y - 1) * dw : fZeros;
+            const uint32_t* subInner = y > r2 - 1 && y - r2 < sh ?
+                                       fInner + (y - r2) * dw : fZeros;
+            const uint32_t outerScale = fOuterScale;
+            const uint32_t innerScale = fInnerScale;
+#if defined(__SSE2__)
+            const __m128i wideOuter = _mm_set1_epi32(outerScale);
+            const __m128i wideInner = _mm_set1_epi32(innerScale);
+            for (; x + 4 <= dw; x += 4) {
+                __m128i* accO = reinterpret_cast<__m128i*>(accOuter + x);
+                __m128i* accI = reinterpret_cast<__m128i*>(accInner + x);
+                __m128i o = _mm_loadu_si128(accO);
+                __m128i i = _mm_loadu_si128(accI);
+                o = _mm_add_epi32(o, _mm_loadu_si128((const __m128i*)(add + x)));
+                o = _mm_sub_epi32(o, _mm_loadu_si128((const __m128i*)(sub + x)));
+                i = _mm_add_epi32(i, _mm_loadu_si128((const __m128i*)(addInner + x)));
+                i = _mm_sub_epi32(i, _mm_loadu_si128((const __m128i*)(subInner + x)));
+                _mm_storeu_si128(accO, o);
+                _mm_storeu_si128(accI, i);
+
+                __m128i evenO, oddO, evenI, oddI;
+                mul_epu32(o, wideOuter, &evenO, &oddO);
+                mul_epu32(i, wideInner, &evenI, &oddI);
+                // the sums fit in 32 bits, as they did in the scalar code
+                __m128i v = shift24(_mm_add_epi64(evenO, evenI),
+                                    _mm_add_epi64(oddO, oddI));
+                v = _mm_packs_epi32(v, v);
+                v = _mm_packus_epi16(v, v);
+                uint32_t four = _mm_cvtsi128_si32(v);
+                memcpy(dst + x, &four, 4);
+            }
+#endif
+            for (; x < dw; x++) {
+                uint32_t o = accOuter[x] + add[x] - sub[x];
+                uint32_t i = accInner[x] + addInner[x] - subInner[x];
+                accOuter[x] = o;
+                accInner[x] = i;
+                dst[x] = SkToU8((o * outerScale + i * innerScale) >> 24);
+            }
         }
-        prev_y += 1;
-        next_y += 1;
     }
 }
 
-/*  sw and sh are the width and height of the src. Since the sum buffer
- matches that, but has an extra row and col at the beginning (with zeros),
- we can just use sw and sh as our "max" values for pinning coordinates
- when sampling into sum[][]
- */
-static void apply_kernel_interp(uint8_t dst[], int rx, int ry,
-                const uint32_t sum[], int sw, int sh, U8CPU outer_weight) {
-    SkASSERT(rx > 0 && ry > 0);
-    SkASSERT(outer_weight <= 255);
+///////////////////////////////////////////////////////////////////////////////
 
-    int inner_weight = 255 - outer_weight;
-
-    // round these guys up if they're bigger than 127
-    outer_weight += outer_weight >> 7;
-    inner_weight += inner_weight >> 7;
-
-    uint32_t outer_scale = (outer_weight << 16) / ((2*rx + 1)*(2*ry + 1));
-    uint32_t inner_scale = (inner_weight << 16) / ((2*rx - 1)*(2*ry - 1));
-
-    int sumStride = sw + 1;
-
-    int dw = sw + 2*rx;
-    int dh = sh + 2*ry;
+/*  Large masks are split into bands of rows that are blurred in parallel. The
+    calling thread does the first band itself.
+ */
 
-    int prev_y = -2*ry;
-    int next_y = 1;
+// smaller masks are not worth the hand off to the other threads
+static const int kMinParallelPixels = 256 * 256;
+static const int kMinBandRows = 32;
+static const int kMaxBands = 16;
+
+static SkMutex          gBlurThreadsMutex;
+static SkThreadPool*    gBlurThreads;
+static int              gBandCount;     // 0 until gBlurThreads is set up
+
+// returns the pool, or NULL (with *bands == 1) if we are single threaded
+static SkThreadPool* get_blur_threads(int* bands) {
+    SkAutoMutexAcquire ac(gBlurThreadsMutex);
+    if (0 == gBandCount) {
+        gBandCount = SkMin32(SkThreadPool::CPUCount(), kMaxBands);
+        if (gBandCount > 1) {
+            gBlurThreads = SkNEW_ARGS(SkThreadPool, (gBandCount - 1));
+            if (0 == gBlurThreads->threadCount()) {
+                SkDELETE(gBlurThreads);
+                gBlurThreads = NULL;
+                gBandCount = 1;
+            }
+        }
+    }
+    *bands = gBandCount;
+    return gBlurThreads;
+}
 
-    for (int y = 0; y < dh; y++) {
-        int py = SkClampPos(prev_y) * sumStride;
-        int ny = SkFastMin32(next_y, sh) * sumStride;
+class BlurBand : public SkRunnable {
+public:
+    typedef void (BoxBlur::*Proc)(int y0, int y1) const;
 
-        int ipy = SkClampPos(prev_y + 1) * sumStride;
-        int iny = SkClampMax(next_y - 1, sh) * sumStride;
+    void set(const BoxBlur* blur, Proc proc, int y0, int y1) {
+        fBlur = blur;
+        fProc = proc;
+        fY0 = y0;
+        fY1 = y1;
+    }
 
-        int prev_x = -2*rx;
-        int next_x = 1;
+    virtual void run() {
+        (fBlur->*fProc)(fY0, fY1);
+    }
 
-        for (int x = 0; x < dw; x++) {
-            int px = SkClampPos(prev_x);
-            int nx = SkFastMin32(next_x, sw);
+private:
+    const BoxBlur*  fBlur;
+    Proc            fProc;
+    int             fY0, fY1;
+};
+
+static void run_in_bands(const BoxBlur& blur, BlurBand::Proc proc, int rows) {
+    int bands = 1;
+    SkThreadPool* threads = NULL;
+    if (blur.dstWidth() * rows >= kMinParallelPixels) {
+        threads = get_blur_threads(&bands);
+        bands = SkMin32(bands, rows / kMinBandRows);
+    }
+    if (NULL == threads || bands <= 1) {
+        (blur.*proc)(0, rows);
+        return;
+    }
 
-            int ipx = SkClampPos(prev_x + 1);
-            int inx = SkClampMax(next_x - 1, sw);
+    BlurBand storage[kMaxBands];
+    for (int i = 1; i < bands; i++) {
+        storage[i].set(&blur, proc, rows * i / bands, rows * (i + 1) / bands);
+        threads->add(&storage[i]);
+    }
+    (blur.*proc)(0, rows / bands);
+    threads->wait();
+}
 
-            uint32_t outer_sum = sum[px+py] + sum[nx+ny] - sum[nx+py] - sum[px+ny];
-            uint32_t inner_sum = sum[ipx+ipy] + sum[inx+iny] - sum[inx+ipy] - sum[ipx+iny];
-            *dst++ = SkToU8((outer_sum * outer_scale + inner_sum * inner_scale) >> 24);
+/*  Blur the sw x sh src into dst, which is (sw + 2r) x (sh + 2r) and has
+    rowbytes equal to its width.
+ */
+static void box_blur(uint8_t dst[], const uint8_t src[], int srcRB,
+                     int sw, int sh, int r, U8CPU outer_weight) {
+    SkASSERT(r > 0);
+    SkASSERT(outer_weight <= 255);
 
-            prev_x += 1;
-            next_x += 1;
-        }
-        prev_y += 1;
-        next_y += 1;
+    BoxBlur blur;
+    blur.fSrc = src;
+    blur.fSrcRB = srcRB;
+    blur.fSW = sw;
+    blur.fSH = sh;
+    blur.fR = r;
+    blur.fDst = dst;
+
+    const int dw = blur.dstWidth();
+    const bool interp = outer_weight != 255;
+    SkAutoTMalloc<uint32_t> storage(((interp ? 2 : 1) * sh + 1) * dw);
+    blur.fOuter = storage.get();
+    blur.fInner = interp ? blur.fOuter + sh * dw : NULL;
+    uint32_t* zeros = storage.get() + (interp ? 2 : 1) * sh * dw;
+    memset(zeros, 0, dw * sizeof(uint32_t));
+    blur.fZeros = zeros;
+
+    if (interp) {
+        int inner_weight = 255 - outer_weight;
+
+        // round these guys up if they're bigger than 127
+        outer_weight += outer_weight >> 7;
+        inner_weight += inner_weight >> 7;
+
+        blur.fOuterScale = (outer_weight << 16) / ((2*r + 1)*(2*r + 1));
+        blur.fInnerScale = (inner_weight << 16) / ((2*r - 1)*(2*r - 1));
+    } else {
+        blur.fOuterScale = (1 << 24) / ((2*r + 1)*(2*r + 1));
+        blur.fInnerScale = 0;
     }
+
+    run_in_bands(blur, &BoxBlur::sumRows, sh);
+    run_in_bands(blur, &BoxBlur::sumColumns, blur.dstHeight());
 }
 
 #include "SkColorPriv.h"
@@ -291,39 +443,20 @@ bool SkBlurMask::Blur(SkMask* dst, const SkMask& src,
         SkAutoTCallVProc<uint8_t, SkMask_FreeImage> autoCall(dp);
 
         // build the blurry destination
-        {
-            SkAutoTMalloc<uint32_t> storage((sw + 2 * (passCount - 1) * rx + 1) * (sh + 2 * (passCount - 1) * ry + 1));
-            uint32_t*               sumBuffer = storage.get();
-
-            //pass1: sp is source, dp is destination
-            build_sum_buffer(sumBuffer, sw, sh, sp, src.fRowBytes);
-            dump_sum_buffer(sumBuffer, sw, sh);
-            if (outer_weight == 255)
-                apply_kernel(dp, rx, ry, sumBuffer, sw, sh);
-            else
-                apply_kernel_interp(dp, rx, ry, sumBuffer, sw, sh, outer_weight);
-
-            if (quality == kHigh_Quality)
-            {
-                //pass2: dp is source, tmpBuffer is destination
-                int tmp_sw = sw + 2 * rx;
-                int tmp_sh = sh + 2 * ry;
-                SkAutoTMalloc<uint8_t>  tmpBuffer(dstSize);
-                build_sum_buffer(sumBuffer, tmp_sw, tmp_sh, dp, tmp_sw);
-                if (outer_weight == 255)
-                    apply_kernel(tmpBuffer.get(), rx, ry, sumBuffer, tmp_sw, tmp_sh);
-                else
-                    apply_kernel_interp(tmpBuffer.get(), rx, ry, sumBuffer, tmp_sw, tmp_sh, outer_weight);
-
-                //pass3: tmpBuffer is source, dp is destination
-                tmp_sw += 2 * rx;
-                tmp_sh += 2 * ry;
-                build_sum_buffer(sumBuffer, tmp_sw, tmp_sh, tmpBuffer.get(), tmp_sw);
-                if (outer_weight == 255)
-                    apply_kernel(dp, rx, ry, sumBuffer, tmp_sw, tmp_sh);
-                else
-                    apply_kernel_interp(dp, rx, ry, sumBuffer, tmp_sw, tmp_sh, outer_weight);
-            }
+        box_blur(dp, sp, src.fRowBytes, sw, sh, rx, outer_weight);
+        if (quality == kHigh_Quality) {
+            //pass2: dp is source, tmpBuffer is destination
+            int tmp_sw = sw + 2 * rx;
+            int tmp_sh = sh + 2 * ry;
+            SkAutoTMalloc<uint8_t>  tmpBuffer(dstSize);
+            box_blur(tmpBuffer.get(), dp, tmp_sw, tmp_sw, tmp_sh, rx,
+                     outer_weight);
+
+            //pass3: tmpBuffer is source, dp is destination
+            tmp_sw += 2 * rx;
+            tmp_sh += 2 * ry;
+            box_blur(dp, tmpBuffer.get(), tmp_sw, tmp_sw, tmp_sh, rx,
+                     outer_weight);
         }
 
         dst->fImage = dp;
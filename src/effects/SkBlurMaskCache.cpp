@@ -0,0 +1,260 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkBlurMaskCache.h"
+#include "SkPurgeableCache.h"
+#include "SkThread.h"
+
+// plenty for the handful of shadows that a UI draws over and over
+#define BLUR_CACHE_DEFAULT_LIMIT    (512 * 1024)
+// keeps the lookup, which looks at every entry, cheap next to a blur
+#define BLUR_CACHE_MAX_ENTRIES      256
+
+/*  Each entry is a single allocation: the header, then the src image (with
+    rowbytes == width), then the dst image.
+ */
+struct BlurCacheEntry {
+    BlurCacheEntry* fPrev;  // more recently used
+    BlurCacheEntry* fNext;  // less recently used
+    size_t          fSize;  // of the whole allocation
+
+    uint32_t        fHash;
+    SkScalar        fRadius;
+    int             fStyle;
+    int             fQuality;
+    int             fSrcWidth;
+    int             fSrcHeight;
+    SkIRect         fDstBounds; // relative to the src's top left
+    uint32_t        fDstRowBytes;
+
+    uint8_t* srcImage() const {
+        return (uint8_t*)(this + 1);
+    }
+    uint8_t* dstImage() const {
+        return this->srcImage() + fSrcWidth * fSrcHeight;
+    }
+    size_t dstSize() const {
+        return fDstRowBytes * fDstBounds.height();
+    }
+};
+
+static SkMutex          gBlurCacheMutex;
+static BlurCacheEntry*  gHead;
+static BlurCacheEntry*  gTail;
+static int              gCount;
+static size_t           gBytesUsed;
+static size_t           gByteLimit = BLUR_CACHE_DEFAULT_LIMIT;
+
+static uint32_t compute_hash(const SkMask& src, SkScalar radius,
+                             SkBlurMask::Style style,
+                             SkBlurMask::Quality quality) {
+    // FNV-1a over the src pixels, then the parameters
+    uint32_t hash = 2166136261U;
+    const int width = src.fBounds.width();
+    const int height = src.fBounds.height();
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = src.fImage + y * src.fRowBytes;
+        for (int x = 0; x < width; x++) {
+            hash = (hash ^ row[x]) * 16777619U;
+        }
+    }
+    const uint32_t params[] = {
+        (uint32_t)SkScalarToFixed(radius), (uint32_t)style, (uint32_t)quality,
+        (uint32_t)width, (uint32_t)height
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(params); i++) {
+        hash = (hash ^ params[i]) * 16777619U;
+    }
+    return hash;
+}
+
+static bool matches(const BlurCacheEntry* entry, uint32_t hash,
+                    const SkMask& src, SkScalar radius,
+                    SkBlurMask::Style style, SkBlurMask::Quality quality) {
+    const int width = src.fBounds.width();
+    const int height = src.fBounds.height();
+    if (entry->fHash != hash || entry->fRadius != radius ||
+            entry->fStyle != style || entry->fQuality != quality ||
+            entry->fSrcWidth != width || entry->fSrcHeight != height) {
+        return false;
+    }
+    const uint8_t* cached = entry->srcImage();
+    for (int y = 0; y < height; y++) {
+        if (memcmp(cached + y * width, src.fImage + y * src.fRowBytes, width)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the following must be called with gBlurCacheMutex held
+
+static void detach(BlurCacheEntry* entry) {
+    if (entry->fPrev) {
+        entry->fPrev->fNext = entry->fNext;
+    } else {
+        gHead = entry->fNext;
+    }
+    if (entry->fNext) {
+        entry->fNext->fPrev = entry->fPrev;
+    } else {
+        gTail = entry->fPrev;
+    }
+    gCount -= 1;
+    gBytesUsed -= entry->fSize;
+}
+
+static void add_to_head(BlurCacheEntry* entry) {
+    entry->fPrev = NULL;
+    entry->fNext = gHead;
+    if (gHead) {
+        gHead->fPrev = entry;
+    } else {
+        gTail = entry;
+    }
+    gHead = entry;
+    gCount += 1;
+    gBytesUsed += entry->fSize;
+}
+
+static void purge_to(size_t limit) {
+    while (gTail && (gBytesUsed > limit || gCount > BLUR_CACHE_MAX_ENTRIES)) {
+        BlurCacheEntry* entry = gTail;
+        detach(entry);
+        sk_free(entry);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkBlurMaskCache::Find(const SkMask& src, SkScalar radius,
+                           SkBlurMask::Style style,
+                           SkBlurMask::Quality quality, SkMask* dst) {
+    SkASSERT(SkMask::kA8_Format == src.fFormat && src.fImage);
+
+    const uint32_t hash = compute_hash(src, radius, style, quality);
+
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    for (BlurCacheEntry* entry = gHead; entry; entry = entry->fNext) {
+        if (matches(entry, hash, src, radius, style, quality)) {
+            detach(entry);
+            add_to_head(entry);
+
+            dst->fBounds = entry->fDstBounds;
+            dst->fBounds.offset(src.fBounds.fLeft, src.fBounds.fTop);
+            dst->fRowBytes = entry->fDstRowBytes;
+            dst->fFormat = SkMask::kA8_Format;
+            dst->fImage = SkMask::AllocImage(entry->dstSize());
+            memcpy(dst->fImage, entry->dstImage(), entry->dstSize());
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkBlurMaskCache::Add(const SkMask& src, SkScalar radius,
+                          SkBlurMask::Style style,
+                          SkBlurMask::Quality quality, const SkMask& dst) {
+    SkASSERT(SkMask::kA8_Format == src.fFormat && src.fImage);
+    SkASSERT(SkMask::kA8_Format == dst.fFormat && dst.fImage);
+
+    const int width = src.fBounds.width();
+    const int height = src.fBounds.height();
+    const size_t size = sizeof(BlurCacheEntry) + width * height +
+                        dst.computeImageSize();
+    // a single mask may not crowd out all of the others
+    if (size > GetByteLimit() / 4) {
+        return;
+    }
+
+    BlurCacheEntry* entry = (BlurCacheEntry*)sk_malloc_flags(size, 0);
+    if (NULL == entry) {
+        return;
+    }
+    entry->fSize = size;
+    entry->fHash = compute_hash(src, radius, style, quality);
+    entry->fRadius = radius;
+    entry->fStyle = style;
+    entry->fQuality = quality;
+    entry->fSrcWidth = width;
+    entry->fSrcHeight = height;
+    entry->fDstBounds = dst.fBounds;
+    entry->fDstBounds.offset(-src.fBounds.fLeft, -src.fBounds.fTop);
+    entry->fDstRowBytes = dst.fRowBytes;
+    for (int y = 0; y < height; y++) {
+        memcpy(entry->srcImage() + y * width, src.fImage + y * src.fRowBytes,
+               width);
+    }
+    memcpy(entry->dstImage(), dst.fImage, entry->dstSize());
+
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    // another thread may have beaten us to it
+    for (BlurCacheEntry* e = gHead; e; e = e->fNext) {
+        if (matches(e, entry->fHash, src, radius, style, quality)) {
+            sk_free(entry);
+            return;
+        }
+    }
+    add_to_head(entry);
+    purge_to(gByteLimit);
+}
+
+size_t SkBlurMaskCache::GetByteLimit() {
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    return gByteLimit;
+}
+
+void SkBlurMaskCache::SetByteLimit(size_t bytes) {
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    gByteLimit = bytes;
+    purge_to(bytes);
+}
+
+size_t SkBlurMaskCache::GetBytesUsed() {
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    return gBytesUsed;
+}
+
+void SkBlurMaskCache::Purge() {
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    purge_to(0);
+}
+
+void SkBlurMaskCache::PurgeTo(size_t bytes) {
+    SkAutoMutexAcquire ac(gBlurCacheMutex);
+    purge_to(bytes);
+}
+
+namespace {
+
+class BlurPurgeableCache : public SkPurgeableCache {
+public:
+    BlurPurgeableCache() : INHERITED("blur masks", kModerate_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        return SkBlurMaskCache::GetBytesUsed();
+    }
+    virtual void purgeTo(size_t bytes) {
+        SkBlurMaskCache::PurgeTo(bytes);
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static BlurPurgeableCache gPurgeableCache;
@@ -0,0 +1,66 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#ifndef SkBlurMaskCache_DEFINED
+#define SkBlurMaskCache_DEFINED
+
+#include "SkBlurMask.h"
+
+/** \class SkBlurMaskCache
+
+    A global, bounded cache of blurred A8 masks, most recently used first.
+
+    Entries are keyed by the blur parameters and by the exact contents of the
+    src mask, which capture both the shape that was drawn and its fractional
+    position on the pixel grid. The src's integer position is not part of the
+    key: the same shape drawn one pixel over finds the same entry.
+*/
+class SkBlurMaskCache {
+public:
+    /** If the result of SkBlurMask::Blur(dst, src, radius, style, quality) is
+        in the cache, copy it into dst (allocating its image with
+        SkMask::AllocImage()) and return true. Otherwise return false.
+    */
+    static bool Find(const SkMask& src, SkScalar radius, SkBlurMask::Style,
+                     SkBlurMask::Quality, SkMask* dst);
+
+    /** Remember that dst is the blur of src with these parameters. Masks that
+        are too large for the cache are ignored.
+    */
+    static void Add(const SkMask& src, SkScalar radius, SkBlurMask::Style,
+                    SkBlurMask::Quality, const SkMask& dst);
+
+    /** Return the limit on the memory used by the cache, in bytes. */
+    static size_t GetByteLimit();
+
+    /** Set the limit, purging the oldest entries if need be. 0 turns the
+        cache off.
+    */
+    static void SetByteLimit(size_t bytes);
+
+    /** Return the memory currently used by the cache, in bytes. */
+    static size_t GetBytesUsed();
+
+    /** Purge the oldest entries until no more than the specified number of
+        bytes remain. Unlike SetByteLimit(), this leaves the limit alone.
+    */
+    static void PurgeTo(size_t bytes);
+
+    /** Remove every entry. */
+    static void Purge();
+};
+
+#endif
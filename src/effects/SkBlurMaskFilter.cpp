@@ -17,8 +17,11 @@
 
 #include "SkBlurMaskFilter.h"
 #include "SkBlurMask.h"
+#include "SkBlurMaskCache.h"
 #include "SkBuffer.h"
+#include "SkDraw.h"
 #include "SkMaskFilter.h"
+#include "SkPath.h"
 
 class SkBlurMaskFilterImpl : public SkMaskFilter {
 public:
@@ -27,6 +30,8 @@ public:
     // overrides from SkMaskFilter
     virtual SkMask::Format getFormat();
     virtual bool filterMask(SkMask* dst, const SkMask& src, const SkMatrix& matrix, SkIPoint* margin);
+    virtual bool computeFastBoundsOutset(SkRect* outset) const;
+    virtual BlurType asABlur(BlurInfo*) const;
 
     // overrides from SkFlattenable
     // This method is not exported to java.
@@ -36,12 +41,22 @@ public:
 
     static SkFlattenable* CreateProc(SkFlattenableReadBuffer&);
 
+protected:
+    virtual FilterReturn filterRectToNine(const SkRect&, const SkMatrix&,
+                                          NinePatch*);
+
 private:
     SkScalar                    fRadius;
     SkBlurMaskFilter::BlurStyle fBlurStyle;
     uint32_t                    fBlurFlags;
 
     SkBlurMaskFilterImpl(SkFlattenableReadBuffer&);
+
+    SkScalar computeRadius(const SkMatrix&) const;
+    SkBlurMask::Quality quality() const {
+        return (fBlurFlags & SkBlurMaskFilter::kHighQuality_BlurFlag) ?
+                SkBlurMask::kHigh_Quality : SkBlurMask::kLow_Quality;
+    }
     
     typedef SkMaskFilter INHERITED;
 };
@@ -83,7 +98,7 @@ SkMask::Format SkBlurMaskFilterImpl::getFormat()
     return SkMask::kA8_Format;
 }
 
-bool SkBlurMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src, const SkMatrix& matrix, SkIPoint* margin)
+SkScalar SkBlurMaskFilterImpl::computeRadius(const SkMatrix& matrix) const
 {
     SkScalar radius;
     if (fBlurFlags & SkBlurMaskFilter::kIgnoreTransform_BlurFlag)
@@ -95,20 +110,182 @@ bool SkBlurMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src, const SkMa
     // handset) we limit the radius so something manageable. (as opposed to
     // a request like 10,000)
     static const SkScalar MAX_RADIUS = SkIntToScalar(128);
-    radius = SkMinScalar(radius, MAX_RADIUS);
-    SkBlurMask::Quality blurQuality = (fBlurFlags & SkBlurMaskFilter::kHighQuality_BlurFlag) ? 
-        SkBlurMask::kHigh_Quality : SkBlurMask::kLow_Quality;
+    return SkMinScalar(radius, MAX_RADIUS);
+}
 
-    if (SkBlurMask::Blur(dst, src, radius, (SkBlurMask::Style)fBlurStyle, blurQuality))
+bool SkBlurMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src, const SkMatrix& matrix, SkIPoint* margin)
+{
+    SkScalar radius = this->computeRadius(matrix);
+    SkBlurMask::Style blurStyle = (SkBlurMask::Style)fBlurStyle;
+    SkBlurMask::Quality blurQuality = this->quality();
+
+    // only an actual image can be looked up, a request for just the bounds
+    // is cheap anyway
+    bool found = src.fImage && SkMask::kA8_Format == src.fFormat &&
+                 SkBlurMaskCache::Find(src, radius, blurStyle, blurQuality, dst);
+    if (!found && SkBlurMask::Blur(dst, src, radius, blurStyle, blurQuality))
     {
-        if (margin) {
-            // we need to integralize radius for our margin, so take the ceil
-            // just to be safe.
-            margin->set(SkScalarCeil(radius), SkScalarCeil(radius));
+        if (src.fImage) {
+            SkBlurMaskCache::Add(src, radius, blurStyle, blurQuality, *dst);
         }
-        return true;
+        found = true;
+    }
+    if (found && margin) {
+        // we need to integralize radius for our margin, so take the ceil
+        // just to be safe.
+        margin->set(SkScalarCeil(radius), SkScalarCeil(radius));
+    }
+    return found;
+}
+
+bool SkBlurMaskFilterImpl::computeFastBoundsOutset(SkRect* outset) const {
+    // a radius that ignores the CTM is in device pixels
+    if (fBlurFlags & SkBlurMaskFilter::kIgnoreTransform_BlurFlag) {
+        return false;
+    }
+    // SkBlurMask::Blur() pads by at most sqrt(passes) * radius, plus a pixel
+    // of rounding per pass. The radius scales with the CTM, the rounding
+    // doesn't, so this holds unless the CTM shrinks the blur a lot.
+    const SkScalar pad = SkScalarMul(fRadius, SkFloatToScalar(1.7321f)) +
+                         SkIntToScalar(3);
+    outset->inset(-pad, -pad);
+    return true;
+}
+
+SkMaskFilter::BlurType SkBlurMaskFilterImpl::asABlur(BlurInfo* info) const {
+    if (info) {
+        info->fRadius = fRadius;
+        info->fIgnoreTransform = SkToBool(fBlurFlags &
+                                    SkBlurMaskFilter::kIgnoreTransform_BlurFlag);
+        info->fHighQuality = SkToBool(fBlurFlags &
+                                    SkBlurMaskFilter::kHighQuality_BlurFlag);
+    }
+    static const BlurType gBlurStyle2BlurType[] = {
+        kNormal_BlurType,
+        kSolid_BlurType,
+        kOuter_BlurType,
+        kInner_BlurType,
+    };
+    SkASSERT((unsigned)fBlurStyle < SK_ARRAY_COUNT(gBlurStyle2BlurType));
+    return gBlurStyle2BlurType[fBlurStyle];
+}
+
+/*  The blur of a rect is the same down the middle of each side: once every
+    dst pixel reads a window that lies inside the rect, whole columns (and
+    rows) of the rect can be dropped without changing the pixels around them.
+    So we blur a rect that is just big enough to have one such column and
+    row, and have it stretched over the real one.
+
+    The dropped columns must be identical, so we only count the ones that are
+    entirely inside the rect (with a pixel to spare for the antialiasing),
+    and we move the right (or left) edge by a whole number of pixels, which
+    keeps its coverage the same.
+ */
+
+// how many pixels of the rect [left, right) can be dropped, given that the
+// middle must keep at least need pixels
+static int compute_extra(SkScalar left, SkScalar right, int need) {
+    int interior = SkScalarFloor(right) - SkScalarCeil(left) - 2;
+    return SkMax32(interior - need, 0);
+}
+
+// The antialiasing scan converter has a separate loop for paths that are at
+// most 32 pixels wide and 1K pixels in all, which rounds their edges a little
+// differently. The small rect must be on the same side of that line as the
+// real one.
+static const int kMinTinyKeep = 32;
+
+static bool is_tiny(const SkRect& r) {
+    SkIRect ir;
+    r.roundOut(&ir);
+    return ir.width() <= 32 && SkAlign4(ir.width()) * ir.height() <= 1024;
+}
+
+// moves the edge with the larger magnitude in, which keeps the result exact
+// as a float: it needs no more precision than that edge already has
+static void shrink(SkScalar* left, SkScalar* right, int extra, bool* fromRight) {
+    *fromRight = SkScalarAbs(*right) >= SkScalarAbs(*left);
+    if (*fromRight) {
+        *right -= SkIntToScalar(extra);
+    } else {
+        *left += SkIntToScalar(extra);
+    }
+}
+
+SkMaskFilter::FilterReturn SkBlurMaskFilterImpl::filterRectToNine(
+        const SkRect& rect, const SkMatrix& matrix, NinePatch* patch)
+{
+    const SkScalar radius = this->computeRadius(matrix);
+
+    // the distance the blur reaches from each pixel
+    SkMask probe, probeDst;
+    probe.fBounds.set(0, 0, 1, 1);
+    probe.fFormat = SkMask::kA8_Format;
+    probe.fImage = NULL;
+    if (!SkBlurMask::Blur(&probeDst, probe, radius, SkBlurMask::kNormal_Style,
+                          this->quality())) {
+        return kUnimplemented_FilterReturn;
+    }
+    const int pad = -probeDst.fBounds.fLeft;
+    const int need = SkMax32(2 * pad + 1, kMinTinyKeep);
+
+    const int extraX = compute_extra(rect.fLeft, rect.fRight, need);
+    const int extraY = compute_extra(rect.fTop, rect.fBottom, need);
+    if (0 == extraX && 0 == extraY) {
+        // too small to be worth it
+        return kUnimplemented_FilterReturn;
+    }
+
+    SkRect small = rect;
+    bool fromRight, fromBottom;
+    shrink(&small.fLeft, &small.fRight, extraX, &fromRight);
+    shrink(&small.fTop, &small.fBottom, extraY, &fromBottom);
+    if (is_tiny(small) != is_tiny(rect)) {
+        return kUnimplemented_FilterReturn;
+    }
+
+    SkPath path;
+    path.addRect(small);
+    SkMask srcM;
+    if (!SkDraw::DrawToMask(path, NULL, NULL, NULL, &srcM,
+                            SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
+        return kFalse_FilterReturn;
+    }
+    SkAutoMaskImage autoSrc(&srcM, false);
+
+    SkMask& dstM = patch->fMask;
+    if (!this->filterMask(&dstM, srcM, matrix, NULL)) {
+        return kFalse_FilterReturn;
+    }
+
+    // the first pixel of the (small) interior, plus the reach of the blur,
+    // is the column whose window is exactly the kept middle. A side that was
+    // not shrunk is not stretched, so any column will do.
+    patch->fCenter.set(0, 0);
+    if (extraX) {
+        patch->fCenter.fX = SkScalarCeil(small.fLeft) + 1 + pad -
+                            dstM.fBounds.fLeft;
+    }
+    if (extraY) {
+        patch->fCenter.fY = SkScalarCeil(small.fTop) + 1 + pad -
+                            dstM.fBounds.fTop;
+    }
+    SkASSERT((unsigned)patch->fCenter.fX < (unsigned)dstM.fBounds.width());
+    SkASSERT((unsigned)patch->fCenter.fY < (unsigned)dstM.fBounds.height());
+
+    SkIRect& outer = patch->fOuterRect;
+    outer = dstM.fBounds;
+    if (fromRight) {
+        outer.fRight += extraX;
+    } else {
+        outer.fLeft -= extraX;
     }
-    return false;
+    if (fromBottom) {
+        outer.fBottom += extraY;
+    } else {
+        outer.fTop -= extraY;
+    }
+    return kTrue_FilterReturn;
 }
 
 SkFlattenable* SkBlurMaskFilterImpl::CreateProc(SkFlattenableReadBuffer& buffer)
@@ -140,6 +317,18 @@ void SkBlurMaskFilterImpl::flatten(SkFlattenableWriteBuffer& buffer)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+size_t SkBlurMaskFilter::GetCacheLimit()
+{
+    return SkBlurMaskCache::GetByteLimit();
+}
+
+void SkBlurMaskFilter::SetCacheLimit(size_t bytes)
+{
+    SkBlurMaskCache::SetByteLimit(bytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static SkFlattenable::Registrar gReg("SkBlurMaskFilter",
                                      SkBlurMaskFilterImpl::CreateProc);
 
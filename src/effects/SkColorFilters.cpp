@@ -16,6 +16,7 @@
 
 #include "SkBlitRow.h"
 #include "SkColorFilter.h"
+#include "SkColorMatrixFilter.h"
 #include "SkColorPriv.h"
 #include "SkUtils.h"
 
@@ -568,6 +569,95 @@ SkColorFilter* SkColorFilter::CreateLightingFilter(SkColor mul, SkColor add) {
     return SkNEW_ARGS(SkLightingColorFilter, (mul, add));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+class SkComposeColorFilter : public SkColorFilter {
+public:
+    SkComposeColorFilter(SkColorFilter* outer, SkColorFilter* inner) {
+        fOuter = outer;     outer->ref();
+        fInner = inner;     inner->ref();
+    }
+
+    virtual ~SkComposeColorFilter() {
+        fInner->unref();
+        fOuter->unref();
+    }
+
+    virtual uint32_t getFlags() {
+        // both have to leave alpha alone (or have a 16bit version)
+        return fOuter->getFlags() & fInner->getFlags();
+    }
+
+    virtual void filterSpan(const SkPMColor shader[], int count,
+                            SkPMColor result[]) {
+        fInner->filterSpan(shader, count, result);
+        fOuter->filterSpan(result, count, result);
+    }
+
+    virtual void filterSpan16(const uint16_t shader[], int count,
+                              uint16_t result[]) {
+        SkASSERT(this->getFlags() & kHasFilter16_Flag);
+        fInner->filterSpan16(shader, count, result);
+        fOuter->filterSpan16(result, count, result);
+    }
+
+    static SkFlattenable* CreateProc(SkFlattenableReadBuffer& buffer) {
+        return SkNEW_ARGS(SkComposeColorFilter, (buffer));
+    }
+
+protected:
+    virtual void flatten(SkFlattenableWriteBuffer& buffer) {
+        this->INHERITED::flatten(buffer);
+        buffer.writeFlattenable(fOuter);
+        buffer.writeFlattenable(fInner);
+    }
+
+    virtual Factory getFactory() { return CreateProc; }
+
+    SkComposeColorFilter(SkFlattenableReadBuffer& buffer) : INHERITED(buffer) {
+        fOuter = static_cast<SkColorFilter*>(buffer.readFlattenable());
+        fInner = static_cast<SkColorFilter*>(buffer.readFlattenable());
+    }
+
+private:
+    SkColorFilter*  fOuter;
+    SkColorFilter*  fInner;
+
+    typedef SkColorFilter INHERITED;
+};
+
+SkColorFilter* SkColorFilter::CreateComposeFilter(SkColorFilter* outer,
+                                                  SkColorFilter* inner) {
+    if (NULL == outer || NULL == inner) {
+        SkColorFilter* filter = outer ? outer : inner;
+        SkSafeRef(filter);
+        return filter;
+    }
+
+    // the outer filter makes the same color whatever it's given
+    SkColor color;
+    SkXfermode::Mode mode;
+    if (outer->asColorMode(&color, &mode) && SkXfermode::kSrc_Mode == mode) {
+        outer->ref();
+        return outer;
+    }
+
+    // the inner filter makes just the one color, so filter it now
+    if (inner->asColorMode(&color, &mode) && SkXfermode::kSrc_Mode == mode &&
+            outer->filterColorExact(color, &color)) {
+        return SkColorFilter::CreateModeFilter(color, SkXfermode::kSrc_Mode);
+    }
+
+    SkColorMatrix outerMatrix, innerMatrix;
+    if (outer->asColorMatrix(outerMatrix.fMat) &&
+            inner->asColorMatrix(innerMatrix.fMat)) {
+        outerMatrix.preConcat(innerMatrix);
+        return SkNEW_ARGS(SkColorMatrixFilter, (outerMatrix));
+    }
+
+    return SkNEW_ARGS(SkComposeColorFilter, (outer, inner));
+}
+
 static SkFlattenable::Registrar
     gSrcColorFilterReg("Src_SkModeColorFilterReg",
                        Src_SkModeColorFilter::CreateProc);
@@ -579,3 +669,7 @@ static SkFlattenable::Registrar
 static SkFlattenable::Registrar
     gProcColorFilterReg("Proc_SkModeColorFilterReg",
                        Proc_SkModeColorFilter::CreateProc);
+
+static SkFlattenable::Registrar
+    gComposeColorFilterReg("SkComposeColorFilter",
+                       SkComposeColorFilter::CreateProc);
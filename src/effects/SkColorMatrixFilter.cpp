@@ -205,6 +205,17 @@ static int32_t pin(int32_t value, int32_t max) {
     return value;
 }
 
+// looked up once; threads racing to look it up all find the same proc
+static SkColorMatrixFilter::SpanProc get_span_proc() {
+    static bool gChecked;
+    static SkColorMatrixFilter::SpanProc gProc;
+    if (!gChecked) {
+        gProc = SkColorMatrixFilter::PlatformSpanProc();
+        gChecked = true;
+    }
+    return gProc;
+}
+
 SkColorMatrixFilter::SkColorMatrixFilter() {
     this->setup(NULL);
 }
@@ -221,6 +232,28 @@ uint32_t SkColorMatrixFilter::getFlags() {
     return this->INHERITED::getFlags() | fFlags;
 }
 
+// rebuilt from fState, so entries that setup() had to shift down come back
+// without their low bits
+bool SkColorMatrixFilter::asColorMatrix(SkScalar matrix[20]) {
+    if (NULL == fProc) {
+        SkColorMatrix cm;
+        cm.setIdentity();
+        memcpy(matrix, cm.fMat, sizeof(cm.fMat));
+        return true;
+    }
+
+    const int32_t add = 1 << (fState.fShift - 1);
+    const int bits = 16 - fState.fShift;
+    for (int i = 0; i < 20; i++) {
+        int32_t value = fState.fArray[i];
+        if (4 == i % 5) {
+            value -= add;   // undo the rounding that setup() added
+        }
+        matrix[i] = SkFixedToScalar(value << bits);
+    }
+    return true;
+}
+
 void SkColorMatrixFilter::filterSpan(const SkPMColor src[], int count,
                                      SkPMColor dst[]) {
     Proc proc = fProc;
@@ -234,9 +267,17 @@ void SkColorMatrixFilter::filterSpan(const SkPMColor src[], int count,
         return;
     }
 
+    // each of the procs is a special case of General, which is what the
+    // platform proc always computes
+    int i = 0;
+    SpanProc spanProc = get_span_proc();
+    if (NULL != spanProc) {
+        i = spanProc(*state, src, count, dst);
+    }
+
     const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
 
-    for (int i = 0; i < count; i++) {
+    for (; i < count; i++) {
         SkPMColor c = src[i];
 
         unsigned r = SkGetPackedR32(c);
@@ -137,6 +137,11 @@ DONE:
     return true;
 }
 
+bool SkCornerPathEffect::computeFastBoundsOutset(SkRect*) const {
+    // the rounded corners stay inside the corners they replace
+    return true;
+}
+
 SkFlattenable::Factory SkCornerPathEffect::getFactory() {
     return CreateProc;
 }
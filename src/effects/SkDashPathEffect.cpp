@@ -36,7 +36,7 @@ static SkScalar FindFirstInterval(const SkScalar intervals[], SkScalar phase,
 
 SkDashPathEffect::SkDashPathEffect(const SkScalar intervals[], int count,
                                    SkScalar phase, bool scaleToFit)
-        : fScaleToFit(scaleToFit) {
+        : fScaleToFit(scaleToFit), fCachedGenerationID(0) {
     SkASSERT(intervals);
     SkASSERT(count > 1 && SkAlign2(count) == count);
 
@@ -76,14 +76,21 @@ SkDashPathEffect::~SkDashPathEffect() {
     sk_free(fIntervals);
 }
 
-bool SkDashPathEffect::filterPath(SkPath* dst, const SkPath& src,
-                                  SkScalar* width) {
-    // we do nothing if the src wants to be filled, or if our dashlength is 0
-    if (*width < 0 || fInitialDashLength < 0) {
-        return false;
+SkScalar SkDashPathEffect::fitScale(SkScalar length) const {
+    if (!fScaleToFit) {
+        return SK_Scalar1;
+    }
+    if (fIntervalLength >= length) {
+        return SkScalarDiv(length, fIntervalLength);
     }
+    SkScalar div = SkScalarDiv(length, fIntervalLength);
+    int n = SkScalarFloor(div);
+    return SkScalarDiv(length, n * fIntervalLength);
+}
 
-    SkPathMeasure   meas(src, false);
+void SkDashPathEffect::dashMeasured(SkPath* dst, const SkPath& src) {
+    SkAutoCachedPathMeasure acm(&fMeasureCache, src, false);
+    SkPathMeasure&  meas = acm.get();
     const SkScalar* intervals = fIntervals;
 
     do {
@@ -91,17 +98,7 @@ bool SkDashPathEffect::filterPath(SkPath* dst, const SkPath& src,
         bool        addedSegment = false;
         SkScalar    length = meas.getLength();
         int         index = fInitialDashIndex;
-        SkScalar    scale = SK_Scalar1;
-
-        if (fScaleToFit) {
-            if (fIntervalLength >= length) {
-                scale = SkScalarDiv(length, fIntervalLength);
-            } else {
-                SkScalar div = SkScalarDiv(length, fIntervalLength);
-                int n = SkScalarFloor(div);
-                scale = SkScalarDiv(length, n * fIntervalLength);
-            }
-        }
+        SkScalar    scale = this->fitScale(length);
 
         SkScalar    distance = 0;
         SkScalar    dlen = SkScalarMul(fInitialDashLength, scale);
@@ -135,6 +132,246 @@ bool SkDashPathEffect::filterPath(SkPath* dst, const SkPath& src,
             meas.getSegment(0, SkScalarMul(fInitialDashLength, scale), dst, !addedSegment);
         }
     } while (meas.nextContour());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct LineSeg {
+    SkPoint     fStart, fStop;
+    SkScalar    fDistance;      // total distance up to fStop
+};
+
+/*  A contour made only of lines, measured the way SkPathMeasure does it (so
+    the dashes fall in the same places), but with the points at hand, so that
+    each dash is found by walking forward from the last one.
+ */
+class LineContour {
+public:
+    LineContour() : fLength(0), fIsClosed(false) {}
+
+    void reset() {
+        fSegs.rewind();
+        fLength = 0;
+        fIsClosed = false;
+    }
+
+    void lineTo(const SkPoint& p0, const SkPoint& p1) {
+        SkScalar d = SkPoint::Distance(p0, p1);
+        SkASSERT(d >= 0);
+        if (!SkScalarNearlyZero(d)) {
+            fLength += d;
+            LineSeg* seg = fSegs.append();
+            seg->fStart = p0;
+            seg->fStop = p1;
+            seg->fDistance = fLength;
+        }
+    }
+
+    void close() { fIsClosed = true; }
+
+    SkScalar length() const { return fLength; }
+    bool isClosed() const { return fIsClosed; }
+
+    /** Like SkPathMeasure::getSegment(). hint is the segment that the last
+        call stopped in, and has to be at or before startD's.
+    */
+    bool getSegment(SkScalar startD, SkScalar stopD, SkPath* dst,
+                    bool startWithMoveTo, int* hint) const {
+        if (startD < 0) {
+            startD = 0;
+        }
+        if (stopD > fLength) {
+            stopD = fLength;
+        }
+        if (startD >= stopD) {
+            return false;
+        }
+
+        // like SkPathMeasure, leave out the pieces too short to matter
+        int i = this->find(startD, *hint);
+        SkScalar t = this->tAt(i, startD);
+        if (startWithMoveTo) {
+            dst->moveTo(this->pointAt(i, t));
+        }
+        const LineSeg* segs = fSegs.begin();
+        if (segs[i].fDistance < stopD) {
+            if (!SkScalarNearlyZero(SK_Scalar1 - t)) {
+                dst->lineTo(segs[i].fStop);
+            }
+            i += 1;
+            while (segs[i].fDistance < stopD) {
+                dst->lineTo(segs[i].fStop);
+                i += 1;
+            }
+            t = 0;
+        }
+        SkScalar stopT = this->tAt(i, stopD);
+        if (!SkScalarNearlyZero(stopT - t)) {
+            dst->lineTo(this->pointAt(i, stopT));
+        }
+        *hint = i;
+        return true;
+    }
+
+private:
+    SkTDArray<LineSeg>  fSegs;
+    SkScalar            fLength;
+    bool                fIsClosed;
+
+    // the first segment that ends at or after distance
+    int find(SkScalar distance, int i) const {
+        const LineSeg* segs = fSegs.begin();
+        const int last = fSegs.count() - 1;
+        while (i < last && segs[i].fDistance < distance) {
+            i += 1;
+        }
+        return i;
+    }
+
+    SkScalar tAt(int i, SkScalar distance) const {
+        SkScalar startD = i > 0 ? fSegs[i - 1].fDistance : 0;
+        return SkScalarDiv(distance - startD, fSegs[i].fDistance - startD);
+    }
+
+    SkPoint pointAt(int i, SkScalar t) const {
+        const LineSeg& seg = fSegs[i];
+        SkPoint pt;
+        if (t >= SK_Scalar1) {
+            pt = seg.fStop;
+        } else {
+            pt.set(SkScalarInterp(seg.fStart.fX, seg.fStop.fX, t),
+                   SkScalarInterp(seg.fStart.fY, seg.fStop.fY, t));
+        }
+        return pt;
+    }
+};
+
+}  // namespace
+
+/*  Dashes the contours as dashMeasured() does, but returns false (leaving dst
+    incomplete) as soon as it finds a curve, which is the only thing that
+    needs SkPathMeasure's help. The contours are split up as it does, and it
+    stops at the first empty one after the first.
+ */
+bool SkDashPathEffect::dashLines(SkPath* dst, const SkPath& src) const {
+    SkPath::Iter    iter(src, false);
+    SkPoint         pts[4];
+    LineContour     contour;
+    const SkScalar* intervals = fIntervals;
+    bool            inContour = false;
+    bool            firstContour = true;
+    bool            done = false;
+
+    while (!done) {
+        switch (iter.next(pts)) {
+            case SkPath::kMove_Verb:
+                if (!inContour) {
+                    inContour = true;
+                    continue;
+                }
+                break;  // it starts the next contour
+            case SkPath::kLine_Verb:
+                contour.lineTo(pts[0], pts[1]);
+                continue;
+            case SkPath::kQuad_Verb:
+            case SkPath::kCubic_Verb:
+                return false;
+            case SkPath::kClose_Verb:
+                contour.close();
+                continue;
+            case SkPath::kDone_Verb:
+                done = true;
+                break;
+        }
+
+        SkScalar length = contour.length();
+        if (!firstContour && length <= 0) {
+            break;
+        }
+        firstContour = false;
+
+        bool        skipFirstSegment = contour.isClosed();
+        bool        addedSegment = false;
+        int         index = fInitialDashIndex;
+        SkScalar    scale = this->fitScale(length);
+        SkScalar    distance = 0;
+        SkScalar    dlen = SkScalarMul(fInitialDashLength, scale);
+        int         hint = 0;
+
+        while (distance < length) {
+            SkASSERT(dlen >= 0);
+            addedSegment = false;
+            if (is_even(index) && dlen > 0 && !skipFirstSegment) {
+                addedSegment = true;
+                contour.getSegment(distance, distance + dlen, dst, true,
+                                   &hint);
+            }
+            distance += dlen;
+            skipFirstSegment = false;
+
+            index += 1;
+            SkASSERT(index <= fCount);
+            if (index == fCount) {
+                index = 0;
+            }
+            dlen = SkScalarMul(intervals[index], scale);
+        }
+
+        if (contour.isClosed() && is_even(fInitialDashIndex) &&
+                fInitialDashLength > 0) {
+            hint = 0;
+            contour.getSegment(0, SkScalarMul(fInitialDashLength, scale), dst,
+                               !addedSegment, &hint);
+        }
+        contour.reset();
+    }
+    return true;
+}
+
+bool SkDashPathEffect::filterPath(SkPath* dst, const SkPath& src,
+                                  SkScalar* width) {
+    // we do nothing if the src wants to be filled, or if our dashlength is 0
+    if (*width < 0 || fInitialDashLength < 0) {
+        return false;
+    }
+
+    // the dashes only depend on the src's points and verbs
+    const uint32_t genID = src.getGenerationID();
+    {
+        SkAutoMutexAcquire ac(fCacheMutex);
+        if (genID == fCachedGenerationID) {
+            if (dst->isEmpty()) {
+                *dst = fCachedDst;
+            } else {
+                dst->addPath(fCachedDst);
+            }
+            return true;
+        }
+    }
+
+    SkPath dashed;
+    if (!this->dashLines(&dashed, src)) {
+        dashed.reset();
+        this->dashMeasured(&dashed, src);
+    }
+
+    {
+        SkAutoMutexAcquire ac(fCacheMutex);
+        fCachedDst = dashed;
+        fCachedGenerationID = genID;
+    }
+    if (dst->isEmpty()) {
+        dst->swap(dashed);
+    } else {
+        dst->addPath(dashed);
+    }
+    return true;
+}
+
+bool SkDashPathEffect::computeFastBoundsOutset(SkRect*) const {
+    // the dashes are pieces of the path
     return true;
 }
 
@@ -157,7 +394,8 @@ SkFlattenable* SkDashPathEffect::CreateProc(SkFlattenableReadBuffer& buffer) {
     return SkNEW_ARGS(SkDashPathEffect, (buffer));
 }
 
-SkDashPathEffect::SkDashPathEffect(SkFlattenableReadBuffer& buffer) {
+SkDashPathEffect::SkDashPathEffect(SkFlattenableReadBuffer& buffer)
+        : fCachedGenerationID(0) {
     fCount = buffer.readS32();
     fInitialDashIndex = buffer.readS32();
     fInitialDashLength = buffer.readScalar();
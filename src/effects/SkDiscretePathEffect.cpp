@@ -75,6 +75,12 @@ bool SkDiscretePathEffect::filterPath(SkPath* dst, const SkPath& src,
     return true;
 }
 
+bool SkDiscretePathEffect::computeFastBoundsOutset(SkRect* outset) const {
+    const SkScalar deviation = SkScalarAbs(fPerterb);
+    outset->inset(-deviation, -deviation);
+    return true;
+}
+
 SkFlattenable::Factory SkDiscretePathEffect::getFactory() {
     return CreateProc;
 }
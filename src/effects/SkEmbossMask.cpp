@@ -17,32 +17,6 @@
 
 #include "SkEmbossMask.h"
 
-static inline int nonzero_to_one(int x) {
-#if 0
-    return x != 0;
-#else
-    return ((unsigned)(x | -x)) >> 31;
-#endif
-}
-
-static inline int neq_to_one(int x, int max) {
-#if 0
-    return x != max;
-#else
-    SkASSERT(x >= 0 && x <= max);
-    return ((unsigned)(x - max)) >> 31;
-#endif
-}
-
-static inline int neq_to_mask(int x, int max) {
-#if 0
-    return -(x != max);
-#else
-    SkASSERT(x >= 0 && x <= max);
-    return (x - max) >> 31;
-#endif
-}
-
 static inline unsigned div255(unsigned x) {
     SkASSERT(x <= (255*255));
     return x * ((1 << 24) / 255) >> 24;
@@ -85,18 +59,76 @@ void SkEmbossMask_BuildTable() {
 
 #endif
 
+namespace {
+
+struct EmbossLight {
+    SkFixed         fX, fY;
+    SkFixed         fZDotNZ;
+    int             fZDot8;
+    int             fAmbient;
+    const uint8_t*  fSpecular;  // the additive value for each hilite
+};
+
+}
+
+static inline void light_pixel(const EmbossLight& light, int nx, int ny,
+                               uint8_t* multiply, uint8_t* additive) {
+    SkFixed numer = light.fX * nx + light.fY * ny + light.fZDotNZ;
+    int     mul = light.fAmbient;
+    int     add = 0;
+
+    if (numer > 0) {  // preflight when numer/denom will be <= 0
+        // can use full numer, but then we need to call SkFixedMul, since
+        // numer is 24 bits, and our table is 12 bits
+
+        // SkFixed dot = SkFixedMul(numer, gTable[]) >> 8
+        SkFixed dot = (unsigned)(numer >> 4) * gInvSqrtTable[(SkAbs32(nx) >> 1 << 7) | (SkAbs32(ny) >> 1)] >> 20;
+        mul = SkFastMin32(mul + dot, 255);
+
+        // now for the reflection
+
+        //  R = 2 (Light * Normal) Normal - Light
+        //  hilite = R * Eye(0, 0, 1)
+
+        int hilite = (2 * dot - light.fZDot8) * light.fZDot8 >> 8;
+        if (hilite > 0) {
+            // pin hilite to 255, since our fast math is also a little sloppy
+            add = light.fSpecular[SkClampMax(hilite, 255)];
+        }
+    }
+    *multiply = SkToU8(mul);
+    *additive = SkToU8(add);
+}
+
+/*  The edges of the mask use the pixel itself in place of the neighbor they
+    don't have, which we look after with the first and last columns (and the
+    rows above and below), so the columns in between can run without checks.
+ */
 void SkEmbossMask::Emboss(SkMask* mask, const SkEmbossMaskFilter::Light& light) {
     SkASSERT(kDelta == kDeltaUsedToBuildTable);
 
     SkASSERT(mask->fFormat == SkMask::k3D_Format);
 
-    int     specular = light.fSpecular;
-    int     ambient = light.fAmbient;
-    SkFixed lx = SkScalarToFixed(light.fDirection[0]);
-    SkFixed ly = SkScalarToFixed(light.fDirection[1]);
+    // specular is 4.4, but only its integer part is used: the hilite is
+    // raised to that power (more or less), which we look up instead of
+    // looping over it for each pixel
+    uint8_t specular[256];
+    for (int hilite = 0; hilite < 256; hilite++) {
+        int add = hilite;
+        for (int i = light.fSpecular >> 4; i > 0; --i) {
+            add = div255(add * hilite);
+        }
+        specular[hilite] = SkToU8(add);
+    }
+
+    EmbossLight l;
+    l.fX = SkScalarToFixed(light.fDirection[0]);
+    l.fY = SkScalarToFixed(light.fDirection[1]);
     SkFixed lz = SkScalarToFixed(light.fDirection[2]);
-    SkFixed lz_dot_nz = lz * kDelta;
-    int     lz_dot8 = lz >> 8;
+    l.fZDotNZ = lz * kDelta;
+    l.fZDot8 = lz >> 8;
+    l.fAmbient = light.fAmbient;
+    l.fSpecular = specular;
 
     size_t      planeSize = mask->computeImageSize();
     uint8_t*    alpha = mask->fImage;
@@ -107,66 +139,29 @@ void SkEmbossMask::Emboss(SkMask* mask, const SkEmbossMaskFilter::Light& light)
     int maxy = mask->fBounds.height() - 1;
     int maxx = mask->fBounds.width() - 1;
 
-    int prev_row = 0;
     for (int y = 0; y <= maxy; y++) {
-        int next_row = neq_to_mask(y, maxy) & rowBytes;
+        const uint8_t* above = y > 0 ? alpha - rowBytes : alpha;
+        const uint8_t* below = y < maxy ? alpha + rowBytes : alpha;
 
-        for (int x = 0; x <= maxx; x++) {
+        if (alpha[0]) {
+            int right = maxx > 0 ? alpha[1] : alpha[0];
+            light_pixel(l, right - alpha[0], below[0] - above[0],
+                        &multiply[0], &additive[0]);
+        }
+        for (int x = 1; x < maxx; x++) {
             if (alpha[x]) {
-                int nx = alpha[x + neq_to_one(x, maxx)] - alpha[x - nonzero_to_one(x)];
-                int ny = alpha[x + next_row] - alpha[x - prev_row];
-
-                SkFixed numer = lx * nx + ly * ny + lz_dot_nz;
-                int     mul = ambient;
-                int     add = 0;
-
-                if (numer > 0) {  // preflight when numer/denom will be <= 0
-#if 0
-                    int denom = SkSqrt32(nx * nx + ny * ny + kDelta*kDelta);
-                    SkFixed dot = numer / denom;
-                    dot >>= 8;  // now dot is 2^8 instead of 2^16
-#else
-                    // can use full numer, but then we need to call SkFixedMul, since
-                    // numer is 24 bits, and our table is 12 bits
-
-                    // SkFixed dot = SkFixedMul(numer, gTable[]) >> 8
-                    SkFixed dot = (unsigned)(numer >> 4) * gInvSqrtTable[(SkAbs32(nx) >> 1 << 7) | (SkAbs32(ny) >> 1)] >> 20;
-#endif
-                    mul = SkFastMin32(mul + dot, 255);
-
-                    // now for the reflection
-
-                    //  R = 2 (Light * Normal) Normal - Light
-                    //  hilite = R * Eye(0, 0, 1)
-
-                    int hilite = (2 * dot - lz_dot8) * lz_dot8 >> 8;
-                    if (hilite > 0) {
-                        // pin hilite to 255, since our fast math is also a little sloppy
-                        hilite = SkClampMax(hilite, 255);
-
-                        // specular is 4.4
-                        // would really like to compute the fractional part of this
-                        // and then possibly cache a 256 table for a given specular
-                        // value in the light, and just pass that in to this function.
-                        add = hilite;
-                        for (int i = specular >> 4; i > 0; --i) {
-                            add = div255(add * hilite);
-                        }
-                    }
-                }
-                multiply[x] = SkToU8(mul);
-                additive[x] = SkToU8(add);
-
-            //  multiply[x] = 0xFF;
-            //  additive[x] = 0;
-            //  ((uint8_t*)alpha)[x] = alpha[x] * multiply[x] >> 8;
+                light_pixel(l, alpha[x + 1] - alpha[x - 1],
+                            below[x] - above[x], &multiply[x], &additive[x]);
             }
         }
+        if (maxx > 0 && alpha[maxx]) {
+            light_pixel(l, alpha[maxx] - alpha[maxx - 1],
+                        below[maxx] - above[maxx],
+                        &multiply[maxx], &additive[maxx]);
+        }
+
         alpha += rowBytes;
         multiply += rowBytes;
         additive += rowBytes;
-        prev_row = rowBytes;
     }
 }
-
-
@@ -22,6 +22,7 @@
 #include "SkUtils.h"
 #include "SkTemplates.h"
 #include "SkBitmapCache.h"
+#include "SkPurgeableCache.h"
 
 #ifndef SK_DISABLE_DITHER_32BIT_GRADIENT
     #define USE_DITHER_32BIT_GRADIENT
@@ -77,6 +78,20 @@ static inline SkFixed mirror_tileproc(SkFixed x) {
     return (x ^ s) & 0xFFFF;
 }
 
+/*  Returns exactly SkFixedSqrt(n), the integer square root of n << 16, but
+    without SkSqrtBits' loop over every bit of the result. The 48-bit value is
+    exact as a double, and its correctly rounded root can never round up to
+    the next integer, so truncating it gives the same answer. We treat n as
+    unsigned, as SkSqrtBits does.
+ */
+static inline SkFixed fast_fixed_sqrt(SkFixed n) {
+#ifdef SK_SCALAR_IS_FLOAT
+    return (SkFixed)sqrt((double)(uint32_t)n * 65536.0);
+#else
+    return SkFixedSqrt(n);
+#endif
+}
+
 static const TileProc gTileProcs[] = {
     clamp_tileproc,
     repeat_tileproc,
@@ -174,10 +189,15 @@ private:
     mutable uint16_t*   fCache16;   // working ptr. If this is NULL, we need to recompute the cache values
     mutable SkPMColor*  fCache32;   // working ptr. If this is NULL, we need to recompute the cache values
 
-    mutable uint16_t*   fCache16Storage;    // storage for fCache16, allocated on demand
+    // storage for fCache16/fCache32. These may be shared with other shaders
+    // (see gTableCache), so their pixels are never changed once built.
+    mutable SkMallocPixelRef* fCache16PixelRef;
     mutable SkMallocPixelRef* fCache32PixelRef;
     unsigned    fCacheAlpha;        // the alpha value we used when we computed the cache. larger than 8bits so we can store uninitialized value
 
+    bool buildCacheKey(SkFlattenableWriteBuffer*, int bits,
+                       unsigned alpha) const;
+
     static void Build16bitCache(uint16_t[], SkColor c0, SkColor c1, int count);
     static void Build32bitCache(SkPMColor[], SkColor c0, SkColor c1, int count,
                                 U8CPU alpha);
@@ -209,8 +229,9 @@ Gradient_Shader::Gradient_Shader(const SkColor colors[], const SkScalar pos[],
     fTileMode = mode;
     fTileProc = gTileProcs[mode];
 
-    fCache16 = fCache16Storage = NULL;
+    fCache16 = NULL;
     fCache32 = NULL;
+    fCache16PixelRef = NULL;
     fCache32PixelRef = NULL;
 
     /*  Note: we let the caller skip the first and/or last position.
@@ -318,8 +339,9 @@ Gradient_Shader::Gradient_Shader(SkFlattenableReadBuffer& buffer) :
 
     fMapper = static_cast<SkUnitMapper*>(buffer.readFlattenable());
 
-    fCache16 = fCache16Storage = NULL;
+    fCache16 = NULL;
     fCache32 = NULL;
+    fCache16PixelRef = NULL;
     fCache32PixelRef = NULL;
 
     int colorCount = fColorCount = buffer.readU32();
@@ -347,9 +369,7 @@ Gradient_Shader::Gradient_Shader(SkFlattenableReadBuffer& buffer) :
 }
 
 Gradient_Shader::~Gradient_Shader() {
-    if (fCache16Storage) {
-        sk_free(fCache16Storage);
-    }
+    SkSafeUnref(fCache16PixelRef);
     SkSafeUnref(fCache32PixelRef);
     if (fOrigColors != fStorage) {
         sk_free(fOrigColors);
@@ -412,16 +432,16 @@ bool Gradient_Shader::setContext(const SkBitmap& device,
     }
 
     // if the new alpha differs from the previous time we were called, inval our cache
-    // this will trigger the cache to be rebuilt.
+    // this will trigger the cache to be rebuilt (or found in gTableCache).
     // we don't care about the first time, since the cache ptrs will already be NULL
+    // The 16bit cache ignores the alpha, so it stays valid.
     if (fCacheAlpha != paintAlpha) {
-        fCache16 = NULL;                // inval the cache
         fCache32 = NULL;                // inval the cache
         fCacheAlpha = paintAlpha;       // record the new alpha
-        // inform our subclasses
-        if (fCache32PixelRef) {
-            fCache32PixelRef->notifyPixelsChanged();
-        }
+        // the old table may be shared, so we drop it rather than rebuild it
+        // in place. The new one will have a new generation ID.
+        SkSafeUnref(fCache32PixelRef);
+        fCache32PixelRef = NULL;
     }
     return true;
 }
@@ -568,16 +588,129 @@ static inline U16CPU bitsTo16(unsigned x, const unsigned bits) {
     return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ *  Gradients with the same colors, positions, mapper (and alpha, for the 32bit
+ *  table) build identical tables, and callers often create many of them. So
+ *  built tables are kept in a small global cache, and shared by every shader
+ *  that asks for the same one. Each table costs 1K (16bit) or 2K (32bit).
+ */
+static const int MAX_NUM_CACHED_GRADIENT_TABLES = 64;
+
+static SkMutex          gTableMutex;
+static SkBitmapCache*   gTableCache;
+
+// returns the shared table (ref'd by the caller), or NULL
+static SkMallocPixelRef* find_shared_table(const SkFlattenableWriteBuffer& key) {
+    SkAutoSTMalloc<64, uint8_t> storage(key.size());
+    key.flatten(storage.get());
+
+    SkAutoMutexAcquire ama(gTableMutex);
+    SkBitmap bitmap;
+    if (NULL == gTableCache ||
+            !gTableCache->find(storage.get(), key.size(), &bitmap)) {
+        return NULL;
+    }
+    // only our own tables are ever added to gTableCache
+    SkMallocPixelRef* pr = static_cast<SkMallocPixelRef*>(bitmap.pixelRef());
+    pr->ref();
+    return pr;
+}
+
+static void add_shared_table(const SkFlattenableWriteBuffer& key,
+                             SkMallocPixelRef* pr, SkBitmap::Config config,
+                             int width) {
+    SkAutoSTMalloc<64, uint8_t> storage(key.size());
+    key.flatten(storage.get());
+
+    pr->setImmutable();
+    SkBitmap bitmap;
+    bitmap.setConfig(config, width, 1);
+    bitmap.setPixelRef(pr);
+
+    SkAutoMutexAcquire ama(gTableMutex);
+    if (NULL == gTableCache) {
+        gTableCache = new SkBitmapCache(MAX_NUM_CACHED_GRADIENT_TABLES);
+    }
+    // another thread may have beaten us to it, in which case we just keep
+    // our own copy
+    if (!gTableCache->find(storage.get(), key.size(), NULL)) {
+        gTableCache->add(storage.get(), key.size(), bitmap);
+    }
+}
+
+namespace {
+
+class TablePurgeableCache : public SkPurgeableCache {
+public:
+    TablePurgeableCache() : INHERITED("gradient tables", kCheap_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        SkAutoMutexAcquire ama(gTableMutex);
+        return gTableCache ? gTableCache->bytesUsed() : 0;
+    }
+    virtual void purgeTo(size_t bytes) {
+        SkAutoMutexAcquire ama(gTableMutex);
+        if (gTableCache) {
+            gTableCache->purgeTo(bytes);
+        }
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static TablePurgeableCache gPurgeableCache;
+
+/*
+ *  The key is [bits, alpha, count, colors[], {positions[]}, mapper]. Returns
+ *  false if the mapper can't be flattened, in which case the table is not
+ *  shared.
+ */
+bool Gradient_Shader::buildCacheKey(SkFlattenableWriteBuffer* key, int bits,
+                                    unsigned alpha) const {
+    if (fMapper && NULL == fMapper->getFactory()) {
+        return false;
+    }
+    key->write32(bits);
+    key->write32(alpha);
+    key->write32(fColorCount);
+    key->writeMul4(fOrigColors, fColorCount * sizeof(SkColor));
+    if (fColorCount > 2) {
+        for (int i = 1; i < fColorCount; i++) {
+            key->write32(fRecs[i].fPos);
+        }
+    }
+    key->writeFlattenable(fMapper);
+    return true;
+}
+
 const uint16_t* Gradient_Shader::getCache16() const {
     if (fCache16 == NULL) {
+        SkFlattenableWriteBuffer key(64);
+        // the 16bit table does not depend on the alpha
+        const bool sharable = this->buildCacheKey(&key, 16, 0);
+        if (sharable) {
+            SkSafeUnref(fCache16PixelRef);
+            fCache16PixelRef = find_shared_table(key);
+            if (fCache16PixelRef) {
+                fCache16 = (uint16_t*)fCache16PixelRef->getAddr();
+                return fCache16;
+            }
+        }
+
         // double the count for dither entries
         const int entryCount = kCache16Count * 2;
         const size_t allocSize = sizeof(uint16_t) * entryCount;
 
-        if (fCache16Storage == NULL) { // set the storage and our working ptr
-            fCache16Storage = (uint16_t*)sk_malloc_throw(allocSize);
+        if (NULL == fCache16PixelRef) {
+            fCache16PixelRef = SkNEW_ARGS(SkMallocPixelRef,
+                                          (NULL, allocSize, NULL));
         }
-        fCache16 = fCache16Storage;
+        fCache16 = (uint16_t*)fCache16PixelRef->getAddr();
         if (fColorCount == 2) {
             Build16bitCache(fCache16, fOrigColors[0], fOrigColors[1], kCache16Count);
         } else {
@@ -595,17 +728,24 @@ const uint16_t* Gradient_Shader::getCache16() const {
         }
 
         if (fMapper) {
-            fCache16Storage = (uint16_t*)sk_malloc_throw(allocSize);
+            SkMallocPixelRef* newPR = SkNEW_ARGS(SkMallocPixelRef,
+                                                 (NULL, allocSize, NULL));
             uint16_t* linear = fCache16;         // just computed linear data
-            uint16_t* mapped = fCache16Storage;  // storage for mapped data
+            uint16_t* mapped = (uint16_t*)newPR->getAddr();  // storage for mapped data
             SkUnitMapper* map = fMapper;
             for (int i = 0; i < kCache16Count; i++) {
                 int index = map->mapUnit16(bitsTo16(i, kCache16Bits)) >> kCache16Shift;
                 mapped[i] = linear[index];
                 mapped[i + kCache16Count] = linear[index + kCache16Count];
             }
-            sk_free(fCache16);
-            fCache16 = fCache16Storage;
+            fCache16PixelRef->unref();
+            fCache16PixelRef = newPR;
+            fCache16 = mapped;
+        }
+
+        if (sharable) {
+            add_shared_table(key, fCache16PixelRef, SkBitmap::kRGB_565_Config,
+                             entryCount);
         }
     }
     return fCache16;
@@ -613,6 +753,17 @@ const uint16_t* Gradient_Shader::getCache16() const {
 
 const SkPMColor* Gradient_Shader::getCache32() const {
     if (fCache32 == NULL) {
+        SkFlattenableWriteBuffer key(64);
+        const bool sharable = this->buildCacheKey(&key, 32, fCacheAlpha);
+        if (sharable) {
+            SkSafeUnref(fCache32PixelRef);
+            fCache32PixelRef = find_shared_table(key);
+            if (fCache32PixelRef) {
+                fCache32 = (SkPMColor*)fCache32PixelRef->getAddr();
+                return fCache32;
+            }
+        }
+
         // double the count for dither entries
         const int entryCount = kCache32Count * 2;
         const size_t allocSize = sizeof(SkPMColor) * entryCount;
@@ -654,7 +805,12 @@ const SkPMColor* Gradient_Shader::getCache32() const {
             }
             fCache32PixelRef->unref();
             fCache32PixelRef = newPR;
-            fCache32 = (SkPMColor*)newPR->getAddr();
+            fCache32 = mapped;
+        }
+
+        if (sharable) {
+            add_shared_table(key, fCache32PixelRef, SkBitmap::kARGB_8888_Config,
+                             entryCount);
         }
     }
     return fCache32;
@@ -664,60 +820,15 @@ const SkPMColor* Gradient_Shader::getCache32() const {
  *  Because our caller might rebuild the same (logically the same) gradient
  *  over and over, we'd like to return exactly the same "bitmap" if possible,
  *  allowing the client to utilize a cache of our bitmap (e.g. with a GPU).
- *  To do that, we maintain a private cache of built-bitmaps, based on our
- *  colors and positions. Note: we don't try to flatten the fMapper, so if one
- *  is present, we skip the cache for now.
+ *  getCache32() already shares its table between shaders with the same
+ *  colors, positions, alpha and mapper (see gTableCache), so we just wrap
+ *  that table, and its generation ID stays the same across those shaders.
  */
 void Gradient_Shader::commonAsABitmap(SkBitmap* bitmap) const {
-    // don't have a way to put the mapper into our cache-key yet
-    if (fMapper) {
-        // force our cahce32pixelref to be built
-        (void)this->getCache32();
-        bitmap->setConfig(SkBitmap::kARGB_8888_Config, kCache32Count, 1);
-        bitmap->setPixelRef(fCache32PixelRef);
-        return;
-    }
-
-    // build our key: [numColors + colors[] + {positions[]} ]
-    int count = 1 + fColorCount;
-    if (fColorCount > 2) {
-        count += fColorCount - 1;    // fRecs[].fPos
-    }
-
-    SkAutoSTMalloc<16, int32_t> storage(count);
-    int32_t* buffer = storage.get();
-
-    *buffer++ = fColorCount;
-    memcpy(buffer, fOrigColors, fColorCount * sizeof(SkColor));
-    buffer += fColorCount;
-    if (fColorCount > 2) {
-        for (int i = 1; i < fColorCount; i++) {
-            *buffer++ = fRecs[i].fPos;
-        }
-    }
-    SkASSERT(buffer - storage.get() == count);
-
-    ///////////////////////////////////
-
-    static SkMutex gMutex;
-    static SkBitmapCache* gCache;
-    // each cache cost 1K of RAM, since each bitmap will be 1x256 at 32bpp
-    static const int MAX_NUM_CACHED_GRADIENT_BITMAPS = 32;
-    SkAutoMutexAcquire ama(gMutex);
-
-    if (NULL == gCache) {
-        gCache = new SkBitmapCache(MAX_NUM_CACHED_GRADIENT_BITMAPS);
-    }
-    size_t size = count * sizeof(int32_t);
-
-    if (!gCache->find(storage.get(), size, bitmap)) {
-        // force our cahce32pixelref to be built
-        (void)this->getCache32();
-        bitmap->setConfig(SkBitmap::kARGB_8888_Config, kCache32Count, 1);
-        bitmap->setPixelRef(fCache32PixelRef);
-
-        gCache->add(storage.get(), size, *bitmap);
-    }
+    // force our cache32pixelref to be built (or found in gTableCache)
+    (void)this->getCache32();
+    bitmap->setConfig(SkBitmap::kARGB_8888_Config, kCache32Count, 1);
+    bitmap->setPixelRef(fCache32PixelRef);
 }
 
 void Gradient_Shader::commonAsAGradient(GradientInfo* info) const {
@@ -1215,7 +1326,7 @@ public:
                     SkFixed magnitudeSquared = SkFixedSquare(fx) + SkFixedSquare(fy);
                     if (magnitudeSquared < 0) // Overflow.
                         magnitudeSquared = SK_FixedMax;
-                    SkFixed dist = SkFixedSqrt(magnitudeSquared);
+                    SkFixed dist = fast_fixed_sqrt(magnitudeSquared);
                     unsigned fi = mirror_tileproc(dist);
                     SkASSERT(fi <= 0xFFFF);
                     *dstC++ = cache[fi >> (16 - kCache32Bits)];
@@ -1228,7 +1339,7 @@ public:
                     SkFixed magnitudeSquared = SkFixedSquare(fx) + SkFixedSquare(fy);
                     if (magnitudeSquared < 0) // Overflow.
                         magnitudeSquared = SK_FixedMax;
-                    SkFixed dist = SkFixedSqrt(magnitudeSquared);
+                    SkFixed dist = fast_fixed_sqrt(magnitudeSquared);
                     unsigned fi = repeat_tileproc(dist);
                     SkASSERT(fi <= 0xFFFF);
                     *dstC++ = cache[fi >> (16 - kCache32Bits)];
@@ -1313,7 +1424,7 @@ public:
                 }
             } else if (proc == mirror_tileproc) {
                 do {
-                    SkFixed dist = SkFixedSqrt(SkFixedSquare(fx) + SkFixedSquare(fy));
+                    SkFixed dist = fast_fixed_sqrt(SkFixedSquare(fx) + SkFixedSquare(fy));
                     unsigned fi = mirror_tileproc(dist);
                     SkASSERT(fi <= 0xFFFF);
                     fx += dx;
@@ -1324,7 +1435,7 @@ public:
             } else {
                 SkASSERT(proc == repeat_tileproc);
                 do {
-                    SkFixed dist = SkFixedSqrt(SkFixedSquare(fx) + SkFixedSquare(fy));
+                    SkFixed dist = fast_fixed_sqrt(SkFixedSquare(fx) + SkFixedSquare(fy));
                     unsigned fi = repeat_tileproc(dist);
                     SkASSERT(fi <= 0xFFFF);
                     fx += dx;
@@ -1,5 +1,10 @@
 #include "SkKernel33MaskFilter.h"
 #include "SkColorPriv.h"
+#include "SkTemplates.h"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 SkMask::Format SkKernel33ProcMaskFilter::getFormat() {
     return SkMask::kA8_Format;
@@ -30,42 +35,52 @@ bool SkKernel33ProcMaskFilter::filterMask(SkMask* dst, const SkMask& src,
     const uint8_t* srcImage = src.fImage;
     uint8_t* dstImage = dst->fImage;
 
-    uint8_t* srcRows[3];
-    uint8_t storage[3][3];
-    
-    srcRows[0] = storage[0];
-    srcRows[1] = storage[1];
-    srcRows[2] = storage[2];
+    // A copy of the src with two rows and columns of zeros all around, so
+    // that every dst pixel's window (which reaches one past the src) can be
+    // read without checking the bounds.
+    const int paddedRB = w + 4;
+    const size_t paddedSize = paddedRB * (h + 4);
+    SkAutoTMalloc<uint8_t> padded(paddedSize);
+    memset(padded.get(), 0, paddedSize);
+    for (int y = 0; y < h; y++) {
+        memcpy(padded.get() + (y + 2) * paddedRB + 2, srcImage + y * srcRB, w);
+    }
 
+    const int dw = dst->fBounds.width();
+    const int dh = dst->fBounds.height();
     unsigned scale = fPercent256;
-    
-    for (int y = -1; y <= h; y++) {
-        uint8_t* dstRow = dstImage;
-        for (int x = -1; x <= w; x++) {
-            memset(storage, 0, sizeof(storage));
-            uint8_t* storagePtr = &storage[0][0];
-
-            for (int ky = y - 1; ky <= y + 1; ky++) {
-                const uint8_t* srcRow = srcImage + ky * srcRB;  // may be out-of-range
-                for (int kx = x - 1; kx <= x + 1; kx++) {
-                    if ((unsigned)ky < (unsigned)h && (unsigned)kx < (unsigned)w) {
-                        *storagePtr = srcRow[kx];
-                    }
-                    storagePtr++;
-                }
-            }            
-            int value = this->computeValue(srcRows);
-            
-            if (scale < 256) {
-                value = SkAlphaBlend(value, srcRows[1][1], scale);
+
+    for (int y = 0; y < dh; y++) {
+        uint8_t* rows[3];
+        rows[0] = padded.get() + y * paddedRB;
+        rows[1] = rows[0] + paddedRB;
+        rows[2] = rows[1] + paddedRB;
+
+        this->computeRow(rows, dw, dstImage);
+
+        if (scale < 256) {
+            const uint8_t* center = rows[1] + 1;
+            for (int x = 0; x < dw; x++) {
+                dstImage[x] = SkToU8(SkAlphaBlend(dstImage[x], center[x],
+                                                  scale));
             }
-            *dstRow++ = SkToU8(value);
         }
         dstImage += dst->fRowBytes;
     }
     return true;
 }
 
+void SkKernel33ProcMaskFilter::computeRow(uint8_t* const rows[3], int count,
+                                          uint8_t dst[]) {
+    uint8_t* srcRows[3];
+    for (int x = 0; x < count; x++) {
+        srcRows[0] = rows[0] + x;
+        srcRows[1] = rows[1] + x;
+        srcRows[2] = rows[2] + x;
+        dst[x] = this->computeValue(srcRows);
+    }
+}
+
 void SkKernel33ProcMaskFilter::flatten(SkFlattenableWriteBuffer& wb) {
     this->INHERITED::flatten(wb);
     wb.write32(fPercent256);
@@ -97,6 +112,73 @@ uint8_t SkKernel33MaskFilter::computeValue(uint8_t* const* srcRows) {
     return (uint8_t)value;
 }
 
+#if defined(__SSE2__)
+// pairs the coefficients up as 16 bit values, for _mm_madd_epi16
+static bool pack_kernel(const int kernel[3][3], __m128i pairs[5]) {
+    const int* k = &kernel[0][0];
+    for (int i = 0; i < 9; i++) {
+        if (k[i] != (int16_t)k[i]) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        pairs[i] = _mm_set1_epi32((int)(((uint32_t)k[2 * i + 1] << 16) |
+                                        (k[2 * i] & 0xFFFF)));
+    }
+    pairs[4] = _mm_set1_epi32(k[8] & 0xFFFF);
+    return true;
+}
+#endif
+
+/*  With SSE2, 8 values at a time: the 9 taps are madd'ed in pairs with their
+    coefficients, which (with 16 bit coefficients) sums them exactly in 32
+    bits, and then the saturating packs pin them to 0..255.
+ */
+void SkKernel33MaskFilter::computeRow(uint8_t* const rows[3], int count,
+                                      uint8_t dst[]) {
+    int x = 0;
+#if defined(__SSE2__)
+    __m128i pairs[5];
+    if (pack_kernel(fKernel, pairs)) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i shift = _mm_cvtsi32_si128(fShift);
+        for (; x + 8 <= count; x += 8) {
+            __m128i taps[10];
+            for (int i = 0; i < 9; i++) {
+                const uint8_t* tap = rows[i / 3] + x + i % 3;
+                taps[i] = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tap)),
+                    zero);
+            }
+            taps[9] = zero;
+
+            __m128i lo = zero;
+            __m128i hi = zero;
+            for (int i = 0; i < 5; i++) {
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(
+                        _mm_unpacklo_epi16(taps[2 * i], taps[2 * i + 1]),
+                        pairs[i]));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(
+                        _mm_unpackhi_epi16(taps[2 * i], taps[2 * i + 1]),
+                        pairs[i]));
+            }
+            lo = _mm_sra_epi32(lo, shift);
+            hi = _mm_sra_epi32(hi, shift);
+            __m128i bytes = _mm_packs_epi32(lo, hi);
+            bytes = _mm_packus_epi16(bytes, bytes);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), bytes);
+        }
+    }
+#endif
+    uint8_t* srcRows[3];
+    for (; x < count; x++) {
+        srcRows[0] = rows[0] + x;
+        srcRows[1] = rows[1] + x;
+        srcRows[2] = rows[2] + x;
+        dst[x] = this->SkKernel33MaskFilter::computeValue(srcRows);
+    }
+}
+
 void SkKernel33MaskFilter::flatten(SkFlattenableWriteBuffer& wb) {
     this->INHERITED::flatten(wb);
     wb.writeMul4(fKernel, 9 * sizeof(int));
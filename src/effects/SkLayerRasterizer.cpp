@@ -23,6 +23,7 @@
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkRegion.h"
+#include "SkTemplates.h"
 #include "SkXfermode.h"
 #include <new>
 
@@ -51,7 +52,86 @@ void SkLayerRasterizer::addLayer(const SkPaint& paint, SkScalar dx,
     rec->fOffset.set(dx, dy);
 }
 
+namespace {
+
+/*  The path that a layer's paint makes from the src (stroked, or through its
+    path effect), which is made once for all of the layers that would make
+    the same one.
+ */
+struct LayerFill {
+    const SkPaint*  fPaint;     // the first layer's
+    SkPath          fPath;
+    bool            fDoFill;    // false if fPath should be hairlined
+};
+
+}  // namespace
+
+// Would the two paints make the same path from the src?
+static bool same_fill(const SkPaint& a, const SkPaint& b) {
+    if (a.getStyle() != b.getStyle() || a.getPathEffect() != b.getPathEffect()) {
+        return false;
+    }
+    return SkPaint::kFill_Style == a.getStyle() ||
+           (a.getStrokeWidth() == b.getStrokeWidth() &&
+            a.getStrokeMiter() == b.getStrokeMiter() &&
+            a.getStrokeCap() == b.getStrokeCap() &&
+            a.getStrokeJoin() == b.getStrokeJoin());
+}
+
+static bool needs_fill_path(const SkPaint& paint) {
+    return paint.getPathEffect() || paint.getStyle() != SkPaint::kFill_Style;
+}
+
+/*  Can the layer be drawn by filling its fill path, instead of handing the src
+    to SkDraw::drawPath() with its paint? Not if SkDraw would draw the stroke
+    some other way, which it does for antialiased strokes up to a couple of
+    pixels wide (once they've been through the matrix).
+ */
+static bool can_fill_instead(const SkPaint& paint, const SkMatrix& matrix) {
+    if (SkPaint::kStroke_Style != paint.getStyle() || !paint.isAntiAlias() ||
+            matrix.hasPerspective()) {
+        return true;
+    }
+    SkVector v;
+    v.set(paint.getStrokeWidth(), 0);
+    matrix.mapVectors(&v, 1);
+    return v.length() > SkIntToScalar(3);
+}
+
+/*  Finds (or makes) every layer's fill path, so that they're only made once,
+    for both the bounds and the drawing.
+ */
+static void make_fills(const SkDeque& layers, const SkPath& path,
+                       LayerFill fills[], int* fillCount,
+                       const LayerFill* layerFills[]) {
+    SkDeque::F2BIter        iter(layers);
+    SkLayerRasterizer_Rec*  rec;
+    int                     count = 0;
+
+    for (int i = 0; (rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL; i++) {
+        const SkPaint& paint = rec->fPaint;
+        layerFills[i] = NULL;
+        if (!needs_fill_path(paint)) {
+            continue;
+        }
+        for (int j = 0; j < count; j++) {
+            if (same_fill(*fills[j].fPaint, paint)) {
+                layerFills[i] = &fills[j];
+                break;
+            }
+        }
+        if (NULL == layerFills[i]) {
+            LayerFill* fill = &fills[count++];
+            fill->fPaint = &paint;
+            fill->fDoFill = paint.getFillPath(path, &fill->fPath);
+            layerFills[i] = fill;
+        }
+    }
+    *fillCount = count;
+}
+
 static bool compute_bounds(const SkDeque& layers, const SkPath& path,
+                           const LayerFill* const layerFills[],
                            const SkMatrix& matrix,
                            const SkIRect* clipBounds, SkIRect* bounds) {
     SkDeque::F2BIter        iter(layers);
@@ -59,15 +139,11 @@ static bool compute_bounds(const SkDeque& layers, const SkPath& path,
 
     bounds->set(SK_MaxS32, SK_MaxS32, SK_MinS32, SK_MinS32);
 
-    while ((rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL) {
+    for (int i = 0; (rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL; i++) {
         const SkPaint&  paint = rec->fPaint;
-        SkPath          fillPath, devPath;
-        const SkPath*   p = &path;
+        SkPath          devPath;
+        const SkPath*   p = layerFills[i] ? &layerFills[i]->fPath : &path;
 
-        if (paint.getPathEffect() || paint.getStyle() != SkPaint::kFill_Style) {
-            paint.getFillPath(path, &fillPath);
-            p = &fillPath;
-        }
         if (p->isEmpty()) {
             continue;
         }
@@ -91,15 +167,152 @@ static bool compute_bounds(const SkDeque& layers, const SkPath& path,
     return true;
 }
 
+/*  Layers that fill the same path, through matrices that only differ by whole
+    pixels, only differ in how their paints put the same coverage into the
+    mask. So the first one's coverage is drawn once, and each of them blits it
+    (which can round a little differently than blitting the path's spans).
+ */
+namespace {
+
+struct LayerDraw {
+    SkMatrix        fMatrix;
+    const SkPath*   fPath;      // path to fill (or NULL) if it can share
+    bool            fAntiAlias;
+    int             fLeader;    // the layer whose coverage it uses
+    int             fShareCount;    // how many use this one's coverage
+    SkIPoint        fOffset;    // from the leader's coverage, in pixels
+};
+
+}  // namespace
+
+static bool same_but_whole_pixels(const SkMatrix& a, const SkMatrix& b,
+                                  SkIPoint* offset) {
+    if (a[SkMatrix::kMScaleX] != b[SkMatrix::kMScaleX] ||
+            a[SkMatrix::kMSkewX] != b[SkMatrix::kMSkewX] ||
+            a[SkMatrix::kMSkewY] != b[SkMatrix::kMSkewY] ||
+            a[SkMatrix::kMScaleY] != b[SkMatrix::kMScaleY]) {
+        return false;
+    }
+    SkScalar dx = b.getTranslateX() - a.getTranslateX();
+    SkScalar dy = b.getTranslateY() - a.getTranslateY();
+    offset->set(SkScalarRound(dx), SkScalarRound(dy));
+    return SkIntToScalar(offset->fX) == dx && SkIntToScalar(offset->fY) == dy;
+}
+
+static void plan_layers(const SkDeque& layers, const SkPath& path,
+                        const LayerFill* const layerFills[],
+                        const SkMatrix& matrix, LayerDraw draws[]) {
+    SkDeque::F2BIter        iter(layers);
+    SkLayerRasterizer_Rec*  rec;
+
+    for (int i = 0; (rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL; i++) {
+        const SkPaint& paint = rec->fPaint;
+        LayerDraw& draw = draws[i];
+        draw.fMatrix = matrix;
+        draw.fMatrix.preTranslate(rec->fOffset.fX, rec->fOffset.fY);
+        draw.fLeader = i;
+        draw.fShareCount = 0;
+        draw.fOffset.set(0, 0);
+        draw.fAntiAlias = paint.isAntiAlias();
+
+        const LayerFill* fill = layerFills[i];
+        draw.fPath = NULL;
+        if (NULL == fill) {
+            draw.fPath = &path;
+        } else if (fill->fDoFill && can_fill_instead(paint, draw.fMatrix)) {
+            draw.fPath = &fill->fPath;
+        }
+        if (NULL == draw.fPath || draw.fPath->isInverseFillType() ||
+                paint.getMaskFilter() || paint.getRasterizer() ||
+                matrix.hasPerspective()) {
+            draw.fPath = NULL;
+            continue;
+        }
+
+        for (int j = 0; j < i; j++) {
+            const LayerDraw& other = draws[j];
+            if (other.fLeader == j && other.fPath == draw.fPath &&
+                    other.fAntiAlias == draw.fAntiAlias &&
+                    same_but_whole_pixels(other.fMatrix, draw.fMatrix,
+                                          &draw.fOffset)) {
+                draw.fLeader = j;
+                draws[j].fShareCount += 1;
+                break;
+            }
+        }
+    }
+}
+
+/*  Draws the leader's coverage, over as much of its path's bounds as any of
+    the layers that use it can blit into the mask (whose pixels are clip), and
+    returns where it goes in the leader's device space. The bitmap is left
+    without pixels if there's nothing to draw.
+ */
+static SkIPoint draw_coverage(const LayerDraw draws[], int count, int leader,
+                              const SkRegion& clip, SkExecutor* executor,
+                              SkBitmap* coverage) {
+    const LayerDraw& layer = draws[leader];
+    SkIRect needed;
+    needed.setEmpty();
+    for (int i = leader; i < count; i++) {
+        if (draws[i].fLeader == leader) {
+            SkIRect r = clip.getBounds();
+            r.offset(-draws[i].fOffset.fX, -draws[i].fOffset.fY);
+            needed.join(r);
+        }
+    }
+
+    SkRect bounds;
+    layer.fMatrix.mapRect(&bounds, layer.fPath->getBounds());
+    SkIRect ir;
+    bounds.roundOut(&ir);
+    ir.inset(-1, -1);
+    SkIPoint origin;
+    origin.set(ir.fLeft, ir.fTop);
+    if (!ir.intersect(needed)) {
+        return origin;
+    }
+    origin.set(ir.fLeft, ir.fTop);
+
+    coverage->setConfig(SkBitmap::kA8_Config, ir.width(), ir.height());
+    coverage->allocPixels();
+    memset(coverage->getPixels(), 0, coverage->getSize());
+
+    SkRegion rectClip;
+    rectClip.setRect(0, 0, ir.width(), ir.height());
+    SkMatrix matrix = layer.fMatrix;
+    matrix.postTranslate(-SkIntToScalar(ir.fLeft), -SkIntToScalar(ir.fTop));
+
+    SkDraw draw;
+    draw.fBitmap    = coverage;
+    draw.fMatrix    = &matrix;
+    draw.fClip      = &rectClip;
+    draw.fBounder   = NULL;
+    draw.fExecutor  = executor;
+
+    SkPaint paint;
+    paint.setAntiAlias(layer.fAntiAlias);
+    draw.drawPath(*layer.fPath, paint);
+    return origin;
+}
+
 bool SkLayerRasterizer::onRasterize(const SkPath& path, const SkMatrix& matrix,
                                     const SkIRect* clipBounds,
-                                    SkMask* mask, SkMask::CreateMode mode) {
+                                    SkMask* mask, SkMask::CreateMode mode,
+                                    SkExecutor* executor) {
     if (fLayers.empty()) {
         return false;
     }
 
+    const int layerCount = fLayers.count();
+    SkAutoTArray<LayerFill> fills(layerCount);
+    SkAutoTMalloc<const LayerFill*> layerFills(layerCount);
+    int fillCount;
+    make_fills(fLayers, path, fills.get(), &fillCount, layerFills.get());
+
     if (SkMask::kJustRenderImage_CreateMode != mode) {
-        if (!compute_bounds(fLayers, path, matrix, clipBounds, &mask->fBounds))
+        if (!compute_bounds(fLayers, path, layerFills.get(), matrix,
+                            clipBounds, &mask->fBounds))
             return false;
     }
 
@@ -135,14 +348,49 @@ bool SkLayerRasterizer::onRasterize(const SkPath& path, const SkMatrix& matrix,
         draw.fClip      = &rectClip;
         // we set the matrixproc in the loop, as the matrix changes each time (potentially)
         draw.fBounder   = NULL;
+        // so that big layers are filled in bands
+        draw.fExecutor  = executor;
+
+        SkAutoTMalloc<LayerDraw> draws(layerCount);
+        plan_layers(fLayers, path, layerFills.get(), translatedMatrix,
+                    draws.get());
+        SkAutoTArray<SkBitmap> coverage(layerCount);
+        SkAutoTMalloc<SkIPoint> coverageOrigin(layerCount);
 
         SkDeque::F2BIter        iter(fLayers);
         SkLayerRasterizer_Rec*  rec;
 
-        while ((rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL) {
-            drawMatrix = translatedMatrix;
-            drawMatrix.preTranslate(rec->fOffset.fX, rec->fOffset.fY);
-            draw.drawPath(path, rec->fPaint);
+        for (int i = 0; (rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL; i++) {
+            const LayerDraw& layer = draws.get()[i];
+            if (layer.fLeader != i || layer.fShareCount > 0) {
+                const int leader = layer.fLeader;
+                if (leader == i) {
+                    coverageOrigin.get()[i] = draw_coverage(draws.get(),
+                                                    layerCount, i, rectClip,
+                                                    executor, &coverage[i]);
+                }
+                if (coverage[leader].getPixels()) {
+                    const SkIPoint& origin = coverageOrigin.get()[leader];
+                    drawMatrix.setTranslate(
+                            SkIntToScalar(origin.fX + layer.fOffset.fX),
+                            SkIntToScalar(origin.fY + layer.fOffset.fY));
+                    draw.drawBitmap(coverage[leader], SkMatrix::I(),
+                                    rec->fPaint);
+                }
+                continue;
+            }
+
+            drawMatrix = layer.fMatrix;
+            const LayerFill* fill = layerFills.get()[i];
+            if (fill && fill->fDoFill &&
+                    can_fill_instead(rec->fPaint, drawMatrix)) {
+                SkPaint paint(rec->fPaint);
+                paint.setStyle(SkPaint::kFill_Style);
+                paint.setPathEffect(NULL);
+                draw.drawPath(fill->fPath, paint);
+            } else {
+                draw.drawPath(path, rec->fPaint);
+            }
         }
     }
     return true;
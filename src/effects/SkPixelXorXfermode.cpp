@@ -25,6 +25,34 @@ SkPMColor SkPixelXorXfermode::xferColor(SkPMColor src, SkPMColor dst) {
     return res;
 }
 
+// looked up once; threads racing to look it up all find the same proc
+static SkPixelXorXfermode::Proc32 get_proc32() {
+    static bool gChecked;
+    static SkPixelXorXfermode::Proc32 gProc;
+    if (!gChecked) {
+        gProc = SkPixelXorXfermode::PlatformProc32();
+        gChecked = true;
+    }
+    return gProc;
+}
+
+void SkPixelXorXfermode::xfer32(SkPMColor dst[], const SkPMColor src[],
+                                int count, const SkAlpha aa[]) {
+    if (NULL != aa) {
+        this->INHERITED::xfer32(dst, src, count, aa);
+        return;
+    }
+
+    int i = 0;
+    Proc32 proc = get_proc32();
+    if (NULL != proc) {
+        i = proc(fOpColor, dst, src, count);
+    }
+    for (; i < count; i++) {
+        dst[i] = this->xferColor(src[i], dst[i]);
+    }
+}
+
 void SkPixelXorXfermode::flatten(SkFlattenableWriteBuffer& wb) {
     this->INHERITED::flatten(wb);
     wb.write32(fOpColor);
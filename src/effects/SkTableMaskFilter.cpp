@@ -15,6 +15,7 @@
  */
 
 #include "SkTableMaskFilter.h"
+#include "SkUtils.h"
 
 SkTableMaskFilter::SkTableMaskFilter() {
     for (int i = 0; i < 256; i++) {
@@ -53,9 +54,7 @@ bool SkTableMaskFilter::filterMask(SkMask* dst, const SkMask& src,
         int extraZeros = dst->fRowBytes - dstWidth;
         
         for (int y = dst->fBounds.height() - 1; y >= 0; --y) {
-            for (int x = dstWidth - 1; x >= 0; --x) {
-                dstP[x] = table[srcP[x]];
-            }
+            sk_table8(dstP, srcP, dstWidth, table);
             srcP += src.fRowBytes;
             // we can't just inc dstP by rowbytes, because if it has any
             // padding between its width and its rowbytes, we need to zero those
@@ -163,6 +163,7 @@ void SkGpuDevice::initFromRenderTarget(GrContext* context,
     
     fCache = NULL;
     fTexture = NULL;
+    fScratchTexture = false;
     fRenderTarget = NULL;
     fNeedClear = false;
     
@@ -194,6 +195,7 @@ SkGpuDevice::SkGpuDevice(GrContext* context, SkBitmap::Config config, int width,
 
     fCache = NULL;
     fTexture = NULL;
+    fScratchTexture = false;
     fRenderTarget = NULL;
     fNeedClear = false;
 
@@ -217,15 +219,35 @@ SkGpuDevice::SkGpuDevice(GrContext* context, SkBitmap::Config config, int width,
         fTexture->ref();
     }
 #else
-    const GrTextureDesc desc = {
+    // Where the GPU has multisampled FBOs this is an MSAA render target, so
+    // antialiased paths are drawn into it directly rather than through
+    // GrContext's offscreen supersampling passes; it is resolved when read.
+    GrTextureDesc desc = {
         kRenderTarget_GrTextureFlagBit,
         kHigh_GrAALevel,
         width,
         height,
         SkGr::Bitmap2PixelConfig(bm)
     };
-    if (fContext->getGpu()->renderTargetCount() < fContext->getGpu()->maxRenderTargetCount())
-        fTexture = fContext->createUncachedTexture(desc, NULL, 0);
+    if (fContext->getGpu()->renderTargetCount() < fContext->getGpu()->maxRenderTargetCount()) {
+        // some drivers refuse multisampled FBOs of some sizes or formats,
+        // which mustn't send us on-screen, so then retry without MSAA
+        for (;;) {
+            if (kSaveLayer_Usage == usage) {
+                // layers come and go, often with slowly changing sizes.
+                // drawDevice copes with the layer not filling the pooled
+                // texture.
+                fTexture = fContext->lockScratchRenderTarget(desc);
+                fScratchTexture = NULL != fTexture;
+            } else {
+                fTexture = fContext->createUncachedTexture(desc, NULL, 0);
+            }
+            if (NULL != fTexture || kNone_GrAALevel == desc.fAALevel) {
+                break;
+            }
+            desc.fAALevel = kNone_GrAALevel;
+        }
+    }
 #endif
     if (NULL != fTexture) {
         fRenderTarget = fTexture->asRenderTarget();
@@ -259,7 +281,11 @@ SkGpuDevice::~SkGpuDevice() {
         delete fDrawProcs;
     }
 
-    SkSafeUnref(fTexture);
+    if (fScratchTexture) {
+        fContext->unlockScratchRenderTarget(fTexture);
+    } else {
+        SkSafeUnref(fTexture);
+    }
     SkSafeUnref(fRenderTarget);
     if (fCache) {
         GrAssert(NULL != fTexture);
@@ -513,6 +539,13 @@ bool SkGpuDevice::skPaint2GrPaintShader(const SkPaint& skPaint,
         SkDebugf("shader->asABitmap() == kNone_BitmapType\n");
         return false;
     }
+    if (GrSamplerState::kNormal_SampleMode != sampleMode &&
+        !fContext->supportsGradients()) {
+        // the gradient is evaluated in the fragment shader, without one we
+        // draw it in software rather than dropping it
+        grPaint->fFallback = true;
+        return false;
+    }
     GrSamplerState* sampler = grPaint->getTextureSampler(kShaderTextureIdx);
     sampler->setSampleMode(sampleMode);
     if (skPaint.isFilterBitmap()) {
@@ -845,6 +878,229 @@ void SkGpuDevice::drawRect(const SkDraw& draw, const SkRect& rect,
 
 #include "SkMaskFilter.h"
 #include "SkBounder.h"
+#include "SkFlattenable.h"
+#include "SkWriter32.h"
+
+// Draws grp through the mask texture (whose top left is at devBounds' when
+// drawn) over devBounds, in device space.
+static void draw_with_mask(GrContext* context, GrPaint* grp,
+                           GrTexture* mask, const SkIRect& devBounds) {
+    // used to compute inverse view, if necessary
+    GrMatrix ivm = context->getMatrix();
+
+    GrAutoMatrix avm(context, GrMatrix::I());
+
+    if (grp->hasTextureOrMask() && ivm.invert(&ivm)) {
+        grp->preConcatActiveSamplerMatrices(ivm);
+    }
+
+    static const int MASK_IDX = GrPaint::kMaxMasks - 1;
+    // we assume the last mask index is available for use
+    GrAssert(NULL == grp->getMask(MASK_IDX));
+    grp->setMask(MASK_IDX, mask);
+    grp->getMaskSampler(MASK_IDX)->setClampNoFilter();
+
+    GrRect d;
+    d.setLTRB(GrIntToScalar(devBounds.fLeft),
+              GrIntToScalar(devBounds.fTop),
+              GrIntToScalar(devBounds.fRight),
+              GrIntToScalar(devBounds.fBottom));
+
+    GrMatrix m;
+    m.setTranslate(-devBounds.fLeft, -devBounds.fTop);
+    m.postIDiv(mask->width(), mask->height());
+    grp->getMaskSampler(MASK_IDX)->setMatrix(m);
+
+    context->drawRect(*grp, d);
+}
+
+// Blurs are done on the GPU as a Gaussian with the variance of the box blur
+// passes SkBlurMask would make. Above this sigma the coverage is downsampled
+// first, which keeps the kernel within GrSamplerState::kMaxKernelWidth.
+#define MAX_BLUR_SIGMA  4.0f
+
+/**
+ * If filter is a normal blur that the context can do on the GPU, returns true
+ * and sets sigma to the deviation of its Gaussian in device space.
+ */
+static bool gpu_blur_sigma(GrContext* context, SkMaskFilter* filter,
+                           const SkPath& path, const SkMatrix& matrix,
+                           float* sigma) {
+    SkMaskFilter::BlurInfo info;
+    if (!context->supportsConvolution() ||
+        SkMaskFilter::kNormal_BlurType != filter->asABlur(&info) ||
+        path.isInverseFillType()) {
+        return false;
+    }
+    SkScalar radius = info.fRadius;
+    if (!info.fIgnoreTransform) {
+        radius = matrix.mapRadius(radius);
+    }
+    // the same limit as SkBlurMaskFilter's
+    radius = SkMinScalar(radius, SkIntToScalar(128));
+    if (radius <= 0) {
+        return false;
+    }
+    // SkBlurMask uses a single pass for small radii
+    int passCount = (info.fHighQuality && radius >= SkIntToScalar(3)) ? 3 : 1;
+    float passRadius = SkScalarToFloat(radius) / sqrtf((float)passCount);
+    // a box of radius r has a variance of r(r+1)/3
+    *sigma = sqrtf(passCount * passRadius * (passRadius + 1) / 3);
+    return true;
+}
+
+// Draws src stretched by scale over dst, replacing what was there.
+static void draw_scaled(GrContext* context, GrTexture* src, const GrRect& dst,
+                        float scale) {
+    GrPaint paint;
+    paint.reset();
+    paint.fSrcBlendCoeff = kOne_BlendCoeff;
+    paint.fDstBlendCoeff = kZero_BlendCoeff;
+    paint.setTexture(0, src);
+    GrSamplerState* sampler = paint.getTextureSampler(0);
+    sampler->setFilter(GrSamplerState::kBilinear_Filter);
+    GrMatrix sampleM;
+    sampleM.setScale(GR_Scalar1 / (scale * src->width()),
+                     GR_Scalar1 / (scale * src->height()));
+    sampler->setMatrix(sampleM);
+    context->drawRect(paint, dst);
+}
+
+/**
+ * Blurs the coverage of a path into a render target on the GPU. The path is
+ * drawn into a scratch target and halved with bilinear draws until the
+ * blur's sigma is small enough, convolved in x and then y, and stretched
+ * back up into the destination.
+ */
+class GpuBlur {
+public:
+    /**
+     * The blurred mask is width x height and is blurred by sigma.
+     */
+    GpuBlur(GrContext* context, int width, int height, float sigma)
+            : fContext(context), fWidth(width), fHeight(height) {
+        fScale = 1;
+        while (sigma > MAX_BLUR_SIGMA) {
+            fScale *= 2;
+            sigma *= 0.5f;
+        }
+        int radius = SkMin32((int)ceilf(3 * sigma),
+                             GrSamplerState::kMaxKernelWidth / 2);
+        fKernelWidth = 2 * radius + 1;
+        float sum = 0;
+        for (int i = 0; i < fKernelWidth; ++i) {
+            float x = (float)(i - radius);
+            fKernel[i] = expf(-x * x / (2 * sigma * sigma));
+            sum += fKernel[i];
+        }
+        for (int i = 0; i < fKernelWidth; ++i) {
+            fKernel[i] /= sum;
+        }
+
+        // the first has a stencil for drawing the path into
+        GrTextureDesc desc = {
+            kRenderTarget_GrTextureFlagBit,
+            kNone_GrAALevel,
+            width,
+            height,
+            kRGBA_8888_GrPixelConfig
+        };
+        fTmp[0] = context->lockScratchRenderTarget(desc);
+        desc.fFlags = desc.fFlags | kNoStencil_GrTextureFlagBit;
+        fTmp[1] = fTmp[0] ? context->lockScratchRenderTarget(desc) : NULL;
+    }
+
+    ~GpuBlur() {
+        for (int i = 0; i < 2; ++i) {
+            if (NULL != fTmp[i]) {
+                fContext->unlockScratchRenderTarget(fTmp[i]);
+            }
+        }
+    }
+
+    /**
+     * Returns false if the scratch targets couldn't be found.
+     */
+    bool valid() const { return NULL != fTmp[1]; }
+
+    /**
+     * Draws the blurred coverage of path, which is in the mask's coordinates,
+     * into the top left of dst. The context's render target, matrix and clip
+     * are left as they were.
+     */
+    void draw(const SkPath& path, GrPathFill fill, GrTexture* dst) {
+        GrAssert(this->valid());
+        GrContext* context = fContext;
+
+        GrContext::AutoRenderTarget art(context, fTmp[0]->asRenderTarget());
+        GrAutoMatrix avm(context, GrMatrix::I());
+        GrClip savedClip(context->getClip());
+        context->setClip(GrIRect::MakeWH(fTmp[0]->width(),
+                                         fTmp[0]->height()));
+
+        // the texels around what is drawn are read by the passes, so the
+        // targets are cleared before each of them
+        int curr = 0;
+        context->setRenderTarget(fTmp[curr]->asRenderTarget());
+        context->clear(NULL, 0x0);
+        GrPaint paint;
+        paint.reset();
+        paint.fAntiAlias = true;
+        context->drawPath(paint, path, fill);
+
+        int w = fWidth;
+        int h = fHeight;
+        for (int scale = 1; scale < fScale; scale *= 2) {
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+            context->setRenderTarget(fTmp[1 - curr]->asRenderTarget());
+            context->clear(NULL, 0x0);
+            draw_scaled(context, fTmp[curr],
+                        GrRect::MakeWH(GrIntToScalar(w), GrIntToScalar(h)),
+                        0.5f);
+            curr = 1 - curr;
+        }
+
+        GrRect rect = GrRect::MakeWH(GrIntToScalar(w), GrIntToScalar(h));
+        context->setRenderTarget(fTmp[1 - curr]->asRenderTarget());
+        context->clear(NULL, 0x0);
+        context->convolveInX(fTmp[curr], rect, fKernel, fKernelWidth);
+        curr = 1 - curr;
+
+        if (1 == fScale) {
+            context->setRenderTarget(dst->asRenderTarget());
+            context->clear(NULL, 0x0);
+            context->convolveInY(fTmp[curr], rect, fKernel, fKernelWidth);
+        } else {
+            context->setRenderTarget(fTmp[1 - curr]->asRenderTarget());
+            context->clear(NULL, 0x0);
+            context->convolveInY(fTmp[curr], rect, fKernel, fKernelWidth);
+            curr = 1 - curr;
+
+            context->setRenderTarget(dst->asRenderTarget());
+            context->clear(NULL, 0x0);
+            draw_scaled(context, fTmp[curr],
+                        GrRect::MakeWH(GrIntToScalar(fWidth),
+                                       GrIntToScalar(fHeight)),
+                        (float)fScale);
+        }
+        context->setClip(savedClip);
+    }
+
+private:
+    GrContext*  fContext;
+    int         fWidth;
+    int         fHeight;
+    int         fScale;     // of the mask over the blurred coverage
+    int         fKernelWidth;
+    float       fKernel[GrSamplerState::kMaxKernelWidth];
+    GrTexture*  fTmp[2];
+};
+
+static GrPathFill gpu_blur_fill(const SkPath& path) {
+    return SkPath::kEvenOdd_FillType == path.getFillType() ?
+                kEvenOdd_PathFill : kWinding_PathFill;
+}
 
 static bool drawWithMaskFilter(GrContext* context, const SkPath& path,
                                SkMaskFilter* filter, const SkMatrix& matrix,
@@ -852,6 +1108,48 @@ static bool drawWithMaskFilter(GrContext* context, const SkPath& path,
                                GrPaint* grp) {
     SkMask  srcM, dstM;
 
+    float sigma;
+    if (gpu_blur_sigma(context, filter, path, matrix, &sigma)) {
+        // the bounds the CPU would give the mask, trimmed to the clip
+        if (!SkDraw::DrawToMask(path, &clip.getBounds(), filter, &matrix,
+                                &srcM, SkMask::kJustComputeBounds_CreateMode)) {
+            return false;
+        }
+        srcM.fFormat = SkMask::kA8_Format;
+        srcM.fImage = NULL;
+        if (!filter->filterMask(&dstM, srcM, matrix, NULL)) {
+            return false;
+        }
+        if (clip.quickReject(dstM.fBounds)) {
+            return false;
+        }
+        if (bounder && !bounder->doIRect(dstM.fBounds)) {
+            return false;
+        }
+
+        GpuBlur blur(context, dstM.fBounds.width(), dstM.fBounds.height(),
+                     sigma);
+        const GrTextureDesc desc = {
+            kRenderTarget_GrTextureFlagBit | kNoStencil_GrTextureFlagBit,
+            kNone_GrAALevel,
+            dstM.fBounds.width(),
+            dstM.fBounds.height(),
+            kRGBA_8888_GrPixelConfig
+        };
+        GrTexture* texture = blur.valid() ?
+                             context->lockScratchRenderTarget(desc) : NULL;
+        if (NULL != texture) {
+            SkPath maskPath;
+            path.offset(-SkIntToScalar(dstM.fBounds.fLeft),
+                        -SkIntToScalar(dstM.fBounds.fTop), &maskPath);
+            blur.draw(maskPath, gpu_blur_fill(path), texture);
+            draw_with_mask(context, grp, texture, dstM.fBounds);
+            // the next lock flushes any draw that still reads it
+            context->unlockScratchRenderTarget(texture);
+            return true;
+        }
+    }
+
     if (!SkDraw::DrawToMask(path, &clip.getBounds(), filter, &matrix, &srcM,
                             SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
         return false;
@@ -874,12 +1172,6 @@ static bool drawWithMaskFilter(GrContext* context, const SkPath& path,
 
     // we now have a device-aligned 8bit mask in dstM, ready to be drawn using
     // the current clip (and identity matrix) and grpaint settings
-
-    // used to compute inverse view, if necessary
-    GrMatrix ivm = context->getMatrix();
-
-    GrAutoMatrix avm(context, GrMatrix::I());
-
     const GrTextureDesc desc = {
         kNone_GrTextureFlags,
         kNone_GrAALevel,
@@ -894,29 +1186,157 @@ static bool drawWithMaskFilter(GrContext* context, const SkPath& path,
         return false;
     }
 
-    if (grp->hasTextureOrMask() && ivm.invert(&ivm)) {
-        grp->preConcatActiveSamplerMatrices(ivm);
+    draw_with_mask(context, grp, texture, dstM.fBounds);
+    texture->unref();
+    return true;
+}
+
+// Masks up to this size (after filtering) are kept in the texture cache, so
+// that redrawing the same path with only an integer translation doesn't
+// rasterize and filter it again. Larger ones are clipped to the device.
+#define MAX_CACHED_MASK_SIZE    256
+
+static uint32_t hash_mask_bytes(const void* data, size_t size, uint32_t hash) {
+    // FNV-1a
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619U;
     }
+    return hash;
+}
 
-    static const int MASK_IDX = GrPaint::kMaxMasks - 1;
-    // we assume the last mask index is available for use
-    GrAssert(NULL == grp->getMask(MASK_IDX));
-    grp->setMask(MASK_IDX, texture);
-    texture->unref();
-    grp->getMaskSampler(MASK_IDX)->setClampNoFilter();
+static uint32_t hash_mask_writer(const SkWriter32& writer, uint32_t hash) {
+    SkAutoSMalloc<1024> storage(writer.size());
+    writer.flatten(storage.get());
+    return hash_mask_bytes(storage.get(), writer.size(), hash);
+}
 
-    GrRect d;
-    d.setLTRB(GrIntToScalar(dstM.fBounds.fLeft),
-              GrIntToScalar(dstM.fBounds.fTop),
-              GrIntToScalar(dstM.fBounds.fRight),
-              GrIntToScalar(dstM.fBounds.fBottom));
+/**
+ * Draws path (in source space) through filter with its mask kept in the
+ * texture cache. The key is the path's contents, the matrix without its
+ * integer translation, and the filter's flattened parameters, so the mask is
+ * found again as long as none of those change. Blurs that the GPU can do are
+ * rendered straight into the cached texture.
+ *
+ * Returns false if the mask can't be cached, and the caller should draw with
+ * drawWithMaskFilter() instead.
+ */
+static bool drawWithCachedMask(GrContext* context, const SkPath& path,
+                               SkMaskFilter* filter, const SkMatrix& matrix,
+                               const SkRegion& clip, SkBounder* bounder,
+                               GrPaint* grp) {
+    if (matrix.hasPerspective() || NULL == filter->getFactory()) {
+        return false;
+    }
 
-    GrMatrix m;
-    m.setTranslate(-dstM.fBounds.fLeft, -dstM.fBounds.fTop);
-    m.postIDiv(dstM.fBounds.width(), dstM.fBounds.height());
-    grp->getMaskSampler(MASK_IDX)->setMatrix(m);
-    
-    context->drawRect(*grp, d);
+    // the mask is made for the fractional translation and placed at the
+    // integer one
+    SkScalar tx = matrix.getTranslateX();
+    SkScalar ty = matrix.getTranslateY();
+    int ix = SkScalarFloor(tx);
+    int iy = SkScalarFloor(ty);
+    SkMatrix maskMatrix = matrix;
+    maskMatrix.postTranslate(-SkIntToScalar(ix), -SkIntToScalar(iy));
+
+    SkPath maskPath;
+    path.transform(maskMatrix, &maskPath);
+
+    // the filter pads the path's bounds itself, so they aren't given it here
+    SkMask srcM, dstM;
+    if (!SkDraw::DrawToMask(maskPath, NULL, NULL, NULL, &srcM,
+                            SkMask::kJustComputeBounds_CreateMode)) {
+        return true;
+    }
+    srcM.fFormat = SkMask::kA8_Format;
+    srcM.fImage = NULL;
+    if (!filter->filterMask(&dstM, srcM, maskMatrix, NULL)) {
+        return true;
+    }
+    if (dstM.fBounds.width() > MAX_CACHED_MASK_SIZE ||
+        dstM.fBounds.height() > MAX_CACHED_MASK_SIZE) {
+        return false;
+    }
+
+    SkIRect devBounds = dstM.fBounds;
+    devBounds.offset(ix, iy);
+    if (clip.quickReject(devBounds)) {
+        return true;
+    }
+    if (bounder && !bounder->doIRect(devBounds)) {
+        return true;
+    }
+
+    SkWriter32 pathWriter(1024);
+    path.flatten(pathWriter);
+    SkFlattenableWriteBuffer filterWriter(64);
+    filterWriter.writeFlattenable(filter);
+    SkScalar xform[] = {
+        maskMatrix.getScaleX(), maskMatrix.getSkewX(), maskMatrix.getTranslateX(),
+        maskMatrix.getSkewY(), maskMatrix.getScaleY(), maskMatrix.getTranslateY(),
+    };
+    uint32_t p0 = hash_mask_writer(pathWriter, 2166136261U);
+    uint32_t p1 = hash_mask_bytes(xform, sizeof(xform), p0 ^ 0x9e3779b9);
+    p1 = hash_mask_writer(filterWriter, p1);
+
+    GrTextureKey key(p0, p1, dstM.fBounds.width(), dstM.fBounds.height());
+    GrSamplerState sampler;
+    sampler.setClampNoFilter();
+    GrTextureEntry* entry = context->findAndLockTexture(&key, sampler);
+
+    float sigma;
+    if (NULL == entry &&
+        gpu_blur_sigma(context, filter, path, maskMatrix, &sigma)) {
+        GpuBlur blur(context, dstM.fBounds.width(), dstM.fBounds.height(),
+                     sigma);
+        if (blur.valid()) {
+            const GrTextureDesc desc = {
+                kRenderTarget_GrTextureFlagBit | kNoStencil_GrTextureFlagBit,
+                kNone_GrAALevel,
+                dstM.fBounds.width(),
+                dstM.fBounds.height(),
+                kRGBA_8888_GrPixelConfig
+            };
+            entry = context->createAndLockTexture(&key, sampler, desc,
+                                                  NULL, 0);
+            if (NULL != entry) {
+                maskPath.offset(-SkIntToScalar(dstM.fBounds.fLeft),
+                                -SkIntToScalar(dstM.fBounds.fTop));
+                blur.draw(maskPath, gpu_blur_fill(path), entry->texture());
+            }
+        }
+    }
+
+    if (NULL == entry) {
+        SkMask renderM, filteredM;
+        if (!SkDraw::DrawToMask(maskPath, NULL, NULL, NULL, &renderM,
+                                SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
+            return true;
+        }
+        SkAutoMaskImage autoRender(&renderM, false);
+        if (!filter->filterMask(&filteredM, renderM, maskMatrix, NULL)) {
+            return true;
+        }
+        SkAutoMaskImage autoFiltered(&filteredM, false);
+        SkASSERT(filteredM.fBounds == dstM.fBounds);
+
+        const GrTextureDesc desc = {
+            kNone_GrTextureFlags,
+            kNone_GrAALevel,
+            filteredM.fBounds.width(),
+            filteredM.fBounds.height(),
+            kAlpha_8_GrPixelConfig
+        };
+        entry = context->createAndLockTexture(&key, sampler, desc,
+                                              filteredM.fImage,
+                                              filteredM.fRowBytes);
+        if (NULL == entry) {
+            return false;
+        }
+    }
+
+    draw_with_mask(context, grp, entry->texture(), devBounds);
+    // the draw holds its own ref on the texture if it is deferred
+    context->unlockTexture(entry);
     return true;
 }
 
@@ -987,6 +1407,12 @@ void SkGpuDevice::drawPath(const SkDraw& draw, const SkPath& origSrcPath,
     // END lift from SkDraw::drawPath()
 
     if (paint.getMaskFilter()) {
+        if (drawWithCachedMask(fContext, *pathPtr, paint.getMaskFilter(),
+                               *draw.fMatrix, *draw.fClip, draw.fBounder,
+                               &grPaint)) {
+            return;
+        }
+
         // avoid possibly allocating a new path in transform if we can
         SkPath* devPathPtr = pathIsMutable ? pathPtr : &tmpPath;
 
@@ -1083,13 +1509,10 @@ void SkGpuDevice::drawBitmap(const SkDraw& draw,
     if (bitmap.getTexture() || (bitmap.width() <= maxTextureSize &&
                                 bitmap.height() <= maxTextureSize)) {
         // take the fast case
-        this->internalDrawBitmap(draw, bitmap, srcRect, m, &grPaint);
+        this->internalDrawBitmap(draw, bitmap, srcRect, srcRect, m, &grPaint);
         return;
     }
 
-    // undo the translate done by SkCanvas
-    int DX = SkMax32(0, srcRect.fLeft);
-    int DY = SkMax32(0, srcRect.fTop);
     // compute clip bounds in local coordinates
     SkIRect clipRect;
     {
@@ -1102,38 +1525,51 @@ void SkGpuDevice::drawBitmap(const SkDraw& draw,
         }
         inverse.mapRect(&r);
         r.roundOut(&clipRect);
-        // apply the canvas' translate to our local clip
-        clipRect.offset(DX, DY);
-    }
-
-    int nx = bitmap.width() / maxTextureSize;
-    int ny = bitmap.height() / maxTextureSize;
-    for (int x = 0; x <= nx; x++) {
-        for (int y = 0; y <= ny; y++) {
-            SkIRect tileR;
-            tileR.set(x * maxTextureSize, y * maxTextureSize,
-                      (x + 1) * maxTextureSize, (y + 1) * maxTextureSize);
-            if (!SkIRect::Intersects(tileR, clipRect)) {
-                continue;
-            }
+        // the local origin is the top left of srcRect, move it to the bitmap's
+        clipRect.offset(srcRect.fLeft, srcRect.fTop);
+    }
+    // only the tiles under both srcRect and the clip are uploaded
+    SkIRect drawRect;
+    if (!drawRect.intersect(srcRect, clipRect)) {
+        return;
+    }
+
+    // With filtering each tile also holds a one pixel border of its
+    // neighbours, which the texture domain lets the sampler reach, so the
+    // seams are filtered like the rest of the image.
+    const int border = paint.isFilterBitmap() ? 1 : 0;
+    const int tileSize = maxTextureSize - 2 * border;
+    const SkIRect bounds = SkIRect::MakeWH(bitmap.width(), bitmap.height());
 
-            SkIRect srcR = tileR;
+    for (int y = drawRect.fTop / tileSize;
+         y <= (drawRect.fBottom - 1) / tileSize; y++) {
+        for (int x = drawRect.fLeft / tileSize;
+             x <= (drawRect.fRight - 1) / tileSize; x++) {
+            SkIRect srcR = SkIRect::MakeXYWH(x * tileSize, y * tileSize,
+                                             tileSize, tileSize);
             if (!srcR.intersect(srcRect)) {
                 continue;
             }
+            SkIRect tileR = srcR;
+            tileR.inset(-border, -border);
+            // we never sample outside of srcRect
+            if (!tileR.intersect(srcRect) || !tileR.intersect(bounds)) {
+                continue;
+            }
 
+            // the tile's pixel ref offset keys its texture in the cache, so
+            // a tile is only uploaded the first time it comes into view
             SkBitmap tmpB;
             if (bitmap.extractSubset(&tmpB, tileR)) {
-                // now offset it to make it "local" to our tmp bitmap
-                srcR.offset(-tileR.fLeft, -tileR.fTop);
-
                 SkMatrix tmpM(m);
-                {
-                    int dx = tileR.fLeft - DX + SkMax32(0, srcR.fLeft);
-                    int dy = tileR.fTop -  DY + SkMax32(0, srcR.fTop);
-                    tmpM.preTranslate(SkIntToScalar(dx), SkIntToScalar(dy));
-                }
-                this->internalDrawBitmap(draw, tmpB, srcR, tmpM, &grPaint);
+                tmpM.preTranslate(SkIntToScalar(srcR.fLeft - srcRect.fLeft),
+                                  SkIntToScalar(srcR.fTop - srcRect.fTop));
+
+                // now offset them to make them "local" to our tmp bitmap
+                srcR.offset(-tileR.fLeft, -tileR.fTop);
+                tileR.offset(-tileR.fLeft, -tileR.fTop);
+                this->internalDrawBitmap(draw, tmpB, srcR, tileR, tmpM,
+                                         &grPaint);
             }
         }
     }
@@ -1145,10 +1581,13 @@ void SkGpuDevice::drawBitmap(const SkDraw& draw,
  *
  *  internalDrawBitmap assumes that the specified bitmap will fit in a texture
  *  and that non-texture portion of the GrPaint has already been setup.
+ *  sampleRect contains srcRect, and is the part of the bitmap that filtering
+ *  may read from.
  */
 void SkGpuDevice::internalDrawBitmap(const SkDraw& draw,
                                      const SkBitmap& bitmap,
                                      const SkIRect& srcRect,
+                                     const SkIRect& sampleRect,
                                      const SkMatrix& m,
                                      GrPaint* grPaint) {
     SkASSERT(bitmap.width() <= fContext->getMaxTextureSize() &&
@@ -1166,10 +1605,37 @@ void SkGpuDevice::internalDrawBitmap(const SkDraw& draw,
     sampler->setSampleMode(GrSamplerState::kNormal_SampleMode);
     sampler->setMatrix(GrMatrix::I());
 
-    GrTexture* texture;
-    SkAutoCachedTexture act(this, bitmap, *sampler, &texture);
-    if (NULL == texture) {
-        return;
+    // Small bitmaps are drawn from the context's image atlas, so that draws
+    // of different ones can share a texture and be batched.
+    GrTexture* texture = NULL;
+    GrIRect atlasBounds;
+    if (NULL == bitmap.getTexture() &&
+        SkBitmap::kARGB_8888_Config == bitmap.config()) {
+        texture = fContext->findOrAddAtlasImage(bitmap.getGenerationID(),
+                                                bitmap.pixelRefOffset(),
+                                                bitmap.width(),
+                                                bitmap.height(),
+                                                bitmap.getPixels(),
+                                                bitmap.rowBytes(),
+                                                &atlasBounds);
+    }
+    // where the bitmap is in the texture, and the size texture coordinates
+    // are normalized by
+    int texL, texT, texW, texH;
+    SkAutoCachedTexture act;
+    if (NULL != texture) {
+        texL = atlasBounds.fLeft;
+        texT = atlasBounds.fTop;
+        texW = texture->width();
+        texH = texture->height();
+    } else {
+        texture = act.set(this, bitmap, *sampler);
+        if (NULL == texture) {
+            return;
+        }
+        texL = texT = 0;
+        texW = bitmap.width();
+        texH = bitmap.height();
     }
 
     grPaint->setTexture(kShaderTextureIdx, texture);
@@ -1177,30 +1643,38 @@ void SkGpuDevice::internalDrawBitmap(const SkDraw& draw,
     GrRect dstRect = SkRect::MakeWH(GrIntToScalar(srcRect.width()),
                                     GrIntToScalar(srcRect.height()));
     GrRect paintRect;
-    paintRect.setLTRB(GrFixedToScalar((srcRect.fLeft << 16) / bitmap.width()),
-                      GrFixedToScalar((srcRect.fTop << 16) / bitmap.height()),
-                      GrFixedToScalar((srcRect.fRight << 16) / bitmap.width()),
-                      GrFixedToScalar((srcRect.fBottom << 16) / bitmap.height()));
+    paintRect.setLTRB(GrFixedToScalar(((texL + srcRect.fLeft) << 16) / texW),
+                      GrFixedToScalar(((texT + srcRect.fTop) << 16) / texH),
+                      GrFixedToScalar(((texL + srcRect.fRight) << 16) / texW),
+                      GrFixedToScalar(((texT + srcRect.fBottom) << 16) / texH));
 
     if (GrSamplerState::kNearest_Filter != sampler->getFilter() &&
-        (srcRect.width() < bitmap.width() || 
-         srcRect.height() < bitmap.height())) {
+        (sampleRect.width() < bitmap.width() ||
+         sampleRect.height() < bitmap.height())) {
         // If drawing a subrect of the bitmap and filtering is enabled,
         // use a constrained texture domain to avoid color bleeding
+        GrRect sampleTexRect;
+        sampleTexRect.setLTRB(
+                GrFixedToScalar(((texL + sampleRect.fLeft) << 16) / texW),
+                GrFixedToScalar(((texT + sampleRect.fTop) << 16) / texH),
+                GrFixedToScalar(((texL + sampleRect.fRight) << 16) / texW),
+                GrFixedToScalar(((texT + sampleRect.fBottom) << 16) / texH));
         GrScalar left, top, right, bottom;
-        if (srcRect.width() > 1) {
-            GrScalar border = GR_ScalarHalf / bitmap.width();
-            left = paintRect.left() + border;
-            right = paintRect.right() - border;
+        if (sampleRect.width() > 1) {
+            GrScalar border = GR_ScalarHalf / texW;
+            left = sampleTexRect.left() + border;
+            right = sampleTexRect.right() - border;
         } else {
-            left = right = GrScalarHalf(paintRect.left() + paintRect.right());
+            left = right = GrScalarHalf(sampleTexRect.left() +
+                                        sampleTexRect.right());
         }
-        if (srcRect.height() > 1) {
-            GrScalar border = GR_ScalarHalf / bitmap.height();
-            top = paintRect.top() + border;
-            bottom = paintRect.bottom() - border;
+        if (sampleRect.height() > 1) {
+            GrScalar border = GR_ScalarHalf / texH;
+            top = sampleTexRect.top() + border;
+            bottom = sampleTexRect.bottom() - border;
         } else {
-            top = bottom = GrScalarHalf(paintRect.top() + paintRect.bottom());
+            top = bottom = GrScalarHalf(sampleTexRect.top() +
+                                        sampleTexRect.bottom());
         }
         GrRect textureDomain;
         textureDomain.setLTRB(left, top, right, bottom);
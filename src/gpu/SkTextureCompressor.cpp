@@ -0,0 +1,368 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkTextureCompressor.h"
+#include "SkColorPriv.h"
+
+// A block's pixels, row by row, as r, g, b.
+typedef uint8_t Block[16][3];
+
+static void load_block(const SkBitmap& bitmap, int left, int top,
+                       Block block) {
+    const int maxX = bitmap.width() - 1;
+    const int maxY = bitmap.height() - 1;
+    for (int y = 0; y < 4; ++y) {
+        int sy = SkMin32(top + y, maxY);
+        for (int x = 0; x < 4; ++x) {
+            int sx = SkMin32(left + x, maxX);
+            uint8_t* rgb = block[y * 4 + x];
+            if (SkBitmap::kARGB_8888_Config == bitmap.config()) {
+                SkPMColor c = *bitmap.getAddr32(sx, sy);
+                rgb[0] = SkGetPackedR32(c);
+                rgb[1] = SkGetPackedG32(c);
+                rgb[2] = SkGetPackedB32(c);
+            } else {
+                uint16_t c = *bitmap.getAddr16(sx, sy);
+                rgb[0] = SkPacked16ToR32(c);
+                rgb[1] = SkPacked16ToG32(c);
+                rgb[2] = SkPacked16ToB32(c);
+            }
+        }
+    }
+}
+
+static inline int clamp_byte(int value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static inline int square(int value) {
+    return value * value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  ETC1 splits each block into two 2x4 (or, flipped, 4x2) halves, each with
+    a base color and one of eight tables of luminance modifiers, and each
+    pixel picks one of its table's four modifiers to add to the base. The
+    bases are either both 444, or 555 with the second one stored as a small
+    difference from the first.
+
+    This tries both splits, takes each half's average color as its base
+    (using the 555 mode when the averages are close enough), and picks the
+    table and modifiers with the least squared error.
+ */
+
+static const int gETC1Modifiers[8][2] = {
+    {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+    { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 },
+};
+
+static inline bool etc1_in_second_half(int x, int y, bool flip) {
+    return flip ? y >= 2 : x >= 2;
+}
+
+/*  Pick the table for one half of the block with the passed base color,
+    setting its index and the modifier index of each of the half's pixels.
+    Returns the squared error.
+ */
+static int etc1_fit_half(const Block block, bool flip, bool second,
+                         const int base[3], int* bestTable,
+                         int modifiers[16]) {
+    int bestError = SK_MaxS32;
+    for (int t = 0; t < 8; ++t) {
+        const int a = gETC1Modifiers[t][0];
+        const int b = gETC1Modifiers[t][1];
+        const int offsets[4] = { a, b, -a, -b };
+        int error = 0;
+        int choices[16];
+        for (int i = 0; i < 16 && error < bestError; ++i) {
+            if (etc1_in_second_half(i & 3, i >> 2, flip) != second) {
+                continue;
+            }
+            int pixelError = SK_MaxS32;
+            for (int m = 0; m < 4; ++m) {
+                int e = 0;
+                for (int c = 0; c < 3; ++c) {
+                    e += square(clamp_byte(base[c] + offsets[m]) - block[i][c]);
+                }
+                if (e < pixelError) {
+                    pixelError = e;
+                    choices[i] = m;
+                }
+            }
+            error += pixelError;
+        }
+        if (error < bestError) {
+            bestError = error;
+            *bestTable = t;
+            for (int i = 0; i < 16; ++i) {
+                if (etc1_in_second_half(i & 3, i >> 2, flip) == second) {
+                    modifiers[i] = choices[i];
+                }
+            }
+        }
+    }
+    return bestError;
+}
+
+static uint64_t etc1_encode_block(const Block block) {
+    uint64_t bestBits = 0;
+    int bestError = SK_MaxS32;
+
+    for (int f = 0; f < 2; ++f) {
+        const bool flip = f != 0;
+        int sums[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+        for (int i = 0; i < 16; ++i) {
+            int half = etc1_in_second_half(i & 3, i >> 2, flip);
+            for (int c = 0; c < 3; ++c) {
+                sums[half][c] += block[i][c];
+            }
+        }
+
+        // the stored base colors, and their expansion to 8 bits
+        int stored[2][3];
+        int base[2][3];
+        bool differential = true;
+        for (int h = 0; h < 2; ++h) {
+            for (int c = 0; c < 3; ++c) {
+                // round the average of the half's 8 pixels to 5 bits
+                stored[h][c] = (sums[h][c] * 31 + 4 * 255) / (8 * 255);
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            int delta = stored[1][c] - stored[0][c];
+            if (delta < -4 || delta > 3) {
+                differential = false;
+            }
+        }
+        for (int h = 0; h < 2; ++h) {
+            for (int c = 0; c < 3; ++c) {
+                if (differential) {
+                    base[h][c] = (stored[h][c] << 3) | (stored[h][c] >> 2);
+                } else {
+                    stored[h][c] = (sums[h][c] * 15 + 4 * 255) / (8 * 255);
+                    base[h][c] = (stored[h][c] << 4) | stored[h][c];
+                }
+            }
+        }
+
+        int tables[2];
+        int modifiers[16];
+        int error = etc1_fit_half(block, flip, false, base[0], &tables[0],
+                                  modifiers) +
+                    etc1_fit_half(block, flip, true, base[1], &tables[1],
+                                  modifiers);
+        if (error >= bestError) {
+            continue;
+        }
+        bestError = error;
+
+        uint32_t high = 0;
+        for (int c = 0; c < 3; ++c) {
+            int shift = 24 - c * 8;
+            if (differential) {
+                int delta = stored[1][c] - stored[0][c];
+                high |= ((stored[0][c] << 3) | (delta & 7)) << shift;
+            } else {
+                high |= ((stored[0][c] << 4) | stored[1][c]) << shift;
+            }
+        }
+        high |= (tables[0] << 5) | (tables[1] << 2) |
+                ((int)differential << 1) | (int)flip;
+
+        // the modifier indices go by column, most significant bits first
+        uint32_t low = 0;
+        for (int i = 0; i < 16; ++i) {
+            int bit = (i & 3) * 4 + (i >> 2);
+            low |= ((modifiers[i] >> 1) << (bit + 16)) |
+                   ((modifiers[i] & 1) << bit);
+        }
+        bestBits = ((uint64_t)high << 32) | low;
+    }
+    return bestBits;
+}
+
+static void etc1_write_block(const Block block, uint8_t dst[8]) {
+    uint64_t bits = etc1_encode_block(block);
+    // big endian
+    for (int i = 7; i >= 0; --i) {
+        dst[i] = (uint8_t)bits;
+        bits >>= 8;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  DXT1 stores two 565 endpoint colors per block, and each pixel picks one
+    of them or one of the two colors a third and two thirds of the way
+    between them. The endpoints must be stored with the first greater than
+    the second, or the block is in a mode with transparent black.
+
+    This takes the endpoints from the pixels at either end of the block's
+    principal axis (the direction its colors vary the most in).
+ */
+
+static inline uint16_t dxt1_pack565(const int rgb[3]) {
+    // round to the nearest, instead of truncating like SkPack888ToRGB16
+    return SkPackRGB16((rgb[0] * 31 + 127) / 255, (rgb[1] * 63 + 127) / 255,
+                       (rgb[2] * 31 + 127) / 255);
+}
+
+static inline void dxt1_unpack565(uint16_t c, int rgb[3]) {
+    rgb[0] = SkPacked16ToR32(c);
+    rgb[1] = SkPacked16ToG32(c);
+    rgb[2] = SkPacked16ToB32(c);
+}
+
+static void dxt1_write_block(const Block block, uint8_t dst[8]) {
+    float mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            mean[c] += block[i][c];
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        mean[c] /= 16;
+    }
+
+    float cov[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+    for (int i = 0; i < 16; ++i) {
+        float d[3];
+        for (int c = 0; c < 3; ++c) {
+            d[c] = block[i][c] - mean[c];
+        }
+        for (int j = 0; j < 3; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                cov[j][k] += d[j] * d[k];
+            }
+        }
+    }
+
+    // a few rounds of power iteration find the principal axis well enough
+    float axis[3] = { 1, 1, 1 };
+    for (int iter = 0; iter < 4; ++iter) {
+        float next[3];
+        float length = 0;
+        for (int j = 0; j < 3; ++j) {
+            next[j] = cov[j][0] * axis[0] + cov[j][1] * axis[1] +
+                      cov[j][2] * axis[2];
+            if (sk_float_abs(next[j]) > length) {
+                length = sk_float_abs(next[j]);
+            }
+        }
+        if (length <= 0) {
+            break;  // a solid block
+        }
+        for (int j = 0; j < 3; ++j) {
+            axis[j] = next[j] / length;
+        }
+    }
+
+    int minIndex = 0;
+    int maxIndex = 0;
+    float minDot = 0;
+    float maxDot = 0;
+    for (int i = 0; i < 16; ++i) {
+        float dot = block[i][0] * axis[0] + block[i][1] * axis[1] +
+                    block[i][2] * axis[2];
+        if (0 == i) {
+            minDot = maxDot = dot;
+        } else if (dot < minDot) {
+            minDot = dot;
+            minIndex = i;
+        } else if (dot > maxDot) {
+            maxDot = dot;
+            maxIndex = i;
+        }
+    }
+
+    int ends[2][3];
+    for (int c = 0; c < 3; ++c) {
+        ends[0][c] = block[maxIndex][c];
+        ends[1][c] = block[minIndex][c];
+    }
+    uint16_t color0 = dxt1_pack565(ends[0]);
+    uint16_t color1 = dxt1_pack565(ends[1]);
+    if (color0 < color1) {
+        SkTSwap(color0, color1);
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        dxt1_unpack565(color0, palette[0]);
+        dxt1_unpack565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i) {
+            int bestError = SK_MaxS32;
+            int best = 0;
+            for (int p = 0; p < 4; ++p) {
+                int e = square(palette[p][0] - block[i][0]) +
+                        square(palette[p][1] - block[i][1]) +
+                        square(palette[p][2] - block[i][2]);
+                if (e < bestError) {
+                    bestError = e;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+    // otherwise every pixel is color0, index 0
+
+    // little endian
+    dst[0] = (uint8_t)color0;
+    dst[1] = (uint8_t)(color0 >> 8);
+    dst[2] = (uint8_t)color1;
+    dst[3] = (uint8_t)(color1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        dst[4 + i] = (uint8_t)(indices >> (i * 8));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkTextureCompressor::GetDataSize(int width, int height) {
+    return ((width + 3) >> 2) * ((height + 3) >> 2) * 8;
+}
+
+bool SkTextureCompressor::Compress(const SkBitmap& bitmap, Format format,
+                                   void* dst) {
+    if (SkBitmap::kARGB_8888_Config != bitmap.config() &&
+        SkBitmap::kRGB_565_Config != bitmap.config()) {
+        return false;
+    }
+    SkASSERT(bitmap.getPixels());
+
+    uint8_t* block = (uint8_t*)dst;
+    Block pixels;
+    for (int y = 0; y < bitmap.height(); y += 4) {
+        for (int x = 0; x < bitmap.width(); x += 4) {
+            load_block(bitmap, x, y, pixels);
+            if (kETC1_Format == format) {
+                etc1_write_block(pixels, block);
+            } else {
+                dxt1_write_block(pixels, block);
+            }
+            block += 8;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#ifndef SkTextureCompressor_DEFINED
+#define SkTextureCompressor_DEFINED
+
+#include "SkBitmap.h"
+
+/**
+ *  Encodes opaque bitmaps into the block compressed formats that GPUs can
+ *  sample directly. Both formats store each 4x4 block of pixels in 8 bytes,
+ *  blocks in rows from the top, so they take a quarter of the memory of 565
+ *  and an eighth of 8888. Alpha is ignored.
+ */
+class SkTextureCompressor {
+public:
+    enum Format {
+        kETC1_Format,   //!< GL_OES_compressed_ETC1_RGB8_texture
+        kDXT1_Format,   //!< GL_EXT_texture_compression_s3tc (opaque)
+    };
+
+    /**
+     *  Return the number of bytes that the compressed data for an image of
+     *  the specified size takes. Partial blocks at the right and bottom
+     *  edges are padded with the edge pixels.
+     */
+    static size_t GetDataSize(int width, int height);
+
+    /**
+     *  Write the compressed data for the bitmap, which must be
+     *  kARGB_8888_Config or kRGB_565_Config with its pixels locked, into dst,
+     *  which must hold GetDataSize() bytes. Returns false (writing nothing)
+     *  if the bitmap's config isn't supported.
+     */
+    static bool Compress(const SkBitmap&, Format, void* dst);
+};
+
+#endif
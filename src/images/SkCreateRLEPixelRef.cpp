@@ -1,3 +1,4 @@
+#include "SkCreateRLEPixelRef.h"
 #include "SkChunkAlloc.h"
 #include "SkPackBits.h"
 #include "SkBitmap.h"
@@ -23,6 +24,7 @@ RLEPixelRef::RLEPixelRef(SkBitmap::RLEPixels* rlep, SkColorTable* ctable)
     fRLEPixels = rlep;  // we now own this ptr
     fCTable = ctable;
     SkSafeRef(ctable);
+    this->setPreLocked(fRLEPixels, fCTable);
 }
 
 RLEPixelRef::~RLEPixelRef() {
@@ -50,14 +52,16 @@ public:
     SkChunkAlloc fStorage;
 };
 
-SkPixelRef* SkCreateRLEPixelRef(const SkBitmap& src);
 SkPixelRef* SkCreateRLEPixelRef(const SkBitmap& src) {
-    
-    if (SkBitmap::kIndex8_Config != src.config() &&
-            SkBitmap::kA8_Config != src.config()) {
+    // kRLE_Index8_Config is the only config that these can be the pixels of
+    if (SkBitmap::kIndex8_Config != src.config()) {
         return NULL;
     }
-    
+    SkAutoLockPixels alp(src);
+    if (!src.readyToDraw()) {
+        return NULL;
+    }
+
     size_t maxPacked = SkPackBits::ComputeMaxSize8(src.width());
 
     // estimate the rle size based on the original size
@@ -117,4 +121,13 @@ SkPixelRef* SkCreateRLEPixelRef(const SkBitmap& src) {
     // transfer ownership of rlePixels to our pixelref
     return SkNEW_ARGS(RLEPixelRef, (rlePixels, src.getColorTable()));
 }
-        
+
+bool SkCreateRLEBitmap(const SkBitmap& src, SkBitmap* dst) {
+    SkPixelRef* pr = SkCreateRLEPixelRef(src);
+    if (NULL == pr) {
+        return false;
+    }
+    dst->setConfig(SkBitmap::kRLE_Index8_Config, src.width(), src.height());
+    dst->setPixelRef(pr)->unref();
+    return true;
+}
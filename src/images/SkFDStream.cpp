@@ -1,6 +1,12 @@
 #include "SkStream.h"
 #include <unistd.h>
 
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID) || \
+    defined(ANDROID)
+    #include <fcntl.h>
+    #define SK_FDSTREAM_USE_FADVISE
+#endif
+
 //#define TRACE_FDSTREAM
 
 SkFDStream::SkFDStream(int fileDesc, bool closeWhenDone)
@@ -83,3 +89,12 @@ size_t SkFDStream::read(void* buffer, size_t size) {
     return 0;
 }
 
+bool SkFDStream::prefetch(size_t offset, size_t length) {
+#ifdef SK_FDSTREAM_USE_FADVISE
+    return fFD >= 0 && length &&
+           0 == ::posix_fadvise(fFD, (off_t)offset, (off_t)length,
+                                POSIX_FADV_WILLNEED);
+#else
+    return false;
+#endif
+}
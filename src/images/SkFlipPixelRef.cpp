@@ -2,13 +2,26 @@
 #include "SkFlattenable.h"
 #include "SkRegion.h"
 
-SkFlipPixelRef::SkFlipPixelRef(SkBitmap::Config config, int width, int height)
-: fFlipper(width, height) {
+// the pages start at this alignment, and the spans CopyBitsFromAddr()
+// copies are rounded out to it, so that when the rows are a multiple of it
+// too, memcpy can use its widest moves
+static const size_t kPageAlign = 16;
+
+static void* alloc_pages(size_t size, int count, void* pages[]) {
+    const size_t stride = (size + kPageAlign - 1) & ~(kPageAlign - 1);
+    char* storage = (char*)sk_malloc_throw(stride * count);
+    for (int i = 0; i < count; i++) {
+        pages[i] = storage + i * stride;
+    }
+    return storage;
+}
+
+SkFlipPixelRef::SkFlipPixelRef(SkBitmap::Config config, int width, int height,
+                               int pageCount)
+: fFlipper(width, height, pageCount) {
     fConfig = config;
     fSize = SkBitmap::ComputeSize(config, width, height);
-    fStorage = sk_malloc_throw(fSize << 1);
-    fPage0 = fStorage;
-    fPage1 = (char*)fStorage + fSize;
+    fStorage = alloc_pages(fSize, pageCount, fPages);
 }
 
 SkFlipPixelRef::~SkFlipPixelRef() {
@@ -39,7 +52,7 @@ void SkFlipPixelRef::endUpdate() {
 void* SkFlipPixelRef::onLockPixels(SkColorTable** ct) {
     fMutex.acquire();
     *ct = NULL;
-    return fPage0;
+    return fPages[0];
 }
 
 void SkFlipPixelRef::onUnlockPixels() {
@@ -48,7 +61,13 @@ void SkFlipPixelRef::onUnlockPixels() {
 
 void SkFlipPixelRef::swapPages() {
     fMutex.acquire();
-    SkTSwap<void*>(fPage0, fPage1);
+    // the back page was just drawn into, so it moves to the front
+    const int last = fFlipper.pageCount() - 1;
+    void* back = fPages[last];
+    for (int i = last; i > 0; i--) {
+        fPages[i] = fPages[i - 1];
+    }
+    fPages[0] = back;
     this->notifyPixelsChanged();
     fMutex.release();
 }
@@ -58,16 +77,14 @@ void SkFlipPixelRef::flatten(SkFlattenableWriteBuffer& buffer) const {
     
     buffer.write32(fSize);
     // only need to write page0
-    buffer.writePad(fPage0, fSize);
+    buffer.writePad(fPages[0], fSize);
 }
 
 SkFlipPixelRef::SkFlipPixelRef(SkFlattenableReadBuffer& buffer)
         : INHERITED(buffer, NULL) {
     fSize = buffer.readU32();
-    fStorage = sk_malloc_throw(fSize << 1);
-    fPage0 = fStorage;
-    fPage1 = (char*)fStorage + fSize;
-    buffer.read(fPage0, fSize);
+    fStorage = alloc_pages(fSize, fFlipper.pageCount(), fPages);
+    buffer.read(fPages[0], fSize);
 }
 
 SkPixelRef* SkFlipPixelRef::Create(SkFlattenableReadBuffer& buffer) {
@@ -79,15 +96,25 @@ static SkPixelRef::Registrar reg("SkFlipPixelRef",
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static void copyRect(const SkBitmap& dst, const SkIRect& rect,
-                     const void* srcAddr, int shift) {
-    const size_t offset = rect.fTop * dst.rowBytes() + (rect.fLeft << shift);
+// Rects of a band closer together than this many bytes are copied as one
+// span, gap and all, which is cheaper than starting another copy.
+static const size_t kMaxSpanGap = 64;
+
+// copy the bytes [left, right) of the rows [top, bottom)
+static void copySpan(const SkBitmap& dst, int top, int bottom, size_t left,
+                     size_t right, const void* srcAddr) {
+    const size_t rb = dst.rowBytes();
+    const size_t offset = top * rb + left;
     char* dstP = static_cast<char*>(dst.getPixels()) + offset;
     const char* srcP = static_cast<const char*>(srcAddr) + offset;
-    const size_t rb = dst.rowBytes();
-    const size_t bytes = rect.width() << shift;
-    
-    int height = rect.height();
+    const size_t bytes = right - left;
+
+    int height = bottom - top;
+    if (bytes == rb) {
+        // whole rows follow each other
+        memcpy(dstP, srcP, height * rb);
+        return;
+    }
     while (--height >= 0) {
         memcpy(dstP, srcP, bytes);
         dstP += rb;
@@ -119,9 +146,45 @@ void SkFlipPixelRef::CopyBitsFromAddr(const SkBitmap& dst, const SkRegion& clip,
     
     const SkIRect bounds = {0, 0, dst.width(), dst.height()};
     SkRegion::Cliperator iter(clip, bounds);
-    
-    while (!iter.done()) {
-        copyRect(dst, iter.rect(), srcAddr, shift);
-        iter.next();
+
+    const size_t rowBytes = dst.rowBytes();
+    int top = 0;
+    int bottom = 0;
+    size_t left = 0;
+    size_t right = 0;
+    bool pending = false;
+    for (; !iter.done(); iter.next()) {
+        const SkIRect& r = iter.rect();
+        // round the rect's bytes out to kPageAlign, within the row
+        const size_t spanLeft = (r.fLeft << shift) & ~(kPageAlign - 1);
+        size_t spanRight = ((r.fRight << shift) + kPageAlign - 1) &
+                           ~(kPageAlign - 1);
+        if (spanRight > rowBytes) {
+            spanRight = rowBytes;
+        }
+        if (pending) {
+            if (r.fTop == top && r.fBottom == bottom &&
+                    spanLeft <= right + kMaxSpanGap) {
+                // the next rect of the same band
+                if (spanRight > right) {
+                    right = spanRight;
+                }
+                continue;
+            }
+            if (r.fTop == bottom && spanLeft == left && spanRight == right) {
+                // the same span in the next band
+                bottom = r.fBottom;
+                continue;
+            }
+            copySpan(dst, top, bottom, left, right, srcAddr);
+        }
+        top = r.fTop;
+        bottom = r.fBottom;
+        left = spanLeft;
+        right = spanRight;
+        pending = true;
+    }
+    if (pending) {
+        copySpan(dst, top, bottom, left, right, srcAddr);
     }
 }
@@ -0,0 +1,244 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkImageDecodeQueue.h"
+#include "SkImageRef_GlobalPool.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC) || \
+    defined(SK_BUILD_FOR_ANDROID) || defined(ANDROID)
+    #define SK_DECODEQUEUE_USE_PTHREADS
+#endif
+
+#ifdef SK_DECODEQUEUE_USE_PTHREADS
+
+#include <pthread.h>
+
+struct SkImageDecodeQueue::Impl {
+    pthread_mutex_t fMutex;
+    pthread_cond_t  fCond;  // signaled when a decode finishes
+
+    Impl() {
+        pthread_mutex_init(&fMutex, NULL);
+        pthread_cond_init(&fCond, NULL);
+    }
+    ~Impl() {
+        pthread_cond_destroy(&fCond);
+        pthread_mutex_destroy(&fMutex);
+    }
+    void lock() { pthread_mutex_lock(&fMutex); }
+    void unlock() { pthread_mutex_unlock(&fMutex); }
+    void sleep() { pthread_cond_wait(&fCond, &fMutex); }
+    void wakeAll() { pthread_cond_broadcast(&fCond); }
+};
+
+#else
+
+/*  Without threads, SkThreadPool runs every decode on the caller's thread
+    inside wait(), so there is never anything to lock or to wait for.
+ */
+struct SkImageDecodeQueue::Impl {
+    void lock() {}
+    void unlock() {}
+    void sleep() { SkASSERT(!"no other thread can wake us"); }
+    void wakeAll() {}
+};
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  Installed on each job's decoder, so that the pixels it allocates are
+    counted against the queue's ceiling.
+ */
+class SkImageDecodeQueue::Allocator : public SkBitmap::Allocator {
+public:
+    Allocator(SkImageDecodeQueue* queue) : fQueue(queue), fReserved(0) {}
+
+    size_t reserved() const { return fReserved; }
+
+    virtual bool allocPixelRef(SkBitmap* bitmap, SkColorTable* ctable) {
+        size_t size = bitmap->getSize();
+        if (ctable) {
+            size += ctable->count() * sizeof(SkPMColor);
+        }
+        fQueue->reserveRAM(size, fReserved);
+        fReserved += size;
+        return bitmap->allocPixels(ctable);
+    }
+
+private:
+    SkImageDecodeQueue* fQueue;
+    size_t              fReserved;
+};
+
+class SkImageDecodeQueue::Job : public SkRunnable {
+public:
+    Job(SkImageDecodeQueue* queue, Future* future)
+            : fQueue(queue), fFuture(future) {
+        future->ref();
+    }
+
+    virtual void run() {
+        fQueue->run(fFuture);
+        fFuture->unref();
+        // the pool does not touch a runnable once it has run
+        SkDELETE(this);
+    }
+
+private:
+    SkImageDecodeQueue* fQueue;
+    Future*             fFuture;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkImageDecodeQueue::Future::Future(SkImageDecodeQueue* queue,
+                                   SkStream* stream, SkBitmap::Config pref,
+                                   SkImageDecoder::Mode mode)
+        : fQueue(queue), fStream(stream), fPrefConfig(pref), fMode(mode),
+          fSuccess(false), fDone(false) {
+    stream->ref();
+}
+
+SkImageDecodeQueue::Future::~Future() {
+    SkSafeUnref(fStream);
+}
+
+bool SkImageDecodeQueue::Future::isDone() const {
+    return fDone;
+}
+
+bool SkImageDecodeQueue::Future::wait(SkBitmap* bitmap) {
+    // once we are done, our queue may have been deleted
+    if (!fDone) {
+        fQueue->waitFor(this);
+    }
+    SkASSERT(fDone);
+    if (fSuccess && bitmap) {
+        *bitmap = fBitmap;
+    }
+    return fSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkImageDecodeQueue::SkImageDecodeQueue(int threadCount, size_t ramCeiling)
+        : fPool(threadCount > 0 ? threadCount : SkThreadPool::CPUCount()) {
+    fImpl = SkNEW(Impl);
+    fRAMCeiling = ramCeiling;
+    fRAMInFlight = 0;
+}
+
+SkImageDecodeQueue::~SkImageDecodeQueue() {
+    fPool.wait();
+    SkASSERT(0 == fRAMInFlight);
+    SkDELETE(fImpl);
+}
+
+size_t SkImageDecodeQueue::getRAMCeiling() const {
+    if (fRAMCeiling) {
+        return fRAMCeiling;
+    }
+    return SkImageRef_GlobalPool::GetRAMBudget();
+}
+
+SkImageDecodeQueue::Future* SkImageDecodeQueue::decode(SkStream* stream,
+                                                SkBitmap::Config pref,
+                                                SkImageDecoder::Mode mode) {
+    SkASSERT(stream);
+    Future* future = SkNEW_ARGS(Future, (this, stream, pref, mode));
+    fPool.add(SkNEW_ARGS(Job, (this, future)));
+    return future;
+}
+
+void SkImageDecodeQueue::decode(SkStream* const streams[], int count,
+                                Future* futures[], SkBitmap::Config pref,
+                                SkImageDecoder::Mode mode) {
+    for (int i = 0; i < count; i++) {
+        futures[i] = this->decode(streams[i], pref, mode);
+    }
+}
+
+void SkImageDecodeQueue::wait() {
+    fPool.wait();
+}
+
+void SkImageDecodeQueue::waitFor(const Future* future) {
+    if (0 == fPool.threadCount()) {
+        fPool.wait();
+        return;
+    }
+    fImpl->lock();
+    while (!future->fDone) {
+        fImpl->sleep();
+    }
+    fImpl->unlock();
+}
+
+// called on a worker thread
+void SkImageDecodeQueue::run(Future* future) {
+    SkStream* stream = future->fStream;
+    Allocator* allocator = SkNEW_ARGS(Allocator, (this));
+    SkAutoUnref aur(allocator);
+
+    SkBitmap bitmap;
+    bool success = false;
+    SkImageDecoder* codec = SkImageDecoder::Factory(stream);
+    if (codec) {
+        SkAutoTDelete<SkImageDecoder> ad(codec);
+        codec->setAllocator(allocator);
+        success = codec->decode(stream, &bitmap, future->fPrefConfig,
+                                future->fMode);
+    }
+    // the stream is only needed for the decode
+    stream->unref();
+    future->fStream = NULL;
+
+    fImpl->lock();
+    future->fBitmap.swap(bitmap);
+    future->fSuccess = success;
+    future->fDone = true;
+    SkASSERT(fRAMInFlight >= allocator->reserved());
+    fRAMInFlight -= allocator->reserved();
+    fImpl->wakeAll();
+    fImpl->unlock();
+}
+
+// called by a decoder, on a worker thread, before it allocates its pixels
+void SkImageDecodeQueue::reserveRAM(size_t bytes, size_t alreadyReserved) {
+    const size_t ceiling = this->getRAMCeiling();
+
+    fImpl->lock();
+    if (ceiling) {
+        // only wait while someone else has memory that they will give back
+        while (fRAMInFlight > alreadyReserved &&
+                fRAMInFlight + bytes > ceiling) {
+            fImpl->sleep();
+        }
+    }
+    fRAMInFlight += bytes;
+    const size_t inFlight = fRAMInFlight;
+    fImpl->unlock();
+
+    if (ceiling) {
+        size_t poolLimit = inFlight < ceiling ? ceiling - inFlight : 0;
+        if (SkImageRef_GlobalPool::GetRAMUsed() > poolLimit) {
+            SkImageRef_GlobalPool::SetRAMUsed(poolLimit);
+        }
+    }
+}
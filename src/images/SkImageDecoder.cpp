@@ -20,6 +20,7 @@
 #include "SkPixelRef.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
+#include "SkTrace.h"
 
 static SkBitmap::Config gDeviceConfig = SkBitmap::kNo_Config;
 
@@ -38,13 +39,17 @@ void SkImageDecoder::SetDeviceConfig(SkBitmap::Config config)
 SkImageDecoder::SkImageDecoder()
     : fPeeker(NULL), fChooser(NULL), fAllocator(NULL), fSampleSize(1),
       fDefaultPref(SkBitmap::kNo_Config), fDitherImage(true),
-      fUsePrefTable(false) {
+      fUsePrefTable(false), fPreserveSrcDepth(false),
+      fTileWidth(0), fTileHeight(0), fTileLength(0),
+      fIncrementalRows(0), fIncrementalResult(kError_IncrementalResult),
+      fIncrementalData(NULL) {
 }
 
 SkImageDecoder::~SkImageDecoder() {
     SkSafeUnref(fPeeker);
     SkSafeUnref(fChooser);
     SkSafeUnref(fAllocator);
+    SkDELETE(fIncrementalData);
 }
 
 SkImageDecoder::Format SkImageDecoder::getFormat() const {
@@ -105,6 +110,10 @@ SkBitmap::Config SkImageDecoder::getPrefConfig(SrcDepth srcDepth,
                                                bool srcHasAlpha) const {
     SkBitmap::Config config;
 
+    if (fPreserveSrcDepth && kIndex_SrcDepth == srcDepth) {
+        return SkBitmap::kIndex8_Config;
+    }
+
     if (fUsePrefTable) {
         int index = 0;
         switch (srcDepth) {
@@ -132,8 +141,16 @@ SkBitmap::Config SkImageDecoder::getPrefConfig(SrcDepth srcDepth,
     return config;
 }
 
+SK_TRACE_COUNTER(gDecodeCount, "imagedecoder.decodes");
+SK_TRACE_COUNTER(gDecodeFailures, "imagedecoder.failures");
+SK_TRACE_COUNTER(gDecodePixels, "imagedecoder.pixels");
+SK_TRACE_COUNTER(gDecodeRegionCount, "imagedecoder.region_decodes");
+
 bool SkImageDecoder::decode(SkStream* stream, SkBitmap* bm,
                             SkBitmap::Config pref, Mode mode) {
+    SK_TRACE_EVENT("SkImageDecoder::decode");
+    SK_TRACE_INC(gDecodeCount);
+
     // pass a temporary bitmap, so that if we return false, we are assured of
     // leaving the caller's bitmap untouched.
     SkBitmap    tmp;
@@ -144,12 +161,134 @@ bool SkImageDecoder::decode(SkStream* stream, SkBitmap* bm,
     fDefaultPref = pref;
 
     if (!this->onDecode(stream, &tmp, mode)) {
+        SK_TRACE_INC(gDecodeFailures);
         return false;
     }
+    if (kDecodePixels_Mode == mode) {
+        SK_TRACE_ADD(gDecodePixels, tmp.width() * tmp.height());
+    }
     bm->swap(tmp);
     return true;
 }
 
+bool SkImageDecoder::buildTileIndex(SkStream* stream, int* width,
+                                    int* height) {
+    int w, h;
+    fTileWidth = fTileHeight = 0;
+    if (!this->onBuildTileIndex(stream, &w, &h) || w <= 0 || h <= 0) {
+        return false;
+    }
+    fTileWidth = w;
+    fTileHeight = h;
+    fTileLength = stream->getLength();
+    if (width) {
+        *width = w;
+    }
+    if (height) {
+        *height = h;
+    }
+    return true;
+}
+
+bool SkImageDecoder::decodeRegion(SkBitmap* bm, const SkIRect& rect,
+                                  SkBitmap::Config pref) {
+    SkASSERT(fTileWidth > 0);
+    SK_TRACE_EVENT("SkImageDecoder::decodeRegion");
+    SK_TRACE_INC(gDecodeRegionCount);
+
+    SkIRect r(rect);
+    if (!r.intersect(0, 0, fTileWidth, fTileHeight)) {
+        return false;
+    }
+
+    // as decode(), leave the caller's bitmap untouched if we fail
+    SkBitmap    tmp;
+
+    fShouldCancelDecode = false;
+    fDefaultPref = pref;
+
+    if (!this->onDecodeRegion(&tmp, r)) {
+        SK_TRACE_INC(gDecodeFailures);
+        return false;
+    }
+    SK_TRACE_ADD(gDecodePixels, r.width() * r.height());
+    bm->swap(tmp);
+    return true;
+}
+
+void SkImageDecoder::prefetchRegion(SkStream* stream,
+                                    const SkIRect& rect) const {
+    if (0 == fTileLength || fTileHeight <= 0) {
+        return;
+    }
+    // the rows above the region's bottom take about that share of the
+    // stream; ask for an eighth more, for the header and uneven compression
+    size_t length = (size_t)((uint64_t)fTileLength * rect.fBottom /
+                             fTileHeight);
+    length += fTileLength >> 3;
+    if (length > fTileLength) {
+        length = fTileLength;
+    }
+    stream->prefetch(0, length);
+}
+
+void SkImageDecoder::beginIncremental(SkBitmap::Config pref) {
+    fShouldCancelDecode = false;
+    fDefaultPref = pref;
+    fIncrementalBitmap.reset();
+    fIncrementalRows = 0;
+    fIncrementalResult = kPartial_IncrementalResult;
+    SkDELETE(fIncrementalData);
+    fIncrementalData = NULL;
+
+    if (!this->onBeginIncremental()) {
+        fIncrementalData = SkNEW(SkDynamicMemoryWStream);
+    }
+}
+
+SkImageDecoder::IncrementalResult SkImageDecoder::pushIncremental(
+                                                const void* data, size_t size) {
+    if (kPartial_IncrementalResult != fIncrementalResult || 0 == size) {
+        return fIncrementalResult;
+    }
+    if (fIncrementalData) {
+        if (!fIncrementalData->write(data, size)) {
+            fIncrementalResult = kError_IncrementalResult;
+        }
+    } else {
+        fIncrementalResult = this->onPushIncremental(data, size);
+    }
+    return fIncrementalResult;
+}
+
+SkImageDecoder::IncrementalResult SkImageDecoder::endIncremental() {
+    if (fIncrementalData) {
+        SkMemoryStream stream(fIncrementalData->getOffset());
+        fIncrementalData->copyTo((void*)stream.getMemoryBase());
+        SkDELETE(fIncrementalData);
+        fIncrementalData = NULL;
+
+        if (kPartial_IncrementalResult == fIncrementalResult) {
+            SkBitmap bm;
+            if (this->decode(&stream, &bm, fDefaultPref, kDecodePixels_Mode)) {
+                fIncrementalBitmap.swap(bm);
+                this->setIncrementalRows(fIncrementalBitmap.height());
+                fIncrementalResult = kComplete_IncrementalResult;
+            }
+        }
+    }
+    if (kComplete_IncrementalResult != fIncrementalResult) {
+        fIncrementalResult = kError_IncrementalResult;
+    }
+    return fIncrementalResult;
+}
+
+void SkImageDecoder::setIncrementalRows(int rows) {
+    SkASSERT(rows >= 0 && rows <= fIncrementalBitmap.height());
+    fIncrementalRows = rows;
+    fIncrementalBitmap.notifyPixelsChanged();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 bool SkImageDecoder::DecodeFile(const char file[], SkBitmap* bm,
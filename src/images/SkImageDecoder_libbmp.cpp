@@ -80,34 +80,84 @@ private:
     bool fJustBounds;
 };
 
-bool SkBMPImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
+static const int kBmpHeaderSize = 14;  // followed by the info header's size
+static const int kMaxPixels = 16383*16383; // max width*height
+// Headers (plus masks and colour map) longer than this are read with the rest
+// of the file.
+static const size_t kMaxStreamedHeaderSize = 64 * 1024;
+
+static size_t read_le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+}
 
-    size_t length = stream->getLength();
-    SkAutoMalloc storage(length);
-    
-    if (stream->read(storage.get(), length) != length) {
+/*  Uncompressed BMPs are decoded a row at a time, straight from the stream
+    into the bitmap, so that we only ever hold one row of the file. RLE images
+    (and ones whose headers we can't make sense of up front) are read in whole
+    and decoded through SkBmpDecoderCallback's rgb buffer.
+ */
+bool SkBMPImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
+    uint8_t peek[kBmpHeaderSize + 4];
+    if (stream->read(peek, sizeof(peek)) != sizeof(peek)) {
         return false;
     }
-    
+    // the pixels start at offset, after the headers and the colour map
+    const size_t offset = read_le32(peek + 10);
+    const size_t infoSize = read_le32(peek + 14);
+
     const bool justBounds = SkImageDecoder::kDecodeBounds_Mode == mode;
     SkBmpDecoderCallback callback(justBounds);
+    image_codec::BmpDecoderHelper helper;
+    int width, height;
+
+    SkAutoMalloc storage;
+    size_t storageSize = 0;
+    bool streaming = false;
+    if (offset >= sizeof(peek) && offset - kBmpHeaderSize >= infoSize &&
+            offset <= kMaxStreamedHeaderSize) {
+        storageSize = offset;
+        storage.alloc(storageSize);
+        memcpy(storage.get(), peek, sizeof(peek));
+        size_t rest = storageSize - sizeof(peek);
+        if (stream->read((char*)storage.get() + sizeof(peek), rest) != rest) {
+            return false;
+        }
+        streaming = helper.ReadHeader((const char*)storage.get(), storageSize,
+                                      kMaxPixels) &&
+                    !helper.isRLE() && helper.pixelOffset() == (int)offset;
+        width = helper.width();
+        height = helper.height();
+    } else {
+        storageSize = sizeof(peek);
+        storage.alloc(storageSize);
+        memcpy(storage.get(), peek, sizeof(peek));
+    }
+
+    if (!streaming) {
+        size_t length = stream->getLength();
+        if (length < storageSize) {
+            return false;
+        }
+        SkAutoMalloc whole(length);
+        memcpy(whole.get(), storage.get(), storageSize);
+        size_t rest = length - storageSize;
+        if (stream->read((char*)whole.get() + storageSize, rest) != rest) {
+            return false;
+        }
+        storage.free();
 
-    // Now decode the BMP into callback's rgb() array [r,g,b, r,g,b, ...]
-    {
-        image_codec::BmpDecoderHelper helper;
-        const int max_pixels = 16383*16383; // max width*height
-        if (!helper.DecodeImage((const char*)storage.get(), length,
-                                max_pixels, &callback)) {
+        // Now decode the BMP into callback's rgb() array [r,g,b, r,g,b, ...]
+        if (!helper.DecodeImage((const char*)whole.get(), length,
+                                kMaxPixels, &callback)) {
             return false;
         }
+        width = callback.width();
+        height = callback.height();
     }
-    
-    // we don't need this anymore, so free it now (before we try to allocate
-    // the bitmap's pixels) rather than waiting for its destructor
+
+    // we don't need the headers anymore, so free them now (before we try to
+    // allocate the bitmap's pixels) rather than waiting for the destructor
     storage.free();
     
-    int width = callback.width();
-    int height = callback.height();
     SkBitmap::Config config = this->getPrefConfig(k32Bit_SrcDepth, false);
 
     // only accept prefConfig if it makes sense for us
@@ -134,14 +184,50 @@ bool SkBMPImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
         return false;
     }
 
-    const int srcRowBytes = width * 3;
     const int dstHeight = sampler.scaledHeight();
-    const uint8_t* srcRow = callback.rgb();
-    
-    srcRow += sampler.srcY0() * srcRowBytes;
-    for (int y = 0; y < dstHeight; y++) {
-        sampler.next(srcRow);
-        srcRow += sampler.srcDY() * srcRowBytes;
+
+    if (!streaming) {
+        const int srcRowBytes = width * 3;
+        const uint8_t* srcRow = callback.rgb();
+
+        srcRow += sampler.srcY0() * srcRowBytes;
+        for (int y = 0; y < dstHeight; y++) {
+            sampler.next(srcRow);
+            srcRow += sampler.srcDY() * srcRowBytes;
+        }
+        return true;
+    }
+
+    const size_t fileRowBytes = helper.rowBytes();
+    SkAutoMalloc rowStorage(fileRowBytes + width * 3);
+    uint8_t* fileRow = (uint8_t*)rowStorage.get();
+    uint8_t* rgbRow = fileRow + fileRowBytes;
+
+    const int srcY0 = sampler.srcY0();
+    const int srcDY = sampler.srcDY();
+    const int lastY = srcY0 + (dstHeight - 1) * srcDY;
+    // bottom-up files give us their last row first, so those rows are sampled
+    // into the bitmap in reverse
+    for (int i = 0; i < height; i++) {
+        const int y = helper.bottomUp() ? height - 1 - i : i;
+        if (y > lastY && !helper.bottomUp()) {
+            break;  // past the last row we sample
+        }
+        size_t bytes = stream->read(fileRow, fileRowBytes);
+        if (bytes != fileRowBytes) {
+            // a load of BMPs seem to have their last byte missing
+            if (i != height - 1 || bytes + 1 != fileRowBytes) {
+                return false;
+            }
+            fileRow[bytes] = 0;
+        }
+        if (y >= srcY0 && y <= lastY && 0 == (y - srcY0) % srcDY) {
+            helper.DecodeRow(fileRow, rgbRow);
+            sampler.sampleInterlaced(rgbRow, y);
+        }
+        if (this->shouldCancelDecode()) {
+            return false;
+        }
     }
     return true;
 }
@@ -37,6 +37,24 @@ extern "C" {
 static const char KEY_MEM_CAP[] = "ro.media.dec.jpeg.memcap";
 #endif
 
+/*  libjpeg-turbo can color-convert straight into the byte order of our 8888
+    and 565 pixels, letting us skip SkScaledBitmapSampler (and its row copy)
+    when nothing is left to sample. Android's libjpeg has its own flavor of
+    this (ANDROID_RGB), which takes precedence.
+*/
+#if !defined(ANDROID_RGB) && defined(JCS_ALPHA_EXTENSIONS) && \
+    defined(SK_CPU_LENDIAN) && 8 == SK_G32_SHIFT && 24 == SK_A32_SHIFT
+    #if 0 == SK_R32_SHIFT && 16 == SK_B32_SHIFT
+        #define SK_JPEG_8888_COLOR_SPACE    JCS_EXT_RGBA
+    #elif 16 == SK_R32_SHIFT && 0 == SK_B32_SHIFT
+        #define SK_JPEG_8888_COLOR_SPACE    JCS_EXT_BGRA
+    #endif
+#endif
+#if !defined(ANDROID_RGB) && defined(LIBJPEG_TURBO_VERSION_NUMBER) && \
+    11 == SK_R16_SHIFT && 5 == SK_G16_SHIFT && 0 == SK_B16_SHIFT
+    #define SK_JPEG_565_COLOR_SPACE     JCS_RGB565
+#endif
+
 // this enables timing code to report milliseconds for an encode
 //#define TIME_ENCODE
 //#define TIME_DECODE
@@ -50,12 +68,24 @@ static const char KEY_MEM_CAP[] = "ro.media.dec.jpeg.memcap";
 
 class SkJPEGImageDecoder : public SkImageDecoder {
 public:
+    SkJPEGImageDecoder() : fTileStream(NULL) {}
+    virtual ~SkJPEGImageDecoder() {
+        SkSafeUnref(fTileStream);
+    }
+
     virtual Format getFormat() const {
         return kJPEG_Format;
     }
 
 protected:
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode);
+    virtual bool onBuildTileIndex(SkStream*, int* width, int* height);
+    virtual bool onDecodeRegion(SkBitmap* bm, const SkIRect& rect);
+
+private:
+    SkStream*   fTileStream;    // set by onBuildTileIndex
+
+    SkBitmap::Config setUpDecompress(jpeg_decompress_struct*, int dctScale);
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -110,23 +140,24 @@ static void overwrite_mem_buffer_size(j_decompress_ptr cinfo) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/*  If we need to better match the request, we might examine the image and
-     output dimensions, and determine if the downsampling jpeg provided is
-     not sufficient. If so, we can recompute a modified sampleSize value to
-     make up the difference.
-
-     To skip this additional scaling, just set sampleSize = 1; below.
+/*  libjpeg can only scale by 1/2, 1/4 and 1/8 in the IDCT, which is far
+    cheaper than decoding the whole image and sampling it afterwards. Return
+    the largest of those (or 1) that divides sampleSize, so that the sampler
+    can make up the rest exactly. An odd sampleSize cannot be met exactly
+    that way, so for it we take the closest scale below it instead, and the
+    result is somewhat larger than requested.
  */
-static int recompute_sampleSize(int sampleSize,
-                                const jpeg_decompress_struct& cinfo) {
-    return sampleSize * cinfo.output_width / cinfo.image_width;
-}
-
-static bool valid_output_dimensions(const jpeg_decompress_struct& cinfo) {
-    /* These are initialized to 0, so if they have non-zero values, we assume
-       they are "valid" (i.e. have been computed by libjpeg)
-     */
-    return cinfo.output_width != 0 && cinfo.output_height != 0;
+static int compute_dct_scale(int sampleSize) {
+    int scale = 1;
+    while (scale < 8 && 0 == sampleSize % (scale << 1)) {
+        scale <<= 1;
+    }
+    if (1 == scale) {
+        while (scale < 8 && (scale << 1) <= sampleSize) {
+            scale <<= 1;
+        }
+    }
+    return scale;
 }
 
 static bool skip_src_rows(jpeg_decompress_struct* cinfo, void* buffer,
@@ -141,6 +172,61 @@ static bool skip_src_rows(jpeg_decompress_struct* cinfo, void* buffer,
     return true;
 }
 
+// Return false if we cannot sample the colorspace that libjpeg will output.
+static bool get_src_config(const jpeg_decompress_struct& cinfo,
+                           SkScaledBitmapSampler::SrcConfig* sc,
+                           int* srcBytesPerPixel) {
+    if (3 == cinfo.out_color_components && JCS_RGB == cinfo.out_color_space) {
+        *sc = SkScaledBitmapSampler::kRGB;
+        *srcBytesPerPixel = 3;
+#ifdef ANDROID_RGB
+    } else if (JCS_RGBA_8888 == cinfo.out_color_space) {
+        *sc = SkScaledBitmapSampler::kRGBX;
+        *srcBytesPerPixel = 4;
+    } else if (JCS_RGB_565 == cinfo.out_color_space) {
+        *sc = SkScaledBitmapSampler::kRGB_565;
+        *srcBytesPerPixel = 2;
+#endif
+    } else if (1 == cinfo.out_color_components &&
+               JCS_GRAYSCALE == cinfo.out_color_space) {
+        *sc = SkScaledBitmapSampler::kGray;
+        *srcBytesPerPixel = 1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#if defined(SK_JPEG_8888_COLOR_SPACE) || defined(SK_JPEG_565_COLOR_SPACE)
+/*  Ask libjpeg-turbo to write rows directly in our pixel format. Returns false
+    (leaving cinfo alone) if it can't for this config or source colorspace.
+*/
+static bool set_direct_color_space(jpeg_decompress_struct* cinfo,
+                                   SkBitmap::Config config, bool dither) {
+    // turbo only converts these to its extended colorspaces (no CMYK/YCCK)
+    if (JCS_YCbCr != cinfo->jpeg_color_space &&
+        JCS_RGB != cinfo->jpeg_color_space &&
+        JCS_GRAYSCALE != cinfo->jpeg_color_space) {
+        return false;
+    }
+#ifdef SK_JPEG_8888_COLOR_SPACE
+    if (SkBitmap::kARGB_8888_Config == config) {
+        cinfo->out_color_space = SK_JPEG_8888_COLOR_SPACE;
+        return true;
+    }
+#endif
+#ifdef SK_JPEG_565_COLOR_SPACE
+    if (SkBitmap::kRGB_565_Config == config) {
+        cinfo->out_color_space = SK_JPEG_565_COLOR_SPACE;
+        // turbo dithers 565 whenever dither_mode is not NONE
+        cinfo->dither_mode = dither ? JDITHER_ORDERED : JDITHER_NONE;
+        return true;
+    }
+#endif
+    return false;
+}
+#endif
+
 // This guy exists just to aid in debugging, as it allows debuggers to just
 // set a break-point in one place to see all error exists.
 static bool return_false(const jpeg_decompress_struct& cinfo,
@@ -153,6 +239,47 @@ static bool return_false(const jpeg_decompress_struct& cinfo,
     return false;   // must always return false
 }
 
+// Set the decompression parameters (after jpeg_read_header), and return the
+// config that we will decode into.
+SkBitmap::Config SkJPEGImageDecoder::setUpDecompress(
+                                jpeg_decompress_struct* cinfo, int dctScale) {
+    cinfo->dct_method = JDCT_IFAST;
+    cinfo->scale_num = 1;
+    cinfo->scale_denom = dctScale;
+
+    /* this gives about 30% performance improvement. In theory it may
+       reduce the visual quality, in practice I'm not seeing a difference
+     */
+    cinfo->do_fancy_upsampling = 0;
+
+    /* this gives another few percents */
+    cinfo->do_block_smoothing = 0;
+
+    /* default format is RGB */
+    cinfo->out_color_space = JCS_RGB;
+
+    SkBitmap::Config config = this->getPrefConfig(k32Bit_SrcDepth, false);
+    // only these make sense for jpegs
+    if (config != SkBitmap::kARGB_8888_Config &&
+        config != SkBitmap::kARGB_4444_Config &&
+        config != SkBitmap::kRGB_565_Config) {
+        config = SkBitmap::kARGB_8888_Config;
+    }
+
+#ifdef ANDROID_RGB
+    cinfo->dither_mode = JDITHER_NONE;
+    if (config == SkBitmap::kARGB_8888_Config) {
+        cinfo->out_color_space = JCS_RGBA_8888;
+    } else if (config == SkBitmap::kRGB_565_Config) {
+        cinfo->out_color_space = JCS_RGB_565;
+        if (this->getDitherImage()) {
+            cinfo->dither_mode = JDITHER_ORDERED;
+        }
+    }
+#endif
+    return config;
+}
+
 bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 #ifdef TIME_DECODE
     AutoTimeMillis atm("JPEG Decode");
@@ -190,78 +317,42 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     }
 
     /*  Try to fulfill the requested sampleSize. Since jpeg can do it (when it
-        can) much faster that we, just use their num/denom api to approximate
-        the size.
+        can) much faster that we, let its num/denom api do as much of it as
+        possible, and sample what remains ourselves.
     */
-    int sampleSize = this->getSampleSize();
-
-    cinfo.dct_method = JDCT_IFAST;
-    cinfo.scale_num = 1;
-    cinfo.scale_denom = sampleSize;
-
-    /* this gives about 30% performance improvement. In theory it may
-       reduce the visual quality, in practice I'm not seeing a difference
-     */
-    cinfo.do_fancy_upsampling = 0;
-
-    /* this gives another few percents */
-    cinfo.do_block_smoothing = 0;
+    const int dctScale = compute_dct_scale(this->getSampleSize());
+    const int sampleSize = SkMax32(this->getSampleSize() / dctScale, 1);
 
-    /* default format is RGB */
-    cinfo.out_color_space = JCS_RGB;
-
-    SkBitmap::Config config = this->getPrefConfig(k32Bit_SrcDepth, false);
-    // only these make sense for jpegs
-    if (config != SkBitmap::kARGB_8888_Config &&
-        config != SkBitmap::kARGB_4444_Config &&
-        config != SkBitmap::kRGB_565_Config) {
-        config = SkBitmap::kARGB_8888_Config;
-    }
+    SkBitmap::Config config = this->setUpDecompress(&cinfo, dctScale);
 
-#ifdef ANDROID_RGB
-    cinfo.dither_mode = JDITHER_NONE;
-    if (config == SkBitmap::kARGB_8888_Config) {
-        cinfo.out_color_space = JCS_RGBA_8888;
-    } else if (config == SkBitmap::kRGB_565_Config) {
-        cinfo.out_color_space = JCS_RGB_565;
-        if (this->getDitherImage()) {
-            cinfo.dither_mode = JDITHER_ORDERED;
-        }
-    }
-#endif
-
-    if (sampleSize == 1 && mode == SkImageDecoder::kDecodeBounds_Mode) {
-        bm->setConfig(config, cinfo.image_width, cinfo.image_height);
+    if (SkImageDecoder::kDecodeBounds_Mode == mode) {
+        // this computes the scaled size without starting the decompressor
+        jpeg_calc_output_dimensions(&cinfo);
+        SkScaledBitmapSampler smpl(cinfo.output_width, cinfo.output_height,
+                                   sampleSize);
+        bm->setConfig(config, smpl.scaledWidth(), smpl.scaledHeight());
         bm->setIsOpaque(true);
         return true;
     }
 
-    /*  image_width and image_height are the original dimensions, available
-        after jpeg_read_header(). To see the scaled dimensions, we have to call
-        jpeg_start_decompress(), and then read output_width and output_height.
+    /* short-circuit the SkScaledBitmapSampler when possible, as this gives
+       a significant performance boost.
     */
+    bool directDecode = false;
+#ifdef ANDROID_RGB
+    directDecode = sampleSize == 1 &&
+        ((config == SkBitmap::kARGB_8888_Config && 
+                cinfo.out_color_space == JCS_RGBA_8888) ||
+        (config == SkBitmap::kRGB_565_Config && 
+                cinfo.out_color_space == JCS_RGB_565));
+#elif defined(SK_JPEG_8888_COLOR_SPACE) || defined(SK_JPEG_565_COLOR_SPACE)
+    directDecode = sampleSize == 1 &&
+        set_direct_color_space(&cinfo, config, this->getDitherImage());
+#endif
+
     if (!jpeg_start_decompress(&cinfo)) {
-        /*  If we failed here, we may still have enough information to return
-            to the caller if they just wanted (subsampled bounds). If sampleSize
-            was 1, then we would have already returned. Thus we just check if
-            we're in kDecodeBounds_Mode, and that we have valid output sizes.
-
-            One reason to fail here is that we have insufficient stream data
-            to complete the setup. However, output dimensions seem to get
-            computed very early, which is why this special check can pay off.
-         */
-        if (SkImageDecoder::kDecodeBounds_Mode == mode &&
-                valid_output_dimensions(cinfo)) {
-            SkScaledBitmapSampler smpl(cinfo.output_width, cinfo.output_height,
-                                       recompute_sampleSize(sampleSize, cinfo));
-            bm->setConfig(config, smpl.scaledWidth(), smpl.scaledHeight());
-            bm->setIsOpaque(true);
-            return true;
-        } else {
-            return return_false(cinfo, *bm, "start_decompress");
-        }
+        return return_false(cinfo, *bm, "start_decompress");
     }
-    sampleSize = recompute_sampleSize(sampleSize, cinfo);
 
     // should we allow the Chooser (if present) to pick a config for us???
     if (!this->chooseFromOneChoice(config, cinfo.output_width,
@@ -269,21 +360,9 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
         return return_false(cinfo, *bm, "chooseFromOneChoice");
     }
 
-#ifdef ANDROID_RGB
-    /* short-circuit the SkScaledBitmapSampler when possible, as this gives
-       a significant performance boost.
-    */
-    if (sampleSize == 1 &&
-        ((config == SkBitmap::kARGB_8888_Config && 
-                cinfo.out_color_space == JCS_RGBA_8888) ||
-        (config == SkBitmap::kRGB_565_Config && 
-                cinfo.out_color_space == JCS_RGB_565)))
-    {
+    if (directDecode) {
         bm->setConfig(config, cinfo.output_width, cinfo.output_height);
         bm->setIsOpaque(true);
-        if (SkImageDecoder::kDecodeBounds_Mode == mode) {
-            return true;
-        }
         if (!this->allocPixelRef(bm, NULL)) {
             return return_false(cinfo, *bm, "allocPixelRef");
         }
@@ -306,22 +385,11 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
         jpeg_finish_decompress(&cinfo);
         return true;
     }
-#endif
     
     // check for supported formats
     SkScaledBitmapSampler::SrcConfig sc;
-    if (3 == cinfo.out_color_components && JCS_RGB == cinfo.out_color_space) {
-        sc = SkScaledBitmapSampler::kRGB;
-#ifdef ANDROID_RGB
-    } else if (JCS_RGBA_8888 == cinfo.out_color_space) {
-        sc = SkScaledBitmapSampler::kRGBX;
-    } else if (JCS_RGB_565 == cinfo.out_color_space) {
-        sc = SkScaledBitmapSampler::kRGB_565;
-#endif
-    } else if (1 == cinfo.out_color_components &&
-               JCS_GRAYSCALE == cinfo.out_color_space) {
-        sc = SkScaledBitmapSampler::kGray;
-    } else {
+    int srcBytesPerPixel;
+    if (!get_src_config(cinfo, &sc, &srcBytesPerPixel)) {
         return return_false(cinfo, *bm, "jpeg colorspace");
     }
 
@@ -332,9 +400,6 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     // jpegs are always opauqe (i.e. have no per-pixel alpha)
     bm->setIsOpaque(true);
 
-    if (SkImageDecoder::kDecodeBounds_Mode == mode) {
-        return true;
-    }
     if (!this->allocPixelRef(bm, NULL)) {
         return return_false(cinfo, *bm, "allocPixelRef");
     }
@@ -384,6 +449,148 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     return true;
 }
 
+bool SkJPEGImageDecoder::onBuildTileIndex(SkStream* stream, int* width,
+                                          int* height) {
+    JPEGAutoClean autoClean;
+
+    jpeg_decompress_struct  cinfo;
+    skjpeg_error_mgr        sk_err;
+    skjpeg_source_mgr       sk_stream(stream, this);
+
+    cinfo.err = jpeg_std_error(&sk_err);
+    sk_err.error_exit = skjpeg_error_exit;
+
+    if (setjmp(sk_err.fJmpBuf)) {
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    autoClean.set(&cinfo);
+    cinfo.src = &sk_stream;
+
+    if (jpeg_read_header(&cinfo, true) != JPEG_HEADER_OK) {
+        return false;
+    }
+    *width = cinfo.image_width;
+    *height = cinfo.image_height;
+    SkRefCnt_SafeAssign(fTileStream, stream);
+    return true;
+}
+
+/*  libjpeg can only produce the scanlines in order, so we decode them down to
+    the bottom of the region and then abort, and only convert the columns that
+    are inside the region. The IDCT scaling is used as in onDecode(), so a
+    sampled region is also cheaper to decode.
+ */
+bool SkJPEGImageDecoder::onDecodeRegion(SkBitmap* bm, const SkIRect& rect) {
+    if (NULL == fTileStream || !fTileStream->rewind()) {
+        return false;
+    }
+    this->prefetchRegion(fTileStream, rect);
+
+    SkAutoMalloc  srcStorage;
+    JPEGAutoClean autoClean;
+
+    jpeg_decompress_struct  cinfo;
+    skjpeg_error_mgr        sk_err;
+    skjpeg_source_mgr       sk_stream(fTileStream, this);
+
+    cinfo.err = jpeg_std_error(&sk_err);
+    sk_err.error_exit = skjpeg_error_exit;
+
+    if (setjmp(sk_err.fJmpBuf)) {
+        return return_false(cinfo, *bm, "setjmp");
+    }
+
+    jpeg_create_decompress(&cinfo);
+    autoClean.set(&cinfo);
+
+#ifdef ANDROID
+    overwrite_mem_buffer_size(&cinfo);
+#endif
+
+    cinfo.src = &sk_stream;
+
+    if (jpeg_read_header(&cinfo, true) != JPEG_HEADER_OK) {
+        return return_false(cinfo, *bm, "read_header");
+    }
+    if (rect.fRight > (int)cinfo.image_width ||
+            rect.fBottom > (int)cinfo.image_height) {
+        // not the stream that we built the index for
+        return return_false(cinfo, *bm, "region");
+    }
+
+    const int dctScale = compute_dct_scale(this->getSampleSize());
+    const int sampleSize = SkMax32(this->getSampleSize() / dctScale, 1);
+    SkBitmap::Config config = this->setUpDecompress(&cinfo, dctScale);
+
+    if (!jpeg_start_decompress(&cinfo)) {
+        return return_false(cinfo, *bm, "start_decompress");
+    }
+
+    SkScaledBitmapSampler::SrcConfig sc;
+    int srcBytesPerPixel;
+    if (!get_src_config(cinfo, &sc, &srcBytesPerPixel)) {
+        return return_false(cinfo, *bm, "jpeg colorspace");
+    }
+
+    // the region in the (IDCT scaled) output's coordinates
+    SkIRect outRect;
+    outRect.set(rect.fLeft / dctScale, rect.fTop / dctScale,
+                (rect.fRight + dctScale - 1) / dctScale,
+                (rect.fBottom + dctScale - 1) / dctScale);
+    if (!outRect.intersect(0, 0, cinfo.output_width, cinfo.output_height)) {
+        return return_false(cinfo, *bm, "region");
+    }
+
+    SkScaledBitmapSampler sampler(outRect.width(), outRect.height(),
+                                  sampleSize);
+
+    bm->setConfig(config, sampler.scaledWidth(), sampler.scaledHeight());
+    // jpegs are always opauqe (i.e. have no per-pixel alpha)
+    bm->setIsOpaque(true);
+
+    if (!this->allocPixelRef(bm, NULL)) {
+        return return_false(cinfo, *bm, "allocPixelRef");
+    }
+
+    SkAutoLockPixels alp(*bm);
+    if (!sampler.begin(bm, sc, this->getDitherImage())) {
+        return return_false(cinfo, *bm, "sampler.begin");
+    }
+
+    uint8_t* srcRow = (uint8_t*)srcStorage.alloc(cinfo.output_width * 4);
+    const uint8_t* srcLeft = srcRow + outRect.fLeft * srcBytesPerPixel;
+
+    if (!skip_src_rows(&cinfo, srcRow, outRect.fTop + sampler.srcY0())) {
+        return return_false(cinfo, *bm, "skip rows");
+    }
+
+    for (int y = 0;; y++) {
+        JSAMPLE* rowptr = (JSAMPLE*)srcRow;
+        int row_count = jpeg_read_scanlines(&cinfo, &rowptr, 1);
+        if (0 == row_count) {
+            return return_false(cinfo, *bm, "read_scanlines");
+        }
+        if (this->shouldCancelDecode()) {
+            return return_false(cinfo, *bm, "shouldCancelDecode");
+        }
+
+        sampler.next(srcLeft);
+        if (bm->height() - 1 == y) {
+            break;
+        }
+
+        if (!skip_src_rows(&cinfo, srcRow, sampler.srcDY() - 1)) {
+            return return_false(cinfo, *bm, "skip rows");
+        }
+    }
+
+    // nothing below the region is needed, so don't decode it
+    jpeg_abort_decompress(&cinfo);
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkColorPriv.h"
@@ -21,6 +21,7 @@
 #include "SkColorPriv.h"
 #include "SkDither.h"
 #include "SkMath.h"
+#include "SkRunnable.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
@@ -28,16 +29,44 @@
 
 extern "C" {
 #include "png.h"
+#include "zlib.h"
 }
 
 class SkPNGImageDecoder : public SkImageDecoder {
 public:
+    SkPNGImageDecoder() : fTileStream(NULL), fIncremental(NULL) {}
+    virtual ~SkPNGImageDecoder();
+
     virtual Format getFormat() const {
         return kPNG_Format;
     }
     
 protected:
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode);
+    virtual bool onBuildTileIndex(SkStream*, int* width, int* height);
+    virtual bool onDecodeRegion(SkBitmap* bm, const SkIRect& rect);
+    virtual bool onBeginIncremental();
+    virtual IncrementalResult onPushIncremental(const void* data, size_t size);
+
+private:
+    struct Incremental;
+
+    SkStream*       fTileStream;    // set by onBuildTileIndex
+    Incremental*    fIncremental;   // set by onBeginIncremental
+
+    // libpng's progressive reader callbacks
+    static void IncrementalInfo(png_structp, png_infop);
+    static void IncrementalRow(png_structp, png_bytep, png_uint_32 row,
+                               int pass);
+    static void IncrementalEnd(png_structp, png_infop);
+    void sampleIncrementalPass();
+
+    bool onDecodeInit(SkStream*, png_structp*, png_infop*);
+    bool getBitmapConfig(png_structp, png_infop, SkBitmap::Config*,
+                         bool* hasAlpha, bool* doDither,
+                         SkPMColor* theTranspColor);
+    bool decodePalette(png_structp, png_infop, bool* hasAlpha,
+                       bool* reallyHasAlpha, SkColorTable**);
 };
 
 #ifndef png_jmpbuf
@@ -135,10 +164,39 @@ static bool hasTransparencyInPalette(png_structp png_ptr, png_infop info_ptr) {
     return false;
 }
 
-bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
-                                 Mode mode) {
-//    SkAutoTrace    apr("SkPNGImageDecoder::onDecode");
+// the transforms that every decode needs, once the header has been read
+static void set_up_transforms(png_structp png_ptr, png_infop info_ptr) {
+    png_uint_32 origWidth, origHeight;
+    int bit_depth, color_type;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth,
+                 &color_type, NULL, NULL, NULL);
 
+    /* tell libpng to strip 16 bit/color files down to 8 bits/color */
+    if (bit_depth == 16) {
+        png_set_strip_16(png_ptr);
+    }
+    /* Extract multiple pixels with bit depths of 1, 2, and 4 from a single
+     * byte into separate bytes (useful for paletted and grayscale images). */
+    if (bit_depth < 8) {
+        png_set_packing(png_ptr);
+    }
+    /* Expand grayscale images to the full 8 bits from 1, 2, or 4 bits/pixel */
+    if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8) {
+        png_set_expand_gray_1_2_4_to_8(png_ptr);
+    }
+    
+    /* Make a grayscale image into RGB. */
+    if (color_type == PNG_COLOR_TYPE_GRAY ||
+        color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+        png_set_gray_to_rgb(png_ptr);
+    }
+}
+
+// Create the read structs for the stream, read its header, and set up the
+// transforms that every decode needs. On success the caller owns the structs
+// (and must set its own setjmp before calling libpng again).
+bool SkPNGImageDecoder::onDecodeInit(SkStream* sk_stream, png_structp* png_ptrp,
+                                     png_infop* info_ptrp) {
     /* Create and initialize the png_struct with the desired error handler
     * functions.  If you want to use the default stderr and longjump method,
     * you can supply NULL for the last three parameters.  We also supply the
@@ -150,6 +208,7 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
     if (png_ptr == NULL) {
         return false;
     }
+    *png_ptrp = png_ptr;
 
     /* Allocate/initialize the memory for image information. */
     png_infop info_ptr = png_create_info_struct(png_ptr);
@@ -157,14 +216,14 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
         png_destroy_read_struct(&png_ptr, NULL, NULL);
         return false;
     }
-
-    PNGAutoClean autoClean(png_ptr, info_ptr);
+    *info_ptrp = info_ptr;
 
     /* Set error handling if you are using the setjmp/longjmp method (this is
     * the normal method of doing things with libpng).  REQUIRED unless you
     * set up your own error handlers in the png_create_read_struct() earlier.
     */
     if (setjmp(png_jmpbuf(png_ptr))) {
+        png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
         return false;
     }
 
@@ -185,31 +244,19 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
     /* The call to png_read_info() gives us all of the information from the
     * PNG file before the first IDAT (image data chunk). */
     png_read_info(png_ptr, info_ptr);
+    set_up_transforms(png_ptr, info_ptr);
+    return true;
+}
+
+bool SkPNGImageDecoder::getBitmapConfig(png_structp png_ptr, png_infop info_ptr,
+                                        SkBitmap::Config* configp,
+                                        bool* hasAlphap, bool* doDitherp,
+                                        SkPMColor* theTranspColorp) {
     png_uint_32 origWidth, origHeight;
-    int bit_depth, color_type, interlace_type;
-    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth, &color_type,
-        &interlace_type, NULL, NULL);
+    int bit_depth, color_type;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth,
+                 &color_type, NULL, NULL, NULL);
 
-    /* tell libpng to strip 16 bit/color files down to 8 bits/color */
-    if (bit_depth == 16) {
-        png_set_strip_16(png_ptr);
-    }
-    /* Extract multiple pixels with bit depths of 1, 2, and 4 from a single
-     * byte into separate bytes (useful for paletted and grayscale images). */
-    if (bit_depth < 8) {
-        png_set_packing(png_ptr);
-    }
-    /* Expand grayscale images to the full 8 bits from 1, 2, or 4 bits/pixel */
-    if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8) {
-        png_set_expand_gray_1_2_4_to_8(png_ptr);
-    }
-    
-    /* Make a grayscale image into RGB. */
-    if (color_type == PNG_COLOR_TYPE_GRAY ||
-        color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
-        png_set_gray_to_rgb(png_ptr);
-    }
-        
     SkBitmap::Config    config;
     bool                hasAlpha = false;
     bool                doDither = this->getDitherImage();
@@ -312,6 +359,113 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
     if (!this->chooseFromOneChoice(config, origWidth, origHeight)) {
         return false;
     }
+
+    *configp = config;
+    *hasAlphap = hasAlpha;
+    *doDitherp = doDither;
+    *theTranspColorp = theTranspColor;
+    return true;
+}
+
+// call only if color_type is PALETTE. Returns the colortable (which the caller
+// must unref), and accumulates into reallyHasAlphap whether it has any alpha.
+bool SkPNGImageDecoder::decodePalette(png_structp png_ptr, png_infop info_ptr,
+                                      bool* hasAlphap, bool* reallyHasAlphap,
+                                      SkColorTable** colorTablep) {
+    int num_palette;
+    png_colorp palette;
+    png_bytep trans;
+    int num_trans;
+    bool reallyHasAlpha = false;
+    SkColorTable* colorTable = NULL;
+
+    png_get_PLTE(png_ptr, info_ptr, &palette, &num_palette);
+    
+    /*  BUGGY IMAGE WORKAROUND
+        
+        We hit some images (e.g. fruit_.png) who contain bytes that are == colortable_count
+        which is a problem since we use the byte as an index. To work around this we grow
+        the colortable by 1 (if its < 256) and duplicate the last color into that slot.
+    */
+    int colorCount = num_palette + (num_palette < 256);
+
+    colorTable = SkNEW_ARGS(SkColorTable, (colorCount));
+
+    SkPMColor* colorPtr = colorTable->lockColors();
+    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
+        png_get_tRNS(png_ptr, info_ptr, &trans, &num_trans, NULL);
+        *hasAlphap = (num_trans > 0);
+    } else {
+        num_trans = 0;
+        colorTable->setFlags(colorTable->getFlags() | SkColorTable::kColorsAreOpaque_Flag);
+    }        
+    // check for bad images that might make us crash
+    if (num_trans > num_palette) {
+        num_trans = num_palette;
+    }
+
+    int index = 0;
+    int transLessThanFF = 0;
+
+    for (; index < num_trans; index++) {
+        transLessThanFF |= (int)*trans - 0xFF;
+        *colorPtr++ = SkPreMultiplyARGB(*trans++, palette->red, palette->green, palette->blue);
+        palette++;
+    }
+    reallyHasAlpha |= (transLessThanFF < 0);
+    if (!reallyHasAlpha) {
+        // a tRNS chunk of all 0xFF is still opaque, which lets kIndex8 draws
+        // take the opaque sprite and shader procs
+        colorTable->setFlags(colorTable->getFlags() | SkColorTable::kColorsAreOpaque_Flag);
+    }
+
+    for (; index < num_palette; index++) {
+        *colorPtr++ = SkPackARGB32(0xFF, palette->red, palette->green, palette->blue);
+        palette++;
+    }
+
+    // see BUGGY IMAGE WORKAROUND comment above
+    if (num_palette < 256) {
+        *colorPtr = colorPtr[-1];
+    }
+    colorTable->unlockColors(true);
+
+    *reallyHasAlphap |= reallyHasAlpha;
+    *colorTablep = colorTable;
+    return true;
+}
+
+bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
+                                 Mode mode) {
+//    SkAutoTrace    apr("SkPNGImageDecoder::onDecode");
+
+    png_structp png_ptr;
+    png_infop info_ptr;
+
+    if (!this->onDecodeInit(sk_stream, &png_ptr, &info_ptr)) {
+        return false;
+    }
+
+    PNGAutoClean autoClean(png_ptr, info_ptr);
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        return false;
+    }
+
+    png_uint_32 origWidth, origHeight;
+    int bit_depth, color_type, interlace_type;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth, &color_type,
+        &interlace_type, NULL, NULL);
+
+    SkBitmap::Config    config;
+    bool                hasAlpha = false;
+    bool                doDither = this->getDitherImage();
+    SkPMColor           theTranspColor = 0; // 0 tells us not to try to match
+
+    if (!this->getBitmapConfig(png_ptr, info_ptr, &config, &hasAlpha,
+                               &doDither, &theTranspColor)) {
+        return false;
+    }
     
     const int sampleSize = this->getSampleSize();
     SkScaledBitmapSampler sampler(origWidth, origHeight, sampleSize);
@@ -331,56 +485,8 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
     SkColorTable* colorTable = NULL;
 
     if (color_type == PNG_COLOR_TYPE_PALETTE) {
-        int num_palette;
-        png_colorp palette;
-        png_bytep trans;
-        int num_trans;
-
-        png_get_PLTE(png_ptr, info_ptr, &palette, &num_palette);
-        
-        /*  BUGGY IMAGE WORKAROUND
-            
-            We hit some images (e.g. fruit_.png) who contain bytes that are == colortable_count
-            which is a problem since we use the byte as an index. To work around this we grow
-            the colortable by 1 (if its < 256) and duplicate the last color into that slot.
-        */
-        int colorCount = num_palette + (num_palette < 256);
-
-        colorTable = SkNEW_ARGS(SkColorTable, (colorCount));
-
-        SkPMColor* colorPtr = colorTable->lockColors();
-        if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
-            png_get_tRNS(png_ptr, info_ptr, &trans, &num_trans, NULL);
-            hasAlpha = (num_trans > 0);
-        } else {
-            num_trans = 0;
-            colorTable->setFlags(colorTable->getFlags() | SkColorTable::kColorsAreOpaque_Flag);
-        }        
-        // check for bad images that might make us crash
-        if (num_trans > num_palette) {
-            num_trans = num_palette;
-        }
-
-        int index = 0;
-        int transLessThanFF = 0;
-
-        for (; index < num_trans; index++) {
-            transLessThanFF |= (int)*trans - 0xFF;
-            *colorPtr++ = SkPreMultiplyARGB(*trans++, palette->red, palette->green, palette->blue);
-            palette++;
-        }
-        reallyHasAlpha |= (transLessThanFF < 0);
-
-        for (; index < num_palette; index++) {
-            *colorPtr++ = SkPackARGB32(0xFF, palette->red, palette->green, palette->blue);
-            palette++;
-        }
-
-        // see BUGGY IMAGE WORKAROUND comment above
-        if (num_palette < 256) {
-            *colorPtr = colorPtr[-1];
-        }
-        colorTable->unlockColors(true);
+        this->decodePalette(png_ptr, info_ptr, &hasAlpha, &reallyHasAlpha,
+                            &colorTable);
     }
     
     SkAutoUnref aur(colorTable);
@@ -499,6 +605,413 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
     return true;
 }
 
+bool SkPNGImageDecoder::onBuildTileIndex(SkStream* sk_stream, int* width,
+                                         int* height) {
+    png_structp png_ptr;
+    png_infop info_ptr;
+
+    if (!this->onDecodeInit(sk_stream, &png_ptr, &info_ptr)) {
+        return false;
+    }
+    png_uint_32 origWidth, origHeight;
+    int bit_depth, color_type;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth,
+                 &color_type, NULL, NULL, NULL);
+    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+
+    *width = origWidth;
+    *height = origHeight;
+    SkRefCnt_SafeAssign(fTileStream, sk_stream);
+    return true;
+}
+
+/*  libpng can only read the rows in order, so we decode them down to the
+    bottom of the region (and no further), but only store the ones inside it,
+    and only convert their columns that are inside it.
+ */
+bool SkPNGImageDecoder::onDecodeRegion(SkBitmap* bm, const SkIRect& rect) {
+    if (NULL == fTileStream || !fTileStream->rewind()) {
+        return false;
+    }
+    this->prefetchRegion(fTileStream, rect);
+
+    png_structp png_ptr;
+    png_infop info_ptr;
+
+    if (!this->onDecodeInit(fTileStream, &png_ptr, &info_ptr)) {
+        return false;
+    }
+
+    PNGAutoClean autoClean(png_ptr, info_ptr);
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        return false;
+    }
+
+    png_uint_32 origWidth, origHeight;
+    int bit_depth, color_type, interlace_type;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth,
+                 &color_type, &interlace_type, NULL, NULL);
+    if (rect.fRight > (int)origWidth || rect.fBottom > (int)origHeight) {
+        // not the stream that we built the index for
+        return false;
+    }
+
+    SkBitmap::Config    config;
+    bool                hasAlpha = false;
+    bool                doDither = this->getDitherImage();
+    SkPMColor           theTranspColor = 0; // 0 tells us not to try to match
+
+    if (!this->getBitmapConfig(png_ptr, info_ptr, &config, &hasAlpha,
+                               &doDither, &theTranspColor)) {
+        return false;
+    }
+
+    SkScaledBitmapSampler sampler(rect.width(), rect.height(),
+                                  this->getSampleSize());
+    bm->setConfig(config, sampler.scaledWidth(), sampler.scaledHeight(), 0);
+
+    bool reallyHasAlpha = false;
+    SkColorTable* colorTable = NULL;
+
+    if (color_type == PNG_COLOR_TYPE_PALETTE) {
+        this->decodePalette(png_ptr, info_ptr, &hasAlpha, &reallyHasAlpha,
+                            &colorTable);
+    }
+
+    SkAutoUnref aur(colorTable);
+
+    if (!this->allocPixelRef(bm, SkBitmap::kIndex8_Config == config ?
+                                    colorTable : NULL)) {
+        return false;
+    }
+
+    SkAutoLockPixels alp(*bm);
+
+    if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY) {
+        png_set_filler(png_ptr, 0xff, PNG_FILLER_AFTER);
+    }
+
+    const int number_passes = interlace_type != PNG_INTERLACE_NONE ?
+                        png_set_interlace_handling(png_ptr) : 1;
+
+    png_read_update_info(png_ptr, info_ptr);
+
+    SkScaledBitmapSampler::SrcConfig sc;
+    int srcBytesPerPixel = 4;
+
+    if (colorTable != NULL) {
+        sc = SkScaledBitmapSampler::kIndex;
+        srcBytesPerPixel = 1;
+    } else if (hasAlpha) {
+        sc = SkScaledBitmapSampler::kRGBA;
+    } else {
+        sc = SkScaledBitmapSampler::kRGBX;
+    }
+
+    SkAutoLockColors ctLock(colorTable);
+    if (!sampler.begin(bm, sc, doDither, ctLock.colors())) {
+        return false;
+    }
+
+    const int height = bm->height();
+    const size_t rb = origWidth * srcBytesPerPixel;
+    const size_t left = rect.fLeft * srcBytesPerPixel;
+
+    if (number_passes > 1) {
+        // each pass fills in more of every row, so we keep the region's rows
+        // for all of the passes, and throw the others away
+        SkAutoMalloc storage((rect.height() + 1) * rb);
+        uint8_t* base = (uint8_t*)storage.get();
+        uint8_t* scratch = base + rect.height() * rb;
+
+        for (int i = 0; i < number_passes; i++) {
+            // the last pass can stop at the bottom of the region
+            const int rows = (i == number_passes - 1) ? rect.fBottom :
+                                                        (int)origHeight;
+            for (int y = 0; y < rows; y++) {
+                uint8_t* bmRow = scratch;
+                if (y >= rect.fTop && y < rect.fBottom) {
+                    bmRow = base + (y - rect.fTop) * rb;
+                }
+                png_read_rows(png_ptr, &bmRow, NULL, 1);
+            }
+            if (this->shouldCancelDecode()) {
+                return false;
+            }
+        }
+        base += sampler.srcY0() * rb + left;
+        for (int y = 0; y < height; y++) {
+            reallyHasAlpha |= sampler.next(base);
+            base += sampler.srcDY() * rb;
+        }
+    } else {
+        SkAutoMalloc storage(rb);
+        uint8_t* srcRow = (uint8_t*)storage.get();
+        skip_src_rows(png_ptr, srcRow, rect.fTop + sampler.srcY0());
+
+        for (int y = 0; y < height; y++) {
+            uint8_t* tmp = srcRow;
+            png_read_rows(png_ptr, &tmp, NULL, 1);
+            reallyHasAlpha |= sampler.next(srcRow + left);
+            if (y < height - 1) {
+                skip_src_rows(png_ptr, srcRow, sampler.srcDY() - 1);
+            }
+            if (this->shouldCancelDecode()) {
+                return false;
+            }
+        }
+    }
+
+    // we do not read the rest of the image (or call png_read_end), since
+    // nothing below the region can change it
+
+    if (0 != theTranspColor) {
+        reallyHasAlpha |= substituteTranspColor(bm, theTranspColor);
+    }
+    bm->setIsOpaque(!reallyHasAlpha);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the state of an incremental decode, between calls to onPushIncremental
+struct SkPNGImageDecoder::Incremental {
+    png_structp             fPng;
+    png_infop               fInfo;
+    SkScaledBitmapSampler*  fSampler;   // NULL until the header is decoded
+    SkColorTable*           fColorTable;
+    const SkPMColor*        fColors;    // fColorTable's, locked
+    SkAutoMalloc            fStorage;   // all the rows, if interlaced
+    size_t                  fSrcRowBytes;
+    int                     fPass;
+    int                     fNextRow;   // the next src row for the sampler
+    bool                    fInterlaced;
+    bool                    fDoDither;
+    bool                    fReallyHasAlpha;
+    SkPMColor               fTranspColor;
+    SkScaledBitmapSampler::SrcConfig fSrcConfig;
+    IncrementalResult       fResult;
+
+    Incremental() : fPng(NULL), fInfo(NULL), fSampler(NULL),
+                    fColorTable(NULL), fColors(NULL), fSrcRowBytes(0), fPass(0), fNextRow(0),
+                    fInterlaced(false), fDoDither(false),
+                    fReallyHasAlpha(false), fTranspColor(0),
+                    fResult(kPartial_IncrementalResult) {}
+
+    ~Incremental() {
+        SkDELETE(fSampler);
+        if (fColors) {
+            fColorTable->unlockColors(false);
+        }
+        SkSafeUnref(fColorTable);
+        if (fPng) {
+            png_destroy_read_struct(&fPng, &fInfo, NULL);
+        }
+    }
+};
+
+SkPNGImageDecoder::~SkPNGImageDecoder() {
+    SkSafeUnref(fTileStream);
+    if (fIncremental) {
+        if (fIncremental->fSampler) {
+            this->incrementalBitmapForWriting()->unlockPixels();
+        }
+        SkDELETE(fIncremental);
+    }
+}
+
+bool SkPNGImageDecoder::onBeginIncremental() {
+    if (fIncremental) {
+        if (fIncremental->fSampler) {
+            this->incrementalBitmapForWriting()->unlockPixels();
+        }
+        SkDELETE(fIncremental);
+        fIncremental = NULL;
+    }
+
+    png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                                 NULL, sk_error_fn, NULL);
+    if (NULL == png_ptr) {
+        return false;
+    }
+    png_infop info_ptr = png_create_info_struct(png_ptr);
+    if (NULL == info_ptr) {
+        png_destroy_read_struct(&png_ptr, NULL, NULL);
+        return false;
+    }
+
+    fIncremental = SkNEW(Incremental);
+    fIncremental->fPng = png_ptr;
+    fIncremental->fInfo = info_ptr;
+
+    png_set_keep_unknown_chunks(png_ptr, PNG_HANDLE_CHUNK_ALWAYS,
+                                (png_byte*)"", 0);
+    if (this->getPeeker()) {
+        png_set_read_user_chunk_fn(png_ptr, (png_voidp)this->getPeeker(),
+                                   sk_read_user_chunk);
+    }
+    png_set_progressive_read_fn(png_ptr, this, IncrementalInfo,
+                                IncrementalRow, IncrementalEnd);
+    return true;
+}
+
+SkImageDecoder::IncrementalResult SkPNGImageDecoder::onPushIncremental(
+                                                const void* data, size_t size) {
+    SkASSERT(fIncremental);
+    if (setjmp(png_jmpbuf(fIncremental->fPng))) {
+        return kError_IncrementalResult;
+    }
+    png_process_data(fIncremental->fPng, fIncremental->fInfo,
+                     (png_bytep)data, size);
+    if (this->shouldCancelDecode()) {
+        return kError_IncrementalResult;
+    }
+    return fIncremental->fResult;
+}
+
+// this is the first half of onDecode()
+void SkPNGImageDecoder::IncrementalInfo(png_structp png_ptr,
+                                        png_infop info_ptr) {
+    SkPNGImageDecoder* self =
+                    (SkPNGImageDecoder*)png_get_progressive_ptr(png_ptr);
+    Incremental* inc = self->fIncremental;
+
+    set_up_transforms(png_ptr, info_ptr);
+
+    png_uint_32 origWidth, origHeight;
+    int bit_depth, color_type, interlace_type;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bit_depth,
+                 &color_type, &interlace_type, NULL, NULL);
+
+    SkBitmap::Config    config;
+    bool                hasAlpha = false;
+    bool                doDither = self->getDitherImage();
+    SkPMColor           theTranspColor = 0;
+
+    if (!self->getBitmapConfig(png_ptr, info_ptr, &config, &hasAlpha,
+                               &doDither, &theTranspColor)) {
+        png_error(png_ptr, "config");
+    }
+
+    if (color_type == PNG_COLOR_TYPE_PALETTE) {
+        self->decodePalette(png_ptr, info_ptr, &hasAlpha,
+                            &inc->fReallyHasAlpha, &inc->fColorTable);
+    }
+
+    SkBitmap* bm = self->incrementalBitmapForWriting();
+    SkScaledBitmapSampler* sampler = SkNEW_ARGS(SkScaledBitmapSampler,
+                            (origWidth, origHeight, self->getSampleSize()));
+    bm->setConfig(config, sampler->scaledWidth(), sampler->scaledHeight(), 0);
+    if (!self->allocPixelRef(bm, SkBitmap::kIndex8_Config == config ?
+                                    inc->fColorTable : NULL)) {
+        SkDELETE(sampler);
+        png_error(png_ptr, "allocPixelRef");
+    }
+    // we write into the pixels for as long as the decode lasts
+    bm->lockPixels();
+    inc->fSampler = sampler;
+
+    if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY) {
+        png_set_filler(png_ptr, 0xff, PNG_FILLER_AFTER);
+    }
+    inc->fInterlaced = interlace_type != PNG_INTERLACE_NONE;
+    if (inc->fInterlaced) {
+        (void)png_set_interlace_handling(png_ptr);
+    }
+    png_read_update_info(png_ptr, info_ptr);
+
+    int srcBytesPerPixel = 4;
+    if (inc->fColorTable) {
+        inc->fSrcConfig = SkScaledBitmapSampler::kIndex;
+        srcBytesPerPixel = 1;
+    } else if (hasAlpha) {
+        inc->fSrcConfig = SkScaledBitmapSampler::kRGBA;
+    } else {
+        inc->fSrcConfig = SkScaledBitmapSampler::kRGBX;
+    }
+    inc->fSrcRowBytes = origWidth * srcBytesPerPixel;
+    inc->fDoDither = doDither;
+    inc->fTranspColor = theTranspColor;
+
+    // the sampler keeps this pointer, so lock them for the whole decode
+    if (inc->fColorTable) {
+        inc->fColors = inc->fColorTable->lockColors();
+    }
+    if (!sampler->begin(bm, inc->fSrcConfig, doDither, inc->fColors)) {
+        png_error(png_ptr, "sampler");
+    }
+    inc->fNextRow = sampler->srcY0();
+
+    if (inc->fInterlaced) {
+        // each pass fills in more of every row, so we need them all
+        inc->fStorage.alloc(origHeight * inc->fSrcRowBytes);
+        memset(inc->fStorage.get(), 0, origHeight * inc->fSrcRowBytes);
+    }
+}
+
+void SkPNGImageDecoder::IncrementalRow(png_structp png_ptr, png_bytep newRow,
+                                       png_uint_32 row, int pass) {
+    SkPNGImageDecoder* self =
+                    (SkPNGImageDecoder*)png_get_progressive_ptr(png_ptr);
+    Incremental* inc = self->fIncremental;
+
+    if (inc->fInterlaced) {
+        if (pass != inc->fPass) {
+            // show what the previous pass decoded
+            self->sampleIncrementalPass();
+            inc->fPass = pass;
+        }
+        if (newRow) {
+            uint8_t* dst = (uint8_t*)inc->fStorage.get() +
+                           row * inc->fSrcRowBytes;
+            png_progressive_combine_row(png_ptr, dst, newRow);
+        }
+        return;
+    }
+
+    if (NULL == newRow || (int)row != inc->fNextRow ||
+            self->incrementalRows() >= inc->fSampler->scaledHeight()) {
+        return;
+    }
+    inc->fReallyHasAlpha |= inc->fSampler->next(newRow);
+    inc->fNextRow += inc->fSampler->srcDY();
+    self->setIncrementalRows(self->incrementalRows() + 1);
+}
+
+// Convert all of the (interlaced) rows decoded so far.
+void SkPNGImageDecoder::sampleIncrementalPass() {
+    Incremental* inc = fIncremental;
+    SkBitmap* bm = this->incrementalBitmapForWriting();
+    inc->fSampler->begin(bm, inc->fSrcConfig, inc->fDoDither, inc->fColors);
+
+    const uint8_t* src = (const uint8_t*)inc->fStorage.get() +
+                         inc->fSampler->srcY0() * inc->fSrcRowBytes;
+    const int height = bm->height();
+    for (int y = 0; y < height; y++) {
+        inc->fReallyHasAlpha |= inc->fSampler->next(src);
+        src += inc->fSampler->srcDY() * inc->fSrcRowBytes;
+    }
+    this->setIncrementalRows(height);
+}
+
+void SkPNGImageDecoder::IncrementalEnd(png_structp png_ptr, png_infop) {
+    SkPNGImageDecoder* self =
+                    (SkPNGImageDecoder*)png_get_progressive_ptr(png_ptr);
+    Incremental* inc = self->fIncremental;
+    SkBitmap* bm = self->incrementalBitmapForWriting();
+
+    if (inc->fInterlaced) {
+        self->sampleIncrementalPass();
+    }
+    if (0 != inc->fTranspColor) {
+        inc->fReallyHasAlpha |= substituteTranspColor(bm, inc->fTranspColor);
+    }
+    bm->setIsOpaque(!inc->fReallyHasAlpha);
+    self->setIncrementalRows(bm->height());
+    inc->fResult = kComplete_IncrementalResult;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkColorPriv.h"
@@ -549,28 +1062,7 @@ static void transform_scanline_444(const char* SK_RESTRICT src, int width,
 
 static void transform_scanline_8888(const char* SK_RESTRICT src, int width,
                                     char* SK_RESTRICT dst) {
-    const SkPMColor* SK_RESTRICT srcP = (const SkPMColor*)src;
-    const SkUnPreMultiply::Scale* SK_RESTRICT table = 
-                                              SkUnPreMultiply::GetScaleTable();
-
-    for (int i = 0; i < width; i++) {
-        SkPMColor c = *srcP++;
-        unsigned a = SkGetPackedA32(c);
-        unsigned r = SkGetPackedR32(c);
-        unsigned g = SkGetPackedG32(c);
-        unsigned b = SkGetPackedB32(c);
-
-        if (0 != a && 255 != a) {
-            SkUnPreMultiply::Scale scale = table[a];
-            r = SkUnPreMultiply::ApplyScale(scale, r);
-            g = SkUnPreMultiply::ApplyScale(scale, g);
-            b = SkUnPreMultiply::ApplyScale(scale, b);
-        }
-        *dst++ = r;
-        *dst++ = g;
-        *dst++ = b;
-        *dst++ = a;
-    }
+    sk_unpremultiply_to_rgba((uint8_t*)dst, (const uint32_t*)src, width);
 }
 
 static void transform_scanline_4444(const char* SK_RESTRICT src, int width,
@@ -707,6 +1199,339 @@ static inline int pack_palette(SkColorTable* ctable,
     return num_trans;
 }
 
+/*  The filters, zlib level and zlib strategy used for each SkImageEncoder
+    speed. kDefault_Speed is what libpng does when it isn't told otherwise.
+*/
+struct PNGSettings {
+    int fFilters;
+    int fLevel;
+    int fStrategy;
+};
+
+static void get_png_settings(SkImageEncoder::Speed speed, bool palette,
+                             PNGSettings* settings) {
+    switch (speed) {
+        case SkImageEncoder::kFast_Speed:
+            settings->fFilters = PNG_FILTER_SUB;
+            settings->fLevel = Z_BEST_SPEED;
+            settings->fStrategy = Z_RLE;
+            break;
+        case SkImageEncoder::kSmallest_Speed:
+            settings->fFilters = PNG_ALL_FILTERS;
+            settings->fLevel = Z_BEST_COMPRESSION;
+            settings->fStrategy = Z_FILTERED;
+            break;
+        default:
+            settings->fFilters = PNG_ALL_FILTERS;
+            settings->fLevel = Z_DEFAULT_COMPRESSION;
+            settings->fStrategy = Z_FILTERED;
+            break;
+    }
+    if (palette) {
+        // filtering indices only scrambles them
+        settings->fFilters = PNG_FILTER_NONE;
+        settings->fStrategy = Z_DEFAULT_STRATEGY;
+    }
+}
+
+static inline int paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkAbs32(p - a);
+    int pb = SkAbs32(p - b);
+    int pc = SkAbs32(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+static inline unsigned filter_sum(uint8_t value) {
+    return value < 128 ? value : 256 - value;
+}
+
+/*  Write the filter type and the filtered bytes of row into dst, which has
+    room for size + 1 bytes, returning the sum libpng's heuristic uses to
+    pick a filter: the bytes' distance from zero, taken as signed. The
+    bytes before the first pixel, and the row above the first row, are 0.
+*/
+static unsigned filter_row(int filter, const uint8_t* SK_RESTRICT row,
+                           const uint8_t* SK_RESTRICT prev, int size, int bpp,
+                           uint8_t* SK_RESTRICT dst) {
+    *dst++ = filter;
+    unsigned sum = 0;
+    int i;
+    switch (filter) {
+        case PNG_FILTER_VALUE_SUB:
+            for (i = 0; i < bpp; i++) {
+                sum += filter_sum(dst[i] = row[i]);
+            }
+            for (; i < size; i++) {
+                sum += filter_sum(dst[i] = row[i] - row[i - bpp]);
+            }
+            break;
+        case PNG_FILTER_VALUE_UP:
+            for (i = 0; i < size; i++) {
+                sum += filter_sum(dst[i] = row[i] - prev[i]);
+            }
+            break;
+        case PNG_FILTER_VALUE_AVG:
+            for (i = 0; i < bpp; i++) {
+                sum += filter_sum(dst[i] = row[i] - (prev[i] >> 1));
+            }
+            for (; i < size; i++) {
+                sum += filter_sum(dst[i] = row[i] -
+                                           ((row[i - bpp] + prev[i]) >> 1));
+            }
+            break;
+        case PNG_FILTER_VALUE_PAETH:
+            for (i = 0; i < bpp; i++) {
+                sum += filter_sum(dst[i] = row[i] - prev[i]);
+            }
+            for (; i < size; i++) {
+                int predicted = paeth_predictor(row[i - bpp], prev[i],
+                                                prev[i - bpp]);
+                sum += filter_sum(dst[i] = row[i] - predicted);
+            }
+            break;
+        default:
+            for (i = 0; i < size; i++) {
+                sum += filter_sum(dst[i] = row[i]);
+            }
+            break;
+    }
+    return sum;
+}
+
+/*  Transforms and filters the rows of a bitmap one after the other, keeping
+    the previous row around for the filters that look at it.
+*/
+class PNGRowFilter {
+public:
+    PNGRowFilter(const SkBitmap& bitmap, transform_scanline_proc proc,
+                 int bytesPerPixel, int filters, int y)
+            : fBitmap(bitmap)
+            , fProc(proc)
+            , fBytesPerPixel(bytesPerPixel)
+            , fFilters(filters) {
+        fRowSize = bitmap.width() * bytesPerPixel;
+        fStorage.alloc(2 * fRowSize + 2 * (fRowSize + 1));
+        fPrev = (uint8_t*)fStorage.get();
+        fRow = fPrev + fRowSize;
+        fFiltered = fRow + fRowSize;
+        fBest = fFiltered + fRowSize + 1;
+
+        fSrc = (const char*)bitmap.getPixels() + y * bitmap.rowBytes();
+        if (y > 0) {
+            fProc(fSrc - bitmap.rowBytes(), bitmap.width(), (char*)fPrev);
+        } else {
+            memset(fPrev, 0, fRowSize);
+        }
+    }
+
+    // the size of each filtered row, including its filter type
+    size_t filteredSize() const { return fRowSize + 1; }
+
+    /** Filter the next row with the allowed filter that has the smallest
+        sum, as libpng picks it, and return it. It stays valid until the
+        next call.
+    */
+    const uint8_t* next() {
+        static const int gFilters[] = {
+            PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP,
+            PNG_FILTER_AVG, PNG_FILTER_PAETH
+        };
+
+        fProc(fSrc, fBitmap.width(), (char*)fRow);
+        fSrc += fBitmap.rowBytes();
+
+        unsigned bestSum = ~0U;
+        for (int f = 0; f < (int)SK_ARRAY_COUNT(gFilters); f++) {
+            if (fFilters & gFilters[f]) {
+                unsigned sum = filter_row(f, fRow, fPrev, fRowSize,
+                                          fBytesPerPixel, fFiltered);
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    SkTSwap(fFiltered, fBest);
+                }
+            }
+        }
+        SkTSwap(fPrev, fRow);
+        return fBest;
+    }
+
+private:
+    const SkBitmap&         fBitmap;
+    transform_scanline_proc fProc;
+    int                     fBytesPerPixel;
+    int                     fFilters;
+    int                     fRowSize;
+    const char*             fSrc;
+    SkAutoMalloc            fStorage;
+    uint8_t*                fPrev;      // transformed rows
+    uint8_t*                fRow;
+    uint8_t*                fFiltered;  // filtered rows
+    uint8_t*                fBest;
+};
+
+// deflate looks this far back for matches
+static const int kDeflateWindowSize = 1 << MAX_WBITS;
+
+/*  One band of rows of a PNG being encoded in parallel, filtered and
+    deflated into a raw deflate stream that ends on a byte boundary, so the
+    bands can be concatenated into the image's single zlib stream. As pigz
+    does, each band is primed with the last 32K of the band before it, so
+    splitting the image up costs next to nothing in size.
+*/
+class PNGBand : public SkRunnable {
+public:
+    const SkBitmap*         fBitmap;
+    transform_scanline_proc fProc;
+    int                     fBytesPerPixel;
+    const PNGSettings*      fSettings;
+    int                     fTop;
+    int                     fBottom;
+    bool                    fLast;
+    size_t                  fOffset;    // bytes reserved before the stream
+
+    SkAutoMalloc            fData;
+    size_t                  fSize;      // bytes written, including fOffset
+    uLong                   fAdler;     // of the filtered rows
+    bool                    fSuccess;
+
+    virtual void run() {
+        fSuccess = this->encode();
+    }
+
+private:
+    bool encode() {
+        z_stream zstream;
+        memset(&zstream, 0, sizeof(zstream));
+        if (Z_OK != deflateInit2(&zstream, fSettings->fLevel, Z_DEFLATED,
+                                 -MAX_WBITS, 8, fSettings->fStrategy)) {
+            return false;
+        }
+
+        // filter the end of the previous band again, to get its window
+        size_t rowSize = fBitmap->width() * fBytesPerPixel + 1;
+        int dictRows = SkMin32(fTop,
+                        (int)((kDeflateWindowSize + rowSize - 1) / rowSize));
+        PNGRowFilter filter(*fBitmap, fProc, fBytesPerPixel,
+                            fSettings->fFilters, fTop - dictRows);
+        bool success = true;
+        if (dictRows > 0) {
+            SkAutoMalloc dict(dictRows * rowSize);
+            uint8_t* dst = (uint8_t*)dict.get();
+            for (int i = 0; i < dictRows; i++) {
+                memcpy(dst + i * rowSize, filter.next(), rowSize);
+            }
+            size_t dictSize = SkMin32((int)(dictRows * rowSize),
+                                      kDeflateWindowSize);
+            success = Z_OK == deflateSetDictionary(&zstream,
+                                        dst + dictRows * rowSize - dictSize,
+                                        dictSize);
+        }
+
+        // deflateBound assumes Z_FINISH; leave room for the sync flush's
+        // empty block, and for the trailer of the whole stream
+        size_t capacity = fOffset + 16 +
+                          deflateBound(&zstream, (fBottom - fTop) * rowSize);
+        fData.alloc(capacity);
+        zstream.next_out = (Bytef*)fData.get() + fOffset;
+        zstream.avail_out = capacity - fOffset - 4;
+        fAdler = adler32(0, NULL, 0);
+
+        for (int y = fTop; y < fBottom && success; y++) {
+            const uint8_t* row = filter.next();
+            fAdler = adler32(fAdler, row, rowSize);
+            zstream.next_in = (Bytef*)row;
+            zstream.avail_in = rowSize;
+            int flush = y + 1 < fBottom ? Z_NO_FLUSH :
+                        (fLast ? Z_FINISH : Z_SYNC_FLUSH);
+            int result = deflate(&zstream, flush);
+            success = (Z_OK == result || Z_STREAM_END == result) &&
+                      0 == zstream.avail_in;
+        }
+        fSize = capacity - 4 - zstream.avail_out;
+        deflateEnd(&zstream);
+        return success;
+    }
+};
+
+// Bands are at least this many bytes of filtered rows, like pigz's blocks.
+static const size_t kMinPNGBandSize = 128 * 1024;
+
+/*  Deflate the rows on the executor's threads, and write them out as the
+    image's IDAT chunks. Returns false if the image is too small to be worth
+    splitting, so the caller should encode it serially.
+*/
+static bool write_parallel_idats(png_structp png_ptr, const SkBitmap& bitmap,
+                                 transform_scanline_proc proc,
+                                 int bytesPerPixel,
+                                 const PNGSettings& settings,
+                                 SkExecutor* executor, bool* success) {
+    const int height = bitmap.height();
+    const size_t rowSize = bitmap.width() * bytesPerPixel + 1;
+    const int bandRows = SkMax32(1, (int)(kMinPNGBandSize / rowSize));
+    const int bandCount = (height + bandRows - 1) / bandRows;
+    if (bandCount < 2) {
+        return false;
+    }
+
+    SkAutoTArray<PNGBand> bands(bandCount);
+    for (int i = 0; i < bandCount; i++) {
+        PNGBand& band = bands[i];
+        band.fBitmap = &bitmap;
+        band.fProc = proc;
+        band.fBytesPerPixel = bytesPerPixel;
+        band.fSettings = &settings;
+        band.fTop = i * bandRows;
+        band.fBottom = SkMin32(height, band.fTop + bandRows);
+        band.fLast = i == bandCount - 1;
+        band.fOffset = 0 == i ? 2 : 0;     // the zlib header
+        band.fSuccess = false;
+        executor->add(&band);
+    }
+    executor->wait();
+
+    *success = false;
+    uLong adler = bands[0].fAdler;
+    for (int i = 0; i < bandCount; i++) {
+        if (!bands[i].fSuccess) {
+            return true;
+        }
+        if (i > 0) {
+            adler = adler32_combine(adler, bands[i].fAdler,
+                                    (bands[i].fBottom - bands[i].fTop) *
+                                    rowSize);
+        }
+    }
+
+    // the zlib header says deflate with a 32K window, and how hard we tried
+    static const int gLevelFlags[] = { 0, 1, 1, 1, 1, 1, 2, 3, 3, 3 };
+    int level = settings.fLevel < 0 ? 6 : settings.fLevel;
+    uint8_t* header = (uint8_t*)bands[0].fData.get();
+    header[0] = 0x78;
+    header[1] = gLevelFlags[level] << 6;
+    header[1] += 31 - ((header[0] << 8) + header[1]) % 31;
+
+    PNGBand& last = bands[bandCount - 1];
+    uint8_t* trailer = (uint8_t*)last.fData.get() + last.fSize;
+    trailer[0] = (uint8_t)(adler >> 24);
+    trailer[1] = (uint8_t)(adler >> 16);
+    trailer[2] = (uint8_t)(adler >> 8);
+    trailer[3] = (uint8_t)adler;
+    last.fSize += 4;
+
+    for (int i = 0; i < bandCount; i++) {
+        png_write_chunk(png_ptr, (png_bytep)"IDAT",
+                        (png_bytep)bands[i].fData.get(), bands[i].fSize);
+    }
+    // png_write_end() insists that libpng wrote the IDATs itself
+    png_write_chunk(png_ptr, (png_bytep)"IEND", NULL, 0);
+    *success = true;
+    return true;
+}
+
 class SkPNGImageEncoder : public SkImageEncoder {
 protected:
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality);
@@ -823,13 +1648,35 @@ bool SkPNGImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bitmap,
         }
     }
 
+    PNGSettings settings;
+    get_png_settings(this->getSpeed(), SkBitmap::kIndex8_Config == config,
+                     &settings);
+    if (SkImageEncoder::kDefault_Speed != this->getSpeed()) {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, settings.fFilters);
+        png_set_compression_level(png_ptr, settings.fLevel);
+        png_set_compression_strategy(png_ptr, settings.fStrategy);
+    }
+
     png_set_sBIT(png_ptr, info_ptr, &sig_bit);
     png_write_info(png_ptr, info_ptr);
 
+    transform_scanline_proc proc = choose_proc(config, hasAlpha);
+
+    SkExecutor* executor = this->getExecutor();
+    if (NULL != executor && executor->threadCount() > 0) {
+        int bytesPerPixel = (colorType & PNG_COLOR_MASK_PALETTE) ? 1 :
+                            (colorType & PNG_COLOR_MASK_ALPHA) ? 4 : 3;
+        bool success;
+        if (write_parallel_idats(png_ptr, bitmap, proc, bytesPerPixel,
+                                 settings, executor, &success)) {
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return success;
+        }
+    }
+
     const char* srcImage = (const char*)bitmap.getPixels();
     SkAutoSMalloc<1024> rowStorage(bitmap.width() << 2);
     char* storage = (char*)rowStorage.get();
-    transform_scanline_proc proc = choose_proc(config, hasAlpha);
 
     for (int y = 0; y < bitmap.height(); y++) {
         png_bytep row_ptr = (png_bytep)storage;
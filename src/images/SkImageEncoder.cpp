@@ -19,6 +19,8 @@
 #include "SkStream.h"
 #include "SkTemplates.h"
 
+SkImageEncoder::SkImageEncoder() : fSpeed(kDefault_Speed), fExecutor(NULL) {}
+
 SkImageEncoder::~SkImageEncoder() {}
 
 bool SkImageEncoder::encodeStream(SkWStream* stream, const SkBitmap& bm,
@@ -1,5 +1,6 @@
 #include "SkImageRef.h"
 #include "SkBitmap.h"
+#include "SkData.h"
 #include "SkFlattenable.h"
 #include "SkImageDecoder.h"
 #include "SkStream.h"
@@ -23,6 +24,8 @@ SkImageRef::SkImageRef(SkStream* stream, SkBitmap::Config config,
     fSampleSize = sampleSize;
     fDoDither = true;
     fPrev = fNext = NULL;
+    fDecodeMSecs = 0;
+    fKeepScore = 0;
     fFactory = NULL;
 
 #ifdef DUMP_IMAGEREF_LIFECYCLE
@@ -136,6 +139,44 @@ bool SkImageRef::prepareBitmap(SkImageDecoder::Mode mode) {
     return false;
 }
 
+bool SkImageRef::decodeUnlocked(SkBitmap* bitmap) {
+    const void* data;
+    size_t length;
+    SkBitmap::Config config;
+    SkImageDecoderFactory* factory;
+    {
+        SkAutoMutexAcquire ac(*this->mutex());
+        data = fStream->getMemoryBase();
+        if (fErrorInDecoding || NULL == data) {
+            return false;
+        }
+        length = fStream->getLength();
+        config = SkBitmap::kNo_Config != fBitmap.config() ?
+                 fBitmap.config() : fConfig;
+        factory = fFactory;
+        SkSafeRef(factory);
+    }
+    SkAutoUnref aur(factory);
+
+    // our stream does not change its memory, only its position, which this
+    // one keeps separately
+    SkMemoryStream stream(data, length);
+    SkImageDecoder* codec;
+    if (factory) {
+        codec = factory->newDecoder(&stream);
+    } else {
+        codec = SkImageDecoder::Factory(&stream);
+    }
+    if (NULL == codec) {
+        return false;
+    }
+    SkAutoTDelete<SkImageDecoder> ad(codec);
+    codec->setSampleSize(fSampleSize);
+    codec->setDitherImage(fDoDither);
+    return codec->decode(&stream, bitmap, config,
+                         SkImageDecoder::kDecodePixels_Mode);
+}
+
 void* SkImageRef::onLockPixels(SkColorTable** ct) {
     SkASSERT(&gImageRefMutex == this->mutex());
 
@@ -154,6 +195,22 @@ void SkImageRef::onUnlockPixels() {
     SkASSERT(&gImageRefMutex == this->mutex());
 }
 
+static void unref_stream(const void*, size_t, void* stream) {
+    ((SkStream*)stream)->unref();
+}
+
+SkData* SkImageRef::onRefEncodedData() {
+    SkAutoMutexAcquire ac(*this->mutex());
+    // only a stream in memory can be shared without reading it all
+    const void* data = fStream ? fStream->getMemoryBase() : NULL;
+    if (NULL == data) {
+        return NULL;
+    }
+    fStream->ref();
+    return SkData::NewWithProc(data, fStream->getLength(), unref_stream,
+                               fStream);
+}
+
 size_t SkImageRef::ramUsed() const {
     size_t size = 0;
 
@@ -179,6 +236,8 @@ SkImageRef::SkImageRef(SkFlattenableReadBuffer& buffer)
     buffer.read((void*)fStream->getMemoryBase(), length);
 
     fPrev = fNext = NULL;
+    fDecodeMSecs = 0;
+    fKeepScore = 0;
     fFactory = NULL;
 }
 
@@ -7,6 +7,7 @@ SkImageRefPool::SkImageRefPool() {
     fRAMUsed = 0;
     fCount = 0;
     fHead = fTail = NULL;
+    fClock = 0;
 }
 
 SkImageRefPool::~SkImageRefPool() {
@@ -20,7 +21,7 @@ void SkImageRefPool::setRAMBudget(size_t size) {
     }
 }
 
-void SkImageRefPool::justAddedPixels(SkImageRef* ref) {
+void SkImageRefPool::justAddedPixels(SkImageRef* ref, SkMSec decodeMSecs) {
 #ifdef DUMP_IMAGEREF_LIFECYCLE
     SkDebugf("=== ImagePool: add pixels %s [%d %d %d] bytes=%d heap=%d\n",
              ref->getURI(),
@@ -29,17 +30,30 @@ void SkImageRefPool::justAddedPixels(SkImageRef* ref) {
              ref->fBitmap.getSize(), (int)fRAMUsed);
 #endif
     fRAMUsed += ref->ramUsed();
+    ref->fDecodeMSecs = decodeMSecs;
+    this->updateKeepScore(ref);
     this->purgeIfNeeded();
 }
 
 void SkImageRefPool::canLosePixels(SkImageRef* ref) {
     // the refs near fHead have recently been released (used)
-    // if we purge, we purge from the tail
     this->detach(ref);
     this->addToHead(ref);
+    this->updateKeepScore(ref);
     this->purgeIfNeeded();
 }
 
+/*  This is GreedyDual-Size: an image that has just been used is worth the
+    time it would take to decode it again, per KB of pixels it holds, on top
+    of the clock. Purging always takes the image that is worth the least, and
+    advances the clock to its score, so the images that are not used again
+    age relative to the ones that are. With equal costs this is LRU.
+ */
+void SkImageRefPool::updateKeepScore(SkImageRef* ref) {
+    float kb = (float)(ref->ramUsed() >> 10) + 1;
+    ref->fKeepScore = fClock + (float)(ref->fDecodeMSecs + 1) / kb;
+}
+
 void SkImageRefPool::purgeIfNeeded() {
     // do nothing if we have a zero-budget (i.e. unlimited)
     if (fRAMBudget != 0) {
@@ -48,29 +62,38 @@ void SkImageRefPool::purgeIfNeeded() {
 }
 
 void SkImageRefPool::setRAMUsed(size_t limit) {
-    SkImageRef* ref = fTail;
-    
-    while (NULL != ref && fRAMUsed > limit) {
-        // only purge it if its pixels are unlocked
-        if (0 == ref->getLockCount() && ref->fBitmap.getPixels()) {
-            size_t size = ref->ramUsed();
-            SkASSERT(size <= fRAMUsed);
-            fRAMUsed -= size;
+    while (fRAMUsed > limit) {
+        // only purge it if its pixels are unlocked. We start from the tail,
+        // so that the least recently used wins ties
+        SkImageRef* ref = NULL;
+        for (SkImageRef* r = fTail; NULL != r; r = r->fPrev) {
+            if (0 == r->getLockCount() && r->fBitmap.getPixels() &&
+                    (NULL == ref || r->fKeepScore < ref->fKeepScore)) {
+                ref = r;
+            }
+        }
+        if (NULL == ref) {
+            break;
+        }
+        if (ref->fKeepScore > fClock) {
+            fClock = ref->fKeepScore;
+        }
+        size_t size = ref->ramUsed();
+        SkASSERT(size <= fRAMUsed);
+        fRAMUsed -= size;
 
 #ifdef DUMP_IMAGEREF_LIFECYCLE
-            SkDebugf("=== ImagePool: purge %s [%d %d %d] bytes=%d heap=%d\n",
-                     ref->getURI(),
-                     ref->fBitmap.width(), ref->fBitmap.height(),
-                     ref->fBitmap.bytesPerPixel(),
-                     (int)size, (int)fRAMUsed);
+        SkDebugf("=== ImagePool: purge %s [%d %d %d] bytes=%d heap=%d\n",
+                 ref->getURI(),
+                 ref->fBitmap.width(), ref->fBitmap.height(),
+                 ref->fBitmap.bytesPerPixel(),
+                 (int)size, (int)fRAMUsed);
 #endif
-            
-            // remember the bitmap config (don't call reset),
-            // just clear the pixel memory
-            ref->fBitmap.setPixels(NULL);
-            SkASSERT(NULL == ref->fBitmap.getPixels());
-        }
-        ref = ref->fPrev;
+
+        // remember the bitmap config (don't call reset),
+        // just clear the pixel memory
+        ref->fBitmap.setPixels(NULL);
+        SkASSERT(NULL == ref->fBitmap.getPixels());
     }
 }
 
@@ -32,11 +32,16 @@ private:
     
     int computeCount() const;
     
+    // the keepScore of the last image we purged, which every image we keep
+    // starts from
+    float       fClock;
+
     friend class SkImageRef_GlobalPool;
-    
-    void justAddedPixels(SkImageRef*);
+
+    void justAddedPixels(SkImageRef*, SkMSec decodeMSecs);
     void canLosePixels(SkImageRef*);
     void purgeIfNeeded();
+    void updateKeepScore(SkImageRef*);
 };
 
 #endif
@@ -0,0 +1,127 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkImageRef_Discardable.h"
+#include "SkDiscardableMemory.h"
+#include "SkImageDecoder.h"
+
+SkImageRef_Discardable::SkImageRef_Discardable(SkStream* stream,
+                                               SkBitmap::Config config,
+                                               int sampleSize)
+        : INHERITED(stream, config, sampleSize), fMemory(NULL), fCT(NULL),
+          fLocked(false), fDecodeCount(0) {}
+
+SkImageRef_Discardable::SkImageRef_Discardable(SkFlattenableReadBuffer& buffer)
+        : INHERITED(buffer), fMemory(NULL), fCT(NULL), fLocked(false),
+          fDecodeCount(0) {}
+
+SkImageRef_Discardable::~SkImageRef_Discardable() {
+    SkSafeUnref(fCT);
+    SkDELETE(fMemory);
+}
+
+void SkImageRef_Discardable::freeMemory() {
+    SkDELETE(fMemory);
+    fMemory = NULL;
+    fLocked = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// decodes into the imageref's memory, which is already locked if it exists
+class DiscardableAllocator : public SkBitmap::Allocator {
+public:
+    DiscardableAllocator(SkImageRef_Discardable* ref) : fRef(ref) {}
+
+    virtual bool allocPixelRef(SkBitmap* bm, SkColorTable* ct) {
+        const size_t size = bm->getSize();
+        if (fRef->fMemory && fRef->fMemory->size() < size) {
+            fRef->freeMemory();
+        }
+        if (NULL == fRef->fMemory) {
+            fRef->fMemory = SkDiscardableMemory::Create(size);
+            if (NULL == fRef->fMemory) {
+                return false;
+            }
+        }
+        SkASSERT(fRef->fLocked || 0 == fRef->fDecodeCount);
+        fRef->fLocked = true;
+        bm->setPixels(fRef->fMemory->data(), ct);
+        return true;
+    }
+
+private:
+    SkImageRef_Discardable* fRef;
+};
+
+bool SkImageRef_Discardable::onDecode(SkImageDecoder* codec, SkStream* stream,
+                                      SkBitmap* bitmap,
+                                      SkBitmap::Config config,
+                                      SkImageDecoder::Mode mode) {
+    if (SkImageDecoder::kDecodeBounds_Mode == mode) {
+        return this->INHERITED::onDecode(codec, stream, bitmap, config, mode);
+    }
+
+    DiscardableAllocator alloc(this);
+    codec->setAllocator(&alloc);
+    bool success = this->INHERITED::onDecode(codec, stream, bitmap, config,
+                                             mode);
+    // remove the allocator, since it's on the stack
+    codec->setAllocator(NULL);
+
+    if (success) {
+        // remember the colortable (if any)
+        SkRefCnt_SafeAssign(fCT, bitmap->getColorTable());
+        fDecodeCount += 1;
+        return true;
+    }
+    this->freeMemory();
+    return false;
+}
+
+void* SkImageRef_Discardable::onLockPixels(SkColorTable** ct) {
+    if (fMemory && !fLocked) {
+        SkASSERT(NULL == fBitmap.getPixels());
+        fLocked = true;
+        if (fMemory->lock()) {
+            fBitmap.setPixels(fMemory->data(), fCT);
+        } else {
+            // the pixels were taken back, so decode them again (and the
+            // colortable with them) into the same memory
+            SkSafeUnref(fCT);
+            fCT = NULL;
+        }
+    }
+    return this->INHERITED::onLockPixels(ct);
+}
+
+void SkImageRef_Discardable::onUnlockPixels() {
+    this->INHERITED::onUnlockPixels();
+
+    if (fMemory && fLocked) {
+        fMemory->unlock();
+        fLocked = false;
+    }
+    fBitmap.setPixels(NULL, NULL);
+}
+
+SkPixelRef* SkImageRef_Discardable::Create(SkFlattenableReadBuffer& buffer) {
+    return SkNEW_ARGS(SkImageRef_Discardable, (buffer));
+}
+
+static SkPixelRef::Registrar reg("SkImageRef_Discardable",
+                                 SkImageRef_Discardable::Create);
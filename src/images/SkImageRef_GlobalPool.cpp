@@ -1,15 +1,21 @@
 #include "SkImageRef_GlobalPool.h"
 #include "SkImageRefPool.h"
+#include "SkPurgeableCache.h"
 #include "SkThread.h"
+#include "SkThreadPool.h"
+#include "SkTime.h"
 
 extern SkMutex gImageRefMutex;
 
 static SkImageRefPool gGlobalImageRefPool;
 
+// created by the first prefetch(), guarded by gImageRefMutex
+static SkThreadPool* gPrefetchThreads;
+
 SkImageRef_GlobalPool::SkImageRef_GlobalPool(SkStream* stream,
                                              SkBitmap::Config config,
                                              int sampleSize)
-        : SkImageRef(stream, config, sampleSize) {
+        : SkImageRef(stream, config, sampleSize), fPrefetching(false) {
     this->mutex()->acquire();
     gGlobalImageRefPool.addToHead(this);
     this->mutex()->release();
@@ -24,11 +30,12 @@ SkImageRef_GlobalPool::~SkImageRef_GlobalPool() {
 bool SkImageRef_GlobalPool::onDecode(SkImageDecoder* codec, SkStream* stream,
                                      SkBitmap* bitmap, SkBitmap::Config config,
                                      SkImageDecoder::Mode mode) {
+    SkMSec start = SkTime::GetMSecs();
     if (!this->INHERITED::onDecode(codec, stream, bitmap, config, mode)) {
         return false;
     }
     if (mode == SkImageDecoder::kDecodePixels_Mode) {
-        gGlobalImageRefPool.justAddedPixels(this);
+        gGlobalImageRefPool.justAddedPixels(this, SkTime::GetMSecs() - start);
     }
     return true;
 }
@@ -40,7 +47,7 @@ void SkImageRef_GlobalPool::onUnlockPixels() {
 }
 
 SkImageRef_GlobalPool::SkImageRef_GlobalPool(SkFlattenableReadBuffer& buffer)
-        : INHERITED(buffer) {
+        : INHERITED(buffer), fPrefetching(false) {
     this->mutex()->acquire();
     gGlobalImageRefPool.addToHead(this);
     this->mutex()->release();
@@ -50,6 +57,69 @@ SkPixelRef* SkImageRef_GlobalPool::Create(SkFlattenableReadBuffer& buffer) {
     return SkNEW_ARGS(SkImageRef_GlobalPool, (buffer));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+class SkImageRef_GlobalPool::PrefetchJob : public SkRunnable {
+public:
+    PrefetchJob(SkImageRef_GlobalPool* ref) : fRef(ref) {
+        ref->ref();
+    }
+
+    virtual void run() {
+        fRef->decodeAhead();
+        fRef->unref();
+        // the pool does not touch a runnable once it has run
+        SkDELETE(this);
+    }
+
+private:
+    SkImageRef_GlobalPool* fRef;
+};
+
+void SkImageRef_GlobalPool::prefetch() {
+    SkAutoMutexAcquire ac(gImageRefMutex);
+    if (fPrefetching || fBitmap.getPixels()) {
+        return;
+    }
+    fPrefetching = true;
+    if (NULL == gPrefetchThreads) {
+        gPrefetchThreads = SkNEW_ARGS(SkThreadPool, (1));
+    }
+    gPrefetchThreads->add(SkNEW_ARGS(PrefetchJob, (this)));
+}
+
+// called on the prefetch thread
+void SkImageRef_GlobalPool::decodeAhead() {
+    SkBitmap bitmap;
+    SkMSec start = SkTime::GetMSecs();
+    bool success = this->decodeUnlocked(&bitmap);
+    SkMSec duration = SkTime::GetMSecs() - start;
+
+    SkAutoMutexAcquire ac(gImageRefMutex);
+    fPrefetching = false;
+    // someone may have decoded (and locked) it in the meantime
+    if (success && NULL == fBitmap.getPixels() && 0 == this->getLockCount()) {
+        // move it to the head as an unlock would, while it has no pixels to
+        // account for
+        gGlobalImageRefPool.detach(this);
+        gGlobalImageRefPool.addToHead(this);
+        fBitmap.swap(bitmap);
+        gGlobalImageRefPool.justAddedPixels(this, duration);
+    }
+}
+
+void SkImageRef_GlobalPool::WaitForPrefetches() {
+    SkThreadPool* threads;
+    {
+        SkAutoMutexAcquire ac(gImageRefMutex);
+        threads = gPrefetchThreads;
+    }
+    // the prefetches need the mutex to finish
+    if (threads) {
+        threads->wait();
+    }
+}
+
 static SkPixelRef::Registrar reg("SkImageRef_GlobalPool",
                                  SkImageRef_GlobalPool::Create);
 
@@ -76,6 +146,27 @@ void SkImageRef_GlobalPool::SetRAMUsed(size_t usage) {
     gGlobalImageRefPool.setRAMUsed(usage);
 }
 
+namespace {
+
+class PoolPurgeableCache : public SkPurgeableCache {
+public:
+    PoolPurgeableCache() : INHERITED("image pool", kExpensive_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        return SkImageRef_GlobalPool::GetRAMUsed();
+    }
+    virtual void purgeTo(size_t bytes) {
+        SkImageRef_GlobalPool::SetRAMUsed(bytes);
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static PoolPurgeableCache gPurgeableCache;
+
 void SkImageRef_GlobalPool::DumpPool() {
     SkAutoMutexAcquire ac(gImageRefMutex);
     gGlobalImageRefPool.dump();
@@ -109,22 +109,40 @@ static void skmem_init_source(j_decompress_ptr cinfo) {
 }
 
 static boolean skmem_fill_input_buffer(j_decompress_ptr cinfo) {
-    SkDebugf("xxxxxxxxxxxxxx skmem_fill_input_buffer called\n");
+    // all of the data was in the buffer from the start, so this is the end
     return FALSE;
 }
 
 static void skmem_skip_input_data(j_decompress_ptr cinfo, long num_bytes) {
     skjpeg_source_mgr*  src = (skjpeg_source_mgr*)cinfo->src;
-//    SkDebugf("xxxxxxxxxxxxxx skmem_skip_input_data called %d\n", num_bytes);
-    src->next_input_byte = (const JOCTET*)((const char*)src->next_input_byte + num_bytes);
+    if (num_bytes <= 0) {
+        return;
+    }
+    if ((size_t)num_bytes > src->bytes_in_buffer) {
+        // skipping past the end leaves nothing, the next fill will fail
+        num_bytes = (long)src->bytes_in_buffer;
+    }
+    src->next_input_byte += num_bytes;
     src->bytes_in_buffer -= num_bytes;
 }
 
-static boolean skmem_resync_to_restart(j_decompress_ptr cinfo, int desired) {
-    SkDebugf("xxxxxxxxxxxxxx skmem_resync_to_restart called\n");
+static boolean skmem_seek_input_data(j_decompress_ptr cinfo, long byte_offset) {
+    skjpeg_source_mgr*  src = (skjpeg_source_mgr*)cinfo->src;
+    if (byte_offset < 0 || (size_t)byte_offset > src->fMemoryBaseSize) {
+        return FALSE;
+    }
+    // current_offset stays at the end of the "buffer", which is all of it
+    src->next_input_byte = src->start_input_byte + byte_offset;
+    src->bytes_in_buffer = src->fMemoryBaseSize - byte_offset;
     return TRUE;
 }
 
+static boolean skmem_resync_to_restart(j_decompress_ptr cinfo, int desired) {
+    // we can look at the bytes in place, so libjpeg's scan for the next
+    // marker works as is
+    return jpeg_resync_to_restart(cinfo, desired);
+}
+
 static void skmem_term_source(j_decompress_ptr /*cinfo*/) {}
 
 
@@ -133,26 +151,30 @@ static void skmem_term_source(j_decompress_ptr /*cinfo*/) {}
 skjpeg_source_mgr::skjpeg_source_mgr(SkStream* stream, SkImageDecoder* decoder,
                                      bool ownStream) : fStream(stream) {
     fDecoder = decoder;
-    const void* baseAddr = stream->getMemoryBase();
-    size_t bufferSize = 4096;
-    size_t len;
-    fMemoryBase = NULL;
     fUnrefStream = ownStream;
-    fMemoryBaseSize = 0;
+    fMemoryBase = stream->getMemoryBase();
+    fMemoryBaseSize = fMemoryBase ? stream->getLength() : 0;
 
-    init_source = sk_init_source;
-    fill_input_buffer = sk_fill_input_buffer;
-    skip_input_data = sk_skip_input_data;
-    resync_to_restart = sk_resync_to_restart;
-    term_source = sk_term_source;
-    seek_input_data = sk_seek_input_data;
-//    SkDebugf("**************** use memorybase %p %d\n", fMemoryBase, fMemoryBaseSize);
+    if (fMemoryBase) {
+        // the data is already in RAM (e.g. a mapped file), so point libjpeg
+        // straight at it rather than copying it through fBuffer
+        init_source = skmem_init_source;
+        fill_input_buffer = skmem_fill_input_buffer;
+        skip_input_data = skmem_skip_input_data;
+        resync_to_restart = skmem_resync_to_restart;
+        term_source = skmem_term_source;
+        seek_input_data = skmem_seek_input_data;
+    } else {
+        init_source = sk_init_source;
+        fill_input_buffer = sk_fill_input_buffer;
+        skip_input_data = sk_skip_input_data;
+        resync_to_restart = sk_resync_to_restart;
+        term_source = sk_term_source;
+        seek_input_data = sk_seek_input_data;
+    }
 }
 
 skjpeg_source_mgr::~skjpeg_source_mgr() {
-    if (fMemoryBase) {
-        sk_free(fMemoryBase);
-    }
     if (fUnrefStream) {
         fStream->unref();
     }
@@ -18,12 +18,61 @@
 #include "SkMovie.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
+#include "SkData.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkThread.h"
 #include "SkUtils.h"
 
 #include "gif_lib.h"
 
+/*  The decoded frames of a file, shared by every movie of that file, along
+    with snapshots of the composited image at a few of the frames (keyframes),
+    so that a movie that goes back in time can start from the nearest one
+    instead of from the first frame.
+ */
+class SkGIFFrames {
+public:
+    // returns the frames for the file's contents, or NULL if they don't decode
+    static SkGIFFrames* Acquire(SkStream*);
+    static void Release(SkGIFFrames*);
+
+    const GifFileType* gif() const { return fGIF; }
+
+    // Copies the latest keyframe after 'after' and at or before 'index' into
+    // bm, which must be the screen's size, and returns its index. Returns -1
+    // if there isn't one.
+    int findKeyframe(int after, int index, SkBitmap* bm);
+    // bm is the image shown at index
+    void addKeyframe(int index, const SkBitmap& bm);
+    bool wantsKeyframe(int index) const;
+
+private:
+    SkGIFFrames(GifFileType*, SkData*, uint32_t hash);
+    ~SkGIFFrames();
+
+    enum {
+        kMaxKeyframes = 8,
+        kKeyframeBudget = 2 * 1024 * 1024  // bytes of snapshots per file
+    };
+
+    struct Keyframe {
+        int         fIndex;
+        SkBitmap    fBitmap;
+    };
+
+    GifFileType*    fGIF;
+    SkData*         fData;      // the file, to tell files with the same hash apart
+    uint32_t        fHash;
+    int             fUseCount;  // guarded by gFramesMutex
+
+    SkMutex         fMutex;     // guards the keyframes
+    Keyframe        fKeyframes[kMaxKeyframes];
+    int             fKeyframeCount;
+    int             fKeyframeInterval;  // 0 if there are no keyframes
+};
+
 class SkGIFMovie : public SkMovie {
 public:
     SkGIFMovie(SkStream* stream);
@@ -35,10 +84,12 @@ protected:
     virtual bool onGetBitmap(SkBitmap*);
     
 private:
+    SkGIFFrames* fFrames;
     GifFileType* fGIF;
     int fCurrIndex;
     int fLastDrawIndex;
     SkBitmap fBackup;
+    SkColor fPaintingColor;
 };
 
 static int Decode(GifFileType* fileType, GifByteType* out, int size) {
@@ -46,25 +97,148 @@ static int Decode(GifFileType* fileType, GifByteType* out, int size) {
     return (int) stream->read(out, size);
 }
 
-SkGIFMovie::SkGIFMovie(SkStream* stream)
+static int getDisposalMethod(const SavedImage* frame);
+
+static SkMutex                  gFramesMutex;
+static SkTDArray<SkGIFFrames*>  gFrames;
+
+static uint32_t hash_data(const SkData* data)
 {
-    fGIF = DGifOpen( stream, Decode );
-    if (NULL == fGIF)
-        return;
+    const uint8_t* bytes = data->bytes();
+    uint32_t hash = 0;
+    for (size_t i = 0; i < data->size(); i++)
+        hash = (hash << 5) + hash + bytes[i];   // djb2
+    return hash;
+}
+
+SkGIFFrames::SkGIFFrames(GifFileType* gif, SkData* data, uint32_t hash)
+    : fGIF(gif), fData(data), fHash(hash), fUseCount(1), fKeyframeCount(0)
+{
+    data->ref();
+
+    size_t frameSize = gif->SWidth * gif->SHeight * sizeof(SkPMColor);
+    int count = SkMin32(kMaxKeyframes, kKeyframeBudget / SkMax32(frameSize, 1));
+    // frame 0 is cheap to get back to, so space the keyframes out after it
+    fKeyframeInterval = count > 0 ? gif->ImageCount / (count + 1) : 0;
+    if (fKeyframeInterval < 2)
+        fKeyframeInterval = count > 0 && gif->ImageCount > 2 ? 2 : 0;
+}
+
+SkGIFFrames::~SkGIFFrames()
+{
+    DGifCloseFile(fGIF);
+    fData->unref();
+}
+
+SkGIFFrames* SkGIFFrames::Acquire(SkStream* stream)
+{
+    SkDynamicMemoryWStream file;
+    char buffer[4096];
+    size_t bytes;
+    while ((bytes = stream->read(buffer, sizeof(buffer))) > 0)
+        file.write(buffer, bytes);
+    SkAutoTUnref<SkData> data(file.detachAsData());
+    uint32_t hash = hash_data(data.get());
+    size_t size = data.get()->size();
+
+    {
+        SkAutoMutexAcquire ac(gFramesMutex);
+        for (int i = 0; i < gFrames.count(); i++) {
+            SkGIFFrames* frames = gFrames[i];
+            if (frames->fHash == hash && frames->fData->size() == size &&
+                    !memcmp(frames->fData->data(), data.get()->data(), size)) {
+                frames->fUseCount += 1;
+                return frames;
+            }
+        }
+    }
+
+    // decode without holding the lock
+    SkMemoryStream memory(data.get()->data(), size, false);
+    GifFileType* gif = DGifOpen(&memory, Decode);
+    if (NULL == gif)
+        return NULL;
+    if (DGifSlurp(gif) != GIF_OK)
+    {
+        DGifCloseFile(gif);
+        return NULL;
+    }
+
+    SkGIFFrames* frames = new SkGIFFrames(gif, data.get(), hash);
+    SkAutoMutexAcquire ac(gFramesMutex);
+    *gFrames.append() = frames;
+    return frames;
+}
 
-    if (DGifSlurp(fGIF) != GIF_OK)
+void SkGIFFrames::Release(SkGIFFrames* frames)
+{
     {
-        DGifCloseFile(fGIF);
-        fGIF = NULL;
+        SkAutoMutexAcquire ac(gFramesMutex);
+        if (--frames->fUseCount > 0)
+            return;
+        gFrames.remove(gFrames.find(frames));
     }
+    delete frames;
+}
+
+bool SkGIFFrames::wantsKeyframe(int index) const
+{
+    // resuming after a restore-to-previous frame would need its backup
+    // as well, so those aren't snapshotted
+    return fKeyframeInterval > 0 && index > 0 && index % fKeyframeInterval == 0 &&
+           getDisposalMethod(&fGIF->SavedImages[index]) != 3;
+}
+
+int SkGIFFrames::findKeyframe(int after, int index, SkBitmap* bm)
+{
+    SkAutoMutexAcquire ac(fMutex);
+    const Keyframe* best = NULL;
+    for (int i = 0; i < fKeyframeCount; i++) {
+        const Keyframe& key = fKeyframes[i];
+        if (key.fIndex > after && key.fIndex <= index &&
+                (NULL == best || key.fIndex > best->fIndex))
+            best = &key;
+    }
+    if (NULL == best)
+        return -1;
+
+    SkAutoLockPixels alpSrc(best->fBitmap);
+    SkAutoLockPixels alpDst(*bm);
+    SkASSERT(best->fBitmap.getSize() == bm->getSize());
+    memcpy(bm->getPixels(), best->fBitmap.getPixels(), bm->getSize());
+    return best->fIndex;
+}
+
+void SkGIFFrames::addKeyframe(int index, const SkBitmap& bm)
+{
+    SkAutoMutexAcquire ac(fMutex);
+    if (fKeyframeCount == kMaxKeyframes)
+        return;
+    for (int i = 0; i < fKeyframeCount; i++)
+        if (fKeyframes[i].fIndex == index)
+            return;
+
+    Keyframe& key = fKeyframes[fKeyframeCount];
+    if (bm.copyTo(&key.fBitmap, SkBitmap::kARGB_8888_Config)) {
+        key.fIndex = index;
+        fKeyframeCount += 1;
+    }
+}
+
+SkGIFMovie::SkGIFMovie(SkStream* stream)
+{
+    fFrames = SkGIFFrames::Acquire(stream);
+    // the frames are only read from here on, so the movies can share them
+    fGIF = fFrames ? const_cast<GifFileType*>(fFrames->gif()) : NULL;
     fCurrIndex = -1;
     fLastDrawIndex = -1;
+    fPaintingColor = SkColorSetARGB(0, 0, 0, 0);
 }
 
 SkGIFMovie::~SkGIFMovie()
 {
-    if (fGIF)
-        DGifCloseFile(fGIF);
+    if (fFrames)
+        SkGIFFrames::Release(fFrames);
 }
 
 static SkMSec savedimage_duration(const SavedImage* image)
@@ -117,19 +291,18 @@ bool SkGIFMovie::onSetTime(SkMSec time)
     return true;
 }
 
-static void copyLine(uint32_t* dst, const unsigned char* src, const ColorMapObject* cmap,
+static void copyLine(uint32_t* dst, const unsigned char* src, const SkPMColor colors[],
                      int transparent, int width)
 {
     for (; width > 0; width--, src++, dst++) {
         if (*src != transparent) {
-            const GifColorType& col = cmap->Colors[*src];
-            *dst = SkPackARGB32(0xFF, col.Red, col.Green, col.Blue);
+            *dst = colors[*src];
         }
     }
 }
 
 static void copyInterlaceGroup(SkBitmap* bm, const unsigned char*& src,
-                               const ColorMapObject* cmap, int transparent, int copyWidth,
+                               const SkPMColor colors[], int transparent, int copyWidth,
                                int copyHeight, const GifImageDesc& imageDesc, int rowStep,
                                int startRow)
 {
@@ -137,7 +310,7 @@ static void copyInterlaceGroup(SkBitmap* bm, const unsigned char*& src,
     // every 'rowStep'th row, starting with row 'startRow'
     for (row = startRow; row < copyHeight; row += rowStep) {
         uint32_t* dst = bm->getAddr32(imageDesc.Left, imageDesc.Top + row);
-        copyLine(dst, src, cmap, transparent, copyWidth);
+        copyLine(dst, src, colors, transparent, copyWidth);
         src += imageDesc.Width;
     }
 
@@ -145,7 +318,7 @@ static void copyInterlaceGroup(SkBitmap* bm, const unsigned char*& src,
     src += imageDesc.Width * ((imageDesc.Height - row + rowStep - 1) / rowStep);
 }
 
-static void blitInterlace(SkBitmap* bm, const SavedImage* frame, const ColorMapObject* cmap,
+static void blitInterlace(SkBitmap* bm, const SavedImage* frame, const SkPMColor colors[],
                           int transparent)
 {
     int width = bm->width();
@@ -164,18 +337,18 @@ static void blitInterlace(SkBitmap* bm, const SavedImage* frame, const ColorMapO
     const unsigned char* src = (unsigned char*)frame->RasterBits;
 
     // group 1 - every 8th row, starting with row 0
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 8, 0);
+    copyInterlaceGroup(bm, src, colors, transparent, copyWidth, copyHeight, frame->ImageDesc, 8, 0);
 
     // group 2 - every 8th row, starting with row 4
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 8, 4);
+    copyInterlaceGroup(bm, src, colors, transparent, copyWidth, copyHeight, frame->ImageDesc, 8, 4);
 
     // group 3 - every 4th row, starting with row 2
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 4, 2);
+    copyInterlaceGroup(bm, src, colors, transparent, copyWidth, copyHeight, frame->ImageDesc, 4, 2);
 
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 2, 1);
+    copyInterlaceGroup(bm, src, colors, transparent, copyWidth, copyHeight, frame->ImageDesc, 2, 1);
 }
 
-static void blitNormal(SkBitmap* bm, const SavedImage* frame, const ColorMapObject* cmap,
+static void blitNormal(SkBitmap* bm, const SavedImage* frame, const SkPMColor colors[],
                        int transparent)
 {
     int width = bm->width();
@@ -192,35 +365,42 @@ static void blitNormal(SkBitmap* bm, const SavedImage* frame, const ColorMapObje
         copyHeight = height - frame->ImageDesc.Top;
     }
 
-    int srcPad, dstPad;
-    dstPad = width - copyWidth;
-    srcPad = frame->ImageDesc.Width - copyWidth;
     for (; copyHeight > 0; copyHeight--) {
-        copyLine(dst, src, cmap, transparent, copyWidth);
+        copyLine(dst, src, colors, transparent, copyWidth);
         src += frame->ImageDesc.Width;
         dst += width;
     }
 }
 
-static void fillRect(SkBitmap* bm, GifWord left, GifWord top, GifWord width, GifWord height,
-                     uint32_t col)
+// the part of the screen that the frame covers, if any
+static bool getFrameRect(const SkBitmap& bm, const SavedImage* frame, SkIRect* rect)
 {
-    int bmWidth = bm->width();
-    int bmHeight = bm->height();
-    uint32_t* dst = bm->getAddr32(left, top);
-    GifWord copyWidth = width;
-    if (left + copyWidth > bmWidth) {
-        copyWidth = bmWidth - left;
-    }
+    rect->setXYWH(frame->ImageDesc.Left, frame->ImageDesc.Top,
+                  frame->ImageDesc.Width, frame->ImageDesc.Height);
+    return rect->intersect(0, 0, bm.width(), bm.height());
+}
 
-    GifWord copyHeight = height;
-    if (top + copyHeight > bmHeight) {
-        copyHeight = bmHeight - top;
+static void fillRect(SkBitmap* bm, const SavedImage* frame, uint32_t col)
+{
+    SkIRect rect;
+    if (!getFrameRect(*bm, frame, &rect)) {
+        return;
+    }
+    for (int y = rect.fTop; y < rect.fBottom; y++) {
+        sk_memset32(bm->getAddr32(rect.fLeft, y), col, rect.width());
     }
+}
 
-    for (; copyHeight > 0; copyHeight--) {
-        sk_memset32(dst, col, copyWidth);
-        dst += bmWidth;
+// copies the part of src that the frame covers into dst
+static void copyFrameRect(SkBitmap* dst, const SkBitmap& src, const SavedImage* frame)
+{
+    SkIRect rect;
+    if (!getFrameRect(*dst, frame, &rect)) {
+        return;
+    }
+    for (int y = rect.fTop; y < rect.fBottom; y++) {
+        memcpy(dst->getAddr32(rect.fLeft, y), src.getAddr32(rect.fLeft, y),
+               rect.width() * sizeof(uint32_t));
     }
 }
 
@@ -249,10 +429,20 @@ static void drawFrame(SkBitmap* bm, const SavedImage* frame, const ColorMapObjec
         return;
     }
 
+    // pack the colors once, rather than for every pixel; indices past the
+    // table come out transparent
+    SkPMColor colors[256];
+    int count = SkMin32(cmap->ColorCount, 256);
+    for (int i = 0; i < count; i++) {
+        const GifColorType& col = cmap->Colors[i];
+        colors[i] = SkPackARGB32(0xFF, col.Red, col.Green, col.Blue);
+    }
+    sk_bzero(colors + count, (256 - count) * sizeof(SkPMColor));
+
     if (frame->ImageDesc.Interlace) {
-        blitInterlace(bm, frame, cmap, transparent);
+        blitInterlace(bm, frame, colors, transparent);
     } else {
-        blitNormal(bm, frame, cmap, transparent);
+        blitNormal(bm, frame, colors, transparent);
     }
 }
 
@@ -286,6 +476,14 @@ static void getTransparencyAndDisposalMethod(const SavedImage* frame, bool* tran
     }
 }
 
+static int getDisposalMethod(const SavedImage* frame)
+{
+    bool trans;
+    int disposal;
+    getTransparencyAndDisposalMethod(frame, &trans, &disposal);
+    return disposal;
+}
+
 // return true if area of 'target' is completely covers area of 'covered'
 static bool checkIfCover(const SavedImage* target, const SavedImage* covered)
 {
@@ -317,24 +515,20 @@ static void disposeFrameIfNeeded(SkBitmap* bm, const SavedImage* cur, const Save
         // restore to background color
         // -> 'background' means background under this image.
         case 2:
-            fillRect(bm, cur->ImageDesc.Left, cur->ImageDesc.Top,
-                     cur->ImageDesc.Width, cur->ImageDesc.Height,
-                     color);
+            fillRect(bm, cur, color);
             break;
 
-        // restore to previous
+        // restore to previous; only the current frame's area has changed
+        // since the backup was made
         case 3:
-            bm->swap(*backup);
+            copyFrameRect(bm, *backup, cur);
             break;
         }
     }
 
-    // Save current image if next frame's disposal method == 3
+    // Save what the next frame will cover, if its disposal method == 3
     if (nextDisposal == 3) {
-        const uint32_t* src = bm->getAddr32(0, 0);
-        uint32_t* dst = backup->getAddr32(0, 0);
-        int cnt = bm->width() * bm->height();
-        memcpy(dst, src, cnt*sizeof(uint32_t));
+        copyFrameRect(backup, *bm, next);
     }
 }
 
@@ -389,32 +583,34 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         lastIndex = fGIF->ImageCount - 1;
     }
 
-    SkColor bgColor = SkPackARGB32(0, 0, 0, 0);
-    if (gif->SColorMap != NULL) {
-        const GifColorType& col = gif->SColorMap->Colors[fGIF->SBackGroundColor];
-        bgColor = SkColorSetARGB(0xFF, col.Red, col.Green, col.Blue);
+    if (startIndex == 0) {
+        const SavedImage* first = &fGIF->SavedImages[0];
+        bool trans;
+        int disposal;
+        getTransparencyAndDisposalMethod(first, &trans, &disposal);
+        fPaintingColor = SkColorSetARGB(0, 0, 0, 0);
+        if (!trans && gif->SColorMap != NULL) {
+            const GifColorType& col = gif->SColorMap->Colors[fGIF->SBackGroundColor];
+            fPaintingColor = SkColorSetARGB(0xFF, col.Red, col.Green, col.Blue);
+        }
+    }
+
+    // skip ahead to the latest keyframe, if there is one past where we are
+    int keyIndex = fFrames->findKeyframe(startIndex - 1, lastIndex, bm);
+    if (keyIndex >= 0) {
+        startIndex = keyIndex + 1;
     }
 
-    static SkColor paintingColor = SkPackARGB32(0, 0, 0, 0);
     // draw each frames - not intelligent way
     for (int i = startIndex; i <= lastIndex; i++) {
         const SavedImage* cur = &fGIF->SavedImages[i];
         if (i == 0) {
-            bool trans;
-            int disposal;
-            getTransparencyAndDisposalMethod(cur, &trans, &disposal);
-            if (!trans && gif->SColorMap != NULL) {
-                paintingColor = bgColor;
-            } else {
-                paintingColor = SkColorSetARGB(0, 0, 0, 0);
-            }
-
-            bm->eraseColor(paintingColor);
-            fBackup.eraseColor(paintingColor);
+            bm->eraseColor(fPaintingColor);
+            fBackup.eraseColor(fPaintingColor);
         } else {
             // Dispose previous frame before move to next frame.
             const SavedImage* prev = &fGIF->SavedImages[i-1];
-            disposeFrameIfNeeded(bm, prev, cur, &fBackup, paintingColor);
+            disposeFrameIfNeeded(bm, prev, cur, &fBackup, fPaintingColor);
         }
 
         // Draw frame
@@ -425,6 +621,10 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         }
     }
 
+    if (lastIndex >= startIndex && fFrames->wantsKeyframe(lastIndex)) {
+        fFrames->addKeyframe(lastIndex, *bm);
+    }
+
     // save index
     fLastDrawIndex = lastIndex;
     return true;
@@ -17,23 +17,20 @@
 #include "SkPageFlipper.h"
 
 SkPageFlipper::SkPageFlipper() {
+    fPageCount = 2;
     fWidth = 0;
     fHeight = 0;
-    fDirty0 = &fDirty0Storage;
-    fDirty1 = &fDirty1Storage;
-
-    fDirty0->setEmpty();
-    fDirty1->setEmpty();
 }
 
-SkPageFlipper::SkPageFlipper(int width, int height) {
+SkPageFlipper::SkPageFlipper(int width, int height, int pageCount) {
+    SkASSERT(pageCount >= 2 && pageCount <= kMaxPages);
+    fPageCount = pageCount;
     fWidth = width;
     fHeight = height;
-    fDirty0 = &fDirty0Storage;
-    fDirty1 = &fDirty1Storage;
 
-    fDirty0->setRect(0, 0, width, height);
-    fDirty1->setEmpty();
+    for (int i = 0; i < pageCount - 1; i++) {
+        fDrawn[i].setRect(0, 0, width, height);
+    }
 }
 
 void SkPageFlipper::resize(int width, int height) {
@@ -41,19 +38,21 @@ void SkPageFlipper::resize(int width, int height) {
     fHeight = height;
     
     // this is the opposite of the constructors
-    fDirty1->setRect(0, 0, width, height);
-    fDirty0->setEmpty();
+    fInval.setRect(0, 0, width, height);
+    for (int i = 0; i < fPageCount - 1; i++) {
+        fDrawn[i].setEmpty();
+    }
 }
 
 void SkPageFlipper::inval() {
-    fDirty1->setRect(0, 0, fWidth, fHeight);
+    fInval.setRect(0, 0, fWidth, fHeight);
 }
 
 void SkPageFlipper::inval(const SkIRect& rect) {
     SkIRect r;
     r.set(0, 0, fWidth, fHeight);
     if (r.intersect(rect)) {
-        fDirty1->op(r, SkRegion::kUnion_Op);
+        fInval.op(r, SkRegion::kUnion_Op);
     }
 }
 
@@ -61,7 +60,7 @@ void SkPageFlipper::inval(const SkRegion& rgn) {
     SkRegion r;
     r.setRect(0, 0, fWidth, fHeight);
     if (r.op(rgn, SkRegion::kIntersect_Op)) {
-        fDirty1->op(r, SkRegion::kUnion_Op);
+        fInval.op(r, SkRegion::kUnion_Op);
     }
 }
 
@@ -75,11 +74,19 @@ void SkPageFlipper::inval(const SkRect& rect, bool antialias) {
 }
 
 const SkRegion& SkPageFlipper::update(SkRegion* copyBits) {
-    // Copy over anything new from page0 that isn't dirty in page1
-    copyBits->op(*fDirty0, *fDirty1, SkRegion::kDifference_Op);
-    SkTSwap<SkRegion*>(fDirty0, fDirty1);
-    fDirty1->setEmpty();
-    return *fDirty0;
-}
+    // Copy over anything the back page hasn't seen yet, from the updates
+    // since it was last drawn, that isn't about to be drawn again
+    *copyBits = fDrawn[0];
+    for (int i = 1; i < fPageCount - 1; i++) {
+        copyBits->op(fDrawn[i], SkRegion::kUnion_Op);
+    }
+    copyBits->op(fInval, SkRegion::kDifference_Op);
 
+    for (int i = fPageCount - 2; i > 0; i--) {
+        fDrawn[i].swap(fDrawn[i - 1]);
+    }
+    fDrawn[0].swap(fInval);
+    fInval.setEmpty();
+    return fDrawn[0];
+}
 
@@ -19,6 +19,19 @@
 #include "SkColorPriv.h"
 #include "SkDither.h"
 
+// The vector procs read 4 byte pixels in memory order (r, g, b, x/a), and
+// write SkPMColors with the alpha in the top byte and green next to it, so
+// at most red and blue trade places.
+#if defined(SK_CPU_LENDIAN) && (24 == SK_A32_SHIFT) && (8 == SK_G32_SHIFT)
+    #if defined(__SSE2__)
+        #include <emmintrin.h>
+        #define SK_SAMPLER_USE_SSE2
+    #elif defined(__ARM_HAVE_NEON)
+        #include <arm_neon.h>
+        #define SK_SAMPLER_USE_NEON
+    #endif
+#endif
+
 // 8888
 
 static bool Sample_Gray_D8888(void* SK_RESTRICT dstRow,
@@ -298,6 +311,194 @@ static bool Sample_Index_DI(void* SK_RESTRICT dstRow,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  Vector versions of the hottest procs, for rows of 4 byte pixels that are
+    not sampled in x (deltaSrc == 4). They produce exactly the same pixels as
+    the portable procs, which also handle the pixels left over at the end.
+ */
+
+#if defined(SK_SAMPLER_USE_SSE2)
+
+static inline __m128i rgba_to_pmcolor_SSE2(__m128i rgba) {
+#if 16 == SK_R32_SHIFT
+    const __m128i ga = _mm_set1_epi32(0xFF00FF00);
+    const __m128i lo = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_slli_epi32(_mm_and_si128(rgba, lo), 16);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(rgba, 16), lo);
+    return _mm_or_si128(_mm_and_si128(rgba, ga), _mm_or_si128(r, b));
+#else
+    return rgba;
+#endif
+}
+
+// c holds 2 pixels as 16 bit r, g, b, a lanes
+static inline __m128i premultiply_SSE2(__m128i c) {
+    const __m128i rgbLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaLanes = _mm_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0);
+    __m128i a = _mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+    // keep the alpha lanes themselves by multiplying them by 255
+    a = _mm_or_si128(_mm_and_si128(a, rgbLanes), alphaLanes);
+    // SkMulDiv255Round
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+static bool Sample_RGBx_D8888_SSE2(void* SK_RESTRICT dstRow,
+                                   const uint8_t* SK_RESTRICT src,
+                    int width, int deltaSrc, int y, const SkPMColor ctable[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i opaque = _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(src + x * 4));
+        c = _mm_or_si128(rgba_to_pmcolor_SSE2(c), opaque);
+        _mm_storeu_si128((__m128i*)(dst + x), c);
+    }
+    return Sample_RGBx_D8888(dst + x, src + x * 4, width - x, deltaSrc, y,
+                             ctable);
+}
+
+static bool Sample_RGBA_D8888_SSE2(void* SK_RESTRICT dstRow,
+                                   const uint8_t* SK_RESTRICT src,
+                    int width, int deltaSrc, int y, const SkPMColor ctable[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i alphaMask = _mm_set1_epi32(-1);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(src + x * 4));
+        alphaMask = _mm_and_si128(alphaMask, c);
+        __m128i lo = premultiply_SSE2(_mm_unpacklo_epi8(c, zero));
+        __m128i hi = premultiply_SSE2(_mm_unpackhi_epi8(c, zero));
+        c = rgba_to_pmcolor_SSE2(_mm_packus_epi16(lo, hi));
+        _mm_storeu_si128((__m128i*)(dst + x), c);
+    }
+    // the alphas are the last byte of each pixel
+    int opaque = _mm_movemask_epi8(_mm_cmpeq_epi8(alphaMask,
+                                                  _mm_set1_epi32(-1)));
+    bool hadAlpha = (opaque & 0x8888) != 0x8888;
+    return Sample_RGBA_D8888(dst + x, src + x * 4, width - x, deltaSrc, y,
+                             ctable) || hadAlpha;
+}
+
+static inline __m128i rgbx_to_565_SSE2(__m128i c) {
+    const __m128i mask5 = _mm_set1_epi32(SK_R16_MASK);
+    const __m128i mask6 = _mm_set1_epi32(SK_G16_MASK);
+    __m128i r = _mm_and_si128(_mm_srli_epi32(c, 3), mask5);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(c, 8 + 2), mask6);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(c, 16 + 3), mask5);
+    c = _mm_or_si128(_mm_slli_epi32(r, SK_R16_SHIFT),
+                     _mm_or_si128(_mm_slli_epi32(g, SK_G16_SHIFT),
+                                  _mm_slli_epi32(b, SK_B16_SHIFT)));
+    // sign extend, so that the signed pack does not saturate
+    return _mm_srai_epi32(_mm_slli_epi32(c, 16), 16);
+}
+
+static bool Sample_RGBx_D565_SSE2(void* SK_RESTRICT dstRow,
+                                  const uint8_t* SK_RESTRICT src,
+                    int width, int deltaSrc, int y, const SkPMColor ctable[]) {
+    SkASSERT(4 == deltaSrc);
+    uint16_t* SK_RESTRICT dst = (uint16_t*)dstRow;
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i c0 = _mm_loadu_si128((const __m128i*)(src + x * 4));
+        __m128i c1 = _mm_loadu_si128((const __m128i*)(src + x * 4 + 16));
+        __m128i d = _mm_packs_epi32(rgbx_to_565_SSE2(c0),
+                                    rgbx_to_565_SSE2(c1));
+        _mm_storeu_si128((__m128i*)(dst + x), d);
+    }
+    return Sample_RGBx_D565(dst + x, src + x * 4, width - x, deltaSrc, y,
+                            ctable);
+}
+
+#define Sample_RGBx_D8888_Opt   Sample_RGBx_D8888_SSE2
+#define Sample_RGBA_D8888_Opt   Sample_RGBA_D8888_SSE2
+#define Sample_RGBx_D565_Opt    Sample_RGBx_D565_SSE2
+
+#elif defined(SK_SAMPLER_USE_NEON)
+
+static inline void store_pmcolors_neon(SkPMColor* dst, uint8x8x4_t c) {
+#if 16 == SK_R32_SHIFT
+    uint8x8_t r = c.val[0];
+    c.val[0] = c.val[2];
+    c.val[2] = r;
+#endif
+    vst4_u8((uint8_t*)dst, c);
+}
+
+// SkMulDiv255Round
+static inline uint8x8_t mul_div255_round_neon(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t prod = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(prod, vshrq_n_u16(prod, 8)), 8);
+}
+
+static bool Sample_RGBx_D8888_neon(void* SK_RESTRICT dstRow,
+                                   const uint8_t* SK_RESTRICT src,
+                    int width, int deltaSrc, int y, const SkPMColor ctable[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t c = vld4_u8(src + x * 4);
+        c.val[3] = vdup_n_u8(0xFF);
+        store_pmcolors_neon(dst + x, c);
+    }
+    return Sample_RGBx_D8888(dst + x, src + x * 4, width - x, deltaSrc, y,
+                             ctable);
+}
+
+static bool Sample_RGBA_D8888_neon(void* SK_RESTRICT dstRow,
+                                   const uint8_t* SK_RESTRICT src,
+                    int width, int deltaSrc, int y, const SkPMColor ctable[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    uint8x8_t alphaMask = vdup_n_u8(0xFF);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t c = vld4_u8(src + x * 4);
+        uint8x8_t a = c.val[3];
+        alphaMask = vand_u8(alphaMask, a);
+        c.val[0] = mul_div255_round_neon(c.val[0], a);
+        c.val[1] = mul_div255_round_neon(c.val[1], a);
+        c.val[2] = mul_div255_round_neon(c.val[2], a);
+        store_pmcolors_neon(dst + x, c);
+    }
+    bool hadAlpha = vget_lane_u64(vreinterpret_u64_u8(alphaMask), 0) !=
+                    ~(uint64_t)0;
+    return Sample_RGBA_D8888(dst + x, src + x * 4, width - x, deltaSrc, y,
+                             ctable) || hadAlpha;
+}
+
+static bool Sample_RGBx_D565_neon(void* SK_RESTRICT dstRow,
+                                  const uint8_t* SK_RESTRICT src,
+                    int width, int deltaSrc, int y, const SkPMColor ctable[]) {
+    SkASSERT(4 == deltaSrc);
+    uint16_t* SK_RESTRICT dst = (uint16_t*)dstRow;
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t c = vld4_u8(src + x * 4);
+        uint16x8_t r = vmovl_u8(vshr_n_u8(c.val[0], 3));
+        uint16x8_t g = vmovl_u8(vshr_n_u8(c.val[1], 2));
+        uint16x8_t b = vmovl_u8(vshr_n_u8(c.val[2], 3));
+        uint16x8_t d = vorrq_u16(vshlq_n_u16(r, SK_R16_SHIFT),
+                                 vorrq_u16(vshlq_n_u16(g, SK_G16_SHIFT),
+                                           vshlq_n_u16(b, SK_B16_SHIFT)));
+        vst1q_u16(dst + x, d);
+    }
+    return Sample_RGBx_D565(dst + x, src + x * 4, width - x, deltaSrc, y,
+                            ctable);
+}
+
+#define Sample_RGBx_D8888_Opt   Sample_RGBx_D8888_neon
+#define Sample_RGBA_D8888_Opt   Sample_RGBA_D8888_neon
+#define Sample_RGBx_D565_Opt    Sample_RGBx_D565_neon
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
 #include "SkScaledBitmapSampler.h"
 
 SkScaledBitmapSampler::SkScaledBitmapSampler(int width, int height,
@@ -421,7 +622,20 @@ bool SkScaledBitmapSampler::begin(SkBitmap* dst, SrcConfig sc, bool dither,
     }
     
     fRowProc = gProcs[index];
-    fDstRow = (char*)dst->getPixels();
+#ifdef Sample_RGBx_D8888_Opt
+    // whole rows of 4 byte pixels can use the vector procs
+    if (1 == fDX && 4 == fSrcPixelSize) {
+        if (Sample_RGBx_D8888 == fRowProc) {
+            fRowProc = Sample_RGBx_D8888_Opt;
+        } else if (Sample_RGBA_D8888 == fRowProc) {
+            fRowProc = Sample_RGBA_D8888_Opt;
+        } else if (Sample_RGBx_D565 == fRowProc) {
+            fRowProc = Sample_RGBx_D565_Opt;
+        }
+    }
+#endif
+    fDstPixels = (char*)dst->getPixels();
+    fDstRow = fDstPixels;
     fDstRowBytes = dst->rowBytes();
     fCurrY = 0;
     return fRowProc != NULL;
@@ -436,3 +650,13 @@ bool SkScaledBitmapSampler::next(const uint8_t* SK_RESTRICT src) {
     fCurrY += 1;
     return hadAlpha;
 }
+
+bool SkScaledBitmapSampler::sampleInterlaced(const uint8_t* SK_RESTRICT src,
+                                             int srcY) {
+    SkASSERT(srcY >= fY0 && 0 == (srcY - fY0) % fDY);
+    const int dstY = (srcY - fY0) / fDY;
+    SkASSERT(dstY < fScaledHeight);
+
+    return fRowProc(fDstPixels + dstY * fDstRowBytes, src + fX0 * fSrcPixelSize,
+                    fScaledWidth, fDX * fSrcPixelSize, dstY, fCTable);
+}
@@ -34,6 +34,12 @@ public:
     // returns true if the row had non-opaque alpha in it
     bool next(const uint8_t* SK_RESTRICT src);
 
+    // call with the row of src pixels at srcY, which must be one of the rows
+    // that is sampled (srcY0() + n * srcDY() for n < scaledHeight()). Unlike
+    // next(), the rows may be passed in any order (e.g. bottom-up).
+    // returns true if the row had non-opaque alpha in it
+    bool sampleInterlaced(const uint8_t* SK_RESTRICT src, int srcY);
+
 private:
     int fScaledWidth;
     int fScaledHeight;
@@ -49,6 +55,7 @@ private:
                             const SkPMColor[]);
 
     // setup state
+    char*   fDstPixels; // the bitmap's pixels
     char*   fDstRow; // points into bitmap's pixels
     int     fDstRowBytes;
     int     fCurrY; // used for dithering
@@ -28,6 +28,29 @@ bool BmpDecoderHelper::DecodeImage(const char* p,
                                    int len,
                                    int max_pixels,
                                    BmpDecoderCallback* callback) {
+  if (!ReadHeader(p, len, max_pixels)) {
+    return false;
+  }
+  // Deliberately off-by-one; a load of BMPs seem to have their last byte
+  // missing.
+  if (!rle_ && (pos_ + (rowLen_ * height_) > len_ + 1)) {
+    return false;
+  }
+
+  output_ = callback->SetSize(width_, height_);
+  if (NULL == output_) {
+    return true;  // meaning we succeeded, but they want us to stop now
+  }
+
+  if (rle_ && (bpp_ == 4 || bpp_ == 8)) {
+    DoRLEDecode();
+  } else {
+    DoStandardDecode();
+  }
+  return true;
+}
+
+bool BmpDecoderHelper::ReadHeader(const char* p, int len, int max_pixels) {
   data_ = reinterpret_cast<const uint8*>(p);
   pos_ = 0;
   len_ = len;
@@ -112,9 +135,9 @@ bool BmpDecoderHelper::DecodeImage(const char* p,
   redBits_ = 0x7c00;
   greenBits_ = 0x03e0;
   blueBits_ = 0x001f;
-  bool rle = false;
+  rle_ = false;
   if (comp == 1 || comp == 2) {
-    rle = true;
+    rle_ = true;
   } else if (comp == 3) {
     if (pos_ + 12 > len_) {
       return false;
@@ -159,26 +182,13 @@ bool BmpDecoderHelper::DecodeImage(const char* p,
     rowPad_ = 4 - (rowLen % 4);
     rowLen += rowPad_;
   }
+  rowLen_ = rowLen;
 
-  if (offset > 0 && offset > pos_ && offset < len_) {
+  // The offset may point at the very end of a header-only buffer.
+  if (offset > 0 && offset > pos_ && offset <= len_) {
     pos_ = offset;
   }
-  // Deliberately off-by-one; a load of BMPs seem to have their last byte
-  // missing.
-  if (!rle && (pos_ + (rowLen * height_) > len_ + 1)) {
-    return false;
-  }
-
-  output_ = callback->SetSize(width_, height_);
-  if (NULL == output_) {
-    return true;  // meaning we succeeded, but they want us to stop now
-  }
-
-  if (rle && (bpp_ == 4 || bpp_ == 8)) {
-    DoRLEDecode();
-  } else {
-    DoStandardDecode();
-  }
+  pixelOffset_ = pos_;
   return true;
 }
 
@@ -276,55 +286,62 @@ void BmpDecoderHelper::PutPixel(int x, int y, uint8 col) {
 }
 
 void BmpDecoderHelper::DoStandardDecode() {
-  int row = 0;
-  uint8 currVal = 0;
-  for (int h = height_ - 1; h >= 0; h--, row++) {
+  scoped_array<uint8> row(new uint8[rowLen_]);
+  for (int h = height_ - 1; h >= 0; h--) {
     int realH = h;
     if (!inverted_) {
       realH = height_ - (h + 1);
     }
-    uint8* line = output_ + (3 * width_ * realH);
-    for (int w = 0; w < width_; w++) {
-      if (bpp_ >= 24) {
-        line[2] = GetByte();
-        line[1] = GetByte();
-        line[0] = GetByte();
-      } else if (bpp_ == 16) {
-        uint32 val = GetShort();
-        line[0] = ((val & redBits_) >> redShiftRight_) << redShiftLeft_;
-        line[1] = ((val & greenBits_) >> greenShiftRight_) << greenShiftLeft_;
-        line[2] = ((val & blueBits_) >> blueShiftRight_) << blueShiftLeft_;
-      } else if (bpp_ <= 8) {
-        uint8 col;
-        if (bpp_ == 8) {
-          col = GetByte();
-        } else if (bpp_ == 4) {
-          if ((w % 2) == 0) {
-            currVal = GetByte();
-            col = currVal >> 4;
-          } else {
-            col = currVal & 0xf;
-          }
+    // The last row may be missing its last byte (see DecodeImage).
+    int count = len_ - pos_;
+    if (count > rowLen_) {
+      count = rowLen_;
+    }
+    memcpy(&row[0], data_ + pos_, count);
+    memset(&row[count], 0, rowLen_ - count);
+    pos_ += count;
+    DecodeRow(&row[0], output_ + (3 * width_ * realH));
+  }
+}
+
+void BmpDecoderHelper::DecodeRow(const uint8* src, uint8* line) const {
+  uint8 currVal = 0;
+  for (int w = 0; w < width_; w++) {
+    if (bpp_ >= 24) {
+      line[2] = *src++;
+      line[1] = *src++;
+      line[0] = *src++;
+      src += pixelPad_;
+    } else if (bpp_ == 16) {
+      uint32 val = src[0] | (src[1] << 8);
+      src += 2;
+      line[0] = ((val & redBits_) >> redShiftRight_) << redShiftLeft_;
+      line[1] = ((val & greenBits_) >> greenShiftRight_) << greenShiftLeft_;
+      line[2] = ((val & blueBits_) >> blueShiftRight_) << blueShiftLeft_;
+    } else if (bpp_ <= 8) {
+      uint8 col;
+      if (bpp_ == 8) {
+        col = *src++;
+      } else if (bpp_ == 4) {
+        if ((w % 2) == 0) {
+          currVal = *src++;
+          col = currVal >> 4;
         } else {
-          if ((w % 8) == 0) {
-            currVal = GetByte();
-          }
-          int bit = w & 7;
-          col = ((currVal >> (7 - bit)) & 1);
+          col = currVal & 0xf;
         }
-        int base = col * 3;
-        line[0] = colTab_[base];
-        line[1] = colTab_[base + 1];
-        line[2] = colTab_[base + 2];
-      }
-      line += 3;
-      for (int i = 0; i < pixelPad_; ++i) {
-        GetByte();
+      } else {
+        if ((w % 8) == 0) {
+          currVal = *src++;
+        }
+        int bit = w & 7;
+        col = ((currVal >> (7 - bit)) & 1);
       }
+      int base = col * 3;
+      line[0] = colTab_[base];
+      line[1] = colTab_[base + 1];
+      line[2] = colTab_[base + 2];
     }
-    for (int i = 0; i < rowPad_; ++i) {
-      GetByte();
-    }
+    line += 3;
   }
 }
 
@@ -83,6 +83,30 @@ class BmpDecoderHelper {
                    int max_pixels,
                    BmpDecoderCallback* callback);
 
+  /**
+   * Parses just the headers and colour map at the start of data, which must
+   * extend at least to the start of the pixels (the file header's offset).
+   * This lets a caller read the pixels a row at a time with DecodeRow().
+   */
+  bool ReadHeader(const char* data, int len, int max_pixels);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  // true if the first row in the file is the bottom row of the image
+  bool bottomUp() const { return inverted_; }
+  // true if the pixels are RLE compressed, and so can't be read by row
+  bool isRLE() const { return rle_; }
+  // offset of the pixels from the start of the data given to ReadHeader()
+  int pixelOffset() const { return pixelOffset_; }
+  // size of one (uncompressed) row of pixels in the file, padding included
+  int rowBytes() const { return rowLen_; }
+
+  /**
+   * Converts one uncompressed row of the file's pixels (rowBytes() long) to
+   * width() r,g,b triples.
+   */
+  void DecodeRow(const uint8* src, uint8* dst) const;
+
  private:
   DISALLOW_EVIL_CONSTRUCTORS(BmpDecoderHelper);
 
@@ -104,6 +128,9 @@ class BmpDecoderHelper {
   int bpp_;
   int pixelPad_;
   int rowPad_;
+  int rowLen_;
+  int pixelOffset_;
+  bool rle_;
   scoped_array<uint8> colTab_;
   uint32 redBits_;
   uint32 greenBits_;
@@ -0,0 +1,202 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include <emmintrin.h>
+#include <string.h>
+#include "SkAvoidXfermode_opts_SSE2.h"
+#include "SkColorPriv.h"
+
+/*  The procs do the portable math for every pixel, with no branches:
+
+    - the distance is the largest absolute difference of the color channels,
+      which is two saturating subtracts and two maxes;
+    - fDistMul is already the tolerance's reciprocal, so scaling the distance
+      is a multiply (kept to its low 32 bits, as scale_dist_14's int is), a
+      subtract and an arithmetic shift. Scales at or below 0 are pinned to 0,
+      which leaves the dst as it was;
+    - the blend is (src * s + dst * (256 - s)) >> 8 in 16 bit lanes, which is
+      SkAlphaBlend's dst + (((src - dst) * s) >> 8) without going negative.
+ */
+
+// (d * mul - sub + (1 << 13)) >> 14 in each 32 bit lane, pinned at 0
+static inline __m128i scale_dist_14(__m128i d, __m128i mul, __m128i sub) {
+    const __m128i even = _mm_set_epi32(0, -1, 0, -1);
+
+    __m128i p02 = _mm_mul_epu32(d, mul);
+    __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(d, 32), mul);
+    __m128i p = _mm_or_si128(_mm_and_si128(p02, even),
+                             _mm_slli_epi64(p13, 32));
+    p = _mm_sub_epi32(p, sub);
+    p = _mm_srai_epi32(_mm_add_epi32(p, _mm_set1_epi32(1 << 13)), 14);
+    return _mm_andnot_si128(_mm_srai_epi32(p, 31), p);
+}
+
+// SkAlphaMul(scale, Accurate255To256(aa)) for four pixels, in 32 bit lanes
+static inline __m128i apply_aa(__m128i scale, const SkAlpha aa[]) {
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t four;
+    memcpy(&four, aa, sizeof(four));
+    __m128i a = _mm_cvtsi32_si128(four);
+    a = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a, zero), zero);
+    a = _mm_add_epi32(a, _mm_srli_epi32(a, 7));
+    // both are at most 256, so each lane's top half is 0
+    return _mm_srli_epi32(_mm_madd_epi16(scale, a), 8);
+}
+
+// (src * s + dst * (256 - s)) >> 8 in each 16 bit lane
+static inline __m128i blend_16(__m128i src, __m128i dst, __m128i s) {
+    const __m128i s256 = _mm_sub_epi16(_mm_set1_epi16(256), s);
+    __m128i p = _mm_add_epi16(_mm_mullo_epi16(src, s),
+                              _mm_mullo_epi16(dst, s256));
+    return _mm_srli_epi16(p, 8);
+}
+
+int SkAvoidXfermode_Proc32_SSE2(const SkAvoidXfermode::State& state,
+                                SkPMColor dst[], const SkPMColor src[],
+                                int count, const SkAlpha aa[]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i op = _mm_set1_epi32((state.fOpR << SK_R32_SHIFT) |
+                                      (state.fOpG << SK_G32_SHIFT) |
+                                      (state.fOpB << SK_B32_SHIFT));
+    const __m128i rgbMask = _mm_set1_epi32(~(SK_A32_MASK << SK_A32_SHIFT));
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i flip = _mm_set1_epi32(state.fTarget ? 0xFF : 0);
+    const __m128i mul = _mm_set1_epi32(state.fDistMul);
+    const __m128i sub = _mm_set1_epi32((state.fDistMul - (1 << 14)) << 8);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)&dst[i]);
+        __m128i s = _mm_loadu_si128((const __m128i*)&src[i]);
+
+        // color_dist32, with alpha out of the way so any shift order works
+        __m128i dist = _mm_or_si128(_mm_subs_epu8(d, op),
+                                    _mm_subs_epu8(op, d));
+        dist = _mm_and_si128(dist, rgbMask);
+        dist = _mm_max_epu8(dist, _mm_srli_epi32(dist, 8));
+        dist = _mm_max_epu8(dist, _mm_srli_epi32(dist, 16));
+        dist = _mm_and_si128(dist, lowByte);
+
+        // 255 - dist for kTargetColor_Mode, then 0..256
+        dist = _mm_xor_si128(dist, flip);
+        dist = _mm_add_epi32(dist, _mm_srli_epi32(dist, 7));
+
+        __m128i scale = scale_dist_14(dist, mul, sub);
+        if (NULL != aa) {
+            scale = apply_aa(scale, &aa[i]);
+        }
+
+        // each pixel's scale in all four of its 16 bit channel lanes
+        scale = _mm_or_si128(scale, _mm_slli_epi32(scale, 16));
+        __m128i lo = blend_16(_mm_unpacklo_epi8(s, zero),
+                              _mm_unpacklo_epi8(d, zero),
+                              _mm_unpacklo_epi32(scale, scale));
+        __m128i hi = blend_16(_mm_unpackhi_epi8(s, zero),
+                              _mm_unpackhi_epi8(d, zero),
+                              _mm_unpackhi_epi32(scale, scale));
+        _mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// SkPacked32ToR16 and friends for eight pixels, in 16 bit lanes
+static inline __m128i packed32_to_16(__m128i s0, __m128i s1, int shift,
+                                     int mask) {
+    const __m128i m = _mm_set1_epi32(mask);
+    return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, shift), m),
+                           _mm_and_si128(_mm_srli_epi32(s1, shift), m));
+}
+
+static inline __m128i abs_diff_16(__m128i a, __m128i b) {
+    return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+int SkAvoidXfermode_Proc16_SSE2(const SkAvoidXfermode::State& state,
+                                uint16_t dst[], const SkPMColor src[],
+                                int count, const SkAlpha aa[]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opR = _mm_set1_epi16(state.fOpR >> (8 - SK_R16_BITS));
+    const __m128i opG = _mm_set1_epi16(state.fOpG >> (8 - SK_G16_BITS));
+    const __m128i opB = _mm_set1_epi16(state.fOpB >> (8 - SK_B16_BITS));
+    const __m128i maskR = _mm_set1_epi16(SK_R16_MASK);
+    const __m128i maskG = _mm_set1_epi16(SK_G16_MASK);
+    const __m128i maskB = _mm_set1_epi16(SK_B16_MASK);
+    const __m128i flip = _mm_set1_epi16(state.fTarget ? 31 : 0);
+    const __m128i mul = _mm_set1_epi32(state.fDistMul);
+    const __m128i sub = _mm_set1_epi32((state.fDistMul - (1 << 14)) <<
+                                       SK_R16_BITS);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i d = _mm_loadu_si128((const __m128i*)&dst[i]);
+        __m128i r = _mm_and_si128(_mm_srli_epi16(d, SK_R16_SHIFT), maskR);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(d, SK_G16_SHIFT), maskG);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(d, SK_B16_SHIFT), maskB);
+
+        // color_dist16, then 31 - dist for kTargetColor_Mode, then 0..32
+        __m128i dist = _mm_srli_epi16(abs_diff_16(g, opG),
+                                      SK_G16_BITS - SK_R16_BITS);
+        dist = _mm_max_epi16(dist, abs_diff_16(r, opR));
+        dist = _mm_max_epi16(dist, abs_diff_16(b, opB));
+        dist = _mm_xor_si128(dist, flip);
+        dist = _mm_add_epi16(dist, _mm_srli_epi16(dist, 4));
+
+        __m128i scaleLo = scale_dist_14(_mm_unpacklo_epi16(dist, zero),
+                                        mul, sub);
+        __m128i scaleHi = scale_dist_14(_mm_unpackhi_epi16(dist, zero),
+                                        mul, sub);
+        if (NULL != aa) {
+            scaleLo = apply_aa(scaleLo, &aa[i]);
+            scaleHi = apply_aa(scaleHi, &aa[i + 4]);
+        }
+        // SkBlend3216's scale <<= 3
+        __m128i scale = _mm_slli_epi16(_mm_packs_epi32(scaleLo, scaleHi), 3);
+
+        __m128i s0 = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i s1 = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+        r = blend_16(packed32_to_16(s0, s1,
+                                    SK_R32_SHIFT + SK_R32_BITS - SK_R16_BITS,
+                                    SK_R16_MASK), r, scale);
+        g = blend_16(packed32_to_16(s0, s1,
+                                    SK_G32_SHIFT + SK_G32_BITS - SK_G16_BITS,
+                                    SK_G16_MASK), g, scale);
+        b = blend_16(packed32_to_16(s0, s1,
+                                    SK_B32_SHIFT + SK_B32_BITS - SK_B16_BITS,
+                                    SK_B16_MASK), b, scale);
+
+        d = _mm_or_si128(_mm_slli_epi16(r, SK_R16_SHIFT),
+                         _mm_or_si128(_mm_slli_epi16(g, SK_G16_SHIFT),
+                                      _mm_slli_epi16(b, SK_B16_SHIFT)));
+        _mm_storeu_si128((__m128i*)&dst[i], d);
+    }
+    return i;
+}
+
+int SkPixelXorXfermode_Proc32_SSE2(uint32_t opColor, SkPMColor dst[],
+                                   const SkPMColor src[], int count) {
+    const __m128i op = _mm_set1_epi32(opColor);
+    const __m128i opaque = _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)&dst[i]);
+        __m128i s = _mm_loadu_si128((const __m128i*)&src[i]);
+        d = _mm_or_si128(_mm_xor_si128(_mm_xor_si128(s, d), op), opaque);
+        _mm_storeu_si128((__m128i*)&dst[i], d);
+    }
+    return i;
+}
@@ -0,0 +1,32 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkAvoidXfermode.h"
+#include "SkPixelXorXfermode.h"
+
+// Match SkAvoidXfermode::xfer32 and xfer16 exactly, four (or eight) pixels
+// at a time.
+
+int SkAvoidXfermode_Proc32_SSE2(const SkAvoidXfermode::State&, SkPMColor dst[],
+                                const SkPMColor src[], int count,
+                                const SkAlpha aa[]);
+int SkAvoidXfermode_Proc16_SSE2(const SkAvoidXfermode::State&, uint16_t dst[],
+                                const SkPMColor src[], int count,
+                                const SkAlpha aa[]);
+
+int SkPixelXorXfermode_Proc32_SSE2(uint32_t opColor, SkPMColor dst[],
+                                   const SkPMColor src[], int count);
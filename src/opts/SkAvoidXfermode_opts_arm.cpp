@@ -0,0 +1,58 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkAvoidXfermode.h"
+#include "SkPixelXorXfermode.h"
+#include "SkColorPriv.h"
+
+#if defined(__ARM_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__ARM_HAVE_NEON)
+
+static int PixelXor_neon(uint32_t opColor, SkPMColor dst[],
+                         const SkPMColor src[], int count) {
+    const uint32x4_t op = vdupq_n_u32(opColor);
+    const uint32x4_t opaque = vdupq_n_u32(SK_A32_MASK << SK_A32_SHIFT);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t d = vld1q_u32(&dst[i]);
+        uint32x4_t s = vld1q_u32(&src[i]);
+        vst1q_u32(&dst[i], vorrq_u32(veorq_u32(veorq_u32(s, d), op), opaque));
+    }
+    return i;
+}
+
+#define PIXEL_XOR_NEON  PixelXor_neon
+#else
+#define PIXEL_XOR_NEON  NULL
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkAvoidXfermode::Proc32 SkAvoidXfermode::PlatformProc32() {
+    return NULL;
+}
+
+SkAvoidXfermode::Proc16 SkAvoidXfermode::PlatformProc16() {
+    return NULL;
+}
+
+SkPixelXorXfermode::Proc32 SkPixelXorXfermode::PlatformProc32() {
+    return PIXEL_XOR_NEON;
+}
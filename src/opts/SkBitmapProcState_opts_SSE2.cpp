@@ -17,24 +17,11 @@
 
 #include <emmintrin.h>
 #include "SkBitmapProcState_opts_SSE2.h"
+#include "SkColorPriv.h"
 #include "SkUtils.h"
 
-void S32_opaque_D32_filter_DX_SSE2(const SkBitmapProcState& s,
-                                   const uint32_t* xy,
-                                   int count, uint32_t* colors) {
-    SkASSERT(count > 0 && colors != NULL);
-    SkASSERT(s.fDoFilter);
-    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
-    SkASSERT(s.fAlphaScale == 256);
-
-    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
-    unsigned rb = s.fBitmap->rowBytes();
-    uint32_t XY = *xy++;
-    unsigned y0 = XY >> 14;
-    const uint32_t* row0 = reinterpret_cast<const uint32_t*>(srcAddr + (y0 >> 4) * rb);
-    const uint32_t* row1 = reinterpret_cast<const uint32_t*>(srcAddr + (XY & 0x3FFF) * rb);
-    unsigned subY = y0 & 0xF;
-
+// Returns (16-y, 16-y, 16-y, 16-y, y, y, y, y), the weights of the two rows.
+static inline __m128i filter_y_weights(unsigned subY) {
     // ( 0,  0,  0,  0,  0,  0,  0, 16)
     __m128i sixteen = _mm_cvtsi32_si128(16);
 
@@ -51,78 +38,139 @@ void S32_opaque_D32_filter_DX_SSE2(const SkBitmapProcState& s,
     __m128i negY = _mm_sub_epi16(sixteen, allY);
 
     // (16-y, 16-y, 16-y, 16-y, y, y, y, y)
-    allY = _mm_unpacklo_epi64(allY, negY);
+    return _mm_unpacklo_epi64(allY, negY);
+}
 
+// Bilerps the pixels c00, c01 (row0) and c10, c11 (row1) by the x weight in
+// XX (x0:14 | 4 | x1:14).
+static inline uint32_t filter_32_pixels(uint32_t XX,
+                                        uint32_t c00, uint32_t c01,
+                                        uint32_t c10, uint32_t c11,
+                                        __m128i allY) {
     // (16, 16, 16, 16, 16, 16, 16, 16 )
-    sixteen = _mm_shuffle_epi32(sixteen, 0);
+    __m128i sixteen = _mm_set1_epi16(16);
 
     // ( 0,  0,  0,  0,  0,  0,  0,  0)
     __m128i zero = _mm_setzero_si128();
-    do {
-        uint32_t XX = *xy++;    // x0:14 | 4 | x1:14
-        unsigned x0 = XX >> 18;
-        unsigned x1 = XX & 0x3FFF;
 
-        // (0, 0, 0, 0, 0, 0, 0, x)
-        __m128i allX = _mm_cvtsi32_si128((XX >> 14) & 0x0F);
-        
-        // (0, 0, 0, 0, x, x, x, x)
-        allX = _mm_shufflelo_epi16(allX, 0);
+    // (0, 0, 0, 0, 0, 0, 0, x)
+    __m128i allX = _mm_cvtsi32_si128((XX >> 14) & 0x0F);
 
-        // (x, x, x, x, x, x, x, x)
-        allX = _mm_shuffle_epi32(allX, 0);
+    // (0, 0, 0, 0, x, x, x, x)
+    allX = _mm_shufflelo_epi16(allX, 0);
 
-        // (16-x, 16-x, 16-x, 16-x, 16-x, 16-x, 16-x)
-        __m128i negX = _mm_sub_epi16(sixteen, allX);
+    // (x, x, x, x, x, x, x, x)
+    allX = _mm_shuffle_epi32(allX, 0);
 
-        // Load 4 samples (pixels).
-        __m128i a00 = _mm_cvtsi32_si128(row0[x0]);
-        __m128i a01 = _mm_cvtsi32_si128(row0[x1]);
-        __m128i a10 = _mm_cvtsi32_si128(row1[x0]);
-        __m128i a11 = _mm_cvtsi32_si128(row1[x1]);
+    // (16-x, 16-x, 16-x, 16-x, 16-x, 16-x, 16-x)
+    __m128i negX = _mm_sub_epi16(sixteen, allX);
 
-        // (0, 0, a00, a10)
-        __m128i a00a10 = _mm_unpacklo_epi32(a10, a00);
+    // Load 4 samples (pixels).
+    __m128i a00 = _mm_cvtsi32_si128(c00);
+    __m128i a01 = _mm_cvtsi32_si128(c01);
+    __m128i a10 = _mm_cvtsi32_si128(c10);
+    __m128i a11 = _mm_cvtsi32_si128(c11);
 
-        // Expand to 16 bits per component.
-        a00a10 = _mm_unpacklo_epi8(a00a10, zero);
+    // (0, 0, a00, a10)
+    __m128i a00a10 = _mm_unpacklo_epi32(a10, a00);
 
-        // ((a00 * (16-y)), (a10 * y)).
-        a00a10 = _mm_mullo_epi16(a00a10, allY);
+    // Expand to 16 bits per component.
+    a00a10 = _mm_unpacklo_epi8(a00a10, zero);
 
-        // (a00 * (16-y) * (16-x), a10 * y * (16-x)).
-        a00a10 = _mm_mullo_epi16(a00a10, negX);
+    // ((a00 * (16-y)), (a10 * y)).
+    a00a10 = _mm_mullo_epi16(a00a10, allY);
 
-        // (0, 0, a01, a10)
-        __m128i a01a11 = _mm_unpacklo_epi32(a11, a01);
+    // (a00 * (16-y) * (16-x), a10 * y * (16-x)).
+    a00a10 = _mm_mullo_epi16(a00a10, negX);
 
-        // Expand to 16 bits per component.
-        a01a11 = _mm_unpacklo_epi8(a01a11, zero);
+    // (0, 0, a01, a10)
+    __m128i a01a11 = _mm_unpacklo_epi32(a11, a01);
 
-        // (a01 * (16-y)), (a11 * y)
-        a01a11 = _mm_mullo_epi16(a01a11, allY);
+    // Expand to 16 bits per component.
+    a01a11 = _mm_unpacklo_epi8(a01a11, zero);
 
-        // (a01 * (16-y) * x), (a11 * y * x)
-        a01a11 = _mm_mullo_epi16(a01a11, allX);
+    // (a01 * (16-y)), (a11 * y)
+    a01a11 = _mm_mullo_epi16(a01a11, allY);
 
-        // (a00*w00 + a01*w01, a10*w10 + a11*w11)
-        __m128i sum = _mm_add_epi16(a00a10, a01a11);
+    // (a01 * (16-y) * x), (a11 * y * x)
+    a01a11 = _mm_mullo_epi16(a01a11, allX);
 
-        // (DC, a00*w00 + a01*w01)
-        __m128i shifted = _mm_shuffle_epi32(sum, 0xEE);
+    // (a00*w00 + a01*w01, a10*w10 + a11*w11)
+    __m128i sum = _mm_add_epi16(a00a10, a01a11);
 
-        // (DC, a00*w00 + a01*w01 + a10*w10 + a11*w11)
-        sum = _mm_add_epi16(sum, shifted);
+    // (DC, a00*w00 + a01*w01)
+    __m128i shifted = _mm_shuffle_epi32(sum, 0xEE);
 
-        // Divide each 16 bit component by 256.
-        sum = _mm_srli_epi16(sum, 8);
+    // (DC, a00*w00 + a01*w01 + a10*w10 + a11*w11)
+    sum = _mm_add_epi16(sum, shifted);
 
-        // Pack lower 4 16 bit values of sum into lower 4 bytes.
-        sum = _mm_packus_epi16(sum, zero);
+    // Divide each 16 bit component by 256.
+    sum = _mm_srli_epi16(sum, 8);
 
-        // Extract low int and store.
-        *colors++ = _mm_cvtsi128_si32(sum);
+    // Pack lower 4 16 bit values of sum into lower 4 bytes.
+    sum = _mm_packus_epi16(sum, zero);
+
+    // Extract low int.
+    return _mm_cvtsi128_si32(sum);
+}
+
+// Bilerps the 4 pixels addressed by XX (x0:14 | 4 | x1:14) in row0 and row1.
+static inline uint32_t filter_32_opaque(uint32_t XX, const uint32_t* row0,
+                                        const uint32_t* row1, __m128i allY) {
+    unsigned x0 = XX >> 18;
+    unsigned x1 = XX & 0x3FFF;
+    return filter_32_pixels(XX, row0[x0], row0[x1], row1[x0], row1[x1], allY);
+}
+
+void S32_opaque_D32_filter_DX_SSE2(const SkBitmapProcState& s,
+                                   const uint32_t* xy,
+                                   int count, uint32_t* colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale == 256);
+
+    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+    unsigned rb = s.fBitmap->rowBytes();
+    uint32_t XY = *xy++;
+    unsigned y0 = XY >> 14;
+    const uint32_t* row0 = reinterpret_cast<const uint32_t*>(srcAddr + (y0 >> 4) * rb);
+    const uint32_t* row1 = reinterpret_cast<const uint32_t*>(srcAddr + (XY & 0x3FFF) * rb);
+    __m128i allY = filter_y_weights(y0 & 0xF);
+
+    do {
+        *colors++ = filter_32_opaque(*xy++, row0, row1, allY);
+    } while (--count > 0);
+}
+
+// Same as S32_opaque_D32_filter_DX_SSE2, looking each pixel up in the
+// (opaque) color table first.
+void SI8_opaque_D32_filter_DX_SSE2(const SkBitmapProcState& s,
+                                   const uint32_t* xy,
+                                   int count, uint32_t* colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kIndex8_Config);
+    SkASSERT(s.fAlphaScale == 256);
+
+    const SkPMColor* SK_RESTRICT table = s.fBitmap->getColorTable()->lockColors();
+    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+    unsigned rb = s.fBitmap->rowBytes();
+    uint32_t XY = *xy++;
+    unsigned y0 = XY >> 14;
+    const uint8_t* row0 = reinterpret_cast<const uint8_t*>(srcAddr + (y0 >> 4) * rb);
+    const uint8_t* row1 = reinterpret_cast<const uint8_t*>(srcAddr + (XY & 0x3FFF) * rb);
+    __m128i allY = filter_y_weights(y0 & 0xF);
+
+    do {
+        uint32_t XX = *xy++;
+        unsigned x0 = XX >> 18;
+        unsigned x1 = XX & 0x3FFF;
+        *colors++ = filter_32_pixels(XX, table[row0[x0]], table[row0[x1]],
+                                     table[row1[x0]], table[row1[x1]], allY);
     } while (--count > 0);
+
+    s.fBitmap->getColorTable()->unlockColors(false);
 }
 
 void S32_alpha_D32_filter_DX_SSE2(const SkBitmapProcState& s,
@@ -240,3 +288,720 @@ void S32_alpha_D32_filter_DX_SSE2(const SkBitmapProcState& s,
         *colors++ = _mm_cvtsi128_si32(sum);
     } while (--count > 0);
 }
+
+// The DXDY procs below take the (Y, X) pairs that the affine and perspective
+// matrix procs write, so every pixel has its own rows and weights.
+
+void S32_opaque_D32_filter_DXDY_SSE2(const SkBitmapProcState& s,
+                                     const uint32_t* xy,
+                                     int count, uint32_t* colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale == 256);
+
+    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+    unsigned rb = s.fBitmap->rowBytes();
+
+    do {
+        uint32_t YY = *xy++;    // y0:14 | 4 | y1:14
+        unsigned y0 = YY >> 18;
+        const uint32_t* row0 = reinterpret_cast<const uint32_t*>(srcAddr + y0 * rb);
+        const uint32_t* row1 = reinterpret_cast<const uint32_t*>(srcAddr + (YY & 0x3FFF) * rb);
+        *colors++ = filter_32_opaque(*xy++, row0, row1,
+                                     filter_y_weights((YY >> 14) & 0xF));
+    } while (--count > 0);
+}
+
+void S32_alpha_D32_filter_DXDY_SSE2(const SkBitmapProcState& s,
+                                    const uint32_t* xy,
+                                    int count, uint32_t* colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale < 256);
+
+    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+    unsigned rb = s.fBitmap->rowBytes();
+    unsigned alphaScale = s.fAlphaScale;
+
+    do {
+        uint32_t YY = *xy++;    // y0:14 | 4 | y1:14
+        unsigned y0 = YY >> 18;
+        const uint32_t* row0 = reinterpret_cast<const uint32_t*>(srcAddr + y0 * rb);
+        const uint32_t* row1 = reinterpret_cast<const uint32_t*>(srcAddr + (YY & 0x3FFF) * rb);
+        uint32_t c = filter_32_opaque(*xy++, row0, row1,
+                                      filter_y_weights((YY >> 14) & 0xF));
+        *colors++ = SkAlphaMulQ(c, alphaScale);
+    } while (--count > 0);
+}
+
+// Scales each component of the 4 pixels in c by alpha (in [0, 256]), as
+// SkAlphaMulQ does.
+static inline __m128i alpha_mul_4(__m128i c, __m128i alpha) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(c, zero);
+    __m128i hi = _mm_unpackhi_epi8(c, zero);
+    lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alpha), 8);
+    hi = _mm_srli_epi16(_mm_mullo_epi16(hi, alpha), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+void S32_alpha_D32_nofilter_DXDY_SSE2(const SkBitmapProcState& s,
+                                      const uint32_t* xy,
+                                      int count, uint32_t* colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(!s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale < 256);
+
+    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+    unsigned rb = s.fBitmap->rowBytes();
+    unsigned alphaScale = s.fAlphaScale;
+
+#define SAMPLE_XY(XY)   \
+    reinterpret_cast<const uint32_t*>(srcAddr + ((XY) >> 16) * rb)[(XY) & 0xFFFF]
+
+    if (count >= 4) {
+        const __m128i alpha = _mm_set1_epi16(alphaScale);
+        do {
+            __m128i c = _mm_set_epi32(SAMPLE_XY(xy[3]), SAMPLE_XY(xy[2]),
+                                      SAMPLE_XY(xy[1]), SAMPLE_XY(xy[0]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(colors),
+                             alpha_mul_4(c, alpha));
+            xy += 4;
+            colors += 4;
+            count -= 4;
+        } while (count >= 4);
+    }
+    while (--count >= 0) {
+        uint32_t XY = *xy++;
+        *colors++ = SkAlphaMulQ(SAMPLE_XY(XY), alphaScale);
+    }
+
+#undef SAMPLE_XY
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  The matrix procs below compute 4 coordinates at a time, and produce exactly
+    what the portable ClampX_ClampY and RepeatX_RepeatY procs do (see
+    SkBitmapProcState_matrix.h). The tile modes are described by a struct of
+    static functions, with a scalar version of each for the leftover pixels.
+    Wide() returns what the vector versions take for max.
+ */
+
+struct ClampTile {
+    static unsigned Index(SkFixed f, unsigned max) {
+        return SkClampMax(f >> 16, max);
+    }
+    static unsigned LowBits(SkFixed f, unsigned max) {
+        return (f >> 12) & 0xF;
+    }
+    static __m128i Wide(unsigned max) {
+        return _mm_set1_epi32(max);
+    }
+    static __m128i Index(__m128i f, __m128i max) {
+        f = _mm_srai_epi32(f, 16);
+        // negatives become 0
+        f = _mm_andnot_si128(_mm_srai_epi32(f, 31), f);
+        __m128i over = _mm_cmpgt_epi32(f, max);
+        return _mm_or_si128(_mm_and_si128(over, max),
+                            _mm_andnot_si128(over, f));
+    }
+    static __m128i LowBits(__m128i f, __m128i max) {
+        return _mm_and_si128(_mm_srli_epi32(f, 12), _mm_set1_epi32(0xF));
+    }
+};
+
+// requires max + 1 to fit in 16 bits, so that the multiplies can be 16x16
+struct RepeatTile {
+    static unsigned Index(SkFixed f, unsigned max) {
+        return ((f & 0xFFFF) * (max + 1)) >> 16;
+    }
+    static unsigned LowBits(SkFixed f, unsigned max) {
+        return (((f & 0xFFFF) * (max + 1)) >> 12) & 0xF;
+    }
+    static __m128i Wide(unsigned max) {
+        // the high half of each lane is 0, so it stays 0 in the products
+        return _mm_set1_epi32(max + 1);
+    }
+    static __m128i Index(__m128i f, __m128i maxPlusOne) {
+        f = _mm_and_si128(f, _mm_set1_epi32(0xFFFF));
+        return _mm_mulhi_epu16(f, maxPlusOne);
+    }
+    static __m128i LowBits(__m128i f, __m128i maxPlusOne) {
+        f = _mm_and_si128(f, _mm_set1_epi32(0xFFFF));
+        f = _mm_srli_epi32(_mm_mullo_epi16(f, maxPlusOne), 12);
+        return _mm_and_si128(f, _mm_set1_epi32(0xF));
+    }
+};
+
+template <typename Tile>
+static inline uint32_t pack_filter(SkFixed f, unsigned max, SkFixed one) {
+    unsigned i = (Tile::Index(f, max) << 4) | Tile::LowBits(f, max);
+    return (i << 14) | Tile::Index(f + one, max);
+}
+
+template <typename Tile>
+static inline __m128i pack_filter(__m128i f, __m128i max, __m128i one) {
+    __m128i i = _mm_or_si128(_mm_slli_epi32(Tile::Index(f, max), 4),
+                             Tile::LowBits(f, max));
+    return _mm_or_si128(_mm_slli_epi32(i, 14),
+                        Tile::Index(_mm_add_epi32(f, one), max));
+}
+
+// (f, f + d, f + 2d, f + 3d)
+static inline __m128i wide_ramp(SkFixed f, SkFixed d) {
+    return _mm_set_epi32(f + 3 * d, f + 2 * d, f + d, f);
+}
+
+// Packs 8 values in [0, 0xFFFF] into 16 bits each, a's first. packs_epi32
+// saturates signed values, so the values are biased into that range first.
+static inline __m128i pack_u16(__m128i a, __m128i b) {
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    a = _mm_sub_epi32(a, bias);
+    b = _mm_sub_epi32(b, bias);
+    return _mm_add_epi16(_mm_packs_epi32(a, b),
+                         _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+
+template <typename Tile>
+static void nofilter_scale(const SkBitmapProcState& s,
+                           uint32_t xy[], int count, int x, int y) {
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+
+    // we store y, x, x, x, x, x
+    const unsigned maxX = s.fBitmap->width() - 1;
+    SkFixed fx;
+    {
+        SkPoint pt;
+        s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                                  SkIntToScalar(y) + SK_ScalarHalf, &pt);
+        const unsigned maxY = s.fBitmap->height() - 1;
+        *xy++ = Tile::Index(SkScalarToFixed(pt.fY), maxY);
+        fx = SkScalarToFixed(pt.fX);
+    }
+
+    if (0 == maxX) {
+        // all of the following X values must be 0
+        memset(xy, 0, count * sizeof(uint16_t));
+        return;
+    }
+
+    const SkFixed dx = s.fInvSx;
+    uint16_t* xx = reinterpret_cast<uint16_t*>(xy);
+    if (count >= 8) {
+        const __m128i max = Tile::Wide(maxX);
+        const __m128i dx4 = _mm_set1_epi32(dx * 4);
+        __m128i wide_fx = wide_ramp(fx, dx);
+        do {
+            __m128i a = Tile::Index(wide_fx, max);
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            __m128i b = Tile::Index(wide_fx, max);
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xx), pack_u16(a, b));
+            xx += 8;
+            fx += dx * 8;
+            count -= 8;
+        } while (count >= 8);
+    }
+    while (--count >= 0) {
+        *xx++ = Tile::Index(fx, maxX);
+        fx += dx;
+    }
+}
+
+template <typename Tile>
+static void filter_scale(const SkBitmapProcState& s,
+                         uint32_t xy[], int count, int x, int y) {
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+    SkASSERT(s.fInvKy == 0);
+
+    const unsigned maxX = s.fBitmap->width() - 1;
+    const SkFixed one = s.fFilterOneX;
+    const SkFixed dx = s.fInvSx;
+    SkFixed fx;
+    {
+        SkPoint pt;
+        s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                                  SkIntToScalar(y) + SK_ScalarHalf, &pt);
+        const SkFixed fy = SkScalarToFixed(pt.fY) - (s.fFilterOneY >> 1);
+        const unsigned maxY = s.fBitmap->height() - 1;
+        *xy++ = pack_filter<Tile>(fy, maxY, s.fFilterOneY);
+        fx = SkScalarToFixed(pt.fX) - (one >> 1);
+    }
+
+    if (count >= 4) {
+        const __m128i max = Tile::Wide(maxX);
+        const __m128i wide_one = _mm_set1_epi32(one);
+        const __m128i dx4 = _mm_set1_epi32(dx * 4);
+        __m128i wide_fx = wide_ramp(fx, dx);
+        do {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy),
+                             pack_filter<Tile>(wide_fx, max, wide_one));
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            xy += 4;
+            fx += dx * 4;
+            count -= 4;
+        } while (count >= 4);
+    }
+    while (--count >= 0) {
+        *xy++ = pack_filter<Tile>(fx, maxX, one);
+        fx += dx;
+    }
+}
+
+template <typename Tile>
+static void nofilter_affine(const SkBitmapProcState& s,
+                            uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kAffine_Mask);
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask |
+                             SkMatrix::kAffine_Mask)) == 0);
+
+    SkPoint srcPt;
+    s.fInvProc(*s.fInvMatrix,
+               SkIntToScalar(x) + SK_ScalarHalf,
+               SkIntToScalar(y) + SK_ScalarHalf, &srcPt);
+
+    SkFixed fx = SkScalarToFixed(srcPt.fX);
+    SkFixed fy = SkScalarToFixed(srcPt.fY);
+    SkFixed dx = s.fInvSx;
+    SkFixed dy = s.fInvKy;
+    unsigned maxX = s.fBitmap->width() - 1;
+    unsigned maxY = s.fBitmap->height() - 1;
+
+    if (count >= 4) {
+        const __m128i wide_maxX = Tile::Wide(maxX);
+        const __m128i wide_maxY = Tile::Wide(maxY);
+        const __m128i dx4 = _mm_set1_epi32(dx * 4);
+        const __m128i dy4 = _mm_set1_epi32(dy * 4);
+        __m128i wide_fx = wide_ramp(fx, dx);
+        __m128i wide_fy = wide_ramp(fy, dy);
+        do {
+            __m128i yy = _mm_slli_epi32(Tile::Index(wide_fy, wide_maxY), 16);
+            __m128i xx = Tile::Index(wide_fx, wide_maxX);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy),
+                             _mm_or_si128(yy, xx));
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            wide_fy = _mm_add_epi32(wide_fy, dy4);
+            xy += 4;
+            fx += dx * 4;
+            fy += dy * 4;
+            count -= 4;
+        } while (count >= 4);
+    }
+    while (--count >= 0) {
+        *xy++ = (Tile::Index(fy, maxY) << 16) | Tile::Index(fx, maxX);
+        fx += dx;
+        fy += dy;
+    }
+}
+
+template <typename Tile>
+static void filter_affine(const SkBitmapProcState& s,
+                          uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kAffine_Mask);
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask |
+                             SkMatrix::kAffine_Mask)) == 0);
+
+    SkPoint srcPt;
+    s.fInvProc(*s.fInvMatrix,
+               SkIntToScalar(x) + SK_ScalarHalf,
+               SkIntToScalar(y) + SK_ScalarHalf, &srcPt);
+
+    SkFixed oneX = s.fFilterOneX;
+    SkFixed oneY = s.fFilterOneY;
+    SkFixed fx = SkScalarToFixed(srcPt.fX) - (oneX >> 1);
+    SkFixed fy = SkScalarToFixed(srcPt.fY) - (oneY >> 1);
+    SkFixed dx = s.fInvSx;
+    SkFixed dy = s.fInvKy;
+    unsigned maxX = s.fBitmap->width() - 1;
+    unsigned maxY = s.fBitmap->height() - 1;
+
+    if (count >= 4) {
+        const __m128i wide_maxX = Tile::Wide(maxX);
+        const __m128i wide_maxY = Tile::Wide(maxY);
+        const __m128i wide_oneX = _mm_set1_epi32(oneX);
+        const __m128i wide_oneY = _mm_set1_epi32(oneY);
+        const __m128i dx4 = _mm_set1_epi32(dx * 4);
+        const __m128i dy4 = _mm_set1_epi32(dy * 4);
+        __m128i wide_fx = wide_ramp(fx, dx);
+        __m128i wide_fy = wide_ramp(fy, dy);
+        do {
+            __m128i yy = pack_filter<Tile>(wide_fy, wide_maxY, wide_oneY);
+            __m128i xx = pack_filter<Tile>(wide_fx, wide_maxX, wide_oneX);
+            // we store y, x pairs
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy),
+                             _mm_unpacklo_epi32(yy, xx));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy + 4),
+                             _mm_unpackhi_epi32(yy, xx));
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            wide_fy = _mm_add_epi32(wide_fy, dy4);
+            xy += 8;
+            fx += dx * 4;
+            fy += dy * 4;
+            count -= 4;
+        } while (count >= 4);
+    }
+    while (--count >= 0) {
+        *xy++ = pack_filter<Tile>(fy, maxY, oneY);
+        fy += dy;
+        *xy++ = pack_filter<Tile>(fx, maxX, oneX);
+        fx += dx;
+    }
+}
+
+// Steps a row of pixels through the perspective inverse the way SkPerspIter
+// does: every kSpan pixels the exact point is mapped, and the ones in between
+// are stepped linearly from it, so the procs below match the portable ones.
+class PerspSpans {
+public:
+    PerspSpans(const SkBitmapProcState& s, int x, int y, int count)
+            : fState(s),
+              fSX(SkIntToScalar(x) + SK_ScalarHalf),
+              fSY(SkIntToScalar(y) + SK_ScalarHalf),
+              fCount(count) {
+        this->map(&fX, &fY);
+    }
+
+    // Returns the number of pixels in the next span, or 0 when the row is
+    // done, along with the span's first coordinate and per-pixel step.
+    int next(SkFixed* fx, SkFixed* fy, SkFixed* dx, SkFixed* dy) {
+        int n = SkMin32(fCount, kSpan);
+        if (0 == n) {
+            return 0;
+        }
+        *fx = fX;
+        *fy = fY;
+        fSX += SkIntToScalar(n);
+        this->map(&fX, &fY);
+        if (kSpan == n) {
+            *dx = (fX - *fx) >> kShift;
+            *dy = (fY - *fy) >> kShift;
+        } else {
+            *dx = (fX - *fx) / n;
+            *dy = (fY - *fy) / n;
+        }
+        fCount -= n;
+        return n;
+    }
+
+private:
+    enum {
+        kShift  = 4,
+        kSpan   = 1 << kShift   // same as SkPerspIter
+    };
+
+    void map(SkFixed* x, SkFixed* y) const {
+        SkPoint pt;
+        fState.fInvProc(*fState.fInvMatrix, fSX, fSY, &pt);
+        *x = SkScalarToFixed(pt.fX);
+        *y = SkScalarToFixed(pt.fY);
+    }
+
+    const SkBitmapProcState& fState;
+    SkScalar    fSX, fSY;
+    SkFixed     fX, fY;
+    int         fCount;
+};
+
+template <typename Tile>
+static void nofilter_persp(const SkBitmapProcState& s,
+                           uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kPerspective_Mask);
+
+    unsigned maxX = s.fBitmap->width() - 1;
+    unsigned maxY = s.fBitmap->height() - 1;
+    const __m128i wide_maxX = Tile::Wide(maxX);
+    const __m128i wide_maxY = Tile::Wide(maxY);
+
+    PerspSpans spans(s, x, y, count);
+    SkFixed fx, fy, dx, dy;
+    while ((count = spans.next(&fx, &fy, &dx, &dy)) != 0) {
+        if (count >= 4) {
+            const __m128i dx4 = _mm_set1_epi32(dx * 4);
+            const __m128i dy4 = _mm_set1_epi32(dy * 4);
+            __m128i wide_fx = wide_ramp(fx, dx);
+            __m128i wide_fy = wide_ramp(fy, dy);
+            do {
+                __m128i yy = _mm_slli_epi32(Tile::Index(wide_fy, wide_maxY),
+                                            16);
+                __m128i xx = Tile::Index(wide_fx, wide_maxX);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(xy),
+                                 _mm_or_si128(yy, xx));
+                wide_fx = _mm_add_epi32(wide_fx, dx4);
+                wide_fy = _mm_add_epi32(wide_fy, dy4);
+                xy += 4;
+                fx += dx * 4;
+                fy += dy * 4;
+                count -= 4;
+            } while (count >= 4);
+        }
+        while (--count >= 0) {
+            *xy++ = (Tile::Index(fy, maxY) << 16) | Tile::Index(fx, maxX);
+            fx += dx;
+            fy += dy;
+        }
+    }
+}
+
+template <typename Tile>
+static void filter_persp(const SkBitmapProcState& s,
+                         uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kPerspective_Mask);
+
+    SkFixed oneX = s.fFilterOneX;
+    SkFixed oneY = s.fFilterOneY;
+    unsigned maxX = s.fBitmap->width() - 1;
+    unsigned maxY = s.fBitmap->height() - 1;
+    const __m128i wide_maxX = Tile::Wide(maxX);
+    const __m128i wide_maxY = Tile::Wide(maxY);
+    const __m128i wide_oneX = _mm_set1_epi32(oneX);
+    const __m128i wide_oneY = _mm_set1_epi32(oneY);
+
+    PerspSpans spans(s, x, y, count);
+    SkFixed fx, fy, dx, dy;
+    while ((count = spans.next(&fx, &fy, &dx, &dy)) != 0) {
+        fx -= oneX >> 1;
+        fy -= oneY >> 1;
+        if (count >= 4) {
+            const __m128i dx4 = _mm_set1_epi32(dx * 4);
+            const __m128i dy4 = _mm_set1_epi32(dy * 4);
+            __m128i wide_fx = wide_ramp(fx, dx);
+            __m128i wide_fy = wide_ramp(fy, dy);
+            do {
+                __m128i yy = pack_filter<Tile>(wide_fy, wide_maxY, wide_oneY);
+                __m128i xx = pack_filter<Tile>(wide_fx, wide_maxX, wide_oneX);
+                // we store y, x pairs
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(xy),
+                                 _mm_unpacklo_epi32(yy, xx));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(xy + 4),
+                                 _mm_unpackhi_epi32(yy, xx));
+                wide_fx = _mm_add_epi32(wide_fx, dx4);
+                wide_fy = _mm_add_epi32(wide_fy, dy4);
+                xy += 8;
+                fx += dx * 4;
+                fy += dy * 4;
+                count -= 4;
+            } while (count >= 4);
+        }
+        while (--count >= 0) {
+            *xy++ = pack_filter<Tile>(fy, maxY, oneY);
+            fy += dy;
+            *xy++ = pack_filter<Tile>(fx, maxX, oneX);
+            fx += dx;
+        }
+    }
+}
+
+void ClampX_ClampY_nofilter_scale_SSE2(const SkBitmapProcState& s,
+                                       uint32_t xy[], int count, int x, int y) {
+    nofilter_scale<ClampTile>(s, xy, count, x, y);
+}
+
+void ClampX_ClampY_filter_scale_SSE2(const SkBitmapProcState& s,
+                                     uint32_t xy[], int count, int x, int y) {
+    filter_scale<ClampTile>(s, xy, count, x, y);
+}
+
+void ClampX_ClampY_nofilter_affine_SSE2(const SkBitmapProcState& s,
+                                        uint32_t xy[], int count,
+                                        int x, int y) {
+    nofilter_affine<ClampTile>(s, xy, count, x, y);
+}
+
+void ClampX_ClampY_filter_affine_SSE2(const SkBitmapProcState& s,
+                                      uint32_t xy[], int count, int x, int y) {
+    filter_affine<ClampTile>(s, xy, count, x, y);
+}
+
+void RepeatX_RepeatY_nofilter_scale_SSE2(const SkBitmapProcState& s,
+                                         uint32_t xy[], int count,
+                                         int x, int y) {
+    nofilter_scale<RepeatTile>(s, xy, count, x, y);
+}
+
+void RepeatX_RepeatY_filter_scale_SSE2(const SkBitmapProcState& s,
+                                       uint32_t xy[], int count, int x, int y) {
+    filter_scale<RepeatTile>(s, xy, count, x, y);
+}
+
+void RepeatX_RepeatY_nofilter_affine_SSE2(const SkBitmapProcState& s,
+                                          uint32_t xy[], int count,
+                                          int x, int y) {
+    nofilter_affine<RepeatTile>(s, xy, count, x, y);
+}
+
+void RepeatX_RepeatY_filter_affine_SSE2(const SkBitmapProcState& s,
+                                        uint32_t xy[], int count,
+                                        int x, int y) {
+    filter_affine<RepeatTile>(s, xy, count, x, y);
+}
+
+void ClampX_ClampY_nofilter_persp_SSE2(const SkBitmapProcState& s,
+                                       uint32_t xy[], int count, int x, int y) {
+    nofilter_persp<ClampTile>(s, xy, count, x, y);
+}
+
+void ClampX_ClampY_filter_persp_SSE2(const SkBitmapProcState& s,
+                                     uint32_t xy[], int count, int x, int y) {
+    filter_persp<ClampTile>(s, xy, count, x, y);
+}
+
+void RepeatX_RepeatY_nofilter_persp_SSE2(const SkBitmapProcState& s,
+                                         uint32_t xy[], int count,
+                                         int x, int y) {
+    nofilter_persp<RepeatTile>(s, xy, count, x, y);
+}
+
+void RepeatX_RepeatY_filter_persp_SSE2(const SkBitmapProcState& s,
+                                       uint32_t xy[], int count, int x, int y) {
+    filter_persp<RepeatTile>(s, xy, count, x, y);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  Shader procs for an opaque 8888 source that is scaled (or translated), which
+    sample each group of 4 pixels as soon as their coordinates are computed,
+    rather than going through the shader's buffer of coordinates.
+ */
+
+template <typename Tile>
+static void S32_opaque_D32_nofilter_DX_shaderproc(const SkBitmapProcState& s,
+                                                  int x, int y,
+                                                  SkPMColor* SK_RESTRICT colors,
+                                                  int count) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+    SkASSERT(!s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale == 256);
+
+    const unsigned maxX = s.fBitmap->width() - 1;
+    const SkFixed dx = s.fInvSx;
+    SkPoint pt;
+    s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                              SkIntToScalar(y) + SK_ScalarHalf, &pt);
+    SkFixed fx = SkScalarToFixed(pt.fX);
+    const unsigned maxY = s.fBitmap->height() - 1;
+    const SkPMColor* SK_RESTRICT row = s.fBitmap->getAddr32(0,
+                                Tile::Index(SkScalarToFixed(pt.fY), maxY));
+
+    if (count >= 4) {
+        const __m128i max = Tile::Wide(maxX);
+        const __m128i dx4 = _mm_set1_epi32(dx * 4);
+        __m128i wide_fx = wide_ramp(fx, dx);
+        uint32_t index[4];
+        do {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index),
+                             Tile::Index(wide_fx, max));
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(colors),
+                             _mm_set_epi32(row[index[3]], row[index[2]],
+                                           row[index[1]], row[index[0]]));
+            colors += 4;
+            fx += dx * 4;
+            count -= 4;
+        } while (count >= 4);
+    }
+    while (--count >= 0) {
+        *colors++ = row[Tile::Index(fx, maxX)];
+        fx += dx;
+    }
+}
+
+template <typename Tile>
+static void S32_opaque_D32_filter_DX_shaderproc(const SkBitmapProcState& s,
+                                                int x, int y,
+                                                SkPMColor* SK_RESTRICT colors,
+                                                int count) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(s.fAlphaScale == 256);
+
+    const unsigned maxX = s.fBitmap->width() - 1;
+    const SkFixed one = s.fFilterOneX;
+    const SkFixed dx = s.fInvSx;
+    SkPoint pt;
+    s.fInvProc(*s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                              SkIntToScalar(y) + SK_ScalarHalf, &pt);
+    SkFixed fx = SkScalarToFixed(pt.fX) - (one >> 1);
+
+    const uint32_t* row0;
+    const uint32_t* row1;
+    __m128i allY;
+    {
+        const SkFixed oneY = s.fFilterOneY;
+        const SkFixed fy = SkScalarToFixed(pt.fY) - (oneY >> 1);
+        const unsigned maxY = s.fBitmap->height() - 1;
+        const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+        unsigned rb = s.fBitmap->rowBytes();
+        row0 = reinterpret_cast<const uint32_t*>(srcAddr +
+                                                 Tile::Index(fy, maxY) * rb);
+        row1 = reinterpret_cast<const uint32_t*>(srcAddr +
+                                        Tile::Index(fy + oneY, maxY) * rb);
+        allY = filter_y_weights(Tile::LowBits(fy, maxY));
+    }
+
+    if (count >= 4) {
+        const __m128i max = Tile::Wide(maxX);
+        const __m128i wide_one = _mm_set1_epi32(one);
+        const __m128i dx4 = _mm_set1_epi32(dx * 4);
+        __m128i wide_fx = wide_ramp(fx, dx);
+        uint32_t XX[4];
+        do {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(XX),
+                             pack_filter<Tile>(wide_fx, max, wide_one));
+            wide_fx = _mm_add_epi32(wide_fx, dx4);
+            colors[0] = filter_32_opaque(XX[0], row0, row1, allY);
+            colors[1] = filter_32_opaque(XX[1], row0, row1, allY);
+            colors[2] = filter_32_opaque(XX[2], row0, row1, allY);
+            colors[3] = filter_32_opaque(XX[3], row0, row1, allY);
+            colors += 4;
+            fx += dx * 4;
+            count -= 4;
+        } while (count >= 4);
+    }
+    while (--count >= 0) {
+        *colors++ = filter_32_opaque(pack_filter<Tile>(fx, maxX, one),
+                                     row0, row1, allY);
+        fx += dx;
+    }
+}
+
+void Clamp_S32_opaque_D32_nofilter_DX_shaderproc_SSE2(
+                                            const SkBitmapProcState& s,
+                                            int x, int y,
+                                            SkPMColor colors[], int count) {
+    S32_opaque_D32_nofilter_DX_shaderproc<ClampTile>(s, x, y, colors, count);
+}
+
+void Clamp_S32_opaque_D32_filter_DX_shaderproc_SSE2(
+                                            const SkBitmapProcState& s,
+                                            int x, int y,
+                                            SkPMColor colors[], int count) {
+    S32_opaque_D32_filter_DX_shaderproc<ClampTile>(s, x, y, colors, count);
+}
+
+void Repeat_S32_opaque_D32_nofilter_DX_shaderproc_SSE2(
+                                            const SkBitmapProcState& s,
+                                            int x, int y,
+                                            SkPMColor colors[], int count) {
+    S32_opaque_D32_nofilter_DX_shaderproc<RepeatTile>(s, x, y, colors, count);
+}
+
+void Repeat_S32_opaque_D32_filter_DX_shaderproc_SSE2(
+                                            const SkBitmapProcState& s,
+                                            int x, int y,
+                                            SkPMColor colors[], int count) {
+    S32_opaque_D32_filter_DX_shaderproc<RepeatTile>(s, x, y, colors, count);
+}
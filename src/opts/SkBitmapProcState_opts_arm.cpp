@@ -22,6 +22,10 @@
 #include "SkColorPriv.h"
 #include "SkUtils.h"
 
+#if defined(__ARM_HAVE_NEON) && !defined(SK_CPU_BENDIAN)
+#include <arm_neon.h>
+#endif
+
 #if __ARM_ARCH__ >= 6 && !defined(SK_CPU_BENDIAN)
 void SI8_D16_nofilter_DX_arm(
     const SkBitmapProcState& s,
@@ -197,6 +201,311 @@ void SI8_opaque_D32_nofilter_DX_arm(const SkBitmapProcState& s,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#if defined(__ARM_HAVE_NEON) && !defined(SK_CPU_BENDIAN)
+/*  Bilinear filtering, two 8888 pixels or four 565 ones at a time. The
+    weights are the portable filters' (Filter_32_opaque, Filter_32_alpha and
+    Filter_565_Expanded), applied in the same integer steps, so the results
+    are identical. Each pixel's neighbors are gathered into small arrays,
+    which are then loaded a lane per pixel (or per pixel's channel).
+ */
+
+// the four neighbors of two 8888 pixels, and their weights in every lane
+// that holds one of the pixel's channels
+struct Pair8888 {
+    SkPMColor   fA00[2], fA01[2], fA10[2], fA11[2];
+    uint8_t     fY[8];
+    uint16_t    fX[8];
+
+    void set(int i, SkPMColor a00, SkPMColor a01, SkPMColor a10,
+             SkPMColor a11, unsigned subX, unsigned subY) {
+        fA00[i] = a00;
+        fA01[i] = a01;
+        fA10[i] = a10;
+        fA11[i] = a11;
+        for (int j = 4 * i; j < 4 * i + 4; j++) {
+            fY[j] = subY;
+            fX[j] = subX;
+        }
+    }
+};
+
+// Filter_32_opaque for both pixels, or Filter_32_alpha if alpha is set. The
+// sums are at most 255 * 16 * 16, so they fit in 16 bits.
+template <bool alpha>
+static inline uint32x2_t filter_pair_8888(const Pair8888& p,
+                                          uint16x8_t alphaScale) {
+    const uint8x8_t y = vld1_u8(p.fY);
+    const uint8x8_t iy = vsub_u8(vdup_n_u8(16), y);
+    const uint16x8_t x = vld1q_u16(p.fX);
+    const uint16x8_t ix = vsubq_u16(vdupq_n_u16(16), x);
+
+    uint16x8_t left = vmull_u8(vreinterpret_u8_u32(vld1_u32(p.fA00)), iy);
+    left = vmlal_u8(left, vreinterpret_u8_u32(vld1_u32(p.fA10)), y);
+    uint16x8_t right = vmull_u8(vreinterpret_u8_u32(vld1_u32(p.fA01)), iy);
+    right = vmlal_u8(right, vreinterpret_u8_u32(vld1_u32(p.fA11)), y);
+    uint16x8_t sum = vmlaq_u16(vmulq_u16(left, ix), right, x);
+
+    if (alpha) {
+        sum = vmulq_u16(vshrq_n_u16(sum, 8), alphaScale);
+    }
+    return vreinterpret_u32_u8(vshrn_n_u16(sum, 8));
+}
+
+template <bool alpha>
+static void S32_D32_filter_DX_neon(const SkBitmapProcState& s,
+                                   const uint32_t* SK_RESTRICT xy,
+                                   int count, SkPMColor* SK_RESTRICT colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(alpha == (s.fAlphaScale < 256));
+
+    const char* SK_RESTRICT srcAddr = (const char*)s.fBitmap->getPixels();
+    unsigned rb = s.fBitmap->rowBytes();
+    const uint16x8_t alphaScale = vdupq_n_u16(s.fAlphaScale);
+
+    uint32_t XY = *xy++;
+    unsigned y0 = XY >> 14;
+    const SkPMColor* SK_RESTRICT row0 = (const SkPMColor*)(srcAddr +
+                                                           (y0 >> 4) * rb);
+    const SkPMColor* SK_RESTRICT row1 = (const SkPMColor*)(srcAddr +
+                                                           (XY & 0x3FFF) * rb);
+    unsigned subY = y0 & 0xF;
+
+    Pair8888 p;
+    while (count > 0) {
+        // an odd pixel at the end is filtered twice, and stored once
+        int n = count >= 2 ? 2 : 1;
+        for (int i = 0; i < 2; i++) {
+            uint32_t XX = xy[i < n ? i : 0];    // x0:14 | 4 | x1:14
+            unsigned x0 = XX >> 18;
+            unsigned x1 = XX & 0x3FFF;
+            p.set(i, row0[x0], row0[x1], row1[x0], row1[x1],
+                  (XX >> 14) & 0xF, subY);
+        }
+        uint32x2_t c = filter_pair_8888<alpha>(p, alphaScale);
+        if (2 == n) {
+            vst1_u32(colors, c);
+        } else {
+            vst1_lane_u32(colors, c, 0);
+        }
+        xy += n;
+        colors += n;
+        count -= n;
+    }
+}
+
+template <bool alpha>
+static void S32_D32_filter_DXDY_neon(const SkBitmapProcState& s,
+                                     const uint32_t* SK_RESTRICT xy,
+                                     int count, SkPMColor* SK_RESTRICT colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kARGB_8888_Config);
+    SkASSERT(alpha == (s.fAlphaScale < 256));
+
+    const char* SK_RESTRICT srcAddr = (const char*)s.fBitmap->getPixels();
+    unsigned rb = s.fBitmap->rowBytes();
+    const uint16x8_t alphaScale = vdupq_n_u16(s.fAlphaScale);
+
+    Pair8888 p;
+    while (count > 0) {
+        int n = count >= 2 ? 2 : 1;
+        for (int i = 0; i < 2; i++) {
+            const uint32_t* data = xy + 2 * (i < n ? i : 0);
+            unsigned y0 = data[0] >> 14;
+            unsigned x0 = data[1] >> 14;
+            const SkPMColor* SK_RESTRICT row0 = (const SkPMColor*)(srcAddr +
+                                                            (y0 >> 4) * rb);
+            const SkPMColor* SK_RESTRICT row1 = (const SkPMColor*)(srcAddr +
+                                                    (data[0] & 0x3FFF) * rb);
+            unsigned x1 = data[1] & 0x3FFF;
+            p.set(i, row0[x0 >> 4], row0[x1], row1[x0 >> 4], row1[x1],
+                  x0 & 0xF, y0 & 0xF);
+        }
+        uint32x2_t c = filter_pair_8888<alpha>(p, alphaScale);
+        if (2 == n) {
+            vst1_u32(colors, c);
+        } else {
+            vst1_lane_u32(colors, c, 0);
+        }
+        xy += 2 * n;
+        colors += n;
+        count -= n;
+    }
+}
+
+// the four neighbors of four 565 pixels, and their weights
+struct Quad565 {
+    uint16_t    fA00[4], fA01[4], fA10[4], fA11[4];
+    uint16_t    fX[4], fY[4];
+
+    void set(int i, uint16_t a00, uint16_t a01, uint16_t a10, uint16_t a11,
+             unsigned subX, unsigned subY) {
+        fA00[i] = a00;
+        fA01[i] = a01;
+        fA10[i] = a10;
+        fA11[i] = a11;
+        fX[i] = subX;
+        fY[i] = subY;
+    }
+};
+
+static inline uint16x4_t load_565_channel(const uint16_t src[4],
+                                          int16x4_t shift, uint16x4_t mask) {
+    return vand_u16(vshl_u16(vld1_u16(src), shift), mask);
+}
+
+// one 565 channel of the four pixels, filtered with Filter_565_Expanded's
+// weights; the sums are at most 63 * 32
+static inline uint16x4_t filter_565_channel(const Quad565& q, int shift,
+                                            unsigned mask, uint16x4_t w00,
+                                            uint16x4_t w01, uint16x4_t w10,
+                                            uint16x4_t w11) {
+    const int16x4_t sh = vdup_n_s16(-shift);
+    const uint16x4_t m = vdup_n_u16(mask);
+    uint16x4_t sum = vmul_u16(load_565_channel(q.fA00, sh, m), w00);
+    sum = vmla_u16(sum, load_565_channel(q.fA01, sh, m), w01);
+    sum = vmla_u16(sum, load_565_channel(q.fA10, sh, m), w10);
+    return vmla_u16(sum, load_565_channel(q.fA11, sh, m), w11);
+}
+
+// Filter_565_Expanded and SkExpanded_565_To_PMColor for four pixels, and
+// then SkAlphaMulQ if alpha is set. The expanded form keeps each channel's
+// sum in a field of its own, so filtering the channels apart is the same.
+template <bool alpha>
+static inline uint32x4_t filter_quad_565(const Quad565& q,
+                                         uint16x4_t alphaScale) {
+    const uint16x4_t x = vld1_u16(q.fX);
+    const uint16x4_t y = vld1_u16(q.fY);
+    const uint16x4_t w11 = vshr_n_u16(vmul_u16(x, y), 3);
+    const uint16x4_t w01 = vsub_u16(vshl_n_u16(x, 1), w11);
+    const uint16x4_t w10 = vsub_u16(vshl_n_u16(y, 1), w11);
+    const uint16x4_t w00 = vsub_u16(vsub_u16(vdup_n_u16(32), w11),
+                                    vadd_u16(w01, w10));
+
+    uint16x4_t r = vshr_n_u16(filter_565_channel(q, SK_R16_SHIFT, SK_R16_MASK,
+                                                 w00, w01, w10, w11), 2);
+    uint16x4_t g = vshr_n_u16(filter_565_channel(q, SK_G16_SHIFT, SK_G16_MASK,
+                                                 w00, w01, w10, w11), 3);
+    uint16x4_t b = vshr_n_u16(filter_565_channel(q, SK_B16_SHIFT, SK_B16_MASK,
+                                                 w00, w01, w10, w11), 2);
+    uint16x4_t a = vdup_n_u16(0xFF);
+    if (alpha) {
+        a = vshr_n_u16(vmul_u16(a, alphaScale), 8);
+        r = vshr_n_u16(vmul_u16(r, alphaScale), 8);
+        g = vshr_n_u16(vmul_u16(g, alphaScale), 8);
+        b = vshr_n_u16(vmul_u16(b, alphaScale), 8);
+    }
+
+    uint32x4_t c = vshlq_n_u32(vmovl_u16(a), SK_A32_SHIFT);
+    c = vorrq_u32(c, vshlq_n_u32(vmovl_u16(r), SK_R32_SHIFT));
+    c = vorrq_u32(c, vshlq_n_u32(vmovl_u16(g), SK_G32_SHIFT));
+    return vorrq_u32(c, vshlq_n_u32(vmovl_u16(b), SK_B32_SHIFT));
+}
+
+static inline void store_quad(SkPMColor* SK_RESTRICT colors, uint32x4_t c,
+                              int n) {
+    if (4 == n) {
+        vst1q_u32(colors, c);
+    } else {
+        SkPMColor tmp[4];
+        vst1q_u32(tmp, c);
+        memcpy(colors, tmp, n * sizeof(SkPMColor));
+    }
+}
+
+template <bool alpha>
+static void S16_D32_filter_DX_neon(const SkBitmapProcState& s,
+                                   const uint32_t* SK_RESTRICT xy,
+                                   int count, SkPMColor* SK_RESTRICT colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kRGB_565_Config);
+    SkASSERT(alpha == (s.fAlphaScale < 256));
+
+    const char* SK_RESTRICT srcAddr = (const char*)s.fBitmap->getPixels();
+    unsigned rb = s.fBitmap->rowBytes();
+    const uint16x4_t alphaScale = vdup_n_u16(s.fAlphaScale);
+
+    uint32_t XY = *xy++;
+    unsigned y0 = XY >> 14;
+    const uint16_t* SK_RESTRICT row0 = (const uint16_t*)(srcAddr +
+                                                         (y0 >> 4) * rb);
+    const uint16_t* SK_RESTRICT row1 = (const uint16_t*)(srcAddr +
+                                                         (XY & 0x3FFF) * rb);
+    unsigned subY = y0 & 0xF;
+
+    Quad565 q;
+    while (count > 0) {
+        // the lanes past the end filter the first pixel again
+        int n = count >= 4 ? 4 : count;
+        for (int i = 0; i < 4; i++) {
+            uint32_t XX = xy[i < n ? i : 0];    // x0:14 | 4 | x1:14
+            unsigned x0 = XX >> 18;
+            unsigned x1 = XX & 0x3FFF;
+            q.set(i, row0[x0], row0[x1], row1[x0], row1[x1],
+                  (XX >> 14) & 0xF, subY);
+        }
+        store_quad(colors, filter_quad_565<alpha>(q, alphaScale), n);
+        xy += n;
+        colors += n;
+        count -= n;
+    }
+}
+
+template <bool alpha>
+static void S16_D32_filter_DXDY_neon(const SkBitmapProcState& s,
+                                     const uint32_t* SK_RESTRICT xy,
+                                     int count, SkPMColor* SK_RESTRICT colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fDoFilter);
+    SkASSERT(s.fBitmap->config() == SkBitmap::kRGB_565_Config);
+    SkASSERT(alpha == (s.fAlphaScale < 256));
+
+    const char* SK_RESTRICT srcAddr = (const char*)s.fBitmap->getPixels();
+    unsigned rb = s.fBitmap->rowBytes();
+    const uint16x4_t alphaScale = vdup_n_u16(s.fAlphaScale);
+
+    Quad565 q;
+    while (count > 0) {
+        int n = count >= 4 ? 4 : count;
+        for (int i = 0; i < 4; i++) {
+            const uint32_t* data = xy + 2 * (i < n ? i : 0);
+            unsigned y0 = data[0] >> 14;
+            unsigned x0 = data[1] >> 14;
+            const uint16_t* SK_RESTRICT row0 = (const uint16_t*)(srcAddr +
+                                                            (y0 >> 4) * rb);
+            const uint16_t* SK_RESTRICT row1 = (const uint16_t*)(srcAddr +
+                                                    (data[0] & 0x3FFF) * rb);
+            unsigned x1 = data[1] & 0x3FFF;
+            q.set(i, row0[x0 >> 4], row0[x1], row1[x0 >> 4], row1[x1],
+                  x0 & 0xF, y0 & 0xF);
+        }
+        store_quad(colors, filter_quad_565<alpha>(q, alphaScale), n);
+        xy += 2 * n;
+        colors += n;
+        count -= n;
+    }
+}
+
+static const struct {
+    SkBitmapProcState::SampleProc32 fProc;
+    SkBitmapProcState::SampleProc32 fProcNEON;
+} gFilterProcs32[] = {
+    { S32_opaque_D32_filter_DX,     S32_D32_filter_DX_neon<false>   },
+    { S32_alpha_D32_filter_DX,      S32_D32_filter_DX_neon<true>    },
+    { S32_opaque_D32_filter_DXDY,   S32_D32_filter_DXDY_neon<false> },
+    { S32_alpha_D32_filter_DXDY,    S32_D32_filter_DXDY_neon<true>  },
+    { S16_opaque_D32_filter_DX,     S16_D32_filter_DX_neon<false>   },
+    { S16_alpha_D32_filter_DX,      S16_D32_filter_DX_neon<true>    },
+    { S16_opaque_D32_filter_DXDY,   S16_D32_filter_DXDY_neon<false> },
+    { S16_alpha_D32_filter_DXDY,    S16_D32_filter_DXDY_neon<true>  },
+};
+#endif  // defined(__ARM_HAVE_NEON) && !defined(SK_CPU_BENDIAN)
+
+///////////////////////////////////////////////////////////////////////////////
+
 /*  If we replace a sampleproc, then we null-out the associated shaderproc,
     otherwise the shader won't even look at the matrix/sampler
  */
@@ -223,6 +532,21 @@ void SkBitmapProcState::platformProcs() {
                     fShaderProc32 = NULL;
                 }
             }
+#endif
+            break;
+        case SkBitmap::kARGB_8888_Config:
+        case SkBitmap::kRGB_565_Config:
+#if defined(__ARM_HAVE_NEON) && !defined(SK_CPU_BENDIAN)
+            if (doFilter) {
+                for (size_t i = 0; i < SK_ARRAY_COUNT(gFilterProcs32); i++) {
+                    if (fSampleProc32 == gFilterProcs32[i].fProc) {
+                        // the fused shaderprocs filter a pixel at a time
+                        fSampleProc32 = gFilterProcs32[i].fProcNEON;
+                        fShaderProc32 = NULL;
+                        break;
+                    }
+                }
+            }
 #endif
             break;
         default:
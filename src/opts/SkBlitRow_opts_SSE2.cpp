@@ -17,7 +17,9 @@
 
 #include "SkBlitRow_opts_SSE2.h"
 #include "SkColorPriv.h"
+#include "SkDither.h"
 #include "SkUtils.h"
+#include "SkXfermode.h"
 
 #include <emmintrin.h>
 
@@ -391,101 +393,1009 @@ void Color32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
     }
 }
 
+/*  Expand 4 coverage bytes into 16-bit words, one pair per pixel, so that the
+    same value can scale both the red/blue and the alpha/green halves.
+ */
+static inline __m128i expand_coverage(uint32_t aa4) {
+    __m128i aa = _mm_cvtsi32_si128(aa4);
+    aa = _mm_unpacklo_epi8(aa, _mm_setzero_si128());
+    return _mm_unpacklo_epi16(aa, aa);
+}
+
+// (c * scale) >> 8 for each channel of 4 pixels, as SkAlphaMulQ does
+static inline __m128i alpha_mul_q(__m128i c, __m128i scale, __m128i rb_mask) {
+    __m128i rb = _mm_and_si128(rb_mask, c);
+    __m128i ag = _mm_srli_epi16(c, 8);
+    rb = _mm_srli_epi16(_mm_mullo_epi16(rb, scale), 8);
+    ag = _mm_andnot_si128(rb_mask, _mm_mullo_epi16(ag, scale));
+    return _mm_or_si128(rb, ag);
+}
+
+// the alpha of each of 4 pixels, copied into both of its 16-bit words
+static inline __m128i splat_alpha(__m128i c) {
+    __m128i a = _mm_srli_epi16(c, 8);
+    a = _mm_shufflehi_epi16(a, 0xF5);
+    return _mm_shufflelo_epi16(a, 0xF5);
+}
+
 void SkARGB32_BlitMask_SSE2(void* device, size_t dstRB,
                             SkBitmap::Config dstConfig, const uint8_t* mask,
                             size_t maskRB, SkColor origColor,
                             int width, int height)
 {
     SkPMColor color = SkPreMultiplyColor(origColor);
+    const bool opaque = (0xFF == SkGetPackedA32(color));
     size_t dstOffset = dstRB - (width << 2);
     size_t maskOffset = maskRB - width;
     SkPMColor* dst = (SkPMColor *)device;
+
+    __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+    __m128i c_256 = _mm_set1_epi16(256);
+    __m128i c_1 = _mm_set1_epi16(1);
+    __m128i src_pixel = _mm_set1_epi32(color);
     do {
         int count = width;
-        if (count >= 4) {
-            while (((size_t)dst & 0x0F) != 0 && (count > 0)) {
-                *dst = SkBlendARGB32(color, *dst, *mask);
-                mask++;
-                dst++;
-                count--;
+        while (count >= 4) {
+            uint32_t aa4 = *reinterpret_cast<const uint32_t*>(mask);
+            __m128i* d = reinterpret_cast<__m128i*>(dst);
+            if (opaque && 0xFFFFFFFF == aa4) {
+                _mm_storeu_si128(d, src_pixel);
+            } else if (aa4) {
+                __m128i dst_pixel = _mm_loadu_si128(d);
+
+                // SkAlpha255To256(aa)
+                __m128i src_scale = _mm_add_epi16(expand_coverage(aa4), c_1);
+                __m128i src = alpha_mul_q(src_pixel, src_scale, rb_mask);
+
+                // 256 - (src alpha * src_scale >> 8)
+                __m128i dst_scale = _mm_sub_epi16(c_256, splat_alpha(src));
+                dst_pixel = alpha_mul_q(dst_pixel, dst_scale, rb_mask);
+
+                _mm_storeu_si128(d, _mm_add_epi8(src, dst_pixel));
             }
-            __m128i *d = reinterpret_cast<__m128i*>(dst);
-            __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
-            __m128i c_256 = _mm_set1_epi16(256);
-            __m128i c_1 = _mm_set1_epi16(1);
-            __m128i src_pixel = _mm_set1_epi32(color);
-            while (count >= 4) {
-                // Load 4 pixels each of src and dest.
-                __m128i dst_pixel = _mm_load_si128(d);
+            mask += 4;
+            dst += 4;
+            count -= 4;
+        }
+        while (count > 0) {
+            *dst = SkBlendARGB32(color, *dst, *mask);
+            dst += 1;
+            mask++;
+            count --;
+        }
+        dst = (SkPMColor *)((char*)dst + dstOffset);
+        mask += maskOffset;
+    } while (--height != 0);
+}
 
-                //set the aphla value
-                __m128i src_scale_wide =  _mm_set_epi8(0, *(mask+3),\
-                                0, *(mask+3),0, \
-                                *(mask+2),0, *(mask+2),\
-                                0,*(mask+1), 0,*(mask+1),\
-                                0, *mask,0,*mask);
+void ColorAA32_SSE2(SkPMColor dst[], const SkAlpha aa[], int count,
+                    SkPMColor color) {
+    __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+    __m128i c_255 = _mm_set1_epi16(255);
+    __m128i c_1 = _mm_set1_epi16(1);
+    __m128i src_pixel = _mm_set1_epi32(color);
+
+    while (count >= 4) {
+        uint32_t aa4 = *reinterpret_cast<const uint32_t*>(aa);
+        if (aa4) {
+            __m128i* d = reinterpret_cast<__m128i*>(dst);
+            __m128i dst_pixel = _mm_loadu_si128(d);
+
+            __m128i coverage = expand_coverage(aa4);
+            __m128i src = alpha_mul_q(src_pixel, _mm_add_epi16(coverage, c_1),
+                                      rb_mask);
+            // the same scale Color32 uses: 255 - src alpha
+            __m128i dst_scale = _mm_sub_epi16(c_255, splat_alpha(src));
+            __m128i result = _mm_add_epi8(src,
+                                alpha_mul_q(dst_pixel, dst_scale, rb_mask));
+
+            // leave the pixels with no coverage untouched
+            __m128i skip = _mm_cmpeq_epi32(coverage, _mm_setzero_si128());
+            result = _mm_or_si128(_mm_and_si128(skip, dst_pixel),
+                                  _mm_andnot_si128(skip, result));
+            _mm_storeu_si128(d, result);
+        }
+        aa += 4;
+        dst += 4;
+        count -= 4;
+    }
+    SkBlitRow::ColorAA32(dst, aa, count, color);
+}
 
-                //call SkAlpha255To256()
-                src_scale_wide = _mm_add_epi16(src_scale_wide, c_1);
+// src + (dst * (256 - src) >> 8), for alphas in 16-bit lanes
+static inline __m128i srcover_a8(__m128i src, __m128i dst, __m128i c_256) {
+    __m128i dst_scale = _mm_sub_epi16(c_256, src);
+    return _mm_add_epi16(src, _mm_srli_epi16(_mm_mullo_epi16(dst, dst_scale),
+                                             8));
+}
 
-                // Get red and blue pixels into lower byte of each word.
-                __m128i dst_rb = _mm_and_si128(rb_mask, dst_pixel);
-                __m128i src_rb = _mm_and_si128(rb_mask, src_pixel);
+// SkAlphaMul(alpha, SkAlpha255To256(aa)), for alphas in 16-bit lanes
+static inline __m128i scale_a8(__m128i alpha, __m128i aa, __m128i c_1) {
+    return _mm_srli_epi16(_mm_mullo_epi16(alpha, _mm_add_epi16(aa, c_1)), 8);
+}
 
-                // Get alpha and green into lower byte of each word.
-                __m128i dst_ag = _mm_srli_epi16(dst_pixel, 8);
-                __m128i src_ag = _mm_srli_epi16(src_pixel, 8);
+static inline bool all_zero(__m128i aa) {
+    return 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(aa,
+                                                      _mm_setzero_si128()));
+}
 
-                // Put per-pixel alpha in low byte of each word.
-                __m128i dst_alpha = _mm_shufflehi_epi16(src_ag, 0xF5);
-                dst_alpha = _mm_shufflelo_epi16(dst_alpha, 0xF5);
+void ColorA8_SSE2(uint8_t dst[], const SkAlpha aa[], int count, U8CPU alpha) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i c_1 = _mm_set1_epi16(1);
+    __m128i c_256 = _mm_set1_epi16(256);
+    __m128i src = _mm_set1_epi16(alpha);
+
+    while (count >= 16) {
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i src_lo = src;
+        __m128i src_hi = src;
+        if (aa) {
+            __m128i aa16 = _mm_loadu_si128(
+                                    reinterpret_cast<const __m128i*>(aa));
+            aa += 16;
+            if (all_zero(aa16)) {
+                dst += 16;
+                count -= 16;
+                continue;
+            }
+            src_lo = scale_a8(src, _mm_unpacklo_epi8(aa16, zero), c_1);
+            src_hi = scale_a8(src, _mm_unpackhi_epi8(aa16, zero), c_1);
+        }
+        __m128i dst16 = _mm_loadu_si128(d);
+        __m128i lo = srcover_a8(src_lo, _mm_unpacklo_epi8(dst16, zero), c_256);
+        __m128i hi = srcover_a8(src_hi, _mm_unpackhi_epi8(dst16, zero), c_256);
+        _mm_storeu_si128(d, _mm_packus_epi16(lo, hi));
+        dst += 16;
+        count -= 16;
+    }
+    SkBlitRow::ColorA8(dst, aa, count, alpha);
+}
 
-                // dst_alpha = dst_alpha * src_scale
-                dst_alpha = _mm_mullo_epi16(dst_alpha, src_scale_wide);
+void AlphaA8_SSE2(uint8_t dst[], const SkAlpha src[], const SkAlpha aa[],
+                  int count) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i c_1 = _mm_set1_epi16(1);
+    __m128i c_256 = _mm_set1_epi16(256);
+
+    while (count >= 16) {
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i src16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i src_lo = _mm_unpacklo_epi8(src16, zero);
+        __m128i src_hi = _mm_unpackhi_epi8(src16, zero);
+        if (aa) {
+            __m128i aa16 = _mm_loadu_si128(
+                                    reinterpret_cast<const __m128i*>(aa));
+            aa += 16;
+            src_lo = scale_a8(src_lo, _mm_unpacklo_epi8(aa16, zero), c_1);
+            src_hi = scale_a8(src_hi, _mm_unpackhi_epi8(aa16, zero), c_1);
+        }
+        __m128i dst16 = _mm_loadu_si128(d);
+        __m128i lo = srcover_a8(src_lo, _mm_unpacklo_epi8(dst16, zero), c_256);
+        __m128i hi = srcover_a8(src_hi, _mm_unpackhi_epi8(dst16, zero), c_256);
+        _mm_storeu_si128(d, _mm_packus_epi16(lo, hi));
+        src += 16;
+        dst += 16;
+        count -= 16;
+    }
+    SkBlitRow::AlphaA8(dst, src, aa, count);
+}
 
-                // Divide by 256.
-                dst_alpha = _mm_srli_epi16(dst_alpha, 8);
+///////////////////////////////////////////////////////////////////////////////
 
-                // Subtract alphas from 256, to get 1..256
-                dst_alpha = _mm_sub_epi16(c_256, dst_alpha);
-                // Multiply red and blue by dst pixel alpha.
-                dst_rb = _mm_mullo_epi16(dst_rb, dst_alpha);
-                // Multiply alpha and green by dst pixel alpha.
-                dst_ag = _mm_mullo_epi16(dst_ag, dst_alpha);
+/*  Xfermode row procs. Each op works on two pixels at a time, unpacked into
+    eight 16-bit lanes, and mirrors the arithmetic of the matching modeproc in
+    src/core/SkXfermode.cpp so that the results are identical.
+ */
 
-                // Multiply red and blue by global alpha.
-                src_rb = _mm_mullo_epi16(src_rb, src_scale_wide);
-                // Multiply alpha and green by global alpha.
-                src_ag = _mm_mullo_epi16(src_ag, src_scale_wide);
-                // Divide by 256.
-                dst_rb = _mm_srli_epi16(dst_rb, 8);
-                src_rb = _mm_srli_epi16(src_rb, 8);
+// SkMulDiv255Round for each lane; a and b must be 0..255
+static inline __m128i mul_div_255_round(__m128i a, __m128i b) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
 
-                // Mask out low bits (goodies already in the right place; no need to divide)
-                dst_ag = _mm_andnot_si128(rb_mask, dst_ag);
-                src_ag = _mm_andnot_si128(rb_mask, src_ag);
+// SkDiv255Round for each lane; prod must be 0..255*255
+static inline __m128i div_255_round(__m128i prod) {
+    prod = _mm_add_epi16(prod, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
 
-                // Combine back into RGBA.
-                dst_pixel = _mm_or_si128(dst_rb, dst_ag);
-                __m128i tmp_src_pixel = _mm_or_si128(src_rb, src_ag);
+// the alpha of each of the 2 unpacked pixels, copied into all 4 of its lanes
+static inline __m128i splat_alpha16(__m128i c) {
+    c = _mm_shufflelo_epi16(c, 0xFF);
+    return _mm_shufflehi_epi16(c, 0xFF);
+}
 
-                // Add two pixels into result.
-                __m128i result = _mm_add_epi8(tmp_src_pixel, dst_pixel);
-                _mm_store_si128(d, result);
-                // load the next 4 pixel
-                mask = mask + 4;
-                d++;
-                count -= 4;
-            }
-            dst = reinterpret_cast<SkPMColor *>(d);
+// selects the alpha lanes of the 2 unpacked pixels
+static inline __m128i alpha_lanes() {
+    return _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+}
+
+// SSE2 has no unsigned 16-bit max/min, so flip the sign bit around the
+// signed versions
+static inline __m128i max_epu16(__m128i a, __m128i b) {
+    __m128i bias = _mm_set1_epi16((short)0x8000);
+    return _mm_xor_si128(bias, _mm_max_epi16(_mm_xor_si128(bias, a),
+                                             _mm_xor_si128(bias, b)));
+}
+
+static inline __m128i min_epu16(__m128i a, __m128i b) {
+    __m128i bias = _mm_set1_epi16((short)0x8000);
+    return _mm_xor_si128(bias, _mm_min_epi16(_mm_xor_si128(bias, a),
+                                             _mm_xor_si128(bias, b)));
+}
+
+struct MultiplyOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        return mul_div_255_round(s, d);
+    }
+};
+
+struct ScreenOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        return _mm_sub_epi16(_mm_add_epi16(s, d), mul_div_255_round(s, d));
+    }
+};
+
+// the alpha lanes come out as srcover_byte(sa, da), since sd == ds there
+struct DarkenOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        __m128i sd = _mm_mullo_epi16(s, splat_alpha16(d));
+        __m128i ds = _mm_mullo_epi16(d, splat_alpha16(s));
+        return _mm_sub_epi16(_mm_add_epi16(s, d),
+                             div_255_round(max_epu16(sd, ds)));
+    }
+};
+
+struct LightenOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        __m128i sd = _mm_mullo_epi16(s, splat_alpha16(d));
+        __m128i ds = _mm_mullo_epi16(d, splat_alpha16(s));
+        return _mm_sub_epi16(_mm_add_epi16(s, d),
+                             div_255_round(min_epu16(sd, ds)));
+    }
+};
+
+// SkAlphaMulQ(src, SkAlpha255To256(da))
+struct SrcInOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        __m128i scale = _mm_add_epi16(splat_alpha16(d), _mm_set1_epi16(1));
+        return _mm_srli_epi16(_mm_mullo_epi16(s, scale), 8);
+    }
+};
+
+// SkAlphaMulQ(dst, SkAlpha255To256(sa))
+struct DstInOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        __m128i scale = _mm_add_epi16(splat_alpha16(s), _mm_set1_epi16(1));
+        return _mm_srli_epi16(_mm_mullo_epi16(d, scale), 8);
+    }
+};
+
+// SkAlphaMulQ(dst, SkAlpha255To256(255 - sa))
+struct DstOutOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        __m128i scale = _mm_sub_epi16(_mm_set1_epi16(256), splat_alpha16(s));
+        return _mm_srli_epi16(_mm_mullo_epi16(d, scale), 8);
+    }
+};
+
+struct SrcATopOp_SSE2 {
+    static inline __m128i Op(__m128i s, __m128i d) {
+        __m128i isa = _mm_sub_epi16(_mm_set1_epi16(255), splat_alpha16(s));
+        __m128i c = _mm_add_epi16(mul_div_255_round(splat_alpha16(d), s),
+                                  mul_div_255_round(isa, d));
+        // the result alpha is just da
+        __m128i mask = alpha_lanes();
+        return _mm_or_si128(_mm_and_si128(mask, d), _mm_andnot_si128(mask, c));
+    }
+};
+
+// XferOp provides Op(src, dst), applied to 2 unpacked pixels at a time
+template <typename XferOp, SkXfermode::Mode mode>
+static void xfer32_SSE2(SkPMColor* SK_RESTRICT dst,
+                        const SkPMColor* SK_RESTRICT src, int count) {
+    __m128i zero = _mm_setzero_si128();
+    while (count >= 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i dst_pixel = _mm_loadu_si128(d);
+
+        __m128i lo = XferOp::Op(_mm_unpacklo_epi8(s, zero),
+                                _mm_unpacklo_epi8(dst_pixel, zero));
+        __m128i hi = XferOp::Op(_mm_unpackhi_epi8(s, zero),
+                                _mm_unpackhi_epi8(dst_pixel, zero));
+        _mm_storeu_si128(d, _mm_packus_epi16(lo, hi));
+
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+    if (count > 0) {
+        SkXfermodeProc proc = SkXfermode::GetProc(mode);
+        for (int i = 0; i < count; i++) {
+            dst[i] = proc(src[i], dst[i]);
         }
-        while(count > 0) {
-            *dst= SkBlendARGB32(color, *dst, *mask);
-            dst += 1;
-            mask++;
-            count --;
+    }
+}
+
+void Multiply_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<MultiplyOp_SSE2, SkXfermode::kMultiply_Mode>(dst, src, count);
+}
+
+void Screen_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<ScreenOp_SSE2, SkXfermode::kScreen_Mode>(dst, src, count);
+}
+
+void Darken_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<DarkenOp_SSE2, SkXfermode::kDarken_Mode>(dst, src, count);
+}
+
+void Lighten_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<LightenOp_SSE2, SkXfermode::kLighten_Mode>(dst, src, count);
+}
+
+void SrcIn_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<SrcInOp_SSE2, SkXfermode::kSrcIn_Mode>(dst, src, count);
+}
+
+void DstIn_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<DstInOp_SSE2, SkXfermode::kDstIn_Mode>(dst, src, count);
+}
+
+void DstOut_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<DstOutOp_SSE2, SkXfermode::kDstOut_Mode>(dst, src, count);
+}
+
+void SrcATop_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count) {
+    xfer32_SSE2<SrcATopOp_SSE2, SkXfermode::kSrcATop_Mode>(dst, src, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  565 row procs. Each block is eight pixels: the src colors are unpacked into
+    a register per channel, in 16-bit lanes, and the math is that of the
+    matching proc in src/core/SkBlitRow_D16.cpp, so that the results are
+    identical. S32A_D565_Opaque_Dither blends in SkExpand_rgb_16's packed
+    form, so it works on four pixels at a time in 32-bit lanes instead. A
+    short row (or the end of one) goes through a block of its own.
+
+    The dither values repeat every four pixels, so one register of them
+    serves every block of a row.
+ */
+
+struct Row565 {
+    __m128i fDither;    // DITHER_VALUE for each pixel of a block
+    unsigned fAlpha;
+};
+
+// Block provides Blit(dst, src, row), applied to 8 pixels at a time
+template <typename Block>
+static void blit_row_565(uint16_t* SK_RESTRICT dst,
+                         const SkPMColor* SK_RESTRICT src, int count,
+                         U8CPU alpha, int x, int y) {
+    Row565 row;
+    row.fAlpha = alpha;
+
+    DITHER_565_SCAN(y);
+    row.fDither = _mm_set_epi16(DITHER_VALUE(x + 7), DITHER_VALUE(x + 6),
+                                DITHER_VALUE(x + 5), DITHER_VALUE(x + 4),
+                                DITHER_VALUE(x + 3), DITHER_VALUE(x + 2),
+                                DITHER_VALUE(x + 1), DITHER_VALUE(x));
+
+    while (count >= 8) {
+        Block::Blit(dst, src, row);
+        dst += 8;
+        src += 8;
+        count -= 8;
+    }
+    if (count > 0) {
+        uint16_t tmpDst[8];
+        SkPMColor tmpSrc[8];
+        memset(tmpSrc, 0, sizeof(tmpSrc));
+        memcpy(tmpSrc, src, count * sizeof(SkPMColor));
+        memcpy(tmpDst, dst, count * sizeof(uint16_t));
+        Block::Blit(tmpDst, tmpSrc, row);
+        memcpy(dst, tmpDst, count * sizeof(uint16_t));
+    }
+}
+
+// the 8 bit channel at shift of the pixels of s0 and then s1, in 16-bit lanes
+static inline __m128i channel_16(__m128i s0, __m128i s1, int shift) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, shift), mask),
+                           _mm_and_si128(_mm_srli_epi32(s1, shift), mask));
+}
+
+struct Src8 {
+    __m128i fA, fR, fG, fB;
+    __m128i fZero;      // -1 in the lanes of the pixels that are 0
+    bool    fAllZero;
+};
+
+static inline void load_src8(const SkPMColor src[], Src8* s) {
+    __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+    s->fA = channel_16(s0, s1, SK_A32_SHIFT);
+    s->fR = channel_16(s0, s1, SK_R32_SHIFT);
+    s->fG = channel_16(s0, s1, SK_G32_SHIFT);
+    s->fB = channel_16(s0, s1, SK_B32_SHIFT);
+
+    const __m128i zero = _mm_setzero_si128();
+    s->fZero = _mm_packs_epi32(_mm_cmpeq_epi32(s0, zero),
+                               _mm_cmpeq_epi32(s1, zero));
+    s->fAllZero = 0xFFFF == _mm_movemask_epi8(s->fZero);
+}
+
+struct Dst8 {
+    __m128i fPixels, fR, fG, fB;
+};
+
+static inline void load_dst8(const uint16_t dst[], Dst8* d) {
+    d->fPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+    d->fR = _mm_and_si128(_mm_srli_epi16(d->fPixels, SK_R16_SHIFT),
+                          _mm_set1_epi16(SK_R16_MASK));
+    d->fG = _mm_and_si128(_mm_srli_epi16(d->fPixels, SK_G16_SHIFT),
+                          _mm_set1_epi16(SK_G16_MASK));
+    d->fB = _mm_and_si128(_mm_srli_epi16(d->fPixels, SK_B16_SHIFT),
+                          _mm_set1_epi16(SK_B16_MASK));
+}
+
+// SkPackRGB16 for each lane
+static inline __m128i pack_565(__m128i r, __m128i g, __m128i b) {
+    return _mm_or_si128(_mm_slli_epi16(r, SK_R16_SHIFT),
+                        _mm_or_si128(_mm_slli_epi16(g, SK_G16_SHIFT),
+                                     _mm_slli_epi16(b, SK_B16_SHIFT)));
+}
+
+// stores c, except where the src was 0, which keeps the dst
+static inline void store_unless_zero(uint16_t dst[], __m128i c,
+                                     const Src8& s, const Dst8& d) {
+    c = _mm_or_si128(_mm_and_si128(s.fZero, d.fPixels),
+                     _mm_andnot_si128(s.fZero, c));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), c);
+}
+
+// SkAlphaBlend for each lane; src and dst are at most 63, scale 256
+static inline __m128i alpha_blend_16(__m128i src, __m128i dst, __m128i scale) {
+    __m128i diff = _mm_mullo_epi16(_mm_sub_epi16(src, dst), scale);
+    return _mm_add_epi16(dst, _mm_srai_epi16(diff, 8));
+}
+
+// SkMul16ShiftRound for each lane
+static inline __m128i mul16_shift_round(__m128i a, __m128i b, int shift) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(a, b),
+                                 _mm_set1_epi16(1 << (shift - 1)));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, shift)),
+                          shift);
+}
+
+// SkDITHER_R32_FOR_565 and friends for each lane
+static inline __m128i dither_r32_for_565(__m128i r, __m128i d) {
+    return _mm_sub_epi16(_mm_add_epi16(r, d), _mm_srli_epi16(r, 5));
+}
+
+static inline __m128i dither_g32_for_565(__m128i g, __m128i d) {
+    return _mm_sub_epi16(_mm_add_epi16(g, _mm_srli_epi16(d, 1)),
+                         _mm_srli_epi16(g, 6));
+}
+
+struct S32_D565_Opaque_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565&) {
+        Src8 s;
+        load_src8(src, &s);
+        __m128i c = pack_565(_mm_srli_epi16(s.fR, 8 - SK_R16_BITS),
+                             _mm_srli_epi16(s.fG, 8 - SK_G16_BITS),
+                             _mm_srli_epi16(s.fB, 8 - SK_B16_BITS));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), c);
+    }
+};
+
+struct S32_D565_Blend_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565& row) {
+        Src8 s;
+        Dst8 d;
+        load_src8(src, &s);
+        load_dst8(dst, &d);
+        const __m128i scale = _mm_set1_epi16(SkAlpha255To256(row.fAlpha));
+        __m128i r = alpha_blend_16(_mm_srli_epi16(s.fR, 8 - SK_R16_BITS), d.fR,
+                                   scale);
+        __m128i g = alpha_blend_16(_mm_srli_epi16(s.fG, 8 - SK_G16_BITS), d.fG,
+                                   scale);
+        __m128i b = alpha_blend_16(_mm_srli_epi16(s.fB, 8 - SK_B16_BITS), d.fB,
+                                   scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), pack_565(r, g, b));
+    }
+};
+
+struct S32A_D565_Opaque_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565&) {
+        Src8 s;
+        load_src8(src, &s);
+        if (s.fAllZero) {
+            return;
         }
-        dst = (SkPMColor *)((char*)dst + dstOffset);
-        mask += maskOffset;
+        Dst8 d;
+        load_dst8(dst, &d);
+
+        // SkSrcOver32To16
+        __m128i isa = _mm_sub_epi16(_mm_set1_epi16(255), s.fA);
+        __m128i r = _mm_add_epi16(s.fR,
+                                  mul16_shift_round(d.fR, isa, SK_R16_BITS));
+        __m128i g = _mm_add_epi16(s.fG,
+                                  mul16_shift_round(d.fG, isa, SK_G16_BITS));
+        __m128i b = _mm_add_epi16(s.fB,
+                                  mul16_shift_round(d.fB, isa, SK_B16_BITS));
+        __m128i c = pack_565(_mm_srli_epi16(r, 8 - SK_R16_BITS),
+                             _mm_srli_epi16(g, 8 - SK_G16_BITS),
+                             _mm_srli_epi16(b, 8 - SK_B16_BITS));
+        store_unless_zero(dst, c, s, d);
+    }
+};
+
+struct S32A_D565_Blend_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565& row) {
+        Src8 s;
+        load_src8(src, &s);
+        if (s.fAllZero) {
+            return;
+        }
+        Dst8 d;
+        load_dst8(dst, &d);
+
+        const __m128i alpha = _mm_set1_epi16(row.fAlpha);
+        __m128i dstScale = _mm_sub_epi16(_mm_set1_epi16(255),
+                                         mul_div_255_round(s.fA, alpha));
+        __m128i r = _mm_add_epi16(
+                _mm_mullo_epi16(_mm_srli_epi16(s.fR, 8 - SK_R16_BITS), alpha),
+                _mm_mullo_epi16(d.fR, dstScale));
+        __m128i g = _mm_add_epi16(
+                _mm_mullo_epi16(_mm_srli_epi16(s.fG, 8 - SK_G16_BITS), alpha),
+                _mm_mullo_epi16(d.fG, dstScale));
+        __m128i b = _mm_add_epi16(
+                _mm_mullo_epi16(_mm_srli_epi16(s.fB, 8 - SK_B16_BITS), alpha),
+                _mm_mullo_epi16(d.fB, dstScale));
+        __m128i c = pack_565(div_255_round(r), div_255_round(g),
+                             div_255_round(b));
+        store_unless_zero(dst, c, s, d);
+    }
+};
+
+struct S32_D565_Opaque_Dither_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565& row) {
+        Src8 s;
+        load_src8(src, &s);
+        // SkDitherRGB32To565
+        __m128i r = dither_r32_for_565(s.fR, row.fDither);
+        __m128i g = dither_g32_for_565(s.fG, row.fDither);
+        __m128i b = dither_r32_for_565(s.fB, row.fDither);
+        __m128i c = pack_565(_mm_srli_epi16(r, 8 - SK_R16_BITS),
+                             _mm_srli_epi16(g, 8 - SK_G16_BITS),
+                             _mm_srli_epi16(b, 8 - SK_B16_BITS));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), c);
+    }
+};
+
+struct S32_D565_Blend_Dither_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565& row) {
+        Src8 s;
+        Dst8 d;
+        load_src8(src, &s);
+        load_dst8(dst, &d);
+        const __m128i scale = _mm_set1_epi16(SkAlpha255To256(row.fAlpha));
+        __m128i r = _mm_srli_epi16(dither_r32_for_565(s.fR, row.fDither),
+                                   8 - SK_R16_BITS);
+        __m128i g = _mm_srli_epi16(dither_g32_for_565(s.fG, row.fDither),
+                                   8 - SK_G16_BITS);
+        __m128i b = _mm_srli_epi16(dither_r32_for_565(s.fB, row.fDither),
+                                   8 - SK_B16_BITS);
+        __m128i c = pack_565(alpha_blend_16(r, d.fR, scale),
+                             alpha_blend_16(g, d.fG, scale),
+                             alpha_blend_16(b, d.fB, scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), c);
+    }
+};
+
+// the low 32 bits of a * b for each lane
+static inline __m128i mullo_epi32(__m128i a, __m128i b) {
+    const __m128i even = _mm_set_epi32(0, -1, 0, -1);
+    __m128i p02 = _mm_mul_epu32(a, b);
+    __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_or_si128(_mm_and_si128(p02, even), _mm_slli_epi64(p13, 32));
+}
+
+// SkExpand_rgb_16 of 565 colors in 32-bit lanes
+static inline __m128i expand_rgb_16(__m128i c) {
+    const __m128i green = _mm_set1_epi32(SK_G16_MASK_IN_PLACE);
+    return _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, green), 16),
+                        _mm_andnot_si128(green, c));
+}
+
+// SkCompact_rgb_16 for two registers of 32-bit lanes, truncated to 16 bits
+// and packed into one
+static inline __m128i compact_rgb_16(__m128i c0, __m128i c1) {
+    const __m128i green = _mm_set1_epi32(SK_G16_MASK_IN_PLACE);
+    c0 = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c0, 16), green),
+                      _mm_andnot_si128(green, c0));
+    c1 = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c1, 16), green),
+                      _mm_andnot_si128(green, c1));
+    // sign extend the low halves, so that the pack keeps them as they are
+    c0 = _mm_srai_epi32(_mm_slli_epi32(c0, 16), 16);
+    c1 = _mm_srai_epi32(_mm_slli_epi32(c1, 16), 16);
+    return _mm_packs_epi32(c0, c1);
+}
+
+// S32A_D565_Opaque_Dither for 4 pixels, returning their expanded results
+static inline __m128i srcover_dither_4(__m128i s, __m128i d, __m128i dither) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i a = _mm_and_si128(_mm_srli_epi32(s, SK_A32_SHIFT), mask);
+    __m128i r = _mm_and_si128(_mm_srli_epi32(s, SK_R32_SHIFT), mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(s, SK_G32_SHIFT), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(s, SK_B32_SHIFT), mask);
+
+    // SkAlphaMul(dither, SkAlpha255To256(a)); both fit in 16 bits
+    dither = _mm_srli_epi32(_mm_madd_epi16(dither,
+                    _mm_add_epi32(a, _mm_set1_epi32(1))), 8);
+    r = _mm_sub_epi32(_mm_add_epi32(r, dither), _mm_srli_epi32(r, 5));
+    g = _mm_sub_epi32(_mm_add_epi32(g, _mm_srli_epi32(dither, 1)),
+                      _mm_srli_epi32(g, 6));
+    b = _mm_sub_epi32(_mm_add_epi32(b, dither), _mm_srli_epi32(b, 5));
+
+    __m128i src = _mm_or_si128(_mm_slli_epi32(g, 24),
+                               _mm_or_si128(_mm_slli_epi32(r, 13),
+                                            _mm_slli_epi32(b, 2)));
+    __m128i scale = _mm_srli_epi32(_mm_sub_epi32(_mm_set1_epi32(256), a), 3);
+    __m128i dst = mullo_epi32(expand_rgb_16(d), scale);
+    return _mm_srli_epi32(_mm_add_epi32(src, dst), 5);
+}
+
+struct S32A_D565_Opaque_Dither_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565& row) {
+        Src8 s;
+        load_src8(src, &s);
+        if (s.fAllZero) {
+            return;
+        }
+        Dst8 d;
+        load_dst8(dst, &d);
+
+        const __m128i zero = _mm_setzero_si128();
+        // the dither repeats every 4 pixels, so both halves use the same values
+        __m128i dither = _mm_unpacklo_epi16(row.fDither, zero);
+        __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+        __m128i c0 = srcover_dither_4(s0, _mm_unpacklo_epi16(d.fPixels, zero),
+                                      dither);
+        __m128i c1 = srcover_dither_4(s1, _mm_unpackhi_epi16(d.fPixels, zero),
+                                      dither);
+        store_unless_zero(dst, compact_rgb_16(c0, c1), s, d);
+    }
+};
+
+struct S32A_D565_Blend_Dither_Block {
+    static void Blit(uint16_t dst[], const SkPMColor src[],
+                     const Row565& row) {
+        Src8 s;
+        load_src8(src, &s);
+        if (s.fAllZero) {
+            return;
+        }
+        Dst8 d;
+        load_dst8(dst, &d);
+
+        const __m128i srcScale = _mm_set1_epi16(SkAlpha255To256(row.fAlpha));
+        // SkAlpha255To256(255 - SkAlphaMul(sa, srcScale)); the product is at
+        // most 255 * 256, which the low 16 bits hold unsigned
+        __m128i dstScale = _mm_sub_epi16(_mm_set1_epi16(256),
+                _mm_srli_epi16(_mm_mullo_epi16(s.fA, srcScale), 8));
+
+        __m128i r = _mm_srli_epi16(dither_r32_for_565(s.fR, row.fDither),
+                                   8 - SK_R16_BITS);
+        __m128i g = _mm_srli_epi16(dither_g32_for_565(s.fG, row.fDither),
+                                   8 - SK_G16_BITS);
+        __m128i b = _mm_srli_epi16(dither_r32_for_565(s.fB, row.fDither),
+                                   8 - SK_B16_BITS);
+        r = _mm_add_epi16(_mm_mullo_epi16(r, srcScale),
+                          _mm_mullo_epi16(d.fR, dstScale));
+        g = _mm_add_epi16(_mm_mullo_epi16(g, srcScale),
+                          _mm_mullo_epi16(d.fG, dstScale));
+        b = _mm_add_epi16(_mm_mullo_epi16(b, srcScale),
+                          _mm_mullo_epi16(d.fB, dstScale));
+        __m128i c = pack_565(_mm_srli_epi16(r, 8), _mm_srli_epi16(g, 8),
+                             _mm_srli_epi16(b, 8));
+        store_unless_zero(dst, c, s, d);
+    }
+};
+
+void S32_D565_Opaque_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int x, int y) {
+    blit_row_565<S32_D565_Opaque_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                         const SkPMColor* SK_RESTRICT src, int count,
+                         U8CPU alpha, int x, int y) {
+    blit_row_565<S32_D565_Blend_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32A_D565_Opaque_SSE2(uint16_t* SK_RESTRICT dst,
+                           const SkPMColor* SK_RESTRICT src, int count,
+                           U8CPU alpha, int x, int y) {
+    blit_row_565<S32A_D565_Opaque_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32A_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int x, int y) {
+    blit_row_565<S32A_D565_Blend_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src, int count,
+                                 U8CPU alpha, int x, int y) {
+    blit_row_565<S32_D565_Opaque_Dither_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src, int count,
+                                U8CPU alpha, int x, int y) {
+    blit_row_565<S32_D565_Blend_Dither_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32A_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                  const SkPMColor* SK_RESTRICT src, int count,
+                                  U8CPU alpha, int x, int y) {
+    blit_row_565<S32A_D565_Opaque_Dither_Block>(dst, src, count, alpha, x, y);
+}
+
+void S32A_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src, int count,
+                                 U8CPU alpha, int x, int y) {
+    blit_row_565<S32A_D565_Blend_Dither_Block>(dst, src, count, alpha, x, y);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  565 mask procs, for SkRGB16_Opaque_Blitter and SkRGB16_Blitter: each blends
+    the color into the device in SkExpand_rgb_16's packed form, four pixels at
+    a time in 32-bit lanes, with the same unsigned wrapping math as those
+    blitters' blitMask.
+ */
+
+// blend_compact(color32, dst32, SkAlpha255To256(aa) >> 3)
+struct MaskOpaque_SSE2 {
+    static inline __m128i Blend(__m128i dst32, __m128i aa, __m128i color32,
+                                __m128i) {
+        __m128i scale = _mm_srli_epi32(_mm_add_epi32(aa, _mm_srli_epi32(aa, 7)),
+                                       3);
+        __m128i diff = mullo_epi32(_mm_sub_epi32(color32, dst32), scale);
+        return _mm_add_epi32(dst32, _mm_srli_epi32(diff, 5));
+    }
+};
+
+// SkRGB16_Blitter::blitMask, with the color's alpha in scale256
+struct MaskColor_SSE2 {
+    static inline __m128i Blend(__m128i dst32, __m128i aa, __m128i color32,
+                                __m128i scale256) {
+        // both fit in 16 bits
+        __m128i scale = _mm_madd_epi16(_mm_add_epi32(aa, _mm_srli_epi32(aa, 7)),
+                                       scale256);
+        scale = _mm_srli_epi32(scale, 8 + 3);
+        __m128i src = mullo_epi32(color32, scale);
+        __m128i dst = mullo_epi32(dst32,
+                                  _mm_sub_epi32(_mm_set1_epi32(32), scale));
+        return _mm_srli_epi32(_mm_add_epi32(src, dst), 5);
+    }
+};
+
+// MaskBlend provides Blend(dst32, aa, color32, scale256), for 4 pixels
+template <typename MaskBlend>
+static inline void mask_block_565(uint16_t dst[], const uint8_t mask[],
+                                  __m128i color32, __m128i scale256) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i aa = _mm_unpacklo_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask)), zero);
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+    __m128i c0 = MaskBlend::Blend(expand_rgb_16(_mm_unpacklo_epi16(d, zero)),
+                                  _mm_unpacklo_epi16(aa, zero),
+                                  color32, scale256);
+    __m128i c1 = MaskBlend::Blend(expand_rgb_16(_mm_unpackhi_epi16(d, zero)),
+                                  _mm_unpackhi_epi16(aa, zero),
+                                  color32, scale256);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), compact_rgb_16(c0, c1));
+}
+
+template <typename MaskBlend>
+static void blit_mask_565(void* device, size_t dstRB, const uint8_t* mask,
+                          size_t maskRB, SkColor color, int width,
+                          int height) {
+    const __m128i color32 = _mm_set1_epi32(SkExpand_rgb_16(
+            SkPack888ToRGB16(SkColorGetR(color), SkColorGetG(color),
+                             SkColorGetB(color))));
+    const __m128i scale256 = _mm_set1_epi32(
+            SkAlpha255To256(SkColorGetA(color)));
+    uint16_t* dst = reinterpret_cast<uint16_t*>(device);
+
+    do {
+        int w = width;
+        int x = 0;
+        for (; w >= 8; w -= 8, x += 8) {
+            mask_block_565<MaskBlend>(dst + x, mask + x, color32, scale256);
+        }
+        if (w > 0) {
+            uint16_t tmpDst[8];
+            uint8_t tmpMask[8];
+            memcpy(tmpDst, dst + x, w * sizeof(uint16_t));
+            memcpy(tmpMask, mask + x, w);
+            mask_block_565<MaskBlend>(tmpDst, tmpMask, color32, scale256);
+            memcpy(dst + x, tmpDst, w * sizeof(uint16_t));
+        }
+        dst = reinterpret_cast<uint16_t*>((char*)dst + dstRB);
+        mask += maskRB;
     } while (--height != 0);
 }
+
+void SkRGB16_BlitMask_Opaque_SSE2(void* device, size_t dstRB,
+                                  SkBitmap::Config dstConfig,
+                                  const uint8_t* mask, size_t maskRB,
+                                  SkColor color, int width, int height) {
+    SkASSERT(SkBitmap::kRGB_565_Config == dstConfig);
+    SkASSERT(0xFF == SkColorGetA(color));
+    blit_mask_565<MaskOpaque_SSE2>(device, dstRB, mask, maskRB, color,
+                                     width, height);
+}
+
+void SkRGB16_BlitMask_Color_SSE2(void* device, size_t dstRB,
+                                 SkBitmap::Config dstConfig,
+                                 const uint8_t* mask, size_t maskRB,
+                                 SkColor color, int width, int height) {
+    SkASSERT(SkBitmap::kRGB_565_Config == dstConfig);
+    blit_mask_565<MaskColor_SSE2>(device, dstRB, mask, maskRB, color,
+                                    width, height);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  The LCD row procs blend each channel with its own coverage (maskA is the
+    largest of the three), as dst + ((src - dst) * scale >> bits), which is
+    (src * scale + dst * (one - scale)) >> bits, where everything stays
+    unsigned and within 16 bits.
+ */
+static inline __m128i lcd_blend_half(__m128i src16, __m128i dst16,
+                                     __m128i cov16, __m128i one, int bits) {
+    __m128i s = _mm_mullo_epi16(src16, cov16);
+    __m128i d = _mm_mullo_epi16(dst16, _mm_sub_epi16(one, cov16));
+    return _mm_srli_epi16(_mm_add_epi16(s, d), bits);
+}
+
+// the largest of the r, g and b of 4 coverage pixels, in the alpha byte
+static inline __m128i lcd_coverage_alpha(__m128i r, __m128i g, __m128i b) {
+    __m128i a = _mm_max_epi16(_mm_max_epi16(r, g), b);
+    return _mm_or_si128(_mm_slli_epi32(a, SK_A32_SHIFT),
+                        _mm_or_si128(_mm_slli_epi32(r, SK_R32_SHIFT),
+                                     _mm_or_si128(
+                                         _mm_slli_epi32(g, SK_G32_SHIFT),
+                                         _mm_slli_epi32(b, SK_B32_SHIFT))));
+}
+
+// the 5 high bits of each channel of 4 LCD16 masks, upscaled to 0..32
+static inline __m128i lcd16_coverage(__m128i m) {
+    const __m128i mask5 = _mm_set1_epi32(31);
+    __m128i r = _mm_and_si128(_mm_srli_epi32(m, SK_R16_SHIFT + SK_R16_BITS - 5),
+                              mask5);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(m, SK_G16_SHIFT + SK_G16_BITS - 5),
+                              mask5);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(m, SK_B16_SHIFT + SK_B16_BITS - 5),
+                              mask5);
+    r = _mm_add_epi32(r, _mm_srli_epi32(r, 4));
+    g = _mm_add_epi32(g, _mm_srli_epi32(g, 4));
+    b = _mm_add_epi32(b, _mm_srli_epi32(b, 4));
+    return lcd_coverage_alpha(r, g, b);
+}
+
+static inline void lcd16_block(SkPMColor dst[], const uint16_t mask[],
+                               __m128i src16) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(32);
+    __m128i m = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask));
+    __m128i cov = lcd16_coverage(_mm_unpacklo_epi16(m, zero));
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    __m128i dstPixels = _mm_loadu_si128(d);
+    __m128i lo = lcd_blend_half(src16, _mm_unpacklo_epi8(dstPixels, zero),
+                                _mm_unpacklo_epi8(cov, zero), one, 5);
+    __m128i hi = lcd_blend_half(src16, _mm_unpackhi_epi8(dstPixels, zero),
+                                _mm_unpackhi_epi8(cov, zero), one, 5);
+    _mm_storeu_si128(d, _mm_packus_epi16(lo, hi));
+}
+
+// the color, with an opaque alpha, in 16-bit words, twice
+static inline __m128i lcd_src16(SkPMColor color) {
+    color |= SK_A32_MASK << SK_A32_SHIFT;
+    return _mm_unpacklo_epi8(_mm_set1_epi32(color), _mm_setzero_si128());
+}
+
+/* SSE2 version of LCD16_Row()
+ * portable version is in core/SkBlitRow_D32.cpp
+ */
+void LCD16_Row_SSE2(SkPMColor dst[], const uint16_t mask[], SkPMColor color,
+                    int width) {
+    const __m128i src16 = lcd_src16(color);
+    while (width >= 4) {
+        // glyphs are mostly empty
+        if (mask[0] | mask[1] | mask[2] | mask[3]) {
+            lcd16_block(dst, mask, src16);
+        }
+        dst += 4;
+        mask += 4;
+        width -= 4;
+    }
+    if (width > 0) {
+        SkPMColor tmpDst[4];
+        uint16_t tmpMask[4] = { 0, 0, 0, 0 };
+        memcpy(tmpDst, dst, width * sizeof(SkPMColor));
+        memcpy(tmpMask, mask, width * sizeof(uint16_t));
+        lcd16_block(tmpDst, tmpMask, src16);
+        memcpy(dst, tmpDst, width * sizeof(SkPMColor));
+    }
+}
+
+// LCD32 coverage is upscaled with SkAlpha255To256, so a zero mask still has
+// to leave its pixel alone
+static inline void lcd32_block(SkPMColor dst[], const uint32_t mask[],
+                               __m128i src16) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(256);
+    const __m128i c_1 = _mm_set1_epi16(1);
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+    __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+    __m128i cov = lcd_coverage_alpha(
+            _mm_and_si128(_mm_srli_epi32(m, SK_R32_SHIFT), mask8),
+            _mm_and_si128(_mm_srli_epi32(m, SK_G32_SHIFT), mask8),
+            _mm_and_si128(_mm_srli_epi32(m, SK_B32_SHIFT), mask8));
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    __m128i dstPixels = _mm_loadu_si128(d);
+    __m128i lo = lcd_blend_half(src16, _mm_unpacklo_epi8(dstPixels, zero),
+                                _mm_add_epi16(_mm_unpacklo_epi8(cov, zero),
+                                              c_1),
+                                one, 8);
+    __m128i hi = lcd_blend_half(src16, _mm_unpackhi_epi8(dstPixels, zero),
+                                _mm_add_epi16(_mm_unpackhi_epi8(cov, zero),
+                                              c_1),
+                                one, 8);
+    __m128i result = _mm_packus_epi16(lo, hi);
+    __m128i keep = _mm_cmpeq_epi32(m, zero);
+    result = _mm_or_si128(_mm_and_si128(keep, dstPixels),
+                          _mm_andnot_si128(keep, result));
+    _mm_storeu_si128(d, result);
+}
+
+/* SSE2 version of LCD32_Row()
+ * portable version is in core/SkBlitRow_D32.cpp
+ */
+void LCD32_Row_SSE2(SkPMColor dst[], const uint32_t mask[], SkPMColor color,
+                    int width) {
+    const __m128i src16 = lcd_src16(color);
+    while (width >= 4) {
+        if (mask[0] | mask[1] | mask[2] | mask[3]) {
+            lcd32_block(dst, mask, src16);
+        }
+        dst += 4;
+        mask += 4;
+        width -= 4;
+    }
+    if (width > 0) {
+        SkPMColor tmpDst[4];
+        uint32_t tmpMask[4] = { 0, 0, 0, 0 };
+        memcpy(tmpDst, dst, width * sizeof(SkPMColor));
+        memcpy(tmpMask, mask, width * sizeof(uint32_t));
+        lcd32_block(tmpDst, tmpMask, src16);
+        memcpy(dst, tmpDst, width * sizeof(SkPMColor));
+    }
+}
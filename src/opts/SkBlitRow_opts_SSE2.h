@@ -16,6 +16,7 @@
  */
 
 #include "SkBlitRow.h"
+#include "SkXfermode.h"
 
 void S32_Blend_BlitRow32_SSE2(SkPMColor* SK_RESTRICT dst,
                               const SkPMColor* SK_RESTRICT src,
@@ -32,3 +33,56 @@ void SkARGB32_BlitMask_SSE2(void* device, size_t dstRB,
                             SkBitmap::Config dstConfig, const uint8_t* mask,
                             size_t maskRB, SkColor color,
                             int width, int height);
+void ColorAA32_SSE2(SkPMColor dst[], const SkAlpha aa[], int count,
+                    SkPMColor color);
+void ColorA8_SSE2(uint8_t dst[], const SkAlpha aa[], int count, U8CPU alpha);
+void AlphaA8_SSE2(uint8_t dst[], const SkAlpha src[], const SkAlpha aa[],
+                  int count);
+
+void Multiply_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void Screen_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void Darken_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void Lighten_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void SrcIn_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void DstIn_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void DstOut_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+void SrcATop_Xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count);
+
+void S32_D565_Opaque_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int x, int y);
+void S32_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                         const SkPMColor* SK_RESTRICT src, int count,
+                         U8CPU alpha, int x, int y);
+void S32A_D565_Opaque_SSE2(uint16_t* SK_RESTRICT dst,
+                           const SkPMColor* SK_RESTRICT src, int count,
+                           U8CPU alpha, int x, int y);
+void S32A_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int x, int y);
+void S32_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src, int count,
+                                 U8CPU alpha, int x, int y);
+void S32_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src, int count,
+                                U8CPU alpha, int x, int y);
+void S32A_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                  const SkPMColor* SK_RESTRICT src, int count,
+                                  U8CPU alpha, int x, int y);
+void S32A_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src, int count,
+                                 U8CPU alpha, int x, int y);
+
+void SkRGB16_BlitMask_Opaque_SSE2(void* device, size_t dstRB,
+                                  SkBitmap::Config dstConfig,
+                                  const uint8_t* mask, size_t maskRB,
+                                  SkColor color, int width, int height);
+void SkRGB16_BlitMask_Color_SSE2(void* device, size_t dstRB,
+                                 SkBitmap::Config dstConfig,
+                                 const uint8_t* mask, size_t maskRB,
+                                 SkColor color, int width, int height);
+
+void LCD16_Row_SSE2(SkPMColor dst[], const uint16_t mask[], SkPMColor color,
+                    int width);
+void LCD32_Row_SSE2(SkPMColor dst[], const uint32_t mask[], SkPMColor color,
+                    int width);
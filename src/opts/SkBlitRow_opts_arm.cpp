@@ -22,6 +22,7 @@
 #include "SkBlitRow.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
+#include "SkXfermode.h"
 
 #if defined(__ARM_HAVE_NEON)
 #include <arm_neon.h>
@@ -1307,6 +1308,256 @@ static const SkBlitRow::Proc32 platform_32_procs[] = {
     S32A_Blend_BlitRow32_PROC		// S32A_Blend
 };
 
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__ARM_HAVE_NEON) && defined(SK_CPU_LENDIAN)
+
+/* These work on 8 pixels at a time, with vld4/vst4 splitting them into one
+ * vector per channel, so the coverage bytes line up with the pixels. Each
+ * channel is scaled with a widening multiply and a narrowing shift, which
+ * gives exactly (c * scale) >> 8, as SkAlphaMulQ does in the portable code.
+ */
+#define SK_A32_BYTE     (SK_A32_SHIFT / 8)
+
+static inline uint8x8_t neon_scale(uint8x8_t c, uint16x8_t scale) {
+    return vshrn_n_u16(vmulq_u16(vmovl_u8(c), scale), 8);
+}
+
+/* Neon version of SkBlitRow::ColorAA32()
+ * portable version is in src/core/SkBlitRow_D32.cpp
+ */
+static void ColorAA32_neon(SkPMColor* SK_RESTRICT dst,
+                           const SkAlpha* SK_RESTRICT aa, int count,
+                           SkPMColor color) {
+    uint8x8_t src_c[4];
+    for (int i = 0; i < 4; i++) {
+        src_c[i] = vdup_n_u8((color >> (i * 8)) & 0xFF);
+    }
+    const uint8x8_t zero = vdup_n_u8(0);
+    const uint8x8_t c_255 = vdup_n_u8(255);
+
+    while (count >= 8) {
+        uint8x8_t coverage = vld1_u8(aa);
+        uint16x8_t src_scale = vaddw_u8(vdupq_n_u16(1), coverage);
+        uint8x8x4_t d = vld4_u8(reinterpret_cast<uint8_t*>(dst));
+        uint8x8_t skip = vceq_u8(coverage, zero);
+
+        uint8x8_t src_a = neon_scale(src_c[SK_A32_BYTE], src_scale);
+        // the same scale Color32 uses: 255 - src alpha
+        uint8x8_t dst_scale = vsub_u8(c_255, src_a);
+
+        for (int i = 0; i < 4; i++) {
+            uint8x8_t src = (SK_A32_BYTE == i) ? src_a :
+                                            neon_scale(src_c[i], src_scale);
+            uint8x8_t res = vadd_u8(src,
+                                vshrn_n_u16(vmull_u8(d.val[i], dst_scale), 8));
+            d.val[i] = vbsl_u8(skip, d.val[i], res);
+        }
+        vst4_u8(reinterpret_cast<uint8_t*>(dst), d);
+
+        aa += 8;
+        dst += 8;
+        count -= 8;
+    }
+    SkBlitRow::ColorAA32(dst, aa, count, color);
+}
+
+/* Neon version of the A8 mask procs
+ * portable versions are in src/core/SkBlitRow_D32.cpp
+ */
+static void D32_Mask_neon(void* device, size_t dstRB, SkBitmap::Config,
+                          const uint8_t* mask, size_t maskRB, SkColor origColor,
+                          int width, int height) {
+    SkPMColor color = SkPreMultiplyColor(origColor);
+    size_t dstOffset = dstRB - (width << 2);
+    size_t maskOffset = maskRB - width;
+    SkPMColor* dst = (SkPMColor*)device;
+
+    uint8x8_t src_c[4];
+    for (int i = 0; i < 4; i++) {
+        src_c[i] = vdup_n_u8((color >> (i * 8)) & 0xFF);
+    }
+    const uint16x8_t c_1 = vdupq_n_u16(1);
+    const uint16x8_t c_256 = vdupq_n_u16(256);
+
+    do {
+        int count = width;
+        while (count >= 8) {
+            uint8x8_t coverage = vld1_u8(mask);
+            uint16x8_t src_scale = vaddw_u8(c_1, coverage);
+            uint8x8x4_t d = vld4_u8(reinterpret_cast<uint8_t*>(dst));
+
+            uint8x8_t src_a = neon_scale(src_c[SK_A32_BYTE], src_scale);
+            // 256 - (src alpha * src_scale >> 8)
+            uint16x8_t dst_scale = vsubw_u8(c_256, src_a);
+
+            for (int i = 0; i < 4; i++) {
+                uint8x8_t src = (SK_A32_BYTE == i) ? src_a :
+                                            neon_scale(src_c[i], src_scale);
+                d.val[i] = vadd_u8(src, neon_scale(d.val[i], dst_scale));
+            }
+            vst4_u8(reinterpret_cast<uint8_t*>(dst), d);
+
+            mask += 8;
+            dst += 8;
+            count -= 8;
+        }
+        while (count > 0) {
+            *dst = SkBlendARGB32(color, *dst, *mask);
+            dst += 1;
+            mask += 1;
+            count -= 1;
+        }
+        dst = (SkPMColor*)((char*)dst + dstOffset);
+        mask += maskOffset;
+    } while (--height != 0);
+}
+
+#define ColorAA32_PROC      ColorAA32_neon
+#define D32_Mask_PROC       D32_Mask_neon
+#else
+#define ColorAA32_PROC      NULL
+#define D32_Mask_PROC       NULL
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__ARM_HAVE_NEON) && defined(SK_CPU_LENDIAN)
+
+/* Xfermode row procs. Like the procs above these work on 8 pixels at a time,
+ * one vector per channel, and mirror the arithmetic of the matching modeproc
+ * in src/core/SkXfermode.cpp so that the results are identical. Sums that
+ * temporarily overflow a byte are fine, since the final value is 0..255.
+ */
+
+// SkMulDiv255Round for each byte
+static inline uint8x8_t neon_mul_div_255_round(uint8x8_t a, uint8x8_t b) {
+    uint16x8_t prod = vaddq_u16(vmull_u8(a, b), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(prod, vshrq_n_u16(prod, 8)), 8);
+}
+
+// SkDiv255Round for each lane; prod must be 0..255*255
+static inline uint8x8_t neon_div_255_round(uint16x8_t prod) {
+    prod = vaddq_u16(prod, vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(prod, vshrq_n_u16(prod, 8)), 8);
+}
+
+struct MultiplyOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        for (int i = 0; i < 4; i++) {
+            d.val[i] = neon_mul_div_255_round(s.val[i], d.val[i]);
+        }
+    }
+};
+
+struct ScreenOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        for (int i = 0; i < 4; i++) {
+            d.val[i] = vsub_u8(vadd_u8(s.val[i], d.val[i]),
+                               neon_mul_div_255_round(s.val[i], d.val[i]));
+        }
+    }
+};
+
+// the alpha channel comes out as srcover_byte(sa, da), since sd == ds there
+struct DarkenOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        uint8x8_t sa = s.val[SK_A32_BYTE];
+        uint8x8_t da = d.val[SK_A32_BYTE];
+        for (int i = 0; i < 4; i++) {
+            uint16x8_t sd = vmull_u8(s.val[i], da);
+            uint16x8_t ds = vmull_u8(d.val[i], sa);
+            d.val[i] = vsub_u8(vadd_u8(s.val[i], d.val[i]),
+                               neon_div_255_round(vmaxq_u16(sd, ds)));
+        }
+    }
+};
+
+struct LightenOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        uint8x8_t sa = s.val[SK_A32_BYTE];
+        uint8x8_t da = d.val[SK_A32_BYTE];
+        for (int i = 0; i < 4; i++) {
+            uint16x8_t sd = vmull_u8(s.val[i], da);
+            uint16x8_t ds = vmull_u8(d.val[i], sa);
+            d.val[i] = vsub_u8(vadd_u8(s.val[i], d.val[i]),
+                               neon_div_255_round(vminq_u16(sd, ds)));
+        }
+    }
+};
+
+// SkAlphaMulQ(src, SkAlpha255To256(da))
+struct SrcInOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        uint16x8_t scale = vaddw_u8(vdupq_n_u16(1), d.val[SK_A32_BYTE]);
+        for (int i = 0; i < 4; i++) {
+            d.val[i] = neon_scale(s.val[i], scale);
+        }
+    }
+};
+
+// SkAlphaMulQ(dst, SkAlpha255To256(sa))
+struct DstInOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        uint16x8_t scale = vaddw_u8(vdupq_n_u16(1), s.val[SK_A32_BYTE]);
+        for (int i = 0; i < 4; i++) {
+            d.val[i] = neon_scale(d.val[i], scale);
+        }
+    }
+};
+
+// SkAlphaMulQ(dst, SkAlpha255To256(255 - sa))
+struct DstOutOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        uint16x8_t scale = vsubw_u8(vdupq_n_u16(256), s.val[SK_A32_BYTE]);
+        for (int i = 0; i < 4; i++) {
+            d.val[i] = neon_scale(d.val[i], scale);
+        }
+    }
+};
+
+// the result alpha is just da, so that channel is left alone
+struct SrcATopOp_neon {
+    static inline void Op(const uint8x8x4_t& s, uint8x8x4_t& d) {
+        uint8x8_t isa = vmvn_u8(s.val[SK_A32_BYTE]);
+        uint8x8_t da = d.val[SK_A32_BYTE];
+        for (int i = 0; i < 4; i++) {
+            if (SK_A32_BYTE != i) {
+                d.val[i] = vadd_u8(neon_mul_div_255_round(da, s.val[i]),
+                                   neon_mul_div_255_round(isa, d.val[i]));
+            }
+        }
+    }
+};
+
+template <typename XferOp, SkXfermode::Mode mode>
+static void xfer32_neon(SkPMColor* SK_RESTRICT dst,
+                        const SkPMColor* SK_RESTRICT src, int count) {
+    while (count >= 8) {
+        uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src));
+        uint8x8x4_t d = vld4_u8(reinterpret_cast<uint8_t*>(dst));
+        XferOp::Op(s, d);
+        vst4_u8(reinterpret_cast<uint8_t*>(dst), d);
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+    if (count > 0) {
+        SkXfermodeProc proc = SkXfermode::GetProc(mode);
+        for (int i = 0; i < count; i++) {
+            dst[i] = proc(src[i], dst[i]);
+        }
+    }
+}
+
+#define XFER32_NEON(op, mode)   xfer32_neon<op##Op_neon, SkXfermode::mode>
+#else
+#define XFER32_NEON(op, mode)   NULL
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
 SkBlitRow::Proc SkBlitRow::PlatformProcs4444(unsigned flags) {
     return platform_4444_procs[flags];
 }
@@ -1323,9 +1574,54 @@ SkBlitRow::ColorProc SkBlitRow::PlatformColorProc() {
     return NULL;
 }
 
+SkBlitRow::ColorAAProc SkBlitRow::PlatformColorAAProc() {
+    return ColorAA32_PROC;
+}
+
+SkBlitRow::ColorA8Proc SkBlitRow::PlatformColorA8Proc() {
+    return NULL;
+}
+
+SkBlitRow::AlphaA8Proc SkBlitRow::PlatformAlphaA8Proc() {
+    return NULL;
+}
 
 SkBlitMask::Proc SkBlitMask::PlatformProcs(SkBitmap::Config dstConfig,
                                            SkColor color)
 {
-   return NULL;
+    if (SkBitmap::kARGB_8888_Config == dstConfig) {
+        return D32_Mask_PROC;
+    }
+    return NULL;
+}
+
+SkBlitMask::LCD16RowProc SkBlitMask::PlatformLCD16RowProc() {
+    return NULL;
+}
+
+SkBlitMask::LCD32RowProc SkBlitMask::PlatformLCD32RowProc() {
+    return NULL;
+}
+
+SkXfermode::Proc32 SkXfermode::PlatformProcs32(Mode mode) {
+    switch (mode) {
+        case kMultiply_Mode:
+            return XFER32_NEON(Multiply, kMultiply_Mode);
+        case kScreen_Mode:
+            return XFER32_NEON(Screen, kScreen_Mode);
+        case kDarken_Mode:
+            return XFER32_NEON(Darken, kDarken_Mode);
+        case kLighten_Mode:
+            return XFER32_NEON(Lighten, kLighten_Mode);
+        case kSrcIn_Mode:
+            return XFER32_NEON(SrcIn, kSrcIn_Mode);
+        case kDstIn_Mode:
+            return XFER32_NEON(DstIn, kDstIn_Mode);
+        case kDstOut_Mode:
+            return XFER32_NEON(DstOut, kDstOut_Mode);
+        case kSrcATop_Mode:
+            return XFER32_NEON(SrcATop, kSrcATop_Mode);
+        default:
+            return NULL;
+    }
 }
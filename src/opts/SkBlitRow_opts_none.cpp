@@ -1,4 +1,5 @@
 #include "SkBlitRow.h"
+#include "SkXfermode.h"
 
 // Platform impl of Platform_procs with no overrides
 
@@ -18,9 +19,33 @@ SkBlitRow::ColorProc SkBlitRow::PlatformColorProc() {
     return NULL;
 }
 
+SkBlitRow::ColorAAProc SkBlitRow::PlatformColorAAProc() {
+    return NULL;
+}
+
+SkBlitRow::ColorA8Proc SkBlitRow::PlatformColorA8Proc() {
+    return NULL;
+}
+
+SkBlitRow::AlphaA8Proc SkBlitRow::PlatformAlphaA8Proc() {
+    return NULL;
+}
+
 
 SkBlitMask::Proc SkBlitMask::PlatformProcs(SkBitmap::Config dstConfig,
                                            SkColor color)
 {
    return NULL;
 }
+
+SkBlitMask::LCD16RowProc SkBlitMask::PlatformLCD16RowProc() {
+   return NULL;
+}
+
+SkBlitMask::LCD32RowProc SkBlitMask::PlatformLCD32RowProc() {
+   return NULL;
+}
+
+SkXfermode::Proc32 SkXfermode::PlatformProcs32(Mode mode) {
+    return NULL;
+}
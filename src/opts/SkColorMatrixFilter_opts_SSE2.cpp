@@ -0,0 +1,150 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include <emmintrin.h>
+#include "SkColorMatrixFilter_opts_SSE2.h"
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
+
+/*  Each loop filters four pixels, with each channel in a register of its
+    own. Every case is computed as General would compute it, and the math is
+    the portable math done four times at once:
+
+    - unpremultiplying multiplies by the 8.24 reciprocal from SkUnPreMultiply,
+      keeping the low 32 bits of the product as ApplyScale does;
+    - the matrix entries can take 23 bits, more than _mm_madd_epi16 can
+      multiply by, so each is split into its top bits and its low 15 bits,
+      and the two sums are put back together with a shift. The sums wrap the
+      same way the portable ones do;
+    - pinning is a saturating pack and a clamp, and premultiplying is the
+      same (c * (a + 1)) >> 8 as SkAlphaMul.
+
+    Opaque pixels need no unpremultiply, and where all four come out opaque,
+    no premultiply either; no reciprocals are looked up for opaque pixels.
+ */
+
+// the entries that multiply channels c0 and c1, as 16 bit pairs: the low 15
+// bits of each, and the rest
+static inline void set_pair(int32_t m0, int32_t m1, __m128i* lo, __m128i* hi) {
+    *lo = _mm_set1_epi32((m0 & 0x7FFF) | ((m1 & 0x7FFF) << 16));
+    *hi = _mm_set1_epi32(((m0 >> 15) & 0xFFFF) |
+                         ((uint32_t)(m1 >> 15) << 16));
+}
+
+// (scale * c + (1 << 23)) >> 24 in each lane, in 32 bits
+static inline __m128i apply_scale(__m128i scale, __m128i c) {
+    const __m128i half = _mm_set1_epi32(1 << 23);
+    const __m128i even = _mm_set_epi32(0, -1, 0, -1);
+
+    // products of lanes 0 and 2, then lanes 1 and 3; the low 32 bits of each
+    // are in lanes 0 and 2
+    __m128i p02 = _mm_mul_epu32(scale, c);
+    __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(scale, 32),
+                                _mm_srli_epi64(c, 32));
+    p02 = _mm_srli_epi32(_mm_add_epi32(p02, half), 24);
+    p13 = _mm_srli_epi32(_mm_add_epi32(p13, half), 24);
+    return _mm_or_si128(_mm_and_si128(p02, even), _mm_slli_epi64(p13, 32));
+}
+
+int SkColorMatrixFilter_Span_SSE2(const SkColorMatrixFilter::State& state,
+                                  const SkPMColor src[], int count,
+                                  SkPMColor dst[]) {
+    const int32_t* array = state.fArray;
+    const int one = 1 << state.fShift;
+    const __m128i shift = _mm_cvtsi32_si128(state.fShift);
+
+    // the rows of the matrix, for r,g and for b,a
+    __m128i rgLo[4], rgHi[4], baLo[4], baHi[4], add[4];
+    for (int k = 0; k < 4; k++) {
+        const int32_t* row = &array[k * 5];
+        set_pair(row[0], row[1], &rgLo[k], &rgHi[k]);
+        set_pair(row[2], row[3], &baLo[k], &baHi[k]);
+        add[k] = _mm_set1_epi32(row[4]);
+    }
+    // alpha comes out as it went in (the add under 'one' is the rounding)
+    const bool keepsAlpha = 0 == (array[15] | array[16] | array[17]) &&
+                            one == array[18] &&
+                            array[19] >= 0 && array[19] < one;
+
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i opaque = _mm_set1_epi32(0xFF << SK_A32_SHIFT);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max16 = _mm_set1_epi16(0xFF);
+    const __m128i one16 = _mm_set1_epi16(1);
+    const __m128i alphaScale = _mm_set1_epi16(256);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i c = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(c, SK_R32_SHIFT), mask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(c, SK_G32_SHIFT), mask);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(c, SK_B32_SHIFT), mask);
+        __m128i a = _mm_and_si128(_mm_srli_epi32(c, SK_A32_SHIFT), mask);
+
+        // need our components to be un-premultiplied
+        __m128i isOpaque = _mm_cmpeq_epi32(_mm_and_si128(c, opaque), opaque);
+        if (0xFFFF != _mm_movemask_epi8(isOpaque)) {
+            __m128i scale = _mm_set_epi32(table[SkGetPackedA32(src[i + 3])],
+                                          table[SkGetPackedA32(src[i + 2])],
+                                          table[SkGetPackedA32(src[i + 1])],
+                                          table[SkGetPackedA32(src[i + 0])]);
+            r = apply_scale(scale, r);
+            g = apply_scale(scale, g);
+            b = apply_scale(scale, b);
+        }
+
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi32(g, 16));
+        __m128i ba = _mm_or_si128(b, _mm_slli_epi32(a, 16));
+        __m128i result[4];
+        for (int k = keepsAlpha ? 2 : 3; k >= 0; k--) {
+            __m128i lo = _mm_add_epi32(_mm_madd_epi16(rg, rgLo[k]),
+                                       _mm_madd_epi16(ba, baLo[k]));
+            __m128i hi = _mm_add_epi32(_mm_madd_epi16(rg, rgHi[k]),
+                                       _mm_madd_epi16(ba, baHi[k]));
+            __m128i sum = _mm_add_epi32(_mm_slli_epi32(hi, 15), lo);
+            result[k] = _mm_sra_epi32(_mm_add_epi32(sum, add[k]), shift);
+        }
+        if (keepsAlpha) {
+            result[3] = a;
+        }
+
+        // pin to [0, 255], as r0..r3 g0..g3 and b0..b3 a0..a3
+        rg = _mm_packs_epi32(result[0], result[1]);
+        ba = _mm_packs_epi32(result[2], result[3]);
+        rg = _mm_min_epi16(_mm_max_epi16(rg, zero), max16);
+        ba = _mm_min_epi16(_mm_max_epi16(ba, zero), max16);
+
+        // re-prepremultiply if needed
+        __m128i aa = _mm_unpackhi_epi64(ba, ba);
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi16(aa, max16))) {
+            __m128i scale = _mm_add_epi16(aa, one16);
+            rg = _mm_srli_epi16(_mm_mullo_epi16(rg, scale), 8);
+            scale = _mm_unpacklo_epi64(scale, alphaScale);
+            ba = _mm_srli_epi16(_mm_mullo_epi16(ba, scale), 8);
+        }
+
+        c = _mm_slli_epi32(_mm_unpacklo_epi16(rg, zero), SK_R32_SHIFT);
+        c = _mm_or_si128(c, _mm_slli_epi32(_mm_unpackhi_epi16(rg, zero),
+                                           SK_G32_SHIFT));
+        c = _mm_or_si128(c, _mm_slli_epi32(_mm_unpacklo_epi16(ba, zero),
+                                           SK_B32_SHIFT));
+        c = _mm_or_si128(c, _mm_slli_epi32(_mm_unpackhi_epi16(ba, zero),
+                                           SK_A32_SHIFT));
+        _mm_storeu_si128((__m128i*)&dst[i], c);
+    }
+    return i;
+}
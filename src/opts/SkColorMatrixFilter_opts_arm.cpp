@@ -0,0 +1,157 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkColorMatrixFilter.h"
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
+
+#if defined(__ARM_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+/*  The NEON proc filters eight pixels at a time, loading them as eight of
+    each channel (vld4), and works on four of them at a time in 32 bit
+    lanes. NEON multiplies 32 bit lanes directly, so this is General's math
+    lane for lane: SkUnPreMultiply's reciprocals, the matrix rows, two
+    saturating narrows for the pin, and (c * (a + 1)) >> 8. Opaque pixels
+    skip the reciprocals, and opaque results the premultiply.
+ */
+
+#if defined(__ARM_HAVE_NEON)
+
+// where each channel is in the bytes of an SkPMColor
+#define R_INDEX     (SK_R32_SHIFT / 8)
+#define G_INDEX     (SK_G32_SHIFT / 8)
+#define B_INDEX     (SK_B32_SHIFT / 8)
+#define A_INDEX     (SK_A32_SHIFT / 8)
+
+// (scale * c + (1 << 23)) >> 24, in 32 bits like ApplyScale
+static inline uint32x4_t apply_scale(uint32x4_t scale, uint32x4_t c) {
+    return vshrq_n_u32(vmlaq_u32(vdupq_n_u32(1 << 23), scale, c), 24);
+}
+
+static inline uint16x4_t rowmul4(const int32_t row[5], int32x4_t r,
+                                 int32x4_t g, int32x4_t b, int32x4_t a,
+                                 int32x4_t shift) {
+    int32x4_t sum = vdupq_n_s32(row[4]);
+    sum = vmlaq_n_s32(sum, r, row[0]);
+    sum = vmlaq_n_s32(sum, g, row[1]);
+    sum = vmlaq_n_s32(sum, b, row[2]);
+    sum = vmlaq_n_s32(sum, a, row[3]);
+    // shifting by -shift is an arithmetic shift right
+    return vqmovun_s32(vshlq_s32(sum, shift));
+}
+
+// c is r, g, b, a for four pixels; scales is NULL if they are all opaque
+static inline void filter4(const int32_t array[20], int32x4_t shift,
+                           bool keepsAlpha, const uint32_t* scales,
+                           uint16x4_t c[4]) {
+    uint32x4_t r = vmovl_u16(c[0]);
+    uint32x4_t g = vmovl_u16(c[1]);
+    uint32x4_t b = vmovl_u16(c[2]);
+    uint32x4_t a = vmovl_u16(c[3]);
+    if (scales) {
+        uint32x4_t scale = vld1q_u32(scales);
+        r = apply_scale(scale, r);
+        g = apply_scale(scale, g);
+        b = apply_scale(scale, b);
+    }
+
+    int32x4_t sr = vreinterpretq_s32_u32(r);
+    int32x4_t sg = vreinterpretq_s32_u32(g);
+    int32x4_t sb = vreinterpretq_s32_u32(b);
+    int32x4_t sa = vreinterpretq_s32_u32(a);
+    c[0] = rowmul4(&array[0], sr, sg, sb, sa, shift);
+    c[1] = rowmul4(&array[5], sr, sg, sb, sa, shift);
+    c[2] = rowmul4(&array[10], sr, sg, sb, sa, shift);
+    if (!keepsAlpha) {
+        c[3] = rowmul4(&array[15], sr, sg, sb, sa, shift);
+    }
+}
+
+static int Span_neon(const SkColorMatrixFilter::State& state,
+                     const SkPMColor src[], int count, SkPMColor dst[]) {
+    const int32_t* array = state.fArray;
+    const int32_t one = 1 << state.fShift;
+    const int32x4_t shift = vdupq_n_s32(-state.fShift);
+    // alpha comes out as it went in (the add under 'one' is the rounding)
+    const bool keepsAlpha = 0 == (array[15] | array[16] | array[17]) &&
+                            one == array[18] &&
+                            array[19] >= 0 && array[19] < one;
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t px = vld4_u8((const uint8_t*)&src[i]);
+        uint16x8_t r = vmovl_u8(px.val[R_INDEX]);
+        uint16x8_t g = vmovl_u8(px.val[G_INDEX]);
+        uint16x8_t b = vmovl_u8(px.val[B_INDEX]);
+        uint16x8_t a = vmovl_u8(px.val[A_INDEX]);
+
+        // need our components to be un-premultiplied
+        uint32_t scales[8];
+        const uint32_t* lowScales = NULL;
+        const uint32_t* highScales = NULL;
+        if (~0ULL != vget_lane_u64(vreinterpret_u64_u8(px.val[A_INDEX]), 0)) {
+            for (int j = 0; j < 8; j++) {
+                scales[j] = table[SkGetPackedA32(src[i + j])];
+            }
+            lowScales = &scales[0];
+            highScales = &scales[4];
+        }
+
+        uint16x4_t low[4] = {
+            vget_low_u16(r), vget_low_u16(g), vget_low_u16(b), vget_low_u16(a)
+        };
+        uint16x4_t high[4] = {
+            vget_high_u16(r), vget_high_u16(g), vget_high_u16(b),
+            vget_high_u16(a)
+        };
+        filter4(array, shift, keepsAlpha, lowScales, low);
+        filter4(array, shift, keepsAlpha, highScales, high);
+
+        uint8x8_t out[4];
+        for (int k = 0; k < 4; k++) {
+            out[k] = vqmovn_u16(vcombine_u16(low[k], high[k]));
+        }
+
+        // re-prepremultiply if needed
+        if (~0ULL != vget_lane_u64(vreinterpret_u64_u8(out[3]), 0)) {
+            uint16x8_t scale = vaddw_u8(vdupq_n_u16(1), out[3]);
+            for (int k = 0; k < 3; k++) {
+                out[k] = vshrn_n_u16(vmulq_u16(vmovl_u8(out[k]), scale), 8);
+            }
+        }
+
+        px.val[R_INDEX] = out[0];
+        px.val[G_INDEX] = out[1];
+        px.val[B_INDEX] = out[2];
+        px.val[A_INDEX] = out[3];
+        vst4_u8((uint8_t*)&dst[i], px);
+    }
+    return i;
+}
+
+#define SPAN_NEON   Span_neon
+#else
+#define SPAN_NEON   NULL
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkColorMatrixFilter::SpanProc SkColorMatrixFilter::PlatformSpanProc() {
+    return SPAN_NEON;
+}
@@ -0,0 +1,213 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include <emmintrin.h>
+#include "SkMatrix_opts_SSE2.h"
+
+/*  Each loop maps two points at a time, as x0 y0 x1 y1 in one register, and
+    the last (odd) point on its own. The sums are done in the same order as
+    the portable procs, so that the results are the same.
+ */
+
+#ifdef SK_SCALAR_IS_FLOAT
+
+// x0 x0 x1 x1
+static inline __m128 splat_x(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+// y0 y0 y1 y1
+static inline __m128 splat_y(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+void SkMatrix_Trans_pts_SSE2(const SkMatrix& m, SkPoint dst[],
+                             const SkPoint src[], int count) {
+    SkASSERT(m.getType() == SkMatrix::kTranslate_Mask);
+
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+
+    for (; count >= 2; count -= 2) {
+        __m128 v = _mm_loadu_ps(&src->fX);
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(v, trans));
+        src += 2;
+        dst += 2;
+    }
+    if (count) {
+        dst->fY = src->fY + ty;
+        dst->fX = src->fX + tx;
+    }
+}
+
+void SkMatrix_Scale_pts_SSE2(const SkMatrix& m, SkPoint dst[],
+                             const SkPoint src[], int count) {
+    SkASSERT(m.getType() == SkMatrix::kScale_Mask);
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const __m128 scale = _mm_setr_ps(mx, my, mx, my);
+
+    for (; count >= 2; count -= 2) {
+        __m128 v = _mm_loadu_ps(&src->fX);
+        _mm_storeu_ps(&dst->fX, _mm_mul_ps(v, scale));
+        src += 2;
+        dst += 2;
+    }
+    if (count) {
+        dst->fY = src->fY * my;
+        dst->fX = src->fX * mx;
+    }
+}
+
+void SkMatrix_ScaleTrans_pts_SSE2(const SkMatrix& m, SkPoint dst[],
+                                  const SkPoint src[], int count) {
+    SkASSERT(m.getType() == (SkMatrix::kScale_Mask |
+                             SkMatrix::kTranslate_Mask));
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const __m128 scale = _mm_setr_ps(mx, my, mx, my);
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+
+    for (; count >= 2; count -= 2) {
+        __m128 v = _mm_loadu_ps(&src->fX);
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(_mm_mul_ps(v, scale), trans));
+        src += 2;
+        dst += 2;
+    }
+    if (count) {
+        dst->fY = src->fY * my + ty;
+        dst->fX = src->fX * mx + tx;
+    }
+}
+
+void SkMatrix_Rot_pts_SSE2(const SkMatrix& m, SkPoint dst[],
+                           const SkPoint src[], int count) {
+    SkASSERT((m.getType() & (SkMatrix::kPerspective_Mask |
+                             SkMatrix::kTranslate_Mask)) == 0);
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const SkScalar kx = m.getSkewX();
+    const SkScalar ky = m.getSkewY();
+    // what x and y are multiplied by for x' (and y')
+    const __m128 xmul = _mm_setr_ps(mx, ky, mx, ky);
+    const __m128 ymul = _mm_setr_ps(kx, my, kx, my);
+
+    for (; count >= 2; count -= 2) {
+        __m128 v = _mm_loadu_ps(&src->fX);
+        __m128 r = _mm_add_ps(_mm_mul_ps(splat_x(v), xmul),
+                              _mm_mul_ps(splat_y(v), ymul));
+        _mm_storeu_ps(&dst->fX, r);
+        src += 2;
+        dst += 2;
+    }
+    if (count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        dst->fY = sx * ky + sy * my;
+        dst->fX = sx * mx + sy * kx;
+    }
+}
+
+void SkMatrix_RotTrans_pts_SSE2(const SkMatrix& m, SkPoint dst[],
+                                const SkPoint src[], int count) {
+    SkASSERT(!m.hasPerspective());
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const SkScalar kx = m.getSkewX();
+    const SkScalar ky = m.getSkewY();
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const __m128 xmul = _mm_setr_ps(mx, ky, mx, ky);
+    const __m128 ymul = _mm_setr_ps(kx, my, kx, my);
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+
+    for (; count >= 2; count -= 2) {
+        __m128 v = _mm_loadu_ps(&src->fX);
+        __m128 r = _mm_add_ps(_mm_mul_ps(splat_x(v), xmul),
+                        _mm_add_ps(_mm_mul_ps(splat_y(v), ymul), trans));
+        _mm_storeu_ps(&dst->fX, r);
+        src += 2;
+        dst += 2;
+    }
+    if (count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        dst->fY = sx * ky + (sy * my + ty);
+        dst->fX = sx * mx + (sy * kx + tx);
+    }
+}
+
+void SkMatrix_Persp_pts_SSE2(const SkMatrix& m, SkPoint dst[],
+                             const SkPoint src[], int count) {
+    SkASSERT(m.hasPerspective());
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const SkScalar kx = m.getSkewX();
+    const SkScalar ky = m.getSkewY();
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const SkScalar p0 = m.getPerspX();
+    const SkScalar p1 = m.getPerspY();
+    const SkScalar p2 = m.get(SkMatrix::kMPersp2);
+    const __m128 xmul = _mm_setr_ps(mx, ky, mx, ky);
+    const __m128 ymul = _mm_setr_ps(kx, my, kx, my);
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+    const __m128 persp0 = _mm_set1_ps(p0);
+    const __m128 persp1 = _mm_set1_ps(p1);
+    const __m128 persp2 = _mm_set1_ps(p2);
+    const __m128 one = _mm_set1_ps(1);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; count >= 2; count -= 2) {
+        __m128 v = _mm_loadu_ps(&src->fX);
+        __m128 xx = splat_x(v);
+        __m128 yy = splat_y(v);
+        __m128 xy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, xmul),
+                                          _mm_mul_ps(yy, ymul)), trans);
+        // z0 z0 z1 z1
+        __m128 z = _mm_add_ps(_mm_mul_ps(xx, persp0),
+                              _mm_add_ps(_mm_mul_ps(yy, persp1), persp2));
+        // the portable proc leaves z == 0 alone, rather than inverting it
+        __m128 inv = _mm_andnot_ps(_mm_cmpeq_ps(z, zero),
+                                   _mm_div_ps(one, z));
+        _mm_storeu_ps(&dst->fX, _mm_mul_ps(xy, inv));
+        src += 2;
+        dst += 2;
+    }
+    if (count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        SkScalar x = sx * mx + sy * kx + tx;
+        SkScalar y = sx * ky + sy * my + ty;
+        SkScalar z = sx * p0 + (sy * p1 + p2);
+        if (z) {
+            z = 1 / z;
+        }
+        dst->fY = y * z;
+        dst->fX = x * z;
+    }
+}
+
+#endif
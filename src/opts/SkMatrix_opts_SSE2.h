@@ -0,0 +1,33 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkMatrix.h"
+
+// These match the portable SkMatrix::*_pts procs exactly.
+
+void SkMatrix_Trans_pts_SSE2(const SkMatrix&, SkPoint dst[],
+                             const SkPoint src[], int count);
+void SkMatrix_Scale_pts_SSE2(const SkMatrix&, SkPoint dst[],
+                             const SkPoint src[], int count);
+void SkMatrix_ScaleTrans_pts_SSE2(const SkMatrix&, SkPoint dst[],
+                                  const SkPoint src[], int count);
+void SkMatrix_Rot_pts_SSE2(const SkMatrix&, SkPoint dst[],
+                           const SkPoint src[], int count);
+void SkMatrix_RotTrans_pts_SSE2(const SkMatrix&, SkPoint dst[],
+                                const SkPoint src[], int count);
+void SkMatrix_Persp_pts_SSE2(const SkMatrix&, SkPoint dst[],
+                             const SkPoint src[], int count);
@@ -0,0 +1,184 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkMatrix.h"
+
+#if defined(__ARM_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+/*  The NEON procs map four points at a time, loading them as four x's and
+    four y's (vld2q), and the last few points on their own. The sums are done
+    in the same order as the portable procs. NEON flushes denormals to zero,
+    which is all that can differ.
+
+    There's no NEON divide, and a reciprocal estimate wouldn't match, so
+    perspective is left to the portable proc.
+ */
+
+#if defined(__ARM_HAVE_NEON) && defined(SK_SCALAR_IS_FLOAT)
+
+static void Trans_pts_neon(const SkMatrix& m, SkPoint dst[],
+                           const SkPoint src[], int count) {
+    SkASSERT(m.getType() == SkMatrix::kTranslate_Mask);
+
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const float32x4_t vtx = vdupq_n_f32(tx);
+    const float32x4_t vty = vdupq_n_f32(ty);
+
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t v = vld2q_f32(&src->fX);
+        v.val[0] = vaddq_f32(v.val[0], vtx);
+        v.val[1] = vaddq_f32(v.val[1], vty);
+        vst2q_f32(&dst->fX, v);
+        src += 4;
+        dst += 4;
+    }
+    for (; count > 0; --count) {
+        dst->fY = src->fY + ty;
+        dst->fX = src->fX + tx;
+        src += 1;
+        dst += 1;
+    }
+}
+
+static void Scale_pts_neon(const SkMatrix& m, SkPoint dst[],
+                           const SkPoint src[], int count) {
+    SkASSERT(m.getType() == SkMatrix::kScale_Mask);
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const float32x4_t vmx = vdupq_n_f32(mx);
+    const float32x4_t vmy = vdupq_n_f32(my);
+
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t v = vld2q_f32(&src->fX);
+        v.val[0] = vmulq_f32(v.val[0], vmx);
+        v.val[1] = vmulq_f32(v.val[1], vmy);
+        vst2q_f32(&dst->fX, v);
+        src += 4;
+        dst += 4;
+    }
+    for (; count > 0; --count) {
+        dst->fY = src->fY * my;
+        dst->fX = src->fX * mx;
+        src += 1;
+        dst += 1;
+    }
+}
+
+static void ScaleTrans_pts_neon(const SkMatrix& m, SkPoint dst[],
+                                const SkPoint src[], int count) {
+    SkASSERT(m.getType() == (SkMatrix::kScale_Mask |
+                             SkMatrix::kTranslate_Mask));
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const float32x4_t vmx = vdupq_n_f32(mx);
+    const float32x4_t vmy = vdupq_n_f32(my);
+    const float32x4_t vtx = vdupq_n_f32(tx);
+    const float32x4_t vty = vdupq_n_f32(ty);
+
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t v = vld2q_f32(&src->fX);
+        // not vmlaq, so that the product is rounded as it is in C
+        v.val[0] = vaddq_f32(vmulq_f32(v.val[0], vmx), vtx);
+        v.val[1] = vaddq_f32(vmulq_f32(v.val[1], vmy), vty);
+        vst2q_f32(&dst->fX, v);
+        src += 4;
+        dst += 4;
+    }
+    for (; count > 0; --count) {
+        dst->fY = src->fY * my + ty;
+        dst->fX = src->fX * mx + tx;
+        src += 1;
+        dst += 1;
+    }
+}
+
+static void RotTrans_pts_neon(const SkMatrix& m, SkPoint dst[],
+                              const SkPoint src[], int count) {
+    SkASSERT(!m.hasPerspective());
+
+    const SkScalar mx = m.getScaleX();
+    const SkScalar my = m.getScaleY();
+    const SkScalar kx = m.getSkewX();
+    const SkScalar ky = m.getSkewY();
+    const SkScalar tx = m.getTranslateX();
+    const SkScalar ty = m.getTranslateY();
+    const float32x4_t vmx = vdupq_n_f32(mx);
+    const float32x4_t vmy = vdupq_n_f32(my);
+    const float32x4_t vkx = vdupq_n_f32(kx);
+    const float32x4_t vky = vdupq_n_f32(ky);
+    const float32x4_t vtx = vdupq_n_f32(tx);
+    const float32x4_t vty = vdupq_n_f32(ty);
+
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t v = vld2q_f32(&src->fX);
+        float32x4x2_t r;
+        r.val[0] = vaddq_f32(vmulq_f32(v.val[0], vmx),
+                             vaddq_f32(vmulq_f32(v.val[1], vkx), vtx));
+        r.val[1] = vaddq_f32(vmulq_f32(v.val[0], vky),
+                             vaddq_f32(vmulq_f32(v.val[1], vmy), vty));
+        vst2q_f32(&dst->fX, r);
+        src += 4;
+        dst += 4;
+    }
+    for (; count > 0; --count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        dst->fY = sx * ky + (sy * my + ty);
+        dst->fX = sx * mx + (sy * kx + tx);
+        src += 1;
+        dst += 1;
+    }
+}
+
+#define TRANS_PTS_NEON          Trans_pts_neon
+#define SCALE_PTS_NEON          Scale_pts_neon
+#define SCALETRANS_PTS_NEON     ScaleTrans_pts_neon
+#define ROTTRANS_PTS_NEON       RotTrans_pts_neon
+#else
+#define TRANS_PTS_NEON          NULL
+#define SCALE_PTS_NEON          NULL
+#define SCALETRANS_PTS_NEON     NULL
+#define ROTTRANS_PTS_NEON       NULL
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkMatrix::MapPtsProc SkMatrix::PlatformMapPtsProc(TypeMask mask) {
+    switch (mask) {
+        case kTranslate_Mask:
+            return TRANS_PTS_NEON;
+        case kScale_Mask:
+            return SCALE_PTS_NEON;
+        case kScale_Mask | kTranslate_Mask:
+            return SCALETRANS_PTS_NEON;
+        // the translate is zero without kTranslate_Mask, which adds nothing
+        // (except to -0), so these use the same proc
+        case kAffine_Mask:
+        case kAffine_Mask | kScale_Mask:
+        case kAffine_Mask | kTranslate_Mask:
+        case kAffine_Mask | kScale_Mask | kTranslate_Mask:
+            return ROTTRANS_PTS_NEON;
+        default:
+            return NULL;
+    }
+}
@@ -17,6 +17,9 @@
 
 #include <emmintrin.h>
 #include "SkUtils_opts_SSE2.h"
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
+#include "SkUtils.h"
  
 void sk_memset16_SSE2(uint16_t *dst, uint16_t value, int count)
 {
@@ -75,3 +78,244 @@ void sk_memset32_SSE2(uint32_t *dst, uint32_t value, int count)
         --count;
     }
 }
+
+/*  Rects this big won't fit in the caches, and won't be in them by the time
+    they are read, so they are streamed out around them, which also saves
+    reading in each line only to overwrite it. Smaller ones are left to the
+    usual stores, which are faster for as long as the last level cache can
+    hold the rect, and those can be tens of megabytes.
+ */
+static const size_t kStreamBytes = 32 << 20;
+
+static void stream16(uint16_t dst[], uint16_t value, int count) {
+    while ((((size_t)dst) & 0x0F) && count > 0) {
+        *dst++ = value;
+        --count;
+    }
+    __m128i *d = reinterpret_cast<__m128i*>(dst);
+    __m128i value_wide = _mm_set1_epi16(value);
+    while (count >= 32) {
+        _mm_stream_si128(d++, value_wide);
+        _mm_stream_si128(d++, value_wide);
+        _mm_stream_si128(d++, value_wide);
+        _mm_stream_si128(d++, value_wide);
+        count -= 32;
+    }
+    while (count >= 8) {
+        _mm_stream_si128(d++, value_wide);
+        count -= 8;
+    }
+    dst = reinterpret_cast<uint16_t*>(d);
+    while (count > 0) {
+        *dst++ = value;
+        --count;
+    }
+}
+
+static void stream32(uint32_t dst[], uint32_t value, int count) {
+    while ((((size_t)dst) & 0x0F) && count > 0) {
+        *dst++ = value;
+        --count;
+    }
+    __m128i *d = reinterpret_cast<__m128i*>(dst);
+    __m128i value_wide = _mm_set1_epi32(value);
+    while (count >= 16) {
+        _mm_stream_si128(d++, value_wide);
+        _mm_stream_si128(d++, value_wide);
+        _mm_stream_si128(d++, value_wide);
+        _mm_stream_si128(d++, value_wide);
+        count -= 16;
+    }
+    while (count >= 4) {
+        _mm_stream_si128(d++, value_wide);
+        count -= 4;
+    }
+    dst = reinterpret_cast<uint32_t*>(d);
+    while (count > 0) {
+        *dst++ = value;
+        --count;
+    }
+}
+
+void sk_memset_rect16_SSE2(uint16_t dst[], uint16_t value, int width,
+                           int height, size_t rowBytes)
+{
+    SkASSERT(dst != NULL && width >= 0 && height >= 0);
+
+    if ((size_t)width * height * sizeof(uint16_t) < kStreamBytes) {
+        sk_memset_rect16_portable(dst, value, width, height, rowBytes);
+        return;
+    }
+    if (rowBytes == width * sizeof(uint16_t)) {
+        width *= height;
+        height = 1;
+    }
+    while (--height >= 0) {
+        stream16(dst, value, width);
+        dst = (uint16_t*)((char*)dst + rowBytes);
+    }
+    // the streamed stores have to land before anyone reads the pixels
+    _mm_sfence();
+}
+
+void sk_memset_rect32_SSE2(uint32_t dst[], uint32_t value, int width,
+                           int height, size_t rowBytes)
+{
+    SkASSERT(dst != NULL && width >= 0 && height >= 0);
+
+    if ((size_t)width * height * sizeof(uint32_t) < kStreamBytes) {
+        sk_memset_rect32_portable(dst, value, width, height, rowBytes);
+        return;
+    }
+    if (rowBytes == width * sizeof(uint32_t)) {
+        width *= height;
+        height = 1;
+    }
+    while (--height >= 0) {
+        stream32(dst, value, width);
+        dst = (uint32_t*)((char*)dst + rowBytes);
+    }
+    _mm_sfence();
+}
+
+/*  SSE2 has no byte shuffle to look up with, but masks are mostly runs of
+    one value (0 outside the glyph, 0xFF inside it), so sixteen bytes that
+    are all the same are mapped with one lookup and one store, and the rest
+    one byte at a time.
+ */
+void sk_table8_SSE2(uint8_t dst[], const uint8_t src[], int count,
+                    const uint8_t table[256])
+{
+    SkASSERT(dst != NULL && src != NULL && table != NULL && count >= 0);
+
+    while (count >= 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i first = _mm_set1_epi8(src[0]);
+        if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(s, first))) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                             _mm_set1_epi8(table[src[0]]));
+        } else {
+            for (int i = 0; i < 16; i++) {
+                dst[i] = table[src[i]];
+            }
+        }
+        src += 16;
+        dst += 16;
+        count -= 16;
+    }
+    while (count > 0) {
+        *dst++ = table[*src++];
+        --count;
+    }
+}
+
+// the four pixels of c, one channel in the low byte of each lane
+static inline __m128i channel_32(__m128i c, int shift) {
+    return _mm_and_si128(_mm_srli_epi32(c, shift), _mm_set1_epi32(0xFF));
+}
+
+// r, g and b in the low byte of each lane, packed into four opaque SkPMColors
+static inline __m128i pack_8888(__m128i r, __m128i g, __m128i b) {
+    __m128i c = _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT);
+    c = _mm_or_si128(c, _mm_slli_epi32(r, SK_R32_SHIFT));
+    c = _mm_or_si128(c, _mm_slli_epi32(g, SK_G32_SHIFT));
+    return _mm_or_si128(c, _mm_slli_epi32(b, SK_B32_SHIFT));
+}
+
+/*  SkPixel16ToPixel32 for eight pixels at a time: each channel is widened to
+    8 bits by replicating its high bits into the new low ones.
+ */
+void sk_pixel16_to_pixel32_SSE2(uint32_t dst[], const uint16_t src[],
+                                int count)
+{
+    SkASSERT(dst != NULL && src != NULL && count >= 0);
+
+    const __m128i mask5 = _mm_set1_epi16(SK_R16_MASK);
+    const __m128i mask6 = _mm_set1_epi16(SK_G16_MASK);
+    const __m128i zero = _mm_setzero_si128();
+    while (count >= 8) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i r = _mm_and_si128(_mm_srli_epi16(c, SK_R16_SHIFT), mask5);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(c, SK_G16_SHIFT), mask6);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(c, SK_B16_SHIFT), mask5);
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+        __m128i lo = pack_8888(_mm_unpacklo_epi16(r, zero),
+                               _mm_unpacklo_epi16(g, zero),
+                               _mm_unpacklo_epi16(b, zero));
+        __m128i hi = pack_8888(_mm_unpackhi_epi16(r, zero),
+                               _mm_unpackhi_epi16(g, zero),
+                               _mm_unpackhi_epi16(b, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), hi);
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+    while (count > 0) {
+        *dst++ = SkPixel16ToPixel32(*src++);
+        --count;
+    }
+}
+
+// the low 32 bits of each lane's product, as SSE4.1's _mm_mullo_epi32
+static inline __m128i mullo_epi32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// SkUnPreMultiply::ApplyScale in each lane, wrapping as its uint32_t does
+static inline __m128i apply_scale(__m128i scale, __m128i component) {
+    __m128i prod = _mm_add_epi32(mullo_epi32(scale, component),
+                                 _mm_set1_epi32(1 << 23));
+    return _mm_srli_epi32(prod, 24);
+}
+
+/*  Four colors at a time. The scales are looked up one at a time, with
+    1 << 24 (which leaves a component as it is) for alphas 0 and 255, and
+    four opaque colors skip the scaling altogether.
+ */
+void sk_unpremultiply_to_rgba_SSE2(uint8_t dst[], const uint32_t src[],
+                                   int count)
+{
+    SkASSERT(dst != NULL && src != NULL && count >= 0);
+
+    const SkUnPreMultiply::Scale* SK_RESTRICT table =
+                                            SkUnPreMultiply::GetScaleTable();
+    const __m128i opaque = _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT);
+    while (count >= 4) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i r = channel_32(c, SK_R32_SHIFT);
+        __m128i g = channel_32(c, SK_G32_SHIFT);
+        __m128i b = channel_32(c, SK_B32_SHIFT);
+        __m128i a = channel_32(c, SK_A32_SHIFT);
+
+        __m128i isOpaque = _mm_cmpeq_epi32(_mm_and_si128(c, opaque), opaque);
+        if (0xFFFF != _mm_movemask_epi8(isOpaque)) {
+            uint32_t scales[4];
+            for (int i = 0; i < 4; i++) {
+                unsigned alpha = SkGetPackedA32(src[i]);
+                scales[i] = (0 == alpha || 255 == alpha) ? (1 << 24)
+                                                         : table[alpha];
+            }
+            __m128i scale = _mm_loadu_si128(
+                                    reinterpret_cast<const __m128i*>(scales));
+            r = apply_scale(scale, r);
+            g = apply_scale(scale, g);
+            b = apply_scale(scale, b);
+        }
+
+        __m128i rgba = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                    _mm_or_si128(_mm_slli_epi32(b, 16),
+                                                 _mm_slli_epi32(a, 24)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), rgba);
+        src += 4;
+        dst += 16;
+        count -= 4;
+    }
+    sk_unpremultiply_to_rgba_portable(dst, src, count);
+}
@@ -19,3 +19,13 @@
  
 void sk_memset16_SSE2(uint16_t *dst, uint16_t value, int count);
 void sk_memset32_SSE2(uint32_t *dst, uint32_t value, int count);
+void sk_memset_rect16_SSE2(uint16_t dst[], uint16_t value, int width,
+                           int height, size_t rowBytes);
+void sk_memset_rect32_SSE2(uint32_t dst[], uint32_t value, int width,
+                           int height, size_t rowBytes);
+void sk_table8_SSE2(uint8_t dst[], const uint8_t src[], int count,
+                    const uint8_t table[256]);
+void sk_pixel16_to_pixel32_SSE2(uint32_t dst[], const uint16_t src[],
+                                int count);
+void sk_unpremultiply_to_rgba_SSE2(uint8_t dst[], const uint32_t src[],
+                                   int count);
@@ -17,6 +17,10 @@
 
 #include "SkUtils.h"
 
+uint32_t SkGetCpuFeatures() {
+    return 0;
+}
+
 SkMemset16Proc SkMemset16GetPlatformProc() {
     return NULL;
 }
@@ -24,3 +28,23 @@ SkMemset16Proc SkMemset16GetPlatformProc() {
 SkMemset32Proc SkMemset32GetPlatformProc() {
     return NULL;
 }
+
+SkMemsetRect16Proc SkMemsetRect16GetPlatformProc() {
+    return NULL;
+}
+
+SkMemsetRect32Proc SkMemsetRect32GetPlatformProc() {
+    return NULL;
+}
+
+SkTable8Proc SkTable8GetPlatformProc() {
+    return NULL;
+}
+
+SkPixel16ToPixel32Proc SkPixel16ToPixel32GetPlatformProc() {
+    return NULL;
+}
+
+SkUnPremultiplyToRGBAProc SkUnPremultiplyToRGBAGetPlatformProc() {
+    return NULL;
+}
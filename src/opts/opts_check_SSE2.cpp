@@ -15,8 +15,11 @@
  ** limitations under the License.
  */
 
+#include "SkAvoidXfermode_opts_SSE2.h"
 #include "SkBitmapProcState_opts_SSE2.h"
 #include "SkBlitRow_opts_SSE2.h"
+#include "SkColorMatrixFilter_opts_SSE2.h"
+#include "SkMatrix_opts_SSE2.h"
 #include "SkUtils_opts_SSE2.h"
 #include "SkUtils.h"
 
@@ -25,16 +28,21 @@
    instruction on Pentium3 on the code below).  Only files named *_SSE2.cpp
    in this directory should be compiled with -msse2. */
 
-#if defined(__x86_64__) || defined(_WIN64)
-/* All x86_64 machines have SSE2, so don't even bother checking. */
-static inline bool hasSSE2() {
-    return true;
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+
+static inline void getcpuid(int info_type, int info[4]) {
+    __cpuidex(info, info_type, 0);
 }
-#else
-#ifdef _MSC_VER
+
+static inline uint64_t getxcr0() {
+    return _xgetbv(0);
+}
+#elif defined(_MSC_VER)
 static inline void getcpuid(int info_type, int info[4]) {
     __asm {
         mov    eax, [info_type]
+        xor    ecx, ecx
         cpuid
         mov    edi, [info]
         mov    [edi], eax
@@ -43,8 +51,28 @@ static inline void getcpuid(int info_type, int info[4]) {
         mov    [edi+12], edx
     }
 }
+
+static inline uint64_t getxcr0() {
+    uint32_t lo, hi;
+    __asm {
+        xor    ecx, ecx
+        _emit  0x0f             // xgetbv, which older assemblers don't know
+        _emit  0x01
+        _emit  0xd0
+        mov    [lo], eax
+        mov    [hi], edx
+    }
+    return ((uint64_t)hi << 32) | lo;
+}
 #else
 static inline void getcpuid(int info_type, int info[4]) {
+#if defined(__x86_64__)
+    asm volatile (
+        "cpuid            \n\t"
+        : "=a"(info[0]), "=b"(info[1]), "=c"(info[2]), "=d"(info[3])
+        : "a"(info_type), "c"(0)
+    );
+#else
     // We save and restore ebx, so this code can be compatible with -fPIC
     asm volatile (
         "pushl %%ebx      \n\t"
@@ -52,24 +80,127 @@ static inline void getcpuid(int info_type, int info[4]) {
         "movl %%ebx, %1   \n\t"
         "popl %%ebx       \n\t"
         : "=a"(info[0]), "=r"(info[1]), "=c"(info[2]), "=d"(info[3])
-        : "a"(info_type)
+        : "a"(info_type), "c"(0)
     );
+#endif
+}
+
+static inline uint64_t getxcr0() {
+    uint32_t lo, hi;
+    // xgetbv, which older assemblers don't know
+    asm volatile (".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
 }
 #endif
 
+static uint32_t probe_cpu_features() {
+    int info[4] = { 0 };
+    getcpuid(0, info);
+    const int maxLeaf = info[0];
+
+    getcpuid(1, info);
+    uint32_t features = 0;
+    if (info[3] & (1 << 26)) {
+        features |= kSSE2_SkCpuFeature;
+    }
+    if (info[2] & (1 << 9)) {
+        features |= kSSSE3_SkCpuFeature;
+    }
+    if (info[2] & (1 << 19)) {
+        features |= kSSE41_SkCpuFeature;
+    }
+
+    // AVX2 also needs the OS to save the ymm registers (OSXSAVE, AVX, and
+    // both the xmm and ymm state bits in XCR0)
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsave_avx) == osxsave_avx && (getxcr0() & 6) == 6 &&
+            maxLeaf >= 7) {
+        getcpuid(7, info);
+        if (info[1] & (1 << 5)) {
+            features |= kAVX2_SkCpuFeature;
+        }
+    }
+    return features;
+}
+
+// looked up once; threads racing to look them up all find the same features
+uint32_t SkGetCpuFeatures() {
+    static bool gChecked;
+    static uint32_t gFeatures;
+    if (!gChecked) {
+        gFeatures = probe_cpu_features();
+        gChecked = true;
+    }
+    return gFeatures;
+}
+
 static inline bool hasSSE2() {
-    int cpu_info[4] = { 0 };
-    getcpuid(1, cpu_info);
-    return (cpu_info[3] & (1<<26)) != 0;
+    return SkToBool(SkGetCpuFeatures() & kSSE2_SkCpuFeature);
 }
-#endif
+
+static const struct {
+    SkBitmapProcState::MatrixProc fProc;
+    SkBitmapProcState::MatrixProc fProcSSE2;
+} gMatrixProcs[] = {
+    { ClampX_ClampY_nofilter_scale,     ClampX_ClampY_nofilter_scale_SSE2    },
+    { ClampX_ClampY_filter_scale,       ClampX_ClampY_filter_scale_SSE2      },
+    { ClampX_ClampY_nofilter_affine,    ClampX_ClampY_nofilter_affine_SSE2   },
+    { ClampX_ClampY_filter_affine,      ClampX_ClampY_filter_affine_SSE2     },
+    { RepeatX_RepeatY_nofilter_scale,   RepeatX_RepeatY_nofilter_scale_SSE2  },
+    { RepeatX_RepeatY_filter_scale,     RepeatX_RepeatY_filter_scale_SSE2    },
+    { RepeatX_RepeatY_nofilter_affine,  RepeatX_RepeatY_nofilter_affine_SSE2 },
+    { RepeatX_RepeatY_filter_affine,    RepeatX_RepeatY_filter_affine_SSE2   },
+    { ClampX_ClampY_nofilter_persp,     ClampX_ClampY_nofilter_persp_SSE2    },
+    { ClampX_ClampY_filter_persp,       ClampX_ClampY_filter_persp_SSE2      },
+    { RepeatX_RepeatY_nofilter_persp,   RepeatX_RepeatY_nofilter_persp_SSE2  },
+    { RepeatX_RepeatY_filter_persp,     RepeatX_RepeatY_filter_persp_SSE2    },
+};
 
 void SkBitmapProcState::platformProcs() {
-    if (hasSSE2()) {
-        if (fSampleProc32 == S32_opaque_D32_filter_DX) {
-            fSampleProc32 = S32_opaque_D32_filter_DX_SSE2;
-        } else if (fSampleProc32 == S32_alpha_D32_filter_DX) {
-            fSampleProc32 = S32_alpha_D32_filter_DX_SSE2;
+    if (!hasSSE2()) {
+        return;
+    }
+
+    if (fSampleProc32 == S32_opaque_D32_filter_DX) {
+        fSampleProc32 = S32_opaque_D32_filter_DX_SSE2;
+    } else if (fSampleProc32 == S32_alpha_D32_filter_DX) {
+        fSampleProc32 = S32_alpha_D32_filter_DX_SSE2;
+    } else if (fSampleProc32 == SI8_opaque_D32_filter_DX) {
+        fSampleProc32 = SI8_opaque_D32_filter_DX_SSE2;
+    } else if (fSampleProc32 == S32_opaque_D32_filter_DXDY) {
+        fSampleProc32 = S32_opaque_D32_filter_DXDY_SSE2;
+    } else if (fSampleProc32 == S32_alpha_D32_filter_DXDY) {
+        fSampleProc32 = S32_alpha_D32_filter_DXDY_SSE2;
+    } else if (fSampleProc32 == S32_alpha_D32_nofilter_DXDY) {
+        fSampleProc32 = S32_alpha_D32_nofilter_DXDY_SSE2;
+    }
+
+    // the SSE2 repeat procs multiply by the width and height in 16 bits
+    if ((fBitmap->width() | fBitmap->height()) > 0xFFFF) {
+        return;
+    }
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gMatrixProcs); i++) {
+        if (fMatrixProc == gMatrixProcs[i].fProc) {
+            fMatrixProc = gMatrixProcs[i].fProcSSE2;
+            break;
+        }
+    }
+
+    // an opaque 8888 source that is only scaled is sampled as soon as its
+    // coordinates are computed
+    if (NULL == fShaderProc32) {
+        if (fSampleProc32 == S32_opaque_D32_nofilter_DX) {
+            if (fMatrixProc == ClampX_ClampY_nofilter_scale_SSE2) {
+                fShaderProc32 = Clamp_S32_opaque_D32_nofilter_DX_shaderproc_SSE2;
+            } else if (fMatrixProc == RepeatX_RepeatY_nofilter_scale_SSE2) {
+                fShaderProc32 = Repeat_S32_opaque_D32_nofilter_DX_shaderproc_SSE2;
+            }
+        } else if (fSampleProc32 == S32_opaque_D32_filter_DX_SSE2) {
+            if (fMatrixProc == ClampX_ClampY_filter_scale_SSE2) {
+                fShaderProc32 = Clamp_S32_opaque_D32_filter_DX_shaderproc_SSE2;
+            } else if (fMatrixProc == RepeatX_RepeatY_filter_scale_SSE2) {
+                fShaderProc32 = Repeat_S32_opaque_D32_filter_DX_shaderproc_SSE2;
+            }
         }
     }
 }
@@ -85,8 +216,26 @@ SkBlitRow::Proc SkBlitRow::PlatformProcs4444(unsigned flags) {
     return NULL;
 }
 
+static SkBlitRow::Proc platform_565_procs[] = {
+    // no dither
+    S32_D565_Opaque_SSE2,
+    S32_D565_Blend_SSE2,
+    S32A_D565_Opaque_SSE2,
+    S32A_D565_Blend_SSE2,
+
+    // dither
+    S32_D565_Opaque_Dither_SSE2,
+    S32_D565_Blend_Dither_SSE2,
+    S32A_D565_Opaque_Dither_SSE2,
+    S32A_D565_Blend_Dither_SSE2,
+};
+
 SkBlitRow::Proc SkBlitRow::PlatformProcs565(unsigned flags) {
-    return NULL;
+    if (hasSSE2()) {
+        return platform_565_procs[flags];
+    } else {
+        return NULL;
+    }
 }
 
 SkBlitRow::ColorProc SkBlitRow::PlatformColorProc() {
@@ -97,6 +246,30 @@ SkBlitRow::ColorProc SkBlitRow::PlatformColorProc() {
     }
 }
 
+SkBlitRow::ColorAAProc SkBlitRow::PlatformColorAAProc() {
+    if (hasSSE2()) {
+        return ColorAA32_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkBlitRow::ColorA8Proc SkBlitRow::PlatformColorA8Proc() {
+    if (hasSSE2()) {
+        return ColorA8_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkBlitRow::AlphaA8Proc SkBlitRow::PlatformAlphaA8Proc() {
+    if (hasSSE2()) {
+        return AlphaA8_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
 SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
     if (hasSSE2()) {
         return platform_32_procs[flags];
@@ -106,6 +279,32 @@ SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
 }
 
 
+SkXfermode::Proc32 SkXfermode::PlatformProcs32(Mode mode) {
+    if (!hasSSE2()) {
+        return NULL;
+    }
+    switch (mode) {
+        case kMultiply_Mode:
+            return Multiply_Xfer32_SSE2;
+        case kScreen_Mode:
+            return Screen_Xfer32_SSE2;
+        case kDarken_Mode:
+            return Darken_Xfer32_SSE2;
+        case kLighten_Mode:
+            return Lighten_Xfer32_SSE2;
+        case kSrcIn_Mode:
+            return SrcIn_Xfer32_SSE2;
+        case kDstIn_Mode:
+            return DstIn_Xfer32_SSE2;
+        case kDstOut_Mode:
+            return DstOut_Xfer32_SSE2;
+        case kSrcATop_Mode:
+            return SrcATop_Xfer32_SSE2;
+        default:
+            return NULL;
+    }
+}
+
 SkBlitMask::Proc SkBlitMask::PlatformProcs(SkBitmap::Config dstConfig,
                                            SkColor color)
 {
@@ -114,10 +313,17 @@ SkBlitMask::Proc SkBlitMask::PlatformProcs(SkBitmap::Config dstConfig,
     if (hasSSE2()) {
         switch (dstConfig) {
             case SkBitmap::kARGB_8888_Config:
-                // TODO: is our current SSE2 faster than the portable, even in
-                // the case of black or opaque? If so, no need for this check.
-                if ( SK_ColorBLACK != color && 0xFF != SkColorGetA(color))
-                    proc = SkARGB32_BlitMask_SSE2;
+                // the SSE2 version matches the portable procs exactly, and is
+                // faster for black and opaque colors too
+                proc = SkARGB32_BlitMask_SSE2;
+                break;
+            case SkBitmap::kRGB_565_Config:
+                // these match SkRGB16_Opaque_Blitter and SkRGB16_Blitter
+                if (0xFF == SkColorGetA(color)) {
+                    proc = SkRGB16_BlitMask_Opaque_SSE2;
+                } else {
+                    proc = SkRGB16_BlitMask_Color_SSE2;
+                }
                 break;
             default:
                  break;
@@ -126,6 +332,22 @@ SkBlitMask::Proc SkBlitMask::PlatformProcs(SkBitmap::Config dstConfig,
     return proc;
 }
 
+SkBlitMask::LCD16RowProc SkBlitMask::PlatformLCD16RowProc() {
+    if (hasSSE2()) {
+        return LCD16_Row_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkBlitMask::LCD32RowProc SkBlitMask::PlatformLCD32RowProc() {
+    if (hasSSE2()) {
+        return LCD32_Row_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
 SkMemset16Proc SkMemset16GetPlatformProc() {
     if (hasSSE2()) {
         return sk_memset16_SSE2;
@@ -141,3 +363,104 @@ SkMemset32Proc SkMemset32GetPlatformProc() {
         return NULL;
     }
 }
+
+SkMemsetRect16Proc SkMemsetRect16GetPlatformProc() {
+    if (hasSSE2()) {
+        return sk_memset_rect16_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkMemsetRect32Proc SkMemsetRect32GetPlatformProc() {
+    if (hasSSE2()) {
+        return sk_memset_rect32_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkTable8Proc SkTable8GetPlatformProc() {
+    if (hasSSE2()) {
+        return sk_table8_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkPixel16ToPixel32Proc SkPixel16ToPixel32GetPlatformProc() {
+    if (hasSSE2()) {
+        return sk_pixel16_to_pixel32_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkUnPremultiplyToRGBAProc SkUnPremultiplyToRGBAGetPlatformProc() {
+    if (hasSSE2()) {
+        return sk_unpremultiply_to_rgba_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkMatrix::MapPtsProc SkMatrix::PlatformMapPtsProc(TypeMask mask) {
+#ifdef SK_SCALAR_IS_FLOAT
+    if (!hasSSE2()) {
+        return NULL;
+    }
+    if (mask & kPerspective_Mask) {
+        return SkMatrix_Persp_pts_SSE2;
+    }
+    switch (mask) {
+        case kTranslate_Mask:
+            return SkMatrix_Trans_pts_SSE2;
+        case kScale_Mask:
+            return SkMatrix_Scale_pts_SSE2;
+        case kScale_Mask | kTranslate_Mask:
+            return SkMatrix_ScaleTrans_pts_SSE2;
+        case kAffine_Mask:
+        case kAffine_Mask | kScale_Mask:
+            return SkMatrix_Rot_pts_SSE2;
+        case kAffine_Mask | kTranslate_Mask:
+        case kAffine_Mask | kScale_Mask | kTranslate_Mask:
+            return SkMatrix_RotTrans_pts_SSE2;
+        default:
+            return NULL;
+    }
+#else
+    return NULL;
+#endif
+}
+
+SkColorMatrixFilter::SpanProc SkColorMatrixFilter::PlatformSpanProc() {
+    if (hasSSE2()) {
+        return SkColorMatrixFilter_Span_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkAvoidXfermode::Proc32 SkAvoidXfermode::PlatformProc32() {
+    if (hasSSE2()) {
+        return SkAvoidXfermode_Proc32_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkAvoidXfermode::Proc16 SkAvoidXfermode::PlatformProc16() {
+    if (hasSSE2()) {
+        return SkAvoidXfermode_Proc16_SSE2;
+    } else {
+        return NULL;
+    }
+}
+
+SkPixelXorXfermode::Proc32 SkPixelXorXfermode::PlatformProc32() {
+    if (hasSSE2()) {
+        return SkPixelXorXfermode_Proc32_SSE2;
+    } else {
+        return NULL;
+    }
+}
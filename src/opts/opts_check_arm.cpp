@@ -24,6 +24,10 @@
 
 #include "SkUtils.h"
 
+#if defined(__ARM_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
 extern "C" void memset16_neon(uint16_t dst[], uint16_t value, int count);
 extern "C" void memset32_neon(uint32_t dst[], uint32_t value, int count);
 
@@ -38,6 +42,11 @@ static inline bool hasNeonRegisters() {
 #endif
 }
 
+// NEON is chosen at compile time
+uint32_t SkGetCpuFeatures() {
+    return 0;
+}
+
 SkMemset16Proc SkMemset16GetPlatformProc() {
     if (hasNeonRegisters()) {
         return memset16_neon;
@@ -61,3 +70,65 @@ SkMemset32Proc SkMemset32GetPlatformProc() {
 #endif
     }
 }
+
+#if defined(__ARM_HAVE_NEON) && defined(SK_CPU_LENDIAN)
+/*  vtbl4 looks eight bytes up in 32 entries, and vtbx4 does the same but
+    leaves the bytes whose index is out of range alone, so eight of them walk
+    the 256 entries a 32 entry slice at a time. Subtracting each slice's base
+    wraps the lower indices around to 224 and up, out of range.
+ */
+static void sk_table8_neon(uint8_t dst[], const uint8_t src[], int count,
+                           const uint8_t table[256]) {
+    SkASSERT(dst != NULL && src != NULL && table != NULL && count >= 0);
+
+    if (count >= 8) {
+        uint8x8x4_t slices[8];
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 4; j++) {
+                slices[i].val[j] = vld1_u8(table + i * 32 + j * 8);
+            }
+        }
+        const uint8x8_t step = vdup_n_u8(32);
+        do {
+            uint8x8_t index = vld1_u8(src);
+            uint8x8_t result = vtbl4_u8(slices[0], index);
+            for (int i = 1; i < 8; i++) {
+                index = vsub_u8(index, step);
+                result = vtbx4_u8(result, slices[i], index);
+            }
+            vst1_u8(dst, result);
+            src += 8;
+            dst += 8;
+            count -= 8;
+        } while (count >= 8);
+    }
+    while (count > 0) {
+        *dst++ = table[*src++];
+        count -= 1;
+    }
+}
+#endif
+
+SkMemsetRect16Proc SkMemsetRect16GetPlatformProc() {
+    return NULL;
+}
+
+SkMemsetRect32Proc SkMemsetRect32GetPlatformProc() {
+    return NULL;
+}
+
+SkTable8Proc SkTable8GetPlatformProc() {
+#if defined(__ARM_HAVE_NEON) && defined(SK_CPU_LENDIAN)
+    return sk_table8_neon;
+#else
+    return NULL;
+#endif
+}
+
+SkPixel16ToPixel32Proc SkPixel16ToPixel32GetPlatformProc() {
+    return NULL;
+}
+
+SkUnPremultiplyToRGBAProc SkUnPremultiplyToRGBAGetPlatformProc() {
+    return NULL;
+}
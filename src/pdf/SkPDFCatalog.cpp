@@ -25,11 +25,18 @@ SkPDFCatalog::SkPDFCatalog()
       fNextFirstPageObjNum(0) {
 }
 
-SkPDFCatalog::~SkPDFCatalog() {}
+SkPDFCatalog::~SkPDFCatalog() {
+    for (int i = 0; i < fSubstituteMap.count(); i++)
+        fSubstituteMap[i].fSubstitute->unref();
+    fReplacedResources.unrefAll();
+}
 
 SkPDFObject* SkPDFCatalog::addObject(SkPDFObject* obj, bool onFirstPage) {
     SkASSERT(findObjectIndex(obj) == -1);
-    SkASSERT(fNextFirstPageObjNum == 0);
+    // Once object numbers are being assigned, only objects numbered after
+    // all the others can be added: that's all of them without a first page.
+    SkASSERT(fNextFirstPageObjNum == 0 ||
+             (!onFirstPage && fFirstPageCount == 0));
     if (onFirstPage)
         fFirstPageCount++;
 
@@ -47,8 +54,16 @@ size_t SkPDFCatalog::setFileOffset(SkPDFObject* obj, size_t offset) {
     return obj->getOutputSize(this, true);
 }
 
+void SkPDFCatalog::forgetObject(SkPDFObject* obj) {
+    int objIndex = findObjectIndex(obj);
+    SkASSERT(objIndex >= 0);
+    SkASSERT(fCatalog[objIndex].fObjNumAssigned);
+    SkASSERT(fCatalog[objIndex].fFileOffset > 0);
+    fCatalog[objIndex].fObject = NULL;
+}
+
 void SkPDFCatalog::emitObjectNumber(SkWStream* stream, SkPDFObject* obj) {
-    stream->writeDecAsText(assignObjNum(obj));
+    stream->writeDecAsText(assignObjNum(getSubstituteObject(obj)));
     stream->writeText(" 0");  // Generation number is always 0.
 }
 
@@ -126,3 +141,26 @@ int32_t SkPDFCatalog::emitXrefTable(SkWStream* stream, bool firstPage) {
 
     return fCatalog.count() + 1;
 }
+
+void SkPDFCatalog::setSubstitute(SkPDFObject* original,
+                                 SkPDFObject* substitute) {
+    SkASSERT(findObjectIndex(original) == -1);
+    SkASSERT(getSubstituteObject(original) == original);
+    SubstituteMapping* mapping = fSubstituteMap.append();
+    mapping->fOriginal = original;
+    mapping->fSubstitute = substitute;
+    substitute->ref();
+    original->getResources(&fReplacedResources);
+}
+
+SkPDFObject* SkPDFCatalog::getSubstituteObject(SkPDFObject* object) {
+    for (int i = 0; i < fSubstituteMap.count(); i++) {
+        if (fSubstituteMap[i].fOriginal == object)
+            return fSubstituteMap[i].fSubstitute;
+    }
+    return object;
+}
+
+bool SkPDFCatalog::isReplaced(SkPDFObject* object) const {
+    return fReplacedResources.find(object) >= 0;
+}
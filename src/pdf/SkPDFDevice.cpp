@@ -284,23 +284,64 @@ static void emit_clip(SkPath* clipPath, SkRect* clipRect,
     }
 }
 
-// TODO(vandebo) Take advantage of SkClipStack::getSaveCount(), the PDF
-// graphic state stack, and the fact that we can know all the clips used
-// on the page to optimize this.
+// Returns true if the clips of prefix are the first clips of stack. Unlike
+// operator==, this ignores the save counts the clips were made at.
+static bool is_clip_stack_prefix(const SkClipStack& prefix,
+                                 const SkClipStack& stack) {
+    SkClipStack::B2FIter prefixIter(prefix);
+    SkClipStack::B2FIter iter(stack);
+
+    const SkClipStack::B2FIter::Clip* prefixEntry;
+    while ((prefixEntry = prefixIter.next()) != NULL) {
+        const SkClipStack::B2FIter::Clip* iterEntry = iter.next();
+        if (NULL == iterEntry || *iterEntry != *prefixEntry) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Appends a copy of clip to stack, in a save level of its own so that it
+// compares the same as the original with is_clip_stack_prefix().
+static void append_clip(const SkClipStack::B2FIter::Clip& clip,
+                        SkClipStack* stack) {
+    stack->save();
+    if (clip.fRect) {
+        stack->clipDevRect(*clip.fRect, clip.fOp);
+    } else if (clip.fPath) {
+        stack->clipDevPath(*clip.fPath, clip.fOp, clip.fDoAA);
+    }
+}
+
+static void emit_translated_clip(const SkClipStack::B2FIter::Clip& clip,
+                                 const SkMatrix& transform,
+                                 SkWStream* contentStream) {
+    SkASSERT(clip.fOp == SkRegion::kIntersect_Op);
+    if (clip.fRect) {
+        SkRect translatedClip;
+        transform.mapRect(&translatedClip, *clip.fRect);
+        emit_clip(NULL, &translatedClip, contentStream);
+    } else if (clip.fPath) {
+        SkPath translatedPath;
+        clip.fPath->transform(transform, &translatedPath);
+        emit_clip(&translatedPath, NULL, contentStream);
+    } else {
+        SkASSERT(false);
+    }
+}
+
 void GraphicStackState::updateClip(const SkClipStack& clipStack,
                                    const SkRegion& clipRegion,
                                    const SkIPoint& translation) {
-    if (clipStack == currentEntry()->fClipStack) {
-        return;
-    }
-
-    while (fStackDepth > 0) {
-        pop();
-        if (clipStack == currentEntry()->fClipStack) {
+    // Reuse the clip if it is already in effect at some level of the stack.
+    for (int i = fStackDepth; i >= 0; i--) {
+        if (clipStack == fEntries[i].fClipStack) {
+            while (fStackDepth > i) {
+                pop();
+            }
             return;
         }
     }
-    push();
 
     // gsState->initialEntry()->fClipStack/Region specifies the clip that has
     // already been applied.  (If this is a top level device, then it specifies
@@ -326,27 +367,67 @@ void GraphicStackState::updateClip(const SkClipStack& clipStack,
     }
 
     if (needRegion) {
+        while (fStackDepth > 0) {
+            pop();
+        }
+        push();
         SkPath clipPath;
         SkAssertResult(clipRegion.getBoundaryPath(&clipPath));
         emit_clip(&clipPath, NULL, fContentStream);
-    } else {
-        skip_clip_stack_prefix(fEntries[0].fClipStack, clipStack, &iter);
-        SkMatrix transform;
-        transform.setTranslate(translation.fX, translation.fY);
-        const SkClipStack::B2FIter::Clip* clipEntry;
-        for (clipEntry = iter.next(); clipEntry; clipEntry = iter.next()) {
-            SkASSERT(clipEntry->fOp == SkRegion::kIntersect_Op);
-            if (clipEntry->fRect) {
-                SkRect translatedClip;
-                transform.mapRect(&translatedClip, *clipEntry->fRect);
-                emit_clip(NULL, &translatedClip, fContentStream);
-            } else if (clipEntry->fPath) {
-                SkPath translatedPath;
-                clipEntry->fPath->transform(transform, &translatedPath);
-                emit_clip(&translatedPath, NULL, fContentStream);
-            } else {
-                SkASSERT(false);
-            }
+        currentEntry()->fClipStack = clipStack;
+        currentEntry()->fClipRegion = clipRegion;
+        return;
+    }
+
+    // Intersecting clips can be applied on top of any level (that isn't
+    // under a matrix) whose clips start clipStack, so keep the deepest one
+    // and only emit the rest; e.g. after a save() or for sibling clips.
+    // There has to be room above it for another clip and the matrix.
+    int base = 0;
+    for (int i = SkMin32(fStackDepth, kMaxStackDepth - 2); i > 0; i--) {
+        if (fEntries[i].fMatrix.isIdentity() &&
+                is_clip_stack_prefix(fEntries[i].fClipStack, clipStack)) {
+            base = i;
+            break;
+        }
+    }
+    while (fStackDepth > base) {
+        pop();
+    }
+
+    // Replay the clips that are already in effect, to label the new levels.
+    SkClipStack applied;
+    SkClipStack::B2FIter appliedIter(clipStack);
+    skip_clip_stack_prefix(fEntries[base].fClipStack, clipStack, &iter);
+    clipEntry = iter.next();
+    const SkClipStack::B2FIter::Clip* appliedEntry;
+    while ((appliedEntry = appliedIter.next()) != NULL &&
+            (NULL == clipEntry || appliedEntry->fRect != clipEntry->fRect ||
+             appliedEntry->fPath != clipEntry->fPath)) {
+        append_clip(*appliedEntry, &applied);
+    }
+
+    if (NULL == clipEntry && base > 0) {
+        // Nothing left to clip; the clips just moved to another save level.
+        currentEntry()->fClipStack = clipStack;
+        currentEntry()->fClipRegion = clipRegion;
+        return;
+    }
+
+    // Each clip gets a level of its own, so that later clip stacks can keep
+    // any that they share with this one. The last level available (leaving
+    // one for the matrix) takes all of the remaining clips.
+    SkMatrix transform;
+    transform.setTranslate(translation.fX, translation.fY);
+    push();
+    while (clipEntry) {
+        emit_translated_clip(*clipEntry, transform, fContentStream);
+        append_clip(*clipEntry, &applied);
+        currentEntry()->fClipStack = applied;
+        currentEntry()->fClipRegion = clipRegion;
+        clipEntry = iter.next();
+        if (clipEntry && fStackDepth < kMaxStackDepth - 1) {
+            push();
         }
     }
     currentEntry()->fClipStack = clipStack;
@@ -563,6 +644,7 @@ void SkPDFDevice::init() {
     fResourceDict = NULL;
     fContentEntries.reset();
     fLastContentEntry = NULL;
+    fFontGlyphUsage.reset(new SkPDFGlyphSetMap());
 }
 
 SkDeviceFactory* SkPDFDevice::onNewDeviceFactory() {
@@ -572,6 +654,7 @@ SkDeviceFactory* SkPDFDevice::onNewDeviceFactory() {
 void SkPDFDevice::cleanUp() {
     fGraphicStateResources.unrefAll();
     fXObjectResources.unrefAll();
+    fImageResources.rewind();
     fFontResources.unrefAll();
     fShaderResources.unrefAll();
 }
@@ -838,6 +921,8 @@ void SkPDFDevice::drawText(const SkDraw& d, const void* text, size_t len,
         size_t availableGlyphs =
             font->glyphsToPDFFontEncoding(glyphIDs + consumedGlyphCount,
                                           numGlyphs - consumedGlyphCount);
+        fFontGlyphUsage->noteGlyphUsage(font, glyphIDs + consumedGlyphCount,
+                                        availableGlyphs);
         SkString encodedString =
             SkPDFString::formatString(glyphIDs + consumedGlyphCount,
                                       availableGlyphs, font->multiByteGlyphs());
@@ -906,6 +991,7 @@ void SkPDFDevice::drawPosText(const SkDraw& d, const void* text, size_t len,
             i--;
             continue;
         }
+        fFontGlyphUsage->noteGlyphUsage(font, &encodedValue, 1);
         SkScalar x = pos[i * scalarsPerPos];
         SkScalar y = scalarsPerPos == 1 ? constY : pos[i * scalarsPerPos + 1];
         align_text(glyphCacheProc, textPaint, glyphIDs + i, 1, &x, &y, NULL);
@@ -961,6 +1047,9 @@ void SkPDFDevice::drawDevice(const SkDraw& d, SkDevice* device, int x, int y,
         return;
     }
 
+    // Merge glyph sets from the drawn device.
+    fFontGlyphUsage->merge(pdfDevice->getFontGlyphUsage());
+
     SkPDFFormXObject* xobject = new SkPDFFormXObject(pdfDevice);
     fXObjectResources.push(xobject);  // Transfer reference.
     SkPDFUtils::DrawFormXObject(fXObjectResources.count() - 1,
@@ -1063,6 +1152,30 @@ void SkPDFDevice::getResources(SkTDArray<SkPDFObject*>* resourceList) const {
     }
 }
 
+void SkPDFDevice::getSharedResources(
+        SkTDArray<SkPDFObject*>* resourceList) const {
+    for (int i = 0; i < fGraphicStateResources.count(); i++) {
+        resourceList->push(fGraphicStateResources[i]);
+        fGraphicStateResources[i]->ref();
+        fGraphicStateResources[i]->getResources(resourceList);
+    }
+    for (int i = 0; i < fFontResources.count(); i++) {
+        resourceList->push(fFontResources[i]);
+        fFontResources[i]->ref();
+        fFontResources[i]->getResources(resourceList);
+    }
+    for (int i = 0; i < fShaderResources.count(); i++) {
+        resourceList->push(fShaderResources[i]);
+        fShaderResources[i]->ref();
+        fShaderResources[i]->getResources(resourceList);
+    }
+    for (int i = 0; i < fImageResources.count(); i++) {
+        resourceList->push(fImageResources[i]);
+        fImageResources[i]->ref();
+        fImageResources[i]->getResources(resourceList);
+    }
+}
+
 const SkTDArray<SkPDFFont*>& SkPDFDevice::getFontResources() const {
     return fFontResources;
 }
@@ -1112,14 +1225,13 @@ SkData* SkPDFDevice::copyContentToData() const {
         gsState.updateMatrix(entry->fState.fMatrix);
         gsState.updateDrawingState(entry->fState);
         
-        SkAutoDataUnref copy(entry->fContent.copyToData());
-        data.write(copy.data(), copy.size());
+        entry->fContent.writeToStream(&data);
     }
     gsState.drainStack();
 
     // potentially we could cache this SkData, and only rebuild it if we
     // see that our state has changed.
-    return data.copyToData();
+    return data.detachAsData();
 }
 
 void SkPDFDevice::createFormXObjectFromDevice(
@@ -1502,7 +1614,15 @@ void SkPDFDevice::internalDrawBitmap(const SkMatrix& matrix,
         return;
     }
 
-    fXObjectResources.push(image);  // Transfer reference.
-    SkPDFUtils::DrawFormXObject(fXObjectResources.count() - 1,
-                                &content.entry()->fContent);
+    // Images are canonicalized, so a bitmap drawn again is already one of
+    // our resources.
+    int index = fXObjectResources.find(image);
+    if (index >= 0) {
+        image->unref();
+    } else {
+        index = fXObjectResources.count();
+        fXObjectResources.push(image);  // Transfer reference.
+        fImageResources.push(image);
+    }
+    SkPDFUtils::DrawFormXObject(index, &content.entry()->fContent);
 }
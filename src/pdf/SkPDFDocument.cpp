@@ -16,17 +16,29 @@
 
 #include "SkPDFDevice.h"
 #include "SkPDFDocument.h"
+#include "SkPDFFont.h"
 #include "SkPDFPage.h"
 #include "SkStream.h"
+#include "SkThreadPool.h"
 
-// Add the resources, starting at firstIndex to the catalog, removing any dupes.
+// Add the resources, starting at firstIndex to the catalog, removing any dupes
+// and the resources of substituted objects, and putting substitutes (and
+// their resources) in place of the objects they replace.
 // A hash table would be really nice here.
 void addResourcesToCatalog(int firstIndex, bool firstPage,
                           SkTDArray<SkPDFObject*>* resourceList,
                           SkPDFCatalog* catalog) {
     for (int i = firstIndex; i < resourceList->count(); i++) {
+        SkPDFObject* substitute =
+            catalog->getSubstituteObject((*resourceList)[i]);
+        if (substitute != (*resourceList)[i]) {
+            substitute->ref();
+            (*resourceList)[i]->unref();
+            (*resourceList)[i] = substitute;
+            substitute->getResources(resourceList);
+        }
         int index = resourceList->find((*resourceList)[i]);
-        if (index != i) {
+        if (index != i || catalog->isReplaced((*resourceList)[i])) {
             (*resourceList)[i]->unref();
             resourceList->removeShuffle(i);
             i--;
@@ -38,12 +50,35 @@ void addResourcesToCatalog(int firstIndex, bool firstPage,
 
 SkPDFDocument::SkPDFDocument()
         : fXRefFileOffset(0),
+          fStream(NULL),
+          fFileOffset(0),
           fSecondPageFirstResourceIndex(0) {
     fDocCatalog = new SkPDFDict("Catalog");
     fDocCatalog->unref();  // SkRefPtr and new both took a reference.
     fCatalog.addObject(fDocCatalog.get(), true);
 }
 
+SkPDFDocument::SkPDFDocument(SkWStream* stream)
+        : fXRefFileOffset(0),
+          fStream(stream),
+          fFileOffset(0),
+          fSecondPageFirstResourceIndex(0) {
+    // Objects are numbered in the order they are emitted, so nothing is
+    // treated as being on the first page.
+    fDocCatalog = new SkPDFDict("Catalog");
+    fDocCatalog->unref();  // SkRefPtr and new both took a reference.
+    fCatalog.addObject(fDocCatalog.get(), false);
+
+    // Pages are emitted before the page count is known, so they all hang
+    // off a single root node.
+    fPageTreeRoot = new SkPDFDict("Pages");
+    fPageTreeRoot->unref();  // SkRefPtr and new both took a reference.
+    fCatalog.addObject(fPageTreeRoot.get(), false);
+
+    emitHeader(fStream);
+    fFileOffset = headerSize();
+}
+
 SkPDFDocument::~SkPDFDocument() {
     fPages.safeUnrefAll();
 
@@ -59,6 +94,14 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
     if (fPages.isEmpty())
         return false;
 
+    if (fStream) {
+        // The rest of the file is already written to fStream.
+        if (stream != fStream || fPageTree.count() != 0)
+            return false;
+        finishStream();
+        return true;
+    }
+
     // We haven't emitted the document before if fPageTree is empty.
     if (fPageTree.count() == 0) {
         SkPDFDict* pageTreeRoot;
@@ -78,6 +121,19 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
         fDocCatalog->insert("OutputIntent", intentArray.get());
         */
 
+        // Fonts only need the glyphs that are drawn with them.
+        SkPDFGlyphSetMap usage;
+        for (int i = 0; i < fPages.count(); i++)
+            usage.merge(fPages[i]->getFontGlyphUsage());
+        for (int i = 0; i < usage.count(); i++) {
+            SkPDFFont* subset =
+                usage[i].fFont->getFontSubset(usage[i].fGlyphSet);
+            if (subset) {
+                fCatalog.setSubstitute(usage[i].fFont, subset);
+                subset->unref();  // The catalog took a reference.
+            }
+        }
+
         bool first_page = true;
         for (int i = 0; i < fPages.count(); i++) {
             int resourceCount = fPageResources.count();
@@ -146,14 +202,82 @@ bool SkPDFDocument::appendPage(const SkRefPtr<SkPDFDevice>& pdfDevice) {
     if (fPageTree.count() != 0)
         return false;
 
-    SkPDFPage* page = new SkPDFPage(pdfDevice);
-    fPages.push(page);  // Reference from new passed to fPages.
+    addPage(new SkPDFPage(pdfDevice), pdfDevice);
+    return true;
+}
+
+namespace {
+
+// Draws one page of appendPages() and builds its content stream.
+class PageTask : public SkRunnable {
+public:
+    PageTask(SkPDFPageSource* source, int pageIndex)
+        : fSource(source),
+          fPageIndex(pageIndex) {
+    }
+
+    virtual void run() {
+        fDevice = fSource->createPage(fPageIndex);
+        if (fDevice.get() == NULL)
+            return;
+        fDevice->unref();  // SkRefPtr and createPage both took a reference.
+        fPage = new SkPDFPage(fDevice);
+        fPage->unref();  // SkRefPtr and new both took a reference.
+        fPage->finalizeContent();
+    }
+
+    SkRefPtr<SkPDFDevice> fDevice;
+    SkRefPtr<SkPDFPage> fPage;
+
+private:
+    SkPDFPageSource* fSource;
+    int fPageIndex;
+};
+
+}  // namespace
+
+bool SkPDFDocument::appendPages(SkPDFPageSource* source, int count,
+                                SkThreadPool* pool) {
+    if (fPageTree.count() != 0)
+        return false;
+
+    SkTDArray<PageTask*> tasks;
+    tasks.setReserve(count);
+    for (int i = 0; i < count; i++) {
+        *tasks.append() = new PageTask(source, i);
+        if (pool)
+            pool->add(tasks[i]);
+        else
+            tasks[i]->run();
+    }
+    if (pool)
+        pool->wait();
+
+    bool success = true;
+    for (int i = 0; i < count; i++) {
+        if (success && tasks[i]->fPage.get()) {
+            tasks[i]->fPage->ref();
+            addPage(tasks[i]->fPage.get(), tasks[i]->fDevice);
+        } else {
+            success = false;
+        }
+    }
+    tasks.deleteAll();
+    return success;
+}
+
+void SkPDFDocument::addPage(SkPDFPage* page,
+                            const SkRefPtr<SkPDFDevice>& pdfDevice) {
+    fPages.push(page);  // Reference passed to fPages.
+    if (fStream) {
+        streamPage(page, pdfDevice);
+        return;
+    }
     // The rest of the pages will be added to the catalog along with the rest
     // of the page tree.  But the first page has to be marked as such, so we
     // handle it here.
     if (fPages.count() == 1)
         fCatalog.addObject(page, true);
-    return true;
 }
 
 const SkTDArray<SkPDFPage*>& SkPDFDocument::getPages() {
@@ -192,3 +316,71 @@ void SkPDFDocument::emitFooter(SkWStream* stream, int64_t objCount) {
     stream->writeBigDecAsText(fXRefFileOffset);
     stream->writeText("\n%%EOF");
 }
+
+void SkPDFDocument::streamPage(SkPDFPage* page,
+                               const SkRefPtr<SkPDFDevice>& pdfDevice) {
+    fCatalog.addObject(page, false);
+    page->insert("Parent", new SkPDFObjRef(fPageTreeRoot.get()))->unref();
+
+    // Shared resources are kept (and emitted) once for the whole document.
+    int sharedCount = fPageResources.count();
+    pdfDevice->getSharedResources(&fPageResources);
+    addResourcesToCatalog(sharedCount, false, &fPageResources, &fCatalog);
+
+    SkTDArray<SkPDFObject*> resources;
+    page->finalizePage(&fCatalog, false, &resources);
+    SkTDArray<SkPDFObject*> pageResources;
+    for (int i = 0; i < resources.count(); i++) {
+        if (fPageResources.find(resources[i]) < 0 &&
+                pageResources.find(resources[i]) < 0) {
+            fCatalog.addObject(resources[i], false);
+            pageResources.push(resources[i]);  // Transfer reference.
+        } else {
+            resources[i]->unref();
+        }
+    }
+
+    fFileOffset += fCatalog.setFileOffset(page, fFileOffset);
+    page->emitObject(fStream, &fCatalog, true);
+    fFileOffset += page->getPageSize(&fCatalog, fFileOffset);
+    page->emitPage(fStream, &fCatalog);
+    for (int i = 0; i < pageResources.count(); i++) {
+        fFileOffset += fCatalog.setFileOffset(pageResources[i], fFileOffset);
+        pageResources[i]->emitObject(fStream, &fCatalog, true);
+    }
+
+    // Nothing emitted later refers to the page's own objects, so only the
+    // page object (for the page tree) outlives this.
+    for (int i = 0; i < pageResources.count(); i++)
+        fCatalog.forgetObject(pageResources[i]);
+    pageResources.unrefAll();
+    page->releaseContent(&fCatalog);
+}
+
+void SkPDFDocument::finishStream() {
+    SkRefPtr<SkPDFArray> kids = new SkPDFArray;
+    kids->unref();  // SkRefPtr and new both took a reference.
+    kids->reserve(fPages.count());
+    for (int i = 0; i < fPages.count(); i++)
+        kids->append(new SkPDFObjRef(fPages[i]))->unref();
+    fPageTreeRoot->insert("Kids", kids.get());
+    fPageTreeRoot->insert("Count", new SkPDFInt(fPages.count()))->unref();
+    fDocCatalog->insert("Pages",
+                        new SkPDFObjRef(fPageTreeRoot.get()))->unref();
+    // Marks the document as emitted; the destructor clears the tree.
+    fPageTree.push(fPageTreeRoot.get());
+    fPageTreeRoot->ref();
+
+    fFileOffset += fCatalog.setFileOffset(fPageTreeRoot.get(), fFileOffset);
+    fPageTreeRoot->emitObject(fStream, &fCatalog, true);
+    fFileOffset += fCatalog.setFileOffset(fDocCatalog.get(), fFileOffset);
+    fDocCatalog->emitObject(fStream, &fCatalog, true);
+    for (int i = 0; i < fPageResources.count(); i++) {
+        fFileOffset += fCatalog.setFileOffset(fPageResources[i], fFileOffset);
+        fPageResources[i]->emitObject(fStream, &fCatalog, true);
+    }
+
+    fXRefFileOffset = fFileOffset;
+    int64_t objCount = fCatalog.emitXrefTable(fStream, false);
+    emitFooter(fStream, objCount);
+}
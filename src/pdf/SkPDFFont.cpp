@@ -170,7 +170,7 @@ SkStream* handleType1Stream(SkStream* srcStream, size_t* headerLen,
             dynamicStream.write(buf, amount);
         amount = 0;
         dynamicStream.write(&amount, 1);  // NULL terminator.
-        data = dynamicStream.copyToData();
+        data = dynamicStream.detachAsData();
         src = data->bytes();
         srcLen = data->size() - 1;
     }
@@ -287,13 +287,15 @@ SkPDFArray* appendVerticalAdvance(
     return array;
 }
 
+// If subset isn't NULL, only the advances of its glyphs are included.
 template <typename Data>
 SkPDFArray* composeAdvanceData(
         SkAdvancedTypefaceMetrics::AdvanceMetric<Data>* advanceInfo,
         uint16_t emSize,
         SkPDFArray* (*appendAdvance)(const Data& advance, uint16_t emSize,
                                      SkPDFArray* array),
-        Data* defaultAdvance) {
+        Data* defaultAdvance,
+        const SkPDFGlyphSet* subset) {
     SkPDFArray* result = new SkPDFArray();
     for (; advanceInfo != NULL; advanceInfo = advanceInfo->fNext.get()) {
         switch (advanceInfo->fType) {
@@ -303,20 +305,44 @@ SkPDFArray* composeAdvanceData(
                 break;
             }
             case SkAdvancedTypefaceMetrics::WidthRange::kRange: {
-                SkRefPtr<SkPDFArray> advanceArray = new SkPDFArray();
-                advanceArray->unref();  // SkRefPtr and new both took a ref.
-                for (int j = 0; j < advanceInfo->fAdvance.count(); j++)
+                // Each run of included glyphs gets its own array.
+                SkRefPtr<SkPDFArray> advanceArray;
+                for (int j = 0; j < advanceInfo->fAdvance.count(); j++) {
+                    uint16_t glyphID = advanceInfo->fStartId + j;
+                    if (subset && !subset->has(glyphID)) {
+                        advanceArray = NULL;
+                        continue;
+                    }
+                    if (advanceArray.get() == NULL) {
+                        advanceArray = new SkPDFArray();
+                        advanceArray->unref();  // SkRefPtr and new took a ref.
+                        result->append(new SkPDFInt(glyphID))->unref();
+                        result->append(advanceArray.get());
+                    }
                     appendAdvance(advanceInfo->fAdvance[j], emSize,
                                   advanceArray.get());
-                result->append(new SkPDFInt(advanceInfo->fStartId))->unref();
-                result->append(advanceArray.get());
+                }
                 break;
             }
             case SkAdvancedTypefaceMetrics::WidthRange::kRun: {
                 SkASSERT(advanceInfo->fAdvance.count() == 1);
-                result->append(new SkPDFInt(advanceInfo->fStartId))->unref();
-                result->append(new SkPDFInt(advanceInfo->fEndId))->unref();
-                appendAdvance(advanceInfo->fAdvance[0], emSize, result);
+                // Each run of included glyphs is a run of its own.
+                int startId = advanceInfo->fStartId;
+                while (startId <= advanceInfo->fEndId) {
+                    if (subset && !subset->has(startId)) {
+                        startId++;
+                        continue;
+                    }
+                    int endId = startId;
+                    while (endId < advanceInfo->fEndId &&
+                           (subset == NULL || subset->has(endId + 1))) {
+                        endId++;
+                    }
+                    result->append(new SkPDFInt(startId))->unref();
+                    result->append(new SkPDFInt(endId))->unref();
+                    appendAdvance(advanceInfo->fAdvance[0], emSize, result);
+                    startId = endId + 1;
+                }
                 break;
             }
         }
@@ -387,8 +413,10 @@ static void append_cmap_footer(SkDynamicMemoryWStream* cmap) {
 }
 
 // Generate <bfchar> table according to PDF spec 1.4 and Adobe Technote 5014.
+// If subset isn't NULL, only its glyphs are mapped.
 static void append_cmap_bfchar_sections(
                 const SkTDArray<SkUnichar>& glyphUnicode,
+                const SkPDFGlyphSet* subset,
                 SkDynamicMemoryWStream* cmap) {
     // PDF spec defines that every bf* list can have at most 100 entries.
     const size_t kMaxEntries = 100;
@@ -396,7 +424,7 @@ static void append_cmap_bfchar_sections(
     SkUnichar unicode[kMaxEntries];
     size_t index = 0;
     for (int i = 0; i < glyphUnicode.count(); i++) {
-        if (glyphUnicode[i]) {
+        if (glyphUnicode[i] && (subset == NULL || subset->has(i))) {
             glyphId[index] = i;
             unicode[index] = glyphUnicode[i];
             ++index;
@@ -412,29 +440,319 @@ static void append_cmap_bfchar_sections(
     }
 }
 
-/* Font subset design: It would be nice to be able to subset fonts
- * (particularly type 3 fonts), but it's a lot of work and not a priority.
- *
- * Resources are canonicalized and uniqueified by pointer so there has to be
- * some additional state indicating which subset of the font is used.  It
- * must be maintained at the page granularity and then combined at the document
- * granularity. a) change SkPDFFont to fill in its state on demand, kind of
- * like SkPDFGraphicState.  b) maintain a per font glyph usage class in each
- * page/pdf device. c) in the document, retrieve the per font glyph usage
- * from each page and combine it and ask for a resource with that subset.
+/* Font subsets: Resources are canonicalized and uniqueified by pointer, so a
+ * font is shared by every page and document that uses it.  Each PDF device
+ * keeps track of the glyphs it uses with each font (SkPDFGlyphSetMap), a
+ * document merges the usage of its pages and, when it's emitted, asks each
+ * font for a subset with just those glyphs (getFontSubset), which the catalog
+ * then emits in place of the font.
  */
 
+namespace {
+
+uint16_t readU16(const uint8_t* data) {
+    return (data[0] << 8) | data[1];
+}
+
+uint32_t readU32(const uint8_t* data) {
+    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+void writeU16(uint8_t* data, uint16_t value) {
+    data[0] = value >> 8;
+    data[1] = value & 0xFF;
+}
+
+void writeU32(uint8_t* data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = (value >> 16) & 0xFF;
+    data[2] = (value >> 8) & 0xFF;
+    data[3] = value & 0xFF;
+}
+
+size_t alignTo4(size_t size) {
+    return (size + 3) & ~3;
+}
+
+// The checksum of a table (or a whole font) in a TrueType font.
+uint32_t sfntChecksum(const uint8_t* data, size_t length) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < length; i += 4) {
+        uint32_t word = 0;
+        for (size_t j = i; j < i + 4; j++)
+            word = (word << 8) | (j < length ? data[j] : 0);
+        sum += word;
+    }
+    return sum;
+}
+
+struct SfntTable {
+    uint32_t fTag;
+    size_t fOffset;
+    size_t fLength;
+};
+
+int findSfntTable(const SkTDArray<SfntTable>& tables, uint32_t tag) {
+    for (int i = 0; i < tables.count(); i++) {
+        if (tables[i].fTag == tag)
+            return i;
+    }
+    return -1;
+}
+
+#define SFNT_TAG(a, b, c, d) (((a) << 24) | ((b) << 16) | ((c) << 8) | (d))
+
+// Return a copy of the TrueType font data in which the glyphs that aren't in
+// subset (or parts of composite glyphs that are) have no outlines, and that
+// leaves out the tables PDF viewers don't need.  Glyph IDs don't change, so
+// the font still goes with an Identity CIDToGIDMap.  Returns NULL if the data
+// isn't a TrueType font that can be subset.
+SkData* subsetTrueTypeFont(const uint8_t* src, size_t size,
+                           const SkPDFGlyphSet* subset) {
+    if (size < 12)
+        return NULL;
+    uint32_t version = readU32(src);
+    if (version != 0x00010000 && version != SFNT_TAG('t', 'r', 'u', 'e'))
+        return NULL;
+    const int numTables = readU16(src + 4);
+    if (12 + 16 * (size_t)numTables > size)
+        return NULL;
+
+    SkTDArray<SfntTable> tables;
+    for (int i = 0; i < numTables; i++) {
+        const uint8_t* record = src + 12 + 16 * i;
+        SfntTable* table = tables.append();
+        table->fTag = readU32(record);
+        table->fOffset = readU32(record + 8);
+        table->fLength = readU32(record + 12);
+        if (table->fOffset > size || table->fLength > size - table->fOffset)
+            return NULL;
+    }
+    int head = findSfntTable(tables, SFNT_TAG('h', 'e', 'a', 'd'));
+    int maxp = findSfntTable(tables, SFNT_TAG('m', 'a', 'x', 'p'));
+    int loca = findSfntTable(tables, SFNT_TAG('l', 'o', 'c', 'a'));
+    int glyf = findSfntTable(tables, SFNT_TAG('g', 'l', 'y', 'f'));
+    if (head < 0 || maxp < 0 || loca < 0 || glyf < 0 ||
+            tables[head].fLength < 54 || tables[maxp].fLength < 6) {
+        return NULL;
+    }
+
+    // Read the glyph offsets.
+    const uint8_t* headData = src + tables[head].fOffset;
+    const int numGlyphs = readU16(src + tables[maxp].fOffset + 4);
+    const bool longOffsets = readU16(headData + 50) != 0;
+    const size_t glyfLength = tables[glyf].fLength;
+    if ((size_t)(numGlyphs + 1) * (longOffsets ? 4 : 2) > tables[loca].fLength)
+        return NULL;
+    SkTDArray<uint32_t> offsets;
+    offsets.setCount(numGlyphs + 1);
+    const uint8_t* locaData = src + tables[loca].fOffset;
+    for (int i = 0; i <= numGlyphs; i++) {
+        offsets[i] = longOffsets ? readU32(locaData + 4 * i)
+                                 : readU16(locaData + 2 * i) * 2;
+        if (offsets[i] > glyfLength || (i > 0 && offsets[i] < offsets[i - 1]))
+            return NULL;
+    }
+
+    // Keep the used glyphs, .notdef and the parts of the composite glyphs
+    // that are kept.
+    const uint8_t* glyfData = src + tables[glyf].fOffset;
+    SkTDArray<uint8_t> keep;
+    keep.setCount(numGlyphs);
+    memset(keep.begin(), 0, numGlyphs);
+    SkTDArray<uint16_t> pending;
+    for (int i = 0; i < numGlyphs; i++) {
+        if (i == 0 || subset->has(i))
+            *pending.append() = i;
+    }
+    while (!pending.isEmpty()) {
+        uint16_t glyphID = pending.top();
+        pending.pop();
+        if (keep[glyphID])
+            continue;
+        keep[glyphID] = 1;
+
+        const uint8_t* glyph = glyfData + offsets[glyphID];
+        const size_t length = offsets[glyphID + 1] - offsets[glyphID];
+        if (length < 10 || (int16_t)readU16(glyph) >= 0)
+            continue;  // Empty or simple glyph.
+        static const uint16_t kArgsAreWords = 0x0001;
+        static const uint16_t kHaveScale = 0x0008;
+        static const uint16_t kMoreComponents = 0x0020;
+        static const uint16_t kHaveXYScale = 0x0040;
+        static const uint16_t kHave2x2 = 0x0080;
+        size_t pos = 10;
+        uint16_t flags;
+        do {
+            if (pos + 4 > length)
+                return NULL;
+            flags = readU16(glyph + pos);
+            uint16_t component = readU16(glyph + pos + 2);
+            if (component >= numGlyphs)
+                return NULL;
+            if (!keep[component])
+                *pending.append() = component;
+            pos += 4 + ((flags & kArgsAreWords) ? 4 : 2);
+            if (flags & kHaveScale)
+                pos += 2;
+            else if (flags & kHaveXYScale)
+                pos += 4;
+            else if (flags & kHave2x2)
+                pos += 8;
+        } while (flags & kMoreComponents);
+    }
+
+    // Lay out the subset of the glyphs, with long offsets.
+    SkTDArray<uint32_t> newOffsets;
+    newOffsets.setCount(numGlyphs + 1);
+    size_t newGlyfLength = 0;
+    for (int i = 0; i < numGlyphs; i++) {
+        newOffsets[i] = newGlyfLength;
+        if (keep[i])
+            newGlyfLength += alignTo4(offsets[i + 1] - offsets[i]);
+    }
+    newOffsets[numGlyphs] = newGlyfLength;
+    const size_t newLocaLength = 4 * (numGlyphs + 1);
+
+    // Only keep the tables that PDF viewers use.
+    static const uint32_t kKeptTables[] = {
+        SFNT_TAG('O', 'S', '/', '2'),
+        SFNT_TAG('c', 'm', 'a', 'p'),
+        SFNT_TAG('c', 'v', 't', ' '),
+        SFNT_TAG('f', 'p', 'g', 'm'),
+        SFNT_TAG('g', 'l', 'y', 'f'),
+        SFNT_TAG('h', 'e', 'a', 'd'),
+        SFNT_TAG('h', 'h', 'e', 'a'),
+        SFNT_TAG('h', 'm', 't', 'x'),
+        SFNT_TAG('l', 'o', 'c', 'a'),
+        SFNT_TAG('m', 'a', 'x', 'p'),
+        SFNT_TAG('n', 'a', 'm', 'e'),
+        SFNT_TAG('p', 'r', 'e', 'p'),
+    };
+    SkTDArray<int> kept;
+    for (int i = 0; i < numTables; i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(kKeptTables); j++) {
+            if (tables[i].fTag == kKeptTables[j]) {
+                *kept.append() = i;
+                break;
+            }
+        }
+    }
+
+    size_t totalSize = 12 + 16 * kept.count();
+    for (int k = 0; k < kept.count(); k++) {
+        int i = kept[k];
+        if (i == glyf)
+            totalSize += newGlyfLength;
+        else if (i == loca)
+            totalSize += newLocaLength;
+        else
+            totalSize += alignTo4(tables[i].fLength);
+    }
+    uint8_t* dst = (uint8_t*)sk_malloc_throw(totalSize);
+    memset(dst, 0, totalSize);
+    writeU32(dst, version);
+    writeU16(dst + 4, kept.count());
+    int entrySelector = 0;
+    while ((2 << entrySelector) <= kept.count())
+        entrySelector++;
+    writeU16(dst + 6, 16 << entrySelector);  // searchRange
+    writeU16(dst + 8, entrySelector);
+    writeU16(dst + 10, 16 * kept.count() - (16 << entrySelector));
+
+    size_t offset = 12 + 16 * kept.count();
+    size_t headOffset = 0;
+    for (int k = 0; k < kept.count(); k++) {
+        int i = kept[k];
+        uint8_t* table = dst + offset;
+        size_t length = tables[i].fLength;
+        if (i == glyf) {
+            for (int gid = 0; gid < numGlyphs; gid++) {
+                if (keep[gid]) {
+                    memcpy(table + newOffsets[gid], glyfData + offsets[gid],
+                           offsets[gid + 1] - offsets[gid]);
+                }
+            }
+            length = newGlyfLength;
+        } else if (i == loca) {
+            for (int gid = 0; gid <= numGlyphs; gid++)
+                writeU32(table + 4 * gid, newOffsets[gid]);
+            length = newLocaLength;
+        } else {
+            memcpy(table, src + tables[i].fOffset, length);
+            if (i == head) {
+                headOffset = offset;
+                writeU32(table + 8, 0);  // checkSumAdjustment
+                writeU16(table + 50, 1);  // indexToLocFormat: long offsets
+            }
+        }
+        uint8_t* record = dst + 12 + 16 * k;
+        writeU32(record, tables[i].fTag);
+        writeU32(record + 4, sfntChecksum(table, length));
+        writeU32(record + 8, offset);
+        writeU32(record + 12, length);
+        offset += alignTo4(length);
+    }
+    SkASSERT(offset == totalSize);
+    writeU32(dst + headOffset + 8, 0xB1B0AFBA - sfntChecksum(dst, totalSize));
+
+    return SkData::NewFromMalloc(dst, totalSize);
+}
+
+// Return a stream with the subset of the TrueType font in fontData, or NULL
+// if it can't be subset.
+SkMemoryStream* subsetFontStream(SkStream* fontData,
+                                 const SkPDFGlyphSet* subset) {
+    size_t size = fontData->getLength();
+    SkAutoMalloc buffer;
+    const uint8_t* src = (const uint8_t*)fontData->getMemoryBase();
+    if (src == NULL) {
+        fontData->rewind();
+        src = (const uint8_t*)buffer.alloc(size);
+        if (fontData->read(buffer.get(), size) != size)
+            return NULL;
+    }
+    SkRefPtr<SkData> subsetData = subsetTrueTypeFont(src, size, subset);
+    if (subsetData.get() == NULL)
+        return NULL;
+    subsetData->unref();  // SkRefPtr and subset both took a reference.
+    SkMemoryStream* result = new SkMemoryStream();
+    result->setData(subsetData.get());
+    return result;
+}
+
+// The name of a font subset has to start with a tag of six upper case
+// letters, which should differ between subsets of the font.
+SkString baseFontName(const SkString& fontName, const SkPDFGlyphSet* subset) {
+    if (subset == NULL)
+        return fontName;
+    SkString name;
+    uint32_t hash = subset->hash();
+    for (int i = 0; i < 6; i++) {
+        name.appendUnichar('A' + hash % 26);
+        hash /= 26;
+    }
+    name.append("+");
+    name.append(fontName);
+    return name;
+}
+
+}  // namespace
+
 SkPDFFont::~SkPDFFont() {
-    SkAutoMutexAcquire lock(canonicalFontsMutex());
-    int index;
-    if (find(SkTypeface::UniqueID(fTypeface.get()), fFirstGlyphID, &index)) {
-        canonicalFonts().removeShuffle(index);
-#ifdef SK_DEBUG
-        SkASSERT(!fDescendant);
-    } else {
-        SkASSERT(fDescendant);
-#endif
+    {
+        SkAutoMutexAcquire lock(canonicalFontsMutex());
+        // Look for this font rather than an equal one: a font that another
+        // thread added first (see getFontResource) was never in the list.
+        for (int i = 0; i < canonicalFonts().count(); i++) {
+            if (canonicalFonts()[i].fFont == this) {
+                SkASSERT(!fDescendant);
+                canonicalFonts().removeShuffle(i);
+                break;
+            }
+        }
     }
+    // Descendant fonts take the lock when they go away.
     fResources.unrefAll();
 }
 
@@ -485,18 +803,26 @@ size_t SkPDFFont::glyphsToPDFFontEncoding(uint16_t* glyphIDs,
 
 // static
 SkPDFFont* SkPDFFont::getFontResource(SkTypeface* typeface, uint16_t glyphID) {
-    SkAutoMutexAcquire lock(canonicalFontsMutex());
     const uint32_t fontID = SkTypeface::UniqueID(typeface);
-    int index;
-    if (find(fontID, glyphID, &index)) {
-        canonicalFonts()[index].fFont->ref();
-        return canonicalFonts()[index].fFont;
+    SkRefPtr<SkPDFFont> relatedFont;
+    {
+        SkAutoMutexAcquire lock(canonicalFontsMutex());
+        int index;
+        if (find(fontID, glyphID, &index)) {
+            canonicalFonts()[index].fFont->ref();
+            return canonicalFonts()[index].fFont;
+        }
+        if (index >= 0) {
+            relatedFont = canonicalFonts()[index].fFont;
+        }
     }
 
+    // Getting the metrics and embedding the font is slow, so it's done
+    // without the lock, letting pages that are drawn on other threads look up
+    // their fonts meanwhile.
     SkRefPtr<SkAdvancedTypefaceMetrics> fontInfo;
     SkPDFDict* fontDescriptor = NULL;
-    if (index >= 0) {
-        SkPDFFont* relatedFont = canonicalFonts()[index].fFont;
+    if (relatedFont.get()) {
         SkASSERT(relatedFont->fFontInfo.get());
         fontInfo = relatedFont->fFontInfo;
         fontDescriptor = relatedFont->fDescriptor.get();
@@ -512,9 +838,19 @@ SkPDFFont* SkPDFFont::getFontResource(SkTypeface* typeface, uint16_t glyphID) {
     }
 
     SkPDFFont* font = new SkPDFFont(fontInfo.get(), typeface, glyphID, false,
-                                    fontDescriptor);
+                                    fontDescriptor, NULL);
+
+    SkAutoMutexAcquire lock(canonicalFontsMutex());
+    int index;
+    if (find(fontID, glyphID, &index)) {
+        // Another thread added the font while this one was building it.
+        SkPDFFont* existing = canonicalFonts()[index].fFont;
+        existing->ref();
+        lock.release();
+        font->unref();
+        return existing;
+    }
     FontRec newEntry(font, fontID, font->fFirstGlyphID);
-    index = canonicalFonts().count();
     canonicalFonts().push(newEntry);
     return font;  // Return the reference new SkPDFFont() created.
 }
@@ -549,7 +885,8 @@ SkPDFFont::SkPDFFont(class SkAdvancedTypefaceMetrics* fontInfo,
                      SkTypeface* typeface,
                      uint16_t glyphID,
                      bool descendantFont,
-                     SkPDFDict* fontDescriptor)
+                     SkPDFDict* fontDescriptor,
+                     const SkPDFGlyphSet* subset)
         : SkPDFDict("Font"),
           fTypeface(typeface),
           fType(fontInfo ? fontInfo->fType :
@@ -558,6 +895,7 @@ SkPDFFont::SkPDFFont(class SkAdvancedTypefaceMetrics* fontInfo,
           fDescendant(descendantFont),
 #endif
           fMultiByteGlyphs(false),
+          fType3Font(false),
           fFirstGlyphID(1),
           fLastGlyphID(fontInfo ? fontInfo->fLastGlyphID : 0),
           fFontInfo(fontInfo),
@@ -569,13 +907,16 @@ SkPDFFont::SkPDFFont(class SkAdvancedTypefaceMetrics* fontInfo,
     if (fType == SkAdvancedTypefaceMetrics::kType1CID_Font ||
         fType == SkAdvancedTypefaceMetrics::kTrueType_Font) {
         if (descendantFont) {
-            populateCIDFont();
+            populateCIDFont(subset);
         } else {
-            populateType0Font();
+            populateType0Font(subset);
         }
         // No need to hold onto the font info for fonts types that
-        // support multibyte glyphs.
-        fFontInfo = NULL;
+        // support multibyte glyphs, unless they can be subset.
+        if (descendantFont || subset ||
+                fType != SkAdvancedTypefaceMetrics::kTrueType_Font) {
+            fFontInfo = NULL;
+        }
         return;
     }
 
@@ -588,14 +929,28 @@ SkPDFFont::SkPDFFont(class SkAdvancedTypefaceMetrics* fontInfo,
              fType == SkAdvancedTypefaceMetrics::kCFF_Font ||
              fType == SkAdvancedTypefaceMetrics::kOther_Font ||
              fType == SkAdvancedTypefaceMetrics::kNotEmbeddable_Font);
-    populateType3Font(glyphID);
+    populateType3Font(glyphID, subset);
+}
+
+SkPDFFont* SkPDFFont::getFontSubset(const SkPDFGlyphSet* usage) {
+    if (fType3Font) {
+        return new SkPDFFont(fFontInfo.get(), fTypeface.get(), fFirstGlyphID,
+                             false, NULL, usage);
+    }
+    if (fMultiByteGlyphs && fFontInfo.get() &&
+            fType == SkAdvancedTypefaceMetrics::kTrueType_Font) {
+        return new SkPDFFont(fFontInfo.get(), fTypeface.get(), 1, false, NULL,
+                             usage);
+    }
+    return NULL;
 }
 
-void SkPDFFont::populateType0Font() {
+void SkPDFFont::populateType0Font(const SkPDFGlyphSet* subset) {
     fMultiByteGlyphs = true;
 
     insert("Subtype", new SkPDFName("Type0"))->unref();
-    insert("BaseFont", new SkPDFName(fFontInfo->fFontName))->unref();
+    insert("BaseFont", new SkPDFName(
+            baseFontName(fFontInfo->fFontName, subset)))->unref();
     insert("Encoding",  new SkPDFName("Identity-H"))->unref();
 
     SkRefPtr<SkPDFArray> descendantFonts = new SkPDFArray();
@@ -603,14 +958,15 @@ void SkPDFFont::populateType0Font() {
 
     // Pass ref new created to fResources.
     fResources.push(
-        new SkPDFFont(fFontInfo.get(), fTypeface.get(), 1, true, NULL));
+        new SkPDFFont(fFontInfo.get(), fTypeface.get(), 1, true, NULL,
+                      subset));
     descendantFonts->append(new SkPDFObjRef(fResources.top()))->unref();
     insert("DescendantFonts", descendantFonts.get());
 
-    populateToUnicodeTable();
+    populateToUnicodeTable(subset);
 }
 
-void SkPDFFont::populateToUnicodeTable() {
+void SkPDFFont::populateToUnicodeTable(const SkPDFGlyphSet* subset) {
     if (fFontInfo.get() == NULL ||
         fFontInfo->fGlyphToUnicode.begin() == NULL) {
         return;
@@ -618,19 +974,20 @@ void SkPDFFont::populateToUnicodeTable() {
 
     SkDynamicMemoryWStream cmap;
     append_tounicode_header(&cmap);
-    append_cmap_bfchar_sections(fFontInfo->fGlyphToUnicode, &cmap);
+    append_cmap_bfchar_sections(fFontInfo->fGlyphToUnicode, subset, &cmap);
     append_cmap_footer(&cmap);
     SkRefPtr<SkMemoryStream> cmapStream = new SkMemoryStream();
     cmapStream->unref();  // SkRefPtr and new took a reference.
-    cmapStream->setData(cmap.copyToData())->unref();
+    cmapStream->setData(cmap.detachAsData())->unref();
     SkRefPtr<SkPDFStream> pdfCmap = new SkPDFStream(cmapStream.get());
     fResources.push(pdfCmap.get());  // Pass reference from new.
     insert("ToUnicode", new SkPDFObjRef(pdfCmap.get()))->unref();
 }
 
-void SkPDFFont::populateCIDFont() {
+void SkPDFFont::populateCIDFont(const SkPDFGlyphSet* subset) {
     fMultiByteGlyphs = true;
-    insert("BaseFont", new SkPDFName(fFontInfo->fFontName))->unref();
+    insert("BaseFont", new SkPDFName(
+            baseFontName(fFontInfo->fFontName, subset)))->unref();
 
     if (fFontInfo->fType == SkAdvancedTypefaceMetrics::kType1CID_Font) {
         insert("Subtype", new SkPDFName("CIDFontType0"))->unref();
@@ -648,13 +1005,14 @@ void SkPDFFont::populateCIDFont() {
     sysInfo->insert("Supplement", new SkPDFInt(0))->unref();
     insert("CIDSystemInfo", sysInfo.get());
 
-    addFontDescriptor(0);
+    addFontDescriptor(0, subset);
 
     if (fFontInfo->fGlyphWidths.get()) {
         int16_t defaultWidth = 0;
         SkRefPtr<SkPDFArray> widths =
             composeAdvanceData(fFontInfo->fGlyphWidths.get(),
-                               fFontInfo->fEmSize, &appendWidth, &defaultWidth);
+                               fFontInfo->fEmSize, &appendWidth, &defaultWidth,
+                               subset);
         widths->unref();  // SkRefPtr and compose both took a reference.
         if (widths->size())
             insert("W", widths.get());
@@ -671,7 +1029,7 @@ void SkPDFFont::populateCIDFont() {
         SkRefPtr<SkPDFArray> advances =
             composeAdvanceData(fFontInfo->fVerticalMetrics.get(),
                                fFontInfo->fEmSize, &appendVerticalAdvance,
-                               &defaultAdvance);
+                               &defaultAdvance, subset);
         advances->unref();  // SkRefPtr and compose both took a ref.
         if (advances->size())
             insert("W2", advances.get());
@@ -711,7 +1069,7 @@ bool SkPDFFont::populateType1Font(int16_t glyphID) {
         }
     }
 
-    if (!addFontDescriptor(defaultWidth))
+    if (!addFontDescriptor(defaultWidth, NULL))
         return false;
 
     insert("Subtype", new SkPDFName("Type1"))->unref();
@@ -739,7 +1097,9 @@ bool SkPDFFont::populateType1Font(int16_t glyphID) {
     return true;
 }
 
-void SkPDFFont::populateType3Font(int16_t glyphID) {
+void SkPDFFont::populateType3Font(int16_t glyphID,
+                                  const SkPDFGlyphSet* subset) {
+    fType3Font = true;
     SkPaint paint;
     paint.setTypeface(fTypeface.get());
     paint.setTextSize(1000);
@@ -781,6 +1141,11 @@ void SkPDFFont::populateType3Font(int16_t glyphID) {
         characterName.printf("gid%d", gID);
         encDiffs->append(new SkPDFName(characterName))->unref();
 
+        // A subset leaves out the descriptions of the glyphs it doesn't use.
+        if (subset && !subset->has(gID - fFirstGlyphID + 1)) {
+            widthArray->append(new SkPDFInt(0))->unref();
+            continue;
+        }
         const SkGlyph& glyph = cache->getGlyphIDMetrics(gID);
         widthArray->append(new SkPDFScalar(SkFixedToScalar(glyph.fAdvanceX)))->unref();
         SkIRect glyphBBox = SkIRect::MakeXYWH(glyph.fLeft, glyph.fTop,
@@ -798,7 +1163,7 @@ void SkPDFFont::populateType3Font(int16_t glyphID) {
         }
         SkRefPtr<SkMemoryStream> glyphStream = new SkMemoryStream();
         glyphStream->unref();  // SkRefPtr and new both took a ref.
-        glyphStream->setData(content.copyToData())->unref();
+        glyphStream->setData(content.detachAsData())->unref();
 
         SkRefPtr<SkPDFStream> glyphDescription =
             new SkPDFStream(glyphStream.get());
@@ -817,10 +1182,11 @@ void SkPDFFont::populateType3Font(int16_t glyphID) {
     if (fFontInfo && fFontInfo->fLastGlyphID <= 255)
         fFontInfo = NULL;
 
-    populateToUnicodeTable();
+    populateToUnicodeTable(subset);
 }
 
-bool SkPDFFont::addFontDescriptor(int16_t defaultWidth) {
+bool SkPDFFont::addFontDescriptor(int16_t defaultWidth,
+                                  const SkPDFGlyphSet* subset) {
     if (fDescriptor.get() != NULL) {
         fResources.push(fDescriptor.get());
         fDescriptor->ref();
@@ -857,6 +1223,13 @@ bool SkPDFFont::addFontDescriptor(int16_t defaultWidth) {
             SkRefPtr<SkStream> fontData =
                 SkFontHost::OpenStream(SkTypeface::UniqueID(fTypeface.get()));
             fontData->unref();  // SkRefPtr and OpenStream both took a ref.
+            if (subset) {
+                SkRefPtr<SkMemoryStream> subsetData = subsetFontStream(
+                        fontData.get(), subset);
+                SkSafeUnref(subsetData.get());  // SkRefPtr and subset both took a ref.
+                if (subsetData.get())
+                    fontData = subsetData.get();
+            }
             SkRefPtr<SkPDFStream> fontStream = new SkPDFStream(fontData.get());
             // SkRefPtr and new both ref()'d fontStream, pass one.
             fResources.push(fontStream.get());
@@ -896,7 +1269,7 @@ bool SkPDFFont::addFontDescriptor(int16_t defaultWidth) {
     insert("FontDescriptor", new SkPDFObjRef(fDescriptor.get()))->unref();
 
     fDescriptor->insert("FontName", new SkPDFName(
-            fFontInfo->fFontName))->unref();
+            baseFontName(fFontInfo->fFontName, subset)))->unref();
     fDescriptor->insert("Flags", new SkPDFInt(fFontInfo->fStyle))->unref();
     fDescriptor->insert("Ascent", new SkPDFScalar(
             scaleFromFontUnits(fFontInfo->fAscent, emSize)))->unref();
@@ -981,3 +1354,87 @@ SkPDFFont::FontRec::FontRec(SkPDFFont* font, uint32_t fontID, uint16_t glyphID)
       fFontID(fontID),
       fGlyphID(glyphID) {
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkPDFGlyphSet::SkPDFGlyphSet() {
+}
+
+void SkPDFGlyphSet::set(const uint16_t* glyphIDs, int numGlyphs) {
+    for (int i = 0; i < numGlyphs; i++) {
+        int word = glyphIDs[i] >> 5;
+        if (word >= fBitSet.count()) {
+            int oldCount = fBitSet.count();
+            fBitSet.setCount(word + 1);
+            memset(fBitSet.begin() + oldCount, 0,
+                   (word + 1 - oldCount) * sizeof(uint32_t));
+        }
+        fBitSet[word] |= 1U << (glyphIDs[i] & 31);
+    }
+}
+
+bool SkPDFGlyphSet::has(uint16_t glyphID) const {
+    int word = glyphID >> 5;
+    return word < fBitSet.count() &&
+           (fBitSet[word] & (1U << (glyphID & 31))) != 0;
+}
+
+void SkPDFGlyphSet::merge(const SkPDFGlyphSet& usage) {
+    int oldCount = fBitSet.count();
+    if (usage.fBitSet.count() > oldCount) {
+        fBitSet.setCount(usage.fBitSet.count());
+        memset(fBitSet.begin() + oldCount, 0,
+               (fBitSet.count() - oldCount) * sizeof(uint32_t));
+    }
+    for (int i = 0; i < usage.fBitSet.count(); i++)
+        fBitSet[i] |= usage.fBitSet[i];
+}
+
+uint32_t SkPDFGlyphSet::hash() const {
+    // FNV-1a, ignoring trailing empty words.
+    int count = fBitSet.count();
+    while (count > 0 && fBitSet[count - 1] == 0)
+        count--;
+    uint32_t hash = 2166136261U;
+    const uint8_t* bytes = (const uint8_t*)fBitSet.begin();
+    for (size_t i = 0; i < count * sizeof(uint32_t); i++)
+        hash = (hash ^ bytes[i]) * 16777619U;
+    return hash;
+}
+
+SkPDFGlyphSetMap::SkPDFGlyphSetMap() {
+}
+
+SkPDFGlyphSetMap::~SkPDFGlyphSetMap() {
+    reset();
+}
+
+void SkPDFGlyphSetMap::merge(const SkPDFGlyphSetMap& usage) {
+    for (int i = 0; i < usage.fMap.count(); i++) {
+        SkPDFGlyphSet* glyphSet = getGlyphSetForFont(usage.fMap[i].fFont);
+        glyphSet->merge(*usage.fMap[i].fGlyphSet);
+    }
+}
+
+void SkPDFGlyphSetMap::reset() {
+    for (int i = 0; i < fMap.count(); i++)
+        delete fMap[i].fGlyphSet;
+    fMap.reset();
+}
+
+void SkPDFGlyphSetMap::noteGlyphUsage(SkPDFFont* font, const uint16_t* glyphIDs,
+                                      int numGlyphs) {
+    SkPDFGlyphSet* subset = getGlyphSetForFont(font);
+    subset->set(glyphIDs, numGlyphs);
+}
+
+SkPDFGlyphSet* SkPDFGlyphSetMap::getGlyphSetForFont(SkPDFFont* font) {
+    for (int i = 0; i < fMap.count(); i++) {
+        if (fMap[i].fFont == font)
+            return fMap[i].fGlyphSet;
+    }
+    FontGlyphSetPair* pair = fMap.append();
+    pair->fFont = font;
+    pair->fGlyphSet = new SkPDFGlyphSet();
+    return pair->fGlyphSet;
+}
@@ -57,12 +57,14 @@ static const char* blend_mode_from_xfermode(SkXfermode::Mode mode) {
 }
 
 SkPDFGraphicState::~SkPDFGraphicState() {
-    SkAutoMutexAcquire lock(canonicalPaintsMutex());
     if (!fSMask) {
+        SkAutoMutexAcquire lock(canonicalPaintsMutex());
         int index = find(fPaint);
         SkASSERT(index >= 0);
         canonicalPaints().removeShuffle(index);
     }
+    // The soft mask's form may hold graphic states, which take the lock when
+    // they go away.
     fResources.unrefAll();
 }
 
@@ -19,9 +19,11 @@
 #include "SkBitmap.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
+#include "SkData.h"
 #include "SkPaint.h"
 #include "SkPackBits.h"
 #include "SkPDFCatalog.h"
+#include "SkPixelRef.h"
 #include "SkRect.h"
 #include "SkStream.h"
 #include "SkString.h"
@@ -241,6 +243,45 @@ SkPDFArray* makeIndexedColorSpace(SkColorTable* table) {
     return result;
 }
 
+// Get the size and number of color components of a JPEG file from its
+// frame header.  Only baseline and progressive Huffman coded frames are
+// accepted, the ones PDF readers are known to handle.
+bool getJpegInfo(const SkData* data, int* width, int* height,
+                 int* components) {
+    const uint8_t* bytes = data->bytes();
+    const size_t size = data->size();
+    if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8)
+        return false;
+
+    size_t offset = 2;
+    while (offset + 4 <= size) {
+        if (bytes[offset] != 0xFF)
+            return false;
+        uint8_t marker = bytes[offset + 1];
+        if (marker == 0xFF) {  // Fill byte.
+            offset++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            offset += 2;  // Markers without a payload.
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA)  // End of image, start of scan.
+            return false;
+        size_t length = (bytes[offset + 2] << 8) | bytes[offset + 3];
+        if (marker == 0xC0 || marker == 0xC1 || marker == 0xC2) {
+            if (length < 8 || offset + 10 > size)
+                return false;
+            *height = (bytes[offset + 5] << 8) | bytes[offset + 6];
+            *width = (bytes[offset + 7] << 8) | bytes[offset + 8];
+            *components = bytes[offset + 9];
+            return bytes[offset + 4] == 8;  // 8 bits per component.
+        }
+        offset += 2 + length;
+    }
+    return false;
+}
+
 };  // namespace
 
 // static
@@ -249,6 +290,61 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
                                     const SkPaint& paint) {
     if (bitmap.getConfig() == SkBitmap::kNo_Config)
         return NULL;
+    // Only a pixel ref's pixels are known to not change without a new
+    // generation ID.
+    if (bitmap.pixelRef() == NULL)
+        return EncodeImage(bitmap, srcRect, paint);
+
+    ImageCanonicalEntry entry(NULL, bitmap, srcRect);
+    {
+        SkAutoMutexAcquire lock(canonicalImagesMutex());
+        int index = canonicalImages().find(entry);
+        if (index >= 0) {
+            SkPDFImage* image = canonicalImages()[index].fImage;
+            image->ref();
+            return image;
+        }
+    }
+
+    // Encoding is slow, so it's done without the lock, letting pages that
+    // are drawn on other threads get their images meanwhile.
+    SkPDFImage* image = EncodeImage(bitmap, srcRect, paint);
+    if (image == NULL)
+        return NULL;
+
+    SkAutoMutexAcquire lock(canonicalImagesMutex());
+    int index = canonicalImages().find(entry);
+    if (index >= 0) {
+        // Another thread added the image while this one was encoding it.
+        SkPDFImage* existing = canonicalImages()[index].fImage;
+        existing->ref();
+        lock.release();
+        image->unref();
+        return existing;
+    }
+    entry.fImage = image;
+    canonicalImages().push(entry);
+    return image;  // Return the reference that came from EncodeImage.
+}
+
+// static
+SkPDFImage* SkPDFImage::EncodeImage(const SkBitmap& bitmap,
+                                    const SkIRect& srcRect,
+                                    const SkPaint& paint) {
+    // If the pixels were decoded from a JPEG file that is still around, and
+    // all of them are drawn, the file can be used as is.
+    SkPixelRef* pixelRef = bitmap.pixelRef();
+    if (pixelRef && bitmap.pixelRefOffset() == 0 &&
+            srcRect == SkIRect::MakeWH(bitmap.width(), bitmap.height())) {
+        SkAutoDataUnref jpeg(pixelRef->refEncodedData());
+        int width, height, components;
+        if (jpeg.get() &&
+                getJpegInfo(jpeg.get(), &width, &height, &components) &&
+                width == bitmap.width() && height == bitmap.height() &&
+                (components == 1 || components == 3)) {
+            return new SkPDFImage(jpeg.get(), width, height, components);
+        }
+    }
 
     SkStream* imageData = NULL;
     SkStream* alphaData = NULL;
@@ -271,6 +367,17 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
 }
 
 SkPDFImage::~SkPDFImage() {
+    {
+        SkAutoMutexAcquire lock(canonicalImagesMutex());
+        // Soft masks and the images of bitmaps without a pixel ref aren't
+        // in the list.
+        for (int i = 0; i < canonicalImages().count(); i++) {
+            if (canonicalImages()[i].fImage == this) {
+                canonicalImages().removeShuffle(i);
+                break;
+            }
+        }
+    }
     fResources.unrefAll();
 }
 
@@ -307,6 +414,19 @@ void SkPDFImage::getResources(SkTDArray<SkPDFObject*>* resourceList) {
     }
 }
 
+SkPDFImage::SkPDFImage(SkData* jpeg, int width, int height, int components) {
+    fStream = new SkPDFStream(jpeg, "DCTDecode");
+    fStream->unref();  // SkRefPtr and new both took a reference.
+
+    insert("Type", new SkPDFName("XObject"))->unref();
+    insert("Subtype", new SkPDFName("Image"))->unref();
+    insert("Width", new SkPDFInt(width))->unref();
+    insert("Height", new SkPDFInt(height))->unref();
+    insert("ColorSpace", new SkPDFName(components == 1 ? "DeviceGray"
+                                                       : "DeviceRGB"))->unref();
+    insert("BitsPerComponent", new SkPDFInt(8))->unref();
+}
+
 SkPDFImage::SkPDFImage(SkStream* imageData, const SkBitmap& bitmap,
                        const SkIRect& srcRect, bool doingAlpha,
                        const SkPaint& paint) {
@@ -380,3 +500,41 @@ SkPDFObject* SkPDFImage::insert(SkPDFName* key, SkPDFObject* value) {
 SkPDFObject* SkPDFImage::insert(const char key[], SkPDFObject* value) {
     return fStream->insert(key, value);
 }
+
+// static
+SkTDArray<SkPDFImage::ImageCanonicalEntry>& SkPDFImage::canonicalImages() {
+    // This initialization is only thread safe with gcc.
+    static SkTDArray<ImageCanonicalEntry> gCanonicalImages;
+    return gCanonicalImages;
+}
+
+// static
+SkMutex& SkPDFImage::canonicalImagesMutex() {
+    // This initialization is only thread safe with gcc.
+    static SkMutex gCanonicalImagesMutex;
+    return gCanonicalImagesMutex;
+}
+
+bool SkPDFImage::ImageCanonicalEntry::operator==(
+        const ImageCanonicalEntry& b) const {
+    return fGenerationID == b.fGenerationID &&
+           fPixelRefOffset == b.fPixelRefOffset &&
+           fRowBytes == b.fRowBytes &&
+           fWidth == b.fWidth &&
+           fHeight == b.fHeight &&
+           fConfig == b.fConfig &&
+           fSrcRect == b.fSrcRect;
+}
+
+SkPDFImage::ImageCanonicalEntry::ImageCanonicalEntry(SkPDFImage* image,
+                                                     const SkBitmap& bitmap,
+                                                     const SkIRect& srcRect)
+    : fImage(image),
+      fGenerationID(bitmap.getGenerationID()),
+      fPixelRefOffset(bitmap.pixelRefOffset()),
+      fRowBytes(bitmap.rowBytes()),
+      fWidth(bitmap.width()),
+      fHeight(bitmap.height()),
+      fConfig(bitmap.getConfig()),
+      fSrcRect(srcRect) {
+}
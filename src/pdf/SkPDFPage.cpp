@@ -26,18 +26,23 @@ SkPDFPage::SkPDFPage(const SkRefPtr<SkPDFDevice>& content)
 
 SkPDFPage::~SkPDFPage() {}
 
+void SkPDFPage::finalizeContent() {
+    if (fContentStream.get() != NULL)
+        return;
+
+    insert("Resources", fDevice->getResourceDict().get());
+    insert("MediaBox", fDevice->getMediaBox().get());
+
+    SkRefPtr<SkStream> content = fDevice->content();
+    content->unref();  // SkRefPtr and content() both took a reference.
+    fContentStream = new SkPDFStream(content.get());
+    fContentStream->unref();  // SkRefPtr and new both took a reference.
+    insert("Contents", new SkPDFObjRef(fContentStream.get()))->unref();
+}
+
 void SkPDFPage::finalizePage(SkPDFCatalog* catalog, bool firstPage,
                              SkTDArray<SkPDFObject*>* resourceObjects) {
-    if (fContentStream.get() == NULL) {
-        insert("Resources", fDevice->getResourceDict().get());
-        insert("MediaBox", fDevice->getMediaBox().get());
-
-        SkRefPtr<SkStream> content = fDevice->content();
-        content->unref();  // SkRefPtr and content() both took a reference.
-        fContentStream = new SkPDFStream(content.get());
-        fContentStream->unref();  // SkRefPtr and new both took a reference.
-        insert("Contents", new SkPDFObjRef(fContentStream.get()))->unref();
-    }
+    finalizeContent();
     catalog->addObject(fContentStream.get(), firstPage);
     fDevice->getResources(resourceObjects);
 }
@@ -53,6 +58,14 @@ void SkPDFPage::emitPage(SkWStream* stream, SkPDFCatalog* catalog) {
     fContentStream->emitObject(stream, catalog, true);
 }
 
+void SkPDFPage::releaseContent(SkPDFCatalog* catalog) {
+    SkASSERT(fContentStream.get() != NULL);
+    catalog->forgetObject(fContentStream.get());
+    clear();
+    fContentStream = NULL;
+    fDevice = NULL;
+}
+
 // static
 void SkPDFPage::generatePageTree(const SkTDArray<SkPDFPage*>& pages,
                                  SkPDFCatalog* catalog,
@@ -140,3 +153,7 @@ void SkPDFPage::generatePageTree(const SkTDArray<SkPDFPage*>& pages,
 const SkTDArray<SkPDFFont*>& SkPDFPage::getFontResources() const {
     return fDevice->getFontResources();
 }
+
+const SkPDFGlyphSetMap& SkPDFPage::getFontGlyphUsage() const {
+    return fDevice->getFontGlyphUsage();
+}
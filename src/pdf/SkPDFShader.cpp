@@ -27,6 +27,74 @@
 #include "SkThread.h"
 #include "SkTypes.h"
 
+// Set dst to a width by height ARGB copy of src, drawn with filtering.
+static bool scaleBitmap(const SkBitmap& src, int width, int height,
+                        SkBitmap* dst) {
+    dst->setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    if (!dst->allocPixels())
+        return false;
+    dst->eraseColor(0);
+
+    SkCanvas canvas(*dst);
+    canvas.scale(SkIntToScalar(width) / src.width(),
+                 SkIntToScalar(height) / src.height());
+    SkPaint paint;
+    paint.setFilterBitmap(true);
+    paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+    canvas.drawBitmap(src, 0, 0, &paint);
+    return true;
+}
+
+// The most image pixels per point an image pattern keeps, which is enough
+// to print it at 288 dpi.
+static const SkScalar kMaxImagePixelsPerPoint = SkIntToScalar(4);
+
+// If matrix draws image with more than kMaxImagePixelsPerPoint image pixels
+// per point in both directions, set scaledImage to image scaled down to that
+// resolution, update matrix to draw it in the same place and return true.
+static bool downsampleImage(const SkBitmap& image, SkMatrix* matrix,
+                            SkBitmap* scaledImage) {
+    if (matrix->hasPerspective() || image.width() == 0 ||
+            image.height() == 0) {
+        return false;
+    }
+    SkVector axes[2];
+    axes[0].set(SK_Scalar1, 0);
+    axes[1].set(0, SK_Scalar1);
+    matrix->mapVectors(axes, 2);
+    SkScalar scale = SkScalarMul(kMaxImagePixelsPerPoint,
+                                 SkMaxScalar(axes[0].length(),
+                                             axes[1].length()));
+    if (scale >= SK_Scalar1)
+        return false;
+
+    int width = SkScalarCeil(image.width() * scale);
+    int height = SkScalarCeil(image.height() * scale);
+    if (width < 1)
+        width = 1;
+    if (height < 1)
+        height = 1;
+
+    // Halve the image until it's close to the final size, so that the
+    // filtering draws below use every pixel.
+    SkBitmap source = image;
+    while (source.width() >= 2 * width && source.height() >= 2 * height) {
+        SkBitmap half;
+        if (!scaleBitmap(source, source.width() / 2, source.height() / 2,
+                         &half)) {
+            return false;
+        }
+        source = half;
+    }
+    if (!scaleBitmap(source, width, height, scaledImage))
+        return false;
+
+    SkScalar scaleX = SkIntToScalar(width) / image.width();
+    SkScalar scaleY = SkIntToScalar(height) / image.height();
+    matrix->preScale(SkScalarInvert(scaleX), SkScalarInvert(scaleY));
+    return true;
+}
+
 static void transformBBox(const SkMatrix& matrix, SkRect* bbox) {
     SkMatrix inverse;
     inverse.reset();
@@ -287,11 +355,13 @@ static SkString sweepCode(const SkShader::GradientInfo& info) {
 }
 
 SkPDFShader::~SkPDFShader() {
-    SkAutoMutexAcquire lock(canonicalShadersMutex());
-    ShaderCanonicalEntry entry(this, fState.get());
-    int index = canonicalShaders().find(entry);
-    SkASSERT(index >= 0);
-    canonicalShaders().removeShuffle(index);
+    {
+        SkAutoMutexAcquire lock(canonicalShadersMutex());
+        ShaderCanonicalEntry entry(this, fState.get());
+        int index = canonicalShaders().find(entry);
+        SkASSERT(index >= 0);
+        canonicalShaders().removeShuffle(index);
+    }
     fResources.unrefAll();
 }
 
@@ -326,13 +396,18 @@ SkPDFShader* SkPDFShader::getPDFShader(const SkShader& shader,
     SkAutoMutexAcquire lock(canonicalShadersMutex());
     SkAutoTDelete<State> shaderState(new State(shader, matrix, surfaceBBox));
 
-    ShaderCanonicalEntry entry(NULL, shaderState.get());
-    int index = canonicalShaders().find(entry);
-    if (index >= 0) {
-        SkPDFShader* result = canonicalShaders()[index].fPDFShader;
-        result->ref();
-        return result;
+    // A pattern covers its whole bounding box, so one that was made for a
+    // larger box can be used as well.
+    for (int i = 0; i < canonicalShaders().count(); i++) {
+        const State* state = canonicalShaders()[i].fState;
+        if (state->fBBox.contains(shaderState.get()->fBBox) &&
+                state->equalsExceptBBox(*shaderState.get())) {
+            SkPDFShader* result = canonicalShaders()[i].fPDFShader;
+            result->ref();
+            return result;
+        }
     }
+    ShaderCanonicalEntry entry(NULL, shaderState.get());
     // The PDFShader takes ownership of the shaderSate.
     pdfShader = new SkPDFShader(shaderState.detach());
     // Check for a valid shader.
@@ -491,6 +566,14 @@ void SkPDFShader::doImageShader() {
 
     SkMatrix finalMatrix = fState.get()->fCanvasTransform;
     finalMatrix.preConcat(fState.get()->fShaderTransform);
+
+    // An image that is drawn much smaller than its size only has to keep
+    // the resolution that can be printed, so it is scaled down to that.
+    const SkBitmap* image = &fState.get()->fImage;
+    SkBitmap scaledImage;
+    if (downsampleImage(*image, &finalMatrix, &scaledImage))
+        image = &scaledImage;
+
     SkRect surfaceBBox;
     surfaceBBox.set(fState.get()->fBBox);
     transformBBox(finalMatrix, &surfaceBBox);
@@ -505,7 +588,6 @@ void SkPDFShader::doImageShader() {
     canvas.translate(-surfaceBBox.fLeft, -surfaceBBox.fTop);
     finalMatrix.preTranslate(surfaceBBox.fLeft, surfaceBBox.fTop);
 
-    const SkBitmap* image = &fState.get()->fImage;
     int width = image->width();
     int height = image->height();
     SkShader::TileMode tileModes[2];
@@ -694,10 +776,14 @@ SkPDFStream* SkPDFShader::makePSFunction(const SkString& psCode,
 }
 
 bool SkPDFShader::State::operator==(const SkPDFShader::State& b) const {
+    return fBBox == b.fBBox && equalsExceptBBox(b);
+}
+
+bool SkPDFShader::State::equalsExceptBBox(
+        const SkPDFShader::State& b) const {
     if (fType != b.fType ||
             fCanvasTransform != b.fCanvasTransform ||
-            fShaderTransform != b.fShaderTransform ||
-            fBBox != b.fBBox) {
+            fShaderTransform != b.fShaderTransform) {
         return false;
     }
 
@@ -36,6 +36,16 @@ SkPDFStream::SkPDFStream(SkStream* stream) {
     insert("Length", new SkPDFInt(fLength))->unref();
 }
 
+SkPDFStream::SkPDFStream(SkData* data, const char filterName[]) {
+    SkRefPtr<SkMemoryStream> stream = new SkMemoryStream;
+    stream->unref();  // SkRefPtr and new both took a reference.
+    stream->setData(data);
+    fPlainData = stream.get();
+    fLength = data->size();
+    insert("Filter", new SkPDFName(filterName))->unref();
+    insert("Length", new SkPDFInt(fLength))->unref();
+}
+
 SkPDFStream::~SkPDFStream() {
 }
 
@@ -45,14 +55,20 @@ void SkPDFStream::emitObject(SkWStream* stream, SkPDFCatalog* catalog,
         return emitIndirectObject(stream, catalog);
 
     this->INHERITED::emitObject(stream, catalog, false);
-    stream->writeText(" stream\n");
     if (fPlainData.get()) {
-        stream->write(fPlainData->getMemoryBase(), fLength);
+        static const char gStart[] = " stream\n";
+        static const char gEnd[] = "\nendstream";
+        const SkWStream::Chunk chunks[] = {
+            { gStart, sizeof(gStart) - 1 },
+            { fPlainData->getMemoryBase(), fLength },
+            { gEnd, sizeof(gEnd) - 1 },
+        };
+        stream->writev(chunks, SK_ARRAY_COUNT(chunks));
     } else {
-        SkAutoDataUnref data(fCompressedData.copyToData());
-        stream->write(data.data(), fLength);
+        stream->writeText(" stream\n");
+        fCompressedData.writeToStream(stream);
+        stream->writeText("\nendstream");
     }
-    stream->writeText("\nendstream");
 }
 
 size_t SkPDFStream::getOutputSize(SkPDFCatalog* catalog, bool indirect) {
@@ -18,12 +18,6 @@
 #include "SkPDFTypes.h"
 #include "SkStream.h"
 
-#ifdef SK_BUILD_FOR_WIN
-    #define SNPRINTF    _snprintf
-#else
-    #define SNPRINTF    snprintf
-#endif
-
 SkPDFObject::SkPDFObject() {}
 SkPDFObject::~SkPDFObject() {}
 
@@ -103,8 +97,36 @@ void SkPDFScalar::emitObject(SkWStream* stream, SkPDFCatalog* catalog,
     Append(fValue, stream);
 }
 
+// Write the decimal digits of value, most significant first.
+static char* append_unsigned(char buffer[], uint64_t value) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = SkToU8('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    size_t len = digits + sizeof(digits) - p;
+    memcpy(buffer, p, len);
+    return buffer + len;
+}
+
+static char* append_integer(char buffer[], int32_t value) {
+    if (value < 0) {
+        *buffer++ = '-';
+        return append_unsigned(buffer, 0u - (uint32_t)value);
+    }
+    return append_unsigned(buffer, value);
+}
+
 // static
 void SkPDFScalar::Append(SkScalar value, SkWStream* stream) {
+    char buffer[kMaxTextSize];
+    char* end = AppendToBuffer(value, buffer);
+    stream->write(buffer, end - buffer);
+}
+
+// static
+char* SkPDFScalar::AppendToBuffer(SkScalar value, char buffer[]) {
     // The range of reals in PDF/A is the same as SkFixed: +/- 32,767 and
     // +/- 1/65,536 (though integers can range from 2^31 - 1 to -2^31).
     // When using floats that are outside the whole value range, we can use
@@ -112,20 +134,46 @@ void SkPDFScalar::Append(SkScalar value, SkWStream* stream) {
 
 
 #if defined(SK_SCALAR_IS_FIXED)
-    stream->writeScalarAsText(value);
-    return;
+    return SkStrAppendScalar(buffer, value);
 #endif  // SK_SCALAR_IS_FIXED
 
 #if !defined(SK_ALLOW_LARGE_PDF_SCALARS)
     if (value > 32767 || value < -32767) {
-        stream->writeDecAsText(SkScalarRound(value));
-        return;
+        return append_integer(buffer, SkScalarRound(value));
     }
 
-    char buffer[SkStrAppendScalar_MaxSize];
-    char* end = SkStrAppendFixed(buffer, SkScalarToFixed(value));
-    stream->write(buffer, end - buffer);
-    return;
+    // This matches SkStrAppendFixed(): at most four fractional digits, with
+    // trailing zeros dropped but at least one digit after the point.
+    SkFixed x = SkScalarToFixed(value);
+    if (x < 0) {
+        *buffer++ = '-';
+        x = -x;
+    }
+    unsigned frac = x & 0xFFFF;
+    unsigned whole = x >> 16;
+    if (frac == 0xFFFF) {
+        // 65535/65536 is closer to 1 than to .9999.
+        whole += 1;
+        frac = 0;
+    }
+    buffer = append_unsigned(buffer, whole);
+    if (frac) {
+        unsigned dec = SkFixedRound(frac * 10000);
+        if (dec == 10000) {
+            dec -= 1;
+        }
+        buffer[0] = '.';
+        buffer[1] = SkToU8('0' + dec / 1000);
+        buffer[2] = SkToU8('0' + dec / 100 % 10);
+        buffer[3] = SkToU8('0' + dec / 10 % 10);
+        buffer[4] = SkToU8('0' + dec % 10);
+        int len = 5;
+        while (len > 2 && buffer[len - 1] == '0') {
+            len--;
+        }
+        buffer += len;
+    }
+    return buffer;
 #endif  // !SK_ALLOW_LARGE_PDF_SCALARS
 
 #if defined(SK_SCALAR_IS_FLOAT) && defined(SK_ALLOW_LARGE_PDF_SCALARS)
@@ -133,28 +181,37 @@ void SkPDFScalar::Append(SkScalar value, SkWStream* stream) {
     // no more precise than an int. (Plus PDF doesn't support scientific
     // notation, so this clamps to SK_Max/MinS32).
     if (value > (1 << 24) || value < -(1 << 24)) {
-        stream->writeDecAsText(value);
-        return;
+        return append_integer(buffer, (int32_t)value);
     }
     // Continue to enforce the PDF limits for small floats.
     if (value < 1.0f/65536 && value > -1.0f/65536) {
-        stream->writeDecAsText(0);
-        return;
+        *buffer = '0';
+        return buffer + 1;
     }
-    // SkStrAppendFloat might still use scientific notation, so use snprintf
-    // directly..
-    static const int kFloat_MaxSize = 19;
-    char buffer[kFloat_MaxSize];
-    int len = SNPRINTF(buffer, kFloat_MaxSize, "%#.8f", value);
-    // %f always prints trailing 0s, so strip them.
-    for (; buffer[len - 1] == '0' && len > 0; len--) {
-        buffer[len - 1] = '\0';
+    // Print eight fractional digits, as "%.8f" would. A float below 2^24
+    // has 24 significant bits and 10^8 needs 19, so the scaled value is
+    // exact in a double and only the final round-half-even step is needed.
+    double scaled = value;
+    if (scaled < 0) {
+        *buffer++ = '-';
+        scaled = -scaled;
     }
-    if (buffer[len - 1] == '.') {
-        buffer[len - 1] = '\0';
+    scaled *= 100000000.0;
+    uint64_t fixed8 = (uint64_t)scaled;
+    double rem = scaled - (double)fixed8;
+    if (rem > 0.5 || (rem == 0.5 && (fixed8 & 1))) {
+        fixed8++;
+    }
+    buffer = append_unsigned(buffer, fixed8 / 100000000);
+    uint32_t frac = (uint32_t)(fixed8 % 100000000);
+    if (frac) {
+        *buffer++ = '.';
+        for (uint32_t tens = 10000000; tens != 0 && frac != 0; tens /= 10) {
+            *buffer++ = SkToU8('0' + frac / tens);
+            frac %= tens;
+        }
     }
-    stream->writeText(buffer);
-    return;
+    return buffer;
 #endif  // SK_SCALAR_IS_FLOAT && SK_ALLOW_LARGE_PDF_SCALARS
 }
 
@@ -34,54 +34,97 @@ SkPDFArray* SkPDFUtils::MatrixToArray(const SkMatrix& matrix) {
     return result;
 }
 
+namespace {
+
+// Collects content stream operators and their operands on the stack so that
+// a run of path segments reaches the stream in a few large writes instead of
+// two writes per number.
+class ContentBuffer {
+public:
+    explicit ContentBuffer(SkWStream* content)
+        : fContent(content),
+          fCurr(fStorage) {
+    }
+    ~ContentBuffer() { this->flush(); }
+
+    // Append each scalar followed by a space, then the operator text.
+    void appendOp(const SkScalar values[], int count, const char op[]) {
+        size_t opLen = strlen(op);
+        SkASSERT(count <= kMaxOperands && opLen <= kMaxOpSize);
+        size_t needed = count * (SkPDFScalar::kMaxTextSize + 1) + opLen;
+        if (fCurr + needed > fStorage + sizeof(fStorage)) {
+            this->flush();
+        }
+        for (int i = 0; i < count; i++) {
+            fCurr = SkPDFScalar::AppendToBuffer(values[i], fCurr);
+            *fCurr++ = ' ';
+        }
+        memcpy(fCurr, op, opLen);
+        fCurr += opLen;
+    }
+
+    void flush() {
+        if (fCurr != fStorage) {
+            fContent->write(fStorage, fCurr - fStorage);
+            fCurr = fStorage;
+        }
+    }
+
+private:
+    enum {
+        kMaxOperands = 6,
+        kMaxOpSize = 4,
+        kMinStorageSize = kMaxOperands * (SkPDFScalar::kMaxTextSize + 1) +
+                          kMaxOpSize,
+    };
+
+    SkWStream* fContent;
+    char* fCurr;
+    char fStorage[kMinStorageSize * 8];
+};
+
+}  // namespace
+
+static void append_cubic(SkScalar ctl1X, SkScalar ctl1Y,
+                         SkScalar ctl2X, SkScalar ctl2Y,
+                         SkScalar dstX, SkScalar dstY, ContentBuffer* content) {
+    if (ctl2X != dstX || ctl2Y != dstY) {
+        SkScalar values[6] = { ctl1X, ctl1Y, ctl2X, ctl2Y, dstX, dstY };
+        content->appendOp(values, 6, "c\n");
+    } else {
+        SkScalar values[4] = { ctl1X, ctl1Y, dstX, dstY };
+        content->appendOp(values, 4, "y\n");
+    }
+}
+
 // static
 void SkPDFUtils::AppendTransform(const SkMatrix& matrix, SkWStream* content) {
     SkScalar values[6];
     SkAssertResult(matrix.pdfTransform(values));
-    for (size_t i = 0; i < SK_ARRAY_COUNT(values); i++) {
-        SkPDFScalar::Append(values[i], content);
-        content->writeText(" ");
-    }
-    content->writeText("cm\n");
+    ContentBuffer buffer(content);
+    buffer.appendOp(values, SK_ARRAY_COUNT(values), "cm\n");
 }
 
 // static
 void SkPDFUtils::MoveTo(SkScalar x, SkScalar y, SkWStream* content) {
-    SkPDFScalar::Append(x, content);
-    content->writeText(" ");
-    SkPDFScalar::Append(y, content);
-    content->writeText(" m\n");
+    SkScalar values[2] = { x, y };
+    ContentBuffer buffer(content);
+    buffer.appendOp(values, 2, "m\n");
 }
 
 // static
 void SkPDFUtils::AppendLine(SkScalar x, SkScalar y, SkWStream* content) {
-    SkPDFScalar::Append(x, content);
-    content->writeText(" ");
-    SkPDFScalar::Append(y, content);
-    content->writeText(" l\n");
+    SkScalar values[2] = { x, y };
+    ContentBuffer buffer(content);
+    buffer.appendOp(values, 2, "l\n");
 }
 
 // static
 void SkPDFUtils::AppendCubic(SkScalar ctl1X, SkScalar ctl1Y,
                              SkScalar ctl2X, SkScalar ctl2Y,
                              SkScalar dstX, SkScalar dstY, SkWStream* content) {
-    SkString cmd("y\n");
-    SkPDFScalar::Append(ctl1X, content);
-    content->writeText(" ");
-    SkPDFScalar::Append(ctl1Y, content);
-    content->writeText(" ");
-    if (ctl2X != dstX || ctl2Y != dstY) {
-        cmd.set("c\n");
-        SkPDFScalar::Append(ctl2X, content);
-        content->writeText(" ");
-        SkPDFScalar::Append(ctl2Y, content);
-        content->writeText(" ");
-    }
-    SkPDFScalar::Append(dstX, content);
-    content->writeText(" ");
-    SkPDFScalar::Append(dstY, content);
-    content->writeText(" ");
-    content->writeText(cmd.c_str());
+    ContentBuffer buffer(content);
+    append_cubic(ctl1X, ctl1Y, ctl2X, ctl2Y, dstX, dstY, &buffer);
 }
 
 // static
@@ -89,18 +132,14 @@ void SkPDFUtils::AppendRectangle(const SkRect& rect, SkWStream* content) {
     // Skia has 0,0 at top left, pdf at bottom left.  Do the right thing.
     SkScalar bottom = SkMinScalar(rect.fBottom, rect.fTop);
 
-    SkPDFScalar::Append(rect.fLeft, content);
-    content->writeText(" ");
-    SkPDFScalar::Append(bottom, content);
-    content->writeText(" ");
-    SkPDFScalar::Append(rect.width(), content);
-    content->writeText(" ");
-    SkPDFScalar::Append(rect.height(), content);
-    content->writeText(" re\n");
+    SkScalar values[4] = { rect.fLeft, bottom, rect.width(), rect.height() };
+    ContentBuffer buffer(content);
+    buffer.appendOp(values, 4, "re\n");
 }
 
 // static
 void SkPDFUtils::EmitPath(const SkPath& path, SkWStream* content) {
+    ContentBuffer buffer(content);
     SkPoint args[4];
     SkPath::Iter iter(path, false);
     for (SkPath::Verb verb = iter.next(args);
@@ -109,10 +148,10 @@ void SkPDFUtils::EmitPath(const SkPath& path, SkWStream* content) {
         // args gets all the points, even the implicit first point.
         switch (verb) {
             case SkPath::kMove_Verb:
-                MoveTo(args[0].fX, args[0].fY, content);
+                buffer.appendOp(&args[0].fX, 2, "m\n");
                 break;
             case SkPath::kLine_Verb:
-                AppendLine(args[1].fX, args[1].fY, content);
+                buffer.appendOp(&args[1].fX, 2, "l\n");
                 break;
             case SkPath::kQuad_Verb: {
                 // Convert quad to cubic (degree elevation). http://goo.gl/vS4i
@@ -122,16 +161,16 @@ void SkPDFUtils::EmitPath(const SkPath& path, SkWStream* content) {
                 SkScalar ctl1Y = SkScalarDiv(args[0].fY + args[1].fY, three);
                 SkScalar ctl2X = SkScalarDiv(args[2].fX + args[1].fX, three);
                 SkScalar ctl2Y = SkScalarDiv(args[2].fY + args[1].fY, three);
-                AppendCubic(ctl1X, ctl1Y, ctl2X, ctl2Y, args[2].fX, args[2].fY,
-                            content);
+                append_cubic(ctl1X, ctl1Y, ctl2X, ctl2Y, args[2].fX, args[2].fY,
+                             &buffer);
                 break;
             }
             case SkPath::kCubic_Verb:
-                AppendCubic(args[1].fX, args[1].fY, args[2].fX, args[2].fY,
-                            args[3].fX, args[3].fY, content);
+                append_cubic(args[1].fX, args[1].fY, args[2].fX, args[2].fY,
+                             args[3].fX, args[3].fY, &buffer);
                 break;
             case SkPath::kClose_Verb:
-                ClosePath(content);
+                buffer.appendOp(NULL, 0, "h\n");
                 break;
             default:
                 SkASSERT(false);
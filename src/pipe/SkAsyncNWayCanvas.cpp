@@ -0,0 +1,123 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkAsyncNWayCanvas.h"
+#include "SkCanvas.h"
+#include "SkGPipeFanOut.h"
+#include "SkThreadPool.h"
+
+// plays the pipe back into one of the targets, as one of the controller's
+// readers
+class SkAsyncNWayCanvas::Target : public SkRunnable {
+public:
+    Target(SkCanvas* canvas) : fCanvas(canvas), fController(NULL),
+                               fStatus(SkGPipeReader::kDone_Status) {}
+
+    void setController(SkGPipeFanOutController* controller) {
+        fController = controller;
+        fStatus = SkGPipeReader::kEOF_Status;
+    }
+
+    bool isDone() const { return SkGPipeReader::kDone_Status == fStatus; }
+
+    virtual void run() {
+        fStatus = fController->playback(fCanvas);
+    }
+
+private:
+    SkCanvas*                   fCanvas;
+    SkGPipeFanOutController*    fController;
+    SkGPipeReader::Status       fStatus;
+};
+
+SkAsyncNWayCanvas::SkAsyncNWayCanvas() : fPool(NULL), fController(NULL) {}
+
+SkAsyncNWayCanvas::~SkAsyncNWayCanvas() {
+    this->endRecording();
+    this->removeAll();
+}
+
+void SkAsyncNWayCanvas::addCanvas(SkCanvas* canvas) {
+    SkASSERT(!this->isRecording());
+    if (canvas) {
+        canvas->ref();
+        *fList.append() = canvas;
+        this->freeTargets();
+    }
+}
+
+void SkAsyncNWayCanvas::removeCanvas(SkCanvas* canvas) {
+    SkASSERT(!this->isRecording());
+    int index = fList.find(canvas);
+    if (index >= 0) {
+        canvas->unref();
+        fList.removeShuffle(index);
+        this->freeTargets();
+    }
+}
+
+void SkAsyncNWayCanvas::removeAll() {
+    SkASSERT(!this->isRecording());
+    fList.unrefAll();
+    fList.reset();
+    this->freeTargets();
+}
+
+void SkAsyncNWayCanvas::freeTargets() {
+    SkDELETE(fPool);
+    fPool = NULL;
+    fTargets.deleteAll();
+    fTargets.reset();
+}
+
+SkCanvas* SkAsyncNWayCanvas::beginRecording() {
+    if (this->isRecording()) {
+        return fWriter.startRecording(fController);
+    }
+
+    // the threads are kept for as long as the targets stay the same
+    if (NULL == fPool) {
+        for (int i = 0; i < fList.count(); i++) {
+            *fTargets.append() = SkNEW_ARGS(Target, (fList[i]));
+        }
+        fPool = SkNEW_ARGS(SkThreadPool, (fList.count()));
+    }
+
+    fController = SkNEW_ARGS(SkGPipeFanOutController, (fTargets.count()));
+    for (int i = 0; i < fTargets.count(); i++) {
+        fTargets[i]->setController(fController);
+        fPool->add(fTargets[i]);
+    }
+    return fWriter.startRecording(fController);
+}
+
+bool SkAsyncNWayCanvas::endRecording() {
+    if (!this->isRecording()) {
+        return true;
+    }
+    fWriter.endRecording();
+    // without threads, this is where the targets play back
+    fPool->wait();
+
+    bool done = true;
+    for (int i = 0; i < fTargets.count(); i++) {
+        done = done && fTargets[i]->isDone();
+    }
+    SkDELETE(fController);
+    fController = NULL;
+    return done;
+}
@@ -0,0 +1,215 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkGPipeFanOut.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC) || \
+    defined(SK_BUILD_FOR_ANDROID) || defined(ANDROID)
+    #define SK_GPIPE_FANOUT_USE_PTHREADS
+#endif
+
+#ifdef SK_GPIPE_FANOUT_USE_PTHREADS
+    #include <pthread.h>
+#endif
+
+// Most ops are small, so a block holds many of them, and readers aren't
+// woken up for a new block too often.
+#define MIN_BLOCK_SIZE  (64 * 1024)
+
+/*  The blocks are a list, from the oldest one that a reader may still read
+    to the one being written. Each block counts the readers that haven't
+    finished with it; readers finish with blocks in order, so the ones nobody
+    needs any more are always at the head of the list.
+ */
+struct SkGPipeFanOutController::Block {
+    Block*  fNext;
+    int     fRefCnt;
+    size_t  fSize;
+    size_t  fWritten;
+
+    uint8_t* data() { return (uint8_t*)this + sizeof(*this); }
+};
+
+#ifdef SK_GPIPE_FANOUT_USE_PTHREADS
+
+struct SkGPipeFanOutController::Impl {
+    pthread_mutex_t fMutex;
+    pthread_cond_t  fWrittenCond;   // signaled when more has been written
+    int             fWaiting;       // readers waiting on fWrittenCond
+};
+
+void SkGPipeFanOutController::lock() {
+    pthread_mutex_lock(&fImpl->fMutex);
+}
+
+void SkGPipeFanOutController::unlock() {
+    pthread_mutex_unlock(&fImpl->fMutex);
+}
+
+bool SkGPipeFanOutController::waitForBlocks() {
+    fImpl->fWaiting += 1;
+    pthread_cond_wait(&fImpl->fWrittenCond, &fImpl->fMutex);
+    fImpl->fWaiting -= 1;
+    return true;
+}
+
+// The writer notifies after every op, so this only signals when a reader is
+// actually waiting, rather than making a system call each time.
+void SkGPipeFanOutController::wakeReaders() {
+    if (fImpl->fWaiting > 0) {
+        pthread_cond_broadcast(&fImpl->fWrittenCond);
+    }
+}
+
+#else   // !SK_GPIPE_FANOUT_USE_PTHREADS
+
+struct SkGPipeFanOutController::Impl {};
+
+void SkGPipeFanOutController::lock() {}
+void SkGPipeFanOutController::unlock() {}
+bool SkGPipeFanOutController::waitForBlocks() { return false; }
+void SkGPipeFanOutController::wakeReaders() {}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeFanOutController::SkGPipeFanOutController(int readerCount)
+    : fHead(NULL)
+    , fTail(NULL)
+    , fReaderCount(readerCount)
+    , fUnstarted(readerCount) {
+    SkASSERT(readerCount >= 0);
+    fImpl = SkNEW(Impl);
+#ifdef SK_GPIPE_FANOUT_USE_PTHREADS
+    pthread_mutex_init(&fImpl->fMutex, NULL);
+    pthread_cond_init(&fImpl->fWrittenCond, NULL);
+    fImpl->fWaiting = 0;
+#endif
+}
+
+SkGPipeFanOutController::~SkGPipeFanOutController() {
+    Block* block = fHead;
+    while (block) {
+        Block* next = block->fNext;
+        sk_free(block);
+        block = next;
+    }
+#ifdef SK_GPIPE_FANOUT_USE_PTHREADS
+    pthread_cond_destroy(&fImpl->fWrittenCond);
+    pthread_mutex_destroy(&fImpl->fMutex);
+#endif
+    SkDELETE(fImpl);
+}
+
+void SkGPipeFanOutController::releaseBlock(Block* block) {
+    SkASSERT(block->fRefCnt > 0);
+    block->fRefCnt -= 1;
+    this->freeUnusedBlocks();
+}
+
+void SkGPipeFanOutController::freeUnusedBlocks() {
+    // the writer may still be writing into the tail
+    while (fHead != fTail && 0 == fHead->fRefCnt) {
+        Block* next = fHead->fNext;
+        sk_free(fHead);
+        fHead = next;
+    }
+}
+
+void* SkGPipeFanOutController::requestBlock(size_t minRequest,
+                                            size_t* actual) {
+    size_t size = SkMax32(minRequest, MIN_BLOCK_SIZE);
+    Block* block = (Block*)sk_malloc_throw(sizeof(Block) + size);
+    block->fNext = NULL;
+    block->fSize = size;
+    block->fWritten = 0;
+
+    this->lock();
+    block->fRefCnt = fReaderCount;
+    if (fTail) {
+        fTail->fNext = block;
+        fTail = block;
+        // the old tail may have been left to the writer
+        this->freeUnusedBlocks();
+    } else {
+        fHead = fTail = block;
+    }
+    this->wakeReaders();
+    this->unlock();
+
+    *actual = size;
+    return block->data();
+}
+
+void SkGPipeFanOutController::notifyWritten(size_t bytes) {
+    this->lock();
+    SkASSERT(fTail && fTail->fWritten + bytes <= fTail->fSize);
+    fTail->fWritten += bytes;
+    this->wakeReaders();
+    this->unlock();
+}
+
+SkGPipeReader::Status SkGPipeFanOutController::playback(SkCanvas* canvas) {
+    SkGPipeReader reader(canvas);
+    SkGPipeReader::Status status = SkGPipeReader::kEOF_Status;
+
+    this->lock();
+    SkASSERT(fUnstarted > 0);
+    fUnstarted -= 1;
+
+    Block* block = NULL;
+    size_t offset = 0;
+    for (;;) {
+        if (NULL == block) {
+            // this reader is counted in every block, so it starts at the head
+            block = fHead;
+        }
+        if (block && offset < block->fWritten) {
+            // the writer doesn't touch what it has notified, so this can be
+            // read without the lock
+            size_t written = block->fWritten;
+            this->unlock();
+            size_t bytesRead;
+            status = reader.playback(block->data() + offset, written - offset,
+                                     &bytesRead);
+            offset += bytesRead;
+            this->lock();
+            if (SkGPipeReader::kEOF_Status != status) {
+                break;
+            }
+        } else if (block && block->fNext) {
+            Block* next = block->fNext;
+            this->releaseBlock(block);
+            block = next;
+            offset = 0;
+        } else if (!this->waitForBlocks()) {
+            break;
+        }
+    }
+
+    // later blocks aren't for this reader any more (whether or not it has
+    // finished), so only the remaining readers are counted in new ones
+    fReaderCount -= 1;
+    while (block) {
+        Block* next = block->fNext;
+        this->releaseBlock(block);
+        block = next;
+    }
+    this->unlock();
+    return status;
+}
@@ -73,11 +73,26 @@ enum DrawOps {
 
     kDef_Typeface_DrawOp,
     kDef_Flattenable_DrawOp,
+    kDef_Path_DrawOp,
+    kDef_Bitmap_DrawOp,
+    kEvict_DrawOp,
 
     // these are signals to playback, not drawing verbs
     kDone_DrawOp,
 };
 
+/**
+ *  Bitmaps, paths and flattenables are defined once (with kDef_..._DrawOp and
+ *  an ID in Data) and then referred to by their ID, for as long as the pipe
+ *  lives. kEvict_DrawOp tells the reader to forget one (Flags is its kind
+ *  and Data its ID), after which the writer may reuse the ID.
+ */
+enum CacheKinds {
+    kBitmap_CacheKind,
+    kFlattenable_CacheKind,
+    kPath_CacheKind,
+};
+
 /**
  *  DrawOp packs into a 32bit int as follows
  *
@@ -131,6 +146,14 @@ enum {
 enum {
     kClear_HasColor_DrawOpFlag  = 1 << 0
 };
+enum {
+    // or'd with the SkRegion::Op, which only needs the lower 3 bits
+    kClipPath_DoAntiAlias_DrawOpFlag = 1 << 3
+};
+enum {
+    kDrawBitmap_HasPaint_DrawOpFlag   = 1 << 0,
+    kDrawBitmap_HasSrcRect_DrawOpFlag = 1 << 1,
+};
 enum {
     kDrawTextOnPath_HasMatrix_DrawOpFlag = 1 << 0
 };
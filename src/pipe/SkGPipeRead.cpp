@@ -15,6 +15,7 @@
  */
 
 
+#include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkPaint.h"
 #include "SkGPipe.h"
@@ -60,6 +61,18 @@ static void set_paintflat(SkPaint* paint, SkFlattenable* obj, unsigned paintFlat
     }
 }
 
+// Return where the object with this ID goes in an array indexed by ID - 1,
+// growing the array (with NULLs) as needed.
+template <typename T> T** idSlot(SkTDArray<T*>* array, unsigned id) {
+    SkASSERT(id > 0);
+    if ((int)id > array->count()) {
+        int oldCount = array->count();
+        array->setCount(id);
+        sk_bzero(array->begin() + oldCount, (id - oldCount) * sizeof(T*));
+    }
+    return &(*array)[id - 1];
+}
+
 template <typename T> class SkRefCntTDArray : public SkTDArray<T> {
 public:
     ~SkRefCntTDArray() { this->unrefAll(); }
@@ -75,6 +88,9 @@ public:
         fReader->setFactoryArray(&fFactoryArray);
     }
 
+    const SkMatrix& baseMatrix() const { return fBaseMatrix; }
+    void setBaseMatrix(const SkMatrix& matrix) { fBaseMatrix = matrix; }
+
     const SkPaint& paint() const { return fPaint; }
     SkPaint* editPaint() { return &fPaint; }
     
@@ -82,13 +98,65 @@ public:
         if (0 == index) {
             return NULL;
         }
+        SkASSERT((int)index <= fFlatArray.count() && fFlatArray[index - 1]);
         return fFlatArray[index - 1];
     }
 
-    void defFlattenable(PaintFlats pf, int index) {
-        SkASSERT(index == fFlatArray.count() + 1);
-        SkFlattenable* obj = fReader->readFlattenable();
-        *fFlatArray.append() = obj;
+    void defFlattenable(PaintFlats pf, unsigned index) {
+        SkFlattenable** slot = idSlot(&fFlatArray, index);
+        SkASSERT(NULL == *slot);
+        *slot = fReader->readFlattenable();
+    }
+
+    const SkPath& getPath(unsigned id) const {
+        SkASSERT(id > 0 && (int)id <= fPathArray.count() && fPathArray[id - 1]);
+        return *fPathArray[id - 1];
+    }
+
+    void defPath(unsigned id) {
+        SkPath** slot = idSlot(&fPathArray, id);
+        SkASSERT(NULL == *slot);
+        *slot = SkNEW(SkPath);
+        (*slot)->unflatten(*fReader);
+    }
+
+    const SkBitmap& getBitmap(unsigned id) const {
+        SkASSERT(id > 0 && (int)id <= fBitmapArray.count() &&
+                 fBitmapArray[id - 1]);
+        return *fBitmapArray[id - 1];
+    }
+
+    void defBitmap(unsigned id) {
+        SkBitmap** slot = idSlot(&fBitmapArray, id);
+        SkASSERT(NULL == *slot);
+        *slot = SkNEW(SkBitmap);
+        (*slot)->unflatten(*fReader);
+    }
+
+    void evict(CacheKinds kind, unsigned id) {
+        switch (kind) {
+            case kBitmap_CacheKind: {
+                SkBitmap** slot = idSlot(&fBitmapArray, id);
+                SkDELETE(*slot);
+                *slot = NULL;
+                break;
+            }
+            case kFlattenable_CacheKind: {
+                // a paint that uses it keeps its own reference
+                SkFlattenable** slot = idSlot(&fFlatArray, id);
+                SkSafeUnref(*slot);
+                *slot = NULL;
+                break;
+            }
+            case kPath_CacheKind: {
+                SkPath** slot = idSlot(&fPathArray, id);
+                SkDELETE(*slot);
+                *slot = NULL;
+                break;
+            }
+            default:
+                SkASSERT(!"bad cache kind");
+        }
     }
 
     void addTypeface() {
@@ -104,8 +172,11 @@ public:
     SkFlattenableReadBuffer* fReader;
 
 private:
+    SkMatrix                  fBaseMatrix;
     SkPaint                   fPaint;
-    SkTDArray<SkFlattenable*> fFlatArray;
+    SkTDArray<SkFlattenable*> fFlatArray;     // by ID - 1, NULL if evicted
+    SkTDArray<SkPath*>        fPathArray;     // by ID - 1, NULL if evicted
+    SkTDArray<SkBitmap*>      fBitmapArray;   // by ID - 1, NULL if evicted
     SkTDArray<SkTypeface*>    fTypefaces;
     SkTDArray<SkFlattenable::Factory> fFactoryArray;
 };
@@ -130,9 +201,10 @@ template <typename T> const T* skipAlign(SkReader32* reader, int count = 1) {
 
 static void clipPath_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                         SkGPipeState* state) {
-    SkPath path;
-    path.unflatten(*reader);
-    canvas->clipPath(path, (SkRegion::Op)DrawOp_unpackData(op32));
+    unsigned flags = DrawOp_unpackFlags(op32);
+    canvas->clipPath(state->getPath(DrawOp_unpackData(op32)),
+                     (SkRegion::Op)(flags & ~kClipPath_DoAntiAlias_DrawOpFlag),
+                     SkToBool(flags & kClipPath_DoAntiAlias_DrawOpFlag));
 }
 
 static void clipRegion_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
@@ -153,6 +225,9 @@ static void setMatrix_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                       SkGPipeState* state) {
     SkMatrix matrix;
     SkReadMatrix(reader, &matrix);
+    // the writer's matrix started out as identity, so this is relative to
+    // what the canvas had then (e.g. the translate to a tile)
+    matrix.postConcat(state->baseMatrix());
     canvas->setMatrix(matrix);
 }
 
@@ -245,9 +320,7 @@ static void drawRect_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
 
 static void drawPath_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                         SkGPipeState* state) {
-    SkPath path;
-    path.unflatten(*reader);
-    canvas->drawPath(path, state->paint());
+    canvas->drawPath(state->getPath(DrawOp_unpackData(op32)), state->paint());
 }
 
 static void drawVertices_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
@@ -315,9 +388,7 @@ static void drawTextOnPath_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op3
                               SkGPipeState* state) {
     size_t len = reader->readU32();
     const void* text = reader->skip(SkAlign4(len));
-
-    SkPath path;
-    path.unflatten(*reader);
+    const SkPath& path = state->getPath(DrawOp_unpackData(op32));
 
     SkMatrix matrixStorage;
     const SkMatrix* matrix = NULL;
@@ -331,24 +402,44 @@ static void drawTextOnPath_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op3
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static const SkPaint* getBitmapPaint(uint32_t op32, SkGPipeState* state) {
+    if (DrawOp_unpackFlags(op32) & kDrawBitmap_HasPaint_DrawOpFlag) {
+        return &state->paint();
+    }
+    return NULL;
+}
+
 static void drawBitmap_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                           SkGPipeState* state) {
-    UNIMPLEMENTED
+    const SkScalar* xy = skip<SkScalar>(reader, 2);
+    canvas->drawBitmap(state->getBitmap(DrawOp_unpackData(op32)), xy[0], xy[1],
+                       getBitmapPaint(op32, state));
 }
 
 static void drawBitmapMatrix_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                                 SkGPipeState* state) {
-    UNIMPLEMENTED
+    SkMatrix matrix;
+    SkReadMatrix(reader, &matrix);
+    canvas->drawBitmapMatrix(state->getBitmap(DrawOp_unpackData(op32)), matrix,
+                             getBitmapPaint(op32, state));
 }
 
 static void drawBitmapRect_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                               SkGPipeState* state) {
-    UNIMPLEMENTED
+    const SkIRect* src = NULL;
+    if (DrawOp_unpackFlags(op32) & kDrawBitmap_HasSrcRect_DrawOpFlag) {
+        src = skip<SkIRect>(reader);
+    }
+    const SkRect* dst = skip<SkRect>(reader);
+    canvas->drawBitmapRect(state->getBitmap(DrawOp_unpackData(op32)), src, *dst,
+                           getBitmapPaint(op32, state));
 }
 
 static void drawSprite_rp(SkCanvas* canvas, SkReader32* reader, uint32_t op32,
                           SkGPipeState* state) {
-    UNIMPLEMENTED
+    const int32_t* xy = skip<int32_t>(reader, 2);
+    canvas->drawSprite(state->getBitmap(DrawOp_unpackData(op32)), xy[0], xy[1],
+                       getBitmapPaint(op32, state));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -429,6 +520,22 @@ static void def_PaintFlat_rp(SkCanvas*, SkReader32*, uint32_t op32,
     state->defFlattenable(pf, index);
 }
 
+static void def_Path_rp(SkCanvas*, SkReader32*, uint32_t op32,
+                        SkGPipeState* state) {
+    state->defPath(DrawOp_unpackData(op32));
+}
+
+static void def_Bitmap_rp(SkCanvas*, SkReader32*, uint32_t op32,
+                          SkGPipeState* state) {
+    state->defBitmap(DrawOp_unpackData(op32));
+}
+
+static void evict_rp(SkCanvas*, SkReader32*, uint32_t op32,
+                     SkGPipeState* state) {
+    state->evict((CacheKinds)DrawOp_unpackFlags(op32),
+                 DrawOp_unpackData(op32));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static void skip_rp(SkCanvas*, SkReader32* reader, uint32_t op32, SkGPipeState*) {
@@ -474,6 +581,9 @@ static const ReadProc gReadTable[] = {
     paintOp_rp,
     def_Typeface_rp,
     def_PaintFlat_rp,
+    def_Path_rp,
+    def_Bitmap_rp,
+    evict_rp,
 
     done_rp
 };
@@ -485,6 +595,8 @@ SkGPipeState::SkGPipeState() {}
 SkGPipeState::~SkGPipeState() {
     fTypefaces.safeUnrefAll();
     fFlatArray.safeUnrefAll();
+    fPathArray.deleteAll();
+    fBitmapArray.deleteAll();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -510,6 +622,7 @@ SkGPipeReader::Status SkGPipeReader::playback(const void* data, size_t length,
 
     if (NULL == fState) {
         fState = new SkGPipeState;
+        fState->setBaseMatrix(fCanvas->getTotalMatrix());
     }
 
     SkASSERT(SK_ARRAY_COUNT(gReadTable) == (kDone_DrawOp + 1));
@@ -538,7 +651,10 @@ SkGPipeReader::Status SkGPipeReader::playback(const void* data, size_t length,
         if (readAtom && 
             (table[op] != paintOp_rp &&
              table[op] != def_Typeface_rp &&
-             table[op] != def_PaintFlat_rp
+             table[op] != def_PaintFlat_rp &&
+             table[op] != def_Path_rp &&
+             table[op] != def_Bitmap_rp &&
+             table[op] != evict_rp
              )) {
                 status = kReadAtom_Status;
                 break;
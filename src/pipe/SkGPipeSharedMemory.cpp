@@ -0,0 +1,272 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkGPipeSharedMemory.h"
+
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+#endif
+
+/*  The ring is in the memory after the header.  The writer and reader keep
+    counts of the bytes they have written and read, which only go up (and
+    wrap around 2^32), so a count's position in the ring is the count modulo
+    the capacity, which is a power of two.
+
+    Blocks never cross the end of the ring.  When the writer needs a block
+    that doesn't fit before the end, it skips the rest of the ring, counting
+    the skipped bytes as written, and sets fWrapPending so that the reader
+    skips them too.
+
+    Each side only writes its own count (and fWrapCount/fWrapPending are only
+    written by the side that owns the skipped bytes at the time), so plain
+    stores with memory barriers are enough.  A side that has to wait for the
+    other sleeps on the other's count with a futex.
+ */
+struct SkGPipeSharedMemory::Header {
+    uint32_t fCapacity;
+
+    // Written by the writer.
+    volatile uint32_t fWriteCount;
+    volatile uint32_t fWrapCount;   // fWriteCount where skipped bytes start
+    volatile uint32_t fWrapPending;
+    volatile uint32_t fWriterDone;
+    volatile uint32_t fWriterWaiting;
+    uint32_t fPad0[10];
+
+    // Written by the reader, on its own cache line.
+    volatile uint32_t fReadCount;
+    volatile uint32_t fReaderWaiting;
+    uint32_t fPad1[14];
+};
+
+namespace {
+
+// The writer asks for blocks of at least 16K (see SkGPipeWrite.cpp), so the
+// ring holds a few of them.
+const size_t kMinCapacity = 64 * 1024;
+const size_t kMaxCapacity = 1 << 30;
+
+size_t roundCapacity(size_t capacity) {
+    size_t rounded = kMinCapacity;
+    while (rounded < capacity && rounded < kMaxCapacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+inline void memoryBarrier() {
+    __sync_synchronize();
+}
+
+// Wait until *word is no longer value (or a while has passed, so that the
+// caller can check whether the other side is gone).  waiting is set while
+// this waits, so that the other side knows to wake it.
+void waitForChange(volatile uint32_t* word, uint32_t value,
+                   volatile uint32_t* waiting) {
+    *waiting = 1;
+    memoryBarrier();
+    if (*word == value) {
+#ifdef __linux__
+        struct timespec timeout = { 0, 100 * 1000 * 1000 };
+        syscall(SYS_futex, word, FUTEX_WAIT, value, &timeout, NULL, 0);
+#else
+        struct timespec timeout = { 0, 50 * 1000 };
+        nanosleep(&timeout, NULL);
+#endif
+    }
+    *waiting = 0;
+}
+
+// Called after *word has changed, to wake the other side if it's waiting.
+void wake(volatile uint32_t* word, volatile uint32_t* waiting) {
+    memoryBarrier();
+    if (*waiting) {
+#ifdef __linux__
+        syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkGPipeSharedMemory::MappedSize(size_t capacity) {
+    return sizeof(Header) + roundCapacity(capacity);
+}
+
+SkGPipeSharedMemory* SkGPipeSharedMemory::Create(size_t capacity) {
+    size_t size = MappedSize(capacity);
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == memory) {
+        return NULL;
+    }
+    // Anonymous memory starts out zeroed.
+    static_cast<Header*>(memory)->fCapacity = roundCapacity(capacity);
+    return SkNEW_ARGS(SkGPipeSharedMemory, (memory, size));
+}
+
+SkGPipeSharedMemory* SkGPipeSharedMemory::CreateFromFD(int fd,
+                                                       size_t capacity,
+                                                       bool initialize) {
+    size_t size = MappedSize(capacity);
+    if (initialize && ftruncate(fd, size) != 0) {
+        return NULL;
+    }
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == memory) {
+        return NULL;
+    }
+    Header* header = static_cast<Header*>(memory);
+    if (initialize) {
+        memset(header, 0, sizeof(Header));
+        header->fCapacity = roundCapacity(capacity);
+    } else if (header->fCapacity != roundCapacity(capacity)) {
+        munmap(memory, size);
+        return NULL;
+    }
+    return SkNEW_ARGS(SkGPipeSharedMemory, (memory, size));
+}
+
+SkGPipeSharedMemory::SkGPipeSharedMemory(void* memory, size_t mappedSize)
+    : fHeader(static_cast<Header*>(memory))
+    , fData(static_cast<uint8_t*>(memory) + sizeof(Header))
+    , fMappedSize(mappedSize) {
+}
+
+SkGPipeSharedMemory::~SkGPipeSharedMemory() {
+    munmap(fHeader, fMappedSize);
+}
+
+size_t SkGPipeSharedMemory::capacity() const {
+    return fHeader->fCapacity;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeSharedMemoryController::SkGPipeSharedMemoryController(
+                                                SkGPipeSharedMemory* memory)
+    : fMemory(memory) {
+}
+
+SkGPipeSharedMemoryController::~SkGPipeSharedMemoryController() {
+    SkGPipeSharedMemory::Header* header = fMemory->fHeader;
+    header->fWriterDone = 1;
+    memoryBarrier();
+#ifdef __linux__
+    syscall(SYS_futex, &header->fWriteCount, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+void* SkGPipeSharedMemoryController::requestBlock(size_t minRequest,
+                                                  size_t* actual) {
+    SkGPipeSharedMemory::Header* header = fMemory->fHeader;
+    const uint32_t capacity = header->fCapacity;
+    if (minRequest > capacity) {
+        return NULL;
+    }
+
+    const uint32_t written = header->fWriteCount;
+    const uint32_t position = written & (capacity - 1);
+    const uint32_t toEnd = capacity - position;
+    for (;;) {
+        uint32_t read = header->fReadCount;
+        uint32_t free = capacity - (written - read);
+        if (toEnd < minRequest) {
+            // Skip the rest of the ring once the reader is out of it.
+            if (free >= toEnd) {
+                header->fWrapCount = written;
+                header->fWrapPending = 1;
+                memoryBarrier();
+                header->fWriteCount = written + toEnd;
+                wake(&header->fWriteCount, &header->fReaderWaiting);
+                return this->requestBlock(minRequest, actual);
+            }
+        } else if (free >= minRequest) {
+            memoryBarrier();  // Don't write where the reader is reading.
+            *actual = SkMin32(toEnd, free) & ~3;
+            return fMemory->fData + position;
+        }
+        waitForChange(&header->fReadCount, read, &header->fWriterWaiting);
+    }
+}
+
+void SkGPipeSharedMemoryController::notifyWritten(size_t bytes) {
+    SkGPipeSharedMemory::Header* header = fMemory->fHeader;
+    memoryBarrier();  // The data has to be there before the reader looks.
+    header->fWriteCount = header->fWriteCount + bytes;
+    wake(&header->fWriteCount, &header->fReaderWaiting);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeSharedMemoryReader::SkGPipeSharedMemoryReader(
+                                SkGPipeSharedMemory* memory, SkCanvas* target)
+    : fMemory(memory)
+    , fReader(target)
+    , fStatus(SkGPipeReader::kEOF_Status) {
+}
+
+SkGPipeReader::Status SkGPipeSharedMemoryReader::playback(bool wait) {
+    SkGPipeSharedMemory::Header* header = fMemory->fHeader;
+    const uint32_t capacity = header->fCapacity;
+    while (SkGPipeReader::kEOF_Status == fStatus) {
+        const uint32_t read = header->fReadCount;
+        const uint32_t written = header->fWriteCount;
+        memoryBarrier();  // Read the data after seeing that it's there.
+
+        if (read == written) {
+            if (header->fWriterDone && header->fWriteCount == written) {
+                fStatus = SkGPipeReader::kError_Status;
+            } else if (!wait) {
+                return SkGPipeReader::kEOF_Status;
+            } else {
+                waitForChange(&header->fWriteCount, written,
+                              &header->fReaderWaiting);
+            }
+            continue;
+        }
+
+        const uint32_t position = read & (capacity - 1);
+        size_t bytesRead;
+        if (header->fWrapPending && header->fWrapCount == read) {
+            header->fWrapPending = 0;
+            bytesRead = capacity - position;
+        } else {
+            // The writer only notifies whole atoms, and its blocks end at
+            // the end of the ring (or where it skipped the rest), so this is
+            // whole ops.
+            size_t length = SkMin32(written - read, capacity - position);
+            if (header->fWrapPending &&
+                    header->fWrapCount - read < written - read) {
+                length = header->fWrapCount - read;
+            }
+            fStatus = fReader.playback(fMemory->fData + position, length,
+                                       &bytesRead);
+        }
+        memoryBarrier();  // Done reading before the writer can overwrite it.
+        header->fReadCount = read + bytesRead;
+        wake(&header->fReadCount, &header->fWriterWaiting);
+    }
+    return fStatus;
+}
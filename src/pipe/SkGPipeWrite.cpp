@@ -23,6 +23,7 @@
 #include "SkGPipePriv.h"
 #include "SkStream.h"
 #include "SkTSearch.h"
+#include "SkTextBlob.h"
 #include "SkTypeface.h"
 #include "SkWriter32.h"
 #include "SkColorFilter.h"
@@ -46,22 +47,6 @@ static SkFlattenable* get_paintflat(const SkPaint& paint, unsigned paintFlat) {
     return NULL;
 }
 
-static size_t estimateFlattenSize(const SkPath& path) {
-    int n = path.countPoints();
-    size_t bytes = 3 * sizeof(int32_t);
-    bytes += n * sizeof(SkPoint);
-    bytes += SkAlign4(n + 2);    // verbs: add 2 for move/close extras
-
-#ifdef SK_DEBUG
-    {
-        SkWriter32 writer(1024);
-        path.flatten(writer);
-        SkASSERT(writer.size() <= bytes);
-    }
-#endif
-    return bytes;
-}
-
 static size_t writeTypeface(SkWriter32* writer, SkTypeface* typeface) {
     SkASSERT(typeface);
     SkDynamicMemoryWStream stream;
@@ -77,6 +62,155 @@ static size_t writeTypeface(SkWriter32* writer, SkTypeface* typeface) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ *  Remembers what the writer has defined for the reader, by a key (e.g. the
+ *  flattened data), so that using the same thing again only writes its ID.
+ *  Once the entries cost more than the budget, the least recently used ones
+ *  are evicted (the caller tells the reader to forget them) and their IDs
+ *  reused, so IDs stay small.
+ *
+ *  Each entry remembers the serial of the last op that used it, so that
+ *  nothing an op refers to is evicted before the op is written.
+ */
+class SkGPipeCache {
+public:
+    SkGPipeCache(size_t budget)
+        : fBudget(budget), fBytesUsed(0), fNextID(1) {}
+    ~SkGPipeCache() { fEntries.freeAll(); }
+
+    /**
+     *  Returns the ID of the entry with this key (marking it as used by the
+     *  op with this serial), or 0 if there is none.
+     */
+    uint32_t find(const void* key, size_t keySize, uint32_t serial);
+
+    /**
+     *  Adds an entry for a key that isn't in the cache, which costs cost
+     *  bytes, and returns its ID (always > 0).
+     */
+    uint32_t add(const void* key, size_t keySize, size_t cost,
+                 uint32_t serial);
+
+    /**
+     *  If adding cost more bytes would go over the budget, removes the least
+     *  recently used entry (which the op with this serial doesn't use) and
+     *  returns its ID; otherwise returns 0.
+     */
+    uint32_t evictFor(size_t cost, uint32_t serial);
+
+private:
+    struct Entry {
+        uint32_t    fHash;
+        uint32_t    fKeySize;
+        uint32_t    fID;
+        uint32_t    fCost;
+        uint32_t    fLastUse;
+
+        void*       key() { return (char*)this + sizeof(*this); }
+        const void* key() const { return (const char*)this + sizeof(*this); }
+
+        static int Compare(const Entry* a, const Entry* b) {
+            if (a->fHash != b->fHash) {
+                return a->fHash < b->fHash ? -1 : 1;
+            }
+            if (a->fKeySize != b->fKeySize) {
+                return a->fKeySize < b->fKeySize ? -1 : 1;
+            }
+            return memcmp(a->key(), b->key(), a->fKeySize);
+        }
+    };
+
+    // entries are sorted by Compare
+    int search(const void* key, size_t keySize);
+
+    SkTDArray<Entry*>   fEntries;
+    SkTDArray<uint32_t> fFreeIDs;
+    size_t              fBudget;
+    size_t              fBytesUsed;
+    uint32_t            fNextID;
+};
+
+// keys are written by SkWriter32, so they are a multiple of 4 bytes
+static uint32_t hashKey(const void* key, size_t keySize) {
+    SkASSERT(SkAlign4(keySize) == keySize);
+    const uint32_t* data = (const uint32_t*)key;
+    uint32_t hash = keySize;
+    for (size_t i = 0; i < keySize / 4; ++i) {
+        hash = (hash << 5) + (hash >> 27) + data[i];
+    }
+    return hash;
+}
+
+int SkGPipeCache::search(const void* key, size_t keySize) {
+    SkAutoSMalloc<1024> storage(sizeof(Entry) + keySize);
+    Entry* target = (Entry*)storage.get();
+    target->fHash = hashKey(key, keySize);
+    target->fKeySize = keySize;
+    memcpy(target->key(), key, keySize);
+    return SkTSearch<Entry>((const Entry**)fEntries.begin(), fEntries.count(),
+                            target, sizeof(target), &Entry::Compare);
+}
+
+uint32_t SkGPipeCache::find(const void* key, size_t keySize,
+                            uint32_t serial) {
+    int index = this->search(key, keySize);
+    if (index < 0) {
+        return 0;
+    }
+    fEntries[index]->fLastUse = serial;
+    return fEntries[index]->fID;
+}
+
+uint32_t SkGPipeCache::add(const void* key, size_t keySize, size_t cost,
+                           uint32_t serial) {
+    int index = this->search(key, keySize);
+    SkASSERT(index < 0);
+    index = ~index;
+
+    Entry* entry = (Entry*)sk_malloc_throw(sizeof(Entry) + keySize);
+    entry->fHash = hashKey(key, keySize);
+    entry->fKeySize = keySize;
+    if (fFreeIDs.count() > 0) {
+        fFreeIDs.pop(&entry->fID);
+    } else {
+        entry->fID = fNextID++;
+    }
+    entry->fCost = cost;
+    entry->fLastUse = serial;
+    memcpy(entry->key(), key, keySize);
+    *fEntries.insert(index) = entry;
+    fBytesUsed += cost;
+    return entry->fID;
+}
+
+uint32_t SkGPipeCache::evictFor(size_t cost, uint32_t serial) {
+    if (fBytesUsed + cost <= fBudget) {
+        return 0;
+    }
+    int oldest = -1;
+    uint32_t oldestAge = 0;
+    for (int i = 0; i < fEntries.count(); ++i) {
+        // serials wrap, which at worst makes a very old entry look new
+        uint32_t age = serial - fEntries[i]->fLastUse;
+        if (age > oldestAge) {
+            oldest = i;
+            oldestAge = age;
+        }
+    }
+    if (oldest < 0) {
+        return 0;
+    }
+    Entry* entry = fEntries[oldest];
+    uint32_t id = entry->fID;
+    fBytesUsed -= entry->fCost;
+    *fFreeIDs.append() = id;
+    fEntries.remove(oldest);
+    sk_free(entry);
+    return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 class SkGPipeCanvas : public SkCanvas {
 public:
     SkGPipeCanvas(SkGPipeController*, SkWriter32*, SkFactorySet*);
@@ -84,8 +218,11 @@ public:
 
     void finish() {
         if (!fDone) {
-            this->writeOp(kDone_DrawOp);
-            this->doNotify();
+            // if nothing was drawn there's no block to write into yet
+            if (this->needOpBytes()) {
+                this->writeOp(kDone_DrawOp);
+                this->doNotify();
+            }
             fDone = true;
         }
     }
@@ -101,7 +238,8 @@ public:
     virtual bool concat(const SkMatrix& matrix);
     virtual void setMatrix(const SkMatrix& matrix);
     virtual bool clipRect(const SkRect& rect, SkRegion::Op op);
-    virtual bool clipPath(const SkPath& path, SkRegion::Op op);
+    virtual bool clipPath(const SkPath& path, SkRegion::Op op,
+                          bool doAntiAlias);
     virtual bool clipRegion(const SkRegion& region, SkRegion::Op op);
     virtual void clear(SkColor);
     virtual void drawPaint(const SkPaint& paint);
@@ -123,6 +261,8 @@ public:
                              const SkPoint pos[], const SkPaint&);
     virtual void drawPosTextH(const void* text, size_t byteLength,
                       const SkScalar xpos[], SkScalar constY, const SkPaint&);
+    virtual void drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                      const SkPaint&);
     virtual void drawTextOnPath(const void* text, size_t byteLength, 
                             const SkPath& path, const SkMatrix* matrix, 
                                 const SkPaint&);
@@ -135,7 +275,7 @@ public:
     virtual void drawData(const void*, size_t);
 
 private:
-    SkFactorySet* fFactorySet;  // optional, only used if cross-process
+    SkFactorySet* fFactorySet;  // records the factory names written
     SkGPipeController* fController;
     SkWriter32& fWriter;
     size_t      fBlockSize; // amount allocated for writer
@@ -164,26 +304,29 @@ private:
         }
     }
 
-    struct FlatData {
-        uint32_t    fIndex; // always > 0
-        uint32_t    fSize;
+    // serial of the op being written, which its cache entries are marked
+    // with so that they aren't evicted before it is written
+    uint32_t fUseSerial;
+
+    SkGPipeCache fFlatCache;
+    SkGPipeCache fPathCache;
+    SkGPipeCache fBitmapCache;
+    void evictFrom(SkGPipeCache*, CacheKinds, size_t cost);
 
-        void*       data() { return (char*)this + sizeof(*this); }
-        
-        static int Compare(const FlatData* a, const FlatData* b) {
-            return memcmp(&a->fSize, &b->fSize, a->fSize + sizeof(a->fSize));
-        }
-    };
-    SkTDArray<FlatData*> fFlatArray;
     int fCurrFlatIndex[kCount_PaintFlats];
     int flattenToIndex(SkFlattenable* obj, PaintFlats);
+    uint32_t getPathID(const SkPath&);
+    uint32_t getBitmapID(const SkBitmap&);
+    int writeBitmapAndPaint(const SkBitmap&, const SkPaint*, uint32_t* id);
 
     SkPaint fPaint;
     void writePaint(const SkPaint&);
 
     class AutoPipeNotify {
     public:
-        AutoPipeNotify(SkGPipeCanvas* canvas) : fCanvas(canvas) {}
+        AutoPipeNotify(SkGPipeCanvas* canvas) : fCanvas(canvas) {
+            canvas->fUseSerial += 1;
+        }
         ~AutoPipeNotify() { fCanvas->doNotify(); }
     private:
         SkGPipeCanvas* fCanvas;
@@ -193,6 +336,26 @@ private:
     typedef SkCanvas INHERITED;
 };
 
+// Write the ops that make the reader forget what has to go from the cache
+// before something that costs cost bytes is added to it.
+void SkGPipeCanvas::evictFrom(SkGPipeCache* cache, CacheKinds kind,
+                              size_t cost) {
+    uint32_t id;
+    while ((id = cache->evictFor(cost, fUseSerial)) != 0) {
+        if (kFlattenable_CacheKind == kind) {
+            // the ID may be reused, so don't assume the reader's paint has it
+            for (int i = 0; i < kCount_PaintFlats; i++) {
+                if (fCurrFlatIndex[i] == (int)id) {
+                    fCurrFlatIndex[i] = -1;
+                }
+            }
+        }
+        if (this->needOpBytes()) {
+            this->writeOp(kEvict_DrawOp, kind, id);
+        }
+    }
+}
+
 // return 0 for NULL (or unflattenable obj), or index-base-1
 int SkGPipeCanvas::flattenToIndex(SkFlattenable* obj, PaintFlats paintflat) {
     if (NULL == obj) {
@@ -205,44 +368,111 @@ int SkGPipeCanvas::flattenToIndex(SkFlattenable* obj, PaintFlats paintflat) {
 
     tmpWriter.writeFlattenable(obj);
     size_t len = tmpWriter.size();
-    size_t allocSize = len + sizeof(FlatData);
+    SkAutoSMalloc<1024> storage(len);
+    tmpWriter.flatten(storage.get());
 
-    SkAutoSMalloc<1024> storage(allocSize);
-    FlatData* flat = (FlatData*)storage.get();
-    flat->fSize = len;
-    tmpWriter.flatten(flat->data());
+    uint32_t id = fFlatCache.find(storage.get(), len, fUseSerial);
+    if (0 == id) {
+        this->evictFrom(&fFlatCache, kFlattenable_CacheKind, len);
+        id = fFlatCache.add(storage.get(), len, len, fUseSerial);
+//        SkDebugf("--- add flattenable[%d] size=%d index=%d\n", paintflat, len, id);
 
-    int index = SkTSearch<FlatData>((const FlatData**)fFlatArray.begin(),
-                                    fFlatArray.count(), flat, sizeof(flat),
-                                    &FlatData::Compare);
-    if (index < 0) {
-        index = ~index;
-        FlatData* copy = (FlatData*)sk_malloc_throw(allocSize);
-        memcpy(copy, flat, allocSize);
-        *fFlatArray.insert(index) = copy;
-        // call this after the insert, so that count() will have been grown
-        copy->fIndex = fFlatArray.count();
-//        SkDebugf("--- add flattenable[%d] size=%d index=%d\n", paintflat, len, copy->fIndex);
+        if (this->needOpBytes(len)) {
+            this->writeOp(kDef_Flattenable_DrawOp, paintflat, id);
+            fWriter.write(storage.get(), len);
+        }
+    }
+    return id;
+}
 
+// return the ID of the path, defining it if the reader doesn't have it
+uint32_t SkGPipeCanvas::getPathID(const SkPath& path) {
+    // most paths fit in the storage, and so need no copying to be the key
+    uint32_t storage[256];
+    SkWriter32 tmpWriter(1024, storage, sizeof(storage));
+    path.flatten(tmpWriter);
+    size_t len = tmpWriter.size();
+    SkAutoMalloc flatStorage;
+    const void* flat = tmpWriter.contiguousArray();
+    if (NULL == flat) {
+        tmpWriter.flatten(flatStorage.alloc(len));
+        flat = flatStorage.get();
+    }
+
+    uint32_t id = fPathCache.find(flat, len, fUseSerial);
+    if (0 == id) {
+        this->evictFrom(&fPathCache, kPath_CacheKind, len);
+        id = fPathCache.add(flat, len, len, fUseSerial);
         if (this->needOpBytes(len)) {
-            this->writeOp(kDef_Flattenable_DrawOp, paintflat, copy->fIndex);
-            fWriter.write(copy->data(), len);
+            this->writeOp(kDef_Path_DrawOp, 0, id);
+            fWriter.write(flat, len);
         }
     }
-    return fFlatArray[index]->fIndex;
+    return id;
+}
+
+// return the ID of the bitmap, defining it if the reader doesn't have it, or
+// 0 if it has no pixels to draw
+uint32_t SkGPipeCanvas::getBitmapID(const SkBitmap& bitmap) {
+    // the same pixels (and part of them) have the same generation ID
+    uint32_t key[6];
+    key[0] = bitmap.getGenerationID();
+    key[1] = bitmap.pixelRefOffset();
+    key[2] = bitmap.width();
+    key[3] = bitmap.height();
+    key[4] = bitmap.rowBytes();
+    key[5] = bitmap.config();
+
+    uint32_t id = fBitmapCache.find(key, sizeof(key), fUseSerial);
+    if (0 == id) {
+        SkAutoLockPixels alp(bitmap);
+        if (NULL == bitmap.getPixels()) {
+            return 0;
+        }
+
+        // always send the pixels, since the reader can't share a pixelref
+        // with the writer (or know when the writer is done with one)
+        SkBitmap pixels;
+        pixels.setConfig(bitmap.config(), bitmap.width(), bitmap.height(),
+                         bitmap.rowBytes());
+        pixels.setPixels(bitmap.getPixels(), bitmap.getColorTable());
+        pixels.setIsOpaque(bitmap.isOpaque());
+
+        SkFlattenableWriteBuffer tmpWriter(1024);
+        tmpWriter.setFlags(SkFlattenableWriteBuffer::kCrossProcess_Flag);
+        pixels.flatten(tmpWriter);
+        size_t len = tmpWriter.size();
+
+        this->evictFrom(&fBitmapCache, kBitmap_CacheKind, len);
+        id = fBitmapCache.add(key, sizeof(key), len, fUseSerial);
+        if (this->needOpBytes(len)) {
+            this->writeOp(kDef_Bitmap_DrawOp, 0, id);
+            tmpWriter.flatten(fWriter.reserve(len));
+        }
+    }
+    return id;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 #define MIN_BLOCK_SIZE  (16 * 1024)
 
+// how many bytes of flattened data each cache holds before it evicts
+#define FLAT_CACHE_BUDGET       (1024 * 1024)
+#define PATH_CACHE_BUDGET       (1024 * 1024)
+#define BITMAP_CACHE_BUDGET     (8 * 1024 * 1024)
+
 SkGPipeCanvas::SkGPipeCanvas(SkGPipeController* controller,
                              SkWriter32* writer, SkFactorySet* fset)
-        : fWriter(*writer) {
+        : fWriter(*writer)
+        , fFlatCache(FLAT_CACHE_BUDGET)
+        , fPathCache(PATH_CACHE_BUDGET)
+        , fBitmapCache(BITMAP_CACHE_BUDGET) {
     fFactorySet = fset;
     fController = controller;
     fDone = false;
     fBlockSize = 0; // need first block from controller
+    fUseSerial = 0;
     sk_bzero(fCurrFlatIndex, sizeof(fCurrFlatIndex));
 
     // we need a device to limit our clip
@@ -256,8 +486,6 @@ SkGPipeCanvas::SkGPipeCanvas(SkGPipeController* controller,
 
 SkGPipeCanvas::~SkGPipeCanvas() {
     this->finish();
-
-    fFlatArray.freeAll();
 }
 
 bool SkGPipeCanvas::needOpBytes(size_t needed) {
@@ -267,7 +495,15 @@ bool SkGPipeCanvas::needOpBytes(size_t needed) {
 
     needed += 4;  // size of DrawOp atom
     if (fWriter.size() + needed > fBlockSize) {
-        void* block = fController->requestBlock(MIN_BLOCK_SIZE, &fBlockSize);
+        // Pass on what's been written to this block (e.g. the paint ops of
+        // the current draw) before moving to the next one.
+        if (fWriter.size() > fBytesNotified) {
+            this->doNotify();
+        }
+        // Ask for enough room for this op, so it isn't written outside of
+        // the controller's block.
+        size_t blockSize = SkMax32(MIN_BLOCK_SIZE, SkAlign4(needed));
+        void* block = fController->requestBlock(blockSize, &fBlockSize);
         if (NULL == block) {
             fDone = true;
             return false;
@@ -417,11 +653,16 @@ bool SkGPipeCanvas::clipRect(const SkRect& rect, SkRegion::Op rgnOp) {
     return this->INHERITED::clipRect(rect, rgnOp);
 }
 
-bool SkGPipeCanvas::clipPath(const SkPath& path, SkRegion::Op rgnOp) {
+bool SkGPipeCanvas::clipPath(const SkPath& path, SkRegion::Op rgnOp,
+                             bool doAntiAlias) {
     NOTIFY_SETUP(this);
-    if (this->needOpBytes(estimateFlattenSize(path))) {
-        this->writeOp(kClipPath_DrawOp, 0, rgnOp);
-        path.flatten(fWriter);
+    uint32_t id = this->getPathID(path);
+    if (this->needOpBytes()) {
+        unsigned flags = rgnOp;
+        if (doAntiAlias) {
+            flags |= kClipPath_DoAntiAlias_DrawOpFlag;
+        }
+        this->writeOp(kClipPath_DrawOp, flags, id);
     }
     // we just pass on the bounds of the path
     return this->INHERITED::clipRect(path.getBounds(), rgnOp);
@@ -485,30 +726,84 @@ void SkGPipeCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
 void SkGPipeCanvas::drawPath(const SkPath& path, const SkPaint& paint) {
     NOTIFY_SETUP(this);
     this->writePaint(paint);
-    if (this->needOpBytes(estimateFlattenSize(path))) {
-        this->writeOp(kDrawPath_DrawOp);
-        path.flatten(fWriter);
+    uint32_t id = this->getPathID(path);
+    if (this->needOpBytes()) {
+        this->writeOp(kDrawPath_DrawOp, 0, id);
     }
 }
 
-void SkGPipeCanvas::drawBitmap(const SkBitmap&, SkScalar left, SkScalar top,
-                                   const SkPaint*) {
-    UNIMPLEMENTED
+// write the paint (if any) and the bitmap for a drawBitmap op, returning the
+// op's flags, or -1 if there is nothing to draw
+int SkGPipeCanvas::writeBitmapAndPaint(const SkBitmap& bitmap,
+                                       const SkPaint* paint, uint32_t* id) {
+    *id = this->getBitmapID(bitmap);
+    if (0 == *id) {
+        return -1;
+    }
+    unsigned flags = 0;
+    if (paint) {
+        flags |= kDrawBitmap_HasPaint_DrawOpFlag;
+        this->writePaint(*paint);
+    }
+    return flags;
 }
 
-void SkGPipeCanvas::drawBitmapRect(const SkBitmap&, const SkIRect* src,
-                                       const SkRect& dst, const SkPaint*) {
-    UNIMPLEMENTED
+void SkGPipeCanvas::drawBitmap(const SkBitmap& bitmap, SkScalar left,
+                               SkScalar top, const SkPaint* paint) {
+    NOTIFY_SETUP(this);
+    uint32_t id;
+    int flags = this->writeBitmapAndPaint(bitmap, paint, &id);
+    if (flags >= 0 && this->needOpBytes(2 * sizeof(SkScalar))) {
+        this->writeOp(kDrawBitmap_DrawOp, flags, id);
+        fWriter.writeScalar(left);
+        fWriter.writeScalar(top);
+    }
 }
 
-void SkGPipeCanvas::drawBitmapMatrix(const SkBitmap&, const SkMatrix&,
-                                         const SkPaint*) {
-    UNIMPLEMENTED
+void SkGPipeCanvas::drawBitmapRect(const SkBitmap& bitmap, const SkIRect* src,
+                                   const SkRect& dst, const SkPaint* paint) {
+    NOTIFY_SETUP(this);
+    uint32_t id;
+    int flags = this->writeBitmapAndPaint(bitmap, paint, &id);
+    if (flags < 0) {
+        return;
+    }
+    size_t size = sizeof(SkRect);
+    if (src) {
+        flags |= kDrawBitmap_HasSrcRect_DrawOpFlag;
+        size += sizeof(SkIRect);
+    }
+    if (this->needOpBytes(size)) {
+        this->writeOp(kDrawBitmapRect_DrawOp, flags, id);
+        if (src) {
+            fWriter.write(src, sizeof(SkIRect));
+        }
+        fWriter.writeRect(dst);
+    }
+}
+
+void SkGPipeCanvas::drawBitmapMatrix(const SkBitmap& bitmap,
+                                     const SkMatrix& matrix,
+                                     const SkPaint* paint) {
+    NOTIFY_SETUP(this);
+    uint32_t id;
+    int flags = this->writeBitmapAndPaint(bitmap, paint, &id);
+    if (flags >= 0 && this->needOpBytes(matrix.flatten(NULL))) {
+        this->writeOp(kDrawBitmapMatrix_DrawOp, flags, id);
+        SkWriteMatrix(&fWriter, matrix);
+    }
 }
 
-void SkGPipeCanvas::drawSprite(const SkBitmap&, int left, int top,
-                                   const SkPaint*) {
-    UNIMPLEMENTED
+void SkGPipeCanvas::drawSprite(const SkBitmap& bitmap, int left, int top,
+                               const SkPaint* paint) {
+    NOTIFY_SETUP(this);
+    uint32_t id;
+    int flags = this->writeBitmapAndPaint(bitmap, paint, &id);
+    if (flags >= 0 && this->needOpBytes(2 * sizeof(int32_t))) {
+        this->writeOp(kDrawSprite_DrawOp, flags, id);
+        fWriter.write32(left);
+        fWriter.write32(top);
+    }
 }
 
 void SkGPipeCanvas::drawText(const void* text, size_t byteLength, SkScalar x, 
@@ -542,6 +837,11 @@ void SkGPipeCanvas::drawPosText(const void* text, size_t byteLength,
     }
 }
 
+void SkGPipeCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x,
+                                 SkScalar y, const SkPaint& paint) {
+    blob->drawAsPosText(this, x, y, paint);
+}
+
 void SkGPipeCanvas::drawPosTextH(const void* text, size_t byteLength,
                                  const SkScalar xpos[], SkScalar constY,
                                  const SkPaint& paint) {
@@ -566,19 +866,19 @@ void SkGPipeCanvas::drawTextOnPath(const void* text, size_t byteLength,
     if (byteLength) {
         NOTIFY_SETUP(this);
         unsigned flags = 0;
-        size_t size = 4 + SkAlign4(byteLength) + estimateFlattenSize(path);
+        size_t size = 4 + SkAlign4(byteLength);
         if (matrix) {
             flags |= kDrawTextOnPath_HasMatrix_DrawOpFlag;
             size += matrix->flatten(NULL);
         }
         this->writePaint(paint);
+        uint32_t id = this->getPathID(path);
         if (this->needOpBytes(size)) {
-            this->writeOp(kDrawTextOnPath_DrawOp, flags, 0);
+            this->writeOp(kDrawTextOnPath_DrawOp, flags, id);
 
             fWriter.write32(byteLength);
             fWriter.writePad(text, byteLength);
 
-            path.flatten(fWriter);
             if (matrix) {
                 SkWriteMatrix(&fWriter, *matrix);
             }
@@ -738,7 +1038,7 @@ void SkGPipeCanvas::writePaint(const SkPaint& paint) {
 
     for (int i = 0; i < kCount_PaintFlats; i++) {
         int index = this->flattenToIndex(get_paintflat(paint, i), (PaintFlats)i);
-        SkASSERT(index >= 0 && index <= fFlatArray.count());
+        SkASSERT(index >= 0);
         if (index != fCurrFlatIndex[i]) {
             *ptr++ = PaintOp_packOpFlagData(kFlatIndex_PaintOp, i, index);
             fCurrFlatIndex[i] = index;
@@ -773,9 +1073,10 @@ SkCanvas* SkGPipeWriter::startRecording(SkGPipeController* controller,
     if (NULL == fCanvas) {
         fWriter.reset(NULL, 0);
         fFactorySet.reset();
+        // SkGPipeReader always expects factory names (or their indices),
+        // even in the same process, so always write them
         fCanvas = SkNEW_ARGS(SkGPipeCanvas, (controller, &fWriter,
-                                             (flags & kCrossProcess_Flag) ?
-                                             &fFactorySet : NULL));
+                                             &fFactorySet));
     }
     return fCanvas;
 }
@@ -0,0 +1,46 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkDiscardableMemory.h"
+
+// nothing is ever discarded
+
+SkDiscardableMemory::SkDiscardableMemory(void* addr, size_t size)
+        : fAddr(addr), fSize(size), fPortData(NULL), fLocked(true) {}
+
+SkDiscardableMemory::~SkDiscardableMemory() {
+    sk_free(fAddr);
+}
+
+SkDiscardableMemory* SkDiscardableMemory::Create(size_t size) {
+    void* addr = sk_malloc_flags(size, 0);
+    if (NULL == addr) {
+        return NULL;
+    }
+    return SkNEW_ARGS(SkDiscardableMemory, (addr, size));
+}
+
+bool SkDiscardableMemory::lock() {
+    SkASSERT(!fLocked);
+    fLocked = true;
+    return true;
+}
+
+void SkDiscardableMemory::unlock() {
+    SkASSERT(fLocked);
+    fLocked = false;
+}
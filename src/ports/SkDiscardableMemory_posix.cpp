@@ -0,0 +1,134 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkDiscardableMemory.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_ANONYMOUS
+    #define MAP_ANONYMOUS   MAP_ANON
+#endif
+
+/*  unlock() hands the pages to madvise(MADV_FREE), which lets the kernel drop
+    them rather than swap them out; a dropped page reads back as zeros, and
+    writing to a page takes it back. madvise can't say which pages were
+    dropped, so before that the first word of each page is set aside, and
+    replaced with a non-zero canary. lock() swaps each canary back for the
+    saved word with a compare-and-swap, which (being a write) also takes the
+    page back, or else finds a zero where the canary was.
+
+    Where there is no MADV_FREE (or the kernel doesn't know it), the pages
+    are kept.
+ */
+
+static const uint32_t kCanary = 0xDEADBEEF;
+
+namespace {
+
+struct Pages {
+    uint32_t*   fSaved;     // the first word of each page
+    size_t      fPageSize;
+    size_t      fCount;
+    bool        fFreed;     // true if the last unlock() called madvise
+};
+
+}
+
+static uint32_t* page_word(void* addr, const Pages* pages, size_t index) {
+    return (uint32_t*)((char*)addr + index * pages->fPageSize);
+}
+
+SkDiscardableMemory::SkDiscardableMemory(void* addr, size_t size)
+        : fAddr(addr), fSize(size), fPortData(NULL), fLocked(true) {
+#ifdef MADV_FREE
+    Pages* pages = SkNEW(Pages);
+    pages->fPageSize = getpagesize();
+    pages->fCount = size / pages->fPageSize;
+    pages->fSaved = (uint32_t*)sk_malloc_throw(pages->fCount *
+                                               sizeof(uint32_t));
+    pages->fFreed = false;
+    fPortData = pages;
+#endif
+}
+
+SkDiscardableMemory::~SkDiscardableMemory() {
+    munmap(fAddr, fSize);
+    Pages* pages = (Pages*)fPortData;
+    if (pages) {
+        sk_free(pages->fSaved);
+        SkDELETE(pages);
+    }
+}
+
+SkDiscardableMemory* SkDiscardableMemory::Create(size_t size) {
+    const size_t mask = getpagesize() - 1;
+    size = (size + mask) & ~mask;
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == addr) {
+        return NULL;
+    }
+    return SkNEW_ARGS(SkDiscardableMemory, (addr, size));
+}
+
+bool SkDiscardableMemory::lock() {
+    SkASSERT(!fLocked);
+    fLocked = true;
+
+    Pages* pages = (Pages*)fPortData;
+    if (NULL == pages || !pages->fFreed) {
+        return true;
+    }
+    pages->fFreed = false;
+    bool intact = true;
+    for (size_t i = 0; i < pages->fCount; i++) {
+        if (!__sync_bool_compare_and_swap(page_word(fAddr, pages, i), kCanary,
+                                          pages->fSaved[i])) {
+            intact = false;
+        }
+    }
+    return intact;
+}
+
+void SkDiscardableMemory::unlock() {
+    SkASSERT(fLocked);
+    fLocked = false;
+
+#ifdef MADV_FREE
+    Pages* pages = (Pages*)fPortData;
+    if (NULL == pages) {
+        return;
+    }
+    for (size_t i = 0; i < pages->fCount; i++) {
+        uint32_t* word = page_word(fAddr, pages, i);
+        pages->fSaved[i] = *word;
+        *word = kCanary;
+    }
+    if (0 == madvise(fAddr, fSize, MADV_FREE)) {
+        pages->fFreed = true;
+    } else {
+        // the kernel is older than its headers; don't try again
+        for (size_t i = 0; i < pages->fCount; i++) {
+            *page_word(fAddr, pages, i) = pages->fSaved[i];
+        }
+        sk_free(pages->fSaved);
+        SkDELETE(pages);
+        fPortData = NULL;
+    }
+#endif
+}
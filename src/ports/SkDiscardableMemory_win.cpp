@@ -0,0 +1,60 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkDiscardableMemory.h"
+
+#include <windows.h>
+
+/*  MEM_RESET lets the OS drop the pages instead of paging them out, and
+    MEM_RESET_UNDO (Windows 8 and later) takes them back, failing if they were
+    already dropped. Without MEM_RESET_UNDO there is no telling, so the
+    memory is simply kept.
+ */
+
+SkDiscardableMemory::SkDiscardableMemory(void* addr, size_t size)
+        : fAddr(addr), fSize(size), fPortData(NULL), fLocked(true) {}
+
+SkDiscardableMemory::~SkDiscardableMemory() {
+    VirtualFree(fAddr, 0, MEM_RELEASE);
+}
+
+SkDiscardableMemory* SkDiscardableMemory::Create(size_t size) {
+    void* addr = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT,
+                              PAGE_READWRITE);
+    if (NULL == addr) {
+        return NULL;
+    }
+    return SkNEW_ARGS(SkDiscardableMemory, (addr, size));
+}
+
+bool SkDiscardableMemory::lock() {
+    SkASSERT(!fLocked);
+    fLocked = true;
+#ifdef MEM_RESET_UNDO
+    return NULL != VirtualAlloc(fAddr, fSize, MEM_RESET_UNDO, PAGE_READWRITE);
+#else
+    return true;
+#endif
+}
+
+void SkDiscardableMemory::unlock() {
+    SkASSERT(fLocked);
+    fLocked = false;
+#ifdef MEM_RESET_UNDO
+    VirtualAlloc(fAddr, fSize, MEM_RESET, PAGE_READWRITE);
+#endif
+}
@@ -27,8 +27,10 @@
 #include "SkScalerContext.h"
 #include "SkStream.h"
 #include "SkString.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkThread.h"
+#include "SkUtils.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -124,15 +126,32 @@ InitFreetype() {
     return true;
 }
 
+// call these inside gFTMutex; each user of gFTLibrary holds a reference
+static void ref_ft_library() {
+    if (gFTCount == 0) {
+        if (!InitFreetype()) {
+            sk_throw();
+        }
+    }
+    ++gFTCount;
+}
+
+static void unref_ft_library() {
+    SkASSERT(gFTCount > 0);
+    if (--gFTCount == 0) {
+//        SkDEBUGF(("FT_Done_FreeType\n"));
+        FT_Done_FreeType(gFTLibrary);
+        SkDEBUGCODE(gFTLibrary = NULL;)
+    }
+}
+
 class SkScalerContext_FreeType : public SkScalerContext {
 public:
     SkScalerContext_FreeType(const SkDescriptor* desc);
     virtual ~SkScalerContext_FreeType();
 
     bool success() const {
-        return fFaceRec != NULL &&
-               fFTSize != NULL &&
-               fFace != NULL;
+        return fFaceRec != NULL && fSizeOK;
     }
 
 protected:
@@ -147,13 +166,28 @@ protected:
     virtual SkUnichar generateGlyphToChar(uint16_t glyph);
 
 private:
-    SkFaceRec*  fFaceRec;
-    FT_Face     fFace;              // reference to shared face in gFaceRecHead
-    FT_Size     fFTSize;            // our own copy
+    SkFaceRec*  fFaceRec;           // the shared font data in gFaceRecHead
+    FT_Face     fFace;              // borrowed from fFaceRec, inside AutoFace
     SkFixed     fScaleX, fScaleY;
     FT_Matrix   fMatrix22;
     uint32_t    fLoadGlyphFlags;
+    bool        fSizeOK;
 
+    // borrows a face with our size and transform on it, for one call
+    class AutoFace {
+    public:
+        AutoFace(SkScalerContext_FreeType* ctx) : fCtx(ctx) {
+            fErr = ctx->lockFace();
+        }
+        ~AutoFace() { fCtx->unlockFace(); }
+        FT_Error error() const { return fErr; }
+    private:
+        SkScalerContext_FreeType*   fCtx;
+        FT_Error                    fErr;
+    };
+
+    FT_Error lockFace();
+    void unlockFace();
     FT_Error setupSize();
     void emboldenOutline(FT_Outline* outline);
 };
@@ -163,21 +197,6 @@ private:
 
 #include "SkStream.h"
 
-struct SkFaceRec {
-    SkFaceRec*      fNext;
-    FT_Face         fFace;
-    FT_StreamRec    fFTStream;
-    SkStream*       fSkStream;
-    uint32_t        fRefCnt;
-    uint32_t        fFontID;
-
-    // assumes ownership of the stream, will call unref() when its done
-    SkFaceRec(SkStream* strm, uint32_t fontID);
-    ~SkFaceRec() {
-        fSkStream->unref();
-    }
-};
-
 extern "C" {
     static unsigned long sk_stream_read(FT_Stream       stream,
                                         unsigned long   offset,
@@ -209,26 +228,208 @@ extern "C" {
     static void sk_stream_close( FT_Stream stream) {}
 }
 
-SkFaceRec::SkFaceRec(SkStream* strm, uint32_t fontID)
-        : fSkStream(strm), fFontID(fontID) {
+/*  A face record holds the bytes of one font file, and a face over them for
+    the typeface-level queries (which must hold gFTMutex to use it). Scaler
+    contexts borrow other faces over the same bytes from the record's spares
+    for each call, opening another if none is free, so a face is only ever
+    used by one thread, and contexts can load and render glyphs on different
+    threads at the same time. A spare remembers the context whose size and
+    transform are on it, which gets it back first; so there are only as many
+    faces as are in use at once, and a context running alone never has to set
+    up its size again. Only opening and closing faces touch the library, and
+    those stay inside gFTMutex.
+
+    Fonts normally come to us memory mapped, so all those faces share the
+    mapping; a stream without a memory base is read into memory once, here.
+    Records are found by file and face index where the port can tell us those,
+    so the typefaces of one file (e.g. its styles under fontconfig) share one
+    record. A record no one uses is kept for a while, most recently used
+    first in gFaceRecHead, and keeps a few of the faces its contexts were
+    done with, so that strikes which come and go don't map and parse their
+    font again each time.
+ */
+struct SkFaceRec {
+    SkFaceRec*      fNext;
+    FT_Face         fFace;
+    SkStream*       fSkStream;
+    const void*     fData;
+    size_t          fSize;
+    SkString        fPath;          // empty if the port didn't give us one
+    int32_t         fFaceIndex;
+    uint32_t        fRefCnt;
+    uint32_t        fFontID;        // the first font to use this record
+
+    struct SpareFace {
+        FT_Face     fFace;
+        const void* fOwner;         // whose size is set up on it, or NULL
+    };
+    SkMutex         fSpareMutex;    // never held while taking gFTMutex
+    SkTDArray<SpareFace> fSpareFaces;
+
+    // assumes ownership of the stream, will call unref() when its done
+    SkFaceRec(SkStream* strm, uint32_t fontID, const SkString& path,
+              int32_t faceIndex);
+    ~SkFaceRec() {
+        if (fData != fSkStream->getMemoryBase()) {
+            sk_free((void*)fData);
+        }
+        fSkStream->unref();
+    }
+
+    FT_Error openFace(FT_Face* face) const;
+
+    // Takes a spare face, preferably owner's (then sized is set to true).
+    // Returns false if there are none.
+    bool takeSpareFace(const void* owner, FT_Face* face, bool* sized);
+    // Keeps the face as a spare, or closes it if we have enough
+    void giveBackFace(FT_Face face, const void* owner);
+    // call this inside gFTMutex, when owner goes away
+    void forgetOwner(const void* owner);
+};
+
+SkFaceRec::SkFaceRec(SkStream* strm, uint32_t fontID, const SkString& path,
+                     int32_t faceIndex)
+        : fFace(NULL), fSkStream(strm), fPath(path), fFaceIndex(faceIndex),
+          fFontID(fontID) {
 //    SkDEBUGF(("SkFaceRec: opening %s (%p)\n", key.c_str(), strm));
 
-    sk_bzero(&fFTStream, sizeof(fFTStream));
-    fFTStream.size = fSkStream->getLength();
-    fFTStream.descriptor.pointer = fSkStream;
-    fFTStream.read  = sk_stream_read;
-    fFTStream.close = sk_stream_close;
+    fSize = fSkStream->getLength();
+    fData = fSkStream->getMemoryBase();
+    if (NULL == fData) {
+        void* data = sk_malloc_throw(fSize);
+        if (!fSkStream->rewind() || fSkStream->read(data, fSize) != fSize) {
+            fSize = 0;
+        }
+        fData = data;
+    }
+}
+
+// call this inside gFTMutex
+FT_Error SkFaceRec::openFace(FT_Face* face) const {
+    FT_Open_Args    args;
+    memset(&args, 0, sizeof(args));
+    args.flags = FT_OPEN_MEMORY;
+    args.memory_base = (const FT_Byte*)fData;
+    args.memory_size = fSize;
+    return FT_Open_Face(gFTLibrary, &args, fFaceIndex, face);
+}
+
+// how many faces a record keeps for its contexts
+static const int kMaxSpareFaces = 4;
+
+bool SkFaceRec::takeSpareFace(const void* owner, FT_Face* face, bool* sized) {
+    SkAutoMutexAcquire  ac(fSpareMutex);
+
+    int count = fSpareFaces.count();
+    if (0 == count) {
+        return false;
+    }
+    int index = count - 1;
+    for (int i = 0; i < count; i++) {
+        if (fSpareFaces[i].fOwner == owner) {
+            index = i;
+            break;
+        }
+    }
+    *face = fSpareFaces[index].fFace;
+    *sized = fSpareFaces[index].fOwner == owner;
+    fSpareFaces.removeShuffle(index);
+    return true;
+}
+
+void SkFaceRec::giveBackFace(FT_Face face, const void* owner) {
+    {
+        SkAutoMutexAcquire  ac(fSpareMutex);
+        if (fSpareFaces.count() < kMaxSpareFaces) {
+            SpareFace* spare = fSpareFaces.append();
+            spare->fFace = face;
+            spare->fOwner = owner;
+            return;
+        }
+    }
+    SkAutoMutexAcquire  ac(gFTMutex);
+    FT_Done_Face(face);
+}
+
+void SkFaceRec::forgetOwner(const void* owner) {
+    SkAutoMutexAcquire  ac(fSpareMutex);
+    for (int i = 0; i < fSpareFaces.count(); i++) {
+        if (fSpareFaces[i].fOwner == owner) {
+            fSpareFaces[i].fOwner = NULL;
+        }
+    }
+}
+
+// how many unused records we keep open
+static const int kMaxIdleFaceRecs = 8;
+static int gIdleFaceRecCount;
+
+static void move_to_head(SkFaceRec* rec, SkFaceRec* prev) {
+    if (prev) {
+        prev->fNext = rec->fNext;
+        rec->fNext = gFaceRecHead;
+        gFaceRecHead = rec;
+    }
+}
+
+// closes the least recently used idle records, until there are only keep
+static void purge_idle_faces(int keep) {
+    while (gIdleFaceRecCount > keep) {
+        SkFaceRec*  rec = gFaceRecHead;
+        SkFaceRec*  prev = NULL;
+        SkFaceRec*  last = NULL;
+        SkFaceRec*  lastPrev = NULL;
+        while (rec) {
+            if (0 == rec->fRefCnt) {
+                last = rec;
+                lastPrev = prev;
+            }
+            prev = rec;
+            rec = rec->fNext;
+        }
+        SkASSERT(last);
+        if (lastPrev) {
+            lastPrev->fNext = last->fNext;
+        } else {
+            gFaceRecHead = last->fNext;
+        }
+        gIdleFaceRecCount -= 1;
+        for (int i = 0; i < last->fSpareFaces.count(); i++) {
+            FT_Done_Face(last->fSpareFaces[i].fFace);
+        }
+        FT_Done_Face(last->fFace);
+        SkDELETE(last);
+        unref_ft_library();
+    }
 }
 
 // Will return 0 on failure
 static SkFaceRec* ref_ft_face(uint32_t fontID) {
-    SkFaceRec* rec = gFaceRecHead;
+    SkString    path;
+    int32_t     faceIndex = 0;
+    size_t length = SkFontHost::GetFileName(fontID, NULL, 0, NULL);
+    if (length > 0) {
+        SkAutoSTMalloc<256, char> storage(length);
+        length = SkFontHost::GetFileName(fontID, storage.get(), length,
+                                         &faceIndex);
+        path.set(storage.get(), length);
+    }
+
+    SkFaceRec*  rec = gFaceRecHead;
+    SkFaceRec*  prev = NULL;
     while (rec) {
-        if (rec->fFontID == fontID) {
+        if (rec->fFontID == fontID ||
+                (!path.isEmpty() && rec->fFaceIndex == faceIndex &&
+                 rec->fPath.equals(path))) {
             SkASSERT(rec->fFace);
+            if (0 == rec->fRefCnt) {
+                gIdleFaceRecCount -= 1;
+            }
             rec->fRefCnt += 1;
+            move_to_head(rec, prev);
             return rec;
         }
+        prev = rec;
         rec = rec->fNext;
     }
 
@@ -239,31 +440,15 @@ static SkFaceRec* ref_ft_face(uint32_t fontID) {
     }
 
     // this passes ownership of strm to the rec
-    rec = SkNEW_ARGS(SkFaceRec, (strm, fontID));
-
-    FT_Open_Args    args;
-    memset(&args, 0, sizeof(args));
-    const void* memoryBase = strm->getMemoryBase();
-
-    if (NULL != memoryBase) {
-//printf("mmap(%s)\n", keyString.c_str());
-        args.flags = FT_OPEN_MEMORY;
-        args.memory_base = (const FT_Byte*)memoryBase;
-        args.memory_size = strm->getLength();
-    } else {
-//printf("fopen(%s)\n", keyString.c_str());
-        args.flags = FT_OPEN_STREAM;
-        args.stream = &rec->fFTStream;
-    }
-
-    int face_index;
-    int length = SkFontHost::GetFileName(fontID, NULL, 0, &face_index);
-    FT_Error err = FT_Open_Face(gFTLibrary, &args, length ? face_index : 0,
-                                &rec->fFace);
+    rec = SkNEW_ARGS(SkFaceRec, (strm, fontID, path, faceIndex));
+    // the record's face keeps the library alive, even while it is idle
+    ref_ft_library();
+    FT_Error err = rec->openFace(&rec->fFace);
 
     if (err) {    // bad filename, try the default font
         fprintf(stderr, "ERROR: unable to open font '%x'\n", fontID);
         SkDELETE(rec);
+        unref_ft_library();
         return 0;
     } else {
         SkASSERT(rec->fFace);
@@ -279,21 +464,16 @@ static void unref_ft_face(FT_Face face) {
     SkFaceRec*  rec = gFaceRecHead;
     SkFaceRec*  prev = NULL;
     while (rec) {
-        SkFaceRec* next = rec->fNext;
         if (rec->fFace == face) {
             if (--rec->fRefCnt == 0) {
-                if (prev) {
-                    prev->fNext = next;
-                } else {
-                    gFaceRecHead = next;
-                }
-                FT_Done_Face(face);
-                SkDELETE(rec);
+                move_to_head(rec, prev);
+                gIdleFaceRecCount += 1;
+                purge_idle_faces(kMaxIdleFaceRecs);
             }
             return;
         }
         prev = rec;
-        rec = next;
+        rec = rec->fNext;
     }
     SkASSERT("shouldn't get here, face not in list");
 }
@@ -416,13 +596,6 @@ SkAdvancedTypefaceMetrics* SkFontHost::GetAdvancedTypefaceMetrics(
     return NULL;
 #else
     SkAutoMutexAcquire ac(gFTMutex);
-    FT_Library libInit = NULL;
-    if (gFTCount == 0) {
-        if (!InitFreetype())
-            sk_throw();
-        libInit = gFTLibrary;
-    }
-    SkAutoTCallIProc<struct FT_LibraryRec_, FT_Done_FreeType> ftLib(libInit);
     SkFaceRec* rec = ref_ft_face(fontID);
     if (NULL == rec)
         return NULL;
@@ -595,8 +768,12 @@ SkAdvancedTypefaceMetrics* SkFontHost::GetAdvancedTypefaceMetrics(
 
 void SkFontHost::FilterRec(SkScalerContext::Rec* rec) {
     if (!gLCDSupportValid) {
-        InitFreetype();
-        FT_Done_FreeType(gFTLibrary);
+        // gFTLibrary is only unset while no one else is using it
+        SkAutoMutexAcquire  ac(gFTMutex);
+        if (!gLCDSupportValid && InitFreetype()) {
+            FT_Done_FreeType(gFTLibrary);
+            SkDEBUGCODE(gFTLibrary = NULL;)
+        }
     }
 
     if (!gLCDSupport && isLCD(*rec)) {
@@ -636,21 +813,15 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(const SkDescriptor* desc)
         : SkScalerContext(desc) {
     SkAutoMutexAcquire  ac(gFTMutex);
 
-    if (gFTCount == 0) {
-        if (!InitFreetype()) {
-            sk_throw();
-        }
-    }
-    ++gFTCount;
+    ref_ft_library();
 
     // load the font file
-    fFTSize = NULL;
     fFace = NULL;
+    fSizeOK = false;
     fFaceRec = ref_ft_face(fRec.fFontID);
     if (NULL == fFaceRec) {
         return;
     }
-    fFace = fFaceRec->fFace;
 
     // compute our factors from the record
 
@@ -749,61 +920,49 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(const SkDescriptor* desc)
         fLoadGlyphFlags = loadFlags;
     }
 
-    // now create the FT_Size
-
+    // now check that we can set up the size, on a face we leave as a spare
+    ac.release();
+    fSizeOK = true;
     {
-        FT_Error    err;
-
-        err = FT_New_Size(fFace, &fFTSize);
-        if (err != 0) {
-            SkDEBUGF(("SkScalerContext_FreeType::FT_New_Size(%x): FT_Set_Char_Size(0x%x, 0x%x) returned 0x%x\n",
-                        fFaceRec->fFontID, fScaleX, fScaleY, err));
-            fFace = NULL;
-            return;
-        }
-
-        err = FT_Activate_Size(fFTSize);
-        if (err != 0) {
-            SkDEBUGF(("SkScalerContext_FreeType::FT_Activate_Size(%x, 0x%x, 0x%x) returned 0x%x\n",
-                        fFaceRec->fFontID, fScaleX, fScaleY, err));
-            fFTSize = NULL;
-        }
-
-        err = FT_Set_Char_Size( fFace,
-                                SkFixedToFDot6(fScaleX), SkFixedToFDot6(fScaleY),
-                                72, 72);
-        if (err != 0) {
-            SkDEBUGF(("SkScalerContext_FreeType::FT_Set_Char_Size(%x, 0x%x, 0x%x) returned 0x%x\n",
-                        fFaceRec->fFontID, fScaleX, fScaleY, err));
-            fFace = NULL;
-            return;
-        }
-
-        FT_Set_Transform( fFace, &fMatrix22, NULL);
+        AutoFace faceLock(this);
+        fSizeOK = 0 == faceLock.error();
     }
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
-    if (fFTSize != NULL) {
-        FT_Done_Size(fFTSize);
-    }
-
     SkAutoMutexAcquire  ac(gFTMutex);
 
-    if (fFace != NULL) {
-        unref_ft_face(fFace);
+    if (fFaceRec != NULL) {
+        fFaceRec->forgetOwner(this);
+        unref_ft_face(fFaceRec->fFace);
     }
-    if (--gFTCount == 0) {
-//        SkDEBUGF(("FT_Done_FreeType\n"));
-        FT_Done_FreeType(gFTLibrary);
-        SkDEBUGCODE(gFTLibrary = NULL;)
+    unref_ft_library();
+}
+
+FT_Error SkScalerContext_FreeType::setupSize() {
+    FT_Error err = FT_Set_Char_Size( fFace,
+                                     SkFixedToFDot6(fScaleX), SkFixedToFDot6(fScaleY),
+                                     72, 72);
+    if (err != 0) {
+        SkDEBUGF(("SkScalerContext_FreeType::FT_Set_Char_Size(%x, 0x%x, 0x%x) returned 0x%x\n",
+                    fFaceRec->fFontID, fScaleX, fScaleY, err));
+        return err;
     }
+
+    FT_Set_Transform( fFace, &fMatrix22, NULL);
+    return 0;
 }
 
-/*  We call this before each use of the fFace, since we may be sharing
-    this face with other context (at different sizes).
+/*  We call this (through AutoFace) before each use of the fFace. The face is
+    ours until unlockFace(), and is used without any locking: the glyph cache
+    only hands a context to one thread at a time.
 */
-FT_Error SkScalerContext_FreeType::setupSize() {
+FT_Error SkScalerContext_FreeType::lockFace() {
+    SkASSERT(NULL == fFace);
+    if (!fSizeOK) {
+        return (FT_Error)-1;
+    }
+
     /*  In the off-chance that a font has been removed, we want to error out
         right away, so call resolve just to be sure.
 
@@ -815,18 +974,34 @@ FT_Error SkScalerContext_FreeType::setupSize() {
         return (FT_Error)-1;
     }
 
-    FT_Error    err = FT_Activate_Size(fFTSize);
+    bool sized;
+    if (!fFaceRec->takeSpareFace(this, &fFace, &sized)) {
+        SkAutoMutexAcquire  ac(gFTMutex);
+        FT_Error err = fFaceRec->openFace(&fFace);
+        if (err != 0) {
+            SkDEBUGF(("SkScalerContext_FreeType: could not open face %x\n",
+                      fFaceRec->fFontID));
+            fFace = NULL;
+            return err;
+        }
+        sized = false;
+    }
+    if (!sized) {
+        FT_Error err = this->setupSize();
+        if (err != 0) {
+            fFaceRec->giveBackFace(fFace, NULL);
+            fFace = NULL;
+            return err;
+        }
+    }
+    return 0;
+}
 
-    if (err != 0) {
-        SkDEBUGF(("SkScalerContext_FreeType::FT_Activate_Size(%x, 0x%x, 0x%x) returned 0x%x\n",
-                    fFaceRec->fFontID, fScaleX, fScaleY, err));
-        fFTSize = NULL;
-    } else {
-        // seems we need to reset this every time (not sure why, but without it
-        // I get random italics from some other fFTSize)
-        FT_Set_Transform( fFace, &fMatrix22, NULL);
+void SkScalerContext_FreeType::unlockFace() {
+    if (fFace != NULL) {
+        fFaceRec->giveBackFace(fFace, this);
+        fFace = NULL;
     }
-    return err;
 }
 
 void SkScalerContext_FreeType::emboldenOutline(FT_Outline* outline) {
@@ -837,14 +1012,21 @@ void SkScalerContext_FreeType::emboldenOutline(FT_Outline* outline) {
 }
 
 unsigned SkScalerContext_FreeType::generateGlyphCount() {
-    return fFace->num_glyphs;
+    AutoFace faceLock(this);
+    return faceLock.error() ? 0 : fFace->num_glyphs;
 }
 
 uint16_t SkScalerContext_FreeType::generateCharToGlyph(SkUnichar uni) {
-    return SkToU16(FT_Get_Char_Index( fFace, uni ));
+    AutoFace faceLock(this);
+    return faceLock.error() ? 0 : SkToU16(FT_Get_Char_Index( fFace, uni ));
 }
 
 SkUnichar SkScalerContext_FreeType::generateGlyphToChar(uint16_t glyph) {
+    AutoFace faceLock(this);
+    if (faceLock.error()) {
+        return 0;
+    }
+
     // iterate through each cmap entry, looking for matching glyph indices
     FT_UInt glyphIndex;
     SkUnichar charCode = FT_Get_First_Char( fFace, &glyphIndex );
@@ -881,9 +1063,8 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
     * which are very cheap to compute with some font formats...
     */
     {
-        SkAutoMutexAcquire  ac(gFTMutex);
-
-        if (this->setupSize()) {
+        AutoFace faceLock(this);
+        if (faceLock.error()) {
             glyph->zeroMetrics();
             return;
         }
@@ -909,14 +1090,13 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
     glyph->fRsbDelta = 0;
     glyph->fLsbDelta = 0;
 
     FT_Error    err;
 
-    if (this->setupSize()) {
+    AutoFace faceLock(this);
+    if (faceLock.error()) {
         goto ERROR;
     }
 
@@ -1072,11 +1252,10 @@ static void copyFT2LCD16(const SkGlyph& glyph, const FT_Bitmap& bitmap,
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
     FT_Error    err;
 
-    if (this->setupSize()) {
+    AutoFace faceLock(this);
+    if (faceLock.error()) {
         goto ERROR;
     }
 
@@ -1132,6 +1311,8 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
                 target.num_grays = 256;
 
                 memset(glyph.fImage, 0, glyph.rowBytes() * glyph.fHeight);
+                // the rasterizers keep their working memory on the stack, so
+                // this is safe to call on several threads with one library
                 FT_Outline_Get_Bitmap(gFTLibrary, outline, &target);
             }
         } break;
@@ -1157,14 +1338,31 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
                 unsigned    minRowBytes = SkMin32(srcRowBytes, dstRowBytes);
                 unsigned    extraRowBytes = dstRowBytes - minRowBytes;
 
+                // gray pixels get their gamma as they are copied
+                const uint8_t* table = NULL;
+                unsigned mapRowBytes = 0;
+                if (fFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY) {
+                    table = this->takeImageTable();
+                    mapRowBytes = SkMin32(glyph.fWidth, minRowBytes);
+                }
+
                 for (int y = fFace->glyph->bitmap.rows - 1; y >= 0; --y) {
-                    memcpy(dst, src, minRowBytes);
+                    if (table) {
+                        sk_table8(dst, src, mapRowBytes, table);
+                        memcpy(dst + mapRowBytes, src + mapRowBytes,
+                               minRowBytes - mapRowBytes);
+                    } else {
+                        memcpy(dst, src, minRowBytes);
+                    }
                     memset(dst + minRowBytes, 0, extraRowBytes);
                     src += srcRowBytes;
                     dst += dstRowBytes;
                 }
             } else if (fFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO &&
                        glyph.fMaskFormat == SkMask::kA8_Format) {
+                const uint8_t* table = this->takeImageTable();
+                const uint8_t on = table ? table[0xff] : 0xff;
+                const uint8_t off = table ? table[0] : 0;
                 for (int y = 0; y < fFace->glyph->bitmap.rows; ++y) {
                     uint8_t byte = 0;
                     int bits = 0;
@@ -1177,7 +1375,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
                             bits = 8;
                         }
 
-                        *dst_row++ = byte & 0x80 ? 0xff : 0;
+                        *dst_row++ = byte & 0x80 ? on : off;
                         bits--;
                         byte <<= 1;
                     }
@@ -1239,11 +1437,10 @@ static int cubic_proc(CONST_PARAM FT_Vector* pt0, CONST_PARAM FT_Vector* pt1,
 
 void SkScalerContext_FreeType::generatePath(const SkGlyph& glyph,
                                             SkPath* path) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
     SkASSERT(&glyph && path);
 
-    if (this->setupSize()) {
+    AutoFace faceLock(this);
+    if (faceLock.error()) {
         path->reset();
         return;
     }
@@ -1292,9 +1489,8 @@ void SkScalerContext_FreeType::generateFontMetrics(SkPaint::FontMetrics* mx,
         return;
     }
 
-    SkAutoMutexAcquire  ac(gFTMutex);
-
-    if (this->setupSize()) {
+    AutoFace faceLock(this);
+    if (faceLock.error()) {
         ERROR:
         if (mx) {
             sk_bzero(mx, sizeof(SkPaint::FontMetrics));
@@ -31,7 +31,9 @@
 #include <fontconfig/fontconfig.h>
 
 #include "SkFontHost.h"
+#include "SkMMapStream.h"
 #include "SkStream.h"
+#include "SkTypefaceCache.h"
 
 // This is an extern from SkFontHost_FreeType
 SkTypeface::Style find_name_and_style(SkStream* stream, SkString* name);
@@ -105,6 +107,14 @@ public:
         : SkTypeface(style, id)
     { }
 
+    virtual ~FontConfigTypeface() {
+        SkAutoMutexAcquire ac(global_fc_map_lock);
+        std::map<uint32_t, SkTypeface *>::iterator it =
+            global_fc_typefaces.find(uniqueID());
+        if (it != global_fc_typefaces.end() && it->second == this)
+            global_fc_typefaces.erase(it);
+    }
+
     virtual SkStream* openStream() { return NULL; };
     virtual const char* getUniqueString() { return NULL; };
 };
@@ -350,9 +360,17 @@ SkTypeface* SkFontHost::CreateTypeface(const SkTypeface* familyFace,
 
     const unsigned fileid = FileIdFromFilename(reinterpret_cast<char*>(filename));
     const unsigned id = FileIdAndStyleToUniqueId(fileid, style);
-    SkTypeface* typeface = SkNEW_ARGS(FontConfigTypeface, (style, id));
     FcPatternDestroy(match);
 
+    // the same file and style always get the same typeface
+    SkTypeface* typeface = SkTypefaceCache::FindByID(id);
+    if (typeface) {
+        typeface->ref();
+        return typeface;
+    }
+
+    typeface = SkNEW_ARGS(FontConfigTypeface, (style, id));
+    SkTypefaceCache::Add(typeface, style);
     {
         SkAutoMutexAcquire ac(global_fc_map_lock);
         global_fc_typefaces[id] = typeface;
@@ -409,7 +427,13 @@ SkStream* SkFontHost::OpenStream(uint32_t id)
     if (i == global_fc_map_inverted.end())
         return NULL;
 
-    return SkNEW_ARGS(SkFILEStream, (i->second.c_str()));
+    // map the file, so that everyone who opens it shares the same pages
+    SkStream* stream = SkNEW_ARGS(SkMMAPStream, (i->second.c_str()));
+    if (stream->getLength() <= 0) {
+        SkDELETE(stream);
+        stream = SkNEW_ARGS(SkFILEStream, (i->second.c_str()));
+    }
+    return stream;
 }
 
 size_t SkFontHost::GetFileName(SkFontID fontID, char path[], size_t length,
@@ -268,6 +268,8 @@ public:
     // openStream returns a SkStream that has been ref-ed
     virtual SkStream* openStream() = 0;
     virtual const char* getUniqueString() const = 0;
+    // the font file, or NULL if we don't come from one
+    virtual const char* getFilePath() const { return NULL; }
     
 private:
     FamilyRec*  fFamilyRec; // we don't own this, just point to it
@@ -354,6 +356,10 @@ public:
         }
         return str;
     }
+
+    virtual const char* getFilePath() const {
+        return fPath.c_str();
+    }
     
 private:
     SkString fPath;
@@ -574,8 +580,20 @@ SkStream* SkFontHost::OpenStream(uint32_t fontID) {
 
 size_t SkFontHost::GetFileName(SkFontID fontID, char path[], size_t length,
                                int32_t* index) {
-    SkDebugf("SkFontHost::GetFileName unimplemented\n");
-    return 0;
+    FamilyTypeface* tf = (FamilyTypeface*)find_from_uniqueID(fontID);
+    const char* filePath = tf ? tf->getFilePath() : NULL;
+    if (NULL == filePath) {
+        return 0;
+    }
+
+    size_t size = strlen(filePath);
+    if (path) {
+        memcpy(path, filePath, SkMin32(size, length));
+    }
+    if (index) {
+        *index = 0;
+    }
+    return size;
 }
 
 SkFontID SkFontHost::NextLogicalFont(SkFontID currFontID, SkFontID origFontID) {
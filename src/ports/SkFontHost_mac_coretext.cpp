@@ -168,7 +168,8 @@ static SkTypeface* GetDefaultFace() {
 
     if (NULL == gDefaultFace) {
         gDefaultFace = NewFromName(FONT_DEFAULT_NAME, SkTypeface::kNormal);
-        SkTypefaceCache::Add(gDefaultFace, SkTypeface::kNormal);
+        SkTypefaceCache::Add(gDefaultFace, SkTypeface::kNormal,
+                             FONT_DEFAULT_NAME);
     }
     return gDefaultFace;
 }
@@ -202,19 +203,6 @@ SkTypeface* SkCreateTypefaceFromCTFont(CTFontRef fontRef) {
     return face;
 }
 
-struct NameStyleRec {
-    const char*         fName;
-    SkTypeface::Style   fStyle;
-};
-
-static bool FindByNameStyle(SkTypeface* face, SkTypeface::Style style,
-                            void* ctx) {
-    const SkTypeface_Mac* mface = reinterpret_cast<SkTypeface_Mac*>(face);
-    const NameStyleRec* rec = reinterpret_cast<const NameStyleRec*>(ctx);
-    
-    return rec->fStyle == style && mface->fName.equals(rec->fName);
-}
-
 static const char* map_css_names(const char* name) {
     static const struct {
         const char* fFrom;  // name the caller specified
@@ -252,15 +240,14 @@ SkTypeface* SkFontHost::CreateTypeface(const SkTypeface* familyFace,
         familyName = FONT_DEFAULT_NAME;
     }
     
-    NameStyleRec rec = { familyName, style };
-    SkTypeface* face = SkTypefaceCache::FindByProc(FindByNameStyle, &rec);
+    SkTypeface* face = SkTypefaceCache::FindByName(familyName, style);
 
     if (face) {
         face->ref();
     } else {
         face = NewFromName(familyName, style);
         if (face) {
-            SkTypefaceCache::Add(face, style);
+            SkTypefaceCache::Add(face, style, familyName);
         } else {
             face = GetDefaultFace();
             face->ref();
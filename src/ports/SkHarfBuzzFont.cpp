@@ -16,8 +16,18 @@
 
 #include "SkHarfBuzzFont.h"
 #include "SkFontHost.h"
+#include "SkGlyphCache.h"
 #include "SkPaint.h"
 #include "SkPath.h"
+#include "SkPurgeableCache.h"
+#include "SkThread.h"
+#include "SkTypeface.h"
+#include "SkUtils.h"
+
+// holds the shaped runs that are shaped over and over, e.g. on every layout
+#define SHAPE_CACHE_DEFAULT_LIMIT   (256 * 1024)
+// keeps the lookup, which looks at every entry, cheap next to shaping
+#define SHAPE_CACHE_MAX_ENTRIES     256
 
 // HB_Fixed is a 26.6 fixed point format.
 static inline HB_Fixed SkScalarToHarfbuzzFixed(SkScalar value) {
@@ -29,9 +39,58 @@ static inline HB_Fixed SkScalarToHarfbuzzFixed(SkScalar value) {
 #endif
 }
 
+/*  While SkHarfBuzzFont::ShapeItem() runs, the font holds one strike for its
+    callbacks, instead of each callback finding (and locking) it through the
+    SkPaint APIs. The strike is only used for the attributes that would find
+    the same one: linear text is measured at a canonical size, so it is left
+    to the paint.
+ */
+class SkAutoHarfBuzzShaping {
+public:
+    SkAutoHarfBuzzShaping(SkHarfBuzzFont* font) : fFont(font), fAutoCache(NULL) {
+        if (font->fShapingCache) {
+            return;     // held by an outer ShapeItem()
+        }
+        SkPaint paint;
+        font->setupPaint(&paint);
+        if (!paint.isLinearText() &&
+                SkTypeface::Equal(paint.getTypeface(), font->getTypeface())) {
+            fAutoCache = SkNEW_ARGS(SkAutoGlyphCache, (paint, NULL));
+            font->fShapingCache = fAutoCache->getCache();
+        }
+    }
+
+    ~SkAutoHarfBuzzShaping() {
+        if (fAutoCache) {
+            fFont->fShapingCache = NULL;
+            SkDELETE(fAutoCache);
+        }
+    }
+
+    static SkGlyphCache* Get(HB_Font hbFont) {
+        return reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData)->fShapingCache;
+    }
+
+private:
+    SkHarfBuzzFont*     fFont;
+    SkAutoGlyphCache*   fAutoCache;
+};
+
 static HB_Bool stringToGlyphs(HB_Font hbFont, const HB_UChar16* characters,
                               hb_uint32 length, HB_Glyph* glyphs,
                               hb_uint32* glyphsSize, HB_Bool isRTL) {
+    SkGlyphCache* cache = SkAutoHarfBuzzShaping::Get(hbFont);
+    if (cache) {
+        const uint16_t* text = characters;
+        const uint16_t* stop = text + length;
+        hb_uint32 numGlyphs = 0;
+        while (text < stop) {
+            glyphs[numGlyphs++] = cache->unicharToGlyph(SkUTF16_NextUnichar(&text));
+        }
+        *glyphsSize = numGlyphs;
+        return 1;
+    }
+
     SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
     SkPaint paint;
 
@@ -55,6 +114,15 @@ static HB_Bool stringToGlyphs(HB_Font hbFont, const HB_UChar16* characters,
 
 static void glyphsToAdvances(HB_Font hbFont, const HB_Glyph* glyphs,
                          hb_uint32 numGlyphs, HB_Fixed* advances, int flags) {
+    SkGlyphCache* cache = SkAutoHarfBuzzShaping::Get(hbFont);
+    if (cache) {
+        for (hb_uint32 i = 0; i < numGlyphs; ++i) {
+            const SkGlyph& glyph = cache->getGlyphIDAdvance(SkToU16(glyphs[i]));
+            advances[i] = SkScalarToHarfbuzzFixed(SkFixedToScalar(glyph.fAdvanceX));
+        }
+        return;
+    }
+
     SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
     SkPaint paint;
 
@@ -78,6 +146,18 @@ static void glyphsToAdvances(HB_Font hbFont, const HB_Glyph* glyphs,
 
 static HB_Bool canRender(HB_Font hbFont, const HB_UChar16* characters,
                          hb_uint32 length) {
+    SkGlyphCache* cache = SkAutoHarfBuzzShaping::Get(hbFont);
+    if (cache) {
+        const uint16_t* text = characters;
+        const uint16_t* stop = text + length;
+        while (text < stop) {
+            if (0 == cache->unicharToGlyph(SkUTF16_NextUnichar(&text))) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
     SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
     SkPaint paint;
 
@@ -116,16 +196,25 @@ static HB_Error getOutlinePoint(HB_Font hbFont, HB_Glyph glyph, int flags,
 
 static void getGlyphMetrics(HB_Font hbFont, HB_Glyph glyph,
                             HB_GlyphMetrics* metrics) {
-    SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
-    SkPaint paint;
-
-    font->setupPaint(&paint);
-    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
-
     SkScalar width;
     SkRect bounds;
     uint16_t glyph16 = SkToU16(glyph);
-    paint.getTextWidths(&glyph16, sizeof(glyph16), &width, &bounds);
+
+    SkGlyphCache* cache = SkAutoHarfBuzzShaping::Get(hbFont);
+    if (cache) {
+        const SkGlyph& g = cache->getGlyphIDMetrics(glyph16);
+        width = SkFixedToScalar(g.fAdvanceX);
+        bounds.set(SkIntToScalar(g.fLeft), SkIntToScalar(g.fTop),
+                   SkIntToScalar(g.fLeft + g.fWidth),
+                   SkIntToScalar(g.fTop + g.fHeight));
+    } else {
+        SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
+        SkPaint paint;
+
+        font->setupPaint(&paint);
+        paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+        paint.getTextWidths(&glyph16, sizeof(glyph16), &width, &bounds);
+    }
 
     metrics->x = SkScalarToHarfbuzzFixed(bounds.fLeft);
     metrics->y = SkScalarToHarfbuzzFixed(bounds.fTop);
@@ -141,12 +230,18 @@ static void getGlyphMetrics(HB_Font hbFont, HB_Glyph glyph,
 
 static HB_Fixed getFontMetric(HB_Font hbFont, HB_FontMetric metric)
 {
-    SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
-    SkPaint paint;
     SkPaint::FontMetrics skiaMetrics;
 
-    font->setupPaint(&paint);
-    paint.getFontMetrics(&skiaMetrics);
+    SkGlyphCache* cache = SkAutoHarfBuzzShaping::Get(hbFont);
+    if (cache) {
+        skiaMetrics = cache->getFontMetricsY();
+    } else {
+        SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(hbFont->userData);
+        SkPaint paint;
+
+        font->setupPaint(&paint);
+        paint.getFontMetrics(&skiaMetrics);
+    }
 
     switch (metric) {
     case HB_FontAscent:
@@ -193,3 +288,292 @@ HB_Error SkHarfBuzzFont::GetFontTableFunc(void* voidface, const HB_Tag tag,
     return HB_Err_Ok;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+enum {
+    kTypefaceID_Key,
+    kTextSize_Key,
+    kTextScaleX_Key,
+    kTextSkewX_Key,
+    kFlags_Key,
+    kHinting_Key,
+    kPPEM_Key,          // x_ppem << 16 | y_ppem
+    kXScale_Key,
+    kYScale_Key,
+    kShaperFlags_Key,
+    kScript_Key,
+    kBidiLevel_Key,
+    kPos_Key,
+    kLength_Key,
+    kStringLength_Key,
+
+    kKeyCount
+};
+
+/*  Each entry is a single allocation: the header, then the glyphs, advances,
+    offsets and log clusters that were shaped, the whole string (the shapers
+    look at the text around the run), and last the glyph attributes.
+ */
+struct ShapedRun {
+    ShapedRun*  fPrev;  // more recently used
+    ShapedRun*  fNext;  // less recently used
+    size_t      fSize;  // of the whole allocation
+
+    uint32_t    fHash;
+    uint32_t    fKey[kKeyCount];
+    hb_uint32   fNumGlyphs;
+    HB_Bool     fKerningApplied;
+
+    hb_uint32 length() const { return fKey[kLength_Key]; }
+    hb_uint32 stringLength() const { return fKey[kStringLength_Key]; }
+
+    HB_Glyph* glyphs() const {
+        return (HB_Glyph*)(this + 1);
+    }
+    HB_Fixed* advances() const {
+        return (HB_Fixed*)(this->glyphs() + fNumGlyphs);
+    }
+    HB_FixedPoint* offsets() const {
+        return (HB_FixedPoint*)(this->advances() + fNumGlyphs);
+    }
+    unsigned short* logClusters() const {
+        return (unsigned short*)(this->offsets() + fNumGlyphs);
+    }
+    HB_UChar16* string() const {
+        return (HB_UChar16*)(this->logClusters() + this->length());
+    }
+    HB_GlyphAttributes* attributes() const {
+        return (HB_GlyphAttributes*)(this->string() + this->stringLength());
+    }
+
+    static size_t ComputeSize(hb_uint32 numGlyphs, hb_uint32 length,
+                              hb_uint32 stringLength) {
+        return sizeof(ShapedRun) +
+               numGlyphs * (sizeof(HB_Glyph) + sizeof(HB_Fixed) +
+                            sizeof(HB_FixedPoint) + sizeof(HB_GlyphAttributes)) +
+               length * sizeof(unsigned short) +
+               stringLength * sizeof(HB_UChar16);
+    }
+};
+
+}
+
+static SkMutex      gShapeCacheMutex;
+static ShapedRun*   gHead;
+static ShapedRun*   gTail;
+static int          gCount;
+static size_t       gBytesUsed;
+
+static uint32_t scalar_bits(SkScalar value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t compute_key(const HB_ShaperItem* item,
+                            uint32_t key[kKeyCount]) {
+    const SkHarfBuzzFont* font =
+            reinterpret_cast<const SkHarfBuzzFont*>(item->font->userData);
+    SkPaint paint;
+    font->setupPaint(&paint);
+
+    key[kTypefaceID_Key] = SkTypeface::UniqueID(paint.getTypeface());
+    key[kTextSize_Key] = scalar_bits(paint.getTextSize());
+    key[kTextScaleX_Key] = scalar_bits(paint.getTextScaleX());
+    key[kTextSkewX_Key] = scalar_bits(paint.getTextSkewX());
+    key[kFlags_Key] = paint.getFlags();
+    key[kHinting_Key] = paint.getHinting();
+    key[kPPEM_Key] = (item->font->x_ppem << 16) | item->font->y_ppem;
+    key[kXScale_Key] = item->font->x_scale;
+    key[kYScale_Key] = item->font->y_scale;
+    key[kShaperFlags_Key] = item->shaperFlags;
+    key[kScript_Key] = item->item.script;
+    key[kBidiLevel_Key] = item->item.bidiLevel;
+    key[kPos_Key] = item->item.pos;
+    key[kLength_Key] = item->item.length;
+    key[kStringLength_Key] = item->stringLength;
+
+    // FNV-1a over the key, then the string
+    uint32_t hash = 2166136261U;
+    for (int i = 0; i < kKeyCount; i++) {
+        hash = (hash ^ key[i]) * 16777619U;
+    }
+    for (hb_uint32 i = 0; i < item->stringLength; i++) {
+        hash = (hash ^ item->string[i]) * 16777619U;
+    }
+    return hash;
+}
+
+static bool matches(const ShapedRun* run, uint32_t hash,
+                    const uint32_t key[kKeyCount], const HB_UChar16* string) {
+    return run->fHash == hash &&
+           !memcmp(run->fKey, key, sizeof(run->fKey)) &&
+           !memcmp(run->string(), string,
+                   run->stringLength() * sizeof(HB_UChar16));
+}
+
+// the following must be called with gShapeCacheMutex held
+
+static void detach(ShapedRun* run) {
+    if (run->fPrev) {
+        run->fPrev->fNext = run->fNext;
+    } else {
+        gHead = run->fNext;
+    }
+    if (run->fNext) {
+        run->fNext->fPrev = run->fPrev;
+    } else {
+        gTail = run->fPrev;
+    }
+    gCount -= 1;
+    gBytesUsed -= run->fSize;
+}
+
+static void add_to_head(ShapedRun* run) {
+    run->fPrev = NULL;
+    run->fNext = gHead;
+    if (gHead) {
+        gHead->fPrev = run;
+    } else {
+        gTail = run;
+    }
+    gHead = run;
+    gCount += 1;
+    gBytesUsed += run->fSize;
+}
+
+static void purge_to(size_t limit) {
+    while (gTail && (gBytesUsed > limit || gCount > SHAPE_CACHE_MAX_ENTRIES)) {
+        ShapedRun* run = gTail;
+        detach(run);
+        sk_free(run);
+    }
+}
+
+static ShapedRun* find(uint32_t hash, const uint32_t key[kKeyCount],
+                       const HB_UChar16* string) {
+    for (ShapedRun* run = gHead; run; run = run->fNext) {
+        if (matches(run, hash, key, string)) {
+            return run;
+        }
+    }
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+HB_Bool SkHarfBuzzFont::ShapeItem(HB_ShaperItem* item) {
+    SkASSERT(item->font->klass == &gSkHarfBuzzFontClass);
+    SkHarfBuzzFont* font = reinterpret_cast<SkHarfBuzzFont*>(item->font->userData);
+
+    // glyphs that were given to us aren't part of the key
+    if (item->glyphIndicesPresent) {
+        SkAutoHarfBuzzShaping shaping(font);
+        return HB_ShapeItem(item);
+    }
+
+    uint32_t key[kKeyCount];
+    const uint32_t hash = compute_key(item, key);
+    const hb_uint32 length = item->item.length;
+    {
+        SkAutoMutexAcquire ac(gShapeCacheMutex);
+        ShapedRun* run = find(hash, key, item->string);
+        if (run) {
+            detach(run);
+            add_to_head(run);
+
+            // ask for the room that HB_ShapeItem() would ask for
+            const hb_uint32 numGlyphs = run->fNumGlyphs;
+            if (item->num_glyphs < length) {
+                item->num_glyphs = length;
+                return false;
+            }
+            if (item->num_glyphs < numGlyphs) {
+                item->num_glyphs = numGlyphs;
+                return false;
+            }
+            item->num_glyphs = numGlyphs;
+            memcpy(item->glyphs, run->glyphs(), numGlyphs * sizeof(HB_Glyph));
+            memcpy(item->attributes, run->attributes(),
+                   numGlyphs * sizeof(HB_GlyphAttributes));
+            memcpy(item->advances, run->advances(), numGlyphs * sizeof(HB_Fixed));
+            memcpy(item->offsets, run->offsets(),
+                   numGlyphs * sizeof(HB_FixedPoint));
+            memcpy(item->log_clusters, run->logClusters(),
+                   length * sizeof(unsigned short));
+            item->kerning_applied = run->fKerningApplied;
+            return true;
+        }
+    }
+
+    HB_Bool result;
+    {
+        SkAutoHarfBuzzShaping shaping(font);
+        result = HB_ShapeItem(item);
+    }
+    if (!result) {
+        return result;
+    }
+
+    const hb_uint32 numGlyphs = item->num_glyphs;
+    const size_t size = ShapedRun::ComputeSize(numGlyphs, length,
+                                               item->stringLength);
+    // a single run may not crowd out all of the others
+    if (size > SHAPE_CACHE_DEFAULT_LIMIT / 4) {
+        return result;
+    }
+    ShapedRun* run = (ShapedRun*)sk_malloc_flags(size, 0);
+    if (NULL == run) {
+        return result;
+    }
+    run->fSize = size;
+    run->fHash = hash;
+    memcpy(run->fKey, key, sizeof(key));
+    run->fNumGlyphs = numGlyphs;
+    run->fKerningApplied = item->kerning_applied;
+    memcpy(run->glyphs(), item->glyphs, numGlyphs * sizeof(HB_Glyph));
+    memcpy(run->attributes(), item->attributes,
+           numGlyphs * sizeof(HB_GlyphAttributes));
+    memcpy(run->advances(), item->advances, numGlyphs * sizeof(HB_Fixed));
+    memcpy(run->offsets(), item->offsets, numGlyphs * sizeof(HB_FixedPoint));
+    memcpy(run->logClusters(), item->log_clusters,
+           length * sizeof(unsigned short));
+    memcpy(run->string(), item->string,
+           item->stringLength * sizeof(HB_UChar16));
+
+    SkAutoMutexAcquire ac(gShapeCacheMutex);
+    // another thread may have beaten us to it
+    if (find(hash, key, item->string)) {
+        sk_free(run);
+        return result;
+    }
+    add_to_head(run);
+    purge_to(SHAPE_CACHE_DEFAULT_LIMIT);
+    return result;
+}
+
+namespace {
+
+class ShapePurgeableCache : public SkPurgeableCache {
+public:
+    ShapePurgeableCache() : INHERITED("shaped runs", kModerate_Cost) {}
+
+    virtual size_t bytesUsed() const {
+        SkAutoMutexAcquire ac(gShapeCacheMutex);
+        return gBytesUsed;
+    }
+    virtual void purgeTo(size_t bytes) {
+        SkAutoMutexAcquire ac(gShapeCacheMutex);
+        purge_to(bytes);
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static ShapePurgeableCache gPurgeableCache;
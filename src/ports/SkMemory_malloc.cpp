@@ -1,7 +1,20 @@
 #include "SkTypes.h"
+#include "SkMemoryTracker.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef SK_ENABLE_MEMORY_TRACKING
+    #define sk_raw_malloc(size, caller)         \
+        SkMemoryTracker::Malloc(size, caller)
+    #define sk_raw_realloc(addr, size, caller)  \
+        SkMemoryTracker::Realloc(addr, size, caller)
+    #define sk_raw_free(addr)                   SkMemoryTracker::Free(addr)
+#else
+    #define sk_raw_malloc(size, caller)         malloc(size)
+    #define sk_raw_realloc(addr, size, caller)  realloc(addr, size)
+    #define sk_raw_free(addr)                   free(addr)
+#endif
+
 void sk_throw() {
     SkASSERT(!"sk_throw");
     abort();
@@ -12,12 +25,23 @@ void sk_out_of_memory(void) {
     abort();
 }
 
+// caller is who called sk_malloc, for SkMemoryTracker
+static void* malloc_flags(size_t size, unsigned flags, const void* caller) {
+    void* p = sk_raw_malloc(size, caller);
+    if (p == NULL) {
+        if (flags & SK_MALLOC_THROW) {
+            sk_throw();
+        }
+    }
+    return p;
+}
+
 void* sk_malloc_throw(size_t size) {
-    return sk_malloc_flags(size, SK_MALLOC_THROW);
+    return malloc_flags(size, SK_MALLOC_THROW, SK_MEMORY_CALLER());
 }
 
 void* sk_realloc_throw(void* addr, size_t size) {
-    void* p = realloc(addr, size);
+    void* p = sk_raw_realloc(addr, size, SK_MEMORY_CALLER());
     if (size == 0) {
         return p;
     }
@@ -29,17 +53,11 @@ void* sk_realloc_throw(void* addr, size_t size) {
 
 void sk_free(void* p) {
     if (p) {
-        free(p);
+        sk_raw_free(p);
     }
 }
 
 void* sk_malloc_flags(size_t size, unsigned flags) {
-    void* p = malloc(size);
-    if (p == NULL) {
-        if (flags & SK_MALLOC_THROW) {
-            sk_throw();
-        }
-    }
-    return p;
+    return malloc_flags(size, flags, SK_MEMORY_CALLER());
 }
 
@@ -89,6 +89,12 @@ void sk_fflush(SkFILE* f)
     SkASSERT(f);
 }
 
+bool sk_fprefetch(SkFILE* f, size_t offset, size_t byteCount)
+{
+    SkASSERT(f);
+    return false;
+}
+
 void sk_fclose(SkFILE* f)
 {
     SkASSERT(f);
@@ -20,6 +20,12 @@
 #include <stdio.h>
 #include <errno.h>
 
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID) || \
+    defined(ANDROID)
+    #include <fcntl.h>
+    #define SK_OSFILE_USE_FADVISE
+#endif
+
 SkFILE* sk_fopen(const char path[], SkFILE_Flags flags)
 {
     char    perm[4];
@@ -94,6 +100,17 @@ void sk_fflush(SkFILE* f)
     ::fflush((FILE*)f);
 }
 
+bool sk_fprefetch(SkFILE* f, size_t offset, size_t byteCount)
+{
+    SkASSERT(f);
+#ifdef SK_OSFILE_USE_FADVISE
+    return 0 == ::posix_fadvise(fileno((FILE*)f), (off_t)offset,
+                                (off_t)byteCount, POSIX_FADV_WILLNEED);
+#else
+    return false;
+#endif
+}
+
 void sk_fclose(SkFILE* f)
 {
     SkASSERT(f);
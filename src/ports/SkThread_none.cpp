@@ -16,6 +16,7 @@
 */
 
 #include "SkThread.h"
+#include "SkTLS.h"
 
 int32_t sk_atomic_inc(int32_t* addr)
 {
@@ -31,6 +32,13 @@ int32_t sk_atomic_dec(int32_t* addr)
     return value;
 }
 
+int32_t sk_atomic_add(int32_t* addr, int32_t inc)
+{
+    int32_t value = *addr;
+    *addr = value + inc;
+    return value;
+}
+
 SkMutex::SkMutex(bool /* isGlobal */)
 {
 }
@@ -47,3 +55,52 @@ void SkMutex::release()
 {
 }
 
+/*  Without threads nobody else can signal the semaphore, so wait() must only
+    be called when its count is above 0.
+ */
+SkSemaphore::SkSemaphore(int count)
+{
+    fStorage[0] = count;
+}
+
+SkSemaphore::~SkSemaphore()
+{
+}
+
+void SkSemaphore::signal(int n)
+{
+    fStorage[0] += n;
+}
+
+void SkSemaphore::wait()
+{
+    SkASSERT((int32_t)fStorage[0] > 0);
+    fStorage[0] -= 1;
+}
+
+int sk_num_cores()
+{
+    return 1;
+}
+
+bool sk_start_thread(void (*)(void*), void*)
+{
+    return false;
+}
+
+void sk_thread_yield()
+{
+}
+
+static void* gSkTLSSpecific;
+
+// there is only the one thread, which never exits
+void* SkTLS::PlatformGetSpecific()
+{
+    return gSkTLSSpecific;
+}
+
+void SkTLS::PlatformSetSpecific(void* ptr)
+{
+    gSkTLSSpecific = ptr;
+}
@@ -1,7 +1,36 @@
 #include "SkThread.h"
+#include "SkTLS.h"
 
 #include <pthread.h>
 #include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+
+/*  The __sync builtins are full barriers, so a dec that takes a count to zero
+    sees every write made by the owners that dropped their references before
+    it. Older ARM compilers don't have them, and neither does gcc before 4.1,
+    so those still use a mutex.
+ */
+#if defined(__GNUC__) && \
+    ((__GNUC__ == 4 && __GNUC_MINOR__ >= 4) || __GNUC__ > 4 || \
+     (!defined(__arm__) && __GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+
+int32_t sk_atomic_inc(int32_t* addr)
+{
+    return __sync_fetch_and_add(addr, 1);
+}
+
+int32_t sk_atomic_dec(int32_t* addr)
+{
+    return __sync_fetch_and_add(addr, -1);
+}
+
+int32_t sk_atomic_add(int32_t* addr, int32_t inc)
+{
+    return __sync_fetch_and_add(addr, inc);
+}
+
+#else
 
 SkMutex gAtomicMutex;
 
@@ -23,6 +52,17 @@ int32_t sk_atomic_dec(int32_t* addr)
     return value;
 }
 
+int32_t sk_atomic_add(int32_t* addr, int32_t inc)
+{
+    SkAutoMutexAcquire ac(gAtomicMutex);
+
+    int32_t value = *addr;
+    *addr = value + inc;
+    return value;
+}
+
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 
 static void print_pthread_error(int status)
@@ -88,3 +128,128 @@ void SkMutex::release()
     SkASSERT(0 == status);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+
+struct PThreadSemaphore {
+    pthread_mutex_t fMutex;
+    pthread_cond_t  fCond;      // signaled when fCount goes above 0
+    int             fCount;
+};
+
+SkSemaphore::SkSemaphore(int count)
+{
+    SK_COMPILE_ASSERT(sizeof(fStorage) >= sizeof(PThreadSemaphore),
+                      NotEnoughSizeForSemaphore);
+    PThreadSemaphore* sem = (PThreadSemaphore*)fStorage;
+
+    int status = pthread_mutex_init(&sem->fMutex, NULL);
+    print_pthread_error(status);
+    SkASSERT(0 == status);
+
+    status = pthread_cond_init(&sem->fCond, NULL);
+    print_pthread_error(status);
+    SkASSERT(0 == status);
+
+    sem->fCount = count;
+}
+
+SkSemaphore::~SkSemaphore()
+{
+    PThreadSemaphore* sem = (PThreadSemaphore*)fStorage;
+    pthread_cond_destroy(&sem->fCond);
+    pthread_mutex_destroy(&sem->fMutex);
+}
+
+void SkSemaphore::signal(int n)
+{
+    PThreadSemaphore* sem = (PThreadSemaphore*)fStorage;
+    pthread_mutex_lock(&sem->fMutex);
+    sem->fCount += n;
+    if (n > 1) {
+        pthread_cond_broadcast(&sem->fCond);
+    } else {
+        pthread_cond_signal(&sem->fCond);
+    }
+    pthread_mutex_unlock(&sem->fMutex);
+}
+
+void SkSemaphore::wait()
+{
+    PThreadSemaphore* sem = (PThreadSemaphore*)fStorage;
+    pthread_mutex_lock(&sem->fMutex);
+    while (sem->fCount <= 0) {
+        pthread_cond_wait(&sem->fCond, &sem->fMutex);
+    }
+    sem->fCount -= 1;
+    pthread_mutex_unlock(&sem->fMutex);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+int sk_num_cores()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count > 0) {
+        return (int)count;
+    }
+#endif
+    return 1;
+}
+
+namespace {
+    struct ThreadStart {
+        void    (*fProc)(void*);
+        void*   fData;
+    };
+}
+
+static void* thread_start(void* arg)
+{
+    ThreadStart start = *(ThreadStart*)arg;
+    sk_free(arg);
+    start.fProc(start.fData);
+    return NULL;
+}
+
+bool sk_start_thread(void (*proc)(void*), void* data)
+{
+    ThreadStart* start = (ThreadStart*)sk_malloc_throw(sizeof(ThreadStart));
+    start->fProc = proc;
+    start->fData = data;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, thread_start, start)) {
+        sk_free(start);
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+void sk_thread_yield()
+{
+    sched_yield();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static pthread_key_t    gSkTLSKey;
+static pthread_once_t   gSkTLSKey_Once = PTHREAD_ONCE_INIT;
+
+static void sk_tls_make_key()
+{
+    (void)pthread_key_create(&gSkTLSKey, SkTLS::Destructor);
+}
+
+void* SkTLS::PlatformGetSpecific()
+{
+    (void)pthread_once(&gSkTLSKey_Once, sk_tls_make_key);
+    return pthread_getspecific(gSkTLSKey);
+}
+
+void SkTLS::PlatformSetSpecific(void* ptr)
+{
+    (void)pthread_once(&gSkTLSKey_Once, sk_tls_make_key);
+    (void)pthread_setspecific(gSkTLSKey, ptr);
+}
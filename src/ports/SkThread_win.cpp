@@ -17,6 +17,7 @@
 
 #include <windows.h>
 #include "SkThread.h"
+#include "SkTLS.h"
 
 int32_t sk_atomic_inc(int32_t* addr)
 {
@@ -29,6 +30,12 @@ int32_t sk_atomic_dec(int32_t* addr)
     return InterlockedDecrement(reinterpret_cast<LONG*>(addr)) + 1;
 }
 
+int32_t sk_atomic_add(int32_t* addr, int32_t inc)
+{
+    // InterlockedExchangeAdd returns the old value
+    return InterlockedExchangeAdd(reinterpret_cast<LONG*>(addr), inc);
+}
+
 SkMutex::SkMutex(bool /* isGlobal */)
 {
     SK_COMPILE_ASSERT(sizeof(fStorage) > sizeof(CRITICAL_SECTION),
@@ -51,3 +58,98 @@ void SkMutex::release()
     LeaveCriticalSection(reinterpret_cast<CRITICAL_SECTION*>(&fStorage));
 }
 
+SkSemaphore::SkSemaphore(int count)
+{
+    SK_COMPILE_ASSERT(sizeof(fStorage) >= sizeof(HANDLE),
+                      NotEnoughSizeForSemaphore);
+    *reinterpret_cast<HANDLE*>(&fStorage) =
+            CreateSemaphore(NULL, count, LONG_MAX, NULL);
+}
+
+SkSemaphore::~SkSemaphore()
+{
+    CloseHandle(*reinterpret_cast<HANDLE*>(&fStorage));
+}
+
+void SkSemaphore::signal(int n)
+{
+    ReleaseSemaphore(*reinterpret_cast<HANDLE*>(&fStorage), n, NULL);
+}
+
+void SkSemaphore::wait()
+{
+    WaitForSingleObject(*reinterpret_cast<HANDLE*>(&fStorage), INFINITE);
+}
+
+int sk_num_cores()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+namespace {
+    struct ThreadStart {
+        void    (*fProc)(void*);
+        void*   fData;
+    };
+}
+
+static DWORD WINAPI thread_start(LPVOID arg)
+{
+    ThreadStart start = *(ThreadStart*)arg;
+    sk_free(arg);
+    start.fProc(start.fData);
+    return 0;
+}
+
+bool sk_start_thread(void (*proc)(void*), void* data)
+{
+    ThreadStart* start = (ThreadStart*)sk_malloc_throw(sizeof(ThreadStart));
+    start->fProc = proc;
+    start->fData = data;
+
+    HANDLE thread = CreateThread(NULL, 0, thread_start, start, 0, NULL);
+    if (NULL == thread) {
+        sk_free(start);
+        return false;
+    }
+    // the thread keeps running without its handle
+    CloseHandle(thread);
+    return true;
+}
+
+void sk_thread_yield()
+{
+    SwitchToThread();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static SkMutex  gSkTLSMutex;
+static DWORD    gSkTLSIndex;
+static bool     gSkTLSIndexValid;
+
+static DWORD sk_tls_index()
+{
+    if (!gSkTLSIndexValid) {
+        SkAutoMutexAcquire ac(gSkTLSMutex);
+        if (!gSkTLSIndexValid) {
+            gSkTLSIndex = TlsAlloc();
+            gSkTLSIndexValid = true;
+        }
+    }
+    return gSkTLSIndex;
+}
+
+// There is no destructor for a TLS slot here, so a thread's objects are
+// leaked when it exits.
+void* SkTLS::PlatformGetSpecific()
+{
+    return TlsGetValue(sk_tls_index());
+}
+
+void SkTLS::PlatformSetSpecific(void* ptr)
+{
+    TlsSetValue(sk_tls_index(), ptr);
+}
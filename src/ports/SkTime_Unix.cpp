@@ -47,4 +47,18 @@ SkMSec SkTime::GetMSecs()
     return (SkMSec) (tv.tv_sec * 1000 + tv.tv_usec / 1000 ); // microseconds to milliseconds
 }
 
+double SkTime::GetUSecs()
+{
+#if defined(SK_BUILD_FOR_MAC)
+    // older SDKs don't have clock_gettime()
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#endif
+}
+
 #endif
@@ -44,3 +44,14 @@ SkMSec SkTime::GetMSecs()
     __int64 t  = li.QuadPart;       /* In 100-nanosecond intervals */
     return (SkMSec)(t / 10000);               /* In milliseconds */
 }
+
+double SkTime::GetUSecs()
+{
+    static LARGE_INTEGER gFrequency;
+    if (0 == gFrequency.QuadPart) {
+        QueryPerformanceFrequency(&gFrequency);
+    }
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1e6 / (double)gFrequency.QuadPart;
+}
@@ -0,0 +1,725 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkSVGPicture.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkParse.h"
+#include "SkParsePath.h"
+#include "SkPicture.h"
+#include "SkStream.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+#include "SkTSearch.h"
+#include "SkXMLParser.h"
+
+/*  Each element is drawn as soon as its attributes are all in, that is, when
+    the parser reaches its first child or its end. Until then its attributes
+    go into slots, so nothing of the document is kept but the stack of
+    inherited paint state.
+ */
+
+enum Element {
+    kCircle_Element,
+    kEllipse_Element,
+    kG_Element,
+    kLine_Element,
+    kPath_Element,
+    kPolygon_Element,
+    kPolyline_Element,
+    kRect_Element,
+    kSVG_Element,
+
+    kNone_Element = -1
+};
+
+// sorted, to match Element
+static const char* gElementNames[] = {
+    "circle", "ellipse", "g", "line", "path", "polygon", "polyline", "rect",
+    "svg"
+};
+
+enum Attr {
+    kCx_Attr,
+    kCy_Attr,
+    kD_Attr,
+    kDisplay_Attr,
+    kFill_Attr,
+    kFillOpacity_Attr,
+    kFillRule_Attr,
+    kHeight_Attr,
+    kOpacity_Attr,
+    kPoints_Attr,
+    kR_Attr,
+    kRx_Attr,
+    kRy_Attr,
+    kStroke_Attr,
+    kStrokeLinecap_Attr,
+    kStrokeLinejoin_Attr,
+    kStrokeMiterlimit_Attr,
+    kStrokeOpacity_Attr,
+    kStrokeWidth_Attr,
+    kStyle_Attr,
+    kTransform_Attr,
+    kViewBox_Attr,
+    kWidth_Attr,
+    kX_Attr,
+    kX1_Attr,
+    kX2_Attr,
+    kY_Attr,
+    kY1_Attr,
+    kY2_Attr,
+
+    kAttrCount
+};
+
+// sorted, to match Attr
+static const char* gAttrNames[] = {
+    "cx", "cy", "d", "display", "fill", "fill-opacity", "fill-rule",
+    "height", "opacity", "points", "r", "rx", "ry", "stroke",
+    "stroke-linecap", "stroke-linejoin", "stroke-miterlimit",
+    "stroke-opacity", "stroke-width", "style", "transform", "viewBox",
+    "width", "x", "x1", "x2", "y", "y1", "y2"
+};
+
+static int find_name(const char* const names[], int count, const char name[],
+                     size_t len) {
+    int index = SkStrSearch(names, count, name, len, sizeof(const char*));
+    return index >= 0 ? index : -1;
+}
+
+namespace {
+
+// the paint properties, which children inherit
+struct State {
+    SkColor     fFillColor;
+    SkColor     fStrokeColor;
+    SkScalar    fFillOpacity;
+    SkScalar    fStrokeOpacity;
+    SkScalar    fStrokeWidth;
+    SkScalar    fMiterLimit;
+    uint8_t     fCap;       // SkPaint::Cap
+    uint8_t     fJoin;      // SkPaint::Join
+    bool        fFill;
+    bool        fStroke;
+    bool        fEvenOdd;
+
+    void setDefaults() {
+        fFillColor = SK_ColorBLACK;
+        fStrokeColor = SK_ColorBLACK;
+        fFillOpacity = SK_Scalar1;
+        fStrokeOpacity = SK_Scalar1;
+        fStrokeWidth = SK_Scalar1;
+        fMiterLimit = SkIntToScalar(4);
+        fCap = SkPaint::kButt_Cap;
+        fJoin = SkPaint::kMiter_Join;
+        fFill = true;
+        fStroke = false;
+        fEvenOdd = false;
+    }
+};
+
+}  // namespace
+
+static U8CPU opacity_to_alpha(SkScalar opacity) {
+    return SkScalarRound(SkScalarPin(opacity, 0, SK_Scalar1) * 255);
+}
+
+static void set_paint_alpha(SkPaint* paint, SkScalar opacity) {
+    paint->setAlpha(SkMulDiv255Round(paint->getAlpha(),
+                                     opacity_to_alpha(opacity)));
+}
+
+static const char* skip_separators(const char str[]) {
+    while (' ' == *str || '\t' == *str || '\n' == *str || '\r' == *str ||
+           ',' == *str) {
+        str += 1;
+    }
+    return str;
+}
+
+// Reads up to max scalars, separated by whitespace or commas, returning how
+// many there were.
+static int parse_scalars(const char str[], SkScalar values[], int max,
+                         const char** stop = NULL) {
+    int count = 0;
+    str = skip_separators(str);
+    while (count < max) {
+        const char* end = SkParse::FindScalar(str, &values[count]);
+        if (NULL == end) {
+            break;
+        }
+        count += 1;
+        str = skip_separators(end);
+    }
+    if (stop) {
+        *stop = str;
+    }
+    return count;
+}
+
+static SkScalar parse_scalar(const char str[], SkScalar defaultValue) {
+    SkScalar value;
+    return parse_scalars(str, &value, 1) ? value : defaultValue;
+}
+
+// "none" turns the paint off; colors we can't draw, such as gradients,
+// turn it off too, and currentColor and inherit leave it as it was.
+static void parse_paint(const char str[], SkColor* color, bool* on) {
+    str = skip_separators(str);
+    if (!strcmp(str, "none") || !strncmp(str, "url(", 4)) {
+        *on = false;
+        return;
+    }
+    if (!strcmp(str, "currentColor") || !strcmp(str, "inherit")) {
+        return;
+    }
+    if (!strncmp(str, "rgb(", 4)) {
+        SkScalar rgb[3];
+        const char* end;
+        if (3 == parse_scalars(str + 4, rgb, 3, &end)) {
+            // the components are either all numbers or all percentages
+            SkScalar scale = strchr(str, '%') ? SkFloatToScalar(2.55f)
+                                              : SK_Scalar1;
+            unsigned c[3];
+            for (int i = 0; i < 3; i++) {
+                c[i] = SkScalarRound(SkScalarPin(SkScalarMul(rgb[i], scale),
+                                                 0, SkIntToScalar(255)));
+            }
+            *color = SkColorSetRGB(c[0], c[1], c[2]);
+            *on = true;
+        }
+        return;
+    }
+    SkColor value = SK_ColorBLACK;
+    if (SkParse::FindColor(str, &value)) {
+        *color = value;
+        *on = true;
+    }
+}
+
+static bool parse_transform(const char str[], SkMatrix* matrix) {
+    matrix->reset();
+    for (;;) {
+        str = skip_separators(str);
+        if (0 == *str) {
+            return true;
+        }
+        const char* name = str;
+        while (('a' <= *str && *str <= 'z') || ('A' <= *str && *str <= 'Z')) {
+            str += 1;
+        }
+        size_t len = str - name;
+        str = skip_separators(str);
+        if ('(' != *str) {
+            return false;
+        }
+        SkScalar v[6];
+        int count = parse_scalars(str + 1, v, 6, &str);
+        if (')' != *str) {
+            return false;
+        }
+        str += 1;
+
+        SkMatrix m;
+        if (6 == len && !strncmp(name, "matrix", len) && 6 == count) {
+            m.setAll(v[0], v[2], v[4], v[1], v[3], v[5], 0, 0, SK_Scalar1);
+        } else if (9 == len && !strncmp(name, "translate", len) &&
+                   (1 == count || 2 == count)) {
+            m.setTranslate(v[0], 2 == count ? v[1] : 0);
+        } else if (5 == len && !strncmp(name, "scale", len) &&
+                   (1 == count || 2 == count)) {
+            m.setScale(v[0], 2 == count ? v[1] : v[0]);
+        } else if (6 == len && !strncmp(name, "rotate", len) &&
+                   (1 == count || 3 == count)) {
+            if (3 == count) {
+                m.setRotate(v[0], v[1], v[2]);
+            } else {
+                m.setRotate(v[0]);
+            }
+        } else if (5 == len && !strncmp(name, "skewX", len) && 1 == count) {
+            m.setSkew(SkScalarTan(SkDegreesToRadians(v[0])), 0);
+        } else if (5 == len && !strncmp(name, "skewY", len) && 1 == count) {
+            m.setSkew(0, SkScalarTan(SkDegreesToRadians(v[0])));
+        } else {
+            return false;
+        }
+        matrix->preConcat(m);
+    }
+}
+
+namespace {
+
+class SVGPictureParser : public SkXMLParser {
+public:
+    SVGPictureParser(SkPicture* picture)
+        : fPicture(picture), fCanvas(NULL), fPending(kNone_Element),
+          fSkipDepth(0), fFailed(false) {}
+
+    // returns false if the document had no root svg element, or had errors
+    bool finish() {
+        if (fCanvas) {
+            fPicture->endRecording();
+        }
+        return fCanvas && !fFailed;
+    }
+
+protected:
+    virtual bool onStartElement(const char elem[]) {
+        if (this->flush()) {
+            return true;
+        }
+        if (fSkipDepth > 0) {
+            fSkipDepth += 1;
+            return false;
+        }
+        int element = find_name(gElementNames, SK_ARRAY_COUNT(gElementNames),
+                                elem, strlen(elem));
+        if (kNone_Element == element) {
+            if (NULL == fCanvas) {
+                return this->fail();    // the root has to be svg
+            }
+            fSkipDepth = 1;
+            return false;
+        }
+        fPending = (Element)element;
+        fHas = 0;
+        return false;
+    }
+
+    virtual bool onAddAttribute(const char name[], const char value[]) {
+        if (kNone_Element != fPending) {
+            int attr = find_name(gAttrNames, SK_ARRAY_COUNT(gAttrNames), name,
+                                 strlen(name));
+            if (attr >= 0) {
+                this->setAttr(attr, value, strlen(value));
+            }
+        }
+        return false;
+    }
+
+    virtual bool onEndElement(const char elem[]) {
+        if (this->flush()) {
+            return true;
+        }
+        if (fSkipDepth > 0) {
+            fSkipDepth -= 1;
+            return false;
+        }
+        if (fStates.count() > 0) {
+            fStates.pop();
+            fCanvas->restore();
+        }
+        return false;
+    }
+
+private:
+    SkPicture*          fPicture;
+    SkCanvas*           fCanvas;    // once the root has been seen
+    SkTDArray<State>    fStates;    // one for each open element
+
+    Element     fPending;   // the element whose attributes we're collecting
+    uint32_t    fHas;       // which of fValues have been set
+    SkString    fValues[kAttrCount];
+    int         fSkipDepth; // while inside an element that we skip
+    bool        fFailed;
+
+    bool fail() {
+        fFailed = true;
+        return true;
+    }
+
+    void setAttr(int attr, const char value[], size_t len) {
+        fValues[attr].set(value, len);
+        fHas |= 1 << attr;
+    }
+
+    const char* get(Attr attr) const {
+        return (fHas & (1 << attr)) ? fValues[attr].c_str() : NULL;
+    }
+
+    SkScalar getScalar(Attr attr, SkScalar defaultValue = 0) const {
+        const char* str = this->get(attr);
+        return str ? parse_scalar(str, defaultValue) : defaultValue;
+    }
+
+    // style declarations win over the attributes
+    void applyStyle() {
+        const char* str = this->get(kStyle_Attr);
+        if (NULL == str) {
+            return;
+        }
+        SkString style(str);
+        str = style.c_str();
+        while (*str) {
+            const char* colon = strchr(str, ':');
+            if (NULL == colon) {
+                break;
+            }
+            const char* end = strchr(colon, ';');
+            if (NULL == end) {
+                end = colon + strlen(colon);
+            }
+            const char* name = skip_separators(str);
+            const char* nameStop = colon;
+            while (nameStop > name && ' ' == nameStop[-1]) {
+                nameStop -= 1;
+            }
+            const char* value = skip_separators(colon + 1);
+            const char* valueStop = end;
+            while (valueStop > value && ' ' == valueStop[-1]) {
+                valueStop -= 1;
+            }
+            SkString key(name, nameStop - name);
+            int attr = find_name(gAttrNames, SK_ARRAY_COUNT(gAttrNames),
+                                 key.c_str(), key.size());
+            if (attr >= 0 && kStyle_Attr != attr) {
+                this->setAttr(attr, value, valueStop - value);
+            }
+            str = *end ? end + 1 : end;
+        }
+    }
+
+    void applyPaint(State* state) const {
+        const char* str;
+        if ((str = this->get(kFill_Attr)) != NULL) {
+            parse_paint(str, &state->fFillColor, &state->fFill);
+        }
+        if ((str = this->get(kStroke_Attr)) != NULL) {
+            parse_paint(str, &state->fStrokeColor, &state->fStroke);
+        }
+        state->fFillOpacity = this->getScalar(kFillOpacity_Attr,
+                                              state->fFillOpacity);
+        state->fStrokeOpacity = this->getScalar(kStrokeOpacity_Attr,
+                                                state->fStrokeOpacity);
+        state->fStrokeWidth = this->getScalar(kStrokeWidth_Attr,
+                                              state->fStrokeWidth);
+        state->fMiterLimit = this->getScalar(kStrokeMiterlimit_Attr,
+                                             state->fMiterLimit);
+        if ((str = this->get(kStrokeLinecap_Attr)) != NULL) {
+            int cap = SkParse::FindList(str, "butt,round,square");
+            if (cap >= 0) {
+                state->fCap = cap;
+            }
+        }
+        if ((str = this->get(kStrokeLinejoin_Attr)) != NULL) {
+            int join = SkParse::FindList(str, "miter,round,bevel");
+            if (join >= 0) {
+                state->fJoin = join;
+            }
+        }
+        if ((str = this->get(kFillRule_Attr)) != NULL) {
+            state->fEvenOdd = !strcmp(str, "evenodd");
+        }
+    }
+
+    // returns true to stop parsing
+    bool flush() {
+        Element element = fPending;
+        if (kNone_Element == element) {
+            return false;
+        }
+        fPending = kNone_Element;
+        this->applyStyle();
+
+        const char* display = this->get(kDisplay_Attr);
+        if (display && !strcmp(display, "none")) {
+            fSkipDepth = 1;
+            return false;
+        }
+
+        if (NULL == fCanvas) {
+            if (kSVG_Element != element || !this->beginRecording()) {
+                return this->fail();
+            }
+        }
+
+        State state;
+        if (fStates.count() > 0) {
+            state = fStates.top();
+        } else {
+            state.setDefaults();
+        }
+        this->applyPaint(&state);
+        *fStates.append() = state;
+
+        SkScalar opacity = this->getScalar(kOpacity_Attr, SK_Scalar1);
+        if (opacity < SK_Scalar1) {
+            fCanvas->saveLayerAlpha(NULL, opacity_to_alpha(opacity));
+        } else {
+            fCanvas->save();
+        }
+
+        const char* transform = this->get(kTransform_Attr);
+        if (transform) {
+            SkMatrix matrix;
+            if (parse_transform(transform, &matrix)) {
+                fCanvas->concat(matrix);
+            }
+        }
+
+        this->draw(element, state);
+        return false;
+    }
+
+    bool beginRecording() {
+        SkScalar box[4];
+        const char* viewBox = this->get(kViewBox_Attr);
+        bool hasBox = viewBox && 4 == parse_scalars(viewBox, box, 4) &&
+                      box[2] > 0 && box[3] > 0;
+
+        // without a size or a viewBox, svgs are 300 x 150
+        SkScalar width = this->getScalar(kWidth_Attr,
+                                hasBox ? box[2] : SkIntToScalar(300));
+        SkScalar height = this->getScalar(kHeight_Attr,
+                                hasBox ? box[3] : SkIntToScalar(150));
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+
+        fCanvas = fPicture->beginRecording(SkScalarCeil(width),
+                                           SkScalarCeil(height));
+        if (hasBox) {
+            // stretch the box over the picture, ignoring preserveAspectRatio
+            fCanvas->scale(SkScalarDiv(width, box[2]),
+                           SkScalarDiv(height, box[3]));
+            fCanvas->translate(-box[0], -box[1]);
+        }
+        // the svg's own x and y only mean something when it is nested
+        fHas &= ~((1 << kX_Attr) | (1 << kY_Attr));
+        return true;
+    }
+
+    void draw(Element element, const State& state) {
+        SkPath path;
+        switch (element) {
+            case kSVG_Element: {
+                SkScalar x = this->getScalar(kX_Attr);
+                SkScalar y = this->getScalar(kY_Attr);
+                if (x || y) {
+                    fCanvas->translate(x, y);
+                }
+                return;
+            }
+            case kG_Element:
+                return;
+            case kPath_Element: {
+                const char* d = this->get(kD_Attr);
+                if (NULL == d || !SkParsePath::FromSVGString(d, &path)) {
+                    return;
+                }
+                break;
+            }
+            case kRect_Element: {
+                SkRect r = SkRect::MakeXYWH(this->getScalar(kX_Attr),
+                                            this->getScalar(kY_Attr),
+                                            this->getScalar(kWidth_Attr),
+                                            this->getScalar(kHeight_Attr));
+                if (r.isEmpty()) {
+                    return;
+                }
+                SkScalar rx = this->getScalar(kRx_Attr, -1);
+                SkScalar ry = this->getScalar(kRy_Attr, -1);
+                if (rx < 0) {
+                    rx = ry;
+                } else if (ry < 0) {
+                    ry = rx;
+                }
+                if (rx > 0 && ry > 0) {
+                    path.addRoundRect(r, SkMinScalar(rx, r.width() / 2),
+                                      SkMinScalar(ry, r.height() / 2));
+                } else {
+                    path.addRect(r);
+                }
+                break;
+            }
+            case kCircle_Element: {
+                SkScalar r = this->getScalar(kR_Attr);
+                if (r <= 0) {
+                    return;
+                }
+                path.addCircle(this->getScalar(kCx_Attr),
+                               this->getScalar(kCy_Attr), r);
+                break;
+            }
+            case kEllipse_Element: {
+                SkScalar rx = this->getScalar(kRx_Attr);
+                SkScalar ry = this->getScalar(kRy_Attr);
+                if (rx <= 0 || ry <= 0) {
+                    return;
+                }
+                SkScalar cx = this->getScalar(kCx_Attr);
+                SkScalar cy = this->getScalar(kCy_Attr);
+                SkRect oval = { cx - rx, cy - ry, cx + rx, cy + ry };
+                path.addOval(oval);
+                break;
+            }
+            case kLine_Element:
+                path.moveTo(this->getScalar(kX1_Attr),
+                            this->getScalar(kY1_Attr));
+                path.lineTo(this->getScalar(kX2_Attr),
+                            this->getScalar(kY2_Attr));
+                break;
+            case kPolyline_Element:
+            case kPolygon_Element: {
+                const char* str = this->get(kPoints_Attr);
+                SkScalar xy[2];
+                while (str && 2 == parse_scalars(str, xy, 2, &str)) {
+                    if (0 == path.countPoints()) {
+                        path.moveTo(xy[0], xy[1]);
+                    } else {
+                        path.lineTo(xy[0], xy[1]);
+                    }
+                }
+                if (path.countPoints() < 2) {
+                    return;
+                }
+                if (kPolygon_Element == element) {
+                    path.close();
+                }
+                break;
+            }
+            default:
+                SkASSERT(!"unexpected element");
+                return;
+        }
+
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        if (state.fFill && kLine_Element != element) {
+            path.setFillType(state.fEvenOdd ? SkPath::kEvenOdd_FillType
+                                            : SkPath::kWinding_FillType);
+            paint.setColor(state.fFillColor);
+            set_paint_alpha(&paint, state.fFillOpacity);
+            fCanvas->drawPath(path, paint);
+        }
+        if (state.fStroke && state.fStrokeWidth > 0) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setColor(state.fStrokeColor);
+            set_paint_alpha(&paint, state.fStrokeOpacity);
+            paint.setStrokeWidth(state.fStrokeWidth);
+            paint.setStrokeMiter(state.fMiterLimit);
+            paint.setStrokeCap((SkPaint::Cap)state.fCap);
+            paint.setStrokeJoin((SkPaint::Join)state.fJoin);
+            fCanvas->drawPath(path, paint);
+        }
+    }
+};
+
+}  // namespace
+
+static SkPicture* finish_picture(SVGPictureParser* parser, bool parsed,
+                                 SkPicture* picture) {
+    if (!parser->finish() || !parsed) {
+        picture->unref();
+        return NULL;
+    }
+    return picture;
+}
+
+SkPicture* SkSVGPicture::CreateFromStream(SkStream* stream) {
+    SkPicture* picture = SkNEW(SkPicture);
+    SVGPictureParser parser(picture);
+    bool parsed = parser.parse(*stream);
+    return finish_picture(&parser, parsed, picture);
+}
+
+SkPicture* SkSVGPicture::CreateFromData(const void* data, size_t length) {
+    SkPicture* picture = SkNEW(SkPicture);
+    SVGPictureParser parser(picture);
+    bool parsed = parser.parse((const char*)data, length);
+    return finish_picture(&parser, parsed, picture);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct CacheRec {
+    uint32_t    fHash;
+    SkData*     fDocument;  // a copy, to rule out collisions
+    SkPicture*  fPicture;
+};
+
+}  // namespace
+
+// oldest first
+static SkMutex              gCacheMutex;
+static SkTDArray<CacheRec>  gCache;
+
+#define kMaxCachedPictures  32
+
+static uint32_t hash_document(const void* data, size_t length) {
+    // FNV-1a
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619;
+    }
+    return hash;
+}
+
+static void free_rec(const CacheRec& rec) {
+    rec.fDocument->unref();
+    rec.fPicture->unref();
+}
+
+SkPicture* SkSVGPicture::RefCached(const void* data, size_t length) {
+    uint32_t hash = hash_document(data, length);
+    {
+        SkAutoMutexAcquire ac(gCacheMutex);
+        for (int i = gCache.count() - 1; i >= 0; --i) {
+            const CacheRec& rec = gCache[i];
+            if (rec.fHash == hash && rec.fDocument->size() == length &&
+                    !memcmp(rec.fDocument->data(), data, length)) {
+                CacheRec found = rec;
+                gCache.remove(i);
+                *gCache.append() = found;
+                found.fPicture->ref();
+                return found.fPicture;
+            }
+        }
+    }
+
+    // parse without holding the lock
+    SkPicture* picture = CreateFromData(data, length);
+    if (NULL == picture) {
+        return NULL;
+    }
+
+    CacheRec rec;
+    rec.fHash = hash;
+    rec.fDocument = SkData::NewWithCopy(data, length);
+    rec.fPicture = picture;
+    picture->ref();
+
+    SkAutoMutexAcquire ac(gCacheMutex);
+    *gCache.append() = rec;
+    if (gCache.count() > kMaxCachedPictures) {
+        free_rec(gCache[0]);
+        gCache.remove(0);
+    }
+    return picture;
+}
+
+void SkSVGPicture::PurgeCache() {
+    SkAutoMutexAcquire ac(gCacheMutex);
+    for (int i = 0; i < gCache.count(); i++) {
+        free_rec(gCache[i]);
+    }
+    gCache.reset();
+}
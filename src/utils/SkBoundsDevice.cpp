@@ -0,0 +1,383 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkBoundsDevice.h"
+#include "SkDraw.h"
+#include "SkDrawLooper.h"
+#include "SkMaskFilter.h"
+#include "SkTemplates.h"
+
+// a bitmap without pixels, since nothing is ever drawn into them
+static SkBitmap make_bitmap(int width, int height) {
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    return bitmap;
+}
+
+SkBoundsDevice::SkBoundsDevice(int width, int height)
+        : INHERITED(make_bitmap(width, height))
+        , fRecordDraws(false) {
+    fDrawnBounds.setEmpty();
+}
+
+void SkBoundsDevice::reset() {
+    fDrawnBounds.setEmpty();
+    fDraws.reset();
+}
+
+void SkBoundsDevice::addDrawBounds(const SkIRect& bounds) {
+    fDrawnBounds.join(bounds);
+    if (fRecordDraws) {
+        *fDraws.append() = bounds;
+    }
+}
+
+static void clip_bounds(const SkDraw& draw, SkRect* bounds) {
+    bounds->set(draw.fClip->getBounds());
+}
+
+void SkBoundsDevice::addDeviceBounds(const SkDraw& draw, const SkRect& bounds,
+                                     unsigned flags) {
+    SkRect clip;
+    clip_bounds(draw, &clip);
+    // clipping first keeps far away (or NaN) bounds from overflowing ints
+    SkRect r = bounds;
+    SkIRect ir;
+    if (!r.intersect(clip)) {
+        ir.setEmpty();
+    } else if (flags & kRound_BoundsFlag) {
+        r.round(&ir);
+    } else {
+        r.roundOut(&ir);
+    }
+    this->addDrawBounds(ir);
+}
+
+// Outset r by how far the paint's mask filter and looper can draw beyond
+// it, and return true, or return false if they can't tell. This is for
+// geometry that is drawn filled, whatever the paint's style.
+static bool outset_by_filters(const SkPaint& paint, SkRect* r) {
+    if (paint.getRasterizer()) {
+        return false;
+    }
+    SkRect outset;
+    outset.setEmpty();
+    SkMaskFilter* filter = paint.getMaskFilter();
+    if (filter && !filter->computeFastBoundsOutset(&outset)) {
+        return false;
+    }
+    SkDrawLooper* looper = paint.getLooper();
+    if (looper && !looper->computeFastBoundsOutset(&outset)) {
+        return false;
+    }
+    r->set(r->fLeft + outset.fLeft, r->fTop + outset.fTop,
+           r->fRight + outset.fRight, r->fBottom + outset.fBottom);
+    return true;
+}
+
+void SkBoundsDevice::addShapeBounds(const SkDraw& draw, const SkMatrix& matrix,
+                                    const SkRect& bounds, const SkPaint& paint,
+                                    unsigned flags) {
+    SkRect r = bounds;
+    bool bounded;
+    if (flags & kFilled_BoundsFlag) {
+        bounded = outset_by_filters(paint, &r);
+    } else if ((bounded = paint.canComputeFastBounds())) {
+        SkRect storage;
+        r = paint.computeFastBounds(bounds, &storage);
+        if (paint.getStyle() != SkPaint::kFill_Style) {
+            SkScalar width = paint.getStrokeWidth();
+            if (0 == width) {
+                // a hairline is a pixel wide whatever the matrix
+                flags |= kOutset_BoundsFlag;
+            } else if (SkPaint::kSquare_Cap == paint.getStrokeCap()) {
+                // the corners of a square cap on a diagonal line reach
+                // further than computeFastBounds() allows for
+                SkScalar extra = SkScalarMul(SkScalarHalf(width),
+                                             SK_ScalarSqrt2 - SK_Scalar1);
+                r.inset(-extra, -extra);
+            }
+        }
+    }
+    if (!bounded || matrix.hasPerspective()) {
+        clip_bounds(draw, &r);
+        this->addDeviceBounds(draw, r);
+        return;
+    }
+
+    matrix.mapRect(&r);
+    SkScalar pad = 0;
+    if (flags & kOutset_BoundsFlag) {
+        pad += SK_Scalar1;
+    }
+    if (paint.getMaskFilter()) {
+        // a blur's rounding doesn't scale with the matrix as its radius does
+        pad += SkIntToScalar(3);
+        flags &= ~kRound_BoundsFlag;
+    }
+    r.inset(-pad, -pad);
+    this->addDeviceBounds(draw, r, flags);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkBoundsDevice::clear(SkColor color) {
+    SkIRect bounds;
+    this->getBounds(&bounds);
+    this->addDrawBounds(bounds);
+}
+
+void SkBoundsDevice::drawPaint(const SkDraw& draw, const SkPaint& paint) {
+    SkRect bounds;
+    clip_bounds(draw, &bounds);
+    this->addDeviceBounds(draw, bounds);
+}
+
+void SkBoundsDevice::drawPoints(const SkDraw& draw, SkCanvas::PointMode mode,
+                                size_t count, const SkPoint pts[],
+                                const SkPaint& paint) {
+    if (0 == count) {
+        return;
+    }
+    SkRect bounds;
+    bounds.set(pts, count);
+    if (SkPaint::kFill_Style == paint.getStyle()) {
+        // points and lines are stroked whatever the style
+        SkPaint stroked(paint);
+        stroked.setStyle(SkPaint::kStroke_Style);
+        this->addShapeBounds(draw, *draw.fMatrix, bounds, stroked);
+    } else {
+        this->addShapeBounds(draw, *draw.fMatrix, bounds, paint);
+    }
+}
+
+void SkBoundsDevice::drawRect(const SkDraw& draw, const SkRect& r,
+                              const SkPaint& paint) {
+    SkRect bounds = r;
+    bounds.sort();
+    unsigned flags = 0;
+    // these are filled by rounding their edges, as SkScan::FillRect() does
+    if (!paint.isAntiAlias() && SkPaint::kFill_Style == paint.getStyle() &&
+            NULL == paint.getPathEffect() && draw.fMatrix->rectStaysRect()) {
+        flags |= kRound_BoundsFlag;
+    }
+    this->addShapeBounds(draw, *draw.fMatrix, bounds, paint, flags);
+}
+
+void SkBoundsDevice::drawPath(const SkDraw& draw, const SkPath& path,
+                              const SkPaint& paint,
+                              const SkMatrix* prePathMatrix, bool) {
+    if (path.isInverseFillType()) {
+        this->drawPaint(draw, paint);
+        return;
+    }
+    if (path.isEmpty()) {
+        this->addDrawBounds(SkIRect::MakeEmpty());
+        return;
+    }
+    SkRect bounds = path.getBounds();
+    if (prePathMatrix) {
+        prePathMatrix->mapRect(&bounds);
+    }
+    this->addShapeBounds(draw, *draw.fMatrix, bounds, paint);
+}
+
+void SkBoundsDevice::drawBitmap(const SkDraw& draw, const SkBitmap& bitmap,
+                                const SkIRect* srcRectOrNull,
+                                const SkMatrix& matrix, const SkPaint& paint) {
+    SkRect bounds;
+    if (srcRectOrNull) {
+        bounds.set(0, 0, SkIntToScalar(srcRectOrNull->width()),
+                   SkIntToScalar(srcRectOrNull->height()));
+    } else {
+        bounds.set(0, 0, SkIntToScalar(bitmap.width()),
+                   SkIntToScalar(bitmap.height()));
+    }
+    // bitmaps are always filled
+    if (NULL == paint.getMaskFilter() && NULL == paint.getLooper()) {
+        SkMatrix total;
+        total.setConcat(*draw.fMatrix, matrix);
+        unsigned flags = kFilled_BoundsFlag;
+        if (!paint.isAntiAlias() && total.rectStaysRect()) {
+            flags |= kRound_BoundsFlag;
+        }
+        this->addShapeBounds(draw, total, bounds, paint, flags);
+    } else {
+        // the filters' outsets are in the canvas' local coordinates
+        matrix.mapRect(&bounds);
+        this->addShapeBounds(draw, *draw.fMatrix, bounds, paint,
+                             kFilled_BoundsFlag);
+    }
+}
+
+void SkBoundsDevice::drawSprite(const SkDraw& draw, const SkBitmap& bitmap,
+                                int x, int y, const SkPaint& paint) {
+    SkRect bounds;
+    bounds.set(SkIRect::MakeXYWH(x, y, bitmap.width(), bitmap.height()));
+    this->addDeviceBounds(draw, bounds, kRound_BoundsFlag);
+}
+
+static SkScalar align_scale(const SkPaint& paint) {
+    switch (paint.getTextAlign()) {
+        case SkPaint::kCenter_Align:
+            return SK_ScalarHalf;
+        case SkPaint::kRight_Align:
+            return SK_Scalar1;
+        default:
+            return 0;
+    }
+}
+
+void SkBoundsDevice::drawText(const SkDraw& draw, const void* text,
+                              size_t len, SkScalar x, SkScalar y,
+                              const SkPaint& paint) {
+    // the glyphs' bounds already include any stroke or path effect
+    SkRect bounds;
+    SkScalar width = paint.measureText(text, len, &bounds);
+    SkScalar left = x - SkScalarMul(width, align_scale(paint));
+    bounds.offset(left, y);
+    if (paint.getFlags() & (SkPaint::kUnderlineText_Flag |
+                            SkPaint::kStrikeThruText_Flag)) {
+        // generously around where SkDraw puts the lines
+        SkScalar size = paint.getTextSize();
+        bounds.join(left, y - SkScalarHalf(size), left + width,
+                    y + SkScalarHalf(SkScalarHalf(size)));
+    }
+    if (bounds.isEmpty()) {
+        this->addDrawBounds(SkIRect::MakeEmpty());
+        return;
+    }
+    this->addShapeBounds(draw, *draw.fMatrix, bounds, paint,
+                         kFilled_BoundsFlag | kOutset_BoundsFlag);
+}
+
+void SkBoundsDevice::drawPosText(const SkDraw& draw, const void* text,
+                                 size_t len, const SkScalar pos[],
+                                 SkScalar constY, int scalarsPerPos,
+                                 const SkPaint& paint) {
+    SkASSERT(1 == scalarsPerPos || 2 == scalarsPerPos);
+    int count = paint.countText(text, len);
+    SkAutoSTMalloc<64, SkScalar> widthStorage(count);
+    SkAutoSTMalloc<64, SkRect> boundsStorage(count);
+    SkScalar* widths = widthStorage.get();
+    SkRect* glyphBounds = boundsStorage.get();
+    count = paint.getTextWidths(text, len, widths, glyphBounds);
+
+    // each glyph is aligned on its own position
+    const SkScalar scale = align_scale(paint);
+    SkRect bounds;
+    bounds.setEmpty();
+    for (int i = 0; i < count; i++) {
+        SkRect r = glyphBounds[i];
+        if (r.isEmpty()) {
+            continue;
+        }
+        SkScalar x = pos[i * scalarsPerPos];
+        SkScalar y = 1 == scalarsPerPos ? constY : pos[i * 2 + 1];
+        r.offset(x - SkScalarMul(widths[i], scale), y);
+        bounds.join(r);
+    }
+    if (bounds.isEmpty()) {
+        this->addDrawBounds(SkIRect::MakeEmpty());
+        return;
+    }
+    this->addShapeBounds(draw, *draw.fMatrix, bounds, paint,
+                         kFilled_BoundsFlag | kOutset_BoundsFlag);
+}
+
+void SkBoundsDevice::drawTextOnPath(const SkDraw& draw, const void* text,
+                                    size_t len, const SkPath& path,
+                                    const SkMatrix* matrix,
+                                    const SkPaint& paint) {
+    // Each glyph is bent so that its baseline follows the path, and its
+    // points along the path are pinned to the path's ends, so the glyphs
+    // stay within their greatest distance from the baseline of the path.
+    SkPaint::FontMetrics metrics;
+    paint.getFontMetrics(&metrics);
+    SkRect box;
+    box.set(metrics.fXMin, metrics.fTop,
+            paint.measureText(text, len) + metrics.fXMax, metrics.fBottom);
+    if (matrix) {
+        matrix->mapRect(&box);
+    }
+    SkScalar radius = SkMaxScalar(SkScalarAbs(box.fTop),
+                                  SkScalarAbs(box.fBottom));
+    SkRect bounds = path.getBounds();
+    bounds.inset(-radius, -radius);
+    // the bent glyphs are stroked as paths would be
+    this->addShapeBounds(draw, *draw.fMatrix, bounds, paint,
+                         kOutset_BoundsFlag);
+}
+
+#ifdef ANDROID
+void SkBoundsDevice::drawPosTextOnPath(const SkDraw& draw, const void* text,
+                                       size_t len, const SkPoint pos[],
+                                       const SkPaint& paint,
+                                       const SkPath& path,
+                                       const SkMatrix* matrix) {
+    this->drawPaint(draw, paint);
+}
+#endif
+
+void SkBoundsDevice::drawVertices(const SkDraw& draw,
+                                  SkCanvas::VertexMode vmode,
+                                  int vertexCount, const SkPoint verts[],
+                                  const SkPoint texs[],
+                                  const SkColor colors[], SkXfermode* xmode,
+                                  const uint16_t indices[], int indexCount,
+                                  const SkPaint& paint) {
+    if (vertexCount <= 0) {
+        return;
+    }
+    SkRect bounds;
+    bounds.set(verts, vertexCount);
+    // without a shader or colors, the triangles are drawn as hairlines
+    this->addShapeBounds(draw, *draw.fMatrix, bounds, paint,
+                         kOutset_BoundsFlag);
+}
+
+// our canvas only draws devices when it restores a layer, and those are
+// always ours (see onCreateCompatibleDevice)
+void SkBoundsDevice::drawDevice(const SkDraw& draw, SkDevice* device,
+                                int x, int y, const SkPaint& paint) {
+    const SkBoundsDevice* layer = static_cast<SkBoundsDevice*>(device);
+    const SkIRect& clip = draw.fClip->getBounds();
+    SkIRect bounds;
+    if (fRecordDraws) {
+        for (int i = 0; i < layer->countDraws(); i++) {
+            bounds = layer->drawBoundsAt(i);
+            bounds.offset(x, y);
+            if (!bounds.intersect(clip)) {
+                bounds.setEmpty();
+            }
+            this->addDrawBounds(bounds);
+        }
+    }
+    bounds = layer->drawnBounds();
+    bounds.offset(x, y);
+    if (bounds.intersect(clip)) {
+        fDrawnBounds.join(bounds);
+    }
+}
+
+SkDevice* SkBoundsDevice::onCreateCompatibleDevice(SkBitmap::Config,
+                                                   int width, int height,
+                                                   bool, Usage) {
+    SkBoundsDevice* device = SkNEW_ARGS(SkBoundsDevice, (width, height));
+    device->setRecordDraws(fRecordDraws);
+    return device;
+}
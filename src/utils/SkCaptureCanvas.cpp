@@ -0,0 +1,125 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkCaptureCanvas.h"
+#include "SkDevice.h"
+#include "SkPicture.h"
+#include "SkStream.h"
+#include "SkThread.h"
+
+SkCaptureCanvas::Slot::Slot() : fPicture(SkNEW(SkPicture)), fBusy(0) {}
+
+SkCaptureCanvas::Slot::~Slot() {
+    SkDELETE(fPicture);
+}
+
+void SkCaptureCanvas::Slot::run() {
+    {
+        SkFILEWStream stream(fPath.c_str());
+        fPicture->serialize(&stream);
+    }
+    // the picture can be reused once this is seen, so it comes last
+    sk_atomic_dec(&fBusy);
+}
+
+bool SkCaptureCanvas::Slot::isBusy() {
+    return 0 != sk_atomic_add(&fBusy, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkCaptureCanvas::SkCaptureCanvas(SkCanvas* target, const char dir[],
+                                 int frameInterval, int ringCount)
+        : fWriter(1) {
+    SkASSERT(ringCount > 0);
+    this->addCanvas(target);
+
+    // SkCanvas quick-rejects some draws (e.g. drawCircle) against our own
+    // clip before they reach the overrides, so give it the target's bounds
+    SkDevice* device = target->getDevice();
+    if (device) {
+        SkBitmap bm;
+        bm.setConfig(SkBitmap::kNo_Config, device->width(), device->height());
+        this->setBitmapDevice(bm);
+    }
+
+    fRingCount = SkMax32(ringCount, 1);
+    fFrameInterval = SkMax32(frameInterval, 0);
+    fFrameCount = 0;
+    fCaptureCount = 0;
+    fDroppedCount = 0;
+    fRecordingSlot = NULL;
+
+    fSlots = SkNEW_ARRAY(Slot, fRingCount);
+    for (int i = 0; i < fRingCount; i++) {
+        fSlots[i].fPath.set(dir);
+        if (!fSlots[i].fPath.isEmpty() && !fSlots[i].fPath.endsWith("/")) {
+            fSlots[i].fPath.append("/");
+        }
+        fSlots[i].fPath.appendf("capture_%d.skp", i);
+    }
+}
+
+SkCaptureCanvas::~SkCaptureCanvas() {
+    if (fRecordingSlot) {
+        this->removeCanvas(fRecordingSlot->fPicture->getRecordingCanvas());
+    }
+    fWriter.wait();
+    SkDELETE_ARRAY(fSlots);
+}
+
+bool SkCaptureCanvas::beginFrame(int width, int height) {
+    SkASSERT(NULL == fRecordingSlot);
+
+    int frame = fFrameCount++;
+    if (0 == fFrameInterval || frame % fFrameInterval) {
+        return false;
+    }
+
+    Slot* slot = &fSlots[fCaptureCount % fRingCount];
+    if (slot->isBusy()) {
+        fDroppedCount += 1;
+        return false;
+    }
+
+    this->addCanvas(slot->fPicture->beginRecording(width, height));
+    fRecordingSlot = slot;
+    return true;
+}
+
+void SkCaptureCanvas::endFrame() {
+    Slot* slot = fRecordingSlot;
+    if (NULL == slot) {
+        return;
+    }
+    fRecordingSlot = NULL;
+
+    this->removeCanvas(slot->fPicture->getRecordingCanvas());
+    slot->fPicture->endRecording();
+
+    sk_atomic_inc(&slot->fBusy);
+    fWriter.add(slot);
+    if (0 == fWriter.threadCount()) {
+        // no threads on this platform, so write it out now
+        fWriter.wait();
+    }
+    fCaptureCount += 1;
+}
+
+void SkCaptureCanvas::flush() {
+    fWriter.wait();
+}
@@ -31,13 +31,22 @@ static bool cross_product_is_neg(const SkIPoint& v, int dx, int dy) {
 #endif
 }
 
-bool SkCullPoints::sect_test(int x0, int y0, int x1, int y1) const {
+// the bits for the sides of fR that (x,y) is outside of, so that each point
+// is only compared with fR once, and a segment is clipped out if both of
+// its ends share a bit
+unsigned SkCullPoints::outcode(int x, int y) const {
+    const SkIRect& r = fR;
+    return  (unsigned)(x < r.fLeft) |
+           ((unsigned)(x > r.fRight) << 1) |
+           ((unsigned)(y < r.fTop) << 2) |
+           ((unsigned)(y > r.fBottom) << 3);
+}
+
+bool SkCullPoints::sect_test(int x0, int y0, unsigned code0,
+                             int x1, int y1, unsigned code1) const {
     const SkIRect& r = fR;
 
-    if ((x0 < r.fLeft    && x1 < r.fLeft) ||
-        (x0 > r.fRight   && x1 > r.fRight) ||
-        (y0 < r.fTop     && y1 < r.fTop) ||
-        (y0 > r.fBottom  && y1 > r.fBottom)) {
+    if (code0 & code1) {
         return false;
     }
 
@@ -83,11 +92,13 @@ void SkCullPoints::reset(const SkIRect& r) {
     fR = r;
     toQuad(fR, fAsQuad);
     fPrevPt.set(0, 0);
+    fPrevCode = this->outcode(0, 0);
     fPrevResult = kNo_Result;
 }
 
 void SkCullPoints::moveTo(int x, int y) {
     fPrevPt.set(x, y);
+    fPrevCode = this->outcode(x, y);
     fPrevResult = kNo_Result;   // so we trigger a movetolineto later
 }
 
@@ -97,11 +108,12 @@ SkCullPoints::LineToResult SkCullPoints::lineTo(int x, int y, SkIPoint line[]) {
     LineToResult result = kNo_Result;
     int x0 = fPrevPt.fX;
     int y0 = fPrevPt.fY;
+    unsigned code = this->outcode(x, y);
     
     // need to upgrade sect_test to chop the result
     // and to correctly return kLineTo_Result when the result is connected
     // to the previous call-out
-    if (this->sect_test(x0, y0, x, y)) {
+    if (this->sect_test(x0, y0, fPrevCode, x, y, code)) {
         line[0].set(x0, y0);
         line[1].set(x, y);
         
@@ -113,6 +125,7 @@ SkCullPoints::LineToResult SkCullPoints::lineTo(int x, int y, SkIPoint line[]) {
     }
 
     fPrevPt.set(x, y);
+    fPrevCode = code;
     fPrevResult = result;
 
     return result;
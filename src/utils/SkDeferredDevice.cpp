@@ -0,0 +1,693 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkDeferredDevice.h"
+#include "SkDraw.h"
+#include "SkPixelRef.h"
+#include "SkXfermode.h"
+
+// every queued draw that is covered is looked for in the queue, so keep it
+// short enough for that to stay cheap
+#define DEFERRED_MAX_QUEUED         256
+// copies of mutable bitmaps, waiting to be drawn
+#define DEFERRED_MAX_COPIED_BYTES   (4 * 1024 * 1024)
+
+// the device pixels that a draw of local with paint may touch
+static SkIRect device_bounds(const SkRect& local, const SkMatrix& matrix,
+                             const SkPaint& paint, const SkRegion& clip) {
+    SkIRect bounds = clip.getBounds();
+    if (!paint.canComputeFastBounds()) {
+        return bounds;
+    }
+
+    SkRect r = local;
+    if (paint.getStyle() != SkPaint::kFill_Style) {
+        // more than computeFastBounds(), which a square cap at 45 degrees
+        // can exceed
+        SkScalar outset = SkScalarMul(paint.getStrokeWidth(),
+                             SkMaxScalar(paint.getStrokeMiter(), SK_Scalar1));
+        r.inset(-outset, -outset);
+    }
+    // and for the paint's effects (which counts the stroke again)
+    SkRect storage;
+    r = paint.computeFastBounds(r, &storage);
+    SkRect devR;
+    matrix.mapRect(&devR, r);
+    SkIRect ir;
+    devR.roundOut(&ir);
+    // for antialiasing and hairlines
+    ir.inset(-1, -1);
+    if (!bounds.intersect(ir)) {
+        bounds.setEmpty();
+    }
+    return bounds;
+}
+
+// true if pixels drawn with paint do not depend on what was there before
+static bool overwrites(const SkPaint& paint, bool srcIsOpaque) {
+    if (paint.getMaskFilter() || paint.getLooper() || paint.getRasterizer()) {
+        return false;
+    }
+    SkXfermode::Mode mode;
+    if (!SkXfermode::AsMode(paint.getXfermode(), &mode)) {
+        return false;
+    }
+    switch (mode) {
+        case SkXfermode::kClear_Mode:
+        case SkXfermode::kSrc_Mode:
+            return true;
+        case SkXfermode::kSrcOver_Mode:
+            return srcIsOpaque && 0xFF == paint.getAlpha() &&
+                   NULL == paint.getShader() && NULL == paint.getColorFilter();
+        default:
+            return false;
+    }
+}
+
+// true if paint fills a rect as a rect, without changing its shape
+static bool is_plain_rect_fill(const SkPaint& paint, const SkMatrix& matrix) {
+    return SkPaint::kFill_Style == paint.getStyle() &&
+           NULL == paint.getPathEffect() && NULL == paint.getMaskFilter() &&
+           NULL == paint.getRasterizer() && NULL == paint.getLooper() &&
+           matrix.rectStaysRect();
+}
+
+static void map_rect(const SkMatrix& matrix, const SkRect& r, SkRect* dst) {
+    // in the same way as SkDraw::drawRect()
+    SkPoint pts[2];
+    matrix.mapXY(r.fLeft, r.fTop, &pts[0]);
+    matrix.mapXY(r.fRight, r.fBottom, &pts[1]);
+    dst->set(pts[0].fX, pts[0].fY, pts[1].fX, pts[1].fY);
+    dst->sort();
+}
+
+static bool is_integral(SkScalar x) {
+    return SkIntToScalar(SkScalarRound(x)) == x;
+}
+
+static bool is_integral(const SkRect& r) {
+    return is_integral(r.fLeft) && is_integral(r.fTop) &&
+           is_integral(r.fRight) && is_integral(r.fBottom);
+}
+
+// if a and b share a whole edge, set joined to their union and return true
+template <typename R> static bool join_rects(const R& a, const R& b,
+                                             R* joined) {
+    if (a.isEmpty() || b.isEmpty()) {
+        return false;
+    }
+    if (a.fTop == b.fTop && a.fBottom == b.fBottom) {
+        if (a.fRight != b.fLeft && b.fRight != a.fLeft) {
+            return false;
+        }
+    } else if (a.fLeft == b.fLeft && a.fRight == b.fRight) {
+        if (a.fBottom != b.fTop && b.fBottom != a.fTop) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    *joined = a;
+    joined->join(b);
+    return true;
+}
+
+// where bitmap's top left pixel sits in its pixelref
+static SkIPoint pixel_ref_origin(const SkBitmap& bitmap) {
+    SkIPoint origin;
+    size_t offset = bitmap.pixelRefOffset();
+    origin.set((offset % bitmap.rowBytes()) / bitmap.bytesPerPixel(),
+               offset / bitmap.rowBytes());
+    return origin;
+}
+
+// a copy of src that later changes to its pixels will not show up in
+static bool snapshot(const SkBitmap& src, SkBitmap* dst, size_t* copied) {
+    const SkPixelRef* pr = src.pixelRef();
+    if (pr && pr->isImmutable()) {
+        *dst = src;
+        return true;
+    }
+    if (!src.copyTo(dst, src.config())) {
+        return false;
+    }
+    dst->setIsOpaque(src.isOpaque());
+    *copied = dst->getSize();
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  A queued draw, with the state it was made with. fBounds holds every pixel
+    it may touch, and fCovers every pixel (within fClip) that it overwrites.
+ */
+class SkDeferredDevice::Cmd {
+public:
+    enum Type {
+        kOther_Type,
+        kRect_Type,
+        kSprite_Type
+    };
+
+    Cmd(Type type, const SkDraw& draw, const SkPaint& paint)
+            : fMatrix(*draw.fMatrix), fClip(*draw.fClip), fPaint(paint),
+              fType(type), fCopiedBytes(0) {
+        fBounds = fClip.getBounds();
+        fCovers.setEmpty();
+    }
+    virtual ~Cmd() {}
+
+    virtual void playback(const SkDraw&) = 0;
+    /** If other can be drawn as part of this draw, take it on and return
+        true. Both are the most recently queued draws, this one first.
+     */
+    virtual bool absorb(const Cmd& other) { return false; }
+
+    bool covers(const SkIRect& r) const {
+        return fCovers.contains(r) && fClip.contains(r);
+    }
+
+    SkMatrix    fMatrix;
+    SkRegion    fClip;
+    SkPaint     fPaint;
+    SkIRect     fBounds;
+    SkIRect     fCovers;
+    Type        fType;
+    size_t      fCopiedBytes;
+
+protected:
+    bool sameState(const Cmd& other) const {
+        return fType == other.fType && fPaint == other.fPaint &&
+               fMatrix == other.fMatrix && fClip == other.fClip;
+    }
+};
+
+namespace {
+
+typedef SkDeferredDevice::Cmd Cmd;
+
+class PaintCmd : public Cmd {
+public:
+    PaintCmd(const SkDraw& draw, const SkPaint& paint)
+            : Cmd(kOther_Type, draw, paint) {
+        if (overwrites(paint, true)) {
+            fCovers = fBounds;
+        }
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawPaint(fPaint);
+    }
+};
+
+class PointsCmd : public Cmd {
+public:
+    PointsCmd(const SkDraw& draw, SkCanvas::PointMode mode, size_t count,
+              const SkPoint pts[], const SkPaint& paint)
+            : Cmd(kOther_Type, draw, paint), fMode(mode) {
+        fPts.append(count, pts);
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawPoints(fMode, fPts.count(), fPts.begin(), fPaint);
+    }
+
+private:
+    SkCanvas::PointMode fMode;
+    SkTDArray<SkPoint>  fPts;
+};
+
+class RectCmd : public Cmd {
+public:
+    RectCmd(const SkDraw& draw, const SkRect& r, const SkPaint& paint)
+            : Cmd(kRect_Type, draw, paint), fRect(r) {
+        this->computeBounds();
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawRect(fRect, fPaint);
+    }
+    virtual bool absorb(const Cmd& other) {
+        if (!this->sameState(other) ||
+                !is_plain_rect_fill(fPaint, fMatrix)) {
+            return false;
+        }
+        const SkRect& r = static_cast<const RectCmd&>(other).fRect;
+        if (fPaint.isAntiAlias()) {
+            // blending two partially covered edges is not the same as not
+            // having an edge there at all
+            SkRect a, b;
+            map_rect(fMatrix, fRect, &a);
+            map_rect(fMatrix, r, &b);
+            if (!is_integral(a) || !is_integral(b)) {
+                return false;
+            }
+        }
+        // without antialiasing each edge is rounded, so abutting rects share
+        // the rounded edge too
+        if (!join_rects(fRect, r, &fRect)) {
+            return false;
+        }
+        this->computeBounds();
+        return true;
+    }
+
+private:
+    SkRect  fRect;
+
+    void computeBounds() {
+        fBounds = device_bounds(fRect, fMatrix, fPaint, fClip);
+        if (is_plain_rect_fill(fPaint, fMatrix) && overwrites(fPaint, true)) {
+            // just the pixels that are entirely inside
+            SkRect devR;
+            map_rect(fMatrix, fRect, &devR);
+            fCovers.set(SkScalarCeil(devR.fLeft), SkScalarCeil(devR.fTop),
+                        SkScalarFloor(devR.fRight),
+                        SkScalarFloor(devR.fBottom));
+        }
+    }
+};
+
+class PathCmd : public Cmd {
+public:
+    PathCmd(const SkDraw& draw, const SkPath& path, const SkPaint& paint,
+            const SkMatrix* prePathMatrix)
+            : Cmd(kOther_Type, draw, paint), fPath(path),
+              fHasPrePathMatrix(NULL != prePathMatrix) {
+        if (prePathMatrix) {
+            fPrePathMatrix = *prePathMatrix;
+        }
+        if (!path.isInverseFillType()) {
+            SkRect r = path.getBounds();
+            if (prePathMatrix) {
+                prePathMatrix->mapRect(&r);
+            }
+            fBounds = device_bounds(r, fMatrix, fPaint, fClip);
+        }
+    }
+    virtual void playback(const SkDraw& draw) {
+        // the path is ours, and only drawn once
+        draw.drawPath(fPath, fPaint,
+                      fHasPrePathMatrix ? &fPrePathMatrix : NULL, true);
+    }
+
+private:
+    SkPath      fPath;
+    SkMatrix    fPrePathMatrix;
+    bool        fHasPrePathMatrix;
+};
+
+class BitmapCmd : public Cmd {
+public:
+    // bitmap is already a snapshot
+    BitmapCmd(const SkDraw& draw, const SkBitmap& bitmap,
+              const SkMatrix& matrix, const SkPaint& paint)
+            : Cmd(kOther_Type, draw, paint), fBitmap(bitmap),
+              fBitmapMatrix(matrix) {
+        SkRect r;
+        r.set(0, 0, SkIntToScalar(bitmap.width()),
+              SkIntToScalar(bitmap.height()));
+        SkMatrix m;
+        m.setConcat(fMatrix, matrix);
+        fBounds = device_bounds(r, m, fPaint, fClip);
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawBitmap(fBitmap, fBitmapMatrix, fPaint);
+    }
+
+private:
+    SkBitmap    fBitmap;
+    SkMatrix    fBitmapMatrix;
+};
+
+class SpriteCmd : public Cmd {
+public:
+    // bitmap is already a snapshot
+    SpriteCmd(const SkDraw& draw, const SkBitmap& bitmap, int x, int y,
+              const SkPaint& paint)
+            : Cmd(kSprite_Type, draw, paint), fBitmap(bitmap) {
+        // sprites ignore the matrix, so don't let it keep them apart
+        fMatrix.reset();
+        fRect.set(x, y, x + bitmap.width(), y + bitmap.height());
+        this->computeBounds();
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawSprite(fBitmap, fRect.fLeft, fRect.fTop, fPaint);
+    }
+    virtual bool absorb(const Cmd& other) {
+        if (!this->sameState(other) || !is_plain_sprite(fBitmap, fPaint)) {
+            return false;
+        }
+        const SkBitmap& bm = static_cast<const SpriteCmd&>(other).fBitmap;
+        const SkIRect& r = static_cast<const SpriteCmd&>(other).fRect;
+        if (NULL == bm.pixelRef() || bm.pixelRef() != fBitmap.pixelRef() ||
+                bm.config() != fBitmap.config() ||
+                bm.rowBytes() != fBitmap.rowBytes() ||
+                bm.isOpaque() != fBitmap.isOpaque()) {
+            return false;
+        }
+        // the two must be taken from the pixelref at the same offset
+        SkIPoint a = pixel_ref_origin(fBitmap);
+        SkIPoint b = pixel_ref_origin(bm);
+        if (fRect.fLeft - a.fX != r.fLeft - b.fX ||
+                fRect.fTop - a.fY != r.fTop - b.fY) {
+            return false;
+        }
+        SkIRect joined;
+        if (!join_rects(fRect, r, &joined)) {
+            return false;
+        }
+
+        const int x = a.fX + joined.fLeft - fRect.fLeft;
+        const int y = a.fY + joined.fTop - fRect.fTop;
+        SkBitmap merged;
+        merged.setConfig(fBitmap.config(), joined.width(), joined.height(),
+                         fBitmap.rowBytes());
+        merged.setPixelRef(fBitmap.pixelRef(), y * fBitmap.rowBytes() +
+                           x * fBitmap.bytesPerPixel());
+        merged.setIsOpaque(fBitmap.isOpaque());
+        fBitmap.swap(merged);
+        fRect = joined;
+        this->computeBounds();
+        return true;
+    }
+
+private:
+    SkBitmap    fBitmap;
+    SkIRect     fRect;
+
+    // true if the sprite is drawn by copying its pixels, rather than as a
+    // mask or through the paint's mask filter
+    static bool is_plain_sprite(const SkBitmap& bitmap, const SkPaint& paint) {
+        return NULL == paint.getMaskFilter() && bitmap.bytesPerPixel() > 0 &&
+               SkBitmap::kA8_Config != bitmap.config();
+    }
+
+    void computeBounds() {
+        if (is_plain_sprite(fBitmap, fPaint)) {
+            fBounds = fClip.getBounds();
+            if (!fBounds.intersect(fRect)) {
+                fBounds.setEmpty();
+            }
+            if (overwrites(fPaint, fBitmap.isOpaque())) {
+                fCovers = fRect;
+            }
+        }
+    }
+};
+
+class TextCmd : public Cmd {
+public:
+    TextCmd(const SkDraw& draw, const void* text, size_t len, SkScalar x,
+            SkScalar y, const SkPaint& paint)
+            : Cmd(kOther_Type, draw, paint), fX(x), fY(y) {
+        fText.append(len, (const char*)text);
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawText(fText.begin(), fText.count(), fX, fY, fPaint);
+    }
+
+private:
+    SkTDArray<char> fText;
+    SkScalar        fX, fY;
+};
+
+class PosTextCmd : public Cmd {
+public:
+    PosTextCmd(const SkDraw& draw, const void* text, size_t len,
+               const SkScalar pos[], SkScalar constY, int scalarsPerPos,
+               const SkPaint& paint)
+            : Cmd(kOther_Type, draw, paint), fConstY(constY),
+              fScalarsPerPos(scalarsPerPos) {
+        fText.append(len, (const char*)text);
+        fPos.append(paint.countText(text, len) * scalarsPerPos, pos);
+    }
+    virtual void playback(const SkDraw& draw) {
+        draw.drawPosText(fText.begin(), fText.count(), fPos.begin(), fConstY,
+                         fScalarsPerPos, fPaint);
+    }
+
+private:
+    SkTDArray<char>     fText;
+    SkTDArray<SkScalar> fPos;
+    SkScalar            fConstY;
+    int                 fScalarsPerPos;
+};
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkDeferredDevice::SkDeferredDevice(const SkBitmap& bitmap)
+        : INHERITED(bitmap), fTarget(bitmap), fCopiedBytes(0) {
+}
+
+SkDeferredDevice::~SkDeferredDevice() {
+    this->flush();
+}
+
+void SkDeferredDevice::onAccessBitmap(SkBitmap*) {
+    this->flush();
+}
+
+void SkDeferredDevice::onAccessBitmapForDraw(SkBitmap*) {
+    // the canvas is about to call one of our draw methods, which will queue
+    // up the draw or flush
+}
+
+bool SkDeferredDevice::canQueue(const SkDraw& draw,
+                                const SkBitmap* bitmap) const {
+    // a bounder wants to hear about each draw as it happens, and the
+    // external matrix only matters to devices that draw text themselves
+    if (draw.fBounder || draw.fProcs || draw.fMVMatrix) {
+        return false;
+    }
+    // a snapshot of our own pixels would miss the draws still queued
+    if (bitmap && (bitmap->pixelRef() ?
+                   bitmap->pixelRef() == fTarget.pixelRef() :
+                   bitmap->getPixels() == fTarget.getPixels())) {
+        return false;
+    }
+    return true;
+}
+
+void SkDeferredDevice::queue(Cmd* cmd) {
+    if (cmd->fBounds.isEmpty()) {
+        SkDELETE(cmd);
+        return;
+    }
+
+    const int last = fQueue.count() - 1;
+    if (last >= 0 && fQueue[last]->absorb(*cmd)) {
+        SkDELETE(cmd);
+        cmd = fQueue[last];
+        fQueue.remove(last);
+    }
+
+    if (!cmd->fCovers.isEmpty()) {
+        for (int i = fQueue.count() - 1; i >= 0; --i) {
+            if (cmd->covers(fQueue[i]->fBounds)) {
+                fCopiedBytes -= fQueue[i]->fCopiedBytes;
+                SkDELETE(fQueue[i]);
+                fQueue.remove(i);
+            }
+        }
+    }
+
+    *fQueue.append() = cmd;
+    fCopiedBytes += cmd->fCopiedBytes;
+    if (fQueue.count() >= DEFERRED_MAX_QUEUED ||
+            fCopiedBytes > DEFERRED_MAX_COPIED_BYTES) {
+        this->flush();
+    }
+}
+
+void SkDeferredDevice::flush() {
+    if (0 == fQueue.count()) {
+        return;
+    }
+
+    SkAutoLockPixels alp(fTarget);
+    if (fTarget.getPixels()) {
+        for (int i = 0; i < fQueue.count(); i++) {
+            Cmd* cmd = fQueue[i];
+            SkDraw draw;
+            draw.fBitmap = &fTarget;
+            draw.fMatrix = &cmd->fMatrix;
+            draw.fClip = &cmd->fClip;
+            // leaving fDevice NULL keeps SkDraw from calling back into us
+            cmd->playback(draw);
+        }
+        fTarget.notifyPixelsChanged();
+    }
+    fQueue.deleteAll();
+    fCopiedBytes = 0;
+}
+
+void SkDeferredDevice::clear(SkColor color) {
+    // there is nothing left to see of the queued draws
+    fQueue.deleteAll();
+    fCopiedBytes = 0;
+    this->INHERITED::clear(color);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkDeferredDevice::drawPaint(const SkDraw& draw, const SkPaint& paint) {
+    if (!this->canQueue(draw)) {
+        this->flush();
+        this->INHERITED::drawPaint(draw, paint);
+        return;
+    }
+    this->queue(SkNEW_ARGS(PaintCmd, (draw, paint)));
+}
+
+void SkDeferredDevice::drawPoints(const SkDraw& draw,
+                                  SkCanvas::PointMode mode, size_t count,
+                                  const SkPoint pts[], const SkPaint& paint) {
+    if (!this->canQueue(draw)) {
+        this->flush();
+        this->INHERITED::drawPoints(draw, mode, count, pts, paint);
+        return;
+    }
+    this->queue(SkNEW_ARGS(PointsCmd, (draw, mode, count, pts, paint)));
+}
+
+void SkDeferredDevice::drawRect(const SkDraw& draw, const SkRect& r,
+                                const SkPaint& paint) {
+    if (!this->canQueue(draw)) {
+        this->flush();
+        this->INHERITED::drawRect(draw, r, paint);
+        return;
+    }
+    this->queue(SkNEW_ARGS(RectCmd, (draw, r, paint)));
+}
+
+void SkDeferredDevice::drawPath(const SkDraw& draw, const SkPath& path,
+                                const SkPaint& paint,
+                                const SkMatrix* prePathMatrix,
+                                bool pathIsMutable) {
+    if (!this->canQueue(draw)) {
+        this->flush();
+        this->INHERITED::drawPath(draw, path, paint, prePathMatrix,
+                                  pathIsMutable);
+        return;
+    }
+    this->queue(SkNEW_ARGS(PathCmd, (draw, path, paint, prePathMatrix)));
+}
+
+void SkDeferredDevice::drawBitmap(const SkDraw& draw, const SkBitmap& bitmap,
+                                  const SkIRect* srcRect,
+                                  const SkMatrix& matrix,
+                                  const SkPaint& paint) {
+    SkBitmap subset;
+    if (srcRect) {
+        if (!bitmap.extractSubset(&subset, *srcRect)) {
+            return;     // extraction failed
+        }
+    } else {
+        subset = bitmap;
+    }
+
+    SkBitmap copy;
+    size_t copied = 0;
+    if (!this->canQueue(draw, &bitmap) ||
+            !snapshot(subset, &copy, &copied)) {
+        this->flush();
+        this->INHERITED::drawBitmap(draw, subset, NULL, matrix, paint);
+        return;
+    }
+    Cmd* cmd = SkNEW_ARGS(BitmapCmd, (draw, copy, matrix, paint));
+    cmd->fCopiedBytes = copied;
+    this->queue(cmd);
+}
+
+void SkDeferredDevice::drawSprite(const SkDraw& draw, const SkBitmap& bitmap,
+                                  int x, int y, const SkPaint& paint) {
+    SkBitmap copy;
+    size_t copied = 0;
+    if (!this->canQueue(draw, &bitmap) ||
+            !snapshot(bitmap, &copy, &copied)) {
+        this->flush();
+        this->INHERITED::drawSprite(draw, bitmap, x, y, paint);
+        return;
+    }
+    Cmd* cmd = SkNEW_ARGS(SpriteCmd, (draw, copy, x, y, paint));
+    cmd->fCopiedBytes = copied;
+    this->queue(cmd);
+}
+
+void SkDeferredDevice::drawText(const SkDraw& draw, const void* text,
+                                size_t len, SkScalar x, SkScalar y,
+                                const SkPaint& paint) {
+    if (!this->canQueue(draw)) {
+        this->flush();
+        this->INHERITED::drawText(draw, text, len, x, y, paint);
+        return;
+    }
+    this->queue(SkNEW_ARGS(TextCmd, (draw, text, len, x, y, paint)));
+}
+
+void SkDeferredDevice::drawPosText(const SkDraw& draw, const void* text,
+                                   size_t len, const SkScalar pos[],
+                                   SkScalar constY, int scalarsPerPos,
+                                   const SkPaint& paint) {
+    if (!this->canQueue(draw)) {
+        this->flush();
+        this->INHERITED::drawPosText(draw, text, len, pos, constY,
+                                     scalarsPerPos, paint);
+        return;
+    }
+    this->queue(SkNEW_ARGS(PosTextCmd, (draw, text, len, pos, constY,
+                                        scalarsPerPos, paint)));
+}
+
+// the rest are drawn right away
+
+void SkDeferredDevice::drawTextOnPath(const SkDraw& draw, const void* text,
+                                      size_t len, const SkPath& path,
+                                      const SkMatrix* matrix,
+                                      const SkPaint& paint) {
+    this->flush();
+    this->INHERITED::drawTextOnPath(draw, text, len, path, matrix, paint);
+}
+
+#ifdef ANDROID
+void SkDeferredDevice::drawPosTextOnPath(const SkDraw& draw, const void* text,
+                                         size_t len, const SkPoint pos[],
+                                         const SkPaint& paint,
+                                         const SkPath& path,
+                                         const SkMatrix* matrix) {
+    this->flush();
+    this->INHERITED::drawPosTextOnPath(draw, text, len, pos, paint, path,
+                                       matrix);
+}
+#endif
+
+void SkDeferredDevice::drawVertices(const SkDraw& draw,
+                                    SkCanvas::VertexMode vmode,
+                                    int vertexCount, const SkPoint verts[],
+                                    const SkPoint texs[],
+                                    const SkColor colors[], SkXfermode* xmode,
+                                    const uint16_t indices[], int indexCount,
+                                    const SkPaint& paint) {
+    this->flush();
+    this->INHERITED::drawVertices(draw, vmode, vertexCount, verts, texs,
+                                  colors, xmode, indices, indexCount, paint);
+}
+
+void SkDeferredDevice::drawDevice(const SkDraw& draw, SkDevice* device,
+                                  int x, int y, const SkPaint& paint) {
+    this->flush();
+    this->INHERITED::drawDevice(draw, device, x, y, paint);
+}
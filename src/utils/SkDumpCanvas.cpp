@@ -2,6 +2,7 @@
 #include "SkPicture.h"
 #include "SkPixelRef.h"
 #include "SkString.h"
+#include "SkTextBlob.h"
 #include <stdarg.h>
 
 // needed just to know that these are all subclassed from SkFlattenable
@@ -233,11 +234,13 @@ bool SkDumpCanvas::clipRect(const SkRect& rect, SkRegion::Op op) {
     return this->INHERITED::clipRect(rect, op);
 }
 
-bool SkDumpCanvas::clipPath(const SkPath& path, SkRegion::Op op) {
+bool SkDumpCanvas::clipPath(const SkPath& path, SkRegion::Op op,
+                            bool doAntiAlias) {
     SkString str;
     toString(path, &str);
-    this->dump(kClip_Verb, NULL, "clipPath(%s %s)", str.c_str(), toString(op));
-    return this->INHERITED::clipPath(path, op);
+    this->dump(kClip_Verb, NULL, "clipPath(%s %s %s)", str.c_str(), toString(op),
+               doAntiAlias ? "AA" : "BW");
+    return this->INHERITED::clipPath(path, op, doAntiAlias);
 }
 
 bool SkDumpCanvas::clipRegion(const SkRegion& deviceRgn, SkRegion::Op op) {
@@ -342,6 +345,13 @@ void SkDumpCanvas::drawPosTextH(const void* text, size_t byteLength,
                SkScalarToFloat(constY));
 }
 
+void SkDumpCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x,
+                                SkScalar y, const SkPaint& paint) {
+    this->dump(kDrawText_Verb, &paint, "drawTextBlob(%d [%d] %g %g)",
+               blob->uniqueID(), blob->glyphCount(), SkScalarToFloat(x),
+               SkScalarToFloat(y));
+}
+
 void SkDumpCanvas::drawTextOnPath(const void* text, size_t byteLength,
                                    const SkPath& path, const SkMatrix* matrix,
                                    const SkPaint& paint) {
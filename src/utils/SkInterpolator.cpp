@@ -35,6 +35,7 @@ void SkInterpolatorBase::reset(int elemCount, int frameCount) {
     fElemCount = SkToU8(elemCount);
     fFrameCount = SkToS16(frameCount);
     fRepeat = SK_Scalar1;
+    fLastIndex = 0;
     if (fStorage) {
         sk_free(fStorage);
         fStorage = NULL;
@@ -71,8 +72,34 @@ SkScalar SkInterpolatorBase::ComputeRelativeT(SkMSec time, SkMSec prevTime,
 
     SkScalar t = SkScalarDiv((SkScalar)(time - prevTime),
                              (SkScalar)(nextTime - prevTime));
-    return blend ?
-            SkUnitCubicInterp(t, blend[0], blend[1], blend[2], blend[3]) : t;
+    // Control points on the diagonal make the cubic the line y = x (this
+    // includes the default blend), so skip solving for it.
+    if (NULL == blend || (blend[0] == blend[1] && blend[2] == blend[3])) {
+        return t;
+    }
+    return SkUnitCubicInterp(t, blend[0], blend[1], blend[2], blend[3]);
+}
+
+int SkInterpolatorBase::searchTimes(SkMSec time) const {
+    // Callers usually sample increasing times, so try the key frame we found
+    // last time and the one after it before searching all of them.
+    int index = fLastIndex;
+    if (index == fFrameCount && time > fTimes[index - 1].fTime) {
+        return ~index;
+    }
+    int stop = SkMin32(index + 2, fFrameCount);
+    for (; index < stop; index++) {
+        SkMSec nextT = fTimes[index].fTime;
+        if (time <= nextT && (0 == index || time > fTimes[index - 1].fTime)) {
+            fLastIndex = index;
+            return time == nextT ? index : ~index;
+        }
+    }
+
+    index = SkTSearch<SkMSec>(&fTimes[0].fTime, fFrameCount, time,
+                              sizeof(SkTimeCode));
+    fLastIndex = index < 0 ? ~index : index;
+    return index;
 }
 
 SkInterpolatorBase::Result SkInterpolatorBase::timeToT(SkMSec time, SkScalar* T,
@@ -100,8 +127,7 @@ SkInterpolatorBase::Result SkInterpolatorBase::timeToT(SkMSec time, SkScalar* T,
         time = offsetTime + startTime;
     }
 
-    int index = SkTSearch<SkMSec>(&fTimes[0].fTime, fFrameCount, time,
-                                  sizeof(SkTimeCode));
+    int index = this->searchTimes(time);
 
     bool    exact = true;
 
@@ -197,21 +223,50 @@ SkInterpolator::Result SkInterpolator::timeToValues(SkMSec time,
     SkBool exact;
     Result result = timeToT(time, &T, &index, &exact);
     if (values) {
-        const SkScalar* nextSrc = &fValues[index * fElemCount];
+        this->writeValues(index, exact, T, values, 1);
+    }
+    return result;
+}
+
+void SkInterpolator::TimeToValues(const SkInterpolator* const interps[],
+                                  int count, SkMSec time, SkScalar values[],
+                                  Result results[]) {
+    for (int i = 0; i < count; i++) {
+        const SkInterpolator* interp = interps[i];
+        SkASSERT(interp->fElemCount == interps[0]->fElemCount);
+
+        SkScalar T;
+        int index;
+        SkBool exact;
+        Result result = interp->timeToT(time, &T, &index, &exact);
+        interp->writeValues(index, exact, T, &values[i], count);
+        if (results) {
+            results[i] = result;
+        }
+    }
+}
 
-        if (exact) {
+void SkInterpolator::writeValues(int index, SkBool exact, SkScalar T,
+                                 SkScalar values[], int stride) const {
+    const SkScalar* nextSrc = &fValues[index * fElemCount];
+
+    if (exact) {
+        if (1 == stride) {
             memcpy(values, nextSrc, fElemCount * sizeof(SkScalar));
-        } else {
-            SkASSERT(index > 0);
+            return;
+        }
+        for (int i = fElemCount - 1; i >= 0; --i) {
+            values[i * stride] = nextSrc[i];
+        }
+    } else {
+        SkASSERT(index > 0);
 
-            const SkScalar* prevSrc = nextSrc - fElemCount;
+        const SkScalar* prevSrc = nextSrc - fElemCount;
 
-            for (int i = fElemCount - 1; i >= 0; --i) {
-                values[i] = SkScalarInterp(prevSrc[i], nextSrc[i], T);
-            }
+        for (int i = fElemCount - 1; i >= 0; --i) {
+            values[i * stride] = SkScalarInterp(prevSrc[i], nextSrc[i], T);
         }
     }
-    return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -36,7 +36,8 @@ SkLayer::SkLayer(const SkLayer& src) : INHERITED() {
 
     fMatrix = src.fMatrix;
     fChildrenMatrix = src.fChildrenMatrix;
-    fFlags = src.fFlags;
+    // the copy makes a cache of its own, when it is first drawn
+    fFlags = src.fFlags | kCacheIsDirty_Flag;
 
 #ifdef DEBUG_TRACK_NEW_DELETE
     gLayerAllocCount += 1;
@@ -67,6 +68,23 @@ void SkLayer::setInheritFromRootTransform(bool doInherit) {
     }
 }
 
+bool SkLayer::isCachingContent() const {
+    return (fFlags & kCachingContent_Flag) != 0;
+}
+
+void SkLayer::setCachingContent(bool doCache) {
+    if (doCache) {
+        fFlags |= kCachingContent_Flag | kCacheIsDirty_Flag;
+    } else {
+        fFlags &= ~kCachingContent_Flag;
+        fCache.reset();
+    }
+}
+
+void SkLayer::inval() {
+    fFlags |= kCacheIsDirty_Flag;
+}
+
 void SkLayer::setMatrix(const SkMatrix& matrix) {
     fMatrix = matrix;
 }
@@ -166,6 +184,39 @@ void SkLayer::onDraw(SkCanvas*, SkScalar opacity) {
 //    SkDebugf("----- no onDraw for %p\n", this);
 }
 
+void SkLayer::drawCache(SkCanvas* canvas, SkScalar opacity) {
+    int width = SkScalarCeil(m_size.width());
+    int height = SkScalarCeil(m_size.height());
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    if (fCache.width() != width || fCache.height() != height) {
+        fCache.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+        if (!fCache.allocPixels()) {
+            fCache.reset();
+            this->onDraw(canvas, opacity);
+            return;
+        }
+        fFlags |= kCacheIsDirty_Flag;
+    }
+
+    if (fFlags & kCacheIsDirty_Flag) {
+        fCache.eraseColor(0);
+        SkCanvas cacheCanvas(fCache);
+        this->onDraw(&cacheCanvas, SK_Scalar1);
+        // so that a texture made from the old content isn't used
+        fCache.notifyPixelsChanged();
+        fFlags &= ~kCacheIsDirty_Flag;
+    }
+
+    SkPaint paint;
+    paint.setAlpha(SkClampMax(SkScalarRound(SkScalarMul(opacity, 255)), 255));
+    // this only makes a difference if the layer is scaled or rotated
+    paint.setFilterBitmap(true);
+    canvas->drawBitmap(fCache, 0, 0, &paint);
+}
+
 #include "SkString.h"
 
 void SkLayer::draw(SkCanvas* canvas, SkScalar opacity) {
@@ -197,7 +248,11 @@ void SkLayer::draw(SkCanvas* canvas, SkScalar opacity) {
         canvas->concat(tmp);
     }
 
-    this->onDraw(canvas, opacity);
+    if (this->isCachingContent()) {
+        this->drawCache(canvas, opacity);
+    } else {
+        this->onDraw(canvas, opacity);
+    }
 
 #ifdef DEBUG_DRAW_LAYER_BOUNDS
     {
@@ -130,12 +130,13 @@ bool SkNWayCanvas::clipRect(const SkRect& rect, SkRegion::Op op) {
     return this->INHERITED::clipRect(rect, op);
 }
 
-bool SkNWayCanvas::clipPath(const SkPath& path, SkRegion::Op op) {
+bool SkNWayCanvas::clipPath(const SkPath& path, SkRegion::Op op,
+                            bool doAntiAlias) {
     Iter iter(fList);
     while (iter.next()) {
-        iter->clipPath(path, op);
+        iter->clipPath(path, op, doAntiAlias);
     }
-    return this->INHERITED::clipPath(path, op);
+    return this->INHERITED::clipPath(path, op, doAntiAlias);
 }
 
 bool SkNWayCanvas::clipRegion(const SkRegion& deviceRgn, SkRegion::Op op) {
@@ -232,6 +233,14 @@ void SkNWayCanvas::drawPosTextH(const void* text, size_t byteLength,
     }
 }
 
+void SkNWayCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x,
+                                SkScalar y, const SkPaint& paint) {
+    Iter iter(fList);
+    while (iter.next()) {
+        iter->drawTextBlob(blob, x, y, paint);
+    }
+}
+
 void SkNWayCanvas::drawTextOnPath(const void* text, size_t byteLength,
                                   const SkPath& path, const SkMatrix* matrix,
                                   const SkPaint& paint) {
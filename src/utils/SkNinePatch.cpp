@@ -16,6 +16,7 @@
 
 #include "SkNinePatch.h"
 #include "SkCanvas.h"
+#include "SkDevice.h"
 #include "SkShader.h"
 
 static const uint16_t g3x3Indices[] = {
@@ -81,6 +82,75 @@ struct Mesh {
     const uint16_t* fIndices;
 };
 
+// returns false if the divs can't be stretched into bounds, in which case the
+// bitmap is drawn as a whole
+static bool computeStretch(const SkRect& bounds, const SkBitmap& bitmap,
+                           const int32_t xDivs[], int numXDivs,
+                           const int32_t yDivs[], int numYDivs,
+                           SkScalar* stretchX, SkScalar* stretchY) {
+    const int numXStretch = (numXDivs + 1) >> 1;
+    const int numYStretch = (numYDivs + 1) >> 1;
+
+    if (numXStretch < 1 && numYStretch < 1) {
+        return false;
+    }
+
+    *stretchX = 0;
+    *stretchY = 0;
+
+    if (numXStretch > 0) {
+        int stretchSize = 0;
+        for (int i = 1; i < numXDivs; i += 2) {
+            stretchSize += xDivs[i] - xDivs[i-1];
+        }
+        int fixed = bitmap.width() - stretchSize;
+        *stretchX = (bounds.width() - SkIntToScalar(fixed)) / numXStretch;
+        if (*stretchX < 0) {
+            return false;
+        }
+    }
+
+    if (numYStretch > 0) {
+        int stretchSize = 0;
+        for (int i = 1; i < numYDivs; i += 2) {
+            stretchSize += yDivs[i] - yDivs[i-1];
+        }
+        int fixed = bitmap.height() - stretchSize;
+        *stretchY = (bounds.height() - SkIntToScalar(fixed)) / numYStretch;
+        if (*stretchY < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// fills (numXDivs + 2) * (numYDivs + 2) verts and texs
+static void fillMesh(SkPoint verts[], SkPoint texs[], const SkRect& bounds,
+                     const SkBitmap& bitmap,
+                     const int32_t xDivs[], int numXDivs,
+                     const int32_t yDivs[], int numYDivs,
+                     SkScalar stretchX, SkScalar stretchY) {
+    SkScalar vy = bounds.fTop;
+    fillRow(verts, texs, vy, 0, bounds, xDivs, numXDivs,
+            stretchX, bitmap.width());
+    verts += numXDivs + 2;
+    texs += numXDivs + 2;
+    for (int y = 0; y < numYDivs; y++) {
+        const SkScalar ty = SkIntToScalar(yDivs[y]);
+        if (y & 1) {
+            vy += stretchY;
+        } else {
+            vy += ty;
+        }
+        fillRow(verts, texs, vy, ty, bounds, xDivs, numXDivs,
+                stretchX, bitmap.width());
+        verts += numXDivs + 2;
+        texs += numXDivs + 2;
+    }
+    fillRow(verts, texs, bounds.fBottom, SkIntToScalar(bitmap.height()),
+            bounds, xDivs, numXDivs, stretchX, bitmap.width());
+}
+
 void SkNinePatch::DrawMesh(SkCanvas* canvas, const SkRect& bounds,
                            const SkBitmap& bitmap,
                            const int32_t xDivs[], int numXDivs,
@@ -112,12 +182,10 @@ void SkNinePatch::DrawMesh(SkCanvas* canvas, const SkRect& bounds,
     }
     
     Mesh mesh;
-    
-    const int numXStretch = (numXDivs + 1) >> 1;
-    const int numYStretch = (numYDivs + 1) >> 1;
-    
-    if (numXStretch < 1 && numYStretch < 1) {
-    BITMAP_RECT:
+    SkScalar stretchX, stretchY;
+
+    if (!computeStretch(bounds, bitmap, xDivs, numXDivs, yDivs, numYDivs,
+                        &stretchX, &stretchY)) {
 //        SkDebugf("------ drawasamesh revert to bitmaprect\n");
         canvas->drawBitmapRect(bitmap, NULL, bounds, paint);
         return;
@@ -133,32 +201,6 @@ void SkNinePatch::DrawMesh(SkCanvas* canvas, const SkRect& bounds,
         }
     }
     
-    SkScalar stretchX = 0, stretchY = 0;
-    
-    if (numXStretch > 0) {
-        int stretchSize = 0;
-        for (int i = 1; i < numXDivs; i += 2) {
-            stretchSize += xDivs[i] - xDivs[i-1];
-        }
-        int fixed = bitmap.width() - stretchSize;
-        stretchX = (bounds.width() - SkIntToScalar(fixed)) / numXStretch;
-        if (stretchX < 0) {
-            goto BITMAP_RECT;
-        }
-    }
-    
-    if (numYStretch > 0) {
-        int stretchSize = 0;
-        for (int i = 1; i < numYDivs; i += 2) {
-            stretchSize += yDivs[i] - yDivs[i-1];
-        }
-        int fixed = bitmap.height() - stretchSize;
-        stretchY = (bounds.height() - SkIntToScalar(fixed)) / numYStretch;
-        if (stretchY < 0) {
-            goto BITMAP_RECT;
-        }
-    }
-    
 #if 0
     SkDebugf("---- drawasamesh [%d %d] -> [%g %g] <%d %d> (%g %g)\n",
              bitmap.width(), bitmap.height(),
@@ -191,25 +233,8 @@ void SkNinePatch::DrawMesh(SkCanvas* canvas, const SkRect& bounds,
         mesh.fIndices = indices;
     }
     
-    SkScalar vy = bounds.fTop;
-    fillRow(verts, texs, vy, 0, bounds, xDivs, numXDivs,
-            stretchX, bitmap.width());
-    verts += numXDivs + 2;
-    texs += numXDivs + 2;
-    for (int y = 0; y < numYDivs; y++) {
-        const SkScalar ty = SkIntToScalar(yDivs[y]);
-        if (y & 1) {
-            vy += stretchY;
-        } else {
-            vy += ty;
-        }
-        fillRow(verts, texs, vy, ty, bounds, xDivs, numXDivs,
-                stretchX, bitmap.width());
-        verts += numXDivs + 2;
-        texs += numXDivs + 2;
-    }
-    fillRow(verts, texs, bounds.fBottom, SkIntToScalar(bitmap.height()),
-            bounds, xDivs, numXDivs, stretchX, bitmap.width());
+    fillMesh(verts, texs, bounds, bitmap, xDivs, numXDivs, yDivs, numYDivs,
+             stretchX, stretchY);
     
     SkShader* shader = SkShader::CreateBitmapShader(bitmap,
                                                     SkShader::kClamp_TileMode,
@@ -226,23 +251,46 @@ void SkNinePatch::DrawMesh(SkCanvas* canvas, const SkRect& bounds,
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
-                             const SkBitmap& bitmap, const SkIRect& margins,
-                             const SkPaint* paint) {
-    const int32_t srcX[4] = {
-        0, margins.fLeft, bitmap.width() - margins.fRight, bitmap.width()
-    };
-    const int32_t srcY[4] = {
-        0, margins.fTop, bitmap.height() - margins.fBottom, bitmap.height()
-    };
-    SkScalar dstX[4] = {
-        dst.fLeft, dst.fLeft + SkIntToScalar(margins.fLeft),
-        dst.fRight - SkIntToScalar(margins.fRight), dst.fRight
-    };
-    SkScalar dstY[4] = {
-        dst.fTop, dst.fTop + SkIntToScalar(margins.fTop),
-        dst.fBottom - SkIntToScalar(margins.fBottom), dst.fBottom
-    };
+static void computeNineDivs(const SkBitmap& bitmap, const SkIRect& margins,
+                            int32_t xDivs[2], int32_t yDivs[2]) {
+    xDivs[0] = margins.fLeft;
+    xDivs[1] = bitmap.width() - margins.fRight;
+    yDivs[0] = margins.fTop;
+    yDivs[1] = bitmap.height() - margins.fBottom;
+
+    if (xDivs[0] > xDivs[1]) {
+        xDivs[0] = bitmap.width() * margins.fLeft /
+            (margins.fLeft + margins.fRight);
+        xDivs[1] = xDivs[0];
+    }
+    if (yDivs[0] > yDivs[1]) {
+        yDivs[0] = bitmap.height() * margins.fTop /
+            (margins.fTop + margins.fBottom);
+        yDivs[1] = yDivs[0];
+    }
+}
+
+static void computeNineRects(const SkRect& dst, const SkBitmap& bitmap,
+                             const SkIRect& margins,
+                             int32_t srcX[4], int32_t srcY[4],
+                             SkScalar dstX[4], SkScalar dstY[4]) {
+    srcX[0] = 0;
+    srcX[1] = margins.fLeft;
+    srcX[2] = bitmap.width() - margins.fRight;
+    srcX[3] = bitmap.width();
+    srcY[0] = 0;
+    srcY[1] = margins.fTop;
+    srcY[2] = bitmap.height() - margins.fBottom;
+    srcY[3] = bitmap.height();
+
+    dstX[0] = dst.fLeft;
+    dstX[1] = dst.fLeft + SkIntToScalar(margins.fLeft);
+    dstX[2] = dst.fRight - SkIntToScalar(margins.fRight);
+    dstX[3] = dst.fRight;
+    dstY[0] = dst.fTop;
+    dstY[1] = dst.fTop + SkIntToScalar(margins.fTop);
+    dstY[2] = dst.fBottom - SkIntToScalar(margins.fBottom);
+    dstY[3] = dst.fBottom;
 
     if (dstX[1] > dstX[2]) {
         dstX[1] = dstX[0] + (dstX[3] - dstX[0]) * SkIntToScalar(margins.fLeft) /
@@ -255,6 +303,14 @@ static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
             (SkIntToScalar(margins.fTop) + SkIntToScalar(margins.fBottom));
         dstY[2] = dstY[1];
     }
+}
+
+static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
+                             const SkBitmap& bitmap, const SkIRect& margins,
+                             const SkPaint* paint) {
+    int32_t srcX[4], srcY[4];
+    SkScalar dstX[4], dstY[4];
+    computeNineRects(dst, bitmap, margins, srcX, srcY, dstX, dstY);
 
     SkIRect s;
     SkRect  d;
@@ -273,6 +329,12 @@ static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
     }
 }
 
+static bool isGpuCanvas(SkCanvas* canvas) {
+    SkDevice* device = canvas->getDevice();
+    return device &&
+           (device->getDeviceCapabilities() & SkDevice::kGL_Capability);
+}
+
 void SkNinePatch::DrawNine(SkCanvas* canvas, const SkRect& bounds,
                            const SkBitmap& bitmap, const SkIRect& margins,
                            const SkPaint* paint) {
@@ -282,29 +344,111 @@ void SkNinePatch::DrawNine(SkCanvas* canvas, const SkRect& bounds,
      when not in GL, the vertices impl is slower (more math) than calling
      the viaRects code.
      */
-    if (false /* is our canvas backed by a gpu?*/) {
+    if (isGpuCanvas(canvas)) {
         int32_t xDivs[2];
         int32_t yDivs[2];
-        
-        xDivs[0] = margins.fLeft;
-        xDivs[1] = bitmap.width() - margins.fRight;
-        yDivs[0] = margins.fTop;
-        yDivs[1] = bitmap.height() - margins.fBottom;
-
-        if (xDivs[0] > xDivs[1]) {
-            xDivs[0] = bitmap.width() * margins.fLeft /
-                (margins.fLeft + margins.fRight);
-            xDivs[1] = xDivs[0];
-        }
-        if (yDivs[0] > yDivs[1]) {
-            yDivs[0] = bitmap.height() * margins.fTop /
-                (margins.fTop + margins.fBottom);
-            yDivs[1] = yDivs[0];
-        }
-        
+        computeNineDivs(bitmap, margins, xDivs, yDivs);
         SkNinePatch::DrawMesh(canvas, bounds, bitmap,
                               xDivs, 2, yDivs, 2, paint);
     } else {
         drawNineViaRects(canvas, bounds, bitmap, margins, paint);
     }
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkNinePatch::SkNinePatch(const SkBitmap& bitmap, const SkIRect& margins)
+        : fBitmap(bitmap), fMargins(margins), fShader(NULL),
+          fMeshWidth(0), fMeshHeight(0) {
+    int32_t srcX[4], srcY[4];
+    SkScalar dstX[4], dstY[4];
+    computeNineRects(SkRect::MakeEmpty(), bitmap, margins, srcX, srcY,
+                     dstX, dstY);
+
+    // RLE bitmaps are decoded here, instead of on every draw
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            SkIRect s;
+            s.set(srcX[x], srcY[y], srcX[x+1], srcY[y+1]);
+            if (!s.isEmpty()) {
+                bitmap.extractSubset(&fSubsets[y * 3 + x], s);
+            }
+        }
+    }
+}
+
+SkNinePatch::~SkNinePatch() {
+    SkSafeUnref(fShader);
+}
+
+bool SkNinePatch::drawAsMesh(SkCanvas* canvas, const SkRect& dst,
+                             const SkPaint* paint) {
+    const SkScalar width = dst.width();
+    const SkScalar height = dst.height();
+    if (width != fMeshWidth || height != fMeshHeight) {
+        int32_t xDivs[2];
+        int32_t yDivs[2];
+        SkScalar stretchX, stretchY;
+        const SkRect bounds = SkRect::MakeWH(width, height);
+
+        computeNineDivs(fBitmap, fMargins, xDivs, yDivs);
+        if (!computeStretch(bounds, fBitmap, xDivs, 2, yDivs, 2,
+                            &stretchX, &stretchY)) {
+            fMeshWidth = fMeshHeight = 0;
+            return false;
+        }
+        fillMesh(fVerts, fTexs, bounds, fBitmap, xDivs, 2, yDivs, 2,
+                 stretchX, stretchY);
+        fMeshWidth = width;
+        fMeshHeight = height;
+    }
+
+    if (NULL == fShader) {
+        fShader = SkShader::CreateBitmapShader(fBitmap,
+                                               SkShader::kClamp_TileMode,
+                                               SkShader::kClamp_TileMode);
+    }
+    SkPaint p;
+    if (paint) {
+        p = *paint;
+    }
+    p.setShader(fShader);
+
+    SkAutoCanvasRestore acr(canvas, true);
+    canvas->translate(dst.fLeft, dst.fTop);
+    canvas->drawVertices(SkCanvas::kTriangles_VertexMode,
+                         SK_ARRAY_COUNT(fVerts), fVerts, fTexs, NULL, NULL,
+                         g3x3Indices, SK_ARRAY_COUNT(g3x3Indices), p);
+    return true;
+}
+
+void SkNinePatch::draw(SkCanvas* canvas, const SkRect& dst,
+                       const SkPaint* paint) {
+    if (dst.isEmpty() || fBitmap.width() == 0 || fBitmap.height() == 0) {
+        return;
+    }
+    if (isGpuCanvas(canvas) && this->drawAsMesh(canvas, dst, paint)) {
+        return;
+    }
+
+    int32_t srcX[4], srcY[4];
+    SkScalar dstX[4], dstY[4];
+    computeNineRects(dst, fBitmap, fMargins, srcX, srcY, dstX, dstY);
+
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            const SkBitmap& subset = fSubsets[y * 3 + x];
+            if (subset.isNull()) {
+                continue;
+            }
+            if (dstX[x+1] - dstX[x] == SkIntToScalar(subset.width()) &&
+                    dstY[y+1] - dstY[y] == SkIntToScalar(subset.height())) {
+                canvas->drawBitmap(subset, dstX[x], dstY[y], paint);
+            } else {
+                SkRect d;
+                d.set(dstX[x], dstY[y], dstX[x+1], dstY[y+1]);
+                canvas->drawBitmapRect(subset, NULL, d, paint);
+            }
+        }
+    }
+}
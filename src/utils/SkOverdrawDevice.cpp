@@ -0,0 +1,291 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkOverdrawDevice.h"
+#include "SkColorPriv.h"
+#include "SkDraw.h"
+#include "SkXfermode.h"
+
+namespace {
+
+// adds one to every pixel with some coverage, ignoring what's drawn
+class CountXfermode : public SkXfermode {
+public:
+    virtual void xfer32(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) {
+        for (int i = 0; i < count; i++) {
+            if (NULL == aa || aa[i]) {
+                dst[i] += 1;
+            }
+        }
+    }
+
+    virtual Factory getFactory() { return NULL; }
+};
+
+// src is a layer's counts, which are all added, along with one for the
+// compositing itself
+class LayerXfermode : public SkXfermode {
+public:
+    virtual void xfer32(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) {
+        for (int i = 0; i < count; i++) {
+            if (NULL == aa || aa[i]) {
+                dst[i] += src[i] + 1;
+            }
+        }
+    }
+
+    virtual Factory getFactory() { return NULL; }
+};
+
+}
+
+// the counts don't change by being looked at, so this is const in spirit
+static const SkBitmap& counts_of(const SkOverdrawDevice* device) {
+    return const_cast<SkOverdrawDevice*>(device)->accessBitmap(false);
+}
+
+SkOverdrawDevice::SkOverdrawDevice(int width, int height)
+        : INHERITED(SkBitmap::kARGB_8888_Config, width, height, false) {
+    fCountMode = SkNEW(CountXfermode);
+    fLayerMode = SkNEW(LayerXfermode);
+}
+
+SkOverdrawDevice::~SkOverdrawDevice() {
+    fCountMode->unref();
+    fLayerMode->unref();
+}
+
+uint32_t SkOverdrawDevice::countAt(int x, int y) const {
+    const SkBitmap& bm = counts_of(this);
+    SkASSERT((unsigned)x < (unsigned)bm.width());
+    SkASSERT((unsigned)y < (unsigned)bm.height());
+    SkAutoLockPixels alp(bm);
+    return *bm.getAddr32(x, y);
+}
+
+uint32_t SkOverdrawDevice::maxCount() const {
+    const SkBitmap& bm = counts_of(this);
+    SkAutoLockPixels alp(bm);
+    uint32_t max = 0;
+    for (int y = 0; y < bm.height(); y++) {
+        const uint32_t* row = bm.getAddr32(0, y);
+        for (int x = 0; x < bm.width(); x++) {
+            max = SkMax32(max, row[x]);
+        }
+    }
+    return max;
+}
+
+int SkOverdrawDevice::countCovered() const {
+    const SkBitmap& bm = counts_of(this);
+    SkAutoLockPixels alp(bm);
+    int covered = 0;
+    for (int y = 0; y < bm.height(); y++) {
+        const uint32_t* row = bm.getAddr32(0, y);
+        for (int x = 0; x < bm.width(); x++) {
+            covered += (0 != row[x]);
+        }
+    }
+    return covered;
+}
+
+float SkOverdrawDevice::averageCount() const {
+    const SkBitmap& bm = counts_of(this);
+    SkAutoLockPixels alp(bm);
+    int covered = 0;
+    double total = 0;
+    for (int y = 0; y < bm.height(); y++) {
+        const uint32_t* row = bm.getAddr32(0, y);
+        for (int x = 0; x < bm.width(); x++) {
+            covered += (0 != row[x]);
+            total += row[x];
+        }
+    }
+    return covered ? (float)(total / covered) : 0;
+}
+
+void SkOverdrawDevice::resetCounts() {
+    this->accessBitmap(true).eraseColor(0);
+}
+
+void SkOverdrawDevice::heatmap(SkBitmap* dst) const {
+    static const SkPMColor gColors[] = {
+        0,
+        SkPackARGB32(0xFF, 0x40, 0x40, 0xFF),   // once
+        SkPackARGB32(0xFF, 0x40, 0xC0, 0x40),   // twice
+        SkPackARGB32(0xFF, 0xFF, 0x80, 0xC0),   // three times
+        SkPackARGB32(0xFF, 0xFF, 0x20, 0x20),   // four or more
+    };
+    const uint32_t maxIndex = SK_ARRAY_COUNT(gColors) - 1;
+
+    const SkBitmap& bm = counts_of(this);
+    SkAutoLockPixels alp(bm);
+    dst->setConfig(SkBitmap::kARGB_8888_Config, bm.width(), bm.height());
+    dst->allocPixels();
+    SkAutoLockPixels alpDst(*dst);
+    for (int y = 0; y < bm.height(); y++) {
+        const uint32_t* src = bm.getAddr32(0, y);
+        SkPMColor* row = dst->getAddr32(0, y);
+        for (int x = 0; x < bm.width(); x++) {
+            row[x] = gColors[SkMin32(src[x], maxIndex)];
+        }
+    }
+}
+
+void SkOverdrawDevice::countingPaint(const SkPaint& paint,
+                                     SkPaint* counting) const {
+    *counting = paint;
+    // what's drawn doesn't matter, only where, so leave only what changes
+    // the coverage (style, path effect, mask filter, antialiasing), and make
+    // sure nothing is skipped for being transparent
+    counting->setShader(NULL);
+    counting->setColorFilter(NULL);
+    counting->setColor(SK_ColorBLACK);
+    counting->setLCDRenderText(false);
+    counting->setXfermode(fCountMode);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkOverdrawDevice::clear(SkColor color) {
+    const SkBitmap& bm = this->accessBitmap(true);
+    SkAutoLockPixels alp(bm);
+    for (int y = 0; y < bm.height(); y++) {
+        uint32_t* row = bm.getAddr32(0, y);
+        for (int x = 0; x < bm.width(); x++) {
+            row[x] += 1;
+        }
+    }
+}
+
+void SkOverdrawDevice::drawPaint(const SkDraw& draw, const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawPaint(draw, counting);
+}
+
+void SkOverdrawDevice::drawPoints(const SkDraw& draw,
+                                  SkCanvas::PointMode mode, size_t count,
+                                  const SkPoint pts[], const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawPoints(draw, mode, count, pts, counting);
+}
+
+void SkOverdrawDevice::drawRect(const SkDraw& draw, const SkRect& r,
+                                const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawRect(draw, r, counting);
+}
+
+void SkOverdrawDevice::drawPath(const SkDraw& draw, const SkPath& path,
+                                const SkPaint& paint,
+                                const SkMatrix* prePathMatrix,
+                                bool pathIsMutable) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawPath(draw, path, counting, prePathMatrix, pathIsMutable);
+}
+
+void SkOverdrawDevice::drawBitmap(const SkDraw& draw, const SkBitmap& bitmap,
+                                  const SkIRect* srcRectOrNull,
+                                  const SkMatrix& matrix,
+                                  const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawBitmap(draw, bitmap, srcRectOrNull, matrix, counting);
+}
+
+void SkOverdrawDevice::drawSprite(const SkDraw& draw, const SkBitmap& bitmap,
+                                  int x, int y, const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawSprite(draw, bitmap, x, y, counting);
+}
+
+void SkOverdrawDevice::drawText(const SkDraw& draw, const void* text,
+                                size_t len, SkScalar x, SkScalar y,
+                                const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawText(draw, text, len, x, y, counting);
+}
+
+void SkOverdrawDevice::drawPosText(const SkDraw& draw, const void* text,
+                                   size_t len, const SkScalar pos[],
+                                   SkScalar constY, int scalarsPerPos,
+                                   const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawPosText(draw, text, len, pos, constY, scalarsPerPos,
+                           counting);
+}
+
+void SkOverdrawDevice::drawTextOnPath(const SkDraw& draw, const void* text,
+                                      size_t len, const SkPath& path,
+                                      const SkMatrix* matrix,
+                                      const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawTextOnPath(draw, text, len, path, matrix, counting);
+}
+
+#ifdef ANDROID
+void SkOverdrawDevice::drawPosTextOnPath(const SkDraw& draw, const void* text,
+                                         size_t len, const SkPoint pos[],
+                                         const SkPaint& paint,
+                                         const SkPath& path,
+                                         const SkMatrix* matrix) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    INHERITED::drawPosTextOnPath(draw, text, len, pos, counting, path,
+                                 matrix);
+}
+#endif
+
+void SkOverdrawDevice::drawVertices(const SkDraw& draw,
+                                    SkCanvas::VertexMode vmode,
+                                    int vertexCount, const SkPoint verts[],
+                                    const SkPoint texs[],
+                                    const SkColor colors[], SkXfermode* xmode,
+                                    const uint16_t indices[], int indexCount,
+                                    const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    // without a shader the texs would be ignored anyway
+    INHERITED::drawVertices(draw, vmode, vertexCount, verts, NULL, colors,
+                            xmode, indices, indexCount, counting);
+}
+
+// our canvas only draws devices when it restores a layer, and those are
+// always ours (see onCreateCompatibleDevice)
+void SkOverdrawDevice::drawDevice(const SkDraw& draw, SkDevice* device,
+                                  int x, int y, const SkPaint& paint) {
+    SkPaint counting;
+    this->countingPaint(paint, &counting);
+    counting.setXfermode(fLayerMode);
+    INHERITED::drawDevice(draw, device, x, y, counting);
+}
+
+SkDevice* SkOverdrawDevice::onCreateCompatibleDevice(SkBitmap::Config,
+                                                     int width, int height,
+                                                     bool, Usage) {
+    return SkNEW_ARGS(SkOverdrawDevice, (width, height));
+}
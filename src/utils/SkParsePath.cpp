@@ -39,10 +39,141 @@ static const char* skip_sep(const char str[]) {
     return str;
 }
 
+#ifdef SK_SCALAR_IS_FLOAT
+
+// the powers of ten that doubles hold exactly
+static const double gPowersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define kMaxExactDigits     15
+#define kMaxExactExponent   22
+
+/*  Scans a number as SVG writes them: a sign, digits with an optional
+    decimal point, and an exponent, all but the digits being optional. This
+    is much quicker than strtod(), and the locale can't change what it reads.
+    Up to kMaxExactDigits significant digits the mantissa is exact in a
+    double, and so is a power of ten up to kMaxExactExponent, so scaling one
+    by the other rounds just once, as strtod() does. The rare numbers with
+    more digits or bigger exponents go to SkParse::FindScalar instead.
+ */
+static const char* scan_scalar(const char str[], SkScalar* value) {
+    const char* start = str;
+    bool negative = false;
+    if ('-' == *str) {
+        negative = true;
+        str += 1;
+    } else if ('+' == *str) {
+        str += 1;
+    }
+
+    double  mantissa = 0;
+    int     digits = 0;     // significant ones, in mantissa
+    int     exponent = 0;
+    bool    hasDigits = false;
+    for (; is_digit(*str); str++) {
+        hasDigits = true;
+        if (digits <= kMaxExactDigits) {
+            mantissa = mantissa * 10 + (*str - '0');
+            digits += (mantissa != 0);
+        } else {
+            exponent += 1;
+        }
+    }
+    if ('.' == *str) {
+        for (str++; is_digit(*str); str++) {
+            hasDigits = true;
+            if (digits <= kMaxExactDigits) {
+                mantissa = mantissa * 10 + (*str - '0');
+                digits += (mantissa != 0);
+                exponent -= 1;
+            }
+        }
+    }
+    if (!hasDigits) {
+        return NULL;
+    }
+
+    // an 'e' without digits after it isn't part of the number
+    if ('e' == *str || 'E' == *str) {
+        const char* e = str + 1;
+        bool negativeExp = false;
+        if ('-' == *e) {
+            negativeExp = true;
+            e += 1;
+        } else if ('+' == *e) {
+            e += 1;
+        }
+        if (is_digit(*e)) {
+            int n = 0;
+            for (; is_digit(*e); e++) {
+                if (n < 10000) {
+                    n = n * 10 + (*e - '0');
+                }
+            }
+            exponent += negativeExp ? -n : n;
+            str = e;
+        }
+    }
+
+    if (digits > kMaxExactDigits || exponent > kMaxExactExponent ||
+            exponent < -kMaxExactExponent) {
+        if (0 == mantissa) {
+            *value = 0;
+            return str;
+        }
+        return SkParse::FindScalar(start, value);
+    }
+    if (exponent < 0) {
+        mantissa /= gPowersOf10[-exponent];
+    } else {
+        mantissa *= gPowersOf10[exponent];
+    }
+    *value = (float)(negative ? -mantissa : mantissa);
+    return str;
+}
+
+#else
+
+static const char* scan_scalar(const char str[], SkScalar* value) {
+    return SkParse::FindScalar(str, value);
+}
+
+#endif
+
+// like SkParse::FindScalars
+static const char* find_scalars(const char str[], SkScalar value[], int count) {
+    str = skip_ws(str);
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            str = skip_sep(str);
+        }
+        str = scan_scalar(str, &value[i]);
+        if (NULL == str) {
+            return NULL;
+        }
+    }
+    return str;
+}
+
+// A guess at how many points a path string has, from how many runs of
+// digits it has, to reserve the path's storage before parsing it.
+static int estimate_points(const char str[]) {
+    int numbers = 0;
+    bool inNumber = false;
+    for (; *str; str++) {
+        bool isNumber = is_digit(*str) || '.' == *str;
+        numbers += isNumber && !inNumber;
+        inNumber = isNumber;
+    }
+    return numbers >> 1;
+}
+
 static const char* find_points(const char str[], SkPoint value[], int count,
                                bool isRelative, SkPoint* relative) {
-    str = SkParse::FindScalars(str, &value[0].fX, count * 2);
-    if (isRelative) {
+    str = find_scalars(str, &value[0].fX, count * 2);
+    if (str && isRelative) {
         for (int index = 0; index < count; index++) {
             value[index].fX += relative->fX;
             value[index].fY += relative->fY;
@@ -53,7 +184,7 @@ static const char* find_points(const char str[], SkPoint value[], int count,
 
 static const char* find_scalar(const char str[], SkScalar* value, 
                                bool isRelative, SkScalar relative) {
-    str = SkParse::FindScalar(str, value);
+    str = find_scalars(str, value, 1);
     if (isRelative) {
         *value += relative;
     }
@@ -69,13 +200,17 @@ bool SkParsePath::FromSVGString(const char data[], SkPath* result) {
     char op = '\0';
     char previousOp = '\0';
     bool relative = false;
+    path.incReserve(estimate_points(data) + 1);
     for (;;) {
+        if (NULL == data) {
+            return false;   // a number was missing or malformed
+        }
         data = skip_ws(data);
         if (data[0] == '\0') {
             break;
         }
         char ch = data[0];
-        if (is_digit(ch) || ch == '-' || ch == '+') {
+        if (is_digit(ch) || ch == '-' || ch == '+' || ch == '.') {
             if (op == '\0') {
                 return false;
             }
@@ -0,0 +1,189 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkPictureTiler.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkPicture.h"
+#include "SkStream.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
+
+namespace {
+
+struct TileGrid {
+    int fTileWidth;
+    int fTileHeight;
+    int fCountX;
+    int fTileCount;
+
+    void getTile(const SkBitmap& dst, int index, SkIRect* tile) const {
+        int x = (index % fCountX) * fTileWidth;
+        int y = (index / fCountX) * fTileHeight;
+        tile->set(x, y, SkMin32(x + fTileWidth, dst.width()),
+                  SkMin32(y + fTileHeight, dst.height()));
+    }
+};
+
+void draw_tile(SkPicture* picture, const SkBitmap& dst, const SkIRect& tile) {
+    SkBitmap subset;
+    if (!dst.extractSubset(&subset, tile)) {
+        return;
+    }
+    SkCanvas canvas(subset);
+    canvas.translate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+    picture->draw(&canvas);
+}
+
+/*  Each worker draws either the shared picture, if it can be drawn on several
+    threads at once, or else a private copy of it, built from the shared
+    serialized data. It pulls tile indices from a counter shared by all of the
+    workers until every tile has been claimed.
+ */
+class TileWorker : public SkRunnable {
+public:
+    TileWorker(SkPicture* picture, const SkData* data, const SkBitmap& dst,
+               const TileGrid& grid, int32_t* nextTile)
+        : fPicture(picture), fData(data), fDst(dst), fGrid(grid)
+        , fNextTile(nextTile) {}
+
+    virtual void run() {
+        if (fPicture) {
+            this->drawTiles(fPicture);
+        } else {
+            SkMemoryStream stream(fData->data(), fData->size());
+            SkPicture picture(&stream);
+            this->drawTiles(&picture);
+        }
+    }
+
+private:
+    void drawTiles(SkPicture* picture) {
+        SkIRect tile;
+        for (;;) {
+            int32_t index = sk_atomic_inc(fNextTile);
+            if (index >= fGrid.fTileCount) {
+                break;
+            }
+            fGrid.getTile(fDst, index, &tile);
+            draw_tile(picture, fDst, tile);
+        }
+    }
+
+    SkPicture*      fPicture;   // NULL if each worker needs its own copy
+    const SkData*   fData;
+    const SkBitmap& fDst;
+    const TileGrid& fGrid;
+    int32_t*        fNextTile;
+};
+
+}
+
+void SkPictureTiler::Draw(SkPicture* picture, const SkBitmap& dst,
+                          int tileWidth, int tileHeight, SkThreadPool* pool) {
+    SkASSERT(picture);
+    SkASSERT(tileWidth > 0 && tileHeight > 0);
+
+    if (dst.width() <= 0 || dst.height() <= 0) {
+        return;
+    }
+    picture->endRecording();
+
+    TileGrid grid;
+    grid.fTileWidth = tileWidth;
+    grid.fTileHeight = tileHeight;
+    grid.fCountX = (dst.width() + tileWidth - 1) / tileWidth;
+    grid.fTileCount = grid.fCountX *
+                      ((dst.height() + tileHeight - 1) / tileHeight);
+
+    SkAutoLockPixels alp(dst);
+
+    int workerCount = pool ? SkMin32(pool->threadCount(), grid.fTileCount) : 0;
+    if (workerCount <= 1) {
+        SkIRect tile;
+        for (int i = 0; i < grid.fTileCount; i++) {
+            grid.getTile(dst, i, &tile);
+            draw_tile(picture, dst, tile);
+        }
+        return;
+    }
+
+    SkPicture* shared = NULL;
+    SkData* data = NULL;
+    if (picture->canDrawConcurrently()) {
+        shared = picture;
+    } else {
+        SkDynamicMemoryWStream wstream;
+        picture->serialize(&wstream);
+        data = wstream.detachAsData();
+    }
+    SkAutoUnref aur(data);
+
+    int32_t nextTile = 0;
+    SkTDArray<TileWorker*> workers;
+    for (int i = 0; i < workerCount; i++) {
+        TileWorker* worker = SkNEW_ARGS(TileWorker,
+                                        (shared, data, dst, grid, &nextTile));
+        *workers.append() = worker;
+        pool->add(worker);
+    }
+    pool->wait();
+    workers.deleteAll();
+}
+
+bool SkPictureTiler::DrawBands(SkPicture* picture, int width, int height,
+                               int bandHeight, SkBitmap::Config config,
+                               BandSink* sink) {
+    SkASSERT(picture);
+    SkASSERT(sink);
+    SkASSERT(bandHeight > 0);
+
+    if (width <= 0 || height <= 0) {
+        return true;
+    }
+    picture->endRecording();
+
+    SkBitmap scratch;
+    scratch.setConfig(config, width, SkMin32(bandHeight, height));
+    if (!scratch.allocPixels()) {
+        return false;
+    }
+    SkAutoLockPixels alp(scratch);
+
+    for (int top = 0; top < height; top += bandHeight) {
+        SkIRect area;
+        area.set(0, 0, width, SkMin32(bandHeight, height - top));
+
+        // the last band may be shorter, so draw into (and hand out) just the
+        // rows that are part of the output
+        SkBitmap band;
+        if (!scratch.extractSubset(&band, area)) {
+            return false;
+        }
+        band.eraseColor(0);
+
+        {
+            SkCanvas canvas(band);
+            canvas.translate(0, -SkIntToScalar(top));
+            picture->draw(&canvas);
+        }
+        if (!sink->onBand(band, top)) {
+            return false;
+        }
+    }
+    return true;
+}
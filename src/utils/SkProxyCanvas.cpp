@@ -55,8 +55,9 @@ bool SkProxyCanvas::clipRect(const SkRect& rect, SkRegion::Op op) {
     return fProxy->clipRect(rect, op);
 }
 
-bool SkProxyCanvas::clipPath(const SkPath& path, SkRegion::Op op) {
-    return fProxy->clipPath(path, op);
+bool SkProxyCanvas::clipPath(const SkPath& path, SkRegion::Op op,
+                             bool doAntiAlias) {
+    return fProxy->clipPath(path, op, doAntiAlias);
 }
 
 bool SkProxyCanvas::clipRegion(const SkRegion& deviceRgn, SkRegion::Op op) {
@@ -116,6 +117,11 @@ void SkProxyCanvas::drawPosTextH(const void* text, size_t byteLength,
     fProxy->drawPosTextH(text, byteLength, xpos, constY, paint);
 }
 
+void SkProxyCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x,
+                                 SkScalar y, const SkPaint& paint) {
+    fProxy->drawTextBlob(blob, x, y, paint);
+}
+
 void SkProxyCanvas::drawTextOnPath(const void* text, size_t byteLength,
                                    const SkPath& path, const SkMatrix* matrix,
                                    const SkPaint& paint) {
@@ -0,0 +1,217 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "SkReadAheadStream.h"
+
+static inline size_t min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+SkReadAheadStream::SkReadAheadStream(SkStream* proxy, size_t blockSize,
+                                     size_t cacheLimit)
+        : fProxy(proxy), fMutex(false), fThread(1) {
+    SkASSERT(proxy != NULL);
+    proxy->ref();
+
+    if (0 == blockSize) {
+        blockSize = kDefaultBlockSize;
+    }
+    fBlockSize = (blockSize + kAlignment - 1) & ~(size_t)(kAlignment - 1);
+    fCacheLimit = cacheLimit ? cacheLimit : (size_t)kDefaultCacheLimit;
+
+    // asking for the length may seek the proxy, so we do it before the
+    // background thread could be reading it
+    fLength = proxy->getLength();
+    fOffset = 0;
+    fFirstBlock = 0;
+    fHeld = 0;
+    fFetched = 0;
+    fTarget = 0;
+    fAtEnd = false;
+    fFilling = false;
+    fFiller.fStream = this;
+}
+
+SkReadAheadStream::~SkReadAheadStream() {
+    this->reset();
+    fProxy->unref();
+}
+
+void SkReadAheadStream::fill() {
+    size_t hinted = 0;
+    for (;;) {
+        size_t start, end;
+        fMutex.acquire();
+        if (fAtEnd || fFetched >= fTarget) {
+            fFilling = false;
+            fMutex.release();
+            return;
+        }
+        start = fFetched;
+        end = fTarget;
+        fMutex.release();
+
+        if (end > hinted) {
+            if (hinted < start) {
+                hinted = start;
+            }
+            fProxy->prefetch(hinted, end - hinted);
+            hinted = end;
+        }
+
+        char* block = (char*)sk_malloc_throw(fBlockSize);
+        size_t size = 0;
+        while (size < fBlockSize) {
+            size_t bytes = fProxy->read(block + size, fBlockSize - size);
+            if (0 == bytes) {
+                break;
+            }
+            size += bytes;
+        }
+
+        SkAutoMutexAcquire ac(fMutex);
+        if (size) {
+            *fBlocks.append() = block;
+            fHeld += fBlockSize;
+            fFetched += size;
+        } else {
+            sk_free(block);
+        }
+        fAtEnd = size < fBlockSize;
+    }
+}
+
+void SkReadAheadStream::fetchTo(size_t end) {
+    bool start = false;
+    {
+        SkAutoMutexAcquire ac(fMutex);
+        if (end > fTarget) {
+            fTarget = end;
+        }
+        if (!fFilling && !fAtEnd && fFetched < fTarget) {
+            fFilling = start = true;
+        }
+    }
+    if (start) {
+        fThread.add(&fFiller);
+    }
+}
+
+size_t SkReadAheadStream::waitFor(size_t end) {
+    this->fetchTo(end);
+
+    fMutex.acquire();
+    bool ready = fAtEnd || fFetched >= end;
+    fMutex.release();
+    if (!ready) {
+        // the filler stops once it has reached fTarget, which is >= end
+        fThread.wait();
+    }
+
+    // keep the next few blocks coming while the caller uses these
+    this->fetchTo(min_size(end + kAheadBlocks * fBlockSize,
+                         fOffset + fCacheLimit));
+
+    SkAutoMutexAcquire ac(fMutex);
+    return min_size(end, fFetched);
+}
+
+void SkReadAheadStream::reset() {
+    fMutex.acquire();
+    fTarget = 0;
+    fMutex.release();
+    fThread.wait();
+
+    // the background thread is idle now, and stays so until fetchTo()
+    for (int i = fFirstBlock; i < fBlocks.count(); i++) {
+        sk_free(fBlocks[i]);
+    }
+    fBlocks.reset();
+    fHeld = 0;
+    fFetched = 0;
+    fAtEnd = false;
+    fFirstBlock = 0;
+    fOffset = 0;
+}
+
+void SkReadAheadStream::freeBehind() {
+    // the blocks that end at or before fOffset won't be read again, unless
+    // we are rewound
+    const int behind = (int)(fOffset / fBlockSize);
+
+    SkAutoMutexAcquire ac(fMutex);
+    while (fHeld > fCacheLimit && fFirstBlock < behind) {
+        sk_free(fBlocks[fFirstBlock]);
+        fBlocks[fFirstBlock] = NULL;
+        fFirstBlock += 1;
+        fHeld -= fBlockSize;
+    }
+}
+
+bool SkReadAheadStream::rewind() {
+    if (0 == fFirstBlock) {
+        fOffset = 0;
+        return true;
+    }
+    // the start has been freed, so we have to read the proxy over again
+    this->reset();
+    return fProxy->rewind();
+}
+
+const char* SkReadAheadStream::getFileName() {
+    return fProxy->getFileName();
+}
+
+size_t SkReadAheadStream::read(void* buffer, size_t size) {
+    if (NULL == buffer && 0 == size) {
+        return fLength;
+    }
+
+    char* dst = (char*)buffer;
+    size_t bytesRead = 0;
+    while (bytesRead < size) {
+        const int index = (int)(fOffset / fBlockSize);
+        const size_t blockStart = index * fBlockSize;
+        const size_t available = this->waitFor(blockStart + fBlockSize);
+        if (available <= fOffset) {
+            break;  // the proxy has ended
+        }
+
+        size_t bytes = min_size(available - fOffset, size - bytesRead);
+        if (dst) {
+            const char* block;
+            {
+                SkAutoMutexAcquire ac(fMutex);
+                block = fBlocks[index];
+            }
+            memcpy(dst + bytesRead, block + (fOffset - blockStart), bytes);
+        }
+        fOffset += bytes;
+        bytesRead += bytes;
+    }
+    this->freeBehind();
+    return bytesRead;
+}
+
+bool SkReadAheadStream::prefetch(size_t offset, size_t length) {
+    size_t end = offset + min_size(length, ~(size_t)0 - offset);
+    if (fLength && end > fLength) {
+        end = fLength;
+    }
+    this->fetchTo(min_size(end, fOffset + fCacheLimit));
+    return true;
+}
@@ -0,0 +1,185 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "SkThreadPool.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC) || \
+    defined(SK_BUILD_FOR_ANDROID) || defined(ANDROID)
+    #define SK_THREADPOOL_USE_PTHREADS
+#endif
+
+#ifdef SK_THREADPOOL_USE_PTHREADS
+
+#include <pthread.h>
+#include <unistd.h>
+
+struct SkThreadPool::Impl {
+    pthread_mutex_t fMutex;
+    pthread_cond_t  fWorkCond;  // signaled when work is queued or on exit
+    pthread_cond_t  fDoneCond;  // signaled when fPending drops to 0
+};
+
+SkThreadPool::SkThreadPool(int threadCount) : fPending(0), fDone(false) {
+    fImpl = SkNEW(Impl);
+    pthread_mutex_init(&fImpl->fMutex, NULL);
+    pthread_cond_init(&fImpl->fWorkCond, NULL);
+    pthread_cond_init(&fImpl->fDoneCond, NULL);
+
+    for (int i = 0; i < threadCount; i++) {
+        pthread_t* thread = (pthread_t*)sk_malloc_throw(sizeof(pthread_t));
+        if (pthread_create(thread, NULL, Loop, this)) {
+            sk_free(thread);
+            break;
+        }
+        *fThreads.append() = thread;
+    }
+}
+
+SkThreadPool::~SkThreadPool() {
+    pthread_mutex_lock(&fImpl->fMutex);
+    fDone = true;
+    pthread_cond_broadcast(&fImpl->fWorkCond);
+    pthread_mutex_unlock(&fImpl->fMutex);
+
+    for (int i = 0; i < fThreads.count(); i++) {
+        pthread_t* thread = (pthread_t*)fThreads[i];
+        pthread_join(*thread, NULL);
+        sk_free(thread);
+    }
+
+    pthread_cond_destroy(&fImpl->fDoneCond);
+    pthread_cond_destroy(&fImpl->fWorkCond);
+    pthread_mutex_destroy(&fImpl->fMutex);
+    SkDELETE(fImpl);
+}
+
+void SkThreadPool::add(SkRunnable* runnable) {
+    if (NULL == runnable) {
+        return;
+    }
+    pthread_mutex_lock(&fImpl->fMutex);
+    *fQueue.append() = runnable;
+    fPending += 1;
+    pthread_cond_signal(&fImpl->fWorkCond);
+    pthread_mutex_unlock(&fImpl->fMutex);
+}
+
+// must be called with fMutex held
+SkRunnable* SkThreadPool::nextRunnable() {
+    if (fQueue.isEmpty()) {
+        return NULL;
+    }
+    SkRunnable* runnable = fQueue[0];
+    fQueue.remove(0);
+    return runnable;
+}
+
+void SkThreadPool::wait() {
+    pthread_mutex_lock(&fImpl->fMutex);
+    if (fThreads.isEmpty()) {
+        // no workers, so drain the queue ourselves
+        SkRunnable* runnable;
+        while ((runnable = this->nextRunnable()) != NULL) {
+            pthread_mutex_unlock(&fImpl->fMutex);
+            runnable->run();
+            pthread_mutex_lock(&fImpl->fMutex);
+            fPending -= 1;
+        }
+    }
+    while (fPending > 0) {
+        pthread_cond_wait(&fImpl->fDoneCond, &fImpl->fMutex);
+    }
+    pthread_mutex_unlock(&fImpl->fMutex);
+}
+
+void* SkThreadPool::Loop(void* arg) {
+    SkThreadPool* pool = (SkThreadPool*)arg;
+    Impl* impl = pool->fImpl;
+
+    pthread_mutex_lock(&impl->fMutex);
+    for (;;) {
+        SkRunnable* runnable = pool->nextRunnable();
+        if (NULL == runnable) {
+            if (pool->fDone) {
+                break;
+            }
+            pthread_cond_wait(&impl->fWorkCond, &impl->fMutex);
+            continue;
+        }
+        pthread_mutex_unlock(&impl->fMutex);
+        runnable->run();
+        pthread_mutex_lock(&impl->fMutex);
+        if (0 == --pool->fPending) {
+            pthread_cond_broadcast(&impl->fDoneCond);
+        }
+    }
+    pthread_mutex_unlock(&impl->fMutex);
+    return NULL;
+}
+
+int SkThreadPool::CPUCount() {
+#ifdef _SC_NPROCESSORS_ONLN
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count > 0) {
+        return (int)count;
+    }
+#endif
+    return 1;
+}
+
+#else   // !SK_THREADPOOL_USE_PTHREADS
+
+/*  No thread support: every runnable is executed on the caller's thread when
+    wait() is called.
+ */
+
+SkThreadPool::SkThreadPool(int) : fImpl(NULL), fPending(0), fDone(false) {}
+
+SkThreadPool::~SkThreadPool() {}
+
+void SkThreadPool::add(SkRunnable* runnable) {
+    if (runnable) {
+        *fQueue.append() = runnable;
+        fPending += 1;
+    }
+}
+
+SkRunnable* SkThreadPool::nextRunnable() {
+    if (fQueue.isEmpty()) {
+        return NULL;
+    }
+    SkRunnable* runnable = fQueue[0];
+    fQueue.remove(0);
+    return runnable;
+}
+
+void SkThreadPool::wait() {
+    SkRunnable* runnable;
+    while ((runnable = this->nextRunnable()) != NULL) {
+        runnable->run();
+        fPending -= 1;
+    }
+}
+
+void* SkThreadPool::Loop(void*) {
+    return NULL;
+}
+
+int SkThreadPool::CPUCount() {
+    return 1;
+}
+
+#endif
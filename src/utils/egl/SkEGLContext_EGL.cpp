@@ -0,0 +1,178 @@
+#include "SkEGLContext.h"
+#include "SkTypes.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <string.h>
+
+#define SK_GL_GET_PROC(T, F) T F = NULL; \
+        F = (T) eglGetProcAddress(#F);
+
+// EGL_MESA_platform_surfaceless, in case eglext.h is too old to have it
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+    #define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static bool has_egl_extension(const char* extensions, const char* ext) {
+    if (NULL == extensions) {
+        return false;
+    }
+    size_t extLength = strlen(ext);
+    const char* p = extensions;
+    while (NULL != (p = strstr(p, ext))) {
+        // the name has to match a whole entry of the space separated list
+        if ((p == extensions || ' ' == p[-1]) &&
+            ('\0' == p[extLength] || ' ' == p[extLength])) {
+            return true;
+        }
+        p += extLength;
+    }
+    return false;
+}
+
+/*
+ *  Prefer the surfaceless platform, which needs neither a window system nor
+ *  a device node owned by a display server. Otherwise take the default
+ *  display, which headless drivers also provide.
+ */
+static EGLDisplay get_display() {
+    const char* clientExts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (has_egl_extension(clientExts, "EGL_MESA_platform_surfaceless") &&
+        has_egl_extension(clientExts, "EGL_EXT_platform_base")) {
+        SK_GL_GET_PROC(PFNEGLGETPLATFORMDISPLAYEXTPROC,
+                       eglGetPlatformDisplayEXT)
+        if (NULL != eglGetPlatformDisplayEXT) {
+            EGLDisplay display = eglGetPlatformDisplayEXT(
+                    EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (EGL_NO_DISPLAY != display) {
+                return display;
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+SkEGLContext::SkEGLContext()
+    : display(EGL_NO_DISPLAY)
+    , context(EGL_NO_CONTEXT)
+    , surface(EGL_NO_SURFACE) {
+}
+
+SkEGLContext::~SkEGLContext() {
+    if (EGL_NO_DISPLAY != this->display) {
+        eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+
+        if (EGL_NO_CONTEXT != this->context)
+            eglDestroyContext(this->display, this->context);
+
+        if (EGL_NO_SURFACE != this->surface)
+            eglDestroySurface(this->display, this->surface);
+
+        eglTerminate(this->display);
+    }
+}
+
+bool SkEGLContext::init(const int width, const int height) {
+    EGLDisplay display = get_display();
+    if (EGL_NO_DISPLAY == display) {
+        SkDebugf("Failed to get an EGL display.\n");
+        return false;
+    }
+
+    EGLint major, minor;
+    if (!eglInitialize(display, &major, &minor)) {
+        SkDebugf("Failed to initialize EGL.\n");
+        return false;
+    }
+    this->display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        SkDebugf("EGL doesn't support desktop OpenGL.\n");
+        return false;
+    }
+
+    // we draw into our own FBO, so the surface is only there to make the
+    // context current when the driver can't do without one
+    static const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE,       EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE,    EGL_OPENGL_BIT,
+        EGL_RED_SIZE,           8,
+        EGL_GREEN_SIZE,         8,
+        EGL_BLUE_SIZE,          8,
+        EGL_ALPHA_SIZE,         8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) ||
+        numConfigs < 1) {
+        SkDebugf("Failed to find an EGL config.\n");
+        return false;
+    }
+
+    EGLContext ctx = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    if (EGL_NO_CONTEXT == ctx) {
+        SkDebugf("Failed to create an OpenGL context.\n");
+        return false;
+    }
+    this->context = ctx;
+
+    const char* displayExts = eglQueryString(display, EGL_EXTENSIONS);
+    if (!has_egl_extension(displayExts, "EGL_KHR_surfaceless_context")) {
+        static const EGLint surfaceAttribs[] = {
+            EGL_WIDTH,  1,
+            EGL_HEIGHT, 1,
+            EGL_NONE
+        };
+        this->surface = eglCreatePbufferSurface(display, config,
+                                                surfaceAttribs);
+        if (EGL_NO_SURFACE == this->surface) {
+            SkDebugf("Failed to create a pbuffer.\n");
+            return false;
+        }
+    }
+
+    if (!eglMakeCurrent(display, this->surface, this->surface, ctx)) {
+        SkDebugf("Could not set the context.\n");
+        return false;
+    }
+
+    //Setup the framebuffers
+    SK_GL_GET_PROC(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers)
+    SK_GL_GET_PROC(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer)
+    SK_GL_GET_PROC(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers)
+    SK_GL_GET_PROC(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer)
+    SK_GL_GET_PROC(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage)
+    SK_GL_GET_PROC(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer)
+    SK_GL_GET_PROC(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus)
+    if (NULL == glGenFramebuffers || NULL == glBindFramebuffer ||
+        NULL == glGenRenderbuffers || NULL == glBindRenderbuffer ||
+        NULL == glRenderbufferStorage || NULL == glFramebufferRenderbuffer ||
+        NULL == glCheckFramebufferStatus) {
+        SkDebugf("Framebuffer objects not found.\n");
+        return false;
+    }
+
+    GLuint fboID;
+    GLuint cbID;
+    GLuint dsID;
+    glGenFramebuffers(1, &fboID);
+    glBindFramebuffer(GL_FRAMEBUFFER, fboID);
+    glGenRenderbuffers(1, &cbID);
+    glBindRenderbuffer(GL_RENDERBUFFER, cbID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, cbID);
+    glGenRenderbuffers(1, &dsID);
+    glBindRenderbuffer(GL_RENDERBUFFER, dsID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, dsID);
+    glViewport(0, 0, width, height);
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    return GL_FRAMEBUFFER_COMPLETE == status;
+}
@@ -224,9 +224,11 @@ void SkOSWindow::onHandleInval(const SkIRect&)
 bool SkOSWindow::onEvent(const SkEvent& evt)
 {
     if (evt.isType("inval-imageview")) {
-        update(NULL);
-        if (!fGLAttached)
-            doPaint();
+        // only what was redrawn needs to reach the screen, and an event
+        // posted after an earlier one already drew everything has none
+        SkIRect area;
+        if (update(&area) && !fGLAttached)
+            doPaint(&area);
         return true;
     }
     return INHERITED::onEvent(evt);
@@ -251,17 +253,20 @@ static bool convertBitmapToXImage(XImage& image, const SkBitmap& bitmap)
     return XInitImage(&image);
 }
 
-void SkOSWindow::doPaint() {
+void SkOSWindow::doPaint(const SkIRect* areaOrNull) {
     if (!fUnixWindow.fDisplay) return;
-    // Draw the bitmap to the screen.
+    // Draw the bitmap (or just the given area of it) to the screen.
     const SkBitmap& bitmap = getBitmap();
-    int width = bitmap.width();
-    int height = bitmap.height();
+    SkIRect area;
+    area.set(0, 0, bitmap.width(), bitmap.height());
+    if (areaOrNull && !area.intersect(*areaOrNull)) return;
 
     XImage image;
     if (!convertBitmapToXImage(image, bitmap)) return;
 
-    XPutImage(fUnixWindow.fDisplay, fUnixWindow.fWin, fUnixWindow.fGc, &image, 0, 0, 0, 0, width, height);
+    XPutImage(fUnixWindow.fDisplay, fUnixWindow.fWin, fUnixWindow.fGc, &image,
+              area.fLeft, area.fTop, area.fLeft, area.fTop,
+              area.width(), area.height());
 }
 
 bool SkOSWindow::onHandleChar(SkUnichar)
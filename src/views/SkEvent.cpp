@@ -287,16 +287,35 @@ void SkEvent::inflate(const SkDOM& dom, const SkDOM::Node* node)
 #endif
 
 #include "SkGlobals.h"
+#include "SkTDArray.h"
 #include "SkThread.h"
 #include "SkTime.h"
 
 #define SK_Event_GlobalsTag     SkSetFourByteTag('e', 'v', 'n', 't')
 
+/*  Delayed events are kept in a binary heap, so posting one or taking the
+    earliest is O(log n). fOrder breaks ties between events with the same
+    time, so that those are still delivered in the order they were posted.
+ */
+struct SkDelayRec {
+    SkMSec      fTime;
+    uint32_t    fOrder;
+    SkEvent*    fEvent;
+
+    bool operator<(const SkDelayRec& other) const {
+        if (fTime != other.fTime) {
+            return SkMSec_LT(fTime, other.fTime);
+        }
+        return (int32_t)(fOrder - other.fOrder) < 0;
+    }
+};
+
 class SkEvent_Globals : public SkGlobals::Rec {
 public:
     SkMutex     fEventMutex;
     SkEvent*    fEventQHead, *fEventQTail;
-    SkEvent*    fDelayQHead;
+    SkTDArray<SkDelayRec>   fDelayHeap;
+    uint32_t    fDelayOrder;
     SkDEBUGCODE(int fEventCounter;)
 };
 
@@ -305,11 +324,56 @@ static SkGlobals::Rec* create_globals()
     SkEvent_Globals* rec = new SkEvent_Globals;
     rec->fEventQHead = NULL;
     rec->fEventQTail = NULL;
-    rec->fDelayQHead = NULL;
+    rec->fDelayOrder = 0;
     SkDEBUGCODE(rec->fEventCounter = 0;)
     return rec;
 }
 
+static void delay_heap_push(SkTDArray<SkDelayRec>* heap, const SkDelayRec& rec)
+{
+    int index = heap->count();
+    *heap->append() = rec;
+
+    SkDelayRec* array = heap->begin();
+    while (index > 0)
+    {
+        int parent = (index - 1) >> 1;
+        if (!(rec < array[parent]))
+            break;
+        array[index] = array[parent];
+        index = parent;
+    }
+    array[index] = rec;
+}
+
+static void delay_heap_pop(SkTDArray<SkDelayRec>* heap)
+{
+    SkASSERT(heap->count() > 0);
+
+    SkDelayRec last;
+    heap->pop(&last);
+
+    const int count = heap->count();
+    if (0 == count)
+        return;
+
+    SkDelayRec* array = heap->begin();
+    int index = 0;
+    for (;;)
+    {
+        int child = (index << 1) + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && array[child + 1] < array[child])
+            child += 1;
+        if (!(array[child] < last))
+            break;
+        array[index] = array[child];
+        index = child;
+    }
+    array[index] = last;
+}
+
 bool SkEvent::Post(SkEvent* evt, SkEventSinkID sinkID, SkMSec delay)
 {
     if (delay)
@@ -400,27 +464,17 @@ bool SkEvent::Enqueue(SkEvent* evt)
     return wasEmpty;
 }
 
-SkEvent* SkEvent::Dequeue(SkEventSinkID* sinkID)
+SkEvent* SkEvent::DequeueAll()
 {
     SkEvent_Globals& globals = *(SkEvent_Globals*)SkGlobals::Find(SK_Event_GlobalsTag, create_globals);
     globals.fEventMutex.acquire();
 
     SkEvent* evt = globals.fEventQHead;
-    if (evt)
-    {
-        SkDEBUGCODE(--globals.fEventCounter);
+    globals.fEventQHead = NULL;
+    globals.fEventQTail = NULL;
+    SkDEBUGCODE(globals.fEventCounter = 0;)
 
-        if (sinkID)
-            *sinkID = evt->fTargetID;
-
-        globals.fEventQHead = evt->fNextEvent;
-        if (globals.fEventQHead == NULL)
-            globals.fEventQTail = NULL;
-    }
     globals.fEventMutex.release();
-
-//  SkDebugf("Dequeue: count=%d\n", gEventCounter);
-
     return evt;
 }
 
@@ -450,25 +504,16 @@ SkMSec SkEvent::EnqueueTime(SkEvent* evt, SkMSec time)
     SkEvent_Globals& globals = *(SkEvent_Globals*)SkGlobals::Find(SK_Event_GlobalsTag, create_globals);
     //  gEventMutex acquired by caller
 
-    SkEvent* curr = globals.fDelayQHead;
-    SkEvent* prev = NULL;
-
-    while (curr)
-    {
-        if (SkMSec_LT(time, curr->fTime))
-            break;
-        prev = curr;
-        curr = curr->fNextEvent;
-    }
-
     evt->fTime = time;
-    evt->fNextEvent = curr;
-    if (prev == NULL)
-        globals.fDelayQHead = evt;
-    else
-        prev->fNextEvent = evt;
+    evt->fNextEvent = NULL;
+
+    SkDelayRec rec;
+    rec.fTime = time;
+    rec.fOrder = globals.fDelayOrder++;
+    rec.fEvent = evt;
+    delay_heap_push(&globals.fDelayHeap, rec);
 
-    SkMSec delay = globals.fDelayQHead->fTime - SkTime::GetMSecs();
+    SkMSec delay = globals.fDelayHeap[0].fTime - SkTime::GetMSecs();
     if ((int32_t)delay <= 0)
         delay = 1;
     return delay;
@@ -480,19 +525,23 @@ SkMSec SkEvent::EnqueueTime(SkEvent* evt, SkMSec time)
 
 bool SkEvent::ProcessEvent()
 {
-    SkEventSinkID   sinkID;
-    SkEvent*        evt = SkEvent::Dequeue(&sinkID);
-    SkAutoTDelete<SkEvent>  autoDelete(evt);
-    bool            again = false;
+    // take everything queued so far in one go, rather than locking the
+    // queue (and, for the caller, waking up) once per event
+    SkEvent* evt = SkEvent::DequeueAll();
+    if (NULL == evt)
+        return false;
+
+    do {
+        SkEvent* next = evt->fNextEvent;
+        SkAutoTDelete<SkEvent>  autoDelete(evt);
 
-    EVENT_LOGN("ProcessEvent", (int32_t)evt);
+        EVENT_LOGN("ProcessEvent", (int32_t)evt);
 
-    if (evt)
-    {
-        (void)SkEventSink::DoEvent(*evt, sinkID);
-        again = SkEvent::QHasEvents();
-    }
-    return again;
+        (void)SkEventSink::DoEvent(*evt, evt->fTargetID);
+        evt = next;
+    } while (evt);
+
+    return SkEvent::QHasEvents();
 }
 
 void SkEvent::ServiceQueueTimer()
@@ -503,13 +552,16 @@ void SkEvent::ServiceQueueTimer()
 
     bool        wasEmpty = false;
     SkMSec      now = SkTime::GetMSecs();
-    SkEvent*    evt = globals.fDelayQHead;
+    SkTDArray<SkDelayRec>& heap = globals.fDelayHeap;
 
-    while (evt)
+    while (heap.count() > 0)
     {
-        if (SkMSec_LT(now, evt->fTime))
+        if (SkMSec_LT(now, heap[0].fTime))
             break;
 
+        SkEvent* evt = heap[0].fEvent;
+        delay_heap_pop(&heap);
+
 #ifdef SK_TRACE_EVENTS
         --gDelayDepth;
         SkDebugf("dequeue-delay %s (%d)", evt->getType(), gDelayDepth);
@@ -519,14 +571,11 @@ void SkEvent::ServiceQueueTimer()
         SkDebugf("\n");
 #endif
 
-        SkEvent* next = evt->fNextEvent;
         if (SkEvent::Enqueue(evt))
             wasEmpty = true;
-        evt = next;
     }
-    globals.fDelayQHead = evt;
 
-    SkMSec time = evt ? evt->fTime - now : 0;
+    SkMSec time = heap.count() > 0 ? heap[0].fTime - now : 0;
 
     globals.fEventMutex.release();
 
@@ -569,12 +618,8 @@ void SkEvent::Term()
         evt = next;
     }
 
-    evt = globals.fDelayQHead;
-    while (evt)
-    {
-        SkEvent* next = evt->fNextEvent;
-        delete evt;
-        evt = next;
-    }
+    for (int i = 0; i < globals.fDelayHeap.count(); i++)
+        delete globals.fDelayHeap[i].fEvent;
+    globals.fDelayHeap.reset();
 }
 
@@ -208,6 +208,9 @@ SkListView::SkListView(U32 flags) : SkWidgetView(flags)
 	fRowHeight = SkIntToScalar(16);
 	fVisibleRowCount = 0;
 	fStrCache = NULL;
+	fStrCacheSlots = 0;
+	fStrCacheStart = 0;
+	fStrCacheRows = 0;
 
 	fPaint[kBG_Attr].setColor(0);
 	fPaint[kNormalText_Attr].setTextSize(SkIntToScalar(14));
@@ -302,7 +305,7 @@ void SkListView::ensureSelectionIsVisible()
 				fScrollIndex = fCurrIndex - fVisibleRowCount + 1;
 			SkASSERT((unsigned)fScrollIndex < (unsigned)fSource->countRows());
 
-			this->dirtyStrCache();
+			// the rows still showing stay in the cache
 			this->inval(NULL);
 		}
 	}
@@ -384,10 +387,11 @@ void SkListView::onDraw(SkCanvas* canvas)
 		else
 			p = &fPaint[kNormalText_Attr];
 
+		const SkString* row = this->getCachedRow(i + fScrollIndex);
 		p->setTextAlign(SkPaint::kLeft_Align);
-		canvas->drawText(fStrCache[i].c_str(), fStrCache[i].size(), x, y, *p);
+		canvas->drawText(row[0].c_str(), row[0].size(), x, y, *p);
 		p->setTextAlign(SkPaint::kRight_Align);
-		canvas->drawText(fStrCache[i + visibleCount].c_str(), fStrCache[i + visibleCount].size(), rite, y, *p);
+		canvas->drawText(row[1].c_str(), row[1].size(), rite, y, *p);
 		canvas->translate(0, fRowHeight);
 	}
 }
@@ -405,29 +409,51 @@ void SkListView::onSizeChange()
 	{
 		fVisibleRowCount = n;
 		this->ensureSelectionIsVisible();
-		this->dirtyStrCache();
 	}
 }
 
 void SkListView::dirtyStrCache()
 {
-	if (fStrCache)
-	{
-		delete[] fStrCache;
-		fStrCache = NULL;
-	}
+	// keep the strings' storage, just forget what they hold
+	fStrCacheRows = 0;
 }
 
+/*	Scrolling only fetches the rows that came into view, into the slots of
+	the ones that left it, so steady scrolling neither reallocates the cache
+	nor asks the source for rows it has already given us.
+*/
 void SkListView::ensureStrCache(int count)
 {
-	if (fStrCache == NULL)
+	if (fStrCacheSlots < count)
 	{
+		delete[] fStrCache;
 		fStrCache = new SkString[count << 1];
-
-		if (fSource)
-			for (int i = 0; i < count; i++)
-				fSource->getRow(i + fScrollIndex, &fStrCache[i], &fStrCache[i + count]);
+		fStrCacheSlots = count;
+		fStrCacheRows = 0;
 	}
+
+	int start = fScrollIndex;
+	int stop = fScrollIndex + count;
+	int keepStart = SkMax32(start, fStrCacheStart);
+	int keepStop = SkMin32(stop, fStrCacheStart + fStrCacheRows);
+
+	if (fSource)
+		for (int i = start; i < stop; i++)
+		{
+			if (i >= keepStart && i < keepStop)
+				continue;
+
+			SkString* row = &fStrCache[(i % fStrCacheSlots) << 1];
+			fSource->getRow(i, &row[0], &row[1]);
+		}
+	fStrCacheStart = start;
+	fStrCacheRows = fSource ? count : 0;
+}
+
+const SkString* SkListView::getCachedRow(int index) const
+{
+	SkASSERT(index >= fStrCacheStart && index < fStrCacheStart + fStrCacheRows);
+	return &fStrCache[(index % fStrCacheSlots) << 1];
 }
 
 bool SkListView::onEvent(const SkEvent& evt)
@@ -17,6 +17,7 @@ SkStaticTextView::SkStaticTextView()
 	fMargin.set(0, 0);
 	fMode = kFixedSize_Mode;
 	fSpacingAlign = SkTextBox::kStart_SpacingAlign;
+	fTextBox.setText(fText.c_str(), fText.size(), fPaint);
 	
 //	init_skin_paint(kStaticText_SkinEnum, &fPaint);
 }
@@ -105,6 +106,7 @@ void SkStaticTextView::setText(const char text[], size_t len)
 	if (!fText.equals(text, len))
 	{
 		fText.set(text, len);
+		fTextBox.setText(fText.c_str(), fText.size(), fPaint);
 		this->computeSize();
 		this->inval(NULL);
 	}
@@ -133,12 +135,11 @@ void SkStaticTextView::onDraw(SkCanvas* canvas)
 	if (fText.isEmpty())
 		return;
 
-	SkTextBox	box;
-
-	box.setMode(fMode == kAutoWidth_Mode ? SkTextBox::kOneLine_Mode : SkTextBox::kLineBreak_Mode);
-	box.setSpacingAlign(this->getSpacingAlign());
-	box.setBox(fMargin.fX, fMargin.fY, this->width() - fMargin.fX, this->height() - fMargin.fY);
-	box.draw(canvas, fText.c_str(), fText.size(), fPaint);
+	// fTextBox keeps its lines until the text, the width or the font changes
+	fTextBox.setMode(fMode == kAutoWidth_Mode ? SkTextBox::kOneLine_Mode : SkTextBox::kLineBreak_Mode);
+	fTextBox.setSpacingAlign(this->getSpacingAlign());
+	fTextBox.setBox(fMargin.fX, fMargin.fY, this->width() - fMargin.fX, this->height() - fMargin.fY);
+	fTextBox.draw(canvas);
 }
 
 void SkStaticTextView::onInflate(const SkDOM& dom, const SkDOM::Node* node)
@@ -16,6 +16,7 @@
 */
 
 #include "SkTextBox.h"
+#include "SkTextBlob.h"
 #include "../core/SkGlyphCache.h"
 #include "SkUtils.h"
 #include "SkAutoKern.h"
@@ -37,19 +38,25 @@ static size_t linebreak(const char text[], const char stop[], const SkPaint& pai
 
     const char* word_start = text;
     int         prevWS = true;
+    bool        devKern = paint.isDevKernText();
 
     while (text < stop)
     {
         const char* prevText = text;
         SkUnichar   uni = SkUTF8_NextUnichar(&text);
         int         currWS = is_ws(uni);
-        const SkGlyph&  glyph = cache->getUnicharMetrics(uni);
 
         if (!currWS && prevWS)
             word_start = prevText;
         prevWS = currWS;
 
-        w += autokern.adjust(glyph) + glyph.fAdvanceX;
+        if (devKern)
+        {
+            const SkGlyph&  glyph = cache->getUnicharAdvance(uni);
+            w += autokern.adjust(glyph) + glyph.fAdvanceX;
+        }
+        else    // the strike keeps a table of the common advances
+            w += cache->getUnicharAdvanceX(uni);
         if (w > limit)
         {
             if (currWS) // eat the rest of the whitespace
@@ -97,6 +104,16 @@ SkTextBox::SkTextBox()
     fSpacingAdd = 0;
     fMode = kLineBreak_Mode;
     fSpacingAlign = kStart_SpacingAlign;
+    fText = NULL;
+    fLen = 0;
+    fPaint = NULL;
+    fLinesWidth = 0;
+    fLinesValid = false;
+}
+
+SkTextBox::~SkTextBox()
+{
+    this->clearLines();
 }
 
 void SkTextBox::setMode(Mode mode)
@@ -143,62 +160,78 @@ void SkTextBox::setSpacing(SkScalar mul, SkScalar add)
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-void SkTextBox::draw(SkCanvas* canvas, const char text[], size_t len, const SkPaint& paint)
+SkScalar SkTextBox::lineOriginX(const SkPaint& paint) const
 {
-    SkASSERT(canvas && &paint && (text || len == 0));
-
-    SkScalar marginWidth = fBox.width();
-
-    if (marginWidth <= 0 || len == 0)
-        return;
-
-    const char* textStop = text + len;
-
-    SkScalar                x, y, scaledSpacing, height, fontHeight;
-    SkPaint::FontMetrics    metrics;
+    SkScalar x;
 
     switch (paint.getTextAlign()) {
     case SkPaint::kLeft_Align:
         x = 0;
         break;
     case SkPaint::kCenter_Align:
-        x = SkScalarHalf(marginWidth);
+        x = SkScalarHalf(fBox.width());
         break;
     default:
-        x = marginWidth;
+        x = fBox.width();
         break;
     }
-    x += fBox.fLeft;
+    return x + fBox.fLeft;
+}
 
-    fontHeight = paint.getFontMetrics(&metrics);
-    scaledSpacing = SkScalarMul(fontHeight, fSpacingMul) + fSpacingAdd;
-    height = fBox.height();
+SkScalar SkTextBox::firstBaseline(int lineCount, const SkPaint& paint,
+                                  SkPaint::FontMetrics* metrics,
+                                  SkScalar* scaledSpacing) const
+{
+    SkScalar fontHeight = paint.getFontMetrics(metrics);
+    SkScalar height = fBox.height();
+    SkScalar textHeight = fontHeight;
+    SkScalar y;
 
-    //  compute Y position for first line
-    {
-        SkScalar textHeight = fontHeight;
+    *scaledSpacing = SkScalarMul(fontHeight, fSpacingMul) + fSpacingAdd;
 
-        if (fMode == kLineBreak_Mode && fSpacingAlign != kStart_SpacingAlign)
-        {
-            int count = SkTextLineBreaker::CountLines(text, textStop - text, paint, marginWidth);
-            SkASSERT(count > 0);
-            textHeight += scaledSpacing * (count - 1);
-        }
+    if (fMode == kLineBreak_Mode && fSpacingAlign != kStart_SpacingAlign)
+    {
+        SkASSERT(lineCount > 0);
+        textHeight += *scaledSpacing * (lineCount - 1);
+    }
 
-        switch (fSpacingAlign) {
-        case kStart_SpacingAlign:
-            y = 0;
-            break;
-        case kCenter_SpacingAlign:
-            y = SkScalarHalf(height - textHeight);
-            break;
-        default:
-            SkASSERT(fSpacingAlign == kEnd_SpacingAlign);
-            y = height - textHeight;
-            break;
-        }
-        y += fBox.fTop - metrics.fAscent;
+    switch (fSpacingAlign) {
+    case kStart_SpacingAlign:
+        y = 0;
+        break;
+    case kCenter_SpacingAlign:
+        y = SkScalarHalf(height - textHeight);
+        break;
+    default:
+        SkASSERT(fSpacingAlign == kEnd_SpacingAlign);
+        y = height - textHeight;
+        break;
     }
+    return y + fBox.fTop - metrics->fAscent;
+}
+
+void SkTextBox::draw(SkCanvas* canvas, const char text[], size_t len, const SkPaint& paint)
+{
+    SkASSERT(canvas && &paint && (text || len == 0));
+
+    SkScalar marginWidth = fBox.width();
+
+    if (marginWidth <= 0 || len == 0)
+        return;
+
+    const char* textStop = text + len;
+
+    SkScalar                x, y, scaledSpacing, height;
+    SkPaint::FontMetrics    metrics;
+    int                     count = 1;
+
+    // only the end and center alignments need the lines counted up front
+    if (fMode == kLineBreak_Mode && fSpacingAlign != kStart_SpacingAlign)
+        count = SkTextLineBreaker::CountLines(text, len, paint, marginWidth);
+
+    x = this->lineOriginX(paint);
+    y = this->firstBaseline(count, paint, &metrics, &scaledSpacing);
+    height = fBox.height();
 
     for (;;)
     {
@@ -216,22 +249,82 @@ void SkTextBox::draw(SkCanvas* canvas, const char text[], size_t len, const SkPa
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void SkTextBox::clearLines() const
+{
+    fLines.unrefAll();
+    fLinesValid = false;
+}
+
+/*  The lines only depend on the width of the box and on the paint's font, so
+    moving the box or changing the spacing or the paint's color, shader etc.
+    keeps them.
+*/
+void SkTextBox::validateLines() const
+{
+    SkScalar width = fBox.width();
+
+    if (fLinesValid && fLinesWidth == width &&
+            SkTextBlob::SameFont(fLinesFont, *fPaint))
+        return;
+
+    this->clearLines();
+
+    // the same lines that SkTextLineBreaker::CountLines() would count
+    if (width > 0)
+    {
+        const char* text = fText;
+        const char* stop = fText + fLen;
+        do {
+            size_t len = linebreak(text, stop, *fPaint, width);
+            *fLines.append() = SkTextBlob::Create(text, len, *fPaint);
+            text += len;
+        } while (text < stop);
+    }
+    fLinesFont = *fPaint;
+    fLinesWidth = width;
+    fLinesValid = true;
+}
+
 void SkTextBox::setText(const char text[], size_t len, const SkPaint& paint) {
     fText = text;
     fLen = len;
     fPaint = &paint;
+    this->clearLines();
 }
 
 void SkTextBox::draw(SkCanvas* canvas) {
-    this->draw(canvas, fText, fLen, *fPaint);
+    SkASSERT(canvas && fPaint);
+
+    this->validateLines();
+    if (fLines.isEmpty() || 0 == fLen)
+        return;
+
+    const SkPaint&          paint = *fPaint;
+    SkScalar                x, y, scaledSpacing, height;
+    SkPaint::FontMetrics    metrics;
+
+    x = this->lineOriginX(paint);
+    y = this->firstBaseline(fLines.count(), paint, &metrics, &scaledSpacing);
+    height = fBox.height();
+
+    for (int i = 0;;)
+    {
+        if (y + metrics.fDescent + metrics.fLeading > 0)
+            canvas->drawTextBlob(fLines[i], x, y, paint);
+        if (++i >= fLines.count())
+            break;
+        y += scaledSpacing;
+        if (y + metrics.fAscent >= height)
+            break;
+    }
 }
 
 int SkTextBox::countLines() const {
-    return SkTextLineBreaker::CountLines(fText, fLen, *fPaint, fBox.width());
+    this->validateLines();
+    return fLines.count();
 }
 
 SkScalar SkTextBox::getTextHeight() const {
     SkScalar spacing = SkScalarMul(fPaint->getTextSize(), fSpacingMul) + fSpacingAdd;
     return this->countLines() * spacing;
 }
-
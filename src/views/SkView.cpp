@@ -1,5 +1,6 @@
 #include "SkView.h"
 #include "SkCanvas.h"
+#include "SkPicture.h"
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -10,11 +11,26 @@ SkView::SkView(uint32_t flags) : fFlags(SkToU8(flags))
 	fParent = fFirstChild = fNextSibling = fPrevSibling = NULL;
 	
 	fContainsFocus = 0;
+	fPictureIsDirty = true;
+	fPicture = NULL;
 }
 
 SkView::~SkView()
 {
 	this->detachAllChildren();
+	SkSafeUnref(fPicture);
+}
+
+void SkView::setCachingDrawing(bool pred) {
+    if (pred != this->isCachingDrawing()) {
+        if (pred) {
+            fPicture = SkNEW(SkPicture);
+        } else {
+            fPicture->unref();
+            fPicture = NULL;
+        }
+        fPictureIsDirty = true;
+    }
 }
 
 void SkView::setFlags(uint32_t flags)
@@ -73,9 +89,12 @@ void SkView::setLoc(SkScalar x, SkScalar y)
 {
 	if (fLoc.fX != x || fLoc.fY != y)
 	{
+        // moving doesn't change what the view itself draws
+        uint8_t wasDirty = fPictureIsDirty;
 		this->inval(NULL);
 		fLoc.set(x, y);
 		this->inval(NULL);
+        fPictureIsDirty = wasDirty;
 	}
 }
 
@@ -107,24 +126,45 @@ void SkView::draw(SkCanvas* canvas)
             fParent->beforeChild(this, canvas);
         }
 
-        int sc = canvas->save();
-		this->onDraw(canvas);
-        canvas->restoreToCount(sc);
+        if (NULL == fPicture) {
+            this->drawContent(canvas, true);
+            return;
+        }
+
+        if (fPictureIsDirty) {
+            SkCanvas* recorder = fPicture->beginRecording(
+                                                SkScalarCeil(fWidth),
+                                                SkScalarCeil(fHeight));
+            this->drawContent(recorder, false);
+            fPicture->endRecording();
+            fPictureIsDirty = false;
+        }
+        canvas->drawPicture(*fPicture);
 
         if (fParent) {
             fParent->afterChild(this, canvas);
         }
-        
-		B2FIter	iter(this);
-		SkView*	child;
+	}
+}
 
-        SkCanvas* childCanvas = this->beforeChildren(canvas);
+void SkView::drawContent(SkCanvas* canvas, bool callAfterChild) {
+    int sc = canvas->save();
+    this->onDraw(canvas);
+    canvas->restoreToCount(sc);
 
-		while ((child = iter.next()) != NULL)
-			child->draw(childCanvas);
-        
-        this->afterChildren(canvas);
-	}
+    if (callAfterChild && fParent) {
+        fParent->afterChild(this, canvas);
+    }
+
+    B2FIter	iter(this);
+    SkView*	child;
+
+    SkCanvas* childCanvas = this->beforeChildren(canvas);
+
+    while ((child = iter.next()) != NULL)
+        child->draw(childCanvas);
+
+    this->afterChildren(canvas);
 }
 
 void SkView::inval(SkRect* rect) {
@@ -144,6 +184,7 @@ void SkView::inval(SkRect* rect) {
             storage = bounds;
             rect = &storage;
         }
+        view->fPictureIsDirty = true;
         if (view->handleInval(rect)) {
             return;
         }
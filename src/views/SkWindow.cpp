@@ -133,6 +133,32 @@ bool SkWindow::handleInval(const SkRect* localR)
 	return true;
 }
 
+void SkWindow::scrollRect(const SkIRect* subset, int dx, int dy) {
+    SkIRect r;
+    r.set(0, 0, fBitmap.width(), fBitmap.height());
+    if (NULL != subset && !r.intersect(*subset)) {
+        return;
+    }
+
+    // the bitmap reports what was exposed relative to r
+    SkRegion exposed;
+    if (!fBitmap.scrollRect(&r, dx, dy, &exposed)) {
+        exposed.setRect(0, 0, r.width(), r.height());
+    }
+    exposed.translate(r.fLeft, r.fTop);
+
+    SkRegion moved;
+    if (moved.op(fDirtyRgn, r, SkRegion::kIntersect_Op)) {
+        moved.translate(dx, dy);
+        moved.op(r, SkRegion::kIntersect_Op);
+        fDirtyRgn.op(moved, SkRegion::kUnion_Op);
+    }
+    if (!exposed.isEmpty()) {
+        fDirtyRgn.op(exposed, SkRegion::kUnion_Op);
+        this->onHandleInval(exposed.getBounds());
+    }
+}
+
 void SkWindow::forceInvalAll() {
     fDirtyRgn.setRect(0, 0,
                       SkScalarCeil(this->width()),
@@ -149,6 +175,44 @@ void SkWindow::forceInvalAll() {
 extern bool gEnableControlledThrow;
 #endif
 
+/*  Views are only rejected when they miss the clip's bounds, so when the dirty
+    region is a few small rects far apart (e.g. two blinking cursors), drawing
+    the window once per rect saves redrawing everything in between.
+ */
+static void draw_dirty(SkWindow* window, SkCanvas* canvas,
+                       const SkRegion& dirty) {
+    enum { kMaxRects = 8 };
+
+    if (dirty.isComplex()) {
+        const SkIRect& bounds = dirty.getBounds();
+        int64_t area = 0;
+        int count = 0;
+        for (SkRegion::Iterator iter(dirty); !iter.done(); iter.next()) {
+            const SkIRect& r = iter.rect();
+            area += (int64_t)r.width() * r.height();
+            if (++count > kMaxRects) {
+                break;
+            }
+        }
+        if (count <= kMaxRects &&
+                2 * area < (int64_t)bounds.width() * bounds.height()) {
+            for (SkRegion::Iterator iter(dirty); !iter.done(); iter.next()) {
+                SkRect r;
+                r.set(iter.rect());
+                SkAutoCanvasRestore acr(canvas, true);
+                canvas->clipRect(r);
+                canvas->concat(window->getMatrix());
+                window->draw(canvas);
+            }
+            return;
+        }
+    }
+
+    SkAutoCanvasRestore acr(canvas, true);
+    canvas->concat(window->getMatrix());
+    window->draw(canvas);
+}
+
 bool SkWindow::update(SkIRect* updateArea, SkCanvas* canvas)
 {
 	if (!fDirtyRgn.isEmpty())
@@ -174,16 +238,14 @@ bool SkWindow::update(SkIRect* updateArea, SkCanvas* canvas)
         }
         canvas->setBitmapDevice(bm);
 
-		canvas->clipRegion(fDirtyRgn);
-		if (updateArea)
-			*updateArea = fDirtyRgn.getBounds();
-
-        SkAutoCanvasRestore acr(canvas, true);
-        canvas->concat(fMatrix);
-
 		// empty this now, so we can correctly record any inval calls that
 		// might be made during the draw call.
-		fDirtyRgn.setEmpty();
+		SkRegion dirty;
+		dirty.swap(fDirtyRgn);
+
+		canvas->clipRegion(dirty);
+		if (updateArea)
+			*updateArea = dirty.getBounds();
 
 #ifdef TEST_BOUNDER
 		test_bounder	b(bm);
@@ -194,12 +256,12 @@ bool SkWindow::update(SkIRect* updateArea, SkCanvas* canvas)
 #endif
 #ifdef SK_BUILD_FOR_WIN32
 		//try {
-			this->draw(canvas);
+			draw_dirty(this, canvas, dirty);
 		//}
 		//catch (...) {
 		//}
 #else
-		this->draw(canvas);
+		draw_dirty(this, canvas, dirty);
 #endif
 #ifdef SK_SIMULATE_FAILED_MALLOC
 		gEnableControlledThrow = false;
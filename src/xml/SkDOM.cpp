@@ -16,6 +16,7 @@
 */
 
 #include "SkDOM.h"
+#include "SkTSearch.h"
 
 /////////////////////////////////////////////////////////////////////////
 
@@ -55,6 +56,8 @@ struct SkDOMNode {
     const char* fName;
     SkDOMNode*  fFirstChild;
     SkDOMNode*  fNextSibling;
+    SkDOMNode** fChildren;      // fChildCount of them, in order
+    uint32_t    fChildCount;
     uint16_t    fAttrCount;
     uint8_t     fType;
     uint8_t     fPad;
@@ -81,6 +84,32 @@ SkDOM::~SkDOM()
 {
 }
 
+void SkDOM::reset()
+{
+    fAlloc.reset();
+    fNames.reset();
+    fRoot = NULL;
+}
+
+const char* SkDOM::findName(const char name[]) const
+{
+    int index = SkStrSearch(fNames.begin(), fNames.count(), name, sizeof(const char*));
+    return index >= 0 ? fNames[index] : NULL;
+}
+
+const char* SkDOM::internName(const char name[])
+{
+    int index = SkStrSearch(fNames.begin(), fNames.count(), name, sizeof(const char*));
+    if (index >= 0)
+        return fNames[index];
+
+    size_t  len = strlen(name);
+    char*   dst = (char*)fAlloc.alloc(len + 1, SkChunkAlloc::kThrow_AllocFailType);
+    memcpy(dst, name, len + 1);
+    *fNames.insert(~index) = dst;
+    return dst;
+}
+
 const SkDOM::Node* SkDOM::getRootNode() const
 {
     return fRoot;
@@ -93,8 +122,12 @@ const SkDOM::Node* SkDOM::getFirstChild(const Node* node, const char name[]) con
 
     if (name)
     {
+        // a name that isn't in the table can't match any node
+        name = this->findName(name);
+        if (name == NULL)
+            return NULL;
         for (; child != NULL; child = child->fNextSibling)
-            if (!strcmp(name, child->fName))
+            if (child->fName == name)
                 break;
     }
     return child;
@@ -106,8 +139,11 @@ const SkDOM::Node* SkDOM::getNextSibling(const Node* node, const char name[]) co
     const Node* sibling = node->fNextSibling;
     if (name)
     {
+        name = this->findName(name);
+        if (name == NULL)
+            return NULL;
         for (; sibling != NULL; sibling = sibling->fNextSibling)
-            if (!strcmp(name, sibling->fName))
+            if (sibling->fName == name)
                 break;
     }
     return sibling;
@@ -131,9 +167,12 @@ const char* SkDOM::findAttr(const Node* node, const char name[]) const
     const Attr* attr = node->attrs();
     const Attr* stop = attr + node->fAttrCount;
 
+    name = this->findName(name);
+    if (name == NULL)
+        return NULL;
     while (attr < stop)
     {
-        if (!strcmp(attr->fName, name))
+        if (attr->fName == name)
             return attr->fValue;
         attr += 1;
     }
@@ -195,7 +234,6 @@ const char* SkDOM::AttrIter::next(const char** value)
 //////////////////////////////////////////////////////////////////////////////
 
 #include "SkXMLParser.h"
-#include "SkTDArray.h"
 
 static char* dupstr(SkChunkAlloc* chunk, const char src[])
 {
@@ -209,7 +247,7 @@ static char* dupstr(SkChunkAlloc* chunk, const char src[])
 class SkDOMParser : public SkXMLParser {
     bool fNeedToFlush;
 public:
-    SkDOMParser(SkChunkAlloc* chunk) : SkXMLParser(&fParserError), fAlloc(chunk)
+    SkDOMParser(SkDOM* dom) : SkXMLParser(&fParserError), fDOM(dom), fAlloc(&dom->fAlloc)
     {
         fRoot = NULL;
         fLevel = 0;
@@ -227,6 +265,8 @@ protected:
 
         node->fName = fElemName;
         node->fFirstChild = NULL;
+        node->fChildren = NULL;
+        node->fChildCount = 0;
         node->fAttrCount = SkToU16(attrCount);
         node->fType = SkDOM::kElement_Type;
 
@@ -253,14 +293,14 @@ protected:
         if (fLevel > 0 && fNeedToFlush)
             this->flushAttributes();
         fNeedToFlush = true;
-        fElemName = dupstr(fAlloc, elem);
+        fElemName = fDOM->internName(elem);
         ++fLevel;
         return false;
     }
     virtual bool onAddAttribute(const char name[], const char value[])
     {
         SkDOM::Attr* attr = fAttrs.append();
-        attr->fName = dupstr(fAlloc, name);
+        attr->fName = fDOM->internName(name);
         attr->fValue = dupstr(fAlloc, value);
         return false;
     }
@@ -277,36 +317,49 @@ protected:
 
         SkDOM::Node* child = parent->fFirstChild;
         SkDOM::Node* prev = NULL;
+        uint32_t count = 0;
         while (child)
         {
             SkDOM::Node* next = child->fNextSibling;
             child->fNextSibling = prev;
             prev = child;
             child = next;
+            count += 1;
         }
         parent->fFirstChild = prev;
+
+        // index the children too, so getChild() doesn't have to walk them
+        if (count > 0)
+        {
+            SkDOM::Node** children = (SkDOM::Node**)fAlloc->alloc(count * sizeof(SkDOM::Node*),
+                                                                  SkChunkAlloc::kThrow_AllocFailType);
+            parent->fChildren = children;
+            parent->fChildCount = count;
+            for (child = prev; child != NULL; child = child->fNextSibling)
+                *children++ = child;
+        }
         return false;
     }
 private:
     SkTDArray<SkDOM::Node*> fParentStack;
+    SkDOM*          fDOM;
     SkChunkAlloc*   fAlloc;
     SkDOM::Node*    fRoot;
 
     // state needed for flushAttributes()
     SkTDArray<SkDOM::Attr>  fAttrs;
-    char*                   fElemName;
+    const char*             fElemName;
     int                     fLevel;
 };
 
 const SkDOM::Node* SkDOM::build(const char doc[], size_t len)
 {
-    fAlloc.reset();
-    SkDOMParser parser(&fAlloc);
+    this->reset();
+    SkDOMParser parser(this);
     if (!parser.parse(doc, len))
     {
         SkDEBUGCODE(SkDebugf("xml parse error, line %d\n", parser.fParserError.getLineNumber());)
-        fRoot = NULL;
-        fAlloc.reset();
+        this->reset();
         return NULL;
     }
     fRoot = parser.getRoot();
@@ -339,8 +392,8 @@ static void walk_dom(const SkDOM& dom, const SkDOM::Node* node, SkXMLParser* par
 
 const SkDOM::Node* SkDOM::copy(const SkDOM& dom, const SkDOM::Node* node)
 {
-    fAlloc.reset();
-    SkDOMParser parser(&fAlloc);
+    this->reset();
+    SkDOMParser parser(this);
 
     walk_dom(dom, node, &parser);
 
@@ -352,17 +405,29 @@ const SkDOM::Node* SkDOM::copy(const SkDOM& dom, const SkDOM::Node* node)
 
 int SkDOM::countChildren(const Node* node, const char elem[]) const
 {
-    int count = 0;
+    SkASSERT(node);
+    if (elem == NULL)
+        return node->fChildCount;
 
-    node = this->getFirstChild(node, elem);
-    while (node)
-    {
-        count += 1;
-        node = this->getNextSibling(node, elem);
-    }
+    elem = this->findName(elem);
+    if (elem == NULL)
+        return 0;
+
+    int count = 0;
+    for (node = node->fFirstChild; node != NULL; node = node->fNextSibling)
+        if (node->fName == elem)
+            count += 1;
     return count;
 }
 
+const SkDOM::Node* SkDOM::getChild(const Node* node, int index) const
+{
+    SkASSERT(node);
+    if ((unsigned)index >= node->fChildCount)
+        return NULL;
+    return node->fChildren[index];
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 #include "SkParse.h"
@@ -503,6 +568,12 @@ void SkDOM::UnitTest()
 
     SkASSERT(dom.getFirstChild(root, "elem1"));
     SkASSERT(!dom.getFirstChild(root, "subelem1"));
+    SkASSERT(!dom.getFirstChild(root, "nosuchelem"));
+
+    SkASSERT(dom.countChildren(root) == 4);
+    SkASSERT(dom.countChildren(root, "elem2") == 1);
+    SkASSERT(dom.getChild(root, 3) == dom.getFirstChild(root, "elem4"));
+    SkASSERT(dom.getChild(root, 4) == NULL);
 
     dom.dump();
 #endif
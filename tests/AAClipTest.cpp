@@ -0,0 +1,155 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkPicture.h"
+
+static const int W = 64;
+static const int H = 64;
+
+static void make_bitmap(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kA8_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static int max_diff(const SkBitmap& a, const SkBitmap& b) {
+    int diff = 0;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            diff = SkMax32(diff, SkAbs32(*a.getAddr8(x, y) - *b.getAddr8(x, y)));
+        }
+    }
+    return diff;
+}
+
+static int count_partial(const SkBitmap& bm) {
+    int count = 0;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            uint8_t a = *bm.getAddr8(x, y);
+            count += (a > 0 && a < 255);
+        }
+    }
+    return count;
+}
+
+static void make_circle(SkPath* path) {
+    path->addCircle(SkIntToScalar(30), SkIntToScalar(33), SkIntToScalar(21));
+}
+
+// Filling through an antialiased clip should be the same as filling the
+// clip's path with antialiasing.
+static void test_intersect(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_circle(&path);
+
+    SkBitmap clipped, filled;
+    make_bitmap(&clipped);
+    make_bitmap(&filled);
+    {
+        SkCanvas canvas(clipped);
+        canvas.clipPath(path, SkRegion::kIntersect_Op, true);
+        canvas.drawColor(SK_ColorBLACK);
+    }
+    {
+        SkCanvas canvas(filled);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        canvas.drawPath(path, paint);
+    }
+    REPORTER_ASSERT(reporter, count_partial(clipped) > 0);
+    REPORTER_ASSERT(reporter, 0 == max_diff(clipped, filled));
+
+    // without antialiasing, the clip's edges are hard
+    SkBitmap aliased;
+    make_bitmap(&aliased);
+    {
+        SkCanvas canvas(aliased);
+        canvas.clipPath(path);
+        canvas.drawColor(SK_ColorBLACK);
+    }
+    REPORTER_ASSERT(reporter, 0 == count_partial(aliased));
+}
+
+// What a clip's difference covers and what the clip itself covers should add
+// up to everything (up to rounding).
+static void test_difference(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_circle(&path);
+
+    SkBitmap outside, inside;
+    make_bitmap(&outside);
+    make_bitmap(&inside);
+    {
+        SkCanvas canvas(outside);
+        canvas.clipPath(path, SkRegion::kDifference_Op, true);
+        canvas.drawColor(SK_ColorBLACK);
+    }
+    {
+        SkCanvas canvas(inside);
+        canvas.clipPath(path, SkRegion::kIntersect_Op, true);
+        SkPaint paint;
+        canvas.drawRect(SkRect::MakeWH(SkIntToScalar(W), SkIntToScalar(H)),
+                        paint);
+    }
+    REPORTER_ASSERT(reporter, count_partial(outside) > 0);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            int sum = *outside.getAddr8(x, y) + *inside.getAddr8(x, y);
+            REPORTER_ASSERT(reporter, SkAbs32(sum - 255) <= 1);
+        }
+    }
+}
+
+// The antialias flag has to survive recording into a picture.
+static void test_picture(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_circle(&path);
+
+    SkPicture picture;
+    SkCanvas* recording = picture.beginRecording(W, H);
+    recording->clipPath(path, SkRegion::kIntersect_Op, true);
+    recording->drawColor(SK_ColorBLACK);
+    picture.endRecording();
+
+    SkBitmap played, direct;
+    make_bitmap(&played);
+    make_bitmap(&direct);
+    {
+        SkCanvas canvas(played);
+        canvas.drawPicture(picture);
+    }
+    {
+        SkCanvas canvas(direct);
+        canvas.clipPath(path, SkRegion::kIntersect_Op, true);
+        canvas.drawColor(SK_ColorBLACK);
+    }
+    REPORTER_ASSERT(reporter, count_partial(played) > 0);
+    REPORTER_ASSERT(reporter, 0 == max_diff(played, direct));
+}
+
+static void TestAAClip(skiatest::Reporter* reporter) {
+    test_intersect(reporter);
+    test_difference(reporter);
+    test_picture(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("AAClip", AAClipTestClass, TestAAClip)
@@ -0,0 +1,232 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+
+static const int W = 64;
+static const int H = 64;
+
+static void draw_coverage(const SkPath& path, SkBitmap* bm, bool analytic,
+                          const SkIRect* clip = NULL) {
+    bm->setConfig(SkBitmap::kA8_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+
+    SkCanvas canvas(*bm);
+    if (clip) {
+        SkRect r;
+        r.set(*clip);
+        canvas.clipRect(r);
+    }
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setAnalyticAA(analytic);
+    canvas.drawPath(path, paint);
+}
+
+static int alpha_at(const SkBitmap& bm, int x, int y) {
+    return *bm.getAddr8(x, y);
+}
+
+static int coverage_sum(const SkBitmap& bm) {
+    int sum = 0;
+    for (int y = 0; y < bm.height(); y++) {
+        for (int x = 0; x < bm.width(); x++) {
+            sum += alpha_at(bm, x, y);
+        }
+    }
+    return sum;
+}
+
+// the coverage of every pixel along the edges of a rect is its exact area
+static void test_rect(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.addRect(SkFloatToScalar(10.5f), SkFloatToScalar(10.25f),
+                 SkFloatToScalar(20.75f), SkFloatToScalar(30.5f));
+
+    SkBitmap bm;
+    draw_coverage(path, &bm, true);
+    SkAutoLockPixels alp(bm);
+
+    REPORTER_ASSERT(reporter, 0 == alpha_at(bm, 9, 15));
+    REPORTER_ASSERT(reporter, 128 == alpha_at(bm, 10, 15));    // 1/2
+    REPORTER_ASSERT(reporter, 255 == alpha_at(bm, 15, 15));
+    REPORTER_ASSERT(reporter, 192 == alpha_at(bm, 20, 15));    // 3/4
+    REPORTER_ASSERT(reporter, 0 == alpha_at(bm, 21, 15));
+    REPORTER_ASSERT(reporter, 192 == alpha_at(bm, 15, 10));    // 3/4
+    REPORTER_ASSERT(reporter, 128 == alpha_at(bm, 15, 30));    // 1/2
+    REPORTER_ASSERT(reporter, 96 == alpha_at(bm, 10, 10));     // 3/8
+    REPORTER_ASSERT(reporter, 0 == alpha_at(bm, 15, 31));
+}
+
+// the coverage of each pixel of a convex polygon matches its area, sampled
+// much more finely than the supersampler does
+static void test_polygon(skiatest::Reporter* reporter) {
+    static const float gPts[] = {
+        31.3f, 2.1f,  58.7f, 20.4f,  50.2f, 61.9f,  8.6f, 55.3f,  3.2f, 17.8f
+    };
+    const int count = SK_ARRAY_COUNT(gPts) / 2;
+
+    SkPath path;
+    path.moveTo(SkFloatToScalar(gPts[0]), SkFloatToScalar(gPts[1]));
+    for (int i = 1; i < count; i++) {
+        path.lineTo(SkFloatToScalar(gPts[2 * i]),
+                    SkFloatToScalar(gPts[2 * i + 1]));
+    }
+    path.close();
+
+    SkBitmap bm;
+    draw_coverage(path, &bm, true);
+    SkAutoLockPixels alp(bm);
+
+    const int N = 64;
+    int maxDiff = 0;
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int inside = 0;
+            for (int sy = 0; sy < N; sy++) {
+                float py = y + (sy + 0.5f) / N;
+                for (int sx = 0; sx < N; sx++) {
+                    float px = x + (sx + 0.5f) / N;
+                    bool in = true;
+                    // the points are clockwise (in y-down space)
+                    for (int i = 0; i < count; i++) {
+                        int j = (i + 1) % count;
+                        float ex = gPts[2 * j] - gPts[2 * i];
+                        float ey = gPts[2 * j + 1] - gPts[2 * i + 1];
+                        float cross = ex * (py - gPts[2 * i + 1]) -
+                                      ey * (px - gPts[2 * i]);
+                        in &= (cross >= 0);
+                    }
+                    inside += in;
+                }
+            }
+            int expected = inside * 255 / (N * N);
+            maxDiff = SkMax32(maxDiff, SkAbs32(expected - alpha_at(bm, x, y)));
+        }
+    }
+    REPORTER_ASSERT(reporter, maxDiff <= 4);
+}
+
+// the total coverage of a circle matches its area
+static void test_circle(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.addCircle(SkFloatToScalar(32.3f), SkFloatToScalar(31.6f),
+                   SkIntToScalar(25));
+
+    SkBitmap bm;
+    draw_coverage(path, &bm, true);
+    SkAutoLockPixels alp(bm);
+
+    const float area = 3.14159265f * 25 * 25 * 255;
+    const int sum = coverage_sum(bm);
+    REPORTER_ASSERT(reporter, sum > area * 0.995f && sum < area * 1.005f);
+}
+
+// a gentle slope produces far more than the 16 levels of 4x4 supersampling,
+// decreasing steadily as the edge moves down across the row
+static void test_slope(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.moveTo(0, SkIntToScalar(10));
+    path.lineTo(SkIntToScalar(W), SkIntToScalar(11));
+    path.lineTo(SkIntToScalar(W), SkIntToScalar(20));
+    path.lineTo(0, SkIntToScalar(20));
+    path.close();
+
+    SkBitmap bm;
+    draw_coverage(path, &bm, true);
+    SkAutoLockPixels alp(bm);
+
+    int levels = 0;
+    int prev = 256;
+    for (int x = 0; x < W; x++) {
+        int a = alpha_at(bm, x, 10);
+        REPORTER_ASSERT(reporter, a <= prev);
+        if (a != prev) {
+            levels += 1;
+            prev = a;
+        }
+    }
+    REPORTER_ASSERT(reporter, levels > 48);
+}
+
+static void test_fill_types(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.addRect(SkIntToScalar(10), SkIntToScalar(10),
+                 SkIntToScalar(30), SkIntToScalar(30));
+    path.addRect(SkIntToScalar(20), SkIntToScalar(20),
+                 SkIntToScalar(40), SkIntToScalar(40));
+
+    SkBitmap bm;
+    draw_coverage(path, &bm, true);
+    {
+        SkAutoLockPixels alp(bm);
+        REPORTER_ASSERT(reporter, 255 == alpha_at(bm, 25, 25));
+        REPORTER_ASSERT(reporter, 255 == alpha_at(bm, 15, 15));
+    }
+
+    path.setFillType(SkPath::kEvenOdd_FillType);
+    draw_coverage(path, &bm, true);
+    {
+        SkAutoLockPixels alp(bm);
+        REPORTER_ASSERT(reporter, 0 == alpha_at(bm, 25, 25));
+        REPORTER_ASSERT(reporter, 255 == alpha_at(bm, 15, 15));
+        REPORTER_ASSERT(reporter, 255 == alpha_at(bm, 35, 35));
+    }
+}
+
+// clipping must not change the coverage of the pixels inside the clip
+static void test_clip(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.moveTo(SkFloatToScalar(-20.5f), SkFloatToScalar(3.3f));
+    path.cubicTo(SkIntToScalar(80), SkIntToScalar(-10),
+                 SkIntToScalar(-30), SkIntToScalar(90),
+                 SkFloatToScalar(90.5f), SkFloatToScalar(60.7f));
+    path.close();
+
+    SkIRect clip;
+    clip.set(13, 7, 41, 50);
+
+    SkBitmap full, clipped;
+    draw_coverage(path, &full, true);
+    draw_coverage(path, &clipped, true, &clip);
+    SkAutoLockPixels alp0(full);
+    SkAutoLockPixels alp1(clipped);
+
+    bool same = true;
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int expected = clip.contains(x, y) ? alpha_at(full, x, y) : 0;
+            same &= (expected == alpha_at(clipped, x, y));
+        }
+    }
+    REPORTER_ASSERT(reporter, same);
+}
+
+static void TestAnalyticAA(skiatest::Reporter* reporter) {
+    test_rect(reporter);
+    test_polygon(reporter);
+    test_circle(reporter);
+    test_slope(reporter);
+    test_fill_types(reporter);
+    test_clip(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("AnalyticAA", AnalyticAATestClass, TestAnalyticAA)
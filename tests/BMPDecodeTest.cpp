@@ -0,0 +1,210 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkColorPriv.h"
+#include "SkData.h"
+#include "SkImageDecoder.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+
+static void write16(SkDynamicMemoryWStream* stream, int value) {
+    uint8_t bytes[2] = { value & 0xFF, (value >> 8) & 0xFF };
+    stream->write(bytes, 2);
+}
+
+static void write32(SkDynamicMemoryWStream* stream, int value) {
+    write16(stream, value & 0xFFFF);
+    write16(stream, (value >> 16) & 0xFFFF);
+}
+
+static int palette_index(int x, int y, int bpp) {
+    return (x + 2 * y) & ((1 << bpp) - 1);
+}
+
+static SkPMColor palette_color(int index) {
+    return SkPackARGB32(0xFF, index, 255 - index, (index * 3) & 0xFF);
+}
+
+static SkPMColor expected_color(int x, int y, int bpp) {
+    if (bpp <= 8) {
+        return palette_color(palette_index(x, y, bpp));
+    }
+    U8CPU r = (x * 13 + y) & 0xFF;
+    U8CPU g = (y * 7) & 0xFF;
+    U8CPU b = ((x ^ y) * 3) & 0xFF;
+    if (16 == bpp) {
+        // 5 bits per component, replicated the way the decoder does
+        r &= 0xF8;
+        g &= 0xF8;
+        b &= 0xF8;
+    }
+    return SkPackARGB32(0xFF, r, g, b);
+}
+
+/*  Writes an uncompressed BMP of the image described by expected_color(). A
+    negative height stores the rows top-down. If truncate is true, the file's
+    last byte is left off, as a lot of BMPs in the wild do. With rle (8 bit
+    only), each pixel is written as a run of one.
+ */
+static SkData* make_bmp(int width, int height, int bpp, bool truncate,
+                        bool rle = false) {
+    const int rows = SkAbs32(height);
+    const int rowBytes = SkAlign4((width * bpp + 7) >> 3);
+    const int colors = bpp <= 8 ? 1 << bpp : 0;
+    const int offset = 14 + 40 + colors * 4;
+
+    SkDynamicMemoryWStream stream;
+    stream.write("BM", 2);
+    write32(&stream, offset + rowBytes * rows);
+    write32(&stream, 0);
+    write32(&stream, offset);
+    write32(&stream, 40);
+    write32(&stream, width);
+    write32(&stream, height);
+    write16(&stream, 1);
+    write16(&stream, bpp);
+    write32(&stream, rle ? 1 : 0);
+    write32(&stream, rowBytes * rows);
+    write32(&stream, 2835);
+    write32(&stream, 2835);
+    write32(&stream, colors);
+    write32(&stream, 0);
+    for (int i = 0; i < colors; i++) {
+        SkPMColor c = palette_color(i);
+        uint8_t bgrx[4] = { SkGetPackedB32(c), SkGetPackedG32(c),
+                            SkGetPackedR32(c), 0 };
+        stream.write(bgrx, 4);
+    }
+
+    if (rle) {
+        for (int y = rows - 1; y >= 0; y--) {
+            for (int x = 0; x < width; x++) {
+                uint8_t run[2] = { 1, palette_index(x, y, bpp) };
+                stream.write(run, 2);
+            }
+            stream.write("\0\0", 2);   // end of line
+        }
+        stream.write("\0\1", 2);       // end of bitmap
+        return stream.copyToData();
+    }
+
+    SkAutoTMalloc<uint8_t> row(rowBytes);
+    for (int i = 0; i < rows; i++) {
+        const int y = height > 0 ? rows - 1 - i : i;
+        memset(row.get(), 0, rowBytes);
+        for (int x = 0; x < width; x++) {
+            SkPMColor c = expected_color(x, y, bpp);
+            uint8_t* p = row.get();
+            if (bpp >= 24) {
+                p += x * (bpp >> 3);
+                p[0] = SkGetPackedB32(c);
+                p[1] = SkGetPackedG32(c);
+                p[2] = SkGetPackedR32(c);
+            } else if (16 == bpp) {
+                int rgb555 = (SkGetPackedR32(c) >> 3) << 10 |
+                             (SkGetPackedG32(c) >> 3) << 5 |
+                             (SkGetPackedB32(c) >> 3);
+                p[x * 2] = rgb555 & 0xFF;
+                p[x * 2 + 1] = rgb555 >> 8;
+            } else {
+                int bit = x * bpp;
+                p[bit >> 3] |= palette_index(x, y, bpp) << (8 - bpp - (bit & 7));
+            }
+        }
+        stream.write(row.get(), rowBytes);
+    }
+
+    SkData* data = stream.copyToData();
+    if (truncate) {
+        SkData* shorter = SkData::NewSubset(data, 0, data->size() - 1);
+        data->unref();
+        data = shorter;
+    }
+    return data;
+}
+
+static bool decode(SkData* data, int sampleSize, SkBitmap* bm) {
+    SkMemoryStream stream(data->data(), data->size());
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    if (NULL == decoder.get()) {
+        return false;
+    }
+    stream.rewind();
+    decoder.get()->setSampleSize(sampleSize);
+    return decoder.get()->decode(&stream, bm, SkBitmap::kARGB_8888_Config,
+                                 SkImageDecoder::kDecodePixels_Mode);
+}
+
+static void test_bmp(skiatest::Reporter* reporter, int width, int height,
+                     int bpp, bool truncate, bool rle = false) {
+    SkData* data = make_bmp(width, height, bpp, truncate, rle);
+    const int rows = SkAbs32(height);
+
+    for (int sampleSize = 1; sampleSize <= 3; sampleSize++) {
+        SkBitmap bm;
+        REPORTER_ASSERT(reporter, decode(data, sampleSize, &bm));
+        REPORTER_ASSERT(reporter, bm.width() == width / sampleSize);
+        REPORTER_ASSERT(reporter, bm.height() == rows / sampleSize);
+
+        // the sampler takes the middle pixel of each cell
+        const int offset = sampleSize >> 1;
+        SkAutoLockPixels alp(bm);
+        bool same = true;
+        for (int y = 0; y < bm.height(); y++) {
+            for (int x = 0; x < bm.width(); x++) {
+                SkPMColor expected = expected_color(x * sampleSize + offset,
+                                                    y * sampleSize + offset,
+                                                    bpp);
+                // a truncated file decodes its last byte as 0
+                if (truncate && (height > 0 ? y == 0 : y == bm.height() - 1)) {
+                    continue;
+                }
+                same &= *bm.getAddr32(x, y) == expected;
+            }
+        }
+        REPORTER_ASSERT(reporter, same);
+    }
+    data->unref();
+}
+
+// Decoding uncompressed BMPs a row at a time gives the right pixels for every
+// depth, row order and sample size.
+static void TestBMPDecode(skiatest::Reporter* reporter) {
+    SkData* probe = make_bmp(4, 4, 24, false);
+    SkBitmap bm;
+    bool supported = decode(probe, 1, &bm);
+    probe->unref();
+    if (!supported) {
+        // no BMP support in this build
+        return;
+    }
+
+    static const int gDepths[] = { 1, 4, 8, 16, 24, 32 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gDepths); i++) {
+        test_bmp(reporter, 37, 29, gDepths[i], false);
+        test_bmp(reporter, 37, -29, gDepths[i], false);
+    }
+    // rows without padding, so the missing byte is part of a pixel
+    test_bmp(reporter, 36, 29, 24, true);
+    test_bmp(reporter, 36, -29, 24, true);
+    // RLE images are still decoded from a copy of the whole file
+    test_bmp(reporter, 37, 29, 8, false, true);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("BMPDecode", BMPDecodeTestClass, TestBMPDecode)
@@ -1,5 +1,9 @@
 #include "Test.h"
 #include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
 #include "SkRect.h"
 
 static const char* boolStr(bool value) {
@@ -230,6 +234,89 @@ void writeCoordPixels(SkBitmap& bm, const Coordinates& coords) {
         setPixel(coords[i]->fX, coords[i]->fY, i, bm);
 }
 
+// random colors for src, premultiplied and opaque if src is opaque
+static void fill_random(SkBitmap* src, SkRandom* rand) {
+    SkAutoLockPixels alp(*src);
+    for (int y = 0; y < src->height(); y++) {
+        for (int x = 0; x < src->width(); x++) {
+            unsigned a = src->isOpaque() ? 0xFF : rand->nextU() & 0xFF;
+            SkPMColor c = SkPreMultiplyColor(SkColorSetA(rand->nextU(), a));
+            switch (src->config()) {
+                case SkBitmap::kIndex8_Config:
+                    *src->getAddr8(x, y) = rand->nextU() & 0xFF;
+                    break;
+                case SkBitmap::kRGB_565_Config:
+                    *src->getAddr16(x, y) = rand->nextU() & 0xFFFF;
+                    break;
+                case SkBitmap::kARGB_4444_Config:
+                    *src->getAddr16(x, y) = SkPixel32ToPixel4444(c);
+                    break;
+                default:
+                    *src->getAddr32(x, y) = c;
+                    break;
+            }
+        }
+    }
+}
+
+// copyTo() converts some configs itself, rather than drawing, and has to come
+// up with the same pixels that drawing does
+static void test_convert_pixels(skiatest::Reporter* reporter) {
+    static const struct {
+        SkBitmap::Config    fSrc;
+        SkBitmap::Config    fDst;
+    } gRec[] = {
+        { SkBitmap::kARGB_8888_Config,  SkBitmap::kRGB_565_Config   },
+        { SkBitmap::kARGB_8888_Config,  SkBitmap::kARGB_4444_Config },
+        { SkBitmap::kRGB_565_Config,    SkBitmap::kARGB_8888_Config },
+        { SkBitmap::kARGB_4444_Config,  SkBitmap::kARGB_8888_Config },
+        { SkBitmap::kIndex8_Config,     SkBitmap::kARGB_8888_Config },
+    };
+
+    SkRandom rand;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+        for (int opaque = 0; opaque <= 1; opaque++) {
+            if (SkBitmap::kRGB_565_Config == gRec[i].fSrc && !opaque) {
+                continue;
+            }
+            SkBitmap src;
+            src.setConfig(gRec[i].fSrc, 19, 7);
+            src.setIsOpaque(0 != opaque);
+            SkColorTable* ctable = NULL;
+            if (SkBitmap::kIndex8_Config == gRec[i].fSrc) {
+                SkPMColor colors[256];
+                for (int j = 0; j < 256; j++) {
+                    unsigned a = opaque ? 0xFF : rand.nextU() & 0xFF;
+                    colors[j] = SkPreMultiplyColor(SkColorSetA(rand.nextU(),
+                                                               a));
+                }
+                ctable = new SkColorTable(colors, 256);
+            }
+            src.allocPixels(ctable);
+            SkSafeUnref(ctable);
+            fill_random(&src, &rand);
+
+            SkBitmap dst;
+            REPORTER_ASSERT(reporter, src.copyTo(&dst, gRec[i].fDst));
+
+            SkBitmap drawn;
+            drawn.setConfig(gRec[i].fDst, 19, 7);
+            drawn.allocPixels();
+            drawn.eraseColor(0);
+            SkCanvas canvas(drawn);
+            SkPaint paint;
+            paint.setDither(true);
+            canvas.drawBitmap(src, 0, 0, &paint);
+
+            SkAutoLockPixels alp0(dst), alp1(drawn);
+            REPORTER_ASSERT(reporter, dst.getSize() == drawn.getSize());
+            REPORTER_ASSERT(reporter, !memcmp(dst.getPixels(),
+                                              drawn.getPixels(),
+                                              drawn.getSize()));
+        }
+    }
+}
+
 static void TestBitmapCopy(skiatest::Reporter* reporter) {
     static const Pair gPairs[] = {
         { SkBitmap::kNo_Config,         "00000000"  },
@@ -581,6 +668,8 @@ static void TestBitmapCopy(skiatest::Reporter* reporter) {
             }
         } // for (size_t copyCase ...
     }
+
+    test_convert_pixels(reporter);
 }
 
 #include "TestClassDef.h"
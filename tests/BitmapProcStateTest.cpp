@@ -0,0 +1,344 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBitmapProcShader.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+
+// gives us the state that setContext picked, platform procs and all
+class ProcShader : public SkBitmapProcShader {
+public:
+    ProcShader(const SkBitmap& src, TileMode tm)
+        : SkBitmapProcShader(src, tm, tm) {}
+
+    const SkBitmapProcState& state() const { return fState; }
+};
+
+static const SkBitmapProcState::MatrixProc gPortableProcs[] = {
+    // indexed by repeat * 6 + (persp ? 4 : affine ? 2 : 0) + filter
+    ClampX_ClampY_nofilter_scale,
+    ClampX_ClampY_filter_scale,
+    ClampX_ClampY_nofilter_affine,
+    ClampX_ClampY_filter_affine,
+    ClampX_ClampY_nofilter_persp,
+    ClampX_ClampY_filter_persp,
+    RepeatX_RepeatY_nofilter_scale,
+    RepeatX_RepeatY_filter_scale,
+    RepeatX_RepeatY_nofilter_affine,
+    RepeatX_RepeatY_filter_affine,
+    RepeatX_RepeatY_nofilter_persp,
+    RepeatX_RepeatY_filter_persp,
+};
+
+static SkBitmapProcState::SampleProc32 portable_sample(bool filter,
+                                                       bool affine,
+                                                       bool opaque) {
+    if (affine) {
+        if (filter) {
+            return opaque ? S32_opaque_D32_filter_DXDY :
+                            S32_alpha_D32_filter_DXDY;
+        }
+        return opaque ? S32_opaque_D32_nofilter_DXDY :
+                        S32_alpha_D32_nofilter_DXDY;
+    }
+    if (filter) {
+        return opaque ? S32_opaque_D32_filter_DX : S32_alpha_D32_filter_DX;
+    }
+    return opaque ? S32_opaque_D32_nofilter_DX : S32_alpha_D32_nofilter_DX;
+}
+
+// the number of uint32_t that the matrix proc writes for count pixels
+static int xy_count(bool filter, bool affine, int count) {
+    if (affine) {
+        return filter ? 2 * count : count;
+    }
+    return filter ? 1 + count : 1 + (count + 1) / 2;
+}
+
+static void test_procs(skiatest::Reporter* reporter, const SkBitmap& src,
+                       const SkMatrix& matrix, SkShader::TileMode tm,
+                       bool filter, U8CPU alpha = 0xFF) {
+    SkBitmap device;
+    device.setConfig(SkBitmap::kARGB_8888_Config, 100, 100);
+    device.allocPixels();
+
+    SkPaint paint;
+    paint.setFilterBitmap(filter);
+    paint.setAlpha(alpha);
+
+    ProcShader shader(src, tm);
+    if (!shader.setContext(device, paint, matrix)) {
+        reporter->reportFailed(SkString("setContext failed"));
+        return;
+    }
+    shader.beginSession();
+
+    const SkBitmapProcState& state = shader.state();
+    const bool persp = (state.fInvType & SkMatrix::kPerspective_Mask) != 0;
+    const bool affine = persp ||
+                        (state.fInvType & SkMatrix::kAffine_Mask) != 0;
+    int index = (SkShader::kRepeat_TileMode == tm ? 6 : 0) +
+                (persp ? 4 : affine ? 2 : 0) + (filter ? 1 : 0);
+    SkBitmapProcState::MatrixProc portable = gPortableProcs[index];
+    SkBitmapProcState::SampleProc32 sample =
+            portable_sample(filter, affine, 0xFF == alpha);
+
+    static const int gCounts[] = { 1, 3, 4, 7, 8, 9, 31, 64 };
+    static const int MAX_COUNT = 64;
+    uint32_t xy[2 * MAX_COUNT + 1];
+    uint32_t expectedXY[2 * MAX_COUNT + 1];
+    SkPMColor colors[MAX_COUNT];
+    SkPMColor expected[MAX_COUNT];
+
+    for (int y = -5; y < 40; y += 7) {
+        for (int x = -13; x < 60; x += 11) {
+            for (size_t i = 0; i < SK_ARRAY_COUNT(gCounts); i++) {
+                const int count = gCounts[i];
+
+                memset(xy, 0, sizeof(xy));
+                memset(expectedXY, 0, sizeof(expectedXY));
+                state.fMatrixProc(state, xy, count, x, y);
+                portable(state, expectedXY, count, x, y);
+                REPORTER_ASSERT(reporter, !memcmp(xy, expectedXY,
+                        xy_count(filter, affine, count) * sizeof(uint32_t)));
+
+                sample(state, expectedXY, count, expected);
+                if (affine) {
+                    state.fSampleProc32(state, expectedXY, count, colors);
+                } else {
+                    shader.shadeSpan(x, y, colors, count);
+                }
+                REPORTER_ASSERT(reporter, !memcmp(colors, expected,
+                                            count * sizeof(SkPMColor)));
+            }
+        }
+    }
+    shader.endSession();
+}
+
+// the fused shaderprocs must match the matrix and sample procs they replace
+static void test_shaderprocs(skiatest::Reporter* reporter,
+                             const SkBitmap& src, const SkMatrix& matrix,
+                             SkShader::TileMode tm, bool filter) {
+    SkBitmap device;
+    device.setConfig(SkBitmap::kARGB_8888_Config, 100, 100);
+    device.allocPixels();
+
+    SkPaint paint;
+    paint.setFilterBitmap(filter);
+
+    ProcShader shader(src, tm);
+    if (!shader.setContext(device, paint, matrix)) {
+        reporter->reportFailed(SkString("setContext failed"));
+        return;
+    }
+    shader.beginSession();
+
+    const SkBitmapProcState& state = shader.state();
+    // 8888 only has fused shaderprocs on some platforms
+    REPORTER_ASSERT(reporter, state.fShaderProc32 ||
+                    SkBitmap::kARGB_8888_Config == src.config());
+    // 565 is the only source here that can be drawn into 565
+    const bool d16 = SkBitmap::kRGB_565_Config == src.config();
+    REPORTER_ASSERT(reporter, !d16 || state.fShaderProc16);
+
+    static const int MAX_COUNT = 50;
+    uint32_t xy[2 * MAX_COUNT + 1];
+    SkPMColor colors[MAX_COUNT];
+    SkPMColor expected[MAX_COUNT];
+    uint16_t colors16[MAX_COUNT];
+    uint16_t expected16[MAX_COUNT];
+
+    for (int y = -5; y < 40; y += 3) {
+        for (int x = -13; x < 60; x += 23) {
+            for (int count = 1; count <= MAX_COUNT; count += 7) {
+                state.fMatrixProc(state, xy, count, x, y);
+                if (state.fShaderProc32) {
+                    state.fSampleProc32(state, xy, count, expected);
+                    state.fShaderProc32(state, x, y, colors, count);
+                    REPORTER_ASSERT(reporter, !memcmp(colors, expected,
+                                                count * sizeof(SkPMColor)));
+                }
+                if (d16 && state.fShaderProc16) {
+                    state.fSampleProc16(state, xy, count, expected16);
+                    state.fShaderProc16(state, x, y, colors16, count);
+                    REPORTER_ASSERT(reporter, !memcmp(colors16, expected16,
+                                                count * sizeof(uint16_t)));
+                }
+            }
+        }
+    }
+    shader.endSession();
+}
+
+// a translated, repeated or mirrored tile is copied rather than sampled, and
+// has to come out as the matrix and sample procs would have it
+static void test_tile_trans(skiatest::Reporter* reporter, const SkBitmap& src,
+                            const SkMatrix& matrix, SkShader::TileMode tm) {
+    SkBitmap device;
+    device.setConfig(SkBitmap::kARGB_8888_Config, 100, 100);
+    device.allocPixels();
+
+    SkPaint paint;
+    ProcShader shader(src, tm);
+    if (!shader.setContext(device, paint, matrix)) {
+        reporter->reportFailed(SkString("setContext failed"));
+        return;
+    }
+    shader.beginSession();
+
+    const SkBitmapProcState& state = shader.state();
+    const bool d16 = SkBitmap::kRGB_565_Config == src.config();
+    REPORTER_ASSERT(reporter, d16 ? NULL != state.fShaderProc16 :
+                                    NULL != state.fShaderProc32);
+
+    static const int MAX_COUNT = 130;
+    uint32_t xy[MAX_COUNT + 1];
+    SkPMColor colors[MAX_COUNT];
+    SkPMColor expected[MAX_COUNT];
+    uint16_t colors16[MAX_COUNT];
+    uint16_t expected16[MAX_COUNT];
+
+    for (int y = -45; y < 70; y += 11) {
+        for (int x = -75; x < 60; x += 17) {
+            for (int count = 1; count <= MAX_COUNT; count += 9) {
+                state.fMatrixProc(state, xy, count, x, y);
+                if (d16) {
+                    state.fSampleProc16(state, xy, count, expected16);
+                    state.fShaderProc16(state, x, y, colors16, count);
+                    REPORTER_ASSERT(reporter, !memcmp(colors16, expected16,
+                                                count * sizeof(uint16_t)));
+                } else {
+                    state.fSampleProc32(state, xy, count, expected);
+                    state.fShaderProc32(state, x, y, colors, count);
+                    REPORTER_ASSERT(reporter, !memcmp(colors, expected,
+                                                count * sizeof(SkPMColor)));
+                }
+            }
+        }
+    }
+    shader.endSession();
+}
+
+static void TestBitmapProcState(skiatest::Reporter* reporter) {
+    SkBitmap src;
+    src.setConfig(SkBitmap::kARGB_8888_Config, 37, 23);
+    src.allocPixels();
+    SkRandom rand;
+    {
+        SkAutoLockPixels alp(src);
+        for (int y = 0; y < src.height(); y++) {
+            for (int x = 0; x < src.width(); x++) {
+                *src.getAddr32(x, y) = rand.nextU() | 0xFF000000;
+            }
+        }
+    }
+
+    SkBitmap src16;
+    src16.setConfig(SkBitmap::kRGB_565_Config, 29, 31);
+    src16.allocPixels();
+    SkBitmap src8;
+    src8.setConfig(SkBitmap::kIndex8_Config, 29, 31);
+    {
+        SkPMColor table[256];
+        for (int i = 0; i < 256; i++) {
+            table[i] = rand.nextU() | 0xFF000000;
+        }
+        SkColorTable* ctable = SkNEW_ARGS(SkColorTable, (table, 256));
+        src8.allocPixels(ctable);
+        ctable->unref();
+
+        SkAutoLockPixels alp16(src16);
+        SkAutoLockPixels alp8(src8);
+        for (int y = 0; y < src16.height(); y++) {
+            for (int x = 0; x < src16.width(); x++) {
+                *src16.getAddr16(x, y) = rand.nextU() & 0xFFFF;
+                *src8.getAddr8(x, y) = rand.nextU() & 0xFF;
+            }
+        }
+    }
+
+    SkMatrix matrices[6];
+    matrices[0].setScale(SkFloatToScalar(1.37f), SkFloatToScalar(0.71f));
+    matrices[0].postTranslate(SkIntToScalar(3), SkIntToScalar(-2));
+    matrices[1].setScale(SkFloatToScalar(-0.6f), SkFloatToScalar(1.9f));
+    matrices[1].postTranslate(SkIntToScalar(30), 0);
+    matrices[2].setRotate(SkIntToScalar(30));
+    matrices[2].postScale(SkFloatToScalar(1.5f), SkFloatToScalar(1.2f));
+    matrices[3].setRotate(SkIntToScalar(-100), SkIntToScalar(10),
+                          SkIntToScalar(10));
+    // a card turned away from the viewer, and one tipped back and spun
+    matrices[4].setAll(SkFloatToScalar(0.8f), 0, SkIntToScalar(10),
+                       SkFloatToScalar(-0.1f), SK_Scalar1, SkIntToScalar(5),
+                       SkFloatToScalar(-0.004f), 0, SK_Scalar1);
+    matrices[5].setAll(SkFloatToScalar(1.3f), SkFloatToScalar(0.4f), 0,
+                       SkFloatToScalar(-0.3f), SkFloatToScalar(0.9f),
+                       SkIntToScalar(20), 0, SkFloatToScalar(0.006f),
+                       SK_Scalar1);
+
+    static const SkShader::TileMode gModes[] = {
+        SkShader::kClamp_TileMode,
+        SkShader::kRepeat_TileMode,
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(matrices); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gModes); j++) {
+            test_procs(reporter, src, matrices[i], gModes[j], false);
+            test_procs(reporter, src, matrices[i], gModes[j], true);
+            test_procs(reporter, src, matrices[i], gModes[j], false, 0x80);
+            test_procs(reporter, src, matrices[i], gModes[j], true, 0x80);
+        }
+    }
+
+    SkMatrix translate;
+    translate.setTranslate(SkIntToScalar(-4), SkIntToScalar(7));
+    test_shaderprocs(reporter, src16, translate, SkShader::kClamp_TileMode,
+                     false);
+    test_shaderprocs(reporter, src8, translate, SkShader::kClamp_TileMode,
+                     false);
+    static const SkShader::TileMode gTileModes[] = {
+        SkShader::kRepeat_TileMode,
+        SkShader::kMirror_TileMode,
+    };
+    SkMatrix translates[3];
+    translates[0] = translate;
+    translates[1].setTranslate(SkFloatToScalar(13.5f), SkFloatToScalar(-2.25f));
+    translates[2].setTranslate(SkFloatToScalar(-100.75f), SkIntToScalar(300));
+    for (size_t i = 0; i < SK_ARRAY_COUNT(translates); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gTileModes); j++) {
+            test_tile_trans(reporter, src, translates[i], gTileModes[j]);
+            test_tile_trans(reporter, src16, translates[i], gTileModes[j]);
+        }
+    }
+
+    // only the first two are not rotated
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gModes); j++) {
+            for (int filter = 0; filter <= 1; filter++) {
+                test_shaderprocs(reporter, src16, matrices[i], gModes[j],
+                                 filter != 0);
+                test_shaderprocs(reporter, src8, matrices[i], gModes[j],
+                                 filter != 0);
+                test_shaderprocs(reporter, src, matrices[i], gModes[j],
+                                 filter != 0);
+            }
+        }
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("BitmapProcState", BitmapProcStateTestClass,
+                 TestBitmapProcState)
@@ -0,0 +1,110 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkRandom.h"
+#include "SkRegion.h"
+
+static void fill_random(const SkBitmap& bm, SkRandom* rand) {
+    SkAutoLockPixels alp(bm);
+    uint8_t* pixels = (uint8_t*)bm.getPixels();
+    for (size_t i = 0; i < bm.getSize(); i++) {
+        pixels[i] = rand->nextU() & 0xFF;
+    }
+}
+
+// scrolling moves each pixel of the subset that stays inside it, leaves the
+// rest of the bitmap alone, and invals what nothing moved on to
+static void test_scroll(skiatest::Reporter* reporter, const SkBitmap& bm,
+                        const SkIRect& subset, int dx, int dy,
+                        SkRandom* rand) {
+    fill_random(bm, rand);
+    SkBitmap orig;
+    REPORTER_ASSERT(reporter, bm.copyTo(&orig, bm.config()));
+
+    SkRegion inval;
+    REPORTER_ASSERT(reporter, bm.scrollRect(&subset, dx, dy, &inval));
+
+    SkIRect bounds;
+    bounds.set(0, 0, subset.width(), subset.height());
+    SkIRect moved(bounds);
+    moved.offset(dx, dy);
+    SkRegion expected(bounds);
+    expected.op(moved, SkRegion::kDifference_Op);
+    REPORTER_ASSERT(reporter, expected == inval);
+
+    SkAutoLockPixels alp0(bm), alp1(orig);
+    const size_t bpp = bm.bytesPerPixel();
+    bool ok = true;
+    for (int y = 0; y < bm.height(); y++) {
+        for (int x = 0; x < bm.width(); x++) {
+            int sx = x, sy = y;
+            if (subset.contains(x, y) && subset.contains(x - dx, y - dy)) {
+                sx = x - dx;
+                sy = y - dy;
+            }
+            ok = ok && !memcmp(bm.getAddr(x, y), orig.getAddr(sx, sy), bpp);
+        }
+    }
+    REPORTER_ASSERT(reporter, ok);
+}
+
+static void TestBitmapScroll(skiatest::Reporter* reporter) {
+    static const SkBitmap::Config gConfigs[] = {
+        SkBitmap::kA8_Config,
+        SkBitmap::kRGB_565_Config,
+        SkBitmap::kARGB_8888_Config,
+    };
+    static const int gDeltas[] = { -13, -5, -1, 0, 1, 4, 9, 13 };
+
+    SkRandom rand;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gConfigs); i++) {
+        // with rows that are contiguous and rows that are not
+        for (int pad = 0; pad <= 8; pad += 8) {
+            SkBitmap bm;
+            bm.setConfig(gConfigs[i], 11, 9);
+            bm.setConfig(gConfigs[i], 11, 9, bm.rowBytes() + pad);
+            bm.allocPixels();
+
+            SkIRect subsets[3];
+            subsets[0].set(0, 0, 11, 9);
+            subsets[1].set(0, 2, 11, 7);
+            subsets[2].set(3, 1, 10, 8);
+            for (size_t j = 0; j < SK_ARRAY_COUNT(subsets); j++) {
+                for (size_t x = 0; x < SK_ARRAY_COUNT(gDeltas); x++) {
+                    for (size_t y = 0; y < SK_ARRAY_COUNT(gDeltas); y++) {
+                        test_scroll(reporter, bm, subsets[j], gDeltas[x],
+                                    gDeltas[y], &rand);
+                    }
+                }
+            }
+        }
+    }
+
+    // without pixels, only inval is computed
+    SkBitmap empty;
+    empty.setConfig(SkBitmap::kARGB_8888_Config, 10, 10);
+    SkRegion inval;
+    REPORTER_ASSERT(reporter, empty.scrollRect(NULL, 0, 3, &inval));
+    REPORTER_ASSERT(reporter, inval == SkRegion(SkIRect::MakeWH(10, 3)));
+    REPORTER_ASSERT(reporter, empty.scrollRect(NULL, -20, 0, &inval));
+    REPORTER_ASSERT(reporter, inval == SkRegion(SkIRect::MakeWH(10, 10)));
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("BitmapScroll", BitmapScrollTestClass, TestBitmapScroll)
@@ -1,8 +1,12 @@
 #include "Test.h"
 #include "SkBitmap.h"
+#include "SkBlitRow.h"
+#include "SkBlurMaskFilter.h"
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
+#include "SkColorShader.h"
 #include "SkGradientShader.h"
+#include "SkRandom.h"
 #include "SkRect.h"
 
 static inline const char* boolStr(bool value) {
@@ -260,9 +264,368 @@ static void test_diagonal(skiatest::Reporter* reporter) {
     }
 }
 
+static const SkColor gBlendColors[] = {
+    SK_ColorBLACK, SK_ColorWHITE, 0xFF336699, 0x80336699, 0x01FFFFFF, 0
+};
+
+static void fill_random(SkRandom* rand, SkPMColor dst[], SkAlpha aa[],
+                        int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkPreMultiplyColor(rand->nextU());
+        // make sure that the special values 0 and 255 show up often
+        switch (rand->nextU() & 3) {
+            case 0:  aa[i] = 0; break;
+            case 1:  aa[i] = 0xFF; break;
+            default: aa[i] = rand->nextU() & 0xFF; break;
+        }
+    }
+}
+
+// the platform procs must match the portable ones exactly, for any length and
+// alignment of the row
+static void test_color_aa(skiatest::Reporter* reporter) {
+    static const int N = 40;
+    SkPMColor dst[N], expected[N];
+    SkAlpha aa[N];
+    SkRandom rand;
+
+    SkBlitRow::ColorAAProc proc = SkBlitRow::ColorAAProcFactory();
+    for (size_t c = 0; c < SK_ARRAY_COUNT(gBlendColors); c++) {
+        SkPMColor color = SkPreMultiplyColor(gBlendColors[c]);
+        for (int start = 0; start < 4; start++) {
+            for (int count = 0; count <= N - start; count++) {
+                fill_random(&rand, dst, aa, N);
+                memcpy(expected, dst, sizeof(dst));
+                SkBlitRow::ColorAA32(expected + start, aa + start, count,
+                                     color);
+                proc(dst + start, aa + start, count, color);
+                REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+            }
+        }
+    }
+}
+
+static void test_blit_mask(skiatest::Reporter* reporter) {
+    static const int W = 21;
+    static const int H = 3;
+    SkPMColor dst[W * H], expected[W * H];
+    SkAlpha mask[W * H];
+    SkRandom rand;
+
+    for (size_t c = 0; c < SK_ARRAY_COUNT(gBlendColors); c++) {
+        SkColor color = gBlendColors[c];
+        SkPMColor pmc = SkPreMultiplyColor(color);
+        SkBlitMask::Proc proc = SkBlitMask::Factory(SkBitmap::kARGB_8888_Config,
+                                                    color);
+        for (int width = 1; width <= W; width++) {
+            fill_random(&rand, dst, mask, W * H);
+            for (int i = 0; i < W * H; i++) {
+                int x = i % W;
+                expected[i] = x < width ? SkBlendARGB32(pmc, dst[i], mask[i]) :
+                                          dst[i];
+            }
+            proc(dst, W * sizeof(SkPMColor), SkBitmap::kARGB_8888_Config,
+                 mask, W, color, width, H);
+            REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+        }
+    }
+}
+
+// the portable LCD blends: each channel by its own coverage, and alpha by the
+// largest of them
+static SkPMColor lcd_blend(SkPMColor color, SkPMColor dst, int maskR,
+                           int maskG, int maskB, int bits) {
+    int maskA = SkMax32(SkMax32(maskR, maskG), maskB);
+    int one = 1 << bits;
+    return SkPackARGB32(
+        (0xFF * maskA + SkGetPackedA32(dst) * (one - maskA)) >> bits,
+        (SkGetPackedR32(color) * maskR + SkGetPackedR32(dst) * (one - maskR))
+            >> bits,
+        (SkGetPackedG32(color) * maskG + SkGetPackedG32(dst) * (one - maskG))
+            >> bits,
+        (SkGetPackedB32(color) * maskB + SkGetPackedB32(dst) * (one - maskB))
+            >> bits);
+}
+
+static SkPMColor lcd16_expected(SkPMColor color, SkPMColor dst,
+                                uint16_t mask) {
+    int r = SkGetPackedR16(mask) >> (SK_R16_BITS - 5);
+    int g = SkGetPackedG16(mask) >> (SK_G16_BITS - 5);
+    int b = SkGetPackedB16(mask) >> (SK_B16_BITS - 5);
+    return lcd_blend(color, dst, r + (r >> 4), g + (g >> 4), b + (b >> 4), 5);
+}
+
+static SkPMColor lcd32_expected(SkPMColor color, SkPMColor dst,
+                                uint32_t mask) {
+    if (0 == mask) {
+        return dst;
+    }
+    return lcd_blend(color, dst, SkAlpha255To256(SkGetPackedR32(mask)),
+                     SkAlpha255To256(SkGetPackedG32(mask)),
+                     SkAlpha255To256(SkGetPackedB32(mask)), 8);
+}
+
+// the LCD row procs, for any length and alignment, with empty and full
+// coverage often enough to show up in whole blocks
+static void test_lcd_rows(skiatest::Reporter* reporter) {
+    static const int N = 40;
+    SkPMColor dst[N], expected[N];
+    uint16_t mask16[N];
+    uint32_t mask32[N];
+    SkRandom rand;
+
+    SkBlitMask::LCD16RowProc proc16 = SkBlitMask::LCD16RowFactory();
+    SkBlitMask::LCD32RowProc proc32 = SkBlitMask::LCD32RowFactory();
+    for (size_t c = 0; c < SK_ARRAY_COUNT(gBlendColors); c++) {
+        SkPMColor color = SkPreMultiplyColor(gBlendColors[c]);
+        for (int start = 0; start < 4; start++) {
+            for (int count = 0; count <= N - start; count++) {
+                for (int i = 0; i < N; i++) {
+                    dst[i] = SkPreMultiplyColor(rand.nextU());
+                    uint32_t m = rand.nextU();
+                    switch (rand.nextU() & 3) {
+                        case 0:  m = 0; break;
+                        case 1:  m = 0xFFFFFFFF; break;
+                        default: break;
+                    }
+                    mask16[i] = (uint16_t)m;
+                    mask32[i] = m;
+                }
+
+                for (int i = 0; i < N; i++) {
+                    bool inside = i >= start && i < start + count;
+                    expected[i] = inside ? lcd16_expected(color, dst[i],
+                                                          mask16[i]) : dst[i];
+                }
+                SkPMColor dst32[N];
+                memcpy(dst32, dst, sizeof(dst));
+                proc16(dst + start, mask16 + start, color, count);
+                REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+
+                for (int i = 0; i < N; i++) {
+                    bool inside = i >= start && i < start + count;
+                    expected[i] = inside ? lcd32_expected(color, dst32[i],
+                                                          mask32[i]) :
+                                           dst32[i];
+                }
+                proc32(dst32 + start, mask32 + start, color, count);
+                REPORTER_ASSERT(reporter,
+                                !memcmp(dst32, expected, sizeof(dst32)));
+            }
+        }
+    }
+}
+
+extern SkBlitRow::Proc SkBlitRow_Factory_565(unsigned flags);
+
+// mostly random colors, with transparent and opaque ones often enough that
+// whole blocks of them show up
+static void fill_random_src(SkRandom* rand, SkPMColor src[], int count) {
+    for (int i = 0; i < count; i++) {
+        switch (rand->nextU() % 5) {
+            case 0:  src[i] = 0; break;
+            case 1:  src[i] = rand->nextU() | 0xFF000000; break;
+            default: src[i] = SkPreMultiplyColor(rand->nextU()); break;
+        }
+    }
+    if (rand->nextU() & 1) {
+        int start = rand->nextU() % count;
+        int stop = start + rand->nextU() % (count - start + 1);
+        for (int i = start; i < stop; i++) {
+            src[i] = 0;
+        }
+    }
+}
+
+// the platform's 565 procs must match the portable ones exactly, for any
+// length and alignment of the row, and any dither position
+static void test_565_procs(skiatest::Reporter* reporter) {
+    static const int N = 40;
+    static const U8CPU gAlphas[] = { 0, 1, 0x7F, 0x80, 0xFE };
+    SkPMColor src[N];
+    uint16_t dst[N], expected[N];
+    SkRandom rand;
+
+    for (unsigned flags = 0; flags < 8; flags++) {
+        SkBlitRow::Proc proc = SkBlitRow::Factory(flags,
+                                                  SkBitmap::kRGB_565_Config);
+        SkBlitRow::Proc portable = SkBlitRow_Factory_565(flags);
+        bool globalAlpha = SkToBool(flags & SkBlitRow::kGlobalAlpha_Flag);
+        for (size_t a = 0; a < SK_ARRAY_COUNT(gAlphas); a++) {
+            U8CPU alpha = globalAlpha ? gAlphas[a] : 0xFF;
+            for (int start = 0; start < 4; start++) {
+                for (int count = 0; count <= N - start; count++) {
+                    fill_random_src(&rand, src, N);
+                    for (int i = 0; i < N; i++) {
+                        dst[i] = rand.nextU() & 0xFFFF;
+                    }
+                    memcpy(expected, dst, sizeof(dst));
+                    int x = rand.nextU() & 7;
+                    int y = rand.nextU() & 7;
+                    portable(expected + start, src + start, count, alpha, x, y);
+                    proc(dst + start, src + start, count, alpha, x, y);
+                    REPORTER_ASSERT(reporter,
+                                    !memcmp(dst, expected, sizeof(dst)));
+                }
+            }
+        }
+    }
+}
+
+// what SkRGB16_Opaque_Blitter and SkRGB16_Blitter do for an A8 mask
+static uint16_t blend_mask_565(SkColor color, uint16_t dst, SkAlpha aa) {
+    uint32_t color32 = SkExpand_rgb_16(SkPack888ToRGB16(SkColorGetR(color),
+                                                        SkColorGetG(color),
+                                                        SkColorGetB(color)));
+    uint32_t dst32 = SkExpand_rgb_16(dst);
+    if (0xFF == SkColorGetA(color)) {
+        unsigned scale5 = SkAlpha255To256(aa) >> 3;
+        return SkCompact_rgb_16(dst32 + ((color32 - dst32) * scale5 >> 5));
+    }
+    unsigned scale = SkAlpha255To256(aa) *
+                     SkAlpha255To256(SkColorGetA(color)) >> (8 + 3);
+    return SkCompact_rgb_16((color32 * scale + dst32 * (32 - scale)) >> 5);
+}
+
+static void test_blit_mask_565(skiatest::Reporter* reporter) {
+    static const int W = 21;
+    static const int H = 3;
+    SkPMColor unused[W * H];
+    uint16_t dst[W * H], expected[W * H];
+    SkAlpha mask[W * H];
+    SkRandom rand;
+
+    for (size_t c = 0; c < SK_ARRAY_COUNT(gBlendColors); c++) {
+        SkColor color = gBlendColors[c];
+        SkBlitMask::Proc proc = SkBlitMask::PlatformProcs(
+                                        SkBitmap::kRGB_565_Config, color);
+        if (NULL == proc) {
+            continue;
+        }
+        for (int width = 1; width <= W; width++) {
+            fill_random(&rand, unused, mask, W * H);
+            for (int i = 0; i < W * H; i++) {
+                dst[i] = rand.nextU() & 0xFFFF;
+                int x = i % W;
+                expected[i] = x < width ? blend_mask_565(color, dst[i],
+                                                         mask[i]) : dst[i];
+            }
+            proc(dst, W * sizeof(uint16_t), SkBitmap::kRGB_565_Config,
+                 mask, W, color, width, H);
+            REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+        }
+    }
+}
+
+static void fill_random_a8(SkRandom* rand, uint8_t alpha[], int count) {
+    for (int i = 0; i < count; i++) {
+        switch (rand->nextU() & 3) {
+            case 0:  alpha[i] = 0; break;
+            case 1:  alpha[i] = 0xFF; break;
+            default: alpha[i] = rand->nextU() & 0xFF; break;
+        }
+    }
+}
+
+static void test_a8_rows(skiatest::Reporter* reporter) {
+    static const int N = 40;
+    static const U8CPU gAlphas[] = { 0, 1, 0x80, 0xFE, 0xFF };
+    uint8_t dst[N], expected[N], src[N], aa[N], none[N];
+    SkRandom rand;
+
+    SkBlitRow::ColorA8Proc colorProc = SkBlitRow::ColorA8ProcFactory();
+    SkBlitRow::AlphaA8Proc alphaProc = SkBlitRow::AlphaA8ProcFactory();
+    memset(none, 0, sizeof(none));
+    for (int start = 0; start < 4; start++) {
+        for (int count = 0; count <= N - start; count++) {
+            fill_random_a8(&rand, src, N);
+            fill_random_a8(&rand, aa, N);
+            for (int useAA = 0; useAA <= 1; useAA++) {
+                const uint8_t* coverage = useAA ? aa + start : NULL;
+                for (size_t a = 0; a < SK_ARRAY_COUNT(gAlphas); a++) {
+                    fill_random_a8(&rand, dst, N);
+                    memcpy(expected, dst, sizeof(dst));
+                    SkBlitRow::ColorA8(expected + start, coverage, count,
+                                       gAlphas[a]);
+                    colorProc(dst + start, coverage, count, gAlphas[a]);
+                    REPORTER_ASSERT(reporter,
+                                    !memcmp(dst, expected, sizeof(dst)));
+                }
+
+                fill_random_a8(&rand, dst, N);
+                memcpy(expected, dst, sizeof(dst));
+                SkBlitRow::AlphaA8(expected + start, src + start, coverage,
+                                   count);
+                alphaProc(dst + start, src + start, coverage, count);
+                REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+            }
+
+            // no coverage, or no alpha, leaves dst alone
+            fill_random_a8(&rand, dst, N);
+            memcpy(expected, dst, sizeof(dst));
+            colorProc(dst + start, none, count, 0xFF);
+            alphaProc(dst + start, none, NULL, count);
+            alphaProc(dst + start, src, none, count);
+            REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+        }
+    }
+}
+
+// Into an A8 device, a shader only matters for its alphas, so a color shader
+// has to draw just what its color's alpha does without one.
+static void test_a8_shader(skiatest::Reporter* reporter) {
+    SkBitmap plain, shaded;
+    for (int i = 0; i < 3; i++) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setColor(0x80336699);
+        if (2 == i) {
+            // blitMask()
+            paint.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(3),
+                                    SkBlurMaskFilter::kNormal_BlurStyle))->unref();
+        }
+
+        SkBitmap* bitmaps[] = { &plain, &shaded };
+        for (int b = 0; b < 2; b++) {
+            bitmaps[b]->setConfig(SkBitmap::kA8_Config, 37, 29);
+            bitmaps[b]->allocPixels();
+            bitmaps[b]->eraseARGB(0x40, 0, 0, 0);
+            if (b) {
+                // the shader's alpha is scaled by the paint's
+                paint.setShader(new SkColorShader(paint.getColor()))->unref();
+                paint.setAlpha(0xFF);
+            }
+
+            SkCanvas canvas(*bitmaps[b]);
+            SkRect r = SkRect::MakeXYWH(SkFloatToScalar(4.5f),
+                                        SkFloatToScalar(3.25f),
+                                        SkIntToScalar(25), SkIntToScalar(20));
+            if (0 == i) {
+                canvas.drawRect(r, paint);
+            } else {
+                canvas.drawOval(r, paint);
+            }
+        }
+
+        SkAutoLockPixels alpp(plain), alps(shaded);
+        // 0x80 over 0x40, where the blur leaves the coverage whole
+        REPORTER_ASSERT(reporter, 2 == i || 0xA0 == *plain.getAddr8(18, 14));
+        REPORTER_ASSERT(reporter, !memcmp(plain.getPixels(),
+                                          shaded.getPixels(),
+                                          plain.getSize()));
+    }
+}
+
 static void TestBlitRow(skiatest::Reporter* reporter) {
     test_00_FF(reporter);
     test_diagonal(reporter);
+    test_color_aa(reporter);
+    test_blit_mask(reporter);
+    test_lcd_rows(reporter);
+    test_565_procs(reporter);
+    test_blit_mask_565(reporter);
+    test_a8_rows(reporter);
+    test_a8_shader(reporter);
 }
 
 #include "TestClassDef.h"
@@ -0,0 +1,289 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBlurMask.h"
+#include "SkBlurMaskCache.h"
+#include "SkBlurMaskFilter.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkDraw.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+
+// the sum of the (2r+1)^2 window that ends at [x, y], where src is 0 outside
+// of its bounds
+static uint32_t window_sum(const SkMask& src, int x, int y, int r) {
+    const int sw = src.fBounds.width();
+    const int sh = src.fBounds.height();
+    uint32_t sum = 0;
+    for (int j = SkMax32(y - 2 * r, 0); j <= SkMin32(y, sh - 1); j++) {
+        for (int i = SkMax32(x - 2 * r, 0); i <= SkMin32(x, sw - 1); i++) {
+            sum += src.fImage[j * src.fRowBytes + i];
+        }
+    }
+    return sum;
+}
+
+// a single low quality pass, computed the slow way
+static uint8_t expected_blur(const SkMask& src, int x, int y, int r,
+                             int outer_weight) {
+    if (255 == outer_weight) {
+        uint32_t scale = (1 << 24) / ((2*r + 1)*(2*r + 1));
+        return SkToU8(window_sum(src, x, y, r) * scale >> 24);
+    }
+    int inner_weight = 255 - outer_weight;
+    outer_weight += outer_weight >> 7;
+    inner_weight += inner_weight >> 7;
+    uint32_t outerScale = (outer_weight << 16) / ((2*r + 1)*(2*r + 1));
+    uint32_t innerScale = (inner_weight << 16) / ((2*r - 1)*(2*r - 1));
+    uint32_t outer = window_sum(src, x, y, r);
+    uint32_t inner = window_sum(src, x - 1, y - 1, r - 1);
+    return SkToU8((outer * outerScale + inner * innerScale) >> 24);
+}
+
+static void test_blur(skiatest::Reporter* reporter, SkRandom* rand,
+                      int w, int h, SkScalar radius) {
+    SkMask src;
+    src.fBounds.set(5, -3, 5 + w, -3 + h);
+    src.fFormat = SkMask::kA8_Format;
+    src.fRowBytes = w + 3;
+    src.fImage = SkMask::AllocImage(src.computeImageSize());
+    for (size_t i = 0; i < src.computeImageSize(); i++) {
+        src.fImage[i] = rand->nextU() & 0xFF;
+    }
+
+    SkMask dst;
+    bool success = SkBlurMask::Blur(&dst, src, radius,
+                                    SkBlurMask::kNormal_Style,
+                                    SkBlurMask::kLow_Quality);
+    REPORTER_ASSERT(reporter, success);
+    if (success) {
+        const int r = SkScalarCeil(radius);
+        const int outer_weight = 255 -
+                SkScalarRound((SkIntToScalar(r) - radius) * 255);
+        REPORTER_ASSERT(reporter, dst.fBounds.width() == w + 2 * r);
+        REPORTER_ASSERT(reporter, dst.fBounds.height() == h + 2 * r);
+
+        int mismatches = 0;
+        for (int y = 0; y < dst.fBounds.height(); y++) {
+            for (int x = 0; x < dst.fBounds.width(); x++) {
+                if (dst.fImage[y * dst.fRowBytes + x] !=
+                        expected_blur(src, x, y, r, outer_weight)) {
+                    mismatches += 1;
+                }
+            }
+        }
+        REPORTER_ASSERT(reporter, 0 == mismatches);
+        SkMask::FreeImage(dst.fImage);
+    }
+    SkMask::FreeImage(src.fImage);
+}
+
+static const int W = 120;
+static const int H = 90;
+
+// draw path with a blur of the given radius, in opaque black
+static void draw_blurred(SkBitmap* bm, const SkPath& path, SkScalar radius,
+                         SkBlurMaskFilter::BlurStyle style, uint32_t flags) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+
+    SkPaint paint;
+    SkSafeUnref(paint.setMaskFilter(SkBlurMaskFilter::Create(radius, style,
+                                                             flags)));
+    SkCanvas canvas(*bm);
+    canvas.drawPath(path, paint);
+}
+
+// the same, by blurring a mask of the whole path
+static void draw_expected(SkBitmap* bm, const SkPath& path, SkScalar radius,
+                          SkBlurMaskFilter::BlurStyle style, uint32_t flags) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+
+    SkMask src, dst;
+    if (!SkDraw::DrawToMask(path, NULL, NULL, NULL, &src,
+                            SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
+        return;
+    }
+    SkAutoMaskImage autoSrc(&src, false);
+    SkBlurMask::Quality quality = (flags & SkBlurMaskFilter::kHighQuality_BlurFlag) ?
+            SkBlurMask::kHigh_Quality : SkBlurMask::kLow_Quality;
+    if (!SkBlurMask::Blur(&dst, src, radius, (SkBlurMask::Style)style,
+                          quality)) {
+        return;
+    }
+    SkAutoMaskImage autoDst(&dst, false);
+
+    SkAutoLockPixels alp(*bm);
+    for (int y = SkMax32(dst.fBounds.fTop, 0);
+         y < SkMin32(dst.fBounds.fBottom, H); y++) {
+        for (int x = SkMax32(dst.fBounds.fLeft, 0);
+             x < SkMin32(dst.fBounds.fRight, W); x++) {
+            int a = dst.fImage[(y - dst.fBounds.fTop) * dst.fRowBytes +
+                               x - dst.fBounds.fLeft];
+            *bm->getAddr32(x, y) = SkPackARGB32(a, 0, 0, 0);
+        }
+    }
+}
+
+static bool equal_alphas(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a);
+    SkAutoLockPixels alpb(b);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (SkGetPackedA32(*a.getAddr32(x, y)) !=
+                    SkGetPackedA32(*b.getAddr32(x, y))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// blurred rects are drawn by stretching the blur of a smaller rect, which
+// must not change a pixel
+static void test_nine_patch(skiatest::Reporter* reporter) {
+    static const SkRect gRects[] = {
+        { SkIntToScalar(10), SkIntToScalar(12), SkIntToScalar(90), SkIntToScalar(70) },
+        { SkFloatToScalar(20.3f), SkFloatToScalar(5.75f), SkFloatToScalar(100.6f), SkFloatToScalar(80.1f) },
+        // partly offscreen
+        { SkFloatToScalar(-40.5f), SkFloatToScalar(-30.25f), SkFloatToScalar(50.5f), SkFloatToScalar(60.5f) },
+        // only wide enough to be stretched one way
+        { SkFloatToScalar(30.5f), SkFloatToScalar(40.5f), SkFloatToScalar(110.5f), SkFloatToScalar(44.5f) },
+    };
+    static const float gRadii[] = { 2, 3.5f, 6 };
+    static const uint32_t gFlags[] = {
+        SkBlurMaskFilter::kNone_BlurFlag,
+        SkBlurMaskFilter::kHighQuality_BlurFlag
+    };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRects); i++) {
+        SkPath path;
+        path.addRect(gRects[i]);
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gRadii); j++) {
+            for (int style = 0; style < SkBlurMaskFilter::kBlurStyleCount;
+                 style++) {
+                for (size_t k = 0; k < SK_ARRAY_COUNT(gFlags); k++) {
+                    SkBitmap actual, expected;
+                    SkScalar radius = SkFloatToScalar(gRadii[j]);
+                    SkBlurMaskFilter::BlurStyle bs =
+                            (SkBlurMaskFilter::BlurStyle)style;
+                    draw_blurred(&actual, path, radius, bs, gFlags[k]);
+                    draw_expected(&expected, path, radius, bs, gFlags[k]);
+                    REPORTER_ASSERT(reporter, equal_alphas(actual, expected));
+                }
+            }
+        }
+    }
+}
+
+static void test_cache(skiatest::Reporter* reporter) {
+    const size_t limit = SkBlurMaskFilter::GetCacheLimit();
+    SkBlurMaskCache::Purge();
+
+    SkRect r = { SkFloatToScalar(10.5f), SkFloatToScalar(10.25f),
+                 SkIntToScalar(50), SkIntToScalar(40) };
+    SkPath path;
+    path.addRoundRect(r, SkIntToScalar(6), SkIntToScalar(6));
+    const SkScalar radius = SkIntToScalar(4);
+
+    SkBitmap first, second, expected;
+    draw_blurred(&first, path, radius, SkBlurMaskFilter::kNormal_BlurStyle, 0);
+    const size_t used = SkBlurMaskCache::GetBytesUsed();
+    REPORTER_ASSERT(reporter, used > 0);
+
+    // a whole pixel over is the same entry
+    path.offset(SkIntToScalar(3), SkIntToScalar(-2));
+    draw_blurred(&second, path, radius, SkBlurMaskFilter::kNormal_BlurStyle, 0);
+    REPORTER_ASSERT(reporter, SkBlurMaskCache::GetBytesUsed() == used);
+    draw_expected(&expected, path, radius, SkBlurMaskFilter::kNormal_BlurStyle, 0);
+    REPORTER_ASSERT(reporter, equal_alphas(second, expected));
+
+    // but a fraction of one is not
+    path.offset(SK_ScalarHalf, 0);
+    draw_blurred(&second, path, radius, SkBlurMaskFilter::kNormal_BlurStyle, 0);
+    REPORTER_ASSERT(reporter, SkBlurMaskCache::GetBytesUsed() > used);
+    draw_expected(&expected, path, radius, SkBlurMaskFilter::kNormal_BlurStyle, 0);
+    REPORTER_ASSERT(reporter, equal_alphas(second, expected));
+
+    SkBlurMaskFilter::SetCacheLimit(0);
+    REPORTER_ASSERT(reporter, 0 == SkBlurMaskCache::GetBytesUsed());
+    draw_blurred(&second, path, radius, SkBlurMaskFilter::kNormal_BlurStyle, 0);
+    REPORTER_ASSERT(reporter, 0 == SkBlurMaskCache::GetBytesUsed());
+    REPORTER_ASSERT(reporter, equal_alphas(second, expected));
+    SkBlurMaskFilter::SetCacheLimit(limit);
+}
+
+// devices that blur the mask themselves rely on asABlur() describing it
+static void test_as_a_blur(skiatest::Reporter* reporter) {
+    static const SkMaskFilter::BlurType gTypes[] = {
+        SkMaskFilter::kNormal_BlurType,
+        SkMaskFilter::kSolid_BlurType,
+        SkMaskFilter::kOuter_BlurType,
+        SkMaskFilter::kInner_BlurType,
+    };
+    for (int style = 0; style < SkBlurMaskFilter::kBlurStyleCount; style++) {
+        SkMaskFilter* filter = SkBlurMaskFilter::Create(SkIntToScalar(3),
+                                    (SkBlurMaskFilter::BlurStyle)style,
+                                    SkBlurMaskFilter::kHighQuality_BlurFlag);
+        SkMaskFilter::BlurInfo info;
+        REPORTER_ASSERT(reporter, gTypes[style] == filter->asABlur(&info));
+        REPORTER_ASSERT(reporter, SkIntToScalar(3) == info.fRadius);
+        REPORTER_ASSERT(reporter, !info.fIgnoreTransform);
+        REPORTER_ASSERT(reporter, info.fHighQuality);
+        REPORTER_ASSERT(reporter, gTypes[style] == filter->asABlur(NULL));
+        filter->unref();
+    }
+
+    SkMaskFilter* filter = SkBlurMaskFilter::Create(SK_ScalarHalf,
+                                SkBlurMaskFilter::kNormal_BlurStyle,
+                                SkBlurMaskFilter::kIgnoreTransform_BlurFlag);
+    SkMaskFilter::BlurInfo info;
+    REPORTER_ASSERT(reporter,
+                    SkMaskFilter::kNormal_BlurType == filter->asABlur(&info));
+    REPORTER_ASSERT(reporter, SK_ScalarHalf == info.fRadius);
+    REPORTER_ASSERT(reporter, info.fIgnoreTransform);
+    REPORTER_ASSERT(reporter, !info.fHighQuality);
+    filter->unref();
+}
+
+static void TestBlur(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    // whole radii blur with one box, the others blend in a smaller one
+    static const float gRadii[] = { 1, 2, 3.5f, 4.25f, 7 };
+    static const int gSizes[] = { 1, 3, 10, 17 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRadii); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gSizes); j++) {
+            for (size_t k = 0; k < SK_ARRAY_COUNT(gSizes); k++) {
+                test_blur(reporter, &rand, gSizes[j], gSizes[k],
+                          SkFloatToScalar(gRadii[i]));
+            }
+        }
+    }
+    // big enough to be split into bands on a multicore machine
+    test_blur(reporter, &rand, 300, 260, SkFloatToScalar(2.5f));
+
+    test_nine_patch(reporter);
+    test_cache(reporter);
+    test_as_a_blur(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Blur", BlurTestClass, TestBlur)
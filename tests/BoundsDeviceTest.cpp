@@ -0,0 +1,302 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkBlurDrawLooper.h"
+#include "SkBlurMaskFilter.h"
+#include "SkBoundsDevice.h"
+#include "SkCanvas.h"
+#include "SkPath.h"
+
+static const int W = 80;
+static const int H = 64;
+
+typedef void (*DrawProc)(SkCanvas*);
+
+static void draw_rects(SkCanvas* canvas) {
+    SkPaint paint;
+    canvas->drawRect(SkRect::MakeLTRB(SkFloatToScalar(10.4f),
+                                      SkFloatToScalar(12.6f),
+                                      SkFloatToScalar(30.5f),
+                                      SkFloatToScalar(20.2f)), paint);
+    canvas->scale(SkIntToScalar(2), SkFloatToScalar(1.5f));
+    canvas->drawRect(SkRect::MakeLTRB(SkFloatToScalar(3.3f),
+                                      SkFloatToScalar(20.6f),
+                                      SkFloatToScalar(8.1f),
+                                      SkFloatToScalar(30.7f)), paint);
+}
+
+static void draw_aa_rect(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    canvas->drawRect(SkRect::MakeLTRB(SkFloatToScalar(5.5f),
+                                      SkFloatToScalar(7.25f),
+                                      SkFloatToScalar(40.1f),
+                                      SkFloatToScalar(22.9f)), paint);
+}
+
+static void draw_bitmaps(SkCanvas* canvas) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 10, 6);
+    bm.allocPixels();
+    bm.eraseColor(SK_ColorRED);
+    canvas->drawBitmap(bm, SkFloatToScalar(3.4f), SkFloatToScalar(50.6f));
+    SkRect dst = SkRect::MakeLTRB(SkFloatToScalar(20.3f), SkIntToScalar(4),
+                                  SkFloatToScalar(61.5f),
+                                  SkFloatToScalar(30.5f));
+    canvas->drawBitmapRect(bm, NULL, dst);
+}
+
+static void draw_rotated(SkCanvas* canvas) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 30, 20);
+    bm.allocPixels();
+    bm.eraseColor(SK_ColorBLUE);
+    canvas->translate(SkIntToScalar(40), SkIntToScalar(5));
+    canvas->rotate(SkIntToScalar(30));
+    canvas->drawBitmap(bm, 0, 0);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    canvas->drawRect(SkRect::MakeWH(SkIntToScalar(10), SkIntToScalar(10)),
+                     paint);
+}
+
+static void draw_strokes(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(SkIntToScalar(6));
+    paint.setStrokeCap(SkPaint::kSquare_Cap);
+    SkPath path;
+    path.moveTo(SkIntToScalar(15), SkIntToScalar(10));
+    path.lineTo(SkIntToScalar(40), SkIntToScalar(35));
+    canvas->drawPath(path, paint);
+
+    paint.setStrokeWidth(0);
+    SkPoint pts[] = {
+        { SkIntToScalar(50), SkIntToScalar(40) },
+        { SkFloatToScalar(70.5f), SkFloatToScalar(59.5f) }
+    };
+    canvas->drawPoints(SkCanvas::kLines_PointMode, 2, pts, paint);
+
+    paint.setStrokeWidth(SkIntToScalar(5));
+    paint.setStrokeCap(SkPaint::kRound_Cap);
+    paint.setStyle(SkPaint::kFill_Style);
+    SkPoint dot = { SkIntToScalar(8), SkIntToScalar(55) };
+    canvas->drawPoints(SkCanvas::kPoints_PointMode, 1, &dot, paint);
+}
+
+static void draw_blurs(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(4),
+                            SkBlurMaskFilter::kNormal_BlurStyle))->unref();
+    canvas->drawCircle(SkIntToScalar(20), SkIntToScalar(20),
+                       SkIntToScalar(8), paint);
+    paint.setMaskFilter(NULL);
+    paint.setLooper(SkNEW_ARGS(SkBlurDrawLooper,
+                               (SkIntToScalar(3), SkIntToScalar(6),
+                                SkIntToScalar(5), 0x80000000)))->unref();
+    canvas->drawRect(SkRect::MakeLTRB(SkIntToScalar(40), SkIntToScalar(30),
+                                      SkIntToScalar(60), SkIntToScalar(45)),
+                     paint);
+}
+
+static void draw_text(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(14));
+    canvas->drawText("Bounds", 6, SkIntToScalar(4), SkIntToScalar(16),
+                     paint);
+    paint.setTextAlign(SkPaint::kCenter_Align);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(SkIntToScalar(3));
+    canvas->drawText("jolt", 4, SkIntToScalar(40), SkIntToScalar(40), paint);
+
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setTextAlign(SkPaint::kRight_Align);
+    SkPoint pos[] = {
+        { SkIntToScalar(20), SkIntToScalar(55) },
+        { SkIntToScalar(60), SkIntToScalar(30) },
+        { SkIntToScalar(75), SkIntToScalar(60) }
+    };
+    canvas->drawPosText("gQ!", 3, pos, paint);
+}
+
+static void draw_text_on_path(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(12));
+    SkPath path;
+    path.moveTo(SkIntToScalar(5), SkIntToScalar(50));
+    path.quadTo(SkIntToScalar(30), SkIntToScalar(5), SkIntToScalar(60),
+                SkIntToScalar(40));
+    canvas->drawTextOnPathHV("along the path", 14, path, 0,
+                             SkIntToScalar(-3), paint);
+}
+
+static void draw_vertices(SkCanvas* canvas) {
+    SkPoint verts[] = {
+        { SkIntToScalar(10), SkIntToScalar(10) },
+        { SkIntToScalar(60), SkIntToScalar(20) },
+        { SkIntToScalar(25), SkFloatToScalar(50.5f) }
+    };
+    SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    SkPaint paint;
+    canvas->drawVertices(SkCanvas::kTriangles_VertexMode, 3, verts, NULL,
+                         colors, NULL, NULL, 0, paint);
+}
+
+static void draw_clipped(SkCanvas* canvas) {
+    SkPaint paint;
+    canvas->clipRect(SkRect::MakeLTRB(SkIntToScalar(20), SkIntToScalar(10),
+                                      SkIntToScalar(50), SkIntToScalar(40)));
+    canvas->drawCircle(SkIntToScalar(20), SkIntToScalar(20),
+                       SkIntToScalar(15), paint);
+}
+
+static void draw_layer(SkCanvas* canvas) {
+    SkPaint paint;
+    SkRect bounds = SkRect::MakeLTRB(SkIntToScalar(10), SkIntToScalar(10),
+                                     SkIntToScalar(70), SkIntToScalar(50));
+    canvas->saveLayerAlpha(&bounds, 0x80);
+    canvas->drawCircle(SkIntToScalar(30), SkIntToScalar(30),
+                       SkIntToScalar(12), paint);
+    canvas->drawRect(SkRect::MakeLTRB(SkIntToScalar(50), SkIntToScalar(5),
+                                      SkIntToScalar(75), SkIntToScalar(20)),
+                     paint);
+    canvas->restore();
+}
+
+// the bounds of the pixels that were drawn
+static SkIRect drawn_pixels(const SkBitmap& bm) {
+    SkAutoLockPixels alp(bm);
+    SkIRect bounds;
+    bounds.setEmpty();
+    for (int y = 0; y < bm.height(); y++) {
+        for (int x = 0; x < bm.width(); x++) {
+            if (*bm.getAddr32(x, y)) {
+                bounds.join(x, y, x + 1, y + 1);
+            }
+        }
+    }
+    return bounds;
+}
+
+static void test_draw(skiatest::Reporter* reporter, DrawProc proc,
+                      bool exact) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm.allocPixels();
+    bm.eraseColor(0);
+    SkCanvas canvas(bm);
+    proc(&canvas);
+    SkIRect pixels = drawn_pixels(bm);
+    REPORTER_ASSERT(reporter, !pixels.isEmpty());
+
+    SkBoundsDevice* device = SkNEW_ARGS(SkBoundsDevice, (W, H));
+    SkCanvas boundsCanvas(device);
+    device->unref();
+    proc(&boundsCanvas);
+    const SkIRect& bounds = device->drawnBounds();
+    if (exact) {
+        REPORTER_ASSERT(reporter, bounds == pixels);
+    } else {
+        REPORTER_ASSERT(reporter, bounds.contains(pixels));
+        // and not by much
+        SkIRect outset = pixels;
+        outset.inset(-32, -32);
+        REPORTER_ASSERT(reporter, outset.contains(bounds));
+    }
+}
+
+static void test_draws(skiatest::Reporter* reporter) {
+    test_draw(reporter, draw_rects, true);
+    test_draw(reporter, draw_bitmaps, true);
+    test_draw(reporter, draw_aa_rect, false);
+    test_draw(reporter, draw_rotated, false);
+    test_draw(reporter, draw_strokes, false);
+    test_draw(reporter, draw_blurs, false);
+    test_draw(reporter, draw_text, false);
+    test_draw(reporter, draw_text_on_path, false);
+    test_draw(reporter, draw_vertices, false);
+    test_draw(reporter, draw_clipped, false);
+    test_draw(reporter, draw_layer, false);
+}
+
+static void test_recording(skiatest::Reporter* reporter) {
+    SkBoundsDevice* device = SkNEW_ARGS(SkBoundsDevice, (W, H));
+    SkCanvas canvas(device);
+    device->unref();
+    REPORTER_ASSERT(reporter, device->drawnBounds().isEmpty());
+    REPORTER_ASSERT(reporter, !device->getRecordDraws());
+
+    SkPaint paint;
+    canvas.drawRect(SkRect::MakeWH(SkIntToScalar(5), SkIntToScalar(5)),
+                    paint);
+    REPORTER_ASSERT(reporter, 0 == device->countDraws());
+
+    device->reset();
+    device->setRecordDraws(true);
+    SkIRect r0 = SkIRect::MakeLTRB(2, 3, 10, 12);
+    SkIRect r1 = SkIRect::MakeLTRB(30, 20, 40, 25);
+    SkIRect r2 = SkIRect::MakeLTRB(50, 40, 60, 50);
+    SkRect r;
+    r.set(r0);
+    canvas.drawRect(r, paint);
+    // a layer's draws are added when it is restored
+    canvas.saveLayer(NULL, NULL);
+    canvas.translate(SkIntToScalar(10), 0);
+    r.set(r1);
+    r.offset(SkIntToScalar(-10), 0);
+    canvas.drawRect(r, paint);
+    REPORTER_ASSERT(reporter, 1 == device->countDraws());
+    canvas.restore();
+    r.set(r2);
+    canvas.drawRect(r, paint);
+
+    REPORTER_ASSERT(reporter, 3 == device->countDraws());
+    REPORTER_ASSERT(reporter, device->drawBoundsAt(0) == r0);
+    REPORTER_ASSERT(reporter, device->drawBoundsAt(1) == r1);
+    REPORTER_ASSERT(reporter, device->drawBoundsAt(2) == r2);
+    REPORTER_ASSERT(reporter,
+                    device->drawnBounds() == SkIRect::MakeLTRB(2, 3, 60, 50));
+
+    // everything is clipped, and a draw can be wholly clipped out
+    device->reset();
+    canvas.drawPaint(paint);
+    REPORTER_ASSERT(reporter, device->drawnBounds() ==
+                              SkIRect::MakeWH(W, H));
+    canvas.clipRect(SkRect::MakeWH(SkIntToScalar(20), SkIntToScalar(20)));
+    canvas.drawPaint(paint);
+    REPORTER_ASSERT(reporter, device->drawBoundsAt(1) ==
+                              SkIRect::MakeWH(20, 20));
+    SkPaint blur;
+    blur.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(2),
+                            SkBlurMaskFilter::kNormal_BlurStyle))->unref();
+    canvas.drawText("x", 1, SkIntToScalar(40), SkIntToScalar(40), blur);
+    REPORTER_ASSERT(reporter, 2 == device->countDraws() ||
+                    device->drawBoundsAt(2).isEmpty());
+}
+
+static void TestBoundsDevice(skiatest::Reporter* reporter) {
+    test_draws(reporter);
+    test_recording(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("BoundsDevice", BoundsDeviceTestClass, TestBoundsDevice)
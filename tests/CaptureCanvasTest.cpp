@@ -0,0 +1,124 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkCaptureCanvas.h"
+#include "SkPicture.h"
+#include "SkStream.h"
+#include <stdio.h>
+
+static const int kWidth = 40;
+static const int kHeight = 30;
+
+static void draw_frame(SkCanvas* canvas, int frame) {
+    canvas->drawColor(SK_ColorWHITE);
+    SkPaint paint;
+    paint.setColor(0xFF000000 | (frame * 0x102030));
+    canvas->save();
+    canvas->translate(SkIntToScalar(frame), 0);
+    canvas->drawRect(SkRect::MakeWH(SkIntToScalar(10), SkIntToScalar(10)),
+                     paint);
+    canvas->restore();
+    canvas->drawCircle(SkIntToScalar(25), SkIntToScalar(15),
+                       SkIntToScalar(frame + 2), paint);
+}
+
+static void make_bitmap(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, kWidth, kHeight);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return a.getSize() == b.getSize() &&
+           !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// The file should hold the given frame, as it was drawn into the target.
+static void check_capture(skiatest::Reporter* reporter, const char path[],
+                          const SkBitmap& expected) {
+    SkFILEStream stream(path);
+    REPORTER_ASSERT(reporter, stream.isValid());
+    if (!stream.isValid()) {
+        return;
+    }
+    SkPicture picture(&stream);
+    REPORTER_ASSERT(reporter, kWidth == picture.width());
+    REPORTER_ASSERT(reporter, kHeight == picture.height());
+
+    SkBitmap bm;
+    make_bitmap(&bm);
+    SkCanvas canvas(bm);
+    canvas.drawPicture(picture);
+    REPORTER_ASSERT(reporter, equal_pixels(bm, expected));
+}
+
+static void TestCaptureCanvas(skiatest::Reporter* reporter) {
+    static const int kFrames = 7;
+    SkBitmap frames[kFrames];
+
+    SkBitmap targetBM;
+    make_bitmap(&targetBM);
+    SkCanvas target(targetBM);
+    {
+        // every other frame, keeping the last two: frames 0, 2, 4 and 6 are
+        // captured, and 4 and 6 are left on disk
+        SkCaptureCanvas capture(&target, "", 2, 2);
+        for (int i = 0; i < kFrames; i++) {
+            bool captured = capture.beginFrame(kWidth, kHeight);
+            draw_frame(&capture, i);
+            capture.endFrame();
+            if (captured) {
+                // let the write finish, so no frames are dropped
+                capture.flush();
+            }
+            REPORTER_ASSERT(reporter, (0 == (i & 1)) == captured);
+            targetBM.copyTo(&frames[i], SkBitmap::kARGB_8888_Config);
+        }
+        REPORTER_ASSERT(reporter, 4 == capture.captureCount());
+        REPORTER_ASSERT(reporter, 0 == capture.droppedCount());
+    }
+
+    // the target saw every frame, captured or not
+    for (int i = 0; i < kFrames; i++) {
+        SkBitmap bm;
+        make_bitmap(&bm);
+        SkCanvas canvas(bm);
+        draw_frame(&canvas, i);
+        REPORTER_ASSERT(reporter, equal_pixels(bm, frames[i]));
+    }
+
+    check_capture(reporter, "capture_0.skp", frames[4]);
+    check_capture(reporter, "capture_1.skp", frames[6]);
+    remove("capture_0.skp");
+    remove("capture_1.skp");
+
+    // an interval of 0 captures nothing
+    SkCaptureCanvas off(&target, "", 0, 1);
+    for (int i = 0; i < 3; i++) {
+        REPORTER_ASSERT(reporter, !off.beginFrame(kWidth, kHeight));
+        draw_frame(&off, i);
+        off.endFrame();
+    }
+    REPORTER_ASSERT(reporter, 0 == off.captureCount());
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("CaptureCanvas", CaptureCanvasTestClass, TestCaptureCanvas)
@@ -81,8 +81,76 @@ static void test_intersectline(skiatest::Reporter* reporter) {
     
 }
 
+static void test_outcodes(skiatest::Reporter* reporter) {
+    static const SkRect gR = { 0, 0, SkIntToScalar(100), SkIntToScalar(100) };
+
+    // an odd count, so both the paired and the single loop are used
+    static const struct {
+        SkPoint fPt;
+        uint8_t fCode;
+    } gRec[] = {
+        { { 50, 50 }, 0 },
+        { { 0, 0 }, 0 },
+        { { 100, 100 }, 0 },
+        { { -1, 50 }, SkLineClipper::kLeft_Outcode },
+        { { 50, -1 }, SkLineClipper::kTop_Outcode },
+        { { 101, 50 }, SkLineClipper::kRight_Outcode },
+        { { 50, 101 }, SkLineClipper::kBottom_Outcode },
+        { { -1, -1 }, SkLineClipper::kLeft_Outcode |
+                      SkLineClipper::kTop_Outcode },
+        { { 101, 101 }, SkLineClipper::kRight_Outcode |
+                        SkLineClipper::kBottom_Outcode },
+    };
+    const int count = SK_ARRAY_COUNT(gRec);
+    SkPoint pts[count];
+    uint8_t codes[count];
+    for (int i = 0; i < count; i++) {
+        pts[i] = gRec[i].fPt;
+    }
+    SkLineClipper::ComputeOutcodes(pts, count, gR, codes);
+    for (int i = 0; i < count; i++) {
+        REPORTER_ASSERT(reporter, gRec[i].fCode == codes[i]);
+    }
+}
+
+static void test_culllines(skiatest::Reporter* reporter) {
+    static const SkRect gR = { 0, 0, SkIntToScalar(100), SkIntToScalar(100) };
+
+    SkPoint src[200];
+    int expected = 0;
+    for (int i = 0; i < 100; i++) {
+        SkScalar y = SkIntToScalar(i * 13 % 300 - 100);
+        src[2 * i].set(SkIntToScalar(i - 20), y);
+        src[2 * i + 1].set(SkIntToScalar(i + 10), y + 20);
+        SkPoint dst[2];
+        // everything that IntersectLine keeps has to be kept
+        if (SkLineClipper::IntersectLine(&src[2 * i], gR, dst)) {
+            expected += 2;
+        }
+    }
+
+    SkPoint dst[200];
+    int count = SkLineClipper::CullLines(src, 200, gR, dst);
+    REPORTER_ASSERT(reporter, count >= expected);
+    for (int i = 0; i < count; i += 2) {
+        SkRect bounds;
+        bounds.set(&dst[i], 2);
+        // nothing that lies completely to one side is kept
+        REPORTER_ASSERT(reporter, bounds.fRight >= gR.fLeft &&
+                                  bounds.fLeft <= gR.fRight &&
+                                  bounds.fBottom >= gR.fTop &&
+                                  bounds.fTop <= gR.fBottom);
+    }
+
+    // in place
+    count = SkLineClipper::CullLines(src, 200, gR, src);
+    REPORTER_ASSERT(reporter, !memcmp(src, dst, count * sizeof(SkPoint)));
+}
+
 void TestClipper(skiatest::Reporter* reporter) {
     test_intersectline(reporter);
+    test_outcodes(reporter);
+    test_culllines(reporter);
 }
 
 #include "TestClassDef.h"
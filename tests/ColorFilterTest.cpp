@@ -1,7 +1,12 @@
 #include "Test.h"
+#include "SkCanvas.h"
 #include "SkColor.h"
 #include "SkColorFilter.h"
+#include "SkColorMatrixFilter.h"
+#include "SkColorPriv.h"
+#include "SkColorShader.h"
 #include "SkRandom.h"
+#include "SkUtils.h"
 #include "SkXfermode.h"
 
 static SkFlattenable* reincarnate_flattenable(SkFlattenable* obj) {
@@ -89,5 +94,228 @@ static void test_asColorMode(skiatest::Reporter* reporter) {
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+static SkPMColor random_pmcolor(SkRandom* rand) {
+    unsigned a = rand->nextU() & 0xFF;
+    // a third of them opaque, so there are opaque runs, and some clear
+    if (rand->nextU() % 3 == 0) {
+        a = 0xFF;
+    } else if (rand->nextU() % 8 == 0) {
+        a = 0;
+    }
+    return SkPackARGB32(a, rand->nextU() % (a + 1), rand->nextU() % (a + 1),
+                        rand->nextU() % (a + 1));
+}
+
+// whole spans (which the platform proc may filter) have to come out the same
+// as pixels filtered one at a time, which it doesn't
+static void test_span(skiatest::Reporter* reporter, const SkScalar mat[20],
+                      SkRandom* rand) {
+    SkColorMatrixFilter filter(mat);
+
+    const int N = 67;
+    SkPMColor src[N], dst[N], inPlace[N];
+    for (int i = 0; i < N; i++) {
+        src[i] = inPlace[i] = random_pmcolor(rand);
+    }
+    // a long opaque run
+    for (int i = 16; i < 40; i++) {
+        src[i] = inPlace[i] = src[i] | (0xFF << SK_A32_SHIFT);
+    }
+
+    filter.filterSpan(src, N, dst);
+    filter.filterSpan(inPlace, N, inPlace);
+    for (int i = 0; i < N; i++) {
+        SkPMColor expected;
+        filter.filterSpan(&src[i], 1, &expected);
+        REPORTER_ASSERT(reporter, expected == dst[i]);
+        REPORTER_ASSERT(reporter, expected == inPlace[i]);
+    }
+}
+
+static void test_colorMatrix(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    SkColorMatrix cm;
+
+    // each of the procs, with and without a 16 bit shift: add, scale, 3x3,
+    // and then alpha both used and changed
+    cm.setIdentity();
+    cm.fMat[4] = SkIntToScalar(30);
+    cm.fMat[9] = SkIntToScalar(-40);
+    test_span(reporter, cm.fMat, &rand);
+    cm.setScale(SK_Scalar1 / 2, SK_Scalar1 * 6 / 5, SkIntToScalar(2));
+    test_span(reporter, cm.fMat, &rand);
+    cm.setSaturation(SK_Scalar1 * 3 / 10);
+    test_span(reporter, cm.fMat, &rand);
+    cm.setRotate(SkColorMatrix::kG_Axis, SkIntToScalar(30));
+    test_span(reporter, cm.fMat, &rand);
+    cm.setIdentity();
+    cm.fMat[3] = SK_Scalar1 / 2;
+    test_span(reporter, cm.fMat, &rand);
+    cm.setScale(SK_Scalar1, SK_Scalar1, SK_Scalar1, SK_Scalar1 * 3 / 4);
+    test_span(reporter, cm.fMat, &rand);
+    cm.setIdentity();
+    cm.fMat[0] = SkIntToScalar(300);
+    cm.fMat[1] = SkIntToScalar(-200);
+    cm.fMat[19] = SkIntToScalar(-20);
+    test_span(reporter, cm.fMat, &rand);
+
+    // and anything else
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < 20; j++) {
+            bool isAdd = 4 == j % 5;
+            cm.fMat[j] = isAdd ?
+                         SkIntToScalar((int)(rand.nextU() % 511) - 255) :
+                         rand.nextSScalar1() * 4;
+        }
+        test_span(reporter, cm.fMat, &rand);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void filter_twice(SkColorFilter* outer, SkColorFilter* inner,
+                         const SkPMColor src[], int count, SkPMColor dst[]) {
+    inner->filterSpan(src, count, dst);
+    outer->filterSpan(dst, count, dst);
+}
+
+static void test_compose(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    const int N = 50;
+    SkPMColor src[N], dst[N], expected[N];
+    for (int i = 0; i < N; i++) {
+        src[i] = random_pmcolor(&rand);
+    }
+
+    SkColorMatrix cm;
+    cm.setScale(SK_Scalar1 / 2, SK_Scalar1 * 3 / 4, SK_Scalar1);
+    SkColorMatrixFilter scale(cm);
+    cm.setSaturation(SK_Scalar1 / 3);
+    SkColorMatrixFilter saturate(cm);
+    SkColorFilter* lighting = SkColorFilter::CreateLightingFilter(0x808080,
+                                                                 0x102030);
+    SkAutoUnref aurL(lighting);
+
+    // with only the one filter, that's what we get back
+    SkColorFilter* cf = SkColorFilter::CreateComposeFilter(&scale, NULL);
+    REPORTER_ASSERT(reporter, &scale == cf);
+    SkSafeUnref(cf);
+    cf = SkColorFilter::CreateComposeFilter(NULL, &scale);
+    REPORTER_ASSERT(reporter, &scale == cf);
+    SkSafeUnref(cf);
+    REPORTER_ASSERT(reporter,
+                    NULL == SkColorFilter::CreateComposeFilter(NULL, NULL));
+
+    // an inner filter that makes one (opaque) color is folded through the
+    // outer one
+    SkColorFilter* red = SkColorFilter::CreateModeFilter(SK_ColorRED,
+                                                    SkXfermode::kSrc_Mode);
+    SkAutoUnref aurR(red);
+    cf = SkColorFilter::CreateComposeFilter(lighting, red);
+    SkAutoUnref aur0(cf);
+    SkColor c;
+    SkXfermode::Mode m;
+    REPORTER_ASSERT(reporter, cf->asColorMode(&c, &m));
+    REPORTER_ASSERT(reporter, SkXfermode::kSrc_Mode == m);
+    cf->filterSpan(src, N, dst);
+    filter_twice(lighting, red, src, N, expected);
+    REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+
+    // and an outer one that does, is all there is
+    SkColorFilter* cf1 = SkColorFilter::CreateComposeFilter(red, lighting);
+    REPORTER_ASSERT(reporter, red == cf1);
+    SkSafeUnref(cf1);
+
+    // two matrices make one, which only rounds differently
+    cf = SkColorFilter::CreateComposeFilter(&saturate, &scale);
+    SkAutoUnref aur2(cf);
+    SkScalar mat[20];
+    REPORTER_ASSERT(reporter, cf->asColorMatrix(mat));
+    cf->filterSpan(src, N, dst);
+    filter_twice(&saturate, &scale, src, N, expected);
+    for (int i = 0; i < N; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            int diff = (int)((dst[i] >> shift) & 0xFF) -
+                       (int)((expected[i] >> shift) & 0xFF);
+            REPORTER_ASSERT(reporter, SkAbs32(diff) <= 2);
+        }
+    }
+
+    // anything else is applied in turn, and survives flattening
+    SkColorFilter* multiply = SkColorFilter::CreateModeFilter(0x80C06020,
+                                                SkXfermode::kMultiply_Mode);
+    SkAutoUnref aurM(multiply);
+    cf = SkColorFilter::CreateComposeFilter(multiply, lighting);
+    SkAutoUnref aur3(cf);
+    REPORTER_ASSERT(reporter, !cf->asColorMode(NULL, NULL));
+    REPORTER_ASSERT(reporter, !cf->asColorMatrix(mat));
+    filter_twice(multiply, lighting, src, N, expected);
+    cf->filterSpan(src, N, dst);
+    REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+    SkColorFilter* cf2 = reincarnate(cf);
+    SkAutoUnref aur4(cf2);
+    REPORTER_ASSERT(reporter, cf2);
+    cf2->filterSpan(src, N, dst);
+    REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+}
+
+static void make_bitmap(SkBitmap* bm, int w, int h, SkPMColor color) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, w, h);
+    bm->allocPixels();
+    for (int y = 0; y < h; y++) {
+        sk_memset32(bm->getAddr32(0, y), color, w);
+    }
+}
+
+// A solid paint color under a filter and a mode is filtered once, when the
+// blitter is chosen, which has to draw what filtering each pixel draws.
+static void test_paint_fold(skiatest::Reporter* reporter) {
+    static const SkColor gColors[] = {
+        SK_ColorRED, 0xFF336699, 0x80336699, 0x01FFFFFF, 0,
+    };
+    SkColorMatrix cm;
+    cm.setSaturation(SK_Scalar1 / 3);
+    SkColorFilter* filters[] = {
+        SkColorFilter::CreateModeFilter(0x80204060, SkXfermode::kScreen_Mode),
+        SkColorFilter::CreateLightingFilter(0x808080, 0x102030),
+        SkNEW_ARGS(SkColorMatrixFilter, (cm)),
+    };
+    SkXfermode* mode = SkXfermode::Create(SkXfermode::kMultiply_Mode);
+    SkAutoUnref aurMode(mode);
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(filters); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gColors); j++) {
+            SkBitmap folded, filtered;
+            make_bitmap(&folded, 4, 4, 0xC0608040);
+            make_bitmap(&filtered, 4, 4, 0xC0608040);
+
+            SkPaint paint;
+            paint.setColor(gColors[j]);
+            paint.setColorFilter(filters[i]);
+            paint.setXfermode(mode);
+            SkCanvas(folded).drawPaint(paint);
+
+            // a shader of its own keeps the filter on the pixels
+            paint.setColor(SK_ColorBLACK);
+            paint.setShader(SkNEW_ARGS(SkColorShader, (gColors[j])))->unref();
+            SkCanvas(filtered).drawPaint(paint);
+
+            REPORTER_ASSERT(reporter, !memcmp(folded.getPixels(),
+                                              filtered.getPixels(),
+                                              folded.getSize()));
+        }
+        filters[i]->unref();
+    }
+}
+
+static void TestColorFilter(skiatest::Reporter* reporter) {
+    test_asColorMode(reporter);
+    test_colorMatrix(reporter);
+    test_compose(reporter);
+    test_paint_fold(reporter);
+}
+
 #include "TestClassDef.h"
-DEFINE_TESTCLASS("ColorFilter", ColorFilterTestClass, test_asColorMode)
+DEFINE_TESTCLASS("ColorFilter", ColorFilterTestClass, TestColorFilter)
@@ -0,0 +1,143 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkColorShader.h"
+#include "SkComposeShader.h"
+#include "SkGradientShader.h"
+#include "SkRandom.h"
+#include "SkXfermode.h"
+
+static const int W = 67;
+static const int H = 3;
+
+static void draw(const SkBitmap& dst, SkShader* shader, U8CPU alpha) {
+    dst.eraseColor(0);
+    SkPaint paint;
+    paint.setShader(shader);
+    paint.setAlpha(alpha);
+    // so we see just what the shader makes
+    paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+    SkCanvas(dst).drawPaint(paint);
+}
+
+static SkShader* make_bitmap_shader(SkRandom* rand, bool opaque) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm.allocPixels();
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            unsigned a = opaque ? 0xFF : rand->nextU() & 0xFF;
+            *bm.getAddr32(x, y) = SkPackARGB32(a, rand->nextU() % (a + 1),
+                                                   rand->nextU() % (a + 1),
+                                                   rand->nextU() % (a + 1));
+        }
+    }
+    bm.setIsOpaque(opaque);
+    return SkShader::CreateBitmapShader(bm, SkShader::kClamp_TileMode,
+                                        SkShader::kClamp_TileMode);
+}
+
+static SkShader* make_gradient(SkColor c0, SkColor c1) {
+    SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(W), 0 } };
+    SkColor colors[] = { c0, c1 };
+    return SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                          SkShader::kClamp_TileMode);
+}
+
+/*  However the compose shader gets there (skipping a shader that makes no
+    difference, folding a solid color into the mode, or calling a row proc),
+    it has to come out the same as running the mode proc over the two
+    shaders' colors, and then scaling by the paint's alpha.
+ */
+static void TestComposeShader(skiatest::Reporter* reporter) {
+    static const SkXfermode::Mode gModes[] = {
+        SkXfermode::kSrcOver_Mode, SkXfermode::kSrc_Mode,
+        SkXfermode::kDst_Mode, SkXfermode::kDstOver_Mode,
+        SkXfermode::kSrcIn_Mode, SkXfermode::kDstIn_Mode,
+        SkXfermode::kMultiply_Mode, SkXfermode::kXor_Mode,
+        SkXfermode::kScreen_Mode, SkXfermode::kOverlay_Mode,
+    };
+    static const U8CPU gAlphas[] = { 0xFF, 0x80 };
+
+    SkRandom rand;
+    SkShader* shadersA[] = {
+        make_bitmap_shader(&rand, false),
+        make_bitmap_shader(&rand, true),
+    };
+    SkShader* shadersB[] = {
+        make_gradient(SK_ColorRED, SK_ColorBLUE),
+        make_gradient(0x80FF0000, 0x200000FF),
+        SkNEW_ARGS(SkColorShader, (0xFF336699)),
+        SkNEW_ARGS(SkColorShader, (0x80336699)),
+        SkNEW_ARGS(SkColorShader, (0)),
+    };
+
+    SkBitmap a, b, dst;
+    a.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    a.allocPixels();
+    b.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    b.allocPixels();
+    dst.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    dst.allocPixels();
+
+    for (size_t ia = 0; ia < SK_ARRAY_COUNT(shadersA); ia++) {
+        draw(a, shadersA[ia], 0xFF);
+        for (size_t ib = 0; ib < SK_ARRAY_COUNT(shadersB); ib++) {
+            draw(b, shadersB[ib], 0xFF);
+            // the last time round is for no mode at all, which is src-over
+            for (size_t im = 0; im <= SK_ARRAY_COUNT(gModes); im++) {
+                bool hasMode = im < SK_ARRAY_COUNT(gModes);
+                SkXfermode::Mode m = hasMode ? gModes[im] :
+                                               SkXfermode::kSrcOver_Mode;
+                SkXfermode* mode = hasMode ? SkXfermode::Create(m) : NULL;
+                SkShader* shader = SkNEW_ARGS(SkComposeShader,
+                                        (shadersA[ia], shadersB[ib], mode));
+                SkSafeUnref(mode);
+                SkXfermodeProc proc = SkXfermode::GetProc(m);
+
+                for (size_t ip = 0; ip < SK_ARRAY_COUNT(gAlphas); ip++) {
+                    draw(dst, shader, gAlphas[ip]);
+                    unsigned scale = SkAlpha255To256(gAlphas[ip]);
+                    bool ok = true;
+                    for (int y = 0; y < H; y++) {
+                        for (int x = 0; x < W; x++) {
+                            SkPMColor expected = SkAlphaMulQ(
+                                  proc(*b.getAddr32(x, y), *a.getAddr32(x, y)),
+                                  scale);
+                            ok = ok && expected == *dst.getAddr32(x, y);
+                        }
+                    }
+                    REPORTER_ASSERT(reporter, ok);
+                }
+                shader->unref();
+            }
+        }
+    }
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(shadersA); i++) {
+        shadersA[i]->unref();
+    }
+    for (size_t i = 0; i < SK_ARRAY_COUNT(shadersB); i++) {
+        shadersB[i]->unref();
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ComposeShader", ComposeShaderTestClass, TestComposeShader)
@@ -0,0 +1,232 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkDashPathEffect.h"
+#include "SkPath.h"
+#include "SkPathMeasure.h"
+#include "SkRandom.h"
+
+static bool is_even(int x) {
+    return 0 == (x & 1);
+}
+
+// how SkDashPathEffect dashes every path, with SkPathMeasure
+static void ref_dash(const SkScalar intervals[], int count, SkScalar phase,
+                     bool scaleToFit, const SkPath& src, SkPath* dst) {
+    SkScalar intervalLength = 0;
+    for (int i = 0; i < count; i++) {
+        intervalLength += intervals[i];
+    }
+    phase = SkScalarMod(phase, intervalLength);
+    int initialIndex = 0;
+    while (phase > intervals[initialIndex]) {
+        phase -= intervals[initialIndex];
+        initialIndex += 1;
+    }
+    SkScalar initialLength = intervals[initialIndex] - phase;
+
+    SkPathMeasure meas(src, false);
+    do {
+        bool skipFirst = meas.isClosed();
+        bool added = false;
+        SkScalar length = meas.getLength();
+        SkScalar scale = SK_Scalar1;
+        if (scaleToFit) {
+            if (intervalLength >= length) {
+                scale = SkScalarDiv(length, intervalLength);
+            } else {
+                int n = SkScalarFloor(SkScalarDiv(length, intervalLength));
+                scale = SkScalarDiv(length, n * intervalLength);
+            }
+        }
+        int index = initialIndex;
+        SkScalar distance = 0;
+        SkScalar dlen = SkScalarMul(initialLength, scale);
+        while (distance < length) {
+            added = false;
+            if (is_even(index) && dlen > 0 && !skipFirst) {
+                added = true;
+                meas.getSegment(distance, distance + dlen, dst, true);
+            }
+            distance += dlen;
+            skipFirst = false;
+            index = (index + 1) % count;
+            dlen = SkScalarMul(intervals[index], scale);
+        }
+        if (meas.isClosed() && is_even(initialIndex) && initialLength > 0) {
+            meas.getSegment(0, SkScalarMul(initialLength, scale), dst, !added);
+        }
+    } while (meas.nextContour());
+}
+
+static bool near(const SkPoint& a, const SkPoint& b) {
+    const SkScalar tol = SK_Scalar1 / 64;
+    return SkScalarAbs(a.fX - b.fX) <= tol && SkScalarAbs(a.fY - b.fY) <= tol;
+}
+
+// the same verbs, and the same points give or take SkPathMeasure's rounding
+static bool paths_match(const SkPath& a, const SkPath& b) {
+    SkPath::Iter iterA(a, false), iterB(b, false);
+    SkPoint ptsA[4], ptsB[4];
+    for (;;) {
+        SkPath::Verb verb = iterA.next(ptsA);
+        if (iterB.next(ptsB) != verb) {
+            return false;
+        }
+        int n = 0;
+        switch (verb) {
+            case SkPath::kMove_Verb:    n = 1; break;
+            case SkPath::kLine_Verb:    n = 2; break;
+            case SkPath::kQuad_Verb:    n = 3; break;
+            case SkPath::kCubic_Verb:   n = 4; break;
+            case SkPath::kClose_Verb:   break;
+            case SkPath::kDone_Verb:    return true;
+        }
+        for (int i = 0; i < n; i++) {
+            if (!near(ptsA[i], ptsB[i])) {
+                return false;
+            }
+        }
+    }
+}
+
+static void check_dash(skiatest::Reporter* reporter, const SkPath& src,
+                       const SkScalar intervals[], int count, SkScalar phase,
+                       bool scaleToFit) {
+    SkDashPathEffect effect(intervals, count, phase, scaleToFit);
+    SkPath expected, actual, again;
+    ref_dash(intervals, count, phase, scaleToFit, src, &expected);
+
+    SkScalar width = 0;
+    REPORTER_ASSERT(reporter, effect.filterPath(&actual, src, &width));
+    REPORTER_ASSERT(reporter, paths_match(actual, expected));
+
+    // the second time around it comes from the cache
+    REPORTER_ASSERT(reporter, effect.filterPath(&again, src, &width));
+    REPORTER_ASSERT(reporter, again == actual);
+
+    // and it doesn't care to be filled
+    width = -SK_Scalar1;
+    REPORTER_ASSERT(reporter, !effect.filterPath(&again, src, &width));
+}
+
+static void make_polyline(SkRandom* rand, int count, bool close,
+                          SkPath* path) {
+    path->moveTo(rand->nextUScalar1() * 100, rand->nextUScalar1() * 100);
+    for (int i = 0; i < count; i++) {
+        path->lineTo(rand->nextUScalar1() * 100, rand->nextUScalar1() * 100);
+    }
+    if (close) {
+        path->close();
+    }
+}
+
+static void test_lines(skiatest::Reporter* reporter) {
+    static const SkScalar gIntervals0[] = { 10, 5 };
+    static const SkScalar gIntervals1[] = { 3, 2, 7, 1 };
+    static const SkScalar gIntervals2[] = { SK_Scalar1 / 2, 20 };
+    static const SkScalar gPhases[] = { 0, 2, 9, 11, 14 };
+
+    SkRandom rand;
+    SkPath paths[6];
+    make_polyline(&rand, 1, false, &paths[0]);
+    make_polyline(&rand, 20, false, &paths[1]);
+    make_polyline(&rand, 20, true, &paths[2]);
+    paths[3].addRect(10, 10, 90, 60);
+    make_polyline(&rand, 5, false, &paths[4]);
+    paths[4].lineTo(paths[4].getPoint(paths[4].countPoints() - 1));
+    make_polyline(&rand, 5, true, &paths[4]);
+    // a zero-length contour stops the dashing
+    make_polyline(&rand, 3, false, &paths[5]);
+    paths[5].moveTo(50, 50);
+    paths[5].lineTo(50, 50);
+    make_polyline(&rand, 3, false, &paths[5]);
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(paths); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gPhases); j++) {
+            for (int fit = 0; fit <= 1; fit++) {
+                check_dash(reporter, paths[i], gIntervals0,
+                           SK_ARRAY_COUNT(gIntervals0), gPhases[j], fit);
+                check_dash(reporter, paths[i], gIntervals1,
+                           SK_ARRAY_COUNT(gIntervals1), gPhases[j], fit);
+                check_dash(reporter, paths[i], gIntervals2,
+                           SK_ARRAY_COUNT(gIntervals2), gPhases[j], fit);
+            }
+        }
+    }
+}
+
+static void test_curves(skiatest::Reporter* reporter) {
+    static const SkScalar gIntervals[] = { 6, 4 };
+    SkPath path;
+    path.moveTo(0, 0);
+    path.lineTo(30, 0);
+    path.quadTo(60, 0, 60, 30);
+    path.cubicTo(60, 60, 0, 60, 0, 30);
+    path.close();
+    path.addCircle(50, 50, 20);
+
+    SkDashPathEffect effect(gIntervals, SK_ARRAY_COUNT(gIntervals), 3);
+    SkPath expected, actual;
+    ref_dash(gIntervals, SK_ARRAY_COUNT(gIntervals), 3, false, path,
+             &expected);
+    SkScalar width = 0;
+    REPORTER_ASSERT(reporter, effect.filterPath(&actual, path, &width));
+    REPORTER_ASSERT(reporter, actual == expected);
+}
+
+// the cache has to notice when the path changes, but not when it's copied
+static void test_cache(skiatest::Reporter* reporter) {
+    static const SkScalar gIntervals[] = { 4, 4 };
+    SkDashPathEffect effect(gIntervals, SK_ARRAY_COUNT(gIntervals), 0);
+    SkScalar width = 0;
+
+    SkPath path;
+    path.moveTo(0, 0);
+    path.lineTo(100, 0);
+    SkPath first;
+    effect.filterPath(&first, path, &width);
+
+    SkPath copy(path);
+    SkPath second;
+    effect.filterPath(&second, copy, &width);
+    REPORTER_ASSERT(reporter, second == first);
+
+    path.lineTo(100, 100);
+    SkPath third, expected;
+    effect.filterPath(&third, path, &width);
+    ref_dash(gIntervals, SK_ARRAY_COUNT(gIntervals), 0, false, path,
+             &expected);
+    REPORTER_ASSERT(reporter, paths_match(third, expected));
+    REPORTER_ASSERT(reporter, third.countPoints() > first.countPoints());
+
+    // dashes are added to whatever dst already has
+    SkPath both(first);
+    effect.filterPath(&both, path, &width);
+    REPORTER_ASSERT(reporter,
+                    both.countPoints() ==
+                    first.countPoints() + third.countPoints());
+}
+
+static void TestDashPathEffect(skiatest::Reporter* reporter) {
+    test_lines(reporter);
+    test_curves(reporter);
+    test_cache(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("DashPathEffect", DashPathEffectTestClass, TestDashPathEffect)
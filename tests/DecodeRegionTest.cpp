@@ -0,0 +1,127 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkGradientShader.h"
+#include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+
+static const int W = 97;
+static const int H = 61;
+
+static SkStream* make_png(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm->allocPixels();
+
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(W), SkIntToScalar(H) } };
+    SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    paint.setShader(SkGradientShader::CreateLinear(pts, colors, NULL, 3,
+                                        SkShader::kMirror_TileMode))->unref();
+    canvas.drawPaint(paint);
+
+    SkDynamicMemoryWStream wstream;
+    if (!SkImageEncoder::EncodeStream(&wstream, *bm, SkImageEncoder::kPNG_Type,
+                                      100)) {
+        return NULL;
+    }
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream,
+                                        (wstream.getOffset()));
+    wstream.copyTo((void*)stream->getMemoryBase());
+    return stream;
+}
+
+// compare region (decoded with sampleSize) against the same pixels of full
+static bool check_region(const SkBitmap& full, const SkBitmap& region,
+                         const SkIRect& rect, int sampleSize) {
+    if (region.width() != rect.width() / sampleSize ||
+            region.height() != rect.height() / sampleSize) {
+        return false;
+    }
+    const int offset = sampleSize >> 1;
+    SkAutoLockPixels alp0(full);
+    SkAutoLockPixels alp1(region);
+    for (int y = 0; y < region.height(); y++) {
+        for (int x = 0; x < region.width(); x++) {
+            int fx = rect.fLeft + offset + x * sampleSize;
+            int fy = rect.fTop + offset + y * sampleSize;
+            if (*region.getAddr32(x, y) != *full.getAddr32(fx, fy)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void TestDecodeRegion(skiatest::Reporter* reporter) {
+    SkBitmap original;
+    SkStream* stream = make_png(&original);
+    if (NULL == stream) {
+        // no png encoder in this build
+        return;
+    }
+    SkAutoUnref aur(stream);
+
+    SkBitmap full;
+    REPORTER_ASSERT(reporter, SkImageDecoder::DecodeStream(stream, &full,
+                                            SkBitmap::kARGB_8888_Config,
+                                            SkImageDecoder::kDecodePixels_Mode));
+
+    stream->rewind();
+    SkImageDecoder* codec = SkImageDecoder::Factory(stream);
+    REPORTER_ASSERT(reporter, codec);
+    if (NULL == codec) {
+        return;
+    }
+    SkAutoTDelete<SkImageDecoder> ad(codec);
+
+    int width, height;
+    REPORTER_ASSERT(reporter, codec->buildTileIndex(stream, &width, &height));
+    REPORTER_ASSERT(reporter, W == width && H == height);
+
+    static const SkIRect gRects[] = {
+        { 0, 0, W, H },
+        { 0, 0, 10, 10 },
+        { 13, 7, 50, 40 },
+        { W - 20, H - 12, W, H },
+    };
+    for (int s = 1; s <= 3; s++) {
+        codec->setSampleSize(s);
+        for (size_t i = 0; i < SK_ARRAY_COUNT(gRects); i++) {
+            SkBitmap region;
+            REPORTER_ASSERT(reporter, codec->decodeRegion(&region, gRects[i],
+                                                SkBitmap::kARGB_8888_Config));
+            REPORTER_ASSERT(reporter, check_region(full, region, gRects[i],
+                                                   s));
+        }
+    }
+
+    // rects are clipped to the image, and must intersect it
+    codec->setSampleSize(1);
+    SkBitmap region;
+    SkIRect rect = { -10, H - 5, 5, H + 20 };
+    REPORTER_ASSERT(reporter, codec->decodeRegion(&region, rect));
+    REPORTER_ASSERT(reporter, 5 == region.width() && 5 == region.height());
+    rect.set(W, 0, W + 10, 10);
+    REPORTER_ASSERT(reporter, !codec->decodeRegion(&region, rect));
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("DecodeRegion", DecodeRegionTestClass, TestDecodeRegion)
@@ -0,0 +1,274 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkDeferredDevice.h"
+#include "SkPath.h"
+#include "SkPixelRef.h"
+
+static const int W = 64;
+static const int H = 48;
+
+static void make_bitmap(SkBitmap* bm, SkBitmap::Config config = SkBitmap::kARGB_8888_Config) {
+    bm->setConfig(config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a);
+    SkAutoLockPixels alpb(b);
+    for (int y = 0; y < H; y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), W * a.bytesPerPixel())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a 16x16 bitmap of distinct colors, with immutable pixels
+static void make_tiles(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 16, 16);
+    bm->allocPixels();
+    bm->setIsOpaque(true);
+    SkAutoLockPixels alp(*bm);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            *bm->getAddr32(x, y) = SkPreMultiplyColor(
+                    SkColorSetARGB(0xFF, x * 16, y * 16, 0x80));
+        }
+    }
+    bm->pixelRef()->setImmutable();
+}
+
+/*  Each scene is drawn directly and through a deferred device, and has to
+    come out the same. queued is how many draws the deferred device should be
+    holding at the end, or -1 for don't care.
+ */
+typedef void (*SceneProc)(SkCanvas*);
+
+static void scene_rect_rows(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setColor(0x8040C020);
+    // abutting rects, which merge into one
+    for (int i = 0; i < 6; i++) {
+        SkRect r = { SkIntToScalar(2 + i * 5), SkFloatToScalar(3.5f),
+                     SkIntToScalar(7 + i * 5), SkFloatToScalar(20.25f) };
+        canvas->drawRect(r, paint);
+    }
+    // and stacked ones
+    for (int i = 0; i < 4; i++) {
+        SkRect r = { SkFloatToScalar(40.3f), SkFloatToScalar(2.5f + i * 3.25f),
+                     SkFloatToScalar(55.7f), SkFloatToScalar(5.75f + i * 3.25f) };
+        canvas->drawRect(r, paint);
+    }
+}
+
+static void scene_aa_rects(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0xC02080F0);
+    // fractional edges, which must not merge
+    for (int i = 0; i < 5; i++) {
+        SkRect r = { SkFloatToScalar(2.5f + i * 6.5f), SkFloatToScalar(3.3f),
+                     SkFloatToScalar(9 + i * 6.5f), SkFloatToScalar(30.6f) };
+        canvas->drawRect(r, paint);
+    }
+    // whole ones, which may
+    for (int i = 0; i < 3; i++) {
+        SkRect r = { SkIntToScalar(5 + i * 8), SkIntToScalar(33),
+                     SkIntToScalar(13 + i * 8), SkIntToScalar(45) };
+        canvas->drawRect(r, paint);
+    }
+}
+
+static void scene_mixed(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0x80FF0000);
+    canvas->drawPaint(paint);
+
+    SkPath path;
+    path.addCircle(SkIntToScalar(20), SkIntToScalar(20), SkIntToScalar(15));
+    paint.setColor(0xA00000FF);
+    canvas->drawPath(path, paint);
+
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(SkIntToScalar(3));
+    canvas->drawRect(SkRect::MakeLTRB(SkIntToScalar(30), SkIntToScalar(5),
+                                      SkIntToScalar(60), SkIntToScalar(40)),
+                     paint);
+
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setColor(SK_ColorBLACK);
+    paint.setTextSize(SkIntToScalar(14));
+    canvas->drawText("deferred", 8, SkIntToScalar(2), SkIntToScalar(44), paint);
+
+    SkPoint pts[] = { { 1, 1 }, { 62, 46 }, { 62, 1 } };
+    canvas->drawPoints(SkCanvas::kPolygon_PointMode, 3, pts, paint);
+
+    canvas->save();
+    canvas->rotate(SkIntToScalar(20));
+    canvas->clipRect(SkRect::MakeWH(SkIntToScalar(40), SkIntToScalar(30)));
+    paint.setColor(0x6000FF00);
+    canvas->drawRect(SkRect::MakeWH(SkIntToScalar(40), SkIntToScalar(50)),
+                     paint);
+    canvas->restore();
+}
+
+static void scene_overdraw(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0x80FF0000);
+    canvas->drawRect(SkRect::MakeLTRB(SkIntToScalar(5), SkIntToScalar(5),
+                                      SkIntToScalar(20), SkIntToScalar(20)),
+                     paint);
+    SkPath path;
+    path.addCircle(SkIntToScalar(12), SkIntToScalar(12), SkIntToScalar(6));
+    paint.setColor(0xA00000FF);
+    canvas->drawPath(path, paint);
+
+    // covers both of the above
+    paint.setColor(SK_ColorWHITE);
+    canvas->drawRect(SkRect::MakeLTRB(SkFloatToScalar(1.5f),
+                                      SkFloatToScalar(1.5f),
+                                      SkFloatToScalar(30.5f),
+                                      SkFloatToScalar(30.5f)),
+                     paint);
+
+    paint.setColor(0x8000FF00);
+    canvas->drawRect(SkRect::MakeLTRB(SkIntToScalar(40), SkIntToScalar(5),
+                                      SkIntToScalar(60), SkIntToScalar(20)),
+                     paint);
+    // covers the green rect, but only part of the white one
+    canvas->save();
+    canvas->clipRect(SkRect::MakeLTRB(SkIntToScalar(25), 0,
+                                      SkIntToScalar(W), SkIntToScalar(H)));
+    paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+    paint.setColor(0x40102030);
+    canvas->drawPaint(paint);
+    canvas->restore();
+}
+
+static void scene_sprites(SkCanvas* canvas) {
+    SkBitmap tiles;
+    make_tiles(&tiles);
+    // a row of 4x16 strips, put back together in their original order
+    for (int i = 0; i < 4; i++) {
+        SkBitmap strip;
+        SkIRect r = { i * 4, 0, i * 4 + 4, 16 };
+        tiles.extractSubset(&strip, r);
+        canvas->drawSprite(strip, 10 + i * 4, 5, NULL);
+    }
+    // and out of it
+    for (int i = 0; i < 4; i++) {
+        SkBitmap strip;
+        SkIRect r = { 0, i * 4, 16, i * 4 + 4 };
+        tiles.extractSubset(&strip, r);
+        canvas->drawSprite(strip, 40, 25 + (3 - i) * 4, NULL);
+    }
+}
+
+static void scene_mutated_bitmap(SkCanvas* canvas) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 10, 10);
+    bm.allocPixels();
+    bm.eraseColor(SK_ColorRED);
+    canvas->drawSprite(bm, 3, 3, NULL);
+    canvas->drawBitmap(bm, SkIntToScalar(20), SkFloatToScalar(10.5f), NULL);
+    // the deferred device took a copy, so this is not what gets drawn
+    bm.eraseColor(SK_ColorGREEN);
+}
+
+static void test_scene(skiatest::Reporter* reporter, SceneProc proc,
+                       int queued) {
+    SkBitmap expected, actual;
+    make_bitmap(&expected);
+    make_bitmap(&actual);
+    {
+        SkCanvas canvas(expected);
+        proc(&canvas);
+    }
+
+    SkDeferredDevice* device = new SkDeferredDevice(actual);
+    SkCanvas canvas(device);
+    device->unref();
+    proc(&canvas);
+    if (queued >= 0) {
+        REPORTER_ASSERT(reporter, queued == device->countQueued());
+    }
+    // must flush first
+    device->accessBitmap(false);
+    REPORTER_ASSERT(reporter, 0 == device->countQueued());
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+}
+
+static void test_flush(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    make_bitmap(&bm);
+    SkDeferredDevice* device = new SkDeferredDevice(bm);
+    SkCanvas canvas(device);
+    device->unref();
+
+    canvas.drawColor(SK_ColorBLUE);
+    REPORTER_ASSERT(reporter, 1 == device->countQueued());
+    {
+        SkAutoLockPixels alp(bm);
+        REPORTER_ASSERT(reporter, 0 == *bm.getAddr32(5, 5));
+    }
+
+    SkBitmap read;
+    REPORTER_ASSERT(reporter, canvas.readPixels(&read));
+    REPORTER_ASSERT(reporter, 0 == device->countQueued());
+    {
+        SkAutoLockPixels alp(read);
+        REPORTER_ASSERT(reporter,
+                        SkPreMultiplyColor(SK_ColorBLUE) == *read.getAddr32(5, 5));
+    }
+
+    // clear drops whatever is queued
+    canvas.drawColor(SK_ColorRED);
+    canvas.clear(SK_ColorGREEN);
+    REPORTER_ASSERT(reporter, 0 == device->countQueued());
+
+    // a draw of the device's own pixels sees everything drawn before it
+    canvas.drawColor(SK_ColorRED);
+    SkBitmap self;
+    bm.extractSubset(&self, SkIRect::MakeWH(8, 8));
+    canvas.drawSprite(self, 20, 20, NULL);
+    REPORTER_ASSERT(reporter, 0 == device->countQueued());
+    {
+        SkAutoLockPixels alp(bm);
+        REPORTER_ASSERT(reporter,
+                        SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(22, 22));
+    }
+}
+
+static void TestDeferredDevice(skiatest::Reporter* reporter) {
+    test_scene(reporter, scene_rect_rows, 2);
+    test_scene(reporter, scene_aa_rects, 6);
+    test_scene(reporter, scene_mixed, -1);
+    // just the white rect and the drawPaint are left
+    test_scene(reporter, scene_overdraw, 2);
+    // the row merges, the shuffled column does not
+    test_scene(reporter, scene_sprites, 5);
+    test_scene(reporter, scene_mutated_bitmap, 2);
+    test_flush(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("DeferredDevice", DeferredDeviceTestClass, TestDeferredDevice)
@@ -0,0 +1,130 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkDiscardableMemory.h"
+#include "SkImageEncoder.h"
+#include "SkImageRef_Discardable.h"
+#include "SkStream.h"
+
+static void test_memory(skiatest::Reporter* reporter) {
+    const int N = 64 * 1024;
+    SkDiscardableMemory* mem = SkDiscardableMemory::Create(N * sizeof(int));
+    REPORTER_ASSERT(reporter, NULL != mem);
+    if (NULL == mem) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, mem->size() >= N * sizeof(int));
+
+    // it starts out locked
+    int* data = (int*)mem->data();
+    for (int i = 0; i < N; i++) {
+        data[i] = i;
+    }
+    for (int pass = 0; pass < 3; pass++) {
+        mem->unlock();
+        if (mem->lock()) {
+            // if the lock says the contents are still there, they must be
+            bool same = true;
+            for (int i = 0; i < N; i++) {
+                same = same && data[i] == i;
+            }
+            REPORTER_ASSERT(reporter, same);
+        } else {
+            for (int i = 0; i < N; i++) {
+                data[i] = i;
+            }
+        }
+        REPORTER_ASSERT(reporter, data == mem->data());
+    }
+    SkDELETE(mem);
+}
+
+static const int W = 32;
+static const int H = 32;
+
+static void make_bitmap(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas.drawCircle(SkIntToScalar(W / 2), SkIntToScalar(H / 2),
+                      SkIntToScalar(W / 3), paint);
+}
+
+static SkStream* make_png(const SkBitmap& bm) {
+    SkDynamicMemoryWStream wstream;
+    if (!SkImageEncoder::EncodeStream(&wstream, bm, SkImageEncoder::kPNG_Type,
+                                      100)) {
+        return NULL;
+    }
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream,
+                                        (wstream.getOffset()));
+    wstream.copyTo((void*)stream->getMemoryBase());
+    return stream;
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a);
+    SkAutoLockPixels alpb(b);
+    if (NULL == a.getPixels() || NULL == b.getPixels() ||
+        a.getSize() != b.getSize()) {
+        return false;
+    }
+    return 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void test_imageref(skiatest::Reporter* reporter) {
+    SkBitmap src;
+    make_bitmap(&src);
+    SkStream* stream = make_png(src);
+    REPORTER_ASSERT(reporter, NULL != stream);
+    if (NULL == stream) {
+        return;
+    }
+
+    SkImageRef_Discardable* ref = SkNEW_ARGS(SkImageRef_Discardable,
+                                    (stream, SkBitmap::kARGB_8888_Config));
+    stream->unref();
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm.setPixelRef(ref)->unref();
+    REPORTER_ASSERT(reporter, 0 == ref->getDecodeCount());
+
+    REPORTER_ASSERT(reporter, same_pixels(src, bm));
+    REPORTER_ASSERT(reporter, 1 == ref->getDecodeCount());
+
+    // whether or not the pixels were taken back in between, they come back
+    // the same, and at most one decode later
+    for (int i = 0; i < 3; i++) {
+        int before = ref->getDecodeCount();
+        REPORTER_ASSERT(reporter, same_pixels(src, bm));
+        REPORTER_ASSERT(reporter, ref->getDecodeCount() - before <= 1);
+    }
+}
+
+static void TestDiscardableMemory(skiatest::Reporter* reporter) {
+    test_memory(reporter);
+    test_imageref(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("DiscardableMemory", DiscardableMemoryTestClass,
+                 TestDiscardableMemory)
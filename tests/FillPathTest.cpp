@@ -15,10 +15,13 @@
  */
 
 #include "Test.h"
+#include "SkCanvas.h"
 #include "SkRegion.h"
 #include "SkPath.h"
 #include "SkScan.h"
 #include "SkBlitter.h"
+#include "SkRandom.h"
+#include "SkThreadPool.h"
 
 namespace {
 
@@ -56,5 +59,257 @@ static void TestFillPathInverse(skiatest::Reporter* reporter) {
   REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
 
+static void draw_clipped_circle(SkBitmap* bm, const SkIRect* clip, bool aa) {
+  bm->setConfig(SkBitmap::kA8_Config, 100, 100);
+  bm->allocPixels();
+  bm->eraseColor(0);
+
+  SkCanvas canvas(*bm);
+  if (clip) {
+    SkRect r;
+    r.set(*clip);
+    canvas.clipRect(r);
+  }
+  // a circle made of cubics, most of which are wholly outside of the clip
+  SkPath path;
+  path.addCircle(SkIntToScalar(50), SkIntToScalar(50), SkIntToScalar(45));
+  SkPaint paint;
+  paint.setAntiAlias(aa);
+  canvas.drawPath(path, paint);
+}
+
+// Curves that are culled before the edges are built (e.g. to the left of the
+// clip, which only count for their winding) should draw what the clipper
+// would have.
+static void TestFillPathClipped(skiatest::Reporter* reporter) {
+  const SkIRect clip = SkIRect::MakeLTRB(30, 20, 70, 98);
+  for (int aa = 0; aa <= 1; ++aa) {
+    SkBitmap clipped, whole;
+    draw_clipped_circle(&clipped, &clip, SkToBool(aa));
+    draw_clipped_circle(&whole, NULL, SkToBool(aa));
+
+    int diffs = 0;
+    for (int y = 0; y < 100; ++y) {
+      for (int x = 0; x < 100; ++x) {
+        uint8_t c = *clipped.getAddr8(x, y);
+        if (!clip.contains(x, y)) {
+          REPORTER_ASSERT(reporter, 0 == c);
+        } else if (SkAbs32(c - *whole.getAddr8(x, y)) > 0x40) {
+          diffs += 1;
+        }
+      }
+    }
+    // the curves that cross the clip are chopped differently, which can flip
+    // a few aliased pixels
+    REPORTER_ASSERT(reporter, diffs <= 8);
+  }
+}
+
+static void make_a8(SkBitmap* bm) {
+  bm->setConfig(SkBitmap::kA8_Config, 100, 100);
+  bm->allocPixels();
+  bm->eraseColor(0);
+}
+
+static void add_triangle(SkPath* path, int col, int row) {
+  SkScalar x = SkIntToScalar(col * 5) + SkFloatToScalar(0.3f);
+  SkScalar y = SkIntToScalar(row * 5) + SkFloatToScalar(0.6f);
+  path->moveTo(x, y);
+  path->lineTo(x + SkFloatToScalar(3.7f), y + SkFloatToScalar(1.2f));
+  path->lineTo(x + SkFloatToScalar(1.1f), y + SkFloatToScalar(3.4f));
+  path->close();
+}
+
+// A path with enough edges to be walked in buckets should draw the same as
+// its parts drawn one at a time (which have few edges each).
+static void TestFillPathManyEdges(skiatest::Reporter* reporter) {
+  SkPath all;
+  for (int row = 0; row < 20; ++row) {
+    for (int col = 0; col < 20; ++col) {
+      add_triangle(&all, col, row);
+    }
+  }
+
+  for (int aa = 0; aa <= 1; ++aa) {
+    SkPaint paint;
+    paint.setAntiAlias(SkToBool(aa));
+
+    SkBitmap together, apart;
+    make_a8(&together);
+    make_a8(&apart);
+    {
+      SkCanvas canvas(together);
+      canvas.drawPath(all, paint);
+    }
+    {
+      SkCanvas canvas(apart);
+      // a row at a time, as wide as the whole path is, so that antialiasing
+      // is done the same way
+      for (int row = 0; row < 20; ++row) {
+        SkPath some;
+        for (int col = 0; col < 20; ++col) {
+          add_triangle(&some, col, row);
+        }
+        canvas.drawPath(some, paint);
+      }
+    }
+    REPORTER_ASSERT(reporter, 0 == memcmp(together.getPixels(),
+                                          apart.getPixels(),
+                                          together.getSize()));
+  }
+
+  // and the inverse fill covers the rest
+  SkBitmap filled, inverse;
+  make_a8(&filled);
+  make_a8(&inverse);
+  {
+    SkCanvas canvas(filled);
+    canvas.drawPath(all, SkPaint());
+  }
+  all.setFillType(SkPath::kInverseWinding_FillType);
+  {
+    SkCanvas canvas(inverse);
+    canvas.drawPath(all, SkPaint());
+  }
+  for (int y = 0; y < 100; ++y) {
+    for (int x = 0; x < 100; ++x) {
+      REPORTER_ASSERT(reporter,
+                      0xFF == (*filled.getAddr8(x, y) ^ *inverse.getAddr8(x, y)));
+    }
+  }
+}
+
+static const int kBandSize = 400;
+
+// a warped grid of tiles, each its own contour, so that the tiles' edges
+// are each shared by two of them
+static void make_mesh(SkPath* path) {
+  const int n = 12;
+  SkPoint pts[n + 1][n + 1];
+  for (int j = 0; j <= n; ++j) {
+    for (int i = 0; i <= n; ++i) {
+      SkScalar x = SkIntToScalar(i * 30 + 10) + SkIntToScalar(j * 3) / 7;
+      SkScalar y = SkIntToScalar(j * 30 + 12) + SkIntToScalar(i * i) / 11;
+      pts[j][i].set(x, y);
+    }
+  }
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      path->moveTo(pts[j][i]);
+      path->lineTo(pts[j][i + 1]);
+      path->lineTo(pts[j + 1][i + 1]);
+      path->lineTo(pts[j + 1][i]);
+      path->close();
+    }
+  }
+}
+
+static SkScalar rand_coord(SkRandom* rand) {
+  return SkScalarMul(rand->nextUScalar1(), SkIntToScalar(kBandSize));
+}
+
+// a tangle of lines and curves that cross each other all over
+static void make_tangle(SkPath* path, int count) {
+  SkRandom rand;
+  path->moveTo(SkIntToScalar(kBandSize / 2), 0);
+  for (int i = 0; i < count; ++i) {
+    SkScalar x = rand_coord(&rand);
+    SkScalar y = rand_coord(&rand);
+    switch (i % 3) {
+      case 0:
+        path->lineTo(x, y);
+        break;
+      case 1:
+        path->quadTo(rand_coord(&rand),
+                     rand_coord(&rand), x, y);
+        break;
+      default:
+        path->cubicTo(rand_coord(&rand),
+                      rand_coord(&rand),
+                      rand_coord(&rand),
+                      rand_coord(&rand), x, y);
+        break;
+    }
+  }
+  path->close();
+  path->addCircle(SkIntToScalar(200), SkIntToScalar(200), SkIntToScalar(150));
+}
+
+// overlapping diamonds, whose edges cross each other right on the centers of
+// (super)scanlines, where the lines' X can't tell which is first
+static void make_diamonds(SkPath* path, SkScalar fractionY) {
+  for (int i = 0; i < 40; ++i) {
+    SkScalar cx = SkIntToScalar(60 + (i * 37) % 280);
+    SkScalar cy = SkIntToScalar(60 + (i * 53) % 280) + fractionY;
+    SkScalar r = SkIntToScalar(20 + (i * 13) % 40);
+    path->moveTo(cx, cy - r);
+    path->lineTo(cx + r, cy);
+    path->lineTo(cx, cy + r);
+    path->lineTo(cx - r, cy);
+    path->close();
+  }
+}
+
+static void draw_in_bands(SkBitmap* bm, const SkPath& path,
+                          const SkPaint& paint, const SkRegion* clip,
+                          SkExecutor* executor) {
+  bm->setConfig(SkBitmap::kARGB_8888_Config, kBandSize, kBandSize);
+  bm->allocPixels();
+  bm->eraseColor(0);
+  SkCanvas canvas(*bm);
+  canvas.setExecutor(executor);
+  if (clip) {
+    canvas.clipRegion(*clip);
+  }
+  canvas.drawPath(path, paint);
+}
+
+// Filling a big path in bands on other threads draws the same as filling it
+// on one.
+static void TestFillPathInBands(skiatest::Reporter* reporter) {
+  SkThreadPool pool(3);
+
+  SkPath paths[5];
+  make_mesh(&paths[0]);
+  make_tangle(&paths[1], 30);     // walked in a list
+  make_tangle(&paths[2], 300);    // walked in buckets
+  make_diamonds(&paths[3], SK_ScalarHalf);             // for aliased fills
+  make_diamonds(&paths[4], SkFloatToScalar(0.125f));   // and antialiased
+
+  SkRegion clips[2];
+  clips[0].setRect(5, 20, 390, 380);
+  clips[1].setRect(0, 0, 250, 150);
+  clips[1].op(SkIRect::MakeLTRB(100, 100, 400, 400), SkRegion::kUnion_Op);
+
+  for (size_t i = 0; i < SK_ARRAY_COUNT(paths); ++i) {
+    for (int aa = 0; aa <= 1; ++aa) {
+      for (int evenOdd = 0; evenOdd <= 1; ++evenOdd) {
+        for (int c = -1; c < (int)SK_ARRAY_COUNT(clips); ++c) {
+          const SkRegion* clip = c < 0 ? NULL : &clips[c];
+          SkPaint paint;
+          paint.setAntiAlias(SkToBool(aa));
+          paint.setColor(0x80336699);
+          paths[i].setFillType(evenOdd ? SkPath::kEvenOdd_FillType :
+                                         SkPath::kWinding_FillType);
+
+          SkBitmap serial, banded;
+          draw_in_bands(&serial, paths[i], paint, clip, NULL);
+          draw_in_bands(&banded, paths[i], paint, clip, &pool);
+          REPORTER_ASSERT(reporter, 0 == memcmp(serial.getPixels(),
+                                                banded.getPixels(),
+                                                serial.getSize()));
+        }
+      }
+    }
+  }
+}
+
+static void TestFillPath(skiatest::Reporter* reporter) {
+  TestFillPathInverse(reporter);
+  TestFillPathClipped(reporter);
+  TestFillPathManyEdges(reporter);
+  TestFillPathInBands(reporter);
+}
+
 #include "TestClassDef.h"
-DEFINE_TESTCLASS("FillPath", FillPathTestClass, TestFillPathInverse)
+DEFINE_TESTCLASS("FillPath", FillPathTestClass, TestFillPath)
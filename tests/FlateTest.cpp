@@ -90,8 +90,75 @@ static void TestFlate(skiatest::Reporter* reporter, SkMemoryStream* testStream,
                                      testData.getLength()) == 0);
 }
 
+#ifdef SK_ZLIB_INCLUDE
+static bool inflates_to(SkDynamicMemoryWStream* compressed,
+                        const SkMemoryStream& expected) {
+    SkAutoDataUnref data(compressed->detachAsData());
+    SkMemoryStream src(data.data(), data.size());
+    SkDynamicMemoryWStream uncompressed;
+    if (!SkFlate::Inflate(&src, &uncompressed)) {
+        return false;
+    }
+    SkAutoDataUnref result(uncompressed.detachAsData());
+    return expected.getLength() == result.size() &&
+           !memcmp(expected.getMemoryBase(), result.data(), result.size());
+}
+
+// one deflater, used over and over, and fed a piece at a time
+static void TestDeflater(skiatest::Reporter* reporter) {
+    const size_t N = 10240;
+    SkMemoryStream testData(N);
+    uint8_t* data = (uint8_t*)testData.getMemoryBase();
+    for (size_t i = 0; i < N; i++) {
+        data[i] = (i / 100) & 0xFF;    // runs, so that there's a saving
+    }
+
+    static const struct {
+        int                     fLevel;
+        SkDeflater::Strategy    fStrategy;
+    } gRec[] = {
+        { SkDeflater::kDefault_Level, SkDeflater::kDefault_Strategy },
+        { SkDeflater::kFast_Level, SkDeflater::kDefault_Strategy },
+        { SkDeflater::kBest_Level, SkDeflater::kFiltered_Strategy },
+        { SkDeflater::kFast_Level, SkDeflater::kRLE_Strategy },
+        { SkDeflater::kNone_Level, SkDeflater::kDefault_Strategy },
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+        SkDeflater deflater(gRec[i].fLevel, gRec[i].fStrategy);
+        for (int times = 0; times < 3; times++) {
+            SkDynamicMemoryWStream compressed;
+            REPORTER_ASSERT(reporter, deflater.begin(&compressed));
+            for (size_t offset = 0; offset < N; offset += 1000) {
+                size_t size = SkMin32(1000, N - offset);
+                REPORTER_ASSERT(reporter, deflater.write(data + offset, size));
+            }
+            REPORTER_ASSERT(reporter, deflater.finish());
+            if (gRec[i].fLevel != SkDeflater::kNone_Level) {
+                REPORTER_ASSERT(reporter, compressed.getOffset() < N / 4);
+            }
+            REPORTER_ASSERT(reporter, inflates_to(&compressed, testData));
+        }
+
+        // a whole stream at once, even one that doesn't know its size
+        SkZeroSizeMemStream src;
+        src.setMemory(data, N);
+        SkDynamicMemoryWStream compressed;
+        REPORTER_ASSERT(reporter, deflater.deflate(&src, &compressed));
+        REPORTER_ASSERT(reporter, inflates_to(&compressed, testData));
+    }
+
+    // writes outside of begin() and finish() are refused
+    SkDeflater deflater;
+    REPORTER_ASSERT(reporter, !deflater.write(data, 10));
+    REPORTER_ASSERT(reporter, !deflater.finish());
+}
+#endif
+
 static void TestFlateCompression(skiatest::Reporter* reporter) {
     TestFlate(reporter, NULL, 0);
+#ifdef SK_ZLIB_INCLUDE
+    TestDeflater(reporter);
+#endif
 #if defined(SK_ZLIB_INCLUDE) && !defined(SK_DEBUG)
     REPORTER_ASSERT(reporter, SkFlate::HaveFlate());
 
@@ -0,0 +1,72 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkBlurMaskFilter.h"
+#include "SkFlattenable.h"
+
+namespace {
+
+class DummyFlattenable : public SkFlattenable {
+public:
+    virtual Factory getFactory() { return NULL; }
+};
+
+}
+
+static SkFlattenable* CreateA(SkFlattenableReadBuffer&) {
+    return SkNEW(DummyFlattenable);
+}
+
+static SkFlattenable* CreateB(SkFlattenableReadBuffer&) {
+    return SkNEW(DummyFlattenable);
+}
+
+static void TestFlattenable(skiatest::Reporter* reporter) {
+    // something registered at startup is found both ways
+    SkFlattenable* blur = SkBlurMaskFilter::Create(SkIntToScalar(3),
+                                    SkBlurMaskFilter::kNormal_BlurStyle);
+    SkFlattenable::Factory fact = blur->getFactory();
+    const char* name = SkFlattenable::FactoryToName(fact);
+    REPORTER_ASSERT(reporter, NULL != name);
+    REPORTER_ASSERT(reporter, fact == SkFlattenable::NameToFactory(name));
+    blur->unref();
+
+    REPORTER_ASSERT(reporter, NULL == SkFlattenable::NameToFactory("Sk"));
+    REPORTER_ASSERT(reporter, NULL == SkFlattenable::NameToFactory(
+                                            "FlattenableTestUnregistered"));
+    REPORTER_ASSERT(reporter, NULL == SkFlattenable::FactoryToName(CreateA));
+
+    // the registry stays sorted as names come in after startup, and
+    // registering a name again replaces its factory
+    SkFlattenable::Register("FlattenableTestB", CreateB);
+    SkFlattenable::Register("FlattenableTestA", CreateA);
+    REPORTER_ASSERT(reporter,
+                    CreateA == SkFlattenable::NameToFactory("FlattenableTestA"));
+    REPORTER_ASSERT(reporter,
+                    CreateB == SkFlattenable::NameToFactory("FlattenableTestB"));
+    REPORTER_ASSERT(reporter, !strcmp("FlattenableTestA",
+                                      SkFlattenable::FactoryToName(CreateA)));
+    REPORTER_ASSERT(reporter, fact == SkFlattenable::NameToFactory(name));
+
+    SkFlattenable::Register("FlattenableTestA", CreateB);
+    REPORTER_ASSERT(reporter,
+                    CreateB == SkFlattenable::NameToFactory("FlattenableTestA"));
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Flattenable", FlattenableTestClass, TestFlattenable)
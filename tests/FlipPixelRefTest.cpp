@@ -0,0 +1,151 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkFlipPixelRef.h"
+#include "SkPageFlipper.h"
+#include "SkRandom.h"
+
+static void test_flipper(skiatest::Reporter* reporter) {
+    const SkIRect a = SkIRect::MakeLTRB(0, 0, 10, 10);
+    const SkIRect b = SkIRect::MakeLTRB(20, 0, 30, 10);
+    const SkIRect c = SkIRect::MakeLTRB(40, 0, 50, 10);
+    SkRegion copyBits;
+    SkRegion allButA(SkIRect::MakeWH(64, 16));
+    allButA.op(a, SkRegion::kDifference_Op);
+
+    // with two pages, the back page is missing the last update
+    SkPageFlipper two(64, 16);
+    REPORTER_ASSERT(reporter, 2 == two.pageCount());
+    two.inval();
+    two.update(&copyBits);
+    REPORTER_ASSERT(reporter, copyBits.isEmpty());
+    two.inval(a);
+    REPORTER_ASSERT(reporter, two.update(&copyBits) == SkRegion(a));
+    REPORTER_ASSERT(reporter, copyBits == allButA);
+    two.inval(b);
+    two.update(&copyBits);
+    REPORTER_ASSERT(reporter, copyBits == SkRegion(a));
+
+    // with three, it is missing the last two
+    SkPageFlipper three(64, 16, 3);
+    REPORTER_ASSERT(reporter, 3 == three.pageCount());
+    three.inval();
+    three.update(&copyBits);
+    REPORTER_ASSERT(reporter, copyBits.isEmpty());
+    three.inval(a);
+    three.update(&copyBits);
+    REPORTER_ASSERT(reporter, copyBits == allButA);
+    three.inval(b);
+    three.update(&copyBits);
+    SkRegion expected(SkIRect::MakeWH(64, 16));
+    expected.op(b, SkRegion::kDifference_Op);
+    REPORTER_ASSERT(reporter, copyBits == expected);
+    three.inval(c);
+    three.update(&copyBits);
+    expected.setRect(a);
+    expected.op(b, SkRegion::kUnion_Op);
+    REPORTER_ASSERT(reporter, copyBits == expected);
+    // and never anything that is about to be drawn again
+    three.inval(b);
+    three.update(&copyBits);
+    REPORTER_ASSERT(reporter, copyBits == SkRegion(c));
+}
+
+static void random_rect(SkRandom* rand, int width, int height, SkIRect* r) {
+    int x = rand->nextU() % width;
+    int y = rand->nextU() % height;
+    r->setXYWH(x, y, 1 + rand->nextU() % (width - x),
+               1 + rand->nextU() % ((height - y + 1) / 2));
+}
+
+// draws something different into each pixel of dirty, for each frame
+static void draw_frame(SkBitmap* bm, const SkRegion& dirty, int frame) {
+    SkCanvas canvas(*bm);
+    canvas.clipRegion(dirty);
+    canvas.drawColor(SkColorSetARGB(0xFF, (frame * 37) & 0xFF,
+                                    (frame * 59) & 0xFF, 0x80));
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SkColorSetARGB(0xFF, 0x80, (frame * 23) & 0xFF,
+                                  (frame * 71) & 0xFF));
+    canvas.drawCircle(SkIntToScalar(frame % 40), SkIntToScalar(frame % 24),
+                      SkIntToScalar(9), paint);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a);
+    SkAutoLockPixels alpb(b);
+    const size_t bytes = a.width() * a.bytesPerPixel();
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), bytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*  Drawing each frame's dirty region into the back page has to leave the
+    front page with the same pixels as drawing all of them into one bitmap.
+ */
+static void test_pixelref(skiatest::Reporter* reporter,
+                          SkBitmap::Config config, int width, int height,
+                          int pageCount) {
+    SkFlipPixelRef* ref = SkNEW_ARGS(SkFlipPixelRef,
+                                     (config, width, height, pageCount));
+    SkBitmap front;
+    front.setConfig(config, width, height);
+    front.setPixelRef(ref)->unref();
+
+    SkBitmap expected;
+    expected.setConfig(config, width, height);
+    expected.allocPixels();
+
+    SkRandom rand;
+    ref->inval();
+    for (int frame = 0; frame < 40; frame++) {
+        if (frame > 0) {
+            SkIRect r;
+            for (int i = rand.nextU() % 4; i >= 0; i--) {
+                random_rect(&rand, width, height, &r);
+                ref->inval(r);
+            }
+        }
+        SkRegion dirty;
+        {
+            SkAutoFlipUpdate update(ref);
+            dirty = update.dirty();
+            SkBitmap back(update.bitmap());
+            draw_frame(&back, dirty, frame);
+        }
+        draw_frame(&expected, dirty, frame);
+        REPORTER_ASSERT(reporter, equal_pixels(front, expected));
+    }
+}
+
+static void TestFlipPixelRef(skiatest::Reporter* reporter) {
+    test_flipper(reporter);
+    for (int pages = 2; pages <= SkPageFlipper::kMaxPages; pages++) {
+        test_pixelref(reporter, SkBitmap::kARGB_8888_Config, 64, 40, pages);
+        test_pixelref(reporter, SkBitmap::kARGB_8888_Config, 37, 23, pages);
+        test_pixelref(reporter, SkBitmap::kRGB_565_Config, 45, 30, pages);
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("FlipPixelRef", FlipPixelRefTestClass, TestFlipPixelRef)
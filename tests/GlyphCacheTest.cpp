@@ -0,0 +1,291 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkGlyphCache.h"
+#include "SkGraphics.h"
+#include "SkOSFile.h"
+#include "SkTemplates.h"
+#include "SkThreadPool.h"
+#include "SkUtils.h"
+
+namespace {
+
+// draws text at a handful of sizes, so that several strikes (spread across
+// the cache's shards) are in use at once
+class TextRunnable : public SkRunnable {
+public:
+    TextRunnable(int seed) : fSeed(seed) {}
+
+    virtual void run() {
+        SkBitmap bm;
+        bm.setConfig(SkBitmap::kARGB_8888_Config, 64, 64);
+        bm.allocPixels();
+        SkCanvas canvas(bm);
+
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 20; i++) {
+            paint.setTextSize(SkIntToScalar(8 + (fSeed + i) % 16));
+            canvas.drawText("Hamburgefons", 12, 0, SkIntToScalar(32), paint);
+        }
+    }
+
+private:
+    int fSeed;
+};
+
+}
+
+// Enough distinct glyphs that the strike has to grow its hash tables several
+// times; the advances must not depend on whether they came from the tables.
+static void test_many_glyphs(skiatest::Reporter* reporter) {
+    const int N = 3000;
+    SkAutoTMalloc<uint16_t> glyphs(N);
+    for (int i = 0; i < N; i++) {
+        glyphs.get()[i] = (uint16_t)i;
+    }
+
+    SkPaint paint;
+    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    paint.setTextSize(SkIntToScalar(13));
+
+    SkAutoTMalloc<SkScalar> first(N);
+    SkAutoTMalloc<SkScalar> second(N);
+    paint.getTextWidths(glyphs.get(), N * sizeof(uint16_t), first.get());
+    paint.getTextWidths(glyphs.get(), N * sizeof(uint16_t), second.get());
+    REPORTER_ASSERT(reporter, !memcmp(first.get(), second.get(),
+                                      N * sizeof(SkScalar)));
+
+    for (int i = 0; i < N; i += 97) {
+        SkScalar width;
+        paint.getTextWidths(&glyphs.get()[i], sizeof(uint16_t), &width);
+        REPORTER_ASSERT(reporter, first.get()[i] == width);
+    }
+}
+
+// ASCII and Latin-1 measure through the strike's advance table, and the rest
+// through the cache; both must agree with measuring the glyphs one by one
+static void test_advance_table(skiatest::Reporter* reporter) {
+    // "Caf\u00e9 \u2014 na\u00efve text" in UTF-8
+    static const char gText[] = "Caf\xC3\xA9 \xE2\x80\x94 na\xC3\xAFve text";
+    const size_t len = strlen(gText);
+
+    SkPaint paint;
+    paint.setTextSize(SkIntToScalar(15));
+
+    const int count = paint.countText(gText, len);
+    SkAutoTMalloc<SkScalar> widths(count);
+    REPORTER_ASSERT(reporter,
+                    count == paint.getTextWidths(gText, len, widths.get()));
+    SkScalar sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += widths.get()[i];
+    }
+
+    // once to fill the table, once to read it back
+    SkScalar first = paint.measureText(gText, len);
+    SkScalar second = paint.measureText(gText, len);
+    REPORTER_ASSERT(reporter, first == second);
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(first, sum));
+
+    SkAutoTMalloc<uint16_t> utf16(len);
+    size_t units = 0;
+    for (const char* ptr = gText; *ptr;) {
+        units += SkUTF16_FromUnichar(SkUTF8_NextUnichar(&ptr),
+                                     utf16.get() + units);
+    }
+    SkPaint paint16(paint);
+    paint16.setTextEncoding(SkPaint::kUTF16_TextEncoding);
+    REPORTER_ASSERT(reporter,
+                    first == paint16.measureText(utf16.get(), units * 2));
+
+    SkAutoTMalloc<uint16_t> glyphs(count);
+    paint.textToGlyphs(gText, len, glyphs.get());
+    SkPaint paintGlyph(paint);
+    paintGlyph.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    REPORTER_ASSERT(reporter,
+                    first == paintGlyph.measureText(glyphs.get(), count * 2));
+
+    // breaking at the full width keeps everything, and a little less doesn't
+    SkScalar measured;
+    REPORTER_ASSERT(reporter, len == paint.breakText(gText, len, first,
+                                                     &measured));
+    REPORTER_ASSERT(reporter, measured == first);
+    size_t part = paint.breakText(gText, len, first - SK_Scalar1 / 2,
+                                  &measured);
+    REPORTER_ASSERT(reporter, part < len && measured < first);
+    REPORTER_ASSERT(reporter, measured == paint.measureText(gText, part));
+}
+
+static bool equal_glyphs(const SkGlyph& a, const SkGlyph& b) {
+    if (a.fID != b.fID || a.fAdvanceX != b.fAdvanceX ||
+            a.fAdvanceY != b.fAdvanceY || a.fWidth != b.fWidth ||
+            a.fHeight != b.fHeight || a.fTop != b.fTop ||
+            a.fLeft != b.fLeft || a.fMaskFormat != b.fMaskFormat) {
+        return false;
+    }
+    if (NULL == a.fImage || NULL == b.fImage) {
+        return a.fImage == b.fImage;
+    }
+    return !memcmp(a.fImage, b.fImage, a.computeImageSize());
+}
+
+// The batch lookup must produce the same glyphs as one-at-a-time lookups.
+static void test_batch(skiatest::Reporter* reporter) {
+    const int N = 100;
+    uint16_t glyphIDs[N];
+    for (int i = 0; i < N; i++) {
+        // include some duplicates
+        glyphIDs[i] = (uint16_t)(i * 7 % 60);
+    }
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(17));
+    SkAutoGlyphCache batchCache(paint, NULL);
+    const SkGlyph* glyphs[N];
+    batchCache.getCache()->getGlyphIDMetrics(glyphIDs, N, glyphs, true);
+
+    // a second detach gives us a separate strike for the same descriptor
+    SkAutoGlyphCache singleCache(paint, NULL);
+    REPORTER_ASSERT(reporter, singleCache.getCache() != batchCache.getCache());
+    for (int i = 0; i < N; i++) {
+        SkGlyphCache* cache = singleCache.getCache();
+        const SkGlyph& glyph = cache->getGlyphIDMetrics(glyphIDs[i]);
+        cache->findImage(glyph);
+        REPORTER_ASSERT(reporter, equal_glyphs(glyph, *glyphs[i]));
+    }
+}
+
+static void draw_text(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 200, 40);
+    bm->allocPixels();
+    bm->eraseColor(0);
+
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(23));
+    canvas.drawText("Hamburgefons", 12, 0, SkIntToScalar(30), paint);
+}
+
+// Text hands its glyphs to the blitter in batches, which have to draw what one
+// glyph at a time does, across batches and against the clip.
+static void test_glyph_runs(skiatest::Reporter* reporter) {
+    static const char gText[] = "Hamburgefons";
+    const int N = 80;
+    char text[N];
+    SkPoint pos[N];
+    for (int i = 0; i < N; i++) {
+        text[i] = gText[i % 12];
+        pos[i].set(SkIntToScalar(i % 40 * 5), SkIntToScalar(20 + i / 40 * 20));
+    }
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(13));
+    paint.setColor(0xFF336699);
+
+    SkBitmap batched, single;
+    for (int i = 0; i < 2; i++) {
+        SkBitmap* bm = i ? &single : &batched;
+        bm->setConfig(SkBitmap::kARGB_8888_Config, 200, 50);
+        bm->allocPixels();
+        bm->eraseColor(0);
+
+        SkCanvas canvas(*bm);
+        canvas.clipRect(SkRect::MakeLTRB(SkIntToScalar(7), SkIntToScalar(14),
+                                         SkIntToScalar(191),
+                                         SkIntToScalar(33)));
+        if (i) {
+            for (int j = 0; j < N; j++) {
+                canvas.drawText(&text[j], 1, pos[j].fX, pos[j].fY, paint);
+            }
+        } else {
+            canvas.drawPosText(text, N, pos, paint);
+        }
+    }
+
+    SkAutoLockPixels alp0(batched);
+    SkAutoLockPixels alp1(single);
+    REPORTER_ASSERT(reporter, !memcmp(batched.getPixels(), single.getPixels(),
+                                      batched.getSize()));
+}
+
+static int remove_strike_files(const char dir[]) {
+    int count = 0;
+    SkOSFile::Iter iter(dir, ".skglyphs");
+    SkString name;
+    while (iter.next(&name)) {
+        SkString path(dir);
+        path.append("/");
+        path.append(name);
+        remove(path.c_str());
+        count += 1;
+    }
+    return count;
+}
+
+// A strike that was purged to disk must draw the same when read back.
+static void test_disk_cache(skiatest::Reporter* reporter) {
+    const char* dir = ".";
+    remove_strike_files(dir);
+    SkGraphics::SetFontCacheUsed(0);
+    SkGraphics::SetGlyphDiskCacheDir(dir);
+
+    SkBitmap expected, actual;
+    draw_text(&expected);
+    // purging writes the strike
+    SkGraphics::SetFontCacheUsed(0);
+    draw_text(&actual);
+    SkGraphics::SetFontCacheUsed(0);
+
+    SkGraphics::SetGlyphDiskCacheDir(NULL);
+    REPORTER_ASSERT(reporter, remove_strike_files(dir) > 0);
+
+    SkAutoLockPixels alp0(expected);
+    SkAutoLockPixels alp1(actual);
+    REPORTER_ASSERT(reporter, !memcmp(expected.getPixels(), actual.getPixels(),
+                                      expected.getSize()));
+}
+
+static void TestGlyphCache(skiatest::Reporter* reporter) {
+    test_many_glyphs(reporter);
+    test_advance_table(reporter);
+    test_batch(reporter);
+    test_glyph_runs(reporter);
+    test_disk_cache(reporter);
+
+    SkThreadPool pool(4);
+    SkTDArray<TextRunnable*> runnables;
+    for (int i = 0; i < 16; i++) {
+        *runnables.append() = new TextRunnable(i);
+        pool.add(runnables[i]);
+    }
+    pool.wait();
+    runnables.deleteAll();
+
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheUsed() > 0);
+
+    // purging to zero must empty every shard
+    SkGraphics::SetFontCacheUsed(0);
+    REPORTER_ASSERT(reporter, 0 == SkGraphics::GetFontCacheUsed());
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("GlyphCache", GlyphCacheTestClass, TestGlyphCache)
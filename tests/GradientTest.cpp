@@ -0,0 +1,172 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkGradientShader.h"
+#include "SkPixelRef.h"
+#include "SkUnitMappers.h"
+
+static SkShader* make_gradient(SkUnitMapper* mapper) {
+    SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(100), 0 } };
+    SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    SkScalar pos[] = { 0, SK_Scalar1 / 4, SK_Scalar1 };
+    return SkGradientShader::CreateLinear(pts, colors, pos, 3,
+                                          SkShader::kClamp_TileMode, mapper);
+}
+
+static void draw(SkShader* shader, U8CPU alpha, SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 100, 10);
+    bm->allocPixels();
+    bm->eraseColor(0);
+
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    paint.setShader(shader);
+    paint.setAlpha(alpha);
+    canvas.drawPaint(paint);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static SkPixelRef* table_of(SkShader* shader) {
+    SkBitmap bm;
+    shader->asABitmap(&bm, NULL, NULL, NULL);
+    return bm.pixelRef();
+}
+
+// equal gradients (with distinct but equal mappers) share one color table
+static void test_shared_table(skiatest::Reporter* reporter) {
+    SkUnitMapper* mapper0 = new SkDiscreteMapper(6);
+    SkUnitMapper* mapper1 = new SkDiscreteMapper(6);
+    SkShader* s0 = make_gradient(mapper0);
+    SkShader* s1 = make_gradient(mapper1);
+    mapper0->unref();
+    mapper1->unref();
+
+    SkBitmap bm0, bm1;
+    draw(s0, 0xFF, &bm0);
+    draw(s1, 0xFF, &bm1);
+    REPORTER_ASSERT(reporter, equal_pixels(bm0, bm1));
+    REPORTER_ASSERT(reporter, table_of(s0) == table_of(s1));
+
+    // a different alpha needs its own table, but must still draw the same
+    // as an unshared shader with that alpha
+    SkPixelRef* opaqueTable = table_of(s0);
+    opaqueTable->ref();
+    draw(s0, 0x80, &bm0);
+    REPORTER_ASSERT(reporter, table_of(s0) != opaqueTable);
+    draw(s1, 0x80, &bm1);
+    REPORTER_ASSERT(reporter, equal_pixels(bm0, bm1));
+    REPORTER_ASSERT(reporter, table_of(s0) == table_of(s1));
+
+    // and going back to the opaque alpha finds the original table again
+    draw(s0, 0xFF, &bm0);
+    REPORTER_ASSERT(reporter, table_of(s0) == opaqueTable);
+    opaqueTable->unref();
+
+    // a different mapper must not share
+    SkUnitMapper* mapper2 = new SkDiscreteMapper(7);
+    SkShader* s2 = make_gradient(mapper2);
+    mapper2->unref();
+    draw(s2, 0xFF, &bm1);
+    draw(s0, 0xFF, &bm0);
+    REPORTER_ASSERT(reporter, !equal_pixels(bm0, bm1));
+    REPORTER_ASSERT(reporter, table_of(s0) != table_of(s2));
+
+    s0->unref();
+    s1->unref();
+    s2->unref();
+}
+
+typedef SkShader* (*GradientProc)(const SkPoint pts[2], const SkColor colors[],
+                                  int count);
+
+static SkShader* make_linear(const SkPoint pts[2], const SkColor colors[],
+                             int count) {
+    return SkGradientShader::CreateLinear(pts, colors, NULL, count,
+                                          SkShader::kClamp_TileMode);
+}
+
+static SkShader* make_radial(const SkPoint pts[2], const SkColor colors[],
+                             int count) {
+    return SkGradientShader::CreateRadial(pts[0], pts[1].fX, colors, NULL,
+                                          count, SkShader::kClamp_TileMode);
+}
+
+static SkShader* make_sweep(const SkPoint pts[2], const SkColor colors[],
+                            int count) {
+    return SkGradientShader::CreateSweep(pts[0].fX, pts[0].fY, colors, NULL,
+                                         count);
+}
+
+static SkShader* make_two_point(const SkPoint pts[2], const SkColor colors[],
+                                int count) {
+    return SkGradientShader::CreateTwoPointRadial(pts[0], SkIntToScalar(5),
+                                                  pts[1], SkIntToScalar(50),
+                                                  colors, NULL, count,
+                                                  SkShader::kClamp_TileMode);
+}
+
+// the bitmap handed to the gpu only depends on the colors, so that shaders
+// rebuilt every frame keep hitting the same texture
+static void test_shared_bitmap(skiatest::Reporter* reporter) {
+    static const GradientProc gProcs[] = {
+        make_linear, make_radial, make_sweep, make_two_point
+    };
+    const SkPoint pts0[] = { { 0, 0 }, { SkIntToScalar(100), 0 } };
+    const SkPoint pts1[] = { { SkIntToScalar(20), SkIntToScalar(30) },
+                             { SkIntToScalar(60), SkIntToScalar(40) } };
+    const SkColor colors0[] = { SK_ColorRED, SK_ColorBLUE };
+    const SkColor colors1[] = { SK_ColorRED, SK_ColorGREEN };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gProcs); i++) {
+        SkShader* s0 = gProcs[i](pts0, colors0, 2);
+        SkShader* s1 = gProcs[i](pts1, colors0, 2);
+        SkShader* s2 = gProcs[i](pts0, colors1, 2);
+
+        SkBitmap bm;
+        draw(s0, 0xFF, &bm);
+        draw(s1, 0xFF, &bm);
+        draw(s2, 0xFF, &bm);
+
+        SkBitmap bm0, bm1, bm2;
+        s0->asABitmap(&bm0, NULL, NULL, NULL);
+        s1->asABitmap(&bm1, NULL, NULL, NULL);
+        s2->asABitmap(&bm2, NULL, NULL, NULL);
+        REPORTER_ASSERT(reporter, bm0.pixelRef() == bm1.pixelRef());
+        REPORTER_ASSERT(reporter,
+                        bm0.getGenerationID() == bm1.getGenerationID());
+        REPORTER_ASSERT(reporter,
+                        bm0.getGenerationID() != bm2.getGenerationID());
+
+        s0->unref();
+        s1->unref();
+        s2->unref();
+    }
+}
+
+static void TestGradients(skiatest::Reporter* reporter) {
+    test_shared_table(reporter);
+    test_shared_bitmap(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Gradients", GradientsTestClass, TestGradients)
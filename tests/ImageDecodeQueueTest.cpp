@@ -0,0 +1,130 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkImageDecodeQueue.h"
+#include "SkImageEncoder.h"
+#include "SkStream.h"
+
+static const int N = 12;
+
+static void make_bitmap(SkBitmap* bm, int index) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 20 + index, 30 - index);
+    bm->allocPixels();
+    bm->eraseColor(SK_ColorWHITE);
+
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SkColorSetARGB(0xFF, index * 20, 0x80, 0xFF - index * 20));
+    canvas.drawCircle(SkIntToScalar(10), SkIntToScalar(10),
+                      SkIntToScalar(3 + index / 2), paint);
+}
+
+static SkStream* encode_png(const SkBitmap& bm) {
+    SkDynamicMemoryWStream wstream;
+    SkImageEncoder* encoder = SkImageEncoder::Create(SkImageEncoder::kPNG_Type);
+    if (NULL == encoder) {
+        return NULL;
+    }
+    bool success = encoder->encodeStream(&wstream, bm, 100);
+    SkDELETE(encoder);
+    if (!success) {
+        return NULL;
+    }
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream,
+                                        (wstream.getOffset()));
+    wstream.copyTo((void*)stream->getMemoryBase());
+    return stream;
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.width() != b.width() || a.height() != b.height() ||
+            a.config() != b.config()) {
+        return false;
+    }
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y),
+                   a.width() * a.bytesPerPixel())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_queue(skiatest::Reporter* reporter, size_t ramCeiling) {
+    SkBitmap originals[N];
+    SkStream* streams[N];
+    for (int i = 0; i < N; i++) {
+        make_bitmap(&originals[i], i);
+        streams[i] = encode_png(originals[i]);
+        if (NULL == streams[i]) {
+            // no png encoder in this build
+            for (int j = 0; j < i; j++) {
+                streams[j]->unref();
+            }
+            return;
+        }
+    }
+
+    SkImageDecodeQueue::Future* futures[N];
+    SkImageDecodeQueue::Future* garbage;
+    {
+        SkImageDecodeQueue queue(4, ramCeiling);
+        queue.decode(streams, N, futures, SkBitmap::kARGB_8888_Config);
+
+        static const char gNotAnImage[] = "this is not an image";
+        SkMemoryStream notAnImage(gNotAnImage, sizeof(gNotAnImage));
+        garbage = queue.decode(&notAnImage);
+
+        // wait for some of them while the queue is alive, the rest after it
+        // has been deleted
+        for (int i = 0; i < N / 2; i++) {
+            SkBitmap bm;
+            REPORTER_ASSERT(reporter, futures[i]->wait(&bm));
+            REPORTER_ASSERT(reporter, futures[i]->isDone());
+            REPORTER_ASSERT(reporter, equal_pixels(originals[i], bm));
+        }
+        REPORTER_ASSERT(reporter, !garbage->wait());
+    }
+
+    for (int i = N / 2; i < N; i++) {
+        REPORTER_ASSERT(reporter, futures[i]->isDone());
+        SkBitmap bm;
+        REPORTER_ASSERT(reporter, futures[i]->wait(&bm));
+        REPORTER_ASSERT(reporter, equal_pixels(originals[i], bm));
+    }
+
+    for (int i = 0; i < N; i++) {
+        futures[i]->unref();
+        streams[i]->unref();
+    }
+    garbage->unref();
+}
+
+static void TestImageDecodeQueue(skiatest::Reporter* reporter) {
+    // no ceiling
+    test_queue(reporter, 0);
+    // smaller than any one image, so the decodes are done one at a time
+    test_queue(reporter, 16);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ImageDecodeQueue", ImageDecodeQueueTestClass,
+                 TestImageDecodeQueue)
@@ -0,0 +1,126 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkImageEncoder.h"
+#include "SkImageRef_GlobalPool.h"
+#include "SkStream.h"
+
+static const int N = 3;
+static const int W = 32;
+static const int H = 32;
+static const size_t kImageSize = W * H * sizeof(SkPMColor);
+
+static SkStream* make_png(int index) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm.allocPixels();
+    bm.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bm);
+    SkPaint paint;
+    paint.setColor(SkColorSetARGB(0xFF, index * 80, 0, 0xFF - index * 80));
+    canvas.drawCircle(SkIntToScalar(W / 2), SkIntToScalar(H / 2),
+                      SkIntToScalar(4 + index * 4), paint);
+
+    SkDynamicMemoryWStream wstream;
+    if (!SkImageEncoder::EncodeStream(&wstream, bm, SkImageEncoder::kPNG_Type,
+                                      100)) {
+        return NULL;
+    }
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream,
+                                        (wstream.getOffset()));
+    wstream.copyTo((void*)stream->getMemoryBase());
+    return stream;
+}
+
+static bool has_pixels(SkImageRef_GlobalPool* ref, size_t* used) {
+    size_t before = SkImageRef_GlobalPool::GetRAMUsed();
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm.setPixelRef(ref);
+    bm.lockPixels();
+    bool decoded = SkImageRef_GlobalPool::GetRAMUsed() > before;
+    *used = SkImageRef_GlobalPool::GetRAMUsed();
+    bm.unlockPixels();
+    return !decoded;
+}
+
+static void TestImageRefPool(skiatest::Reporter* reporter) {
+    const size_t oldBudget = SkImageRef_GlobalPool::GetRAMBudget();
+    SkImageRef_GlobalPool::SetRAMBudget(0);
+    const size_t base = SkImageRef_GlobalPool::GetRAMUsed();
+
+    SkImageRef_GlobalPool* refs[N];
+    for (int i = 0; i < N; i++) {
+        SkStream* stream = make_png(i);
+        if (NULL == stream) {
+            // no png encoder in this build
+            for (int j = 0; j < i; j++) {
+                refs[j]->unref();
+            }
+            return;
+        }
+        refs[i] = SkNEW_ARGS(SkImageRef_GlobalPool,
+                             (stream, SkBitmap::kARGB_8888_Config));
+        stream->unref();
+    }
+
+    size_t used;
+    for (int i = 0; i < N; i++) {
+        REPORTER_ASSERT(reporter, !has_pixels(refs[i], &used));
+        REPORTER_ASSERT(reporter, base + (i + 1) * kImageSize == used);
+    }
+
+    // purging only takes unlocked pixels
+    SkBitmap locked;
+    locked.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    locked.setPixelRef(refs[1]);
+    locked.lockPixels();
+    SkImageRef_GlobalPool::SetRAMUsed(base);
+    REPORTER_ASSERT(reporter, base + kImageSize ==
+                              SkImageRef_GlobalPool::GetRAMUsed());
+    locked.unlockPixels();
+    locked.reset();
+
+    // a prefetched image is ready when it is locked
+    refs[0]->prefetch();
+    refs[2]->prefetch();
+    SkImageRef_GlobalPool::WaitForPrefetches();
+    REPORTER_ASSERT(reporter, base + 3 * kImageSize ==
+                              SkImageRef_GlobalPool::GetRAMUsed());
+    REPORTER_ASSERT(reporter, has_pixels(refs[0], &used));
+    REPORTER_ASSERT(reporter, has_pixels(refs[2], &used));
+
+    // with a budget, the pool keeps what fits
+    SkImageRef_GlobalPool::SetRAMBudget(base + 2 * kImageSize);
+    REPORTER_ASSERT(reporter, SkImageRef_GlobalPool::GetRAMUsed() <=
+                              base + 2 * kImageSize);
+    for (int i = 0; i < N; i++) {
+        has_pixels(refs[i], &used);
+        REPORTER_ASSERT(reporter, SkImageRef_GlobalPool::GetRAMUsed() <=
+                                  base + 2 * kImageSize);
+    }
+
+    for (int i = 0; i < N; i++) {
+        refs[i]->unref();
+    }
+    REPORTER_ASSERT(reporter, base == SkImageRef_GlobalPool::GetRAMUsed());
+    SkImageRef_GlobalPool::SetRAMBudget(oldBudget);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ImageRefPool", ImageRefPoolTestClass, TestImageRefPool)
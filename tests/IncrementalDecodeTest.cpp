@@ -0,0 +1,214 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkGradientShader.h"
+#include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+
+static SkMemoryStream* make_png(int w, int h) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, w, h);
+    bm.allocPixels();
+
+    SkCanvas canvas(bm);
+    SkPaint paint;
+    SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(w), SkIntToScalar(h) } };
+    SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    paint.setShader(SkGradientShader::CreateLinear(pts, colors, NULL, 3,
+                                        SkShader::kMirror_TileMode))->unref();
+    canvas.drawPaint(paint);
+
+    SkDynamicMemoryWStream wstream;
+    if (!SkImageEncoder::EncodeStream(&wstream, bm, SkImageEncoder::kPNG_Type,
+                                      100)) {
+        return NULL;
+    }
+    SkMemoryStream* stream = SkNEW_ARGS(SkMemoryStream,
+                                        (wstream.getOffset()));
+    wstream.copyTo((void*)stream->getMemoryBase());
+    return stream;
+}
+
+/*  A decoder that does not implement the incremental hooks, for a toy format:
+    a width byte, a height byte, then one gray byte per pixel.
+ */
+class GrayDecoder : public SkImageDecoder {
+protected:
+    virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
+        uint8_t size[2];
+        if (stream->read(size, 2) != 2 || 0 == size[0] || 0 == size[1]) {
+            return false;
+        }
+        bm->setConfig(SkBitmap::kARGB_8888_Config, size[0], size[1]);
+        if (kDecodeBounds_Mode == mode) {
+            return true;
+        }
+        if (!this->allocPixelRef(bm, NULL)) {
+            return false;
+        }
+        SkAutoLockPixels alp(*bm);
+        for (int y = 0; y < bm->height(); y++) {
+            for (int x = 0; x < bm->width(); x++) {
+                uint8_t gray;
+                if (stream->read(&gray, 1) != 1) {
+                    return false;
+                }
+                *bm->getAddr32(x, y) = SkPackARGB32(0xFF, gray, gray, gray);
+            }
+        }
+        return true;
+    }
+};
+
+static const uint8_t gGray[] = {
+    3, 2,
+    0x00, 0x80, 0xFF,
+    0xFF, 0x80, 0x00,
+};
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.width() != b.width() || a.height() != b.height() ||
+            a.config() != b.config()) {
+        return false;
+    }
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y),
+                   a.width() * a.bytesPerPixel())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static SkImageDecoder* create_decoder(const void* data, size_t size) {
+    SkMemoryStream firstBytes(data, size);
+    return SkImageDecoder::Factory(&firstBytes);
+}
+
+// push the data in chunks, checking that the rows only ever increase
+static SkImageDecoder::IncrementalResult push_all(
+                                    skiatest::Reporter* reporter,
+                                    SkImageDecoder* codec, const char* data,
+                                    size_t size, size_t chunk) {
+    SkImageDecoder::IncrementalResult result =
+                                    SkImageDecoder::kPartial_IncrementalResult;
+    int rows = 0;
+    for (size_t offset = 0; offset < size; offset += chunk) {
+        result = codec->pushIncremental(data + offset,
+                                        SkMin32(chunk, size - offset));
+        REPORTER_ASSERT(reporter,
+                        SkImageDecoder::kError_IncrementalResult != result);
+        REPORTER_ASSERT(reporter, codec->incrementalRows() >= rows);
+        rows = codec->incrementalRows();
+    }
+    return result;
+}
+
+static void test_png(skiatest::Reporter* reporter) {
+    SkMemoryStream* stream = make_png(67, 45);
+    if (NULL == stream) {
+        // no png encoder in this build
+        return;
+    }
+    SkAutoUnref aur(stream);
+    const char* data = (const char*)stream->getMemoryBase();
+    const size_t size = stream->getLength();
+
+    for (int sampleSize = 1; sampleSize <= 2; sampleSize++) {
+        SkImageDecoder* codec = create_decoder(data, size);
+        REPORTER_ASSERT(reporter, codec);
+        if (NULL == codec) {
+            return;
+        }
+        SkAutoTDelete<SkImageDecoder> ad(codec);
+        codec->setSampleSize(sampleSize);
+
+        SkBitmap expected;
+        stream->rewind();
+        REPORTER_ASSERT(reporter, codec->decode(stream, &expected,
+                                            SkBitmap::kARGB_8888_Config,
+                                            SkImageDecoder::kDecodePixels_Mode));
+
+        // all of it at once
+        codec->beginIncremental(SkBitmap::kARGB_8888_Config);
+        REPORTER_ASSERT(reporter, SkImageDecoder::kComplete_IncrementalResult ==
+                                  codec->pushIncremental(data, size));
+        REPORTER_ASSERT(reporter, SkImageDecoder::kComplete_IncrementalResult ==
+                                  codec->endIncremental());
+        REPORTER_ASSERT(reporter, equal_pixels(expected,
+                                               codec->incrementalBitmap()));
+
+        // a few bytes at a time
+        codec->beginIncremental(SkBitmap::kARGB_8888_Config);
+        REPORTER_ASSERT(reporter, SkImageDecoder::kComplete_IncrementalResult ==
+                                  push_all(reporter, codec, data, size, 37));
+        REPORTER_ASSERT(reporter, expected.height() ==
+                                  codec->incrementalRows());
+        REPORTER_ASSERT(reporter, equal_pixels(expected,
+                                               codec->incrementalBitmap()));
+
+        // truncated, we get what was there
+        codec->beginIncremental(SkBitmap::kARGB_8888_Config);
+        REPORTER_ASSERT(reporter, SkImageDecoder::kPartial_IncrementalResult ==
+                                push_all(reporter, codec, data, size - 20, 37));
+        REPORTER_ASSERT(reporter, SkImageDecoder::kError_IncrementalResult ==
+                                  codec->endIncremental());
+        REPORTER_ASSERT(reporter, expected.width() ==
+                                  codec->incrementalBitmap().width());
+    }
+}
+
+// decoders that cannot decode as the data arrives decode at the end
+static void test_fallback(skiatest::Reporter* reporter) {
+    GrayDecoder codec;
+
+    codec.beginIncremental();
+    REPORTER_ASSERT(reporter, SkImageDecoder::kPartial_IncrementalResult ==
+                        push_all(reporter, &codec, (const char*)gGray,
+                                 sizeof(gGray), 3));
+    REPORTER_ASSERT(reporter, 0 == codec.incrementalRows());
+    REPORTER_ASSERT(reporter, SkImageDecoder::kComplete_IncrementalResult ==
+                              codec.endIncremental());
+
+    const SkBitmap& bm = codec.incrementalBitmap();
+    REPORTER_ASSERT(reporter, 3 == bm.width() && 2 == bm.height());
+    REPORTER_ASSERT(reporter, 2 == codec.incrementalRows());
+    SkAutoLockPixels alp(bm);
+    REPORTER_ASSERT(reporter, SK_ColorBLACK == bm.getColor(0, 0));
+    REPORTER_ASSERT(reporter, SK_ColorWHITE == bm.getColor(0, 1));
+
+    // a short stream fails at the end
+    codec.beginIncremental();
+    codec.pushIncremental(gGray, sizeof(gGray) - 1);
+    REPORTER_ASSERT(reporter, SkImageDecoder::kError_IncrementalResult ==
+                              codec.endIncremental());
+}
+
+static void TestIncrementalDecode(skiatest::Reporter* reporter) {
+    test_png(reporter);
+    test_fallback(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("IncrementalDecode", IncrementalDecodeTestClass,
+                 TestIncrementalDecode)
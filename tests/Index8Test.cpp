@@ -0,0 +1,143 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkData.h"
+#include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+
+// A palettized bitmap whose table has translucent entries.
+static void make_index8(SkBitmap* bm) {
+    SkPMColor colors[16];
+    SkRandom rand;
+    for (int i = 0; i < 16; i++) {
+        U8CPU a = (i & 3) ? 0xFF : rand.nextU() & 0xFF;
+        colors[i] = SkPreMultiplyARGB(a, rand.nextU() & 0xFF,
+                                      rand.nextU() & 0xFF, rand.nextU() & 0xFF);
+    }
+    SkColorTable* ctable = new SkColorTable(colors, 16);
+    bm->setConfig(SkBitmap::kIndex8_Config, 64, 48);
+    bm->allocPixels(ctable);
+    ctable->unref();
+
+    SkAutoLockPixels alp(*bm);
+    for (int y = 0; y < bm->height(); y++) {
+        for (int x = 0; x < bm->width(); x++) {
+            *bm->getAddr8(x, y) = ((x >> 2) + y) & 15;
+        }
+    }
+}
+
+static bool decode(SkData* data, bool preserveSrcDepth, SkBitmap* bm) {
+    SkMemoryStream stream(data->data(), data->size());
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    if (NULL == decoder.get()) {
+        return false;
+    }
+    stream.rewind();
+    decoder.get()->setPreserveSrcDepth(preserveSrcDepth);
+    return decoder.get()->decode(&stream, bm, SkBitmap::kARGB_8888_Config,
+                                 SkImageDecoder::kDecodePixels_Mode);
+}
+
+static bool same_colors(const SkBitmap& index8, const SkBitmap& argb) {
+    SkAutoLockPixels alp0(index8);
+    SkAutoLockPixels alp1(argb);
+    if (index8.width() != argb.width() || index8.height() != argb.height()) {
+        return false;
+    }
+    for (int y = 0; y < argb.height(); y++) {
+        for (int x = 0; x < argb.width(); x++) {
+            if (index8.getIndex8Color(x, y) != *argb.getAddr32(x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A palettized PNG with alpha stays kIndex8 when asked to preserve its depth,
+// and holds the same premultiplied colors it would have been expanded to.
+static void test_decode(skiatest::Reporter* reporter, const SkBitmap& src) {
+    SkDynamicMemoryWStream stream;
+    if (!SkImageEncoder::EncodeStream(&stream, src, SkImageEncoder::kPNG_Type,
+                                      100)) {
+        // no PNG support in this build
+        return;
+    }
+    SkData* data = stream.copyToData();
+
+    SkBitmap expanded, index8;
+    REPORTER_ASSERT(reporter, decode(data, false, &expanded));
+    REPORTER_ASSERT(reporter, decode(data, true, &index8));
+    REPORTER_ASSERT(reporter,
+                    SkBitmap::kARGB_8888_Config == expanded.config());
+    REPORTER_ASSERT(reporter, SkBitmap::kIndex8_Config == index8.config());
+    REPORTER_ASSERT(reporter, !index8.isOpaque());
+    REPORTER_ASSERT(reporter, same_colors(index8, expanded));
+    REPORTER_ASSERT(reporter, same_colors(src, expanded));
+    data->unref();
+}
+
+// Drawing a kIndex8 bitmap matches drawing its 8888 expansion, through both
+// the sprite and the (filtered) shader procs.
+static void test_draw(skiatest::Reporter* reporter, const SkBitmap& src) {
+    SkBitmap expanded;
+    REPORTER_ASSERT(reporter,
+                    src.copyTo(&expanded, SkBitmap::kARGB_8888_Config));
+
+    SkBitmap dst[2];
+    for (int i = 0; i < 2; i++) {
+        dst[i].setConfig(SkBitmap::kARGB_8888_Config, 160, 120);
+        dst[i].allocPixels();
+        dst[i].eraseColor(SK_ColorWHITE);
+
+        const SkBitmap& bm = i ? expanded : src;
+        SkCanvas canvas(dst[i]);
+        SkPaint paint;
+        canvas.drawBitmap(bm, 3, 5, &paint);
+        paint.setAlpha(0x80);
+        canvas.drawBitmap(bm, 80, 5, &paint);
+
+        paint.setAlpha(0xFF);
+        paint.setFilterBitmap(true);
+        canvas.translate(SkFloatToScalar(2.5f), 60);
+        canvas.scale(SkFloatToScalar(1.7f), SkFloatToScalar(1.1f));
+        canvas.drawBitmap(bm, 0, 0, &paint);
+    }
+
+    SkAutoLockPixels alp0(dst[0]);
+    SkAutoLockPixels alp1(dst[1]);
+    REPORTER_ASSERT(reporter,
+                    !memcmp(dst[0].getPixels(), dst[1].getPixels(),
+                            dst[0].getSize()));
+}
+
+static void TestIndex8(skiatest::Reporter* reporter) {
+    SkBitmap src;
+    make_index8(&src);
+    test_decode(reporter, src);
+    test_draw(reporter, src);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Index8", Index8TestClass, TestIndex8)
@@ -0,0 +1,121 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkInterpolator.h"
+#include "SkRandom.h"
+
+static const int kFrameCount = 20;
+static const int kElemCount = 3;
+
+static SkMSec frame_time(int i) {
+    return 100 + i * 37;
+}
+
+static void set_frames(SkInterpolator* interp, int offset) {
+    static const SkScalar gEase[4] = { 0, SK_Scalar1, 0, SK_Scalar1 };
+    for (int i = 0; i < kFrameCount; i++) {
+        SkScalar values[kElemCount];
+        for (int e = 0; e < kElemCount; e++) {
+            values[e] = SkIntToScalar((i + offset) * 10 + e * (i & 3));
+        }
+        interp->setKeyFrame(i, frame_time(i), values, (i & 1) ? gEase : NULL);
+    }
+}
+
+static bool check_time(const SkInterpolator& interp, SkMSec time) {
+    // A fresh interpolator has no search hint.
+    SkInterpolator fresh(kElemCount, kFrameCount);
+    set_frames(&fresh, 0);
+
+    SkScalar expected[kElemCount], actual[kElemCount];
+    SkInterpolator::Result expectedResult = fresh.timeToValues(time, expected);
+    SkInterpolator::Result result = interp.timeToValues(time, actual);
+    return result == expectedResult &&
+           0 == memcmp(expected, actual, sizeof(expected));
+}
+
+static void TestInterpolator(skiatest::Reporter* reporter) {
+    SkInterpolator inter(kElemCount, 2);
+    SkScalar v0[kElemCount] = { 10, 20, 30 };
+    SkScalar v1[kElemCount] = { 110, 220, 330 };
+    SkScalar v[kElemCount];
+    inter.setKeyFrame(0, 100, v0);
+    inter.setKeyFrame(1, 200, v1);
+
+    // The default blend is linear.
+    REPORTER_ASSERT(reporter, inter.timeToValues(125, v) ==
+                              SkInterpolator::kNormal_Result);
+    REPORTER_ASSERT(reporter, v[0] == 35 && v[1] == 70 && v[2] == 105);
+    REPORTER_ASSERT(reporter, inter.timeToValues(99, v) ==
+                              SkInterpolator::kFreezeStart_Result);
+    REPORTER_ASSERT(reporter, 0 == memcmp(v, v0, sizeof(v)));
+    REPORTER_ASSERT(reporter, inter.timeToValues(201, v) ==
+                              SkInterpolator::kFreezeEnd_Result);
+    REPORTER_ASSERT(reporter, 0 == memcmp(v, v1, sizeof(v)));
+
+    // Any other blend still eases.
+    static const SkScalar gEaseOut[4] = { 0, SK_Scalar1, 0, SK_Scalar1 };
+    inter.setKeyFrame(0, 100, v0, gEaseOut);
+    inter.timeToValues(125, v);
+    REPORTER_ASSERT(reporter, v[0] > 35);
+
+    // Forward, backward and out-of-range sampling all agree with an
+    // interpolator that searches from scratch.
+    SkInterpolator interp(kElemCount, kFrameCount);
+    set_frames(&interp, 0);
+    SkMSec end = frame_time(kFrameCount - 1);
+    for (SkMSec time = 50; time < end + 50; time += 7) {
+        REPORTER_ASSERT(reporter, check_time(interp, time));
+    }
+    for (int i = 0; i < kFrameCount; i++) {
+        REPORTER_ASSERT(reporter, check_time(interp, frame_time(i)));
+    }
+    SkRandom rand;
+    for (int i = 0; i < 200; i++) {
+        SkMSec time = rand.nextU() % (end + 100);
+        REPORTER_ASSERT(reporter, check_time(interp, time));
+    }
+
+    // Sampling a batch writes element-major values.
+    static const int kBatchCount = 4;
+    SkInterpolator batch[kBatchCount];
+    const SkInterpolator* batchPtrs[kBatchCount];
+    for (int i = 0; i < kBatchCount; i++) {
+        batch[i].reset(kElemCount, kFrameCount);
+        set_frames(&batch[i], i);
+        batchPtrs[i] = &batch[i];
+    }
+    for (SkMSec time = 50; time < end + 50; time += 29) {
+        SkScalar values[kElemCount * kBatchCount];
+        SkInterpolator::Result results[kBatchCount];
+        SkInterpolator::TimeToValues(batchPtrs, kBatchCount, time, values,
+                                     results);
+        for (int i = 0; i < kBatchCount; i++) {
+            SkScalar single[kElemCount];
+            REPORTER_ASSERT(reporter,
+                            batch[i].timeToValues(time, single) == results[i]);
+            for (int e = 0; e < kElemCount; e++) {
+                REPORTER_ASSERT(reporter,
+                                single[e] == values[e * kBatchCount + i]);
+            }
+        }
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Interpolator", InterpolatorTestClass, TestInterpolator)
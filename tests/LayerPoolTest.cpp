@@ -0,0 +1,140 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkLayerPool.h"
+
+static bool is_clear(const SkBitmap& bm) {
+    SkAutoLockPixels alp(bm);
+    for (int y = 0; y < bm.height(); y++) {
+        for (int x = 0; x < bm.width(); x++) {
+            if (*bm.getAddr32(x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void* alloc(SkBitmap* bm, SkBitmap::Config config, int w, int h) {
+    if (!SkLayerPool::AllocPixels(bm, config, w, h, false)) {
+        return NULL;
+    }
+    SkAutoLockPixels alp(*bm);
+    return bm->getPixels();
+}
+
+static void test_reuse(skiatest::Reporter* reporter) {
+    const SkBitmap::Config config = SkBitmap::kARGB_8888_Config;
+    SkBitmap bm;
+    void* pixels = alloc(&bm, config, 100, 50);
+    REPORTER_ASSERT(reporter, NULL != pixels);
+    REPORTER_ASSERT(reporter, 100 == bm.width() && 50 == bm.height());
+    REPORTER_ASSERT(reporter, is_clear(bm));
+    bm.eraseColor(SK_ColorRED);
+    bm.reset();
+    REPORTER_ASSERT(reporter, SkLayerPool::GetBytesUsed() >= 100 * 50 * 4);
+
+    // a layer of a similar size gets the same pixels, cleared again
+    void* again = alloc(&bm, config, 90, 40);
+    REPORTER_ASSERT(reporter, again == pixels);
+    REPORTER_ASSERT(reporter, 90 == bm.width() && 40 == bm.height());
+    REPORTER_ASSERT(reporter, bm.rowBytes() >= 100 * 4);
+    REPORTER_ASSERT(reporter, is_clear(bm));
+    REPORTER_ASSERT(reporter, 0 == SkLayerPool::GetBytesUsed());
+    bm.reset();
+
+    // but not one that doesn't fit, or of another config, or much smaller
+    SkBitmap other;
+    REPORTER_ASSERT(reporter, alloc(&other, config, 101, 80) != pixels);
+    other.reset();
+    REPORTER_ASSERT(reporter,
+                    alloc(&other, SkBitmap::kA8_Config, 100, 50) != pixels);
+    other.reset();
+    REPORTER_ASSERT(reporter, alloc(&other, config, 20, 20) != pixels);
+    other.reset();
+    REPORTER_ASSERT(reporter, alloc(&other, config, 100, 50) == pixels);
+    other.reset();
+
+    // colortables aren't pooled
+    REPORTER_ASSERT(reporter, !SkLayerPool::AllocPixels(&other,
+                                    SkBitmap::kIndex8_Config, 8, 8, false));
+    REPORTER_ASSERT(reporter, !SkLayerPool::AllocPixels(&other,
+                                    config, 0, 8, false));
+
+    SkLayerPool::Purge();
+    REPORTER_ASSERT(reporter, 0 == SkLayerPool::GetBytesUsed());
+
+    // with no limit nothing is kept
+    SkLayerPool::SetByteLimit(0);
+    REPORTER_ASSERT(reporter, NULL != alloc(&bm, config, 100, 50));
+    bm.reset();
+    REPORTER_ASSERT(reporter, 0 == SkLayerPool::GetBytesUsed());
+    SkLayerPool::SetByteLimit(1024 * 1024);
+}
+
+static void draw_layers(SkBitmap* dst) {
+    dst->setConfig(SkBitmap::kARGB_8888_Config, 64, 64);
+    dst->allocPixels();
+    dst->eraseColor(SK_ColorWHITE);
+
+    SkCanvas canvas(*dst);
+    SkPaint paint;
+    for (int i = 0; i < 3; i++) {
+        SkRect bounds = SkRect::MakeXYWH(SkIntToScalar(i * 4),
+                                         SkIntToScalar(i * 3),
+                                         SkIntToScalar(40 - i),
+                                         SkIntToScalar(40));
+        canvas.saveLayerAlpha(&bounds, 0x80);
+        paint.setColor(i & 1 ? SK_ColorBLUE : SK_ColorGREEN);
+        canvas.drawCircle(SkIntToScalar(20 + i * 8), SkIntToScalar(24),
+                          SkIntToScalar(10 + i * 3), paint);
+        canvas.restore();
+    }
+}
+
+// layers that reuse each other's pixels draw what fresh ones would
+static void test_canvas(skiatest::Reporter* reporter) {
+    SkBitmap ref, dst;
+    SkLayerPool::SetByteLimit(0);
+    draw_layers(&ref);
+    SkLayerPool::SetByteLimit(1024 * 1024);
+    draw_layers(&dst);
+    REPORTER_ASSERT(reporter, SkLayerPool::GetBytesUsed() > 0);
+    draw_layers(&dst);
+
+    SkAutoLockPixels alpr(ref);
+    SkAutoLockPixels alpd(dst);
+    REPORTER_ASSERT(reporter, !memcmp(ref.getPixels(), dst.getPixels(),
+                                      ref.getSize()));
+}
+
+static void TestLayerPool(skiatest::Reporter* reporter) {
+    const size_t limit = SkLayerPool::GetByteLimit();
+    SkLayerPool::SetByteLimit(1024 * 1024);
+    SkLayerPool::Purge();
+
+    test_reuse(reporter);
+    test_canvas(reporter);
+
+    SkLayerPool::Purge();
+    SkLayerPool::SetByteLimit(limit);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("LayerPool", LayerPoolTestClass, TestLayerPool)
@@ -0,0 +1,190 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBlurMaskFilter.h"
+#include "SkDashPathEffect.h"
+#include "SkDraw.h"
+#include "SkLayerRasterizer.h"
+#include "SkMaskFilter.h"
+#include "SkPath.h"
+#include "SkRegion.h"
+#include "SkThread.h"
+
+struct Layer {
+    SkPaint     fPaint;
+    SkVector    fOffset;
+};
+
+// how SkLayerRasterizer draws its layers: each one's paint on the src
+static bool ref_rasterize(const Layer layers[], int count, const SkPath& path,
+                          const SkMatrix& matrix, SkMask* mask) {
+    mask->fBounds.set(SK_MaxS32, SK_MaxS32, SK_MinS32, SK_MinS32);
+    for (int i = 0; i < count; i++) {
+        const SkPaint& paint = layers[i].fPaint;
+        SkPath fillPath, devPath;
+        paint.getFillPath(path, &fillPath);
+        if (fillPath.isEmpty()) {
+            continue;
+        }
+        SkMatrix m = matrix;
+        m.preTranslate(layers[i].fOffset.fX, layers[i].fOffset.fY);
+        fillPath.transform(m, &devPath);
+        SkMask bounds;
+        if (!SkDraw::DrawToMask(devPath, NULL, paint.getMaskFilter(), &matrix,
+                                &bounds,
+                                SkMask::kJustComputeBounds_CreateMode)) {
+            return false;
+        }
+        mask->fBounds.join(bounds.fBounds);
+    }
+
+    mask->fFormat = SkMask::kA8_Format;
+    mask->fRowBytes = mask->fBounds.width();
+    mask->fImage = SkMask::AllocImage(mask->computeImageSize());
+    memset(mask->fImage, 0, mask->computeImageSize());
+
+    SkBitmap device;
+    device.setConfig(SkBitmap::kA8_Config, mask->fBounds.width(),
+                     mask->fBounds.height(), mask->fRowBytes);
+    device.setPixels(mask->fImage);
+    SkRegion clip;
+    clip.setRect(0, 0, mask->fBounds.width(), mask->fBounds.height());
+
+    SkMatrix drawMatrix;
+    SkDraw draw;
+    draw.fBitmap = &device;
+    draw.fMatrix = &drawMatrix;
+    draw.fClip = &clip;
+    for (int i = 0; i < count; i++) {
+        drawMatrix = matrix;
+        drawMatrix.postTranslate(-SkIntToScalar(mask->fBounds.fLeft),
+                                 -SkIntToScalar(mask->fBounds.fTop));
+        drawMatrix.preTranslate(layers[i].fOffset.fX, layers[i].fOffset.fY);
+        draw.drawPath(path, layers[i].fPaint);
+    }
+    return true;
+}
+
+// the largest difference between the masks' pixels, or 256 if their bounds
+// aren't the same
+static int mask_diff(const SkMask& a, const SkMask& b) {
+    if (a.fBounds != b.fBounds) {
+        return 256;
+    }
+    int diff = 0;
+    for (int y = a.fBounds.fTop; y < a.fBounds.fBottom; y++) {
+        const uint8_t* rowA = a.getAddr(a.fBounds.fLeft, y);
+        const uint8_t* rowB = b.getAddr(b.fBounds.fLeft, y);
+        for (int x = 0; x < a.fBounds.width(); x++) {
+            diff = SkMax32(diff, SkAbs32(rowA[x] - rowB[x]));
+        }
+    }
+    return diff;
+}
+
+static void check_layers(skiatest::Reporter* reporter, const Layer layers[],
+                         int count, const SkPath& path, const SkMatrix& matrix,
+                         SkExecutor* executor, int tolerance) {
+    SkLayerRasterizer rasterizer;
+    for (int i = 0; i < count; i++) {
+        rasterizer.addLayer(layers[i].fPaint, layers[i].fOffset.fX,
+                            layers[i].fOffset.fY);
+    }
+
+    SkMask expected, actual;
+    REPORTER_ASSERT(reporter, ref_rasterize(layers, count, path, matrix,
+                                            &expected));
+    REPORTER_ASSERT(reporter, rasterizer.rasterize(path, matrix, NULL, NULL,
+                        &actual, SkMask::kComputeBoundsAndRenderImage_CreateMode,
+                        executor));
+    REPORTER_ASSERT(reporter, mask_diff(actual, expected) <= tolerance);
+
+    SkMask bounds;
+    REPORTER_ASSERT(reporter, rasterizer.rasterize(path, matrix, NULL, NULL,
+                        &bounds, SkMask::kJustComputeBounds_CreateMode));
+    REPORTER_ASSERT(reporter, bounds.fBounds == expected.fBounds);
+
+    SkMask::FreeImage(expected.fImage);
+    SkMask::FreeImage(actual.fImage);
+}
+
+static void TestLayerRasterizer(skiatest::Reporter* reporter) {
+    static const SkScalar gIntervals[] = { 8, 4 };
+
+    // an outline, a shadow and a fill, as text effects stack them
+    Layer layers[8];
+    layers[0].fPaint.setStyle(SkPaint::kStroke_Style);
+    layers[0].fPaint.setStrokeWidth(SkIntToScalar(6));
+    layers[0].fOffset.set(0, 0);
+    layers[1].fPaint.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(3),
+                        SkBlurMaskFilter::kNormal_BlurStyle))->unref();
+    layers[1].fPaint.setAlpha(0x80);
+    layers[1].fOffset.set(SkIntToScalar(4), SkIntToScalar(4));
+    layers[2].fPaint.setAlpha(0xC0);
+    layers[2].fOffset.set(0, 0);
+    // the same outline again, to share the first one's fill path
+    layers[3] = layers[0];
+    layers[3].fPaint.setAlpha(0x40);
+    layers[3].fOffset.set(SkIntToScalar(-2), SkIntToScalar(1));
+    // thin enough (after a scale) that SkDraw strokes it its own way
+    layers[4].fPaint.setStyle(SkPaint::kStroke_Style);
+    layers[4].fPaint.setStrokeWidth(SkIntToScalar(2));
+    layers[4].fOffset.set(0, 0);
+    layers[5].fPaint.setStyle(SkPaint::kStrokeAndFill_Style);
+    layers[5].fPaint.setStrokeWidth(SkIntToScalar(3));
+    layers[5].fOffset.set(SkIntToScalar(1), 0);
+    layers[6].fPaint.setStyle(SkPaint::kStroke_Style);
+    layers[6].fPaint.setStrokeWidth(SkIntToScalar(4));
+    layers[6].fPaint.setPathEffect(new SkDashPathEffect(gIntervals, 2, 0))->unref();
+    layers[6].fOffset.set(0, 0);
+    // a hairline
+    layers[7].fPaint.setStyle(SkPaint::kStroke_Style);
+    layers[7].fOffset.set(0, SkIntToScalar(2));
+    for (int i = 0; i < 8; i++) {
+        layers[i].fPaint.setAntiAlias(i != 5);
+    }
+
+    SkPath path;
+    path.addCircle(SkIntToScalar(30), SkIntToScalar(30), SkIntToScalar(20));
+    path.addRect(SkIntToScalar(10), SkIntToScalar(50), SkIntToScalar(70),
+                 SkIntToScalar(60));
+
+    SkMatrix matrices[3];
+    matrices[0].reset();
+    matrices[1].setScale(SK_Scalar1 / 2, SK_Scalar1 / 2);
+    matrices[2].setRotate(SkIntToScalar(30));
+    matrices[2].postTranslate(SkIntToScalar(5), SkIntToScalar(7));
+
+    // layers 0 and 3 share one coverage mask when their offsets come out as
+    // whole pixels, which blits a bit differently than their spans would
+    for (int i = 0; i < 3; i++) {
+        check_layers(reporter, layers, 3, path, matrices[i], NULL, 0);
+        check_layers(reporter, layers, 8, path, matrices[i], NULL,
+                     0 == i ? 1 : 0);
+    }
+
+    // and big enough to be filled in bands, with workers even on a single
+    // core (if nothing has used the pool yet)
+    SkTaskGroup::SetThreadCount(3);
+    SkTaskGroup group;
+    SkMatrix big;
+    big.setScale(SkIntToScalar(8), SkIntToScalar(8));
+    check_layers(reporter, layers, 8, path, big, &group, 1);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("LayerRasterizer", LayerRasterizerTestClass, TestLayerRasterizer)
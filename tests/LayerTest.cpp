@@ -0,0 +1,137 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkLayer.h"
+
+namespace {
+
+// fills its left half with color, and counts how often it is asked to
+class CountingLayer : public SkLayer {
+public:
+    CountingLayer(SkColor color) : fColor(color), fDrawCount(0) {}
+
+    SkColor fColor;
+    int     fDrawCount;
+
+protected:
+    virtual void onDraw(SkCanvas* canvas, SkScalar opacity) {
+        fDrawCount += 1;
+        SkPaint paint;
+        paint.setColor(fColor);
+        paint.setAlpha(SkScalarRound(SkScalarMul(opacity, 255)));
+        canvas->drawRect(SkRect::MakeWH(SkScalarHalf(this->getWidth()),
+                                        this->getHeight()), paint);
+    }
+};
+
+}
+
+static void draw_layer(SkLayer* layer, SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 40, 30);
+    bm->allocPixels();
+    bm->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bm);
+    layer->draw(&canvas);
+}
+
+// true if no component differs by more than tolerance
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b,
+                        int tolerance = 0) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    const uint8_t* pa = (const uint8_t*)a.getPixels();
+    const uint8_t* pb = (const uint8_t*)b.getPixels();
+    for (size_t i = 0; i < a.getSize(); i++) {
+        if (SkAbs32(pa[i] - pb[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a caching layer only draws its content again once it has been invalidated,
+// and otherwise looks just like one that draws every time
+static void TestLayer(skiatest::Reporter* reporter) {
+    SkAutoTUnref<CountingLayer> cached(new CountingLayer(SK_ColorBLUE));
+    SkAutoTUnref<CountingLayer> plain(new CountingLayer(SK_ColorBLUE));
+    SkAutoTUnref<CountingLayer> child(new CountingLayer(SK_ColorRED));
+    SkLayer* layers[] = { cached.get(), plain.get() };
+    for (int i = 0; i < 2; i++) {
+        layers[i]->setSize(SkIntToScalar(20), SkIntToScalar(10));
+    }
+    cached.get()->setCachingContent(true);
+    REPORTER_ASSERT(reporter, cached.get()->isCachingContent());
+    REPORTER_ASSERT(reporter, !plain.get()->isCachingContent());
+
+    // only the transform changes from one draw to the next
+    SkBitmap expected, actual;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 2; j++) {
+            layers[j]->setPosition(SkIntToScalar(3 + 5 * i),
+                                   SkIntToScalar(2 * i));
+        }
+        draw_layer(plain.get(), &expected);
+        draw_layer(cached.get(), &actual);
+        REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+    }
+    REPORTER_ASSERT(reporter, 1 == cached.get()->fDrawCount);
+    REPORTER_ASSERT(reporter, 3 == plain.get()->fDrawCount);
+
+    // bigger, and with a child that draws itself on top
+    for (int j = 0; j < 2; j++) {
+        layers[j]->setSize(SkIntToScalar(30), SkIntToScalar(20));
+    }
+    child.get()->setSize(SkIntToScalar(6), SkIntToScalar(6));
+    cached.get()->addChild(child.get());
+    draw_layer(cached.get(), &actual);
+    REPORTER_ASSERT(reporter, 2 == cached.get()->fDrawCount);
+    REPORTER_ASSERT(reporter, 1 == child.get()->fDrawCount);
+    {
+        SkAutoLockPixels alp(actual);
+        REPORTER_ASSERT(reporter, SK_ColorRED == *actual.getAddr32(14, 6));
+    }
+    child.get()->detachFromParent();
+
+    // new content is only drawn once the layer has been told
+    cached.get()->fColor = SK_ColorGREEN;
+    plain.get()->fColor = SK_ColorGREEN;
+    draw_layer(cached.get(), &actual);
+    REPORTER_ASSERT(reporter, 2 == cached.get()->fDrawCount);
+    cached.get()->inval();
+    draw_layer(cached.get(), &actual);
+    draw_layer(plain.get(), &expected);
+    REPORTER_ASSERT(reporter, 3 == cached.get()->fDrawCount);
+    REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+
+    // and the opacity is applied when the cache is drawn, give or take the
+    // rounding of blending the cache rather than the color
+    for (int j = 0; j < 2; j++) {
+        layers[j]->setOpacity(SK_ScalarHalf);
+    }
+    draw_layer(cached.get(), &actual);
+    draw_layer(plain.get(), &expected);
+    REPORTER_ASSERT(reporter, 3 == cached.get()->fDrawCount);
+    REPORTER_ASSERT(reporter, same_pixels(expected, actual, 1));
+
+    cached.get()->setCachingContent(false);
+    draw_layer(cached.get(), &actual);
+    REPORTER_ASSERT(reporter, 4 == cached.get()->fDrawCount);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Layer", LayerTestClass, TestLayer)
@@ -0,0 +1,258 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkColorPriv.h"
+#include "SkEmbossMask.h"
+#include "SkEmbossMask_Table.h"
+#include "SkKernel33MaskFilter.h"
+#include "SkMatrix.h"
+#include "SkRandom.h"
+#include "SkTemplates.h"
+
+static void make_mask(SkMask* mask, SkRandom* rand, int w, int h,
+                      SkMask::Format format, int planes) {
+    mask->fBounds.set(0, 0, w, h);
+    mask->fRowBytes = w + 3;    // not packed, to check we use it
+    mask->fFormat = format;
+    mask->fImage = SkMask::AllocImage(mask->computeImageSize() * planes);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            // zeros too, since those pixels are skipped
+            uint8_t value = rand->nextU() % 3 ? rand->nextU() & 0xFF : 0;
+            mask->fImage[y * mask->fRowBytes + x] = value;
+        }
+    }
+}
+
+// dst[x, y] is the kernel applied to src[x - 2 .. x, y - 2 .. y], computed the
+// slow way, with zeros outside of src
+static uint8_t expected_kernel33(const SkMask& src, int x, int y,
+                                 const int kernel[3][3], int shift,
+                                 int percent256) {
+    const int w = src.fBounds.width();
+    const int h = src.fBounds.height();
+    int value = 0;
+    int center = 0;
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            int sx = x - 2 + i;
+            int sy = y - 2 + j;
+            int tap = 0;
+            if ((unsigned)sx < (unsigned)w && (unsigned)sy < (unsigned)h) {
+                tap = src.fImage[sy * src.fRowBytes + sx];
+            }
+            value += kernel[j][i] * tap;
+            if (1 == i && 1 == j) {
+                center = tap;
+            }
+        }
+    }
+    value = SkPin32(value >> shift, 0, 255);
+    if (percent256 < 256) {
+        value = SkAlphaBlend(value, center, percent256);
+    }
+    return SkToU8(value);
+}
+
+static void test_kernel33(skiatest::Reporter* reporter, SkRandom* rand,
+                          int w, int h, const int kernel[3][3], int shift,
+                          int percent256) {
+    SkMask src, dst;
+    make_mask(&src, rand, w, h, SkMask::kA8_Format, 1);
+
+    SkKernel33MaskFilter filter(kernel, shift, percent256);
+    REPORTER_ASSERT(reporter, filter.filterMask(&dst, src, SkMatrix::I(),
+                                                NULL));
+    REPORTER_ASSERT(reporter, dst.fBounds.width() == w + 2);
+    REPORTER_ASSERT(reporter, dst.fBounds.height() == h + 2);
+
+    bool ok = true;
+    for (int y = 0; y < h + 2; y++) {
+        for (int x = 0; x < w + 2; x++) {
+            uint8_t expected = expected_kernel33(src, x, y, kernel, shift,
+                                                 percent256);
+            ok = ok && expected == dst.fImage[y * dst.fRowBytes + x];
+        }
+    }
+    REPORTER_ASSERT(reporter, ok);
+
+    SkMask::FreeImage(dst.fImage);
+    SkMask::FreeImage(src.fImage);
+}
+
+static void test_kernel33s(skiatest::Reporter* reporter) {
+    static const int gSharpen[3][3] = {
+        { -1, -1, -1 }, { -1, 9, -1 }, { -1, -1, -1 },
+    };
+    static const int gBox[3][3] = {
+        { 1, 2, 1 }, { 2, 4, 2 }, { 1, 2, 1 },
+    };
+    // too big for the 16 bit coefficients of the fast path
+    static const int gWide[3][3] = {
+        { 40000, 0, -40000 }, { 0, 1 << 16, 0 }, { -3, 0, 3 },
+    };
+    static const struct {
+        int fW, fH;
+    } gSizes[] = {
+        { 1, 1 }, { 2, 3 }, { 6, 2 }, { 7, 5 }, { 17, 9 }, { 40, 3 },
+    };
+
+    SkRandom rand;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gSizes); i++) {
+        int w = gSizes[i].fW;
+        int h = gSizes[i].fH;
+        test_kernel33(reporter, &rand, w, h, gSharpen, 0, 256);
+        test_kernel33(reporter, &rand, w, h, gSharpen, 1, 128);
+        test_kernel33(reporter, &rand, w, h, gBox, 4, 256);
+        test_kernel33(reporter, &rand, w, h, gBox, 3, 200);
+        test_kernel33(reporter, &rand, w, h, gWide, 16, 256);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static inline int nonzero_to_one(int x) {
+    return x != 0;
+}
+
+static inline int neq_to_one(int x, int max) {
+    return x != max;
+}
+
+static inline unsigned div255(unsigned x) {
+    return x * ((1 << 24) / 255) >> 24;
+}
+
+// the lighting, one pixel at a time, as SkEmbossMask::Emboss first had it
+static void expected_emboss(SkMask* mask,
+                            const SkEmbossMaskFilter::Light& light) {
+    int     specular = light.fSpecular;
+    int     ambient = light.fAmbient;
+    SkFixed lx = SkScalarToFixed(light.fDirection[0]);
+    SkFixed ly = SkScalarToFixed(light.fDirection[1]);
+    SkFixed lz = SkScalarToFixed(light.fDirection[2]);
+    SkFixed lz_dot_nz = lz * kDeltaUsedToBuildTable;
+    int     lz_dot8 = lz >> 8;
+
+    size_t      planeSize = mask->computeImageSize();
+    uint8_t*    alpha = mask->fImage;
+    uint8_t*    multiply = alpha + planeSize;
+    uint8_t*    additive = multiply + planeSize;
+
+    int rowBytes = mask->fRowBytes;
+    int maxy = mask->fBounds.height() - 1;
+    int maxx = mask->fBounds.width() - 1;
+
+    int prev_row = 0;
+    for (int y = 0; y <= maxy; y++) {
+        int next_row = y != maxy ? rowBytes : 0;
+        for (int x = 0; x <= maxx; x++) {
+            if (alpha[x]) {
+                int nx = alpha[x + neq_to_one(x, maxx)] -
+                         alpha[x - nonzero_to_one(x)];
+                int ny = alpha[x + next_row] - alpha[x - prev_row];
+
+                SkFixed numer = lx * nx + ly * ny + lz_dot_nz;
+                int     mul = ambient;
+                int     add = 0;
+                if (numer > 0) {
+                    SkFixed dot = (unsigned)(numer >> 4) *
+                            gInvSqrtTable[(SkAbs32(nx) >> 1 << 7) |
+                                          (SkAbs32(ny) >> 1)] >> 20;
+                    mul = SkFastMin32(mul + dot, 255);
+                    int hilite = (2 * dot - lz_dot8) * lz_dot8 >> 8;
+                    if (hilite > 0) {
+                        hilite = SkClampMax(hilite, 255);
+                        add = hilite;
+                        for (int i = specular >> 4; i > 0; --i) {
+                            add = div255(add * hilite);
+                        }
+                    }
+                }
+                multiply[x] = SkToU8(mul);
+                additive[x] = SkToU8(add);
+            }
+        }
+        alpha += rowBytes;
+        multiply += rowBytes;
+        additive += rowBytes;
+        prev_row = rowBytes;
+    }
+}
+
+static void normalize(SkScalar v[3]) {
+    SkScalar mag = SkScalarSqrt(SkScalarSquare(v[0]) + SkScalarSquare(v[1]) +
+                                SkScalarSquare(v[2]));
+    for (int i = 0; i < 3; i++) {
+        v[i] = SkScalarDiv(v[i], mag);
+    }
+}
+
+static void test_emboss(skiatest::Reporter* reporter) {
+    static const struct {
+        int fW, fH;
+    } gSizes[] = {
+        { 1, 1 }, { 1, 4 }, { 2, 2 }, { 5, 1 }, { 9, 7 }, { 33, 12 },
+    };
+    static const SkScalar gDirections[][3] = {
+        { SK_Scalar1, SK_Scalar1, SK_Scalar1 },
+        { -SK_Scalar1 / 3, SK_Scalar1 / 2, SK_Scalar1 * 3 / 4 },
+        { 0, -SK_Scalar1, SK_Scalar1 / 8 },
+    };
+    static const uint8_t gSpeculars[] = { 0, 0x18, 0x40, 0x7F };
+
+    SkRandom rand;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gSizes); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gDirections); j++) {
+            for (size_t k = 0; k < SK_ARRAY_COUNT(gSpeculars); k++) {
+                SkEmbossMaskFilter::Light light;
+                memcpy(light.fDirection, gDirections[j],
+                       sizeof(light.fDirection));
+                normalize(light.fDirection);
+                light.fPad = 0;
+                light.fAmbient = 0x30;
+                light.fSpecular = gSpeculars[k];
+
+                SkMask mask;
+                make_mask(&mask, &rand, gSizes[i].fW, gSizes[i].fH,
+                          SkMask::k3D_Format, 3);
+                size_t size = mask.computeImageSize() * 3;
+                // the untouched pixels of the other planes have to stay so
+                SkAutoTMalloc<uint8_t> expected(size);
+                memset(mask.fImage + size / 3, 0x5A, size * 2 / 3);
+                memcpy(expected.get(), mask.fImage, size);
+
+                SkMask expectedMask = mask;
+                expectedMask.fImage = expected.get();
+                expected_emboss(&expectedMask, light);
+                SkEmbossMask::Emboss(&mask, light);
+                REPORTER_ASSERT(reporter,
+                                !memcmp(expected.get(), mask.fImage, size));
+                SkMask::FreeImage(mask.fImage);
+            }
+        }
+    }
+}
+
+static void TestMaskFilter(skiatest::Reporter* reporter) {
+    test_kernel33s(reporter);
+    test_emboss(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("MaskFilter", MaskFilterTestClass, TestMaskFilter)
@@ -1,5 +1,6 @@
 #include "Test.h"
 #include "SkMatrix.h"
+#include "SkRandom.h"
 
 static bool nearly_equal_scalar(SkScalar a, SkScalar b) {
     // Note that we get more compounded error for multiple operations when
@@ -48,6 +49,74 @@ static void test_flatten(skiatest::Reporter* reporter, const SkMatrix& m) {
     REPORTER_ASSERT(reporter, memcmp(buffer, buffer2, size1) == 0);
 }
 
+// Mapping points in a batch (which may use the platform's procs) should give
+// exactly what mapping them one at a time does, for every type of matrix.
+static void test_map_points(skiatest::Reporter* reporter, const SkMatrix& m) {
+    SkRandom rand;
+    SkPoint src[13], batch[13];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(src); i++) {
+        src[i].set(rand.nextSScalar1() * 100, rand.nextSScalar1() * 100);
+    }
+    // the odd count leaves a point over from any pairs or fours
+    for (int count = 0; count <= (int)SK_ARRAY_COUNT(src); count++) {
+        m.mapPoints(batch, src, count);
+        for (int i = 0; i < count; i++) {
+            SkPoint one;
+            m.mapPoints(&one, &src[i], 1);
+            REPORTER_ASSERT(reporter, one == batch[i]);
+            if (!m.hasPerspective()) {
+                SkPoint xy;
+                m.mapXY(src[i].fX, src[i].fY, &xy);
+                REPORTER_ASSERT(reporter, xy == batch[i]);
+            }
+        }
+    }
+
+    // in place
+    memcpy(batch, src, sizeof(src));
+    m.mapPoints(batch, SK_ARRAY_COUNT(batch));
+    for (size_t i = 0; i < SK_ARRAY_COUNT(src); i++) {
+        SkPoint one;
+        m.mapPoints(&one, &src[i], 1);
+        REPORTER_ASSERT(reporter, one == batch[i]);
+    }
+
+    SkRect rects[5], mapped[5];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(rects); i++) {
+        rects[i].set(&src[2 * i], 2);
+    }
+    bool staysRect = m.mapRects(mapped, rects, SK_ARRAY_COUNT(rects));
+    REPORTER_ASSERT(reporter, staysRect == m.rectStaysRect());
+    for (size_t i = 0; i < SK_ARRAY_COUNT(rects); i++) {
+        SkRect one;
+        m.mapRect(&one, rects[i]);
+        REPORTER_ASSERT(reporter, one == mapped[i]);
+    }
+}
+
+static void test_map_points_types(skiatest::Reporter* reporter) {
+    SkMatrix m;
+
+    m.reset();
+    test_map_points(reporter, m);
+    m.setTranslate(SkIntToScalar(7), -SkIntToScalar(3));
+    test_map_points(reporter, m);
+    m.setScale(SkIntToScalar(3), SK_Scalar1 / 3);
+    test_map_points(reporter, m);
+    m.postTranslate(SkIntToScalar(5), SkIntToScalar(11));
+    test_map_points(reporter, m);
+    m.setRotate(SkIntToScalar(30));
+    test_map_points(reporter, m);
+    m.setSkew(SK_Scalar1 / 2, 0);
+    test_map_points(reporter, m);
+    m.postScale(SkIntToScalar(2), SkIntToScalar(3));
+    m.postTranslate(SkIntToScalar(5), SkIntToScalar(11));
+    test_map_points(reporter, m);
+    m.setPerspX(SK_Scalar1 / 1000);
+    m.setPerspY(SK_Scalar1 / 500);
+    test_map_points(reporter, m);
+}
+
 void TestMatrix(skiatest::Reporter* reporter) {
     SkMatrix    mat, inverse, iden1, iden2;
 
@@ -117,6 +186,8 @@ void TestMatrix(skiatest::Reporter* reporter) {
                     m.rectStaysRect() == gRectStaysRectSamples[i].mStaysRect);
         }
     }
+
+    test_map_points_types(reporter);
 }
 
 #include "TestClassDef.h"
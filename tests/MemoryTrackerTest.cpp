@@ -0,0 +1,113 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkMemoryTracker.h"
+
+// stand-ins for call sites
+static void site_a() {}
+static void site_b() {}
+
+static const SkMemoryTracker::Site* find_site(
+                                    const SkMemoryTracker::Site sites[],
+                                    int count, const void* caller) {
+    for (int i = 0; i < count; i++) {
+        if (sites[i].fCaller == caller) {
+            return &sites[i];
+        }
+    }
+    return NULL;
+}
+
+static void TestMemoryTracker(skiatest::Reporter* reporter) {
+    const void* callerA = (const void*)&site_a;
+    const void* callerB = (const void*)&site_b;
+
+    // these count whether or not sk_malloc is tracked
+    SkMemoryTracker::Stats before, after;
+    SkMemoryTracker::GetStats(&before);
+    SkMemoryTracker::ResetPeak();
+
+    void* a = SkMemoryTracker::Malloc(100, callerA);
+    void* b = SkMemoryTracker::Malloc(1000, callerB);
+    REPORTER_ASSERT(reporter, a && b);
+    REPORTER_ASSERT(reporter, 0 == ((uintptr_t)a & 7));
+    memset(a, 0x11, 100);
+    memset(b, 0x22, 1000);
+
+    a = SkMemoryTracker::Realloc(a, 200, callerA);
+    REPORTER_ASSERT(reporter, 0x11 == ((uint8_t*)a)[99]);
+    SkMemoryTracker::GetStats(&after);
+    int64_t current = after.fCurrentBytes - before.fCurrentBytes;
+    int64_t peak = after.fPeakBytes - before.fCurrentBytes;
+    REPORTER_ASSERT(reporter, 1200 <= current);
+    REPORTER_ASSERT(reporter, 1200 <= peak);
+    REPORTER_ASSERT(reporter, 1300 <= after.fAllocatedBytes -
+                                      before.fAllocatedBytes);
+    REPORTER_ASSERT(reporter, 3 <= after.fAllocCount - before.fAllocCount);
+
+    const int kMaxSites = 4096;
+    SkMemoryTracker::Site* sites = new SkMemoryTracker::Site[kMaxSites];
+    int count = SkMin32(SkMemoryTracker::GetSites(sites, kMaxSites),
+                        kMaxSites);
+    const SkMemoryTracker::Site* siteA = find_site(sites, count, callerA);
+    const SkMemoryTracker::Site* siteB = find_site(sites, count, callerB);
+    REPORTER_ASSERT(reporter, siteA && siteB);
+    if (siteA && siteB) {
+        REPORTER_ASSERT(reporter, 2 == siteA->fAllocCount);
+        REPORTER_ASSERT(reporter, 300 == siteA->fAllocatedBytes);
+        REPORTER_ASSERT(reporter, 200 == siteA->fCurrentBytes);
+        REPORTER_ASSERT(reporter, 1 == siteB->fAllocCount);
+        REPORTER_ASSERT(reporter, 1000 == siteB->fCurrentBytes);
+    }
+    // most bytes first
+    for (int i = 1; i < count; i++) {
+        REPORTER_ASSERT(reporter, sites[i - 1].fAllocatedBytes >=
+                                  sites[i].fAllocatedBytes);
+    }
+    // asking for fewer still gets the biggest
+    SkMemoryTracker::Site biggest;
+    SkMemoryTracker::GetSites(&biggest, 1);
+    REPORTER_ASSERT(reporter, count > 0 &&
+                              biggest.fAllocatedBytes ==
+                              sites[0].fAllocatedBytes);
+
+    SkMemoryTracker::Free(a);
+    SkMemoryTracker::GetStats(&after);
+    REPORTER_ASSERT(reporter, 200 <= current - (after.fCurrentBytes -
+                                                before.fCurrentBytes));
+
+    // a block freed after its site was forgotten isn't taken off another
+    SkMemoryTracker::ResetSites();
+    void* c = SkMemoryTracker::Malloc(10, callerB);
+    SkMemoryTracker::Free(b);
+    count = SkMin32(SkMemoryTracker::GetSites(sites, kMaxSites), kMaxSites);
+    siteB = find_site(sites, count, callerB);
+    REPORTER_ASSERT(reporter, siteB && 10 == siteB->fCurrentBytes);
+    SkMemoryTracker::Free(c);
+
+    // nor is a block that was never tracked, which is just freed
+    SkMemoryTracker::Free(malloc(64));
+    SkMemoryTracker::Free(NULL);
+    REPORTER_ASSERT(reporter, NULL == SkMemoryTracker::Realloc(
+                                      SkMemoryTracker::Malloc(8, callerA),
+                                      0, callerA));
+    delete[] sites;
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("MemoryTracker", MemoryTrackerTestClass, TestMemoryTracker)
@@ -0,0 +1,124 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkPixelRef.h"
+
+static const int kSize = 256;
+static const int kScale = 8;
+
+// black, with a white column every kScale pixels
+static void make_columns(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, kSize, kSize);
+    bm->allocPixels();
+    bm->eraseColor(SK_ColorBLACK);
+    for (int y = 0; y < kSize; y++) {
+        for (int x = 3; x < kSize; x += kScale) {
+            *bm->getAddr32(x, y) = SK_ColorWHITE;
+        }
+    }
+}
+
+// draw bm filtered at 1/kScale, and return the brightest resulting green
+static unsigned draw_minified(const SkBitmap& bm) {
+    SkBitmap dst;
+    dst.setConfig(SkBitmap::kARGB_8888_Config, kSize / kScale,
+                  kSize / kScale);
+    dst.allocPixels();
+    dst.eraseColor(0);
+
+    SkCanvas canvas(dst);
+    SkScalar scale = SK_Scalar1 / kScale;
+    canvas.scale(scale, scale);
+    SkPaint paint;
+    paint.setFilterBitmap(true);
+    canvas.drawBitmap(bm, 0, 0, &paint);
+
+    unsigned maxG = 0;
+    for (int y = 0; y < dst.height(); y++) {
+        for (int x = 0; x < dst.width(); x++) {
+            maxG = SkMax32(maxG, SkGetPackedG32(*dst.getAddr32(x, y)));
+        }
+    }
+    return maxG;
+}
+
+static void* level_pixels(SkBitmap* bm) {
+    SkBitmap level;
+    if (bm->extractMipLevel(&level, 4 * SK_Fixed1, 0) <= 0) {
+        return NULL;
+    }
+    return level.getPixels();
+}
+
+static void test_sharing(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    make_columns(&bm);
+    bm.buildMipMap();
+    REPORTER_ASSERT(reporter, bm.hasMipMap());
+    REPORTER_ASSERT(reporter, 2 == bm.extractMipLevel(NULL, 4 * SK_Fixed1, 0));
+    // the smallest level can be reached
+    REPORTER_ASSERT(reporter, 8 == bm.extractMipLevel(NULL,
+                                                      kSize * SK_Fixed1, 0));
+
+    // another bitmap on the same pixels shares the levels
+    SkBitmap other;
+    other.setConfig(bm.config(), bm.width(), bm.height());
+    other.setPixelRef(bm.pixelRef());
+    other.buildMipMap();
+    REPORTER_ASSERT(reporter, level_pixels(&bm) == level_pixels(&other));
+
+    // but not once the pixels have changed
+    bm.pixelRef()->notifyPixelsChanged();
+    SkBitmap changed;
+    changed.setConfig(bm.config(), bm.width(), bm.height());
+    changed.setPixelRef(bm.pixelRef());
+    changed.buildMipMap();
+    REPORTER_ASSERT(reporter, level_pixels(&bm) != level_pixels(&changed));
+}
+
+static void test_minify(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    make_columns(&bm);
+
+    // bilerp alone mixes one white column with a black one
+    REPORTER_ASSERT(reporter, draw_minified(bm) > 96);
+    REPORTER_ASSERT(reporter, !bm.hasMipMap());
+
+    // immutable pixels get mip levels, which average all of the columns
+    bm.pixelRef()->setImmutable();
+    REPORTER_ASSERT(reporter, draw_minified(bm) < 64);
+
+    // and cache them on the pixelref
+    SkBitmap other;
+    other.setConfig(bm.config(), bm.width(), bm.height());
+    other.setPixelRef(bm.pixelRef());
+    other.buildMipMap();
+    SkBitmap copy(bm);
+    copy.buildMipMap();
+    REPORTER_ASSERT(reporter, level_pixels(&other) == level_pixels(&copy));
+}
+
+static void TestMipMap(skiatest::Reporter* reporter) {
+    test_sharing(reporter);
+    test_minify(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("MipMap", MipMapTestClass, TestMipMap)
@@ -0,0 +1,90 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkNinePatch.h"
+
+static void make_patch(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 12, 10);
+    bm->allocPixels();
+    for (int y = 0; y < bm->height(); y++) {
+        for (int x = 0; x < bm->width(); x++) {
+            *bm->getAddr32(x, y) = SkPackARGB32(0xFF, x * 20, y * 25,
+                                                (x ^ y) * 16);
+        }
+    }
+}
+
+static void make_dst(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 64, 64);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    return 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// a retained nine-patch has to draw what DrawNine() draws
+static void TestNinePatch(skiatest::Reporter* reporter) {
+    SkBitmap src;
+    make_patch(&src);
+
+    static const SkIRect gMargins[] = {
+        { 3, 2, 4, 3 },
+        { 0, 0, 0, 0 },
+        { 6, 5, 6, 5 },     // nothing to stretch
+        { 8, 6, 8, 6 },     // margins that overlap
+    };
+    static const SkRect gDst[] = {
+        { 0, 0, 12, 10 },                           // unscaled
+        { 5, 7, 50, 33 },
+        { SK_Scalar1 / 3, SK_Scalar1 / 2, 40, 61 }, // fractional
+        { 10, 10, 16, 14 },                         // smaller than the margins
+        { 20, 20, 20, 40 },                         // empty
+    };
+
+    SkPaint filter;
+    filter.setFilterBitmap(true);
+    filter.setAlpha(0x80);
+    const SkPaint* gPaints[] = { NULL, &filter };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gMargins); i++) {
+        SkNinePatch patch(src, gMargins[i]);
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gDst); j++) {
+            for (size_t k = 0; k < SK_ARRAY_COUNT(gPaints); k++) {
+                SkBitmap expected, actual;
+                make_dst(&expected);
+                make_dst(&actual);
+
+                SkCanvas c0(expected);
+                SkNinePatch::DrawNine(&c0, gDst[j], src, gMargins[i],
+                                      gPaints[k]);
+                SkCanvas c1(actual);
+                patch.draw(&c1, gDst[j], gPaints[k]);
+
+                REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+            }
+        }
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("NinePatch", NinePatchTestClass, TestNinePatch)
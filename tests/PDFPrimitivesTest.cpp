@@ -17,12 +17,21 @@
 #include <string>
 
 #include "Test.h"
+#include "SkCanvas.h"
 #include "SkData.h"
+#include "SkGradientShader.h"
+#include "SkMallocPixelRef.h"
 #include "SkPDFCatalog.h"
+#include "SkPDFDevice.h"
+#include "SkPDFDocument.h"
+#include "SkPDFFont.h"
+#include "SkPDFShader.h"
 #include "SkPDFStream.h"
 #include "SkPDFTypes.h"
+#include "SkPDFUtils.h"
 #include "SkScalar.h"
 #include "SkStream.h"
+#include "SkThreadPool.h"
 
 static bool stream_equals(const SkDynamicMemoryWStream& stream, size_t offset,
                           const void* buffer, size_t len) {
@@ -121,6 +130,394 @@ static void TestObjectRef(skiatest::Reporter* reporter) {
                                             buffer.getOffset()));
 }
 
+static void TestSubstitute(skiatest::Reporter* reporter) {
+    SkRefPtr<SkPDFInt> original = new SkPDFInt(1);
+    original->unref();  // SkRefPtr and new both took a reference.
+    SkRefPtr<SkPDFInt> substitute = new SkPDFInt(2);
+    substitute->unref();  // SkRefPtr and new both took a reference.
+    SkRefPtr<SkPDFObjRef> originalRef = new SkPDFObjRef(original.get());
+    originalRef->unref();  // SkRefPtr and new both took a reference.
+
+    SkPDFCatalog catalog;
+    catalog.setSubstitute(original.get(), substitute.get());
+    catalog.addObject(substitute.get(), false);
+    REPORTER_ASSERT(reporter,
+                    catalog.getSubstituteObject(original.get()) ==
+                        substitute.get());
+    REPORTER_ASSERT(reporter,
+                    catalog.getSubstituteObject(substitute.get()) ==
+                        substitute.get());
+    REPORTER_ASSERT(reporter, !catalog.isReplaced(substitute.get()));
+
+    char expectedResult[] = "1 0 R";
+    SkDynamicMemoryWStream buffer;
+    originalRef->emitObject(&buffer, &catalog, false);
+    REPORTER_ASSERT(reporter, buffer.getOffset() == strlen(expectedResult));
+    REPORTER_ASSERT(reporter, stream_equals(buffer, 0, expectedResult,
+                                            buffer.getOffset()));
+}
+
+static void TestGlyphSet(skiatest::Reporter* reporter) {
+    const uint16_t glyphs[] = { 1, 31, 32, 700 };
+    SkPDFGlyphSet set;
+    set.set(glyphs, 3);
+    REPORTER_ASSERT(reporter, set.has(1));
+    REPORTER_ASSERT(reporter, set.has(31));
+    REPORTER_ASSERT(reporter, set.has(32));
+    REPORTER_ASSERT(reporter, !set.has(0));
+    REPORTER_ASSERT(reporter, !set.has(700));
+    REPORTER_ASSERT(reporter, !set.has(65535));
+
+    SkPDFGlyphSet other;
+    other.set(glyphs + 3, 1);
+    uint32_t hash = set.hash();
+    set.merge(other);
+    REPORTER_ASSERT(reporter, set.has(700));
+    REPORTER_ASSERT(reporter, set.has(32));
+    REPORTER_ASSERT(reporter, set.hash() != hash);
+
+    SkPDFGlyphSetMap map;
+    SkPDFFont* font1 = reinterpret_cast<SkPDFFont*>(1);
+    SkPDFFont* font2 = reinterpret_cast<SkPDFFont*>(2);
+    map.noteGlyphUsage(font1, glyphs, 2);
+    SkPDFGlyphSetMap otherMap;
+    otherMap.noteGlyphUsage(font1, glyphs + 2, 1);
+    otherMap.noteGlyphUsage(font2, glyphs + 3, 1);
+    map.merge(otherMap);
+    REPORTER_ASSERT(reporter, map.count() == 2);
+    REPORTER_ASSERT(reporter, map[0].fFont == font1);
+    REPORTER_ASSERT(reporter, map[0].fGlyphSet->has(32));
+    REPORTER_ASSERT(reporter, !map[0].fGlyphSet->has(700));
+    REPORTER_ASSERT(reporter, map[1].fFont == font2);
+    REPORTER_ASSERT(reporter, map[1].fGlyphSet->has(700));
+    map.reset();
+    REPORTER_ASSERT(reporter, map.count() == 0);
+}
+
+static void TestShaderCache(skiatest::Reporter* reporter) {
+    SkPoint points[2] = { { 0, 0 }, { SkIntToScalar(50), 0 } };
+    SkColor colors[2] = { SK_ColorRED, SK_ColorBLUE };
+    SkShader* shader = SkGradientShader::CreateLinear(
+            points, colors, NULL, 2, SkShader::kClamp_TileMode);
+    SkAutoUnref aur(shader);
+    SkMatrix matrix;
+    matrix.reset();
+
+    SkPDFShader* large = SkPDFShader::getPDFShader(
+            *shader, matrix, SkIRect::MakeWH(100, 100));
+    SkPDFShader* contained = SkPDFShader::getPDFShader(
+            *shader, matrix, SkIRect::MakeXYWH(10, 10, 50, 50));
+    SkPDFShader* larger = SkPDFShader::getPDFShader(
+            *shader, matrix, SkIRect::MakeWH(200, 200));
+    REPORTER_ASSERT(reporter, large != NULL);
+    REPORTER_ASSERT(reporter, contained == large);
+    REPORTER_ASSERT(reporter, larger != large);
+    SkSafeUnref(large);
+    SkSafeUnref(contained);
+    SkSafeUnref(larger);
+}
+
+static void draw_page(SkPDFDocument* doc, SkColor color) {
+    SkISize pageSize = SkISize::Make(100, 100);
+    SkRefPtr<SkPDFDevice> device =
+        new SkPDFDevice(pageSize, pageSize, SkMatrix::I());
+    device->unref();  // SkRefPtr and new both took a reference.
+    SkCanvas canvas(device.get());
+    SkPaint paint;
+    paint.setColor(color);
+    canvas.drawRect(SkRect::MakeWH(50, 50), paint);
+    doc->appendPage(device);
+}
+
+// startxref must point at the xref table and every entry in it at the start
+// of its object.
+static bool check_xref(const std::string& pdf) {
+    size_t startxref = pdf.rfind("startxref\n");
+    if (startxref == std::string::npos)
+        return false;
+    size_t xref = atol(pdf.c_str() + startxref + strlen("startxref\n"));
+    if (pdf.compare(xref, 5, "xref\n") != 0)
+        return false;
+    int first, count;
+    if (sscanf(pdf.c_str() + xref, "xref\n%d %d\n", &first, &count) != 2)
+        return false;
+    size_t entry = pdf.find("0000000000 65535 f \n", xref);
+    if (first != 0 || entry == std::string::npos)
+        return false;
+    for (int objNum = 1; objNum < count; objNum++) {
+        entry += 20;
+        long offset = atol(pdf.c_str() + entry);
+        char header[32];
+        sprintf(header, "%d 0 obj\n", objNum);
+        if (pdf.compare(offset, strlen(header), header) != 0)
+            return false;
+    }
+    return true;
+}
+
+static void TestStreamedDocument(skiatest::Reporter* reporter) {
+    SkDynamicMemoryWStream buffer;
+    {
+        SkPDFDocument doc(&buffer);
+        draw_page(&doc, SK_ColorRED);
+        // translucent, so the page uses a graphic state shared with page 3
+        draw_page(&doc, 0x80008000);
+        draw_page(&doc, 0x80000080);
+        REPORTER_ASSERT(reporter, doc.emitPDF(&buffer));
+        REPORTER_ASSERT(reporter, !doc.emitPDF(&buffer));
+    }
+
+    SkAutoDataUnref data(buffer.copyToData());
+    std::string pdf(static_cast<const char*>(data.data()), data.size());
+    REPORTER_ASSERT(reporter, pdf.compare(0, 8, "%PDF-1.4") == 0);
+    REPORTER_ASSERT(reporter, pdf.find("/Count 3") != std::string::npos);
+    REPORTER_ASSERT(reporter, pdf.rfind("%%EOF") == pdf.size() - 5);
+    REPORTER_ASSERT(reporter, check_xref(pdf));
+
+    // the same pages emitted all at once are laid out correctly as well
+    SkDynamicMemoryWStream wholeBuffer;
+    SkPDFDocument wholeDoc;
+    draw_page(&wholeDoc, SK_ColorRED);
+    draw_page(&wholeDoc, 0x80008000);
+    REPORTER_ASSERT(reporter, wholeDoc.emitPDF(&wholeBuffer));
+    SkAutoDataUnref wholeData(wholeBuffer.copyToData());
+    std::string wholePdf(static_cast<const char*>(wholeData.data()),
+                         wholeData.size());
+    REPORTER_ASSERT(reporter, check_xref(wholePdf));
+}
+
+namespace {
+
+class ColorPageSource : public SkPDFPageSource {
+public:
+    virtual SkPDFDevice* createPage(int pageIndex) {
+        SkISize pageSize = SkISize::Make(100, 100);
+        SkPDFDevice* device =
+            new SkPDFDevice(pageSize, pageSize, SkMatrix::I());
+        SkCanvas canvas(device);
+        SkPaint paint;
+        // every other page is translucent, so those share a graphic state
+        paint.setColor(pageIndex & 1 ? 0x80008000 : SK_ColorRED);
+        canvas.drawRect(SkRect::MakeWH(50, 50), paint);
+        return device;
+    }
+};
+
+}  // namespace
+
+static std::string emit_to_string(SkPDFDocument* doc) {
+    SkDynamicMemoryWStream buffer;
+    doc->emitPDF(&buffer);
+    SkAutoDataUnref data(buffer.copyToData());
+    return std::string(static_cast<const char*>(data.data()), data.size());
+}
+
+static void TestAppendPages(skiatest::Reporter* reporter) {
+    static const int kPageCount = 6;
+    ColorPageSource source;
+
+    SkPDFDocument serialDoc;
+    for (int i = 0; i < kPageCount; i++) {
+        SkRefPtr<SkPDFDevice> device = source.createPage(i);
+        device->unref();  // SkRefPtr and createPage both took a reference.
+        serialDoc.appendPage(device);
+    }
+    std::string serialPdf = emit_to_string(&serialDoc);
+
+    SkPDFDocument doc;
+    SkThreadPool pool(4);
+    REPORTER_ASSERT(reporter, doc.appendPages(&source, kPageCount, &pool));
+    REPORTER_ASSERT(reporter, doc.getPages().count() == kPageCount);
+    std::string pdf = emit_to_string(&doc);
+    REPORTER_ASSERT(reporter, check_xref(pdf));
+    // the same objects as when the pages are drawn one at a time, though
+    // the page dictionaries' entries are in another order
+    REPORTER_ASSERT(reporter, pdf.size() == serialPdf.size());
+
+    SkPDFDocument callerDoc;
+    REPORTER_ASSERT(reporter, callerDoc.appendPages(&source, kPageCount, NULL));
+    REPORTER_ASSERT(reporter,
+                    emit_to_string(&callerDoc).size() == serialPdf.size());
+    REPORTER_ASSERT(reporter, !callerDoc.appendPages(&source, 1, NULL));
+}
+
+namespace {
+
+// Pixels that claim to have been decoded from a JPEG file.
+class JpegPixelRef : public SkMallocPixelRef {
+public:
+    JpegPixelRef(void* addr, size_t size, SkData* jpeg)
+        : SkMallocPixelRef(addr, size, NULL),
+          fJpeg(jpeg) {
+        jpeg->ref();
+    }
+    virtual ~JpegPixelRef() { fJpeg->unref(); }
+
+protected:
+    virtual SkData* onRefEncodedData() {
+        fJpeg->ref();
+        return fJpeg;
+    }
+
+private:
+    SkData* fJpeg;
+};
+
+}  // namespace
+
+static int count_substrings(const std::string& str, const char sub[]) {
+    int count = 0;
+    for (size_t pos = str.find(sub); pos != std::string::npos;
+             pos = str.find(sub, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+static void draw_bitmap_page(SkPDFDocument* doc, const SkBitmap& bitmap) {
+    SkISize pageSize = SkISize::Make(100, 100);
+    SkRefPtr<SkPDFDevice> device =
+        new SkPDFDevice(pageSize, pageSize, SkMatrix::I());
+    device->unref();  // SkRefPtr and new both took a reference.
+    SkCanvas canvas(device.get());
+    canvas.drawBitmap(bitmap, 0, 0);
+    canvas.drawBitmap(bitmap, 20, 20);
+    doc->appendPage(device);
+}
+
+static void TestImages(skiatest::Reporter* reporter) {
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config, 8, 8);
+    bitmap.allocPixels();
+    bitmap.eraseColor(SK_ColorBLUE);
+
+    // a bitmap drawn twice on each of two pages is emitted once
+    SkPDFDocument doc;
+    draw_bitmap_page(&doc, bitmap);
+    draw_bitmap_page(&doc, bitmap);
+    std::string pdf = emit_to_string(&doc);
+    REPORTER_ASSERT(reporter, count_substrings(pdf, "/Subtype /Image") == 1);
+
+    // but once its pixels change, it's a new image
+    SkPDFDocument changedDoc;
+    draw_bitmap_page(&changedDoc, bitmap);
+    bitmap.eraseColor(SK_ColorGREEN);
+    draw_bitmap_page(&changedDoc, bitmap);
+    pdf = emit_to_string(&changedDoc);
+    REPORTER_ASSERT(reporter, count_substrings(pdf, "/Subtype /Image") == 2);
+
+    // the start of an 8x8 three component baseline JPEG file
+    static const uint8_t kJpeg[] = {
+        0xFF, 0xD8,                                     // start of image
+        0xFF, 0xE0, 0x00, 0x04, 0x00, 0x00,             // APP0
+        0xFF, 0xC0, 0x00, 0x11, 0x08, 0x00, 0x08, 0x00, 0x08, 0x03,
+        0x01, 0x11, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01,
+        0xFF, 0xD9,                                     // end of image
+    };
+    SkAutoDataUnref jpeg(SkData::NewWithCopy(kJpeg, sizeof(kJpeg)));
+    SkBitmap jpegBitmap;
+    jpegBitmap.setConfig(SkBitmap::kARGB_8888_Config, 8, 8);
+    size_t size = jpegBitmap.getSize();
+    SkPixelRef* pixelRef =
+        new JpegPixelRef(sk_malloc_throw(size), size, jpeg.get());
+    jpegBitmap.setPixelRef(pixelRef)->unref();
+    jpegBitmap.eraseColor(SK_ColorBLUE);
+
+    SkPDFDocument jpegDoc;
+    draw_bitmap_page(&jpegDoc, jpegBitmap);
+    pdf = emit_to_string(&jpegDoc);
+    REPORTER_ASSERT(reporter, pdf.find("/Filter /DCTDecode") !=
+                              std::string::npos);
+    std::string jpegBytes(reinterpret_cast<const char*>(kJpeg), sizeof(kJpeg));
+    REPORTER_ASSERT(reporter, pdf.find(jpegBytes) != std::string::npos);
+
+    // only the whole image is the JPEG file
+    SkPDFDocument subsetDoc;
+    SkISize pageSize = SkISize::Make(100, 100);
+    SkRefPtr<SkPDFDevice> device =
+        new SkPDFDevice(pageSize, pageSize, SkMatrix::I());
+    device->unref();  // SkRefPtr and new both took a reference.
+    SkCanvas canvas(device.get());
+    SkIRect subset = SkIRect::MakeWH(4, 4);
+    canvas.drawBitmapRect(jpegBitmap, &subset,
+                          SkRect::MakeWH(SkIntToScalar(4), SkIntToScalar(4)));
+    subsetDoc.appendPage(device);
+    pdf = emit_to_string(&subsetDoc);
+    REPORTER_ASSERT(reporter, pdf.find("/DCTDecode") == std::string::npos);
+}
+
+// Clips that consecutive draws share are only emitted once.
+static void TestContentClips(skiatest::Reporter* reporter) {
+    SkISize pageSize = SkISize::Make(300, 200);
+    SkMatrix identity;
+    identity.reset();
+    SkRefPtr<SkPDFDevice> device = new SkPDFDevice(pageSize, pageSize,
+                                                   identity);
+    device->unref();  // SkRefPtr and new both took a reference.
+
+    SkCanvas canvas(device.get());
+    SkPaint paint;
+    canvas.clipRect(SkRect::MakeLTRB(10, 10, 290, 190));
+    for (int i = 0; i < 3; i++) {
+        canvas.save();
+        canvas.clipRect(SkRect::MakeXYWH(SkIntToScalar(20 + i * 90), 20,
+                                         80, 160));
+        paint.setColor(0xFF000000 | (0x40 << (i * 8)));
+        canvas.drawPaint(paint);
+        canvas.restore();
+    }
+    canvas.save();
+    canvas.drawPaint(paint);
+    canvas.restore();
+
+    SkAutoDataUnref content(device->copyContentToData());
+    std::string str(reinterpret_cast<const char*>(content.bytes()),
+                    content.size());
+    // the page clip, then one clip per bar
+    REPORTER_ASSERT(reporter, count_substrings(str, "W n") == 4);
+    REPORTER_ASSERT(reporter, count_substrings(str, "q\n") ==
+                              count_substrings(str, "Q\n"));
+}
+
+// Path operators are written with every operand, in order, even when the
+// path is long enough to need several writes to the stream.
+static void TestEmitPath(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.moveTo(SK_ScalarHalf, 2);
+    path.lineTo(-3, SkIntToScalar(40000));
+    path.cubicTo(1, 2, 3, 4, 5, 6);
+    path.cubicTo(1, 2, 5, 6, 5, 6);
+    path.lineTo(SK_ScalarHalf, 2);
+    path.close();
+
+    SkDynamicMemoryWStream buffer;
+    SkPDFUtils::EmitPath(path, &buffer);
+    const char expected[] = "0.5 2 m\n-3 40000 l\n1 2 3 4 5 6 c\n"
+                            "1 2 5 6 y\n0.5 2 l\nh\n";
+    REPORTER_ASSERT(reporter, buffer.getOffset() == strlen(expected));
+    REPORTER_ASSERT(reporter, stream_equals(buffer, 0, expected,
+                                            strlen(expected)));
+
+    SkPath longPath;
+    std::string longExpected = "0 0 m\n";
+    longPath.moveTo(0, 0);
+    for (int i = 1; i <= 500; i++) {
+        longPath.lineTo(SkIntToScalar(i), SkIntToScalar(i) / 4);
+        SkString segment;
+        segment.printf("%d %d", i, i / 4);
+        static const char* gQuarters[] = { "", ".25", ".5", ".75" };
+        segment.append(gQuarters[i % 4]);
+        segment.append(" l\n");
+        longExpected.append(segment.c_str());
+    }
+    SkDynamicMemoryWStream longBuffer;
+    SkPDFUtils::EmitPath(longPath, &longBuffer);
+    REPORTER_ASSERT(reporter, longBuffer.getOffset() == longExpected.size());
+    REPORTER_ASSERT(reporter, stream_equals(longBuffer, 0,
+                                            longExpected.c_str(),
+                                            longExpected.size()));
+}
+
 static void TestPDFPrimitives(skiatest::Reporter* reporter) {
     SkRefPtr<SkPDFInt> int42 = new SkPDFInt(42);
     int42->unref();  // SkRefPtr and new both took a reference.
@@ -212,6 +609,16 @@ static void TestPDFPrimitives(skiatest::Reporter* reporter) {
     TestCatalog(reporter);
 
     TestObjectRef(reporter);
+
+    TestSubstitute(reporter);
+    TestGlyphSet(reporter);
+    TestShaderCache(reporter);
+
+    TestStreamedDocument(reporter);
+    TestAppendPages(reporter);
+    TestImages(reporter);
+    TestContentClips(reporter);
+    TestEmitPath(reporter);
 }
 
 #include "TestClassDef.h"
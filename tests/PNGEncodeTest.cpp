@@ -0,0 +1,114 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+#include "SkThreadPool.h"
+
+// Tall enough that a parallel encode splits it into several bands.
+static void make_bitmap(SkBitmap* bm, bool opaque) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 256, 600);
+    bm->allocPixels();
+    bm->eraseColor(opaque ? SK_ColorWHITE : 0);
+
+    SkCanvas canvas(*bm);
+    SkRandom rand;
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int i = 0; i < 200; i++) {
+        paint.setColor(rand.nextU() | 0xFF000000);
+        canvas.drawCircle(rand.nextUScalar1() * 256, rand.nextUScalar1() * 600,
+                          rand.nextUScalar1() * 30, paint);
+    }
+}
+
+static bool encode_and_decode(const SkBitmap& src, SkImageEncoder::Speed speed,
+                              SkExecutor* executor, SkBitmap* dst) {
+    SkAutoTDelete<SkImageEncoder> encoder(
+                    SkImageEncoder::Create(SkImageEncoder::kPNG_Type));
+    if (NULL == encoder.get()) {
+        return false;
+    }
+    encoder.get()->setSpeed(speed);
+    encoder.get()->setExecutor(executor);
+
+    SkDynamicMemoryWStream stream;
+    if (!encoder.get()->encodeStream(&stream, src, 100)) {
+        return false;
+    }
+    SkData* data = stream.copyToData();
+    bool success = SkImageDecoder::DecodeMemory(data->data(), data->size(),
+                                        dst, SkBitmap::kARGB_8888_Config,
+                                        SkImageDecoder::kDecodePixels_Mode);
+    data->unref();
+    return success;
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return a.width() == b.width() && a.height() == b.height() &&
+           a.getSize() == b.getSize() &&
+           !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// Every speed, and encoding on several threads, is lossless and gives back
+// the same image.
+static void TestPNGEncode(skiatest::Reporter* reporter) {
+    SkThreadPool pool(2);
+    SkThreadPool noThreads(0);
+    SkExecutor* executors[] = { NULL, &noThreads, &pool };
+    static const SkImageEncoder::Speed gSpeeds[] = {
+        SkImageEncoder::kFast_Speed,
+        SkImageEncoder::kDefault_Speed,
+        SkImageEncoder::kSmallest_Speed,
+    };
+
+    for (int opaque = 0; opaque <= 1; opaque++) {
+        SkBitmap src;
+        make_bitmap(&src, SkToBool(opaque));
+
+        SkBitmap expected;
+        if (!encode_and_decode(src, SkImageEncoder::kDefault_Speed, NULL,
+                               &expected)) {
+            // no PNG support in this build
+            return;
+        }
+        if (opaque) {
+            REPORTER_ASSERT(reporter, equal_pixels(src, expected));
+        }
+
+        for (size_t s = 0; s < SK_ARRAY_COUNT(gSpeeds); s++) {
+            for (size_t e = 0; e < SK_ARRAY_COUNT(executors); e++) {
+                SkBitmap decoded;
+                REPORTER_ASSERT(reporter,
+                                encode_and_decode(src, gSpeeds[s], executors[e],
+                                                  &decoded));
+                REPORTER_ASSERT(reporter, equal_pixels(decoded, expected));
+            }
+        }
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PNGEncode", PNGEncodeTestClass, TestPNGEncode)
@@ -118,8 +118,41 @@ static void test_pack8(skiatest::Reporter* reporter) {
     }
 }
 
+// the table lookups have to see the same indices that Unpack8 writes out
+static void test_unpack_table(skiatest::Reporter* reporter) {
+    uint32_t table32[4];
+    uint16_t table16[4];
+    for (int i = 0; i < 4; i++) {
+        table32[i] = gRand.nextU();
+        table16[i] = (uint16_t)gRand.nextU();
+    }
+
+    for (size_t size = 1; size <= 100; size += 1) {
+        uint8_t src[100], packed[200], index[100];
+        rand_fill(src, size);
+        SkPackBits::Pack8(src, size, packed);
+
+        for (size_t skip = 0; skip < size; skip++) {
+            for (size_t write = 0; skip + write <= size; write++) {
+                uint32_t dst32[100];
+                uint16_t dst16[100];
+                SkPackBits::Unpack8(index, skip, write, packed);
+                SkPackBits::Unpack8To32(dst32, skip, write, packed, table32);
+                SkPackBits::Unpack8To16(dst16, skip, write, packed, table16);
+                bool match = true;
+                for (size_t i = 0; i < write; i++) {
+                    match = match && dst32[i] == table32[index[i]] &&
+                                     dst16[i] == table16[index[i]];
+                }
+                REPORTER_ASSERT(reporter, match);
+            }
+        }
+    }
+}
+
 static void TestPackBits(skiatest::Reporter* reporter) {
     test_pack8(reporter);
+    test_unpack_table(reporter);
     test_pack16(reporter);
 }
 
@@ -1,4 +1,10 @@
 #include "Test.h"
+#include "SkBlurDrawLooper.h"
+#include "SkBlurMaskFilter.h"
+#include "SkCanvas.h"
+#include "SkDiscretePathEffect.h"
+#include "SkLayerDrawLooper.h"
+#include "SkLayerRasterizer.h"
 #include "SkPath.h"
 #include "SkPaint.h"
 
@@ -36,8 +42,116 @@ static void regression_cubic(skiatest::Reporter* reporter) {
     REPORTER_ASSERT(reporter, maxR.contains(strokeR));
 }
 
+// the bounds of the pixels that drawing r with paint (through matrix) touches
+static SkIRect drawn_bounds(const SkRect& r, const SkPaint& paint,
+                            const SkMatrix& matrix) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 200, 200);
+    bm.allocPixels();
+    bm.eraseColor(0);
+    SkCanvas canvas(bm);
+    canvas.concat(matrix);
+    canvas.drawRect(r, paint);
+
+    SkIRect bounds;
+    bounds.setEmpty();
+    for (int y = 0; y < bm.height(); y++) {
+        for (int x = 0; x < bm.width(); x++) {
+            if (*bm.getAddr32(x, y)) {
+                SkIRect pixel = SkIRect::MakeXYWH(x, y, 1, 1);
+                bounds.join(pixel);
+            }
+        }
+    }
+    return bounds;
+}
+
+static void check_fast_bounds(skiatest::Reporter* reporter,
+                              const SkPaint& paint) {
+    REPORTER_ASSERT(reporter, paint.canComputeFastBounds());
+
+    const SkScalar scales[] = { SK_Scalar1, SkIntToScalar(2) };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(scales); i++) {
+        SkMatrix matrix;
+        matrix.setScale(scales[i], scales[i]);
+        const SkRect r = SkRect::MakeXYWH(SkIntToScalar(30), SkIntToScalar(25),
+                                          SkIntToScalar(20), SkIntToScalar(15));
+        SkRect storage, dev;
+        matrix.mapRect(&dev, paint.computeFastBounds(r, &storage));
+        SkIRect fast;
+        dev.roundOut(&fast);
+
+        SkIRect drawn = drawn_bounds(r, paint, matrix);
+        REPORTER_ASSERT(reporter, !drawn.isEmpty());
+        REPORTER_ASSERT(reporter, fast.contains(drawn));
+    }
+}
+
+static void test_fast_bounds(skiatest::Reporter* reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    SkRect r = SkRect::MakeLTRB(0, 0, SkIntToScalar(10), SkIntToScalar(20));
+    SkRect storage;
+    REPORTER_ASSERT(reporter, &r == &paint.computeFastBounds(r, &storage));
+
+    // the cached outset follows the stroke
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeJoin(SkPaint::kBevel_Join);
+    paint.setStrokeWidth(SkIntToScalar(4));
+    SkPaint copy(paint);
+    SkRect expected = r;
+    expected.inset(-SkIntToScalar(2), -SkIntToScalar(2));
+    REPORTER_ASSERT(reporter, paint.computeFastBounds(r, &storage) == expected);
+    // which doesn't count as a difference between paints
+    REPORTER_ASSERT(reporter, copy == paint);
+    paint.setStrokeWidth(SkIntToScalar(10));
+    expected = r;
+    expected.inset(-SkIntToScalar(5), -SkIntToScalar(5));
+    REPORTER_ASSERT(reporter, paint.computeFastBounds(r, &storage) == expected);
+    check_fast_bounds(reporter, paint);
+
+    SkPaint blur;
+    blur.setAntiAlias(true);
+    blur.setColor(SK_ColorBLACK);
+    blur.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(6),
+                                SkBlurMaskFilter::kNormal_BlurStyle,
+                                SkBlurMaskFilter::kHighQuality_BlurFlag))->unref();
+    check_fast_bounds(reporter, blur);
+    blur.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(3),
+                                SkBlurMaskFilter::kOuter_BlurStyle,
+                                SkBlurMaskFilter::kNone_BlurFlag))->unref();
+    check_fast_bounds(reporter, blur);
+
+    SkPaint shadow;
+    shadow.setAntiAlias(true);
+    shadow.setLooper(new SkBlurDrawLooper(SkIntToScalar(4), SkIntToScalar(12),
+                                          -SkIntToScalar(7),
+                                          SK_ColorBLACK))->unref();
+    check_fast_bounds(reporter, shadow);
+    shadow.setStyle(SkPaint::kStroke_Style);
+    shadow.setStrokeWidth(SkIntToScalar(6));
+    shadow.setPathEffect(new SkDiscretePathEffect(SkIntToScalar(4),
+                                                  SkIntToScalar(3)))->unref();
+    check_fast_bounds(reporter, shadow);
+
+    // effects that can't bound what they draw
+    SkPaint none;
+    none.setMaskFilter(SkBlurMaskFilter::Create(SkIntToScalar(3),
+                                SkBlurMaskFilter::kNormal_BlurStyle,
+                                SkBlurMaskFilter::kIgnoreTransform_BlurFlag))->unref();
+    REPORTER_ASSERT(reporter, !none.canComputeFastBounds());
+    none.setMaskFilter(NULL);
+    REPORTER_ASSERT(reporter, none.canComputeFastBounds());
+    none.setLooper(new SkLayerDrawLooper)->unref();
+    REPORTER_ASSERT(reporter, !none.canComputeFastBounds());
+    none.setLooper(NULL);
+    none.setRasterizer(new SkLayerRasterizer)->unref();
+    REPORTER_ASSERT(reporter, !none.canComputeFastBounds());
+}
+
 static void TestPaint(skiatest::Reporter* reporter) {
     // TODO add general paint tests
+    test_fast_bounds(reporter);
 
     // regression tests
     regression_cubic(reporter);
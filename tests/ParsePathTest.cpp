@@ -20,6 +20,29 @@ static void test_to_from(skiatest::Reporter* reporter, const SkPath& path) {
 #endif
 }
 
+// numbers can run together, and have exponents
+static void test_numbers(skiatest::Reporter* reporter) {
+    SkPath path;
+    bool success = SkParsePath::FromSVGString("M.5-1.5.25e1 1e2L+2E-1,3 4e0-5",
+                                              &path);
+    REPORTER_ASSERT(reporter, success);
+    SkPoint pts[4];
+    REPORTER_ASSERT(reporter, 4 == path.getPoints(pts, 4));
+    REPORTER_ASSERT(reporter, pts[0].fX == SkFloatToScalar(0.5f));
+    REPORTER_ASSERT(reporter, pts[0].fY == SkFloatToScalar(-1.5f));
+    REPORTER_ASSERT(reporter, pts[1].fX == SkFloatToScalar(2.5f));
+    REPORTER_ASSERT(reporter, pts[1].fY == SkIntToScalar(100));
+    REPORTER_ASSERT(reporter, pts[2].fX == SkFloatToScalar(0.2f));
+    REPORTER_ASSERT(reporter, pts[2].fY == SkIntToScalar(3));
+    REPORTER_ASSERT(reporter, pts[3].fX == SkIntToScalar(4));
+    REPORTER_ASSERT(reporter, pts[3].fY == SkIntToScalar(-5));
+
+    // a missing coordinate fails, and leaves the path alone
+    REPORTER_ASSERT(reporter, !SkParsePath::FromSVGString("M10", &path));
+    REPORTER_ASSERT(reporter, !SkParsePath::FromSVGString("M1,2L-", &path));
+    REPORTER_ASSERT(reporter, 4 == path.countPoints());
+}
+
 static void TestParsePath(skiatest::Reporter* reporter) {
     static const struct {
         const char* fStr;
@@ -52,6 +75,8 @@ static void TestParsePath(skiatest::Reporter* reporter) {
     test_to_from(reporter, p);
     p.addRoundRect(r, SkFloatToScalar(4), SkFloatToScalar(4.5));
     test_to_from(reporter, p);
+
+    test_numbers(reporter);
 }
 
 #include "TestClassDef.h"
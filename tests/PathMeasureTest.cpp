@@ -1,6 +1,118 @@
 #include "Test.h"
 #include "SkPathMeasure.h"
 
+static void make_two_contours(SkPath* path) {
+    path->addCircle(0, 0, SK_Scalar1 * 10);
+    path->moveTo(0, 0);
+    path->lineTo(SK_Scalar1 * 3, SK_Scalar1 * 4);
+    path->cubicTo(0, SK_Scalar1 * 20, SK_Scalar1 * 20, SK_Scalar1 * 20,
+                  SK_Scalar1 * 20, 0);
+}
+
+// the lengths of path's contours, until the first that has none
+static int get_lengths(SkPathMeasure* meas, SkScalar lengths[], int max) {
+    int count = 0;
+    do {
+        lengths[count++] = meas->getLength();
+    } while (count < max && meas->nextContour());
+    return count;
+}
+
+// measuring a copy (which has the same generation ID), or measuring again
+// after rewinding, gives the same answers
+static void test_reuse(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_two_contours(&path);
+
+    SkPathMeasure meas(path, false);
+    SkScalar lengths[4];
+    int count = get_lengths(&meas, lengths, 4);
+    REPORTER_ASSERT(reporter, 2 == count);
+    REPORTER_ASSERT(reporter, lengths[0] > SK_Scalar1 * 60);
+    REPORTER_ASSERT(reporter, lengths[1] > SK_Scalar1 * 25);
+    REPORTER_ASSERT(reporter, !meas.nextContour());
+
+    SkScalar again[4];
+    meas.rewind();
+    REPORTER_ASSERT(reporter, count == get_lengths(&meas, again, 4));
+    REPORTER_ASSERT(reporter, !memcmp(lengths, again, sizeof(SkScalar) * count));
+
+    SkPath copy(path);
+    meas.setPath(&copy, false);
+    REPORTER_ASSERT(reporter, count == get_lengths(&meas, again, 4));
+    REPORTER_ASSERT(reporter, !memcmp(lengths, again, sizeof(SkScalar) * count));
+
+    // but an edit is noticed
+    copy.offset(SK_Scalar1, 0);
+    copy.lineTo(SK_Scalar1 * 21, SK_Scalar1 * 30);
+    meas.setPath(&copy, false);
+    REPORTER_ASSERT(reporter, count == get_lengths(&meas, again, 4));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(again[0], lengths[0]));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(again[1],
+                                              lengths[1] + SK_Scalar1 * 30));
+
+    // as is forcing the contours closed
+    meas.setPath(&path, true);
+    REPORTER_ASSERT(reporter, count == get_lengths(&meas, again, 4));
+    REPORTER_ASSERT(reporter, again[1] > lengths[1]);
+}
+
+// getPosTans() finds the same positions and tangents as getPosTan()
+static void test_batch(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_two_contours(&path);
+
+    const int N = 50;
+    SkScalar distances[N];
+    SkPoint positions[N];
+    SkVector tangents[N];
+
+    SkPathMeasure batch(path, false);
+    SkPathMeasure single(path, false);
+    do {
+        SkScalar length = batch.getLength();
+        // increasing, then jumping around, and some out of range
+        for (int i = 0; i < N; i++) {
+            distances[i] = i < N / 2 ? length * i / (N / 2) :
+                                       length * ((i * 7) % N) / N;
+        }
+        distances[N - 1] = -SK_Scalar1;
+        distances[N - 2] = length + SK_Scalar1;
+        REPORTER_ASSERT(reporter, batch.getPosTans(distances, N, positions,
+                                                   tangents));
+
+        for (int i = 0; i < N; i++) {
+            SkPoint pos;
+            SkVector tan;
+            REPORTER_ASSERT(reporter, single.getPosTan(distances[i], &pos, &tan));
+            REPORTER_ASSERT(reporter, pos == positions[i]);
+            REPORTER_ASSERT(reporter, tan == tangents[i]);
+        }
+        single.nextContour();
+    } while (batch.nextContour());
+}
+
+static void test_cache(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_two_contours(&path);
+
+    SkPathMeasureCache cache;
+    SkPathMeasure* first;
+    SkScalar length;
+    {
+        SkAutoCachedPathMeasure acm(&cache, path, false);
+        first = &acm.get();
+        length = first->getLength();
+
+        // while it's checked out, someone else gets their own
+        SkAutoCachedPathMeasure acm2(&cache, path, false);
+        REPORTER_ASSERT(reporter, &acm2.get() != first);
+        REPORTER_ASSERT(reporter, acm2.get().getLength() == length);
+    }
+    SkAutoCachedPathMeasure acm(&cache, path, false);
+    REPORTER_ASSERT(reporter, acm.get().getLength() == length);
+}
+
 static void TestPathMeasure(skiatest::Reporter* reporter) {
     SkPath  path;
 
@@ -36,6 +148,10 @@ static void TestPathMeasure(skiatest::Reporter* reporter) {
                  d, p.fX, p.fY, v.fX, v.fY);
 #endif
     }
+
+    test_reuse(reporter);
+    test_batch(reporter);
+    test_cache(reporter);
 }
 
 #include "TestClassDef.h"
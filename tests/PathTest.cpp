@@ -170,6 +170,198 @@ static void test_convexity(skiatest::Reporter* reporter) {
     }
 }
 
+static void test_isRect(skiatest::Reporter* reporter) {
+    SkPath path;
+    REPORTER_ASSERT(reporter, !path.isRect(NULL));
+
+    // an unclosed rect, starting with a vertical side
+    path.moveTo(0, 0);
+    path.lineTo(0, SK_Scalar1);
+    path.lineTo(SK_Scalar1, SK_Scalar1);
+    path.lineTo(SK_Scalar1, 0);
+    SkRect rect;
+    REPORTER_ASSERT(reporter, path.isRect(&rect));
+    REPORTER_ASSERT(reporter, rect == SkRect::MakeWH(SK_Scalar1, SK_Scalar1));
+
+    // back to the start, and closed
+    path.lineTo(0, 0);
+    path.close();
+    REPORTER_ASSERT(reporter, path.isRect(NULL));
+
+    // a side that doesn't go back to the start
+    path.setLastPt(0, SK_Scalar1 / 2);
+    REPORTER_ASSERT(reporter, !path.isRect(NULL));
+
+    // a diagonal
+    path.reset();
+    path.moveTo(0, 0);
+    path.lineTo(SK_Scalar1, 0);
+    path.lineTo(SK_Scalar1, SK_Scalar1);
+    path.lineTo(SK_Scalar1 / 2, SK_Scalar1);
+    REPORTER_ASSERT(reporter, !path.isRect(NULL));
+
+    // an empty side
+    path.reset();
+    path.moveTo(0, 0);
+    path.lineTo(SK_Scalar1, 0);
+    path.lineTo(SK_Scalar1, 0);
+    path.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, !path.isRect(NULL));
+
+    path.reset();
+    path.addOval(SkRect::MakeWH(SK_Scalar1, SK_Scalar1));
+    REPORTER_ASSERT(reporter, !path.isRect(NULL));
+}
+
+static void test_isOval(skiatest::Reporter* reporter) {
+    const SkRect oval = SkRect::MakeWH(SK_Scalar1 * 4, SK_Scalar1 * 2);
+    SkPath path;
+    REPORTER_ASSERT(reporter, !path.isOval(NULL));
+
+    path.addOval(oval);
+    SkRect rect;
+    REPORTER_ASSERT(reporter, path.isOval(&rect));
+    REPORTER_ASSERT(reporter, rect == oval);
+
+    // scaling keeps it an oval, rotating it by 45 degrees doesn't
+    SkMatrix matrix;
+    matrix.setScale(SK_Scalar1 * 2, SK_Scalar1 * 3);
+    SkPath scaled;
+    path.transform(matrix, &scaled);
+    REPORTER_ASSERT(reporter, scaled.isOval(&rect));
+    REPORTER_ASSERT(reporter, rect == SkRect::MakeWH(SK_Scalar1 * 8,
+                                                     SK_Scalar1 * 6));
+    matrix.setRotate(SkIntToScalar(45));
+    path.transform(matrix);
+    REPORTER_ASSERT(reporter, !path.isOval(NULL));
+
+    // so does a copy, but not adding to it
+    path.reset();
+    path.addCircle(SK_Scalar1, SK_Scalar1, SK_Scalar1);
+    SkPath copy(path);
+    REPORTER_ASSERT(reporter, copy.isOval(NULL));
+    copy.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, !copy.isOval(NULL));
+
+    // nor is an oval added to something else
+    path.reset();
+    path.addRect(oval);
+    path.addOval(oval);
+    REPORTER_ASSERT(reporter, !path.isOval(NULL));
+}
+
+static void test_direction(skiatest::Reporter* reporter) {
+    const SkRect rect = SkRect::MakeWH(SK_Scalar1 * 4, SK_Scalar1 * 2);
+    SkPath path;
+    SkPath::Direction dir;
+    REPORTER_ASSERT(reporter, !path.getDirection(&dir));
+
+    path.addRect(rect, SkPath::kCCW_Direction);
+    REPORTER_ASSERT(reporter, path.getDirection(&dir));
+    REPORTER_ASSERT(reporter, SkPath::kCCW_Direction == dir);
+
+    // the same as what's computed
+    static const SkPath::Direction gDirs[] = {
+        SkPath::kCW_Direction, SkPath::kCCW_Direction
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gDirs); i++) {
+        SkPath oval;
+        oval.addOval(rect, gDirs[i]);
+        SkPath traced;
+        SkPath::Iter iter(oval, false);
+        SkPoint pts[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+            switch (verb) {
+                case SkPath::kMove_Verb: traced.moveTo(pts[0]); break;
+                case SkPath::kQuad_Verb: traced.quadTo(pts[1], pts[2]); break;
+                case SkPath::kClose_Verb: traced.close(); break;
+                default: break;
+            }
+        }
+        REPORTER_ASSERT(reporter, traced.getDirection(&dir));
+        REPORTER_ASSERT(reporter, gDirs[i] == dir);
+    }
+
+    // a mirror reverses it
+    SkMatrix matrix;
+    matrix.setScale(-SK_Scalar1, SK_Scalar1);
+    path.transform(matrix);
+    REPORTER_ASSERT(reporter, path.getDirection(&dir));
+    REPORTER_ASSERT(reporter, SkPath::kCW_Direction == dir);
+
+    // concave and degenerate paths have none
+    path.reset();
+    path.addRect(rect);
+    path.addRect(rect);
+    REPORTER_ASSERT(reporter, !path.getDirection(&dir));
+    path.reset();
+    path.moveTo(0, 0);
+    path.lineTo(SK_Scalar1, SK_Scalar1);
+    REPORTER_ASSERT(reporter, !path.getDirection(&dir));
+}
+
+static void test_generationID(skiatest::Reporter* reporter) {
+    SkPath a, b;
+    REPORTER_ASSERT(reporter, a.getGenerationID() != 0);
+    REPORTER_ASSERT(reporter, a.getGenerationID() == a.getGenerationID());
+    // IDs are unique, even for paths with the same contents
+    REPORTER_ASSERT(reporter, a.getGenerationID() != b.getGenerationID());
+
+    a.addRect(SkRect::MakeWH(SK_Scalar1, SK_Scalar1));
+    uint32_t id = a.getGenerationID();
+    SkPath copy(a);
+    REPORTER_ASSERT(reporter, copy.getGenerationID() == id);
+    b = a;
+    REPORTER_ASSERT(reporter, b.getGenerationID() == id);
+
+    // only asking isn't a change
+    a.getBounds();
+    a.getConvexity();
+    a.isRect(NULL);
+    REPORTER_ASSERT(reporter, a.getGenerationID() == id);
+
+    // but any edit is
+    copy.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, copy.getGenerationID() != id);
+    uint32_t copyID = copy.getGenerationID();
+    copy.setFillType(SkPath::kEvenOdd_FillType);
+    REPORTER_ASSERT(reporter, copy.getGenerationID() != copyID);
+    copyID = copy.getGenerationID();
+    copy.offset(SK_Scalar1, 0);
+    REPORTER_ASSERT(reporter, copy.getGenerationID() != copyID);
+    copyID = copy.getGenerationID();
+    copy.setLastPt(SK_Scalar1, SK_Scalar1);
+    REPORTER_ASSERT(reporter, copy.getGenerationID() != copyID);
+    REPORTER_ASSERT(reporter, a.getGenerationID() == id);
+
+    b.reset();
+    REPORTER_ASSERT(reporter, b.getGenerationID() != id);
+    a.swap(b);
+    REPORTER_ASSERT(reporter, b.getGenerationID() == id);
+}
+
+// small paths keep their points inside the path, which copies and swaps with
+// paths on the heap have to cope with
+static void test_inline_points(skiatest::Reporter* reporter) {
+    SkPath rect, oval;
+    rect.addRect(0, 0, SkIntToScalar(10), SkIntToScalar(20));
+    oval.addOval(SkRect::MakeWH(SkIntToScalar(30), SkIntToScalar(40)));
+    SkPath rectCopy(rect), ovalCopy(oval);
+    REPORTER_ASSERT(reporter, rectCopy == rect);
+    REPORTER_ASSERT(reporter, ovalCopy == oval);
+
+    rect.swap(oval);
+    REPORTER_ASSERT(reporter, rect == ovalCopy);
+    REPORTER_ASSERT(reporter, oval == rectCopy);
+    REPORTER_ASSERT(reporter, oval.isRect(NULL));
+
+    rect = oval;
+    REPORTER_ASSERT(reporter, rect == rectCopy);
+    rect.lineTo(SkIntToScalar(5), SkIntToScalar(5));
+    REPORTER_ASSERT(reporter, oval == rectCopy);
+}
+
 void TestPath(skiatest::Reporter* reporter);
 void TestPath(skiatest::Reporter* reporter) {
     {
@@ -222,9 +414,8 @@ void TestPath(skiatest::Reporter* reporter) {
     p.offset(SK_Scalar1*3, SK_Scalar1*4);
     REPORTER_ASSERT(reporter, bounds == p.getBounds());
 
-#if 0 // isRect needs to be implemented
     REPORTER_ASSERT(reporter, p.isRect(NULL));
-    bounds.setEmpty();
+    bounds2.setEmpty();
     REPORTER_ASSERT(reporter, p.isRect(&bounds2));
     REPORTER_ASSERT(reporter, bounds == bounds2);
 
@@ -232,7 +423,6 @@ void TestPath(skiatest::Reporter* reporter) {
     bounds.set(0, 0, SK_Scalar1/2, SK_Scalar1/2);
     p.addRect(bounds);
     REPORTER_ASSERT(reporter, !p.isRect(NULL));
-#endif
 
     SkPoint pt;
 
@@ -242,6 +432,11 @@ void TestPath(skiatest::Reporter* reporter) {
 
     test_convexity(reporter);
     test_convexity2(reporter);
+    test_isRect(reporter);
+    test_isOval(reporter);
+    test_direction(reporter);
+    test_generationID(reporter);
+    test_inline_points(reporter);
 }
 
 #include "TestClassDef.h"
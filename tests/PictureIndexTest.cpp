@@ -0,0 +1,166 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkPictureIndex.h"
+
+namespace {
+
+// Counts the drawRect calls that make it through playback.
+class CountingCanvas : public SkCanvas {
+public:
+    CountingCanvas(const SkBitmap& bm) : SkCanvas(bm), fRectCount(0) {}
+
+    virtual void drawRect(const SkRect& r, const SkPaint& paint) {
+        fRectCount += 1;
+        this->INHERITED::drawRect(r, paint);
+    }
+
+    int fRectCount;
+
+private:
+    typedef SkCanvas INHERITED;
+};
+
+}
+
+static const int kCells = 20;
+static const int kCellSize = 50;
+static const int kSize = kCells * kCellSize;
+
+static void get_clip(SkRect* clip) {
+    clip->set(SkIntToScalar(340), SkIntToScalar(420),
+              SkIntToScalar(495), SkIntToScalar(595));
+}
+
+// draws a kCells x kCells grid of little rects
+static void draw_grid(SkCanvas* canvas, bool replaceClip) {
+    if (replaceClip) {
+        SkRect clip;
+        get_clip(&clip);
+        canvas->clipRect(clip, SkRegion::kReplace_Op);
+    }
+
+    SkPaint paint;
+    for (int y = 0; y < kCells; y++) {
+        for (int x = 0; x < kCells; x++) {
+            paint.setColor(0xFF000000 | (x * 12 << 16) | (y * 12 << 8));
+            SkRect r;
+            r.setXYWH(SkIntToScalar(x * kCellSize + 5),
+                      SkIntToScalar(y * kCellSize + 5),
+                      SkIntToScalar(kCellSize - 10),
+                      SkIntToScalar(kCellSize - 10));
+            canvas->drawRect(r, paint);
+        }
+    }
+    // a stroked rect that spans the whole picture
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(SkIntToScalar(4));
+    SkRect r;
+    r.set(0, 0, SkIntToScalar(kSize), SkIntToScalar(kSize));
+    canvas->drawRect(r, paint);
+}
+
+static void alloc(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 200, 200);
+    bm->allocPixels();
+    bm->eraseColor(SK_ColorWHITE);
+}
+
+static void setup_canvas(SkCanvas* canvas) {
+    canvas->translate(-SkIntToScalar(330), -SkIntToScalar(410));
+    SkRect clip;
+    get_clip(&clip);
+    canvas->clipRect(clip);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void test_playback(skiatest::Reporter* reporter, bool replaceClip) {
+    SkPicture picture;
+    draw_grid(picture.beginRecording(kSize, kSize), replaceClip);
+    picture.endRecording();
+
+    SkBitmap expected, actual;
+    alloc(&expected);
+    alloc(&actual);
+
+    SkCanvas direct(expected);
+    setup_canvas(&direct);
+    draw_grid(&direct, replaceClip);
+
+    CountingCanvas counter(actual);
+    setup_canvas(&counter);
+    picture.draw(&counter);
+
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+    if (replaceClip) {
+        // kReplace_Op can grow the clip, so it disables the index
+        REPORTER_ASSERT(reporter, kCells * kCells + 1 == counter.fRectCount);
+    } else {
+        // the clip touches a 4x4 block of cells, plus the frame
+        REPORTER_ASSERT(reporter, 4 * 4 + 1 == counter.fRectCount);
+    }
+}
+
+static void test_index(skiatest::Reporter* reporter) {
+    SkTDArray<SkPictureIndex::Op> ops;
+    for (int i = 0; i < 10; i++) {
+        SkPictureIndex::Op* op = ops.append();
+        op->fOffset = i * 8;
+        op->fSize = 8;
+        op->fBounds.setXYWH(i * 100, 0, 50, 50);
+    }
+    // one op far outside of the grid
+    SkPictureIndex::Op* op = ops.append();
+    op->fOffset = 80;
+    op->fSize = 8;
+    op->fBounds.set(-5000, -5000, -4000, -4000);
+
+    SkPictureIndex index(ops, 1000, 50);
+    REPORTER_ASSERT(reporter, 11 == index.count());
+
+    bool visible[11];
+    memset(visible, 0, sizeof(visible));
+    SkIRect query;
+    query.set(120, 10, 330, 20);
+    index.search(query, visible);
+    for (int i = 0; i < 11; i++) {
+        REPORTER_ASSERT(reporter, visible[i] == (i >= 1 && i <= 3));
+    }
+
+    memset(visible, 0, sizeof(visible));
+    query.set(-4500, -4500, -4400, -4400);
+    index.search(query, visible);
+    for (int i = 0; i < 11; i++) {
+        REPORTER_ASSERT(reporter, visible[i] == (10 == i));
+    }
+}
+
+static void TestPictureIndex(skiatest::Reporter* reporter) {
+    test_index(reporter);
+    test_playback(reporter, false);
+    test_playback(reporter, true);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PictureIndex", PictureIndexTestClass, TestPictureIndex)
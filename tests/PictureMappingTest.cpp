@@ -0,0 +1,138 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkGradientShader.h"
+#include "SkPath.h"
+#include "SkPicture.h"
+#include "SkRegion.h"
+#include "SkStream.h"
+
+static const int W = 80;
+static const int H = 60;
+
+// uses each kind of object that a picture keeps: bitmaps, matrices, paints
+// (with a shader), paths, regions and pictures
+static void draw_scene(SkCanvas* canvas) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 8, 8);
+    bm.allocPixels();
+    bm.eraseColor(0xFF3080C0);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0xFFC04020);
+    canvas->drawRect(SkRect::MakeLTRB(SkIntToScalar(2), SkIntToScalar(3),
+                                      SkIntToScalar(30), SkIntToScalar(20)),
+                     paint);
+
+    SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(W), SkIntToScalar(H) } };
+    SkColor colors[] = { SK_ColorRED, SK_ColorBLUE };
+    SkSafeUnref(paint.setShader(SkGradientShader::CreateLinear(pts, colors,
+                                        NULL, 2, SkShader::kClamp_TileMode)));
+    SkPath path;
+    path.addCircle(SkIntToScalar(50), SkIntToScalar(20), SkIntToScalar(12));
+    canvas->drawPath(path, paint);
+    paint.setShader(NULL);
+
+    SkRegion region;
+    region.setRect(5, 25, 40, 55);
+    region.op(20, 35, 60, 58, SkRegion::kUnion_Op);
+    canvas->save();
+    canvas->clipRegion(region);
+    SkMatrix matrix;
+    matrix.setScale(SkIntToScalar(3), SkIntToScalar(2));
+    matrix.postTranslate(SkIntToScalar(10), SkIntToScalar(30));
+    canvas->drawBitmapMatrix(bm, matrix, NULL);
+    canvas->restore();
+
+    // the recording refs it
+    SkPicture* nested = new SkPicture;
+    SkCanvas* nestedCanvas = nested->beginRecording(20, 20);
+    nestedCanvas->drawBitmap(bm, SkIntToScalar(2), SkIntToScalar(2), NULL);
+    nestedCanvas->drawColor(0x4000FF00);
+    nested->endRecording();
+    canvas->translate(SkIntToScalar(55), SkIntToScalar(35));
+    canvas->drawPicture(*nested);
+    nested->unref();
+}
+
+static void draw_picture(SkPicture* picture, SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+    SkCanvas canvas(*bm);
+    picture->draw(&canvas);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a);
+    SkAutoLockPixels alpb(b);
+    return 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void TestPictureMapping(skiatest::Reporter* reporter) {
+    SkPicture original;
+    draw_scene(original.beginRecording(W, H));
+    original.endRecording();
+    SkBitmap expected;
+    draw_picture(&original, &expected);
+
+    SkDynamicMemoryWStream stream;
+    original.serializeMappable(&stream);
+    SkData* data = stream.copyToData();
+    REPORTER_ASSERT(reporter, 0 == (data->size() & 3));
+
+    SkPicture* mapped = new SkPicture(data);
+    data->unref();  // the picture keeps it alive
+    REPORTER_ASSERT(reporter, W == mapped->width() && H == mapped->height());
+
+    SkBitmap actual;
+    draw_picture(mapped, &actual);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+    // and again, with everything already unflattened
+    draw_picture(mapped, &actual);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+
+    // a copy shares the mapping, and outlives the original
+    SkPicture* copy = new SkPicture(*mapped);
+    mapped->unref();
+    draw_picture(copy, &actual);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+
+    // which can still be written in the other format
+    SkDynamicMemoryWStream plainStream;
+    copy->serialize(&plainStream);
+    copy->unref();
+    SkAutoDataUnref plainData(plainStream.copyToData());
+    SkMemoryStream plainReader(plainData.data(), plainData.size());
+    SkPicture plain(&plainReader);
+    draw_picture(&plain, &actual);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+
+    // an empty picture has no playback
+    SkPicture empty;
+    SkDynamicMemoryWStream emptyStream;
+    empty.serializeMappable(&emptyStream);
+    SkAutoDataUnref emptyData(emptyStream.copyToData());
+    SkPicture emptyMapped(emptyData.get());
+    REPORTER_ASSERT(reporter, 0 == emptyMapped.width());
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PictureMapping", PictureMappingTestClass, TestPictureMapping)
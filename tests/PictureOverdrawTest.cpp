@@ -0,0 +1,215 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPath.h"
+#include "SkPicture.h"
+
+namespace {
+
+// Counts the draws and saves that make it through playback.
+class CountingCanvas : public SkCanvas {
+public:
+    CountingCanvas(const SkBitmap& bm) : SkCanvas(bm), fDraws(0), fSaves(0) {}
+
+    virtual int save(SaveFlags flags) {
+        fSaves += 1;
+        return this->INHERITED::save(flags);
+    }
+    virtual int saveLayer(const SkRect* bounds, const SkPaint* paint,
+                          SaveFlags flags) {
+        fSaves += 1;
+        return this->INHERITED::saveLayer(bounds, paint, flags);
+    }
+    virtual void drawPaint(const SkPaint& paint) {
+        fDraws += 1;
+        this->INHERITED::drawPaint(paint);
+    }
+    virtual void drawRect(const SkRect& r, const SkPaint& paint) {
+        fDraws += 1;
+        this->INHERITED::drawRect(r, paint);
+    }
+    virtual void drawPath(const SkPath& path, const SkPaint& paint) {
+        fDraws += 1;
+        this->INHERITED::drawPath(path, paint);
+    }
+
+    int fDraws;
+    int fSaves;
+
+private:
+    typedef SkCanvas INHERITED;
+};
+
+}
+
+static const int W = 64;
+static const int H = 48;
+
+static SkRect make_rect(float l, float t, float r, float b) {
+    SkRect rect = { SkFloatToScalar(l), SkFloatToScalar(t),
+                    SkFloatToScalar(r), SkFloatToScalar(b) };
+    return rect;
+}
+
+static void draw_circle(SkCanvas* canvas, float x, float y, float radius,
+                        SkColor color) {
+    SkPath path;
+    path.addCircle(SkFloatToScalar(x), SkFloatToScalar(y),
+                   SkFloatToScalar(radius));
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(color);
+    canvas->drawPath(path, paint);
+}
+
+static void draw_rect(SkCanvas* canvas, const SkRect& r, SkColor color) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(color);
+    canvas->drawRect(r, paint);
+}
+
+typedef void (*SceneProc)(SkCanvas*);
+
+static void scene_covered(SkCanvas* canvas) {
+    draw_circle(canvas, 20, 20, 8, 0x80FF0000);
+    draw_rect(canvas, make_rect(10.5f, 12.5f, 30.5f, 25), 0xC00000FF);
+    // covers both of the above
+    draw_rect(canvas, make_rect(5.5f, 5.25f, 40, 35.5f), SK_ColorWHITE);
+    draw_circle(canvas, 30, 30, 10, 0x8000FF00);
+}
+
+static void scene_empty_saves(SkCanvas* canvas) {
+    canvas->save();
+    canvas->clipRect(make_rect(10, 10, 20, 20));
+    canvas->save();
+    canvas->translate(SkIntToScalar(5), SkIntToScalar(5));
+    canvas->restore();
+    canvas->restore();
+
+    canvas->save();
+    canvas->clipRect(make_rect(5, 5, 50, 40));
+    draw_circle(canvas, 25, 25, 30, 0xFF20C040);
+    canvas->save();
+    canvas->rotate(SkIntToScalar(30));
+    canvas->restore();
+    canvas->restore();
+}
+
+static void scene_layers(SkCanvas* canvas) {
+    draw_circle(canvas, 20, 20, 6, 0xFFFF0000);
+    canvas->saveLayer(NULL, NULL);
+    draw_circle(canvas, 24, 20, 6, 0xFF0000FF);
+    // covers the blue circle, but the red one is underneath the layer
+    draw_rect(canvas, make_rect(5, 5, 40, 35), 0xFF00FF00);
+    canvas->restore();
+    // covers the red circle, and the layer's green rect, but the layer itself
+    // is still drawn
+    draw_rect(canvas, make_rect(2, 2, 45, 40), 0xFF808080);
+}
+
+static void scene_clear(SkCanvas* canvas) {
+    draw_circle(canvas, 20, 20, 6, 0xFFFF0000);
+    draw_rect(canvas, make_rect(40, 5, 60, 30), 0x800000FF);
+    canvas->clear(0x40FFFF00);
+    draw_circle(canvas, 30, 24, 10, 0xFF00FF00);
+}
+
+static void scene_translucent(SkCanvas* canvas) {
+    draw_circle(canvas, 20, 20, 6, 0xFFFF0000);
+    draw_rect(canvas, make_rect(2, 2, 45, 40), 0xF0808080);
+    draw_rect(canvas, make_rect(30, 10, 50, 30), 0xFF0000FF);
+    // covers the blue rect, but only once the clip is applied
+    SkPaint paint;
+    paint.setColor(SK_ColorBLACK);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(SkIntToScalar(30));
+    canvas->drawRect(make_rect(25, 5, 55, 35), paint);
+}
+
+static void scene_clips(SkCanvas* canvas) {
+    // dropped, which moves the clip ops after it
+    draw_rect(canvas, make_rect(5, 5, 25, 20), 0xFFFF0000);
+    canvas->save();
+    canvas->clipRect(make_rect(40, 2, 60, 20));
+    draw_circle(canvas, 50, 10, 8, 0xFF0000FF);
+    canvas->save();
+    canvas->clipRect(make_rect(45, 8, 60, 20));
+    draw_circle(canvas, 52, 14, 6, 0xFF00FFFF);
+    canvas->restore();
+    canvas->restore();
+    draw_rect(canvas, make_rect(2, 2, 30, 30), 0xFF00FF00);
+}
+
+/*  Records the scene with and without the flag, and plays both back (clipped
+    to clip, if it is not NULL). They have to come out the same, and the
+    optimized one has to make exactly draws draw calls and saves save calls.
+ */
+static void test_scene(skiatest::Reporter* reporter, SceneProc proc,
+                       int draws, int saves, const SkRect* clip = NULL) {
+    SkPicture plain, optimized;
+    proc(plain.beginRecording(W, H));
+    plain.endRecording();
+    proc(optimized.beginRecording(W, H,
+                SkPicture::kEliminateOverdraw_RecordingFlag));
+    optimized.endRecording();
+
+    SkBitmap expected, actual;
+    expected.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    expected.allocPixels();
+    expected.eraseColor(0);
+    actual.setConfig(SkBitmap::kARGB_8888_Config, W, H);
+    actual.allocPixels();
+    actual.eraseColor(0);
+
+    CountingCanvas expectedCanvas(expected);
+    CountingCanvas actualCanvas(actual);
+    if (clip) {
+        expectedCanvas.clipRect(*clip);
+        actualCanvas.clipRect(*clip);
+    }
+    plain.draw(&expectedCanvas);
+    optimized.draw(&actualCanvas);
+
+    REPORTER_ASSERT(reporter, draws == actualCanvas.fDraws);
+    REPORTER_ASSERT(reporter, saves == actualCanvas.fSaves);
+    REPORTER_ASSERT(reporter, actualCanvas.fDraws <= expectedCanvas.fDraws);
+
+    SkAutoLockPixels alpe(expected);
+    SkAutoLockPixels alpa(actual);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(),
+                                          actual.getPixels(),
+                                          expected.getSize()));
+}
+
+static void TestPictureOverdraw(skiatest::Reporter* reporter) {
+    test_scene(reporter, scene_covered, 2, 0);
+    test_scene(reporter, scene_empty_saves, 1, 1);
+    test_scene(reporter, scene_layers, 1, 1);
+    test_scene(reporter, scene_clear, 1, 0);
+    test_scene(reporter, scene_translucent, 4, 0);
+    test_scene(reporter, scene_clips, 3, 2);
+
+    // clipped so that the first clipRect comes out empty, which skips ahead
+    // to its (moved) restore, past the inner save
+    SkRect clip = make_rect(0, 25, 35, 48);
+    test_scene(reporter, scene_clips, 1, 1, &clip);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PictureOverdraw", PictureOverdrawTestClass, TestPictureOverdraw)
@@ -0,0 +1,188 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkColorShader.h"
+#include "SkOverdrawDevice.h"
+#include "SkPicture.h"
+#include "SkPictureProfile.h"
+#include "SkString.h"
+
+static const SkPictureProfile::Stat* find_op(const SkPictureProfile& profile,
+                                             const char name[]) {
+    for (int i = 0; i < SkPictureProfile::kOpTypeCount; i++) {
+        const char* opName = SkPictureProfile::OpName(i);
+        if (opName && !strcmp(opName, name)) {
+            return &profile.op(i);
+        }
+    }
+    return NULL;
+}
+
+static void test_profile(skiatest::Reporter* reporter) {
+    SkPaint aa;
+    aa.setAntiAlias(true);
+    SkPaint shaded;
+    shaded.setShader(SkNEW_ARGS(SkColorShader, (SK_ColorRED)))->unref();
+    shaded.setXfermodeMode(SkXfermode::kMultiply_Mode);
+
+    SkPicture picture;
+    SkCanvas* recorder = picture.beginRecording(100, 100);
+    recorder->save();
+    recorder->translate(SkIntToScalar(10), SkIntToScalar(10));
+    recorder->drawRect(SkRect::MakeWH(SkIntToScalar(20), SkIntToScalar(20)),
+                       aa);
+    recorder->drawRect(SkRect::MakeWH(SkIntToScalar(30), SkIntToScalar(30)),
+                       shaded);
+    recorder->restore();
+    recorder->drawPaint(shaded);
+    picture.endRecording();
+
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 100, 100);
+    bm.allocPixels();
+    bm.eraseColor(0);
+    SkCanvas canvas(bm);
+
+    SkPictureProfile profile;
+    picture.profile(&canvas, &profile);
+
+    REPORTER_ASSERT(reporter, 6 == profile.total().fCount);
+    REPORTER_ASSERT(reporter, 2 == find_op(profile, "DRAW_RECT")->fCount);
+    REPORTER_ASSERT(reporter, 1 == find_op(profile, "DRAW_PAINT")->fCount);
+    REPORTER_ASSERT(reporter, 1 == find_op(profile, "SAVE")->fCount);
+    REPORTER_ASSERT(reporter, 1 == find_op(profile, "TRANSLATE")->fCount);
+    REPORTER_ASSERT(reporter, 0 == find_op(profile, "DRAW_PATH")->fCount);
+
+    REPORTER_ASSERT(reporter, 1 ==
+            profile.feature(SkPictureProfile::kAntiAlias_Feature).fCount);
+    REPORTER_ASSERT(reporter, 2 ==
+            profile.feature(SkPictureProfile::kShader_Feature).fCount);
+    REPORTER_ASSERT(reporter, 2 ==
+            profile.feature(SkPictureProfile::kXfermode_Feature).fCount);
+    REPORTER_ASSERT(reporter, 0 ==
+            profile.feature(SkPictureProfile::kMaskFilter_Feature).fCount);
+
+    double sum = 0;
+    for (int i = 0; i < SkPictureProfile::kOpTypeCount; i++) {
+        REPORTER_ASSERT(reporter, profile.op(i).fUSecs >= 0);
+        sum += profile.op(i).fUSecs;
+    }
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(SkDoubleToScalar(sum),
+                              SkDoubleToScalar(profile.total().fUSecs)));
+
+    SkString str;
+    profile.toString(&str);
+    REPORTER_ASSERT(reporter, strstr(str.c_str(), "DRAW_RECT"));
+    REPORTER_ASSERT(reporter, strstr(str.c_str(), "antialias"));
+    REPORTER_ASSERT(reporter, !strstr(str.c_str(), "DRAW_PATH"));
+
+    // a second pass adds to the totals, until they are reset
+    picture.profile(&canvas, &profile);
+    REPORTER_ASSERT(reporter, 12 == profile.total().fCount);
+    profile.reset();
+    REPORTER_ASSERT(reporter, 0 == profile.total().fCount);
+    REPORTER_ASSERT(reporter, 0 == profile.total().fUSecs);
+}
+
+static void test_overdraw(skiatest::Reporter* reporter) {
+    SkOverdrawDevice* device = SkNEW_ARGS(SkOverdrawDevice, (10, 10));
+    SkCanvas canvas(device);
+    device->unref();
+
+    REPORTER_ASSERT(reporter, 0 == device->maxCount());
+
+    // what's drawn doesn't matter, so a transparent color or a shader with
+    // an xfermode count the same as anything else
+    SkPaint paint;
+    paint.setColor(0);
+    canvas.drawRect(SkRect::MakeWH(SkIntToScalar(10), SkIntToScalar(10)),
+                    paint);
+    SkPaint shaded;
+    shaded.setShader(SkNEW_ARGS(SkColorShader, (SK_ColorRED)))->unref();
+    shaded.setXfermodeMode(SkXfermode::kDstIn_Mode);
+    canvas.drawRect(SkRect::MakeWH(SkIntToScalar(5), SkIntToScalar(5)),
+                    shaded);
+
+    REPORTER_ASSERT(reporter, 2 == device->countAt(0, 0));
+    REPORTER_ASSERT(reporter, 2 == device->countAt(4, 4));
+    REPORTER_ASSERT(reporter, 1 == device->countAt(5, 5));
+    REPORTER_ASSERT(reporter, 1 == device->countAt(9, 0));
+    REPORTER_ASSERT(reporter, 2 == device->maxCount());
+    REPORTER_ASSERT(reporter, 100 == device->countCovered());
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(
+                              SkFloatToScalar(device->averageCount()),
+                              SkFloatToScalar(1.25f)));
+
+    SkBitmap heatmap;
+    device->heatmap(&heatmap);
+    REPORTER_ASSERT(reporter, 10 == heatmap.width());
+    REPORTER_ASSERT(reporter, 10 == heatmap.height());
+    {
+        SkAutoLockPixels alp(heatmap);
+        REPORTER_ASSERT(reporter, *heatmap.getAddr32(0, 0) !=
+                                  *heatmap.getAddr32(9, 9));
+        REPORTER_ASSERT(reporter, 0xFF == SkGetPackedA32(
+                                  *heatmap.getAddr32(9, 9)));
+    }
+
+    device->resetCounts();
+    REPORTER_ASSERT(reporter, 0 == device->countCovered());
+    device->heatmap(&heatmap);
+    {
+        SkAutoLockPixels alp(heatmap);
+        REPORTER_ASSERT(reporter, 0 == *heatmap.getAddr32(3, 3));
+    }
+
+    // a layer's draws count, and so does compositing it
+    canvas.saveLayer(NULL, NULL);
+    canvas.drawRect(SkRect::MakeWH(SkIntToScalar(5), SkIntToScalar(5)),
+                    paint);
+    canvas.drawRect(SkRect::MakeWH(SkIntToScalar(2), SkIntToScalar(2)),
+                    paint);
+    canvas.restore();
+    REPORTER_ASSERT(reporter, 3 == device->countAt(0, 0));
+    REPORTER_ASSERT(reporter, 2 == device->countAt(4, 4));
+    REPORTER_ASSERT(reporter, 1 == device->countAt(9, 9));
+
+    // clear writes every pixel
+    canvas.clear(SK_ColorWHITE);
+    REPORTER_ASSERT(reporter, 4 == device->countAt(0, 0));
+    REPORTER_ASSERT(reporter, 2 == device->countAt(9, 9));
+
+    // a picture played back into it counts the same
+    SkPicture picture;
+    SkCanvas* recorder = picture.beginRecording(10, 10);
+    recorder->drawRect(SkRect::MakeWH(SkIntToScalar(10), SkIntToScalar(1)),
+                       paint);
+    picture.endRecording();
+    device->resetCounts();
+    canvas.drawPicture(picture);
+    canvas.drawPicture(picture);
+    REPORTER_ASSERT(reporter, 2 == device->countAt(7, 0));
+    REPORTER_ASSERT(reporter, 0 == device->countAt(7, 1));
+}
+
+static void TestPictureProfile(skiatest::Reporter* reporter) {
+    test_profile(reporter);
+    test_overdraw(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PictureProfile", PictureProfileTestClass, TestPictureProfile)
@@ -0,0 +1,336 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPathHeap.h"
+#include "SkPictureRecord.h"
+
+// Identical paths are only stored once.
+static void test_path_heap(skiatest::Reporter* reporter) {
+    SkPathHeap* heap = new SkPathHeap;
+    static const int kDistinct = 300;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < kDistinct; i++) {
+            SkPath path;
+            path.moveTo(0, 0);
+            path.lineTo(SkIntToScalar(i), SkIntToScalar(10));
+            path.lineTo(SkIntToScalar(10), SkIntToScalar(i % 7));
+            REPORTER_ASSERT(reporter, i + 1 == heap->append(path));
+        }
+    }
+    REPORTER_ASSERT(reporter, kDistinct == heap->count());
+
+    // the fill type counts, and so does the order of the points
+    SkPath path;
+    path.moveTo(0, 0);
+    path.lineTo(SkIntToScalar(1), SkIntToScalar(10));
+    path.lineTo(SkIntToScalar(10), SkIntToScalar(1));
+    REPORTER_ASSERT(reporter, 2 == heap->append(path));
+    path.setFillType(SkPath::kEvenOdd_FillType);
+    REPORTER_ASSERT(reporter, kDistinct + 1 == heap->append(path));
+    SkPath reversed;
+    reversed.moveTo(0, 0);
+    reversed.lineTo(SkIntToScalar(10), SkIntToScalar(1));
+    reversed.lineTo(SkIntToScalar(1), SkIntToScalar(10));
+    REPORTER_ASSERT(reporter, kDistinct + 2 == heap->append(reversed));
+    REPORTER_ASSERT(reporter, (*heap)[kDistinct + 1] == reversed);
+    heap->unref();
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return a.getSize() == b.getSize() &&
+           !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void draw_pixels(SkPicture* picture, int size, SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, size, size);
+    bm->allocPixels();
+    bm->eraseColor(0);
+    SkCanvas canvas(*bm);
+    picture->draw(&canvas);
+}
+
+// Small pictures are recorded in place, however deeply they nest, and play
+// back as they would have by reference, even where they lie outside the
+// recording's bounds.
+static void test_inline_pictures(skiatest::Reporter* reporter) {
+    SkPicture pictures[4];
+    for (int i = 0; i < 4; i++) {
+        SkCanvas* canvas = pictures[i].beginRecording(20, 20);
+        SkPaint paint;
+        paint.setColor(0xFF000000 | (0x3F << (i * 6)));
+        canvas->translate(SkIntToScalar(10), SkIntToScalar(5));
+        canvas->clipRect(SkRect::MakeWH(SkIntToScalar(60), SkIntToScalar(60)));
+        canvas->drawRect(SkRect::MakeWH(SkIntToScalar(30), SkIntToScalar(8)),
+                         paint);
+        if (i > 0) {
+            canvas->drawPicture(pictures[i - 1]);
+        }
+        pictures[i].endRecording();
+    }
+
+    SkPictureRecord* record =
+        new SkPictureRecord(SkPicture::kInlineSmallPictures_RecordingFlag);
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kNo_Config, 20, 20);
+    record->setBitmapDevice(bm);
+    record->drawPicture(pictures[3]);
+    REPORTER_ASSERT(reporter, 0 == record->getPictureRefs().count());
+    REPORTER_ASSERT(reporter, 4 == record->getPaints().count());
+
+    // nor are pictures that are still recording
+    SkPicture recording;
+    recording.beginRecording(20, 20)->drawColor(SK_ColorRED);
+    record->drawPicture(recording);
+    REPORTER_ASSERT(reporter, 1 == record->getPictureRefs().count());
+    recording.endRecording();
+
+    // but large ones are only referenced
+    SkPicture large;
+    SkCanvas* canvas = large.beginRecording(20, 20);
+    for (int i = 0; i < 200; i++) {
+        canvas->drawColor(SK_ColorBLUE);
+    }
+    large.endRecording();
+    record->drawPicture(large);
+    REPORTER_ASSERT(reporter, 2 == record->getPictureRefs().count());
+    record->unref();
+
+    SkPicture byRef, inlined;
+    byRef.beginRecording(20, 20)->drawPicture(pictures[3]);
+    byRef.endRecording();
+    inlined.beginRecording(20, 20,
+        SkPicture::kInlineSmallPictures_RecordingFlag)->drawPicture(
+            pictures[3]);
+    inlined.endRecording();
+
+    SkBitmap expected, actual;
+    draw_pixels(&byRef, 80, &expected);
+    draw_pixels(&inlined, 80, &actual);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+}
+
+static const SkRect gLayerRect = { 10, 10, 40, 30 };
+
+static void begin_layer(SkCanvas* canvas, const SkRect* bounds, bool layer) {
+    if (layer) {
+        canvas->saveLayerAlpha(bounds, 0x80);
+    } else {
+        canvas->save();
+    }
+}
+
+static void draw_rect_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    begin_layer(canvas, NULL, layer);
+    canvas->translate(SkIntToScalar(5), 0);
+    canvas->drawRect(gLayerRect, paint);
+    canvas->restore();
+}
+
+// the rect under the layer still shows through it
+static void draw_covering_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(gLayerRect, paint);
+    draw_rect_layer(canvas, layer);
+}
+
+static void draw_empty_layer(SkCanvas* canvas, bool layer) {
+    begin_layer(canvas, NULL, layer);
+    canvas->restore();
+}
+
+static void draw_bounded_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    SkRect bounds = gLayerRect;
+    bounds.inset(-SkIntToScalar(4), -SkIntToScalar(4));
+    begin_layer(canvas, &bounds, layer);
+    canvas->drawOval(gLayerRect, paint);
+    canvas->restore();
+}
+
+static void draw_clipping_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    SkRect bounds = gLayerRect;
+    bounds.inset(SkIntToScalar(4), SkIntToScalar(4));
+    begin_layer(canvas, &bounds, layer);
+    canvas->drawRect(gLayerRect, paint);
+    canvas->restore();
+}
+
+static void draw_two_rects_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    begin_layer(canvas, NULL, layer);
+    canvas->drawRect(gLayerRect, paint);
+    canvas->drawRect(SkRect::MakeWH(SkIntToScalar(20), SkIntToScalar(20)),
+                     paint);
+    canvas->restore();
+}
+
+static void draw_hairline_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    paint.setStyle(SkPaint::kStroke_Style);
+    begin_layer(canvas, NULL, layer);
+    canvas->drawRect(gLayerRect, paint);
+    canvas->restore();
+}
+
+static void draw_text_layer(SkCanvas* canvas, bool layer) {
+    SkPaint paint;
+    begin_layer(canvas, NULL, layer);
+    canvas->drawText("ww", 2, SkIntToScalar(10), SkIntToScalar(30), paint);
+    canvas->restore();
+}
+
+static size_t record_size(void (*proc)(SkCanvas*, bool), bool layer) {
+    SkPictureRecord* record = new SkPictureRecord(0);
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kNo_Config, 100, 100);
+    record->setBitmapDevice(bm);
+    proc(record, layer);
+    size_t size = record->writeStream().size();
+    record->unref();
+    return size;
+}
+
+static void alloc_white(SkBitmap* bm, int size) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, size, size);
+    bm->allocPixels();
+    bm->eraseColor(SK_ColorWHITE);
+}
+
+static bool close_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            SkPMColor ca = *a.getAddr32(x, y);
+            SkPMColor cb = *b.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                int diff = (int)((ca >> shift) & 0xFF) -
+                           (int)((cb >> shift) & 0xFF);
+                if (diff < -1 || diff > 1) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// A layer holding a single draw that can take its alpha is recorded as a
+// save, as if the layer had never been made, and draws (nearly) the same.
+static void test_fold_layers(skiatest::Reporter* reporter) {
+    static const struct {
+        void (*fProc)(SkCanvas*, bool);
+        bool fFolds;
+    } gRec[] = {
+        { draw_rect_layer,      true },
+        { draw_covering_layer,  true },
+        { draw_empty_layer,     true },
+        { draw_bounded_layer,   true },
+        { draw_clipping_layer,  false },
+        { draw_two_rects_layer, false },
+        { draw_hairline_layer,  false },
+        { draw_text_layer,      false },
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+        bool folded = record_size(gRec[i].fProc, true) ==
+                      record_size(gRec[i].fProc, false);
+        REPORTER_ASSERT(reporter, gRec[i].fFolds == folded);
+
+        SkBitmap expected;
+        alloc_white(&expected, 50);
+        SkCanvas liveCanvas(expected);
+        gRec[i].fProc(&liveCanvas, true);
+
+        for (int pass = 0; pass < 2; pass++) {
+            SkPicture picture;
+            gRec[i].fProc(picture.beginRecording(50, 50, pass ?
+                    SkPicture::kEliminateOverdraw_RecordingFlag : 0), true);
+            picture.endRecording();
+
+            SkBitmap actual;
+            alloc_white(&actual, 50);
+            SkCanvas playbackCanvas(actual);
+            picture.draw(&playbackCanvas);
+            REPORTER_ASSERT(reporter, close_pixels(expected, actual));
+        }
+    }
+
+    // a layer that is fully transparent is not drawn at all
+    SkBitmap bm;
+    alloc_white(&bm, 50);
+    SkCanvas canvas(bm);
+    canvas.saveLayerAlpha(NULL, 0);
+    REPORTER_ASSERT(reporter, canvas.getTotalClip().isEmpty());
+    canvas.drawColor(SK_ColorRED);
+    canvas.restore();
+    REPORTER_ASSERT(reporter, !canvas.getTotalClip().isEmpty());
+    SkAutoLockPixels alp(bm);
+    REPORTER_ASSERT(reporter, SK_ColorWHITE == *bm.getAddr32(25, 25));
+}
+
+// Each distinct paint and matrix is flattened once, however often it is used,
+// and keeps the index it was first given.
+static void TestPictureRecord(skiatest::Reporter* reporter) {
+    SkPictureRecord* record = new SkPictureRecord(0);
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kNo_Config, 100, 100);
+    record->setBitmapDevice(bm);
+
+    static const int kDistinct = 2000;
+    const SkRect r = SkRect::MakeWH(SkIntToScalar(10), SkIntToScalar(10));
+    for (int pass = 0; pass < 3; pass++) {
+        for (int i = 0; i < kDistinct; i++) {
+            SkPaint paint;
+            paint.setColor(0xFF000000 | i);
+            SkMatrix matrix;
+            matrix.setTranslate(SkIntToScalar(i % 50), 0);
+            record->setMatrix(matrix);
+            record->drawRect(r, paint);
+        }
+    }
+
+    const SkTDArray<const SkFlatPaint*>& paints = record->getPaints();
+    REPORTER_ASSERT(reporter, kDistinct == paints.count());
+    const SkTDArray<const SkFlatMatrix*>& matrices = record->getMatrices();
+    REPORTER_ASSERT(reporter, 50 == matrices.count());
+    for (int i = 0; i < paints.count(); i++) {
+        REPORTER_ASSERT(reporter, i + 1 == paints[i]->index());
+    }
+
+    // recording again starts over
+    record->reset();
+    SkPaint paint;
+    record->drawRect(r, paint);
+    REPORTER_ASSERT(reporter, 1 == record->getPaints().count());
+    REPORTER_ASSERT(reporter, 1 == record->getPaints()[0]->index());
+    record->unref();
+
+    test_path_heap(reporter);
+    test_inline_pictures(reporter);
+    test_fold_layers(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PictureRecord", PictureRecordTestClass, TestPictureRecord)
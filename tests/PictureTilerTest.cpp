@@ -0,0 +1,264 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkGradientShader.h"
+#include "SkPicture.h"
+#include "SkPictureTiler.h"
+#include "SkRandom.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
+
+namespace {
+
+class CountRunnable : public SkRunnable {
+public:
+    CountRunnable(int32_t* counter) : fCounter(counter) {}
+    virtual void run() { sk_atomic_inc(fCounter); }
+private:
+    int32_t* fCounter;
+};
+
+}
+
+static void test_threadpool(skiatest::Reporter* reporter, int threadCount) {
+    SkThreadPool pool(threadCount);
+    REPORTER_ASSERT(reporter, pool.threadCount() == threadCount);
+
+    int32_t counter = 0;
+    CountRunnable runnable(&counter);
+    for (int pass = 1; pass <= 2; pass++) {
+        for (int i = 0; i < 100; i++) {
+            pool.add(&runnable);
+        }
+        pool.wait();
+        REPORTER_ASSERT(reporter, 100 * pass == counter);
+    }
+}
+
+static void record_content(SkPicture* picture, int width, int height,
+                           bool rectsOnly) {
+    SkCanvas* canvas = picture->beginRecording(width, height);
+    canvas->drawColor(SK_ColorWHITE);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    if (!rectsOnly) {
+        SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(width), 0 } };
+        SkColor colors[] = { SK_ColorRED, SK_ColorBLUE };
+        SkShader* shader = SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                                    SkShader::kClamp_TileMode);
+        paint.setShader(shader)->unref();
+    }
+
+    SkRandom rand;
+    for (int i = 0; i < 40; i++) {
+        SkRect r;
+        r.setXYWH(rand.nextUScalar1() * width, rand.nextUScalar1() * height,
+                  SkIntToScalar(20), SkIntToScalar(30));
+        if ((i & 1) && !rectsOnly) {
+            canvas->drawOval(r, paint);
+        } else {
+            paint.setColor(rand.nextU() | 0xFF000000);
+            canvas->drawRect(r, paint);
+        }
+    }
+    picture->endRecording();
+}
+
+static void alloc(SkBitmap* bm, int width, int height) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return a.getSize() == b.getSize() &&
+           !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void test_tiled_draw(skiatest::Reporter* reporter, int threadCount) {
+    const int W = 157;
+    const int H = 93;
+
+    // Rects are not affected by where the tile seams fall, so tiled playback
+    // must match a direct draw exactly.
+    {
+        SkPicture picture;
+        record_content(&picture, W, H, true);
+
+        SkBitmap expected, actual;
+        alloc(&expected, W, H);
+        alloc(&actual, W, H);
+
+        SkCanvas canvas(expected);
+        picture.draw(&canvas);
+
+        SkThreadPool pool(threadCount);
+        SkPictureTiler::Draw(&picture, actual, 32, 20, &pool);
+        REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+    }
+
+    // Curves and gradients may differ slightly at the seams (edges are
+    // clipped to each tile), but the threaded result must be identical to
+    // the single-threaded tiled result.
+    {
+        SkPicture picture;
+        record_content(&picture, W, H, false);
+
+        SkBitmap expected, actual;
+        alloc(&expected, W, H);
+        alloc(&actual, W, H);
+
+        SkPictureTiler::Draw(&picture, expected, 32, 20, NULL);
+
+        SkThreadPool pool(threadCount);
+        SkPictureTiler::Draw(&picture, actual, 32, 20, &pool);
+        REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+    }
+}
+
+namespace {
+
+// copies each band into its place in a full-size bitmap
+class CopyBandSink : public SkPictureTiler::BandSink {
+public:
+    CopyBandSink(const SkBitmap& dst, int maxBands)
+        : fDst(dst), fBandCount(0), fMaxBands(maxBands) {}
+
+    virtual bool onBand(const SkBitmap& band, int top) {
+        SkAutoLockPixels alp(band);
+        for (int y = 0; y < band.height(); y++) {
+            memcpy(fDst.getAddr32(0, top + y), band.getAddr32(0, y),
+                   band.width() << 2);
+        }
+        return ++fBandCount < fMaxBands;
+    }
+
+    const SkBitmap& fDst;
+    int             fBandCount;
+    int             fMaxBands;
+};
+
+}
+
+static void test_band_draw(skiatest::Reporter* reporter) {
+    const int W = 157;
+    const int H = 93;
+
+    SkPicture picture;
+    record_content(&picture, W, H, true);
+
+    SkBitmap expected, actual;
+    alloc(&expected, W, H);
+    alloc(&actual, W, H);
+
+    SkCanvas canvas(expected);
+    picture.draw(&canvas);
+
+    // 93 rows in bands of 20 is 5 bands, the last one 13 rows high
+    SkAutoLockPixels alp(actual);
+    CopyBandSink sink(actual, 100);
+    REPORTER_ASSERT(reporter, SkPictureTiler::DrawBands(&picture, W, H, 20,
+                                    SkBitmap::kARGB_8888_Config, &sink));
+    REPORTER_ASSERT(reporter, 5 == sink.fBandCount);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+
+    // the sink can stop the drawing early
+    CopyBandSink stopper(actual, 2);
+    REPORTER_ASSERT(reporter, !SkPictureTiler::DrawBands(&picture, W, H, 20,
+                                    SkBitmap::kARGB_8888_Config, &stopper));
+    REPORTER_ASSERT(reporter, 2 == stopper.fBandCount);
+}
+
+namespace {
+
+// plays a shared picture into a bitmap of its own
+class DrawRunnable : public SkRunnable {
+public:
+    DrawRunnable() : fPicture(NULL) {}
+
+    virtual void run() {
+        SkCanvas canvas(fBitmap);
+        for (int i = 0; i < 10; i++) {
+            fPicture->draw(&canvas);
+        }
+    }
+
+    SkPicture*  fPicture;
+    SkBitmap    fBitmap;
+};
+
+}
+
+static void test_shared_draw(skiatest::Reporter* reporter) {
+    const int W = 157;
+    const int H = 93;
+
+    SkPicture picture;
+    record_content(&picture, W, H, true);
+    REPORTER_ASSERT(reporter, picture.canDrawConcurrently());
+
+    SkBitmap expected;
+    alloc(&expected, W, H);
+    SkCanvas canvas(expected);
+    picture.draw(&canvas);
+
+    const int N = 4;
+    DrawRunnable runnables[N];
+    SkThreadPool pool(N);
+    for (int i = 0; i < N; i++) {
+        runnables[i].fPicture = &picture;
+        alloc(&runnables[i].fBitmap, W, H);
+        pool.add(&runnables[i]);
+    }
+    pool.wait();
+    for (int i = 0; i < N; i++) {
+        REPORTER_ASSERT(reporter, equal_pixels(expected,
+                                               runnables[i].fBitmap));
+    }
+
+    // shaders keep per-draw state, in a picture or in one that it draws
+    SkPicture shaded;
+    record_content(&shaded, W, H, false);
+    REPORTER_ASSERT(reporter, !shaded.canDrawConcurrently());
+
+    SkPicture outer;
+    outer.beginRecording(W, H)->drawPicture(shaded);
+    REPORTER_ASSERT(reporter, !outer.canDrawConcurrently());
+
+    SkPicture empty;
+    REPORTER_ASSERT(reporter, empty.canDrawConcurrently());
+}
+
+static void TestPictureTiler(skiatest::Reporter* reporter) {
+    test_threadpool(reporter, 0);
+    test_threadpool(reporter, 4);
+
+    test_tiled_draw(reporter, 0);
+    test_tiled_draw(reporter, 1);
+    test_tiled_draw(reporter, 4);
+
+    test_band_draw(reporter);
+    test_shared_draw(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PictureTiler", PictureTilerTestClass, TestPictureTiler)
@@ -0,0 +1,122 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkMallocPixelRef.h"
+#include "SkThread.h"
+
+namespace {
+
+// counts its locks, to check which ones reach the subclass
+class CountingPixelRef : public SkPixelRef {
+public:
+    CountingPixelRef() : fLocks(0), fUnlocks(0) {}
+
+    int fLocks, fUnlocks;
+
+protected:
+    virtual void* onLockPixels(SkColorTable** ct) {
+        fLocks += 1;
+        *ct = NULL;
+        return fStorage;
+    }
+    virtual void onUnlockPixels() {
+        fUnlocks += 1;
+    }
+
+private:
+    uint32_t fStorage[4];
+};
+
+// locks and unlocks a shared pixel ref, through a bitmap of its own
+class LockRunnable : public SkRunnable {
+public:
+    LockRunnable() : fSrc(NULL), fOK(true) {}
+
+    const SkBitmap* fSrc;
+    bool            fOK;
+
+    virtual void run() {
+        SkBitmap bm(*fSrc);
+        for (int i = 0; i < 1000; i++) {
+            SkAutoLockPixels alp(bm);
+            fOK = fOK && bm.getPixels() == fSrc->pixelRef()->pixels();
+        }
+    }
+};
+
+}
+
+static void test_prelocked(skiatest::Reporter* reporter) {
+    SkBitmap src;
+    src.setConfig(SkBitmap::kARGB_8888_Config, 8, 8);
+    SkPixelRef* pr = SkNEW_ARGS(SkMallocPixelRef,
+                                (NULL, src.getSize(), NULL));
+    src.setPixelRef(pr)->unref();
+    SkBitmap bm(src);
+
+    // malloc'd pixels are there whether or not they are locked
+    void* pixels = pr->pixels();
+    REPORTER_ASSERT(reporter, NULL != pixels);
+    REPORTER_ASSERT(reporter, 0 == pr->getLockCount());
+    {
+        SkAutoLockPixels alp(bm);
+        REPORTER_ASSERT(reporter, 1 == pr->getLockCount());
+        REPORTER_ASSERT(reporter, pixels == bm.getPixels());
+    }
+    REPORTER_ASSERT(reporter, 0 == pr->getLockCount());
+    REPORTER_ASSERT(reporter, pixels == pr->pixels());
+
+    // but the bitmap only sees them while it has them locked
+    REPORTER_ASSERT(reporter, NULL == bm.getPixels());
+
+    SkTaskGroup group;
+    LockRunnable runnables[4];
+    for (int i = 0; i < 4; i++) {
+        runnables[i].fSrc = &bm;
+        group.add(&runnables[i]);
+    }
+    group.wait();
+    for (int i = 0; i < 4; i++) {
+        REPORTER_ASSERT(reporter, runnables[i].fOK);
+    }
+    REPORTER_ASSERT(reporter, 0 == pr->getLockCount());
+}
+
+// without pre-locking, only the first lock and the last unlock get through
+static void test_nested(skiatest::Reporter* reporter) {
+    CountingPixelRef pr;
+    REPORTER_ASSERT(reporter, NULL == pr.pixels());
+
+    pr.lockPixels();
+    pr.lockPixels();
+    REPORTER_ASSERT(reporter, NULL != pr.pixels());
+    REPORTER_ASSERT(reporter, 1 == pr.fLocks);
+    pr.unlockPixels();
+    REPORTER_ASSERT(reporter, 0 == pr.fUnlocks);
+    pr.unlockPixels();
+    REPORTER_ASSERT(reporter, 1 == pr.fUnlocks);
+    REPORTER_ASSERT(reporter, NULL == pr.pixels());
+}
+
+static void TestPixelRef(skiatest::Reporter* reporter) {
+    test_prelocked(reporter);
+    test_nested(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PixelRef", PixelRefTestClass, TestPixelRef)
@@ -0,0 +1,104 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkGraphics.h"
+#include "SkPurgeableCache.h"
+
+namespace {
+
+class FakeCache : public SkPurgeableCache {
+public:
+    FakeCache(const char name[], Cost cost, size_t bytes)
+        : INHERITED(name, cost), fBytes(bytes), fPurges(0) {}
+
+    size_t  fBytes;
+    int     fPurges;
+
+    virtual size_t bytesUsed() const { return fBytes; }
+    virtual void purgeTo(size_t bytes) {
+        fPurges += 1;
+        if (fBytes > bytes) {
+            fBytes = bytes;
+        }
+    }
+
+private:
+    typedef SkPurgeableCache INHERITED;
+};
+
+}
+
+static bool find_usage(const char name[], size_t* bytes) {
+    const int kMax = 32;
+    SkPurgeableCache::Usage usage[kMax];
+    int count = SkMin32(SkGraphics::GetCacheUsage(usage, kMax), kMax);
+    for (int i = 0; i < count; i++) {
+        if (!strcmp(usage[i].fName, name)) {
+            *bytes = usage[i].fBytesUsed;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The fakes are far larger than the real caches, so that the order in which
+// they are purged doesn't depend on what the other tests left behind.
+static void TestPurgeableCache(skiatest::Reporter* reporter) {
+    const size_t kHuge = 1 << 30;
+    size_t bytes;
+    {
+        FakeCache cheap("test cheap", SkPurgeableCache::kCheap_Cost, kHuge);
+        FakeCache dear("test expensive", SkPurgeableCache::kExpensive_Cost,
+                       kHuge);
+        REPORTER_ASSERT(reporter, find_usage("test cheap", &bytes));
+        REPORTER_ASSERT(reporter, kHuge == bytes);
+        REPORTER_ASSERT(reporter,
+                        SkGraphics::GetTotalCacheUsed() >= 2 * kHuge);
+
+        // trimming a little only touches the cheap one
+        size_t total = SkGraphics::GetTotalCacheUsed();
+        size_t left = SkPurgeableCache::PurgeTo(total - 100);
+        REPORTER_ASSERT(reporter, left <= total - 100);
+        REPORTER_ASSERT(reporter, kHuge - 100 == cheap.fBytes);
+        REPORTER_ASSERT(reporter, kHuge == dear.fBytes);
+        REPORTER_ASSERT(reporter, 0 == dear.fPurges);
+
+        // trimming past the cheap one's size empties it, then starts on the
+        // expensive one
+        left = SkPurgeableCache::PurgeTo(kHuge / 2);
+        REPORTER_ASSERT(reporter, left <= kHuge / 2);
+        REPORTER_ASSERT(reporter, 0 == cheap.fBytes);
+        REPORTER_ASSERT(reporter, dear.fBytes <= kHuge / 2);
+
+        // with no budget, the budget level leaves everything alone
+        REPORTER_ASSERT(reporter, 0 == SkGraphics::GetCacheBudget());
+        const int purges = dear.fPurges;
+        SkGraphics::PurgeToBudget(SkGraphics::kBudget_PurgeLevel);
+        REPORTER_ASSERT(reporter, purges == dear.fPurges);
+
+        REPORTER_ASSERT(reporter,
+                0 == SkGraphics::PurgeToBudget(SkGraphics::kAll_PurgeLevel));
+        REPORTER_ASSERT(reporter, 0 == dear.fBytes);
+    }
+    // deleting a cache unregisters it
+    REPORTER_ASSERT(reporter, !find_usage("test cheap", &bytes));
+    REPORTER_ASSERT(reporter, find_usage("glyphs", &bytes));
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("PurgeableCache", PurgeableCacheTestClass, TestPurgeableCache)
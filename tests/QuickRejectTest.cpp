@@ -0,0 +1,105 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkRandom.h"
+
+// what quickReject() must agree with: whether the rect's device bounds miss
+// the clip's bounds, grown by a pixel for antialiasing (an empty clip misses
+// everything)
+static bool misses_clip(const SkCanvas& canvas, const SkRect& rect) {
+    if (canvas.getTotalClip().isEmpty()) {
+        return true;
+    }
+    SkRect dev;
+    canvas.getTotalMatrix().mapRect(&dev, rect);
+    SkRect clip;
+    clip.set(canvas.getTotalClip().getBounds());
+    clip.inset(-SK_Scalar1, -SK_Scalar1);
+    return !SkRect::Intersects(dev, clip);
+}
+
+static SkScalar next_range(SkRandom& rand, SkScalar min, SkScalar max) {
+    return min + SkScalarMul(rand.nextUScalar1(), max - min);
+}
+
+static void check_rects(skiatest::Reporter* reporter, const SkCanvas& canvas,
+                        SkRandom& rand) {
+    for (int i = 0; i < 200; i++) {
+        SkScalar x = next_range(rand, -SkIntToScalar(100), SkIntToScalar(200));
+        SkScalar y = next_range(rand, -SkIntToScalar(100), SkIntToScalar(200));
+        SkRect r = SkRect::MakeXYWH(x, y,
+                        next_range(rand, SK_Scalar1 / 4, SkIntToScalar(40)),
+                        next_range(rand, SK_Scalar1 / 4, SkIntToScalar(40)));
+        REPORTER_ASSERT(reporter, canvas.quickReject(r, SkCanvas::kAA_EdgeType)
+                                  == misses_clip(canvas, r));
+    }
+}
+
+static void test_scale_translate(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 100, 100);
+    bm.allocPixels();
+    SkCanvas canvas(bm);
+    SkRandom rand;
+
+    canvas.clipRect(SkRect::MakeLTRB(SkIntToScalar(10), SkIntToScalar(20),
+                                     SkIntToScalar(60), SkIntToScalar(50)));
+    check_rects(reporter, canvas, rand);
+
+    // the device clip bounds stay valid while the matrix moves
+    for (int i = 0; i < 4; i++) {
+        canvas.save();
+        canvas.translate(SkIntToScalar(i * 13 - 20), SkIntToScalar(i * 7));
+        if (i & 1) {
+            canvas.scale(-SK_Scalar1 / 2, SkIntToScalar(3));
+        }
+        check_rects(reporter, canvas, rand);
+
+        // but not when the clip changes
+        canvas.save();
+        canvas.clipRect(SkRect::MakeXYWH(0, 0, SkIntToScalar(15),
+                                         SkIntToScalar(15)));
+        check_rects(reporter, canvas, rand);
+        canvas.restore();
+        check_rects(reporter, canvas, rand);
+        canvas.restore();
+    }
+
+    // quickRejectY() compares against the same bounds
+    canvas.translate(0, SkIntToScalar(5));
+    REPORTER_ASSERT(reporter, canvas.quickRejectY(SkIntToScalar(47),
+                                                  SkIntToScalar(60),
+                                                  SkCanvas::kAA_EdgeType));
+    REPORTER_ASSERT(reporter, !canvas.quickRejectY(SkIntToScalar(45),
+                                                   SkIntToScalar(60),
+                                                   SkCanvas::kAA_EdgeType));
+    REPORTER_ASSERT(reporter, canvas.quickRejectY(SkIntToScalar(-5),
+                                                  SkIntToScalar(14),
+                                                  SkCanvas::kAA_EdgeType));
+    REPORTER_ASSERT(reporter, !canvas.quickRejectY(SkIntToScalar(-5),
+                                                   SkIntToScalar(15),
+                                                   SkCanvas::kAA_EdgeType));
+}
+
+static void TestQuickReject(skiatest::Reporter* reporter) {
+    test_scale_translate(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("QuickReject", QuickRejectTestClass, TestQuickReject)
@@ -57,6 +57,33 @@ static void TestRegion(skiatest::Reporter* reporter) {
         }
         REPORTER_ASSERT(reporter, test_rects(rect, N));
     }
+
+    // enough rects for the scanlines to have many intervals, some of them
+    // empty or repeated
+    for (int i = 0; i < 20; i++) {
+        const int N = 300;
+        SkIRect rect[N];
+        for (int j = 0; j < N; j++) {
+            rand_rect(&rect[j], rand);
+        }
+        rect[N - 1] = rect[0];
+        REPORTER_ASSERT(reporter, test_rects(rect, N));
+    }
+
+    // rects that only touch make one rect
+    const SkIRect touching[] = {
+        { 0, 0, 2, 1 },
+        { 2, 0, 4, 1 },
+        { 0, 1, 4, 3 },
+        { 1, 1, 1, 5 },
+    };
+    SkRegion rgn;
+    REPORTER_ASSERT(reporter, rgn.setRects(touching, SK_ARRAY_COUNT(touching)));
+    REPORTER_ASSERT(reporter, rgn.isRect());
+    REPORTER_ASSERT(reporter, test_rects(touching, SK_ARRAY_COUNT(touching)));
+
+    REPORTER_ASSERT(reporter, !rgn.setRects(touching, 0));
+    REPORTER_ASSERT(reporter, rgn.isEmpty());
 }
 
 #include "TestClassDef.h"
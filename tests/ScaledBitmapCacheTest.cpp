@@ -0,0 +1,169 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkPixelRef.h"
+#include "SkRandom.h"
+#include "SkScaledBitmapCache.h"
+#include "SkShader.h"
+
+static const int kSize = 100;
+
+static void make_src(SkBitmap* bm, bool opaque) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, kSize, kSize);
+    bm->allocPixels();
+    SkRandom rand;
+    for (int y = 0; y < kSize; y++) {
+        for (int x = 0; x < kSize; x++) {
+            U8CPU a = opaque ? 0xFF : rand.nextU() & 0xFF;
+            *bm->getAddr32(x, y) = SkPreMultiplyARGB(a, rand.nextU() & 0xFF,
+                                                     x * 255 / kSize,
+                                                     y * 255 / kSize);
+        }
+    }
+    bm->setIsOpaque(opaque);
+}
+
+struct DrawRec {
+    SkScalar    fScaleX, fScaleY;
+    SkScalar    fDx, fDy;
+    bool        fShader;    // fill the device with a clamped shader
+};
+
+static void draw(SkBitmap* dst, const SkBitmap& src, const DrawRec& rec,
+                 U8CPU alpha) {
+    dst->setConfig(SkBitmap::kARGB_8888_Config, 80, 80);
+    dst->allocPixels();
+    dst->eraseColor(0);
+
+    SkCanvas canvas(*dst);
+    canvas.translate(rec.fDx, rec.fDy);
+    canvas.scale(rec.fScaleX, rec.fScaleY);
+    SkPaint paint;
+    paint.setFilterBitmap(true);
+    paint.setAlpha(alpha);
+    if (rec.fShader) {
+        paint.setShader(SkShader::CreateBitmapShader(src,
+                                                SkShader::kClamp_TileMode,
+                                                SkShader::kClamp_TileMode))->unref();
+        SkRect r = SkRect::MakeXYWH(-SkIntToScalar(kSize), -SkIntToScalar(kSize),
+                                    SkIntToScalar(kSize * 4),
+                                    SkIntToScalar(kSize * 4));
+        canvas.drawRect(r, paint);
+    } else {
+        canvas.drawBitmap(src, 0, 0, &paint);
+    }
+}
+
+static int max_diff(const SkBitmap& a, const SkBitmap& b) {
+    int diff = 0;
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            SkPMColor ca = *a.getAddr32(x, y);
+            SkPMColor cb = *b.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                int da = (int)((ca >> shift) & 0xFF) - (int)((cb >> shift) & 0xFF);
+                diff = SkMax32(diff, SkAbs32(da));
+            }
+        }
+    }
+    return diff;
+}
+
+static void test_draws(skiatest::Reporter* reporter, bool opaque) {
+    static const DrawRec gRec[] = {
+        { SK_Scalar1 / 2, SK_Scalar1 / 2, 0, 0, false },
+        { SK_Scalar1 / 2, SK_Scalar1 / 2, SK_Scalar1 / 3, SK_Scalar1 * 7 / 4, false },
+        { SkFloatToScalar(0.37f), SkFloatToScalar(0.7f), SkIntToScalar(5), SkIntToScalar(3), false },
+        { -SK_Scalar1 / 3, SK_Scalar1 / 4, SkIntToScalar(60), SkIntToScalar(9), false },
+        { SkFloatToScalar(0.6f), SkFloatToScalar(0.45f), SkFloatToScalar(10.25f), SkIntToScalar(12), true },
+    };
+
+    SkBitmap src;
+    make_src(&src, opaque);
+    src.pixelRef()->setImmutable();
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+        DrawRec rec = gRec[i];
+        for (int j = 0; j < 3; j++) {
+            // the second draw finds the first one's bitmap, and the third
+            // finds it after moving by whole pixels
+            SkScaledBitmapCache::SetByteLimit(0);
+            SkBitmap ref, dst;
+            draw(&ref, src, rec, 0xFF);
+            SkScaledBitmapCache::SetByteLimit(1024 * 1024);
+            draw(&dst, src, rec, 0xFF);
+            REPORTER_ASSERT(reporter, SkScaledBitmapCache::GetBytesUsed() > 0);
+            // its coordinates are rounded from a different translate
+            REPORTER_ASSERT(reporter, max_diff(ref, dst) <= 1);
+            if (1 == j) {
+                rec.fDx += SkIntToScalar(7);
+                rec.fDy -= SkIntToScalar(2);
+                SkScaledBitmapCache::SetByteLimit(0);
+                draw(&ref, src, rec, 0xFF);
+                SkScaledBitmapCache::SetByteLimit(1024 * 1024);
+            }
+        }
+        SkScaledBitmapCache::Purge();
+        REPORTER_ASSERT(reporter, 0 == SkScaledBitmapCache::GetBytesUsed());
+    }
+}
+
+// draws that the cache can't stand in for leave it alone
+static void test_skipped(skiatest::Reporter* reporter) {
+    SkBitmap src;
+    make_src(&src, true);
+    DrawRec rec = { SK_Scalar1 / 2, SK_Scalar1 / 2, 0, 0, false };
+    SkBitmap dst;
+
+    // mutable pixels
+    draw(&dst, src, rec, 0xFF);
+    REPORTER_ASSERT(reporter, 0 == SkScaledBitmapCache::GetBytesUsed());
+
+    // translucent paints
+    src.pixelRef()->setImmutable();
+    draw(&dst, src, rec, 0x80);
+    REPORTER_ASSERT(reporter, 0 == SkScaledBitmapCache::GetBytesUsed());
+
+    // enlarging
+    rec.fScaleX = rec.fScaleY = SkIntToScalar(2);
+    draw(&dst, src, rec, 0xFF);
+    REPORTER_ASSERT(reporter, 0 == SkScaledBitmapCache::GetBytesUsed());
+
+    rec.fScaleX = rec.fScaleY = SK_Scalar1 / 2;
+    draw(&dst, src, rec, 0xFF);
+    REPORTER_ASSERT(reporter, SkScaledBitmapCache::GetBytesUsed() > 0);
+    SkScaledBitmapCache::Purge();
+}
+
+static void TestScaledBitmapCache(skiatest::Reporter* reporter) {
+    const size_t limit = SkScaledBitmapCache::GetByteLimit();
+    SkScaledBitmapCache::SetByteLimit(1024 * 1024);
+    SkScaledBitmapCache::Purge();
+
+    test_draws(reporter, true);
+    test_draws(reporter, false);
+    test_skipped(reporter);
+
+    SkScaledBitmapCache::SetByteLimit(limit);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ScaledBitmapCache", ScaledBitmapCacheTestClass,
+                 TestScaledBitmapCache)
@@ -0,0 +1,102 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkRandom.h"
+#include "SkScaledBitmapSampler.h"
+#include "SkTemplates.h"
+
+static const int kMaxWidth = 37;
+
+/*  Convert one row of width pixels, both unsampled (which may use the
+    platform's vector procs) and as every other pixel of a row twice as wide
+    (which always uses the portable procs), and check that they agree.
+ */
+static void test_row(skiatest::Reporter* reporter, const uint8_t src[],
+                     int width, SkScaledBitmapSampler::SrcConfig sc,
+                     int srcPixelSize, SkBitmap::Config config) {
+    SkAutoMalloc storage(2 * width * srcPixelSize);
+    uint8_t* wide = (uint8_t*)storage.get();
+    for (int x = 0; x < width; x++) {
+        // the 2x sampler reads the odd pixels
+        memset(wide + 2 * x * srcPixelSize, 0x5A, srcPixelSize);
+        memcpy(wide + (2 * x + 1) * srcPixelSize, src + x * srcPixelSize,
+               srcPixelSize);
+    }
+
+    SkBitmap whole, sampled;
+    whole.setConfig(config, width, 1);
+    whole.allocPixels();
+    sampled.setConfig(config, width, 1);
+    sampled.allocPixels();
+
+    SkScaledBitmapSampler wholeSampler(width, 1, 1);
+    SkScaledBitmapSampler sampledSampler(2 * width, 2, 2);
+    REPORTER_ASSERT(reporter, sampledSampler.scaledWidth() == width);
+    REPORTER_ASSERT(reporter, wholeSampler.begin(&whole, sc, false));
+    REPORTER_ASSERT(reporter, sampledSampler.begin(&sampled, sc, false));
+
+    bool wholeAlpha = wholeSampler.next(src);
+    bool sampledAlpha = sampledSampler.next(wide);
+    REPORTER_ASSERT(reporter, wholeAlpha == sampledAlpha);
+    REPORTER_ASSERT(reporter, !memcmp(whole.getPixels(), sampled.getPixels(),
+                                      width * whole.bytesPerPixel()));
+}
+
+static void TestScaledBitmapSampler(skiatest::Reporter* reporter) {
+    static const struct {
+        SkScaledBitmapSampler::SrcConfig    fSrcConfig;
+        int                                 fSrcPixelSize;
+    } gSrcs[] = {
+        { SkScaledBitmapSampler::kRGB,  3 },
+        { SkScaledBitmapSampler::kRGBX, 4 },
+        { SkScaledBitmapSampler::kRGBA, 4 },
+    };
+    static const SkBitmap::Config gConfigs[] = {
+        SkBitmap::kARGB_8888_Config,
+        SkBitmap::kRGB_565_Config,
+        SkBitmap::kARGB_4444_Config,
+    };
+
+    SkRandom rand;
+    uint8_t src[kMaxWidth * 4];
+    for (int width = 1; width <= kMaxWidth; width++) {
+        for (size_t i = 0; i < SK_ARRAY_COUNT(src); i++) {
+            src[i] = rand.nextU() & 0xFF;
+        }
+        // every other row is opaque, to check what next() reports
+        if (width & 1) {
+            for (int x = 0; x < width; x++) {
+                src[x * 4 + 3] = 0xFF;
+            }
+        } else {
+            // and the edge cases of the premultiply
+            src[3] = 0;
+            src[7] = 0xFF;
+        }
+        for (size_t s = 0; s < SK_ARRAY_COUNT(gSrcs); s++) {
+            for (size_t c = 0; c < SK_ARRAY_COUNT(gConfigs); c++) {
+                test_row(reporter, src, width, gSrcs[s].fSrcConfig,
+                         gSrcs[s].fSrcPixelSize, gConfigs[c]);
+            }
+        }
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ScaledBitmapSampler", ScaledBitmapSamplerTestClass,
+                 TestScaledBitmapSampler)
@@ -0,0 +1,156 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkScratchAlloc.h"
+#include "SkThread.h"
+#include "SkTLS.h"
+
+static void fill(void* ptr, size_t size, int value) {
+    memset(ptr, value, size);
+}
+
+static bool check(const void* ptr, size_t size, int value) {
+    const uint8_t* bytes = (const uint8_t*)ptr;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_scopes(skiatest::Reporter* reporter) {
+    SkScratchAlloc* alloc = SkScratchAlloc::Get();
+    REPORTER_ASSERT(reporter, alloc == SkScratchAlloc::Get());
+
+    SkAutoScratch outer;
+    void* a = outer.alloc(100);
+    fill(a, 100, 1);
+    REPORTER_ASSERT(reporter, 0 == ((intptr_t)a & 7));
+
+    void* first;
+    {
+        SkAutoScratch inner;
+        // bigger than a block, so that it gets one of its own
+        first = inner.alloc(100 * 1024);
+        fill(first, 100 * 1024, 2);
+        void* b = inner.alloc(3);
+        REPORTER_ASSERT(reporter, 0 == ((intptr_t)b & 7));
+        inner.reset();
+        REPORTER_ASSERT(reporter, first == inner.alloc(100 * 1024));
+    }
+    // the inner scope's memory is reused, and the outer's is untouched
+    size_t capacity = alloc->totalCapacity();
+    {
+        SkAutoScratch inner;
+        REPORTER_ASSERT(reporter, first == inner.alloc(100 * 1024));
+    }
+    REPORTER_ASSERT(reporter, capacity == alloc->totalCapacity());
+    REPORTER_ASSERT(reporter, check(a, 100, 1));
+
+    void* c = outer.alloc(50);
+    REPORTER_ASSERT(reporter, c != a);
+    fill(c, 50, 3);
+    REPORTER_ASSERT(reporter, check(a, 100, 1));
+}
+
+// drawing the same thing again shouldn't need more scratch memory
+static void test_steady_state(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    bm.setConfig(SkBitmap::kARGB_8888_Config, 200, 200);
+    bm.allocPixels();
+    SkCanvas canvas(bm);
+
+    SkPath path;
+    for (int i = 0; i < 50; i++) {
+        path.addCircle(SkIntToScalar(20 + i * 3), SkIntToScalar(100),
+                       SkIntToScalar(10 + i));
+    }
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    SkScratchAlloc* alloc = SkScratchAlloc::Get();
+    canvas.drawPath(path, paint);
+    size_t capacity = alloc->totalCapacity();
+    REPORTER_ASSERT(reporter, capacity > 0);
+    for (int i = 0; i < 4; i++) {
+        canvas.drawPath(path, paint);
+    }
+    REPORTER_ASSERT(reporter, capacity == alloc->totalCapacity());
+}
+
+static int32_t gDeleteCount;
+
+static void* create_int() {
+    return SkNEW(int);
+}
+
+static void delete_int(void* ptr) {
+    sk_atomic_inc(&gDeleteCount);
+    SkDELETE((int*)ptr);
+}
+
+namespace {
+
+// every thread gets its own
+class TLSRunnable : public SkRunnable {
+public:
+    TLSRunnable() : fPtr(NULL) {}
+
+    virtual void run() {
+        fPtr = SkTLS::Get(create_int, delete_int);
+        fFound = SkTLS::Find(create_int) == fPtr;
+    }
+
+    void*   fPtr;
+    bool    fFound;
+};
+
+}
+
+static void test_tls(skiatest::Reporter* reporter) {
+    REPORTER_ASSERT(reporter, NULL == SkTLS::Find(create_int));
+    void* mine = SkTLS::Get(create_int, delete_int);
+    REPORTER_ASSERT(reporter, NULL != mine);
+    REPORTER_ASSERT(reporter, mine == SkTLS::Get(create_int, delete_int));
+    REPORTER_ASSERT(reporter, mine == SkTLS::Find(create_int));
+
+    SkTaskGroup group;
+    TLSRunnable runnables[4];
+    for (int i = 0; i < 4; i++) {
+        group.add(&runnables[i]);
+    }
+    group.wait();
+    for (int i = 0; i < 4; i++) {
+        REPORTER_ASSERT(reporter, runnables[i].fFound);
+        REPORTER_ASSERT(reporter, NULL != runnables[i].fPtr);
+    }
+    // the pool's threads don't exit, so nothing has been deleted
+    REPORTER_ASSERT(reporter, 0 == gDeleteCount);
+}
+
+static void TestScratchAlloc(skiatest::Reporter* reporter) {
+    test_scopes(reporter);
+    test_steady_state(reporter);
+    test_tls(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ScratchAlloc", ScratchAllocTestClass, TestScratchAlloc)
@@ -27,6 +27,44 @@ static void check_sort(skiatest::Reporter* reporter, const char label[],
     }
 }
 
+// sorts by the top byte only, to leave ties for the stability check
+struct HighByteLT {
+    bool operator()(int a, int b) const { return (a >> 8) < (b >> 8); }
+};
+
+struct IntKey {
+    int32_t operator()(int value) const { return value; }
+};
+
+struct Keyed {
+    int32_t fKey;
+    int     fIndex;
+};
+
+struct KeyedKey {
+    int32_t operator()(const Keyed& k) const { return k.fKey; }
+};
+
+static void test_radix(skiatest::Reporter* reporter, SkRandom& rand) {
+    Keyed array[300];
+    int count = rand.nextRangeU(1, SK_ARRAY_COUNT(array));
+    // a few distinct keys, of either sign and any size
+    const int32_t keys[] = {
+        -0x7FFFFFFF - 1, -70000, -3, 0, 5, 0x1234, 0x7FFFFFFF
+    };
+    for (int j = 0; j < count; j++) {
+        array[j].fKey = keys[rand.nextU() % SK_ARRAY_COUNT(keys)];
+        array[j].fIndex = j;
+    }
+    SkTRadixSort(array, count, KeyedKey());
+    for (int j = 1; j < count; j++) {
+        const Keyed& prev = array[j - 1];
+        const Keyed& curr = array[j];
+        REPORTER_ASSERT(reporter, prev.fKey < curr.fKey ||
+                        (prev.fKey == curr.fKey && prev.fIndex < curr.fIndex));
+    }
+}
+
 static void TestSort(skiatest::Reporter* reporter) {
     int         array[500];
     SkRandom    rand;
@@ -41,7 +79,45 @@ static void TestSort(skiatest::Reporter* reporter) {
         rand_array(rand, array, count);
         SkTHeapSort<int>(array, count);
         check_sort(reporter, "Heap", array, count);
+
+        rand_array(rand, array, count);
+        SkTIntroSort(array, count);
+        check_sort(reporter, "Intro", array, count);
+
+        rand_array(rand, array, count);
+        SkTRadixSort(array, count, IntKey());
+        check_sort(reporter, "Radix", array, count);
+
+        // with the low byte ignored, and then only the low byte left
+        for (int j = 0; j < count; j++) {
+            array[j] = rand.nextU() & 0xFFFF;
+        }
+        SkTIntroSort(array, count, HighByteLT());
+        for (int j = 0; j < count; j++) {
+            array[j] >>= 8;
+        }
+        check_sort(reporter, "IntroLT", array, count);
+
+        test_radix(reporter, rand);
+    }
+
+    // already sorted, reversed and all the same, which quicksorts badly
+    const int count = SK_ARRAY_COUNT(array);
+    for (int j = 0; j < count; j++) {
+        array[j] = j;
+    }
+    SkTIntroSort(array, count);
+    check_sort(reporter, "IntroSorted", array, count);
+    for (int j = 0; j < count; j++) {
+        array[j] = count - j;
+    }
+    SkTIntroSort(array, count);
+    check_sort(reporter, "IntroReversed", array, count);
+    for (int j = 0; j < count; j++) {
+        array[j] = 7;
     }
+    SkTIntroSort(array, count);
+    check_sort(reporter, "IntroSame", array, count);
 }
 
 // need tests for SkStrSearch
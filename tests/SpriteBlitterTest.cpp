@@ -0,0 +1,291 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorFilter.h"
+#include "SkColorPriv.h"
+#include "SkCreateRLEPixelRef.h"
+#include "SkRandom.h"
+#include "SkShader.h"
+#include "SkXfermode.h"
+
+static void make_source(SkBitmap* src, SkBitmap::Config config, bool opaque,
+                        SkRandom* rand) {
+    src->setConfig(config, 13, 9);
+    src->setIsOpaque(opaque);
+    SkColorTable* ctable = NULL;
+    if (SkBitmap::kIndex8_Config == config) {
+        SkPMColor colors[256];
+        for (int i = 0; i < 256; i++) {
+            unsigned a = opaque ? 0xFF : rand->nextU() & 0xFF;
+            colors[i] = SkPreMultiplyColor(SkColorSetA(rand->nextU(), a));
+        }
+        ctable = new SkColorTable(colors, 256);
+        ctable->setIsOpaque(opaque);
+    }
+    src->allocPixels(ctable);
+    SkSafeUnref(ctable);
+
+    SkAutoLockPixels alp(*src);
+    for (int y = 0; y < src->height(); y++) {
+        for (int x = 0; x < src->width(); x++) {
+            unsigned a = opaque ? 0xFF : rand->nextU() & 0xFF;
+            SkPMColor c = SkPreMultiplyColor(SkColorSetA(rand->nextU(), a));
+            switch (config) {
+                case SkBitmap::kIndex8_Config:
+                    *src->getAddr8(x, y) = rand->nextU() & 0xFF;
+                    break;
+                case SkBitmap::kRGB_565_Config:
+                    *src->getAddr16(x, y) = rand->nextU() & 0xFFFF;
+                    break;
+                case SkBitmap::kARGB_4444_Config:
+                    *src->getAddr16(x, y) = SkPixel32ToPixel4444(c);
+                    break;
+                default:
+                    *src->getAddr32(x, y) = c;
+                    break;
+            }
+        }
+    }
+}
+
+static void make_device(SkBitmap* dev, SkBitmap::Config config) {
+    dev->setConfig(config, 24, 16);
+    dev->allocPixels();
+
+    SkAutoLockPixels alp(*dev);
+    for (int y = 0; y < dev->height(); y++) {
+        for (int x = 0; x < dev->width(); x++) {
+            SkPMColor c = SkPackARGB32(0xFF, x * 10, y * 15, 0x80);
+            if (SkBitmap::kRGB_565_Config == config) {
+                *dev->getAddr16(x, y) = SkPixel32ToPixel16(c);
+            } else {
+                *dev->getAddr32(x, y) = c;
+            }
+        }
+    }
+}
+
+// the largest difference in any component, in the device's own units
+static int max_diff(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    int diff = 0;
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            int da[4];
+            if (SkBitmap::kRGB_565_Config == a.config()) {
+                uint16_t ca = *a.getAddr16(x, y);
+                uint16_t cb = *b.getAddr16(x, y);
+                da[0] = SkGetPackedR16(ca) - SkGetPackedR16(cb);
+                da[1] = SkGetPackedG16(ca) - SkGetPackedG16(cb);
+                da[2] = SkGetPackedB16(ca) - SkGetPackedB16(cb);
+                da[3] = 0;
+            } else {
+                SkPMColor ca = *a.getAddr32(x, y);
+                SkPMColor cb = *b.getAddr32(x, y);
+                da[0] = SkGetPackedR32(ca) - SkGetPackedR32(cb);
+                da[1] = SkGetPackedG32(ca) - SkGetPackedG32(cb);
+                da[2] = SkGetPackedB32(ca) - SkGetPackedB32(cb);
+                da[3] = SkGetPackedA32(ca) - SkGetPackedA32(cb);
+            }
+            for (int i = 0; i < 4; i++) {
+                diff = SkMax32(diff, SkAbs32(da[i]));
+            }
+        }
+    }
+    return diff;
+}
+
+// draws src at (5, 3), as a sprite or through a translated clamp shader
+static void draw_at(const SkBitmap& src, const SkBitmap& dev,
+                    const SkPaint& srcPaint, bool shaded) {
+    SkPaint paint(srcPaint);
+    SkCanvas canvas(dev);
+    if (!shaded) {
+        canvas.drawBitmap(src, SkIntToScalar(5), SkIntToScalar(3), &paint);
+        return;
+    }
+    SkShader* shader = SkShader::CreateBitmapShader(src,
+                                                    SkShader::kClamp_TileMode,
+                                                    SkShader::kClamp_TileMode);
+    SkMatrix m;
+    m.setTranslate(SkIntToScalar(5), SkIntToScalar(3));
+    shader->setLocalMatrix(m);
+    paint.setShader(shader)->unref();
+    // past the bitmap's edges too, to see it clamp
+    canvas.drawRect(SkRect::MakeXYWH(0, 0, SkIntToScalar(20),
+                                     SkIntToScalar(14)), paint);
+}
+
+// RLE bitmaps are drawn straight from their runs, and have to draw what the
+// index8 bitmaps they were packed from do.
+static void test_rle(skiatest::Reporter* reporter, SkRandom* rand) {
+    static const SkBitmap::Config gDstConfigs[] = {
+        SkBitmap::kARGB_8888_Config,
+        SkBitmap::kRGB_565_Config,
+    };
+    static const U8CPU gAlphas[] = { 0xFF, 0x80 };
+
+    for (int opaque = 0; opaque <= 1; opaque++) {
+        SkBitmap index8, rle;
+        make_source(&index8, SkBitmap::kIndex8_Config, 0 != opaque, rand);
+        {
+            // runs of a few pixels, between the random ones
+            SkAutoLockPixels alp(index8);
+            for (int y = 0; y < index8.height(); y++) {
+                for (int x = y & 3; x < index8.width(); x += 5) {
+                    for (int i = 1; i < 4 && x + i < index8.width(); i++) {
+                        *index8.getAddr8(x + i, y) = *index8.getAddr8(x, y);
+                    }
+                }
+            }
+        }
+        REPORTER_ASSERT(reporter, SkCreateRLEBitmap(index8, &rle));
+        REPORTER_ASSERT(reporter,
+                        SkBitmap::kRLE_Index8_Config == rle.config());
+
+        for (size_t d = 0; d < SK_ARRAY_COUNT(gDstConfigs); d++) {
+        for (size_t a = 0; a < SK_ARRAY_COUNT(gAlphas); a++) {
+        for (int effect = 0; effect < 4; effect++) {
+        for (int shaded = 0; shaded <= 1; shaded++) {
+            SkPaint paint;
+            paint.setAlpha(gAlphas[a]);
+            paint.setDither(0 != (effect & 2));
+            if (effect & 1) {
+                paint.setXfermode(SkXfermode::Create(
+                                SkXfermode::kMultiply_Mode))->unref();
+            }
+
+            SkBitmap expected, actual;
+            make_device(&expected, gDstConfigs[d]);
+            make_device(&actual, gDstConfigs[d]);
+            draw_at(index8, expected, paint, 0 != shaded);
+            draw_at(rle, actual, paint, 0 != shaded);
+            // index8 sprites blend into 565 with rounding of their own
+            int tolerance = SkBitmap::kRGB_565_Config == gDstConfigs[d] &&
+                            0xFF != gAlphas[a] ? 1 : 0;
+            REPORTER_ASSERT(reporter,
+                            max_diff(expected, actual) <= tolerance);
+        }
+        }
+        }
+        }
+    }
+
+    // drawn any other way, they draw nothing
+    SkBitmap index8, rle, dev, untouched;
+    make_source(&index8, SkBitmap::kIndex8_Config, true, rand);
+    SkCreateRLEBitmap(index8, &rle);
+    make_device(&dev, SkBitmap::kARGB_8888_Config);
+    make_device(&untouched, SkBitmap::kARGB_8888_Config);
+    SkCanvas canvas(dev);
+    canvas.scale(SkIntToScalar(2), SkIntToScalar(2));
+    canvas.drawBitmap(rle, 0, 0);
+    REPORTER_ASSERT(reporter, 0 == max_diff(dev, untouched));
+
+    // and only index8 bitmaps can be packed
+    SkBitmap argb;
+    make_source(&argb, SkBitmap::kARGB_8888_Config, true, rand);
+    REPORTER_ASSERT(reporter, !SkCreateRLEBitmap(argb, &rle));
+}
+
+// Sprites draw every source config under alpha, xfermodes and color filters,
+// and have to come up with what the bitmap shaders draw for the same paint,
+// give or take the rounding of a global alpha blend (and of dithering it, in
+// 565).
+static void TestSpriteBlitter(skiatest::Reporter* reporter) {
+    static const SkBitmap::Config gSrcConfigs[] = {
+        SkBitmap::kARGB_8888_Config,
+        SkBitmap::kARGB_4444_Config,
+        SkBitmap::kRGB_565_Config,
+        SkBitmap::kIndex8_Config,
+    };
+    static const SkBitmap::Config gDstConfigs[] = {
+        SkBitmap::kARGB_8888_Config,
+        SkBitmap::kRGB_565_Config,
+    };
+    static const U8CPU gAlphas[] = { 0xFF, 0x80 };
+
+    SkRandom rand;
+    for (size_t s = 0; s < SK_ARRAY_COUNT(gSrcConfigs); s++) {
+        for (int opaque = 0; opaque <= 1; opaque++) {
+            if (SkBitmap::kRGB_565_Config == gSrcConfigs[s] && !opaque) {
+                continue;
+            }
+            SkBitmap src;
+            make_source(&src, gSrcConfigs[s], 0 != opaque, &rand);
+
+            for (size_t d = 0; d < SK_ARRAY_COUNT(gDstConfigs); d++) {
+            for (size_t a = 0; a < SK_ARRAY_COUNT(gAlphas); a++) {
+            for (int effect = 0; effect < 4; effect++) {
+                // these sprites blend with 4bit alphas
+                if (SkBitmap::kARGB_4444_Config == gSrcConfigs[s] &&
+                        SkBitmap::kRGB_565_Config == gDstConfigs[d] &&
+                        0 == effect) {
+                    continue;
+                }
+                SkPaint paint;
+                paint.setAlpha(gAlphas[a]);
+                paint.setDither(SkBitmap::kRGB_565_Config == gDstConfigs[d]);
+                if (effect & 1) {
+                    paint.setXfermode(SkXfermode::Create(
+                                    SkXfermode::kMultiply_Mode))->unref();
+                }
+                if (effect & 2) {
+                    paint.setColorFilter(SkColorFilter::CreateModeFilter(
+                            0x80408020, SkXfermode::kSrcATop_Mode))->unref();
+                }
+
+                SkBitmap sprite, shaded;
+                make_device(&sprite, gDstConfigs[d]);
+                make_device(&shaded, gDstConfigs[d]);
+
+                SkCanvas spriteCanvas(sprite);
+                spriteCanvas.drawBitmap(src, SkIntToScalar(5),
+                                        SkIntToScalar(3), &paint);
+
+                SkShader* shader = SkShader::CreateBitmapShader(src,
+                                                   SkShader::kClamp_TileMode,
+                                                   SkShader::kClamp_TileMode);
+                SkMatrix m;
+                m.setTranslate(SkIntToScalar(5), SkIntToScalar(3));
+                shader->setLocalMatrix(m);
+                paint.setShader(shader)->unref();
+                SkCanvas shadedCanvas(shaded);
+                shadedCanvas.drawRect(SkRect::MakeXYWH(SkIntToScalar(5),
+                                                      SkIntToScalar(3),
+                                                      SkIntToScalar(13),
+                                                      SkIntToScalar(9)),
+                                      paint);
+
+                int tolerance = SkBitmap::kRGB_565_Config == gDstConfigs[d] ?
+                                2 : 1;
+                REPORTER_ASSERT(reporter,
+                                max_diff(sprite, shaded) <= tolerance);
+            }
+            }
+            }
+        }
+    }
+
+    test_rle(reporter, &rand);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("SpriteBlitter", SpriteBlitterTestClass, TestSpriteBlitter)
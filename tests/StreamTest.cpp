@@ -2,6 +2,7 @@
 #include "SkRandom.h"
 #include "SkStream.h"
 #include "SkData.h"
+#include "SkReadAheadStream.h"
 
 #define MAX_SIZE    (256 * 1024)
 
@@ -89,12 +90,156 @@ static void TestWStream(skiatest::Reporter* reporter) {
         REPORTER_ASSERT(reporter, memcmp(dst, data->data(), data->size()) == 0);
         data->unref();
     }
+
+    // what goes to another stream a block at a time is the same
+    {
+        SkDynamicMemoryWStream ds2;
+        REPORTER_ASSERT(reporter, ds.writeToStream(&ds2));
+        SkAutoDataUnref data(ds2.copyToData());
+        REPORTER_ASSERT(reporter, 100 * 26 == data.size());
+        REPORTER_ASSERT(reporter, memcmp(dst, data.data(), data.size()) == 0);
+    }
+
+    // detaching leaves the stream empty
+    {
+        SkAutoDataUnref data(ds.detachAsData());
+        REPORTER_ASSERT(reporter, 100 * 26 == data.size());
+        REPORTER_ASSERT(reporter, memcmp(dst, data.data(), data.size()) == 0);
+        REPORTER_ASSERT(reporter, 0 == ds.getOffset());
+    }
     delete[] dst;
 }
 
+// with blocks big enough for everything, the data is handed over as is
+static void test_detach(skiatest::Reporter* reporter) {
+    const char s[] = "abcdefghijklmnopqrstuvwxyz";
+    SkDynamicMemoryWStream ds(4096);
+    for (int i = 0; i < 100; i++) {
+        ds.write(s, 26);
+    }
+
+    SkAutoDataUnref data(ds.detachAsData());
+    REPORTER_ASSERT(reporter, 100 * 26 == data.size());
+    for (int i = 0; i < 100; i++) {
+        REPORTER_ASSERT(reporter,
+                        !memcmp(data.bytes() + i * 26, s, 26));
+    }
+
+    // the stream starts over
+    ds.write(s, 3);
+    SkAutoDataUnref data2(ds.detachAsData());
+    REPORTER_ASSERT(reporter, 3 == data2.size());
+    REPORTER_ASSERT(reporter, !memcmp(data2.data(), s, 3));
+}
+
+static void test_writev(skiatest::Reporter* reporter) {
+    const SkWStream::Chunk chunks[] = {
+        { "abc", 3 },
+        { "", 0 },
+        { "defgh", 5 },
+    };
+    SkDynamicMemoryWStream ds;
+    REPORTER_ASSERT(reporter, ds.writev(chunks, SK_ARRAY_COUNT(chunks)));
+    SkAutoDataUnref data(ds.detachAsData());
+    REPORTER_ASSERT(reporter, 8 == data.size());
+    REPORTER_ASSERT(reporter, !memcmp(data.data(), "abcdefgh", 8));
+}
+
+namespace {
+    // remembers how it was read; SkReadAheadStream only reads it from its
+    // background thread, and we only look once that has stopped
+    class RecordingStream : public SkMemoryStream {
+    public:
+        RecordingStream(const void* data, size_t length)
+            : INHERITED(data, length), fRewinds(0), fPrefetches(0),
+              fBadReads(0), fBlockSize(0) {}
+
+        virtual bool rewind() {
+            fRewinds += 1;
+            return this->INHERITED::rewind();
+        }
+        virtual size_t read(void* buffer, size_t size) {
+            // only the read that finds the end may be out of step
+            if (buffer && (this->peek() % fBlockSize || size % fBlockSize) &&
+                    this->peek() < this->getLength()) {
+                fBadReads += 1;
+            }
+            return this->INHERITED::read(buffer, size);
+        }
+        virtual bool prefetch(size_t offset, size_t length) {
+            fPrefetches += 1;
+            return false;
+        }
+
+        int     fRewinds, fPrefetches, fBadReads;
+        size_t  fBlockSize;
+
+    private:
+        typedef SkMemoryStream INHERITED;
+    };
+}
+
+static void test_readahead(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    SkAutoMalloc am(MAX_SIZE * 2);
+    char* storage = (char*)am.get();
+    char* storage2 = storage + MAX_SIZE;
+    random_fill(rand, storage, MAX_SIZE);
+
+    static const size_t gBlockSizes[] = { 0, 4096, 10000 };
+    static const size_t gCacheLimits[] = { 0, 16 * 1024 };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gBlockSizes); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gCacheLimits); j++) {
+            const size_t size = MAX_SIZE - (rand.nextU() & 0xFFF);
+            RecordingStream proxy(storage, size);
+            int rewinds;
+            {
+                SkReadAheadStream stream(&proxy, gBlockSizes[i],
+                                         gCacheLimits[j]);
+                proxy.fBlockSize = stream.blockSize();
+                REPORTER_ASSERT(reporter, 0 == stream.blockSize() % 4096);
+                REPORTER_ASSERT(reporter, stream.getLength() == size);
+                REPORTER_ASSERT(reporter, stream.prefetch(0, 20000));
+
+                // read and skip in odd sizes, to the end
+                size_t offset = 0;
+                while (offset < size) {
+                    size_t s = 1 + (rand.nextU() & 0x3FFF);
+                    size_t ss;
+                    if (rand.nextU() & 3) {
+                        ss = stream.read(storage2, s);
+                        REPORTER_ASSERT(reporter,
+                                !memcmp(storage + offset, storage2, ss));
+                    } else {
+                        ss = stream.skip(s);
+                    }
+                    REPORTER_ASSERT(reporter, ss == (s < size - offset ? s : size - offset));
+                    offset += ss;
+                }
+                REPORTER_ASSERT(reporter, 0 == stream.read(storage2, 1));
+
+                // start over, either from memory or from the proxy
+                REPORTER_ASSERT(reporter, stream.rewind());
+                size_t s = stream.read(storage2, 3000);
+                REPORTER_ASSERT(reporter, 3000 == s);
+                REPORTER_ASSERT(reporter, !memcmp(storage, storage2, s));
+                rewinds = proxy.fRewinds;
+            }
+            // everything is kept under the default limit
+            REPORTER_ASSERT(reporter, (0 == gCacheLimits[j]) == !rewinds);
+            REPORTER_ASSERT(reporter, proxy.fPrefetches > 0);
+            REPORTER_ASSERT(reporter, 0 == proxy.fBadReads);
+        }
+    }
+}
+
 static void TestStreams(skiatest::Reporter* reporter) {
     TestRStream(reporter);
     TestWStream(reporter);
+    test_detach(reporter);
+    test_writev(reporter);
+    test_readahead(reporter);
 }
 
 #include "TestClassDef.h"
@@ -0,0 +1,119 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkTDArray.h"
+
+typedef SkSTDArray<4, int> IntArray;
+
+static void set_ints(IntArray* array, int count) {
+    array->rewind();
+    for (int i = 0; i < count; i++) {
+        *array->append() = i;
+    }
+}
+
+static bool check_ints(const IntArray& array, int count) {
+    if (array.count() != count) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (array[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// past N elements the array moves to the heap, keeping what it had
+static void test_grow(skiatest::Reporter* reporter) {
+    IntArray array;
+    REPORTER_ASSERT(reporter, array.isEmpty());
+    set_ints(&array, 4);
+    REPORTER_ASSERT(reporter, check_ints(array, 4));
+    set_ints(&array, 100);
+    REPORTER_ASSERT(reporter, check_ints(array, 100));
+
+    // rewind keeps the heap block, reset gives it back
+    array.rewind();
+    REPORTER_ASSERT(reporter, array.isEmpty());
+    set_ints(&array, 3);
+    REPORTER_ASSERT(reporter, check_ints(array, 3));
+    array.reset();
+    REPORTER_ASSERT(reporter, array.isEmpty());
+    set_ints(&array, 2);
+    REPORTER_ASSERT(reporter, check_ints(array, 2));
+
+    array.setReserve(50);
+    REPORTER_ASSERT(reporter, check_ints(array, 2));
+    array.setCount(1);
+    REPORTER_ASSERT(reporter, check_ints(array, 1));
+
+    SkDEBUGCODE(array.validate();)
+}
+
+// swapping and copying work whichever of the arrays is inline
+static void test_swap(skiatest::Reporter* reporter) {
+    static const int gCounts[] = { 0, 3, 4, 20 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gCounts); i++) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(gCounts); j++) {
+            IntArray a, b;
+            set_ints(&a, gCounts[i]);
+            set_ints(&b, gCounts[j]);
+            a.swap(b);
+            REPORTER_ASSERT(reporter, check_ints(a, gCounts[j]));
+            REPORTER_ASSERT(reporter, check_ints(b, gCounts[i]));
+
+            a = b;
+            REPORTER_ASSERT(reporter, check_ints(a, gCounts[i]));
+            REPORTER_ASSERT(reporter, a == b);
+
+            IntArray c(b);
+            REPORTER_ASSERT(reporter, check_ints(c, gCounts[i]));
+            SkDEBUGCODE(a.validate();)
+            SkDEBUGCODE(b.validate();)
+            SkDEBUGCODE(c.validate();)
+        }
+    }
+}
+
+static void test_remove(skiatest::Reporter* reporter) {
+    IntArray array;
+    set_ints(&array, 6);
+    array.remove(1, 2);
+    REPORTER_ASSERT(reporter, 4 == array.count());
+    REPORTER_ASSERT(reporter, 0 == array[0]);
+    REPORTER_ASSERT(reporter, 3 == array[1]);
+    array.removeShuffle(0);
+    REPORTER_ASSERT(reporter, 3 == array.count());
+    REPORTER_ASSERT(reporter, 5 == array[0]);
+
+    int top;
+    array.pop(&top);
+    REPORTER_ASSERT(reporter, 4 == top);
+    array.push(7);
+    REPORTER_ASSERT(reporter, 7 == array.top());
+}
+
+static void TestTDArray(skiatest::Reporter* reporter) {
+    test_grow(reporter);
+    test_swap(reporter);
+    test_remove(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("TDArray", TDArrayTestClass, TestTDArray)
@@ -0,0 +1,146 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkThread.h"
+#include "SkTemplates.h"
+
+namespace {
+
+class CountRunnable : public SkRunnable {
+public:
+    CountRunnable() : fCount(0) {}
+
+    virtual void run() {
+        sk_atomic_inc(&fCount);
+    }
+
+    int32_t fCount;
+};
+
+// waits on a group of its own from inside the pool, which mustn't deadlock
+// even if every worker is doing the same
+class NestedRunnable : public SkRunnable {
+public:
+    NestedRunnable() : fDone(false) {}
+
+    virtual void run() {
+        CountRunnable inner[4];
+        SkTaskGroup group;
+        for (int i = 0; i < 4; i++) {
+            group.add(&inner[i]);
+        }
+        group.wait();
+        fDone = true;
+        for (int i = 0; i < 4; i++) {
+            fDone = fDone && 1 == inner[i].fCount;
+        }
+    }
+
+    bool fDone;
+};
+
+}
+
+static void test_group(skiatest::Reporter* reporter) {
+    const int N = 100;
+    SkAutoTArray<CountRunnable> runnables(N);
+    {
+        SkTaskGroup group;
+        for (int i = 0; i < N; i++) {
+            group.add(&runnables[i]);
+        }
+        group.add(NULL);
+        group.wait();
+        for (int i = 0; i < N; i++) {
+            REPORTER_ASSERT(reporter, 1 == runnables[i].fCount);
+        }
+
+        // the group can be used again after a wait()
+        for (int i = 0; i < N; i++) {
+            group.add(&runnables[i]);
+        }
+        // and the destructor waits
+    }
+    for (int i = 0; i < N; i++) {
+        REPORTER_ASSERT(reporter, 2 == runnables[i].fCount);
+    }
+
+    // waiting with nothing added returns at once
+    SkTaskGroup empty;
+    empty.wait();
+}
+
+static void test_nested(skiatest::Reporter* reporter) {
+    const int N = 8;
+    NestedRunnable runnables[N];
+    SkTaskGroup group;
+    for (int i = 0; i < N; i++) {
+        group.add(&runnables[i]);
+    }
+    group.wait();
+    for (int i = 0; i < N; i++) {
+        REPORTER_ASSERT(reporter, runnables[i].fDone);
+    }
+}
+
+static void count_range(void* context, int start, int stop) {
+    int32_t* counts = (int32_t*)context;
+    for (int i = start; i < stop; i++) {
+        sk_atomic_inc(&counts[i]);
+    }
+}
+
+// every index in the range has to be visited exactly once
+static void test_parallel_for(skiatest::Reporter* reporter) {
+    static const struct {
+        int fStart, fStop, fGrain;
+    } gRec[] = {
+        {   0, 1000,    1 },
+        {   0, 1000,   64 },
+        {   3,  997,  100 },
+        {  10,   11,    5 },
+        {   0,  500, 1000 },
+        {   0,  200,    0 },
+        {  50,   50,    1 },
+        {  60,   40,    1 },
+    };
+
+    const int MAX = 1000;
+    int32_t counts[MAX];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+        memset(counts, 0, sizeof(counts));
+        SkParallelFor(gRec[i].fStart, gRec[i].fStop, gRec[i].fGrain,
+                      count_range, counts);
+        for (int j = 0; j < MAX; j++) {
+            bool inside = j >= gRec[i].fStart && j < gRec[i].fStop;
+            REPORTER_ASSERT(reporter, (inside ? 1 : 0) == counts[j]);
+        }
+    }
+}
+
+static void TestTaskGroup(skiatest::Reporter* reporter) {
+    // so that there are workers even on a single core; this only takes
+    // effect if nothing has used the pool yet
+    SkTaskGroup::SetThreadCount(3);
+
+    test_group(reporter);
+    test_nested(reporter);
+    test_parallel_for(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("TaskGroup", TaskGroupTestClass, TestTaskGroup)
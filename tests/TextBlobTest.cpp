@@ -0,0 +1,127 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkTextBlob.h"
+
+static const char gText[] = "Hamburgefons";
+static const size_t gLen = sizeof(gText) - 1;
+
+static void setup_paint(SkPaint* paint) {
+    paint->setAntiAlias(true);
+    paint->setTextSize(SkIntToScalar(19));
+    paint->setTextAlign(SkPaint::kCenter_Align);
+}
+
+static void alloc(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kARGB_8888_Config, 160, 40);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alp0(a);
+    SkAutoLockPixels alp1(b);
+    return !memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void test_layout(skiatest::Reporter* reporter) {
+    SkPaint paint;
+    setup_paint(&paint);
+
+    SkTextBlob* blob = SkTextBlob::Create(gText, gLen, paint);
+    SkAutoUnref aur(blob);
+    REPORTER_ASSERT(reporter, (int)gLen == blob->glyphCount());
+
+    uint16_t glyphs[gLen];
+    paint.textToGlyphs(gText, gLen, glyphs);
+    REPORTER_ASSERT(reporter, !memcmp(glyphs, blob->glyphs(), sizeof(glyphs)));
+
+    // centered on the origin, consecutive glyphs one advance apart
+    SkScalar widths[gLen];
+    paint.getTextWidths(gText, gLen, widths);
+    SkScalar total = paint.measureText(gText, gLen);
+    const SkPoint* pos = blob->positions();
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(pos[0].fX, -total / 2));
+    for (size_t i = 1; i < gLen; i++) {
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(pos[i].fX,
+                                                pos[i - 1].fX + widths[i - 1]));
+        REPORTER_ASSERT(reporter, 0 == pos[i].fY);
+    }
+
+    SkTextBlob* other = SkTextBlob::Create(gText, gLen, paint);
+    REPORTER_ASSERT(reporter, other->uniqueID() != blob->uniqueID());
+    other->unref();
+
+    SkTextBlob* empty = SkTextBlob::Create(gText, 0, paint);
+    REPORTER_ASSERT(reporter, 0 == empty->glyphCount());
+    REPORTER_ASSERT(reporter, empty->bounds().isEmpty());
+    empty->unref();
+}
+
+static void test_draw(skiatest::Reporter* reporter) {
+    SkPaint fontPaint;
+    setup_paint(&fontPaint);
+    SkTextBlob* blob = SkTextBlob::Create(gText, gLen, fontPaint);
+    SkAutoUnref aur(blob);
+
+    const SkScalar x = SkIntToScalar(80);
+    const SkScalar y = SkIntToScalar(30);
+
+    // the blob's font wins over the draw paint's
+    SkPaint drawPaint;
+    drawPaint.setColor(SK_ColorBLUE);
+    drawPaint.setTextSize(SkIntToScalar(40));
+    fontPaint.setColor(SK_ColorBLUE);
+
+    SkBitmap expected, actual, recorded;
+    alloc(&expected);
+    alloc(&actual);
+    alloc(&recorded);
+
+    SkCanvas expectedCanvas(expected);
+    expectedCanvas.drawText(gText, gLen, x, y, fontPaint);
+
+    SkCanvas actualCanvas(actual);
+    actualCanvas.drawTextBlob(blob, x, y, drawPaint);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+
+    SkPicture picture;
+    picture.beginRecording(160, 40)->drawTextBlob(blob, x, y, drawPaint);
+    picture.endRecording();
+    SkCanvas recordedCanvas(recorded);
+    picture.draw(&recordedCanvas);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, recorded));
+
+    // entirely clipped out
+    SkBitmap clipped;
+    alloc(&clipped);
+    SkCanvas clippedCanvas(clipped);
+    clippedCanvas.drawTextBlob(blob, x, SkIntToScalar(-100), drawPaint);
+    SkBitmap blank;
+    alloc(&blank);
+    REPORTER_ASSERT(reporter, equal_pixels(blank, clipped));
+}
+
+static void TestTextBlob(skiatest::Reporter* reporter) {
+    test_layout(reporter);
+    test_draw(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("TextBlob", TextBlobTestClass, TestTextBlob)
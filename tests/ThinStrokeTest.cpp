@@ -0,0 +1,186 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "Test.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+
+static const int W = 64;
+static const int H = 64;
+
+static void make_bitmap(SkBitmap* bm) {
+    bm->setConfig(SkBitmap::kA8_Config, W, H);
+    bm->allocPixels();
+    bm->eraseColor(0);
+}
+
+static void make_stroke_paint(SkPaint* paint, SkScalar width,
+                              SkPaint::Cap cap) {
+    paint->setAntiAlias(true);
+    paint->setStyle(SkPaint::kStroke_Style);
+    paint->setStrokeWidth(width);
+    paint->setStrokeCap(cap);
+    paint->setStrokeJoin(SkPaint::kRound_Join);
+}
+
+// Draw the path's stroke (which takes the thin stroke path when it can), and
+// the outline of the stroke, filled.
+static void draw_both(const SkPath& path, const SkPaint& paint,
+                      SkBitmap* stroked, SkBitmap* outlined) {
+    make_bitmap(stroked);
+    make_bitmap(outlined);
+    {
+        SkCanvas canvas(*stroked);
+        canvas.drawPath(path, paint);
+    }
+    {
+        SkPath outline;
+        paint.getFillPath(path, &outline);
+        SkPaint fill(paint);
+        fill.setStyle(SkPaint::kFill_Style);
+        SkCanvas canvas(*outlined);
+        canvas.drawPath(outline, fill);
+    }
+}
+
+static int total_coverage(const SkBitmap& bm) {
+    int total = 0;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            total += *bm.getAddr8(x, y);
+        }
+    }
+    return total;
+}
+
+static int max_diff(const SkBitmap& a, const SkBitmap& b) {
+    int diff = 0;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            diff = SkMax32(diff, SkAbs32(*a.getAddr8(x, y) - *b.getAddr8(x, y)));
+        }
+    }
+    return diff;
+}
+
+// The thin stroke should cover about what its outline does.
+static void check_close(skiatest::Reporter* reporter, const SkPath& path,
+                        const SkPaint& paint) {
+    SkBitmap stroked, outlined;
+    draw_both(path, paint, &stroked, &outlined);
+    int a = total_coverage(stroked);
+    int b = total_coverage(outlined);
+    REPORTER_ASSERT(reporter, b > 0);
+    REPORTER_ASSERT(reporter, SkAbs32(a - b) * 20 <= b);
+    // joins and ends are approximated, but no pixel is far off
+    REPORTER_ASSERT(reporter, max_diff(stroked, outlined) <= 96);
+}
+
+static void test_horizontal(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.moveTo(SkIntToScalar(10), SkFloatToScalar(20.5f));
+    path.lineTo(SkIntToScalar(50), SkFloatToScalar(20.5f));
+
+    SkPaint paint;
+    make_stroke_paint(&paint, SkIntToScalar(2), SkPaint::kButt_Cap);
+    SkBitmap stroked, outlined;
+    draw_both(path, paint, &stroked, &outlined);
+
+    // the stroke covers [19.5, 21.5), so the middle row is solid and the
+    // rows either side are half covered
+    for (int x = 10; x < 50; ++x) {
+        REPORTER_ASSERT(reporter, 0 == *stroked.getAddr8(x, 18));
+        REPORTER_ASSERT(reporter, SkAbs32(*stroked.getAddr8(x, 19) - 128) <= 1);
+        REPORTER_ASSERT(reporter, 0xFF == *stroked.getAddr8(x, 20));
+        REPORTER_ASSERT(reporter, SkAbs32(*stroked.getAddr8(x, 21) - 128) <= 1);
+        REPORTER_ASSERT(reporter, 0 == *stroked.getAddr8(x, 22));
+    }
+    // butt caps end exactly at the ends
+    REPORTER_ASSERT(reporter, 0 == *stroked.getAddr8(9, 20));
+    REPORTER_ASSERT(reporter, 0 == *stroked.getAddr8(50, 20));
+    REPORTER_ASSERT(reporter, 2 >= max_diff(stroked, outlined));
+}
+
+static void test_polylines(skiatest::Reporter* reporter) {
+    static const SkPaint::Cap gCaps[] = {
+        SkPaint::kButt_Cap, SkPaint::kRound_Cap, SkPaint::kSquare_Cap
+    };
+    static const SkScalar gWidths[] = {
+        SkFloatToScalar(1.25f), SkFloatToScalar(1.5f), SkIntToScalar(2)
+    };
+
+    SkRandom rand;
+    for (size_t c = 0; c < SK_ARRAY_COUNT(gCaps); ++c) {
+        for (size_t w = 0; w < SK_ARRAY_COUNT(gWidths); ++w) {
+            SkPaint paint;
+            make_stroke_paint(&paint, gWidths[w], gCaps[c]);
+
+            // a zig-zag, that turns sharply
+            SkPath zigzag;
+            zigzag.moveTo(SkIntToScalar(4), SkIntToScalar(40));
+            for (int i = 1; i <= 7; ++i) {
+                zigzag.lineTo(SkIntToScalar(4 + i * 8),
+                              SkIntToScalar((i & 1) ? 10 : 40));
+            }
+            check_close(reporter, zigzag, paint);
+
+            // a closed polygon
+            SkPath polygon;
+            polygon.moveTo(SkFloatToScalar(10.3f), SkFloatToScalar(12.8f));
+            polygon.lineTo(SkFloatToScalar(52.1f), SkFloatToScalar(20.4f));
+            polygon.lineTo(SkFloatToScalar(40.6f), SkFloatToScalar(55.2f));
+            polygon.lineTo(SkFloatToScalar(15.9f), SkFloatToScalar(44.7f));
+            polygon.close();
+            check_close(reporter, polygon, paint);
+
+            // a chart-like line of many short lines, partly off the canvas
+            SkPath chart;
+            chart.moveTo(-SkIntToScalar(8), SkIntToScalar(32));
+            for (int x = -7; x < W + 8; ++x) {
+                chart.lineTo(SkIntToScalar(x),
+                             SkIntToScalar(32) + rand.nextSScalar1() * 20);
+            }
+            check_close(reporter, chart, paint);
+        }
+    }
+}
+
+// Translucent strokes draw some pixels twice in the thin stroke path, so they
+// still draw their outline.
+static void test_translucent(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.moveTo(SkIntToScalar(4), SkIntToScalar(40));
+    path.lineTo(SkIntToScalar(30), SkIntToScalar(10));
+    path.lineTo(SkIntToScalar(56), SkIntToScalar(40));
+
+    SkPaint paint;
+    make_stroke_paint(&paint, SkFloatToScalar(1.5f), SkPaint::kRound_Cap);
+    paint.setAlpha(0x80);
+    SkBitmap stroked, outlined;
+    draw_both(path, paint, &stroked, &outlined);
+    REPORTER_ASSERT(reporter, 0 == max_diff(stroked, outlined));
+}
+
+static void TestThinStroke(skiatest::Reporter* reporter) {
+    test_horizontal(reporter);
+    test_polylines(reporter);
+    test_translucent(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("ThinStroke", ThinStrokeTestClass, TestThinStroke)
@@ -0,0 +1,117 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+#include "SkTrace.h"
+
+static SkTrace::Counter gTestCounter("test.counter");
+
+namespace {
+
+class AddRunnable : public SkRunnable {
+public:
+    virtual void run() {
+        for (int i = 0; i < 1000; i++) {
+            gTestCounter.add(3);
+        }
+    }
+};
+
+}
+
+static void test_counters(skiatest::Reporter* reporter) {
+    SkTrace::Reset();
+    REPORTER_ASSERT(reporter, 0 == gTestCounter.value());
+    REPORTER_ASSERT(reporter, &gTestCounter ==
+                    SkTrace::FindCounter("test.counter"));
+    REPORTER_ASSERT(reporter, NULL == SkTrace::FindCounter("test.nothing"));
+
+    gTestCounter.add(5);
+    gTestCounter.inc();
+    REPORTER_ASSERT(reporter, 6 == gTestCounter.value());
+
+    // the adds are atomic
+    const int N = 4;
+    AddRunnable runnables[N];
+    SkTaskGroup group;
+    for (int i = 0; i < N; i++) {
+        group.add(&runnables[i]);
+    }
+    group.wait();
+    REPORTER_ASSERT(reporter, 6 + N * 3000 == gTestCounter.value());
+
+    SkTrace::Reset();
+    REPORTER_ASSERT(reporter, 0 == gTestCounter.value());
+}
+
+static void test_events(skiatest::Reporter* reporter) {
+    SkTrace::Reset();
+
+    // nothing is recorded unless tracing is enabled
+    SkTrace::SetEnabled(false);
+    {
+        SkTrace::AutoEvent event("test.disabled");
+    }
+    REPORTER_ASSERT(reporter, 0 == SkTrace::GetEventCount());
+
+    SkTrace::SetEnabled(true);
+    REPORTER_ASSERT(reporter, SkTrace::IsEnabled());
+    {
+        SkTrace::AutoEvent event("test.event");
+    }
+    REPORTER_ASSERT(reporter, 1 == SkTrace::GetEventCount());
+
+    // past the end of the buffer, events are dropped (and counted)
+    for (int i = 0; i < SkTrace::kMaxEvents + 10; i++) {
+        SkTrace::RecordEvent("test.filler", 0, 1);
+    }
+    SkTrace::SetEnabled(false);
+    REPORTER_ASSERT(reporter, SkTrace::kMaxEvents == SkTrace::GetEventCount());
+    REPORTER_ASSERT(reporter, 11 == SkTrace::GetDroppedEventCount());
+
+    gTestCounter.add(42);
+    SkDynamicMemoryWStream stream;
+    SkTrace::WriteJSON(&stream);
+    SkAutoTArray<char> text(stream.getOffset() + 1);
+    stream.copyTo(text.get());
+    text[stream.getOffset()] = 0;
+
+    REPORTER_ASSERT(reporter, 0 == strncmp(text.get(), "{\"traceEvents\": [", 17));
+    REPORTER_ASSERT(reporter, strstr(text.get(), "\"name\": \"test.event\""));
+    REPORTER_ASSERT(reporter, NULL == strstr(text.get(), "test.disabled"));
+    REPORTER_ASSERT(reporter, strstr(text.get(),
+        "\"name\": \"test.counter\", \"cat\": \"skia\", \"ph\": \"C\""));
+    REPORTER_ASSERT(reporter, strstr(text.get(), "{\"value\": 42}"));
+    REPORTER_ASSERT(reporter, strstr(text.get(), "{\"value\": 11}"));
+    // (too long for an SkString)
+    REPORTER_ASSERT(reporter, stream.getOffset() > 4 && 0 == strcmp(
+                    text.get() + stream.getOffset() - 4, "\n]}\n"));
+
+    SkTrace::Reset();
+    REPORTER_ASSERT(reporter, 0 == SkTrace::GetEventCount());
+    REPORTER_ASSERT(reporter, 0 == SkTrace::GetDroppedEventCount());
+}
+
+static void TestTrace(skiatest::Reporter* reporter) {
+    test_counters(reporter);
+    test_events(reporter);
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("Trace", TraceTestClass, TestTrace)
@@ -0,0 +1,102 @@
+/*
+    Copyright 2011 Google Inc.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+         http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+
+#include "Test.h"
+#include "SkString.h"
+#include "SkTypefaceCache.h"
+
+namespace {
+
+class TestTypeface : public SkTypeface {
+public:
+    explicit TestTypeface(Style style)
+        : SkTypeface(style, SkTypefaceCache::NewFontID()) {}
+};
+
+}  // namespace
+
+static const int kFaceCount = 300;
+
+static SkTypeface::Style style_for(int i) {
+    return (SkTypeface::Style)(i & SkTypeface::kBoldItalic);
+}
+
+static void make_name(int i, SkString* name) {
+    name->printf("TypefaceCacheTest %d", i / 4);
+}
+
+static void TestTypefaceCache(skiatest::Reporter* reporter) {
+    SkTypeface* faces[kFaceCount];
+    SkFontID ids[kFaceCount];
+    SkString name;
+
+    // More faces than the cache's limit; none can be purged while we hold
+    // our own reference to them.
+    for (int i = 0; i < kFaceCount; i++) {
+        faces[i] = new TestTypeface(style_for(i));
+        ids[i] = faces[i]->uniqueID();
+        make_name(i, &name);
+        SkTypefaceCache::Add(faces[i], style_for(i), name.c_str());
+    }
+
+    for (int i = 0; i < kFaceCount; i++) {
+        make_name(i, &name);
+        REPORTER_ASSERT(reporter,
+                        SkTypefaceCache::FindByID(ids[i]) == faces[i]);
+        REPORTER_ASSERT(reporter, SkTypefaceCache::FindByName(name.c_str(),
+                                      style_for(i)) == faces[i]);
+    }
+    name.set("TypefaceCacheTest missing");
+    REPORTER_ASSERT(reporter, NULL == SkTypefaceCache::FindByName(name.c_str(),
+                                          SkTypeface::kNormal));
+
+    // A face added without a name is only found by its ID.
+    SkTypeface* unnamed = new TestTypeface(SkTypeface::kBold);
+    SkTypefaceCache::Add(unnamed, SkTypeface::kBold);
+    REPORTER_ASSERT(reporter,
+                    SkTypefaceCache::FindByID(unnamed->uniqueID()) == unnamed);
+    REPORTER_ASSERT(reporter, NULL == SkTypefaceCache::FindByName("",
+                                          SkTypeface::kBold));
+    unnamed->unref();
+
+    // Let the cache own the first half, then add one more face to force a
+    // purge. Whatever was dropped must be gone from both tables.
+    for (int i = 0; i < kFaceCount / 2; i++) {
+        faces[i]->unref();
+    }
+    SkTypeface* extra = new TestTypeface(SkTypeface::kNormal);
+    SkTypefaceCache::Add(extra, SkTypeface::kNormal);
+    extra->unref();
+
+    for (int i = 0; i < kFaceCount; i++) {
+        make_name(i, &name);
+        SkTypeface* byID = SkTypefaceCache::FindByID(ids[i]);
+        SkTypeface* byName = SkTypefaceCache::FindByName(name.c_str(),
+                                                         style_for(i));
+        REPORTER_ASSERT(reporter, byID == byName);
+        if (i >= kFaceCount / 2) {
+            REPORTER_ASSERT(reporter, byID == faces[i]);
+        }
+    }
+
+    for (int i = kFaceCount / 2; i < kFaceCount; i++) {
+        faces[i]->unref();
+    }
+}
+
+#include "TestClassDef.h"
+DEFINE_TESTCLASS("TypefaceCache", TypefaceCacheTestClass, TestTypefaceCache)
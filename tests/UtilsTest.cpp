@@ -1,8 +1,10 @@
 #include "Test.h"
+#include "SkColorPriv.h"
 #include "SkRandom.h"
 #include "SkRefCnt.h"
 #include "SkTSearch.h"
 #include "SkTSort.h"
+#include "SkTemplates.h"
 #include "SkUtils.h"
 
 class RefClass : public SkRefCnt {
@@ -132,6 +134,165 @@ static void test_utf16(skiatest::Reporter* reporter) {
     }
 }
 
+// runs of one value take a different path than mixed bytes in some procs
+static void test_table8(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    uint8_t table[256];
+    for (int i = 0; i < 256; i++) {
+        table[i] = rand.nextU() & 0xFF;
+    }
+
+    uint8_t src[80], dst[80], expected[80];
+    for (int run = 1; run <= 64; run *= 4) {
+        for (int i = 0; i < 80; i++) {
+            src[i] = (i / run) & 1 ? rand.nextU() & 0xFF : 0;
+        }
+        for (int offset = 0; offset < 4; offset++) {
+            for (int count = 0; count <= 80 - offset; count++) {
+                memset(dst, 0x55, sizeof(dst));
+                memcpy(expected, dst, sizeof(dst));
+                for (int i = 0; i < count; i++) {
+                    expected[offset + i] = table[src[offset + i]];
+                }
+                sk_table8(dst + offset, src + offset, count, table);
+                REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+
+                // and in place
+                memcpy(dst, src, sizeof(dst));
+                for (int i = 0; i < 80; i++) {
+                    bool mapped = i >= offset && i < offset + count;
+                    expected[i] = mapped ? table[src[i]] : src[i];
+                }
+                sk_table8(dst + offset, dst + offset, count, table);
+                REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+            }
+        }
+    }
+}
+
+template <typename T>
+static bool check_rect(const T* base, int rowCount, int left, int top,
+                       int width, int height, T value, T fill) {
+    for (int y = 0; y < height + 2; y++) {
+        for (int x = 0; x < rowCount; x++) {
+            bool inside = x >= left && x < left + width &&
+                          y >= top && y < top + height;
+            if (base[y * rowCount + x] != (inside ? value : fill)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// the rows may be contiguous or not, and big enough for the platform to
+// stream them out, but nothing between or around them may be written
+static void test_memset_rect(skiatest::Reporter* reporter) {
+    static const struct {
+        int fWidth, fHeight, fGap;  // fGap values between one row and the next
+    } gRec[] = {
+        {    0,    4, 3 },
+        {    1,    1, 0 },
+        {   37,    5, 0 },
+        {   37,    5, 3 },
+        {  100,   10, 1 },
+        { 1100, 1000, 0 },
+        { 1100, 1000, 5 },
+    };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gRec); i++) {
+        const int width = gRec[i].fWidth;
+        const int height = gRec[i].fHeight;
+        const int rowCount = width + gRec[i].fGap;
+        const int left = gRec[i].fGap > 0 ? 1 : 0;
+        // with a row of fill above and below
+        const size_t count = rowCount * (height + 2);
+
+        SkAutoTMalloc<uint32_t> storage32(count);
+        uint32_t* base32 = storage32.get();
+        sk_memset32_portable(base32, 0x55555555, count);
+        sk_memset_rect32(base32 + rowCount + left, 0x12345678, width, height,
+                         rowCount * sizeof(uint32_t));
+        REPORTER_ASSERT(reporter, check_rect<uint32_t>(base32, rowCount, left,
+                                  1, width, height, 0x12345678, 0x55555555));
+
+        SkAutoTMalloc<uint16_t> storage16(count);
+        uint16_t* base16 = storage16.get();
+        sk_memset16_portable(base16, 0x5555, count);
+        sk_memset_rect16(base16 + rowCount + left, 0x1234, width, height,
+                         rowCount * sizeof(uint16_t));
+        REPORTER_ASSERT(reporter, check_rect<uint16_t>(base16, rowCount, left,
+                                  1, width, height, 0x1234, 0x5555));
+    }
+}
+
+// the platform converters have to match the portable ones for every count,
+// including colors that aren't properly premultiplied
+static void test_pixel_converters(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    uint16_t src16[37];
+    uint32_t src32[37];
+    for (int i = 0; i < 37; i++) {
+        src16[i] = rand.nextU() & 0xFFFF;
+        src32[i] = rand.nextU();
+        switch (i % 4) {
+            case 0: // opaque
+                src32[i] |= SK_A32_MASK << SK_A32_SHIFT;
+                break;
+            case 1: // transparent
+                src32[i] &= ~(SK_A32_MASK << SK_A32_SHIFT);
+                break;
+            case 2: // premultiplied
+                src32[i] = SkPreMultiplyColor(src32[i]);
+                break;
+        }
+    }
+
+    for (int count = 0; count <= 37; count++) {
+        uint32_t dst32[38], expected32[38];
+        memset(dst32, 0x55, sizeof(dst32));
+        memcpy(expected32, dst32, sizeof(dst32));
+        sk_pixel16_to_pixel32_portable(expected32, src16, count);
+        sk_pixel16_to_pixel32(dst32, src16, count);
+        REPORTER_ASSERT(reporter, !memcmp(dst32, expected32, sizeof(dst32)));
+
+        uint8_t dst8[4 * 38], expected8[4 * 38];
+        memset(dst8, 0x55, sizeof(dst8));
+        memcpy(expected8, dst8, sizeof(dst8));
+        sk_unpremultiply_to_rgba_portable(expected8, src32, count);
+        sk_unpremultiply_to_rgba(dst8, src32, count);
+        REPORTER_ASSERT(reporter, !memcmp(dst8, expected8, sizeof(dst8)));
+    }
+
+    // unpremultiplying is exact for the colors that premultiplying can't
+    // have lost anything from
+    uint32_t c = SkPackARGB32(0x80, 0x40, 0x20, 0);
+    uint8_t rgba[4];
+    sk_unpremultiply_to_rgba(rgba, &c, 1);
+    REPORTER_ASSERT(reporter, 0x80 == rgba[0] && 0x40 == rgba[1] &&
+                              0 == rgba[2] && 0x80 == rgba[3]);
+}
+
+// each extension needs the ones before it, so a CPU (or an OS that doesn't
+// save the ymm registers) never reports one without the others
+static void test_cpu_features(skiatest::Reporter* reporter) {
+    uint32_t features = SkGetCpuFeatures();
+    REPORTER_ASSERT(reporter, features == SkGetCpuFeatures());
+
+    if (features & kAVX2_SkCpuFeature) {
+        REPORTER_ASSERT(reporter, features & kSSE41_SkCpuFeature);
+    }
+    if (features & kSSE41_SkCpuFeature) {
+        REPORTER_ASSERT(reporter, features & kSSSE3_SkCpuFeature);
+    }
+    if (features & kSSSE3_SkCpuFeature) {
+        REPORTER_ASSERT(reporter, features & kSSE2_SkCpuFeature);
+    }
+#if defined(__x86_64__) || defined(_WIN64)
+    REPORTER_ASSERT(reporter, features & kSSE2_SkCpuFeature);
+#endif
+}
+
 static void TestUTF(skiatest::Reporter* reporter) {
     static const struct {
         const char* fUtf8;
@@ -167,6 +328,10 @@ static void TestUTF(skiatest::Reporter* reporter) {
     test_search(reporter);
     test_refptr(reporter);
     test_autounref(reporter);
+    test_table8(reporter);
+    test_memset_rect(reporter);
+    test_pixel_converters(reporter);
+    test_cpu_features(reporter);
 }
 
 #include "TestClassDef.h"
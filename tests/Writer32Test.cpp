@@ -60,6 +60,113 @@ static void test2(skiatest::Reporter* reporter, SkWriter32* writer) {
     REPORTER_ASSERT(reporter, reader.eof());
 }
 
+static void write_ints(SkWriter32* writer, int start, int stop) {
+    for (int i = start; i < stop; ++i) {
+        writer->write32(i);
+    }
+}
+
+static bool check_ints(const void* data, int count) {
+    SkReader32 reader(data, count * 4);
+    for (int i = 0; i < count; ++i) {
+        if (reader.readInt() != i) {
+            return false;
+        }
+    }
+    return reader.eof();
+}
+
+static bool check_peeks(SkWriter32* writer, int count) {
+    for (int i = 0; i < count; ++i) {
+        if ((int32_t)*writer->peek32(i * 4) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// writes past the end of the caller's storage go to allocated blocks
+static void test_spill(skiatest::Reporter* reporter) {
+    const int N = 1000;
+    uint32_t storage[4];
+    SkWriter32 writer(16, storage, sizeof(storage));
+    REPORTER_ASSERT(reporter, (void*)storage == writer.getSingleBlock());
+
+    write_ints(&writer, 0, 4);
+    REPORTER_ASSERT(reporter, storage == writer.contiguousArray());
+    write_ints(&writer, 4, N);
+    REPORTER_ASSERT(reporter, (void*)storage == writer.getSingleBlock());
+    REPORTER_ASSERT(reporter, NULL == writer.contiguousArray());
+    REPORTER_ASSERT(reporter, NULL == writer.detachContiguousArray());
+
+    SkAutoMalloc flat(writer.size());
+    writer.flatten(flat.get());
+    REPORTER_ASSERT(reporter, check_ints(flat.get(), N));
+    REPORTER_ASSERT(reporter, check_peeks(&writer, N));
+}
+
+// after a reset, as much as was written before goes into one block
+static void test_reuse(skiatest::Reporter* reporter) {
+    const int N = 1000;
+    SkWriter32 writer(16);
+    write_ints(&writer, 0, N);
+    REPORTER_ASSERT(reporter, NULL == writer.contiguousArray());
+    REPORTER_ASSERT(reporter, check_peeks(&writer, N));
+    {
+        SkAutoMalloc flat(writer.size());
+        writer.flatten(flat.get());
+        REPORTER_ASSERT(reporter, check_ints(flat.get(), N));
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        writer.reset();
+        REPORTER_ASSERT(reporter, 0 == writer.size());
+        write_ints(&writer, 0, N);
+        const void* data = writer.contiguousArray();
+        REPORTER_ASSERT(reporter, NULL != data);
+        REPORTER_ASSERT(reporter, check_ints(data, N));
+        REPORTER_ASSERT(reporter, check_peeks(&writer, N));
+    }
+
+    void* data = writer.detachContiguousArray();
+    REPORTER_ASSERT(reporter, NULL != data);
+    REPORTER_ASSERT(reporter, 0 == writer.size());
+    REPORTER_ASSERT(reporter, check_ints(data, N));
+    sk_free(data);
+
+    // the writer carries on without the block
+    write_ints(&writer, 0, 10);
+    REPORTER_ASSERT(reporter, check_peeks(&writer, 10));
+}
+
+// rewinding, whether into the current block or an earlier one, carries on
+// writing as if nothing after the offset had been written
+static void test_rewind(skiatest::Reporter* reporter) {
+    const int N = 1000;
+    uint32_t storage[4];
+    SkWriter32 writer(16, storage, sizeof(storage));
+    write_ints(&writer, 0, N);
+
+    static const int gOffsets[] = { N - 1, N / 2, 20, 4, 3, 0 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gOffsets); ++i) {
+        const int count = gOffsets[i];
+        writer.rewindToOffset(count * 4);
+        REPORTER_ASSERT(reporter, (uint32_t)(count * 4) == writer.size());
+        REPORTER_ASSERT(reporter, check_peeks(&writer, count));
+
+        write_ints(&writer, count, count + 10);
+        SkAutoMalloc flat(writer.size());
+        writer.flatten(flat.get());
+        REPORTER_ASSERT(reporter, check_ints(flat.get(), count + 10));
+        REPORTER_ASSERT(reporter, check_peeks(&writer, count + 10));
+    }
+
+    // rewinding to the end changes nothing
+    writer.rewindToOffset(writer.size());
+    REPORTER_ASSERT(reporter, 10 * 4 == writer.size());
+    REPORTER_ASSERT(reporter, check_peeks(&writer, 10));
+}
+
 static void Tests(skiatest::Reporter* reporter) {
     // dynamic allocator
     {
@@ -83,6 +190,10 @@ static void Tests(skiatest::Reporter* reporter) {
         writer.reset(storage, sizeof(storage));
         test2(reporter, &writer);
     }
+
+    test_spill(reporter);
+    test_reuse(reporter);
+    test_rewind(reporter);
 }
 
 #include "TestClassDef.h"
@@ -1,5 +1,9 @@
 #include "Test.h"
+#include "SkAvoidXfermode.h"
 #include "SkColor.h"
+#include "SkColorPriv.h"
+#include "SkPixelXorXfermode.h"
+#include "SkRandom.h"
 #include "SkXfermode.h"
 
 SkPMColor bogusXfermodeProc(SkPMColor src, SkPMColor dst) {
@@ -39,5 +43,122 @@ static void test_asMode(skiatest::Reporter* reporter) {
     bogusXfer->unref();
 }
 
+static SkPMColor random_pmcolor(SkRandom* rand) {
+    SkColor c = rand->nextU();
+    switch (rand->nextU() & 3) {
+        case 0:
+            c |= 0xFF000000;
+            break;
+        case 1:
+            c &= 0x00FFFFFF;
+            break;
+        default:
+            break;
+    }
+    return SkPreMultiplyColor(c);
+}
+
+// xfer32 (which may use a platform row proc) must match the modeproc exactly
+static void test_xfer32(skiatest::Reporter* reporter) {
+    static const int N = 37;
+    SkPMColor src[N], dst[N], expected[N];
+    SkRandom rand;
+
+    for (int mode = 0; mode <= SkXfermode::kLastMode; mode++) {
+        SkXfermode* xfer = SkXfermode::Create((SkXfermode::Mode) mode);
+        if (NULL == xfer) {
+            continue;
+        }
+        SkXfermodeProc proc = SkXfermode::GetProc((SkXfermode::Mode) mode);
+        for (int count = 0; count <= N; count++) {
+            for (int i = 0; i < N; i++) {
+                src[i] = random_pmcolor(&rand);
+                dst[i] = expected[i] = random_pmcolor(&rand);
+            }
+            for (int i = 0; i < count; i++) {
+                expected[i] = proc(src[i], expected[i]);
+            }
+            xfer->xfer32(dst, src, count, NULL);
+            REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+        }
+        xfer->unref();
+    }
+}
+
+// near the op color (so that the distances cover the tolerances), or anywhere
+static SkPMColor random_near(SkRandom* rand, SkColor op) {
+    if (rand->nextU() & 1) {
+        return random_pmcolor(rand);
+    }
+    int d = (rand->nextU() & 63) - 32;
+    return SkPackARGB32(0xFF, SkClampMax(SkColorGetR(op) + d, 255),
+                        SkClampMax(SkColorGetG(op) - d, 255),
+                        SkClampMax(SkColorGetB(op) + d / 2, 255));
+}
+
+// A row (which may go to a platform proc) has to come out as it does a pixel
+// at a time (which goes to the portable code).
+static void test_avoid(skiatest::Reporter* reporter) {
+    static const int N = 37;
+    SkPMColor src[N], dst32[N], expected32[N];
+    uint16_t dst16[N], expected16[N];
+    SkAlpha aa[N];
+    SkRandom rand;
+
+    static const U8CPU gTolerance[] = { 0, 1, 16, 100, 254, 255 };
+    for (size_t t = 0; t < SK_ARRAY_COUNT(gTolerance); t++) {
+        for (int mode = 0; mode < 2; mode++) {
+            SkColor op = rand.nextU() | 0xFF000000;
+            SkAvoidXfermode xfer(op, gTolerance[t],
+                                 (SkAvoidXfermode::Mode)mode);
+            for (int useAA = 0; useAA < 2; useAA++) {
+                for (int i = 0; i < N; i++) {
+                    src[i] = random_pmcolor(&rand);
+                    dst32[i] = expected32[i] = random_near(&rand, op);
+                    dst16[i] = expected16[i] =
+                            SkPixel32ToPixel16(random_near(&rand, op));
+                    aa[i] = (rand.nextU() & 1) ? 0xFF : rand.nextU() & 0xFF;
+                }
+                const SkAlpha* coverage = useAA ? aa : NULL;
+                xfer.xfer32(dst32, src, N, coverage);
+                xfer.xfer16(dst16, src, N, coverage);
+                for (int i = 0; i < N; i++) {
+                    const SkAlpha* a = useAA ? &aa[i] : NULL;
+                    xfer.xfer32(&expected32[i], &src[i], 1, a);
+                    xfer.xfer16(&expected16[i], &src[i], 1, a);
+                }
+                REPORTER_ASSERT(reporter,
+                                !memcmp(dst32, expected32, sizeof(dst32)));
+                REPORTER_ASSERT(reporter,
+                                !memcmp(dst16, expected16, sizeof(dst16)));
+            }
+        }
+    }
+}
+
+static void test_pixel_xor(skiatest::Reporter* reporter) {
+    static const int N = 37;
+    SkPMColor src[N], dst[N], expected[N];
+    SkRandom rand;
+
+    SkColor op = rand.nextU();
+    SkPixelXorXfermode xfer(op);
+    for (int i = 0; i < N; i++) {
+        src[i] = random_pmcolor(&rand);
+        dst[i] = random_pmcolor(&rand);
+        expected[i] = src[i] ^ dst[i] ^ op;
+        expected[i] |= SK_A32_MASK << SK_A32_SHIFT;
+    }
+    xfer.xfer32(dst, src, N, NULL);
+    REPORTER_ASSERT(reporter, !memcmp(dst, expected, sizeof(dst)));
+}
+
+static void TestXfermode(skiatest::Reporter* reporter) {
+    test_asMode(reporter);
+    test_xfer32(reporter);
+    test_avoid(reporter);
+    test_pixel_xor(reporter);
+}
+
 #include "TestClassDef.h"
-DEFINE_TESTCLASS("Xfermode", XfermodeTestClass, test_asMode)
+DEFINE_TESTCLASS("Xfermode", XfermodeTestClass, TestXfermode)